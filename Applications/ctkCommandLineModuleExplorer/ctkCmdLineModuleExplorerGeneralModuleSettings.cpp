@@ -21,9 +21,9 @@
 
 #include "ctkCmdLineModuleExplorerGeneralModuleSettings.h"
 #include "ctkCmdLineModuleManager.h"
+#include "ctkCmdLineModuleScheduler.h"
 #include "ctkCmdLineModuleExplorerConstants.h"
 
-#include <QThreadPool>
 #include <QSettings>
 
 ctkCmdLineModuleExplorerGeneralModuleSettings::ctkCmdLineModuleExplorerGeneralModuleSettings(ctkCmdLineModuleManager* cmdLineModuleManager)
@@ -40,7 +40,7 @@ ctkCmdLineModuleExplorerGeneralModuleSettings::ctkCmdLineModuleExplorerGeneralMo
 void ctkCmdLineModuleExplorerGeneralModuleSettings::applySettings()
 {
   int maxParallelModules = this->propertyValue(ctkCmdLineModuleExplorerConstants::KEY_MAX_PARALLEL_MODULES).toInt();
-  QThreadPool::globalInstance()->setMaxThreadCount(maxParallelModules);
+  this->CmdLineModuleManager->scheduler()->setMaximumConcurrentTasks(maxParallelModules);
 
   int timeout = this->propertyValue(ctkCmdLineModuleExplorerConstants::KEY_XML_TIMEOUT_SECONDS).toInt();
   this->CmdLineModuleManager->setTimeOutForXMLRetrieval(timeout*1000);
@@ -31,6 +31,7 @@
 #include "ctkCmdLineModuleUtils.h"
 
 #include <ctkCmdLineModuleManager.h>
+#include <ctkCmdLineModuleScheduler.h>
 #include <ctkCmdLineModuleConcurrentHelpers.h>
 #include <ctkCmdLineModuleDescription.h>
 #include <ctkCmdLineModuleFrontendFactoryQtGui.h>
@@ -77,8 +78,8 @@ ctkCLModuleExplorerMainWindow::ctkCLModuleExplorerMainWindow(QWidget *parent) :
   {
     settings.setValue(ctkCmdLineModuleExplorerConstants::KEY_MAX_PARALLEL_MODULES, QThread::idealThreadCount());
   }
-  QThreadPool::globalInstance()->setMaxThreadCount(settings.value(ctkCmdLineModuleExplorerConstants::KEY_MAX_PARALLEL_MODULES,
-                                                                  QThread::idealThreadCount()).toInt());
+  moduleManager.scheduler()->setMaximumConcurrentTasks(settings.value(ctkCmdLineModuleExplorerConstants::KEY_MAX_PARALLEL_MODULES,
+                                                                      QThread::idealThreadCount()).toInt());
   if (!settings.contains(ctkCmdLineModuleExplorerConstants::KEY_XML_TIMEOUT_SECONDS))
   {
     settings.setValue(ctkCmdLineModuleExplorerConstants::KEY_XML_TIMEOUT_SECONDS, QVariant(30));
@@ -146,12 +147,11 @@ ctkCLModuleExplorerMainWindow::ctkCLModuleExplorerMainWindow(QWidget *parent) :
   }
 
   // Register persistent modules
-  QFuture<ctkCmdLineModuleReferenceResult> future = QtConcurrent::mapped(settings.value(ctkCmdLineModuleExplorerConstants::KEY_REGISTERED_MODULES).toStringList(),
-                                                                         ctkCmdLineModuleConcurrentRegister(&moduleManager, true));
-  future.waitForFinished();
+  QList<ctkCmdLineModuleReferenceResult> results = moduleManager.registerModules(
+        settings.value(ctkCmdLineModuleExplorerConstants::KEY_REGISTERED_MODULES).toStringList(), true);
 
-  ctkCmdLineModuleUtils::messageBoxModuleRegistration(future,
-                                                      moduleManager.validationMode());
+  ctkCmdLineModuleUtils::messageBoxForModuleRegistration(
+        ctkCmdLineModuleUtils::errorMessagesFromModuleRegistration(results, moduleManager.validationMode()));
 
   // Start watching directories
   directoryWatcher.setDebug(true);
@@ -83,12 +83,14 @@ void ctkCmdLineModuleExplorerModulesSettings::applySettings()
   this->setCursor(Qt::BusyCursor);
 
   QFuture<void> future1 = QtConcurrent::mapped(removedModules, ctkCmdLineModuleConcurrentUnRegister(this->ModuleManager));
-  QFuture<ctkCmdLineModuleReferenceResult> future2 = QtConcurrent::mapped(addedModules, ctkCmdLineModuleConcurrentRegister(this->ModuleManager, true));
 
   ctkSettingsPanel::applySettings();
 
   future1.waitForFinished();
 
+  // Registered on the pool of the module manager
+  QList<ctkCmdLineModuleReferenceResult> results = this->ModuleManager->registerModules(addedModules, true);
+
   /*
   QFutureSynchronizer<void> sync;
   sync.addFuture(future1);
@@ -102,9 +104,8 @@ void ctkCmdLineModuleExplorerModulesSettings::applySettings()
 
   this->unsetCursor();
 
-  future2.waitForFinished();
-  ctkCmdLineModuleUtils::messageBoxModuleRegistration(future2,
-                                                      this->ModuleManager->validationMode());
+  ctkCmdLineModuleUtils::messageBoxForModuleRegistration(
+        ctkCmdLineModuleUtils::errorMessagesFromModuleRegistration(results, this->ModuleManager->validationMode()));
 
 }
 
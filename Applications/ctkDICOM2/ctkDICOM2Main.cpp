@@ -82,6 +82,7 @@ int main(int argc, char** argv)
   ctkDICOMBrowser DICOMApp;
 
   DICOMApp.setDatabaseDirectory(databaseDirectory);
+  DICOMApp.setAsynchronousImport(true);
   DICOMApp.show();
 
   return app.exec();
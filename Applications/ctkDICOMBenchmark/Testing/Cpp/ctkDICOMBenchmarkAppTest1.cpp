@@ -0,0 +1,89 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+int ctkDICOMBenchmarkAppTest1(int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "Must specify path to ctkDICOMBenchmark on command line\n";
+    return EXIT_FAILURE;
+    }
+  std::cout << "Testing ctkDICOMBenchmark: " << argv[1] << "\n";
+  QString command = QString(argv[1]);
+  QString directory = QDir::tempPath() + "/ctkDICOMBenchmarkAppTest1";
+  QString output = directory + ".json";
+  QFile::remove(output);
+
+  // a small tree, only the command line and the report are tested
+  QStringList parameters;
+  parameters << "--directory" << directory << "--output" << output
+             << "--patients" << "1" << "--studies" << "1" << "--series" << "2"
+             << "--instances" << "3" << "--rows" << "16" << "--columns" << "16"
+             << "--repeat" << "1";
+  int res = QProcess::execute(command, parameters);
+  if (res != EXIT_SUCCESS)
+    {
+    std::cerr << '\"' << qPrintable(command + " " + parameters.join(" ")) << '\"'
+              << " returned " << res << std::endl;
+    return res;
+    }
+
+  QFile report(output);
+  if (!report.open(QIODevice::ReadOnly))
+    {
+    std::cerr << "ctkDICOMBenchmark didn't write " << qPrintable(output) << std::endl;
+    return EXIT_FAILURE;
+    }
+  QString content = QString::fromUtf8(report.readAll());
+  if (!content.startsWith("{") ||
+      !content.contains("\"files\": 6") ||
+      !content.contains("\"medianFilesPerSecond\"") ||
+      !content.contains("\"meanFetchMilliseconds\"") ||
+      !content.contains("\"memoryLookupsPerSecond\"") ||
+      !content.contains("\"medianPrecacheFilesPerSecond\"") ||
+      !content.contains("\"medianHeadersPerSecond\"") ||
+      !content.contains("\"skipped\": true"))
+    {
+    std::cerr << "Unexpected report:\n" << qPrintable(content) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // invalid arguments
+  parameters.clear();
+  parameters << "--patients" << "0";
+  if (QProcess::execute(command, parameters) == EXIT_SUCCESS)
+    {
+    std::cerr << "ctkDICOMBenchmark should fail with no patient" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
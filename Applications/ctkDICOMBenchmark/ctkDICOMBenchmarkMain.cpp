@@ -0,0 +1,874 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+/* Notes:
+ *
+ * This program measures the throughput of the DICOM core classes on a
+ * synthetic tree of files and writes the results as JSON, e.g.:
+ *
+ * ../CTK-build/bin/ctkDICOMBenchmark --patients 10 --instances 100 --output results.json
+ *
+ * The tree only depends on the options, the UIDs included, so that the
+ * results of two builds run with the same options can be compared.
+ *
+ * The C-FIND and C-GET benchmarks are run with --network, they need the
+ * dcmqrscp and storescu DCMTK executables (see ctkDICOMTester).
+ */
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSharedPointer>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QTextStream>
+#include <QTime>
+#include <QtAlgorithms>
+
+// CTK includes
+#include <ctkDICOMDatabase.h>
+#include <ctkDICOMIndexer.h>
+#include <ctkDICOMItem.h>
+#include <ctkDICOMModel.h>
+#include <ctkDICOMQuery.h>
+#include <ctkDICOMRetrieve.h>
+#include <ctkDICOMTester.h>
+
+// DCMTK includes
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcuid.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#ifndef CTK_VERSION
+# define CTK_VERSION "unknown"
+#endif
+
+//----------------------------------------------------------------------------
+struct ctkDICOMBenchmarkOptions
+{
+  ctkDICOMBenchmarkOptions()
+    : Patients(2)
+    , StudiesPerPatient(2)
+    , SeriesPerStudy(2)
+    , InstancesPerSeries(10)
+    , Rows(256)
+    , Columns(256)
+    , Frames(1)
+    , Repeat(3)
+    , Network(false)
+  {
+  }
+  int Patients;
+  int StudiesPerPatient;
+  int SeriesPerStudy;
+  int InstancesPerSeries;
+  int Rows;
+  int Columns;
+  int Frames;
+  int Repeat;
+  bool Network;
+  QString Directory;
+  QString Output;
+  QString DCMQRSCPExecutable;
+  QString DCMQRSCPConfigFile;
+  QString StoreSCUExecutable;
+};
+
+//----------------------------------------------------------------------------
+void print_usage()
+{
+  std::cerr << "Usage:\n";
+  std::cerr << "  ctkDICOMBenchmark [options]\n";
+  std::cerr << "Options:\n";
+  std::cerr << "  --directory <dir>         Working directory, emptied before the run.\n";
+  std::cerr << "                            Default is <temp>/ctkDICOMBenchmark.\n";
+  std::cerr << "  --output <file.json>      Result file, the standard output by default.\n";
+  std::cerr << "  --patients <n>            Number of patients (2).\n";
+  std::cerr << "  --studies <n>             Number of studies per patient (2).\n";
+  std::cerr << "  --series <n>              Number of series per study (2).\n";
+  std::cerr << "  --instances <n>           Number of instances per series (10).\n";
+  std::cerr << "  --rows <n>                Rows of the frames (256).\n";
+  std::cerr << "  --columns <n>             Columns of the frames (256).\n";
+  std::cerr << "  --frames <n>              Number of frames per instance (1).\n";
+  std::cerr << "  --repeat <n>              Number of runs of each benchmark (3).\n";
+  std::cerr << "  --network                 Run the C-FIND and C-GET benchmarks.\n";
+  std::cerr << "  --dcmqrscp <exe>          dcmqrscp executable, see ctkDICOMTester.\n";
+  std::cerr << "  --dcmqrscp-config <file>  dcmqrscp configuration file.\n";
+  std::cerr << "  --storescu <exe>          storescu executable.\n";
+  return;
+}
+
+//----------------------------------------------------------------------------
+static bool parseArguments(const QStringList& arguments, ctkDICOMBenchmarkOptions& options)
+{
+  for (int i = 1; i < arguments.count(); ++i)
+    {
+    const QString& argument = arguments[i];
+    if (argument == "--network")
+      {
+      options.Network = true;
+      continue;
+      }
+    if (i + 1 >= arguments.count())
+      {
+      std::cerr << "Missing value for " << qPrintable(argument) << std::endl;
+      return false;
+      }
+    const QString value = arguments[++i];
+    bool ok = true;
+    if (argument == "--directory")
+      {
+      options.Directory = value;
+      }
+    else if (argument == "--output")
+      {
+      options.Output = value;
+      }
+    else if (argument == "--dcmqrscp")
+      {
+      options.DCMQRSCPExecutable = value;
+      }
+    else if (argument == "--dcmqrscp-config")
+      {
+      options.DCMQRSCPConfigFile = value;
+      }
+    else if (argument == "--storescu")
+      {
+      options.StoreSCUExecutable = value;
+      }
+    else if (argument == "--patients")
+      {
+      options.Patients = value.toInt(&ok);
+      }
+    else if (argument == "--studies")
+      {
+      options.StudiesPerPatient = value.toInt(&ok);
+      }
+    else if (argument == "--series")
+      {
+      options.SeriesPerStudy = value.toInt(&ok);
+      }
+    else if (argument == "--instances")
+      {
+      options.InstancesPerSeries = value.toInt(&ok);
+      }
+    else if (argument == "--rows")
+      {
+      options.Rows = value.toInt(&ok);
+      }
+    else if (argument == "--columns")
+      {
+      options.Columns = value.toInt(&ok);
+      }
+    else if (argument == "--frames")
+      {
+      options.Frames = value.toInt(&ok);
+      }
+    else if (argument == "--repeat")
+      {
+      options.Repeat = value.toInt(&ok);
+      }
+    else
+      {
+      std::cerr << "Unknown option " << qPrintable(argument) << std::endl;
+      return false;
+      }
+    if (!ok)
+      {
+      std::cerr << "Could not convert " << qPrintable(value) << " to an integer" << std::endl;
+      return false;
+      }
+    }
+  if (options.Patients < 1 || options.StudiesPerPatient < 1 || options.SeriesPerStudy < 1 ||
+      options.InstancesPerSeries < 1 || options.Rows < 1 || options.Columns < 1 ||
+      options.Frames < 1 || options.Repeat < 1)
+    {
+    std::cerr << "The counts and sizes must be strictly positive" << std::endl;
+    return false;
+    }
+  if (options.Directory.isEmpty())
+    {
+    options.Directory = QDir::tempPath() + "/ctkDICOMBenchmark";
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// JSON helpers, the JSON classes are not available with Qt 4
+
+//----------------------------------------------------------------------------
+static QString jsonString(const QString& value)
+{
+  QString result("\"");
+  foreach(const QChar& c, value)
+    {
+    if (c == '"' || c == '\\')
+      {
+      result += '\\';
+      result += c;
+      }
+    else if (c.unicode() < 0x20)
+      {
+      result += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+      }
+    else
+      {
+      result += c;
+      }
+    }
+  return result + "\"";
+}
+
+//----------------------------------------------------------------------------
+static QString jsonNumber(double value)
+{
+  return QString::number(value, 'g', 12);
+}
+
+//----------------------------------------------------------------------------
+static QString jsonObject(const QStringList& members, int indent)
+{
+  if (members.isEmpty())
+    {
+    return "{}";
+    }
+  QString padding(indent + 2, ' ');
+  return "{\n" + padding + members.join(",\n" + padding) + "\n" + QString(indent, ' ') + "}";
+}
+
+//----------------------------------------------------------------------------
+static QString jsonMember(const QString& name, const QString& value)
+{
+  return jsonString(name) + ": " + value;
+}
+
+//----------------------------------------------------------------------------
+static QString jsonArray(const QList<double>& values)
+{
+  QStringList items;
+  foreach(double value, values)
+    {
+    items << jsonNumber(value);
+    }
+  return "[" + items.join(", ") + "]";
+}
+
+//----------------------------------------------------------------------------
+static double median(QList<double> values)
+{
+  if (values.isEmpty())
+    {
+    return 0.;
+    }
+  qSort(values);
+  int middle = values.count() / 2;
+  return values.count() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.;
+}
+
+//----------------------------------------------------------------------------
+/// Seconds elapsed since time was started, at least a millisecond to keep
+/// the rates finite.
+static double elapsedSeconds(const QTime& time)
+{
+  return qMax(1, time.elapsed()) / 1000.;
+}
+
+//----------------------------------------------------------------------------
+static bool removeDirectory(const QString& path)
+{
+  QDir directory(path);
+  if (!directory.exists())
+    {
+    return true;
+    }
+  foreach(const QFileInfo& info,
+          directory.entryInfoList(QDir::NoDotAndDotDot | QDir::AllEntries | QDir::Hidden))
+    {
+    bool removed = info.isDir() ? removeDirectory(info.absoluteFilePath())
+                                : directory.remove(info.fileName());
+    if (!removed)
+      {
+      return false;
+      }
+    }
+  return QDir().rmdir(path);
+}
+
+//----------------------------------------------------------------------------
+/// UID made of \a root and of the indices of the patient, study, series and
+/// instance, instead of a generated one.
+static QByteArray benchmarkUID(const char* root, int patient, int study = -1,
+                               int series = -1, int instance = -1)
+{
+  QString uid = QString("%1.%2").arg(root).arg(patient + 1);
+  int indices[3] = { study, series, instance };
+  for (int i = 0; i < 3 && indices[i] >= 0; ++i)
+    {
+    uid += QString(".%1").arg(indices[i] + 1);
+    }
+  return uid.toLatin1();
+}
+
+//----------------------------------------------------------------------------
+static bool writeInstance(const QString& filePath, int patient,
+                          const char* studyUID, int study,
+                          const char* seriesUID, int series, int instance,
+                          const ctkDICOMBenchmarkOptions& options,
+                          const std::vector<Uint16>& pixels)
+{
+  DcmFileFormat fileFormat;
+  DcmDataset* dataset = fileFormat.getDataset();
+  dataset->putAndInsertString(DCM_SOPClassUID, UID_MRImageStorage);
+  dataset->putAndInsertString(DCM_SOPInstanceUID,
+                              benchmarkUID(SITE_INSTANCE_UID_ROOT, patient, study,
+                                           series, instance).constData());
+  dataset->putAndInsertString(DCM_PatientName,
+                              QString("Benchmark^Patient%1").arg(patient).toLatin1().constData());
+  dataset->putAndInsertString(DCM_PatientID,
+                              QString("CTKBENCH%1").arg(patient).toLatin1().constData());
+  dataset->putAndInsertString(DCM_PatientBirthDate, "19700101");
+  dataset->putAndInsertString(DCM_PatientSex, patient % 2 ? "F" : "M");
+  dataset->putAndInsertString(DCM_StudyInstanceUID, studyUID);
+  dataset->putAndInsertString(DCM_StudyID, QString::number(study).toLatin1().constData());
+  dataset->putAndInsertString(DCM_StudyDate, "20150101");
+  dataset->putAndInsertString(DCM_StudyTime, "120000");
+  dataset->putAndInsertString(DCM_StudyDescription,
+                              QString("Benchmark study %1").arg(study).toLatin1().constData());
+  dataset->putAndInsertString(DCM_AccessionNumber, "");
+  dataset->putAndInsertString(DCM_Modality, "MR");
+  dataset->putAndInsertString(DCM_SeriesInstanceUID, seriesUID);
+  dataset->putAndInsertString(DCM_SeriesNumber, QString::number(series).toLatin1().constData());
+  dataset->putAndInsertString(DCM_SeriesDescription,
+                              QString("Benchmark series %1").arg(series).toLatin1().constData());
+  dataset->putAndInsertString(DCM_InstanceNumber, QString::number(instance + 1).toLatin1().constData());
+  dataset->putAndInsertUint16(DCM_Rows, options.Rows);
+  dataset->putAndInsertUint16(DCM_Columns, options.Columns);
+  dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+  dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+  dataset->putAndInsertUint16(DCM_BitsAllocated, 16);
+  dataset->putAndInsertUint16(DCM_BitsStored, 12);
+  dataset->putAndInsertUint16(DCM_HighBit, 11);
+  dataset->putAndInsertUint16(DCM_PixelRepresentation, 0);
+  if (options.Frames > 1)
+    {
+    dataset->putAndInsertString(DCM_NumberOfFrames,
+                                QString::number(options.Frames).toLatin1().constData());
+    }
+  dataset->putAndInsertUint16Array(DCM_PixelData, &pixels[0],
+                                   static_cast<unsigned long>(pixels.size()));
+  return fileFormat.saveFile(QFile::encodeName(filePath).constData(),
+                             EXS_LittleEndianExplicit).good();
+}
+
+//----------------------------------------------------------------------------
+/// Write the synthetic tree into dataDirectory, a directory per series.
+static QStringList generateTree(const QString& dataDirectory,
+                                const ctkDICOMBenchmarkOptions& options)
+{
+  QStringList files;
+  std::vector<Uint16> pixels(
+    static_cast<size_t>(options.Rows) * options.Columns * options.Frames);
+  for (size_t i = 0; i < pixels.size(); ++i)
+    {
+    pixels[i] = static_cast<Uint16>(i % 4096);
+    }
+  for (int patient = 0; patient < options.Patients; ++patient)
+    {
+    for (int study = 0; study < options.StudiesPerPatient; ++study)
+      {
+      QByteArray studyUID = benchmarkUID(SITE_STUDY_UID_ROOT, patient, study);
+      for (int series = 0; series < options.SeriesPerStudy; ++series)
+        {
+        QByteArray seriesUID = benchmarkUID(SITE_SERIES_UID_ROOT, patient, study, series);
+        QString seriesDirectory = QString("%1/patient%2/study%3/series%4")
+          .arg(dataDirectory).arg(patient).arg(study).arg(series);
+        if (!QDir().mkpath(seriesDirectory))
+          {
+          std::cerr << "Unable to create " << qPrintable(seriesDirectory) << std::endl;
+          return QStringList();
+          }
+        for (int instance = 0; instance < options.InstancesPerSeries; ++instance)
+          {
+          QString filePath = QString("%1/%2.dcm").arg(seriesDirectory).arg(instance);
+          if (!writeInstance(filePath, patient, studyUID.constData(), study,
+                             seriesUID.constData(), series, instance, options, pixels))
+            {
+            std::cerr << "Unable to write " << qPrintable(filePath) << std::endl;
+            return QStringList();
+            }
+          files << filePath;
+          }
+        }
+      }
+    }
+  return files;
+}
+
+//----------------------------------------------------------------------------
+static bool openEmptyDatabase(ctkDICOMDatabase& database, const QString& databaseFile)
+{
+  database.closeDatabase();
+  QFile::remove(databaseFile);
+  database.openDatabase(databaseFile);
+  if (!database.isOpen())
+    {
+    std::cerr << "Unable to open " << qPrintable(databaseFile) << ": "
+              << qPrintable(database.lastError()) << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// ctkDICOMIndexer::addDirectory() on an empty database.
+static QString benchmarkIndexer(ctkDICOMDatabase& database, const QString& databaseFile,
+                                const QString& dataDirectory, int fileCount,
+                                const ctkDICOMBenchmarkOptions& options)
+{
+  QList<double> seconds;
+  QList<double> filesPerSecond;
+  for (int run = 0; run < options.Repeat; ++run)
+    {
+    if (!openEmptyDatabase(database, databaseFile))
+      {
+      return QString();
+      }
+    ctkDICOMIndexer indexer;
+    QTime time;
+    time.start();
+    indexer.addDirectory(database, dataDirectory);
+    seconds << elapsedSeconds(time);
+    filesPerSecond << fileCount / seconds.last();
+    }
+  int indexedFiles = database.allFiles().count();
+
+  QStringList members;
+  members << jsonMember("files", jsonNumber(indexedFiles));
+  members << jsonMember("seconds", jsonArray(seconds));
+  members << jsonMember("filesPerSecond", jsonArray(filesPerSecond));
+  members << jsonMember("medianFilesPerSecond", jsonNumber(median(filesPerSecond)));
+  return jsonObject(members, 4);
+}
+
+//----------------------------------------------------------------------------
+/// ctkDICOMDatabase::insert() of parsed headers in a bulk insert session,
+/// without and with tags to precache.
+static QString benchmarkInsert(ctkDICOMDatabase& database, const QString& databaseFile,
+                               const QStringList& files, const ctkDICOMBenchmarkOptions& options)
+{
+  // the headers are parsed once, only the database is measured
+  QList<QSharedPointer<ctkDICOMItem> > items;
+  foreach(const QString& file, files)
+    {
+    QSharedPointer<ctkDICOMItem> item(new ctkDICOMItem);
+    item->InitializeFromFileHeader(file);
+    items << item;
+    }
+  QStringList tags;
+  tags << "0010,0010" << "0020,000D" << "0008,103E" << "0020,0013";
+
+  QStringList members;
+  for (int precache = 0; precache < 2; ++precache)
+    {
+    QList<double> filesPerSecond;
+    for (int run = 0; run < options.Repeat; ++run)
+      {
+      if (!openEmptyDatabase(database, databaseFile))
+        {
+        return QString();
+        }
+      database.setTagsToPrecache(precache ? tags : QStringList());
+      QTime time;
+      time.start();
+      database.beginBulkInsert();
+      for (int i = 0; i < items.count(); ++i)
+        {
+        database.insert(*items[i], files[i], false, false);
+        }
+      database.endBulkInsert();
+      filesPerSecond << items.count() / elapsedSeconds(time);
+      }
+    QString name = precache ? "precacheFilesPerSecond" : "filesPerSecond";
+    members << jsonMember(name, jsonArray(filesPerSecond));
+    members << jsonMember(precache ? "medianPrecacheFilesPerSecond" : "medianFilesPerSecond",
+                          jsonNumber(median(filesPerSecond)));
+    }
+  members.prepend(jsonMember("files", jsonNumber(database.allFiles().count())));
+  database.setTagsToPrecache(QStringList());
+  return jsonObject(members, 4);
+}
+
+//----------------------------------------------------------------------------
+/// Parsing of the files by ctkDICOMItem, entirely and up to the pixel data,
+/// and decoding of a few of their attributes. The files are in the page
+/// cache, see benchmarkIndexer() for the cost of reading them.
+static QString benchmarkDecode(const QStringList& files, const ctkDICOMBenchmarkOptions& options)
+{
+  QList<double> filesPerSecond;
+  QList<double> headersPerSecond;
+  int decoded = 0;
+  for (int run = 0; run < options.Repeat; ++run)
+    {
+    for (int header = 0; header < 2; ++header)
+      {
+      decoded = 0;
+      QTime time;
+      time.start();
+      foreach(const QString& file, files)
+        {
+        ctkDICOMItem item;
+        if (header)
+          {
+          item.InitializeFromFileHeader(file);
+          }
+        else
+          {
+          item.InitializeFromFile(file);
+          }
+        if (!item.GetElementAsString(DCM_SOPInstanceUID).isEmpty() &&
+            !item.GetElementAsString(DCM_PatientName).isEmpty() &&
+            item.GetElementAsDate(DCM_StudyDate).isValid())
+          {
+          ++decoded;
+          }
+        }
+      (header ? headersPerSecond : filesPerSecond) << files.count() / elapsedSeconds(time);
+      }
+    }
+
+  QStringList members;
+  members << jsonMember("files", jsonNumber(decoded));
+  members << jsonMember("filesPerSecond", jsonArray(filesPerSecond));
+  members << jsonMember("medianFilesPerSecond", jsonNumber(median(filesPerSecond)));
+  members << jsonMember("headersPerSecond", jsonArray(headersPerSecond));
+  members << jsonMember("medianHeadersPerSecond", jsonNumber(median(headersPerSecond)));
+  return jsonObject(members, 4);
+}
+
+//----------------------------------------------------------------------------
+static void fetchAll(ctkDICOMModel& model, const QModelIndex& parent, QList<double>& latencies)
+{
+  if (model.canFetchMore(parent))
+    {
+    QTime time;
+    time.start();
+    model.fetchMore(parent);
+    latencies << time.elapsed();
+    }
+  int rowCount = model.rowCount(parent);
+  for (int row = 0; row < rowCount; ++row)
+    {
+    fetchAll(model, model.index(row, 0, parent), latencies);
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Latency of the fetches populating ctkDICOMModel down to the series.
+static QString benchmarkModel(ctkDICOMDatabase& database, const ctkDICOMBenchmarkOptions& options)
+{
+  QList<double> totals;
+  QList<double> latencies;
+  for (int run = 0; run < options.Repeat; ++run)
+    {
+    ctkDICOMModel model;
+    model.setEndLevel(ctkDICOMModel::SeriesType);
+    QTime time;
+    time.start();
+    model.setDatabase(database.database());
+    fetchAll(model, QModelIndex(), latencies);
+    totals << time.elapsed();
+    }
+  double sum = 0.;
+  double maximum = 0.;
+  foreach(double latency, latencies)
+    {
+    sum += latency;
+    maximum = qMax(maximum, latency);
+    }
+
+  QStringList members;
+  members << jsonMember("fetches", jsonNumber(latencies.count()));
+  members << jsonMember("totalMilliseconds", jsonArray(totals));
+  members << jsonMember("meanFetchMilliseconds",
+                        jsonNumber(latencies.isEmpty() ? 0. : sum / latencies.count()));
+  members << jsonMember("medianFetchMilliseconds", jsonNumber(median(latencies)));
+  members << jsonMember("maxFetchMilliseconds", jsonNumber(maximum));
+  return jsonObject(members, 4);
+}
+
+//----------------------------------------------------------------------------
+/// Rate of cachedTag() lookups answered by the tag cache database and by
+/// the in-memory cache in front of it.
+static QString benchmarkTagCache(ctkDICOMDatabase& database, const ctkDICOMBenchmarkOptions& options)
+{
+  QStringList instances;
+  QSqlQuery query(database.database());
+  query.exec("SELECT SOPInstanceUID FROM Images");
+  while (query.next())
+    {
+    instances << query.value(0).toString();
+    }
+  QStringList tags;
+  tags << "0010,0010" << "0020,000D" << "0008,103E" << "0020,0013";
+
+  QStringList cachedInstances;
+  QStringList cachedTags;
+  QStringList cachedValues;
+  foreach(const QString& instance, instances)
+    {
+    foreach(const QString& tag, tags)
+      {
+      cachedInstances << instance;
+      cachedTags << tag;
+      cachedValues << instance + tag;
+      }
+    }
+  QTime time;
+  time.start();
+  database.cacheTags(cachedInstances, cachedTags, cachedValues);
+  double insertSeconds = elapsedSeconds(time);
+
+  int defaultCacheSize = database.tagValueCacheSize();
+  QList<double> databaseRates;
+  QList<double> memoryRates;
+  for (int run = 0; run < options.Repeat; ++run)
+    {
+    database.setTagValueCacheSize(0);
+    time.start();
+    for (int i = 0; i < cachedInstances.count(); ++i)
+      {
+      database.cachedTag(cachedInstances[i], cachedTags[i]);
+      }
+    databaseRates << cachedInstances.count() / elapsedSeconds(time);
+
+    database.setTagValueCacheSize(defaultCacheSize);
+    for (int i = 0; i < cachedInstances.count(); ++i)
+      {
+      database.cachedTag(cachedInstances[i], cachedTags[i]);
+      }
+    time.start();
+    for (int i = 0; i < cachedInstances.count(); ++i)
+      {
+      database.cachedTag(cachedInstances[i], cachedTags[i]);
+      }
+    memoryRates << cachedInstances.count() / elapsedSeconds(time);
+    }
+
+  QStringList members;
+  members << jsonMember("lookups", jsonNumber(cachedInstances.count()));
+  members << jsonMember("insertValuesPerSecond", jsonNumber(cachedInstances.count() / insertSeconds));
+  members << jsonMember("databaseLookupsPerSecond", jsonArray(databaseRates));
+  members << jsonMember("memoryLookupsPerSecond", jsonArray(memoryRates));
+  return jsonObject(members, 4);
+}
+
+//----------------------------------------------------------------------------
+/// C-FIND and C-GET against the dcmqrscp test server.
+static QString benchmarkNetwork(const QStringList& files, const QString& workDirectory,
+                                const ctkDICOMBenchmarkOptions& options)
+{
+  QStringList members;
+  if (!options.Network)
+    {
+    members << jsonMember("skipped", "true");
+    return jsonObject(members, 4);
+    }
+
+  ctkDICOMTester tester;
+  if (!options.DCMQRSCPExecutable.isEmpty())
+    {
+    tester.setDCMQRSCPExecutable(options.DCMQRSCPExecutable);
+    }
+  if (!options.DCMQRSCPConfigFile.isEmpty())
+    {
+    tester.setDCMQRSCPConfigFile(options.DCMQRSCPConfigFile);
+    }
+  if (!options.StoreSCUExecutable.isEmpty())
+    {
+    tester.setStoreSCUExecutable(options.StoreSCUExecutable);
+    }
+  if (!tester.startDCMQRSCP())
+    {
+    std::cerr << "Unable to start dcmqrscp" << std::endl;
+    members << jsonMember("error", jsonString("Unable to start dcmqrscp"));
+    return jsonObject(members, 4);
+    }
+
+  QTime time;
+  time.start();
+  bool stored = tester.storeData(files);
+  double storeSeconds = elapsedSeconds(time);
+
+  QList<double> findSeconds;
+  QList<double> getFilesPerSecond;
+  int studies = 0;
+  bool success = stored;
+  for (int run = 0; success && run < options.Repeat; ++run)
+    {
+    ctkDICOMDatabase queryDatabase;
+    queryDatabase.openDatabase(":memory:", "ctkDICOMBenchmark-query");
+    ctkDICOMQuery query;
+    query.setCallingAETitle("CTK_AE");
+    query.setCalledAETitle("CTK_AE");
+    query.setHost("localhost");
+    query.setPort(tester.dcmqrscpPort());
+    time.start();
+    success = query.query(queryDatabase);
+    findSeconds << elapsedSeconds(time);
+    studies = query.studyInstanceUIDQueried().count();
+
+    QString retrieveDatabaseFile = workDirectory + "/retrieve.sql";
+    QSharedPointer<ctkDICOMDatabase> retrieveDatabase(new ctkDICOMDatabase);
+    if (!openEmptyDatabase(*retrieveDatabase, retrieveDatabaseFile))
+      {
+      success = false;
+      break;
+      }
+    ctkDICOMRetrieve retrieve;
+    retrieve.setCallingAETitle("CTK_AE");
+    retrieve.setCalledAETitle("CTK_AE");
+    retrieve.setHost("localhost");
+    retrieve.setPort(tester.dcmqrscpPort());
+    retrieve.setDatabase(retrieveDatabase);
+    time.start();
+    foreach(const QString& study, query.studyInstanceUIDQueried())
+      {
+      success = retrieve.getStudy(study) && success;
+      }
+    getFilesPerSecond << retrieveDatabase->allFiles().count() / elapsedSeconds(time);
+    retrieveDatabase->closeDatabase();
+    QFile::remove(retrieveDatabaseFile);
+    }
+  tester.stopDCMQRSCP();
+
+  members << jsonMember("success", success ? "true" : "false");
+  members << jsonMember("storeFilesPerSecond", jsonNumber(files.count() / storeSeconds));
+  members << jsonMember("studies", jsonNumber(studies));
+  members << jsonMember("findSeconds", jsonArray(findSeconds));
+  members << jsonMember("getFilesPerSecond", jsonArray(getFilesPerSecond));
+  return jsonObject(members, 4);
+}
+
+/**
+  *
+*/
+int main(int argc, char** argv)
+{
+  QCoreApplication app(argc, argv);
+
+  ctkDICOMBenchmarkOptions options;
+  QStringList arguments = app.arguments();
+  if (arguments.contains("--help") || !parseArguments(arguments, options))
+    {
+    print_usage();
+    return EXIT_FAILURE;
+    }
+
+  // the tree is generated again to measure the indexing of files that
+  // are not in the page cache yet
+  if (!removeDirectory(options.Directory) || !QDir().mkpath(options.Directory))
+    {
+    std::cerr << "Unable to create " << qPrintable(options.Directory) << std::endl;
+    return EXIT_FAILURE;
+    }
+  QString dataDirectory = options.Directory + "/data";
+
+  QTime time;
+  time.start();
+  QStringList files = generateTree(dataDirectory, options);
+  double generateSeconds = elapsedSeconds(time);
+  if (files.isEmpty())
+    {
+    return EXIT_FAILURE;
+    }
+  qint64 bytes = 0;
+  foreach(const QString& file, files)
+    {
+    bytes += QFileInfo(file).size();
+    }
+
+  ctkDICOMDatabase database;
+  QString databaseFile = options.Directory + "/ctkDICOM.sql";
+  QStringList benchmarks;
+  QString result = benchmarkIndexer(database, databaseFile, dataDirectory, files.count(), options);
+  if (result.isEmpty())
+    {
+    return EXIT_FAILURE;
+    }
+  benchmarks << jsonMember("index", result);
+  benchmarks << jsonMember("model", benchmarkModel(database, options));
+  benchmarks << jsonMember("tagCache", benchmarkTagCache(database, options));
+  result = benchmarkInsert(database, databaseFile, files, options);
+  if (result.isEmpty())
+    {
+    return EXIT_FAILURE;
+    }
+  benchmarks << jsonMember("insert", result);
+  benchmarks << jsonMember("decode", benchmarkDecode(files, options));
+  benchmarks << jsonMember("network", benchmarkNetwork(files, options.Directory, options));
+  database.closeDatabase();
+
+  QStringList configuration;
+  configuration << jsonMember("patients", jsonNumber(options.Patients));
+  configuration << jsonMember("studiesPerPatient", jsonNumber(options.StudiesPerPatient));
+  configuration << jsonMember("seriesPerStudy", jsonNumber(options.SeriesPerStudy));
+  configuration << jsonMember("instancesPerSeries", jsonNumber(options.InstancesPerSeries));
+  configuration << jsonMember("rows", jsonNumber(options.Rows));
+  configuration << jsonMember("columns", jsonNumber(options.Columns));
+  configuration << jsonMember("frames", jsonNumber(options.Frames));
+  configuration << jsonMember("repeat", jsonNumber(options.Repeat));
+  configuration << jsonMember("files", jsonNumber(files.count()));
+  configuration << jsonMember("bytes", jsonNumber(bytes));
+  configuration << jsonMember("generateFilesPerSecond", jsonNumber(files.count() / generateSeconds));
+
+  QStringList report;
+  report << jsonMember("ctkVersion", jsonString(CTK_VERSION));
+  report << jsonMember("dcmtkVersion", jsonString(OFFIS_DCMTK_VERSION_STRING));
+  report << jsonMember("qtVersion", jsonString(qVersion()));
+  report << jsonMember("date", jsonString(QDateTime::currentDateTime().toString(Qt::ISODate)));
+  report << jsonMember("configuration", jsonObject(configuration, 2));
+  report << jsonMember("benchmarks", jsonObject(benchmarks, 2));
+
+  QFile output;
+  if (options.Output.isEmpty())
+    {
+    output.open(stdout, QIODevice::WriteOnly);
+    }
+  else
+    {
+    output.setFileName(options.Output);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+      {
+      std::cerr << "Unable to write " << qPrintable(options.Output) << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  QTextStream out(&output);
+  out << jsonObject(report, 0) << "\n";
+  return EXIT_SUCCESS;
+}
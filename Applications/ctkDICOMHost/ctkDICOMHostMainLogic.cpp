@@ -71,12 +71,13 @@ void ctkDICOMHostMainLogic::sendDataToHostedApp()
  if ((this->Host) && (this->HostControls->validAppFileName()) && (ValidSelection))
   {
     *Data = ctkDicomAppHosting::AvailableData(); // empty AvailableData structure (at least not with the same id...)
+    ctkDicomAvailableDataHelper::ctkDicomAvailableDataAccessor accessor(*Data);
     foreach (const QString &str, SelectedFiles) {
       if (str.isEmpty())
         continue;
       qDebug() << str;
 
-      ctkDicomAvailableDataHelper::addToAvailableData(*Data, 
+      ctkDicomAvailableDataHelper::addToAvailableData(accessor, 
         Host->objectLocatorCache(), 
         str);
     }
@@ -20,6 +20,7 @@
 
 // Qt includes
 #include <QCoreApplication>
+#include <QFile>
 #include <QProcess>
 
 // STD includes
@@ -57,6 +58,21 @@ int ctkDICOMIndexerAppTest1(int argc, char * argv [])
               << " returned " << res << std::endl;
     return res;
     }
+  // Parallel and resumable import, the second run skips all the files
+  QFile::remove("test.checkpoint");
+  for (int run = 0; run < 2; ++run)
+    {
+    parameters.clear();
+    parameters << "--add" << "--threads" << "2" << "--checkpoint" << "test.checkpoint"
+               << "--summary" << database << ".";
+    res = QProcess::execute(command, parameters);
+    if (res != EXIT_SUCCESS)
+      {
+      std::cerr << '\"' << qPrintable(command + " " + parameters.join(" ")) << '\"'
+                << " returned " << res << std::endl;
+      return res;
+      }
+    }
   parameters.clear();
   parameters << "--cleanup" << database;
   res = QProcess::execute(command, parameters);
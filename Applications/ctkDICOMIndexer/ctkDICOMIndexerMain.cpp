@@ -20,7 +20,14 @@
 
 // Qt includes
 #include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSet>
+#include <QStringList>
 #include <QTextStream>
+#include <QVariant>
 
 // CTK includes
 #include <ctkDICOMIndexer.h>
@@ -34,10 +41,18 @@
 void print_usage()
 {
   std::cerr << "Usage:\n";
-  std::cerr << "  1. ctkDICOMIndexer --add <database.db> <sourceDir> [destDir]\n";
+  std::cerr << "  1. ctkDICOMIndexer --add [options] <database.db> <sourceDir> [destDir]\n";
   std::cerr << "     Adds (or refreshes) sourceDir to the index of the database.\n";
   std::cerr << "     Creates the database if it is not valid..\n";
   std::cerr << "     If destDir is provided, images are copied there after import.\n";
+  std::cerr << "     Options:\n";
+  std::cerr << "       --threads <count>    Number of threads parsing the headers, the\n";
+  std::cerr << "                            database is written by a single thread.\n";
+  std::cerr << "                            Default is the number of cores.\n";
+  std::cerr << "       --checkpoint <file>  Append the committed files to <file> and skip\n";
+  std::cerr << "                            the files it lists, to resume an import.\n";
+  std::cerr << "       --summary            Print the throughput and the time spent in\n";
+  std::cerr << "                            each phase of the import.\n";
   std::cerr << "  2. ctkDICOMIndexer --init <database.db> [sqlScript]\n";
   std::cerr << "     Reinitialize the database. Uses default schema or the provided sqlScript file.\n";
   std::cerr << "  3. ctkDICOMIndexer --cleanup <database.db>\n";
@@ -46,6 +61,136 @@ void print_usage()
 }
 
 
+//----------------------------------------------------------------------------
+/// Files listed in the checkpoint file, one path per line.
+QSet<QString> readCheckpoint(const QString& checkpointFile)
+{
+  QSet<QString> indexedFiles;
+  QFile file(checkpointFile);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    return indexedFiles;
+  }
+  QTextStream in(&file);
+  in.setCodec("UTF-8");
+  while (!in.atEnd())
+  {
+    QString line = in.readLine();
+    if (!line.isEmpty())
+    {
+      indexedFiles.insert(line);
+    }
+  }
+  return indexedFiles;
+}
+
+//----------------------------------------------------------------------------
+void printSummary(QTextStream& out, ctkDICOMDatabase& database, int fileCount,
+                  int skippedCount, qint64 scanMs, qint64 indexMs)
+{
+  QVariantMap statistics = database.statistics();
+  out << "Summary:\n";
+  out << "  files found:        " << fileCount << "\n";
+  out << "  files skipped:      " << skippedCount << "\n";
+  out << "  instances inserted: " << statistics["insertedInstances"].toInt() << "\n";
+  out << "  scan:               " << scanMs / 1000. << " s\n";
+  out << "  index:              " << indexMs / 1000. << " s";
+  if (indexMs > 0)
+  {
+    out << " (" << (fileCount - skippedCount) * 1000. / indexMs << " files/s)";
+  }
+  out << "\n";
+  const char* phases[] = {"parse", "instanceCheck", "patient", "study", "series",
+                          "image", "fileCopy", "precache", "thumbnail", "commit"};
+  for (unsigned int i = 0; i < sizeof(phases) / sizeof(phases[0]); ++i)
+  {
+    QVariantMap phase = statistics[phases[i]].toMap();
+    // parse time is summed over the parser threads
+    out << "  " << QString(phases[i]).leftJustified(14) << phase["seconds"].toDouble()
+        << " s over " << phase["count"].toInt() << " calls\n";
+  }
+  out.flush();
+}
+
+//----------------------------------------------------------------------------
+/// Index the files of sourceDir in chunks. Each chunk is committed by
+/// addListOfFiles() before its files are appended to the checkpoint file,
+/// so that an interrupted import can be resumed.
+int addDirectory(QTextStream& out, ctkDICOMIndexer& indexer, ctkDICOMDatabase& database,
+                 const QString& sourceDir, const QString& destDir,
+                 const QString& checkpointFile, bool summary)
+{
+  if (summary)
+  {
+    database.setStatisticsEnabled(true);
+    database.resetStatistics();
+  }
+  QElapsedTimer timer;
+  timer.start();
+
+  // DICOMDIR are indexed from their directory records, at once
+  if (QDir(sourceDir).exists("DICOMDIR"))
+  {
+    indexer.addDirectory(database, sourceDir, destDir);
+    if (summary)
+    {
+      printSummary(out, database, 0, 0, 0, timer.elapsed());
+    }
+    return EXIT_SUCCESS;
+  }
+
+  QSet<QString> indexedFiles;
+  if (!checkpointFile.isEmpty())
+  {
+    indexedFiles = readCheckpoint(checkpointFile);
+  }
+  QStringList filesToIndex;
+  int fileCount = 0;
+  QDirIterator it(sourceDir, QDir::Files, QDirIterator::Subdirectories);
+  while (it.hasNext())
+  {
+    QString filePath = it.next();
+    ++fileCount;
+    if (!indexedFiles.contains(filePath))
+    {
+      filesToIndex << filePath;
+    }
+  }
+  const qint64 scanMs = timer.restart();
+
+  QFile checkpoint(checkpointFile);
+  QTextStream checkpointStream(&checkpoint);
+  checkpointStream.setCodec("UTF-8");
+  if (!checkpointFile.isEmpty() &&
+      !checkpoint.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+  {
+    std::cerr << "Can't open checkpoint file " << qPrintable(checkpointFile) << std::endl;
+    return EXIT_FAILURE;
+  }
+  // Without checkpoint, there is no need to commit in between
+  const int chunkSize = checkpointFile.isEmpty() ? filesToIndex.count() : 1000;
+  for (int start = 0; start < filesToIndex.count(); start += chunkSize)
+  {
+    QStringList chunk = filesToIndex.mid(start, chunkSize);
+    indexer.addListOfFiles(database, chunk, destDir);
+    if (checkpoint.isOpen())
+    {
+      foreach(const QString& filePath, chunk)
+      {
+        checkpointStream << filePath << "\n";
+      }
+      checkpointStream.flush();
+      checkpoint.flush();
+    }
+  }
+  if (summary)
+  {
+    printSummary(out, database, fileCount, fileCount - filesToIndex.count(),
+                 scanMs, timer.elapsed());
+  }
+  return EXIT_SUCCESS;
+}
+
 /**
   *
 */
@@ -69,17 +214,38 @@ int main(int argc, char** argv)
   {
     if (std::string("--add") == argv[1])
     {
+      QStringList arguments = app.arguments().mid(2);
+      QString checkpointFile;
+      bool summary = false;
+      QStringList positionalArguments;
+      while (!arguments.isEmpty())
       {
-        myCTK.openDatabase( argv[2] );
-        if (argc > 4)
+        QString argument = arguments.takeFirst();
+        if (argument == "--threads" && !arguments.isEmpty())
         {
-          idx.addDirectory(myCTK,argv[3],argv[4]);
+          idx.setNumberOfParserThreads(arguments.takeFirst().toInt());
+        }
+        else if (argument == "--checkpoint" && !arguments.isEmpty())
+        {
+          checkpointFile = arguments.takeFirst();
+        }
+        else if (argument == "--summary")
+        {
+          summary = true;
         }
         else
         {
-          idx.addDirectory(myCTK,argv[3]);
+          positionalArguments << argument;
         }
       }
+      if (positionalArguments.count() < 2)
+      {
+        print_usage();
+        return EXIT_FAILURE;
+      }
+      myCTK.openDatabase(positionalArguments[0]);
+      return addDirectory(out, idx, myCTK, positionalArguments[1],
+                          positionalArguments.value(2), checkpointFile, summary);
     }
     else if (std::string("--init") == argv[1])
     {
@@ -34,6 +34,7 @@
 #include <ctkPluginException.h>
 #include <ctkPluginFramework.h>
 #include <ctkPluginContext.h>
+#include <service/debug/ctkFrameworkProfiler.h>
 
 #include <QApplication>
 #include <QMainWindow>
@@ -42,6 +43,7 @@
 #include <QUrl>
 #include <QSettings>
 #include <QCloseEvent>
+#include <QDateTime>
 
 #define SETTINGS_WND_GEOM "mainwindow.geom"
 #define SETTINGS_WND_STATE "mainwindow.state"
@@ -128,6 +130,27 @@ ctkPluginBrowser::ctkPluginBrowser(ctkPluginFramework* framework)
   ui.pluginToolBar->addAction(startPluginAction);
   ui.pluginToolBar->addAction(stopPluginAction);
 
+  profileFrameworkAction = new QAction("Profile Framework", this);
+  profileFrameworkAction->setCheckable(true);
+  dumpProfilingDataAction = new QAction("Dump Profiling Data", this);
+
+  connect(profileFrameworkAction, SIGNAL(toggled(bool)), this, SLOT(profileFramework(bool)));
+  connect(dumpProfilingDataAction, SIGNAL(triggered()), this, SLOT(dumpProfilingData()));
+
+  if (ctkFrameworkProfiler* profiler = getFrameworkProfiler())
+  {
+    profileFrameworkAction->setChecked(profiler->isEnabled());
+  }
+  else
+  {
+    profileFrameworkAction->setEnabled(false);
+    dumpProfilingDataAction->setEnabled(false);
+  }
+
+  ui.pluginToolBar->addSeparator();
+  ui.pluginToolBar->addAction(profileFrameworkAction);
+  ui.pluginToolBar->addAction(dumpProfilingDataAction);
+
   QSettings settings;
   if(settings.contains(SETTINGS_WND_GEOM))
   {
@@ -265,6 +288,33 @@ void ctkPluginBrowser::stopPlugin()
   plugin->stop();
 }
 
+ctkFrameworkProfiler* ctkPluginBrowser::getFrameworkProfiler() const
+{
+  ctkPluginContext* context = framework->getPluginContext();
+  ctkServiceReference ref = context->getServiceReference<ctkFrameworkProfiler>();
+  return ref ? context->getService<ctkFrameworkProfiler>(ref) : 0;
+}
+
+void ctkPluginBrowser::profileFramework(bool enabled)
+{
+  if (ctkFrameworkProfiler* profiler = getFrameworkProfiler())
+  {
+    profiler->setEnabled(enabled);
+  }
+}
+
+void ctkPluginBrowser::dumpProfilingData()
+{
+  ctkFrameworkProfiler* profiler = getFrameworkProfiler();
+  if (!profiler) return;
+
+  QString dump = profiler->dump();
+  qDebug().nospace() << qPrintable(dump);
+
+  QString time = QDateTime::currentDateTime().toString(Qt::ISODate);
+  editors->openEditor(QString("/profiling/") + time, dump.toUtf8(), QString("Profiling ") + time);
+}
+
 void ctkPluginBrowser::closeEvent(QCloseEvent *closeEvent)
 {
   QSettings settings;
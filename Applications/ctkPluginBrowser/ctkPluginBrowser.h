@@ -35,6 +35,7 @@
 
 
 class ctkPluginFramework;
+struct ctkFrameworkProfiler;
 
 class ctkPluginBrowser : public QMainWindow
 {
@@ -59,12 +60,16 @@ private Q_SLOTS:
   void startPluginNow();
   void stopPlugin();
 
+  void profileFramework(bool enabled);
+  void dumpProfilingData();
+
 private:
 
   void closeEvent(QCloseEvent* closeEvent);
 
   void updatePluginToolbar(QSharedPointer<ctkPlugin> plugin);
   void startPlugin(ctkPlugin::StartOptions options);
+  ctkFrameworkProfiler* getFrameworkProfiler() const;
 
   QMap<ctkPluginEvent::Type, QString> pluginEventTypeToString;
 
@@ -76,6 +81,8 @@ private:
   QAction* startPluginNowAction;
   QAction* startPluginAction;
   QAction* stopPluginAction;
+  QAction* profileFrameworkAction;
+  QAction* dumpProfilingDataAction;
 };
 
 #endif // CTKPLUGINBROWSER_H
@@ -62,6 +62,8 @@ ctkXnatTreeBrowserMainWindow::ctkXnatTreeBrowserMainWindow(QWidget *parent) :
 
   this->connect(ui->loginButton, SIGNAL(clicked()), SLOT(loginButtonPushed()));
   this->connect(ui->treeView, SIGNAL(clicked(const QModelIndex&)), SLOT(itemSelected(const QModelIndex&)));
+  // The children of a collapsed item are not requested any longer
+  m_TreeModel->connect(ui->treeView, SIGNAL(collapsed(const QModelIndex&)), SLOT(cancelFetch(const QModelIndex&)));
   this->connect(ui->downloadButton, SIGNAL(clicked()), SLOT(downloadButtonClicked()));
   this->connect(ui->addResourceButton, SIGNAL(clicked()), SLOT(addResourceClicked()));
   this->connect(ui->uploadFileButton, SIGNAL(clicked()), SLOT(uploadFileClicked()));
@@ -0,0 +1,29 @@
+
+
+#! Usage:
+#! \code
+#! SIMPLE_BENCHMARK(<testname> [argument1 ...])
+#! \endcode
+#!
+#! This macro adds a QTest based benchmark like SIMPLE_TEST does. The QTest
+#! results, the benchmark results included, are written as XML to
+#! <CTK_BENCHMARK_OUTPUT_DIR>/<testname>.xml.
+#!
+#! Variables named KIT and CTK_BENCHMARK_OUTPUT_DIR are expected to be defined
+#! in the current scope. KIT variable usually matches the value of PROJECT_NAME.
+#!
+#! The macro associates the labels KIT and Benchmark to the test, the
+#! Benchmarks target runs the tests labeled Benchmark.
+#!
+#! \sa SIMPLE_TEST
+#!
+#! \ingroup CMakeUtilities
+macro(SIMPLE_BENCHMARK testname)
+  if("${CTK_BENCHMARK_OUTPUT_DIR}" STREQUAL "")
+    message(FATAL_ERROR "error: CTK_BENCHMARK_OUTPUT_DIR variable is not set !")
+  endif()
+
+  SIMPLE_TEST(${testname} -xml -o ${CTK_BENCHMARK_OUTPUT_DIR}/${testname}.xml ${ARGN})
+  set_property(TEST ${testname} APPEND PROPERTY LABELS Benchmark)
+endmacro()
+
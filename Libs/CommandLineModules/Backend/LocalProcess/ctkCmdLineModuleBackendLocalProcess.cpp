@@ -24,6 +24,7 @@
 #include "ctkCmdLineModuleDescription.h"
 #include "ctkCmdLineModuleFrontend.h"
 #include "ctkCmdLineModuleFuture.h"
+#include "ctkCmdLineModuleLibraryTask_p.h"
 #include "ctkCmdLineModuleParameter.h"
 #include "ctkCmdLineModuleParameterGroup.h"
 #include "ctkCmdLineModuleProcessTask.h"
@@ -33,6 +34,9 @@
 
 #include "ctkUtils.h"
 #include <iostream>
+#include <QHash>
+#include <QLibrary>
+#include <QMutex>
 #include <QProcess>
 #include <QUrl>
 
@@ -40,13 +44,66 @@
 struct ctkCmdLineModuleBackendLocalProcessPrivate
 {
 
+  // A shared library module, which stays loaded once it has been resolved
+  struct Library
+  {
+    Library()
+      : EntryPoint(NULL), XmlDescription(NULL), XmlDescriptionFunction(NULL)
+    {}
+
+    ctkCmdLineModuleLibraryTask::EntryPoint EntryPoint;
+    const char* XmlDescription;
+    char* (*XmlDescriptionFunction)();
+  };
+
   int m_TimeoutForXMLRetrieval;
 
+  QMutex m_LibraryMutex;
+  QHash<QString, Library> m_Libraries;
+
   ctkCmdLineModuleBackendLocalProcessPrivate()
     : m_TimeoutForXMLRetrieval(0) // use the value from the module manager
   {
   }
 
+  static bool isSharedLibrary(const QUrl& location)
+  {
+    return QLibrary::isLibrary(location.toLocalFile());
+  }
+
+  // Loads the shared library module at location, or throws a ctkCmdLineModuleRunException
+  Library library(const QUrl& location)
+  {
+    QString fileName = location.toLocalFile();
+
+    QMutexLocker lock(&m_LibraryMutex);
+    QHash<QString, Library>::const_iterator iter = m_Libraries.find(fileName);
+    if (iter != m_Libraries.end())
+    {
+      return iter.value();
+    }
+
+    // QLibrary does not unload the library when it is destroyed
+    QLibrary lib(fileName);
+    if (!lib.load())
+    {
+      throw ctkCmdLineModuleRunException(location, 0, lib.errorString());
+    }
+
+    Library result;
+    result.EntryPoint = reinterpret_cast<ctkCmdLineModuleLibraryTask::EntryPoint>(lib.resolve("ModuleEntryPoint"));
+    result.XmlDescription = reinterpret_cast<const char*>(lib.resolve("XMLModuleDescription"));
+    result.XmlDescriptionFunction = reinterpret_cast<char* (*)()>(lib.resolve("GetXMLModuleDescription"));
+    if (result.EntryPoint == NULL ||
+        (result.XmlDescription == NULL && result.XmlDescriptionFunction == NULL))
+    {
+      throw ctkCmdLineModuleRunException(location, 0, "The shared library does not export the "
+                                         "ModuleEntryPoint and XMLModuleDescription symbols.");
+    }
+    m_Libraries.insert(fileName, result);
+    return result;
+  }
+
   QString normalizeFlag(const QString& flag) const
   {
     return flag.trimmed().remove(QRegExp("^-*"));
@@ -175,6 +232,13 @@ qint64 ctkCmdLineModuleBackendLocalProcess::timeStamp(const QUrl &location) cons
 //----------------------------------------------------------------------------
 QByteArray ctkCmdLineModuleBackendLocalProcess::rawXmlDescription(const QUrl &location, int timeout)
 {
+  if (d->isSharedLibrary(location))
+  {
+    ctkCmdLineModuleBackendLocalProcessPrivate::Library library = d->library(location);
+    const char* xml = library.XmlDescription ? library.XmlDescription : library.XmlDescriptionFunction();
+    return QByteArray(xml);
+  }
+
   QProcess process;
   process.setReadChannel(QProcess::StandardOutput);
   process.start(location.toLocalFile(), QStringList("--xml"));
@@ -201,6 +265,14 @@ ctkCmdLineModuleFuture ctkCmdLineModuleBackendLocalProcess::run(ctkCmdLineModule
 {
   QStringList args = d->commandLineArguments(frontend->values(), frontend->moduleReference().description());
 
+  if (d->isSharedLibrary(frontend->location()))
+  {
+    ctkCmdLineModuleLibraryTask* libraryTask =
+        new ctkCmdLineModuleLibraryTask(d->library(frontend->location()).EntryPoint,
+                                        frontend->location().toLocalFile(), args);
+    return libraryTask->start();
+  }
+
   // Instances of ctkCmdLineModuleProcessTask are auto-deleted by the
   // thread pool.
   ctkCmdLineModuleProcessTask* moduleProcess =
@@ -208,6 +280,31 @@ ctkCmdLineModuleFuture ctkCmdLineModuleBackendLocalProcess::run(ctkCmdLineModule
   return moduleProcess->start();
 }
 
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleBackendLocalProcess::runScheduled(ctkCmdLineModuleFrontend* frontend,
+                                                                         ctkCmdLineModuleScheduler* scheduler)
+{
+  if (scheduler == NULL)
+  {
+    return this->run(frontend);
+  }
+
+  QStringList args = d->commandLineArguments(frontend->values(), frontend->moduleReference().description());
+
+  if (d->isSharedLibrary(frontend->location()))
+  {
+    ctkCmdLineModuleLibraryTask* libraryTask =
+        new ctkCmdLineModuleLibraryTask(d->library(frontend->location()).EntryPoint,
+                                        frontend->location().toLocalFile(), args);
+    return libraryTask->start(scheduler);
+  }
+
+  // Instances of ctkCmdLineModuleProcessTask are deleted by the scheduler.
+  ctkCmdLineModuleProcessTask* moduleProcess =
+      new ctkCmdLineModuleProcessTask(frontend->location().toLocalFile(), args);
+  return moduleProcess->start(scheduler);
+}
+
 //----------------------------------------------------------------------------
 void ctkCmdLineModuleBackendLocalProcess::setTimeOutForXMLRetrieval(int timeOut)
 {
@@ -48,6 +48,14 @@ struct ctkCmdLineModuleBackendLocalProcessPrivate;
  *
  * The ctkCmdLineModuleFuture returned by run() allows cancelation by killing the running
  * process. On Unix systems, it also allows to pause it.
+ *
+ * A location which is a shared library (see QLibrary::isLibrary()) is handled as a
+ * "shared object" module exporting the \c ModuleEntryPoint function and either the
+ * \c XMLModuleDescription string or the \c GetXMLModuleDescription function. Such a
+ * module is loaded once with QLibrary and its entry point is called in a thread of
+ * QThreadPool::globalInstance(), which avoids the process start-up. Its runs cannot be
+ * canceled or paused once they have started; the output of the module goes to the
+ * standard output of the application and the library is not reloaded when it changes.
  */
 class CTK_CMDLINEMODULEBACKENDLP_EXPORT ctkCmdLineModuleBackendLocalProcess : public ctkCmdLineModuleBackend
 {
@@ -78,8 +86,9 @@ public:
    * @param location The location URL of the module for which to get the XML description.
    * @return The raw XML description.
    *
-   * This method always calls the executable with a \c &ndash;&ndash;xml argument and returns
-   * the complete data emitted on the standard output channel.
+   * This method calls the executable with a \c &ndash;&ndash;xml argument and returns
+   * the complete data emitted on the standard output channel. For a shared library
+   * module, it returns the description exported by the library.
    */
   virtual QByteArray rawXmlDescription(const QUrl& location, int timeout);
 
@@ -90,6 +99,17 @@ public:
    */
   virtual ctkCmdLineModuleFuture run(ctkCmdLineModuleFrontend *frontend);
 
+  /**
+   * @brief Run a front-end for this module in a local process started by \c scheduler.
+   * @param frontend The front-end to run.
+   * @param scheduler The scheduler of the module manager.
+   * @return A future object for communicating with the running process.
+   *
+   * Unlike run(ctkCmdLineModuleFrontend*), no thread is blocked while the process runs.
+   */
+  virtual ctkCmdLineModuleFuture runScheduled(ctkCmdLineModuleFrontend* frontend,
+                                              ctkCmdLineModuleScheduler* scheduler);
+
   /**
    * @brief Setter for the number of milliseconds to wait when retrieving xml.
    * @param timeOut in milliseconds.
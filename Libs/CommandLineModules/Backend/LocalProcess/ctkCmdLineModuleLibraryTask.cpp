@@ -0,0 +1,172 @@
+/*=============================================================================
+  
+  Library: CTK
+  
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+    
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+  
+=============================================================================*/
+
+#include "ctkCmdLineModuleLibraryTask_p.h"
+
+#include "ctkCmdLineModuleFuture.h"
+#include "ctkCmdLineModuleRunException.h"
+
+#include <QFile>
+#include <QThreadPool>
+#include <QUrl>
+
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <time.h>
+#endif
+
+namespace {
+
+//----------------------------------------------------------------------------
+qint64 threadCpuTime()
+{
+#ifdef Q_OS_LINUX
+  struct timespec ts;
+  if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+  {
+    return static_cast<qint64>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+  }
+#endif
+  return -1;
+}
+
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleLibraryTask::ctkCmdLineModuleLibraryTask(EntryPoint entryPoint, const QString& location,
+                                                         const QStringList& args)
+  : ModuleEntryPoint(entryPoint)
+  , Location(location)
+  , Args(args)
+  , Scheduler(NULL)
+{
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleLibraryTask::start()
+{
+  this->setRunnable(this);
+  this->setProgressRange(0,0);
+  this->QueueTimer.start();
+  this->reportStarted();
+  ctkCmdLineModuleFuture future = this->future();
+  QThreadPool::globalInstance()->start(this, /*m_priority*/ 0);
+  return future;
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleLibraryTask::start(ctkCmdLineModuleScheduler* scheduler)
+{
+  this->setProgressRange(0,0);
+  this->QueueTimer.start();
+  this->reportStarted();
+  ctkCmdLineModuleFuture future = this->future();
+  // The task may be finished and deleted as soon as it is scheduled
+  scheduler->schedule(this, QUrl::fromLocalFile(this->Location));
+  return future;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleLibraryTask::execute(ctkCmdLineModuleScheduler* scheduler)
+{
+  // The scheduler deletes the task, not the thread pool
+  this->Scheduler = scheduler;
+  this->setAutoDelete(false);
+  scheduler->threadPool()->start(this, /*m_priority*/ 0);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleLibraryTask::cancelTask()
+{
+  // A running entry point cannot be interrupted, only a pending run is skipped
+  this->cancel();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleLibraryTask::run()
+{
+  if (!this->isCanceled())
+  {
+    // The module gets its own copy of the arguments, which it may modify
+    QList<QByteArray> args;
+    args << QFile::encodeName(this->Location);
+    foreach(const QString& arg, this->Args)
+    {
+      args << arg.toLocal8Bit();
+    }
+    std::vector<char*> argv;
+    for (int i = 0; i < args.size(); ++i)
+    {
+      argv.push_back(args[i].data());
+    }
+    argv.push_back(NULL);
+
+    ctkCmdLineModuleRunMetrics metrics;
+    metrics.QueueWaitTime = this->QueueTimer.elapsed();
+    metrics.SpawnTime = 0;
+    QElapsedTimer runTimer;
+    runTimer.start();
+    const qint64 cpuTimeBefore = threadCpuTime();
+
+    QString excMsg;
+    int exitCode = 0;
+    try
+    {
+      exitCode = this->ModuleEntryPoint(args.size(), &argv[0]);
+      if (exitCode != 0)
+      {
+        excMsg = QString("The module entry point returned %1.").arg(exitCode);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      excMsg = e.what();
+    }
+    catch (...)
+    {
+      excMsg = "Unknown exception.";
+    }
+
+    metrics.WallTime = runTimer.elapsed();
+    if (cpuTimeBefore >= 0)
+    {
+      metrics.CpuTime = threadCpuTime() - cpuTimeBefore;
+    }
+    this->reportMetrics(metrics);
+
+    if (!excMsg.isNull())
+    {
+      this->reportException(ctkCmdLineModuleRunException(QUrl::fromLocalFile(this->Location), exitCode, excMsg));
+    }
+
+    this->setProgressRange(0,1);
+    this->setProgressValue(1);
+  }
+
+  this->reportFinished();
+
+  if (this->Scheduler)
+  {
+    // Deletes this task
+    this->Scheduler->taskFinished(this);
+  }
+}
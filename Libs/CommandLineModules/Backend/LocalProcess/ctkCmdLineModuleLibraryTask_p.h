@@ -0,0 +1,80 @@
+/*=============================================================================
+  
+  Library: CTK
+  
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+    
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+  
+=============================================================================*/
+
+#ifndef CTKCMDLINEMODULELIBRARYTASK_P_H
+#define CTKCMDLINEMODULELIBRARYTASK_P_H
+
+#include "ctkCmdLineModuleFutureInterface.h"
+#include "ctkCmdLineModuleScheduler.h"
+
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QStringList>
+
+/**
+ * \class ctkCmdLineModuleLibraryTask
+ * \brief Implements ctkCmdLineModuleFutureInterface to run the entry point of
+ * a shared library module in a thread of QThreadPool::globalInstance().
+ *
+ * When the task is queued in a ctkCmdLineModuleScheduler, it is started on the
+ * thread pool of the scheduler once the scheduler has a free slot.
+ *
+ * No process is spawned, so the reported spawn time is 0. The CPU time of the
+ * thread running the entry point is measured on Linux, the peak resident set
+ * size of the shared process is not reported.
+ *
+ * \ingroup CommandLineModulesBackendLocalProcess_API
+ */
+class ctkCmdLineModuleLibraryTask
+    : public ctkCmdLineModuleFutureInterface, public QRunnable, public ctkCmdLineModuleScheduledTask
+{
+
+public:
+
+  /**
+   * @brief The \c ModuleEntryPoint function exported by a shared library module.
+   */
+  typedef int (*EntryPoint)(int argc, char* argv[]);
+
+  ctkCmdLineModuleLibraryTask(EntryPoint entryPoint, const QString& location, const QStringList& args);
+
+  ctkCmdLineModuleFuture start();
+
+  /**
+   * @brief Queue the task in \c scheduler, which deletes it once the module has returned.
+   */
+  ctkCmdLineModuleFuture start(ctkCmdLineModuleScheduler* scheduler);
+
+  void run();
+
+  virtual void execute(ctkCmdLineModuleScheduler* scheduler);
+  virtual void cancelTask();
+
+private:
+
+  EntryPoint ModuleEntryPoint;
+  const QString Location;
+  const QStringList Args;
+  ctkCmdLineModuleScheduler* Scheduler;
+  QElapsedTimer QueueTimer;
+};
+
+#endif // CTKCMDLINEMODULELIBRARYTASK_P_H
@@ -0,0 +1,73 @@
+/*=============================================================================
+  
+  Library: CTK
+  
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+    
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+  
+=============================================================================*/
+
+#include "ctkCmdLineModuleProcessRunner_p.h"
+
+#include "ctkCmdLineModuleProcessTask.h"
+#include "ctkCmdLineModuleProcessWatcher_p.h"
+#include "ctkCmdLineModuleScheduler.h"
+
+#include <QDebug>
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleProcessRunner::ctkCmdLineModuleProcessRunner(ctkCmdLineModuleProcessTask* task,
+                                                             ctkCmdLineModuleScheduler* scheduler)
+  : Task(task)
+  , Scheduler(scheduler)
+  , Finished(false)
+{
+  Process.setReadChannel(QProcess::StandardOutput);
+  connect(&Process, SIGNAL(finished(int)), SLOT(processFinished()));
+  connect(&Process, SIGNAL(error(QProcess::ProcessError)), SLOT(processFinished()));
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleProcessRunner::~ctkCmdLineModuleProcessRunner()
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleProcessRunner::start(const QString& location, const QStringList& args)
+{
+  qDebug() << "ctkCmdLineModuleProcessRunner::start() starting location=" << location << ", args=" << args;
+
+  // The process may report an error, which deletes the task, before start() returns
+  ProcessWatcher.reset(new ctkCmdLineModuleProcessWatcher(Process, location, *Task));
+  Process.start(location, args, QIODevice::ReadOnly | QIODevice::Text);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleProcessRunner::processFinished()
+{
+  // A crashed process reports both an error and its end
+  if (Finished) return;
+  Finished = true;
+
+  ProcessWatcher->reportMetrics();
+  Task->reportProcessFinished(Process);
+
+  // The watcher refers to the task, which is deleted by the scheduler
+  ProcessWatcher.reset();
+  Scheduler->taskFinished(Task);
+  Task = NULL;
+
+  this->deleteLater();
+}
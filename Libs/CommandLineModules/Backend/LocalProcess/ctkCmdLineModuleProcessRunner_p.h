@@ -0,0 +1,65 @@
+/*=============================================================================
+  
+  Library: CTK
+  
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+    
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+  
+=============================================================================*/
+
+#ifndef CTKCMDLINEMODULEPROCESSRUNNER_P_H
+#define CTKCMDLINEMODULEPROCESSRUNNER_P_H
+
+#include <QObject>
+#include <QProcess>
+#include <QScopedPointer>
+#include <QStringList>
+
+class ctkCmdLineModuleProcessTask;
+class ctkCmdLineModuleProcessWatcher;
+class ctkCmdLineModuleScheduler;
+
+/**
+ * \class ctkCmdLineModuleProcessRunner
+ * \brief Runs the process of a scheduled ctkCmdLineModuleProcessTask without blocking
+ * a thread, the process is watched by the event loop of the thread of the runner.
+ * \ingroup CommandLineModulesBackendLocalProcess_API
+ */
+class ctkCmdLineModuleProcessRunner : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  ctkCmdLineModuleProcessRunner(ctkCmdLineModuleProcessTask* task, ctkCmdLineModuleScheduler* scheduler);
+  ~ctkCmdLineModuleProcessRunner();
+
+  void start(const QString& location, const QStringList& args);
+
+protected Q_SLOTS:
+
+  void processFinished();
+
+private:
+
+  ctkCmdLineModuleProcessTask* Task;
+  ctkCmdLineModuleScheduler* Scheduler;
+  QProcess Process;
+  // Destroyed before the process it watches
+  QScopedPointer<ctkCmdLineModuleProcessWatcher> ProcessWatcher;
+  bool Finished;
+};
+
+#endif // CTKCMDLINEMODULEPROCESSRUNNER_P_H
@@ -20,15 +20,18 @@
 =============================================================================*/
 
 #include "ctkCmdLineModuleProcessTask.h"
+#include "ctkCmdLineModuleProcessRunner_p.h"
 #include "ctkCmdLineModuleProcessWatcher_p.h"
 #include "ctkCmdLineModuleRunException.h"
 #include "ctkCmdLineModuleXmlProgressWatcher.h"
 #include "ctkCmdLineModuleFuture.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QEventLoop>
 #include <QThreadPool>
 #include <QProcess>
+#include <QUrl>
 
 //----------------------------------------------------------------------------
 struct ctkCmdLineModuleProcessTaskPrivate
@@ -38,8 +41,16 @@ struct ctkCmdLineModuleProcessTaskPrivate
     , Args(args)
   {}
 
+  void reportQueueWaitTime(ctkCmdLineModuleFutureInterface* futureInterface)
+  {
+    ctkCmdLineModuleRunMetrics metrics;
+    metrics.QueueWaitTime = QueueTimer.elapsed();
+    futureInterface->reportMetrics(metrics);
+  }
+
   const QString Location;
   const QStringList Args;
+  QElapsedTimer QueueTimer;
 };
 
 //----------------------------------------------------------------------------
@@ -61,12 +72,47 @@ ctkCmdLineModuleProcessTask::~ctkCmdLineModuleProcessTask()
 ctkCmdLineModuleFuture ctkCmdLineModuleProcessTask::start()
 {
   this->setRunnable(this);
+  d->QueueTimer.start();
   this->reportStarted();
   ctkCmdLineModuleFuture future = this->future();
   QThreadPool::globalInstance()->start(this, /*m_priority*/ 0);
   return future;
 }
 
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleProcessTask::start(ctkCmdLineModuleScheduler* scheduler)
+{
+  d->QueueTimer.start();
+  this->reportStarted();
+  ctkCmdLineModuleFuture future = this->future();
+  // The task may be finished and deleted as soon as it is scheduled
+  scheduler->schedule(this, QUrl::fromLocalFile(d->Location));
+  return future;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleProcessTask::execute(ctkCmdLineModuleScheduler* scheduler)
+{
+  if (this->isCanceled())
+  {
+    this->reportFinished();
+    scheduler->taskFinished(this);
+    return;
+  }
+
+  d->reportQueueWaitTime(this);
+
+  // The runner deletes itself once the process has finished.
+  ctkCmdLineModuleProcessRunner* runner = new ctkCmdLineModuleProcessRunner(this, scheduler);
+  runner->start(d->Location, d->Args);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleProcessTask::cancelTask()
+{
+  this->cancel();
+}
+
 //----------------------------------------------------------------------------
 void ctkCmdLineModuleProcessTask::run()
 {
@@ -76,6 +122,8 @@ void ctkCmdLineModuleProcessTask::run()
     return;
   }
 
+  d->reportQueueWaitTime(this);
+
   QProcess process;
   process.setReadChannel(QProcess::StandardOutput);
 
@@ -85,13 +133,20 @@ void ctkCmdLineModuleProcessTask::run()
 
   qDebug() << "ctkCmdLineModuleProcessTask::run() starting d->Location=" << d->Location << ", d->Args=" << d->Args;
 
-  process.start(d->Location, d->Args, QIODevice::ReadOnly | QIODevice::Text);
-
+  // Created before the process is started to measure its spawn time
   ctkCmdLineModuleProcessWatcher progressWatcher(process, d->Location, *this);
-  Q_UNUSED(progressWatcher)
+
+  process.start(d->Location, d->Args, QIODevice::ReadOnly | QIODevice::Text);
 
   localLoop.exec();
 
+  progressWatcher.reportMetrics();
+  this->reportProcessFinished(process);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleProcessTask::reportProcessFinished(QProcess& process)
+{
   if (process.error() != QProcess::UnknownError || process.exitCode() != 0)
   {
     this->reportException(ctkCmdLineModuleRunException(d->Location, process.exitCode(), process.errorString()));
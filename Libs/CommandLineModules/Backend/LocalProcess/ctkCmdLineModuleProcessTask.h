@@ -23,6 +23,7 @@
 #define CTKCMDLINEMODULEPROCESSTASK_H
 
 #include "ctkCmdLineModuleFutureInterface.h"
+#include "ctkCmdLineModuleScheduler.h"
 
 #include "ctkCommandLineModulesBackendLocalProcessExport.h"
 
@@ -41,10 +42,15 @@ struct ctkCmdLineModuleProcessTaskPrivate;
  * \class ctkCmdLineModuleProcessTask
  * \brief Implements ctkCmdLineModuleFutureInterface to enabling
  * running a command line application asynchronously.
+ *
+ * The task is either run by QThreadPool::globalInstance(), in which case it blocks
+ * a pool thread while the process runs, or by a ctkCmdLineModuleScheduler which
+ * watches the process from its event thread.
+ *
  * \ingroup CommandLineModulesBackendLocalProcess_API
  */
 class CTK_CMDLINEMODULEBACKENDLP_EXPORT ctkCmdLineModuleProcessTask
-    : public ctkCmdLineModuleFutureInterface, public QRunnable
+    : public ctkCmdLineModuleFutureInterface, public QRunnable, public ctkCmdLineModuleScheduledTask
 {
 
 public:
@@ -54,10 +60,22 @@ public:
 
   ctkCmdLineModuleFuture start();
 
+  /**
+   * @brief Queue the task in \c scheduler, which deletes it once the process has finished.
+   */
+  ctkCmdLineModuleFuture start(ctkCmdLineModuleScheduler* scheduler);
+
   void run();
 
+  virtual void execute(ctkCmdLineModuleScheduler* scheduler);
+  virtual void cancelTask();
+
 private:
 
+  friend class ctkCmdLineModuleProcessRunner;
+
+  void reportProcessFinished(QProcess& process);
+
   QScopedPointer<ctkCmdLineModuleProcessTaskPrivate> d;
 
 };
@@ -30,12 +30,21 @@
 #include <signal.h>
 #endif
 
+#ifdef Q_OS_LINUX
+#include <QFile>
+#include <unistd.h>
+#endif
+
 //----------------------------------------------------------------------------
 ctkCmdLineModuleProcessWatcher::ctkCmdLineModuleProcessWatcher(QProcess& process, const QString& location,
                                                                ctkCmdLineModuleFutureInterface &futureInterface)
   : process(process), location(location), futureInterface(futureInterface), processXmlWatcher(&process),
-    processPaused(false), progressValue(0)
+    processPaused(false), progressValue(0), spawnTime(-1), cpuTime(-1), peakResidentSetSize(-1)
 {
+  // The watcher is created before the process is started
+  runTimer.start();
+  connect(&process, SIGNAL(started()), SLOT(processStarted()));
+
   // The reported float value in the range [0.0,1.0] for the progress is scaled to [0,1000].
   // Value 1001 is reserved for the last "filter-end" output, which is reported as a progress event.
   // Value 1002 is reserved internally to report process termination.
@@ -61,6 +70,74 @@ ctkCmdLineModuleProcessWatcher::ctkCmdLineModuleProcessWatcher(QProcess& process
   pollPauseTimer.start(500);
 #endif
   futureWatcher.setFuture(futureInterface.future());
+
+#ifdef Q_OS_LINUX
+  connect(&resourceTimer, SIGNAL(timeout()), SLOT(sampleResourceUsage()));
+#endif
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleProcessWatcher::reportMetrics()
+{
+  resourceTimer.stop();
+
+  ctkCmdLineModuleRunMetrics metrics;
+  metrics.SpawnTime = spawnTime;
+  metrics.WallTime = runTimer.elapsed();
+  metrics.CpuTime = cpuTime;
+  metrics.PeakResidentSetSize = peakResidentSetSize;
+  futureInterface.reportMetrics(metrics);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleProcessWatcher::processStarted()
+{
+  spawnTime = runTimer.elapsed();
+#ifdef Q_OS_LINUX
+  this->sampleResourceUsage();
+  resourceTimer.start(100);
+#endif
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleProcessWatcher::sampleResourceUsage()
+{
+#ifdef Q_OS_LINUX
+  const QString procDir = QString("/proc/%1/").arg(process.pid());
+
+  // The fields after the command name, which may contain spaces, start
+  // with the state. utime and stime are the 14th and 15th field.
+  QFile statFile(procDir + "stat");
+  if (statFile.open(QIODevice::ReadOnly))
+  {
+    QByteArray stat = statFile.readAll();
+    QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() > 12)
+    {
+      static const long ticksPerSecond = ::sysconf(_SC_CLK_TCK);
+      qint64 ticks = fields[11].toLongLong() + fields[12].toLongLong();
+      if (ticksPerSecond > 0 && ticks * 1000 / ticksPerSecond > cpuTime)
+      {
+        cpuTime = ticks * 1000 / ticksPerSecond;
+      }
+    }
+  }
+
+  QFile statusFile(procDir + "status");
+  if (statusFile.open(QIODevice::ReadOnly))
+  {
+    foreach(const QByteArray& line, statusFile.readAll().split('\n'))
+    {
+      if (line.startsWith("VmHWM:"))
+      {
+        // reported in kB
+        qint64 peak = line.mid(6).trimmed().split(' ').front().toLongLong() * 1024;
+        if (peak > peakResidentSetSize) peakResidentSetSize = peak;
+        break;
+      }
+    }
+  }
+#endif
 }
 
 //----------------------------------------------------------------------------
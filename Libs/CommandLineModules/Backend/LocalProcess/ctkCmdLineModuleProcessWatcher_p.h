@@ -26,6 +26,7 @@
 #include "ctkCmdLineModuleFutureInterface.h"
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QTimer>
 
@@ -36,6 +37,11 @@ class QProcess;
 /**
  * \class ctkCmdLineModuleProcessWatcher
  * \brief Provides progress updates using QFutureWatcher
+ *
+ * The watcher also measures the spawn and wall time of the process. On Linux, the CPU
+ * time and peak resident set size are sampled from /proc while the process runs, so
+ * they miss at most the last sampling interval.
+ *
  * \ingroup CommandLineModulesBackendLocalProcess_API
  */
 class ctkCmdLineModuleProcessWatcher : public QObject
@@ -47,8 +53,17 @@ public:
   ctkCmdLineModuleProcessWatcher(QProcess& process, const QString& location,
                                  ctkCmdLineModuleFutureInterface& futureInterface);
 
+  /**
+   * @brief Report the metrics measured so far to the future interface, to be
+   * called once the process has finished.
+   */
+  void reportMetrics();
+
 protected Q_SLOTS:
 
+  void processStarted();
+  void sampleResourceUsage();
+
   void filterStarted(const QString& name, const QString& comment);
   void filterProgress(float progress, const QString &comment);
   void filterResult(const QString& parameter, const QString& value);
@@ -76,6 +91,12 @@ private:
   QTimer pollPauseTimer;
   bool processPaused;
   int progressValue;
+
+  QElapsedTimer runTimer;
+  QTimer resourceTimer;
+  qint64 spawnTime;
+  qint64 cpuTime;
+  qint64 peakResidentSetSize;
 };
 
 #endif // CTKCMDLINEMODULEPROCESSWATCHER_P_H
@@ -0,0 +1,397 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkCmdLineModuleBatch.h"
+#include "ctkCmdLineModuleBackend.h"
+#include "ctkCmdLineModuleFrontend.h"
+#include "ctkCmdLineModuleFrontendFactory.h"
+#include "ctkCmdLineModuleFuture.h"
+#include "ctkCmdLineModuleFutureWatcher.h"
+#include "ctkCmdLineModuleManager.h"
+#include "ctkCmdLineModuleReference.h"
+#include "ctkCmdLineModuleRunException.h"
+
+#include "ctkTest.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QRunnable>
+#include <QStringList>
+#include <QThreadPool>
+#include <QUrl>
+
+#if (QT_VERSION < QT_VERSION_CHECK(4,7,0))
+extern int qHash(const QUrl& url);
+#endif
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Adds one to "value" and returns it in "sum", or copies the "input" file to the
+// "output" file, appending the module name.
+class TaskMockUp : public ctkCmdLineModuleFutureInterface, public QRunnable
+{
+public:
+
+  TaskMockUp(const QUrl& location, const QHash<QString, QVariant>& values)
+    : Location(location), Values(values)
+  {}
+
+  ctkCmdLineModuleFuture start()
+  {
+    this->setProgressRange(0,0);
+    this->reportStarted();
+    ctkCmdLineModuleFuture future = this->future();
+    QThreadPool::globalInstance()->start(this);
+    return future;
+  }
+
+  void run()
+  {
+    QString name = Location.host();
+    if (name == "fail")
+    {
+      this->reportException(ctkCmdLineModuleRunException(Location, 1, "Failure"));
+    }
+    else if (name == "add")
+    {
+      this->reportResult(ctkCmdLineModuleResult("sum", Values["value"].toInt() + 1));
+    }
+    else
+    {
+      QByteArray data;
+      QFile input(Values["input"].toString());
+      if (input.open(QIODevice::ReadOnly))
+      {
+        data = input.readAll();
+      }
+      QFile output(Values["output"].toString());
+      output.open(QIODevice::WriteOnly);
+      output.write(data + name.toLatin1());
+    }
+    this->reportFinished();
+  }
+
+private:
+
+  QUrl Location;
+  QHash<QString, QVariant> Values;
+};
+
+//-----------------------------------------------------------------------------
+class BackendMockUp : public ctkCmdLineModuleBackend
+{
+
+public:
+
+  void addModule(const QUrl& location, const QByteArray& xml)
+  {
+    this->m_UrlToXml[location] = xml;
+  }
+
+  virtual QString name() const { return "Mockup"; }
+  virtual QString description() const { return "Test Mock-up"; }
+  virtual QList<QString> schemes() const { return QList<QString>() << "test"; }
+  virtual qint64 timeStamp(const QUrl& /*location*/) const { return 0; }
+
+  virtual QByteArray rawXmlDescription(const QUrl& location, int /*timeout*/)
+  {
+    return m_UrlToXml[location];
+  }
+
+protected:
+
+  virtual ctkCmdLineModuleFuture run(ctkCmdLineModuleFrontend* frontend)
+  {
+    TaskMockUp* task = new TaskMockUp(frontend->location(), frontend->values());
+    return task->start();
+  }
+
+private:
+
+  QHash<QUrl, QByteArray> m_UrlToXml;
+};
+
+//-----------------------------------------------------------------------------
+class FrontendMockUp : public ctkCmdLineModuleFrontend
+{
+public:
+
+  FrontendMockUp(const ctkCmdLineModuleReference& moduleRef)
+    : ctkCmdLineModuleFrontend(moduleRef)
+  {}
+
+  virtual QObject* guiHandle() const { return NULL; }
+
+  virtual QVariant value(const QString& parameter, int /*role*/ = LocalResourceRole) const
+  {
+    return Values[parameter];
+  }
+
+  virtual void setValue(const QString& parameter, const QVariant& value, int /*role*/ = DisplayRole)
+  {
+    Values[parameter] = value;
+  }
+
+private:
+
+  QHash<QString, QVariant> Values;
+};
+
+//-----------------------------------------------------------------------------
+class FrontendFactoryMockUp : public ctkCmdLineModuleFrontendFactory
+{
+public:
+
+  virtual QString name() const { return "Mockup"; }
+  virtual QString description() const { return "Test Mock-up"; }
+
+  virtual ctkCmdLineModuleFrontend* create(const ctkCmdLineModuleReference& moduleRef)
+  {
+    return new FrontendMockUp(moduleRef);
+  }
+};
+
+//-----------------------------------------------------------------------------
+void waitForFinished(const ctkCmdLineModuleFuture& future)
+{
+  ctkCmdLineModuleFutureWatcher watcher;
+  QEventLoop loop;
+  QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+  watcher.setFuture(future);
+  if (!future.isFinished())
+  {
+    loop.exec();
+  }
+}
+
+}
+
+//-----------------------------------------------------------------------------
+class ctkCmdLineModuleBatchTester : public QObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+
+  void initTestCase();
+
+  void testSweep();
+  void testPipeline();
+  void testFilePipeline();
+  void testFailure();
+  void testCycle();
+
+private:
+
+  BackendMockUp backend;
+  FrontendFactoryMockUp frontendFactory;
+  QScopedPointer<ctkCmdLineModuleManager> manager;
+};
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchTester::initTestCase()
+{
+  QByteArray addXml = "<executable>\n"
+                      "  <title>Add</title>\n"
+                      "  <description>Adds one</description>\n"
+                      "  <parameters>\n"
+                      "    <label>bla</label>\n"
+                      "    <description>bla</description>\n"
+                      "    <integer>\n"
+                      "      <name>value</name>\n"
+                      "      <flag>i</flag>\n"
+                      "      <description>bla</description>\n"
+                      "      <label>bla</label>\n"
+                      "    </integer>\n"
+                      "    <integer>\n"
+                      "      <name>sum</name>\n"
+                      "      <index>1000</index>\n"
+                      "      <description>bla</description>\n"
+                      "      <label>bla</label>\n"
+                      "      <channel>output</channel>\n"
+                      "    </integer>\n"
+                      "  </parameters>\n"
+                      "</executable>\n";
+
+  QByteArray copyXml = "<executable>\n"
+                       "  <title>Copy</title>\n"
+                       "  <description>Copies a file</description>\n"
+                       "  <parameters>\n"
+                       "    <label>bla</label>\n"
+                       "    <description>bla</description>\n"
+                       "    <file fileExtensions=\".txt\">\n"
+                       "      <name>input</name>\n"
+                       "      <index>0</index>\n"
+                       "      <description>bla</description>\n"
+                       "      <label>bla</label>\n"
+                       "      <channel>input</channel>\n"
+                       "    </file>\n"
+                       "    <file fileExtensions=\".txt\">\n"
+                       "      <name>output</name>\n"
+                       "      <index>1</index>\n"
+                       "      <description>bla</description>\n"
+                       "      <label>bla</label>\n"
+                       "      <channel>output</channel>\n"
+                       "    </file>\n"
+                       "  </parameters>\n"
+                       "</executable>\n";
+
+  backend.addModule(QUrl("test://add"), addXml);
+  backend.addModule(QUrl("test://fail"), addXml);
+  backend.addModule(QUrl("test://a"), copyXml);
+  backend.addModule(QUrl("test://b"), copyXml);
+
+  manager.reset(new ctkCmdLineModuleManager());
+  manager->registerBackend(&backend);
+  foreach(const QString& module, QStringList() << "add" << "fail" << "a" << "b")
+  {
+    QVERIFY(manager->registerModule(QUrl("test://" + module)));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchTester::testSweep()
+{
+  ctkCmdLineModuleBatch batch(manager.data(), &frontendFactory);
+  QList<QVariant> values;
+  values << 1 << 2 << 3 << 4;
+  QList<int> jobs = batch.addSweep(manager->moduleReference(QUrl("test://add")), "value", values);
+  QCOMPARE(jobs.size(), 4);
+  QCOMPARE(batch.jobCount(), 4);
+
+  ctkCmdLineModuleFuture future = batch.run();
+  waitForFinished(future);
+
+  QVERIFY(!future.isCanceled());
+  QCOMPARE(future.progressValue(), 4);
+  for (int i = 0; i < jobs.size(); ++i)
+  {
+    ctkCmdLineModuleFuture jobFuture = batch.frontend(jobs[i])->future();
+    QCOMPARE(jobFuture.resultCount(), 1);
+    QCOMPARE(jobFuture.resultAt(0).value().toInt(), values[i].toInt() + 1);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchTester::testPipeline()
+{
+  ctkCmdLineModuleReference addRef = manager->moduleReference(QUrl("test://add"));
+  QHash<QString, QVariant> values;
+  values["value"] = 1;
+
+  ctkCmdLineModuleBatch batch(manager.data(), &frontendFactory);
+  int first = batch.addJob(addRef, values);
+  int second = batch.addJob(addRef);
+  int third = batch.addJob(addRef);
+  batch.addDependency(third, "value", second, "sum");
+  batch.addDependency(second, "value", first, "sum");
+
+  ctkCmdLineModuleFuture future = batch.run();
+  waitForFinished(future);
+
+  QVERIFY(!future.isCanceled());
+  QCOMPARE(batch.frontend(third)->future().resultAt(0).value().toInt(), 4);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchTester::testFilePipeline()
+{
+  QString outputFile = QDir::temp().filePath("ctkCmdLineModuleBatchTester.txt");
+  QFile::remove(outputFile);
+  QHash<QString, QVariant> values;
+  values["output"] = outputFile;
+
+  ctkCmdLineModuleBatch batch(manager.data(), &frontendFactory);
+  batch.setTemporaryDirectory(QDir::tempPath());
+  int first = batch.addJob(manager->moduleReference(QUrl("test://a")));
+  int second = batch.addJob(manager->moduleReference(QUrl("test://b")), values);
+  batch.addDependency(second, "input", first, "output");
+
+  ctkCmdLineModuleFuture future = batch.run();
+  QString intermediateFile = batch.frontend(first)->value("output").toString();
+  QVERIFY(intermediateFile.startsWith(QDir::tempPath()));
+  QVERIFY(intermediateFile.endsWith(".txt"));
+  QCOMPARE(batch.frontend(second)->value("input").toString(), intermediateFile);
+  waitForFinished(future);
+
+  QVERIFY(!future.isCanceled());
+  QVERIFY(!QFile::exists(intermediateFile));
+  QFile output(outputFile);
+  QVERIFY(output.open(QIODevice::ReadOnly));
+  QCOMPARE(output.readAll(), QByteArray("ab"));
+  output.remove();
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchTester::testFailure()
+{
+  ctkCmdLineModuleBatch batch(manager.data(), &frontendFactory);
+  int failing = batch.addJob(manager->moduleReference(QUrl("test://fail")));
+  int dependent = batch.addJob(manager->moduleReference(QUrl("test://add")));
+  batch.addDependency(dependent, failing);
+
+  ctkCmdLineModuleFuture future = batch.run();
+  waitForFinished(future);
+
+  QVERIFY(future.isCanceled());
+  // The dependent job was skipped
+  QCOMPARE(batch.frontend(dependent)->future().resultCount(), 0);
+  try
+  {
+    future.waitForFinished();
+    QFAIL("The error of the failing job was not reported");
+  }
+  catch (const ctkCmdLineModuleRunException& e)
+  {
+    QCOMPARE(e.errorCode(), 1);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchTester::testCycle()
+{
+  ctkCmdLineModuleReference addRef = manager->moduleReference(QUrl("test://add"));
+  ctkCmdLineModuleBatch batch(manager.data(), &frontendFactory);
+  int first = batch.addJob(addRef);
+  int second = batch.addJob(addRef);
+  batch.addDependency(first, second);
+  batch.addDependency(second, first);
+
+  try
+  {
+    batch.run();
+    QFAIL("Started a batch with a cycle");
+  }
+  catch (const ctkInvalidArgumentException&)
+  {
+  }
+}
+
+
+// ----------------------------------------------------------------------------
+CTK_TEST_MAIN(ctkCmdLineModuleBatchTest)
+#include "moc_ctkCmdLineModuleBatchTest.cpp"
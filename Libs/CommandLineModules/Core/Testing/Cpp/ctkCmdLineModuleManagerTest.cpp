@@ -23,8 +23,12 @@
 #include "ctkCmdLineModuleManager.h"
 #include "ctkCmdLineModuleBackend.h"
 #include "ctkException.h"
+#include "ctkCmdLineModuleFrontend.h"
 #include "ctkCmdLineModuleFuture.h"
 #include "ctkCmdLineModuleReferenceResult.h"
+#include "ctkCmdLineModuleDescription.h"
+#include "ctkCmdLineModuleParameter.h"
+#include "ctkCmdLineModuleParameterGroup.h"
 #include <ctkCmdLineModuleConcurrentHelpers.h>
 #include <ctkCmdLineModuleTimeoutException.h>
 
@@ -35,6 +39,8 @@
 #include <QBuffer>
 #include <QDataStream>
 #include <QDebug>
+#include <QDir>
+#include <QFile>
 
 #if (QT_VERSION < QT_VERSION_CHECK(4,7,0))
 extern int qHash(const QUrl& url);
@@ -92,11 +98,33 @@ public:
 
 protected:
 
-  virtual ctkCmdLineModuleFuture run(ctkCmdLineModuleFrontend* /*frontend*/)
+  // Returns "param" + 1 as "sum" and writes it to the "output" file
+  virtual ctkCmdLineModuleFuture run(ctkCmdLineModuleFrontend* frontend)
   {
-    return ctkCmdLineModuleFuture();
+    ++m_RunCount;
+    int sum = frontend->value("param").toInt() + 1;
+    QString outputFile = frontend->value("output").toString();
+    if (!outputFile.isEmpty())
+    {
+      QFile output(outputFile);
+      output.open(QIODevice::WriteOnly);
+      output.write(QByteArray::number(sum));
+    }
+
+    ctkCmdLineModuleFutureInterface futureInterface;
+    futureInterface.reportStarted();
+    futureInterface.reportResult(ctkCmdLineModuleResult("sum", sum));
+    ctkCmdLineModuleFuture future = futureInterface.future();
+    futureInterface.reportFinished();
+    return future;
   }
 
+public:
+
+  int m_RunCount;
+
+  BackendMockUp() : m_RunCount(0) {}
+
 private:
 
   QHash<QUrl, qint64> m_UrlToTimestamp;
@@ -105,6 +133,32 @@ private:
   QHash<QUrl, QByteArray> m_UrlToXml;
 };
 
+//-----------------------------------------------------------------------------
+class FrontendMockUp : public ctkCmdLineModuleFrontend
+{
+public:
+
+  FrontendMockUp(const ctkCmdLineModuleReference& moduleRef)
+    : ctkCmdLineModuleFrontend(moduleRef)
+  {}
+
+  virtual QObject* guiHandle() const { return NULL; }
+
+  virtual QVariant value(const QString& parameter, int /*role*/ = LocalResourceRole) const
+  {
+    return Values[parameter];
+  }
+
+  virtual void setValue(const QString& parameter, const QVariant& value, int /*role*/ = DisplayRole)
+  {
+    Values[parameter] = value;
+  }
+
+private:
+
+  QHash<QString, QVariant> Values;
+};
+
 }
 
 //-----------------------------------------------------------------------------
@@ -122,6 +176,9 @@ private Q_SLOTS:
   void testSkipValidation();
   void testTimeoutHandling();
   void testCaching();
+  void testTimeoutCaching();
+  void testDescriptionCaching();
+  void testResultCaching();
 
 private:
 
@@ -396,6 +453,201 @@ void ctkCmdLineModuleManagerTester::testCaching()
   }
 }
 
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleManagerTester::testTimeoutCaching()
+{
+  QUrl location("test://validXml");
+
+  {
+    BackendMockUp backend;
+    backend.addModule(location, validXml, 1000);
+    backend.setTimestamp(location, 1);
+
+    ctkCmdLineModuleManager manager(ctkCmdLineModuleManager::STRICT_VALIDATION, cachePath);
+    manager.setTimeOutForXMLRetrieval(500);
+    manager.registerBackend(&backend);
+
+    try
+    {
+      manager.registerModule(location);
+      QFAIL("ctkCmdLineModuleTimeoutException expected");
+    }
+    catch (const ctkCmdLineModuleTimeoutException&)
+    {}
+    QVERIFY(backend.xmlRetrievalCount(location) == 1);
+  }
+
+  // The time-out is remembered across managers sharing the cache
+  {
+    BackendMockUp backend;
+    backend.addModule(location, validXml, 1000);
+    backend.setTimestamp(location, 1);
+
+    ctkCmdLineModuleManager manager(ctkCmdLineModuleManager::STRICT_VALIDATION, cachePath);
+    manager.setTimeOutForXMLRetrieval(500);
+    manager.registerBackend(&backend);
+
+    try
+    {
+      manager.registerModule(location);
+      QFAIL("ctkCmdLineModuleTimeoutException expected");
+    }
+    catch (const ctkCmdLineModuleTimeoutException&)
+    {}
+    QVERIFY(backend.xmlRetrievalCount(location) == 0);
+
+    // A modified module is retried
+    backend.setTimestamp(location, 2);
+    try
+    {
+      manager.registerModule(location);
+      QFAIL("ctkCmdLineModuleTimeoutException expected");
+    }
+    catch (const ctkCmdLineModuleTimeoutException&)
+    {}
+    QVERIFY(backend.xmlRetrievalCount(location) == 1);
+
+    // So is a module given more time
+    manager.setTimeOutForXMLRetrieval(2000);
+    QVERIFY(manager.registerModule(location));
+    QVERIFY(backend.xmlRetrievalCount(location) == 2);
+  }
+}
+
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleManagerTester::testDescriptionCaching()
+{
+  QUrl location("test://validXml");
+
+  {
+    BackendMockUp backend;
+    backend.addModule(location, validXml);
+    backend.setTimestamp(location, 1);
+
+    ctkCmdLineModuleManager manager(ctkCmdLineModuleManager::STRICT_VALIDATION, cachePath);
+    manager.registerBackend(&backend);
+
+    ctkCmdLineModuleReference ref = manager.registerModule(location);
+    QVERIFY(ref);
+    QCOMPARE(ref.description().title(), QString("My Filter"));
+  }
+
+  // The parsed description is restored from the cache
+  {
+    BackendMockUp backend;
+    backend.addModule(location, validXml);
+    backend.setTimestamp(location, 1);
+
+    ctkCmdLineModuleManager manager(ctkCmdLineModuleManager::STRICT_VALIDATION, cachePath);
+    manager.registerBackend(&backend);
+
+    ctkCmdLineModuleReference ref = manager.registerModule(location);
+    QVERIFY(ref);
+    QVERIFY(backend.xmlRetrievalCount(location) == 0);
+
+    ctkCmdLineModuleDescription description = ref.description();
+    QCOMPARE(description.title(), QString("My Filter"));
+    QCOMPARE(description.description(), QString("Awesome filter"));
+    QCOMPARE(description.parameterGroups().size(), 1);
+    QVERIFY(description.hasParameter("param"));
+    QCOMPARE(description.parameter("param").flag(), QString("i"));
+  }
+}
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleManagerTester::testResultCaching()
+{
+  QByteArray xml = "<executable>\n"
+                   "  <title>My Filter</title>\n"
+                   "  <description>Awesome filter</description>\n"
+                   "  <parameters>\n"
+                   "    <label>bla</label>\n"
+                   "    <description>bla</description>\n"
+                   "    <integer>\n"
+                   "      <name>param</name>\n"
+                   "      <flag>i</flag>\n"
+                   "      <description>bla</description>\n"
+                   "      <label>bla</label>\n"
+                   "    </integer>\n"
+                   "    <file>\n"
+                   "      <name>output</name>\n"
+                   "      <index>0</index>\n"
+                   "      <description>bla</description>\n"
+                   "      <label>bla</label>\n"
+                   "      <channel>output</channel>\n"
+                   "    </file>\n"
+                   "  </parameters>\n"
+                   "</executable>\n";
+
+  QUrl location("test://resultCaching");
+  BackendMockUp backend;
+  backend.addModule(location, xml);
+
+  ctkCmdLineModuleManager manager(ctkCmdLineModuleManager::STRICT_VALIDATION, cachePath);
+  manager.registerBackend(&backend);
+  QVERIFY(!manager.isResultCacheEnabled());
+  manager.setResultCacheEnabled(true);
+  QVERIFY(manager.isResultCacheEnabled());
+
+  ctkCmdLineModuleReference ref = manager.registerModule(location);
+  QVERIFY(ref);
+
+  QString outputFile = QDir::temp().filePath("ctkCmdLineModuleManagerTester_output.txt");
+  FrontendMockUp frontend(ref);
+  frontend.setValue("param", 1);
+  frontend.setValue("output", outputFile);
+
+  // The result is recorded once the watcher of the run reports its end
+  ctkCmdLineModuleFuture future = manager.run(&frontend);
+  for (int i = 0; i < 100 && manager.resultCacheCount() == 0; ++i)
+  {
+    QTest::qWait(10);
+  }
+  QCOMPARE(manager.resultCacheCount(), 1);
+  QCOMPARE(manager.resultCacheMisses(), 1);
+  QCOMPARE(manager.resultCacheHits(), 0);
+  QVERIFY(manager.resultCacheSize() > 0);
+  QCOMPARE(backend.m_RunCount, 1);
+
+  // The same run is served from the cache, including its output file
+  QVERIFY(QFile::remove(outputFile));
+  future = manager.run(&frontend);
+  QVERIFY(future.isFinished());
+  QCOMPARE(backend.m_RunCount, 1);
+  QCOMPARE(manager.resultCacheHits(), 1);
+  QCOMPARE(future.resultCount(), 1);
+  QCOMPARE(future.resultAt(0).value().toInt(), 2);
+  QFile output(outputFile);
+  QVERIFY(output.open(QIODevice::ReadOnly));
+  QCOMPARE(output.readAll(), QByteArray("2"));
+  output.close();
+
+  // Other values run the module again
+  frontend.setValue("param", 2);
+  future = manager.run(&frontend);
+  for (int i = 0; i < 100 && manager.resultCacheCount() == 1; ++i)
+  {
+    QTest::qWait(10);
+  }
+  QCOMPARE(backend.m_RunCount, 2);
+  QCOMPARE(manager.resultCacheMisses(), 2);
+  QCOMPARE(manager.resultCacheCount(), 2);
+
+  // The least recently used run is evicted
+  manager.setResultCacheMaximumSize(1);
+  QCOMPARE(manager.resultCacheCount(), 1);
+  frontend.setValue("param", 1);
+  manager.run(&frontend);
+  QCOMPARE(manager.resultCacheMisses(), 3);
+
+  manager.clearResultCache();
+  QCOMPARE(manager.resultCacheCount(), 0);
+  QCOMPARE(manager.resultCacheHits(), 0);
+  QFile::remove(outputFile);
+
+  // Wait for the recorder of the last run
+  QTest::qWait(50);
+}
+
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(ctkCmdLineModuleManagerTest)
 #include "moc_ctkCmdLineModuleManagerTest.cpp"
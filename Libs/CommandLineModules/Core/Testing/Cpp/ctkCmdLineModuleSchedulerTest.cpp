@@ -0,0 +1,279 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkCmdLineModuleScheduler.h"
+
+#include "ctkTest.h"
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QStringList>
+#include <QTime>
+#include <QUrl>
+
+namespace {
+
+// Records the order in which the tasks are executed
+struct TaskLog
+{
+  QMutex Mutex;
+  QStringList Executed;
+  QList<ctkCmdLineModuleScheduledTask*> Running;
+};
+
+class TaskMockUp : public ctkCmdLineModuleScheduledTask
+{
+
+public:
+
+  TaskMockUp(const QString& name, TaskLog& log)
+    : m_Name(name)
+    , m_Log(log)
+    , m_Scheduler(0)
+    , m_Canceled(false)
+  {}
+
+  virtual void execute(ctkCmdLineModuleScheduler* scheduler)
+  {
+    {
+      QMutexLocker lock(&m_Log.Mutex);
+      if (!m_Canceled)
+      {
+        m_Log.Executed << m_Name;
+        m_Log.Running << this;
+        m_Scheduler = scheduler;
+        return;
+      }
+    }
+    scheduler->taskFinished(this);
+  }
+
+  virtual void cancelTask()
+  {
+    ctkCmdLineModuleScheduler* scheduler = 0;
+    {
+      QMutexLocker lock(&m_Log.Mutex);
+      m_Canceled = true;
+      m_Log.Running.removeAll(this);
+      scheduler = m_Scheduler;
+    }
+    // A running task finishes as soon as it is canceled
+    if (scheduler)
+    {
+      scheduler->taskFinished(this);
+    }
+  }
+
+private:
+
+  QString m_Name;
+  TaskLog& m_Log;
+  ctkCmdLineModuleScheduler* m_Scheduler;
+  bool m_Canceled;
+};
+
+bool waitForExecutedCount(TaskLog& log, int count)
+{
+  QTime waitTime;
+  waitTime.start();
+  while (waitTime.elapsed() < 5000)
+  {
+    {
+      QMutexLocker lock(&log.Mutex);
+      if (log.Executed.size() >= count) return true;
+    }
+    QTest::qWait(10);
+  }
+  return false;
+}
+
+ctkCmdLineModuleScheduledTask* takeRunning(TaskLog& log)
+{
+  QMutexLocker lock(&log.Mutex);
+  return log.Running.takeFirst();
+}
+
+}
+
+// ----------------------------------------------------------------------------
+class ctkCmdLineModuleSchedulerTester : public QObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+
+  void testMaximumConcurrentTasks();
+  void testPriority();
+  void testCost();
+  void testModuleConcurrencyLimit();
+  void testBackendConcurrencyLimit();
+};
+
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleSchedulerTester::testMaximumConcurrentTasks()
+{
+  TaskLog log;
+  ctkCmdLineModuleScheduler scheduler;
+  scheduler.setMaximumConcurrentTasks(2);
+  QCOMPARE(scheduler.maximumConcurrentTasks(), 2);
+
+  QUrl location("mockup:module");
+  for (int i = 0; i < 5; ++i)
+  {
+    scheduler.schedule(new TaskMockUp(QString::number(i), log), location);
+  }
+
+  QVERIFY(waitForExecutedCount(log, 2));
+  QCOMPARE(scheduler.runningTaskCount(), 2);
+  QCOMPARE(scheduler.pendingTaskCount(), 3);
+
+  scheduler.taskFinished(takeRunning(log));
+  QVERIFY(waitForExecutedCount(log, 3));
+  QCOMPARE(scheduler.runningTaskCount(), 2);
+  QCOMPARE(scheduler.pendingTaskCount(), 2);
+
+  QCOMPARE(log.Executed, QStringList() << "0" << "1" << "2");
+
+  // The remaining tasks are canceled by the destructor
+}
+
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleSchedulerTester::testPriority()
+{
+  TaskLog log;
+  ctkCmdLineModuleScheduler scheduler;
+  scheduler.setMaximumConcurrentTasks(1);
+
+  QUrl lowLocation("mockup:low");
+  QUrl highLocation("mockup:high");
+  scheduler.setPriority(highLocation, 10);
+  QCOMPARE(scheduler.priority(highLocation), 10);
+  QCOMPARE(scheduler.priority(lowLocation), 0);
+
+  scheduler.schedule(new TaskMockUp("low1", log), lowLocation);
+  QVERIFY(waitForExecutedCount(log, 1));
+
+  scheduler.schedule(new TaskMockUp("low2", log), lowLocation);
+  scheduler.schedule(new TaskMockUp("high1", log), highLocation);
+  scheduler.schedule(new TaskMockUp("high2", log), highLocation);
+
+  for (int i = 2; i <= 4; ++i)
+  {
+    scheduler.taskFinished(takeRunning(log));
+    QVERIFY(waitForExecutedCount(log, i));
+  }
+  scheduler.taskFinished(takeRunning(log));
+
+  QCOMPARE(log.Executed, QStringList() << "low1" << "high1" << "high2" << "low2");
+  QCOMPARE(scheduler.runningTaskCount(), 0);
+  QCOMPARE(scheduler.pendingTaskCount(), 0);
+}
+
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleSchedulerTester::testCost()
+{
+  TaskLog log;
+  ctkCmdLineModuleScheduler scheduler;
+  scheduler.setMaximumConcurrentTasks(3);
+
+  QUrl location("mockup:module");
+  QUrl heavyLocation("mockup:heavy");
+  scheduler.setCost(heavyLocation, 5);
+  QCOMPARE(scheduler.cost(heavyLocation), 5);
+
+  scheduler.schedule(new TaskMockUp("light", log), location);
+  scheduler.schedule(new TaskMockUp("heavy", log), heavyLocation);
+  QVERIFY(waitForExecutedCount(log, 1));
+
+  // The heavy task waits for the light one, then runs alone
+  QTest::qWait(50);
+  QCOMPARE(scheduler.runningTaskCount(), 1);
+  scheduler.taskFinished(takeRunning(log));
+  QVERIFY(waitForExecutedCount(log, 2));
+
+  scheduler.schedule(new TaskMockUp("light2", log), location);
+  QTest::qWait(50);
+  QCOMPARE(scheduler.runningTaskCount(), 1);
+  QCOMPARE(scheduler.pendingTaskCount(), 1);
+  scheduler.taskFinished(takeRunning(log));
+  QVERIFY(waitForExecutedCount(log, 3));
+}
+
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleSchedulerTester::testModuleConcurrencyLimit()
+{
+  TaskLog log;
+  ctkCmdLineModuleScheduler scheduler;
+  scheduler.setMaximumConcurrentTasks(4);
+
+  QUrl gpuLocation("mockup:gpu");
+  QUrl location("mockup:module");
+  scheduler.setModuleConcurrencyLimit(gpuLocation, 1);
+  QCOMPARE(scheduler.moduleConcurrencyLimit(gpuLocation), 1);
+  QCOMPARE(scheduler.moduleConcurrencyLimit(location), 0);
+
+  // The second gpu run waits, without holding back the other module
+  scheduler.schedule(new TaskMockUp("gpu1", log), gpuLocation);
+  scheduler.schedule(new TaskMockUp("gpu2", log), gpuLocation);
+  scheduler.schedule(new TaskMockUp("light1", log), location);
+  scheduler.schedule(new TaskMockUp("light2", log), location);
+  QVERIFY(waitForExecutedCount(log, 3));
+  QTest::qWait(50);
+  QCOMPARE(scheduler.runningTaskCount(), 3);
+  QCOMPARE(scheduler.pendingTaskCount(), 1);
+  QCOMPARE(log.Executed, QStringList() << "gpu1" << "light1" << "light2");
+
+  scheduler.taskFinished(takeRunning(log));
+  QVERIFY(waitForExecutedCount(log, 4));
+  QCOMPARE(log.Executed.last(), QString("gpu2"));
+  QCOMPARE(scheduler.pendingTaskCount(), 0);
+}
+
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleSchedulerTester::testBackendConcurrencyLimit()
+{
+  TaskLog log;
+  ctkCmdLineModuleScheduler scheduler;
+  scheduler.setMaximumConcurrentTasks(4);
+
+  scheduler.setBackendConcurrencyLimit("mockup", 2);
+  QCOMPARE(scheduler.backendConcurrencyLimit("mockup"), 2);
+  QCOMPARE(scheduler.backendConcurrencyLimit("other"), 0);
+
+  scheduler.schedule(new TaskMockUp("a", log), QUrl("mockup:a"));
+  scheduler.schedule(new TaskMockUp("b", log), QUrl("mockup:b"));
+  scheduler.schedule(new TaskMockUp("c", log), QUrl("mockup:c"));
+  scheduler.schedule(new TaskMockUp("other", log), QUrl("other:module"));
+  QVERIFY(waitForExecutedCount(log, 3));
+  QTest::qWait(50);
+  QCOMPARE(log.Executed, QStringList() << "a" << "b" << "other");
+  QCOMPARE(scheduler.pendingTaskCount(), 1);
+
+  // Raising the limit starts the pending run
+  scheduler.setBackendConcurrencyLimit("mockup", 0);
+  QVERIFY(waitForExecutedCount(log, 4));
+  QCOMPARE(scheduler.runningTaskCount(), 4);
+}
+
+// ----------------------------------------------------------------------------
+CTK_TEST_MAIN(ctkCmdLineModuleSchedulerTest)
+#include "moc_ctkCmdLineModuleSchedulerTest.cpp"
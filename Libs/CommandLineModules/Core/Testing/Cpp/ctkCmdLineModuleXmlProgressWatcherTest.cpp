@@ -30,6 +30,7 @@
 #include <QBuffer>
 #include <QDataStream>
 #include <QDebug>
+#include <QSignalSpy>
 
 
 namespace {
@@ -95,6 +96,8 @@ private Q_SLOTS:
 
   void testSignalsAndValues();
   void testMalformedXml();
+  void testProgressInterval();
+  void testOutputSink();
 };
 
 //-----------------------------------------------------------------------------
@@ -192,6 +195,107 @@ void ctkCmdLineModuleXmlProgressWatcherTester::testMalformedXml()
   QCOMPARE(signalTester.accumulatedProgress, 0.5f);
 }
 
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleXmlProgressWatcherTester::testProgressInterval()
+{
+  // Test data
+  QByteArray filterStart = "<filter-start>\n"
+                             "<filter-name>My Filter</filter-name>\n"
+                             "<filter-comment>Awesome filter</filter-comment>\n"
+                           "</filter-start>\n";
+  QString filterProgress = "<filter-progress>%1</filter-progress>\n";
+  QByteArray filterEnd = "<filter-end>\n"
+                           "<filter-name>My Filter</filter-name>\n"
+                         "</filter-end>";
+
+  QBuffer buffer;
+  buffer.open(QIODevice::ReadWrite);
+  ctkCmdLineModuleXmlProgressWatcher progressWatcher(&buffer);
+  progressWatcher.setProgressInterval(60000);
+  QCOMPARE(progressWatcher.progressInterval(), 60000);
+
+  SignalTester signalTester;
+  signalTester.connect(&progressWatcher, SIGNAL(filterStarted(QString,QString)), &signalTester, SLOT(filterStarted(QString,QString)));
+  signalTester.connect(&progressWatcher, SIGNAL(filterProgress(float,QString)), &signalTester, SLOT(filterProgress(float,QString)));
+  signalTester.connect(&progressWatcher, SIGNAL(filterFinished(QString,QString)), &signalTester, SLOT(filterFinished(QString,QString)));
+  signalTester.connect(&progressWatcher, SIGNAL(filterXmlError(QString)), &signalTester, SLOT(filterXmlError(QString)));
+
+  buffer.write(filterStart);
+  buffer.write(filterProgress.arg(0.3).toLatin1());
+  buffer.write(filterProgress.arg(0.6).toLatin1());
+  buffer.write(filterProgress.arg(0.9).toLatin1());
+  buffer.write(filterEnd);
+
+  QCoreApplication::processEvents();
+
+  // The first report is emitted immediately, the last one before the end of the filter
+  QList<QString> expectedSignals;
+  expectedSignals << "filter.started";
+  expectedSignals << "filter.progress";
+  expectedSignals << "filter.progress";
+  expectedSignals << "filter.finished";
+
+  if (!signalTester.error.isEmpty())
+  {
+    qDebug() << signalTester.error;
+    QFAIL("XML parsing error");
+  }
+
+  QVERIFY(signalTester.checkSignals(expectedSignals));
+
+  QCOMPARE(signalTester.accumulatedProgress, 1.2f);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleXmlProgressWatcherTester::testOutputSink()
+{
+  // Test data, the second chunk starts in the middle of a tag
+  QByteArray chunk1 = "Output <1>\n"
+                      "<filter-start>\n"
+                        "<filter-name>My Filter</filter-name>\n"
+                        "<filter-comment>Awesome &amp; filter</filter-comment>\n"
+                      "</filter-start>\n"
+                      "Output 2\n"
+                      "<filter-e";
+  QByteArray chunk2 = "nd>\n"
+                        "<filter-name>My Filter</filter-name>\n"
+                      "</filter-end>\n"
+                      "Output 3";
+
+  QBuffer buffer;
+  buffer.open(QIODevice::ReadWrite);
+  ctkCmdLineModuleXmlProgressWatcher progressWatcher(&buffer);
+
+  QBuffer sink;
+  sink.open(QIODevice::WriteOnly);
+  progressWatcher.setOutputSink(&sink);
+  QCOMPARE(progressWatcher.outputSink(), static_cast<QIODevice*>(&sink));
+
+  ctkCmdLineModuleSignalTester signalTester;
+  signalTester.connect(&progressWatcher, SIGNAL(filterStarted(QString,QString)), &signalTester, SLOT(filterStarted(QString,QString)));
+  signalTester.connect(&progressWatcher, SIGNAL(filterFinished(QString,QString)), &signalTester, SLOT(filterFinished(QString,QString)));
+  signalTester.connect(&progressWatcher, SIGNAL(filterXmlError(QString)), &signalTester, SLOT(filterXmlError(QString)));
+  QSignalSpy outputSpy(&progressWatcher, SIGNAL(outputDataAvailable(QByteArray)));
+  QSignalSpy startedSpy(&progressWatcher, SIGNAL(filterStarted(QString,QString)));
+
+  buffer.write(chunk1);
+  QCoreApplication::processEvents();
+  QCOMPARE(sink.data(), QByteArray("Output <1>\nOutput 2\n"));
+
+  buffer.write(chunk2);
+  QCoreApplication::processEvents();
+  QCOMPARE(sink.data(), QByteArray("Output <1>\nOutput 2\nOutput 3"));
+
+  QList<QString> expectedSignals;
+  expectedSignals << "filter.started";
+  expectedSignals << "filter.finished";
+  QVERIFY(signalTester.checkSignals(expectedSignals));
+
+  QCOMPARE(startedSpy.count(), 1);
+  QCOMPARE(startedSpy.front().at(1).toString(), QString("Awesome & filter"));
+  QCOMPARE(outputSpy.count(), 0);
+}
+
 
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(ctkCmdLineModuleXmlProgressWatcherTest)
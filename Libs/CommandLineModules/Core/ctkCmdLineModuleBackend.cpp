@@ -20,6 +20,7 @@
 =============================================================================*/
 
 #include "ctkCmdLineModuleBackend.h"
+#include "ctkCmdLineModuleFuture.h"
 
 #include <qbytearray.h>
 
@@ -39,3 +40,10 @@ int ctkCmdLineModuleBackend::timeOutForXmlRetrieval() const
 {
   return 0;
 }
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleBackend::runScheduled(ctkCmdLineModuleFrontend* frontend,
+                                                             ctkCmdLineModuleScheduler* /*scheduler*/)
+{
+  return this->run(frontend);
+}
@@ -26,6 +26,7 @@
 
 class ctkCmdLineModuleFrontend;
 class ctkCmdLineModuleFuture;
+class ctkCmdLineModuleScheduler;
 
 template<typename T> class QList;
 class QUrl;
@@ -137,6 +138,18 @@ protected:
    */
   virtual ctkCmdLineModuleFuture run(ctkCmdLineModuleFrontend* frontend) = 0;
 
+  /**
+   * @brief Execute the back-end process using the scheduler of the module manager.
+   * @param frontend A pointer to a front end implementation.
+   * @param scheduler The scheduler of the ctkCmdLineModuleManager running the module.
+   *
+   * This is the method called by ctkCmdLineModuleManager::run(). Back-ends which run
+   * their tasks with the ctkCmdLineModuleScheduler should override it, the default
+   * implementation calls run(ctkCmdLineModuleFrontend*).
+   */
+  virtual ctkCmdLineModuleFuture runScheduled(ctkCmdLineModuleFrontend* frontend,
+                                              ctkCmdLineModuleScheduler* scheduler);
+
 };
 
 #endif // CTKCMDLINEMODULEBACKEND_H
@@ -0,0 +1,496 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkCmdLineModuleBatch.h"
+
+#include "ctkCmdLineModuleDescription.h"
+#include "ctkCmdLineModuleFrontend.h"
+#include "ctkCmdLineModuleFrontendFactory.h"
+#include "ctkCmdLineModuleFuture.h"
+#include "ctkCmdLineModuleFutureWatcher.h"
+#include "ctkCmdLineModuleManager.h"
+#include "ctkCmdLineModuleParameter.h"
+#include "ctkCmdLineModuleReference.h"
+#include "ctkCmdLineModuleRunException.h"
+
+#include <ctkException.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QStringList>
+
+namespace {
+
+//----------------------------------------------------------------------------
+QString defaultTemporaryDirectory()
+{
+#ifdef Q_OS_LINUX
+  // Intermediate files in a tmpfs do not touch the disk
+  QFileInfo shm("/dev/shm");
+  if (shm.isDir() && shm.isWritable())
+  {
+    return shm.absoluteFilePath();
+  }
+#endif
+  return QDir::tempPath();
+}
+
+}
+
+//----------------------------------------------------------------------------
+struct ctkCmdLineModuleBatchDependency
+{
+  int SourceJob;
+  QString InputParameter;
+  QString OutputParameter;
+};
+
+//----------------------------------------------------------------------------
+struct ctkCmdLineModuleBatchJob
+{
+  enum State {
+    Pending,
+    Running,
+    Finished,
+    Failed
+  };
+
+  ctkCmdLineModuleBatchJob()
+    : Frontend(NULL)
+    , JobState(Pending)
+  {}
+
+  ctkCmdLineModuleFrontend* Frontend;
+  QList<ctkCmdLineModuleBatchDependency> Dependencies;
+  State JobState;
+  ctkCmdLineModuleFuture Future;
+};
+
+//----------------------------------------------------------------------------
+struct ctkCmdLineModuleBatchPrivate
+{
+  ctkCmdLineModuleBatchPrivate(ctkCmdLineModuleBatch* qq, ctkCmdLineModuleManager* manager,
+                               ctkCmdLineModuleFrontendFactory* frontendFactory)
+    : q(qq)
+    , Manager(manager)
+    , FrontendFactory(frontendFactory)
+    , TemporaryDirectory(defaultTemporaryDirectory())
+    , Started(false)
+    , Finished(false)
+    , FinishedJobs(0)
+  {}
+
+  void checkJob(int job) const
+  {
+    if (job < 0 || job >= Jobs.size())
+    {
+      throw ctkInvalidArgumentException(QString("The batch has no job %1.").arg(job));
+    }
+  }
+
+  ctkCmdLineModuleParameter parameter(int job, const QString& name) const
+  {
+    ctkCmdLineModuleDescription description = Jobs[job].Frontend->moduleReference().description();
+    if (!description.hasParameter(name))
+    {
+      throw ctkInvalidArgumentException(QString("The module of job %1 has no parameter \"%2\".")
+                                        .arg(job).arg(name));
+    }
+    return description.parameter(name);
+  }
+
+  void checkCycles() const
+  {
+    // Kahn's algorithm, the jobs left with dependencies are part of a cycle
+    QList<int> remaining;
+    for (int i = 0; i < Jobs.size(); ++i)
+    {
+      remaining.push_back(Jobs[i].Dependencies.size());
+    }
+    QList<int> ready;
+    for (int i = 0; i < Jobs.size(); ++i)
+    {
+      if (remaining[i] == 0) ready.push_back(i);
+    }
+    int sorted = 0;
+    while (!ready.isEmpty())
+    {
+      int source = ready.takeFirst();
+      ++sorted;
+      for (int i = 0; i < Jobs.size(); ++i)
+      {
+        foreach(const ctkCmdLineModuleBatchDependency& dependency, Jobs[i].Dependencies)
+        {
+          if (dependency.SourceJob == source && --remaining[i] == 0)
+          {
+            ready.push_back(i);
+          }
+        }
+      }
+    }
+    if (sorted != Jobs.size())
+    {
+      throw ctkInvalidArgumentException("The dependencies of the batch jobs contain a cycle.");
+    }
+  }
+
+  // Sets the output files of the parameters passed through the temporary directory
+  void assignOutputFiles()
+  {
+    const QString prefix = QString("ctkCmdLineModuleBatch-%1-%2")
+        .arg(QCoreApplication::applicationPid())
+        .arg(reinterpret_cast<quintptr>(q), 0, 16);
+    QDir temporaryDir(TemporaryDirectory);
+
+    for (int i = 0; i < Jobs.size(); ++i)
+    {
+      foreach(const ctkCmdLineModuleBatchDependency& dependency, Jobs[i].Dependencies)
+      {
+        if (dependency.OutputParameter.isEmpty()) continue;
+
+        QPair<int, QString> output(dependency.SourceJob, dependency.OutputParameter);
+        ctkCmdLineModuleParameter parameter = this->parameter(dependency.SourceJob, dependency.OutputParameter);
+        if (parameter.isReturnParameter() || OutputFiles.contains(output)) continue;
+
+        ctkCmdLineModuleFrontend* source = Jobs[dependency.SourceJob].Frontend;
+        QString fileName = source->value(dependency.OutputParameter).toString();
+        if (fileName.isEmpty())
+        {
+          QString extension = parameter.fileExtensions().isEmpty() ? QString() : parameter.fileExtensions().front();
+          if (!extension.isEmpty() && !extension.startsWith('.'))
+          {
+            extension.prepend('.');
+          }
+          fileName = temporaryDir.filePath(QString("%1-%2-%3%4").arg(prefix).arg(dependency.SourceJob)
+                                           .arg(dependency.OutputParameter).arg(extension));
+          source->setValue(dependency.OutputParameter, fileName);
+          TemporaryFiles.push_back(fileName);
+        }
+        OutputFiles.insert(output, fileName);
+      }
+    }
+  }
+
+  QVariant outputValue(const ctkCmdLineModuleBatchDependency& dependency) const
+  {
+    QHash<QPair<int, QString>, QString>::const_iterator iter =
+        OutputFiles.find(qMakePair(dependency.SourceJob, dependency.OutputParameter));
+    if (iter != OutputFiles.end())
+    {
+      return iter.value();
+    }
+
+    // A return parameter
+    QList<ctkCmdLineModuleResult> results = Jobs[dependency.SourceJob].Future.results();
+    foreach(const ctkCmdLineModuleResult& result, results)
+    {
+      if (result.parameter() == dependency.OutputParameter)
+      {
+        return result.value();
+      }
+    }
+    return QVariant();
+  }
+
+  // Starts the pending jobs whose dependencies have finished successfully
+  void startJobs()
+  {
+    bool changed = true;
+    while (changed)
+    {
+      changed = false;
+      for (int i = 0; i < Jobs.size(); ++i)
+      {
+        ctkCmdLineModuleBatchJob& job = Jobs[i];
+        if (job.JobState != ctkCmdLineModuleBatchJob::Pending) continue;
+
+        bool ready = !FutureInterface.isCanceled();
+        bool failed = false;
+        foreach(const ctkCmdLineModuleBatchDependency& dependency, job.Dependencies)
+        {
+          ctkCmdLineModuleBatchJob::State sourceState = Jobs[dependency.SourceJob].JobState;
+          ready = ready && sourceState == ctkCmdLineModuleBatchJob::Finished;
+          failed = failed || sourceState == ctkCmdLineModuleBatchJob::Failed;
+        }
+        if (failed)
+        {
+          // Skip the job
+          job.JobState = ctkCmdLineModuleBatchJob::Failed;
+          changed = true;
+          continue;
+        }
+        if (!ready) continue;
+
+        foreach(const ctkCmdLineModuleBatchDependency& dependency, job.Dependencies)
+        {
+          if (!dependency.OutputParameter.isEmpty())
+          {
+            job.Frontend->setValue(dependency.InputParameter, this->outputValue(dependency));
+          }
+        }
+
+        try
+        {
+          job.Future = Manager->run(job.Frontend);
+        }
+        catch (const ctkException& e)
+        {
+          FutureInterface.reportException(ctkCmdLineModuleRunException(job.Frontend->location(), 0, e.message()));
+          job.JobState = ctkCmdLineModuleBatchJob::Failed;
+          changed = true;
+          continue;
+        }
+
+        job.JobState = ctkCmdLineModuleBatchJob::Running;
+        ctkCmdLineModuleFutureWatcher* watcher = new ctkCmdLineModuleFutureWatcher(q);
+        q->connect(watcher, SIGNAL(finished()), SLOT(jobFinished()));
+        Watchers.insert(watcher, i);
+        watcher->setFuture(job.Future);
+      }
+    }
+
+    if (Watchers.isEmpty())
+    {
+      this->finish();
+    }
+  }
+
+  void finish()
+  {
+    if (Finished) return;
+    Finished = true;
+
+    this->removeTemporaryFiles();
+    FutureInterface.reportFinished();
+  }
+
+  void removeTemporaryFiles()
+  {
+    foreach(const QString& fileName, TemporaryFiles)
+    {
+      QFile::remove(fileName);
+    }
+    TemporaryFiles.clear();
+  }
+
+  ctkCmdLineModuleBatch* q;
+  ctkCmdLineModuleManager* Manager;
+  ctkCmdLineModuleFrontendFactory* FrontendFactory;
+  QString TemporaryDirectory;
+
+  QList<ctkCmdLineModuleBatchJob> Jobs;
+  QHash<QPair<int, QString>, QString> OutputFiles;
+  QStringList TemporaryFiles;
+  QHash<ctkCmdLineModuleFutureWatcher*, int> Watchers;
+
+  ctkCmdLineModuleFutureInterface FutureInterface;
+  ctkCmdLineModuleFutureWatcher BatchWatcher;
+  bool Started;
+  bool Finished;
+  int FinishedJobs;
+};
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleBatch::ctkCmdLineModuleBatch(ctkCmdLineModuleManager* manager,
+                                             ctkCmdLineModuleFrontendFactory* frontendFactory,
+                                             QObject* parent)
+  : QObject(parent)
+  , d(new ctkCmdLineModuleBatchPrivate(this, manager, frontendFactory))
+{
+  d->FutureInterface.setCanCancel(true);
+  connect(&d->BatchWatcher, SIGNAL(canceled()), SLOT(batchCanceled()));
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleBatch::~ctkCmdLineModuleBatch()
+{
+  d->removeTemporaryFiles();
+  foreach(const ctkCmdLineModuleBatchJob& job, d->Jobs)
+  {
+    delete job.Frontend;
+  }
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBatch::addJob(const ctkCmdLineModuleReference& moduleRef, const QHash<QString, QVariant>& values)
+{
+  ctkCmdLineModuleFrontend* frontend = d->FrontendFactory->create(moduleRef);
+  if (frontend == NULL)
+  {
+    throw ctkInvalidArgumentException(QString("No front-end could be created for the module at ")
+                                      + moduleRef.location().toString());
+  }
+  frontend->setValues(values);
+
+  ctkCmdLineModuleBatchJob job;
+  job.Frontend = frontend;
+  d->Jobs.push_back(job);
+  return d->Jobs.size() - 1;
+}
+
+//----------------------------------------------------------------------------
+QList<int> ctkCmdLineModuleBatch::addSweep(const ctkCmdLineModuleReference& moduleRef, const QString& parameter,
+                                           const QList<QVariant>& sweepValues,
+                                           const QHash<QString, QVariant>& values)
+{
+  QList<int> jobs;
+  QHash<QString, QVariant> jobValues = values;
+  foreach(const QVariant& value, sweepValues)
+  {
+    jobValues[parameter] = value;
+    jobs.push_back(this->addJob(moduleRef, jobValues));
+  }
+  return jobs;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBatch::addDependency(int job, int sourceJob)
+{
+  d->checkJob(job);
+  d->checkJob(sourceJob);
+
+  ctkCmdLineModuleBatchDependency dependency;
+  dependency.SourceJob = sourceJob;
+  d->Jobs[job].Dependencies.push_back(dependency);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBatch::addDependency(int job, const QString& inputParameter,
+                                          int sourceJob, const QString& outputParameter)
+{
+  d->checkJob(job);
+  d->checkJob(sourceJob);
+  d->parameter(job, inputParameter);
+  d->parameter(sourceJob, outputParameter);
+
+  ctkCmdLineModuleBatchDependency dependency;
+  dependency.SourceJob = sourceJob;
+  dependency.InputParameter = inputParameter;
+  dependency.OutputParameter = outputParameter;
+  d->Jobs[job].Dependencies.push_back(dependency);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBatch::jobCount() const
+{
+  return d->Jobs.size();
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFrontend* ctkCmdLineModuleBatch::frontend(int job) const
+{
+  d->checkJob(job);
+  return d->Jobs[job].Frontend;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBatch::setTemporaryDirectory(const QString& path)
+{
+  d->TemporaryDirectory = path;
+}
+
+//----------------------------------------------------------------------------
+QString ctkCmdLineModuleBatch::temporaryDirectory() const
+{
+  return d->TemporaryDirectory;
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleBatch::run()
+{
+  if (d->Started)
+  {
+    throw ctkIllegalStateException("The batch was already started.");
+  }
+  d->checkCycles();
+  d->assignOutputFiles();
+  d->Started = true;
+
+  d->FutureInterface.setProgressRange(0, d->Jobs.size());
+  d->FutureInterface.reportStarted();
+  d->BatchWatcher.setFuture(d->FutureInterface.future());
+
+  d->startJobs();
+  return d->FutureInterface.future();
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleBatch::future() const
+{
+  return d->FutureInterface.future();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBatch::jobFinished()
+{
+  ctkCmdLineModuleFutureWatcher* watcher = static_cast<ctkCmdLineModuleFutureWatcher*>(this->sender());
+  int index = d->Watchers.take(watcher);
+  watcher->deleteLater();
+
+  ctkCmdLineModuleBatchJob& job = d->Jobs[index];
+  ctkCmdLineModuleFuture future = job.Future;
+
+  QByteArray outputData = future.readAllOutputData();
+  if (!outputData.isEmpty())
+  {
+    d->FutureInterface.reportOutputData(outputData);
+  }
+  QByteArray errorData = future.readAllErrorData();
+  if (!errorData.isEmpty())
+  {
+    d->FutureInterface.reportErrorData(errorData);
+  }
+
+  if (future.isCanceled())
+  {
+    job.JobState = ctkCmdLineModuleBatchJob::Failed;
+    try
+    {
+      future.waitForFinished();
+      // Canceled without an error
+      d->FutureInterface.cancel();
+    }
+    catch (const QtConcurrent::Exception& e)
+    {
+      // Only the first error is kept
+      d->FutureInterface.reportException(e);
+    }
+  }
+  else
+  {
+    job.JobState = ctkCmdLineModuleBatchJob::Finished;
+  }
+
+  d->FutureInterface.setProgressValue(++d->FinishedJobs);
+  d->startJobs();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBatch::batchCanceled()
+{
+  foreach(ctkCmdLineModuleFutureWatcher* watcher, d->Watchers.keys())
+  {
+    watcher->cancel();
+  }
+}
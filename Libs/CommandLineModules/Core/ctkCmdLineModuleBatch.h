@@ -0,0 +1,156 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKCMDLINEMODULEBATCH_H
+#define CTKCMDLINEMODULEBATCH_H
+
+#include "ctkCommandLineModulesCoreExport.h"
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QHash>
+#include <QList>
+#include <QVariant>
+
+class ctkCmdLineModuleFrontend;
+class ctkCmdLineModuleFrontendFactory;
+class ctkCmdLineModuleFuture;
+class ctkCmdLineModuleManager;
+class ctkCmdLineModuleReference;
+struct ctkCmdLineModuleBatchPrivate;
+
+/**
+ * @ingroup CommandLineModulesCore_API
+ *
+ * @brief Runs a set of modules, possibly depending on each other, as a single future.
+ *
+ * Each job of the batch is a run of a module with its own front-end, created by the
+ * front-end factory. Jobs are added one by one with addJob() or as a parameter sweep
+ * with addSweep(). A dependency added with addDependency() starts a job only after
+ * another one has finished successfully, and can pass the value of an output parameter
+ * of the first job to an input parameter of the second one:
+ *
+ * - a return parameter is passed by value, from the results of the first job;
+ * - any other output parameter, usually a file or an image, is written to a file in
+ *   temporaryDirectory() which is removed once the batch has finished.
+ *
+ * run() starts all jobs without pending dependencies at once through
+ * ctkCmdLineModuleManager::run(), so that independent jobs overlap as far as the
+ * scheduler of the manager allows. The returned future reports the number of finished
+ * jobs as its progress and the output data of the jobs. Canceling it cancels the running
+ * jobs and skips the pending ones. If a job fails, the batch future reports its error and
+ * is canceled the same way.
+ *
+ * The batch must be used from the thread it lives in and must not be destroyed before
+ * its future has finished.
+ */
+class CTK_CMDLINEMODULECORE_EXPORT ctkCmdLineModuleBatch : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  ctkCmdLineModuleBatch(ctkCmdLineModuleManager* manager, ctkCmdLineModuleFrontendFactory* frontendFactory,
+                        QObject* parent = 0);
+
+  /**
+   * @brief Deletes the front-ends of the jobs.
+   */
+  ~ctkCmdLineModuleBatch();
+
+  /**
+   * @brief Add a run of the module \c moduleRef.
+   * @param moduleRef The module to run.
+   * @param values The parameter values, see ctkCmdLineModuleFrontend::setValues().
+   * @return The index of the job.
+   * @throws ctkInvalidArgumentException if no front-end could be created for the module.
+   */
+  int addJob(const ctkCmdLineModuleReference& moduleRef,
+             const QHash<QString, QVariant>& values = QHash<QString, QVariant>());
+
+  /**
+   * @brief Add one run of the module \c moduleRef per value of \c parameter.
+   * @param moduleRef The module to run.
+   * @param parameter The name of the parameter to sweep.
+   * @param sweepValues The values of \c parameter, one per job.
+   * @param values The values of the other parameters, shared by all jobs.
+   * @return The indexes of the jobs, in the order of \c sweepValues.
+   */
+  QList<int> addSweep(const ctkCmdLineModuleReference& moduleRef, const QString& parameter,
+                      const QList<QVariant>& sweepValues,
+                      const QHash<QString, QVariant>& values = QHash<QString, QVariant>());
+
+  /**
+   * @brief Start \c job only after \c sourceJob has finished successfully.
+   * @throws ctkInvalidArgumentException if one of the jobs does not exist.
+   */
+  void addDependency(int job, int sourceJob);
+
+  /**
+   * @brief Pass the output parameter \c outputParameter of \c sourceJob to the input
+   *        parameter \c inputParameter of \c job, which is started after \c sourceJob.
+   * @throws ctkInvalidArgumentException if one of the jobs or parameters does not exist.
+   */
+  void addDependency(int job, const QString& inputParameter, int sourceJob, const QString& outputParameter);
+
+  int jobCount() const;
+
+  /**
+   * @brief The front-end of \c job, whose future gives the results of that job once it has started.
+   */
+  ctkCmdLineModuleFrontend* frontend(int job) const;
+
+  /**
+   * @brief Set the directory of the intermediate files.
+   *
+   * The default is a RAM backed directory if one is available, like /dev/shm
+   * on Linux, and QDir::tempPath() otherwise.
+   */
+  void setTemporaryDirectory(const QString& path);
+  QString temporaryDirectory() const;
+
+  /**
+   * @brief Start the jobs, which can only be done once.
+   * @return The future of the whole batch.
+   * @throws ctkInvalidArgumentException if the dependencies contain a cycle.
+   * @throws ctkIllegalStateException if the batch was already started.
+   */
+  ctkCmdLineModuleFuture run();
+
+  /**
+   * @brief The future of the whole batch.
+   */
+  ctkCmdLineModuleFuture future() const;
+
+private Q_SLOTS:
+
+  void jobFinished();
+  void batchCanceled();
+
+private:
+
+  QScopedPointer<ctkCmdLineModuleBatchPrivate> d;
+
+  Q_DISABLE_COPY(ctkCmdLineModuleBatch)
+
+};
+
+#endif // CTKCMDLINEMODULEBATCH_H
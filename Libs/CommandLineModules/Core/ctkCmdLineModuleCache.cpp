@@ -22,9 +22,10 @@
 #include "ctkCmdLineModuleCache_p.h"
 
 #include <QUrl>
+#include <QDataStream>
+#include <QDir>
 #include <QFile>
 #include <QDirIterator>
-#include <QTextStream>
 #include <QMutex>
 #include <QHash>
 
@@ -36,41 +37,186 @@ CTK_CMDLINEMODULECORE_EXPORT int qHash(const QUrl& url)
 }
 #endif
 
+namespace {
+
+const quint32 CacheFileMagic = 0x63746b4d; // "ctkM"
+const quint32 CacheFileVersion = 2;
+
+}
+
 struct ctkCmdLineModuleCachePrivate
 {
+  enum ValidationState
+  {
+    NotValidated = 0,
+    Valid,
+    Invalid
+  };
+
+  struct Entry
+  {
+    Entry()
+      : TimeStamp(-1)
+      , TimeOutTimeStamp(0)
+      , TimeOut(-1)
+      , Validation(NotValidated)
+    {}
+
+    bool isEmpty() const
+    {
+      return this->TimeStamp < 0 && this->TimeOut < 0;
+    }
+
+    qint64 TimeStamp;
+    QByteArray XmlDescription;
+    qint64 TimeOutTimeStamp;
+    int TimeOut;
+    int Validation;
+    QString ValidationErrorString;
+    QByteArray SerializedDescription;
+  };
+
+  ctkCmdLineModuleCachePrivate()
+    : Dirty(false)
+  {}
+
   QString CacheDir;
 
-  QHash<QUrl, qint64> LocationToTimeStamp;
-  QHash<QUrl, QByteArray> LocationToXmlDescription;
+  QHash<QUrl, Entry> LocationToEntry;
+  bool Dirty;
 
   QMutex Mutex;
 
-  void LoadTimeStamps()
+  QString cacheFileName() const
+  {
+    return this->CacheDir + "/ctkCmdLineModuleCache.bin";
+  }
+
+  bool LoadCacheFile()
+  {
+    QFile cacheFile(this->cacheFileName());
+    if (!cacheFile.open(QIODevice::ReadOnly))
+    {
+      return false;
+    }
+
+    QDataStream in(&cacheFile);
+    in.setVersion(QDataStream::Qt_4_6);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != CacheFileMagic || version < 1 || version > CacheFileVersion)
+    {
+      // an unknown format is dropped and rebuilt
+      return true;
+    }
+
+    for (quint32 i = 0; i < count; ++i)
+    {
+      QString url;
+      Entry entry;
+      in >> url >> entry.TimeStamp >> entry.XmlDescription
+         >> entry.TimeOutTimeStamp >> entry.TimeOut;
+      if (version >= 2)
+      {
+        qint32 validation = NotValidated;
+        in >> validation >> entry.ValidationErrorString >> entry.SerializedDescription;
+        entry.Validation = validation;
+      }
+      if (in.status() != QDataStream::Ok)
+      {
+        // keep the entries read so far
+        break;
+      }
+      this->LocationToEntry[QUrl(url)] = entry;
+    }
+    return true;
+  }
+
+  // Imports the time stamp and XML files of the previous cache layout, one pair per module
+  void ImportLegacyFiles()
   {
+    QStringList legacyFiles;
     QDirIterator dirIter(this->CacheDir, QStringList() << "*.timestamp", QDir::Files | QDir::Readable);
     while(dirIter.hasNext())
     {
-      QFile timestampFile(dirIter.next());
+      QString timestampFileName = dirIter.next();
+      QFile timestampFile(timestampFileName);
       timestampFile.open(QIODevice::ReadOnly);
       QUrl url = QUrl(timestampFile.readLine().trimmed().data());
       QByteArray timestamp = timestampFile.readLine();
+      timestampFile.close();
+      legacyFiles << timestampFileName;
+
       bool ok = false;
       qint64 ts = timestamp.toLongLong(&ok);
       if (ok && !url.isEmpty())
       {
-        this->LocationToTimeStamp[url] = ts;
+        QString xmlFileName = timestampFileName.left(timestampFileName.size() - 10) + ".xml";
+        QFile xmlFile(xmlFileName);
+        Entry entry;
+        entry.TimeStamp = ts;
+        if (xmlFile.open(QIODevice::ReadOnly))
+        {
+          entry.XmlDescription = xmlFile.readAll();
+          xmlFile.close();
+          legacyFiles << xmlFileName;
+        }
+        this->LocationToEntry[url] = entry;
       }
     }
-  }
 
-  QString timeStampFileName(const QUrl& moduleLocation) const
-  {
-    return this->CacheDir + "/" + QString::number(qHash(moduleLocation)) + ".timestamp";
+    if (!legacyFiles.isEmpty() && this->WriteCacheFile())
+    {
+      foreach(const QString& legacyFile, legacyFiles)
+      {
+        QFile::remove(legacyFile);
+      }
+    }
   }
 
-  QString xmlFileName(const QUrl& moduleLocation) const
+  // Writes all entries to a temporary file which then replaces the cache file
+  bool WriteCacheFile()
   {
-    return this->CacheDir + "/" + QString::number(qHash(moduleLocation)) + ".xml";
+    QString tmpFileName = this->cacheFileName() + ".tmp";
+    QFile tmpFile(tmpFileName);
+    if (!tmpFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      return false;
+    }
+
+    {
+      QDataStream out(&tmpFile);
+      out.setVersion(QDataStream::Qt_4_6);
+      out << CacheFileMagic << CacheFileVersion << static_cast<quint32>(this->LocationToEntry.size());
+      QHash<QUrl, Entry>::const_iterator iter = this->LocationToEntry.begin();
+      for (; iter != this->LocationToEntry.end(); ++iter)
+      {
+        const Entry& entry = iter.value();
+        out << iter.key().toString() << entry.TimeStamp << entry.XmlDescription
+            << entry.TimeOutTimeStamp << entry.TimeOut
+            << static_cast<qint32>(entry.Validation) << entry.ValidationErrorString
+            << entry.SerializedDescription;
+      }
+    }
+
+    bool ok = tmpFile.error() == QFile::NoError && tmpFile.flush();
+    tmpFile.close();
+    if (!ok)
+    {
+      tmpFile.remove();
+      return false;
+    }
+
+    QFile::remove(this->cacheFileName());
+    if (!QFile::rename(tmpFileName, this->cacheFileName()))
+    {
+      tmpFile.remove();
+      return false;
+    }
+    this->Dirty = false;
+    return true;
   }
 };
 
@@ -78,11 +224,15 @@ ctkCmdLineModuleCache::ctkCmdLineModuleCache(const QString& cacheDir)
   : d(new ctkCmdLineModuleCachePrivate)
 {
   d->CacheDir = cacheDir;
-  d->LoadTimeStamps();
+  if (!d->LoadCacheFile())
+  {
+    d->ImportLegacyFiles();
+  }
 }
 
 ctkCmdLineModuleCache::~ctkCmdLineModuleCache()
 {
+  this->flush();
 }
 
 QString ctkCmdLineModuleCache::cacheDir() const
@@ -94,98 +244,139 @@ QString ctkCmdLineModuleCache::cacheDir() const
 QByteArray ctkCmdLineModuleCache::rawXmlDescription(const QUrl& moduleLocation) const
 {
   QMutexLocker lock(&d->Mutex);
+  return d->LocationToEntry.value(moduleLocation).XmlDescription;
+}
 
-  if (d->LocationToXmlDescription.contains(moduleLocation))
+qint64 ctkCmdLineModuleCache::timeStamp(const QUrl& moduleLocation) const
+{
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::const_iterator iter = d->LocationToEntry.find(moduleLocation);
+  return iter == d->LocationToEntry.end() ? -1 : iter.value().TimeStamp;
+}
+
+int ctkCmdLineModuleCache::xmlRetrievalTimeOut(const QUrl& moduleLocation, qint64* timestamp) const
+{
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::const_iterator iter = d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end() || iter.value().TimeOut < 0)
   {
-    return d->LocationToXmlDescription[moduleLocation];
+    return -1;
   }
-  // lazily load the XML description from the file system
-  QByteArray xml;
-  QString a = moduleLocation.toString();
-  QString fn = d->xmlFileName(moduleLocation);
-  QFile xmlFile(d->xmlFileName(moduleLocation));
-  if (xmlFile.exists() && xmlFile.open(QIODevice::ReadOnly))
+  if (timestamp)
   {
-    xml = xmlFile.readAll();
-    xmlFile.close();
+    *timestamp = iter.value().TimeOutTimeStamp;
   }
-  d->LocationToXmlDescription[moduleLocation] = xml;
-  return xml;
+  return iter.value().TimeOut;
 }
 
-qint64 ctkCmdLineModuleCache::timeStamp(const QUrl& moduleLocation) const
+void ctkCmdLineModuleCache::cacheXmlRetrievalTimeOut(const QUrl& moduleLocation, qint64 timestamp, int timeout)
 {
   QMutexLocker lock(&d->Mutex);
-  if (d->LocationToTimeStamp.contains(moduleLocation))
+  ctkCmdLineModuleCachePrivate::Entry& entry = d->LocationToEntry[moduleLocation];
+  entry.TimeOutTimeStamp = timestamp;
+  entry.TimeOut = timeout;
+  d->Dirty = true;
+}
+
+void ctkCmdLineModuleCache::removeXmlRetrievalTimeOut(const QUrl& moduleLocation)
+{
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::iterator iter = d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end() || iter.value().TimeOut < 0)
+  {
+    return;
+  }
+  iter.value().TimeOut = -1;
+  iter.value().TimeOutTimeStamp = 0;
+  if (iter.value().isEmpty())
   {
-    return d->LocationToTimeStamp[moduleLocation];
+    d->LocationToEntry.erase(iter);
   }
-  return -1;
+  d->Dirty = true;
 }
 
 void ctkCmdLineModuleCache::cacheXmlDescription(const QUrl& moduleLocation, qint64 timestamp, const QByteArray& xmlDescription)
 {
-  QFile timestampFile(d->timeStampFileName(moduleLocation));
-  QFile xmlFile(d->xmlFileName(moduleLocation));
-  timestampFile.remove();
-  timestampFile.open(QIODevice::WriteOnly);
+  QMutexLocker lock(&d->Mutex);
+  ctkCmdLineModuleCachePrivate::Entry entry;
+  entry.TimeStamp = timestamp;
+  entry.XmlDescription = xmlDescription;
+  d->LocationToEntry[moduleLocation] = entry;
+  d->Dirty = true;
+}
 
-  QByteArray ba;
-  QTextStream str(&ba);
-  str << moduleLocation.toString() << '\n' << timestamp;
-  str.flush();
-  if (timestampFile.write(ba) == -1)
+bool ctkCmdLineModuleCache::xmlValidationResult(const QUrl& moduleLocation, bool* valid, QString* errorString) const
+{
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::const_iterator iter = d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end() || iter.value().Validation == ctkCmdLineModuleCachePrivate::NotValidated)
   {
-    timestampFile.close();
-    timestampFile.remove();
-    return;
+    return false;
   }
-  timestampFile.close();
-
-  xmlFile.remove();
-  if (!xmlDescription.isEmpty())
+  if (valid)
   {
-    xmlFile.open(QIODevice::WriteOnly);
-    if (xmlFile.write(xmlDescription) == -1)
-    {
-      timestampFile.remove();
-      xmlFile.close();
-      xmlFile.remove();
-      return;
-    }
+    *valid = iter.value().Validation == ctkCmdLineModuleCachePrivate::Valid;
   }
-
+  if (errorString)
   {
-    QMutexLocker lock(&d->Mutex);
-    d->LocationToXmlDescription[moduleLocation] = xmlDescription;
-    d->LocationToTimeStamp[moduleLocation] = timestamp;
+    *errorString = iter.value().ValidationErrorString;
   }
+  return true;
 }
 
-void ctkCmdLineModuleCache::removeCacheEntry(const QUrl& moduleLocation)
+void ctkCmdLineModuleCache::cacheXmlValidationResult(const QUrl& moduleLocation, bool valid, const QString& errorString)
 {
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::iterator iter = d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end() || iter.value().TimeStamp < 0)
   {
-    QMutexLocker lock(&d->Mutex);
-    d->LocationToTimeStamp.remove(moduleLocation);
-    d->LocationToXmlDescription.remove(moduleLocation);
+    return;
   }
+  iter.value().Validation = valid ? ctkCmdLineModuleCachePrivate::Valid : ctkCmdLineModuleCachePrivate::Invalid;
+  iter.value().ValidationErrorString = errorString;
+  d->Dirty = true;
+}
+
+QByteArray ctkCmdLineModuleCache::serializedDescription(const QUrl& moduleLocation) const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->LocationToEntry.value(moduleLocation).SerializedDescription;
+}
 
-  QFile timestampFile(d->timeStampFileName(moduleLocation));
-  if (timestampFile.exists())
+void ctkCmdLineModuleCache::cacheSerializedDescription(const QUrl& moduleLocation, const QByteArray& description)
+{
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::iterator iter = d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end() || iter.value().TimeStamp < 0)
   {
-    timestampFile.remove();
+    return;
   }
-  QFile xmlFile(d->xmlFileName(moduleLocation));
-  if (xmlFile.exists())
+  iter.value().SerializedDescription = description;
+  d->Dirty = true;
+}
+
+void ctkCmdLineModuleCache::removeCacheEntry(const QUrl& moduleLocation)
+{
+  QMutexLocker lock(&d->Mutex);
+  if (d->LocationToEntry.remove(moduleLocation))
   {
-    xmlFile.remove();
+    d->Dirty = true;
   }
 }
 
 void ctkCmdLineModuleCache::clearCache()
 {
-  foreach(const QUrl &url, d->LocationToXmlDescription.keys())
+  QMutexLocker lock(&d->Mutex);
+  d->LocationToEntry.clear();
+  d->Dirty = true;
+}
+
+bool ctkCmdLineModuleCache::flush()
+{
+  QMutexLocker lock(&d->Mutex);
+  if (!d->Dirty)
   {
-    removeCacheEntry(url);
+    return true;
   }
+  return d->WriteCacheFile();
 }
@@ -33,9 +33,14 @@ class QUrl;
  * \brief Private non-exported class to contain a cache of
  * XML descriptions and time-stamps.
  *
- * The intention is that this Cache is an in-memory representation
- * of a file-system directory containing XML files and a corresponding
- * timestamp. Hence these should always be in synch.
+ * The cache is an in-memory representation of a single file in the
+ * cache directory, holding the XML description, time-stamp, validation
+ * result, parsed description and XML retrieval time-out of every module. The file is read once on
+ * construction. The changes are written at once by flush() or on
+ * destruction, to a temporary file which then replaces the cache file.
+ *
+ * The time-stamp and XML files of the previous cache layout, two per
+ * module, are imported if there is no cache file yet.
  *
  * \ingroup CommandLineModulesCore_API
  */
@@ -78,6 +83,73 @@ public:
    */
   void cacheXmlDescription(const QUrl& moduleLocation, qint64 timestamp, const QByteArray& xmlDescription);
 
+  /**
+   * @brief Returns the result of validating the cached XML description of a module.
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   * @param valid set to true if the XML description is valid
+   * @param errorString set to the validation error
+   * @return false if the cached XML description was not validated
+   */
+  bool xmlValidationResult(const QUrl& moduleLocation, bool* valid, QString* errorString = 0) const;
+
+  /**
+   * @brief Records the result of validating the cached XML description of a module.
+   *
+   * The result is discarded with the XML description by cacheXmlDescription().
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   * @param valid true if the XML description is valid
+   * @param errorString the validation error
+   */
+  void cacheXmlValidationResult(const QUrl& moduleLocation, bool valid, const QString& errorString);
+
+  /**
+   * @brief Returns the parsed description of a module, serialized by ctkCmdLineModuleDescriptionSerializer.
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   * @return the serialized description, or an empty QByteArray if it is not cached
+   */
+  QByteArray serializedDescription(const QUrl& moduleLocation) const;
+
+  /**
+   * @brief Adds the parsed description of a module with a cached XML description.
+   *
+   * The description is discarded with the XML description by cacheXmlDescription().
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   * @param description the description serialized by ctkCmdLineModuleDescriptionSerializer
+   */
+  void cacheSerializedDescription(const QUrl& moduleLocation, const QByteArray& description);
+
+  /**
+   * @brief Returns the timeout of the last XML retrieval of a module which timed out.
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   * @param timestamp the time stamp of the module when it timed out
+   * @return the timeout in milliseconds, or -1 if no time-out is cached
+   */
+  int xmlRetrievalTimeOut(const QUrl& moduleLocation, qint64* timestamp = 0) const;
+
+  /**
+   * @brief Records that the XML retrieval of a module timed out.
+   *
+   * Unlike an empty XML description, the module is retried as soon as it is
+   * modified or a larger timeout is used.
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   * @param timestamp the time stamp of the module
+   * @param timeout the timeout in milliseconds
+   */
+  void cacheXmlRetrievalTimeOut(const QUrl& moduleLocation, qint64 timestamp, int timeout);
+
+  /**
+   * @brief Removes the recorded time-out of a module.
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   */
+  void removeXmlRetrievalTimeOut(const QUrl& moduleLocation);
+
   /**
    * @brief Removes an entry from the cache.
    * @param moduleLocation QUrl representing the location,
@@ -90,6 +162,12 @@ public:
    */
   void clearCache();
 
+  /**
+   * @brief Writes the changed entries to the cache file.
+   * @return false if the cache file could not be written
+   */
+  bool flush();
+
 private:
 
   QScopedPointer<ctkCmdLineModuleCachePrivate> d;
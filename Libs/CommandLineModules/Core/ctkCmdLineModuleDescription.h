@@ -135,6 +135,7 @@ private:
 
   friend class ctkCmdLineModuleXmlParser;
   friend struct ctkCmdLineModuleReferencePrivate;
+  friend class ctkCmdLineModuleDescriptionSerializer;
 
   ctkCmdLineModuleDescription();
 
@@ -0,0 +1,154 @@
+/*=============================================================================
+
+Library: CTK
+
+Copyright (c) 2010 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+=============================================================================*/
+
+#include "ctkCmdLineModuleDescriptionSerializer_p.h"
+
+#include "ctkCmdLineModuleDescription.h"
+#include "ctkCmdLineModuleDescription_p.h"
+#include "ctkCmdLineModuleParameter.h"
+#include "ctkCmdLineModuleParameter_p.h"
+#include "ctkCmdLineModuleParameterGroup.h"
+#include "ctkCmdLineModuleParameterGroup_p.h"
+
+#include <QDataStream>
+
+namespace {
+
+// Increase when the layout of the serialized data changes
+const quint32 SerializationVersion = 1;
+
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkCmdLineModuleDescriptionSerializer::serialize(const ctkCmdLineModuleDescription& description)
+{
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_4_6);
+
+  const ctkCmdLineModuleDescriptionPrivate* d = description.d.constData();
+  out << SerializationVersion
+      << d->Title << d->Category << d->Description << d->Version
+      << d->DocumentationURL << d->License << d->Acknowledgements << d->Contributor
+      << d->Type << d->Target << d->Location
+      << d->AlternativeType << d->AlternativeTarget << d->AlternativeLocation;
+  // The logo is not part of the XML description, it is not serialized.
+
+  out << static_cast<quint32>(d->ParameterGroups.size());
+  foreach(const ctkCmdLineModuleParameterGroup& group, d->ParameterGroups)
+  {
+    write(out, group);
+  }
+  return data;
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleDescriptionSerializer::deserialize(const QByteArray& data, ctkCmdLineModuleDescription* description)
+{
+  QDataStream in(data);
+  in.setVersion(QDataStream::Qt_4_6);
+
+  quint32 version = 0;
+  in >> version;
+  if (in.status() != QDataStream::Ok || version != SerializationVersion)
+  {
+    return false;
+  }
+
+  ctkCmdLineModuleDescriptionPrivate* d = description->d.data();
+  in >> d->Title >> d->Category >> d->Description >> d->Version
+     >> d->DocumentationURL >> d->License >> d->Acknowledgements >> d->Contributor
+     >> d->Type >> d->Target >> d->Location
+     >> d->AlternativeType >> d->AlternativeTarget >> d->AlternativeLocation;
+
+  quint32 groupCount = 0;
+  in >> groupCount;
+  d->ParameterGroups.clear();
+  for (quint32 i = 0; i < groupCount && in.status() == QDataStream::Ok; ++i)
+  {
+    ctkCmdLineModuleParameterGroup group;
+    read(in, group);
+    d->ParameterGroups.push_back(group);
+  }
+  return in.status() == QDataStream::Ok && in.atEnd();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleDescriptionSerializer::write(QDataStream& out, const ctkCmdLineModuleParameterGroup& group)
+{
+  const ctkCmdLineModuleParameterGroupPrivate* d = group.d.constData();
+  out << d->Label << d->Description << d->Advanced;
+
+  out << static_cast<quint32>(d->Parameters.size());
+  foreach(const ctkCmdLineModuleParameter& parameter, d->Parameters)
+  {
+    write(out, parameter);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleDescriptionSerializer::write(QDataStream& out, const ctkCmdLineModuleParameter& parameter)
+{
+  const ctkCmdLineModuleParameterPrivate* d = parameter.d.constData();
+  out << d->Tag << d->Name << d->Description << d->Label << d->Type << d->Hidden
+      << d->Default << d->Flag << d->LongFlag << d->Constraints
+      << d->Minimum << d->Maximum << d->Step << d->Channel
+      << static_cast<qint32>(d->Index) << static_cast<qint32>(d->Multiple)
+      << d->FileExtensionsAsString << d->FileExtensions << d->CoordinateSystem << d->Elements
+      << d->FlagAliasesAsString << d->DeprecatedFlagAliasesAsString
+      << d->LongFlagAliasesAsString << d->DeprecatedLongFlagAliasesAsString
+      << d->FlagAliases << d->DeprecatedFlagAliases
+      << d->LongFlagAliases << d->DeprecatedLongFlagAliases;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleDescriptionSerializer::read(QDataStream& in, ctkCmdLineModuleParameterGroup& group)
+{
+  ctkCmdLineModuleParameterGroupPrivate* d = group.d.data();
+  in >> d->Label >> d->Description >> d->Advanced;
+
+  quint32 parameterCount = 0;
+  in >> parameterCount;
+  for (quint32 i = 0; i < parameterCount && in.status() == QDataStream::Ok; ++i)
+  {
+    ctkCmdLineModuleParameter parameter;
+    read(in, parameter);
+    d->Parameters.push_back(parameter);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleDescriptionSerializer::read(QDataStream& in, ctkCmdLineModuleParameter& parameter)
+{
+  ctkCmdLineModuleParameterPrivate* d = parameter.d.data();
+  qint32 index = 0;
+  qint32 multiple = 0;
+  in >> d->Tag >> d->Name >> d->Description >> d->Label >> d->Type >> d->Hidden
+     >> d->Default >> d->Flag >> d->LongFlag >> d->Constraints
+     >> d->Minimum >> d->Maximum >> d->Step >> d->Channel
+     >> index >> multiple
+     >> d->FileExtensionsAsString >> d->FileExtensions >> d->CoordinateSystem >> d->Elements
+     >> d->FlagAliasesAsString >> d->DeprecatedFlagAliasesAsString
+     >> d->LongFlagAliasesAsString >> d->DeprecatedLongFlagAliasesAsString
+     >> d->FlagAliases >> d->DeprecatedFlagAliases
+     >> d->LongFlagAliases >> d->DeprecatedLongFlagAliases;
+  d->Index = index;
+  d->Multiple = multiple;
+}
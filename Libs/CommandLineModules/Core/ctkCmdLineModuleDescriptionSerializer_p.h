@@ -0,0 +1,61 @@
+/*=============================================================================
+  
+  Library: CTK
+  
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+    
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  
+    http://www.apache.org/licenses/LICENSE-2.0
+    
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+  
+=============================================================================*/
+
+#ifndef CTKCMDLINEMODULEDESCRIPTIONSERIALIZER_P_H
+#define CTKCMDLINEMODULEDESCRIPTIONSERIALIZER_P_H
+
+#include <QByteArray>
+
+class ctkCmdLineModuleDescription;
+class ctkCmdLineModuleParameter;
+class ctkCmdLineModuleParameterGroup;
+
+class QDataStream;
+
+/**
+ * \class ctkCmdLineModuleDescriptionSerializer
+ * \brief Converts a parsed ctkCmdLineModuleDescription to and from a binary form,
+ * so that it can be cached instead of parsing the XML description again.
+ * \ingroup CommandLineModulesCore_API
+ * \see ctkCmdLineModuleCache
+ */
+class ctkCmdLineModuleDescriptionSerializer
+{
+
+public:
+
+  static QByteArray serialize(const ctkCmdLineModuleDescription& description);
+
+  /**
+   * @brief Restores a description from the output of serialize().
+   * @return false if the data is corrupt or was written by another version
+   */
+  static bool deserialize(const QByteArray& data, ctkCmdLineModuleDescription* description);
+
+private:
+
+  static void write(QDataStream& out, const ctkCmdLineModuleParameterGroup& group);
+  static void write(QDataStream& out, const ctkCmdLineModuleParameter& parameter);
+  static void read(QDataStream& in, ctkCmdLineModuleParameterGroup& group);
+  static void read(QDataStream& in, ctkCmdLineModuleParameter& parameter);
+};
+
+#endif // CTKCMDLINEMODULEDESCRIPTIONSERIALIZER_P_H
@@ -32,11 +32,74 @@
 #include <QFileInfo>
 #include <QUrl>
 #include <QDebug>
+#include <QEventLoop>
+#include <QMutex>
+#include <QRunnable>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
 #include <QtConcurrentMap>
 
 #include <iostream>
 
 
+namespace {
+
+//-----------------------------------------------------------------------------
+// Results of the modules registered by one call of loadModules
+struct ctkCmdLineModuleRegistrationBatch
+{
+  ctkCmdLineModuleRegistrationBatch(int count)
+    : Results(count)
+    , Remaining(count)
+    , Loop(NULL)
+  {}
+
+  QMutex Mutex;
+  QVector<ctkCmdLineModuleReferenceResult> Results;
+  QList<int> Finished;
+  int Remaining;
+  QEventLoop* Loop;
+};
+
+//-----------------------------------------------------------------------------
+class ctkCmdLineModuleRegistrationTask : public QRunnable
+{
+
+public:
+
+  ctkCmdLineModuleRegistrationTask(ctkCmdLineModuleManager* moduleManager, bool debug,
+                                   const QString& executable, int index,
+                                   ctkCmdLineModuleRegistrationBatch* batch)
+    : Register(moduleManager, debug)
+    , Executable(executable)
+    , Index(index)
+    , Batch(batch)
+  {}
+
+  virtual void run()
+  {
+    ctkCmdLineModuleReferenceResult result = this->Register(this->Executable);
+
+    // The loop is only accessed with the mutex locked, so that it is not
+    // destroyed before the last task woke it up.
+    QMutexLocker lock(&this->Batch->Mutex);
+    this->Batch->Results[this->Index] = result;
+    this->Batch->Finished.push_back(this->Index);
+    --this->Batch->Remaining;
+    QMetaObject::invokeMethod(this->Batch->Loop, "quit", Qt::QueuedConnection);
+  }
+
+private:
+
+  ctkCmdLineModuleConcurrentRegister Register;
+  QString Executable;
+  int Index;
+  ctkCmdLineModuleRegistrationBatch* Batch;
+};
+
+}
+
 //-----------------------------------------------------------------------------
 // ctkCmdLineModuleDirectoryWatcher methods
 
@@ -62,6 +125,20 @@ void ctkCmdLineModuleDirectoryWatcher::setDebug(bool debug)
 }
 
 
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleDirectoryWatcher::setMaximumConcurrentRegistrations(int count)
+{
+  d->setMaximumConcurrentRegistrations(count);
+}
+
+
+//-----------------------------------------------------------------------------
+int ctkCmdLineModuleDirectoryWatcher::maximumConcurrentRegistrations() const
+{
+  return d->maximumConcurrentRegistrations();
+}
+
+
 //-----------------------------------------------------------------------------
 void ctkCmdLineModuleDirectoryWatcher::setDirectories(const QStringList& directories)
 {
@@ -115,9 +192,11 @@ ctkCmdLineModuleDirectoryWatcherPrivate::ctkCmdLineModuleDirectoryWatcherPrivate
 : q(d)
 , ModuleManager(moduleManager)
 , FileSystemWatcher(NULL)
+, Loading(false)
 , Debug(false)
 {
   FileSystemWatcher = new QFileSystemWatcher();
+  this->RegistrationPool.setMaxThreadCount(QThread::idealThreadCount());
 
   connect(this->FileSystemWatcher, SIGNAL(fileChanged(QString)), this, SLOT(onFileChanged(QString)));
   connect(this->FileSystemWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(onDirectoryChanged(QString)));
@@ -127,6 +206,7 @@ ctkCmdLineModuleDirectoryWatcherPrivate::ctkCmdLineModuleDirectoryWatcherPrivate
 //-----------------------------------------------------------------------------
 ctkCmdLineModuleDirectoryWatcherPrivate::~ctkCmdLineModuleDirectoryWatcherPrivate()
 {
+  this->RegistrationPool.waitForDone();
   delete this->FileSystemWatcher;
 }
 
@@ -138,6 +218,20 @@ void ctkCmdLineModuleDirectoryWatcherPrivate::setDebug(bool debug)
 }
 
 
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleDirectoryWatcherPrivate::setMaximumConcurrentRegistrations(int count)
+{
+  this->RegistrationPool.setMaxThreadCount(qMax(1, count));
+}
+
+
+//-----------------------------------------------------------------------------
+int ctkCmdLineModuleDirectoryWatcherPrivate::maximumConcurrentRegistrations() const
+{
+  return this->RegistrationPool.maxThreadCount();
+}
+
+
 //-----------------------------------------------------------------------------
 void ctkCmdLineModuleDirectoryWatcherPrivate::setDirectories(const QStringList& directories)
 {
@@ -415,21 +509,63 @@ void ctkCmdLineModuleDirectoryWatcherPrivate::updateModules(const QString &direc
 //-----------------------------------------------------------------------------
 QList<ctkCmdLineModuleReferenceResult> ctkCmdLineModuleDirectoryWatcherPrivate::loadModules(const QStringList& executables)
 {
-  QList<ctkCmdLineModuleReferenceResult> refResults = QtConcurrent::blockingMapped(executables,
-                                                                                   ctkCmdLineModuleConcurrentRegister(this->ModuleManager, this->Debug));
+  QList<ctkCmdLineModuleReferenceResult> refResults;
+  if (executables.isEmpty())
+  {
+    return refResults;
+  }
 
+  bool wasLoading = this->Loading;
+  this->Loading = true;
+
+  QEventLoop loop;
+  ctkCmdLineModuleRegistrationBatch batch(executables.size());
+  batch.Loop = &loop;
   for (int i = 0; i < executables.size(); ++i)
   {
-    if (refResults[i].m_Reference)
+    this->RegistrationPool.start(new ctkCmdLineModuleRegistrationTask(this->ModuleManager, this->Debug,
+                                                                      executables[i], i, &batch));
+  }
+
+  // Process the events while the modules are registered, so that the
+  // moduleRegistered() signals are delivered as the modules finish.
+  batch.Mutex.lock();
+  while (batch.Remaining > 0 || !batch.Finished.isEmpty())
+  {
+    QList<int> finished;
+    finished.swap(batch.Finished);
+    int remaining = batch.Remaining;
+    batch.Mutex.unlock();
+
+    foreach (int i, finished)
+    {
+      if (batch.Results[i].m_Reference)
+      {
+        this->MapFileNameToReferenceResult[executables[i]] = batch.Results[i];
+      }
+      if (this->Debug) qDebug() << "ctkCmdLineModuleDirectoryWatcherPrivate::loadModules finished" << executables[i];
+    }
+    if (remaining > 0)
     {
-      this->MapFileNameToReferenceResult[executables[i]] = refResults[i];
+      loop.exec(QEventLoop::ExcludeUserInputEvents);
     }
+
+    batch.Mutex.lock();
   }
+  batch.Mutex.unlock();
+
+  this->Loading = wasLoading;
+  refResults = batch.Results.toList();
 
   // Broadcast error messages.
   QString errorMessages = ctkCmdLineModuleUtils::errorMessagesFromModuleRegistration(refResults, this->ModuleManager->validationMode());
   q->emitErrorDectectedSignal(errorMessages);
 
+  if (!this->Loading && (!this->DeferredFiles.isEmpty() || !this->DeferredDirectories.isEmpty()))
+  {
+    QTimer::singleShot(0, this, SLOT(processDeferredChanges()));
+  }
+
   return refResults;
 }
 
@@ -448,6 +584,12 @@ void ctkCmdLineModuleDirectoryWatcherPrivate::unloadModules(const QStringList& e
 //-----------------------------------------------------------------------------
 void ctkCmdLineModuleDirectoryWatcherPrivate::onFileChanged(const QString& path)
 {
+  if (this->Loading)
+  {
+    if (!this->DeferredFiles.contains(path)) this->DeferredFiles << path;
+    return;
+  }
+
   ctkCmdLineModuleReferenceResult refResult = this->loadModules(QStringList() << path).front();
   if (refResult.m_Reference)
   {
@@ -463,6 +605,12 @@ void ctkCmdLineModuleDirectoryWatcherPrivate::onFileChanged(const QString& path)
 //-----------------------------------------------------------------------------
 void ctkCmdLineModuleDirectoryWatcherPrivate::onDirectoryChanged(const QString &path)
 {
+  if (this->Loading)
+  {
+    if (!this->DeferredDirectories.contains(path)) this->DeferredDirectories << path;
+    return;
+  }
+
   QStringList directories;
   directories << path;
 
@@ -481,3 +629,25 @@ void ctkCmdLineModuleDirectoryWatcherPrivate::onDirectoryChanged(const QString &
 }
 
 
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleDirectoryWatcherPrivate::processDeferredChanges()
+{
+  if (this->Loading)
+  {
+    return;
+  }
+
+  QStringList directories;
+  directories.swap(this->DeferredDirectories);
+  foreach (QString directory, directories)
+  {
+    this->onDirectoryChanged(directory);
+  }
+
+  QStringList files;
+  files.swap(this->DeferredFiles);
+  foreach (QString file, files)
+  {
+    this->onFileChanged(file);
+  }
+}
@@ -59,6 +59,10 @@ class ctkCmdLineModuleDirectoryWatcherPrivate;
  *
  * If either directories or files are invalid (not existing, not executable etc),
  * they are filtered out and ignored.
+ *
+ * The modules are registered concurrently. While they are registered, the events
+ * of the calling thread are processed, so that the ctkCmdLineModuleManager::moduleRegistered()
+ * signal of each module is delivered as soon as the module is available.
  */
 class CTK_CMDLINEMODULECORE_EXPORT ctkCmdLineModuleDirectoryWatcher
 : public QObject
@@ -76,6 +80,21 @@ public:
    */
   void setDebug(bool debug);
 
+  /**
+   * \brief Set the maximum number of modules registered concurrently.
+   *
+   * Each module retrieves its XML description in its own slot with the time-out
+   * of the ctkCmdLineModuleManager, so a hanging module only delays the modules
+   * waiting for its slot. The default is QThread::idealThreadCount().
+   * \param count the maximum number of concurrent registrations, at least 1.
+   */
+  void setMaximumConcurrentRegistrations(int count);
+
+  /**
+   * \brief Returns the maximum number of modules registered concurrently.
+   */
+  int maximumConcurrentRegistrations() const;
+
   /**
    * \brief Set the directories to be watched.
    * \param directories a list of directory names. If any of these are
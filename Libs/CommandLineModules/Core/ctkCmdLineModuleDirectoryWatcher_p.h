@@ -25,6 +25,7 @@
 #include <QString>
 #include <QStringList>
 #include <QFileInfoList>
+#include <QThreadPool>
 
 #include "ctkCmdLineModuleReferenceResult.h"
 #include "ctkCmdLineModuleDirectoryWatcher.h"
@@ -55,6 +56,16 @@ public:
    */
   void setDebug(bool debug);
 
+  /**
+   * \see ctkCmdLineModuleDirectoryWatcher::setMaximumConcurrentRegistrations
+   */
+  void setMaximumConcurrentRegistrations(int count);
+
+  /**
+   * \see ctkCmdLineModuleDirectoryWatcher::maximumConcurrentRegistrations
+   */
+  int maximumConcurrentRegistrations() const;
+
   /**
    * \see ctkCmdLineModuleDirectoryWatcher::setDirectories
    */
@@ -92,6 +103,11 @@ public Q_SLOTS:
    */
   void onDirectoryChanged(const QString &path);
 
+  /**
+   * \brief Handles the changes reported while modules were being loaded.
+   */
+  void processDeferredChanges();
+
 private:
 
   /**
@@ -155,6 +171,10 @@ private:
    * \brief Uses the ctkCmdLineModuleManager to try and add the executables to the list
    * of executables, and if successful it is added to this->MapFileNameToReference.
    *
+   * The executables are registered in this->RegistrationPool, and the events are processed
+   * until all of them are finished. The changes reported by the QFileSystemWatcher meanwhile
+   * are deferred to processDeferredChanges().
+   *
    * \param executables A list of paths to executable files, denoted by an absolute path.
    */
   QList<ctkCmdLineModuleReferenceResult> loadModules(const QStringList& executables);
@@ -171,6 +191,10 @@ private:
   ctkCmdLineModuleManager* ModuleManager;
   QFileSystemWatcher* FileSystemWatcher;
   QStringList AdditionalModules;
+  QThreadPool RegistrationPool;
+  bool Loading;
+  QStringList DeferredFiles;
+  QStringList DeferredDirectories;
   bool Debug;
 };
 
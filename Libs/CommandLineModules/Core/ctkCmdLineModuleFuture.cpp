@@ -44,6 +44,12 @@ QByteArray ctkCmdLineModuleFuture::readAllErrorData() const
   return d.errorData();
 }
 
+//----------------------------------------------------------------------------
+ctkCmdLineModuleRunMetrics ctkCmdLineModuleFuture::metrics() const
+{
+  return d.metrics();
+}
+
 //----------------------------------------------------------------------------
 bool ctkCmdLineModuleFuture::canCancel() const
 {
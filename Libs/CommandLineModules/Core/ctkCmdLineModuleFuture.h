@@ -62,6 +62,15 @@ public:
    */
   QByteArray readAllErrorData() const;
 
+  /**
+   * @brief Get the execution metrics of the module reported so far.
+   *
+   * The metrics are complete once the future is finished.
+   *
+   * @return The metrics of this run.
+   */
+  ctkCmdLineModuleRunMetrics metrics() const;
+
   /**
    * @brief Check if this module can be canceled via cancel().
    * @return \c true if this module can be canceled, \c false otherwise.
@@ -198,6 +198,33 @@ void QFutureInterface<ctkCmdLineModuleResult>::reportErrorData(const QByteArray&
   d->sendCallOut(ctkCmdLineModuleFutureCallOutEvent(ctkCmdLineModuleFutureCallOutEvent::ErrorReady));
 }
 
+//----------------------------------------------------------------------------
+void QFutureInterface<ctkCmdLineModuleResult>::reportMetrics(const ctkCmdLineModuleRunMetrics& metrics)
+{
+  QMutexLocker l(&d->Mutex);
+
+  ctkCmdLineModuleRunMetrics& m = d->Metrics;
+  if (metrics.QueueWaitTime >= 0) m.QueueWaitTime = metrics.QueueWaitTime;
+  if (metrics.SpawnTime >= 0) m.SpawnTime = metrics.SpawnTime;
+  if (metrics.WallTime >= 0) m.WallTime = metrics.WallTime;
+  if (metrics.CpuTime >= 0) m.CpuTime = metrics.CpuTime;
+  if (metrics.PeakResidentSetSize >= 0) m.PeakResidentSetSize = metrics.PeakResidentSetSize;
+  if (metrics.OutputBytes >= 0) m.OutputBytes = metrics.OutputBytes;
+  if (metrics.ErrorBytes >= 0) m.ErrorBytes = metrics.ErrorBytes;
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleRunMetrics QFutureInterface<ctkCmdLineModuleResult>::metrics() const
+{
+  QMutexLocker l(&d->Mutex);
+
+  ctkCmdLineModuleRunMetrics m = d->Metrics;
+  // default to the amount of data reported so far
+  if (m.OutputBytes < 0) m.OutputBytes = d->OutputData.size();
+  if (m.ErrorBytes < 0) m.ErrorBytes = d->ErrorData.size();
+  return m;
+}
+
 //----------------------------------------------------------------------------
 QByteArray QFutureInterface<ctkCmdLineModuleResult>::outputData(int position, int size) const
 {
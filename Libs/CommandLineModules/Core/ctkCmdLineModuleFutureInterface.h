@@ -25,6 +25,7 @@
 #include <ctkCommandLineModulesCoreExport.h>
 
 #include "ctkCmdLineModuleResult.h"
+#include "ctkCmdLineModuleRunMetrics.h"
 
 #include <QFutureInterface>
 #if (QT_VERSION < 0x50000)
@@ -77,6 +78,14 @@ public:
   void reportOutputData(const QByteArray& outputData);
   void reportErrorData(const QByteArray& errorData);
 
+  /**
+   * @brief Report the metrics measured by the backend for this run.
+   *
+   * Only the values which are not -1 replace the previously reported ones. The
+   * output and error byte counts are derived from the reported data if not given.
+   */
+  void reportMetrics(const ctkCmdLineModuleRunMetrics& metrics);
+
   inline const ctkCmdLineModuleResult &resultReference(int index) const;
   inline const ctkCmdLineModuleResult *resultPointer(int index) const;
   inline QList<ctkCmdLineModuleResult> results();
@@ -84,6 +93,8 @@ public:
   QByteArray outputData(int position = 0, int size = -1) const;
   QByteArray errorData(int position = 0, int size = -1) const;
 
+  ctkCmdLineModuleRunMetrics metrics() const;
+
 private:
 
   friend struct ctkCmdLineModuleFutureWatcherPrivate;
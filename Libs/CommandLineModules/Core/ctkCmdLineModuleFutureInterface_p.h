@@ -26,6 +26,8 @@
 #include <QAtomicInt>
 #include <QMutex>
 
+#include "ctkCmdLineModuleRunMetrics.h"
+
 class ctkCmdLineModuleFutureCallOutEvent : public QEvent
 {
 public:
@@ -80,6 +82,8 @@ public:
   QByteArray OutputData;
   QByteArray ErrorData;
 
+  ctkCmdLineModuleRunMetrics Metrics;
+
   ctkCmdLineModuleFutureInterface* q;
 
   void sendCallOut(const ctkCmdLineModuleFutureCallOutEvent &callOut);
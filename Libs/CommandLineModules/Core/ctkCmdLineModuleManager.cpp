@@ -22,6 +22,7 @@
 #include "ctkCmdLineModuleManager.h"
 
 #include "ctkCmdLineModuleBackend.h"
+#include "ctkCmdLineModuleConcurrentHelpers.h"
 #include "ctkCmdLineModuleFrontend.h"
 #include "ctkCmdLineModuleTimeoutException.h"
 #include "ctkCmdLineModuleCache_p.h"
@@ -29,12 +30,15 @@
 #include "ctkCmdLineModuleXmlValidator.h"
 #include "ctkCmdLineModuleReference.h"
 #include "ctkCmdLineModuleReference_p.h"
+#include "ctkCmdLineModuleResultCache_p.h"
 #include "ctkCmdLineModuleRunException.h"
+#include "ctkCmdLineModuleScheduler.h"
 #include "ctkCmdLineModuleXmlException.h"
 #include "ctkCmdLineModuleTimeoutException.h"
 
 #include <ctkException.h>
 
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QDir>
 #include <QStringList>
@@ -45,6 +49,10 @@
 #include <QMutex>
 #include <QDebug>
 #include <QFuture>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 #include <algorithm>
 
@@ -52,13 +60,66 @@
 extern int qHash(const QUrl& url);
 #endif
 
+namespace {
+
+//----------------------------------------------------------------------------
+// Results of a registerModules() call
+struct ctkCmdLineModuleRegistrationBatch
+{
+  QMutex Mutex;
+  QWaitCondition Finished;
+  int Remaining;
+  QList<ctkCmdLineModuleReferenceResult> Results;
+};
+
+//----------------------------------------------------------------------------
+class ctkCmdLineModuleManagerRegistrationTask : public QRunnable
+{
+public:
+
+  ctkCmdLineModuleManagerRegistrationTask(ctkCmdLineModuleManager* manager, bool debug,
+                                          const QString& location, int index,
+                                          ctkCmdLineModuleRegistrationBatch* batch)
+    : Manager(manager)
+    , Debug(debug)
+    , Location(location)
+    , Index(index)
+    , Batch(batch)
+  {}
+
+  virtual void run()
+  {
+    ctkCmdLineModuleReferenceResult result =
+        ctkCmdLineModuleConcurrentRegister(this->Manager, this->Debug)(this->Location);
+    QMutexLocker lock(&this->Batch->Mutex);
+    this->Batch->Results[this->Index] = result;
+    if (--this->Batch->Remaining == 0)
+    {
+      this->Batch->Finished.wakeAll();
+    }
+  }
+
+private:
+
+  ctkCmdLineModuleManager* Manager;
+  bool Debug;
+  QString Location;
+  int Index;
+  ctkCmdLineModuleRegistrationBatch* Batch;
+};
+
+}
+
 //----------------------------------------------------------------------------
 struct ctkCmdLineModuleManagerPrivate
 {
   ctkCmdLineModuleManagerPrivate(ctkCmdLineModuleManager::ValidationMode mode, const QString& cacheDir)
     : XmlTimeOut(30000)
     , ValidationMode(mode)
+    , ResultCacheEnabled(false)
   {
+    RegistrationPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+
     QFileInfo fileInfo(cacheDir);
     if (!fileInfo.exists())
     {
@@ -72,6 +133,8 @@ struct ctkCmdLineModuleManagerPrivate
     if (fileInfo.isWritable())
     {
       ModuleCache.reset(new ctkCmdLineModuleCache(cacheDir));
+      ResultCache = QSharedPointer<ctkCmdLineModuleResultCache>(
+                      new ctkCmdLineModuleResultCache(cacheDir + "/results"));
     }
     else
     {
@@ -94,6 +157,16 @@ struct ctkCmdLineModuleManagerPrivate
   int XmlTimeOut;
 
   ctkCmdLineModuleManager::ValidationMode ValidationMode;
+
+  // Shared with the recorders of the running modules
+  QSharedPointer<ctkCmdLineModuleResultCache> ResultCache;
+  bool ResultCacheEnabled;
+
+  mutable ctkCmdLineModuleScheduler Scheduler;
+
+  // Declared last, so that the registrations and then the running tasks
+  // are finished first.
+  mutable QThreadPool RegistrationPool;
 };
 
 //----------------------------------------------------------------------------
@@ -195,6 +268,7 @@ ctkCmdLineModuleManager::registerModule(const QUrl &location)
   }
 
   bool fromCache = false;
+  QElapsedTimer xmlRetrievalTimer;
   qint64 newTimeStamp = 0;
   qint64 cacheTimeStamp = 0;
   int timeout = backend->timeOutForXmlRetrieval();
@@ -210,15 +284,31 @@ ctkCmdLineModuleManager::registerModule(const QUrl &location)
     if (cacheTimeStamp < 0                // i.e. timestamp is invalid
         || cacheTimeStamp < newTimeStamp) // i.e. timestamp is genuinely out of date
     {
+      // skip modules which already timed out, until they are modified or
+      // a larger timeout is used
+      qint64 timeOutTimeStamp = 0;
+      int cachedTimeOut = d->ModuleCache->xmlRetrievalTimeOut(location, &timeOutTimeStamp);
+      if (cachedTimeOut >= timeout && timeOutTimeStamp == newTimeStamp)
+      {
+        throw ctkCmdLineModuleTimeoutException(location,
+                                               QString("Retrieving the XML description timed out after %1 ms "
+                                                       "before, the module is skipped until it is modified.")
+                                               .arg(cachedTimeOut));
+      }
+
       // newly fetch the XML description
       try
       {
+        xmlRetrievalTimer.start();
         xml = backend->rawXmlDescription(location, timeout);
+        d->ModuleCache->removeXmlRetrievalTimeOut(location);
       }
       catch (const ctkCmdLineModuleTimeoutException&)
       {
         // in case of a time-out, do not cache it as a failed attempt
-        // by recording an empty QByteArray in the cache
+        // by recording an empty QByteArray in the cache, but remember
+        // the timeout so that a hanging module does not delay every start
+        d->ModuleCache->cacheXmlRetrievalTimeOut(location, newTimeStamp, timeout);
         throw;
       }
       catch (...)
@@ -239,6 +329,7 @@ ctkCmdLineModuleManager::registerModule(const QUrl &location)
   {
     try
     {
+      xmlRetrievalTimer.start();
       xml = backend->rawXmlDescription(location, timeout);
     }
     catch (const ctkCmdLineModuleRunException& e)
@@ -266,38 +357,50 @@ ctkCmdLineModuleManager::registerModule(const QUrl &location)
   ref.d->Location = location;
   ref.d->RawXmlDescription = xml;
   ref.d->Backend = backend;
+  ref.d->XmlRetrievalTime = fromCache ? 0 : xmlRetrievalTimer.elapsed();
+
+  // true if the XML description is in the cache, which can then hold the
+  // parsed description as well
+  bool xmlCached = fromCache;
 
   if (d->ValidationMode != SKIP_VALIDATION)
   {
-    // validate the outputted xml description
-    QBuffer input(&xml);
-    input.open(QIODevice::ReadOnly);
+    bool valid = true;
+    QString validationErrorString;
 
-    ctkCmdLineModuleXmlValidator validator(&input);
-    if (!validator.validateInput())
+    // an unchanged module is only validated once
+    if (!fromCache || !d->ModuleCache->xmlValidationResult(location, &valid, &validationErrorString))
     {
-      if (d->ModuleCache)
+      // validate the outputted xml description
+      QBuffer input(&xml);
+      input.open(QIODevice::ReadOnly);
+
+      ctkCmdLineModuleXmlValidator validator(&input);
+      valid = validator.validateInput();
+      validationErrorString = validator.errorString();
+
+      if (d->ModuleCache && !fromCache && (!valid || newTimeStamp > 0))
       {
-        // validation failed, cache the description anyway
+        // cache the xml, even if the validation failed
         d->ModuleCache->cacheXmlDescription(location, newTimeStamp, xml);
+        xmlCached = true;
+      }
+      if (xmlCached)
+      {
+        d->ModuleCache->cacheXmlValidationResult(location, valid, validationErrorString);
       }
+    }
 
+    if (!valid)
+    {
       if (d->ValidationMode == STRICT_VALIDATION)
       {
         throw ctkInvalidArgumentException(QString("Validating module at %1 failed: %2")
-                                          .arg(location.toString()).arg(validator.errorString()));
+                                          .arg(location.toString()).arg(validationErrorString));
       }
       else
       {
-        ref.d->XmlValidationErrorString = validator.errorString();
-      }
-    }
-    else
-    {
-      if (d->ModuleCache && newTimeStamp > 0 && !fromCache)
-      {
-        // successfully validated the xml, cache it
-        d->ModuleCache->cacheXmlDescription(location, newTimeStamp, xml);
+        ref.d->XmlValidationErrorString = validationErrorString;
       }
     }
   }
@@ -307,6 +410,21 @@ ctkCmdLineModuleManager::registerModule(const QUrl &location)
     {
       // cache it
       d->ModuleCache->cacheXmlDescription(location, newTimeStamp, xml);
+      xmlCached = true;
+    }
+  }
+
+  if (xmlCached)
+  {
+    // Use the cached parsed description of an unchanged module, otherwise
+    // parse it now and cache it for the next registration
+    if (!fromCache || !ref.d->setSerializedDescription(d->ModuleCache->serializedDescription(location)))
+    {
+      QByteArray description = ref.d->serializedDescription();
+      if (!description.isEmpty())
+      {
+        d->ModuleCache->cacheSerializedDescription(location, description);
+      }
     }
   }
 
@@ -346,6 +464,36 @@ void ctkCmdLineModuleManager::unregisterModule(const ctkCmdLineModuleReference&
 }
 
 
+//----------------------------------------------------------------------------
+QList<ctkCmdLineModuleReferenceResult> ctkCmdLineModuleManager::registerModules(const QStringList& locations,
+                                                                               bool debug)
+{
+  ctkCmdLineModuleRegistrationBatch batch;
+  batch.Remaining = locations.size();
+  for (int i = 0; i < locations.size(); ++i)
+  {
+    batch.Results << ctkCmdLineModuleReferenceResult();
+  }
+  for (int i = 0; i < locations.size(); ++i)
+  {
+    d->RegistrationPool.start(new ctkCmdLineModuleManagerRegistrationTask(this, debug, locations[i],
+                                                                          i, &batch));
+  }
+
+  QMutexLocker lock(&batch.Mutex);
+  while (batch.Remaining > 0)
+  {
+    batch.Finished.wait(&batch.Mutex);
+  }
+  return batch.Results;
+}
+
+//----------------------------------------------------------------------------
+QThreadPool* ctkCmdLineModuleManager::registrationThreadPool() const
+{
+  return &d->RegistrationPool;
+}
+
 //----------------------------------------------------------------------------
 void ctkCmdLineModuleManager::clearCache()
 {
@@ -371,11 +519,105 @@ QList<ctkCmdLineModuleReference> ctkCmdLineModuleManager::moduleReferences() con
 //----------------------------------------------------------------------------
 ctkCmdLineModuleFuture ctkCmdLineModuleManager::run(ctkCmdLineModuleFrontend *frontend)
 {
-  QMutexLocker lock(&d->Mutex);
-  d->checkBackends_unlocked(frontend->location());
+  ctkCmdLineModuleBackend* backend = NULL;
+  QSharedPointer<ctkCmdLineModuleResultCache> resultCache;
+  {
+    QMutexLocker lock(&d->Mutex);
+    d->checkBackends_unlocked(frontend->location());
+    backend = d->SchemeToBackend[frontend->location().scheme()];
+    if (d->ResultCacheEnabled)
+    {
+      resultCache = d->ResultCache;
+    }
+  }
 
-  ctkCmdLineModuleFuture future = d->SchemeToBackend[frontend->location().scheme()]->run(frontend);
+  // The input files are hashed without holding the lock
+  QByteArray resultKey;
+  QStringList outputFiles;
+  if (resultCache)
+  {
+    resultKey = ctkCmdLineModuleResultCache::key(frontend, backend->timeStamp(frontend->location()));
+    outputFiles = ctkCmdLineModuleResultCache::outputFiles(frontend);
+  }
+
+  ctkCmdLineModuleFuture future;
+  if (resultKey.isEmpty() || !resultCache->restore(resultKey, outputFiles, &future))
+  {
+    future = backend->runScheduled(frontend, &d->Scheduler);
+    if (!resultKey.isEmpty())
+    {
+      // Deletes itself once the module has finished
+      new ctkCmdLineModuleResultCacheRecorder(resultCache, resultKey, outputFiles, future);
+    }
+  }
   frontend->setFuture(future);
   emit frontend->started();
   return future;
 }
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleManager::setResultCacheEnabled(bool enabled)
+{
+  QMutexLocker lock(&d->Mutex);
+  if (enabled && !d->ResultCache)
+  {
+    qWarning() << "Command line module result cache not available without a cache directory.";
+    return;
+  }
+  d->ResultCacheEnabled = enabled;
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleManager::isResultCacheEnabled() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->ResultCacheEnabled;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleManager::setResultCacheMaximumSize(qint64 bytes)
+{
+  if (d->ResultCache) d->ResultCache->setMaximumSize(bytes);
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkCmdLineModuleManager::resultCacheMaximumSize() const
+{
+  return d->ResultCache ? d->ResultCache->maximumSize() : 0;
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkCmdLineModuleManager::resultCacheSize() const
+{
+  return d->ResultCache ? d->ResultCache->size() : 0;
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleManager::resultCacheCount() const
+{
+  return d->ResultCache ? d->ResultCache->count() : 0;
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleManager::resultCacheHits() const
+{
+  return d->ResultCache ? d->ResultCache->hits() : 0;
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleManager::resultCacheMisses() const
+{
+  return d->ResultCache ? d->ResultCache->misses() : 0;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleManager::clearResultCache()
+{
+  if (d->ResultCache) d->ResultCache->clear();
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleScheduler* ctkCmdLineModuleManager::scheduler() const
+{
+  return &d->Scheduler;
+}
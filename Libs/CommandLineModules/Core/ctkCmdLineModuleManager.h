@@ -29,11 +29,15 @@
 #include <QString>
 #include <QStringList>
 #include "ctkCmdLineModuleReference.h"
+#include "ctkCmdLineModuleReferenceResult.h"
+
+class QThreadPool;
 
 struct ctkCmdLineModuleBackend;
 struct ctkCmdLineModuleFrontendFactory;
 class ctkCmdLineModuleFrontend;
 class ctkCmdLineModuleFuture;
+class ctkCmdLineModuleScheduler;
 
 struct ctkCmdLineModuleManagerPrivate;
 
@@ -115,7 +119,9 @@ public:
   /**
    * @brief Set the timeout for retrieving the XML parameter description from a module.
    *
-   * The default time-out is 30 seconds.
+   * The default time-out is 30 seconds. If the module cache is enabled, a module
+   * which timed out is not run again by registerModule() until it is modified or
+   * a larger time-out is set, a ctkCmdLineModuleTimeoutException is thrown instead.
    *
    * @param timeout The timeout in milli seconds.
    */
@@ -169,6 +175,29 @@ public:
    */
   void unregisterModule(const ctkCmdLineModuleReference& moduleRef);
 
+  /**
+   * @brief Registers modules concurrently, on the registration thread pool.
+   * @param locations The local file paths of the modules.
+   * @param debug Print the registration errors with qDebug().
+   * @return The registration results, in the order of <code>locations</code>.
+   *
+   * This method blocks until all modules are registered. Instead of being thrown,
+   * the registration errors are reported in the results.
+   *
+   * @see ctkCmdLineModuleConcurrentRegister
+   * @see registrationThreadPool()
+   */
+  QList<ctkCmdLineModuleReferenceResult> registerModules(const QStringList& locations, bool debug = false);
+
+  /**
+   * @brief Get the thread pool registering the modules in registerModules().
+   * @return The pool owned by this manager, with QThread::idealThreadCount() threads by default.
+   *
+   * The registrations do not compete with the module runs, which are limited by the
+   * scheduler(), nor with the other users of QThreadPool::globalInstance().
+   */
+  QThreadPool* registrationThreadPool() const;
+
   /**
    * @brief Clears the XML/timestamp cache.
    */
@@ -203,6 +232,66 @@ public:
    */
   ctkCmdLineModuleFuture run(ctkCmdLineModuleFrontend* frontend);
 
+  /**
+   * @brief Enable the cache of the results of module runs, disabled by default.
+   *
+   * When enabled, run() computes a key from the module location and time stamp, the
+   * parameter values and the content of the input files. If a run with the same key
+   * finished successfully before, the output files of that run are copied to the
+   * current output locations and a finished future reporting the same results and
+   * output data is returned, without running the module. The cache needs the cache
+   * directory given to the constructor, and runs with a directory parameter are not cached.
+   *
+   * Only enable it for deterministic modules. The results are recorded once the run
+   * has finished, which requires an event loop in the thread calling run().
+   */
+  void setResultCacheEnabled(bool enabled);
+  bool isResultCacheEnabled() const;
+
+  /**
+   * @brief Set the number of bytes the result cache may use, 512 MB by default.
+   *
+   * The least recently used runs are removed when the cache grows larger.
+   */
+  void setResultCacheMaximumSize(qint64 bytes);
+  qint64 resultCacheMaximumSize() const;
+
+  /**
+   * @brief Returns the number of bytes used by the result cache.
+   */
+  qint64 resultCacheSize() const;
+
+  /**
+   * @brief Returns the number of runs in the result cache.
+   */
+  int resultCacheCount() const;
+
+  /**
+   * @brief Returns the number of runs served from the result cache since it was created or cleared.
+   */
+  int resultCacheHits() const;
+
+  /**
+   * @brief Returns the number of runs not found in the result cache since it was created or cleared.
+   */
+  int resultCacheMisses() const;
+
+  /**
+   * @brief Removes all runs from the result cache and resets its hit and miss counts.
+   */
+  void clearResultCache();
+
+  /**
+   * @brief Get the scheduler used by the back-ends to run modules.
+   * @return The scheduler owned by this manager.
+   *
+   * Use it to limit the number of concurrently running modules, globally, per
+   * module or per back-end, or to give priorities and costs to modules.
+   *
+   * @see ctkCmdLineModuleScheduler
+   */
+  ctkCmdLineModuleScheduler* scheduler() const;
+
 Q_SIGNALS:
 
   /**
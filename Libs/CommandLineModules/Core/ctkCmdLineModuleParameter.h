@@ -223,6 +223,7 @@ private:
 
   friend struct ctkCmdLineModuleParameterParser;
   friend class ctkCmdLineModuleXmlParser;
+  friend class ctkCmdLineModuleDescriptionSerializer;
 
   ctkCmdLineModuleParameter();
 
@@ -63,6 +63,7 @@ public:
 private:
 
   friend class ctkCmdLineModuleXmlParser;
+  friend class ctkCmdLineModuleDescriptionSerializer;
 
   ctkCmdLineModuleParameterGroup();
 
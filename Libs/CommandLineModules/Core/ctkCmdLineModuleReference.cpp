@@ -21,6 +21,7 @@
 
 #include "ctkCmdLineModuleReference.h"
 #include "ctkCmdLineModuleReference_p.h"
+#include "ctkCmdLineModuleDescriptionSerializer_p.h"
 #include "ctkCmdLineModuleXmlParser_p.h"
 #include "ctkCmdLineModuleXmlException.h"
 
@@ -29,7 +30,7 @@
 
 //----------------------------------------------------------------------------
 ctkCmdLineModuleReferencePrivate::ctkCmdLineModuleReferencePrivate()
-  : Backend(NULL), XmlException(NULL)
+  : Backend(NULL), XmlRetrievalTime(-1), XmlException(NULL)
 {
 }
 
@@ -67,6 +68,33 @@ ctkCmdLineModuleDescription ctkCmdLineModuleReferencePrivate::description() cons
   return Description;
 }
 
+//----------------------------------------------------------------------------
+QByteArray ctkCmdLineModuleReferencePrivate::serializedDescription() const
+{
+  if (!XmlException)
+  {
+    this->description();
+  }
+  if (XmlException)
+  {
+    return QByteArray();
+  }
+  return ctkCmdLineModuleDescriptionSerializer::serialize(Description);
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleReferencePrivate::setSerializedDescription(const QByteArray& data)
+{
+  ctkCmdLineModuleDescription description;
+  if (!ctkCmdLineModuleDescriptionSerializer::deserialize(data, &description) ||
+      description.title().isNull())
+  {
+    return false;
+  }
+  Description = description;
+  return true;
+}
+
 //----------------------------------------------------------------------------
 ctkCmdLineModuleReference::ctkCmdLineModuleReference()
   : d(new ctkCmdLineModuleReferencePrivate())
@@ -108,6 +136,12 @@ QByteArray ctkCmdLineModuleReference::rawXmlDescription() const
   return d->RawXmlDescription;
 }
 
+//----------------------------------------------------------------------------
+qint64 ctkCmdLineModuleReference::xmlRetrievalTime() const
+{
+  return d->XmlRetrievalTime;
+}
+
 //----------------------------------------------------------------------------
 QString ctkCmdLineModuleReference::xmlValidationErrorString() const
 {
@@ -72,6 +72,13 @@ public:
    */
   QByteArray rawXmlDescription() const;
 
+  /**
+   * @brief Get the time needed by the back-end to supply the raw XML description.
+   * @return The retrieval time in milliseconds, 0 if the description was taken
+   *         from the module cache or -1 for an invalid reference.
+   */
+  qint64 xmlRetrievalTime() const;
+
   /**
    * @brief Retrieve a validation error string.
    * @return A non-empty string describing the validation error, if validation
@@ -37,10 +37,24 @@ struct ctkCmdLineModuleReferencePrivate : public QSharedData
 
   ctkCmdLineModuleDescription description() const;
 
+  /**
+   * @brief Parses the XML description and returns it in the form of
+   * ctkCmdLineModuleDescriptionSerializer, or an empty array if it is invalid.
+   */
+  QByteArray serializedDescription() const;
+
+  /**
+   * @brief Uses a description serialized by serializedDescription() instead of
+   * parsing the XML description.
+   * @return false if the data could not be restored
+   */
+  bool setSerializedDescription(const QByteArray& data);
+
   ctkCmdLineModuleBackend* Backend;
   QUrl Location;
   QByteArray RawXmlDescription;
   QString XmlValidationErrorString;
+  qint64 XmlRetrievalTime;
 
 private:
 
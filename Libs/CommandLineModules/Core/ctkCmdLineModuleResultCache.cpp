@@ -0,0 +1,451 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkCmdLineModuleResultCache_p.h"
+
+#include "ctkCmdLineModuleDescription.h"
+#include "ctkCmdLineModuleFrontend.h"
+#include "ctkCmdLineModuleParameter.h"
+#include "ctkCmdLineModuleParameterGroup.h"
+#include "ctkCmdLineModuleReference.h"
+#include "ctkCmdLineModuleResult.h"
+
+#include <ctkUtils.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QUrl>
+#include <QVector>
+
+namespace {
+
+const quint32 EntryFileMagic = 0x63746b52; // "ctkR"
+const quint32 EntryFileVersion = 1;
+const char EntryFileName[] = "entry.bin";
+const char UsedFileName[] = "used";
+
+//----------------------------------------------------------------------------
+bool isFileParameter(const ctkCmdLineModuleParameter& parameter)
+{
+  static QStringList fileTags = QStringList() << "file" << "image" << "geometry" << "transform"
+                                              << "table" << "measurement" << "pointfile";
+  return fileTags.contains(parameter.tag());
+}
+
+//----------------------------------------------------------------------------
+QStringList parameterFiles(ctkCmdLineModuleFrontend* frontend, const ctkCmdLineModuleParameter& parameter)
+{
+  QString value = frontend->value(parameter.name()).toString();
+  if (value.isEmpty()) return QStringList();
+  return parameter.multiple() ? value.split(',', QString::SkipEmptyParts) : QStringList(value);
+}
+
+//----------------------------------------------------------------------------
+QList<ctkCmdLineModuleParameter> moduleParameters(ctkCmdLineModuleFrontend* frontend)
+{
+  QList<ctkCmdLineModuleParameter> parameters;
+  foreach(const ctkCmdLineModuleParameterGroup& group,
+          frontend->moduleReference().description().parameterGroups())
+  {
+    parameters << group.parameters();
+  }
+  return parameters;
+}
+
+//----------------------------------------------------------------------------
+qint64 currentTime()
+{
+  return ctk::msecsTo(QDateTime::fromTime_t(0), QDateTime::currentDateTime());
+}
+
+}
+
+//----------------------------------------------------------------------------
+struct ctkCmdLineModuleResultCachePrivate
+{
+  struct Entry
+  {
+    Entry() : Size(0), LastUsed(0) {}
+
+    qint64 Size;
+    qint64 LastUsed;
+  };
+
+  ctkCmdLineModuleResultCachePrivate(const QString& cacheDir)
+    : CacheDir(cacheDir)
+    , MaximumSize(512 * 1024 * 1024)
+    , Size(0)
+    , Hits(0)
+    , Misses(0)
+  {
+    QDir().mkpath(cacheDir);
+    this->ScanEntries();
+  }
+
+  QString EntryDir(const QByteArray& key) const
+  {
+    return CacheDir + "/" + QString::fromLatin1(key.toHex());
+  }
+
+  // Rebuilds the index from the entry directories of a previous session
+  void ScanEntries()
+  {
+    QDir dir(CacheDir);
+    foreach(const QString& name, dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+      QDir entryDir(dir.filePath(name));
+      QFileInfo entryFile(entryDir.filePath(EntryFileName));
+      if (!entryFile.exists())
+      {
+        ctk::removeDirRecursively(entryDir.absolutePath());
+        continue;
+      }
+
+      Entry entry;
+      foreach(const QFileInfo& fileInfo, entryDir.entryInfoList(QDir::Files))
+      {
+        entry.Size += fileInfo.size();
+        entry.LastUsed = qMax(entry.LastUsed, ctk::msecsTo(QDateTime::fromTime_t(0), fileInfo.lastModified()));
+      }
+      Entries.insert(QByteArray::fromHex(name.toLatin1()), entry);
+      Size += entry.Size;
+    }
+  }
+
+  void RemoveEntry(const QByteArray& key)
+  {
+    QHash<QByteArray, Entry>::iterator iter = Entries.find(key);
+    if (iter == Entries.end()) return;
+    Size -= iter.value().Size;
+    Entries.erase(iter);
+    ctk::removeDirRecursively(this->EntryDir(key));
+  }
+
+  // Removes the least recently used entries, except the one of key
+  void Evict(const QByteArray& key)
+  {
+    while (Size > MaximumSize && Entries.size() > 1)
+    {
+      QByteArray oldestKey;
+      qint64 oldest = 0;
+      QHash<QByteArray, Entry>::const_iterator iter = Entries.begin();
+      for (; iter != Entries.end(); ++iter)
+      {
+        if (iter.key() != key && (oldestKey.isEmpty() || iter.value().LastUsed < oldest))
+        {
+          oldestKey = iter.key();
+          oldest = iter.value().LastUsed;
+        }
+      }
+      this->RemoveEntry(oldestKey);
+    }
+  }
+
+  const QString CacheDir;
+  mutable QMutex Mutex;
+  QHash<QByteArray, Entry> Entries;
+  qint64 MaximumSize;
+  qint64 Size;
+  int Hits;
+  int Misses;
+};
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleResultCache::ctkCmdLineModuleResultCache(const QString& cacheDir)
+  : d(new ctkCmdLineModuleResultCachePrivate(cacheDir))
+{
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleResultCache::~ctkCmdLineModuleResultCache()
+{
+}
+
+//----------------------------------------------------------------------------
+QString ctkCmdLineModuleResultCache::cacheDir() const
+{
+  return d->CacheDir;
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkCmdLineModuleResultCache::key(ctkCmdLineModuleFrontend* frontend, qint64 timeStamp)
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(frontend->location().toString().toUtf8());
+  hash.addData(QByteArray::number(timeStamp));
+
+  foreach(const ctkCmdLineModuleParameter& parameter, moduleParameters(frontend))
+  {
+    if (parameter.isReturnParameter()) continue;
+    if (parameter.tag() == "directory")
+    {
+      // The content of a directory is not hashed
+      return QByteArray();
+    }
+
+    hash.addData(parameter.name().toUtf8());
+    hash.addData("", 1);
+    if (parameter.channel() == "output" && isFileParameter(parameter))
+    {
+      // The output files are copied from the cache to whatever location is set
+      continue;
+    }
+    hash.addData(frontend->value(parameter.name()).toString().toUtf8());
+    hash.addData("", 1);
+
+    if (isFileParameter(parameter))
+    {
+      foreach(const QString& fileName, parameterFiles(frontend, parameter))
+      {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+          hash.addData("missing", 7);
+          continue;
+        }
+        QByteArray buffer;
+        while (!(buffer = file.read(64 * 1024)).isEmpty())
+        {
+          hash.addData(buffer);
+        }
+      }
+    }
+  }
+  return hash.result();
+}
+
+//----------------------------------------------------------------------------
+QStringList ctkCmdLineModuleResultCache::outputFiles(ctkCmdLineModuleFrontend* frontend)
+{
+  QStringList files;
+  foreach(const ctkCmdLineModuleParameter& parameter, moduleParameters(frontend))
+  {
+    if (parameter.channel() == "output" && isFileParameter(parameter) && !parameter.isReturnParameter())
+    {
+      files << parameterFiles(frontend, parameter);
+    }
+  }
+  return files;
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleResultCache::restore(const QByteArray& key, const QStringList& outputFiles,
+                                          ctkCmdLineModuleFuture* future)
+{
+  QMutexLocker lock(&d->Mutex);
+
+  QHash<QByteArray, ctkCmdLineModuleResultCachePrivate::Entry>::iterator iter = d->Entries.find(key);
+  if (iter == d->Entries.end())
+  {
+    ++d->Misses;
+    return false;
+  }
+
+  QDir entryDir(d->EntryDir(key));
+  QFile entryFile(entryDir.filePath(EntryFileName));
+  QList<bool> outputs;
+  QList<QPair<QString, QVariant> > results;
+  QByteArray outputData;
+  QByteArray errorData;
+  bool valid = false;
+  if (entryFile.open(QIODevice::ReadOnly))
+  {
+    QDataStream in(&entryFile);
+    in.setVersion(QDataStream::Qt_4_6);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic == EntryFileMagic && version == EntryFileVersion)
+    {
+      in >> outputs >> results >> outputData >> errorData;
+      valid = in.status() == QDataStream::Ok && outputs.size() == outputFiles.size();
+    }
+  }
+
+  for (int i = 0; valid && i < outputs.size(); ++i)
+  {
+    if (!outputs[i]) continue;
+    QFile::remove(outputFiles[i]);
+    valid = QFile::copy(entryDir.filePath(QString("output%1").arg(i)), outputFiles[i]);
+  }
+
+  if (!valid)
+  {
+    d->RemoveEntry(key);
+    ++d->Misses;
+    return false;
+  }
+
+  // Updates the modification time used to order the entries of the next session
+  QFile usedFile(entryDir.filePath(UsedFileName));
+  usedFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+  iter.value().LastUsed = currentTime();
+  ++d->Hits;
+
+  ctkCmdLineModuleFutureInterface futureInterface;
+  futureInterface.reportStarted();
+  if (!outputData.isEmpty()) futureInterface.reportOutputData(outputData);
+  if (!errorData.isEmpty()) futureInterface.reportErrorData(errorData);
+  QVector<ctkCmdLineModuleResult> cachedResults;
+  for (int i = 0; i < results.size(); ++i)
+  {
+    cachedResults.push_back(ctkCmdLineModuleResult(results[i].first, results[i].second));
+  }
+  if (!cachedResults.isEmpty()) futureInterface.reportResults(cachedResults);
+  futureInterface.setProgressRange(0, 1);
+  futureInterface.setProgressValue(1);
+  *future = futureInterface.future();
+  futureInterface.reportFinished();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleResultCache::store(const QByteArray& key, const QStringList& outputFiles,
+                                        const ctkCmdLineModuleFuture& future)
+{
+  QList<QPair<QString, QVariant> > results;
+  foreach(const ctkCmdLineModuleResult& result, future.results())
+  {
+    results.push_back(qMakePair(result.parameter(), result.value()));
+  }
+
+  QMutexLocker lock(&d->Mutex);
+
+  d->RemoveEntry(key);
+  QDir entryDir(d->EntryDir(key));
+  if (!QDir().mkpath(entryDir.absolutePath())) return;
+
+  ctkCmdLineModuleResultCachePrivate::Entry entry;
+  QList<bool> outputs;
+  for (int i = 0; i < outputFiles.size(); ++i)
+  {
+    QString cachedFile = entryDir.filePath(QString("output%1").arg(i));
+    outputs.push_back(QFile::copy(outputFiles[i], cachedFile));
+    if (outputs.back())
+    {
+      entry.Size += QFileInfo(cachedFile).size();
+    }
+  }
+
+  QFile entryFile(entryDir.filePath(EntryFileName));
+  if (!entryFile.open(QIODevice::WriteOnly))
+  {
+    ctk::removeDirRecursively(entryDir.absolutePath());
+    return;
+  }
+  QDataStream out(&entryFile);
+  out.setVersion(QDataStream::Qt_4_6);
+  out << EntryFileMagic << EntryFileVersion << outputs << results
+      << future.readAllOutputData() << future.readAllErrorData();
+  entryFile.close();
+  entry.Size += entryFile.size();
+  entry.LastUsed = currentTime();
+
+  d->Entries.insert(key, entry);
+  d->Size += entry.Size;
+  d->Evict(key);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleResultCache::setMaximumSize(qint64 bytes)
+{
+  QMutexLocker lock(&d->Mutex);
+  d->MaximumSize = bytes;
+  d->Evict(QByteArray());
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkCmdLineModuleResultCache::maximumSize() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->MaximumSize;
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkCmdLineModuleResultCache::size() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->Size;
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleResultCache::count() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->Entries.size();
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleResultCache::hits() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->Hits;
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleResultCache::misses() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->Misses;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleResultCache::clear()
+{
+  QMutexLocker lock(&d->Mutex);
+  foreach(const QByteArray& key, d->Entries.keys())
+  {
+    d->RemoveEntry(key);
+  }
+  d->Hits = 0;
+  d->Misses = 0;
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleResultCacheRecorder::ctkCmdLineModuleResultCacheRecorder(
+    const QSharedPointer<ctkCmdLineModuleResultCache>& cache, const QByteArray& key,
+    const QStringList& outputFiles, const ctkCmdLineModuleFuture& future)
+  : Cache(cache)
+  , Key(key)
+  , OutputFiles(outputFiles)
+{
+  connect(&Watcher, SIGNAL(finished()), SLOT(runFinished()));
+  Watcher.setFuture(future);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleResultCacheRecorder::runFinished()
+{
+  ctkCmdLineModuleFuture future = Watcher.future();
+  // A canceled run reported an error or was stopped by the user
+  if (!future.isCanceled())
+  {
+    Cache->store(Key, OutputFiles, future);
+  }
+  this->deleteLater();
+}
@@ -0,0 +1,143 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKCMDLINEMODULERESULTCACHE_P_H
+#define CTKCMDLINEMODULERESULTCACHE_P_H
+
+#include "ctkCmdLineModuleFuture.h"
+#include "ctkCmdLineModuleFutureWatcher.h"
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QStringList>
+
+class ctkCmdLineModuleFrontend;
+struct ctkCmdLineModuleResultCachePrivate;
+
+/**
+ * \class ctkCmdLineModuleResultCache
+ * \brief Private non-exported class to cache the results of module runs.
+ *
+ * A run is identified by a key hashing the module location and time stamp,
+ * the values of its parameters and the content of its input files. Each entry
+ * is a sub-directory of the cache directory holding the reported results, the
+ * output and error data and a copy of the output files of the run. The least
+ * recently used entries are removed when the cache grows larger than maximumSize().
+ *
+ * This class is thread-safe.
+ *
+ * \ingroup CommandLineModulesCore_API
+ */
+class ctkCmdLineModuleResultCache
+{
+
+public:
+
+  ctkCmdLineModuleResultCache(const QString& cacheDir);
+  ~ctkCmdLineModuleResultCache();
+
+  QString cacheDir() const;
+
+  /**
+   * @brief Returns the key of a run of \c frontend.
+   * @param frontend The front-end to run.
+   * @param timeStamp The time stamp of the module.
+   * @return The key, or an empty QByteArray if the run cannot be cached,
+   * for example because a directory parameter is set.
+   */
+  static QByteArray key(ctkCmdLineModuleFrontend* frontend, qint64 timeStamp);
+
+  /**
+   * @brief Returns the output files written by a run of \c frontend, in parameter order.
+   */
+  static QStringList outputFiles(ctkCmdLineModuleFrontend* frontend);
+
+  /**
+   * @brief Looks up a run and counts a hit or a miss.
+   * @param key The key of the run.
+   * @param outputFiles The output files, which are replaced by the cached ones on a hit.
+   * @param future Set to a finished future reporting the cached results on a hit.
+   * @return true on a hit.
+   */
+  bool restore(const QByteArray& key, const QStringList& outputFiles, ctkCmdLineModuleFuture* future);
+
+  /**
+   * @brief Stores the results and output files of a successful run.
+   */
+  void store(const QByteArray& key, const QStringList& outputFiles, const ctkCmdLineModuleFuture& future);
+
+  void setMaximumSize(qint64 bytes);
+  qint64 maximumSize() const;
+
+  /**
+   * @brief Returns the number of bytes used by the cached runs.
+   */
+  qint64 size() const;
+
+  int count() const;
+  int hits() const;
+  int misses() const;
+
+  /**
+   * @brief Removes all entries and resets the hit and miss counts.
+   */
+  void clear();
+
+private:
+
+  QScopedPointer<ctkCmdLineModuleResultCachePrivate> d;
+
+  Q_DISABLE_COPY(ctkCmdLineModuleResultCache)
+};
+
+/**
+ * \class ctkCmdLineModuleResultCacheRecorder
+ * \brief Stores a run in a ctkCmdLineModuleResultCache once it has finished successfully.
+ *
+ * The recorder deletes itself when the run has finished. It needs an event loop
+ * in the thread which started the run.
+ *
+ * \ingroup CommandLineModulesCore_API
+ */
+class ctkCmdLineModuleResultCacheRecorder : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  ctkCmdLineModuleResultCacheRecorder(const QSharedPointer<ctkCmdLineModuleResultCache>& cache,
+                                      const QByteArray& key, const QStringList& outputFiles,
+                                      const ctkCmdLineModuleFuture& future);
+
+private Q_SLOTS:
+
+  void runFinished();
+
+private:
+
+  QSharedPointer<ctkCmdLineModuleResultCache> Cache;
+  QByteArray Key;
+  QStringList OutputFiles;
+  ctkCmdLineModuleFutureWatcher Watcher;
+};
+
+#endif // CTKCMDLINEMODULERESULTCACHE_P_H
@@ -0,0 +1,50 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkCmdLineModuleRunMetrics.h"
+
+#include <QDebug>
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleRunMetrics::ctkCmdLineModuleRunMetrics()
+  : QueueWaitTime(-1)
+  , SpawnTime(-1)
+  , WallTime(-1)
+  , CpuTime(-1)
+  , PeakResidentSetSize(-1)
+  , OutputBytes(-1)
+  , ErrorBytes(-1)
+{
+}
+
+//----------------------------------------------------------------------------
+QDebug operator<<(QDebug debug, const ctkCmdLineModuleRunMetrics& metrics)
+{
+  debug.nospace() << "ctkCmdLineModuleRunMetrics(queue wait " << metrics.QueueWaitTime
+                  << " ms, spawn " << metrics.SpawnTime
+                  << " ms, wall " << metrics.WallTime
+                  << " ms, cpu " << metrics.CpuTime
+                  << " ms, peak rss " << metrics.PeakResidentSetSize
+                  << " bytes, output " << metrics.OutputBytes
+                  << " bytes, error " << metrics.ErrorBytes << " bytes)";
+  return debug.space();
+}
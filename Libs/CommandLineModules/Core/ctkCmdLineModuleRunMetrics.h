@@ -0,0 +1,75 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKCMDLINEMODULERUNMETRICS_H
+#define CTKCMDLINEMODULERUNMETRICS_H
+
+#include "ctkCommandLineModulesCoreExport.h"
+
+#include <QtGlobal>
+
+class QDebug;
+
+/**
+ * @ingroup CommandLineModulesCore_API
+ *
+ * @brief Execution metrics of a module run.
+ *
+ * The metrics are reported by the backend while the module runs and can be
+ * retrieved via ctkCmdLineModuleFuture::metrics(). Values which are not known,
+ * because the module did not get that far or the backend or platform cannot
+ * measure them, are -1.
+ *
+ * The time needed to retrieve the XML description of a module is not part of a
+ * run, see ctkCmdLineModuleReference::xmlRetrievalTime().
+ *
+ * @see ctkCmdLineModuleFuture
+ */
+struct CTK_CMDLINEMODULECORE_EXPORT ctkCmdLineModuleRunMetrics
+{
+  ctkCmdLineModuleRunMetrics();
+
+  /** Time in milliseconds between scheduling the run and its start. */
+  qint64 QueueWaitTime;
+
+  /** Time in milliseconds needed to start the module process. */
+  qint64 SpawnTime;
+
+  /** Time in milliseconds from the start of the run to its end. */
+  qint64 WallTime;
+
+  /** User and system CPU time in milliseconds used by the module. */
+  qint64 CpuTime;
+
+  /** Peak resident set size of the module in bytes. */
+  qint64 PeakResidentSetSize;
+
+  /** Number of bytes of output data, see ctkCmdLineModuleFuture::readAllOutputData(). */
+  qint64 OutputBytes;
+
+  /** Number of bytes of error data, see ctkCmdLineModuleFuture::readAllErrorData(). */
+  qint64 ErrorBytes;
+};
+
+CTK_CMDLINEMODULECORE_EXPORT QDebug operator<<(QDebug debug, const ctkCmdLineModuleRunMetrics& metrics);
+
+#endif // CTKCMDLINEMODULERUNMETRICS_H
@@ -0,0 +1,364 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkCmdLineModuleScheduler.h"
+#include "ctkCmdLineModuleScheduler_p.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QTime>
+#include <QUrl>
+#include <QWaitCondition>
+
+#if (QT_VERSION < QT_VERSION_CHECK(4,7,0))
+extern int qHash(const QUrl& url);
+#endif
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleScheduledTask::~ctkCmdLineModuleScheduledTask()
+{
+}
+
+//----------------------------------------------------------------------------
+struct ctkCmdLineModuleSchedulerPrivate
+{
+  ctkCmdLineModuleSchedulerPrivate(ctkCmdLineModuleScheduler* q)
+    : q(q)
+    , MaximumConcurrentTasks(qMax(1, QThread::idealThreadCount()))
+    , RunningCost(0)
+    , Destroying(false)
+    , Dispatcher(new ctkCmdLineModuleSchedulerDispatcher(this))
+  {
+    Dispatcher->moveToThread(&EventThread);
+    ThreadPool.setMaxThreadCount(MaximumConcurrentTasks);
+  }
+
+  struct PendingTask
+  {
+    ctkCmdLineModuleScheduledTask* Task;
+    QUrl Location;
+    int Priority;
+    int Cost;
+  };
+
+  struct RunningTask
+  {
+    RunningTask() : Cost(0) {}
+    QUrl Location;
+    int Cost;
+  };
+
+  bool withinConcurrencyLimits_unlocked(const QUrl& location) const
+  {
+    int moduleLimit = this->ModuleLimits.value(location, 0);
+    if (moduleLimit > 0 && this->RunningPerModule.value(location, 0) >= moduleLimit)
+    {
+      return false;
+    }
+    int backendLimit = this->BackendLimits.value(location.scheme(), 0);
+    return backendLimit <= 0 || this->RunningPerBackend.value(location.scheme(), 0) < backendLimit;
+  }
+
+  void startTasks_unlocked()
+  {
+    bool started = false;
+    QList<PendingTask>::iterator it = this->PendingTasks.begin();
+    while (it != this->PendingTasks.end())
+    {
+      // A task held back by the limit of its module or back-end lets the next ones start
+      if (!this->Destroying && !this->withinConcurrencyLimits_unlocked(it->Location))
+      {
+        ++it;
+        continue;
+      }
+      int cost = qMin(it->Cost, this->MaximumConcurrentTasks);
+      // Do not let cheaper tasks overtake the first one, it would starve
+      if (!this->Destroying && this->RunningCost + cost > this->MaximumConcurrentTasks)
+      {
+        break;
+      }
+      RunningTask runningTask;
+      runningTask.Location = it->Location;
+      runningTask.Cost = cost;
+      this->RunningCost += cost;
+      this->RunningTasks.insert(it->Task, runningTask);
+      ++this->RunningPerModule[it->Location];
+      ++this->RunningPerBackend[it->Location.scheme()];
+      this->TasksToExecute.push_back(it->Task);
+      it = this->PendingTasks.erase(it);
+      started = true;
+    }
+
+    if (started)
+    {
+      if (!this->EventThread.isRunning())
+      {
+        this->EventThread.start();
+      }
+      QMetaObject::invokeMethod(this->Dispatcher, "executeTasks", Qt::QueuedConnection);
+    }
+  }
+
+  ctkCmdLineModuleScheduler* const q;
+
+  mutable QMutex Mutex;
+  QWaitCondition TaskFinishedCondition;
+
+  int MaximumConcurrentTasks;
+  QHash<QUrl, int> Priorities;
+  QHash<QUrl, int> Costs;
+  QHash<QUrl, int> ModuleLimits;
+  QHash<QString, int> BackendLimits;
+
+  // Sorted by decreasing priority
+  QList<PendingTask> PendingTasks;
+  // Started tasks, not executed by the dispatcher yet
+  QList<ctkCmdLineModuleScheduledTask*> TasksToExecute;
+  // Cost and location of the started tasks
+  QHash<ctkCmdLineModuleScheduledTask*, RunningTask> RunningTasks;
+  QHash<QUrl, int> RunningPerModule;
+  QHash<QString, int> RunningPerBackend;
+  int RunningCost;
+
+  bool Destroying;
+
+  QThread EventThread;
+  ctkCmdLineModuleSchedulerDispatcher* Dispatcher;
+
+  mutable QThreadPool ThreadPool;
+};
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleSchedulerDispatcher::ctkCmdLineModuleSchedulerDispatcher(ctkCmdLineModuleSchedulerPrivate* d)
+  : d(d)
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleSchedulerDispatcher::executeTasks()
+{
+  QList<ctkCmdLineModuleScheduledTask*> tasks;
+  {
+    QMutexLocker lock(&d->Mutex);
+    tasks.swap(d->TasksToExecute);
+  }
+  foreach(ctkCmdLineModuleScheduledTask* task, tasks)
+  {
+    task->execute(d->q);
+  }
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleScheduler::ctkCmdLineModuleScheduler()
+  : d(new ctkCmdLineModuleSchedulerPrivate(this))
+{
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleScheduler::~ctkCmdLineModuleScheduler()
+{
+  QList<ctkCmdLineModuleScheduledTask*> tasks;
+  {
+    QMutexLocker lock(&d->Mutex);
+    d->Destroying = true;
+    foreach(const ctkCmdLineModuleSchedulerPrivate::PendingTask& pendingTask, d->PendingTasks)
+    {
+      tasks.push_back(pendingTask.Task);
+    }
+    tasks << d->RunningTasks.keys();
+  }
+
+  foreach(ctkCmdLineModuleScheduledTask* task, tasks)
+  {
+    task->cancelTask();
+  }
+
+  {
+    QMutexLocker lock(&d->Mutex);
+    // The canceled pending tasks only report that they are finished
+    d->startTasks_unlocked();
+
+    QTime waitTime;
+    waitTime.start();
+    while (!d->RunningTasks.isEmpty() && waitTime.elapsed() < 30000)
+    {
+      d->TaskFinishedCondition.wait(&d->Mutex, 100);
+    }
+    if (!d->RunningTasks.isEmpty())
+    {
+      qWarning() << "ctkCmdLineModuleScheduler:" << d->RunningTasks.size()
+                 << "tasks did not finish after being canceled";
+    }
+  }
+
+  d->EventThread.quit();
+  d->EventThread.wait();
+  delete d->Dispatcher;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleScheduler::setMaximumConcurrentTasks(int count)
+{
+  QMutexLocker lock(&d->Mutex);
+  d->MaximumConcurrentTasks = qMax(1, count);
+  d->ThreadPool.setMaxThreadCount(d->MaximumConcurrentTasks);
+  d->startTasks_unlocked();
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleScheduler::maximumConcurrentTasks() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->MaximumConcurrentTasks;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleScheduler::setPriority(const QUrl& location, int priority)
+{
+  QMutexLocker lock(&d->Mutex);
+  d->Priorities.insert(location, priority);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleScheduler::priority(const QUrl& location) const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->Priorities.value(location, 0);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleScheduler::setCost(const QUrl& location, int cost)
+{
+  QMutexLocker lock(&d->Mutex);
+  d->Costs.insert(location, qMax(1, cost));
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleScheduler::cost(const QUrl& location) const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->Costs.value(location, 1);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleScheduler::setModuleConcurrencyLimit(const QUrl& location, int count)
+{
+  QMutexLocker lock(&d->Mutex);
+  d->ModuleLimits.insert(location, qMax(0, count));
+  d->startTasks_unlocked();
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleScheduler::moduleConcurrencyLimit(const QUrl& location) const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->ModuleLimits.value(location, 0);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleScheduler::setBackendConcurrencyLimit(const QString& scheme, int count)
+{
+  QMutexLocker lock(&d->Mutex);
+  d->BackendLimits.insert(scheme, qMax(0, count));
+  d->startTasks_unlocked();
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleScheduler::backendConcurrencyLimit(const QString& scheme) const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->BackendLimits.value(scheme, 0);
+}
+
+//----------------------------------------------------------------------------
+QThreadPool* ctkCmdLineModuleScheduler::threadPool() const
+{
+  return &d->ThreadPool;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleScheduler::schedule(ctkCmdLineModuleScheduledTask* task, const QUrl& location)
+{
+  if (task == NULL) return;
+
+  QMutexLocker lock(&d->Mutex);
+
+  ctkCmdLineModuleSchedulerPrivate::PendingTask pendingTask;
+  pendingTask.Task = task;
+  pendingTask.Location = location;
+  pendingTask.Priority = d->Priorities.value(location, 0);
+  pendingTask.Cost = d->Costs.value(location, 1);
+
+  QList<ctkCmdLineModuleSchedulerPrivate::PendingTask>::iterator it = d->PendingTasks.begin();
+  while (it != d->PendingTasks.end() && it->Priority >= pendingTask.Priority)
+  {
+    ++it;
+  }
+  d->PendingTasks.insert(it, pendingTask);
+
+  if (d->Destroying)
+  {
+    task->cancelTask();
+  }
+  d->startTasks_unlocked();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleScheduler::taskFinished(ctkCmdLineModuleScheduledTask* task)
+{
+  {
+    QMutexLocker lock(&d->Mutex);
+    if (d->RunningTasks.contains(task))
+    {
+      ctkCmdLineModuleSchedulerPrivate::RunningTask runningTask = d->RunningTasks.take(task);
+      d->RunningCost -= runningTask.Cost;
+      if (--d->RunningPerModule[runningTask.Location] == 0)
+      {
+        d->RunningPerModule.remove(runningTask.Location);
+      }
+      if (--d->RunningPerBackend[runningTask.Location.scheme()] == 0)
+      {
+        d->RunningPerBackend.remove(runningTask.Location.scheme());
+      }
+    }
+    d->startTasks_unlocked();
+    d->TaskFinishedCondition.wakeAll();
+  }
+  delete task;
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleScheduler::pendingTaskCount() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->PendingTasks.size();
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleScheduler::runningTaskCount() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->RunningTasks.size();
+}
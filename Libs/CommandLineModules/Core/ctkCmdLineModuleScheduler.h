@@ -0,0 +1,170 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKCMDLINEMODULESCHEDULER_H
+#define CTKCMDLINEMODULESCHEDULER_H
+
+#include "ctkCommandLineModulesCoreExport.h"
+
+#include <QScopedPointer>
+
+class QString;
+class QThreadPool;
+class QUrl;
+
+class ctkCmdLineModuleScheduler;
+struct ctkCmdLineModuleSchedulerPrivate;
+
+/**
+ * @ingroup CommandLineModulesCore_API
+ *
+ * @brief Interface of the tasks run by a ctkCmdLineModuleScheduler.
+ *
+ * A scheduled task does not block a thread while it is running. The scheduler
+ * calls execute() in its event thread when the task can start, and the task
+ * calls ctkCmdLineModuleScheduler::taskFinished() once it is done, from any thread.
+ */
+struct CTK_CMDLINEMODULECORE_EXPORT ctkCmdLineModuleScheduledTask
+{
+  virtual ~ctkCmdLineModuleScheduledTask();
+
+  /**
+   * @brief Start the task and return immediately.
+   * @param scheduler The scheduler to notify with taskFinished().
+   *
+   * This method is called in the event thread of the scheduler, which runs
+   * an event loop. A task which was canceled before being started must still
+   * call taskFinished().
+   */
+  virtual void execute(ctkCmdLineModuleScheduler* scheduler) = 0;
+
+  /**
+   * @brief Request the task to stop, it still calls taskFinished().
+   *
+   * This method is called by the scheduler when it is destroyed.
+   */
+  virtual void cancelTask() = 0;
+};
+
+/**
+ * @ingroup CommandLineModulesCore_API
+ *
+ * @brief Bounded, priority based scheduling of module runs.
+ *
+ * The ctkCmdLineModuleManager owns a scheduler which is passed to the back-ends
+ * when running a module. Instead of using a thread of QThreadPool::globalInstance()
+ * per run, the back-ends can queue ctkCmdLineModuleScheduledTask instances. At most
+ * maximumConcurrentTasks() slots are used at the same time, and the pending tasks
+ * are started by decreasing priority, in the order they were queued for equal priorities.
+ *
+ * Each module can be given a priority and a cost, the number of slots used by one of
+ * its runs, for example a module which uses several threads itself. The concurrent runs
+ * can also be limited per module and per back-end, e.g. to run a module using the GPU
+ * once at a time while the other modules still run in parallel.
+ *
+ * This class is thread-safe.
+ */
+class CTK_CMDLINEMODULECORE_EXPORT ctkCmdLineModuleScheduler
+{
+
+public:
+
+  ctkCmdLineModuleScheduler();
+
+  /**
+   * @brief Cancels the pending and running tasks and waits for them to finish.
+   */
+  ~ctkCmdLineModuleScheduler();
+
+  /**
+   * @brief Set the number of slots available to the running tasks.
+   *
+   * The default is QThread::idealThreadCount().
+   */
+  void setMaximumConcurrentTasks(int count);
+  int maximumConcurrentTasks() const;
+
+  /**
+   * @brief Set the priority of the runs of the module at \c location, 0 by default.
+   */
+  void setPriority(const QUrl& location, int priority);
+  int priority(const QUrl& location) const;
+
+  /**
+   * @brief Set the number of slots used by a run of the module at \c location, 1 by default.
+   *
+   * A cost larger than maximumConcurrentTasks() is reduced to it, so that the task
+   * runs alone.
+   */
+  void setCost(const QUrl& location, int cost);
+  int cost(const QUrl& location) const;
+
+  /**
+   * @brief Limit the number of concurrent runs of the module at \c location, 0 (no limit) by default.
+   *
+   * The pending runs of a module which reached its limit do not hold back the runs
+   * of the other modules.
+   */
+  void setModuleConcurrencyLimit(const QUrl& location, int count);
+  int moduleConcurrencyLimit(const QUrl& location) const;
+
+  /**
+   * @brief Limit the number of concurrent runs of the modules of a back-end, 0 (no limit) by default.
+   * @param scheme The URL scheme of the back-end modules, see ctkCmdLineModuleBackend::schemes().
+   */
+  void setBackendConcurrencyLimit(const QString& scheme, int count);
+  int backendConcurrencyLimit(const QString& scheme) const;
+
+  /**
+   * @brief Get the thread pool of the tasks which need a thread, e.g. the runs of
+   * shared library modules.
+   *
+   * Its maximum thread count follows maximumConcurrentTasks(), the tasks do not
+   * compete with the other users of QThreadPool::globalInstance().
+   */
+  QThreadPool* threadPool() const;
+
+  /**
+   * @brief Queue a task for a module.
+   * @param task The task, which is deleted by the scheduler once it has finished.
+   * @param location The location of the module, which selects its priority and cost.
+   */
+  void schedule(ctkCmdLineModuleScheduledTask* task, const QUrl& location);
+
+  /**
+   * @brief Notify the scheduler that \c task has finished.
+   *
+   * The task is deleted and must not be accessed after calling this method.
+   */
+  void taskFinished(ctkCmdLineModuleScheduledTask* task);
+
+  int pendingTaskCount() const;
+  int runningTaskCount() const;
+
+private:
+
+  QScopedPointer<ctkCmdLineModuleSchedulerPrivate> d;
+
+  Q_DISABLE_COPY(ctkCmdLineModuleScheduler)
+
+};
+
+#endif // CTKCMDLINEMODULESCHEDULER_H
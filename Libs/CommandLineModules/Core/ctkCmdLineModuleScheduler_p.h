@@ -19,32 +19,33 @@
 
 =============================================================================*/
 
-
-#ifndef CTKEASLOTHANDLER_P_H
-#define CTKEASLOTHANDLER_P_H
+#ifndef CTKCMDLINEMODULESCHEDULER_P_H
+#define CTKCMDLINEMODULESCHEDULER_P_H
 
 #include <QObject>
 
-#include <ctkServiceRegistration.h>
-#include <service/event/ctkEventHandler.h>
+struct ctkCmdLineModuleSchedulerPrivate;
 
-class ctkEASlotHandler : public QObject, public ctkEventHandler
+/**
+ * \class ctkCmdLineModuleSchedulerDispatcher
+ * \brief Lives in the event thread of a ctkCmdLineModuleScheduler and starts its tasks.
+ * \ingroup CommandLineModulesCore_API
+ */
+class ctkCmdLineModuleSchedulerDispatcher : public QObject
 {
   Q_OBJECT
-  Q_INTERFACES(ctkEventHandler)
 
 public:
 
-  ctkServiceRegistration reg;
-
-  void updateProperties(const ctkDictionary& properties);
+  ctkCmdLineModuleSchedulerDispatcher(ctkCmdLineModuleSchedulerPrivate* d);
 
-  void handleEvent(const ctkEvent& event);
+public Q_SLOTS:
 
-Q_SIGNALS:
+  void executeTasks();
 
-  void eventOccured(const ctkEvent& event);
+private:
 
+  ctkCmdLineModuleSchedulerPrivate* d;
 };
 
-#endif // CTKEASLOTHANDLER_P_H
+#endif // CTKCMDLINEMODULESCHEDULER_P_H
@@ -21,21 +21,86 @@
 
 #include "ctkCmdLineModuleXmlProgressWatcher.h"
 
+#include <QElapsedTimer>
 #include <QIODevice>
 #include <QProcess>
-#include <QXmlStreamReader>
+#include <QTimer>
 
 #include <QDebug>
 
+#include <cstring>
+
 namespace {
 
-static QString FILTER_START = "filter-start";
-static QString FILTER_NAME = "filter-name";
-static QString FILTER_COMMENT = "filter-comment";
-static QString FILTER_PROGRESS = "filter-progress";
-static QString FILTER_PROGRESS_TEXT = "filter-progress-text";
-static QString FILTER_RESULT = "filter-result";
-static QString FILTER_END = "filter-end";
+static const char FILTER_START[] = "filter-start";
+static const char FILTER_NAME[] = "filter-name";
+static const char FILTER_COMMENT[] = "filter-comment";
+static const char FILTER_PROGRESS[] = "filter-progress";
+static const char FILTER_PROGRESS_TEXT[] = "filter-progress-text";
+static const char FILTER_RESULT[] = "filter-result";
+static const char FILTER_END[] = "filter-end";
+
+// Longest tag waited for before the '<' is taken as output
+static const int MAXIMUM_TAG_SIZE = 4096;
+
+bool isTag(const QByteArray& name, const char* tag)
+{
+  return qstricmp(name.constData(), tag) == 0;
+}
+
+bool isFilterTag(const QByteArray& name)
+{
+  return isTag(name, FILTER_START) || isTag(name, FILTER_PROGRESS) ||
+      isTag(name, FILTER_PROGRESS_TEXT) || isTag(name, FILTER_RESULT) ||
+      isTag(name, FILTER_END);
+}
+
+bool isNameStartChar(char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' ||
+      static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool isNameChar(char c)
+{
+  return isNameStartChar(c) || (c >= '0' && c <= '9') || c == '-' || c == '.';
+}
+
+// Replaces the predefined and numeric character references of an element content
+QString decodeText(const QByteArray& text)
+{
+  if (text.indexOf('&') < 0)
+  {
+    return QString::fromUtf8(text.constData(), text.size());
+  }
+
+  QString result = QString::fromUtf8(text.constData(), text.size());
+  int pos = 0;
+  while ((pos = result.indexOf('&', pos)) >= 0)
+  {
+    int end = result.indexOf(';', pos);
+    if (end < 0) break;
+    QString entity = result.mid(pos + 1, end - pos - 1);
+    QString replacement;
+    if (entity == "lt") replacement = "<";
+    else if (entity == "gt") replacement = ">";
+    else if (entity == "amp") replacement = "&";
+    else if (entity == "quot") replacement = "\"";
+    else if (entity == "apos") replacement = "'";
+    else if (entity.startsWith('#'))
+    {
+      bool ok = false;
+      uint code = entity.startsWith("#x") ? entity.mid(2).toUInt(&ok, 16) : entity.mid(1).toUInt(&ok);
+      if (ok) replacement = QString(QChar(code));
+    }
+    if (!replacement.isEmpty())
+    {
+      result.replace(pos, end - pos + 1, replacement);
+    }
+    ++pos;
+  }
+  return result;
+}
 
 }
 
@@ -46,28 +111,23 @@ public:
 
   ctkCmdLineModuleXmlProgressWatcherPrivate(QIODevice* input, ctkCmdLineModuleXmlProgressWatcher* qq)
     : input(input), process(NULL), readPos(0), q(qq), error(false), currentProgress(0)
+    , lineNumber(1), stripNewline(false), outputSink(NULL), progressInterval(0)
+    , progressPending(false), pendingProgress(0)
   {
-    // wrap the content in an artifical root element
-    reader.addData("<module-root>");
   }
 
   ctkCmdLineModuleXmlProgressWatcherPrivate(QProcess* input, ctkCmdLineModuleXmlProgressWatcher* qq)
     : input(input), process(input), readPos(0), q(qq), error(false), currentProgress(0)
+    , lineNumber(1), stripNewline(false), outputSink(NULL), progressInterval(0)
+    , progressPending(false), pendingProgress(0)
   {
-    // wrap the content in an artifical root element
-    reader.addData("<module-root>");
   }
 
   void _q_readyRead()
   {
     input->seek(readPos);
 
-    QByteArray buffer = input->readAll();
-
-    buffer.prepend("<module-snippet>");
-    buffer.append("</module-snippet>");
-
-    reader.addData(buffer);
+    buffer.append(input->readAll());
     readPos = input->pos();
     parseProgressXml();
   }
@@ -77,155 +137,372 @@ public:
     emit q->errorDataAvailable(process->readAllStandardError());
   }
 
+  void _q_emitPendingProgress()
+  {
+    if (progressPending)
+    {
+      progressPending = false;
+      lastProgress.start();
+      emit q->filterProgress(pendingProgress, pendingComment);
+    }
+  }
+
+  // Scans the buffered bytes for the progress and result tags. Everything outside
+  // of the top-level elements is output data, incomplete tags are kept for the next call.
   void parseProgressXml()
   {
-    QXmlStreamReader::TokenType type = reader.readNext();
-    QByteArray outputData;
-    while(type != QXmlStreamReader::Invalid)
+    const char* data = buffer.constData();
+    const int size = buffer.size();
+    int pos = 0;
+    int textStart = 0;
+
+    while (pos < size)
     {
-      switch(type)
-      {
-      case QXmlStreamReader::NoToken: break;
-      case QXmlStreamReader::Characters:
+      const char* lt = static_cast<const char*>(memchr(data + pos, '<', size - pos));
+      int tagStart = lt ? static_cast<int>(lt - data) : size;
+
+      // the text up to the next tag
+      if (tagStart > textStart)
       {
         if (stack.empty())
         {
-          QByteArray output(reader.text().toString().toLatin1());
+          const char* text = data + textStart;
+          int textSize = tagStart - textStart;
           // get rid of a possible newline after the last xml end tag
-          if (output.startsWith('\n')) output = output.remove(0,1);
-          outputData.append(output);
-          break;
-        }
-
-        if (stack.size() == 2 &&
-            (stack.front() == FILTER_START || stack.front() == FILTER_END))
-        {
-          if (stack.back() == FILTER_NAME)
-          {
-            currentName = reader.text().toString().trimmed();
-          }
-          else if (stack.back() == FILTER_COMMENT)
+          if (stripNewline)
           {
-            currentComment = reader.text().toString().trimmed();
+            if (textSize > 0 && text[0] == '\r') { ++text; --textSize; }
+            if (textSize > 0 && text[0] == '\n') { ++text; --textSize; }
           }
+          outputData.append(text, textSize);
         }
-        else if (stack.size() == 1 && stack.back() == FILTER_PROGRESS)
+        else if (collectText())
         {
-          currentProgress = reader.text().toString().toFloat();
+          currentText.append(data + textStart, tagStart - textStart);
         }
-        else if (stack.size() == 1 && stack.back() == FILTER_PROGRESS_TEXT)
+        stripNewline = false;
+        countLines(data + textStart, tagStart - textStart);
+      }
+      if (!lt)
+      {
+        pos = textStart = size;
+        break;
+      }
+
+      int tagEnd = scanTag(data, size, tagStart);
+      if (tagEnd == -1)
+      {
+        // incomplete tag, wait for more data
+        pos = textStart = tagStart;
+        break;
+      }
+      if (tagEnd == -2)
+      {
+        // not a tag, the '<' is part of the text
+        textStart = tagStart;
+        pos = tagStart + 1;
+        const char* next = static_cast<const char*>(memchr(data + pos, '<', size - pos));
+        if (next)
         {
-          currentComment = reader.text().toString();
+          // the text up to the next '<' is handled in the next iteration
+          outputOrCollect(data + textStart, static_cast<int>(next - data) - textStart);
+          pos = textStart = static_cast<int>(next - data);
         }
-        else if (stack.size() == 1 && stack.back() == FILTER_RESULT)
+        else
         {
-          currentResultValue = reader.text().toString();
+          outputOrCollect(data + textStart, size - textStart);
+          pos = textStart = size;
         }
-        break;
+        continue;
       }
-      case QXmlStreamReader::StartElement:
-      {
-        QStringRef name = reader.name();
-        QString parent;
-        if (!stack.empty()) parent = stack.back();
 
-        if (name.compare("module-root") != 0 && name.compare("module-snippet") != 0)
-        {
-          stack.push_back(name.toString());
-        }
+      handleTag(data + tagStart, tagEnd - tagStart);
+      countLines(data + tagStart, tagEnd - tagStart);
+      pos = textStart = tagEnd;
+    }
 
-        if (name.compare(FILTER_START, Qt::CaseInsensitive) == 0 ||
-            name.compare(FILTER_PROGRESS, Qt::CaseInsensitive) == 0 ||
-            name.compare(FILTER_PROGRESS_TEXT, Qt::CaseInsensitive) == 0 ||
-            name.compare(FILTER_RESULT, Qt::CaseInsensitive) == 0 ||
-            name.compare(FILTER_END, Qt::CaseInsensitive) == 0)
-        {
-          if (!parent.isEmpty())
-          {
-            unexpectedNestedElement(name.toString());
-            break;
-          }
+    buffer.remove(0, textStart);
+    flushOutput();
+  }
 
-          if (name.compare(FILTER_START, Qt::CaseInsensitive) == 0)
-          {
-            currentName = QString();
-            currentComment = QString();
-            currentProgress = 0;
-          }
-          else if (name.compare(FILTER_PROGRESS_TEXT, Qt::CaseInsensitive) == 0)
-          {
-            currentProgress = reader.attributes().value("progress").toString().toFloat();
-          }
-          else if (name.compare(FILTER_RESULT, Qt::CaseInsensitive) == 0)
-          {
-            currentResultParameter = reader.attributes().value("name").toString();
-            currentResultValue.clear();
-          }
-        }
-        break;
+  void outputOrCollect(const char* text, int textSize)
+  {
+    if (stack.empty())
+    {
+      outputData.append(text, textSize);
+    }
+    else if (collectText())
+    {
+      currentText.append(text, textSize);
+    }
+    stripNewline = false;
+    countLines(text, textSize);
+  }
+
+  // Returns the end of the tag at tagStart, -1 if it is incomplete or -2 if it is not a tag
+  int scanTag(const char* data, int size, int tagStart)
+  {
+    int pos = tagStart + 1;
+    if (pos >= size) return -1;
+
+    char c = data[pos];
+    const char* closing = ">";
+    if (c == '!')
+    {
+      if (size - pos < 3) return -1;
+      if (data[pos + 1] != '-' || data[pos + 2] != '-') return -2;
+      closing = "-->";
+    }
+    else if (c == '?')
+    {
+      closing = "?>";
+    }
+    else if (c == '/')
+    {
+      if (pos + 1 >= size) return -1;
+      if (!isNameStartChar(data[pos + 1])) return -2;
+    }
+    else if (!isNameStartChar(c))
+    {
+      return -2;
+    }
+
+    QByteArray haystack = QByteArray::fromRawData(data + pos, size - pos);
+    int end = haystack.indexOf(closing);
+    if (end < 0)
+    {
+      return size - tagStart > MAXIMUM_TAG_SIZE ? -2 : -1;
+    }
+    return pos + end + static_cast<int>(strlen(closing));
+  }
+
+  void handleTag(const char* tag, int tagSize)
+  {
+    if (tag[1] == '!' || tag[1] == '?')
+    {
+      // comments and processing instructions
+      return;
+    }
+
+    bool endTag = tag[1] == '/';
+    int nameStart = endTag ? 2 : 1;
+    int nameEnd = nameStart;
+    while (nameEnd < tagSize && isNameChar(tag[nameEnd])) ++nameEnd;
+    QByteArray name(tag + nameStart, nameEnd - nameStart);
+
+    if (endTag)
+    {
+      handleEndElement(name);
+      return;
+    }
+
+    QByteArray attributes(tag + nameEnd, tagSize - nameEnd - 1);
+    bool emptyElement = attributes.endsWith('/');
+    handleStartElement(name, attributes);
+    if (emptyElement)
+    {
+      handleEndElement(name);
+    }
+  }
+
+  void handleStartElement(const QByteArray& name, const QByteArray& attributes)
+  {
+    QByteArray parent;
+    if (!stack.empty()) parent = stack.back();
+    stack.push_back(name);
+    currentText.clear();
+
+    if (!isFilterTag(name))
+    {
+      return;
+    }
+    if (!parent.isEmpty())
+    {
+      unexpectedNestedElement(QString::fromUtf8(name));
+      return;
+    }
+
+    if (isTag(name, FILTER_START))
+    {
+      currentName = QString();
+      currentComment = QString();
+      currentProgress = 0;
+    }
+    else if (isTag(name, FILTER_PROGRESS_TEXT))
+    {
+      currentProgress = attribute(attributes, "progress").toFloat();
+    }
+    else if (isTag(name, FILTER_RESULT))
+    {
+      currentResultParameter = attribute(attributes, "name");
+    }
+  }
+
+  void handleEndElement(const QByteArray& name)
+  {
+    if (stack.empty() || qstricmp(stack.back().constData(), name.constData()) != 0)
+    {
+      xmlError(QString("Opening and ending tag mismatch for \"%1\".").arg(QString::fromUtf8(name)));
+      // resynchronize on the matching start tag, if any
+      int index = stack.size() - 1;
+      while (index >= 0 && qstricmp(stack[index].constData(), name.constData()) != 0) --index;
+      if (index < 0) return;
+      while (stack.size() > index + 1) stack.pop_back();
+    }
+
+    QByteArray curr = stack.back();
+    stack.pop_back();
+    QByteArray parent;
+    if (!stack.empty()) parent = stack.back();
+
+    if (stack.size() == 1 && (isTag(parent, FILTER_START) || isTag(parent, FILTER_END)))
+    {
+      if (isTag(curr, FILTER_NAME))
+      {
+        currentName = decodeText(currentText).trimmed();
       }
-      case QXmlStreamReader::EndElement:
+      else if (isTag(curr, FILTER_COMMENT))
       {
-        QStringRef name = reader.name();
+        currentComment = decodeText(currentText).trimmed();
+      }
+    }
+    else if (stack.empty())
+    {
+      stripNewline = true;
+      if (isTag(curr, FILTER_START))
+      {
+        flushOutput();
+        emit q->filterStarted(currentName, currentComment);
+        currentComment = QString();
+      }
+      else if (isTag(curr, FILTER_PROGRESS))
+      {
+        flushOutput();
+        currentProgress = decodeText(currentText).toFloat();
+        reportProgress(currentProgress, QString());
+      }
+      else if (isTag(curr, FILTER_PROGRESS_TEXT))
+      {
+        flushOutput();
+        currentComment = decodeText(currentText);
+        reportProgress(currentProgress, currentComment);
+        currentComment = QString();
+      }
+      else if (isTag(curr, FILTER_RESULT))
+      {
+        flushOutput();
+        _q_emitPendingProgress();
+        emit q->filterResult(currentResultParameter, decodeText(currentText));
+      }
+      else if (isTag(curr, FILTER_END))
+      {
+        flushOutput();
+        _q_emitPendingProgress();
+        emit q->filterFinished(currentName, currentComment);
+        currentName = QString();
+        currentComment = QString();
+      }
+    }
+    currentText.clear();
+  }
 
-        QString curr;
-        QString parent;
-        if (!stack.empty())
-        {
-          curr = stack.back();
-          stack.pop_back();
-          if (!stack.empty()) parent = stack.back();
-        }
+  // The text of the elements holding a value
+  bool collectText() const
+  {
+    if (stack.size() == 1)
+    {
+      return isTag(stack.back(), FILTER_PROGRESS) || isTag(stack.back(), FILTER_PROGRESS_TEXT) ||
+          isTag(stack.back(), FILTER_RESULT);
+    }
+    if (stack.size() == 2 && (isTag(stack.front(), FILTER_START) || isTag(stack.front(), FILTER_END)))
+    {
+      return isTag(stack.back(), FILTER_NAME) || isTag(stack.back(), FILTER_COMMENT);
+    }
+    return false;
+  }
 
-        if (parent.isEmpty() && name.compare("module-snippet") != 0)
+  QString attribute(const QByteArray& attributes, const char* name) const
+  {
+    int pos = 0;
+    const int nameSize = static_cast<int>(strlen(name));
+    while ((pos = attributes.indexOf(name, pos)) >= 0)
+    {
+      bool start = pos == 0 || !isNameChar(attributes[pos - 1]);
+      int valuePos = pos + nameSize;
+      while (valuePos < attributes.size() && attributes[valuePos] == ' ') ++valuePos;
+      if (start && valuePos < attributes.size() && attributes[valuePos] == '=')
+      {
+        ++valuePos;
+        while (valuePos < attributes.size() && attributes[valuePos] == ' ') ++valuePos;
+        if (valuePos < attributes.size() && (attributes[valuePos] == '"' || attributes[valuePos] == '\''))
         {
-          if (name.compare(FILTER_START, Qt::CaseInsensitive) == 0)
+          int valueEnd = attributes.indexOf(attributes[valuePos], valuePos + 1);
+          if (valueEnd > valuePos)
           {
-            emit q->filterStarted(currentName, currentComment);
-            currentComment = QString();
-          }
-          else if (name.compare(FILTER_PROGRESS, Qt::CaseInsensitive) == 0)
-          {
-            emit q->filterProgress(currentProgress, QString());
-          }
-          else if (name.compare(FILTER_PROGRESS_TEXT, Qt::CaseInsensitive) == 0)
-          {
-            emit q->filterProgress(currentProgress, currentComment);
-            currentComment = QString();
-          }
-          else if (name.compare(FILTER_RESULT, Qt::CaseInsensitive) == 0)
-          {
-            emit q->filterResult(currentResultParameter, currentResultValue);
-          }
-          else if (name.compare(FILTER_END, Qt::CaseInsensitive) == 0)
-          {
-            emit q->filterFinished(currentName, currentComment);
-            currentName = QString();
-            currentComment = QString();
+            return decodeText(attributes.mid(valuePos + 1, valueEnd - valuePos - 1));
           }
         }
-        break;
-      }
-      default:
-        break;
       }
+      pos += nameSize;
+    }
+    return QString();
+  }
 
-      if (!outputData.isEmpty())
-      {
-        emit q->outputDataAvailable(outputData);
-        outputData.clear();
-      }
-      type = reader.readNext();
+  void reportProgress(float progress, const QString& comment)
+  {
+    if (progressInterval <= 0)
+    {
+      emit q->filterProgress(progress, comment);
+      return;
     }
 
-    if (type == QXmlStreamReader::Invalid && reader.error() != QXmlStreamReader::PrematureEndOfDocumentError)
+    // Only the last progress report of an interval is emitted
+    bool timerRunning = progressPending;
+    progressPending = true;
+    pendingProgress = progress;
+    pendingComment = comment;
+    if (!lastProgress.isValid() || lastProgress.elapsed() >= progressInterval)
     {
-      if (!error)
-      {
-        error = true;
-        emit q->filterXmlError(QString("Error parsing XML at line %1, column %2: ")
-                               .arg(reader.lineNumber()).arg(reader.columnNumber()) + reader.errorString());
-      }
+      _q_emitPendingProgress();
+    }
+    else if (!timerRunning)
+    {
+      QTimer::singleShot(progressInterval - static_cast<int>(lastProgress.elapsed()), q,
+                         SLOT(_q_emitPendingProgress()));
+    }
+  }
+
+  void flushOutput()
+  {
+    if (outputData.isEmpty()) return;
+
+    if (outputSink)
+    {
+      outputSink->write(outputData);
+    }
+    else
+    {
+      emit q->outputDataAvailable(outputData);
+    }
+    outputData.clear();
+  }
+
+  void countLines(const char* text, int textSize)
+  {
+    const char* end = text + textSize;
+    while ((text = static_cast<const char*>(memchr(text, '\n', end - text))) != NULL)
+    {
+      ++lineNumber;
+      ++text;
+    }
+  }
+
+  void xmlError(const QString& message)
+  {
+    if (!error)
+    {
+      error = true;
+      emit q->filterXmlError(QString("Error parsing XML at line %1: %2").arg(lineNumber).arg(message));
     }
   }
 
@@ -235,7 +512,7 @@ public:
     {
       error = true;
       emit q->filterXmlError(QString("\"%1\" must be a top-level element, found at line %2.")
-                             .arg(element).arg(reader.lineNumber()));
+                             .arg(element).arg(lineNumber));
     }
   }
 
@@ -244,13 +521,24 @@ public:
   qint64 readPos;
   ctkCmdLineModuleXmlProgressWatcher* q;
   bool error;
-  QXmlStreamReader reader;
-  QList<QString> stack;
+  QByteArray buffer;
+  QByteArray outputData;
+  QList<QByteArray> stack;
+  QByteArray currentText;
   QString currentName;
   QString currentComment;
   float currentProgress;
   QString currentResultParameter;
-  QString currentResultValue;
+  int lineNumber;
+  bool stripNewline;
+
+  QIODevice* outputSink;
+
+  int progressInterval;
+  QElapsedTimer lastProgress;
+  bool progressPending;
+  float pendingProgress;
+  QString pendingComment;
 };
 
 
@@ -282,4 +570,32 @@ ctkCmdLineModuleXmlProgressWatcher::~ctkCmdLineModuleXmlProgressWatcher()
 {
 }
 
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleXmlProgressWatcher::setProgressInterval(int msecs)
+{
+  d->progressInterval = msecs;
+  if (msecs <= 0)
+  {
+    d->_q_emitPendingProgress();
+  }
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleXmlProgressWatcher::progressInterval() const
+{
+  return d->progressInterval;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleXmlProgressWatcher::setOutputSink(QIODevice* sink)
+{
+  d->outputSink = sink;
+}
+
+//----------------------------------------------------------------------------
+QIODevice* ctkCmdLineModuleXmlProgressWatcher::outputSink() const
+{
+  return d->outputSink;
+}
+
 #include "moc_ctkCmdLineModuleXmlProgressWatcher.cpp"
@@ -39,6 +39,10 @@ class QProcess;
  * This class is usually only used by back-end implementators for modules
  * which can report progress and results in the form of XML fragments written
  * to a QIODevice.
+ *
+ * The data is scanned incrementally as raw bytes. Only the content of the
+ * progress and result elements is converted to strings, everything written
+ * outside of them is passed through as output data.
  */
 class CTK_CMDLINEMODULECORE_EXPORT ctkCmdLineModuleXmlProgressWatcher : public QObject
 {
@@ -50,6 +54,28 @@ public:
   ctkCmdLineModuleXmlProgressWatcher(QProcess* input);
   ~ctkCmdLineModuleXmlProgressWatcher();
 
+  /**
+   * @brief Limits the rate of the filterProgress() signal.
+   *
+   * Within \a msecs milliseconds, only the last progress report is emitted. The
+   * pending report is emitted before the filterResult() and filterFinished() signals.
+   * The default value of 0 emits every progress report.
+   *
+   * @param msecs The minimum time between two filterProgress() signals.
+   */
+  void setProgressInterval(int msecs);
+  int progressInterval() const;
+
+  /**
+   * @brief Writes the output data to \a sink instead of emitting outputDataAvailable().
+   *
+   * The sink must be open for writing and is not owned by the watcher.
+   *
+   * @param sink The output device, or NULL to emit outputDataAvailable() again.
+   */
+  void setOutputSink(QIODevice* sink);
+  QIODevice* outputSink() const;
+
 Q_SIGNALS:
 
   void filterStarted(const QString& name, const QString& comment);
@@ -67,6 +93,7 @@ private:
 
   Q_PRIVATE_SLOT(d, void _q_readyRead())
   Q_PRIVATE_SLOT(d, void _q_readyReadError())
+  Q_PRIVATE_SLOT(d, void _q_emitPendingProgress())
 
   QScopedPointer<ctkCmdLineModuleXmlProgressWatcherPrivate> d;
 };
@@ -21,8 +21,12 @@
 
 // Qt includes
 #include <QBuffer>
+#include <QCache>
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QFile>
+#include <QMap>
+#include <QMutex>
 #include <QXmlQuery>
 #include <QXmlSchema>
 #include <QXmlSchemaValidator>
@@ -32,6 +36,24 @@
 #include "ctkCmdLineModuleXslTransform.h"
 #include "ctkCmdLineModuleXmlMsgHandler_p.h"
 
+//----------------------------------------------------------------------------
+namespace {
+
+// Outputs of the transformations, by hash of their inputs
+struct ctkCmdLineModuleXslOutputCache
+{
+  ctkCmdLineModuleXslOutputCache()
+    : Outputs(16 * 1024 * 1024)
+  {}
+
+  QMutex Mutex;
+  QCache<QByteArray, QByteArray> Outputs;
+};
+
+}
+
+Q_GLOBAL_STATIC(ctkCmdLineModuleXslOutputCache, ctkCmdLineModuleXslOutputCacheInstance)
+
 //----------------------------------------------------------------------------
 class ctkCmdLineModuleXslTransformPrivate
 {
@@ -40,6 +62,7 @@ public:
   ctkCmdLineModuleXslTransformPrivate(QIODevice *output)
     : Validate(false)
     , Format(false)
+    , CacheOutput(false)
     , OutputSchema(0)
     , Transformation(0)
     , Output(output)
@@ -52,6 +75,7 @@ public:
 
   bool Validate;
   bool Format;
+  bool CacheOutput;
 
   QIODevice* OutputSchema;
   QIODevice* Transformation;
@@ -59,6 +83,7 @@ public:
 
   QXmlQuery XslTransform;
   QList<QIODevice*> ExtraTransformations;
+  QMap<QString, QVariant> BoundVariables;
   ctkCmdLineModuleXmlMsgHandler MsgHandler;
 
   QString ErrorStr;
@@ -175,13 +200,6 @@ bool ctkCmdLineModuleXslTransform::transform()
   inputDevice->reset();
 
 
-  if (!d->XslTransform.setFocus(inputDevice))
-  {
-    QString msg("Error transforming XML input: %1");
-    d->ErrorStr = msg.arg(d->MsgHandler.statusMessage());
-    return false;
-  }
-
   if (!d->Transformation)
   {
     d->ErrorStr = "No XSL transformation set.";
@@ -189,17 +207,75 @@ bool ctkCmdLineModuleXslTransform::transform()
   }
 
   d->Transformation->open(QIODevice::ReadOnly);
+  d->Transformation->reset();
   QString query(d->Transformation->readAll());
   QString extra;
   foreach(QIODevice* extraIODevice, d->ExtraTransformations)
   {
     extraIODevice->open(QIODevice::ReadOnly);
+    extraIODevice->reset();
     extra += extraIODevice->readAll();
   }
   query.replace("<!-- EXTRA TRANSFORMATIONS -->", extra);
 #if 0
   qDebug() << query;
 #endif
+
+  QByteArray cacheKey;
+  if (d->CacheOutput)
+  {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(inputDevice->readAll());
+    inputDevice->reset();
+    hash.addData(query.toUtf8());
+    for (QMap<QString, QVariant>::const_iterator iter = d->BoundVariables.begin();
+         iter != d->BoundVariables.end(); ++iter)
+    {
+      hash.addData(iter.key().toUtf8());
+      hash.addData(iter.value().typeName());
+      hash.addData(iter.value().toString().toUtf8());
+    }
+    hash.addData(d->Format ? "1" : "0");
+    cacheKey = hash.result();
+
+    ctkCmdLineModuleXslOutputCache* cache = ctkCmdLineModuleXslOutputCacheInstance();
+    QByteArray cachedOutput;
+    {
+      QMutexLocker lock(&cache->Mutex);
+      if (QByteArray* output = cache->Outputs.object(cacheKey))
+      {
+        cachedOutput = *output;
+      }
+    }
+    if (!cachedOutput.isNull())
+    {
+      // The cached outputs have already been validated
+      bool closeOutput = false;
+      if (!(d->Output->openMode() & QIODevice::WriteOnly))
+      {
+        d->Output->open(QIODevice::WriteOnly);
+        closeOutput = true;
+      }
+      d->Output->write(cachedOutput);
+      if (closeOutput)
+      {
+        d->Output->close();
+      }
+      else
+      {
+        d->Output->reset();
+      }
+      return true;
+    }
+  }
+
+  if (!d->XslTransform.setFocus(inputDevice))
+  {
+    QString msg("Error transforming XML input: %1");
+    d->ErrorStr = msg.arg(d->MsgHandler.statusMessage());
+    return false;
+  }
+
   d->XslTransform.setQuery(query);
 
   bool closeOutput = false;
@@ -208,6 +284,7 @@ bool ctkCmdLineModuleXslTransform::transform()
     d->Output->open(QIODevice::WriteOnly);
     closeOutput = true;
   }
+  qint64 outputStart = d->Output->pos();
 
   QScopedPointer<QXmlSerializer> xmlSerializer;
   if (d->Format)
@@ -231,6 +308,13 @@ bool ctkCmdLineModuleXslTransform::transform()
   qDebug() << d->Output;
 #endif
 
+  QByteArray output;
+  if (d->CacheOutput && !closeOutput && d->Output->isReadable() && !d->Output->isSequential())
+  {
+    d->Output->seek(outputStart);
+    output = d->Output->readAll();
+  }
+
   if (closeOutput)
   {
     d->Output->close();
@@ -240,9 +324,16 @@ bool ctkCmdLineModuleXslTransform::transform()
     d->Output->reset();
   }
 
-  if (d->Validate)
+  if (d->Validate && !d->validateOutput())
+  {
+    return false;
+  }
+
+  if (!output.isNull())
   {
-    return d->validateOutput();
+    ctkCmdLineModuleXslOutputCache* cache = ctkCmdLineModuleXslOutputCacheInstance();
+    QMutexLocker lock(&cache->Mutex);
+    cache->Outputs.insert(cacheKey, new QByteArray(output), output.size());
   }
   return true;
 }
@@ -257,6 +348,7 @@ void ctkCmdLineModuleXslTransform::setXslTransformation(QIODevice *transformatio
 void ctkCmdLineModuleXslTransform::bindVariable(const QString& name, const QVariant& value)
 {
   d->XslTransform.bindVariable(name, value);
+  d->BoundVariables[name] = value;
 }
 
 //----------------------------------------------------------------------------
@@ -285,6 +377,42 @@ bool ctkCmdLineModuleXslTransform::validateOutput() const
   return d->Validate;
 }
 
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleXslTransform::setCacheOutput(bool cache)
+{
+  d->CacheOutput = cache;
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleXslTransform::cacheOutput() const
+{
+  return d->CacheOutput;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleXslTransform::setOutputCacheSize(int bytes)
+{
+  ctkCmdLineModuleXslOutputCache* cache = ctkCmdLineModuleXslOutputCacheInstance();
+  QMutexLocker lock(&cache->Mutex);
+  cache->Outputs.setMaxCost(bytes);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleXslTransform::outputCacheSize()
+{
+  ctkCmdLineModuleXslOutputCache* cache = ctkCmdLineModuleXslOutputCacheInstance();
+  QMutexLocker lock(&cache->Mutex);
+  return cache->Outputs.maxCost();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleXslTransform::clearOutputCache()
+{
+  ctkCmdLineModuleXslOutputCache* cache = ctkCmdLineModuleXslOutputCacheInstance();
+  QMutexLocker lock(&cache->Mutex);
+  cache->Outputs.clear();
+}
+
 //----------------------------------------------------------------------------
 bool ctkCmdLineModuleXslTransform::error() const
 {
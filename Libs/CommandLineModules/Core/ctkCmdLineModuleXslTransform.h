@@ -143,6 +143,34 @@ public:
    */
   bool validateOutput() const;
 
+  /**
+   * @brief Enables the process wide cache of the transformation outputs.
+   *
+   * QXmlQuery compiles the XSL transformation for each transform() call. With the
+   * cache enabled, transform() writes the output of a previous call for the same
+   * input, transformations, bound variables and formatting instead, without
+   * evaluating the transformation again. The cache is disabled by default.
+   *
+   * @param cache If \c true, the outputs are cached.
+   */
+  void setCacheOutput(bool cache);
+
+  /**
+   * @brief Returns \c true if the outputs are cached.
+   */
+  bool cacheOutput() const;
+
+  /**
+   * @brief Set the maximum size in bytes of the cached outputs, 16 MB by default.
+   */
+  static void setOutputCacheSize(int bytes);
+  static int outputCacheSize();
+
+  /**
+   * @brief Removes all the cached outputs.
+   */
+  static void clearOutputCache();
+
   /**
    * @brief Returns true if an error occured.
    *
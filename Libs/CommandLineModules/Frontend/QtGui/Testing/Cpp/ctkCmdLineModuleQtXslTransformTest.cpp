@@ -23,6 +23,7 @@
 #include <QCoreApplication>
 #include <QList>
 #include <QString>
+#include <QStringList>
 
 // CTK includes
 #include "ctkCmdLineModuleFrontendFactoryQtGui.h"
@@ -45,6 +46,8 @@ private slots:
 
   void testXslExtraTransformation();
   void testXslExtraTransformation_data();
+
+  void testCacheOutput();
 };
 
 QString invalidXml =
@@ -474,6 +477,68 @@ void ctkCmdLineModuleQtXslTransformTester::testXslExtraTransformation_data()
 
 }
 
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleQtXslTransformTester::testCacheOutput()
+{
+  QString integerParameter =
+    header
+    + parametersHeader
+    + integer
+    + parametersFooter
+    + footer;
+  QString integerParameterUi =
+    mainWidgetHeader
+    + parametersWidgetHeader
+    + parametersLayoutHeader
+    + integerWidgetLabel
+    + integerWidgetSpinBoxHeader
+    + integerWidgetSpinBox
+    + integerWidgetSpinBoxFooter
+    + parametersLayoutFooter
+    + parametersWidgetFooter
+    + mainWidgetFooter;
+  QString sliderParameterUi = integerParameterUi;
+  sliderParameterUi.replace("QSpinBox", "ctkSliderWidget");
+
+  ctkCmdLineModuleXslTransform::clearOutputCache();
+
+  // The second round is written from the cache, the bound variable is part of the key
+  for (int i = 0; i < 2; ++i)
+  {
+    QStringList outputs;
+    for (int j = 0; j < 2; ++j)
+    {
+      ctkCmdLineModuleXslTransform transformer;
+      QVERIFY(!transformer.cacheOutput());
+      transformer.setCacheOutput(true);
+
+      QFile transformation(":/ctkCmdLineModuleXmlToQtUi.xsl");
+      transformer.setXslTransformation(&transformation);
+
+      QByteArray inputArray(integerParameter.toUtf8());
+      QBuffer inputBuffer(&inputArray);
+      transformer.setInput(&inputBuffer);
+
+      QBuffer output;
+      output.open(QBuffer::ReadWrite);
+      transformer.setOutput(&output);
+
+      transformer.setFormatXmlOutput(true);
+      if (j == 1)
+      {
+        transformer.bindVariable("integerWidget", QString("ctkSliderWidget"));
+      }
+
+      QVERIFY(transformer.transform());
+      outputs << QString(output.readAll());
+    }
+    QCOMPARE(outputs[0], integerParameterUi);
+    QCOMPARE(outputs[1], sliderParameterUi);
+  }
+
+  ctkCmdLineModuleXslTransform::clearOutputCache();
+}
+
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(ctkCmdLineModuleQtXslTransformTest)
 #include "moc_ctkCmdLineModuleQtXslTransformTest.cpp"
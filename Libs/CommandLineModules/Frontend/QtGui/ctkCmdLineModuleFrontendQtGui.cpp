@@ -84,6 +84,8 @@ ctkCmdLineModuleXslTransform* ctkCmdLineModuleFrontendQtGui::xslTransform() cons
     d->Transform.reset(new ctkCmdLineModuleXslTransform());
     d->xslFile.reset(new QFile(":/ctkCmdLineModuleXmlToQtUi.xsl"));
     d->Transform->setXslTransformation(d->xslFile.data());
+    // The generated UI only changes with the XML description of the module
+    d->Transform->setCacheOutput(true);
   }
   return d->Transform.data();
 }
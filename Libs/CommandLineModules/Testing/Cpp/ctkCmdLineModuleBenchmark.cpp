@@ -0,0 +1,227 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include <ctkCmdLineModuleManager.h>
+#include <ctkCmdLineModuleConcurrentHelpers.h>
+#include <ctkCmdLineModuleFrontendFactory.h>
+#include <ctkCmdLineModuleFrontend.h>
+#include <ctkCmdLineModuleReference.h>
+#include <ctkCmdLineModuleDescription.h>
+#include <ctkCmdLineModuleParameter.h>
+#include <ctkCmdLineModuleFuture.h>
+
+#include "ctkCmdLineModuleBackendLocalProcess.h"
+
+#include "ctkTest.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QtConcurrentMap>
+
+namespace {
+
+// The test bed module delays its XML output by two seconds, the modules
+// are registered concurrently as done by ctkCmdLineModuleDirectoryWatcher.
+const int ModuleCount = 8;
+
+//-----------------------------------------------------------------------------
+struct ModuleFrontendMockup : public ctkCmdLineModuleFrontend
+{
+  ModuleFrontendMockup(const ctkCmdLineModuleReference& moduleRef)
+    : ctkCmdLineModuleFrontend(moduleRef) {}
+
+  virtual QObject* guiHandle() const { return NULL; }
+
+  virtual QVariant value(const QString& parameter, int role) const
+  {
+    Q_UNUSED(role)
+    QVariant value = currentValues[parameter];
+    if (!value.isValid())
+      return this->moduleReference().description().parameter(parameter).defaultValue();
+    return value;
+  }
+
+  virtual void setValue(const QString& parameter, const QVariant& value, int role = DisplayRole)
+  {
+    Q_UNUSED(role)
+    currentValues[parameter] = value;
+  }
+
+private:
+
+  QHash<QString, QVariant> currentValues;
+};
+
+}
+
+//-----------------------------------------------------------------------------
+class ctkCmdLineModuleBenchmarker : public QObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+
+  void initTestCase();
+  void cleanupTestCase();
+
+  void benchmarkRegistration_data();
+  void benchmarkRegistration();
+
+  void benchmarkRunLatency_data();
+  void benchmarkRunLatency();
+
+private:
+
+  QString modulePath;
+  QString workPath;
+  QList<QUrl> moduleUrls;
+};
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBenchmarker::initTestCase()
+{
+  QString suffix;
+#ifdef Q_OS_WIN
+  suffix = ".exe";
+#endif
+  modulePath = QCoreApplication::applicationDirPath() + "/ctkCmdLineModuleTestBed";
+  workPath = QDir::tempPath() + "/ctkCmdLineModuleBenchmarker";
+
+  QDir().mkpath(workPath + "/cache");
+
+  // Distinct copies of the test module, registering one location twice
+  // just returns the existing reference
+  for (int i = 0; i < ModuleCount; ++i)
+  {
+    QString copy = QString("%1/ctkCmdLineModuleTestBed%2").arg(workPath).arg(i);
+    QFile::remove(copy + suffix);
+    QVERIFY(QFile::copy(modulePath + suffix, copy + suffix));
+    moduleUrls << QUrl::fromLocalFile(copy);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBenchmarker::cleanupTestCase()
+{
+  QDir cacheDir(workPath + "/cache");
+  foreach(const QString& entry, cacheDir.entryList(QDir::Files))
+  {
+    cacheDir.remove(entry);
+  }
+  QDir workDir(workPath);
+  foreach(const QString& entry, workDir.entryList(QDir::Files))
+  {
+    workDir.remove(entry);
+  }
+  workDir.rmdir("cache");
+  QDir().rmdir(workPath);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBenchmarker::benchmarkRegistration_data()
+{
+  QTest::addColumn<bool>("cached");
+
+  QTest::newRow(qPrintable(QString("%1 modules, uncached").arg(ModuleCount))) << false;
+  QTest::newRow(qPrintable(QString("%1 modules, cached").arg(ModuleCount))) << true;
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBenchmarker::benchmarkRegistration()
+{
+  QFETCH(bool, cached);
+
+  ctkCmdLineModuleBackendLocalProcess backend;
+  ctkCmdLineModuleManager manager(ctkCmdLineModuleManager::STRICT_VALIDATION,
+                                  cached ? workPath + "/cache" : QString());
+  manager.registerBackend(&backend);
+
+  QList<ctkCmdLineModuleReferenceResult> results;
+  if (cached)
+  {
+    // fill the module cache
+    results = QtConcurrent::blockingMapped<QList<ctkCmdLineModuleReferenceResult> >(
+                moduleUrls, ctkCmdLineModuleConcurrentRegister(&manager));
+    foreach(const ctkCmdLineModuleReferenceResult& result, results)
+    {
+      manager.unregisterModule(result.m_Reference);
+    }
+  }
+
+  QBENCHMARK
+  {
+    results = QtConcurrent::blockingMapped<QList<ctkCmdLineModuleReferenceResult> >(
+                moduleUrls, ctkCmdLineModuleConcurrentRegister(&manager));
+    foreach(const ctkCmdLineModuleReferenceResult& result, results)
+    {
+      manager.unregisterModule(result.m_Reference);
+    }
+  }
+
+  qint64 xmlRetrievalTime = 0;
+  foreach(const ctkCmdLineModuleReferenceResult& result, results)
+  {
+    QVERIFY2(result.m_Reference, qPrintable(result.m_RuntimeError));
+    xmlRetrievalTime += result.m_Reference.xmlRetrievalTime();
+  }
+  qDebug() << "Mean XML retrieval time:" << xmlRetrievalTime / ModuleCount << "ms";
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBenchmarker::benchmarkRunLatency_data()
+{
+  QTest::addColumn<int>("runtime");
+
+  QTest::newRow("runtime 0 s") << 0;
+  QTest::newRow("runtime 1 s") << 1;
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBenchmarker::benchmarkRunLatency()
+{
+  QFETCH(int, runtime);
+
+  ctkCmdLineModuleBackendLocalProcess backend;
+  ctkCmdLineModuleManager manager;
+  manager.registerBackend(&backend);
+
+  ctkCmdLineModuleReference moduleRef = manager.registerModule(QUrl::fromLocalFile(modulePath));
+  ModuleFrontendMockup frontend(moduleRef);
+  frontend.setValue("runtimeVar", runtime);
+
+  ctkCmdLineModuleFuture future;
+  QBENCHMARK
+  {
+    future = manager.run(&frontend);
+    future.waitForFinished();
+  }
+
+  ctkCmdLineModuleRunMetrics metrics = future.metrics();
+  QVERIFY(metrics.WallTime >= 0);
+  qDebug() << metrics;
+}
+
+// ----------------------------------------------------------------------------
+CTK_TEST_MAIN(ctkCmdLineModuleBenchmark)
+#include "moc_ctkCmdLineModuleBenchmark.cpp"
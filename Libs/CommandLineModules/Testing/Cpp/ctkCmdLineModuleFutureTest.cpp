@@ -215,6 +215,14 @@ void ctkCmdLineModuleFutureTester::testStartFinish()
   results << ctkCmdLineModuleResult("imageOutput", "/tmp/out.nrrd");
   results << ctkCmdLineModuleResult("exitStatusOutput", "Normal exit");
   QCOMPARE(signalTester.results(), results);
+
+  ctkCmdLineModuleRunMetrics metrics = future.metrics();
+  QVERIFY(metrics.QueueWaitTime >= 0);
+  QVERIFY(metrics.SpawnTime >= 0);
+  // the test module sleeps for at least 1.5 seconds
+  QVERIFY(metrics.WallTime >= 1500);
+  QCOMPARE(metrics.ErrorBytes, static_cast<qint64>(future.readAllErrorData().size()));
+  QCOMPARE(metrics.OutputBytes, static_cast<qint64>(future.readAllOutputData().size()));
 }
 
 //-----------------------------------------------------------------------------
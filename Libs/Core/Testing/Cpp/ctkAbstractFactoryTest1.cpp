@@ -20,6 +20,7 @@
 
 // Qt includes
 #include <QCoreApplication>
+#include <QThread>
 
 // CTK includes
 #include "ctkAbstractFactory.h"
@@ -54,9 +55,56 @@ public:
     this->registerItem("item1", QSharedPointer<ctkAbstractFactoryItem<BaseClassType> >(new FactoryItem<BaseClassType>()));
     this->registerItem("item2", QSharedPointer<ctkAbstractFactoryItem<BaseClassType> >(new FactoryItem<BaseClassType>()));
   }
+
+  void registerNumberedItems(int count)
+  {
+    for (int i = 0; i < count; ++i)
+      {
+      this->registerItem(QString("numbered%1").arg(i),
+        QSharedPointer<ctkAbstractFactoryItem<BaseClassType> >(new FactoryItem<BaseClassType>()));
+      }
+  }
 };
 
 struct Item{
+  Item() : Used(false) {}
+  bool Used;
+};
+
+int ResetCount = 0;
+void resetItem(Item* item)
+{
+  item->Used = false;
+  ++ResetCount;
+}
+
+//-----------------------------------------------------------------------------
+// Look items up while another thread registers them
+class FactoryReader : public QThread
+{
+public:
+  FactoryReader(Factory<Item>* factory, int count)
+    : TheFactory(factory), Count(count), Failed(false) {}
+
+  virtual void run()
+  {
+    int previousCount = 0;
+    while (previousCount < this->Count)
+      {
+      int count = this->TheFactory->itemKeys().count();
+      // Instances may not be created yet, but lookups must not crash
+      this->TheFactory->instance(QString("numbered%1").arg(count - 1));
+      if (count < previousCount)
+        {
+        this->Failed = true;
+        }
+      previousCount = count;
+      }
+  }
+
+  Factory<Item>* TheFactory;
+  int            Count;
+  bool           Failed;
 };
 
 //-----------------------------------------------------------------------------
@@ -123,6 +171,64 @@ int ctkAbstractFactoryTest1(int argc, char * argv [] )
     }
   factory.uninstantiate("item1");
 
+  // Released objects are reset and reused
+  factory.setMaximumPoolSize(1);
+  factory.setPoolResetFunction(resetItem);
+  Item* pooledItem1 = factory.acquire("item1");
+  Item* pooledItem2 = factory.acquire("item1");
+  if (pooledItem1 == 0 || pooledItem2 == 0 || pooledItem1 == pooledItem2 ||
+      factory.instance("item1") != 0 ||
+      factory.acquire("unregistered item") != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - ctkAbstractFactory::acquire() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  pooledItem1->Used = true;
+  factory.release("item1", pooledItem1);
+  // The pool is full, the second object is deleted
+  factory.release("item1", pooledItem2);
+  if (ResetCount != 2 ||
+      factory.acquire("item1") != pooledItem1 || pooledItem1->Used)
+    {
+    std::cerr << "Line " << __LINE__ << " - ctkAbstractFactory::release() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  factory.release("item1", pooledItem1);
+  factory.clearPool();
+
+  // 1 instantiate() and 2 acquire() created an object
+  if (factory.instantiationStatistics("item1").Count != 3 ||
+      factory.instantiationStatistics("item1").Failures != 0 ||
+      factory.instantiationStatistics("item2").Count != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - ctkAbstractFactory::instantiationStatistics() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  factory.printAdditionalInfo();
+
+  // Concurrent lookups see the registered items grow
+  Factory<Item> concurrentFactory;
+  const int numberOfItems = 2000;
+  QList<FactoryReader*> readers;
+  for (int i = 0; i < 4; ++i)
+    {
+    readers << new FactoryReader(&concurrentFactory, numberOfItems);
+    readers.last()->start();
+    }
+  concurrentFactory.registerNumberedItems(numberOfItems);
+  bool readersFailed = false;
+  foreach (FactoryReader* reader, readers)
+    {
+    reader->wait();
+    readersFailed = readersFailed || reader->Failed;
+    }
+  qDeleteAll(readers);
+  if (readersFailed || concurrentFactory.itemKeys().count() != numberOfItems)
+    {
+    std::cerr << "Line " << __LINE__ << " - Concurrent lookups failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
 
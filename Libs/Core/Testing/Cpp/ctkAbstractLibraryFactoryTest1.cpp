@@ -20,6 +20,8 @@
 
 // Qt includes
 #include <QCoreApplication>
+#include <QDir>
+#include <QFile>
 
 // CTK includes
 #include "ctkAbstractLibraryFactory.h"
@@ -57,6 +59,20 @@ protected:
 //-----------------------------------------------------------------------------
 class ctkDummyLibraryFactoryItem: public ctkAbstractLibraryFactory<ctkDummyLibrary>
 {
+public:
+  void registerAll(const QStringList& directories)
+  {
+    this->registerAllFileItems(directories);
+  }
+  bool isLoadDeferred(const QString& key)const
+  {
+    return this->item(key) && this->item(key)->isLoadDeferred();
+  }
+  bool isValid(const QFileInfo& file)const
+  {
+    return this->isValidFile(file);
+  }
+
 protected:
   //-----------------------------------------------------------------------------
   ctkAbstractFactoryItem<ctkDummyLibrary>* createFactoryFileBasedItem()
@@ -136,6 +152,80 @@ int ctkAbstractLibraryFactoryTest1(int argc, char * argv [])
     }
 
   libraryFactory.uninstantiate(itemKey);
+
+  // Scan a directory with the library and a bad library, twice, with a
+  // manifest cache.
+  QDir scanDir(QDir::tempPath());
+  QString scanDirName = QString("ctkAbstractLibraryFactoryTest1-%1")
+    .arg(QCoreApplication::applicationPid());
+  scanDir.mkpath(scanDirName);
+  scanDir.cd(scanDirName);
+  QString libraryCopy = scanDir.filePath(file.fileName());
+  QString badLibrary = scanDir.filePath(QString("ctkBadLibrary.") + file.suffix());
+  QString cacheFile = scanDir.filePath("ctkAbstractLibraryFactoryTest1.ini");
+  QFile::copy(file.filePath(), libraryCopy);
+  QFile bad(badLibrary);
+  bad.open(QIODevice::WriteOnly);
+  bad.write("not a library");
+  bad.close();
+
+  bool cacheOk = true;
+  for (int scan = 0; scan < 2 && cacheOk; ++scan)
+    {
+    ctkDummyLibraryFactoryItem scanningFactory;
+    scanningFactory.setCacheFileName(cacheFile);
+    scanningFactory.registerAll(QStringList() << scanDir.path());
+    QString scannedKey = scanningFactory.itemKeys().value(0);
+    if (scanningFactory.itemKeys().count() != 1 ||
+        scanningFactory.isLoadDeferred(scannedKey) != (scan == 1) ||
+        !QFile::exists(cacheFile))
+      {
+      std::cerr << "Line " << __LINE__ << " - Scan " << scan
+                << ": registerAllFileItems() failed "
+                << scanningFactory.itemKeys().count() << std::endl;
+      cacheOk = false;
+      }
+    else if (scanningFactory.instantiate(scannedKey) == 0 ||
+             scanningFactory.isLoadDeferred(scannedKey))
+      {
+      std::cerr << "Line " << __LINE__ << " - Scan " << scan
+                << ": instantiate() failed" << std::endl;
+      cacheOk = false;
+      }
+    scanningFactory.uninstantiate(scannedKey);
+    }
+  QFile::remove(libraryCopy);
+  QFile::remove(badLibrary);
+  QFile::remove(cacheFile);
+  scanDir.cdUp();
+  scanDir.rmdir(scanDirName);
+  if (!cacheOk)
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Check the symbols without loading the library
+  ctkDummyLibraryFactoryItem checkingFactory;
+  checkingFactory.setCheckSymbolsWithoutLoading(true);
+  checkingFactory.setSymbols(QStringList() << "ctkNoSuchSymbol");
+  if (checkingFactory.isValid(file))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - isValidFile() accepted a library missing a symbol" << std::endl;
+    return EXIT_FAILURE;
+    }
+  checkingFactory.setSymbols(QStringList() << "qt_plugin_instance");
+  itemKey = checkingFactory.registerFileItem(file);
+  if (!checkingFactory.isValid(file) || itemKey.isEmpty() ||
+      !checkingFactory.isLoadDeferred(itemKey) ||
+      checkingFactory.instantiate(itemKey) == 0)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Failed to register a library without loading it" << std::endl;
+    return EXIT_FAILURE;
+    }
+  checkingFactory.uninstantiate(itemKey);
+
   return EXIT_SUCCESS;
 }
 
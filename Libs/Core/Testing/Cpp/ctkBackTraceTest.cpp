@@ -46,6 +46,23 @@ void Q_DECL_EXPORT bt_func1()
     qCritical() << "Stack frame for bt_func2() missing";
     exit(EXIT_FAILURE);
   }
+
+  // Copies share the return addresses and symbolize them identically
+  ctkBackTrace copy(bt);
+  if (copy.stackSize() != bt.stackSize() ||
+      copy.returnAddress(2) != bt.returnAddress(2) ||
+      copy.stackTrace() != bt.stackTrace())
+  {
+    qCritical() << "Copied back trace differs from the original";
+    exit(EXIT_FAILURE);
+  }
+
+  ctkBackTrace emptyTrace(0);
+  if (emptyTrace.stackSize() != 0 || !emptyTrace.stackFrame(0).isNull())
+  {
+    qCritical() << "Back trace without frames should be empty";
+    exit(EXIT_FAILURE);
+  }
 }
 
 //-----------------------------------------------------------------------------
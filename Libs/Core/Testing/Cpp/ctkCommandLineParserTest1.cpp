@@ -826,5 +826,83 @@ int ctkCommandLineParserTest1(int, char*[])
     return EXIT_FAILURE;
     }
 
+  // Test17 - Check that parsing the same parser repeatedly gives the same results
+  ctkCommandLineParser parser17;
+  parser17.setArgumentPrefix("--", "-");
+  QStringList arguments17;
+  arguments17 << "ctkCommandLineParserTest1";
+  for (int i = 0; i < 200; ++i)
+    {
+    parser17.addArgument(QString("int-%1").arg(i), "", QVariant::Int);
+    arguments17 << QString("--int-%1").arg(i) << QString::number(-i);
+    }
+  parser17.addArgument("double", "d", QVariant::Double);
+  parser17.addArgument("list", "l", QVariant::StringList);
+  arguments17 << "-d" << ".5" << "--list" << "a" << "b" << "c";
+
+  for (int pass = 0; pass < 2; ++pass)
+    {
+    ok = false;
+    parsedArgs = parser17.parseArguments(arguments17, &ok);
+    if (!ok || parsedArgs.size() != 202 ||
+        parsedArgs["int-199"].toInt() != -199 ||
+        parsedArgs["double"].toDouble() != 0.5 ||
+        parsedArgs["list"].toStringList() != (QStringList() << "a" << "b" << "c"))
+      {
+      qCritical() << "Test17 - Failed to parse arguments, pass" << pass << ":"
+                  << parser17.errorString();
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The validators match the default regular expressions exactly
+  QStringList invalidValues17;
+  invalidValues17 << "5." << "-" << "1.2.3" << "+1" << " 1";
+  foreach (const QString& invalidValue, invalidValues17)
+    {
+    QStringList invalidArguments17;
+    invalidArguments17 << "ctkCommandLineParserTest1" << "--double" << invalidValue;
+    ok = true;
+    parser17.parseArguments(invalidArguments17, &ok);
+    if (ok)
+      {
+      qCritical() << "Test17 - Double value" << invalidValue << "should be rejected";
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A custom expression replaces the default validator
+  parser17.setExactMatchRegularExpression("--int-0", "[0-9]x", "A digit and 'x' are expected");
+  QStringList customArguments17;
+  customArguments17 << "ctkCommandLineParserTest1" << "--int-0" << "7x";
+  ok = false;
+  parser17.parseArguments(customArguments17, &ok);
+  if (!ok)
+    {
+    qCritical() << "Test17 - Custom expression should be used:" << parser17.errorString();
+    return EXIT_FAILURE;
+    }
+
+  // Arguments spelled with the previous prefixes aren't recognized anymore
+  parser17.setArgumentPrefix("/", "+");
+  ok = false;
+  parsedArgs = parser17.parseArguments(arguments17, &ok);
+  if (!ok || parsedArgs.contains("int-1") ||
+      parser17.unparsedArguments().size() != arguments17.size() - 1)
+    {
+    qCritical() << "Test17 - Changing the prefixes should invalidate the arguments";
+    return EXIT_FAILURE;
+    }
+  QStringList prefixedArguments17;
+  prefixedArguments17 << "ctkCommandLineParserTest1" << "/int-1" << "1" << "+d" << "2.5";
+  ok = false;
+  parsedArgs = parser17.parseArguments(prefixedArguments17, &ok);
+  if (!ok || parsedArgs["int-1"].toInt() != 1 || parsedArgs["double"].toDouble() != 2.5)
+    {
+    qCritical() << "Test17 - Failed to parse arguments with the new prefixes:"
+                << parser17.errorString();
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
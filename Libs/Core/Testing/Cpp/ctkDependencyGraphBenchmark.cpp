@@ -0,0 +1,228 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// CTK includes
+#include "ctkDependencyGraph.h"
+#include "ctkHighPrecisionTimer.h"
+
+// STL includes
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <queue>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// The representation ctkDependencyGraph used before it was compressed: one
+// heap allocated array of successors per vertex, traversed recursively.
+class ctkAdjacencyListGraph
+{
+public:
+  ctkAdjacencyListGraph(int nvertices)
+    : Edges(nvertices + 1), OutDegree(nvertices + 1, 0),
+      Discovered(nvertices + 1, false), Processed(nvertices + 1, false),
+      NVertices(nvertices), CycleDetected(false)
+  {
+    for (int i = 0; i <= nvertices; ++i)
+      {
+      this->Edges[i] = new std::vector<int>(2000);
+      }
+  }
+
+  ~ctkAdjacencyListGraph()
+  {
+    for (size_t i = 0; i < this->Edges.size(); ++i)
+      {
+      delete this->Edges[i];
+      }
+  }
+
+  void insertEdge(int from, int to)
+  {
+    (*this->Edges[from])[this->OutDegree[from]++] = to;
+  }
+
+  bool checkForCycle()
+  {
+    for (int v = 1; v <= this->NVertices && !this->CycleDetected; ++v)
+      {
+      if (!this->Discovered[v])
+        {
+        this->traverseUsingDFS(v);
+        }
+      }
+    return this->CycleDetected;
+  }
+
+  void traverseUsingDFS(int v)
+  {
+    this->Discovered[v] = true;
+    for (int i = 0; i < this->OutDegree[v] && !this->CycleDetected; ++i)
+      {
+      int y = (*this->Edges[v])[i];
+      if (!this->Discovered[y])
+        {
+        this->traverseUsingDFS(y);
+        }
+      else if (!this->Processed[y])
+        {
+        this->CycleDetected = true;
+        }
+      }
+    this->Processed[v] = true;
+  }
+
+  bool topologicalSort(std::list<int>& sorted)
+  {
+    std::vector<int> indegree(this->NVertices + 1, 0);
+    for (int v = 1; v <= this->NVertices; ++v)
+      {
+      for (int i = 0; i < this->OutDegree[v]; ++i)
+        {
+        ++indegree[(*this->Edges[v])[i]];
+        }
+      }
+    std::queue<int> zeroin;
+    for (int v = 1; v <= this->NVertices; ++v)
+      {
+      if (indegree[v] == 0)
+        {
+        zeroin.push(v);
+        }
+      }
+    while (!zeroin.empty())
+      {
+      int x = zeroin.front();
+      zeroin.pop();
+      sorted.push_back(x);
+      for (int i = 0; i < this->OutDegree[x]; ++i)
+        {
+        int y = (*this->Edges[x])[i];
+        if (--indegree[y] == 0)
+          {
+          zeroin.push(y);
+          }
+        }
+      }
+    return static_cast<int>(sorted.size()) == this->NVertices;
+  }
+
+private:
+  std::vector<std::vector<int>* > Edges;
+  std::vector<int> OutDegree;
+  std::vector<bool> Discovered;
+  std::vector<bool> Processed;
+  int NVertices;
+  bool CycleDetected;
+};
+
+//----------------------------------------------------------------------------
+// Modules depending on up to 'dependencies' modules with a lower id
+void generateModuleDependencies(int modules, int dependencies,
+                                std::vector<std::pair<int, int> >& edges)
+{
+  srand(1);
+  for (int module = 2; module <= modules; ++module)
+    {
+    int count = 1 + rand() % dependencies;
+    for (int i = 0; i < count; ++i)
+      {
+      edges.push_back(std::make_pair(module, 1 + rand() % (module - 1)));
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template<class GraphType>
+bool benchmark(const char* name, int nvertices,
+               const std::vector<std::pair<int, int> >& edges, std::list<int>& sorted)
+{
+  ctkHighPrecisionTimer timer;
+  timer.start();
+  GraphType graph(nvertices);
+  for (size_t i = 0; i < edges.size(); ++i)
+    {
+    graph.insertEdge(edges[i].first, edges[i].second);
+    }
+  qint64 insertTime = timer.elapsedMicro();
+
+  timer.start();
+  bool cycle = graph.checkForCycle();
+  qint64 cycleTime = timer.elapsedMicro();
+
+  timer.start();
+  bool sortResult = graph.topologicalSort(sorted);
+  qint64 sortTime = timer.elapsedMicro();
+
+  std::cout << name << ": " << nvertices << " vertices, " << edges.size() << " edges:"
+            << " insert " << insertTime << " us,"
+            << " checkForCycle " << cycleTime << " us,"
+            << " topologicalSort " << sortTime << " us" << std::endl;
+  return !cycle && sortResult;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int ctkDependencyGraphBenchmark(int argc, char * argv [] )
+{
+  if (argc > 1)
+    {
+    std::cerr << argv[0] << " expects zero arguments" << std::endl;
+    }
+
+  const int modules = 5000;
+  std::vector<std::pair<int, int> > edges;
+  generateModuleDependencies(modules, 8, edges);
+
+  std::list<int> adjacencyListSorted;
+  std::list<int> sorted;
+  if (!benchmark<ctkAdjacencyListGraph>("Adjacency lists", modules, edges, adjacencyListSorted) ||
+      !benchmark<ctkDependencyGraph>("Compressed sparse row", modules, edges, sorted))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to sort the modules" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (sorted != adjacencyListSorted)
+    {
+    std::cerr << "Line " << __LINE__ << " - The modules are sorted differently" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A chain deep enough to overflow the stack of a recursive traversal
+  const int chainLength = 1000000;
+  std::vector<std::pair<int, int> > chain;
+  for (int module = 1; module < chainLength; ++module)
+    {
+    chain.push_back(std::make_pair(module, module + 1));
+    }
+  sorted.clear();
+  if (!benchmark<ctkDependencyGraph>("Compressed sparse row (chain)", chainLength, chain, sorted) ||
+      static_cast<int>(sorted.size()) != chainLength || sorted.front() != 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to sort the chain" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
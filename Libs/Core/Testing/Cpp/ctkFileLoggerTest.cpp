@@ -1,4 +1,9 @@
 
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
 // CTK includes
 #include "ctkFileLogger.h"
 #include "ctkTest.h"
@@ -9,13 +14,81 @@ class ctkFileLoggerTester: public QObject
   Q_OBJECT
 private slots:
   void initTestCase();
+  void cleanup();
+
+  void testAsynchronous();
+  void testRotation();
 
+private:
+  QString FilePath;
 };
 
 // ----------------------------------------------------------------------------
 void ctkFileLoggerTester::initTestCase()
 {
+  this->FilePath = QDir::temp().filePath(
+        QString("ctkFileLoggerTest-%1.log").arg(QCoreApplication::applicationPid()));
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::cleanup()
+{
+  QFile::remove(this->FilePath);
+  for (int i = 1; i < 5; ++i)
+    {
+    QFile::remove(QString("%1.%2").arg(this->FilePath).arg(i));
+    }
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testAsynchronous()
+{
+  ctkFileLogger logger;
+  logger.setFilePath(this->FilePath);
+  logger.setAsynchronous(true);
+  logger.setMaximumPendingMessages(16);
+  QVERIFY(logger.asynchronous());
+
+  const int messageCount = 1000;
+  for (int i = 0; i < messageCount; ++i)
+    {
+    logger.logMessage(QString("message %1").arg(i));
+    }
+  logger.flush();
+
+  QFile f(this->FilePath);
+  QVERIFY(f.open(QFile::ReadOnly | QFile::Text));
+  QTextStream s(&f);
+  int lineCount = 0;
+  while (!s.atEnd())
+    {
+    QCOMPARE(s.readLine(), QString("message %1").arg(lineCount));
+    ++lineCount;
+    }
+  QCOMPARE(lineCount, messageCount);
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testRotation()
+{
+  ctkFileLogger logger;
+  logger.setFilePath(this->FilePath);
+  logger.setNumberOfFilesToKeep(3);
+  logger.setMaximumFileSize(10);
+
+  // Each message exceeds the maximum size and rotates the file.
+  for (int i = 0; i < 5; ++i)
+    {
+    logger.logMessage(QString("rotated message %1").arg(i));
+    }
+
+  QVERIFY(QFile::exists(this->FilePath + ".1"));
+  QVERIFY(QFile::exists(this->FilePath + ".2"));
+  QVERIFY(!QFile::exists(this->FilePath + ".3"));
 
+  QFile f(this->FilePath + ".1");
+  QVERIFY(f.open(QFile::ReadOnly | QFile::Text));
+  QCOMPARE(QString(f.readLine()).trimmed(), QString("rotated message 4"));
 }
 
 // ----------------------------------------------------------------------------
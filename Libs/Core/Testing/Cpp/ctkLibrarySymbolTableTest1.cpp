@@ -0,0 +1,110 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+
+// CTK includes
+#include "ctkLibrarySymbolTable.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+int ctkLibrarySymbolTableTest1(int argc, char * argv[])
+{
+  if (argc <= 1)
+    {
+    std::cerr << "Missing argument" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QString filePath(argv[1]);
+
+  if (!QFile::exists(filePath))
+    {
+    std::cerr << "Line " << __LINE__ << " - "
+              << "filePath [" << qPrintable(filePath)
+              << "] do *NOT* exist" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkLibrarySymbolTable symbolTable;
+  if (symbolTable.load() || symbolTable.isLoaded())
+    {
+    // Should fail to load without any valid filename
+    std::cerr << "Line " << __LINE__ << " - "
+              << "Problem with load() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A file that isn't a binary
+  QString textFilePath = QDir::temp().filePath("ctkLibrarySymbolTableTest1.txt");
+  QFile textFile(textFilePath);
+  textFile.open(QIODevice::WriteOnly);
+  textFile.write("Not a library");
+  textFile.close();
+  symbolTable.setFileName(textFilePath);
+  bool textFileLoaded = symbolTable.load();
+  QFile::remove(textFilePath);
+  if (textFileLoaded || symbolTable.isLoaded() || !symbolTable.symbols().isEmpty())
+    {
+    std::cerr << "Line " << __LINE__ << " - "
+              << "Problem with load() method on a text file" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  symbolTable.setFileName(filePath);
+  if (symbolTable.fileName() != filePath)
+    {
+    std::cerr << "Line " << __LINE__ << " - "
+              << "Problem with setFileName() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!symbolTable.load() || !symbolTable.isLoaded() || symbolTable.symbols().isEmpty())
+    {
+    std::cerr << "Line " << __LINE__ << " - "
+              << "Failed to load [" << qPrintable(filePath) << "]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Exported by all the Qt plugins
+  if (!symbolTable.contains("qt_plugin_instance") ||
+      symbolTable.contains("ctkNoSuchSymbol") ||
+      !symbolTable.containsAll(QStringList() << "qt_plugin_instance") ||
+      symbolTable.containsAll(QStringList() << "qt_plugin_instance" << "ctkNoSuchSymbol"))
+    {
+    std::cerr << "Line " << __LINE__ << " - "
+              << "Problem with contains() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!symbolTable.unload() || symbolTable.isLoaded() ||
+      symbolTable.contains("qt_plugin_instance"))
+    {
+    std::cerr << "Line " << __LINE__ << " - "
+              << "Problem with unload() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
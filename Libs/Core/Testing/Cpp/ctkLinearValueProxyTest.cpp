@@ -53,6 +53,10 @@ private Q_SLOTS:
 
   void testProxyModified();
   void testProxyModified_data();
+
+  void testValuesConversion();
+
+  void testRangeConversion();
 };
 
 // ----------------------------------------------------------------------------
@@ -504,6 +508,79 @@ void ctkLinearValueProxyTester::testProxyModified_data()
   QTest::newRow("null offset") << 0.0 << false << 1;
 }
 
+// ----------------------------------------------------------------------------
+void ctkLinearValueProxyTester::testValuesConversion()
+{
+  ctkLinearValueProxy proxy;
+  proxy.setCoefficient(-2.5);
+  proxy.setOffset(3.0);
+
+  const int count = 5;
+  double values[count] = {-10., -0.5, 0., 1.25, 1e6};
+  double proxyValues[count];
+  proxy.proxyValuesFromValues(values, proxyValues, count);
+  for (int i = 0; i < count; ++i)
+    {
+    ctkTest::COMPARE(proxyValues[i], proxy.proxyValueFromValue(values[i]));
+    }
+
+  double convertedValues[count];
+  proxy.valuesFromProxyValues(proxyValues, convertedValues, count);
+  for (int i = 0; i < count; ++i)
+    {
+    ctkTest::COMPARE(convertedValues[i], proxy.valueFromProxyValue(proxyValues[i]));
+    }
+
+  // In place
+  proxy.proxyValuesFromValues(values, values, count);
+  for (int i = 0; i < count; ++i)
+    {
+    ctkTest::COMPARE(values[i], proxyValues[i]);
+    }
+}
+
+// ----------------------------------------------------------------------------
+void ctkLinearValueProxyTester::testRangeConversion()
+{
+  ctkLinearValueProxy proxy;
+  proxy.setCoefficient(2.0);
+  proxy.setOffset(1.0);
+
+  double proxyMinimum = 0.;
+  double proxyMaximum = 0.;
+  proxy.proxyRangeFromValueRange(-1., 10., proxyMinimum, proxyMaximum);
+  ctkTest::COMPARE(proxyMinimum, -1.);
+  ctkTest::COMPARE(proxyMaximum, 21.);
+
+  // Cached range
+  proxy.proxyRangeFromValueRange(-1., 10., proxyMinimum, proxyMaximum);
+  ctkTest::COMPARE(proxyMinimum, -1.);
+  ctkTest::COMPARE(proxyMaximum, 21.);
+
+  // The cache follows the coefficient, the offset and the range
+  proxy.setCoefficient(-1.0);
+  proxy.proxyRangeFromValueRange(-1., 10., proxyMinimum, proxyMaximum);
+  ctkTest::COMPARE(proxyMinimum, 2.);
+  ctkTest::COMPARE(proxyMaximum, -9.);
+  proxy.setOffset(0.0);
+  proxy.proxyRangeFromValueRange(-1., 10., proxyMinimum, proxyMaximum);
+  ctkTest::COMPARE(proxyMinimum, 1.);
+  ctkTest::COMPARE(proxyMaximum, -10.);
+  proxy.proxyRangeFromValueRange(0., 5., proxyMinimum, proxyMaximum);
+  ctkTest::COMPARE(proxyMinimum, 0.);
+  ctkTest::COMPARE(proxyMaximum, -5.);
+
+  double minimum = 0.;
+  double maximum = 0.;
+  proxy.valueRangeFromProxyRange(proxyMinimum, proxyMaximum, minimum, maximum);
+  ctkTest::COMPARE(minimum, 0.);
+  ctkTest::COMPARE(maximum, 5.);
+  proxy.setOffset(5.0);
+  proxy.valueRangeFromProxyRange(proxyMinimum, proxyMaximum, minimum, maximum);
+  ctkTest::COMPARE(minimum, 5.);
+  ctkTest::COMPARE(maximum, 10.);
+}
+
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(ctkLinearValueProxyTest)
 #include "moc_ctkLinearValueProxyTest.cpp"
@@ -19,6 +19,7 @@
 =========================================================================*/
 
 // QT includes
+#include <QThread>
 #include <QtGlobal>
 
 // CTK includes
@@ -28,6 +29,30 @@
 #include <cstdlib>
 #include <iostream>
 
+namespace
+{
+
+//-----------------------------------------------------------------------------
+struct ctkLazySingletonTestHelper
+{
+  int Value;
+  ctkLazySingletonTestHelper() : Value(42) {}
+};
+
+//-----------------------------------------------------------------------------
+class ctkLazySingletonTestThread : public QThread
+{
+public:
+  ctkLazySingletonTestThread() : Instance(0) {}
+  virtual void run()
+  {
+    this->Instance = ctkLazySingleton<ctkLazySingletonTestHelper>::instance();
+  }
+  ctkLazySingletonTestHelper* Instance;
+};
+
+}
+
 //-----------------------------------------------------------------------------
 int ctkSingletonTest1(int argc, char * argv [] )
 {
@@ -46,6 +71,26 @@ int ctkSingletonTest1(int argc, char * argv [] )
     std::cerr << "Problem with ctkSingletonTestHelper" << std::endl;
     return EXIT_FAILURE;
     }
+
+  // Concurrent first calls get the same instance
+  ctkLazySingletonTestThread threads[8];
+  for (int i = 0; i < 8; ++i)
+    {
+    threads[i].start();
+    }
+  for (int i = 0; i < 8; ++i)
+    {
+    threads[i].wait();
+    }
+  ctkLazySingletonTestHelper* instance = ctkLazySingleton<ctkLazySingletonTestHelper>::instance();
+  for (int i = 0; i < 8; ++i)
+    {
+    if (threads[i].Instance != instance || instance->Value != 42)
+      {
+      std::cerr << "Line " << __LINE__ << " - Problem with ctkLazySingleton" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
   return EXIT_SUCCESS;
 }
 
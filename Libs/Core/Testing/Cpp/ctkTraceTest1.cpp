@@ -0,0 +1,142 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QThread>
+
+// CTK includes
+#include "ctkTrace.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+class ctkTraceTestThread : public QThread
+{
+public:
+  virtual void run()
+  {
+    for (int i = 0; i < 10; ++i)
+      {
+      CTK_TRACE_SCOPE_CATEGORY("test", "ctkTraceTestThread::run");
+      }
+  }
+};
+
+}
+
+//-----------------------------------------------------------------------------
+int ctkTraceTest1(int argc, char * argv [] )
+{
+  Q_UNUSED(argc);
+  Q_UNUSED(argv);
+
+  if (ctkTrace::isEnabled())
+    {
+    std::cerr << "Line " << __LINE__ << " - Tracing should be disabled by default" << std::endl;
+    return EXIT_FAILURE;
+    }
+  {
+  CTK_TRACE_SCOPE("ignored");
+  }
+  if (ctkTrace::eventCount() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Disabled tracing recorded a span" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkTrace::setEnabled(true);
+  {
+  CTK_TRACE_SCOPE("outer");
+  CTK_TRACE_SCOPE("inner \"quoted\"");
+  }
+  ctkTraceTestThread thread;
+  thread.start();
+  thread.wait();
+  if (ctkTrace::eventCount() != 12 || ctkTrace::droppedEventCount() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Expected 12 spans, got "
+              << ctkTrace::eventCount() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QByteArray json = ctkTrace::toChromeTrace();
+  if (!json.startsWith("{") ||
+      !json.contains("\"name\":\"outer\",\"cat\":\"ctk\",\"ph\":\"X\"") ||
+      !json.contains("\"name\":\"inner \\\"quoted\\\"\"") ||
+      !json.contains("\"cat\":\"test\"") ||
+      json.count("\"thread_name\"") != 2)
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected trace:\n" << json.constData() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString fileName = QDir::temp().filePath("ctkTraceTest1.json");
+  if (!ctkTrace::writeChromeTrace(fileName))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write " << qPrintable(fileName) << std::endl;
+    return EXIT_FAILURE;
+    }
+  QFile file(fileName);
+  file.open(QIODevice::ReadOnly);
+  bool sameTrace = (file.readAll() == json);
+  file.close();
+  QFile::remove(fileName);
+  if (!sameTrace)
+    {
+    std::cerr << "Line " << __LINE__ << " - Written trace differs" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Only the spans recorded after clear() are exported
+  ctkTrace::clear();
+  {
+  CTK_TRACE_SCOPE("after clear");
+  }
+  json = ctkTrace::toChromeTrace();
+  if (ctkTrace::eventCount() != 1 || json.contains("\"outer\"") || !json.contains("\"after clear\""))
+    {
+    std::cerr << "Line " << __LINE__ << " - clear() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Spans beyond the thread capacity, of which the main thread used 3 spans
+  ctkTrace::clear();
+  int maximum = ctkTrace::maximumEventsPerThread();
+  for (int i = 0; i < maximum + 10; ++i)
+    {
+    CTK_TRACE_SCOPE("many");
+    }
+  if (ctkTrace::eventCount() != maximum - 3 || ctkTrace::droppedEventCount() != 13)
+    {
+    std::cerr << "Line " << __LINE__ << " - Expected " << maximum - 3 << " spans and 13 dropped, got "
+              << ctkTrace::eventCount() << " and " << ctkTrace::droppedEventCount() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkTrace::setEnabled(false);
+  return EXIT_SUCCESS;
+}
@@ -92,6 +92,14 @@ int ctkWorkflowTest3(int argc, char * argv [] )
   QTimer::singleShot(defaultTime, &app, SLOT(quit()));
   app.exec();
 
+  // the paths are followed across the branches, and only forward
+  if (!workflow->canGoToStep("Step 6") || !workflow->canGoToStep("Step 8", s3)
+      || workflow->canGoToStep("Step 5", s3) || workflow->canGoToStep("Step 0", s1))
+    {
+    std::cerr << "error finding the paths between the steps" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   // transition to s1
   workflow->goForward();
   QTimer::singleShot(defaultTime, &app, SLOT(quit()));
@@ -0,0 +1,171 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  =========================================================================*/
+
+// QT includes
+#include <QCoreApplication>
+#include <QFutureInterface>
+#include <QTimer>
+
+// CTK includes
+#include "ctkWorkflow.h"
+#include "ctkWorkflowStep.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Step whose validation and entry are completed by the test, as a background
+// task would, while the event loop keeps running
+class ctkAsynchronousWorkflowStep : public ctkWorkflowStep
+{
+public:
+  typedef ctkWorkflowStep Superclass;
+  explicit ctkAsynchronousWorkflowStep(const QString& newId)
+    : Superclass(newId), PrepareCount(0){}
+
+  virtual void validate(const QString& desiredBranchId = QString())
+  {
+    this->Validation = QFutureInterface<bool>();
+    this->Validation.reportStarted();
+    this->validationComplete(this->Validation.future(), desiredBranchId);
+  }
+
+  virtual void onEntry(const ctkWorkflowStep* comingFrom,
+                       const ctkWorkflowInterstepTransition::InterstepTransitionType transitionType)
+  {
+    Q_UNUSED(comingFrom);
+    Q_UNUSED(transitionType);
+    this->Entry = QFutureInterface<void>();
+    this->Entry.reportStarted();
+    this->onEntryComplete(this->Entry.future());
+  }
+
+  virtual void prepareForEntry()
+  {
+    ++this->PrepareCount;
+  }
+
+  void finishValidation(bool validationSucceeded)
+  {
+    this->Validation.reportResult(validationSucceeded);
+    this->Validation.reportFinished();
+  }
+
+  void finishEntry()
+  {
+    this->Entry.reportFinished();
+  }
+
+  int PrepareCount;
+
+private:
+  QFutureInterface<bool> Validation;
+  QFutureInterface<void> Entry;
+};
+
+//-----------------------------------------------------------------------------
+void processEvents(QCoreApplication& app)
+{
+  QTimer::singleShot(100, &app, SLOT(quit()));
+  app.exec();
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int ctkWorkflowTest4(int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  ctkWorkflow workflow;
+  ctkAsynchronousWorkflowStep* s0 = new ctkAsynchronousWorkflowStep("Step 0");
+  ctkAsynchronousWorkflowStep* s1 = new ctkAsynchronousWorkflowStep("Step 1");
+  ctkAsynchronousWorkflowStep* s2 = new ctkAsynchronousWorkflowStep("Step 2");
+  workflow.addTransition(s0, s1);
+  workflow.addTransition(s1, s2);
+  workflow.setInitialStep(s0);
+  workflow.setPrefetchNextStep(true);
+
+  // The workflow waits for the entry work of the initial step
+  workflow.start();
+  processEvents(app);
+  if (workflow.currentStep() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - s0 should still be entering" << std::endl;
+    return EXIT_FAILURE;
+    }
+  s0->finishEntry();
+  processEvents(app);
+  if (workflow.currentStep() != s0 || s1->PrepareCount != 1 || s2->PrepareCount != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to enter s0 and prepare s1" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A failed validation keeps the current step
+  workflow.goForward();
+  processEvents(app);
+  if (workflow.currentStep() != s0)
+    {
+    std::cerr << "Line " << __LINE__ << " - s0 should still be validating" << std::endl;
+    return EXIT_FAILURE;
+    }
+  s0->finishValidation(false);
+  processEvents(app);
+  if (workflow.currentStep() != s0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Validation of s0 should have failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A successful validation goes to the next step once its entry work is done
+  workflow.goForward();
+  processEvents(app);
+  s0->finishValidation(true);
+  processEvents(app);
+  s1->finishEntry();
+  processEvents(app);
+  if (workflow.currentStep() != s1 || s2->PrepareCount != 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to go to s1 and prepare s2" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Prefetching is opt-in
+  workflow.setPrefetchNextStep(false);
+  workflow.goBackward();
+  processEvents(app);
+  s0->finishEntry();
+  processEvents(app);
+  if (workflow.currentStep() != s0 || s1->PrepareCount != 1)
+    {
+    std::cerr << "Line " << __LINE__ << " - s1 should not be prepared again" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  workflow.stop();
+  processEvents(app);
+
+  return EXIT_SUCCESS;
+}
@@ -22,8 +22,12 @@
 #define __ctkAbstractFactory_h
 
 // Qt includes
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QString>
 #include <QHash>
+#include <QList>
+#include <QMutex>
 #include <QSharedPointer>
 #include <QStringList>
 
@@ -59,9 +63,27 @@ public:
   BaseClassType* instance()const;
   virtual void uninstantiate();
 
+  /// \brief Create a new object owned by the caller.
+  /// Unlike instantiate(), the item doesn't hold the object: instance() is
+  /// unchanged. Return 0 if the creation failed or if the item is not
+  /// poolable.
+  /// \sa isPoolable(), ctkAbstractFactory::acquire()
+  BaseClassType* newInstance();
+
+  /// \brief Return true if instanciator() returns a new object each time.
+  /// True by default, items returning a shared object (e.g. the root
+  /// object of a Qt plugin) must return false.
+  virtual bool isPoolable()const;
+
   void setVerbose(bool value);
   bool verbose()const;
 
+  /// \brief Defer load() until the first instantiate().
+  /// Factories set it on items they know to be valid without loading them,
+  /// e.g. items found in a manifest cache. False by default.
+  void setLoadDeferred(bool deferred);
+  bool isLoadDeferred()const;
+
 protected:
 
   void appendInstantiateErrorString(const QString& msg);
@@ -81,11 +103,15 @@ protected:
   BaseClassType* Instance;
 
 private:
+  /// Load the item if its load was deferred, return false if it failed
+  bool loadDeferredItem();
+
   QStringList InstantiateErrorStrings;
   QStringList InstantiateWarningStrings;
   QStringList LoadErrorStrings;
   QStringList LoadWarningStrings;
   bool Verbose;
+  bool LoadDeferred;
 };
 
 //----------------------------------------------------------------------------
@@ -96,6 +122,15 @@ private:
 /// are uniquely identifyed by a key. Subclasses of ctkAbstractFactory are
 /// responsible for populating the list of ctkAbstractFactoryItems.
 /// BaseClassType could be any type (most probably a QObject)
+///
+/// Items are registered from one thread at a time, but item(),
+/// instance(), path() and itemKeys() can be called from any thread: the
+/// first lookup after a registration publishes an immutable snapshot of the
+/// items, which later lookups read without locking.
+///
+/// Besides the instance held by each item, short lived objects can be
+/// obtained with acquire() and given back with release(): released objects
+/// are kept in a pool per item and reused by the next acquire().
 template<typename BaseClassType>
 class ctkAbstractFactory
 {
@@ -103,6 +138,21 @@ public:
 
   typedef QHash<QString, QSharedPointer<ctkAbstractFactoryItem<BaseClassType> > > HashType;
 
+  /// Function called on the objects given back with release(), before they
+  /// are returned again by acquire().
+  typedef void (*PoolResetFunction)(BaseClassType* object);
+
+  /// Objects created for an item by instantiate() and acquire(), the times
+  /// are in nanoseconds.
+  struct InstantiationStatistics
+  {
+    InstantiationStatistics() : Count(0), Failures(0), TotalTime(0), MaximumTime(0) {}
+    int    Count;
+    int    Failures;
+    qint64 TotalTime;
+    qint64 MaximumTime;
+  };
+
   /// Constructor/Desctructor
   ctkAbstractFactory();
   virtual ~ctkAbstractFactory();
@@ -120,6 +170,38 @@ public:
   /// Do nothing if the item given by the key has not be instantiated nor registered.
   void uninstantiate(const QString& itemKey);
 
+  /// \brief Return an object from the pool of \a itemKey, or a new one
+  /// if the pool is empty.
+  /// The object belongs to the caller, it should be given back with
+  /// release() or deleted. Return 0 if the item is not registered or not
+  /// poolable.
+  /// \sa ctkAbstractFactoryItem::isPoolable()
+  BaseClassType* acquire(const QString& itemKey);
+
+  /// \brief Give back an object returned by acquire().
+  /// The object is reset with the poolResetFunction() and kept for the
+  /// next acquire(), or deleted if the pool of the item is full.
+  void release(const QString& itemKey, BaseClassType* object);
+
+  /// Delete the objects in the pool of \a itemKey, or in all the pools if
+  /// \a itemKey is empty.
+  void clearPool(const QString& itemKey = QString());
+
+  /// Number of released objects kept per item, 8 by default.
+  /// 0 deletes the objects as soon as they are released.
+  void setMaximumPoolSize(int size);
+  int maximumPoolSize()const;
+
+  /// Function called on the released objects, none by default.
+  void setPoolResetFunction(PoolResetFunction function);
+  PoolResetFunction poolResetFunction()const;
+
+  /// \brief Return how many objects were created for \a itemKey and how
+  /// long it took.
+  /// Use it to find the items that are expensive to construct.
+  InstantiationStatistics instantiationStatistics(const QString& itemKey)const;
+  void resetInstantiationStatistics();
+
   /// \brief Get path associated with the item identified by \a itemKey
   /// Should be overloaded in subclasse
   virtual QString path(const QString& itemKey){ Q_UNUSED(itemKey); return QString(); }
@@ -146,11 +228,17 @@ protected:
 
   /// \brief Call the load method associated with the item.
   /// If succesfully loaded, add it to the internal map.
+  /// Items with a deferred load are added without being loaded.
   bool registerItem(const QString& key, const QSharedPointer<ctkAbstractFactoryItem<BaseClassType> > & item);
 
   /// Get a Factory item given its itemKey. Return 0 if any.
   ctkAbstractFactoryItem<BaseClassType> * item(const QString& itemKey)const;
 
+  /// Return true if an item is registered with \a itemKey.
+  /// Unlike item(), it doesn't publish a snapshot of the items: use it
+  /// while registering items.
+  bool hasItem(const QString& itemKey)const;
+
   ctkAbstractFactoryItem<BaseClassType> * sharedItem(const QString& itemKey)const;
 
   typedef typename HashType::const_iterator ConstIterator;
@@ -161,9 +249,31 @@ private:
   ctkAbstractFactory(const ctkAbstractFactory &); /// Not implemented
   void operator=(const ctkAbstractFactory&); /// Not implemented
   */
+
+  /// Return the current snapshot, to be released with releaseItems()
+  const HashType* acquireItems()const;
+  void releaseItems()const;
+
+  void recordInstantiation(const QString& itemKey, bool succeeded, qint64 time);
+
   HashType RegisteredItemMap;
   QSharedPointer<HashType> SharedRegisteredItemMap;
 
+  // Snapshot of RegisteredItemMap read by the lookups. Replaced snapshots
+  // are deleted once no lookup is reading a snapshot.
+  mutable QMutex                          RegistrationMutex;
+  mutable QAtomicPointer<const HashType>  PublishedItemMap;
+  mutable QAtomicInt                      PublishedItemMapModified;
+  mutable QAtomicInt                      PublishedItemMapReaders;
+  mutable QList<const HashType*>          RetiredItemMaps;
+
+  // Pools of released objects and statistics, guarded by PoolMutex
+  mutable QMutex                                   PoolMutex;
+  QHash<QString, QList<BaseClassType*> >           Pools;
+  int                                              MaximumPoolSize;
+  PoolResetFunction                                ResetFunction;
+  QHash<QString, InstantiationStatistics>          Statistics;
+
   bool Verbose;
 };
 
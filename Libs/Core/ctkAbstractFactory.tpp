@@ -23,6 +23,7 @@
 
 // QT includes
 #include <QDebug>
+#include <QElapsedTimer>
 
 // CTK includes
 #include "ctkAbstractFactory.h"
@@ -36,6 +37,7 @@ ctkAbstractFactoryItem<BaseClassType>::ctkAbstractFactoryItem()
   :Instance()
 {
   this->Verbose = false;
+  this->LoadDeferred = false;
 }
 
 //----------------------------------------------------------------------------
@@ -134,10 +136,59 @@ BaseClassType* ctkAbstractFactoryItem<BaseClassType>::instantiate()
 {
   this->clearInstantiateErrorStrings();
   this->clearInstantiateWarningStrings();
+  if (!this->loadDeferredItem())
+    {
+    return 0;
+    }
   this->Instance = this->instanciator();
   return this->Instance;
 }
 
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+BaseClassType* ctkAbstractFactoryItem<BaseClassType>::newInstance()
+{
+  if (!this->isPoolable())
+    {
+    return 0;
+    }
+  this->clearInstantiateErrorStrings();
+  this->clearInstantiateWarningStrings();
+  if (!this->loadDeferredItem())
+    {
+    return 0;
+    }
+  return this->instanciator();
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+bool ctkAbstractFactoryItem<BaseClassType>::isPoolable()const
+{
+  return true;
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+bool ctkAbstractFactoryItem<BaseClassType>::loadDeferredItem()
+{
+  if (!this->LoadDeferred)
+    {
+    return true;
+    }
+  this->LoadDeferred = false;
+  if (!this->load())
+    {
+    foreach(const QString& errorString, this->loadErrorStrings())
+      {
+      this->appendInstantiateErrorString(errorString);
+      }
+    this->appendInstantiateErrorString(QLatin1String("Failed to load item"));
+    return false;
+    }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 template<typename BaseClassType>
 bool ctkAbstractFactoryItem<BaseClassType>::isInstantiated()const
@@ -180,12 +231,28 @@ bool ctkAbstractFactoryItem<BaseClassType>::verbose()const
   return this->Verbose;
 }
 
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFactoryItem<BaseClassType>::setLoadDeferred(bool deferred)
+{
+  this->LoadDeferred = deferred;
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+bool ctkAbstractFactoryItem<BaseClassType>::isLoadDeferred()const
+{
+  return this->LoadDeferred;
+}
+
 //----------------------------------------------------------------------------
 // ctkAbstractFactory methods
 
 //----------------------------------------------------------------------------
 template<typename BaseClassType>
 ctkAbstractFactory<BaseClassType>::ctkAbstractFactory()
+  : PublishedItemMap(new HashType), PublishedItemMapModified(0), PublishedItemMapReaders(0)
+  , MaximumPoolSize(8), ResetFunction(0)
 {
   this->Verbose = false;
   this->SharedRegisteredItemMap = QSharedPointer<HashType>(new HashType);
@@ -195,6 +262,9 @@ ctkAbstractFactory<BaseClassType>::ctkAbstractFactory()
 template<typename BaseClassType>
 ctkAbstractFactory<BaseClassType>::~ctkAbstractFactory()
 {
+  this->clearPool();
+  delete this->PublishedItemMap.fetchAndStoreOrdered(0);
+  qDeleteAll(this->RetiredItemMaps);
 }
 
 //----------------------------------------------------------------------------
@@ -202,7 +272,17 @@ template<typename BaseClassType>
 void ctkAbstractFactory<BaseClassType>::printAdditionalInfo()
 {
   qDebug() << "ctkAbstractFactory<BaseClassType> (" << this << ")";
-  // TODO
+  QMutexLocker lock(&this->PoolMutex);
+  typename QHash<QString, InstantiationStatistics>::const_iterator it;
+  for (it = this->Statistics.constBegin(); it != this->Statistics.constEnd(); ++it)
+    {
+    const InstantiationStatistics& statistics = it.value();
+    qDebug().nospace() << "  " << qPrintable(it.key()) << ": "
+                       << statistics.Count << " instantiation(s), "
+                       << statistics.Failures << " failure(s), average "
+                       << (statistics.Count ? statistics.TotalTime / statistics.Count / 1000 : 0)
+                       << " us, maximum " << statistics.MaximumTime / 1000 << " us";
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -215,7 +295,17 @@ BaseClassType* ctkAbstractFactory<BaseClassType>::instantiate(const QString& ite
   if (_item)
     {
     wasInstantiated = _item->isInstantiated();
-    instance = wasInstantiated ? _item->instance() : _item->instantiate();
+    if (wasInstantiated)
+      {
+      instance = _item->instance();
+      }
+    else
+      {
+      QElapsedTimer timer;
+      timer.start();
+      instance = _item->instantiate();
+      this->recordInstantiation(itemKey, instance != 0, timer.nsecsElapsed());
+      }
     }
   if (!wasInstantiated)
     {
@@ -264,6 +354,168 @@ void ctkAbstractFactory<BaseClassType>::uninstantiate(const QString& itemKey)
   _item->uninstantiate();
 }
 
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+BaseClassType* ctkAbstractFactory<BaseClassType>::acquire(const QString& itemKey)
+{
+  ctkAbstractFactoryItem<BaseClassType>* _item = this->item(itemKey);
+  if (!_item || !_item->isPoolable())
+    {
+    return 0;
+    }
+  {
+  QMutexLocker lock(&this->PoolMutex);
+  typename QHash<QString, QList<BaseClassType*> >::iterator pool = this->Pools.find(itemKey);
+  if (pool != this->Pools.end() && !pool.value().isEmpty())
+    {
+    return pool.value().takeLast();
+    }
+  }
+  QElapsedTimer timer;
+  timer.start();
+  BaseClassType* object = _item->newInstance();
+  this->recordInstantiation(itemKey, object != 0, timer.nsecsElapsed());
+  if (!object)
+    {
+    this->displayStatusMessage(QtCriticalMsg,
+                               QString("Attempt to instantiate \"%1\"").arg(itemKey),
+                               "Failed", this->verbose());
+    }
+  return object;
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFactory<BaseClassType>::release(const QString& itemKey, BaseClassType* object)
+{
+  if (!object)
+    {
+    return;
+    }
+  PoolResetFunction resetFunction = this->poolResetFunction();
+  if (resetFunction)
+    {
+    resetFunction(object);
+    }
+  bool pooled = false;
+  if (this->item(itemKey))
+    {
+    QMutexLocker lock(&this->PoolMutex);
+    QList<BaseClassType*>& pool = this->Pools[itemKey];
+    if (pool.size() < this->MaximumPoolSize)
+      {
+      pool.append(object);
+      pooled = true;
+      }
+    }
+  if (!pooled)
+    {
+    delete object;
+    }
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFactory<BaseClassType>::clearPool(const QString& itemKey)
+{
+  QList<BaseClassType*> objects;
+  {
+  QMutexLocker lock(&this->PoolMutex);
+  if (itemKey.isEmpty())
+    {
+    foreach(const QList<BaseClassType*>& pool, this->Pools)
+      {
+      objects << pool;
+      }
+    this->Pools.clear();
+    }
+  else
+    {
+    objects = this->Pools.take(itemKey);
+    }
+  }
+  qDeleteAll(objects);
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFactory<BaseClassType>::setMaximumPoolSize(int size)
+{
+  QList<BaseClassType*> objects;
+  {
+  QMutexLocker lock(&this->PoolMutex);
+  this->MaximumPoolSize = qMax(0, size);
+  typename QHash<QString, QList<BaseClassType*> >::iterator it;
+  for (it = this->Pools.begin(); it != this->Pools.end(); ++it)
+    {
+    while (it.value().size() > this->MaximumPoolSize)
+      {
+      objects << it.value().takeLast();
+      }
+    }
+  }
+  qDeleteAll(objects);
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+int ctkAbstractFactory<BaseClassType>::maximumPoolSize()const
+{
+  QMutexLocker lock(&this->PoolMutex);
+  return this->MaximumPoolSize;
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFactory<BaseClassType>::setPoolResetFunction(PoolResetFunction function)
+{
+  QMutexLocker lock(&this->PoolMutex);
+  this->ResetFunction = function;
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+typename ctkAbstractFactory<BaseClassType>::PoolResetFunction
+ctkAbstractFactory<BaseClassType>::poolResetFunction()const
+{
+  QMutexLocker lock(&this->PoolMutex);
+  return this->ResetFunction;
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+typename ctkAbstractFactory<BaseClassType>::InstantiationStatistics
+ctkAbstractFactory<BaseClassType>::instantiationStatistics(const QString& itemKey)const
+{
+  QMutexLocker lock(&this->PoolMutex);
+  return this->Statistics.value(itemKey);
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFactory<BaseClassType>::resetInstantiationStatistics()
+{
+  QMutexLocker lock(&this->PoolMutex);
+  this->Statistics.clear();
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFactory<BaseClassType>::recordInstantiation(
+  const QString& itemKey, bool succeeded, qint64 time)
+{
+  QMutexLocker lock(&this->PoolMutex);
+  InstantiationStatistics& statistics = this->Statistics[itemKey];
+  if (!succeeded)
+    {
+    ++statistics.Failures;
+    return;
+    }
+  ++statistics.Count;
+  statistics.TotalTime += time;
+  statistics.MaximumTime = qMax(statistics.MaximumTime, time);
+}
+
 //----------------------------------------------------------------------------
 template<typename BaseClassType>
 void ctkAbstractFactory<BaseClassType>::setSharedItems(const QSharedPointer<HashType>& items)
@@ -285,7 +537,9 @@ QStringList ctkAbstractFactory<BaseClassType>::itemKeys() const
 {
   // Since by construction, we checked if a name was already in the QHash,
   // there is no need to call 'uniqueKeys'
-  return this->RegisteredItemMap.keys();
+  QStringList keys = this->acquireItems()->keys();
+  this->releaseItems();
+  return keys;
 }
 
 //----------------------------------------------------------------------------
@@ -331,7 +585,7 @@ bool ctkAbstractFactory<BaseClassType>::registerItem(const QString& key,
 
   QString description = QString("Attempt to register \"%1\"").arg(key);
 
-  if (this->item(key))
+  if (this->hasItem(key))
     {
     this->displayStatusMessage(QtWarningMsg, description, "Already registered", this->verbose());
     return false;
@@ -344,8 +598,8 @@ bool ctkAbstractFactory<BaseClassType>::registerItem(const QString& key,
     return false;
     }
   
-  // Attempt to load it
-  if (!_item->load())
+  // Attempt to load it, unless the factory knows it is valid
+  if (!_item->isLoadDeferred() && !_item->load())
     {
     this->displayStatusMessage(QtCriticalMsg, description, "Failed", this->verbose());
     if(!_item->loadErrorStrings().isEmpty())
@@ -366,7 +620,11 @@ bool ctkAbstractFactory<BaseClassType>::registerItem(const QString& key,
     }
   
   // Store item reference using a QSharedPointer
+  {
+  QMutexLocker lock(&this->RegistrationMutex);
   this->RegisteredItemMap.insert(key, _item);
+  this->PublishedItemMapModified.fetchAndStoreOrdered(1);
+  }
   this->SharedRegisteredItemMap.data()->insert(key, _item);
 
   this->displayStatusMessage(QtDebugMsg, description, "OK", this->verbose());
@@ -377,12 +635,54 @@ bool ctkAbstractFactory<BaseClassType>::registerItem(const QString& key,
 template<typename BaseClassType>
 ctkAbstractFactoryItem<BaseClassType> * ctkAbstractFactory<BaseClassType>::item(const QString& itemKey)const
 {
-  ConstIterator iter = this->RegisteredItemMap.find(itemKey);
-  if ( iter == this->RegisteredItemMap.constEnd())
+  const HashType* items = this->acquireItems();
+  ConstIterator iter = items->find(itemKey);
+  // Items are never unregistered, the pointer outlives the snapshot
+  ctkAbstractFactoryItem<BaseClassType>* _item =
+    iter == items->constEnd() ? 0 : iter.value().data();
+  this->releaseItems();
+  return _item;
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+bool ctkAbstractFactory<BaseClassType>::hasItem(const QString& itemKey)const
+{
+  QMutexLocker lock(&this->RegistrationMutex);
+  return this->RegisteredItemMap.contains(itemKey);
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+const typename ctkAbstractFactory<BaseClassType>::HashType*
+ctkAbstractFactory<BaseClassType>::acquireItems()const
+{
+  if (this->PublishedItemMapModified.fetchAndAddRelaxed(0))
     {
-    return 0;
+    QMutexLocker lock(&this->RegistrationMutex);
+    if (this->PublishedItemMapModified.fetchAndAddOrdered(0))
+      {
+      // Implicitly shared copy: the registrations detach RegisteredItemMap
+      const HashType* retired =
+        this->PublishedItemMap.fetchAndStoreOrdered(new HashType(this->RegisteredItemMap));
+      this->PublishedItemMapModified.fetchAndStoreOrdered(0);
+      this->RetiredItemMaps << retired;
+      if (this->PublishedItemMapReaders.fetchAndAddOrdered(0) == 0)
+        {
+        qDeleteAll(this->RetiredItemMaps);
+        this->RetiredItemMaps.clear();
+        }
+      }
     }
-  return iter.value().data();
+  this->PublishedItemMapReaders.fetchAndAddOrdered(1);
+  return this->PublishedItemMap.fetchAndAddOrdered(0);
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFactory<BaseClassType>::releaseItems()const
+{
+  this->PublishedItemMapReaders.fetchAndAddOrdered(-1);
 }
 
 //----------------------------------------------------------------------------
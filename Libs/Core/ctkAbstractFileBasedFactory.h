@@ -23,7 +23,9 @@
 
 // Qt includes
 #include <QFileInfo>
+#include <QRunnable>
 #include <QStringList>
+#include <QVariantMap>
 
 // CTK includes
 #include "ctkAbstractFactory.h"
@@ -43,12 +45,29 @@ private:
   QString               Path;
 };
 
+template<typename BaseClassType>
+class ctkAbstractFileBasedFactoryPreloadTask;
+
 //----------------------------------------------------------------------------
 /// \ingroup Core
+/// ctkAbstractFileBasedFactory registers items from files found in directories.
+/// <p> If a cache file name is set, registerAllFileItems() records in it which
+/// files were valid, keyed by file path, size and modification time. Files
+/// that are unchanged since are registered without being loaded; they are
+/// loaded the first time they are instantiated, like the files for which
+/// canDeferLoad() is true. The other files are preloaded concurrently before
+/// being registered.
 template<typename BaseClassType>
 class ctkAbstractFileBasedFactory : public ctkAbstractFactory<BaseClassType>
 {
 public:
+  ctkAbstractFileBasedFactory();
+
+  /// Set the manifest cache used by registerAllFileItems(). It is read and
+  /// written with QSettings in the INI format. Empty (no cache) by default.
+  void setCacheFileName(const QString& fileName);
+  QString cacheFileName()const;
+
   virtual bool isValidFile(const QFileInfo& file)const;
   QString itemKey(const QFileInfo& file)const;
 
@@ -62,12 +81,48 @@ public:
 protected:
   void registerAllFileItems(const QStringList& directories);
 
-  bool registerFileItem(const QString& key, const QFileInfo& file);
+  /// Register the item, without loading it if \a deferLoad is true.
+  bool registerFileItem(const QString& key, const QFileInfo& file, bool deferLoad = false);
 
   virtual ctkAbstractFactoryItem<BaseClassType>* createFactoryFileBasedItem();
   virtual void initItem(ctkAbstractFactoryItem<BaseClassType>* item);
 
   virtual QString fileNameToKey(const QString& path)const;
+
+  /// Symbols the items must provide. A cache entry recorded with other
+  /// symbols is ignored. Empty by default.
+  virtual QStringList requiredSymbols()const;
+
+  /// Return true if \a file is known to be valid without being loaded, its
+  /// item is then loaded the first time it is instantiated. False by default.
+  virtual bool canDeferLoad(const QFileInfo& file)const;
+
+  /// Called from worker threads for the files that aren't in the cache,
+  /// before they are registered, to do the expensive part of the loading
+  /// concurrently. Must be thread-safe. Does nothing by default.
+  virtual void preloadFile(const QFileInfo& file)const;
+
+  QVariantMap readCache()const;
+  void writeCache(const QVariantMap& cache)const;
+
+private:
+  friend class ctkAbstractFileBasedFactoryPreloadTask<BaseClassType>;
+
+  QString CacheFileName;
+};
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+class ctkAbstractFileBasedFactoryPreloadTask : public QRunnable
+{
+public:
+  ctkAbstractFileBasedFactoryPreloadTask(
+    const ctkAbstractFileBasedFactory<BaseClassType>* factory, const QString& path);
+  virtual void run();
+
+private:
+  const ctkAbstractFileBasedFactory<BaseClassType>* Factory;
+  QString Path;
 };
 
 #include "ctkAbstractFileBasedFactory.tpp"
@@ -22,7 +22,10 @@
 #define __ctkAbstractFileBasedFactory_tpp
 
 // Qt includes
+#include <QDateTime>
 #include <QDirIterator>
+#include <QSettings>
+#include <QThreadPool>
 
 // CTK includes
 #include "ctkAbstractFileBasedFactory.h"
@@ -44,9 +47,48 @@ QString ctkAbstractFactoryFileBasedItem<BaseClassType>::path()const
   return this->Path;
 }
 
+//----------------------------------------------------------------------------
+// ctkAbstractFileBasedFactoryPreloadTask methods
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+ctkAbstractFileBasedFactoryPreloadTask<BaseClassType>::ctkAbstractFileBasedFactoryPreloadTask(
+  const ctkAbstractFileBasedFactory<BaseClassType>* factory, const QString& path)
+  : Factory(factory)
+  , Path(path)
+{
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFileBasedFactoryPreloadTask<BaseClassType>::run()
+{
+  this->Factory->preloadFile(QFileInfo(this->Path));
+}
+
 //----------------------------------------------------------------------------
 // ctkAbstractFileBasedFactory methods
 
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+ctkAbstractFileBasedFactory<BaseClassType>::ctkAbstractFileBasedFactory()
+{
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFileBasedFactory<BaseClassType>::setCacheFileName(const QString& fileName)
+{
+  this->CacheFileName = fileName;
+}
+
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+QString ctkAbstractFileBasedFactory<BaseClassType>::cacheFileName()const
+{
+  return this->CacheFileName;
+}
+
 //----------------------------------------------------------------------------
 template<typename BaseClassType>
 QString ctkAbstractFileBasedFactory<BaseClassType>::path(const QString& key)
@@ -61,6 +103,7 @@ QString ctkAbstractFileBasedFactory<BaseClassType>::path(const QString& key)
 template<typename BaseClassType>
 void ctkAbstractFileBasedFactory<BaseClassType>::registerAllFileItems(const QStringList& directories)
 {
+  QList<QFileInfo> files;
   // Process one path at a time
   foreach (QString path, directories)
     {
@@ -80,9 +123,69 @@ void ctkAbstractFileBasedFactory<BaseClassType>::registerAllFileItems(const QStr
         {
         continue;
         }
-      this->registerFileItem(fileInfo);
+      files << fileInfo;
+      }
+    }
+
+  QVariantMap cache = this->readCache();
+  QStringList symbols = this->requiredSymbols();
+
+  // Find the files that are unchanged since they were cached or that don't
+  // need to be loaded, and preload the others concurrently.
+  QList<bool> cachedFiles;
+  QList<bool> deferrableFiles;
+  QThreadPool preloadPool;
+  foreach (const QFileInfo& fileInfo, files)
+    {
+    QString key = this->itemKey(fileInfo);
+    QVariantMap entry = cache.value(fileInfo.filePath()).toMap();
+    bool cached = !entry.isEmpty() &&
+      entry.value("key").toString() == key &&
+      entry.value("size").toLongLong() == fileInfo.size() &&
+      entry.value("lastModified").toDateTime() == fileInfo.lastModified() &&
+      entry.value("symbols").toStringList() == symbols;
+    bool deferrable = !cached && this->canDeferLoad(fileInfo);
+    cachedFiles << cached;
+    deferrableFiles << deferrable;
+    if (!cached && !deferrable && !this->hasItem(key) && !this->sharedItem(key))
+      {
+      preloadPool.start(new ctkAbstractFileBasedFactoryPreloadTask<BaseClassType>(
+                          this, fileInfo.filePath()));
+      }
+    }
+  preloadPool.waitForDone();
+
+  for (int i = 0; i < files.count(); ++i)
+    {
+    const QFileInfo& fileInfo = files.at(i);
+    QString key = this->itemKey(fileInfo);
+    if (this->hasItem(key) || this->sharedItem(key))
+      {
+      this->registerFileItem(key, fileInfo);
+      continue;
+      }
+    bool cached = cachedFiles.at(i);
+    if (cached && !cache.value(fileInfo.filePath()).toMap().value("valid").toBool())
+      {
+      this->displayStatusMessage(QtDebugMsg, QString("Attempt to register \"%1\"").arg(key),
+                                 "Invalid in cache", this->verbose());
+      continue;
+      }
+    bool registered = this->registerFileItem(key, fileInfo,
+                                             cached || deferrableFiles.at(i));
+    if (!cached)
+      {
+      QVariantMap entry;
+      entry["key"] = key;
+      entry["size"] = fileInfo.size();
+      entry["lastModified"] = fileInfo.lastModified();
+      entry["symbols"] = symbols;
+      entry["valid"] = registered;
+      cache.insert(fileInfo.filePath(), entry);
       }
     }
+
+  this->writeCache(cache);
 }
 
 //-----------------------------------------------------------------------------
@@ -99,17 +202,17 @@ QString ctkAbstractFileBasedFactory<BaseClassType>
 ::registerFileItem(const QFileInfo& fileInfo)
 {
   QString key = this->itemKey(fileInfo);
-  bool registered = this->registerFileItem(key, fileInfo);
+  bool registered = this->registerFileItem(key, fileInfo, this->canDeferLoad(fileInfo));
   return registered ? key : QString();
 }
 
 //-----------------------------------------------------------------------------
 template<typename BaseClassType>
 bool ctkAbstractFileBasedFactory<BaseClassType>
-::registerFileItem(const QString& key, const QFileInfo& fileInfo)
+::registerFileItem(const QString& key, const QFileInfo& fileInfo, bool deferLoad)
 {
   QString description = QString("Attempt to register \"%1\"").arg(key);
-  if (this->item(key))
+  if (this->hasItem(key))
     {
     this->displayStatusMessage(QtWarningMsg, description, "Already registered", this->verbose());
     return true;
@@ -131,6 +234,7 @@ bool ctkAbstractFileBasedFactory<BaseClassType>
   dynamic_cast<ctkAbstractFactoryFileBasedItem<BaseClassType>*>(itemToRegister.data())
     ->setPath(fileInfo.filePath());
   this->initItem(itemToRegister.data());
+  itemToRegister->setLoadDeferred(deferLoad);
   return this->registerItem(key, itemToRegister);
 }
 
@@ -166,4 +270,59 @@ QString ctkAbstractFileBasedFactory<BaseClassType>
   return QFileInfo(fileName).baseName();
 }
 
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+QStringList ctkAbstractFileBasedFactory<BaseClassType>::requiredSymbols()const
+{
+  return QStringList();
+}
+
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+bool ctkAbstractFileBasedFactory<BaseClassType>::canDeferLoad(const QFileInfo& file)const
+{
+  Q_UNUSED(file);
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFileBasedFactory<BaseClassType>::preloadFile(const QFileInfo& file)const
+{
+  Q_UNUSED(file);
+}
+
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+QVariantMap ctkAbstractFileBasedFactory<BaseClassType>::readCache()const
+{
+  if (this->CacheFileName.isEmpty())
+    {
+    return QVariantMap();
+    }
+  QSettings settings(this->CacheFileName, QSettings::IniFormat);
+  return settings.value("files").toMap();
+}
+
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractFileBasedFactory<BaseClassType>::writeCache(const QVariantMap& cache)const
+{
+  if (this->CacheFileName.isEmpty())
+    {
+    return;
+    }
+  // Forget the files that don't exist anymore
+  QVariantMap existingFiles;
+  for (QVariantMap::const_iterator it = cache.constBegin(); it != cache.constEnd(); ++it)
+    {
+    if (QFile::exists(it.key()))
+      {
+      existingFiles.insert(it.key(), it.value());
+      }
+    }
+  QSettings settings(this->CacheFileName, QSettings::IniFormat);
+  settings.setValue("files", existingFiles);
+}
+
 #endif
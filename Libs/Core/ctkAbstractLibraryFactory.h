@@ -28,6 +28,7 @@
 
 // CTK includes
 #include "ctkAbstractFileBasedFactory.h"
+#include "ctkLibrarySymbolTable.h"
 
 //----------------------------------------------------------------------------
 /// \ingroup Core
@@ -79,15 +80,34 @@ class ctkAbstractLibraryFactory
   : public ctkAbstractFileBasedFactory<BaseClassType>
 {
 public:
+  ctkAbstractLibraryFactory();
+
   /// Set the list of symbols
   void setSymbols(const QStringList& symbols);
 
+  /// \brief Check the symbols in the export table of the files.
+  /// If true, the files that miss one of the symbols are rejected by
+  /// isValidFile() and the files that have all of them are registered
+  /// without being loaded, using ctkLibrarySymbolTable. Their failures to
+  /// load (e.g. a missing dependency) are then only reported when they are
+  /// instantiated. The files whose format isn't supported are loaded to be
+  /// checked. False by default.
+  void setCheckSymbolsWithoutLoading(bool check);
+  bool checkSymbolsWithoutLoading()const;
+
 protected:
   virtual bool isValidFile(const QFileInfo& file)const;
   virtual void initItem(ctkAbstractFactoryItem<BaseClassType>* item);
 
+  virtual QStringList requiredSymbols()const;
+  virtual bool canDeferLoad(const QFileInfo& file)const;
+
+  /// Load the library, the item then finds it already loaded.
+  virtual void preloadFile(const QFileInfo& file)const;
+
 private:
   QStringList Symbols;
+  bool CheckSymbolsWithoutLoading;
 };
 
 #include "ctkAbstractLibraryFactory.tpp"
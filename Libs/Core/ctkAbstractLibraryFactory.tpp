@@ -110,6 +110,13 @@ ctkFactoryLibraryItem<BaseClassType>::symbolAddress(const QString& symbol)const
 //----------------------------------------------------------------------------
 // ctkAbstractLibraryFactory methods
 
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+ctkAbstractLibraryFactory<BaseClassType>::ctkAbstractLibraryFactory()
+{
+  this->CheckSymbolsWithoutLoading = false;
+}
+
 //-----------------------------------------------------------------------------
 template<typename BaseClassType>
 void ctkAbstractLibraryFactory<BaseClassType>::setSymbols(
@@ -123,8 +130,20 @@ template<typename BaseClassType>
 bool ctkAbstractLibraryFactory<BaseClassType>
 ::isValidFile(const QFileInfo& file)const
 {
-  return this->ctkAbstractFileBasedFactory<BaseClassType>::isValidFile(file) &&
-    QLibrary::isLibrary(file.fileName());
+  if (!this->ctkAbstractFileBasedFactory<BaseClassType>::isValidFile(file) ||
+      !QLibrary::isLibrary(file.fileName()))
+    {
+    return false;
+    }
+  if (this->CheckSymbolsWithoutLoading)
+    {
+    ctkLibrarySymbolTable symbolTable(file.filePath());
+    if (symbolTable.load() && !symbolTable.containsAll(this->Symbols))
+      {
+      return false;
+      }
+    }
+  return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -136,4 +155,46 @@ initItem(ctkAbstractFactoryItem<BaseClassType>* item)
   dynamic_cast<ctkFactoryLibraryItem<BaseClassType>*>(item)->setSymbols(this->Symbols);
 }
 
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractLibraryFactory<BaseClassType>::setCheckSymbolsWithoutLoading(bool check)
+{
+  this->CheckSymbolsWithoutLoading = check;
+}
+
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+bool ctkAbstractLibraryFactory<BaseClassType>::checkSymbolsWithoutLoading()const
+{
+  return this->CheckSymbolsWithoutLoading;
+}
+
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+bool ctkAbstractLibraryFactory<BaseClassType>::canDeferLoad(const QFileInfo& file)const
+{
+  if (!this->CheckSymbolsWithoutLoading)
+    {
+    return false;
+    }
+  ctkLibrarySymbolTable symbolTable(file.filePath());
+  return symbolTable.load() && symbolTable.containsAll(this->Symbols);
+}
+
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+QStringList ctkAbstractLibraryFactory<BaseClassType>::requiredSymbols()const
+{
+  return this->Symbols;
+}
+
+//-----------------------------------------------------------------------------
+template<typename BaseClassType>
+void ctkAbstractLibraryFactory<BaseClassType>::preloadFile(const QFileInfo& file)const
+{
+  // The library stays loaded when the QLibrary is destroyed.
+  QLibrary library(file.filePath());
+  library.load();
+}
+
 #endif
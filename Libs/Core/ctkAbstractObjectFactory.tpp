@@ -61,7 +61,7 @@ template<typename ClassType>
 bool ctkAbstractObjectFactory<BaseClassType>::registerObject(const QString& key)
 {
   QString description = QString("Attempt to register \"%1\"").arg(key);
-  if (this->item(key))
+  if (this->hasItem(key))
     {
     this->displayStatusMessage(QtWarningMsg, description, "Already registered", this->verbose());
     return false;
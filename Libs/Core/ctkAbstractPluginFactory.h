@@ -37,6 +37,10 @@ public:
   virtual bool load();
   virtual QString loadErrorString()const;
 
+  /// The instance is the root object of the plugin, shared by all the
+  /// loaders of the plugin.
+  virtual bool isPoolable()const;
+
 protected:
   virtual BaseClassType* instanciator();
 
@@ -61,6 +61,13 @@ QString ctkFactoryPluginItem<BaseClassType>::loadErrorString()const
   return this->Loader.errorString();
 }
 
+//----------------------------------------------------------------------------
+template<typename BaseClassType>
+bool ctkFactoryPluginItem<BaseClassType>::isPoolable()const
+{
+  return false;
+}
+
 //----------------------------------------------------------------------------
 template<typename BaseClassType>
 BaseClassType* ctkFactoryPluginItem<BaseClassType>::instanciator()
@@ -31,7 +31,10 @@
 
 #include "ctkBackTrace.h"
 
+#include <QHash>
 #include <QList>
+#include <QMutex>
+#include <QVector>
 
 #include <vector>
 
@@ -71,7 +74,9 @@ size_t const ctkBackTrace::DefaultStackSize = 32;
 // --------------------------------------------------------------------------
 struct ctkBackTracePrivate
 {
-  std::vector<void *> Frames;
+  /// Raw return addresses, symbolized only when a frame is printed.
+  /// Implicitly shared so that copying an exception doesn't copy them.
+  QVector<void *> Frames;
 
   int trace(void** addresses, size_t size) const;
   std::string getSymbol(void* address) const;
@@ -88,9 +93,20 @@ ctkBackTrace::ctkBackTrace(size_t framesNumber)
 {
   if(framesNumber == 0)
     return;
-  d->Frames.resize(framesNumber, 0);
-  size_t size = d->trace(&d->Frames.front(), framesNumber);
+  // Capture on the stack, allocate only what is used
+  void* stackFrames[64];
+  std::vector<void *> heapFrames;
+  void** frames = stackFrames;
+  if (framesNumber > sizeof(stackFrames) / sizeof(void*))
+  {
+    heapFrames.resize(framesNumber, 0);
+    frames = &heapFrames.front();
+  }
+  int size = d->trace(frames, framesNumber);
+  if (size <= 0)
+    return;
   d->Frames.resize(size);
+  qCopy(frames, frames + size, d->Frames.begin());
 }
 
 // --------------------------------------------------------------------------
@@ -108,15 +124,15 @@ size_t ctkBackTrace::stackSize() const
 void* ctkBackTrace::returnAddress(unsigned frameNumber) const
 {
   if(frameNumber < stackSize())
-    return d->Frames[frameNumber];
+    return d->Frames.at(frameNumber);
   return 0;
 }
 
 // --------------------------------------------------------------------------
 QString ctkBackTrace::stackFrame(unsigned frameNumber) const
 {
-  if(frameNumber < d->Frames.size())
-    return QString::fromStdString(d->getSymbol(d->Frames[frameNumber]));
+  if(frameNumber < stackSize())
+    return QString::fromStdString(d->getSymbol(d->Frames.at(frameNumber)));
   return QString();
 }
 
@@ -128,9 +144,9 @@ QList<QString> ctkBackTrace::stackTrace() const
   if(d->Frames.empty())
     return trace;
 
-  for (std::size_t i = 0; i < d->Frames.size(); ++i)
+  for (int i = 0; i < d->Frames.size(); ++i)
   {
-    std::string s = d->getSymbol(d->Frames[i]);
+    std::string s = d->getSymbol(d->Frames.at(i));
     if (!s.empty())
     {
       trace.push_back(QString::fromStdString(s));
@@ -187,6 +203,70 @@ int ctkBackTracePrivate::trace(void** /*array*/, size_t /*n*/) const
 
 #if defined(CTK_HAVE_DLADDR) && defined(CTK_HAVE_ABI_CXA_DEMANGLE)
 
+namespace {
+
+// --------------------------------------------------------------------------
+// Demangled names, shared by all the back traces of the process.
+// The cache is keyed by the mangled name rather than the address so that it
+// stays valid when libraries are unloaded and others mapped in their place.
+struct ctkBackTraceSymbolCache
+{
+  QMutex Mutex;
+  QHash<QByteArray, std::string> DemangledNames;
+};
+
+}
+
+Q_GLOBAL_STATIC(ctkBackTraceSymbolCache, backTraceSymbolCache)
+
+namespace {
+
+// --------------------------------------------------------------------------
+std::string demangle(const char* mangledName)
+{
+  // Bound the memory used by the cache
+  static const int MaximumCachedNames = 8192;
+
+  ctkBackTraceSymbolCache* cache = backTraceSymbolCache();
+  QByteArray key = QByteArray::fromRawData(mangledName, qstrlen(mangledName));
+  if (cache)
+  {
+    QMutexLocker lock(&cache->Mutex);
+    QHash<QByteArray, std::string>::const_iterator it = cache->DemangledNames.constFind(key);
+    if (it != cache->DemangledNames.constEnd())
+    {
+      return it.value();
+    }
+  }
+
+  std::string name;
+  int status = 0;
+  char *demangled = abi::__cxa_demangle(mangledName, 0, 0, &status);
+  if(demangled)
+  {
+    name = demangled;
+    free(demangled);
+  }
+  else
+  {
+    name = mangledName;
+  }
+
+  if (cache)
+  {
+    QMutexLocker lock(&cache->Mutex);
+    if (cache->DemangledNames.size() >= MaximumCachedNames)
+    {
+      cache->DemangledNames.clear();
+    }
+    // Deep copy, the symbol name belongs to the library
+    cache->DemangledNames.insert(QByteArray(mangledName), name);
+  }
+  return name;
+}
+
+}
+
 // --------------------------------------------------------------------------
 std::string ctkBackTracePrivate::getSymbol(void* ptr) const
 {
@@ -205,17 +285,7 @@ std::string ctkBackTracePrivate::getSymbol(void* ptr) const
   {
     if(info.dli_sname)
     {
-      int status = 0;
-      char *demangled = abi::__cxa_demangle(info.dli_sname, 0, 0, &status);
-      if(demangled)
-      {
-        res << demangled;
-        free(demangled);
-      }
-      else
-      {
-        res << info.dli_sname;
-      }
+      res << demangle(info.dli_sname);
     }
     else
     {
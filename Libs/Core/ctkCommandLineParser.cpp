@@ -23,11 +23,13 @@
 
 // Qt includes 
 #include <QHash>
+#include <QSet>
 #include <QStringList>
 #include <QTextStream>
 #include <QDebug>
 #include <QSettings>
 #include <QPointer>
+#include <QRegExp>
 
 // CTK includes
 #include "ctkCommandLineParser.h"
@@ -38,6 +40,15 @@ namespace
 class CommandLineParserArgumentDescription
 {
 public:
+  /// The default integer and double expressions are checked without QRegExp
+  enum ValidatorType
+    {
+    NoValidation,
+    IntegerValidation,
+    DoubleValidation,
+    RegularExpressionValidation
+    };
+
   CommandLineParserArgumentDescription(
     const QString& longArg, const QString& longArgPrefix,
     const QString& shortArg, const QString& shortArgPrefix,
@@ -47,12 +58,14 @@ public:
       : LongArg(longArg), LongArgPrefix(longArgPrefix),
       ShortArg(shortArg), ShortArgPrefix(shortArgPrefix),
       ArgHelp(argHelp), IgnoreRest(ignoreRest), NumberOfParametersToProcess(0),
-      Deprecated(deprecated), DefaultValue(defaultValue), Value(type), ValueType(type)
+      Deprecated(deprecated), Validator(NoValidation), Parsed(false),
+      DefaultValue(defaultValue), Value(type), ValueType(type)
   {
     if (defaultValue.isValid())
       {
       Value = defaultValue;
       }
+    Key = !longArg.isEmpty() ? longArg : shortArg;
 
     switch (type)
       {
@@ -91,11 +104,14 @@ public:
       default:
         ExactMatchFailedMessage = QString("Type %1 not supported.").arg(static_cast<int>(type));
       }
-
+    this->setRegularExpression(RegularExpression);
   }
 
   ~CommandLineParserArgumentDescription(){}
 
+  /// Compile \a expression once instead of for every parameter
+  void setRegularExpression(const QString& expression);
+
   bool addParameter(const QString& value);
 
   QString helpText(int fieldWidth, const char charPad, const QString& settingsValue = "");
@@ -110,23 +126,84 @@ public:
   QString RegularExpression;
   QString ExactMatchFailedMessage;
   bool    Deprecated;
+  QString Key;
+
+  ValidatorType Validator;
+  QRegExp       CompiledRegularExpression;
+  bool          Parsed;
 
   QVariant       DefaultValue;
   QVariant       Value;
   QVariant::Type ValueType;
 };
 
+// --------------------------------------------------------------------------
+void CommandLineParserArgumentDescription::setRegularExpression(const QString& expression)
+{
+  this->RegularExpression = expression;
+  this->CompiledRegularExpression = QRegExp();
+  if (expression.isEmpty() || expression == ".*")
+    {
+    this->Validator = NoValidation;
+    }
+  else if (expression == "-?[0-9]+")
+    {
+    this->Validator = IntegerValidation;
+    }
+  else if (expression == "-?[0-9]*\\.?[0-9]+")
+    {
+    this->Validator = DoubleValidation;
+    }
+  else
+    {
+    this->Validator = RegularExpressionValidation;
+    this->CompiledRegularExpression = QRegExp(expression);
+    }
+}
+
+// --------------------------------------------------------------------------
+bool isDigit(QChar c)
+{
+  return c >= QLatin1Char('0') && c <= QLatin1Char('9');
+}
+
 // --------------------------------------------------------------------------
 bool CommandLineParserArgumentDescription::addParameter(const QString& value)
 {
-  if (!RegularExpression.isEmpty())
+  // Validate value
+  switch (this->Validator)
     {
-    // Validate value
-    QRegExp regexp(this->RegularExpression);
-    if (!regexp.exactMatch(value))
+    case IntegerValidation:
+    case DoubleValidation:
       {
-      return false;
+      // Same as an exact match of "-?[0-9]+" or "-?[0-9]*\\.?[0-9]+"
+      int start = value.startsWith(QLatin1Char('-')) ? 1 : 0;
+      bool point = false;
+      for (int i = start; i < value.size(); ++i)
+        {
+        if (value.at(i) == QLatin1Char('.') && this->Validator == DoubleValidation && !point)
+          {
+          point = true;
+          }
+        else if (!isDigit(value.at(i)))
+          {
+          return false;
+          }
+        }
+      if (value.size() == start || !isDigit(value.at(value.size() - 1)))
+        {
+        return false;
+        }
       }
+      break;
+    case RegularExpressionValidation:
+      if (!this->CompiledRegularExpression.exactMatch(value))
+        {
+        return false;
+        }
+      break;
+    default:
+      break;
     }
 
   switch (Value.type())
@@ -151,7 +228,9 @@ bool CommandLineParserArgumentDescription::addParameter(const QString& value)
         }
       else
         {
+        // Release the variant's copy so that appending doesn't detach the list
         QStringList list = Value.toStringList();
+        Value = QVariant();
         list << value;
         Value.setValue(list);
         }
@@ -233,20 +312,31 @@ class ctkCommandLineParser::ctkInternal
 {
 public:
   ctkInternal(QSettings* settings)
-    : Debug(false), FieldWidth(0), UseQSettings(false),
+    : ArgumentTableModified(true), Debug(false), FieldWidth(0), UseQSettings(false),
       Settings(settings), MergeSettings(true), StrictMode(false)
   {}
 
   ~ctkInternal() { qDeleteAll(ArgumentDescriptionList); }
   
   CommandLineParserArgumentDescription* argumentDescription(const QString& argument);
+
+  /// Same as argumentDescription() but with a single lookup of the prefixed
+  /// argument in ArgumentTable
+  CommandLineParserArgumentDescription* parsedArgumentDescription(const QString& argument);
+
+  /// Build ArgumentTable if an argument or a prefix changed since last time
+  void updateArgumentTable();
   
   QList<CommandLineParserArgumentDescription*>                 ArgumentDescriptionList;
   QHash<QString, CommandLineParserArgumentDescription*>        ArgNameToArgumentDescriptionMap;
   QMap<QString, QList<CommandLineParserArgumentDescription*> > GroupToArgumentDescriptionListMap;
+
+  /// Every spelling (with long, short or no prefix) of the registered arguments
+  QHash<QString, CommandLineParserArgumentDescription*>        ArgumentTable;
+  bool                                                         ArgumentTableModified;
   
   QStringList UnparsedArguments; 
-  QStringList ProcessedArguments;
+  QSet<QString> ProcessedArguments;
   QString     ErrorString;
   bool        Debug;
   int         FieldWidth;
@@ -297,6 +387,44 @@ CommandLineParserArgumentDescription*
   return 0;
 }
 
+// --------------------------------------------------------------------------
+CommandLineParserArgumentDescription*
+  ctkCommandLineParser::ctkInternal::parsedArgumentDescription(const QString& argument)
+{
+  this->updateArgumentTable();
+  return this->ArgumentTable.value(argument, 0);
+}
+
+// --------------------------------------------------------------------------
+void ctkCommandLineParser::ctkInternal::updateArgumentTable()
+{
+  if (!this->ArgumentTableModified)
+    {
+    return;
+    }
+  this->ArgumentTable.clear();
+  this->ArgumentTable.reserve(3 * this->ArgNameToArgumentDescriptionMap.size());
+  // argumentDescription() only strips a prefix, so any argument it resolves
+  // is one of these spellings
+  QHashIterator<QString, CommandLineParserArgumentDescription*> it(
+    this->ArgNameToArgumentDescriptionMap);
+  while (it.hasNext())
+    {
+    it.next();
+    QStringList spellings;
+    spellings << this->LongPrefix + it.key() << this->ShortPrefix + it.key() << it.key();
+    foreach (const QString& spelling, spellings)
+      {
+      CommandLineParserArgumentDescription* desc = this->argumentDescription(spelling);
+      if (desc)
+        {
+        this->ArgumentTable.insert(spelling, desc);
+        }
+      }
+    }
+  this->ArgumentTableModified = false;
+}
+
 // --------------------------------------------------------------------------
 // ctkCommandLineParser methods
 
@@ -335,13 +463,13 @@ QHash<QString, QVariant> ctkCommandLineParser::parseArguments(const QStringList&
       {
       desc->Value = desc->DefaultValue;
       }
+    desc->Parsed = false;
     }
 
   bool error = false;
   bool ignoreRest = false;
   bool useSettings = this->Internal->UseQSettings;
   CommandLineParserArgumentDescription * currentArgDesc = 0;
-  QList<CommandLineParserArgumentDescription*> parsedArgDescriptions;
   for(int i = 1; i < arguments.size(); ++i)
     {
     QString argument = arguments.at(i);
@@ -393,7 +521,7 @@ QHash<QString, QVariant> ctkCommandLineParser::parseArguments(const QStringList&
       }
 
     // Retrieve corresponding argument description
-    currentArgDesc = this->Internal->argumentDescription(argument);
+    currentArgDesc = this->Internal->parsedArgumentDescription(argument);
 
     // Is there a corresponding argument description ?
     if (currentArgDesc)
@@ -405,7 +533,7 @@ QHash<QString, QVariant> ctkCommandLineParser::parseArguments(const QStringList&
         }
       else
         {
-        parsedArgDescriptions.push_back(currentArgDesc);
+        currentArgDesc->Parsed = true;
         }
 
       // Is the argument the special "disable QSettings" argument?
@@ -415,7 +543,8 @@ QHash<QString, QVariant> ctkCommandLineParser::parseArguments(const QStringList&
         useSettings = false;
         }
 
-      this->Internal->ProcessedArguments << currentArgDesc->ShortArg << currentArgDesc->LongArg;
+      this->Internal->ProcessedArguments.insert(currentArgDesc->ShortArg);
+      this->Internal->ProcessedArguments.insert(currentArgDesc->LongArg);
       int numberOfParametersToProcess = currentArgDesc->NumberOfParametersToProcess;
       ignoreRest = currentArgDesc->IgnoreRest;
       if (this->Internal->Debug && ignoreRest)
@@ -430,14 +559,14 @@ QHash<QString, QVariant> ctkCommandLineParser::parseArguments(const QStringList&
         }
       else if (numberOfParametersToProcess > 0)
         {
-        QString missingParameterError =
+        const char* missingParameterError =
             "Argument %1 has %2 value(s) associated whereas exacly %3 are expected.";
         for(int j=1; j <= numberOfParametersToProcess; ++j)
           {
           if (i + j >= arguments.size())
             {
             this->Internal->ErrorString = 
-                missingParameterError.arg(argument).arg(j-1).arg(numberOfParametersToProcess);
+                QString(missingParameterError).arg(argument).arg(j-1).arg(numberOfParametersToProcess);
             if (this->Internal->Debug) { qDebug() << this->Internal->ErrorString; }
             if (ok) { *ok = false; }
             return QHash<QString, QVariant>();
@@ -450,7 +579,7 @@ QHash<QString, QVariant> ctkCommandLineParser::parseArguments(const QStringList&
           if (this->argumentAdded(parameter))
             {
             this->Internal->ErrorString =
-                missingParameterError.arg(argument).arg(j-1).arg(numberOfParametersToProcess);
+                QString(missingParameterError).arg(argument).arg(j-1).arg(numberOfParametersToProcess);
             if (this->Internal->Debug) { qDebug() << this->Internal->ErrorString; }
             if (ok) { *ok = false; }
             return QHash<QString, QVariant>();
@@ -543,21 +672,14 @@ QHash<QString, QVariant> ctkCommandLineParser::parseArguments(const QStringList&
     }
 
   QHash<QString, QVariant> parsedArguments;
+  parsedArguments.reserve(this->Internal->ArgumentDescriptionList.size());
   QListIterator<CommandLineParserArgumentDescription*> it(this->Internal->ArgumentDescriptionList);
   while (it.hasNext())
     {
-    QString key;
     CommandLineParserArgumentDescription* desc = it.next();
-    if (!desc->LongArg.isEmpty())
-      {
-      key = desc->LongArg;
-      }
-    else
-      {
-      key = desc->ShortArg;
-      }
+    const QString& key = desc->Key;
 
-    if (parsedArgDescriptions.contains(desc))
+    if (desc->Parsed)
       {
       // The argument was supplied on the command line, so use the given value
 
@@ -692,6 +814,7 @@ void ctkCommandLineParser::addArgument(const QString& longarg, const QString& sh
 
   this->Internal->ArgumentDescriptionList << argDesc;
   this->Internal->GroupToArgumentDescriptionListMap[this->Internal->CurrentGroup] << argDesc;
+  this->Internal->ArgumentTableModified = true;
 }
 
 // --------------------------------------------------------------------------
@@ -716,7 +839,7 @@ bool ctkCommandLineParser::setExactMatchRegularExpression(
     {
     return false;
     }
-  argDesc->RegularExpression = expression;
+  argDesc->setRegularExpression(expression);
   argDesc->ExactMatchFailedMessage = exactMatchFailedMessage;
   return true;
 }
@@ -834,6 +957,7 @@ void ctkCommandLineParser::setArgumentPrefix(const QString& longPrefix, const QS
 {
   this->Internal->LongPrefix = longPrefix;
   this->Internal->ShortPrefix = shortPrefix;
+  this->Internal->ArgumentTableModified = true;
 }
 
 // --------------------------------------------------------------------------
@@ -26,14 +26,22 @@
 #include <sstream>
 #include <algorithm>
 #include <vector>
-#include <set>
 #include <map>
 #include <list>
 #include <queue>
 #include <cassert>
 
-#define MAXV 100
-#define MAXDEGREE 2000
+//----------------------------------------------------------------------------
+// Vertex being traversed by ctkDependencyGraphPrivate::findPathsDFS, with the
+// path it extends, the path as it was when the vertex was reached, and the
+// index of its next successor.
+struct ctkDependencyGraphPathFrame
+{
+  int Vertex;
+  std::list<int>* Path;
+  std::list<int> Branch;
+  int NextChild;
+};
 
 //----------------------------------------------------------------------------
 class ctkDependencyGraphPrivate
@@ -49,7 +57,7 @@ public:
   /// Compute outdegree
   void computeOutdegrees(std::vector<int>& computedOutdegrees);
   
-  /// Traverse tree using Depth-first_search
+  /// Traverse tree using Depth-first_search, without recursion
   void traverseUsingDFS(int v);
   
   /// Called each time an edge is visited
@@ -61,16 +69,17 @@ public:
   /// Retrieve the path between two vertices
   void findPathDFS(int from, int to, std::list<int>& path);
 
-  /// Recursive function used by findPaths to retrieve the path between two vertices
-  void findPathsRec(int from, int to, std::list<int>* path, std::list<std::list<int>* >& paths);
+  /// Function used by findPaths to retrieve the paths between two vertices
+  void findPathsDFS(int from, int to, std::list<int>* path, std::list<std::list<int>* >& paths);
   
-  void setEdge(int vertice, int degree, int value);
+  /// Build the compressed sparse row representation from the inserted
+  /// edges if edges were inserted since it was last built.
+  void updateEdges();
   int edge(int vertice, int degree)const;
 
   void verticesWithIndegree(int indegree, std::list<int>& list);
 
   int subgraphSize(int rootId);
-  void subgraphSizeRec(int rootId, std::set<int>& uniqueVertices);
 
   void subgraphInsert(ctkDependencyGraph& subgraph, int rootId,
                       std::map<int,int>& subgraphIdToGlobal, std::map<int,int>& globalIdToSubgraph);
@@ -79,8 +88,16 @@ public:
                       std::map<int, int>& globalIdToSubgraph,
                       int globalId);
 
-  /// See http://en.wikipedia.org/wiki/Adjacency_list
-  std::vector<std::vector<int>* > Edges;
+  /// Edges in insertion order
+  std::vector<int> InsertedEdgesFrom;
+  std::vector<int> InsertedEdgesTo;
+  /// Compressed sparse row representation of the edges: the successors of
+  /// the vertex v are Edges[FirstEdge[v]] to Edges[FirstEdge[v+1] - 1], in
+  /// insertion order.
+  /// See http://en.wikipedia.org/wiki/Sparse_matrix
+  std::vector<int> FirstEdge;
+  std::vector<int> Edges;
+  bool EdgesModified;
   std::vector<int> OutDegree;
   std::vector<int> InDegree;
   int NVertices;
@@ -166,18 +183,11 @@ ctkDependencyGraphPrivate::ctkDependencyGraphPrivate(ctkDependencyGraph& object)
   this->CycleDetected = false;
   this->CycleOrigin = 0;
   this->CycleEnd = 0;
+  this->EdgesModified = false;
 }
 
 ctkDependencyGraphPrivate::~ctkDependencyGraphPrivate()
 {
-  std::vector<std::vector<int>* >::iterator edgesIterator;
-  for (edgesIterator = this->Edges.begin(); edgesIterator != this->Edges.end(); edgesIterator++)
-    {
-    if (*edgesIterator != NULL)
-      {
-      delete *edgesIterator;
-      }
-    }
 }
 
 //----------------------------------------------------------------------------
@@ -201,40 +211,51 @@ void ctkDependencyGraphPrivate::computeOutdegrees(std::vector<int>& computedOutd
 void ctkDependencyGraphPrivate::traverseUsingDFS(int v)
 {
   // allow for search termination
-	if (this->Abort)
-	  {
-	  return;
-	  }
+  if (this->Abort)
+    {
+    return;
+    }
 
-	this->Discovered[v] = true;
-	this->processVertex(v);
+  // Vertices being traversed with the index of their next successor
+  std::vector<std::pair<int, int> > stack;
 
-  int y; // successor vertex
-  for (int i=0; i<this->OutDegree[v]; i++)
-	  {
-		y = this->edge(v, i);
-		if (q_ptr->shouldExcludeEdge(this->edge(v, i)) == false)
-		  {
-      this->Parent[y] = v;
-			if (this->Discovered[y] == false)
-			  {
-				this->traverseUsingDFS(y);
-			  } 
-			else 
-			  {
-				if (this->Processed[y] == false)
-				  {
-					this->processEdge(v,y);
-					}
-			  }
-		  }
-		if (this->Abort)
-		  {
-		  return;
-		  }
-	}
+  this->Discovered[v] = true;
+  this->processVertex(v);
+  stack.push_back(std::make_pair(v, 0));
+
+  while (!stack.empty())
+    {
+    int x = stack.back().first;
+    int i = stack.back().second;
+    if (i >= this->OutDegree[x])
+      {
+      this->Processed[x] = true;
+      stack.pop_back();
+      continue;
+      }
+    ++stack.back().second;
 
-	this->Processed[v] = true;
+    int y = this->edge(x, i); // successor vertex
+    if (q_ptr->shouldExcludeEdge(y))
+      {
+      continue;
+      }
+    this->Parent[y] = x;
+    if (this->Discovered[y] == false)
+      {
+      this->Discovered[y] = true;
+      this->processVertex(y);
+      stack.push_back(std::make_pair(y, 0));
+      }
+    else if (this->Processed[y] == false)
+      {
+      this->processEdge(x, y);
+      if (this->Abort)
+        {
+        return;
+        }
+      }
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -269,66 +290,91 @@ void ctkDependencyGraphPrivate::processVertex(int v)
 }
 
 //----------------------------------------------------------------------------
-void ctkDependencyGraphPrivate::setEdge(int vertice, int degree, int value)
+void ctkDependencyGraphPrivate::updateEdges()
 {
-  assert(vertice <= this->NVertices);
-  assert(degree < MAXDEGREE);
-  (*this->Edges[vertice])[degree] = value; 
+  if (!this->EdgesModified)
+    {
+    return;
+    }
+  this->FirstEdge.assign(this->NVertices + 2, 0);
+  for (int v = 1; v <= this->NVertices; v++)
+    {
+    this->FirstEdge[v + 1] = this->FirstEdge[v] + this->OutDegree[v];
+    }
+  // Counting sort of the edges by origin, stable to keep the insertion order
+  std::vector<int> nextEdge(this->FirstEdge);
+  this->Edges.resize(this->NEdges);
+  for (int e = 0; e < this->NEdges; e++)
+    {
+    this->Edges[nextEdge[this->InsertedEdgesFrom[e]]++] = this->InsertedEdgesTo[e];
+    }
+  this->EdgesModified = false;
 }
 
 //----------------------------------------------------------------------------
 int ctkDependencyGraphPrivate::edge(int vertice, int degree)const
 {
   assert(vertice <= this->NVertices);
-  assert(degree < MAXDEGREE);
-  return (*this->Edges[vertice])[degree];
+  assert(degree < this->OutDegree[vertice]);
+  assert(!this->EdgesModified);
+  return this->Edges[this->FirstEdge[vertice] + degree];
 }
 
 //----------------------------------------------------------------------------
 void ctkDependencyGraphPrivate::findPathDFS(int from, int to, std::list<int>& path)
 {
-  if ((from == to) || (to == -1))
+  // Walk up the parents of 'to', the parents can't be more than NVertices
+  std::list<int> ancestors;
+  for (int depth = 0; to != from && to != -1 && depth <= this->NVertices; ++depth)
     {
-    path.push_back(from);
-    }
-  else 
-    {
-    this->findPathDFS(from, this->Parent[to], path);
-    path.push_back(to);
+    ancestors.push_front(to);
+    to = this->Parent[to];
     }
+  path.push_back(from);
+  path.splice(path.end(), ancestors);
 }
 
 //----------------------------------------------------------------------------
-void ctkDependencyGraphPrivate::findPathsRec(
+void ctkDependencyGraphPrivate::findPathsDFS(
   int from, int to, std::list<int>* path, std::list<std::list<int>* >& paths)
 {
-  if (from == to)
-    {
-    return;
-    }
-  
-  std::list<int> branch;
-  branch = *path;
+  // The path of the first successor of a vertex is extended, the path of the
+  // others is a new copy of the path as it was when the vertex was reached.
+  typedef ctkDependencyGraphPathFrame Frame;
+  std::list<Frame> stack;
 
-  int child = from;
-  for (int j=0; j < this->OutDegree[child]; j++)
+  Frame root;
+  root.Vertex = from;
+  root.Path = path;
+  root.Branch = *path;
+  root.NextChild = 0;
+  stack.push_back(root);
+
+  while (!stack.empty())
     {
-    if (j == 0)
+    Frame& frame = stack.back();
+    if (frame.Vertex == to || frame.NextChild >= this->OutDegree[frame.Vertex])
       {
-      int parent = this->edge(child, j);
-      (*path).push_back(parent);
-      this->findPathsRec(parent, to, path, paths);
+      stack.pop_back();
+      continue;
       }
-    else
+    int j = frame.NextChild++;
+    int parent = this->edge(frame.Vertex, j);
+    std::list<int>* parentPath = frame.Path;
+    if (j != 0)
       {
-      int parent = this->edge(child, j);
       // Copy path and add it to the list
-      std::list<int>* pathCopy = new std::list<int>();
-      *pathCopy = branch;
-      paths.push_back(pathCopy);
-      (*pathCopy).push_back(parent);
-      this->findPathsRec(parent, to, pathCopy, paths);
+      parentPath = new std::list<int>(frame.Branch);
+      paths.push_back(parentPath);
       }
+    parentPath->push_back(parent);
+
+    Frame child;
+    child.Vertex = parent;
+    child.Path = parentPath;
+    child.Branch = *parentPath;
+    child.NextChild = 0;
+    stack.push_back(child);
     }
 }
 
@@ -347,43 +393,67 @@ void ctkDependencyGraphPrivate::verticesWithIndegree(int indegree, std::list<int
 }
 
 //----------------------------------------------------------------------------
-void ctkDependencyGraphPrivate::subgraphSizeRec(int rootId, std::set<int>& uniqueVertices)
+int ctkDependencyGraphPrivate::subgraphSize(int rootId)
 {
   assert(rootId > 0);
 
-  for (int i = 0; i < this->OutDegree[rootId]; ++i)
+  std::vector<bool> reached(this->NVertices + 1, false);
+  std::vector<int> stack;
+  reached[rootId] = true;
+  stack.push_back(rootId);
+  int size = 1;
+  while (!stack.empty())
     {
-    int child = this->edge(rootId, i);
-    uniqueVertices.insert(child);
-    subgraphSizeRec(child, uniqueVertices);
+    int v = stack.back();
+    stack.pop_back();
+    for (int i = 0; i < this->OutDegree[v]; ++i)
+      {
+      int child = this->edge(v, i);
+      if (!reached[child])
+        {
+        reached[child] = true;
+        stack.push_back(child);
+        ++size;
+        }
+      }
     }
+  return size;
 }
 
 //----------------------------------------------------------------------------
-int ctkDependencyGraphPrivate::subgraphSize(int rootId)
-{
-  assert(rootId > 0);
-
-  std::set<int> vertices;
-  vertices.insert(rootId);
-  this->subgraphSizeRec(rootId, vertices);
-  return static_cast<int>(vertices.size());
-}
-
 void ctkDependencyGraphPrivate::subgraphInsert(
     ctkDependencyGraph& subgraph, int rootId,
     std::map<int,int>& subgraphIdToGlobal, std::map<int,int>& globalIdToSubgraph)
 {
-  int from = this->getOrGenerateSubgraphId(subgraphIdToGlobal, globalIdToSubgraph, rootId);
-  for (int i = 0; i < this->OutDegree[rootId]; ++i)
-  {
-    int childId = this->edge(rootId, i);
+  // Depth-first traversal inserting the edges of each reached vertex once
+  std::vector<bool> inserted(this->NVertices + 1, false);
+  std::vector<std::pair<int, int> > stack;
+  inserted[rootId] = true;
+  stack.push_back(std::make_pair(rootId, 0));
+  while (!stack.empty())
+    {
+    int v = stack.back().first;
+    int i = stack.back().second;
+    if (i >= this->OutDegree[v])
+      {
+      stack.pop_back();
+      continue;
+      }
+    ++stack.back().second;
+
+    int from = this->getOrGenerateSubgraphId(subgraphIdToGlobal, globalIdToSubgraph, v);
+    int childId = this->edge(v, i);
     int to = this->getOrGenerateSubgraphId(subgraphIdToGlobal, globalIdToSubgraph,
                                            childId);
-
     subgraph.insertEdge(from, to);
-    this->subgraphInsert(subgraph, childId, subgraphIdToGlobal, globalIdToSubgraph);
-  }
+    if (!inserted[childId])
+      {
+      inserted[childId] = true;
+      stack.push_back(std::make_pair(childId, 0));
+      }
+    }
+  // The root of a subgraph without edges still gets an id
+  this->getOrGenerateSubgraphId(subgraphIdToGlobal, globalIdToSubgraph, rootId);
 }
 
 //----------------------------------------------------------------------------
@@ -420,9 +490,9 @@ ctkDependencyGraph::ctkDependencyGraph(int nvertices)
   d_ptr->Processed.resize(nvertices + 1);
   d_ptr->Discovered.resize(nvertices + 1);
   d_ptr->Parent.resize(nvertices + 1);
-  d_ptr->Edges.resize(nvertices + 1);
   d_ptr->OutDegree.resize(nvertices + 1);
   d_ptr->InDegree.resize(nvertices + 1);
+  d_ptr->FirstEdge.resize(nvertices + 2);
 
   for (int i=1; i <= nvertices; i++)
     {
@@ -430,13 +500,6 @@ ctkDependencyGraph::ctkDependencyGraph(int nvertices)
     d_ptr->InDegree[i] = 0;
     }
     
-  // initialize Edge adjacency list
-  for (int i=0; i <= nvertices; i++)
-    {
-    d_ptr->Edges[i] = new std::vector<int>();
-    d_ptr->Edges[i]->resize(MAXDEGREE);
-    }
-    
   // initialize search
   for (int i=1; i <= nvertices; i++)
     {
@@ -485,6 +548,7 @@ void ctkDependencyGraph::printAdditionalInfo()const
 //----------------------------------------------------------------------------
 void ctkDependencyGraph::printGraph()const
 {
+  d_ptr->updateEdges();
   for(int i=1; i <= d_ptr->NVertices; i++)
     {
     std::cout << i << ":";
@@ -531,12 +595,10 @@ bool ctkDependencyGraph::checkForCycle()
 {
   if (d_ptr->NEdges > 0)
     {
-    // Store unprocessed vertex ids
-    std::list<int> uncheckedVertices;
-    for (int i = 1; i <= d_ptr->NVertices; ++i)
-      {
-        uncheckedVertices.push_back(i);
-      }
+    d_ptr->updateEdges();
+
+    // The vertices processed by a traversal are not traversed again: a cycle
+    // reachable from them would have been detected by that traversal.
 
     // Start the cycle detection on the source vertices
     std::list<int> sources;
@@ -544,40 +606,27 @@ bool ctkDependencyGraph::checkForCycle()
     std::list<int>::const_iterator sourcesIterator;
     for (sourcesIterator = sources.begin(); sourcesIterator != sources.end(); sourcesIterator++)
       {
-      d_ptr->traverseUsingDFS(*sourcesIterator);
-      if (this->cycleDetected()) return true;
-
-      for (unsigned int i=0; i < d_ptr->Processed.size(); i++)
+      if (d_ptr->Discovered[*sourcesIterator] == false)
         {
-          if (d_ptr->Processed[i] == true)
-            {
-            uncheckedVertices.remove(i);
-            }
-
-          d_ptr->Discovered[i] = false;
-          d_ptr->Processed[i] = false;
+        d_ptr->traverseUsingDFS(*sourcesIterator);
+        if (this->cycleDetected()) return true;
         }
       }
 
     // If a component does not have a source vertex,
     // i.e. it is a cycle a -> b -> a, check all non
-    // processed vertices.
-    while (!uncheckedVertices.empty())
+    // processed vertices, starting with the highest id.
+    for (int unchecked = d_ptr->NVertices; unchecked >= 1; --unchecked)
       {
-      d_ptr->traverseUsingDFS((*uncheckedVertices.rbegin()));
-      if (this->cycleDetected()) return true;
-
-      for (unsigned int i=0; i < d_ptr->Processed.size(); i++)
+      if (d_ptr->Discovered[unchecked] == false)
         {
-          if (d_ptr->Processed[i] == true)
-            {
-            uncheckedVertices.remove(i);
-            }
-
-          d_ptr->Discovered[i] = false;
-          d_ptr->Processed[i] = false;
+        d_ptr->traverseUsingDFS(unchecked);
+        if (this->cycleDetected()) return true;
         }
       }
+
+    std::fill(d_ptr->Discovered.begin(), d_ptr->Discovered.end(), false);
+    std::fill(d_ptr->Processed.begin(), d_ptr->Processed.end(), false);
     }
   return this->cycleDetected();
 }
@@ -606,14 +655,11 @@ void ctkDependencyGraph::insertEdge(int from, int to)
   assert(from > 0 && from <= d_ptr->NVertices);
   assert(to > 0 && to <= d_ptr->NVertices);
   
-  // resize if needed
-  size_t capacity = d_ptr->Edges[from]->capacity();
-  if (d_ptr->OutDegree[from] > static_cast<int>(capacity))
-    {
-    d_ptr->Edges[from]->resize(capacity + capacity * 0.3);
-    }
-
-  d_ptr->setEdge(from, d_ptr->OutDegree[from], to);
+  // The compressed sparse row representation is built when the graph is
+  // traversed next.
+  d_ptr->InsertedEdgesFrom.push_back(from);
+  d_ptr->InsertedEdgesTo.push_back(to);
+  d_ptr->EdgesModified = true;
   d_ptr->OutDegree[from]++;
   d_ptr->InDegree[to]++;
 
@@ -623,10 +669,12 @@ void ctkDependencyGraph::insertEdge(int from, int to)
 //----------------------------------------------------------------------------
 void ctkDependencyGraph::findPaths(int from, int to, std::list<std::list<int>* >& paths)
 {
+  d_ptr->updateEdges();
+
   std::list<int>* path = new std::list<int>;
   (*path).push_back(from);
   (paths).push_back(path);
-  d_ptr->findPathsRec(from, to, path, paths);
+  d_ptr->findPathsDFS(from, to, path, paths);
 
   // Remove lists not ending with the requested element
   std::list<std::list<int>* >::iterator pathsIterator;
@@ -639,6 +687,7 @@ void ctkDependencyGraph::findPaths(int from, int to, std::list<std::list<int>* >
 
     if (*(pathToCheck->rbegin()) != to)
       {
+      delete pathToCheck;
       pathsIterator = paths.erase(pathsIterator);
       }
     else
@@ -676,6 +725,8 @@ void ctkDependencyGraph::findPath(int from, int to, std::list<int>& path)
 //----------------------------------------------------------------------------
 bool ctkDependencyGraph::topologicalSort(std::list<int>& sorted, int rootId)
 {
+  d_ptr->updateEdges();
+
   if (rootId > 0)
     {
     ctkDependencyGraph subgraph(d_ptr->subgraphSize(rootId));
@@ -693,52 +744,44 @@ bool ctkDependencyGraph::topologicalSort(std::list<int>& sorted, int rootId)
     return result;
     }
 
-  std::vector<int> outdegree; // outdegree of each vertex
-  outdegree.resize(MAXV);
-  std::queue<int> zeroout;	  // vertices of outdegree 0
-	int x, y;			        // current and next vertex
-  
-  outdegree.resize(d_ptr->NVertices + 1);
-	
-	// resize if needed
-	if (d_ptr->NVertices > MAXV)
-	  {
-    outdegree.resize(d_ptr->NVertices);
-	  }
+  // Kahn's algorithm, O(V+E)
+  std::vector<int> outdegree(d_ptr->NVertices + 1); // outdegree of each vertex
+  std::queue<int> zeroout; // vertices of outdegree 0
+  int x, y;                // current and next vertex
 
-	d_ptr->computeOutdegrees(outdegree);
-	
-	for (int i=1; i <= d_ptr->NVertices; i++)
-	  {
+  d_ptr->computeOutdegrees(outdegree);
+
+  for (int i=1; i <= d_ptr->NVertices; i++)
+    {
     if (outdegree[i] == 0)
-		  {
+      {
       zeroout.push(i);
-		  }
-		}
+      }
+    }
 
-	int j=0;
+  int j=0;
   while (zeroout.empty() == false)
-	  {
-		j = j+1;
+    {
+    j = j+1;
     x = zeroout.front();
     zeroout.pop();
-		sorted.push_back(x);
+    sorted.push_back(x);
     for (int i=0; i < d_ptr->OutDegree[x]; i++)
-		  {
-			y = d_ptr->edge(x, i);
+      {
+      y = d_ptr->edge(x, i);
       outdegree[y] --;
       if (outdegree[y] == 0)
-			  {
+        {
         zeroout.push(y);
-			  }
-		  }
-	  }
+        }
+      }
+    }
+
+  if (j != d_ptr->NVertices)
+    {
+    return false;
+    }
 
-	if (j != d_ptr->NVertices)
-	  {
-		return false;
-		}
-		
   return true;
 }
 
@@ -35,6 +35,9 @@ class ctkDependencyGraphPrivate;
 /// \ingroup Core
 /// \class ctkDependencyGraph
 /// \brief Class to implement a dependency graph, converted to STL instead of Qt.
+/// The edges are stored in compressed sparse row form, built from the inserted
+/// edges the first time the graph is traversed after an insertion. None of
+/// the traversals are recursive.
 class CTK_CORE_EXPORT ctkDependencyGraph
 {
 public:
@@ -23,10 +23,56 @@
 // Qt includes
 #include <QHash>
 #include <QDateTime>
+#include <QMutex>
+#include <QThreadStorage>
 
 // CTK includes
 #include "ctkErrorLogContext.h"
 
+namespace
+{
+
+// --------------------------------------------------------------------------
+struct ctkErrorLogBufferedMessage
+{
+  QString                     ThreadId;
+  ctkErrorLogLevel::LogLevel  LogLevel;
+  QString                     Origin;
+  ctkErrorLogContext          Context;
+  QString                     Text;
+  int                         Count;
+};
+
+// --------------------------------------------------------------------------
+// Messages of one thread not yet handled. Only the flush competes with the
+// thread for the mutex.
+struct ctkErrorLogThreadBuffer
+{
+  ctkErrorLogThreadBuffer() : Finished(0) {}
+
+  QMutex                              Mutex;
+  QList<ctkErrorLogBufferedMessage>   Messages;
+  // Index of the message in Messages, by logLevel, origin, context and text
+  QHash<QString, int>                 MessageIndexes;
+  // Set when the thread finished
+  QAtomicInt                          Finished;
+};
+
+// --------------------------------------------------------------------------
+// Deleted by QThreadStorage when its thread finishes, the buffer is kept by
+// the handler up to the next flush
+struct ctkErrorLogThreadHandle
+{
+  ctkErrorLogThreadHandle(ctkErrorLogThreadBuffer* buffer) : Buffer(buffer) {}
+  ~ctkErrorLogThreadHandle()
+  {
+    this->Buffer->Finished.fetchAndStoreOrdered(1);
+  }
+  ctkErrorLogThreadBuffer* Buffer;
+};
+
+}
+
 // --------------------------------------------------------------------------
 // ctkErrorLogAbstractMessageHandlerPrivate
 
@@ -43,18 +89,49 @@ public:
   // Use "int" instead of "ctkErrorLogModel::TerminalOutput" to avoid compilation warning ...
   // qhash.h:879: warning: passing 'ctkErrorLogModel::TerminalOutput' chooses 'int' over 'uint' [-Wsign-promo]
   QHash<int, ctkErrorLogTerminalOutput*> TerminalOutputs;
+
+  ctkErrorLogThreadBuffer* currentThreadBuffer();
+
+  QThreadStorage<ctkErrorLogThreadHandle*> ThreadHandles;
+  QMutex                                  BuffersMutex;
+  QList<ctkErrorLogThreadBuffer*>          Buffers;
+  QAtomicInt                              FlushScheduled;
 };
 
 // --------------------------------------------------------------------------
 ctkErrorLogAbstractMessageHandlerPrivate::
 ctkErrorLogAbstractMessageHandlerPrivate()
-  : Enabled(false)
+  : Enabled(false), FlushScheduled(0)
 {
 }
 
 // --------------------------------------------------------------------------
 ctkErrorLogAbstractMessageHandlerPrivate::~ctkErrorLogAbstractMessageHandlerPrivate()
 {
+  // The handles of the other running threads are not deleted by
+  // QThreadStorage anymore once it is destroyed, they don't access the
+  // buffers.
+  if (this->ThreadHandles.hasLocalData())
+    {
+    this->ThreadHandles.setLocalData(0);
+    }
+  qDeleteAll(this->Buffers);
+}
+
+// --------------------------------------------------------------------------
+ctkErrorLogThreadBuffer* ctkErrorLogAbstractMessageHandlerPrivate::currentThreadBuffer()
+{
+  if (this->ThreadHandles.hasLocalData())
+    {
+    return this->ThreadHandles.localData()->Buffer;
+    }
+  ctkErrorLogThreadBuffer* buffer = new ctkErrorLogThreadBuffer;
+  {
+    QMutexLocker locker(&this->BuffersMutex);
+    this->Buffers << buffer;
+  }
+  this->ThreadHandles.setLocalData(new ctkErrorLogThreadHandle(buffer));
+  return buffer;
 }
 
 // --------------------------------------------------------------------------
@@ -155,3 +232,91 @@ void ctkErrorLogAbstractMessageHandler::setTerminalOutput(
   Q_D(ctkErrorLogAbstractMessageHandler);
   d->TerminalOutputs.insert(terminalOutputType, terminalOutput);
 }
+
+// --------------------------------------------------------------------------
+void ctkErrorLogAbstractMessageHandler::bufferMessage(const QString& threadId,
+                                                      ctkErrorLogLevel::LogLevel logLevel,
+                                                      const QString& origin,
+                                                      const ctkErrorLogContext& logContext,
+                                                      const QString &text)
+{
+  Q_D(ctkErrorLogAbstractMessageHandler);
+  ctkErrorLogThreadBuffer* buffer = d->currentThreadBuffer();
+  QString key = QString::number(logLevel) + '|' + origin + '|' + logContext.File + '|' +
+    QString::number(logContext.Line) + '|' + logContext.Category + '\n' + text;
+  {
+    QMutexLocker locker(&buffer->Mutex);
+    QHash<QString, int>::const_iterator it = buffer->MessageIndexes.constFind(key);
+    if (it != buffer->MessageIndexes.constEnd())
+      {
+      ++buffer->Messages[it.value()].Count;
+      }
+    else
+      {
+      ctkErrorLogBufferedMessage message;
+      message.ThreadId = threadId;
+      message.LogLevel = logLevel;
+      message.Origin = origin;
+      message.Context = logContext;
+      message.Text = text;
+      message.Count = 1;
+      buffer->MessageIndexes.insert(key, buffer->Messages.count());
+      buffer->Messages << message;
+      }
+  }
+  // A single event flushes the messages buffered until it is processed
+  if (d->FlushScheduled.testAndSetOrdered(0, 1))
+    {
+    QMetaObject::invokeMethod(this, "flushBufferedMessages", Qt::QueuedConnection);
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogAbstractMessageHandler::flushBufferedMessages()
+{
+  Q_D(ctkErrorLogAbstractMessageHandler);
+  // Messages buffered from now on are flushed by another call
+  d->FlushScheduled.fetchAndStoreOrdered(0);
+
+  QList<ctkErrorLogBufferedMessage> messages;
+  {
+    QMutexLocker locker(&d->BuffersMutex);
+    QList<ctkErrorLogThreadBuffer*>::iterator it = d->Buffers.begin();
+    while (it != d->Buffers.end())
+      {
+      ctkErrorLogThreadBuffer* buffer = *it;
+      // Finished before taking its messages, no message can be added anymore
+      bool finished = buffer->Finished.fetchAndAddOrdered(0) != 0;
+      {
+        QMutexLocker bufferLocker(&buffer->Mutex);
+        messages << buffer->Messages;
+        buffer->Messages.clear();
+        buffer->MessageIndexes.clear();
+      }
+      if (finished)
+        {
+        delete buffer;
+        it = d->Buffers.erase(it);
+        }
+      else
+        {
+        ++it;
+        }
+      }
+  }
+
+  foreach(const ctkErrorLogBufferedMessage& message, messages)
+    {
+    if (message.Count == 1)
+      {
+      this->handleMessage(message.ThreadId, message.LogLevel, message.Origin,
+                          message.Context, message.Text);
+      continue;
+      }
+    QString repeated = QString(" (repeated %1 times)").arg(message.Count);
+    ctkErrorLogContext context = message.Context;
+    context.Message.append(repeated);
+    this->handleMessage(message.ThreadId, message.LogLevel, message.Origin,
+                        context, message.Text + repeated);
+    }
+}
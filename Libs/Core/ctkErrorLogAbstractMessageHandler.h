@@ -56,10 +56,26 @@ public:
                      const QString& origin, const ctkErrorLogContext& logContext,
                      const QString &text);
 
+  /// Thread-safe variant of handleMessage() for handlers called by many
+  /// threads at a high rate (e.g. multi-threaded VTK or ITK filters).
+  /// The message is appended to a buffer of the calling thread, identical
+  /// messages being collapsed with their count, and is handled later in the
+  /// thread of the handler by flushBufferedMessages().
+  /// \sa handleMessage()
+  void bufferMessage(const QString& threadId, ctkErrorLogLevel::LogLevel logLevel,
+                     const QString& origin, const ctkErrorLogContext& logContext,
+                     const QString &text);
+
   ctkErrorLogTerminalOutput* terminalOutput(ctkErrorLogTerminalOutput::TerminalOutput terminalOutputType)const;
   void setTerminalOutput(ctkErrorLogTerminalOutput::TerminalOutput terminalOutputType,
                          ctkErrorLogTerminalOutput * terminalOutput);
 
+public Q_SLOTS:
+  /// Handle the messages buffered by all the threads, a message repeated
+  /// \a n times once with " (repeated n times)" appended to its text.
+  /// Called asynchronously after bufferMessage().
+  void flushBufferedMessages();
+
 Q_SIGNALS:
   void messageHandled(const QDateTime& currentDateTime, const QString& threadId,
                       ctkErrorLogLevel::LogLevel logLevel, const QString& origin,
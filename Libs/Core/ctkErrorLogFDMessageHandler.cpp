@@ -178,25 +178,21 @@ bool ctkFDHandler::enabled()const
 // --------------------------------------------------------------------------
 void ctkFDHandler::run()
 {
+  // Read the pipe in blocks instead of one character at a time, every complete
+  // line of a block is still reported as its own message.
+  QByteArray buffer(Self::ReadBufferSize, '\0');
+  QByteArray pending;
+  QString threadId = ctk::qtHandleToString(QThread::currentThreadId());
   while(true)
     {
-    char c = '\0';
-    QString line;
-    while(c != '\n')
-      {
 #ifdef Q_OS_WIN32
-      int res = _read(this->Pipe[0], &c, 1); // When used with pipe, read() is blocking
+    int res = _read(this->Pipe[0], buffer.data(), buffer.size()); // When used with pipe, read() is blocking
 #else
-      ssize_t res = read(this->Pipe[0], &c, 1); // When used with pipe, read() is blocking
+    ssize_t res = read(this->Pipe[0], buffer.data(), buffer.size()); // When used with pipe, read() is blocking
 #endif
-      if (res == -1)
-        {
-        break;
-        }
-      if (c != '\n')
-        {
-        line += c;
-        }
+    if (res <= 0)
+      {
+      break;
       }
 
     if (!this->enabled())
@@ -204,13 +200,24 @@ void ctkFDHandler::run()
       break;
       }
 
-    Q_ASSERT(this->MessageHandler);
-    this->MessageHandler->handleMessage(
-      ctk::qtHandleToString(QThread::currentThreadId()),
-      this->LogLevel,
-      this->MessageHandler->handlerPrettyName(),
-      ctkErrorLogContext(line),
-      line);
+    pending.append(buffer.constData(), static_cast<int>(res));
+
+    int start = 0;
+    int end = 0;
+    while((end = pending.indexOf('\n', start)) >= 0)
+      {
+      QString line = QString::fromLocal8Bit(pending.constData() + start, end - start);
+      start = end + 1;
+
+      Q_ASSERT(this->MessageHandler);
+      this->MessageHandler->handleMessage(
+        threadId,
+        this->LogLevel,
+        this->MessageHandler->handlerPrettyName(),
+        ctkErrorLogContext(line),
+        line);
+      }
+    pending.remove(0, start);
     }
 }
 
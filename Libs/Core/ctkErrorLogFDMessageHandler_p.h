@@ -46,6 +46,9 @@ class ctkFDHandler : public QThread
 public:
   typedef ctkFDHandler Self;
 
+  /// Maximum number of bytes read from the pipe at once.
+  enum { ReadBufferSize = 65536 };
+
   ctkFDHandler(ctkErrorLogFDMessageHandler* messageHandler,
                ctkErrorLogLevel::LogLevel logLevel,
                ctkErrorLogTerminalOutput::TerminalOutput terminalOutput);
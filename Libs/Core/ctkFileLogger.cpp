@@ -19,12 +19,20 @@
 =========================================================================*/
 
 // Qt includes
+#include <QCoreApplication>
 #include <QFile>
+#include <QMutex>
+#include <QStringList>
 #include <QTextStream>
+#include <QThread>
+#include <QWaitCondition>
 
 // CTK includes
 #include "ctkFileLogger.h"
 
+// --------------------------------------------------------------------------
+class ctkFileLoggerWriter;
+
 // --------------------------------------------------------------------------
 // ctkFileLoggerPrivate
 
@@ -40,22 +48,115 @@ public:
 
   void init();
 
+  void startWriter();
+  void stopWriter();
+
+  /// Rename filePath to filePath.1, filePath.1 to filePath.2 and so on.
+  static void rotate(const QString& filePath, int numberOfFilesToKeep);
+
   bool Enabled;
   QString FilePath;
   int NumberOfFilesToKeep;
+  qint64 MaximumFileSize;
+
+  // Asynchronous mode, the members below are protected by Mutex
+  QScopedPointer<ctkFileLoggerWriter> Writer;
+  QMutex Mutex;
+  QWaitCondition MessagesQueued;
+  QWaitCondition MessagesTaken;
+  QWaitCondition MessagesWritten;
+  QStringList PendingMessages;
+  int MaximumPendingMessages;
+  qint64 QueuedCount;
+  qint64 WrittenCount;
+  bool Stopping;
+};
+
+// --------------------------------------------------------------------------
+// ctkFileLoggerWriter
+
+// --------------------------------------------------------------------------
+class ctkFileLoggerWriter : public QThread
+{
+public:
+  ctkFileLoggerWriter(ctkFileLoggerPrivate* d) : d(d) {}
+
+protected:
+  virtual void run();
+
+  ctkFileLoggerPrivate* d;
 };
 
+// --------------------------------------------------------------------------
+void ctkFileLoggerWriter::run()
+{
+  QFile file;
+  QMutexLocker lock(&d->Mutex);
+  while (true)
+    {
+    while (d->PendingMessages.isEmpty() && !d->Stopping)
+      {
+      d->MessagesQueued.wait(&d->Mutex);
+      }
+    if (d->PendingMessages.isEmpty())
+      {
+      break;
+      }
+    QStringList messages = d->PendingMessages;
+    d->PendingMessages.clear();
+    QString filePath = d->FilePath;
+    qint64 maximumFileSize = d->MaximumFileSize;
+    int numberOfFilesToKeep = d->NumberOfFilesToKeep;
+    d->MessagesTaken.wakeAll();
+    lock.unlock();
+
+    if (file.fileName() != filePath)
+      {
+      file.close();
+      file.setFileName(filePath);
+      }
+    if (file.isOpen() || file.open(QFile::Append))
+      {
+      QTextStream s(&file);
+      foreach(const QString& msg, messages)
+        {
+        s << msg << '\n';
+        }
+      s.flush();
+      file.flush();
+      if (maximumFileSize > 0 && file.size() >= maximumFileSize)
+        {
+        file.close();
+        ctkFileLoggerPrivate::rotate(filePath, numberOfFilesToKeep);
+        }
+      }
+
+    lock.relock();
+    d->WrittenCount += messages.size();
+    d->MessagesWritten.wakeAll();
+    }
+}
+
+// --------------------------------------------------------------------------
+// ctkFileLoggerPrivate methods
+
 // --------------------------------------------------------------------------
 ctkFileLoggerPrivate::ctkFileLoggerPrivate(ctkFileLogger& object)
   : q_ptr(&object)
 {
   this->Enabled = true;
   this->NumberOfFilesToKeep = 10;
+  this->MaximumFileSize = 0;
+  this->MaximumPendingMessages = 4096;
+  this->QueuedCount = 0;
+  this->WrittenCount = 0;
+  this->Stopping = false;
 }
 
 // --------------------------------------------------------------------------
 ctkFileLoggerPrivate::~ctkFileLoggerPrivate()
 {
+  this->stopWriter();
 }
 
 // --------------------------------------------------------------------------
@@ -63,6 +164,65 @@ void ctkFileLoggerPrivate::init()
 {
 }
 
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::startWriter()
+{
+  Q_Q(ctkFileLogger);
+  if (this->Writer)
+    {
+    return;
+    }
+  this->Stopping = false;
+  this->Writer.reset(new ctkFileLoggerWriter(this));
+  this->Writer->start(QThread::LowPriority);
+  if (QCoreApplication::instance())
+    {
+    QObject::connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), q, SLOT(flush()));
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::stopWriter()
+{
+  Q_Q(ctkFileLogger);
+  if (!this->Writer)
+    {
+    return;
+    }
+  {
+    // the queued messages are written before the thread finishes
+    QMutexLocker lock(&this->Mutex);
+    this->Stopping = true;
+    this->MessagesQueued.wakeAll();
+  }
+  this->Writer->wait();
+  this->Writer.reset();
+  if (QCoreApplication::instance())
+    {
+    QObject::disconnect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), q, SLOT(flush()));
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::rotate(const QString& filePath, int numberOfFilesToKeep)
+{
+  if (numberOfFilesToKeep <= 1)
+    {
+    QFile::remove(filePath);
+    return;
+    }
+  QFile::remove(QString("%1.%2").arg(filePath).arg(numberOfFilesToKeep - 1));
+  for (int i = numberOfFilesToKeep - 2; i >= 1; --i)
+    {
+    QString source = QString("%1.%2").arg(filePath).arg(i);
+    if (QFile::exists(source))
+      {
+      QFile::rename(source, QString("%1.%2").arg(filePath).arg(i + 1));
+      }
+    }
+  QFile::rename(filePath, filePath + ".1");
+}
+
 // --------------------------------------------------------------------------
 // ctkFileLogger
 
@@ -78,6 +238,8 @@ ctkFileLogger::ctkFileLogger(QObject* parentObject)
 // --------------------------------------------------------------------------
 ctkFileLogger::~ctkFileLogger()
 {
+  Q_D(ctkFileLogger);
+  d->stopWriter();
 }
 
 // --------------------------------------------------------------------------
@@ -105,6 +267,9 @@ QString ctkFileLogger::filePath()const
 void ctkFileLogger::setFilePath(const QString& filePath)
 {
   Q_D(ctkFileLogger);
+  // the messages already logged go to the previous file
+  this->flush();
+  QMutexLocker lock(&d->Mutex);
   d->FilePath = filePath;
 }
 
@@ -119,9 +284,62 @@ int ctkFileLogger::numberOfFilesToKeep()const
 void ctkFileLogger::setNumberOfFilesToKeep(int value)
 {
   Q_D(ctkFileLogger);
+  QMutexLocker lock(&d->Mutex);
   d->NumberOfFilesToKeep = value;
 }
 
+// --------------------------------------------------------------------------
+qint64 ctkFileLogger::maximumFileSize()const
+{
+  Q_D(const ctkFileLogger);
+  return d->MaximumFileSize;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setMaximumFileSize(qint64 value)
+{
+  Q_D(ctkFileLogger);
+  QMutexLocker lock(&d->Mutex);
+  d->MaximumFileSize = value;
+}
+
+// --------------------------------------------------------------------------
+bool ctkFileLogger::asynchronous()const
+{
+  Q_D(const ctkFileLogger);
+  return !d->Writer.isNull();
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setAsynchronous(bool value)
+{
+  Q_D(ctkFileLogger);
+  if (value)
+    {
+    d->startWriter();
+    }
+  else
+    {
+    d->stopWriter();
+    }
+}
+
+// --------------------------------------------------------------------------
+int ctkFileLogger::maximumPendingMessages()const
+{
+  Q_D(const ctkFileLogger);
+  return d->MaximumPendingMessages;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setMaximumPendingMessages(int value)
+{
+  Q_D(ctkFileLogger);
+  QMutexLocker lock(&d->Mutex);
+  d->MaximumPendingMessages = qMax(1, value);
+  d->MessagesTaken.wakeAll();
+}
+
 // --------------------------------------------------------------------------
 void ctkFileLogger::logMessage(const QString& msg)
 {
@@ -130,6 +348,23 @@ void ctkFileLogger::logMessage(const QString& msg)
     {
     return;
     }
+
+  if (d->Writer)
+    {
+    QMutexLocker lock(&d->Mutex);
+    while (d->PendingMessages.size() >= d->MaximumPendingMessages)
+      {
+      d->MessagesTaken.wait(&d->Mutex);
+      }
+    d->PendingMessages.append(msg);
+    ++d->QueuedCount;
+    if (d->PendingMessages.size() == 1)
+      {
+      d->MessagesQueued.wakeOne();
+      }
+    return;
+    }
+
   QFile f(d->FilePath);
   if (!f.open(QFile::Append))
     {
@@ -138,5 +373,24 @@ void ctkFileLogger::logMessage(const QString& msg)
   QTextStream s(&f);
   s << msg << endl;
   f.close();
+  if (d->MaximumFileSize > 0 && f.size() >= d->MaximumFileSize)
+    {
+    ctkFileLoggerPrivate::rotate(d->FilePath, d->NumberOfFilesToKeep);
+    }
 }
 
+// --------------------------------------------------------------------------
+void ctkFileLogger::flush()
+{
+  Q_D(ctkFileLogger);
+  if (!d->Writer)
+    {
+    return;
+    }
+  QMutexLocker lock(&d->Mutex);
+  qint64 queuedCount = d->QueuedCount;
+  while (d->WrittenCount < queuedCount)
+    {
+    d->MessagesWritten.wait(&d->Mutex);
+    }
+}
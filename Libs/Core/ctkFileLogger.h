@@ -32,11 +32,25 @@ class ctkFileLoggerPrivate;
 
 //------------------------------------------------------------------------------
 /// \ingroup Core
+/// Append the messages to a file.
+///
+/// By default each message is written by the calling thread, the file being opened
+/// and closed for each of them. In asynchronous mode, the messages are queued and
+/// written in blocks by a background thread which keeps the file open; flush() waits
+/// until the queued messages are written. It is called when the logger is destroyed
+/// and when the application is about to quit.
+///
+/// When maximumFileSize is set, the file is rotated once it reaches that size: it is
+/// renamed to filePath.1, the previous filePath.1 to filePath.2 and so on, keeping
+/// at most numberOfFilesToKeep files including the current one.
 class CTK_CORE_EXPORT ctkFileLogger : public QObject
 {
   Q_OBJECT
   Q_PROPERTY(bool enabled READ enabled WRITE setEnabled)
   Q_PROPERTY(QString filePath READ filePath WRITE setFilePath)
+  Q_PROPERTY(int numberOfFilesToKeep READ numberOfFilesToKeep WRITE setNumberOfFilesToKeep)
+  Q_PROPERTY(qint64 maximumFileSize READ maximumFileSize WRITE setMaximumFileSize)
+  Q_PROPERTY(bool asynchronous READ asynchronous WRITE setAsynchronous)
 
 public:
   typedef QObject Superclass;
@@ -53,9 +67,24 @@ public:
   int numberOfFilesToKeep()const;
   void setNumberOfFilesToKeep(int value);
 
+  /// Size in bytes from which the file is rotated, 0 (the default) to never rotate it.
+  qint64 maximumFileSize()const;
+  void setMaximumFileSize(qint64 value);
+
+  bool asynchronous()const;
+  void setAsynchronous(bool value);
+
+  /// Number of messages queued in asynchronous mode above which logMessage()
+  /// waits for the background thread, 4096 by default.
+  int maximumPendingMessages()const;
+  void setMaximumPendingMessages(int value);
+
 public Q_SLOTS:
   void logMessage(const QString& msg);
 
+  /// Wait until the messages queued in asynchronous mode are written.
+  void flush();
+
 protected:
   QScopedPointer<ctkFileLoggerPrivate> d_ptr;
 
@@ -0,0 +1,529 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QFile>
+#include <QSet>
+
+// CTK includes
+#include "ctkLibrarySymbolTable.h"
+#include "ctkPimpl.h"
+
+namespace
+{
+
+// --------------------------------------------------------------------------
+/// Bounds checked reads of little or big endian values in a mapped file.
+class ctkBinaryReader
+{
+public:
+  ctkBinaryReader(const uchar* data, qint64 size, bool bigEndian)
+    : Data(data), Size(size), BigEndian(bigEndian)
+  {
+  }
+
+  bool contains(quint64 offset, quint64 size)const
+  {
+    return offset <= static_cast<quint64>(this->Size) &&
+      size <= static_cast<quint64>(this->Size) - offset;
+  }
+
+  quint64 read(quint64 offset, int bytes)const
+  {
+    if (!this->contains(offset, bytes))
+      {
+      return 0;
+      }
+    quint64 value = 0;
+    for (int i = 0; i < bytes; ++i)
+      {
+      int byte = this->BigEndian ? i : bytes - 1 - i;
+      value = (value << 8) | this->Data[offset + byte];
+      }
+    return value;
+  }
+
+  quint8 u8(quint64 offset)const { return static_cast<quint8>(this->read(offset, 1)); }
+  quint16 u16(quint64 offset)const { return static_cast<quint16>(this->read(offset, 2)); }
+  quint32 u32(quint64 offset)const { return static_cast<quint32>(this->read(offset, 4)); }
+  quint64 u64(quint64 offset)const { return this->read(offset, 8); }
+
+  /// Null terminated string at \a offset, not past \a end.
+  QByteArray string(quint64 offset, quint64 end)const
+  {
+    end = qMin(end, static_cast<quint64>(this->Size));
+    if (offset >= end)
+      {
+      return QByteArray();
+      }
+    const char* begin = reinterpret_cast<const char*>(this->Data + offset);
+    quint64 length = 0;
+    while (offset + length < end && begin[length] != '\0')
+      {
+      ++length;
+      }
+    return QByteArray(begin, static_cast<int>(length));
+  }
+
+  const uchar* Data;
+  qint64 Size;
+  bool BigEndian;
+};
+
+// ELF constants
+const quint32 ELF_SHT_DYNSYM = 11;
+const quint8 ELF_STB_GLOBAL = 1;
+const quint8 ELF_STB_WEAK = 2;
+const quint8 ELF_STB_GNU_UNIQUE = 10;
+const quint8 ELF_STV_HIDDEN = 2;
+const quint8 ELF_STV_INTERNAL = 1;
+
+// Mach-O constants
+const quint32 MACHO_MAGIC = 0xfeedface;
+const quint32 MACHO_MAGIC_64 = 0xfeedfacf;
+const quint32 MACHO_CIGAM = 0xcefaedfe;
+const quint32 MACHO_CIGAM_64 = 0xcffaedfe;
+const quint32 MACHO_FAT_MAGIC = 0xcafebabe;
+const quint32 MACHO_LC_SYMTAB = 0x2;
+const quint8 MACHO_N_STAB = 0xe0;
+const quint8 MACHO_N_PEXT = 0x10;
+const quint8 MACHO_N_TYPE = 0x0e;
+const quint8 MACHO_N_EXT = 0x01;
+
+// Mach-O cpu type of this process, to pick the slice of universal binaries.
+#if defined(__x86_64__)
+const quint32 MACHO_HOST_CPU_TYPE = 0x01000007;
+#elif defined(__i386__)
+const quint32 MACHO_HOST_CPU_TYPE = 0x7;
+#elif defined(__arm64__) || defined(__aarch64__)
+const quint32 MACHO_HOST_CPU_TYPE = 0x0100000c;
+#elif defined(__arm__)
+const quint32 MACHO_HOST_CPU_TYPE = 0xc;
+#elif defined(__ppc64__)
+const quint32 MACHO_HOST_CPU_TYPE = 0x01000012;
+#elif defined(__ppc__)
+const quint32 MACHO_HOST_CPU_TYPE = 0x12;
+#else
+const quint32 MACHO_HOST_CPU_TYPE = 0;
+#endif
+
+// PE constants
+const quint16 PE_MAGIC_32 = 0x10b;
+const quint16 PE_MAGIC_64 = 0x20b;
+
+// --------------------------------------------------------------------------
+/// Convert a relative virtual address of a PE file into a file offset,
+/// return 0 if the address isn't in any of the sections.
+quint64 peRVAToOffset(const ctkBinaryReader& reader, quint64 sections,
+                      quint16 sectionCount, quint32 rva)
+{
+  for (quint16 i = 0; i < sectionCount; ++i)
+    {
+    quint64 section = sections + static_cast<quint64>(i) * 40;
+    quint32 virtualSize = reader.u32(section + 8);
+    quint32 virtualAddress = reader.u32(section + 12);
+    quint32 rawSize = reader.u32(section + 16);
+    quint32 rawOffset = reader.u32(section + 20);
+    if (rva >= virtualAddress && rva - virtualAddress < qMax(virtualSize, rawSize))
+      {
+      return static_cast<quint64>(rva - virtualAddress) + rawOffset;
+      }
+    }
+  return 0;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+class ctkLibrarySymbolTablePrivate
+{
+public:
+  ctkLibrarySymbolTablePrivate();
+
+  bool parse(const uchar* data, qint64 size);
+  bool parseElf(const uchar* data, qint64 size);
+  bool parseMachO(const uchar* data, qint64 size);
+  bool parseMachOFat(const uchar* data, qint64 size);
+  bool parsePE(const uchar* data, qint64 size);
+
+  QString FileName;
+  QSet<QByteArray> Symbols;
+  bool Loaded;
+};
+
+// --------------------------------------------------------------------------
+// ctkLibrarySymbolTablePrivate methods
+
+// --------------------------------------------------------------------------
+ctkLibrarySymbolTablePrivate::ctkLibrarySymbolTablePrivate()
+{
+  this->Loaded = false;
+}
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTablePrivate::parse(const uchar* data, qint64 size)
+{
+  if (size < 4)
+    {
+    return false;
+    }
+  if (data[0] == 0x7f && data[1] == 'E' && data[2] == 'L' && data[3] == 'F')
+    {
+    return this->parseElf(data, size);
+    }
+  if (data[0] == 'M' && data[1] == 'Z')
+    {
+    return this->parsePE(data, size);
+    }
+  quint32 magic = ctkBinaryReader(data, size, true).u32(0);
+  if (magic == MACHO_FAT_MAGIC)
+    {
+    return this->parseMachOFat(data, size);
+    }
+  if (magic == MACHO_MAGIC || magic == MACHO_MAGIC_64 ||
+      magic == MACHO_CIGAM || magic == MACHO_CIGAM_64)
+    {
+    return this->parseMachO(data, size);
+    }
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTablePrivate::parseElf(const uchar* data, qint64 size)
+{
+  if (size < 0x34)
+    {
+    return false;
+    }
+  bool is64 = (data[4] == 2);
+  if (!is64 && data[4] != 1)
+    {
+    return false;
+    }
+  ctkBinaryReader reader(data, size, data[5] == 2);
+
+  quint64 sectionHeadersOffset = is64 ? reader.u64(0x28) : reader.u32(0x20);
+  quint16 sectionHeaderSize = reader.u16(is64 ? 0x3a : 0x2e);
+  quint16 sectionCount = reader.u16(is64 ? 0x3c : 0x30);
+  if (sectionHeadersOffset == 0 || sectionHeaderSize < (is64 ? 0x40 : 0x28) ||
+      !reader.contains(sectionHeadersOffset,
+                       static_cast<quint64>(sectionHeaderSize) * sectionCount))
+    {
+    return false;
+    }
+
+  for (quint16 section = 0; section < sectionCount; ++section)
+    {
+    quint64 header = sectionHeadersOffset + static_cast<quint64>(section) * sectionHeaderSize;
+    if (reader.u32(header + 4) != ELF_SHT_DYNSYM)
+      {
+      continue;
+      }
+    quint64 symbolsOffset = is64 ? reader.u64(header + 0x18) : reader.u32(header + 0x10);
+    quint64 symbolsSize = is64 ? reader.u64(header + 0x20) : reader.u32(header + 0x14);
+    quint32 stringSection = reader.u32(header + (is64 ? 0x28 : 0x18));
+    quint64 symbolSize = is64 ? reader.u64(header + 0x38) : reader.u32(header + 0x24);
+    if (stringSection >= sectionCount || symbolSize < (is64 ? 24u : 16u) ||
+        !reader.contains(symbolsOffset, symbolsSize))
+      {
+      return false;
+      }
+    quint64 stringHeader = sectionHeadersOffset +
+      static_cast<quint64>(stringSection) * sectionHeaderSize;
+    quint64 stringsOffset = is64 ? reader.u64(stringHeader + 0x18) : reader.u32(stringHeader + 0x10);
+    quint64 stringsSize = is64 ? reader.u64(stringHeader + 0x20) : reader.u32(stringHeader + 0x14);
+    if (!reader.contains(stringsOffset, stringsSize))
+      {
+      return false;
+      }
+
+    for (quint64 symbol = symbolsOffset; symbol + symbolSize <= symbolsOffset + symbolsSize;
+         symbol += symbolSize)
+      {
+      quint32 name = reader.u32(symbol);
+      quint8 info = reader.u8(symbol + (is64 ? 4 : 12));
+      quint8 other = reader.u8(symbol + (is64 ? 5 : 13));
+      quint16 sectionIndex = reader.u16(symbol + (is64 ? 6 : 14));
+      quint8 binding = info >> 4;
+      quint8 visibility = other & 0x3;
+      // Only the defined and visible global symbols can be resolved
+      if (name == 0 || sectionIndex == 0 ||
+          (binding != ELF_STB_GLOBAL && binding != ELF_STB_WEAK &&
+           binding != ELF_STB_GNU_UNIQUE) ||
+          visibility == ELF_STV_HIDDEN || visibility == ELF_STV_INTERNAL)
+        {
+        continue;
+        }
+      this->Symbols.insert(reader.string(stringsOffset + name, stringsOffset + stringsSize));
+      }
+    return true;
+    }
+  // No dynamic symbol table
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTablePrivate::parseMachOFat(const uchar* data, qint64 size)
+{
+  // The fat header is always big endian
+  ctkBinaryReader reader(data, size, true);
+  quint32 archCount = reader.u32(4);
+  if (archCount == 0 || !reader.contains(8, static_cast<quint64>(archCount) * 20))
+    {
+    return false;
+    }
+  quint32 chosenArch = 0;
+  for (quint32 arch = 0; arch < archCount; ++arch)
+    {
+    if (reader.u32(8 + arch * 20) == MACHO_HOST_CPU_TYPE)
+      {
+      chosenArch = arch;
+      break;
+      }
+    }
+  quint32 offset = reader.u32(8 + chosenArch * 20 + 8);
+  quint32 sliceSize = reader.u32(8 + chosenArch * 20 + 12);
+  if (!reader.contains(offset, sliceSize))
+    {
+    return false;
+    }
+  return this->parseMachO(data + offset, sliceSize);
+}
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTablePrivate::parseMachO(const uchar* data, qint64 size)
+{
+  quint32 magic = ctkBinaryReader(data, size, false).u32(0);
+  bool is64 = (magic == MACHO_MAGIC_64 || magic == MACHO_CIGAM_64);
+  bool bigEndian = (magic == MACHO_CIGAM || magic == MACHO_CIGAM_64);
+  if (!is64 && magic != MACHO_MAGIC && magic != MACHO_CIGAM)
+    {
+    return false;
+    }
+  ctkBinaryReader reader(data, size, bigEndian);
+
+  quint32 commandCount = reader.u32(16);
+  quint64 command = is64 ? 32 : 28;
+  for (quint32 i = 0; i < commandCount; ++i)
+    {
+    quint32 commandType = reader.u32(command);
+    quint32 commandSize = reader.u32(command + 4);
+    if (commandSize < 8 || !reader.contains(command, commandSize))
+      {
+      return false;
+      }
+    if (commandType == MACHO_LC_SYMTAB)
+      {
+      quint32 symbolsOffset = reader.u32(command + 8);
+      quint32 symbolCount = reader.u32(command + 12);
+      quint32 stringsOffset = reader.u32(command + 16);
+      quint32 stringsSize = reader.u32(command + 20);
+      quint64 symbolSize = is64 ? 16 : 12;
+      if (!reader.contains(symbolsOffset, symbolCount * symbolSize) ||
+          !reader.contains(stringsOffset, stringsSize))
+        {
+        return false;
+        }
+      for (quint32 s = 0; s < symbolCount; ++s)
+        {
+        quint64 symbol = symbolsOffset + s * symbolSize;
+        quint32 name = reader.u32(symbol);
+        quint8 type = reader.u8(symbol + 4);
+        // Only the defined external symbols can be resolved
+        if (name == 0 || (type & MACHO_N_STAB) || (type & MACHO_N_PEXT) ||
+            !(type & MACHO_N_EXT) || (type & MACHO_N_TYPE) == 0)
+          {
+          continue;
+          }
+        QByteArray symbolName =
+          reader.string(static_cast<quint64>(stringsOffset) + name,
+                        static_cast<quint64>(stringsOffset) + stringsSize);
+        if (symbolName.startsWith('_'))
+          {
+          symbolName.remove(0, 1);
+          }
+        this->Symbols.insert(symbolName);
+        }
+      return true;
+      }
+    command += commandSize;
+    }
+  // No symbol table
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTablePrivate::parsePE(const uchar* data, qint64 size)
+{
+  ctkBinaryReader reader(data, size, false);
+  quint64 pe = reader.u32(0x3c);
+  if (!reader.contains(pe, 24) ||
+      data[pe] != 'P' || data[pe + 1] != 'E' || data[pe + 2] != 0 || data[pe + 3] != 0)
+    {
+    return false;
+    }
+  quint16 sectionCount = reader.u16(pe + 6);
+  quint16 optionalHeaderSize = reader.u16(pe + 20);
+  quint64 optionalHeader = pe + 24;
+  quint16 magic = reader.u16(optionalHeader);
+  if (magic != PE_MAGIC_32 && magic != PE_MAGIC_64)
+    {
+    return false;
+    }
+  bool is64 = (magic == PE_MAGIC_64);
+  quint32 directoryCount = reader.u32(optionalHeader + (is64 ? 108 : 92));
+  quint64 directories = optionalHeader + (is64 ? 112 : 96);
+  quint64 sections = optionalHeader + optionalHeaderSize;
+  if (!reader.contains(sections, static_cast<quint64>(sectionCount) * 40))
+    {
+    return false;
+    }
+  if (directoryCount == 0)
+    {
+    // No export table, nothing is exported
+    return true;
+    }
+  quint32 exportRVA = reader.u32(directories);
+  if (exportRVA == 0)
+    {
+    return true;
+    }
+
+  quint64 exportDirectory = peRVAToOffset(reader, sections, sectionCount, exportRVA);
+  if (exportDirectory == 0 || !reader.contains(exportDirectory, 40))
+    {
+    return false;
+    }
+  quint32 nameCount = reader.u32(exportDirectory + 24);
+  quint64 names = peRVAToOffset(reader, sections, sectionCount,
+                                       reader.u32(exportDirectory + 32));
+  if (nameCount > 0 && (names == 0 || !reader.contains(names, static_cast<quint64>(nameCount) * 4)))
+    {
+    return false;
+    }
+  for (quint32 i = 0; i < nameCount; ++i)
+    {
+    quint64 name = peRVAToOffset(reader, sections, sectionCount, reader.u32(names + i * 4));
+    if (name != 0)
+      {
+      this->Symbols.insert(reader.string(name, size));
+      }
+    }
+  return true;
+}
+
+// --------------------------------------------------------------------------
+// ctkLibrarySymbolTable methods
+
+// --------------------------------------------------------------------------
+ctkLibrarySymbolTable::ctkLibrarySymbolTable()
+  : d_ptr(new ctkLibrarySymbolTablePrivate)
+{
+}
+
+// --------------------------------------------------------------------------
+ctkLibrarySymbolTable::ctkLibrarySymbolTable(const QString& fileName)
+  : d_ptr(new ctkLibrarySymbolTablePrivate)
+{
+  Q_D(ctkLibrarySymbolTable);
+  d->FileName = fileName;
+}
+
+// --------------------------------------------------------------------------
+ctkLibrarySymbolTable::~ctkLibrarySymbolTable()
+{
+}
+
+// --------------------------------------------------------------------------
+CTK_GET_CPP(ctkLibrarySymbolTable, QString, fileName, FileName);
+CTK_SET_CPP(ctkLibrarySymbolTable, const QString&, setFileName, FileName);
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTable::isLoaded() const
+{
+  Q_D(const ctkLibrarySymbolTable);
+  return d->Loaded;
+}
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTable::load()
+{
+  Q_D(ctkLibrarySymbolTable);
+  this->unload();
+
+  QFile file(d->FileName);
+  if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+    {
+    return false;
+    }
+  const uchar* data = file.map(0, file.size());
+  if (!data)
+    {
+    return false;
+    }
+  d->Loaded = d->parse(data, file.size());
+  file.unmap(const_cast<uchar*>(data));
+  if (!d->Loaded)
+    {
+    d->Symbols.clear();
+    }
+  return d->Loaded;
+}
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTable::unload()
+{
+  Q_D(ctkLibrarySymbolTable);
+  d->Symbols.clear();
+  d->Loaded = false;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTable::contains(const QString& symbol)const
+{
+  Q_D(const ctkLibrarySymbolTable);
+  return d->Symbols.contains(symbol.toLatin1());
+}
+
+// --------------------------------------------------------------------------
+bool ctkLibrarySymbolTable::containsAll(const QStringList& symbols)const
+{
+  foreach(const QString& symbol, symbols)
+    {
+    if (!this->contains(symbol))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+// --------------------------------------------------------------------------
+QStringList ctkLibrarySymbolTable::symbols()const
+{
+  Q_D(const ctkLibrarySymbolTable);
+  QStringList symbols;
+  foreach(const QByteArray& symbol, d->Symbols)
+    {
+    symbols << QString::fromLatin1(symbol);
+    }
+  return symbols;
+}
@@ -0,0 +1,78 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkLibrarySymbolTable_h
+#define __ctkLibrarySymbolTable_h
+
+// Qt includes
+#include <QScopedPointer>
+#include <QString>
+#include <QStringList>
+
+#include "ctkCoreExport.h"
+
+class ctkLibrarySymbolTablePrivate;
+
+/// \ingroup Core
+/// Reads the symbols exported by a shared library without loading it.
+/// The file is memory-mapped and its dynamic symbol table (ELF), symbol
+/// table (Mach-O, including universal binaries) or export table (PE) is
+/// read directly. Neither the library initializers nor its dependencies
+/// are run or loaded. Unlike ctkBinaryFileDescriptor, it doesn't need BFD.
+class CTK_CORE_EXPORT ctkLibrarySymbolTable
+{
+public:
+  ctkLibrarySymbolTable();
+  ctkLibrarySymbolTable(const QString& fileName);
+  virtual ~ctkLibrarySymbolTable();
+
+  QString fileName()const;
+  void setFileName(const QString& fileName);
+
+  /// Read the exported symbols of the file.
+  /// Return false if the file can't be read or isn't an ELF, Mach-O or PE
+  /// binary of a supported layout.
+  bool load();
+
+  /// Forget the symbols
+  bool unload();
+
+  bool isLoaded() const;
+
+  /// Return true if the file exports \a symbol. As with QLibrary::resolve(),
+  /// the leading underscore of the Mach-O symbols must be omitted.
+  bool contains(const QString& symbol)const;
+
+  /// Return true if the file exports all the \a symbols.
+  bool containsAll(const QStringList& symbols)const;
+
+  /// List of the exported symbols
+  QStringList symbols()const;
+
+protected:
+  QScopedPointer<ctkLibrarySymbolTablePrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkLibrarySymbolTable);
+  Q_DISABLE_COPY(ctkLibrarySymbolTable);
+
+};
+
+#endif
@@ -44,6 +44,29 @@ public:
 
   double Coefficient;
   double Offset;
+
+  /// Last range converted by proxyRangeFromValueRange() or
+  /// valueRangeFromProxyRange()
+  struct RangeCache
+  {
+    RangeCache();
+    bool lookup(double coefficient, double offset,
+                double minimum, double maximum,
+                double& convertedMinimum, double& convertedMaximum)const;
+    void store(double coefficient, double offset,
+               double minimum, double maximum,
+               double convertedMinimum, double convertedMaximum);
+
+    bool   Valid;
+    double Coefficient;
+    double Offset;
+    double Minimum;
+    double Maximum;
+    double ConvertedMinimum;
+    double ConvertedMaximum;
+  };
+  mutable RangeCache ProxyRange;
+  mutable RangeCache ValueRange;
 };
 
 // --------------------------------------------------------------------------
@@ -68,6 +91,47 @@ bool ctkLinearValueProxyPrivate::isCoefficientValid() const
   return qAbs(this->Coefficient) > std::numeric_limits<double>::epsilon();
 }
 
+// --------------------------------------------------------------------------
+ctkLinearValueProxyPrivate::RangeCache::RangeCache()
+  : Valid(false)
+  , Coefficient(0.), Offset(0.)
+  , Minimum(0.), Maximum(0.)
+  , ConvertedMinimum(0.), ConvertedMaximum(0.)
+{
+}
+
+// --------------------------------------------------------------------------
+bool ctkLinearValueProxyPrivate::RangeCache::lookup(
+  double coefficient, double offset, double minimum, double maximum,
+  double& convertedMinimum, double& convertedMaximum)const
+{
+  // The coefficient and offset are part of the key: the cache is
+  // invalidated when they change, even through a reimplemented accessor.
+  if (!this->Valid ||
+      this->Coefficient != coefficient || this->Offset != offset ||
+      this->Minimum != minimum || this->Maximum != maximum)
+    {
+    return false;
+    }
+  convertedMinimum = this->ConvertedMinimum;
+  convertedMaximum = this->ConvertedMaximum;
+  return true;
+}
+
+// --------------------------------------------------------------------------
+void ctkLinearValueProxyPrivate::RangeCache::store(
+  double coefficient, double offset, double minimum, double maximum,
+  double convertedMinimum, double convertedMaximum)
+{
+  this->Valid = true;
+  this->Coefficient = coefficient;
+  this->Offset = offset;
+  this->Minimum = minimum;
+  this->Maximum = maximum;
+  this->ConvertedMinimum = convertedMinimum;
+  this->ConvertedMaximum = convertedMaximum;
+}
+
 // --------------------------------------------------------------------------
 // ctkLinearValueProxy methods
 
@@ -95,6 +159,67 @@ double ctkLinearValueProxy::valueFromProxyValue(double proxyValue) const
   return (proxyValue - this->offset()) / this->coefficient();
 }
 
+// --------------------------------------------------------------------------
+void ctkLinearValueProxy::proxyValuesFromValues(const double* values,
+                                                double* proxyValues, int count) const
+{
+  const double coefficient = this->coefficient();
+  const double offset = this->offset();
+  for (int i = 0; i < count; ++i)
+    {
+    proxyValues[i] = (coefficient * values[i]) + offset;
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkLinearValueProxy::valuesFromProxyValues(const double* proxyValues,
+                                                double* values, int count) const
+{
+  const double coefficient = this->coefficient();
+  const double offset = this->offset();
+  for (int i = 0; i < count; ++i)
+    {
+    values[i] = (proxyValues[i] - offset) / coefficient;
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkLinearValueProxy::proxyRangeFromValueRange(double minimum, double maximum,
+                                                   double& proxyMinimum,
+                                                   double& proxyMaximum) const
+{
+  Q_D(const ctkLinearValueProxy);
+  const double coefficient = this->coefficient();
+  const double offset = this->offset();
+  if (d->ProxyRange.lookup(coefficient, offset, minimum, maximum,
+                           proxyMinimum, proxyMaximum))
+    {
+    return;
+    }
+  this->Superclass::proxyRangeFromValueRange(minimum, maximum,
+                                             proxyMinimum, proxyMaximum);
+  d->ProxyRange.store(coefficient, offset, minimum, maximum,
+                      proxyMinimum, proxyMaximum);
+}
+
+// --------------------------------------------------------------------------
+void ctkLinearValueProxy::valueRangeFromProxyRange(double proxyMinimum, double proxyMaximum,
+                                                   double& minimum, double& maximum) const
+{
+  Q_D(const ctkLinearValueProxy);
+  const double coefficient = this->coefficient();
+  const double offset = this->offset();
+  if (d->ValueRange.lookup(coefficient, offset, proxyMinimum, proxyMaximum,
+                           minimum, maximum))
+    {
+    return;
+    }
+  this->Superclass::valueRangeFromProxyRange(proxyMinimum, proxyMaximum,
+                                             minimum, maximum);
+  d->ValueRange.store(coefficient, offset, proxyMinimum, proxyMaximum,
+                      minimum, maximum);
+}
+
 // --------------------------------------------------------------------------
 CTK_GET_CPP(ctkLinearValueProxy, double, coefficient, Coefficient);
 CTK_GET_CPP(ctkLinearValueProxy, double, offset, Offset);
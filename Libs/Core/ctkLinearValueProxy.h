@@ -52,6 +52,18 @@ public:
 
   virtual double valueFromProxyValue(double proxyValue) const;
 
+  /// Reimplemented to read the coefficient and the offset only once per
+  /// array instead of once per element.
+  virtual void proxyValuesFromValues(const double* values, double* proxyValues, int count) const;
+  virtual void valuesFromProxyValues(const double* proxyValues, double* values, int count) const;
+
+  /// Reimplemented to return the last converted range without computation
+  /// until the range, the coefficient or the offset change.
+  virtual void proxyRangeFromValueRange(double minimum, double maximum,
+                                        double& proxyMinimum, double& proxyMaximum) const;
+  virtual void valueRangeFromProxyRange(double proxyMinimum, double proxyMaximum,
+                                        double& minimum, double& maximum) const;
+
   virtual double coefficient() const;
   virtual double offset() const;
 
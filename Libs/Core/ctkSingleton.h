@@ -109,4 +109,81 @@ CTK_SINGLETON_DEFINE_INITIALIZER(NAME)
 
 ///@}
 
+// Qt includes
+#include <QAtomicPointer>
+
+//----------------------------------------------------------------------------
+/// \ingroup Core
+/// \brief Thread-safe singleton created on first use.
+///
+/// Unlike the CTK_SINGLETON macros, which create the instance when the
+/// translation units including the header are initialized, the instance is
+/// created by the first call to instance(), from any thread, and deleted at
+/// exit. Concurrent first calls may each construct a T: a single one is
+/// published and the others are deleted, so the constructor of T must not
+/// have side effects. Once published, instance() is an atomic load.
+/// \code
+/// class ctkMyRegistry
+/// {
+///   ...
+/// private:
+///   ctkMyRegistry();
+///   friend class ctkLazySingleton<ctkMyRegistry>;
+/// };
+/// ctkLazySingleton<ctkMyRegistry>::instance()->...
+/// \endcode
+template<typename T>
+class ctkLazySingleton
+{
+public:
+  static T* instance();
+
+private:
+  struct Cleanup
+  {
+    ~Cleanup()
+    {
+      delete ctkLazySingleton<T>::Instance.fetchAndStoreOrdered(0);
+    }
+  };
+
+  static QBasicAtomicPointer<T> Instance;
+  static Cleanup Cleaner;
+};
+
+//----------------------------------------------------------------------------
+template<typename T>
+QBasicAtomicPointer<T> ctkLazySingleton<T>::Instance = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+//----------------------------------------------------------------------------
+template<typename T>
+typename ctkLazySingleton<T>::Cleanup ctkLazySingleton<T>::Cleaner;
+
+//----------------------------------------------------------------------------
+template<typename T>
+T* ctkLazySingleton<T>::instance()
+{
+#if QT_VERSION >= 0x050000
+  T* instance = Instance.loadAcquire();
+#else
+  T* instance = Instance;
+#endif
+  if (!instance)
+    {
+    T* created = new T;
+    if (Instance.testAndSetOrdered(0, created))
+      {
+      // Instantiate the cleanup of the published instance
+      (void)&Cleaner;
+      instance = created;
+      }
+    else
+      {
+      delete created;
+      instance = Instance.fetchAndAddOrdered(0);
+      }
+    }
+  return instance;
+}
+
 #endif //__ctkSingleton_h
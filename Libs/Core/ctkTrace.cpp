@@ -0,0 +1,452 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QCoreApplication>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadStorage>
+
+// CTK includes
+#include "ctkHighPrecisionTimer.h"
+#include "ctkTrace.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct ctkTraceEvent
+{
+  const char* Name;
+  const char* Category;
+  qint64      Start;
+  qint64      Duration;
+};
+
+//----------------------------------------------------------------------------
+// Events are appended by a single thread and read by any thread: the count
+// is published after the event is written.
+struct ctkTraceChunk
+{
+  enum { Size = 4096 };
+  ctkTraceChunk() : Count(0), Next(0) {}
+
+  ctkTraceEvent                 Events[Size];
+  QAtomicInt                    Count;
+  QAtomicPointer<ctkTraceChunk> Next;
+};
+
+const int ctkTraceMaximumChunksPerThread = 256;
+
+//----------------------------------------------------------------------------
+inline int ctkTraceLoadAcquire(QAtomicInt& atomic)
+{
+#if QT_VERSION >= 0x050000
+  return atomic.loadAcquire();
+#else
+  return atomic.fetchAndAddAcquire(0);
+#endif
+}
+
+//----------------------------------------------------------------------------
+inline ctkTraceChunk* ctkTraceLoadAcquire(QAtomicPointer<ctkTraceChunk>& atomic)
+{
+#if QT_VERSION >= 0x050000
+  return atomic.loadAcquire();
+#else
+  return atomic.fetchAndAddAcquire(0);
+#endif
+}
+
+//----------------------------------------------------------------------------
+inline void ctkTraceStoreRelease(QAtomicInt& atomic, int value)
+{
+#if QT_VERSION >= 0x050000
+  atomic.storeRelease(value);
+#else
+  atomic.fetchAndStoreRelease(value);
+#endif
+}
+
+//----------------------------------------------------------------------------
+struct ctkTraceThreadBuffer
+{
+  ctkTraceThreadBuffer(int id, const QString& name)
+    : Id(id), Name(name), Last(&First), LastCount(0), Chunks(1), Dropped(0),
+      ClearedChunk(&First), ClearedCount(0), ClearedDropped(0)
+  {}
+
+  ~ctkTraceThreadBuffer()
+  {
+    ctkTraceChunk* chunk = ctkTraceLoadAcquire(this->First.Next);
+    while (chunk)
+      {
+      ctkTraceChunk* next = ctkTraceLoadAcquire(chunk->Next);
+      delete chunk;
+      chunk = next;
+      }
+  }
+
+  const int     Id;
+  const QString Name;
+  ctkTraceChunk First;
+
+  // Only used by the thread owning the buffer
+  ctkTraceChunk* Last;
+  int            LastCount;
+  int            Chunks;
+
+  QAtomicInt     Dropped;
+
+  // Position of the last clear(), protected by the registry mutex
+  ctkTraceChunk* ClearedChunk;
+  int            ClearedCount;
+  int            ClearedDropped;
+};
+
+//----------------------------------------------------------------------------
+struct ctkTraceRegistry
+{
+  ~ctkTraceRegistry()
+  {
+    qDeleteAll(this->Buffers);
+  }
+
+  QMutex                        Mutex;
+  QList<ctkTraceThreadBuffer*>  Buffers;
+};
+
+//----------------------------------------------------------------------------
+// Deleted by QThreadStorage when its thread finishes, the buffer is kept by
+// the registry up to the export
+struct ctkTraceThreadHandle
+{
+  ctkTraceThreadHandle(ctkTraceThreadBuffer* buffer) : Buffer(buffer) {}
+  ctkTraceThreadBuffer* Buffer;
+};
+
+//----------------------------------------------------------------------------
+struct ctkTraceClock
+{
+  ctkTraceClock() { this->Timer.start(); }
+  ctkHighPrecisionTimer Timer;
+};
+
+QAtomicInt ctkTraceEnabled;
+
+}
+
+Q_GLOBAL_STATIC(ctkTraceRegistry, ctkTraceRegistryInstance)
+Q_GLOBAL_STATIC(QThreadStorage<ctkTraceThreadHandle*>, ctkTraceThreadHandles)
+Q_GLOBAL_STATIC(ctkTraceClock, ctkTraceClockInstance)
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+ctkTraceThreadBuffer* ctkTraceCurrentThreadBuffer()
+{
+  QThreadStorage<ctkTraceThreadHandle*>* handles = ctkTraceThreadHandles();
+  if (!handles)
+    {
+    return 0;
+    }
+  if (handles->hasLocalData())
+    {
+    return handles->localData()->Buffer;
+    }
+
+  ctkTraceRegistry* registry = ctkTraceRegistryInstance();
+  if (!registry)
+    {
+    return 0;
+    }
+  QThread* thread = QThread::currentThread();
+  QMutexLocker lock(&registry->Mutex);
+  int id = registry->Buffers.size() + 1;
+  QString name = thread ? thread->objectName() : QString();
+  if (name.isEmpty())
+    {
+    name = QCoreApplication::instance() && QCoreApplication::instance()->thread() == thread ?
+      QString("Main thread") : QString("Thread %1").arg(id);
+    }
+  ctkTraceThreadBuffer* buffer = new ctkTraceThreadBuffer(id, name);
+  registry->Buffers << buffer;
+  handles->setLocalData(new ctkTraceThreadHandle(buffer));
+  return buffer;
+}
+
+//----------------------------------------------------------------------------
+// Call \a visitor on the events of \a buffer recorded since the last clear().
+// Return the number of events.
+template<class VisitorType>
+int ctkTraceVisitEvents(ctkTraceThreadBuffer* buffer, VisitorType& visitor)
+{
+  int count = 0;
+  ctkTraceChunk* chunk = buffer->ClearedChunk;
+  int begin = buffer->ClearedCount;
+  while (chunk)
+    {
+    int end = ctkTraceLoadAcquire(chunk->Count);
+    for (int i = begin; i < end; ++i)
+      {
+      visitor(buffer, chunk->Events[i]);
+      }
+    count += end - begin;
+    if (end < ctkTraceChunk::Size)
+      {
+      break;
+      }
+    chunk = ctkTraceLoadAcquire(chunk->Next);
+    begin = 0;
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+struct ctkTraceNullVisitor
+{
+  void operator()(ctkTraceThreadBuffer*, const ctkTraceEvent&) {}
+};
+
+//----------------------------------------------------------------------------
+void ctkTraceAppendString(QByteArray& json, const QByteArray& string)
+{
+  json += '"';
+  for (int i = 0; i < string.size(); ++i)
+    {
+    char c = string.at(i);
+    if (c == '"' || c == '\\')
+      {
+      json += '\\';
+      json += c;
+      }
+    else if (static_cast<unsigned char>(c) < 0x20)
+      {
+      json += QByteArray("\\u00") + QByteArray::number(static_cast<int>(c), 16).rightJustified(2, '0');
+      }
+    else
+      {
+      json += c;
+      }
+    }
+  json += '"';
+}
+
+//----------------------------------------------------------------------------
+struct ctkTraceChromeVisitor
+{
+  ctkTraceChromeVisitor(QByteArray& json, const QByteArray& pid) : Json(json), Pid(pid) {}
+
+  void separate()
+  {
+    this->Json += this->Json.endsWith('[') ? "\n" : ",\n";
+  }
+
+  void operator()(ctkTraceThreadBuffer* buffer, const ctkTraceEvent& event)
+  {
+    this->separate();
+    this->Json += "{\"name\":";
+    ctkTraceAppendString(this->Json, event.Name ? event.Name : "");
+    if (event.Category)
+      {
+      this->Json += ",\"cat\":";
+      ctkTraceAppendString(this->Json, event.Category);
+      }
+    this->Json += ",\"ph\":\"X\",\"ts\":" + QByteArray::number(event.Start)
+      + ",\"dur\":" + QByteArray::number(event.Duration)
+      + ",\"pid\":" + this->Pid
+      + ",\"tid\":" + QByteArray::number(buffer->Id) + "}";
+  }
+
+  QByteArray&      Json;
+  const QByteArray Pid;
+};
+
+}
+
+//----------------------------------------------------------------------------
+bool ctkTrace::isEnabled()
+{
+#if QT_VERSION >= 0x050000
+  return ctkTraceEnabled.load() != 0;
+#else
+  return ctkTraceEnabled != 0;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void ctkTrace::setEnabled(bool enabled)
+{
+  // Start the clock before the first span
+  ctkTrace::timestamp();
+  ctkTraceEnabled.fetchAndStoreOrdered(enabled ? 1 : 0);
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkTrace::timestamp()
+{
+  ctkTraceClock* clock = ctkTraceClockInstance();
+  return clock ? clock->Timer.elapsedMicro() : 0;
+}
+
+//----------------------------------------------------------------------------
+void ctkTrace::addEvent(const char* name, const char* category,
+                        qint64 start, qint64 duration)
+{
+  ctkTraceThreadBuffer* buffer = ctkTraceCurrentThreadBuffer();
+  if (!buffer)
+    {
+    return;
+    }
+  if (buffer->LastCount == ctkTraceChunk::Size)
+    {
+    if (buffer->Chunks == ctkTraceMaximumChunksPerThread)
+      {
+      buffer->Dropped.fetchAndAddRelaxed(1);
+      return;
+      }
+    ctkTraceChunk* chunk = new ctkTraceChunk;
+    buffer->Last->Next.fetchAndStoreRelease(chunk);
+    buffer->Last = chunk;
+    buffer->LastCount = 0;
+    ++buffer->Chunks;
+    }
+  ctkTraceEvent& event = buffer->Last->Events[buffer->LastCount];
+  event.Name = name;
+  event.Category = category;
+  event.Start = start;
+  event.Duration = duration;
+  ++buffer->LastCount;
+  ctkTraceStoreRelease(buffer->Last->Count, buffer->LastCount);
+}
+
+//----------------------------------------------------------------------------
+void ctkTrace::clear()
+{
+  ctkTraceRegistry* registry = ctkTraceRegistryInstance();
+  if (!registry)
+    {
+    return;
+    }
+  QMutexLocker lock(&registry->Mutex);
+  foreach (ctkTraceThreadBuffer* buffer, registry->Buffers)
+    {
+    // Move the mark to the end of the published events; the thread may
+    // keep appending concurrently.
+    ctkTraceChunk* chunk = buffer->ClearedChunk;
+    int count = ctkTraceLoadAcquire(chunk->Count);
+    while (count == ctkTraceChunk::Size)
+      {
+      ctkTraceChunk* next = ctkTraceLoadAcquire(chunk->Next);
+      if (!next)
+        {
+        break;
+        }
+      chunk = next;
+      count = ctkTraceLoadAcquire(chunk->Count);
+      }
+    buffer->ClearedChunk = chunk;
+    buffer->ClearedCount = count;
+    buffer->ClearedDropped = buffer->Dropped.fetchAndAddRelaxed(0);
+    }
+}
+
+//----------------------------------------------------------------------------
+int ctkTrace::eventCount()
+{
+  ctkTraceRegistry* registry = ctkTraceRegistryInstance();
+  if (!registry)
+    {
+    return 0;
+    }
+  QMutexLocker lock(&registry->Mutex);
+  int count = 0;
+  ctkTraceNullVisitor visitor;
+  foreach (ctkTraceThreadBuffer* buffer, registry->Buffers)
+    {
+    count += ctkTraceVisitEvents(buffer, visitor);
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+int ctkTrace::droppedEventCount()
+{
+  ctkTraceRegistry* registry = ctkTraceRegistryInstance();
+  if (!registry)
+    {
+    return 0;
+    }
+  QMutexLocker lock(&registry->Mutex);
+  int count = 0;
+  foreach (ctkTraceThreadBuffer* buffer, registry->Buffers)
+    {
+    count += buffer->Dropped.fetchAndAddRelaxed(0) - buffer->ClearedDropped;
+    }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+int ctkTrace::maximumEventsPerThread()
+{
+  return ctkTraceChunk::Size * ctkTraceMaximumChunksPerThread;
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkTrace::toChromeTrace()
+{
+  QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  ctkTraceRegistry* registry = ctkTraceRegistryInstance();
+  if (registry)
+    {
+    QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    ctkTraceChromeVisitor visitor(json, pid);
+    QMutexLocker lock(&registry->Mutex);
+    foreach (ctkTraceThreadBuffer* buffer, registry->Buffers)
+      {
+      visitor.separate();
+      json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid
+        + ",\"tid\":" + QByteArray::number(buffer->Id) + ",\"args\":{\"name\":";
+      ctkTraceAppendString(json, buffer->Name.toUtf8());
+      json += "}}";
+      ctkTraceVisitEvents(buffer, visitor);
+      }
+    }
+  json += "\n]}\n";
+  return json;
+}
+
+//----------------------------------------------------------------------------
+bool ctkTrace::writeChromeTrace(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    return false;
+    }
+  QByteArray json = ctkTrace::toChromeTrace();
+  return file.write(json) == json.size();
+}
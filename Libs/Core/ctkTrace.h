@@ -0,0 +1,134 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkTrace_h
+#define __ctkTrace_h
+
+// Qt includes
+#include <QByteArray>
+#include <QString>
+
+#include "ctkCoreExport.h"
+
+/// \ingroup Core
+/// Collects the spans recorded by ctkTraceScope and exports them in the
+/// Chrome trace event format, readable by chrome://tracing and Perfetto.
+///
+/// Each thread appends to its own buffer without locking; only the first
+/// span of a thread takes a lock to register the buffer. Names and
+/// categories are not copied: they must be string literals or otherwise
+/// outlive the tracing session. When tracing is disabled, a scope costs a
+/// single check of the enabled flag.
+///
+/// Timestamps are measured with ctkHighPrecisionTimer, in microseconds.
+/// A thread keeps at most maximumEventsPerThread() spans, later spans are
+/// counted in droppedEventCount().
+class CTK_CORE_EXPORT ctkTrace
+{
+public:
+  /// Tracing is disabled by default
+  static bool isEnabled();
+  static void setEnabled(bool enabled);
+
+  /// Microseconds since the tracing epoch
+  static qint64 timestamp();
+
+  /// Record a completed span. Called by ~ctkTraceScope()
+  static void addEvent(const char* name, const char* category,
+                       qint64 start, qint64 duration);
+
+  /// Forget the spans recorded so far. The memory is kept for the threads
+  /// to record new spans.
+  static void clear();
+
+  /// Number of spans recorded since the last clear()
+  static int eventCount();
+
+  /// Number of spans dropped because a thread buffer was full
+  static int droppedEventCount();
+
+  static int maximumEventsPerThread();
+
+  /// Spans recorded since the last clear(), as a Chrome trace JSON object
+  static QByteArray toChromeTrace();
+
+  /// Write toChromeTrace() into \a fileName.
+  /// Return false if the file can't be written.
+  static bool writeChromeTrace(const QString& fileName);
+};
+
+/// \ingroup Core
+/// Record the lifetime of the scope as a span of ctkTrace, if tracing is
+/// enabled when the scope starts.
+/// \sa CTK_TRACE_SCOPE
+class ctkTraceScope
+{
+public:
+  inline ctkTraceScope(const char* name, const char* category = "ctk");
+  inline ~ctkTraceScope();
+
+private:
+  const char* Name;
+  const char* Category;
+  qint64      Start;
+
+  ctkTraceScope(const ctkTraceScope&);
+  void operator=(const ctkTraceScope&);
+};
+
+//----------------------------------------------------------------------------
+inline ctkTraceScope::ctkTraceScope(const char* name, const char* category)
+  : Name(name), Category(category), Start(-1)
+{
+  if (ctkTrace::isEnabled())
+    {
+    this->Start = ctkTrace::timestamp();
+    }
+}
+
+//----------------------------------------------------------------------------
+inline ctkTraceScope::~ctkTraceScope()
+{
+  if (this->Start >= 0)
+    {
+    ctkTrace::addEvent(this->Name, this->Category, this->Start,
+                       ctkTrace::timestamp() - this->Start);
+    }
+}
+
+#define CTK_TRACE_CONCAT_IMPL(a, b) a##b
+#define CTK_TRACE_CONCAT(a, b) CTK_TRACE_CONCAT_IMPL(a, b)
+
+/// Trace the enclosing scope under the literal \a name
+/// \code
+/// void ctkDICOMDatabase::insert(...)
+/// {
+///   CTK_TRACE_SCOPE("ctkDICOMDatabase::insert");
+///   ...
+/// }
+/// \endcode
+#define CTK_TRACE_SCOPE(name) \
+  ctkTraceScope CTK_TRACE_CONCAT(ctkTraceScope_, __LINE__)(name)
+
+/// Same as CTK_TRACE_SCOPE, under the literal \a category
+#define CTK_TRACE_SCOPE_CATEGORY(category, name) \
+  ctkTraceScope CTK_TRACE_CONCAT(ctkTraceScope_, __LINE__)(name, category)
+
+#endif
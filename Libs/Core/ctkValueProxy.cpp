@@ -69,6 +69,43 @@ ctkValueProxy::~ctkValueProxy()
 {
 }
 
+// --------------------------------------------------------------------------
+void ctkValueProxy::proxyValuesFromValues(const double* values,
+                                          double* proxyValues, int count) const
+{
+  for (int i = 0; i < count; ++i)
+    {
+    proxyValues[i] = this->proxyValueFromValue(values[i]);
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkValueProxy::valuesFromProxyValues(const double* proxyValues,
+                                          double* values, int count) const
+{
+  for (int i = 0; i < count; ++i)
+    {
+    values[i] = this->valueFromProxyValue(proxyValues[i]);
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkValueProxy::proxyRangeFromValueRange(double minimum, double maximum,
+                                             double& proxyMinimum,
+                                             double& proxyMaximum) const
+{
+  proxyMinimum = this->proxyValueFromValue(minimum);
+  proxyMaximum = this->proxyValueFromValue(maximum);
+}
+
+// --------------------------------------------------------------------------
+void ctkValueProxy::valueRangeFromProxyRange(double proxyMinimum, double proxyMaximum,
+                                             double& minimum, double& maximum) const
+{
+  minimum = this->valueFromProxyValue(proxyMinimum);
+  maximum = this->valueFromProxyValue(proxyMaximum);
+}
+
 // --------------------------------------------------------------------------
 double ctkValueProxy::value() const
 {
@@ -67,6 +67,26 @@ public:
   virtual double proxyValueFromValue(double value) const = 0;
   virtual double valueFromProxyValue(double proxyValue) const = 0;
 
+  /// Convert the \a count first elements of \a values into \a proxyValues.
+  /// \a values and \a proxyValues can be the same array.
+  /// The default implementation calls proxyValueFromValue() on each element,
+  /// subclasses can reimplement it to convert whole arrays at once (e.g.
+  /// histogram bins or axis ticks).
+  virtual void proxyValuesFromValues(const double* values, double* proxyValues, int count) const;
+  /// Convert the \a count first elements of \a proxyValues into \a values.
+  /// \sa proxyValuesFromValues()
+  virtual void valuesFromProxyValues(const double* proxyValues, double* values, int count) const;
+
+  /// Convert the bounds of a range at once. The bounds are not reordered.
+  /// \sa proxyValueFromValue()
+  virtual void proxyRangeFromValueRange(double minimum, double maximum,
+                                        double& proxyMinimum, double& proxyMaximum) const;
+  /// Convert the bounds of a proxy range at once. The bounds are not
+  /// reordered.
+  /// \sa valueFromProxyValue()
+  virtual void valueRangeFromProxyRange(double proxyMinimum, double proxyMaximum,
+                                        double& minimum, double& maximum) const;
+
   double value() const;
   virtual double proxyValue() const;
 
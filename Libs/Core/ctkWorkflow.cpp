@@ -57,6 +57,10 @@ ctkWorkflowPrivate::ctkWorkflowPrivate(ctkWorkflow& object)
   this->ARTIFICIAL_BRANCH_ID_PREFIX = "ctkWorkflowArtificialBranchId_";
 
   this->Verbose = false;
+
+  this->PrefetchNextStep = false;
+
+  this->ForwardDistancesModified = true;
 }
 
 // --------------------------------------------------------------------------
@@ -426,6 +430,21 @@ void ctkWorkflowPrivate::processingAfterOnEntry()
   else
     {
     emit q->currentStepChanged(this->CurrentStep);
+
+    forwardAndBackwardSteps* steps = this->StepToForwardAndBackwardStepMap.value(this->CurrentStep);
+    if (this->PrefetchNextStep && this->CurrentStep && steps)
+      {
+      // goForward() without branchId follows the first transition
+      ctkWorkflowStep* nextStep = steps->forwardStep(steps->firstForwardBranchId());
+      if (nextStep)
+        {
+        if (this->Verbose)
+          {
+          qDebug() << QString("processingAfterOnEntry - preparing %1").arg(nextStep->name());
+          }
+        nextStep->prepareForEntry();
+        }
+      }
     }
 }
 
@@ -504,8 +523,6 @@ int ctkWorkflowPrivate::numberOfBackwardSteps(ctkWorkflowStep* step)
 // --------------------------------------------------------------------------
 bool ctkWorkflowPrivate::pathExists(const QString& goalId, ctkWorkflowStep* origin)const
 {
-  Q_Q(const ctkWorkflow);
-
   Q_ASSERT(!goalId.isEmpty());
   Q_ASSERT(this->CurrentStep);
 
@@ -523,10 +540,17 @@ bool ctkWorkflowPrivate::pathExists(const QString& goalId, ctkWorkflowStep* orig
   // - there is a goal AND
   // - either:
   //   - the origin is already the goal
-  //   - there is a path from at least one of the origin's successors to the goal
-  return (q->hasStep(goalId)
-          && ((QString::compare(goalId, originId, Qt::CaseInsensitive) == 0)
-              || (q->canGoForward(origin)))); // <-- TODO insert logic here for looking at graph
+  //   - the goal can be reached from the origin following the forward transitions
+  ctkWorkflowStep* goal = this->stepFromId(goalId);
+  if (!goal)
+    {
+    return false;
+    }
+  if (QString::compare(goalId, originId, Qt::CaseInsensitive) == 0)
+    {
+    return true;
+    }
+  return this->forwardDistance(origin ? origin : this->CurrentStep, goal) > 0;
 }
 
 // --------------------------------------------------------------------------
@@ -549,6 +573,80 @@ bool ctkWorkflowPrivate::pathExistsFromNextStep(const QString& goalId, const QSt
     }
 }
 
+// --------------------------------------------------------------------------
+int ctkWorkflowPrivate::forwardDistance(ctkWorkflowStep* origin, ctkWorkflowStep* goal)const
+{
+  if (origin == goal)
+    {
+    return 0;
+    }
+  this->updateForwardDistances();
+  return this->ForwardDistances.value(origin).value(goal, -1);
+}
+
+// --------------------------------------------------------------------------
+QString ctkWorkflowPrivate::forwardBranchIdTowards(ctkWorkflowStep* goal)const
+{
+  QString branchId;
+  forwardAndBackwardSteps* steps = this->StepToForwardAndBackwardStepMap.value(this->CurrentStep);
+  if (!steps)
+    {
+    return branchId;
+    }
+  // the transitions are tried in the order they were created, so that the first one wins
+  // between paths of the same length
+  int shortestDistance = -1;
+  QList<ctkWorkflowStep*> forwardSteps = steps->forwardSteps();
+  QList<QString> forwardBranchIds = steps->forwardBranchIds();
+  for (int i = 0; i < forwardSteps.size(); ++i)
+    {
+    int distance = this->forwardDistance(forwardSteps.at(i), goal);
+    if (distance != -1 && (shortestDistance == -1 || distance < shortestDistance))
+      {
+      shortestDistance = distance;
+      branchId = forwardBranchIds.at(i);
+      }
+    }
+  return branchId;
+}
+
+// --------------------------------------------------------------------------
+void ctkWorkflowPrivate::updateForwardDistances()const
+{
+  if (!this->ForwardDistancesModified)
+    {
+    return;
+    }
+  this->ForwardDistances.clear();
+
+  // breadth first search from each step, the transitions are not weighted
+  foreach(ctkWorkflowStep* origin, this->StepToForwardAndBackwardStepMap.keys())
+    {
+    QMap<ctkWorkflowStep*, int>& distances = this->ForwardDistances[origin];
+    QList<ctkWorkflowStep*> stepsToVisit;
+    stepsToVisit << origin;
+    for (int i = 0; i < stepsToVisit.size(); ++i)
+      {
+      ctkWorkflowStep* step = stepsToVisit.at(i);
+      int distance = (step == origin ? 0 : distances.value(step));
+      forwardAndBackwardSteps* steps = this->StepToForwardAndBackwardStepMap.value(step);
+      if (!steps)
+        {
+        continue;
+        }
+      foreach(ctkWorkflowStep* nextStep, steps->forwardSteps())
+        {
+        if (nextStep != origin && !distances.contains(nextStep))
+          {
+          distances.insert(nextStep, distance + 1);
+          stepsToVisit << nextStep;
+          }
+        }
+      }
+    }
+  this->ForwardDistancesModified = false;
+}
+
 // --------------------------------------------------------------------------
 // ctkWorkflow methods
 
@@ -647,6 +745,7 @@ bool ctkWorkflow::addTransition(ctkWorkflowStep* origin, ctkWorkflowStep* destin
       {
       //qDebug() << "addTransition" << origin->id() << "->" << destination->id();
       d->createTransitionToNextStep(origin, destination, branchId);
+      d->ForwardDistancesModified = true;
       }
 
     // create the backward transition
@@ -809,6 +908,10 @@ void ctkWorkflow::start()
     return;
     }
 
+  // The transitions can't change while the workflow is running, find the paths between the
+  // steps once so that goToStep() doesn't search the graph again
+  d->updateForwardDistances();
+
   // Setup to do the entry processing for the initial setp
   d->StateMachine->setInitialState(d->InitialStep->processingState());
   d->OriginStep = 0;
@@ -919,6 +1022,10 @@ CTK_SET_CPP(ctkWorkflow, bool, setGoBackToOriginStepUponSuccess, GoBackToOriginS
 CTK_GET_CPP(ctkWorkflow, bool, verbose, Verbose);
 CTK_SET_CPP(ctkWorkflow, bool, setVerbose, Verbose);
 
+// --------------------------------------------------------------------------
+CTK_GET_CPP(ctkWorkflow, bool, prefetchNextStep, PrefetchNextStep);
+CTK_SET_CPP(ctkWorkflow, bool, setPrefetchNextStep, PrefetchNextStep);
+
 // --------------------------------------------------------------------------
 void ctkWorkflow::goToStep(const QString& targetId)
 {
@@ -1025,7 +1132,16 @@ void ctkWorkflow::goToNextStepAfterSuccessfulValidation(const QString& branchId)
   Q_ASSERT(numberOfForwardSteps);
 
   // validationComplete() does not give us a branchId
-  if (branchId.isEmpty())
+  if (branchId.isEmpty() && d->GoToStep && numberOfForwardSteps > 1)
+    {
+    // when going to a 'goTo' step, follow the shortest path to it
+    transitionBranchId = d->forwardBranchIdTowards(d->GoToStep);
+    if (transitionBranchId.isEmpty())
+      {
+      transitionBranchId = firstForwardBranchId;
+      }
+    }
+  else if (branchId.isEmpty())
     {
     transitionBranchId = firstForwardBranchId;
     if (numberOfForwardSteps > 1)
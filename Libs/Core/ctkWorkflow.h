@@ -43,6 +43,7 @@ class CTK_CORE_EXPORT ctkWorkflow : public QObject
   Q_PROPERTY(bool isRunning READ isRunning DESIGNABLE false)
   Q_PROPERTY(bool goBackToOriginStepUponSuccess READ goBackToOriginStepUponSuccess WRITE setGoBackToOriginStepUponSuccess)
   Q_PROPERTY(bool verbose READ verbose WRITE setVerbose)
+  Q_PROPERTY(bool prefetchNextStep READ prefetchNextStep WRITE setPrefetchNextStep)
 
 public:
 
@@ -139,9 +140,8 @@ public:
   /// Returns whether or not we can go to the goal step from the origin step: i.e. there is a path
   /// in the workflow from the current step to the given step.
   ///
-  /// If no step is designated as the 'origin', then the workflow's current step will be used
-  /// Note: does not currently work in branching workflows if the origin and target steps are not on
-  /// the same branch
+  /// If no step is designated as the 'origin', then the workflow's current step will be used.
+  /// The paths between the steps are computed when the workflow starts.
   Q_INVOKABLE bool canGoToStep(const QString& targetId, ctkWorkflowStep* step=0)const;
 
   /// Get the steps that directly follow the given step.
@@ -189,6 +189,13 @@ public:
   bool verbose()const;
   void setVerbose(bool value);
 
+  /// If set, ctkWorkflowStep::prepareForEntry() is called on the step following the current
+  /// step (along the first transition created) each time the current step changes, so that it
+  /// can get ready while the user is still on the current step.
+  /// False by default.
+  bool prefetchNextStep()const;
+  void setPrefetchNextStep(bool value);
+
 public Q_SLOTS:
 
   /// Use this to trigger evaluation of the processing state of the current step, and subsequent
@@ -198,7 +205,8 @@ public Q_SLOTS:
   /// Use this to trigger transition to the previous step (does not require validation)
   virtual void goBackward(const QString& desiredBranchId = QString());
 
-  /// Go to the given step by iteratively calling goForward() until we reach it.
+  /// Go to the given step by iteratively calling goForward() until we reach it. At branches where
+  /// the steps don't give a branch id, the shortest path to the step is followed.
   virtual void goToStep(const QString& targetId);
 
   /// \brief Receives the result of a step's validate(const QString&) function.
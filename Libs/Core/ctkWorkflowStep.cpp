@@ -64,6 +64,13 @@ ctkWorkflowStepPrivate::ctkWorkflowStepPrivate(ctkWorkflowStep& object)
       new ctkWorkflowIntrastepTransition(ctkWorkflowIntrastepTransition::ValidationFailedTransition);
   this->ValidationFailedTransition->setTargetState(this->ProcessingState);
   this->ValidationState->addTransition(this->ValidationFailedTransition);
+
+  QObject::connect(&this->ValidationWatcher, SIGNAL(finished()),
+                   this, SLOT(onValidationFinished()));
+  QObject::connect(&this->OnEntryWatcher, SIGNAL(finished()),
+                   this, SLOT(onEntryFinished()));
+  QObject::connect(&this->OnExitWatcher, SIGNAL(finished()),
+                   this, SLOT(onExitFinished()));
 }
 
 // --------------------------------------------------------------------------
@@ -99,6 +106,27 @@ void ctkWorkflowStepPrivate::onExitCompleteInternal()const
   emit onExitComplete();
 }
 
+// --------------------------------------------------------------------------
+void ctkWorkflowStepPrivate::onValidationFinished()
+{
+  bool validationSucceeded = !this->ValidationWatcher.isCanceled()
+    && this->ValidationWatcher.future().resultCount() > 0
+    && this->ValidationWatcher.result();
+  this->validationCompleteInternal(validationSucceeded, this->ValidationBranchId);
+}
+
+// --------------------------------------------------------------------------
+void ctkWorkflowStepPrivate::onEntryFinished()
+{
+  this->onEntryCompleteInternal();
+}
+
+// --------------------------------------------------------------------------
+void ctkWorkflowStepPrivate::onExitFinished()
+{
+  this->onExitCompleteInternal();
+}
+
 // --------------------------------------------------------------------------
 void ctkWorkflowStepPrivate::invokeValidateCommandInternal(const QString& desiredBranchId)const
 {
@@ -216,6 +244,15 @@ void ctkWorkflowStep::validationComplete(bool validationResults, const QString&
   d->validationCompleteInternal(validationResults, branchId);
 }
 
+// --------------------------------------------------------------------------
+void ctkWorkflowStep::validationComplete(const QFuture<bool>& validationSucceeded,
+                                         const QString& branchId)
+{
+  Q_D(ctkWorkflowStep);
+  d->ValidationBranchId = branchId;
+  d->ValidationWatcher.setFuture(validationSucceeded);
+}
+
 // --------------------------------------------------------------------------
 void ctkWorkflowStep::onEntryComplete()const
 {
@@ -223,6 +260,13 @@ void ctkWorkflowStep::onEntryComplete()const
   d->onEntryCompleteInternal();
 }
 
+// --------------------------------------------------------------------------
+void ctkWorkflowStep::onEntryComplete(const QFuture<void>& entry)
+{
+  Q_D(ctkWorkflowStep);
+  d->OnEntryWatcher.setFuture(entry);
+}
+
 // --------------------------------------------------------------------------
 void ctkWorkflowStep::onExitComplete()const
 {
@@ -230,6 +274,13 @@ void ctkWorkflowStep::onExitComplete()const
   d->onExitCompleteInternal();
 }
 
+// --------------------------------------------------------------------------
+void ctkWorkflowStep::onExitComplete(const QFuture<void>& exit)
+{
+  Q_D(ctkWorkflowStep);
+  d->OnExitWatcher.setFuture(exit);
+}
+
 // --------------------------------------------------------------------------
 void ctkWorkflowStep::invokeValidateCommand(const QString& desiredBranchId)const
 {
@@ -263,6 +314,11 @@ void ctkWorkflowStep::validate(const QString& desiredBranchId)
   this->validationComplete(true, desiredBranchId);
 }
 
+// --------------------------------------------------------------------------
+void ctkWorkflowStep::prepareForEntry()
+{
+}
+
 
 // --------------------------------------------------------------------------
 void ctkWorkflowStep::onEntry(const ctkWorkflowStep* comingFrom,
@@ -22,6 +22,7 @@
 #define __ctkWorkflowStep_h
 
 // Qt includes
+#include <QFuture>
 class QObject;
 class QState;
 
@@ -204,6 +205,17 @@ protected:
   ///  </ul>
   virtual void validate(const QString& desiredBranchId = QString());
 
+  /// \brief Reimplement this function to prepare the step before it is entered.
+  ///
+  /// If ctkWorkflow::prefetchNextStep() is enabled, it is called on the step that goForward()
+  /// would go to without a branchId, as soon as the step before it becomes the current step.
+  /// It is speculative: the user may go elsewhere, and it may be called again each time the
+  /// previous step is entered. It must not block; start the work in the background, e.g. with
+  /// QtConcurrent::run(), and let onEntry() wait for it with onEntryComplete(const QFuture<void>&).
+  ///
+  /// The default implementation does nothing.
+  virtual void prepareForEntry();
+
   /// \brief Signal (emitted by the private implementation) indicating that validation of this
   /// step's processing should be performed.
   ///
@@ -216,6 +228,13 @@ protected:
   /// \sa validation()
   void validationComplete(bool validationSuceeded, const QString& branchId = QString())const;
 
+  /// \brief Call validationComplete() with the result of \a validationSucceeded once it is
+  /// finished, without blocking the event loop.
+  ///
+  /// Use it in validate() to run the validation in the background. A canceled future or a future
+  /// without result is a failed validation. Starting a new validation forgets the previous one.
+  void validationComplete(const QFuture<bool>& validationSucceeded, const QString& branchId = QString());
+
   /// \brief Signal (emitted by the private implementation) indicating that the step's 'onEntry'
   /// processing should be performed.
   ///
@@ -228,6 +247,11 @@ protected:
   /// \sa onEntry()
   void onEntryComplete()const;
 
+  /// \brief Call onEntryComplete() once \a entry is finished, without blocking the event loop.
+  ///
+  /// Use it in onEntry() to load the data of the step in the background.
+  void onEntryComplete(const QFuture<void>& entry);
+
   /// \brief Signal (emitted by the private implementation) indicating that the step's 'onExit'
   /// processing should be performed.
   ///
@@ -240,6 +264,9 @@ protected:
   /// \sa onExit()
   void onExitComplete()const;
 
+  /// \brief Call onExitComplete() once \a exit is finished, without blocking the event loop.
+  void onExitComplete(const QFuture<void>& exit);
+
 protected:
   QScopedPointer<ctkWorkflowStepPrivate> d_ptr;
 
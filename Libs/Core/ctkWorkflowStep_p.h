@@ -22,6 +22,7 @@
 #define __ctkWorkflowStep_p_h
 
 // Qt includes
+#include <QFutureWatcher>
 #include <QObject>
 #include <QPointer>
 
@@ -71,6 +72,12 @@ protected:
   bool HasOnEntryCommand;
   bool HasOnExitCommand;
 
+  // Asynchronous validation, onEntry and onExit
+  QFutureWatcher<bool> ValidationWatcher;
+  QString              ValidationBranchId;
+  QFutureWatcher<void> OnEntryWatcher;
+  QFutureWatcher<void> OnExitWatcher;
+
   void invokeValidateCommandInternal(const QString& desiredBranchId)const;
 
   void validationCompleteInternal(bool validationSuceeded, const QString& branchId)const;
@@ -83,6 +90,10 @@ protected:
 
   void onExitCompleteInternal()const;
 
+protected Q_SLOTS:
+  void onValidationFinished();
+  void onEntryFinished();
+  void onExitFinished();
 
 Q_SIGNALS:
   void invokeValidateCommand(const QString& desiredBranchId)const;
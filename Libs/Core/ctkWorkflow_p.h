@@ -246,6 +246,18 @@ public:
   /// branchId) to the step with the given goalId
   bool pathExistsFromNextStep(const QString& goalId, const QString& branchId)const;
 
+  /// Returns the number of forward transitions on the shortest path from \a origin to \a goal,
+  /// 0 if \a origin is \a goal and -1 if \a goal can't be reached from \a origin.
+  int forwardDistance(ctkWorkflowStep* origin, ctkWorkflowStep* goal)const;
+
+  /// Returns the branch id of the transition leaving the current step along the shortest path
+  /// to the given goal, or an empty string if there is no such path.
+  QString forwardBranchIdTowards(ctkWorkflowStep* goal)const;
+
+  /// Computes the distances between all the steps following the forward transitions, they are
+  /// computed when the workflow starts and each time a transition was added since.
+  void updateForwardDistances()const;
+
 public Q_SLOTS:
 
   /// \brief Workflow processing executed after a step's onEntry function is run.
@@ -298,6 +310,13 @@ public:
   QString ARTIFICIAL_BRANCH_ID_PREFIX;
 
   bool Verbose;
+
+  bool PrefetchNextStep;
+
+  // Distances along the forward transitions, ForwardDistances[origin][goal] is only set for the
+  // goals that can be reached from origin
+  mutable QMap<ctkWorkflowStep*, QMap<ctkWorkflowStep*, int> > ForwardDistances;
+  mutable bool ForwardDistancesModified;
 };
 
 #endif
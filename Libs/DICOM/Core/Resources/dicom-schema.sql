@@ -19,15 +19,26 @@ DROP INDEX IF EXISTS 'ImagesFilenameIndex' ;
 DROP INDEX IF EXISTS 'ImagesSeriesIndex' ;
 DROP INDEX IF EXISTS 'SeriesStudyIndex' ;
 DROP INDEX IF EXISTS 'StudiesPatientIndex' ;
+DROP INDEX IF EXISTS 'PatientsNameIndex' ;
+DROP INDEX IF EXISTS 'PatientsIDIndex' ;
+DROP INDEX IF EXISTS 'StudiesDateIndex' ;
+DROP INDEX IF EXISTS 'StudiesAccessionNumberIndex' ;
+DROP INDEX IF EXISTS 'SeriesModalityIndex' ;
 
 CREATE TABLE 'SchemaInfo' ( 'Version' VARCHAR(1024) NOT NULL );
-INSERT INTO 'SchemaInfo' VALUES('0.5.3');
+INSERT INTO 'SchemaInfo' VALUES('0.5.6');
+
+-- FileSize of the Images, InstanceCount, TotalBytes, First/LastInsertTimestamp
+-- of the Series and SeriesCount, InstanceCount and ModalitiesInStudy of the
+-- Studies are maintained by ctkDICOMDatabase when instances are inserted and
+-- removed, so that the browser does not have to aggregate the Images
 
 CREATE TABLE 'Images' (
   'SOPInstanceUID' VARCHAR(64) NOT NULL,
   'Filename' VARCHAR(1024) NOT NULL ,
   'SeriesInstanceUID' VARCHAR(64) NOT NULL ,
   'InsertTimestamp' VARCHAR(20) NOT NULL ,
+  'FileSize' INT NULL ,
   PRIMARY KEY ('SOPInstanceUID') );
 CREATE TABLE 'Patients' (
   'UID' INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -53,6 +64,10 @@ CREATE TABLE 'Series' (
   'ScanningSequence' VARCHAR(45) NULL ,
   'EchoNumber' INT NULL ,
   'TemporalPosition' INT NULL ,
+  'InstanceCount' INT NOT NULL DEFAULT 0 ,
+  'TotalBytes' INT NOT NULL DEFAULT 0 ,
+  'FirstInsertTimestamp' VARCHAR(20) NULL ,
+  'LastInsertTimestamp' VARCHAR(20) NULL ,
   PRIMARY KEY ('SeriesInstanceUID') );
 CREATE TABLE 'Studies' (
   'StudyInstanceUID' VARCHAR(64) NOT NULL ,
@@ -66,6 +81,8 @@ CREATE TABLE 'Studies' (
   'ReferringPhysician' VARCHAR(255) NULL ,
   'PerformingPhysiciansName' VARCHAR(255) NULL ,
   'StudyDescription' VARCHAR(255) NULL ,
+  'SeriesCount' INT NOT NULL DEFAULT 0 ,
+  'InstanceCount' INT NOT NULL DEFAULT 0 ,
   PRIMARY KEY ('StudyInstanceUID') );
 
 CREATE UNIQUE INDEX IF NOT EXISTS 'ImagesFilenameIndex' ON 'Images' ('Filename');
@@ -73,6 +90,18 @@ CREATE INDEX IF NOT EXISTS 'ImagesSeriesIndex' ON 'Images' ('SeriesInstanceUID')
 CREATE INDEX IF NOT EXISTS 'SeriesStudyIndex' ON 'Series' ('StudyInstanceUID');
 CREATE INDEX IF NOT EXISTS 'StudiesPatientIndex' ON 'Studies' ('PatientsUID');
 
+-- indexes for the columns searched and sorted on by the browser and for
+-- the existence checks done while inserting
+CREATE INDEX IF NOT EXISTS 'PatientsNameIndex' ON 'Patients' ('PatientsName');
+CREATE INDEX IF NOT EXISTS 'PatientsIDIndex' ON 'Patients' ('PatientID', 'PatientsName');
+CREATE INDEX IF NOT EXISTS 'StudiesDateIndex' ON 'Studies' ('StudyDate', 'StudyInstanceUID');
+CREATE INDEX IF NOT EXISTS 'StudiesAccessionNumberIndex' ON 'Studies' ('AccessionNumber');
+CREATE INDEX IF NOT EXISTS 'SeriesModalityIndex' ON 'Series' ('Modality', 'StudyInstanceUID');
+
+-- Fingerprint of the content of the directories that have been indexed
+-- (modification time, inode, number and size of the files), used to skip
+-- the directories that did not change when refreshing the database
 CREATE TABLE 'Directories' (
   'Dirname' VARCHAR(1024) ,
+  'Fingerprint' VARCHAR(255) NULL ,
   PRIMARY KEY ('Dirname') );
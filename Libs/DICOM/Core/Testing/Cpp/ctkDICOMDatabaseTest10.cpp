@@ -0,0 +1,124 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+
+int ctkDICOMDatabaseTest10( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMDatabaseTest10: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString dicomFilePath(argv[1]);
+
+  ctkDICOMDatabase database;
+  QDir databaseDirectory = QDir::temp();
+  databaseDirectory.remove("ctkDICOMDatabase.sql");
+  databaseDirectory.remove("ctkDICOMTagCache.sql");
+
+  QFileInfo databaseFile(databaseDirectory, QString("database.test"));
+  database.openDatabase(databaseFile.absoluteFilePath());
+
+  bool res = database.initializeDatabase();
+
+  if (!res)
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the file is copied into the database directory, it is removed with
+  // the study
+  database.insert(dicomFilePath, true, false);
+
+  QString instanceUID("1.2.840.113619.2.135.3596.6358736.4843.1115808177.83");
+  QString storedFilePath = database.fileForInstance(instanceUID);
+  if (storedFilePath.isEmpty() || storedFilePath == dicomFilePath
+      || !QFileInfo(storedFilePath).exists())
+    {
+    std::cerr << "ctkDICOMDatabase::insert() failed to store the file: "
+              << qPrintable(storedFilePath) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Test the batch removal
+  //
+  QString studyUID = database.studyForSeries(database.seriesForFile(storedFilePath));
+  QStringList studies;
+  studies << studyUID << "1.2.3.4.not.in.database";
+  if (!database.removeStudies(studies, true))
+    {
+    std::cerr << "ctkDICOMDatabase::removeStudies() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!database.allFiles().isEmpty() || !database.patients().isEmpty())
+    {
+    std::cerr << "ctkDICOMDatabase::removeStudies() left "
+              << database.allFiles().count() << " files and "
+              << database.patients().count() << " patients" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.waitForFileRemoval();
+  if (QFileInfo(storedFilePath).exists())
+    {
+    std::cerr << "ctkDICOMDatabase::removeStudies() did not remove "
+              << qPrintable(storedFilePath) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // nothing to remove
+  if (!database.removeSeries(QStringList()) || !database.removePatients(QStringList()))
+    {
+    std::cerr << "ctkDICOMDatabase: removing no series should succeed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the removed patient, study and series must be inserted again
+  database.insert(dicomFilePath, false, false);
+  if (database.patients().count() != 1 || database.studiesForPatient(database.patients()[0]).count() != 1
+      || database.seriesForStudy(studyUID).count() != 1)
+    {
+    std::cerr << "ctkDICOMDatabase::insert() failed to insert the removed study again" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,93 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVariant>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+
+int ctkDICOMDatabaseTest11( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMDatabaseTest11: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString dicomFilePath(argv[1]);
+
+  // disabled statistics are not collected
+  ctkDICOMDatabase disabledDatabase;
+  disabledDatabase.openDatabase(":memory:");
+  disabledDatabase.setStatisticsEnabled(false);
+  disabledDatabase.insert(dicomFilePath, false, false);
+  if (disabledDatabase.statistics()["insertedInstances"].toInt() != 0)
+    {
+    std::cerr << "ctkDICOMDatabase: statistics collected while disabled" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:");
+  database.setStatisticsEnabled(true);
+  database.insert(dicomFilePath, false, false);
+
+  QVariantMap statistics = database.statistics();
+  if (statistics["insertedInstances"].toInt() != 1)
+    {
+    std::cerr << "ctkDICOMDatabase: wrong number of inserted instances: "
+              << statistics["insertedInstances"].toInt() << std::endl;
+    return EXIT_FAILURE;
+    }
+  QStringList phases;
+  phases << "parse" << "instanceCheck" << "patient" << "study" << "series" << "image";
+  foreach(const QString& phase, phases)
+    {
+    QVariantMap phaseStatistics = statistics[phase].toMap();
+    if (phaseStatistics["count"].toInt() < 1 ||
+        phaseStatistics["seconds"].toDouble() < 0.)
+      {
+      std::cerr << "ctkDICOMDatabase: phase " << qPrintable(phase)
+                << " was not timed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  database.resetStatistics();
+  if (database.statistics()["insertedInstances"].toInt() != 0 ||
+      database.statistics()["parse"].toMap()["count"].toInt() != 0)
+    {
+    std::cerr << "ctkDICOMDatabase::resetStatistics() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QSqlQuery>
+#include <QStringList>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMOperationToken.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+
+int ctkDICOMDatabaseTest12( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMDatabaseTest12: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString dicomFilePath(argv[1]);
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:");
+  ctkDICOMOperationToken token;
+  database.setOperationToken(&token);
+
+  // the inserts of an aborted bulk insert session are rolled back
+  database.beginBulkInsert();
+  database.insert(dicomFilePath, false, false);
+  database.abortBulkInsert();
+  if (database.isBulkInserting() || !database.patients().isEmpty()
+      || !database.allFiles().isEmpty())
+    {
+    std::cerr << "ctkDICOMDatabase::abortBulkInsert() did not roll back" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // and the file can be inserted again
+  database.beginBulkInsert();
+  database.insert(dicomFilePath, false, false);
+  database.endBulkInsert();
+  if (database.allFiles().count() != 1 || database.patients().count() != 1)
+    {
+    std::cerr << "ctkDICOMDatabase: insert after abortBulkInsert() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // leave the patient, study and series empty
+  QSqlQuery deleteImages(database.database());
+  deleteImages.exec("DELETE FROM Images");
+
+  // a canceled cleanup leaves the database untouched
+  token.cancel();
+  if (!token.isCanceled() || database.cleanup())
+    {
+    std::cerr << "ctkDICOMDatabase::cleanup() should be canceled" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (database.patients().count() != 1)
+    {
+    std::cerr << "ctkDICOMDatabase::cleanup() was not rolled back" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  token.reset();
+  if (!database.cleanup() || !database.patients().isEmpty()
+      || token.itemsDone() != token.totalItems() || token.phase().isEmpty())
+    {
+    std::cerr << "ctkDICOMDatabase::cleanup() progress not reported: "
+              << token.itemsDone() << "/" << token.totalItems() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
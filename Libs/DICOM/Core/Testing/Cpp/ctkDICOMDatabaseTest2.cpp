@@ -19,13 +19,18 @@
 =========================================================================*/
 
 // Qt includes
+#include <QBuffer>
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QDir>
 #include <QTimer>
 
 // ctkDICOMCore includes
 #include "ctkDICOMDatabase.h"
 
+// DCMTK includes
+#include <dcmtk/dcmdata/dcdeftag.h>
+
 // STD includes
 #include <iostream>
 #include <cstdlib>
@@ -176,6 +181,24 @@ int ctkDICOMDatabaseTest2( int argc, char * argv [] )
     }
 
 
+  // the value has just been cached, it must come from memory
+  int hits = database.tagValueCacheHits();
+  database.cachedTag(instanceUID, tag);
+  if (database.tagValueCacheHits() != hits + 1)
+    {
+    std::cerr << "ctkDICOMDatabase: cached tag should be found in the tag value cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QList<QStringList> bulkValues = database.instanceValues(
+    QStringList() << instanceUID, QStringList() << tag);
+  if (bulkValues.count() != 1 || bulkValues[0].count() != 1 ||
+      bulkValues[0][0] != knownSeriesDescription)
+    {
+    std::cerr << "ctkDICOMDatabase: instanceValues returned invalid values" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   QString foundSeriesDescription = database.instanceValue(instanceUID, tag);
 
   if (foundSeriesDescription != knownSeriesDescription)
@@ -204,6 +227,80 @@ int ctkDICOMDatabaseTest2( int argc, char * argv [] )
     return EXIT_FAILURE;
     }
 
+  // read several tags from the file in one pass
+  if (!database.initializeTagCache())
+    {
+    std::cerr << "ctkDICOMDatabase: could not initialize tag cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QList<DcmTagKey> tagKeys;
+  tagKeys << DCM_SeriesDescription << DCM_SOPInstanceUID;
+  QList<QStringList> fileValues = database.fileValues(QStringList() << foundFile, tagKeys);
+  if (fileValues.count() != 1 || fileValues[0].count() != 2 ||
+      fileValues[0][0] != database.fileValue(foundFile, tag) ||
+      fileValues[0][1] != instanceUID)
+    {
+    std::cerr << "ctkDICOMDatabase: fileValues returned invalid values" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (database.cachedTag(instanceUID, "0008,0018") != instanceUID)
+    {
+    std::cerr << "ctkDICOMDatabase: fileValues did not cache the values" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // export the tables and the cached tags, the second tag is not cached
+  QStringList exportTags;
+  exportTags << "0008,0018" << "0020,0013";
+  QBuffer csvBuffer;
+  csvBuffer.open(QIODevice::WriteOnly);
+  if (!database.exportMetadata(&csvBuffer, exportTags, ctkDICOMDatabase::ExportCSV))
+    {
+    std::cerr << "ctkDICOMDatabase: exportMetadata failed to write CSV" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QList<QByteArray> csvLines = csvBuffer.data().split('\n');
+  if (csvLines.count() != 3 || !csvLines[0].startsWith("PatientsUID,") ||
+      !csvLines[0].contains(",SOPInstanceUID,") ||
+      !csvLines[1].endsWith(instanceUID.toLatin1() + "," + "\r"))
+    {
+    std::cerr << "ctkDICOMDatabase: exportMetadata wrote invalid CSV" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QBuffer columnarBuffer;
+  columnarBuffer.open(QIODevice::ReadWrite);
+  if (!database.exportMetadata(&columnarBuffer, exportTags, ctkDICOMDatabase::ExportColumnar))
+    {
+    std::cerr << "ctkDICOMDatabase: exportMetadata failed to write columns" << std::endl;
+    return EXIT_FAILURE;
+    }
+  columnarBuffer.seek(0);
+  QDataStream columnarStream(&columnarBuffer);
+  columnarStream.setVersion(QDataStream::Qt_4_6);
+  quint32 magic, version;
+  QStringList columnNames;
+  qint32 rowCount, endOfGroups;
+  columnarStream >> magic >> version >> columnNames >> rowCount;
+  QList<QStringList> columnValues;
+  for (int i = 0; i < columnNames.count(); ++i)
+    {
+    QStringList column;
+    columnarStream >> column;
+    columnValues << column;
+    }
+  columnarStream >> endOfGroups;
+  int uidColumn = columnNames.indexOf("SOPInstanceUID");
+  if (magic != 0x43544b4d || version != 1 || rowCount != 1 || endOfGroups != 0 ||
+      columnNames.mid(columnNames.count() - 2) != exportTags || uidColumn < 0 ||
+      columnValues[uidColumn] != QStringList(instanceUID) ||
+      columnValues[columnNames.count() - 2] != QStringList(instanceUID) ||
+      columnValues[columnNames.count() - 1] != QStringList(QString()))
+    {
+    std::cerr << "ctkDICOMDatabase: exportMetadata wrote invalid columns" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   database.closeDatabase();
   database.initializeDatabase();
 
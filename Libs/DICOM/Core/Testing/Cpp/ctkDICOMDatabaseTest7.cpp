@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+
+int ctkDICOMDatabaseTest7( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMDatabaseTest7: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString dicomFilePath(argv[1]);
+
+  ctkDICOMDatabase database;
+  QDir databaseDirectory = QDir::temp();
+  databaseDirectory.remove("ctkDICOMDatabase.sql");
+  databaseDirectory.remove("ctkDICOMTagCache.sql");
+
+  QFileInfo databaseFile(databaseDirectory, QString("database.test"));
+  database.openDatabase(databaseFile.absoluteFilePath());
+
+  bool res = database.initializeDatabase();
+
+  if (!res)
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Test the bulk insert session:
+  // - inserted instances are visible while the session is open
+  // - nested sessions only end with the outermost endBulkInsert()
+  //
+  if (database.isBulkInserting())
+    {
+    std::cerr << "ctkDICOMDatabase: no bulk insert should be running by default"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.setBulkInsertTransactionSize(1);
+  if (database.bulkInsertTransactionSize() != 1)
+    {
+    std::cerr << "ctkDICOMDatabase::setBulkInsertTransactionSize() failed"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.beginBulkInsert();
+  database.beginBulkInsert();
+  database.insert(dicomFilePath, false, false);
+  // inserting the same file twice must not add it twice
+  database.insert(dicomFilePath, false, false);
+  database.endBulkInsert();
+
+  if (!database.isBulkInserting())
+    {
+    std::cerr << "ctkDICOMDatabase: nested endBulkInsert() should not end the session"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString instanceUID("1.2.840.113619.2.135.3596.6358736.4843.1115808177.83");
+  if (database.fileForInstance(instanceUID) != dicomFilePath)
+    {
+    std::cerr << "ctkDICOMDatabase: instance inserted in bulk insert session not found"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.endBulkInsert();
+
+  if (database.isBulkInserting())
+    {
+    std::cerr << "ctkDICOMDatabase: bulk insert session should have ended"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (database.allFiles().count() != 1)
+    {
+    std::cerr << "ctkDICOMDatabase: expected 1 file after bulk insert, got "
+              << database.allFiles().count() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
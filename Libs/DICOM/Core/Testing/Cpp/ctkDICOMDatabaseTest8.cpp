@@ -0,0 +1,162 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QSqlQuery>
+#include <QThread>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+//------------------------------------------------------------------------------
+class ctkDICOMDatabaseReaderThread : public QThread
+{
+public:
+  ctkDICOMDatabaseReaderThread(ctkDICOMDatabase* database)
+    : Database(database)
+    , ImageCount(-1)
+    , SameConnection(false)
+    , WriteFailed(false)
+  {
+  }
+
+  virtual void run()
+  {
+    QSqlDatabase reader = this->Database->readerConnection();
+    if (!reader.isValid() || !reader.isOpen())
+      {
+      return;
+      }
+    this->ConnectionName = reader.connectionName();
+    this->SameConnection =
+      (this->Database->readerConnection().connectionName() == this->ConnectionName);
+
+    QSqlQuery query(reader);
+    if (query.exec("SELECT COUNT(*) FROM Images") && query.next())
+      {
+      this->ImageCount = query.value(0).toInt();
+      }
+    this->WriteFailed = !query.exec("DELETE FROM Images");
+  }
+
+  ctkDICOMDatabase* Database;
+  QString ConnectionName;
+  int ImageCount;
+  bool SameConnection;
+  bool WriteFailed;
+};
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabaseTest8( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMDatabaseTest8: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString dicomFilePath(argv[1]);
+
+  ctkDICOMDatabase database;
+  QDir databaseDirectory = QDir::temp();
+  databaseDirectory.remove("ctkDICOMDatabase.sql");
+  databaseDirectory.remove("ctkDICOMTagCache.sql");
+
+  QFileInfo databaseFile(databaseDirectory, QString("database.test"));
+  database.openDatabase(databaseFile.absoluteFilePath());
+
+  bool res = database.initializeDatabase();
+
+  if (!res)
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.insert(dicomFilePath, false, false);
+
+  //
+  // Test the reader connections:
+  // - each thread gets its own connection, reused by later calls
+  // - the connection is read-only
+  //
+  ctkDICOMDatabaseReaderThread reader1(&database);
+  ctkDICOMDatabaseReaderThread reader2(&database);
+  reader1.start();
+  reader2.start();
+  reader1.wait();
+  reader2.wait();
+
+  if (reader1.ImageCount != 1 || reader2.ImageCount != 1)
+    {
+    std::cerr << "ctkDICOMDatabase::readerConnection(): expected 1 image, got "
+              << reader1.ImageCount << " and " << reader2.ImageCount << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!reader1.SameConnection || !reader2.SameConnection ||
+      reader1.ConnectionName == reader2.ConnectionName ||
+      reader1.ConnectionName == database.database().connectionName())
+    {
+    std::cerr << "ctkDICOMDatabase::readerConnection(): connections should be per thread"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!reader1.WriteFailed || database.allFiles().count() != 1)
+    {
+    std::cerr << "ctkDICOMDatabase::readerConnection(): connection should be read-only"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the connections are removed when the threads finish
+  if (QSqlDatabase::contains(reader1.ConnectionName) ||
+      QSqlDatabase::contains(reader2.ConnectionName))
+    {
+    std::cerr << "ctkDICOMDatabase::readerConnection(): connections should be removed"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // in-memory databases can't be shared
+  ctkDICOMDatabase inMemoryDatabase;
+  inMemoryDatabase.openDatabase(":memory:", "DICOM-DB-memory");
+  if (inMemoryDatabase.readerConnection().isValid())
+    {
+    std::cerr << "ctkDICOMDatabase::readerConnection(): expected an invalid connection "
+              << "for an in-memory database" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  inMemoryDatabase.closeDatabase();
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
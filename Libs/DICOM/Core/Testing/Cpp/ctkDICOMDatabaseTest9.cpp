@@ -0,0 +1,130 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+
+int ctkDICOMDatabaseTest9( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMDatabaseTest9: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString dicomFilePath(argv[1]);
+
+  ctkDICOMDatabase database;
+  QDir databaseDirectory = QDir::temp();
+  databaseDirectory.remove("ctkDICOMDatabase.sql");
+  databaseDirectory.remove("ctkDICOMTagCache.sql");
+
+  QFileInfo databaseFile(databaseDirectory, QString("database.test"));
+  database.openDatabase(databaseFile.absoluteFilePath());
+
+  bool res = database.initializeDatabase();
+
+  if (!res)
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.insert(dicomFilePath, false, false);
+
+  //
+  // Test the aggregates maintained by insert() and removeFiles()
+  //
+  QString instanceUID("1.2.840.113619.2.135.3596.6358736.4843.1115808177.83");
+  QString seriesUID = database.seriesForFile(dicomFilePath);
+  QString studyUID = database.studyForSeries(seriesUID);
+  if (seriesUID.isEmpty() || studyUID.isEmpty()
+      || database.fileForInstance(instanceUID) != dicomFilePath)
+    {
+    std::cerr << "ctkDICOMDatabase::insert() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (database.instanceCountForSeries(seriesUID) != 1 ||
+      database.seriesCountForStudy(studyUID) != 1 ||
+      database.instanceCountForStudy(studyUID) != 1)
+    {
+    std::cerr << "ctkDICOMDatabase: wrong instance or series count: "
+              << database.instanceCountForSeries(seriesUID) << " "
+              << database.seriesCountForStudy(studyUID) << " "
+              << database.instanceCountForStudy(studyUID) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (database.totalBytesForSeries(seriesUID) != QFileInfo(dicomFilePath).size())
+    {
+    std::cerr << "ctkDICOMDatabase::totalBytesForSeries() failed: "
+              << database.totalBytesForSeries(seriesUID) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!database.firstInsertDateTimeForSeries(seriesUID).isValid() ||
+      database.firstInsertDateTimeForSeries(seriesUID) !=
+      database.lastInsertDateTimeForSeries(seriesUID))
+    {
+    std::cerr << "ctkDICOMDatabase: wrong insert date times for series" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!database.modalitiesForStudy(studyUID).contains("MR"))
+    {
+    std::cerr << "ctkDICOMDatabase::modalitiesForStudy() failed: "
+              << qPrintable(database.modalitiesForStudy(studyUID).join(",")) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // inserting the same file again must not count it twice
+  database.insert(dicomFilePath, false, false);
+  if (database.instanceCountForSeries(seriesUID) != 1)
+    {
+    std::cerr << "ctkDICOMDatabase: instance counted twice" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.removeFiles(QStringList() << dicomFilePath);
+  if (database.instanceCountForSeries(seriesUID) != 0 ||
+      database.seriesCountForStudy(studyUID) != 0)
+    {
+    std::cerr << "ctkDICOMDatabase: aggregates not updated by removeFiles()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMFilterProxyModel.h"
+#include "ctkDICOMModel.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+//------------------------------------------------------------------------------
+static bool checkRowCount(int line, const ctkDICOMFilterProxyModel& proxy, int expected)
+{
+  if (proxy.rowCount() != expected)
+    {
+    std::cerr << "Line " << line << " - Problem with rowCount(): "
+              << proxy.rowCount() << " instead of " << expected << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMFilterProxyModelTest1( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc <= 2)
+    {
+    std::cerr << "Usage: ctkDICOMFilterProxyModelTest1 <scratch.db> <dumpfile.sql>" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMDatabase database(argv[1]);
+  if (!database.initializeDatabase(argv[2]))
+    {
+    std::cerr << "Error when initializing the data base: " << argv[2]
+              << " error: " << qPrintable(database.lastError()) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMModel model;
+  model.setDatabase(database.database());
+  ctkDICOMFilterProxyModel proxy;
+  proxy.setSourceModel(&model);
+
+  // The sample database has 3 patients: "Austrialian",
+  // "09.11.24-14:36:24-STD" and "MROVERLAY-13"
+  if (proxy.filterDelay() != 300 ||
+      !checkRowCount(__LINE__, proxy, 3))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // The filter is updated after the delay, or by applyPendingFilter()
+  proxy.setNameSearchText("MROVER");
+  if (!proxy.isFilterPending() ||
+      !checkRowCount(__LINE__, proxy, 3))
+    {
+    return EXIT_FAILURE;
+    }
+  proxy.applyPendingFilter();
+  if (proxy.isFilterPending() ||
+      !checkRowCount(__LINE__, proxy, 1))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Rapid changes re-filter once, after the last one
+  proxy.setFilterDelay(50);
+  proxy.setNameSearchText("A");
+  proxy.setNameSearchText("Au");
+  proxy.setNameSearchText("Aus");
+  QEventLoop eventLoop;
+  QTimer::singleShot(200, &eventLoop, SLOT(quit()));
+  eventLoop.exec();
+  if (proxy.isFilterPending() ||
+      !checkRowCount(__LINE__, proxy, 1))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Regular expressions
+  proxy.setFilterDelay(0);
+  proxy.setNameSearchText("^[0-9]");
+  if (proxy.isFilterPending() ||
+      !checkRowCount(__LINE__, proxy, 1))
+    {
+    return EXIT_FAILURE;
+    }
+  proxy.setNameSearchText("A.*-");
+  if (!checkRowCount(__LINE__, proxy, 1))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Plain substrings
+  proxy.setNameSearchText("-1");
+  if (!checkRowCount(__LINE__, proxy, 2))
+    {
+    return EXIT_FAILURE;
+    }
+  proxy.setNameSearchText("no patient matches this text");
+  if (!checkRowCount(__LINE__, proxy, 0))
+    {
+    return EXIT_FAILURE;
+    }
+  proxy.setNameSearchText("");
+  if (!checkRowCount(__LINE__, proxy, 3))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // SQL filtering, the source model only fetches the matching rows
+  proxy.setSqlFiltering(true);
+  proxy.setNameSearchText("MROVER");
+  if (model.searchParameters().value("Name").toString() != "MROVER" ||
+      model.rowCount() != 1 ||
+      !checkRowCount(__LINE__, proxy, 1))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with sqlFiltering" << std::endl;
+    return EXIT_FAILURE;
+    }
+  proxy.setNameSearchText("-1");
+  if (model.rowCount() != 2 ||
+      !checkRowCount(__LINE__, proxy, 2))
+    {
+    return EXIT_FAILURE;
+    }
+  // LIKE wildcards are matched literally
+  proxy.setNameSearchText("%");
+  if (model.rowCount() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with escaped wildcard" << std::endl;
+    return EXIT_FAILURE;
+    }
+  proxy.setNameSearchText("-1");
+
+  // Back to client side filtering, the source model has all the rows again
+  proxy.setSqlFiltering(false);
+  if (model.searchParameters().value("Name").toString() != "" ||
+      model.rowCount() != 3 ||
+      !checkRowCount(__LINE__, proxy, 2))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with sqlFiltering" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -36,6 +36,19 @@ int ctkDICOMIndexerTest1( int argc, char * argv [] )
   ctkDICOMDatabase database;
   ctkDICOMIndexer indexer;
 
+  if (indexer.numberOfParserThreads() != 0)
+    {
+    std::cerr << "ctkDICOMIndexer: by default one parser thread per core should be used"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  indexer.setNumberOfParserThreads(2);
+  if (indexer.numberOfParserThreads() != 2)
+    {
+    std::cerr << "ctkDICOMIndexer::setNumberOfParserThreads() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   // Test ctkDICOMIndexer::addDirectory()
   // just check if it doesn't crash
   indexer.addDirectory(database, QString());
@@ -0,0 +1,117 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+
+// ctkCore includes
+#include "ctkUtils.h"
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMIndexer.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+
+int ctkDICOMIndexerTest2( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMIndexerTest2: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString dicomFilePath(argv[1]);
+
+  QString directory = QDir::tempPath() + "/ctkDICOMIndexerTest2";
+  ctk::removeDirRecursively(directory);
+  QDir().mkpath(directory + "/series");
+  QString copiedFilePath = directory + "/series/000055.IMA";
+  if (!QFile::copy(dicomFilePath, copiedFilePath))
+    {
+    std::cerr << "ctkDICOMIndexerTest2: failed to copy " << qPrintable(dicomFilePath)
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:");
+  ctkDICOMIndexer indexer;
+
+  //
+  // Test the incremental refresh:
+  // - new files are indexed and the directory fingerprints are stored
+  // - refreshing an unchanged directory changes nothing
+  // - deleted files are removed from the database
+  //
+  indexer.refreshDatabase(database, directory);
+  if (database.allFiles() != QStringList(copiedFilePath))
+    {
+    std::cerr << "ctkDICOMIndexer::refreshDatabase() failed to index new file"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QHash<QString, QString> fingerprints = database.directoryFingerprints(directory);
+  if (fingerprints.count() != 2
+      || !fingerprints.contains(directory)
+      || !fingerprints.contains(directory + "/series"))
+    {
+    std::cerr << "ctkDICOMIndexer::refreshDatabase() failed to store the fingerprints, got "
+              << fingerprints.count() << " fingerprints" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  indexer.refreshDatabase(database, directory);
+  if (database.allFiles() != QStringList(copiedFilePath)
+      || database.directoryFingerprints(directory) != fingerprints)
+    {
+    std::cerr << "ctkDICOMIndexer::refreshDatabase() modified an unchanged directory"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QFile::remove(copiedFilePath);
+  indexer.refreshDatabase(database, directory);
+  if (!database.allFiles().isEmpty())
+    {
+    std::cerr << "ctkDICOMIndexer::refreshDatabase() failed to remove deleted file"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctk::removeDirRecursively(directory);
+  indexer.refreshDatabase(database, directory);
+  if (!database.directoryFingerprints(directory).isEmpty())
+    {
+    std::cerr << "ctkDICOMIndexer::refreshDatabase() failed to remove deleted directories"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+// Qt includes
+#include <QCoreApplication>
+
+// ctkDICOMCore includes
+#include "ctkDICOMItem.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+int ctkDICOMItemTest2( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMItemTest2: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString dicomFilePath(argv[1]);
+  QString sopInstanceUID("1.2.840.113619.2.135.3596.6358736.4843.1115808177.83");
+
+  ctkDICOMItem item;
+  item.InitializeFromFile(dicomFilePath);
+  if (item.GetSOPInstanceUID() != sopInstanceUID)
+    {
+    std::cerr << "ctkDICOMItem::InitializeFromFile() failed: "
+              << qPrintable(item.GetSOPInstanceUID()) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Test reading from a memory-mapped file
+  //
+  ctkDICOMItem mappedItem;
+  if (!mappedItem.InitializeFromMappedFile(dicomFilePath)
+      || mappedItem.GetSOPInstanceUID() != sopInstanceUID
+      || mappedItem.SerializeToByteArray() != item.SerializeToByteArray())
+    {
+    std::cerr << "ctkDICOMItem::InitializeFromMappedFile() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMItem mappedHeaderItem;
+  if (!mappedHeaderItem.InitializeFromMappedFile(dicomFilePath, DCM_PixelData)
+      || mappedHeaderItem.GetSOPInstanceUID() != sopInstanceUID)
+    {
+    std::cerr << "ctkDICOMItem::InitializeFromMappedFile() failed to read the header" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMItem missingItem;
+  if (missingItem.InitializeFromMappedFile(dicomFilePath + ".missing"))
+    {
+    std::cerr << "ctkDICOMItem::InitializeFromMappedFile() should fail on a missing file" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Test the binary serialization round trip
+  //
+  QByteArray buffer = item.SerializeToByteArray();
+  if (buffer.isEmpty())
+    {
+    std::cerr << "ctkDICOMItem::SerializeToByteArray() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMItem deserializedItem;
+  if (!deserializedItem.InitializeFromByteArray(buffer)
+      || deserializedItem.GetSOPInstanceUID() != sopInstanceUID
+      || deserializedItem.SerializeToByteArray() != buffer)
+    {
+    std::cerr << "ctkDICOMItem::InitializeFromByteArray() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //
+  // Test the implicit sharing
+  //
+  ctkDICOMItem copiedItem(item);
+  ctkDICOMItem assignedItem;
+  assignedItem = item;
+  if (copiedItem.GetSOPInstanceUID() != sopInstanceUID
+      || assignedItem.GetSOPInstanceUID() != sopInstanceUID)
+    {
+    std::cerr << "ctkDICOMItem copy failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  copiedItem.SetElementAsString(DCM_SOPInstanceUID, "1.2.3");
+  if (copiedItem.GetSOPInstanceUID() != "1.2.3"
+      || item.GetSOPInstanceUID() != sopInstanceUID
+      || assignedItem.GetSOPInstanceUID() != sopInstanceUID)
+    {
+    std::cerr << "ctkDICOMItem failed to detach a modified copy" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -134,6 +134,50 @@ int ctkDICOMPersonNameTest1( int argc, char * argv [] )
     return EXIT_FAILURE;
     }
 
+  // test fromDicomValue(), with ideographic and phonetic representations
+  ctkDICOMPersonName dicomName = ctkDICOMPersonName::fromDicomValue(
+    QString::fromUtf8("Yamada^Tarou =\xe5\xb1\xb1\xe7\x94\xb0^\xe5\xa4\xaa\xe9\x83\x8e=\xe3\x82\x84\xe3\x81\xbe\xe3\x81\xa0^\xe3\x81\x9f\xe3\x82\x8d\xe3\x81\x86"));
+  if (dicomName.lastName() != "Yamada" ||
+      dicomName.firstName() != "Tarou" ||
+      !dicomName.middleName().isEmpty() ||
+      dicomName.ideographicName().lastName() != QString::fromUtf8("\xe5\xb1\xb1\xe7\x94\xb0") ||
+      dicomName.ideographicName().firstName() != QString::fromUtf8("\xe5\xa4\xaa\xe9\x83\x8e") ||
+      dicomName.phoneticName().lastName() != QString::fromUtf8("\xe3\x82\x84\xe3\x81\xbe\xe3\x81\xa0") ||
+      dicomName.formattedName() != "Yamada, Tarou")
+    {
+    std::cerr << "ctkDICOMPersonName::fromDicomValue() failed:"
+              << qPrintable(dicomName.formattedName()) << std::endl;
+    return EXIT_FAILURE;
+    }
+  dicomName = ctkDICOMPersonName::fromDicomValue("Adams^John Robert Quincy^^Rev.^B.A. M.Div.");
+  if (dicomName.lastName() != "Adams" ||
+      dicomName.firstName() != "John Robert Quincy" ||
+      !dicomName.middleName().isEmpty() ||
+      dicomName.namePrefix() != "Rev." ||
+      dicomName.nameSuffix() != "B.A. M.Div." ||
+      !dicomName.ideographicName().lastName().isEmpty())
+    {
+    std::cerr << "ctkDICOMPersonName::fromDicomValue() failed:"
+              << qPrintable(dicomName.formattedName()) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // test sortKey(), searchKey() and normalizedKey()
+  ctkDICOMPersonName accentedName = ctkDICOMPersonName::fromDicomValue(
+    QString::fromUtf8("M\xc3\xbcller^J\xc3\xa9r\xc3\xb4me"));
+  ctkDICOMPersonName longerName = ctkDICOMPersonName::fromDicomValue("MULLERS^Anna");
+  if (accentedName.sortKey() != ctkDICOMPersonName::fromDicomValue("muller^JEROME").sortKey() ||
+      !(accentedName.sortKey() < longerName.sortKey()) ||
+      accentedName.searchKey() != "jerome muller" ||
+      !dicomName.searchKey().contains(ctkDICOMPersonName::normalizedKey("QUINCY ADAMS")) ||
+      ctkDICOMPersonName::normalizedKey(QString::fromUtf8("J\xc3\xa9R\xc3\xb4ME")) != "jerome")
+    {
+    std::cerr << "ctkDICOMPersonName keys failed:"
+              << qPrintable(accentedName.sortKey()) << " "
+              << qPrintable(accentedName.searchKey()) << std::endl;
+    return EXIT_FAILURE;
+    }
+
   if (argc <= 1 || QString(argv[1]) != "-I")
     {
     QTimer::singleShot(200, &app, SLOT(quit()));
@@ -87,6 +87,37 @@ int ctkDICOMRetrieveTest1( int argc, char * argv [] )
     return EXIT_FAILURE;
     }
 
+  std::cerr << "Set Throttling\n";
+  retrieve.setMaximumBytesPerSecond(1000000);
+  retrieve.setMaximumAssociations(4);
+  if (retrieve.maximumBytesPerSecond() != 1000000 ||
+      retrieve.effectiveMaximumBytesPerSecond() != 1000000 ||
+      retrieve.effectiveMaximumAssociations() != 4)
+    {
+    std::cerr << "ctkDICOMRetrieve::setMaximumBytesPerSecond() failed: "
+              << retrieve.effectiveMaximumBytesPerSecond() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // a profile with the same start and end times covers the whole day
+  retrieve.addThrottleProfile(QTime(7, 0), QTime(7, 0), 1000, 1);
+  if (retrieve.effectiveMaximumBytesPerSecond() != 1000 ||
+      retrieve.effectiveMaximumAssociations() != 1)
+    {
+    std::cerr << "ctkDICOMRetrieve::addThrottleProfile() failed: "
+              << retrieve.effectiveMaximumBytesPerSecond() << " "
+              << retrieve.effectiveMaximumAssociations() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  retrieve.removeAllThrottleProfiles();
+  if (retrieve.effectiveMaximumBytesPerSecond() != 1000000)
+    {
+    std::cerr << "ctkDICOMRetrieve::removeAllThrottleProfiles() failed: "
+              << retrieve.effectiveMaximumBytesPerSecond() << std::endl;
+    return EXIT_FAILURE;
+    }
+
   std::cerr << "Set Database\n";
   QSharedPointer<ctkDICOMDatabase> dicomDatabase(new ctkDICOMDatabase);
   retrieve.setDatabase(dicomDatabase);
@@ -0,0 +1,127 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QFileInfo>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMSeriesPrefetcher.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+//------------------------------------------------------------------------------
+int ctkDICOMSeriesPrefetcherTest1( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMSeriesPrefetcherTest1: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString dicomFilePath(argv[1]);
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:");
+  database.insert(dicomFilePath, false, false);
+  QString seriesUID = database.seriesForFile(dicomFilePath);
+  if (seriesUID.isEmpty())
+    {
+    std::cerr << "ctkDICOMDatabase::insert() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMSeriesPrefetcher prefetcher;
+  if (prefetcher.prefetchSeries(seriesUID))
+    {
+    std::cerr << "ctkDICOMSeriesPrefetcher::prefetchSeries() should fail without database"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  prefetcher.setDatabase(&database);
+  if (prefetcher.prefetchSeries("1.2.3.4"))
+    {
+    std::cerr << "ctkDICOMSeriesPrefetcher::prefetchSeries() should fail for an unknown series"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!prefetcher.prefetchSeries(seriesUID, ctkDICOMSeriesPrefetcher::HoverHint))
+    {
+    std::cerr << "ctkDICOMSeriesPrefetcher::prefetchSeries() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  prefetcher.waitForDone();
+
+  qint64 fileSize = QFileInfo(dicomFilePath).size();
+  if (!prefetcher.isSeriesPrefetched(seriesUID) ||
+      prefetcher.prefetchedBytes() != fileSize)
+    {
+    std::cerr << "ctkDICOMSeriesPrefetcher: expected " << fileSize << " bytes prefetched, got "
+              << prefetcher.prefetchedBytes() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // already prefetched
+  if (prefetcher.prefetchSeries(seriesUID))
+    {
+    std::cerr << "ctkDICOMSeriesPrefetcher::prefetchSeries() should not load a series twice"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!prefetcher.seriesOpened(seriesUID) ||
+      prefetcher.seriesOpened("1.2.3.4") ||
+      prefetcher.hits() != 1 || prefetcher.misses() != 1 ||
+      prefetcher.hitRate() != 0.5)
+    {
+    std::cerr << "ctkDICOMSeriesPrefetcher: wrong statistics, " << prefetcher.hits()
+              << " hits and " << prefetcher.misses() << " misses" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the series budget limits the bytes loaded
+  prefetcher.clear();
+  prefetcher.setSeriesBudget(1024);
+  prefetcher.prefetchSeries(seriesUID);
+  prefetcher.waitForDone();
+  if (prefetcher.prefetchedBytes() != qMin(fileSize, Q_INT64_C(1024)))
+    {
+    std::cerr << "ctkDICOMSeriesPrefetcher::setSeriesBudget() failed, "
+              << prefetcher.prefetchedBytes() << " bytes prefetched" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  prefetcher.resetStatistics();
+  if (prefetcher.hits() != 0 || prefetcher.misses() != 0 || prefetcher.hitRate() != 0.)
+    {
+    std::cerr << "ctkDICOMSeriesPrefetcher::resetStatistics() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+
+// ctkDICOMCore includes
+#include "ctkDICOMStorageListener.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+//------------------------------------------------------------------------------
+int ctkDICOMStorageListenerTest1( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  ctkDICOMStorageListener listener;
+  if (listener.AETitle() != "CTKSTORESCP" ||
+      listener.port() != 11112 ||
+      listener.maximumAssociations() != 4 ||
+      listener.isListening() ||
+      listener.activeAssociations() != 0 ||
+      listener.receivedFiles() != 0 ||
+      !listener.pendingFiles().isEmpty())
+    {
+    std::cerr << "ctkDICOMStorageListener: wrong default values" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // no database and no storage directory
+  if (listener.start())
+    {
+    std::cerr << "ctkDICOMStorageListener::start() should fail without directory"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  listener.setMaximumAssociations(0);
+  if (listener.maximumAssociations() != 1)
+    {
+    std::cerr << "ctkDICOMStorageListener::setMaximumAssociations() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QString storageDirectory = QDir::tempPath() + "/ctkDICOMStorageListenerTest1";
+  listener.setStorageDirectory(storageDirectory);
+  listener.setPort(11123);
+  if (!listener.start())
+    {
+    std::cerr << "ctkDICOMStorageListener::start() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!listener.isListening() || !QDir(storageDirectory).exists())
+    {
+    std::cerr << "ctkDICOMStorageListener::start() should create the directory"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the properties can't be changed while listening
+  listener.setPort(11124);
+  if (listener.port() != 11123)
+    {
+    std::cerr << "ctkDICOMStorageListener::setPort() should be ignored" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  listener.stop();
+  if (listener.isListening())
+    {
+    std::cerr << "ctkDICOMStorageListener::stop() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the listener can be restarted
+  if (!listener.start())
+    {
+    std::cerr << "ctkDICOMStorageListener::start() failed after stop()" << std::endl;
+    return EXIT_FAILURE;
+    }
+  listener.stop();
+
+  QDir().rmdir(storageDirectory);
+  return EXIT_SUCCESS;
+}
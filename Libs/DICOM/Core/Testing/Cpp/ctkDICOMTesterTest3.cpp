@@ -0,0 +1,86 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVariant>
+
+// ctkDICOMCore includes
+#include "ctkDICOMTester.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+void ctkDICOMTesterTest3PrintUsage()
+{
+  std::cout << " ctkDICOMTesterTest3 images" << std::endl;
+}
+
+int ctkDICOMTesterTest3(int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+
+  QStringList arguments = app.arguments();
+  arguments.pop_front();
+  if (!arguments.count())
+    {
+    ctkDICOMTesterTest3PrintUsage();
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMTester tester;
+  if (!tester.generateLoad(arguments, 4, 20).isEmpty())
+    {
+    std::cout << "generateLoad() without dcmqrscp must fail" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  tester.startDCMQRSCP();
+
+  const int instanceCount = 20;
+  QVariantMap report = tester.generateLoad(arguments, 4, instanceCount, 2);
+  if (report["Instances"].toInt() != instanceCount ||
+      report["Failures"].toInt() != 0 ||
+      report["Associations"].toList().count() != 4 ||
+      report["ImagesPerSecond"].toDouble() <= 0.)
+    {
+    std::cout << "Can't generate load: " << report["Instances"].toInt() << " instances, "
+              << report["Failures"].toInt() << " failures" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  int associationInstances = 0;
+  foreach(const QVariant& association, report["Associations"].toList())
+    {
+    associationInstances += association.toMap()["Instances"].toInt();
+    }
+  if (associationInstances != instanceCount ||
+      report["LatencyMedianMs"].toLongLong() > report["LatencyMaxMs"].toLongLong())
+    {
+    std::cout << "Wrong per association report" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << report["ImagesPerSecond"].toDouble() << " images/s, p95 latency "
+            << report["LatencyP95Ms"].toLongLong() << " ms" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,375 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QMutexLocker>
+
+// ctkDICOM includes
+#include "ctkLogger.h"
+#include "ctkDICOMBackgroundIndexer.h"
+#include "ctkDICOMBackgroundIndexer_p.h"
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMIndexer.h"
+
+//------------------------------------------------------------------------------
+static ctkLogger logger("org.commontk.dicom.DICOMBackgroundIndexer" );
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// ctkDICOMBackgroundIndexerWorker methods
+
+//------------------------------------------------------------------------------
+ctkDICOMBackgroundIndexerWorker::ctkDICOMBackgroundIndexerWorker(ctkDICOMBackgroundIndexerPrivate* indexer)
+  : BackgroundIndexer(indexer)
+{
+  this->Indexer = new ctkDICOMIndexer(this);
+  connect(this->Indexer, SIGNAL(indexingComplete()), this, SIGNAL(indexingComplete()));
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMBackgroundIndexerWorker::~ctkDICOMBackgroundIndexerWorker()
+{
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMBackgroundIndexerWorker::openDatabase(const ctkDICOMBackgroundIndexerJob& job)
+{
+  if (this->Database && this->Database->isOpen()
+      && this->Database->databaseFilename() == job.DatabaseFile)
+    {
+    this->Database->setTagsToPrecache(job.TagsToPrecache);
+    this->Database->setThumbnailGenerator(job.ThumbnailGenerator);
+    return true;
+    }
+
+  this->shutdown();
+
+  this->Database.reset(new ctkDICOMDatabase);
+  this->Database->setWriteAheadLogging(job.WriteAheadLogging);
+  this->Database->setMemoryMappedIOSize(job.MemoryMappedIOSize);
+  this->Database->setPageCacheSize(job.PageCacheSize);
+  this->Database->setThumbnailGenerator(job.ThumbnailGenerator);
+
+  QString connectionName = QString("DICOM-DB-BackgroundIndexer-%1")
+    .arg(reinterpret_cast<quintptr>(this));
+  this->Database->openDatabase(job.DatabaseFile, connectionName);
+  if (!this->Database->isOpen())
+    {
+    logger.error("Unable to open " + job.DatabaseFile + ": " + this->Database->lastError());
+    this->Database.reset();
+    return false;
+    }
+  this->Database->setTagsToPrecache(job.TagsToPrecache);
+
+  connect(this->Database.data(), SIGNAL(patientAdded(int,QString,QString,QString)),
+          this, SLOT(onPatientAdded(int,QString,QString,QString)));
+  connect(this->Database.data(), SIGNAL(studyAdded(QString)), this, SLOT(onStudyAdded(QString)));
+  connect(this->Database.data(), SIGNAL(seriesAdded(QString)), this, SLOT(onSeriesAdded(QString)));
+  connect(this->Database.data(), SIGNAL(instanceAdded(QString)), this, SLOT(onInstanceAdded(QString)));
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexerWorker::processNextJob()
+{
+  ctkDICOMBackgroundIndexerJob job;
+  if (!this->BackgroundIndexer->takeNextJob(job))
+    {
+    return;
+    }
+
+  if (!this->BackgroundIndexer->isCanceled(job) && this->openDatabase(job))
+    {
+    this->LastNotificationTime.start();
+    this->Indexer->addDirectory(*this->Database, job.DirectoryName, job.DestinationDirectoryName);
+    this->flushNotifications(true);
+    }
+  else
+    {
+    // keep one indexingComplete per queued directory
+    emit indexingComplete();
+    }
+
+  this->BackgroundIndexer->jobDone();
+  emit jobFinished();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexerWorker::shutdown()
+{
+  if (this->Database)
+    {
+    this->Database->closeDatabase();
+    this->Database.reset();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexerWorker::flushNotifications(bool force)
+{
+  int interval;
+  {
+  QMutexLocker locker(&this->BackgroundIndexer->Mutex);
+  interval = this->BackgroundIndexer->NotificationInterval;
+  }
+  if (!force && this->LastNotificationTime.elapsed() < interval)
+    {
+    return;
+    }
+  this->LastNotificationTime.restart();
+
+  // Parents are reported before their children so that receivers can
+  // look them up when handling the children.
+  if (!this->PendingPatients.isEmpty())
+    {
+    emit patientsAdded(this->PendingPatients);
+    this->PendingPatients.clear();
+    }
+  if (!this->PendingStudies.isEmpty())
+    {
+    emit studiesAdded(this->PendingStudies);
+    this->PendingStudies.clear();
+    }
+  if (!this->PendingSeries.isEmpty())
+    {
+    emit seriesAdded(this->PendingSeries);
+    this->PendingSeries.clear();
+    }
+  if (!this->PendingInstances.isEmpty())
+    {
+    emit instancesAdded(this->PendingInstances);
+    this->PendingInstances.clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexerWorker::onPatientAdded(int, QString patientID, QString, QString)
+{
+  this->PendingPatients << patientID;
+  this->flushNotifications(false);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexerWorker::onStudyAdded(QString studyInstanceUID)
+{
+  this->PendingStudies << studyInstanceUID;
+  this->flushNotifications(false);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexerWorker::onSeriesAdded(QString seriesInstanceUID)
+{
+  this->PendingSeries << seriesInstanceUID;
+  this->flushNotifications(false);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexerWorker::onInstanceAdded(QString sopInstanceUID)
+{
+  this->PendingInstances << sopInstanceUID;
+  this->flushNotifications(false);
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMBackgroundIndexerPrivate methods
+
+//------------------------------------------------------------------------------
+ctkDICOMBackgroundIndexerPrivate::ctkDICOMBackgroundIndexerPrivate(ctkDICOMBackgroundIndexer& o)
+  : q_ptr(&o)
+  , Worker(0)
+  , PendingJobs(0)
+  , LastSequence(0)
+  , CanceledSequence(0)
+  , NotificationInterval(250)
+{
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMBackgroundIndexerPrivate::~ctkDICOMBackgroundIndexerPrivate()
+{
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMBackgroundIndexerPrivate::takeNextJob(ctkDICOMBackgroundIndexerJob& job)
+{
+  QMutexLocker locker(&this->Mutex);
+  if (this->Jobs.isEmpty())
+    {
+    return false;
+    }
+  job = this->Jobs.dequeue();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexerPrivate::jobDone()
+{
+  QMutexLocker locker(&this->Mutex);
+  --this->PendingJobs;
+  if (this->PendingJobs == 0)
+    {
+    this->AllJobsDone.wakeAll();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMBackgroundIndexerPrivate::isCanceled(const ctkDICOMBackgroundIndexerJob& job)
+{
+  QMutexLocker locker(&this->Mutex);
+  return job.Sequence <= this->CanceledSequence;
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMBackgroundIndexer methods
+
+//------------------------------------------------------------------------------
+ctkDICOMBackgroundIndexer::ctkDICOMBackgroundIndexer(QObject *parent)
+  : QObject(parent)
+  , d_ptr(new ctkDICOMBackgroundIndexerPrivate(*this))
+{
+  Q_D(ctkDICOMBackgroundIndexer);
+  d->Worker = new ctkDICOMBackgroundIndexerWorker(d);
+  d->Worker->moveToThread(&d->WorkerThread);
+
+  // Signals emitted from the worker thread are queued to this thread.
+  connect(d->Worker->Indexer, SIGNAL(foundFilesToIndex(int)), this, SIGNAL(foundFilesToIndex(int)));
+  connect(d->Worker->Indexer, SIGNAL(indexingFilePath(QString)), this, SIGNAL(indexingFilePath(QString)));
+  connect(d->Worker->Indexer, SIGNAL(progress(int)), this, SIGNAL(progress(int)));
+  connect(d->Worker, SIGNAL(indexingComplete()), this, SIGNAL(indexingComplete()));
+  connect(d->Worker, SIGNAL(patientsAdded(QStringList)), this, SIGNAL(patientsAdded(QStringList)));
+  connect(d->Worker, SIGNAL(studiesAdded(QStringList)), this, SIGNAL(studiesAdded(QStringList)));
+  connect(d->Worker, SIGNAL(seriesAdded(QStringList)), this, SIGNAL(seriesAdded(QStringList)));
+  connect(d->Worker, SIGNAL(instancesAdded(QStringList)), this, SIGNAL(instancesAdded(QStringList)));
+  connect(d->Worker, SIGNAL(jobFinished()), this, SLOT(onJobFinished()));
+
+  d->WorkerThread.start();
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMBackgroundIndexer::~ctkDICOMBackgroundIndexer()
+{
+  Q_D(ctkDICOMBackgroundIndexer);
+  this->cancel();
+  // The worker connection must be closed from the thread that opened it.
+  QMetaObject::invokeMethod(d->Worker, "shutdown", Qt::BlockingQueuedConnection);
+  d->WorkerThread.quit();
+  d->WorkerThread.wait();
+  delete d->Worker;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexer::setNotificationInterval(int msec)
+{
+  Q_D(ctkDICOMBackgroundIndexer);
+  QMutexLocker locker(&d->Mutex);
+  d->NotificationInterval = msec;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMBackgroundIndexer::notificationInterval()const
+{
+  Q_D(const ctkDICOMBackgroundIndexer);
+  QMutexLocker locker(&d->Mutex);
+  return d->NotificationInterval;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexer::setNumberOfParserThreads(int threadCount)
+{
+  Q_D(ctkDICOMBackgroundIndexer);
+  d->Worker->Indexer->setNumberOfParserThreads(threadCount);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMBackgroundIndexer::numberOfParserThreads()const
+{
+  Q_D(const ctkDICOMBackgroundIndexer);
+  return d->Worker->Indexer->numberOfParserThreads();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMBackgroundIndexer::isIndexing()const
+{
+  Q_D(const ctkDICOMBackgroundIndexer);
+  QMutexLocker locker(&d->Mutex);
+  return d->PendingJobs > 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexer::addDirectory(ctkDICOMDatabase& database,
+                                             const QString& directoryName,
+                                             const QString& destinationDirectoryName)
+{
+  Q_D(ctkDICOMBackgroundIndexer);
+  if (!database.isOpen() || database.isInMemory())
+    {
+    logger.error("Background indexing requires an opened database file.");
+    emit indexingComplete();
+    return;
+    }
+
+  ctkDICOMBackgroundIndexerJob job;
+  job.DatabaseFile = database.databaseFilename();
+  job.TagsToPrecache = database.tagsToPrecache();
+  job.WriteAheadLogging = database.writeAheadLogging();
+  job.MemoryMappedIOSize = database.memoryMappedIOSize();
+  job.PageCacheSize = database.pageCacheSize();
+  job.ThumbnailGenerator = database.thumbnailGenerator();
+  job.DirectoryName = directoryName;
+  job.DestinationDirectoryName = destinationDirectoryName;
+  {
+  QMutexLocker locker(&d->Mutex);
+  job.Sequence = ++d->LastSequence;
+  d->Jobs.enqueue(job);
+  ++d->PendingJobs;
+  }
+  QMetaObject::invokeMethod(d->Worker, "processNextJob", Qt::QueuedConnection);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexer::waitForImportFinished()
+{
+  Q_D(ctkDICOMBackgroundIndexer);
+  QMutexLocker locker(&d->Mutex);
+  while (d->PendingJobs > 0)
+    {
+    d->AllJobsDone.wait(&d->Mutex);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexer::cancel()
+{
+  Q_D(ctkDICOMBackgroundIndexer);
+  {
+  QMutexLocker locker(&d->Mutex);
+  d->CanceledSequence = d->LastSequence;
+  }
+  d->Worker->Indexer->cancel();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMBackgroundIndexer::onJobFinished()
+{
+  if (!this->isIndexing())
+    {
+    emit allIndexingComplete();
+    }
+}
@@ -0,0 +1,114 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMBackgroundIndexer_h
+#define __ctkDICOMBackgroundIndexer_h
+
+// Qt includes
+#include <QObject>
+#include <QStringList>
+
+#include "ctkDICOMCoreExport.h"
+
+class ctkDICOMBackgroundIndexerPrivate;
+class ctkDICOMDatabase;
+
+/// \ingroup DICOM_Core
+///
+/// \brief Indexes DICOM directories into a database on a worker thread.
+///
+/// The worker thread opens its own connection to the database file used
+/// by the database given to addDirectory(), so that the thread owning
+/// that database (typically the GUI thread) keeps running while the files
+/// are being imported. Directories are imported one after the other in
+/// the order they were queued.
+///
+/// Because the database object given to addDirectory() does not see the
+/// inserts made by the worker, the added patients, studies, series and
+/// instances are reported by the signals of this class. These signals are
+/// batched and emitted at most once every notificationInterval()
+/// milliseconds.
+///
+class CTK_DICOM_CORE_EXPORT ctkDICOMBackgroundIndexer : public QObject
+{
+  Q_OBJECT
+  Q_PROPERTY(int notificationInterval READ notificationInterval WRITE setNotificationInterval)
+  Q_PROPERTY(bool isIndexing READ isIndexing)
+
+public:
+  explicit ctkDICOMBackgroundIndexer(QObject *parent = 0);
+  virtual ~ctkDICOMBackgroundIndexer();
+
+  /// Minimum time in milliseconds between two emissions of the
+  /// patientsAdded, studiesAdded, seriesAdded and instancesAdded signals.
+  /// Default is 250ms.
+  void setNotificationInterval(int msec);
+  int notificationInterval()const;
+
+  /// See ctkDICOMIndexer::setNumberOfParserThreads
+  void setNumberOfParserThreads(int threadCount);
+  int numberOfParserThreads()const;
+
+  /// Returns true while there are queued or running imports.
+  bool isIndexing()const;
+
+  /// Queue the import of directoryName into the database file of
+  /// database, optionally copying the files to destinationDirectoryName.
+  /// The tags to precache and the SQLite options of database are used by
+  /// the worker connection. The method returns immediately.
+  Q_INVOKABLE void addDirectory(ctkDICOMDatabase& database, const QString& directoryName,
+                    const QString& destinationDirectoryName = "");
+
+  /// Block until all the queued imports are done.
+  Q_INVOKABLE void waitForImportFinished();
+
+Q_SIGNALS:
+  /// Forwarded from the worker ctkDICOMIndexer.
+  void foundFilesToIndex(int);
+  void indexingFilePath(QString);
+  void progress(int);
+  /// Emitted when an import is done. Imports are done in the order
+  /// they were queued.
+  void indexingComplete();
+  /// Emitted when all the queued imports are done.
+  void allIndexingComplete();
+
+  /// Batched notifications of the items inserted by the worker.
+  void patientsAdded(QStringList patientIDs);
+  void studiesAdded(QStringList studyInstanceUIDs);
+  void seriesAdded(QStringList seriesInstanceUIDs);
+  void instancesAdded(QStringList sopInstanceUIDs);
+
+public Q_SLOTS:
+  /// Cancel the running import and the queued ones.
+  void cancel();
+
+protected Q_SLOTS:
+  void onJobFinished();
+
+protected:
+  QScopedPointer<ctkDICOMBackgroundIndexerPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDICOMBackgroundIndexer);
+  Q_DISABLE_COPY(ctkDICOMBackgroundIndexer);
+};
+
+#endif
@@ -0,0 +1,141 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef CTKDICOMBACKGROUNDINDEXERPRIVATE_H
+#define CTKDICOMBACKGROUNDINDEXERPRIVATE_H
+
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QScopedPointer>
+#include <QThread>
+#include <QTime>
+#include <QWaitCondition>
+
+#include "ctkDICOMBackgroundIndexer.h"
+
+class ctkDICOMAbstractThumbnailGenerator;
+class ctkDICOMDatabase;
+class ctkDICOMIndexer;
+
+//------------------------------------------------------------------------------
+/// An import queued by ctkDICOMBackgroundIndexer::addDirectory().
+/// The database settings are copied from the database given by the caller
+/// so that the worker connection behaves the same way.
+struct ctkDICOMBackgroundIndexerJob
+{
+  int Sequence;
+  QString DatabaseFile;
+  QStringList TagsToPrecache;
+  bool WriteAheadLogging;
+  qint64 MemoryMappedIOSize;
+  int PageCacheSize;
+  ctkDICOMAbstractThumbnailGenerator* ThumbnailGenerator;
+  QString DirectoryName;
+  QString DestinationDirectoryName;
+};
+
+class ctkDICOMBackgroundIndexerPrivate;
+
+//------------------------------------------------------------------------------
+/// Lives in the worker thread, owns the worker database connection and
+/// runs the queued imports.
+class ctkDICOMBackgroundIndexerWorker : public QObject
+{
+  Q_OBJECT
+
+public:
+  ctkDICOMBackgroundIndexerWorker(ctkDICOMBackgroundIndexerPrivate* indexer);
+  virtual ~ctkDICOMBackgroundIndexerWorker();
+
+  /// Created as a child so that it moves to the worker thread with us.
+  ctkDICOMIndexer* Indexer;
+
+public Q_SLOTS:
+  /// Run the next queued job.
+  void processNextJob();
+  /// Close the worker connection. Must run in the worker thread.
+  void shutdown();
+
+protected Q_SLOTS:
+  void onPatientAdded(int, QString patientID, QString, QString);
+  void onStudyAdded(QString studyInstanceUID);
+  void onSeriesAdded(QString seriesInstanceUID);
+  void onInstanceAdded(QString sopInstanceUID);
+
+Q_SIGNALS:
+  void patientsAdded(QStringList patientIDs);
+  void studiesAdded(QStringList studyInstanceUIDs);
+  void seriesAdded(QStringList seriesInstanceUIDs);
+  void instancesAdded(QStringList sopInstanceUIDs);
+  void indexingComplete();
+  void jobFinished();
+
+protected:
+  /// Open (or reuse) the worker connection to the database of job.
+  bool openDatabase(const ctkDICOMBackgroundIndexerJob& job);
+  /// Emit the pending notifications if notificationInterval elapsed,
+  /// or unconditionally if force is true.
+  void flushNotifications(bool force);
+
+  ctkDICOMBackgroundIndexerPrivate* const BackgroundIndexer;
+  QScopedPointer<ctkDICOMDatabase> Database;
+
+  QStringList PendingPatients;
+  QStringList PendingStudies;
+  QStringList PendingSeries;
+  QStringList PendingInstances;
+  QTime LastNotificationTime;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMBackgroundIndexerPrivate
+{
+  Q_DECLARE_PUBLIC(ctkDICOMBackgroundIndexer);
+
+protected:
+  ctkDICOMBackgroundIndexer* const q_ptr;
+
+public:
+  ctkDICOMBackgroundIndexerPrivate(ctkDICOMBackgroundIndexer&);
+  ~ctkDICOMBackgroundIndexerPrivate();
+
+  /// Called from the worker thread. Returns false if there is no job left.
+  bool takeNextJob(ctkDICOMBackgroundIndexerJob& job);
+  /// Called from the worker thread when a job is done.
+  void jobDone();
+  /// Returns true if the job has been canceled before it started.
+  bool isCanceled(const ctkDICOMBackgroundIndexerJob& job);
+
+  QThread WorkerThread;
+  ctkDICOMBackgroundIndexerWorker* Worker;
+
+  /// Protects the members below, which are shared with the worker thread.
+  mutable QMutex Mutex;
+  QWaitCondition AllJobsDone;
+  QQueue<ctkDICOMBackgroundIndexerJob> Jobs;
+  int PendingJobs;
+  int LastSequence;
+  /// Jobs with a sequence up to this one are canceled.
+  int CanceledSequence;
+  int NotificationInterval;
+};
+
+#endif // CTKDICOMBACKGROUNDINDEXERPRIVATE_H
@@ -21,22 +21,39 @@
 #include <stdexcept>
 
 // Qt includes
+#include <QCache>
+#include <QDataStream>
 #include <QDate>
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QFileSystemWatcher>
+#include <QHash>
+#include <QIODevice>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QRunnable>
 #include <QSet>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QTime>
 #include <QVariant>
+#include <QVector>
+#if QT_VERSION >= 0x040800
+# include <QElapsedTimer>
+#endif
 
 // ctkDICOM includes
 #include "ctkDICOMDatabase.h"
 #include "ctkDICOMAbstractThumbnailGenerator.h"
 #include "ctkDICOMItem.h"
+#include "ctkDICOMOperationToken.h"
+#include "ctkDICOMThumbnailQueue.h"
 
 #include "ctkLogger.h"
 
@@ -67,6 +84,86 @@ static QString TagNotInInstance("__TAG_NOT_IN_INSTANCE__");
 // really is the empty string
 static QString ValueIsEmptyString("__VALUE_IS_EMPTY_STRING__");
 
+//------------------------------------------------------------------------------
+/// Bounded, thread-safe, least recently used cache of the tag values
+/// stored in the tag cache database, keyed by (SOPInstanceUID, tag).
+class ctkDICOMTagValueCache
+{
+public:
+  ctkDICOMTagValueCache() : Hits(0), Misses(0)
+  {
+    this->Cache.setMaxCost(100000);
+  }
+
+  bool find(const QString& sopInstanceUID, const QString& tag, QString& value)
+  {
+    QMutexLocker locker(&this->Mutex);
+    QString* cachedValue = this->Cache.object(key(sopInstanceUID, tag));
+    if (!cachedValue)
+      {
+      ++this->Misses;
+      return false;
+      }
+    ++this->Hits;
+    value = *cachedValue;
+    return true;
+  }
+
+  void insert(const QString& sopInstanceUID, const QString& tag, const QString& value)
+  {
+    QMutexLocker locker(&this->Mutex);
+    this->Cache.insert(key(sopInstanceUID, tag), new QString(value));
+  }
+
+  void clear()
+  {
+    QMutexLocker locker(&this->Mutex);
+    this->Cache.clear();
+  }
+
+  void setMaximumSize(int entryCount)
+  {
+    QMutexLocker locker(&this->Mutex);
+    this->Cache.setMaxCost(entryCount);
+  }
+
+  int maximumSize()const
+  {
+    QMutexLocker locker(&this->Mutex);
+    return this->Cache.maxCost();
+  }
+
+  int hits()const
+  {
+    QMutexLocker locker(&this->Mutex);
+    return this->Hits;
+  }
+
+  int misses()const
+  {
+    QMutexLocker locker(&this->Mutex);
+    return this->Misses;
+  }
+
+  void resetStatistics()
+  {
+    QMutexLocker locker(&this->Mutex);
+    this->Hits = 0;
+    this->Misses = 0;
+  }
+
+private:
+  static QString key(const QString& sopInstanceUID, const QString& tag)
+  {
+    return sopInstanceUID + QLatin1Char('|') + tag;
+  }
+
+  mutable QMutex Mutex;
+  QCache<QString, QString> Cache;
+  int Hits;
+  int Misses;
+};
+
 //------------------------------------------------------------------------------
 class ctkDICOMDatabasePrivate
 {
@@ -94,6 +191,31 @@ public:
   void beginTransaction();
   void endTransaction();
 
+  ///
+  /// \brief bulk insert session, see ctkDICOMDatabase::beginBulkInsert()
+  ///
+  /// Returns a prepared query for \a sql. During a bulk insert session the
+  /// query is prepared only once and then shared by all the inserts.
+  QSqlQuery preparedQuery(const QString& sql);
+  /// Called after each inserted instance, commits the pending bulk insert
+  /// transaction when it is large or old enough.
+  void bulkInsertInstanceDone();
+  void beginBulkInsertTransaction();
+  void commitBulkInsertTransaction();
+  /// Roll back the pending bulk insert transaction and reload the
+  /// in-memory state that the rolled back inserts updated.
+  void rollbackBulkInsertTransaction();
+  /// Roll back a canceled cleanup() and reload the known UIDs it removed.
+  bool rollbackCleanup(QSqlQuery& query);
+  int BulkInsertDepth;
+  /// abortBulkInsert() was called, the session is rolled back
+  bool BulkInsertAborted;
+  int BulkInsertTransactionSize;
+  int BulkInsertCommitInterval;
+  int BulkInsertPendingInstances;
+  QTime BulkInsertTransactionTime;
+  QMap<QString, QSqlQuery> PreparedQueries;
+
   // dataset must be set always
   // filePath has to be set if this is an import of an actual file
   void insert ( const ctkDICOMItem& ctkDataset, const QString& filePath, bool storeFile = true, bool generateThumbnail = true);
@@ -116,10 +238,34 @@ public:
   /// Name of the database file (i.e. for SQLITE the sqlite file)
   QString      DatabaseFileName;
   QString      LastError;
+  /// see ctkDICOMDatabase::setOperationToken()
+  QPointer<ctkDICOMOperationToken> OperationToken;
+  bool isOperationCanceled()const;
   QSqlDatabase Database;
   QMap<QString, QString> LoadedHeader;
 
+  /// SQLite tuning applied by openDatabase()
+  bool WriteAheadLogging;
+  qint64 MemoryMappedIOSize;
+  int PageCacheSize;
+  /// apply the SQLite tuning options to \a database
+  void configureConnection(QSqlDatabase& database, bool inMemory, bool readOnly = false);
+
+  /// read-only connections of the threads, see readerConnection()
+  QMutex ReaderConnectionsMutex;
+  QHash<QThread*, QString> ReaderConnections;
+  int ReaderConnectionCount;
+  /// the schema of the file has been checked by a reader connection
+  bool ReaderSchemaVerified;
+  void removeReaderConnections();
+
   ctkDICOMAbstractThumbnailGenerator* thumbnailGenerator;
+  /// thumbnails are generated outside of insert()
+  ctkDICOMThumbnailQueue ThumbnailQueue;
+  /// series whose representative thumbnail has been queued
+  QSet<QString> SeriesWithThumbnail;
+  QString thumbnailPath(const QString& studyInstanceUID, const QString& seriesInstanceUID,
+                        const QString& sopInstanceUID);
 
   /// these are for optimizing the import of image sequences
   /// since most information are identical for all slices
@@ -133,6 +279,17 @@ public:
   /// resets the variables to new inserts won't be fooled by leftover values
   void resetLastInsertedValues();
 
+  /// Patients (by PatientID and PatientsName), studies and series known to
+  /// be in the database, so that inserting files that are not sorted by
+  /// series does not look them up in the database for each file.
+  /// Loaded when the database is opened, kept current by the inserts and
+  /// by cleanup(). A UID that is not in the cache is still looked up, it
+  /// may have been inserted through another connection.
+  QHash<QPair<QString, QString>, int> KnownPatients;
+  QSet<QString> KnownStudies;
+  QSet<QString> KnownSeries;
+  void loadKnownUIDs();
+
   /// tagCache table has been checked to exist
   bool TagCacheVerified;
   /// tag cache has independent database to avoid locking issue
@@ -140,12 +297,163 @@ public:
   /// reading while the tag cache is writing
   QSqlDatabase TagCacheDatabase;
   QString TagCacheDatabaseFilename;
+  /// in-memory cache in front of TagCacheDatabase
+  ctkDICOMTagValueCache TagValueCache;
   QStringList TagsToPrecache;
-  void precacheTags( const QString sopInstanceUID );
+  /// Cache the TagsToPrecache values of an instance being inserted.
+  /// During a bulk insert the values are only written into the tag cache
+  /// when the bulk insert transaction is committed.
+  void precacheTags( const ctkDICOMItem& dataset, const QString sopInstanceUID );
+  /// The dataset being inserted only has the DICOMDIR attributes, the
+  /// missing tags must not be cached as missing from the instance.
+  bool InsertingDirectoryRecord;
+  /// Write the pending precached values into the tag cache.
+  void flushPrecachedTags();
+  QStringList PrecachedSOPInstanceUIDs;
+  QStringList PrecachedTags;
+  QStringList PrecachedValues;
+
+  /// Load into TagValueCache the values of tags cached for the instances,
+  /// with one query per chunk of instances.
+  void fetchCachedTags( const QStringList& sopInstanceUIDs, const QStringList& tags );
+  /// Return the values of the tags at \a indexes of \a tagKeys, parsing
+  /// the file only once and only up to the last of them.
+  static QStringList readFileValues( const QString& fileName,
+                                     const QList<DcmTagKey>& tagKeys,
+                                     const QList<int>& indexes );
+  /// Return the values of the instance that are in the tag cache. The
+  /// indexes of the tags missing from the cache are added to \a missing.
+  QStringList cachedTags( const QString& sopInstanceUID, const QStringList& tags,
+                          QList<int>& missing );
+  /// Write values into the tag cache in one transaction
+  void cacheTagValues( const QStringList& sopInstanceUIDs, const QStringList& tags,
+                       const QStringList& values );
+
+  /// Maintain the aggregates of the Series and Studies tables
+  /// (see ctkDICOMDatabase::instanceCountForSeries())
+  void addInstanceToAggregates(const QString& seriesInstanceUID, const QString& studyInstanceUID,
+                               qint64 fileSize, const QDateTime& insertTimestamp);
+  void addSeriesToAggregates(const QString& studyInstanceUID, const QString& modality);
+  /// Recompute the aggregates once instances have been removed
+  void updateSeriesAggregates(const QString& seriesInstanceUID);
+  void updateStudyAggregates(const QString& studyInstanceUID);
+
+  /// Fill the temporary RemovalKeys table with keys, in the current
+  /// transaction, for the set-based statements of the batch removals.
+  bool setRemovalKeys(const QStringList& keys);
+  /// Query the values of the first column of sql, run after setRemovalKeys
+  QStringList selectForRemovalKeys(const QString& sql);
+  /// Delete the files on FileRemovalPool
+  void removeFilesInBackground(const QStringList& filePaths);
+  void incrementalVacuum();
+  QThreadPool FileRemovalPool;
 
   int insertPatient(const ctkDICOMItem& ctkDataset);
   void insertStudy(const ctkDICOMItem& ctkDataset, int dbPatientID);
   void insertSeries( const ctkDICOMItem& ctkDataset, QString studyInstanceUID);
+
+  /// Insert statistics, see ctkDICOMDatabase::statistics()
+  bool StatisticsEnabled;
+  int StatisticsLogInterval;
+  /// Protects the counters below, the parse phase is added from the
+  /// threads parsing the files.
+  mutable QMutex StatisticsMutex;
+  int StatisticsCounts[ctkDICOMDatabase::InsertPhaseCount];
+  qint64 StatisticsNanoseconds[ctkDICOMDatabase::InsertPhaseCount];
+  int StatisticsInsertedInstances;
+  QTime StatisticsLogTime;
+  void addPhaseTime(int phase, qint64 nanoseconds);
+  void resetStatistics();
+  /// Called after each insert, logs the statistics every
+  /// StatisticsLogInterval seconds.
+  void logStatisticsIfNeeded();
+};
+
+//------------------------------------------------------------------------------
+/// Names of the phases in ctkDICOMDatabase::statistics()
+static const char* ctkDICOMInsertPhaseNames[ctkDICOMDatabase::InsertPhaseCount] =
+{
+  "parse",
+  "instanceCheck",
+  "patient",
+  "study",
+  "series",
+  "image",
+  "fileCopy",
+  "precache",
+  "thumbnail",
+  "commit"
+};
+
+//------------------------------------------------------------------------------
+/// Times a phase of the insert, from its construction to stop() or its
+/// destruction, if the statistics are enabled.
+class ctkDICOMInsertPhaseTimer
+{
+public:
+  ctkDICOMInsertPhaseTimer(ctkDICOMDatabasePrivate* database, ctkDICOMDatabase::InsertPhase phase)
+    : Database(database->StatisticsEnabled ? database : 0)
+    , Phase(phase)
+  {
+    if (this->Database)
+      {
+      this->Timer.start();
+      }
+  }
+
+  ~ctkDICOMInsertPhaseTimer()
+  {
+    this->stop();
+  }
+
+  void stop()
+  {
+    if (!this->Database)
+      {
+      return;
+      }
+#if QT_VERSION >= 0x040800
+    this->Database->addPhaseTime(this->Phase, this->Timer.nsecsElapsed());
+#else
+    this->Database->addPhaseTime(this->Phase, static_cast<qint64>(this->Timer.elapsed()) * 1000000);
+#endif
+    this->Database = 0;
+  }
+
+private:
+  ctkDICOMDatabasePrivate* Database;
+  ctkDICOMDatabase::InsertPhase Phase;
+#if QT_VERSION >= 0x040800
+  QElapsedTimer Timer;
+#else
+  QTime Timer;
+#endif
+};
+
+//------------------------------------------------------------------------------
+/// Deletes files removed from the database, outside of the thread writing
+/// into the database.
+class ctkDICOMFileRemovalTask : public QRunnable
+{
+public:
+  ctkDICOMFileRemovalTask(const QStringList& filePaths)
+    : FilePaths(filePaths)
+  {
+  }
+
+  virtual void run()
+  {
+    foreach(const QString& filePath, this->FilePaths)
+      {
+      if (QFile::exists(filePath) && !QFile::remove(filePath))
+        {
+        logger.warn("Failed to remove file " + filePath);
+        }
+      }
+  }
+
+private:
+  QStringList FilePaths;
 };
 
 //------------------------------------------------------------------------------
@@ -157,7 +465,79 @@ ctkDICOMDatabasePrivate::ctkDICOMDatabasePrivate(ctkDICOMDatabase& o): q_ptr(&o)
   this->thumbnailGenerator = NULL;
   this->LoggedExecVerbose = false;
   this->TagCacheVerified = false;
+  this->WriteAheadLogging = false;
+  this->MemoryMappedIOSize = 0;
+  this->PageCacheSize = 0;
+  this->BulkInsertDepth = 0;
+  this->BulkInsertAborted = false;
+  this->BulkInsertTransactionSize = 100;
+  this->BulkInsertCommitInterval = 1000;
+  this->BulkInsertPendingInstances = 0;
+  this->ReaderConnectionCount = 0;
+  this->ReaderSchemaVerified = false;
+  this->InsertingDirectoryRecord = false;
+  this->FileRemovalPool.setMaxThreadCount(1);
   this->resetLastInsertedValues();
+  // the statistics can be enabled without changing the application
+  QByteArray statisticsVariable = qgetenv("CTK_DICOM_DATABASE_STATISTICS");
+  this->StatisticsEnabled = !statisticsVariable.isEmpty();
+  this->StatisticsLogInterval = qMax(0, statisticsVariable.toInt());
+  this->resetStatistics();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::addPhaseTime(int phase, qint64 nanoseconds)
+{
+  QMutexLocker locker(&this->StatisticsMutex);
+  ++this->StatisticsCounts[phase];
+  this->StatisticsNanoseconds[phase] += nanoseconds;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::resetStatistics()
+{
+  QMutexLocker locker(&this->StatisticsMutex);
+  for (int phase = 0; phase < ctkDICOMDatabase::InsertPhaseCount; ++phase)
+    {
+    this->StatisticsCounts[phase] = 0;
+    this->StatisticsNanoseconds[phase] = 0;
+    }
+  this->StatisticsInsertedInstances = 0;
+  this->StatisticsLogTime.start();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::logStatisticsIfNeeded()
+{
+  if (!this->StatisticsEnabled || this->StatisticsLogInterval <= 0 ||
+      this->StatisticsLogTime.elapsed() < this->StatisticsLogInterval * 1000)
+    {
+    return;
+    }
+  this->StatisticsLogTime.start();
+  QStringList phases;
+  QMutexLocker locker(&this->StatisticsMutex);
+  for (int phase = 0; phase < ctkDICOMDatabase::InsertPhaseCount; ++phase)
+    {
+    if (this->StatisticsCounts[phase])
+      {
+      phases << QString("%1 %2 s (%3)").arg(ctkDICOMInsertPhaseNames[phase])
+        .arg(this->StatisticsNanoseconds[phase] / 1e9, 0, 'f', 3)
+        .arg(this->StatisticsCounts[phase]);
+      }
+    }
+  logger.info(QString("Insert statistics: %1 instances, ").arg(this->StatisticsInsertedInstances)
+              + phases.join(", "));
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMDatabasePrivate::thumbnailPath(const QString& studyInstanceUID,
+                                               const QString& seriesInstanceUID,
+                                               const QString& sopInstanceUID)
+{
+  Q_Q(ctkDICOMDatabase);
+  return q->databaseDirectory() + "/thumbs/" + studyInstanceUID + "/"
+    + seriesInstanceUID + "/" + sopInstanceUID + ".png";
 }
 
 //------------------------------------------------------------------------------
@@ -171,6 +551,44 @@ void ctkDICOMDatabasePrivate::resetLastInsertedValues()
   this->LastPatientUID = -1;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::loadKnownUIDs()
+{
+  this->KnownPatients.clear();
+  this->KnownStudies.clear();
+  this->KnownSeries.clear();
+  if (!this->Database.isOpen())
+    {
+    return;
+    }
+  // the tables don't exist until the database is initialized,
+  // the queries fail silently then
+  QSqlQuery query(this->Database);
+  query.setForwardOnly(true);
+  if (query.exec("SELECT UID, PatientID, PatientsName FROM Patients"))
+    {
+    while (query.next())
+      {
+      this->KnownPatients.insert(
+        qMakePair(query.value(1).toString(), query.value(2).toString()), query.value(0).toInt());
+      }
+    }
+  if (query.exec("SELECT StudyInstanceUID FROM Studies"))
+    {
+    while (query.next())
+      {
+      this->KnownStudies.insert(query.value(0).toString());
+      }
+    }
+  if (query.exec("SELECT SeriesInstanceUID FROM Series"))
+    {
+    while (query.next())
+      {
+      this->KnownSeries.insert(query.value(0).toString());
+      }
+    }
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMDatabasePrivate::init(QString databaseFilename)
 {
@@ -197,6 +615,83 @@ void ctkDICOMDatabasePrivate::registerCompressionLibraries(){
 //------------------------------------------------------------------------------
 ctkDICOMDatabasePrivate::~ctkDICOMDatabasePrivate()
 {
+  this->removeReaderConnections();
+  this->FileRemovalPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabasePrivate::setRemovalKeys(const QStringList& keys)
+{
+  QSqlQuery query(this->Database);
+  if (!this->loggedExec(query, "CREATE TEMP TABLE IF NOT EXISTS RemovalKeys ( 'Key' VARCHAR(64) PRIMARY KEY )")
+      || !this->loggedExec(query, "DELETE FROM temp.RemovalKeys"))
+    {
+    return false;
+    }
+  QSqlQuery insertKey(this->Database);
+  insertKey.prepare("INSERT OR IGNORE INTO temp.RemovalKeys ( 'Key' ) VALUES ( ? )");
+  foreach(const QString& key, keys)
+    {
+    insertKey.bindValue(0, key);
+    if (!this->loggedExec(insertKey))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+QStringList ctkDICOMDatabasePrivate::selectForRemovalKeys(const QString& sql)
+{
+  QStringList values;
+  QSqlQuery query(this->Database);
+  if (this->loggedExec(query, sql))
+    {
+    while (query.next())
+      {
+      values << query.value(0).toString();
+      }
+    }
+  return values;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::removeFilesInBackground(const QStringList& filePaths)
+{
+  if (!filePaths.isEmpty())
+    {
+    this->FileRemovalPool.start(new ctkDICOMFileRemovalTask(filePaths));
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::incrementalVacuum()
+{
+  QSqlQuery query(this->Database);
+  // 2 is INCREMENTAL, it can only be set before the tables are created
+  if (this->loggedExec(query, "PRAGMA auto_vacuum") && query.next()
+      && query.value(0).toInt() == 2)
+    {
+    query.finish();
+    this->loggedExec(query, "PRAGMA incremental_vacuum");
+    }
+  else
+    {
+    logger.warn("The database does not use auto_vacuum = INCREMENTAL, run VACUUM to reclaim the free pages");
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::removeReaderConnections()
+{
+  QMutexLocker locker(&this->ReaderConnectionsMutex);
+  foreach(const QString& connectionName, this->ReaderConnections)
+    {
+    QSqlDatabase::removeDatabase(connectionName);
+    }
+  this->ReaderConnections.clear();
+  this->ReaderSchemaVerified = false;
 }
 
 //------------------------------------------------------------------------------
@@ -270,12 +765,155 @@ void ctkDICOMDatabasePrivate::endTransaction()
   transaction.exec();
 }
 
+//------------------------------------------------------------------------------
+QSqlQuery ctkDICOMDatabasePrivate::preparedQuery(const QString& sql)
+{
+  if (this->BulkInsertDepth == 0)
+    {
+    QSqlQuery query(this->Database);
+    query.prepare(sql);
+    return query;
+    }
+  QMap<QString, QSqlQuery>::iterator it = this->PreparedQueries.find(sql);
+  if (it == this->PreparedQueries.end())
+    {
+    QSqlQuery query(this->Database);
+    query.prepare(sql);
+    it = this->PreparedQueries.insert(sql, query);
+    }
+  return it.value();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::beginBulkInsertTransaction()
+{
+  this->Database.transaction();
+  if (this->TagCacheDatabase.isOpen())
+    {
+    this->TagCacheDatabase.transaction();
+    }
+  this->BulkInsertPendingInstances = 0;
+  this->BulkInsertTransactionTime.start();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::commitBulkInsertTransaction()
+{
+  {
+  ctkDICOMInsertPhaseTimer precacheTimer(this, ctkDICOMDatabase::PrecachePhase);
+  this->flushPrecachedTags();
+  }
+  ctkDICOMInsertPhaseTimer commitTimer(this, ctkDICOMDatabase::CommitPhase);
+  // active SELECT statements would keep the transaction open
+  foreach(QSqlQuery query, this->PreparedQueries)
+    {
+    query.finish();
+    }
+  if (!this->Database.commit())
+    {
+    logger.error("SQLITE ERROR committing bulk insert: " + this->Database.lastError().text());
+    }
+  if (this->TagCacheDatabase.isOpen())
+    {
+    this->TagCacheDatabase.commit();
+    }
+  this->BulkInsertPendingInstances = 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::rollbackBulkInsertTransaction()
+{
+  foreach(QSqlQuery query, this->PreparedQueries)
+    {
+    query.finish();
+    }
+  if (!this->Database.rollback())
+    {
+    logger.error("SQLITE ERROR rolling back bulk insert: " + this->Database.lastError().text());
+    }
+  if (this->TagCacheDatabase.isOpen())
+    {
+    this->TagCacheDatabase.rollback();
+    }
+  this->PrecachedSOPInstanceUIDs.clear();
+  this->PrecachedTags.clear();
+  this->PrecachedValues.clear();
+  this->BulkInsertPendingInstances = 0;
+  // the caches may reference patients, studies and series rolled back
+  this->SeriesWithThumbnail.clear();
+  this->resetLastInsertedValues();
+  this->loadKnownUIDs();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabasePrivate::rollbackCleanup(QSqlQuery& query)
+{
+  query.finish();
+  this->Database.rollback();
+  this->loadKnownUIDs();
+  logger.warn("Cleanup canceled");
+  return false;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabasePrivate::isOperationCanceled()const
+{
+  return this->OperationToken && this->OperationToken->isCanceled();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::bulkInsertInstanceDone()
+{
+  if (this->BulkInsertDepth == 0 || this->BulkInsertAborted)
+    {
+    return;
+    }
+  ++this->BulkInsertPendingInstances;
+  if (this->BulkInsertPendingInstances >= this->BulkInsertTransactionSize ||
+      this->BulkInsertTransactionTime.elapsed() >= this->BulkInsertCommitInterval)
+    {
+    this->commitBulkInsertTransaction();
+    this->beginBulkInsertTransaction();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::configureConnection(QSqlDatabase& database, bool inMemory, bool readOnly)
+{
+  QSqlQuery pragmaQuery(database);
+  if (!readOnly)
+    {
+    // Disable synchronous writing to make modifications faster
+    pragmaQuery.exec("PRAGMA synchronous = OFF");
+    }
+  // the journal mode is stored in the file, readers don't need to set it
+  if (this->WriteAheadLogging && !inMemory && !readOnly)
+    {
+    // readers are not blocked by a writer anymore
+    if (!pragmaQuery.exec("PRAGMA journal_mode = WAL"))
+      {
+      logger.warn("Could not enable write-ahead logging: " + pragmaQuery.lastError().text());
+      }
+    }
+  if (this->MemoryMappedIOSize > 0 && !inMemory)
+    {
+    pragmaQuery.exec(QString("PRAGMA mmap_size = %1").arg(this->MemoryMappedIOSize));
+    }
+  if (this->PageCacheSize > 0)
+    {
+    // a negative value is a size in KiB rather than a number of pages
+    pragmaQuery.exec(QString("PRAGMA cache_size = -%1").arg(this->PageCacheSize));
+    }
+  pragmaQuery.finish();
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMDatabasePrivate::createBackupFileList()
 {
   QSqlQuery query(this->Database);
+  // the backup left by a canceled update holds the files not reinserted yet
   loggedExec(query, "CREATE TABLE IF NOT EXISTS main.Filenames_backup (Filename TEXT PRIMARY KEY NOT NULL )" );
-  loggedExec(query, "INSERT INTO Filenames_backup SELECT Filename FROM Images;" );
+  loggedExec(query, "INSERT OR IGNORE INTO Filenames_backup SELECT Filename FROM Images;" );
 }
 
 //------------------------------------------------------------------------------
@@ -291,6 +929,7 @@ void ctkDICOMDatabasePrivate::removeBackupFileList()
 void ctkDICOMDatabase::openDatabase(const QString databaseFile, const QString& connectionName )
 {
   Q_D(ctkDICOMDatabase);
+  d->removeReaderConnections();
   d->DatabaseFileName = databaseFile;
   d->Database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
   d->Database.setDatabaseName(databaseFile);
@@ -308,6 +947,7 @@ void ctkDICOMDatabase::openDatabase(const QString databaseFile, const QString& c
         }
     }
   d->resetLastInsertedValues();
+  d->loadKnownUIDs();
 
   if (!isInMemory())
     {
@@ -315,12 +955,7 @@ void ctkDICOMDatabase::openDatabase(const QString databaseFile, const QString& c
       connect(watcher, SIGNAL(fileChanged(QString)),this, SIGNAL (databaseChanged()) );
     }
 
-  //Disable synchronous writing to make modifications faster
-  {
-  QSqlQuery pragmaSyncQuery(d->Database);
-  pragmaSyncQuery.exec("PRAGMA synchronous = OFF");
-  pragmaSyncQuery.finish();
-  }
+  d->configureConnection(d->Database, this->isInMemory());
 
   // set up the tag cache for use later
   QFileInfo fileInfo(d->DatabaseFileName);
@@ -390,16 +1025,132 @@ const QSqlDatabase& ctkDICOMDatabase::database() const {
 }
 
 //------------------------------------------------------------------------------
-void ctkDICOMDatabase::setThumbnailGenerator(ctkDICOMAbstractThumbnailGenerator *generator){
+QSqlDatabase ctkDICOMDatabase::readerConnection()
+{
   Q_D(ctkDICOMDatabase);
-  d->thumbnailGenerator = generator;
-}
-
-//------------------------------------------------------------------------------
-ctkDICOMAbstractThumbnailGenerator* ctkDICOMDatabase::thumbnailGenerator(){
-  Q_D(const ctkDICOMDatabase);
-  return d->thumbnailGenerator;
-}
+  if (d->DatabaseFileName.isEmpty() || this->isInMemory())
+    {
+    return QSqlDatabase();
+    }
+  QThread* thread = QThread::currentThread();
+  QMutexLocker locker(&d->ReaderConnectionsMutex);
+  QHash<QThread*, QString>::const_iterator reader = d->ReaderConnections.constFind(thread);
+  if (reader != d->ReaderConnections.constEnd())
+    {
+    return QSqlDatabase::database(reader.value(), false);
+    }
+
+  QString readerConnectionName = QString("%1-reader-%2")
+    .arg(d->Database.connectionName()).arg(++d->ReaderConnectionCount);
+  bool valid = false;
+  {
+  QSqlDatabase readerDatabase = QSqlDatabase::addDatabase("QSQLITE", readerConnectionName);
+  readerDatabase.setDatabaseName(d->DatabaseFileName);
+  readerDatabase.setConnectOptions("QSQLITE_OPEN_READONLY");
+  if (!readerDatabase.open())
+    {
+    logger.error("Unable to open reader connection: " + readerDatabase.lastError().text());
+    }
+  else if (!d->ReaderSchemaVerified)
+    {
+    // done once for all the readers of the file, a mismatch is checked
+    // again by the next reader in case the schema has been updated
+    QSqlQuery versionQuery(readerDatabase);
+    if (versionQuery.exec("SELECT Version from SchemaInfo;") && versionQuery.next()
+        && versionQuery.value(0).toString() == this->schemaVersion())
+      {
+      d->ReaderSchemaVerified = true;
+      }
+    else
+      {
+      logger.error("Unable to open reader connection: the schema of "
+                   + d->DatabaseFileName + " is not " + this->schemaVersion());
+      }
+    }
+  valid = d->ReaderSchemaVerified;
+  if (valid)
+    {
+    d->configureConnection(readerDatabase, false, true);
+    }
+  else
+    {
+    readerDatabase.close();
+    }
+  }
+  if (!valid)
+    {
+    QSqlDatabase::removeDatabase(readerConnectionName);
+    return QSqlDatabase();
+    }
+
+  d->ReaderConnections.insert(thread, readerConnectionName);
+  // finished() is emitted by the thread itself, which still owns the
+  // connection at that point
+  this->connect(thread, SIGNAL(finished()), SLOT(onReaderThreadFinished()),
+                Qt::DirectConnection);
+  return QSqlDatabase::database(readerConnectionName, false);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::onReaderThreadFinished()
+{
+  Q_D(ctkDICOMDatabase);
+  QString readerConnectionName;
+  {
+  QMutexLocker locker(&d->ReaderConnectionsMutex);
+  // sender() is not valid for a direct connection from another thread
+  readerConnectionName = d->ReaderConnections.take(QThread::currentThread());
+  }
+  if (!readerConnectionName.isEmpty())
+    {
+    QSqlDatabase::removeDatabase(readerConnectionName);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setThumbnailGenerator(ctkDICOMAbstractThumbnailGenerator *generator){
+  Q_D(ctkDICOMDatabase);
+  d->thumbnailGenerator = generator;
+  d->ThumbnailQueue.setThumbnailGenerator(generator);
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMAbstractThumbnailGenerator* ctkDICOMDatabase::thumbnailGenerator(){
+  Q_D(const ctkDICOMDatabase);
+  return d->thumbnailGenerator;
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailQueue* ctkDICOMDatabase::thumbnailQueue()
+{
+  Q_D(ctkDICOMDatabase);
+  return &d->ThumbnailQueue;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMDatabase::thumbnailPathForInstance(const QString& studyInstanceUID,
+                                                   const QString& seriesInstanceUID,
+                                                   const QString& sopInstanceUID)
+{
+  Q_D(ctkDICOMDatabase);
+  return d->thumbnailPath(studyInstanceUID, seriesInstanceUID, sopInstanceUID);
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::requestThumbnail(const QString& studyInstanceUID,
+                                        const QString& seriesInstanceUID,
+                                        const QString& sopInstanceUID)
+{
+  Q_D(ctkDICOMDatabase);
+  QString filePath = this->fileForInstance(sopInstanceUID);
+  if (filePath.isEmpty())
+    {
+    return false;
+    }
+  return d->ThumbnailQueue.addThumbnail(filePath,
+    d->thumbnailPath(studyInstanceUID, seriesInstanceUID, sopInstanceUID),
+    ctkDICOMThumbnailQueue::RequestedPriority);
+}
 
 //------------------------------------------------------------------------------
 bool ctkDICOMDatabasePrivate::executeScript(const QString script) {
@@ -411,8 +1162,20 @@ bool ctkDICOMDatabasePrivate::executeScript(const QString script) {
       return false;
     }
 
-  QString sqlCommands( QTextStream(&scriptFile).readAll() );
-  sqlCommands.replace( '\n', ' ' );
+  // the lines are joined before being split at the semicolons, the
+  // comments must be stripped first not to hide the following statement
+  QString sqlCommands;
+  QTextStream scriptStream(&scriptFile);
+  while (!scriptStream.atEnd())
+    {
+    QString line = scriptStream.readLine();
+    int commentStart = line.indexOf("--");
+    if (commentStart >= 0)
+      {
+      line.truncate(commentStart);
+      }
+    sqlCommands += line + ' ';
+    }
   sqlCommands.remove( '\r' );
   sqlCommands.replace("; ", ";\n");
 
@@ -462,8 +1225,16 @@ bool ctkDICOMDatabase::initializeDatabase(const char* sqlFileName)
   // remove any existing schema info - this handles the case where an
   // old schema should be loaded for testing.
   QSqlQuery dropSchemaInfo(d->Database);
+  if (d->Database.tables().isEmpty())
+    {
+    // the free pages left by the removals can then be reclaimed with
+    // an incremental vacuum, see removeSeries(QStringList)
+    d->loggedExec( dropSchemaInfo, QString("PRAGMA auto_vacuum = INCREMENTAL;") );
+    }
   d->loggedExec( dropSchemaInfo, QString("DROP TABLE IF EXISTS 'SchemaInfo';") );
-  return d->executeScript(sqlFileName);
+  bool success = d->executeScript(sqlFileName);
+  d->loadKnownUIDs();
+  return success;
 }
 
 //------------------------------------------------------------------------------
@@ -495,13 +1266,15 @@ QString ctkDICOMDatabase::schemaVersion()
   //   so that the ctkDICOMDatabasePrivate::filenames method
   //   still works.
   //
-  return QString("0.5.3");
+  return QString("0.5.6");
 };
 
 //------------------------------------------------------------------------------
 bool ctkDICOMDatabase::updateSchemaIfNeeded(const char* schemaFile)
 {
-  if ( schemaVersionLoaded() != schemaVersion() )
+  Q_D(ctkDICOMDatabase);
+  if ( schemaVersionLoaded() != schemaVersion()
+       || d->Database.tables().contains("Filenames_backup") )
     {
     return this->updateSchema(schemaFile);
     }
@@ -528,10 +1301,24 @@ bool ctkDICOMDatabase::updateSchema(const char* schemaFile)
 
   QStringList allFiles = d->filenames("Filenames_backup");
   emit schemaUpdateStarted(allFiles.length());
+  if (d->OperationToken)
+    {
+    d->OperationToken->startPhase("Updating schema", allFiles.count());
+    }
 
   int progressValue = 0;
+  this->beginBulkInsert();
   foreach(QString file, allFiles)
   {
+    if (d->isOperationCanceled())
+      {
+      // the backup is kept, the update is run again by updateSchemaIfNeeded()
+      this->abortBulkInsert();
+      logger.warn(QString("Schema update canceled, %1 of %2 files reinserted")
+                  .arg(progressValue).arg(allFiles.count()));
+      emit schemaUpdated();
+      return false;
+      }
     emit schemaUpdateProgress(progressValue);
     emit schemaUpdateProgress(file);
 
@@ -539,7 +1326,12 @@ bool ctkDICOMDatabase::updateSchema(const char* schemaFile)
     this->insert(file,false,false,true);
 
     progressValue++;
+    if (d->OperationToken)
+      {
+      d->OperationToken->setItemsDone(progressValue);
+      }
   }
+  this->endBulkInsert();
   // TODO: check better that everything is ok
   d->removeBackupFileList();
   emit schemaUpdated();
@@ -552,8 +1344,224 @@ bool ctkDICOMDatabase::updateSchema(const char* schemaFile)
 void ctkDICOMDatabase::closeDatabase()
 {
   Q_D(ctkDICOMDatabase);
+  if (d->BulkInsertDepth > 0)
+    {
+    if (d->BulkInsertAborted)
+      {
+      d->rollbackBulkInsertTransaction();
+      }
+    else
+      {
+      d->commitBulkInsertTransaction();
+      }
+    d->BulkInsertDepth = 0;
+    d->BulkInsertAborted = false;
+    }
+  d->PreparedQueries.clear();
+  d->removeReaderConnections();
   d->Database.close();
   d->TagCacheDatabase.close();
+  d->loadKnownUIDs();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setWriteAheadLogging(bool enable)
+{
+  Q_D(ctkDICOMDatabase);
+  d->WriteAheadLogging = enable;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::writeAheadLogging()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->WriteAheadLogging;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setMemoryMappedIOSize(qint64 bytes)
+{
+  Q_D(ctkDICOMDatabase);
+  d->MemoryMappedIOSize = bytes;
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMDatabase::memoryMappedIOSize()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->MemoryMappedIOSize;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setPageCacheSize(int kibibytes)
+{
+  Q_D(ctkDICOMDatabase);
+  d->PageCacheSize = kibibytes;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::pageCacheSize()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->PageCacheSize;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::beginBulkInsert()
+{
+  Q_D(ctkDICOMDatabase);
+  if (d->BulkInsertDepth++ == 0)
+    {
+    d->beginBulkInsertTransaction();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::endBulkInsert()
+{
+  Q_D(ctkDICOMDatabase);
+  if (d->BulkInsertDepth == 0)
+    {
+    logger.warn("endBulkInsert() called without matching beginBulkInsert()");
+    return;
+    }
+  if (--d->BulkInsertDepth == 0)
+    {
+    if (d->BulkInsertAborted)
+      {
+      d->rollbackBulkInsertTransaction();
+      }
+    else
+      {
+      d->commitBulkInsertTransaction();
+      }
+    d->BulkInsertAborted = false;
+    d->PreparedQueries.clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::abortBulkInsert()
+{
+  Q_D(ctkDICOMDatabase);
+  if (d->BulkInsertDepth == 0)
+    {
+    logger.warn("abortBulkInsert() called without matching beginBulkInsert()");
+    return;
+    }
+  d->BulkInsertAborted = true;
+  this->endBulkInsert();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setOperationToken(ctkDICOMOperationToken* token)
+{
+  Q_D(ctkDICOMDatabase);
+  d->OperationToken = token;
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMOperationToken* ctkDICOMDatabase::operationToken()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->OperationToken;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::isBulkInserting()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->BulkInsertDepth > 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setBulkInsertTransactionSize(int instanceCount)
+{
+  Q_D(ctkDICOMDatabase);
+  d->BulkInsertTransactionSize = qMax(1, instanceCount);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::bulkInsertTransactionSize()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->BulkInsertTransactionSize;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setBulkInsertCommitInterval(int msec)
+{
+  Q_D(ctkDICOMDatabase);
+  d->BulkInsertCommitInterval = msec;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::bulkInsertCommitInterval()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->BulkInsertCommitInterval;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setStatisticsEnabled(bool enabled)
+{
+  Q_D(ctkDICOMDatabase);
+  d->StatisticsEnabled = enabled;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::statisticsEnabled()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->StatisticsEnabled;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setStatisticsLogInterval(int seconds)
+{
+  Q_D(ctkDICOMDatabase);
+  d->StatisticsLogInterval = qMax(0, seconds);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::statisticsLogInterval()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->StatisticsLogInterval;
+}
+
+//------------------------------------------------------------------------------
+QVariantMap ctkDICOMDatabase::statistics()const
+{
+  Q_D(const ctkDICOMDatabase);
+  QMutexLocker locker(&d->StatisticsMutex);
+  QVariantMap statistics;
+  statistics["insertedInstances"] = d->StatisticsInsertedInstances;
+  for (int phase = 0; phase < InsertPhaseCount; ++phase)
+    {
+    QVariantMap phaseStatistics;
+    phaseStatistics["count"] = d->StatisticsCounts[phase];
+    phaseStatistics["seconds"] = d->StatisticsNanoseconds[phase] / 1e9;
+    statistics[ctkDICOMInsertPhaseNames[phase]] = phaseStatistics;
+    }
+  return statistics;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::resetStatistics()
+{
+  Q_D(ctkDICOMDatabase);
+  d->resetStatistics();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::addInsertPhaseTime(InsertPhase phase, qint64 nanoseconds)
+{
+  Q_D(ctkDICOMDatabase);
+  if (d->StatisticsEnabled && phase >= 0 && phase < InsertPhaseCount)
+    {
+    d->addPhaseTime(phase, nanoseconds);
+    }
 }
 
 //
@@ -658,6 +1666,77 @@ QHash<QString,QString> ctkDICOMDatabase::descriptionsForFile(QString fileName)
   return( result );
 }
 
+//------------------------------------------------------------------------------
+/// Returns the value of a single row, single column query on uid.
+static QVariant aggregateValue(const QSqlDatabase& database, const QString& sql, const QString& uid)
+{
+  QSqlQuery query(database);
+  query.prepare(sql);
+  query.bindValue(0, uid);
+  if (query.exec() && query.next())
+    {
+    return query.value(0);
+    }
+  return QVariant();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::instanceCountForSeries(const QString seriesUID)
+{
+  Q_D(ctkDICOMDatabase);
+  return aggregateValue(d->Database,
+    "SELECT InstanceCount FROM Series WHERE SeriesInstanceUID = ?", seriesUID).toInt();
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMDatabase::totalBytesForSeries(const QString seriesUID)
+{
+  Q_D(ctkDICOMDatabase);
+  return aggregateValue(d->Database,
+    "SELECT TotalBytes FROM Series WHERE SeriesInstanceUID = ?", seriesUID).toLongLong();
+}
+
+//------------------------------------------------------------------------------
+QDateTime ctkDICOMDatabase::firstInsertDateTimeForSeries(const QString seriesUID)
+{
+  Q_D(ctkDICOMDatabase);
+  return QDateTime::fromString(aggregateValue(d->Database,
+    "SELECT FirstInsertTimestamp FROM Series WHERE SeriesInstanceUID = ?", seriesUID).toString(), Qt::ISODate);
+}
+
+//------------------------------------------------------------------------------
+QDateTime ctkDICOMDatabase::lastInsertDateTimeForSeries(const QString seriesUID)
+{
+  Q_D(ctkDICOMDatabase);
+  return QDateTime::fromString(aggregateValue(d->Database,
+    "SELECT LastInsertTimestamp FROM Series WHERE SeriesInstanceUID = ?", seriesUID).toString(), Qt::ISODate);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::seriesCountForStudy(const QString studyUID)
+{
+  Q_D(ctkDICOMDatabase);
+  return aggregateValue(d->Database,
+    "SELECT SeriesCount FROM Studies WHERE StudyInstanceUID = ?", studyUID).toInt();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::instanceCountForStudy(const QString studyUID)
+{
+  Q_D(ctkDICOMDatabase);
+  return aggregateValue(d->Database,
+    "SELECT InstanceCount FROM Studies WHERE StudyInstanceUID = ?", studyUID).toInt();
+}
+
+//------------------------------------------------------------------------------
+QStringList ctkDICOMDatabase::modalitiesForStudy(const QString studyUID)
+{
+  Q_D(ctkDICOMDatabase);
+  return aggregateValue(d->Database,
+    "SELECT ModalitiesInStudy FROM Studies WHERE StudyInstanceUID = ?", studyUID)
+    .toString().split('\\', QString::SkipEmptyParts);
+}
+
 //------------------------------------------------------------------------------
 QString ctkDICOMDatabase::descriptionForSeries(const QString seriesUID)
 {
@@ -955,12 +2034,9 @@ QString ctkDICOMDatabase::fileValue(const QString fileName, const unsigned short
   // - for now we create a ctkDICOMItem and extract the value from there
   // - then we convert to the appropriate type of string
   //
-  //As an optimization we could consider
-  // - check if we are currently looking at the dataset for this fileName
-  // - if so, are we looking for a group/element that is past the last one
-  //   accessed
-  //   -- if so, keep looking for the requested group/element
-  //   -- if not, start again from the begining
+  //
+  // To read several tags, use fileValues() instead: it parses each file once
+  // for all the missing tags.
 
   QString tag = this->groupElementToTag(group, element);
   QString sopInstanceUID = this->instanceForFile(fileName);
@@ -1026,12 +2102,29 @@ void ctkDICOMDatabase::insert( const ctkDICOMItem& ctkDataset, bool storeFile, b
   d->insert(ctkDataset, QString(), storeFile, generateThumbnail);
 }
 
-
 //------------------------------------------------------------------------------
-void ctkDICOMDatabase::insert ( const QString& filePath, bool storeFile, bool generateThumbnail, bool createHierarchy, const QString& destinationDirectoryName)
+void ctkDICOMDatabase::insert( const ctkDICOMItem& ctkDataset, const QString& filePath,
+                               bool storeFile, bool generateThumbnail)
 {
   Q_D(ctkDICOMDatabase);
-  Q_UNUSED(createHierarchy);
+  d->insert(ctkDataset, filePath, storeFile, generateThumbnail);
+}
+
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::insertDirectoryRecord( const ctkDICOMItem& dataset, const QString& filePath )
+{
+  Q_D(ctkDICOMDatabase);
+  d->InsertingDirectoryRecord = true;
+  d->insert(dataset, filePath, false, false);
+  d->InsertingDirectoryRecord = false;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::insert ( const QString& filePath, bool storeFile, bool generateThumbnail, bool createHierarchy, const QString& destinationDirectoryName)
+{
+  Q_D(ctkDICOMDatabase);
+  Q_UNUSED(createHierarchy);
   Q_UNUSED(destinationDirectoryName);
 
   /// first we check if the file is already in the database
@@ -1048,7 +2141,11 @@ void ctkDICOMDatabase::insert ( const QString& filePath, bool storeFile, bool ge
   DcmFileFormat fileformat;
   ctkDICOMItem ctkDataset;
 
-  ctkDataset.InitializeFromFile(filePath);
+  // only the header is needed to index the file, the file itself is copied
+  // if it has to be stored and thumbnails are generated from the file
+  ctkDICOMInsertPhaseTimer parseTimer(d, ParsePhase);
+  ctkDataset.InitializeFromFileHeader(filePath);
+  parseTimer.stop();
   if ( ctkDataset.IsInitialized() )
     {
       d->insert( ctkDataset, filePath, storeFile, generateThumbnail );
@@ -1070,8 +2167,15 @@ int ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& ctkDataset)
   QString patientsName(ctkDataset.GetElementAsString(DCM_PatientName) );
   QString patientsBirthDate(ctkDataset.GetElementAsString(DCM_PatientBirthDate) );
 
-  QSqlQuery checkPatientExistsQuery(Database);
-  checkPatientExistsQuery.prepare ( "SELECT * FROM Patients WHERE PatientID = ? AND PatientsName = ?" );
+  QPair<QString, QString> patientKey(patientID, patientsName);
+  QHash<QPair<QString, QString>, int>::const_iterator knownPatient =
+    this->KnownPatients.constFind(patientKey);
+  if (knownPatient != this->KnownPatients.constEnd())
+    {
+    return knownPatient.value();
+    }
+
+  QSqlQuery checkPatientExistsQuery = preparedQuery( "SELECT * FROM Patients WHERE PatientID = ? AND PatientsName = ?" );
   checkPatientExistsQuery.bindValue ( 0, patientID );
   checkPatientExistsQuery.bindValue ( 1, patientsName );
   loggedExec(checkPatientExistsQuery);
@@ -1091,8 +2195,7 @@ int ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& ctkDataset)
       QString patientsAge(ctkDataset.GetElementAsString(DCM_PatientAge) );
       QString patientComments(ctkDataset.GetElementAsString(DCM_PatientComments) );
 
-      QSqlQuery insertPatientStatement ( Database );
-      insertPatientStatement.prepare ( "INSERT INTO Patients ('UID', 'PatientsName', 'PatientID', 'PatientsBirthDate', 'PatientsBirthTime', 'PatientsSex', 'PatientsAge', 'PatientsComments' ) values ( NULL, ?, ?, ?, ?, ?, ?, ? )" );
+      QSqlQuery insertPatientStatement = preparedQuery ( "INSERT INTO Patients ('UID', 'PatientsName', 'PatientID', 'PatientsBirthDate', 'PatientsBirthTime', 'PatientsSex', 'PatientsAge', 'PatientsComments' ) values ( NULL, ?, ?, ?, ?, ?, ?, ? )" );
       insertPatientStatement.bindValue ( 0, patientsName );
       insertPatientStatement.bindValue ( 1, patientID );
       insertPatientStatement.bindValue ( 2, QDate::fromString ( patientsBirthDate, "yyyyMMdd" ) );
@@ -1101,12 +2204,17 @@ int ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& ctkDataset)
       // TODO: shift patient's age to study,
       // since this is not a patient level attribute in images
       // insertPatientStatement.bindValue ( 5, patientsAge );
+      insertPatientStatement.bindValue ( 5, QVariant() );
       insertPatientStatement.bindValue ( 6, patientComments );
       loggedExec(insertPatientStatement);
       dbPatientID = insertPatientStatement.lastInsertId().toInt();
       logger.debug ( "New patient inserted: " + QString().setNum ( dbPatientID ) );
       qDebug() << "New patient inserted as : " << dbPatientID;
     }
+    if (dbPatientID > 0)
+      {
+      this->KnownPatients.insert(patientKey, dbPatientID);
+      }
     return dbPatientID;
 }
 
@@ -1114,8 +2222,11 @@ int ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& ctkDataset)
 void ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& ctkDataset, int dbPatientID)
 {
   QString studyInstanceUID(ctkDataset.GetElementAsString(DCM_StudyInstanceUID) );
-  QSqlQuery checkStudyExistsQuery (Database);
-  checkStudyExistsQuery.prepare ( "SELECT * FROM Studies WHERE StudyInstanceUID = ?" );
+  if (this->KnownStudies.contains(studyInstanceUID))
+    {
+    return;
+    }
+  QSqlQuery checkStudyExistsQuery = preparedQuery ( "SELECT * FROM Studies WHERE StudyInstanceUID = ?" );
   checkStudyExistsQuery.bindValue ( 0, studyInstanceUID );
   checkStudyExistsQuery.exec();
   if(!checkStudyExistsQuery.next())
@@ -1132,8 +2243,7 @@ void ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& ctkDataset, int db
       QString referringPhysician(ctkDataset.GetElementAsString(DCM_ReferringPhysicianName) );
       QString studyDescription(ctkDataset.GetElementAsString(DCM_StudyDescription) );
 
-      QSqlQuery insertStudyStatement ( Database );
-      insertStudyStatement.prepare ( "INSERT INTO Studies ( 'StudyInstanceUID', 'PatientsUID', 'StudyID', 'StudyDate', 'StudyTime', 'AccessionNumber', 'ModalitiesInStudy', 'InstitutionName', 'ReferringPhysician', 'PerformingPhysiciansName', 'StudyDescription' ) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
+      QSqlQuery insertStudyStatement = preparedQuery ( "INSERT INTO Studies ( 'StudyInstanceUID', 'PatientsUID', 'StudyID', 'StudyDate', 'StudyTime', 'AccessionNumber', 'ModalitiesInStudy', 'InstitutionName', 'ReferringPhysician', 'PerformingPhysiciansName', 'StudyDescription' ) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
       insertStudyStatement.bindValue ( 0, studyInstanceUID );
       insertStudyStatement.bindValue ( 1, dbPatientID );
       insertStudyStatement.bindValue ( 2, studyID );
@@ -1152,11 +2262,13 @@ void ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& ctkDataset, int db
       else
         {
           LastStudyInstanceUID = studyInstanceUID;
+          this->KnownStudies.insert(studyInstanceUID);
         }
     }
   else
     {
     qDebug() << "Used existing study: " << studyInstanceUID;
+    this->KnownStudies.insert(studyInstanceUID);
     }
 }
 
@@ -1164,8 +2276,11 @@ void ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& ctkDataset, int db
 void ctkDICOMDatabasePrivate::insertSeries(const ctkDICOMItem& ctkDataset, QString studyInstanceUID)
 {
   QString seriesInstanceUID(ctkDataset.GetElementAsString(DCM_SeriesInstanceUID) );
-  QSqlQuery checkSeriesExistsQuery (Database);
-  checkSeriesExistsQuery.prepare ( "SELECT * FROM Series WHERE SeriesInstanceUID = ?" );
+  if (this->KnownSeries.contains(seriesInstanceUID))
+    {
+    return;
+    }
+  QSqlQuery checkSeriesExistsQuery = preparedQuery ( "SELECT * FROM Series WHERE SeriesInstanceUID = ?" );
   checkSeriesExistsQuery.bindValue ( 0, seriesInstanceUID );
   logger.warn ( "Statement: " + checkSeriesExistsQuery.lastQuery() );
   checkSeriesExistsQuery.exec();
@@ -1186,8 +2301,7 @@ void ctkDICOMDatabasePrivate::insertSeries(const ctkDICOMItem& ctkDataset, QStri
       long echoNumber(ctkDataset.GetElementAsInteger(DCM_EchoNumbers) );
       long temporalPosition(ctkDataset.GetElementAsInteger(DCM_TemporalPositionIdentifier) );
 
-      QSqlQuery insertSeriesStatement ( Database );
-      insertSeriesStatement.prepare ( "INSERT INTO Series ( 'SeriesInstanceUID', 'StudyInstanceUID', 'SeriesNumber', 'SeriesDate', 'SeriesTime', 'SeriesDescription', 'Modality', 'BodyPartExamined', 'FrameOfReferenceUID', 'AcquisitionNumber', 'ContrastAgent', 'ScanningSequence', 'EchoNumber', 'TemporalPosition' ) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
+      QSqlQuery insertSeriesStatement = preparedQuery ( "INSERT INTO Series ( 'SeriesInstanceUID', 'StudyInstanceUID', 'SeriesNumber', 'SeriesDate', 'SeriesTime', 'SeriesDescription', 'Modality', 'BodyPartExamined', 'FrameOfReferenceUID', 'AcquisitionNumber', 'ContrastAgent', 'ScanningSequence', 'EchoNumber', 'TemporalPosition' ) VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
       insertSeriesStatement.bindValue ( 0, seriesInstanceUID );
       insertSeriesStatement.bindValue ( 1, studyInstanceUID );
       insertSeriesStatement.bindValue ( 2, static_cast<int>(seriesNumber) );
@@ -1212,12 +2326,113 @@ void ctkDICOMDatabasePrivate::insertSeries(const ctkDICOMItem& ctkDataset, QStri
       else
         {
           LastSeriesInstanceUID = seriesInstanceUID;
+          this->KnownSeries.insert(seriesInstanceUID);
+          this->addSeriesToAggregates(studyInstanceUID, modality);
         }
     }
   else
     {
     qDebug() << "Used existing series: " << seriesInstanceUID;
+    this->KnownSeries.insert(seriesInstanceUID);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::addInstanceToAggregates(const QString& seriesInstanceUID,
+                                                      const QString& studyInstanceUID,
+                                                      qint64 fileSize,
+                                                      const QDateTime& insertTimestamp)
+{
+  QSqlQuery updateSeries = this->preparedQuery(
+    "UPDATE Series SET InstanceCount = InstanceCount + 1, TotalBytes = TotalBytes + ?, "
+    "FirstInsertTimestamp = COALESCE(FirstInsertTimestamp, ?), LastInsertTimestamp = ? "
+    "WHERE SeriesInstanceUID = ?");
+  updateSeries.bindValue(0, fileSize);
+  updateSeries.bindValue(1, insertTimestamp);
+  updateSeries.bindValue(2, insertTimestamp);
+  updateSeries.bindValue(3, seriesInstanceUID);
+  this->loggedExec(updateSeries);
+
+  QSqlQuery updateStudy = this->preparedQuery(
+    "UPDATE Studies SET InstanceCount = InstanceCount + 1 WHERE StudyInstanceUID = ?");
+  updateStudy.bindValue(0, studyInstanceUID);
+  this->loggedExec(updateStudy);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::addSeriesToAggregates(const QString& studyInstanceUID,
+                                                    const QString& modality)
+{
+  QSqlQuery modalitiesQuery = this->preparedQuery(
+    "SELECT ModalitiesInStudy FROM Studies WHERE StudyInstanceUID = ?");
+  modalitiesQuery.bindValue(0, studyInstanceUID);
+  QStringList modalities;
+  if (this->loggedExec(modalitiesQuery) && modalitiesQuery.next())
+    {
+    modalities = modalitiesQuery.value(0).toString().split('\\', QString::SkipEmptyParts);
+    }
+  modalitiesQuery.finish();
+  if (!modality.isEmpty() && !modalities.contains(modality))
+    {
+    modalities << modality;
+    }
+
+  QSqlQuery updateStudy = this->preparedQuery(
+    "UPDATE Studies SET SeriesCount = SeriesCount + 1, ModalitiesInStudy = ? WHERE StudyInstanceUID = ?");
+  updateStudy.bindValue(0, modalities.join("\\"));
+  updateStudy.bindValue(1, studyInstanceUID);
+  this->loggedExec(updateStudy);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::updateSeriesAggregates(const QString& seriesInstanceUID)
+{
+  // only the images of the series are read, through ImagesSeriesIndex
+  QSqlQuery updateSeries(this->Database);
+  updateSeries.prepare(
+    "UPDATE Series SET "
+    "InstanceCount = ( SELECT COUNT(*) FROM Images WHERE Images.SeriesInstanceUID = Series.SeriesInstanceUID ), "
+    "TotalBytes = ( SELECT COALESCE(SUM(FileSize), 0) FROM Images WHERE Images.SeriesInstanceUID = Series.SeriesInstanceUID ), "
+    "FirstInsertTimestamp = ( SELECT MIN(InsertTimestamp) FROM Images WHERE Images.SeriesInstanceUID = Series.SeriesInstanceUID ), "
+    "LastInsertTimestamp = ( SELECT MAX(InsertTimestamp) FROM Images WHERE Images.SeriesInstanceUID = Series.SeriesInstanceUID ) "
+    "WHERE SeriesInstanceUID = ?");
+  updateSeries.bindValue(0, seriesInstanceUID);
+  this->loggedExec(updateSeries);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::updateStudyAggregates(const QString& studyInstanceUID)
+{
+  if (studyInstanceUID.isEmpty())
+    {
+    return;
+    }
+  QSqlQuery modalitiesQuery(this->Database);
+  modalitiesQuery.prepare("SELECT DISTINCT Modality FROM Series WHERE StudyInstanceUID = ?");
+  modalitiesQuery.bindValue(0, studyInstanceUID);
+  QStringList modalities;
+  if (this->loggedExec(modalitiesQuery))
+    {
+    while (modalitiesQuery.next())
+      {
+      QString modality = modalitiesQuery.value(0).toString();
+      if (!modality.isEmpty())
+        {
+        modalities << modality;
+        }
+      }
     }
+
+  QSqlQuery updateStudy(this->Database);
+  updateStudy.prepare(
+    "UPDATE Studies SET "
+    "SeriesCount = ( SELECT COUNT(*) FROM Series WHERE Series.StudyInstanceUID = Studies.StudyInstanceUID ), "
+    "InstanceCount = ( SELECT COALESCE(SUM(InstanceCount), 0) FROM Series WHERE Series.StudyInstanceUID = Studies.StudyInstanceUID ), "
+    "ModalitiesInStudy = ? "
+    "WHERE StudyInstanceUID = ?");
+  updateStudy.bindValue(0, modalities.join("\\"));
+  updateStudy.bindValue(1, studyInstanceUID);
+  this->loggedExec(updateStudy);
 }
 
 //------------------------------------------------------------------------------
@@ -1235,30 +2450,67 @@ const QStringList ctkDICOMDatabase::tagsToPrecache()
 }
 
 //------------------------------------------------------------------------------
-void ctkDICOMDatabasePrivate::precacheTags( const QString sopInstanceUID )
+void ctkDICOMDatabasePrivate::precacheTags( const ctkDICOMItem& dataset, const QString sopInstanceUID )
 {
   Q_Q(ctkDICOMDatabase);
 
-  ctkDICOMItem dataset;
-  QString fileName = q->fileForInstance(sopInstanceUID);
-  dataset.InitializeFromFile(fileName);
-
+  if (this->TagsToPrecache.isEmpty())
+    {
+    return;
+    }
 
-  QStringList sopInstanceUIDs, tags, values;
   foreach (const QString &tag, this->TagsToPrecache)
     {
     unsigned short group, element;
     q->tagToGroupElement(tag, group, element);
     DcmTagKey tagKey(group, element);
     QString value = dataset.GetAllElementValuesAsString(tagKey);
-    sopInstanceUIDs << sopInstanceUID;
-    tags << tag;
-    values << value;
+    if (value.isEmpty() && (this->InsertingDirectoryRecord ||
+        group > 0x7fe0 || (group == 0x7fe0 && element >= 0x0010)))
+      {
+      // elements starting at the pixel data may not be part of a header-only
+      // dataset, and a DICOMDIR record only has a few attributes of the
+      // instance: leave them to fileValue() instead of caching them as missing
+      continue;
+      }
+    this->PrecachedSOPInstanceUIDs << sopInstanceUID;
+    this->PrecachedTags << tag;
+    this->PrecachedValues << value;
     }
 
-  this->beginTransaction();
-  q->cacheTags(sopInstanceUIDs, tags, values);
-  this->endTransaction();
+  if (this->BulkInsertDepth == 0)
+    {
+    this->flushPrecachedTags();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::flushPrecachedTags()
+{
+  Q_Q(ctkDICOMDatabase);
+
+  if (this->PrecachedSOPInstanceUIDs.isEmpty())
+    {
+    return;
+    }
+
+  // the tag cache lives in its own database, keep the transaction there
+  // so that it does not interfere with a transaction opened on the main one.
+  // During a bulk insert the transaction is already opened by the session.
+  bool ownTransaction = (this->BulkInsertDepth == 0);
+  if (ownTransaction)
+    {
+    this->TagCacheDatabase.transaction();
+    }
+  q->cacheTags(this->PrecachedSOPInstanceUIDs, this->PrecachedTags, this->PrecachedValues);
+  if (ownTransaction)
+    {
+    this->TagCacheDatabase.commit();
+    }
+
+  this->PrecachedSOPInstanceUIDs.clear();
+  this->PrecachedTags.clear();
+  this->PrecachedValues.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -1278,10 +2530,10 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
 
   QString sopInstanceUID ( ctkDataset.GetElementAsString(DCM_SOPInstanceUID) );
 
-  QSqlQuery fileExistsQuery ( Database );
-  fileExistsQuery.prepare("SELECT InsertTimestamp,Filename FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
+  QSqlQuery fileExistsQuery = preparedQuery("SELECT InsertTimestamp,Filename,SeriesInstanceUID FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
   fileExistsQuery.bindValue(":sopInstanceUID",sopInstanceUID);
   {
+  ctkDICOMInsertPhaseTimer instanceCheckTimer(this, ctkDICOMDatabase::InstanceCheckPhase);
   bool success = fileExistsQuery.exec();
   if (!success)
     {
@@ -1317,6 +2569,9 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
             logger.error("SQLITE ERROR deleting old image row: " + deleteFile.lastError().driverText());
             return;
           }
+        QString oldSeriesInstanceUID(fileExistsQuery.value(2).toString());
+        this->updateSeriesAggregates(oldSeriesInstanceUID);
+        this->updateStudyAggregates(q->studyForSeries(oldSeriesInstanceUID));
         }
     }
   }
@@ -1350,6 +2605,7 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
   QString filename = filePath;
   if ( storeFile && !q->isInMemory() && !seriesInstanceUID.isEmpty() )
     {
+      ctkDICOMInsertPhaseTimer fileCopyTimer(this, ctkDICOMDatabase::FileCopyPhase);
       // QString studySeriesDirectory = studyInstanceUID + "/" + seriesInstanceUID;
       QString destinationDirectoryName = q->databaseDirectory() + "/dicom/";
       QDir destinationDir(destinationDirectoryName);
@@ -1401,7 +2657,9 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
           // Ok, something is different from last insert, let's insert him if he's not
           // already in the db.
 
+          ctkDICOMInsertPhaseTimer patientTimer(this, ctkDICOMDatabase::PatientPhase);
           dbPatientID = insertPatient( ctkDataset );
+          patientTimer.stop();
 
           // let users of this class track when things happen
           emit q->patientAdded(dbPatientID, patientID, patientsName, patientsBirthDate);
@@ -1419,7 +2677,9 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
 
       if ( studyInstanceUID != "" && LastStudyInstanceUID != studyInstanceUID )
         {
+          ctkDICOMInsertPhaseTimer studyTimer(this, ctkDICOMDatabase::StudyPhase);
           insertStudy(ctkDataset,dbPatientID);
+          studyTimer.stop();
 
           // let users of this class track when things happen
           emit q->studyAdded(studyInstanceUID);
@@ -1429,7 +2689,9 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
 
       if ( seriesInstanceUID != "" && seriesInstanceUID != LastSeriesInstanceUID )
         {
+          ctkDICOMInsertPhaseTimer seriesTimer(this, ctkDICOMDatabase::SeriesPhase);
           insertSeries(ctkDataset, studyInstanceUID);
+          seriesTimer.stop();
 
           // let users of this class track when things happen
           emit q->seriesAdded(seriesInstanceUID);
@@ -1439,23 +2701,37 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
       //
       if ( !filename.isEmpty() && !seriesInstanceUID.isEmpty() )
         {
-          QSqlQuery checkImageExistsQuery (Database);
-          checkImageExistsQuery.prepare ( "SELECT * FROM Images WHERE Filename = ?" );
+          ctkDICOMInsertPhaseTimer imageTimer(this, ctkDICOMDatabase::ImagePhase);
+          QSqlQuery checkImageExistsQuery = preparedQuery ( "SELECT * FROM Images WHERE Filename = ?" );
           checkImageExistsQuery.bindValue ( 0, filename );
           checkImageExistsQuery.exec();
           qDebug() << "Maybe add Instance";
           if(!checkImageExistsQuery.next())
             {
-              QSqlQuery insertImageStatement ( Database );
-              insertImageStatement.prepare ( "INSERT INTO Images ( 'SOPInstanceUID', 'Filename', 'SeriesInstanceUID', 'InsertTimestamp' ) VALUES ( ?, ?, ?, ? )" );
+              QDateTime insertTimestamp = QDateTime::currentDateTime();
+              qint64 fileSize = QFileInfo(filename).size();
+              QSqlQuery insertImageStatement = preparedQuery ( "INSERT INTO Images ( 'SOPInstanceUID', 'Filename', 'SeriesInstanceUID', 'InsertTimestamp', 'FileSize' ) VALUES ( ?, ?, ?, ?, ? )" );
               insertImageStatement.bindValue ( 0, sopInstanceUID );
               insertImageStatement.bindValue ( 1, filename );
               insertImageStatement.bindValue ( 2, seriesInstanceUID );
-              insertImageStatement.bindValue ( 3, QDateTime::currentDateTime() );
-              insertImageStatement.exec();
+              insertImageStatement.bindValue ( 3, insertTimestamp );
+              insertImageStatement.bindValue ( 4, fileSize );
+              if ( insertImageStatement.exec() )
+                {
+                this->addInstanceToAggregates(seriesInstanceUID, studyInstanceUID, fileSize, insertTimestamp);
+                if (this->StatisticsEnabled)
+                  {
+                  QMutexLocker locker(&this->StatisticsMutex);
+                  ++this->StatisticsInsertedInstances;
+                  }
+                }
+              imageTimer.stop();
 
               // insert was needed, so cache any application-requested tags
-              this->precacheTags(sopInstanceUID);
+              // (the values are taken from the dataset, the file is not read again)
+              ctkDICOMInsertPhaseTimer precacheTimer(this, ctkDICOMDatabase::PrecachePhase);
+              this->precacheTags(ctkDataset, sopInstanceUID);
+              precacheTimer.stop();
 
               // let users of this class track when things happen
               emit q->instanceAdded(sopInstanceUID);
@@ -1463,27 +2739,27 @@ void ctkDICOMDatabasePrivate::insert( const ctkDICOMItem& ctkDataset, const QStr
             }
         }
 
-      if( generateThumbnail && thumbnailGenerator && !seriesInstanceUID.isEmpty() )
+      // Decoding the pixel data is left to the thumbnail queue. Only the
+      // first instance of each series is queued, as the representative
+      // thumbnail of the series. The other thumbnails are generated when
+      // they are requested (see requestThumbnail()).
+      if( generateThumbnail && thumbnailGenerator && !seriesInstanceUID.isEmpty()
+          && !filename.isEmpty() && !this->SeriesWithThumbnail.contains(seriesInstanceUID) )
         {
-          QString studySeriesDirectory = studyInstanceUID + "/" + seriesInstanceUID;
-          //Create thumbnail here
-          QString thumbnailPath = q->databaseDirectory() +
-              "/thumbs/" + studyInstanceUID + "/" + seriesInstanceUID
-              + "/" + sopInstanceUID + ".png";
-          QFileInfo thumbnailInfo(thumbnailPath);
-          if( !(thumbnailInfo.exists()
-                && (thumbnailInfo.lastModified() > QFileInfo(filename).lastModified())))
-            {
-              QDir(q->databaseDirectory() + "/thumbs/").mkpath(studySeriesDirectory);
-              DicomImage dcmImage(QDir::toNativeSeparators(filename).toLatin1());
-              thumbnailGenerator->generateThumbnail(&dcmImage, thumbnailPath);
-            }
+          ctkDICOMInsertPhaseTimer thumbnailTimer(this, ctkDICOMDatabase::ThumbnailPhase);
+          this->SeriesWithThumbnail.insert(seriesInstanceUID);
+          this->ThumbnailQueue.addThumbnail(filename,
+            this->thumbnailPath(studyInstanceUID, seriesInstanceUID, sopInstanceUID),
+            ctkDICOMThumbnailQueue::SeriesPriority);
         }
 
       if (q->isInMemory())
         {
           emit q->databaseChanged();
         }
+
+      this->bulkInsertInstanceDone();
+      this->logStatisticsIfNeeded();
     }
   else
     {
@@ -1543,6 +2819,7 @@ bool ctkDICOMDatabase::removeSeries(const QString& seriesInstanceUID)
       return false;
     }
 
+  QString studyInstanceUID = this->studyForSeries(seriesInstanceUID);
   QList< QPair<QString,QString> > removeList;
   while ( fileExistsQuery.next() )
     {
@@ -1598,20 +2875,342 @@ bool ctkDICOMDatabase::removeSeries(const QString& seriesInstanceUID)
     }
 
   this->cleanup();
+  d->updateStudyAggregates(studyInstanceUID);
 
   d->resetLastInsertedValues();
 
   return true;
 }
 
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::removeSeries(const QStringList& seriesInstanceUIDs, bool incrementalVacuum)
+{
+  Q_D(ctkDICOMDatabase);
+  if (seriesInstanceUIDs.isEmpty())
+    {
+    return true;
+    }
+
+  bool success = d->Database.transaction() && d->setRemovalKeys(seriesInstanceUIDs);
+  if (!success)
+    {
+    d->Database.rollback();
+    return false;
+    }
+
+  QStringList studiesToUpdate = d->selectForRemovalKeys(
+    "SELECT DISTINCT StudyInstanceUID FROM Series WHERE SeriesInstanceUID IN ( SELECT Key FROM temp.RemovalKeys )");
+
+  // only the files below the internal storage are removed, like removeSeries()
+  QString storageDirectory = this->databaseDirectory() + "/dicom/";
+  QStringList filesToRemove;
+  QSqlQuery filesQuery(d->Database);
+  success = d->loggedExec(filesQuery,
+    "SELECT Filename, SOPInstanceUID, Series.SeriesInstanceUID, StudyInstanceUID FROM Images, Series "
+    "WHERE Series.SeriesInstanceUID = Images.SeriesInstanceUID "
+    "AND Images.SeriesInstanceUID IN ( SELECT Key FROM temp.RemovalKeys )");
+  while (success && filesQuery.next())
+    {
+    QString dbFilePath = filesQuery.value(0).toString();
+    QString sopInstanceUID = filesQuery.value(1).toString();
+    QString seriesInstanceUID = filesQuery.value(2).toString();
+    QString studyInstanceUID = filesQuery.value(3).toString();
+    QString internalFilePath = studyInstanceUID + "/" + seriesInstanceUID + "/" + sopInstanceUID;
+    if (dbFilePath.startsWith(storageDirectory))
+      {
+      if (dbFilePath.endsWith(internalFilePath))
+        {
+        filesToRemove << dbFilePath;
+        }
+      else
+        {
+        logger.error("Database inconsistency detected during delete!");
+        }
+      }
+    filesToRemove << d->thumbnailPath(studyInstanceUID, seriesInstanceUID, sopInstanceUID);
+    }
+  filesQuery.finish();
+
+  QSqlQuery removeQuery(d->Database);
+  success = success
+    && d->loggedExec(removeQuery, "DELETE FROM Images WHERE SeriesInstanceUID IN ( SELECT Key FROM temp.RemovalKeys )")
+    && d->loggedExec(removeQuery, "DELETE FROM Series WHERE SeriesInstanceUID IN ( SELECT Key FROM temp.RemovalKeys )");
+  if (!success)
+    {
+    logger.error("SQLITE ERROR: could not remove " + QString::number(seriesInstanceUIDs.count()) + " series");
+    d->Database.rollback();
+    return false;
+    }
+  d->Database.commit();
+  foreach (const QString& seriesInstanceUID, seriesInstanceUIDs)
+    {
+    d->KnownSeries.remove(seriesInstanceUID);
+    }
+
+  this->cleanup();
+  foreach (const QString& studyInstanceUID, studiesToUpdate)
+    {
+    d->updateStudyAggregates(studyInstanceUID);
+    }
+  d->resetLastInsertedValues();
+
+  d->removeFilesInBackground(filesToRemove);
+  if (incrementalVacuum)
+    {
+    d->incrementalVacuum();
+    }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::removeStudies(const QStringList& studyInstanceUIDs, bool incrementalVacuum)
+{
+  Q_D(ctkDICOMDatabase);
+  if (studyInstanceUIDs.isEmpty() || !d->setRemovalKeys(studyInstanceUIDs))
+    {
+    return studyInstanceUIDs.isEmpty();
+    }
+  QStringList seriesInstanceUIDs = d->selectForRemovalKeys(
+    "SELECT SeriesInstanceUID FROM Series WHERE StudyInstanceUID IN ( SELECT Key FROM temp.RemovalKeys )");
+  if (seriesInstanceUIDs.isEmpty())
+    {
+    return this->cleanup();
+    }
+  // the studies left without series are removed by cleanup()
+  return this->removeSeries(seriesInstanceUIDs, incrementalVacuum);
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::removePatients(const QStringList& patientUIDs, bool incrementalVacuum)
+{
+  Q_D(ctkDICOMDatabase);
+  if (patientUIDs.isEmpty() || !d->setRemovalKeys(patientUIDs))
+    {
+    return patientUIDs.isEmpty();
+    }
+  QStringList seriesInstanceUIDs = d->selectForRemovalKeys(
+    "SELECT SeriesInstanceUID FROM Series, Studies WHERE Series.StudyInstanceUID = Studies.StudyInstanceUID "
+    "AND Studies.PatientsUID IN ( SELECT Key FROM temp.RemovalKeys )");
+  if (seriesInstanceUIDs.isEmpty())
+    {
+    return this->cleanup();
+    }
+  return this->removeSeries(seriesInstanceUIDs, incrementalVacuum);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::waitForFileRemoval()
+{
+  Q_D(ctkDICOMDatabase);
+  d->FileRemovalPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::removeFiles(const QStringList& fileNames)
+{
+  Q_D(ctkDICOMDatabase);
+  if (fileNames.isEmpty())
+    {
+    return true;
+    }
+
+  bool success = d->Database.transaction();
+  QSqlQuery instanceQuery ( d->Database );
+  instanceQuery.prepare("SELECT SOPInstanceUID, Images.SeriesInstanceUID, StudyInstanceUID FROM Images,Series WHERE Series.SeriesInstanceUID = Images.SeriesInstanceUID AND Filename = ?");
+  QSqlQuery fileRemove ( d->Database );
+  fileRemove.prepare("DELETE FROM Images WHERE Filename = ?");
+  QSet<QString> seriesToUpdate;
+  QSet<QString> studiesToUpdate;
+  foreach (const QString& fileName, fileNames)
+    {
+    instanceQuery.bindValue(0, fileName);
+    if (instanceQuery.exec() && instanceQuery.next())
+      {
+      seriesToUpdate.insert(instanceQuery.value(1).toString());
+      studiesToUpdate.insert(instanceQuery.value(2).toString());
+      QFile::remove(d->thumbnailPath(instanceQuery.value(2).toString(),
+                                     instanceQuery.value(1).toString(),
+                                     instanceQuery.value(0).toString()));
+      }
+    instanceQuery.finish();
+    fileRemove.bindValue(0, fileName);
+    if (!fileRemove.exec())
+      {
+      logger.error("SQLITE ERROR: could not remove file " + fileName);
+      logger.error("SQLITE ERROR: " + fileRemove.lastError().driverText());
+      success = false;
+      }
+    }
+  foreach (const QString& seriesInstanceUID, seriesToUpdate)
+    {
+    d->updateSeriesAggregates(seriesInstanceUID);
+    }
+  d->Database.commit();
+
+  // the studies are updated once the empty series are removed
+  this->cleanup();
+  foreach (const QString& studyInstanceUID, studiesToUpdate)
+    {
+    d->updateStudyAggregates(studyInstanceUID);
+    }
+  d->resetLastInsertedValues();
+  return success;
+}
+
+//------------------------------------------------------------------------------
+/// Bind the range of the paths below directoryName, which can be looked up
+/// with the index of the column unlike a LIKE pattern.
+static void bindPathsBelow(QSqlQuery& query, const QString& directoryName)
+{
+  QString prefix = directoryName;
+  if (!prefix.endsWith('/'))
+    {
+    prefix += '/';
+    }
+  // '0' is the character after '/'
+  QString end = prefix.left(prefix.length() - 1) + '0';
+  query.bindValue(0, prefix);
+  query.bindValue(1, end);
+}
+
+//------------------------------------------------------------------------------
+QHash<QString, QDateTime> ctkDICOMDatabase::insertDateTimesForDirectory(const QString& directoryName)
+{
+  Q_D(ctkDICOMDatabase);
+  QHash<QString, QDateTime> result;
+  QSqlQuery query(d->Database);
+  query.prepare("SELECT Filename, InsertTimestamp FROM Images WHERE Filename >= ? AND Filename < ?");
+  bindPathsBelow(query, directoryName);
+  if (!d->loggedExec(query))
+    {
+    return result;
+    }
+  while (query.next())
+    {
+    result.insert(query.value(0).toString(),
+                  QDateTime::fromString(query.value(1).toString(), Qt::ISODate));
+    }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+QHash<QString, QString> ctkDICOMDatabase::directoryFingerprints(const QString& directoryName)
+{
+  Q_D(ctkDICOMDatabase);
+  QHash<QString, QString> result;
+  QSqlQuery query(d->Database);
+  query.prepare("SELECT Dirname, Fingerprint FROM Directories WHERE (Dirname >= ? AND Dirname < ?) OR Dirname = ?");
+  bindPathsBelow(query, directoryName);
+  query.bindValue(2, directoryName);
+  if (!d->loggedExec(query))
+    {
+    return result;
+    }
+  while (query.next())
+    {
+    result.insert(query.value(0).toString(), query.value(1).toString());
+    }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::setDirectoryFingerprints(const QHash<QString, QString>& fingerprints)
+{
+  Q_D(ctkDICOMDatabase);
+  if (fingerprints.isEmpty())
+    {
+    return true;
+    }
+  bool success = d->Database.transaction();
+  QSqlQuery query(d->Database);
+  query.prepare("INSERT OR REPLACE INTO Directories ( 'Dirname', 'Fingerprint' ) VALUES ( ?, ? )");
+  QHash<QString, QString>::const_iterator it;
+  for (it = fingerprints.constBegin(); it != fingerprints.constEnd(); ++it)
+    {
+    query.bindValue(0, it.key());
+    query.bindValue(1, it.value());
+    success = d->loggedExec(query) && success;
+    }
+  return d->Database.commit() && success;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::removeDirectoryFingerprints(const QStringList& directoryNames)
+{
+  Q_D(ctkDICOMDatabase);
+  if (directoryNames.isEmpty())
+    {
+    return true;
+    }
+  bool success = d->Database.transaction();
+  QSqlQuery query(d->Database);
+  query.prepare("DELETE FROM Directories WHERE Dirname = ?");
+  foreach (const QString& directoryName, directoryNames)
+    {
+    query.bindValue(0, directoryName);
+    success = d->loggedExec(query) && success;
+    }
+  return d->Database.commit() && success;
+}
+
 //------------------------------------------------------------------------------
 bool ctkDICOMDatabase::cleanup()
 {
   Q_D(ctkDICOMDatabase);
+  // a bulk insert session already opened the transaction
+  bool ownTransaction = d->BulkInsertDepth == 0 && d->Database.transaction();
+  if (d->OperationToken)
+    {
+    d->OperationToken->startPhase("Cleaning up", 3);
+    }
   QSqlQuery seriesCleanup ( d->Database );
+  // the removed rows are first dropped from the known UIDs
+  seriesCleanup.exec("SELECT SeriesInstanceUID FROM Series WHERE ( SELECT COUNT(*) FROM Images WHERE Images.SeriesInstanceUID = Series.SeriesInstanceUID ) = 0;");
+  while (seriesCleanup.next())
+    {
+    d->KnownSeries.remove(seriesCleanup.value(0).toString());
+    }
   seriesCleanup.exec("DELETE FROM Series WHERE ( SELECT COUNT(*) FROM Images WHERE Images.SeriesInstanceUID = Series.SeriesInstanceUID ) = 0;");
+  if (ownTransaction && d->isOperationCanceled())
+    {
+    return d->rollbackCleanup(seriesCleanup);
+    }
+  if (d->OperationToken)
+    {
+    d->OperationToken->setItemsDone(1);
+    }
+  seriesCleanup.exec("SELECT StudyInstanceUID FROM Studies WHERE ( SELECT COUNT(*) FROM Series WHERE Series.StudyInstanceUID = Studies.StudyInstanceUID ) = 0;");
+  while (seriesCleanup.next())
+    {
+    d->KnownStudies.remove(seriesCleanup.value(0).toString());
+    }
   seriesCleanup.exec("DELETE FROM Studies WHERE ( SELECT COUNT(*) FROM Series WHERE Series.StudyInstanceUID = Studies.StudyInstanceUID ) = 0;");
+  if (ownTransaction && d->isOperationCanceled())
+    {
+    return d->rollbackCleanup(seriesCleanup);
+    }
+  if (d->OperationToken)
+    {
+    d->OperationToken->setItemsDone(2);
+    }
+  seriesCleanup.exec("SELECT PatientID, PatientsName FROM Patients WHERE ( SELECT COUNT(*) FROM Studies WHERE Studies.PatientsUID = Patients.UID ) = 0;");
+  while (seriesCleanup.next())
+    {
+    d->KnownPatients.remove(qMakePair(seriesCleanup.value(0).toString(), seriesCleanup.value(1).toString()));
+    }
   seriesCleanup.exec("DELETE FROM Patients WHERE ( SELECT COUNT(*) FROM Studies WHERE Studies.PatientsUID = Patients.UID ) = 0;");
+  seriesCleanup.finish();
+  if (ownTransaction && !d->Database.commit())
+    {
+    logger.error("SQLITE ERROR committing cleanup: " + d->Database.lastError().text());
+    d->Database.rollback();
+    d->loadKnownUIDs();
+    return false;
+    }
+  if (d->OperationToken)
+    {
+    d->OperationToken->setItemsDone(3);
+    }
   return true;
 }
 
@@ -1695,10 +3294,7 @@ bool ctkDICOMDatabase::tagCacheExists()
       return false;
       }
 
-    //Disable synchronous writing to make modifications faster
-    QSqlQuery pragmaSyncQuery(d->TagCacheDatabase);
-    pragmaSyncQuery.exec("PRAGMA synchronous = OFF");
-    pragmaSyncQuery.finish();
+    d->configureConnection(d->TagCacheDatabase, false);
 
     }
 
@@ -1735,6 +3331,7 @@ bool ctkDICOMDatabase::initializeTagCache()
   createCacheTable.prepare(
     "CREATE TABLE TagCache (SOPInstanceUID, Tag, Value, PRIMARY KEY (SOPInstanceUID, Tag))" );
   bool success = d->loggedExec(createCacheTable);
+  d->TagValueCache.clear();
   if (success)
     {
     d->TagCacheVerified = true;
@@ -1747,6 +3344,13 @@ bool ctkDICOMDatabase::initializeTagCache()
 QString ctkDICOMDatabase::cachedTag(const QString sopInstanceUID, const QString tag)
 {
   Q_D(ctkDICOMDatabase);
+  // make the values precached by a running bulk insert visible
+  d->flushPrecachedTags();
+  QString result("");
+  if (d->TagValueCache.find(sopInstanceUID, tag, result))
+    {
+    return( result );
+    }
   if ( !this->tagCacheExists() )
     {
     if ( !this->initializeTagCache() )
@@ -1759,7 +3363,6 @@ QString ctkDICOMDatabase::cachedTag(const QString sopInstanceUID, const QString
   selectValue.bindValue(":sopInstanceUID",sopInstanceUID);
   selectValue.bindValue(":tag",tag);
   d->loggedExec(selectValue);
-  QString result("");
   if (selectValue.next())
     {
     result = selectValue.value(0).toString();
@@ -1767,6 +3370,7 @@ QString ctkDICOMDatabase::cachedTag(const QString sopInstanceUID, const QString
       {
       result = ValueIsEmptyString;
       }
+    d->TagValueCache.insert(sopInstanceUID, tag, result);
     }
   return( result );
 }
@@ -1808,5 +3412,509 @@ bool ctkDICOMDatabase::cacheTags(const QStringList sopInstanceUIDs, const QStrin
   insertTags.addBindValue(sopInstanceUIDs);
   insertTags.addBindValue(tags);
   insertTags.addBindValue(values);
-  return d->loggedExecBatch(insertTags);
+  bool success = d->loggedExecBatch(insertTags);
+  if (success)
+    {
+    for (int i = 0; i < sopInstanceUIDs.count() && i < tags.count() && i < values.count(); ++i)
+      {
+      d->TagValueCache.insert(sopInstanceUIDs[i], tags[i], values[i]);
+      }
+    }
+  return success;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::fetchCachedTags(const QStringList& sopInstanceUIDs, const QStringList& tags)
+{
+  Q_Q(ctkDICOMDatabase);
+  // Fetch the values missing from the in-memory cache with one query per
+  // chunk of instances (SQLite limits the number of bound parameters).
+  const int maximumUIDsPerQuery = 900 - tags.count();
+  if ( tags.isEmpty() || maximumUIDsPerQuery <= 0 || !q->tagCacheExists() )
+    {
+    return;
+    }
+  QStringList tagMarks;
+  for (int i = 0; i < tags.count(); ++i)
+    {
+    tagMarks << "?";
+    }
+  for (int first = 0; first < sopInstanceUIDs.count(); first += maximumUIDsPerQuery)
+    {
+    QStringList uids = sopInstanceUIDs.mid(first, maximumUIDsPerQuery);
+    QStringList uidMarks;
+    for (int i = 0; i < uids.count(); ++i)
+      {
+      uidMarks << "?";
+      }
+    QSqlQuery selectValues( this->TagCacheDatabase );
+    selectValues.prepare( QString("SELECT SOPInstanceUID, Tag, Value FROM TagCache "
+                                  "WHERE SOPInstanceUID IN (%1) AND Tag IN (%2)")
+                          .arg(uidMarks.join(",")).arg(tagMarks.join(",")) );
+    foreach (const QString& uid, uids)
+      {
+      selectValues.addBindValue(uid);
+      }
+    foreach (const QString& tag, tags)
+      {
+      selectValues.addBindValue(tag);
+      }
+    this->loggedExec(selectValues);
+    while (selectValues.next())
+      {
+      QString value = selectValues.value(2).toString();
+      if (value.isEmpty())
+        {
+        value = ValueIsEmptyString;
+        }
+      this->TagValueCache.insert(selectValues.value(0).toString(),
+                                 selectValues.value(1).toString(), value);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+QStringList ctkDICOMDatabasePrivate::cachedTags(const QString& sopInstanceUID,
+                                                const QStringList& tags,
+                                                QList<int>& missing)
+{
+  Q_Q(ctkDICOMDatabase);
+  QStringList values;
+  for (int i = 0; i < tags.count(); ++i)
+    {
+    QString value = q->cachedTag(sopInstanceUID, tags[i]);
+    if (value == TagNotInInstance || value == ValueIsEmptyString)
+      {
+      value = "";
+      }
+    else if (value == "")
+      {
+      missing << i;
+      }
+    values << value;
+    }
+  return values;
+}
+
+//------------------------------------------------------------------------------
+QStringList ctkDICOMDatabasePrivate::readFileValues(const QString& fileName,
+                                                    const QList<DcmTagKey>& tagKeys,
+                                                    const QList<int>& indexes)
+{
+  QStringList values;
+  if (indexes.isEmpty())
+    {
+    return values;
+    }
+  DcmTagKey lastTagKey = tagKeys[indexes[0]];
+  foreach (int index, indexes)
+    {
+    if (tagKeys[index] > lastTagKey)
+      {
+      lastTagKey = tagKeys[index];
+      }
+    }
+  // Parsing stops at the element following the last requested one
+  DcmTagKey stopTagKey(DCM_UndefinedTagKey);
+  if (lastTagKey.getElement() < 0xffff)
+    {
+    stopTagKey = DcmTagKey(lastTagKey.getGroup(), lastTagKey.getElement() + 1);
+    }
+  else if (lastTagKey.getGroup() < 0xffff)
+    {
+    stopTagKey = DcmTagKey(lastTagKey.getGroup() + 1, 0);
+    }
+
+  ctkDICOMItem dataset;
+  dataset.InitializeFromFileUntilTag(fileName, stopTagKey);
+  foreach (int index, indexes)
+    {
+    values << dataset.GetAllElementValuesAsString(tagKeys[index]);
+    }
+  return values;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::cacheTagValues(const QStringList& sopInstanceUIDs,
+                                             const QStringList& tags,
+                                             const QStringList& values)
+{
+  Q_Q(ctkDICOMDatabase);
+  if (sopInstanceUIDs.isEmpty())
+    {
+    return;
+    }
+  // as in flushPrecachedTags(), a bulk insert already opened the transaction
+  bool ownTransaction = (this->BulkInsertDepth == 0);
+  if (ownTransaction)
+    {
+    this->TagCacheDatabase.transaction();
+    }
+  q->cacheTags(sopInstanceUIDs, tags, values);
+  if (ownTransaction)
+    {
+    this->TagCacheDatabase.commit();
+    }
+}
+
+//------------------------------------------------------------------------------
+QList<QStringList> ctkDICOMDatabase::instanceValues(const QStringList sopInstanceUIDs, const QStringList tags)
+{
+  Q_D(ctkDICOMDatabase);
+  d->flushPrecachedTags();
+  d->fetchCachedTags(sopInstanceUIDs, tags);
+
+  // values not in the tag cache at all are read from the files, each file
+  // is parsed once for all its missing values
+  QList<DcmTagKey> tagKeys;
+  foreach (const QString& tag, tags)
+    {
+    unsigned short group, element;
+    this->tagToGroupElement(tag, group, element);
+    tagKeys << DcmTagKey(group, element);
+    }
+  QStringList newUIDs, newTags, newValues;
+  QList<QStringList> result;
+  foreach (const QString& sopInstanceUID, sopInstanceUIDs)
+    {
+    QList<int> missing;
+    QStringList values = d->cachedTags(sopInstanceUID, tags, missing);
+    QString filePath = missing.isEmpty() ? QString() : this->fileForInstance(sopInstanceUID);
+    if (!filePath.isEmpty())
+      {
+      QStringList fileValues = d->readFileValues(filePath, tagKeys, missing);
+      for (int i = 0; i < missing.count(); ++i)
+        {
+        values[missing[i]] = fileValues[i];
+        newUIDs << sopInstanceUID;
+        newTags << tags[missing[i]];
+        newValues << fileValues[i];
+        }
+      }
+    result << values;
+    }
+  d->cacheTagValues(newUIDs, newTags, newValues);
+  return result;
+}
+
+//------------------------------------------------------------------------------
+QList<QStringList> ctkDICOMDatabase::fileValues(const QStringList fileNames, const QList<DcmTagKey> tagKeys)
+{
+  Q_D(ctkDICOMDatabase);
+  d->flushPrecachedTags();
+
+  QStringList tags;
+  foreach (const DcmTagKey& tagKey, tagKeys)
+    {
+    tags << this->groupElementToTag(tagKey.getGroup(), tagKey.getElement());
+    }
+  QStringList sopInstanceUIDs;
+  foreach (const QString& fileName, fileNames)
+    {
+    sopInstanceUIDs << this->instanceForFile(fileName);
+    }
+  d->fetchCachedTags(sopInstanceUIDs, tags);
+
+  QStringList newUIDs, newTags, newValues;
+  QList<QStringList> result;
+  for (int f = 0; f < fileNames.count(); ++f)
+    {
+    const QString& sopInstanceUID = sopInstanceUIDs[f];
+    QList<int> missing;
+    QStringList values = d->cachedTags(sopInstanceUID, tags, missing);
+    QStringList fileValues = d->readFileValues(fileNames[f], tagKeys, missing);
+    for (int i = 0; i < missing.count(); ++i)
+      {
+      values[missing[i]] = fileValues[i];
+      newUIDs << sopInstanceUID;
+      newTags << tags[missing[i]];
+      newValues << fileValues[i];
+      }
+    result << values;
+    }
+  d->cacheTagValues(newUIDs, newTags, newValues);
+  return result;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setTagValueCacheSize(int entryCount)
+{
+  Q_D(ctkDICOMDatabase);
+  d->TagValueCache.setMaximumSize(entryCount);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::tagValueCacheSize()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->TagValueCache.maximumSize();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::tagValueCacheHits()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->TagValueCache.hits();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::tagValueCacheMisses()const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->TagValueCache.misses();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::resetTagValueCacheStatistics()
+{
+  Q_D(ctkDICOMDatabase);
+  d->TagValueCache.resetStatistics();
+}
+
+//------------------------------------------------------------------------------
+/// Write the rows of ctkDICOMDatabase::exportMetadata() to the device, one
+/// group of rows at a time.
+class ctkDICOMMetadataExporter
+{
+public:
+  ctkDICOMMetadataExporter(QIODevice* device, ctkDICOMDatabase::ExportFormat format,
+                           int rowGroupSize)
+    : Device(device)
+    , Stream(device)
+    , Format(format)
+    , RowGroupSize(rowGroupSize)
+    , RowCount(0)
+  {
+    this->Stream.setVersion(QDataStream::Qt_4_6);
+  }
+
+  bool writeHeader(const QStringList& columns)
+  {
+    if (this->Format == ctkDICOMDatabase::ExportColumnar)
+      {
+      this->Stream << quint32(0x43544b4d) << quint32(1) << columns;
+      this->Columns = QVector<QStringList>(columns.count());
+      return this->Stream.status() == QDataStream::Ok;
+      }
+    this->appendCSVRow(columns);
+    return this->flush();
+  }
+
+  bool writeRow(const QStringList& values)
+  {
+    if (this->Format == ctkDICOMDatabase::ExportColumnar)
+      {
+      for (int i = 0; i < this->Columns.count(); ++i)
+        {
+        this->Columns[i] << values[i];
+        }
+      }
+    else
+      {
+      this->appendCSVRow(values);
+      }
+    if (++this->RowCount >= this->RowGroupSize)
+      {
+      return this->flush();
+      }
+    return true;
+  }
+
+  bool finish()
+  {
+    if (!this->flush())
+      {
+      return false;
+      }
+    if (this->Format == ctkDICOMDatabase::ExportColumnar)
+      {
+      this->Stream << qint32(0);
+      return this->Stream.status() == QDataStream::Ok;
+      }
+    return true;
+  }
+
+private:
+  void appendCSVRow(const QStringList& values)
+  {
+    for (int i = 0; i < values.count(); ++i)
+      {
+      if (i > 0)
+        {
+        this->Buffer += ',';
+        }
+      QByteArray field = values[i].toUtf8();
+      if (field.contains(',') || field.contains('"') ||
+          field.contains('\n') || field.contains('\r'))
+        {
+        field.replace('"', "\"\"");
+        this->Buffer += '"';
+        this->Buffer += field;
+        this->Buffer += '"';
+        }
+      else
+        {
+        this->Buffer += field;
+        }
+      }
+    this->Buffer += "\r\n";
+  }
+
+  bool flush()
+  {
+    bool success = true;
+    if (this->Format == ctkDICOMDatabase::ExportColumnar)
+      {
+      if (this->RowCount > 0)
+        {
+        this->Stream << qint32(this->RowCount);
+        for (int i = 0; i < this->Columns.count(); ++i)
+          {
+          this->Stream << this->Columns[i];
+          this->Columns[i].clear();
+          }
+        }
+      success = (this->Stream.status() == QDataStream::Ok);
+      }
+    else if (!this->Buffer.isEmpty())
+      {
+      success = (this->Device->write(this->Buffer) == this->Buffer.size());
+      this->Buffer.clear();
+      }
+    this->RowCount = 0;
+    return success;
+  }
+
+  QIODevice* Device;
+  QDataStream Stream;
+  ctkDICOMDatabase::ExportFormat Format;
+  int RowGroupSize;
+  int RowCount;
+  /// CSV lines of the current group of rows
+  QByteArray Buffer;
+  /// Columnar values of the current group of rows
+  QVector<QStringList> Columns;
+};
+
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabase::exportMetadata(QIODevice* device, const QStringList& tags,
+                                      ExportFormat format, int rowGroupSize)
+{
+  Q_D(ctkDICOMDatabase);
+  if (!device || !device->isWritable())
+    {
+    return false;
+    }
+  d->flushPrecachedTags();
+
+  // Both queries are sorted by SOPInstanceUID, which is the primary key of
+  // the Images and TagCache tables: they are streamed without being sorted
+  // and merged row by row.
+  QSqlQuery instances(d->Database);
+  instances.setForwardOnly(true);
+  if (!d->loggedExec(instances,
+        "SELECT Patients.UID AS PatientsUID, PatientsName, PatientID, "
+        "PatientsBirthDate, PatientsBirthTime, PatientsSex, PatientsAge, PatientsComments, "
+        "Studies.StudyInstanceUID AS StudyInstanceUID, StudyID, StudyDate, StudyTime, "
+        "AccessionNumber, ModalitiesInStudy, InstitutionName, ReferringPhysician, "
+        "PerformingPhysiciansName, StudyDescription, "
+        "Series.SeriesInstanceUID AS SeriesInstanceUID, SeriesNumber, SeriesDate, SeriesTime, "
+        "SeriesDescription, Modality, BodyPartExamined, FrameOfReferenceUID, "
+        "AcquisitionNumber, ContrastAgent, ScanningSequence, EchoNumber, TemporalPosition, "
+        "Images.SOPInstanceUID AS SOPInstanceUID, Filename, InsertTimestamp, FileSize "
+        "FROM Images "
+        "JOIN Series ON Images.SeriesInstanceUID = Series.SeriesInstanceUID "
+        "JOIN Studies ON Series.StudyInstanceUID = Studies.StudyInstanceUID "
+        "JOIN Patients ON Studies.PatientsUID = Patients.UID "
+        "ORDER BY Images.SOPInstanceUID"))
+    {
+    return false;
+    }
+
+  QHash<QString, int> tagColumns;
+  for (int i = 0; i < tags.count(); ++i)
+    {
+    tagColumns.insert(tags[i], i);
+    }
+  QSqlQuery cachedValues(d->TagCacheDatabase);
+  cachedValues.setForwardOnly(true);
+  bool hasCachedValue = false;
+  if (!tags.isEmpty() && this->tagCacheExists())
+    {
+    // SQLite limits the number of bound parameters, the values of many tags
+    // are filtered by tagColumns instead
+    QString tagFilter;
+    if (tags.count() <= 900)
+      {
+      QStringList tagMarks;
+      for (int i = 0; i < tags.count(); ++i)
+        {
+        tagMarks << "?";
+        }
+      tagFilter = QString("WHERE Tag IN (%1) ").arg(tagMarks.join(","));
+      }
+    cachedValues.prepare( QString("SELECT SOPInstanceUID, Tag, Value FROM TagCache %1"
+                                  "ORDER BY SOPInstanceUID").arg(tagFilter) );
+    if (!tagFilter.isEmpty())
+      {
+      foreach (const QString& tag, tags)
+        {
+        cachedValues.addBindValue(tag);
+        }
+      }
+    if (!d->loggedExec(cachedValues))
+      {
+      return false;
+      }
+    hasCachedValue = cachedValues.next();
+    }
+
+  QSqlRecord record = instances.record();
+  const int instanceColumnCount = record.count();
+  const int uidColumn = record.indexOf("SOPInstanceUID");
+  QStringList columns;
+  for (int i = 0; i < instanceColumnCount; ++i)
+    {
+    columns << record.fieldName(i);
+    }
+  columns << tags;
+
+  ctkDICOMMetadataExporter exporter(device, format, qMax(1, rowGroupSize));
+  if (!exporter.writeHeader(columns))
+    {
+    return false;
+    }
+  while (instances.next())
+    {
+    QStringList values;
+    for (int i = 0; i < instanceColumnCount; ++i)
+      {
+      values << instances.value(i).toString();
+      }
+    for (int i = 0; i < tags.count(); ++i)
+      {
+      values << QString();
+      }
+    const QString sopInstanceUID = values[uidColumn];
+    // skip the values cached for instances no longer in the database
+    while (hasCachedValue && cachedValues.value(0).toString() < sopInstanceUID)
+      {
+      hasCachedValue = cachedValues.next();
+      }
+    while (hasCachedValue && cachedValues.value(0).toString() == sopInstanceUID)
+      {
+      int tagColumn = tagColumns.value(cachedValues.value(1).toString(), -1);
+      QString value = cachedValues.value(2).toString();
+      if (tagColumn >= 0 && value != TagNotInInstance)
+        {
+        values[instanceColumnCount + tagColumn] = value;
+        }
+      hasCachedValue = cachedValues.next();
+      }
+    if (!exporter.writeRow(values))
+      {
+      return false;
+      }
+    }
+  return exporter.finish();
 }
@@ -22,17 +22,22 @@
 #define __ctkDICOMDatabase_h
 
 // Qt includes
+#include <QDateTime>
+#include <QHash>
 #include <QObject>
 #include <QStringList>
 #include <QSqlDatabase>
+#include <QVariant>
 
 #include "ctkDICOMItem.h"
 #include "ctkDICOMCoreExport.h"
 
-class QDateTime;
 class ctkDICOMDatabasePrivate;
 class DcmDataset;
 class ctkDICOMAbstractThumbnailGenerator;
+class ctkDICOMOperationToken;
+class ctkDICOMThumbnailQueue;
+class QIODevice;
 
 /// \ingroup DICOM_Core
 ///
@@ -57,6 +62,8 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMDatabase : public QObject
   Q_PROPERTY(QString lastError READ lastError)
   Q_PROPERTY(QString databaseFilename READ databaseFilename)
   Q_PROPERTY(QStringList tagsToPrecache READ tagsToPrecache WRITE setTagsToPrecache)
+  Q_PROPERTY(bool writeAheadLogging READ writeAheadLogging WRITE setWriteAheadLogging)
+  Q_PROPERTY(int pageCacheSize READ pageCacheSize WRITE setPageCacheSize)
 
 public:
   explicit ctkDICOMDatabase(QObject *parent = 0);
@@ -64,6 +71,17 @@ public:
   virtual ~ctkDICOMDatabase();
 
   const QSqlDatabase& database() const;
+  ///
+  /// Returns a read-only connection to the database file for the calling
+  /// thread. Unlike database(), which belongs to the thread that opened
+  /// the database, it can be used by worker threads (e.g. sorting or
+  /// thumbnail jobs). The connection is opened the first time a thread
+  /// asks for it, with the same SQLite tuning options as database(), and
+  /// is removed when the thread finishes or when the database is closed.
+  /// Returns an invalid connection for in-memory databases, which can't
+  /// be shared, or if the schema of the file is not schemaVersion().
+  /// This method is thread safe.
+  QSqlDatabase readerConnection();
   const QString lastError() const;
   const QString databaseFilename() const;
 
@@ -92,6 +110,31 @@ public:
   /// get thumbnail genrator object
   ctkDICOMAbstractThumbnailGenerator* thumbnailGenerator();
 
+  ///
+  /// Queue generating the thumbnails with thumbnailGenerator().
+  /// insert() only queues the thumbnail of the first instance of each
+  /// series, the others are generated by requestThumbnail().
+  ctkDICOMThumbnailQueue* thumbnailQueue();
+
+  ///
+  /// Token canceling and following the progress of the long operations,
+  /// updateSchema() and cleanup(). It is not owned by the database.
+  void setOperationToken(ctkDICOMOperationToken* token);
+  ctkDICOMOperationToken* operationToken()const;
+
+  ///
+  /// Path of the thumbnail of an instance, the file may not exist yet.
+  Q_INVOKABLE QString thumbnailPathForInstance(const QString& studyInstanceUID,
+    const QString& seriesInstanceUID, const QString& sopInstanceUID);
+
+  ///
+  /// Queue generating the thumbnail of an instance ahead of the other
+  /// thumbnails. ctkDICOMThumbnailQueue::thumbnailGenerated() is emitted
+  /// once it is generated.
+  /// Returns false if the thumbnail is up to date or can't be generated.
+  Q_INVOKABLE bool requestThumbnail(const QString& studyInstanceUID,
+    const QString& seriesInstanceUID, const QString& sopInstanceUID);
+
   ///
   /// open the SQLite database in @param databaseFile . If the file does not
   /// exist, a new database is created and initialized with the
@@ -103,9 +146,30 @@ public:
   ///        thus expires after destruction of this object).
   /// @param connectionName The database connection name.
   /// @param update the schema if it is found to be out of date
+  ///
+  /// The SQLite tuning options (writeAheadLogging, memoryMappedIOSize and
+  /// pageCacheSize) are applied when the database is opened, they must be
+  /// set before calling openDatabase.
   Q_INVOKABLE virtual void openDatabase(const QString databaseFile,
                                         const QString& connectionName = "DICOM-DB");
 
+  ///
+  /// Use SQLite write-ahead logging (WAL) journaling, so that readers are
+  /// not blocked while the database is written (e.g. by the indexer).
+  /// Ignored for in-memory databases. Default is false.
+  void setWriteAheadLogging(bool enable);
+  bool writeAheadLogging()const;
+  ///
+  /// Maximum number of bytes of the database file SQLite accesses using
+  /// memory-mapped I/O. 0 (default) keeps the SQLite default.
+  void setMemoryMappedIOSize(qint64 bytes);
+  qint64 memoryMappedIOSize()const;
+  ///
+  /// Size in KiB of the SQLite page cache of each connection.
+  /// 0 (default) keeps the SQLite default.
+  void setPageCacheSize(int kibibytes);
+  int pageCacheSize()const;
+
   ///
   /// close the database. It must not be used afterwards.
   Q_INVOKABLE void closeDatabase();
@@ -114,9 +178,13 @@ public:
   Q_INVOKABLE bool initializeDatabase(const char* schemaFile = ":/dicom/dicom-schema.sql");
 
   /// updates the database schema and reinserts all existing files
+  /// The update can be canceled with operationToken(): the files that were
+  /// not reinserted are then kept in a backup table, and the next call to
+  /// updateSchemaIfNeeded() runs the update again. Returns false if canceled.
   Q_INVOKABLE bool updateSchema(const char* schemaFile = ":/dicom/dicom-schema.sql");
 
-  /// updates the database schema only if the versions don't match
+  /// updates the database schema only if the versions don't match, or if
+  /// a previous update was canceled
   /// Returns true if schema was updated
   Q_INVOKABLE bool updateSchemaIfNeeded(const char* schemaFile = ":/dicom/dicom-schema.sql");
 
@@ -139,6 +207,17 @@ public:
   Q_INVOKABLE QString descriptionForSeries(const QString seriesUID);
   Q_INVOKABLE QString descriptionForStudy(const QString studyUID);
   Q_INVOKABLE QString nameForPatient(const QString patientUID);
+  ///
+  /// Aggregates of the instances of a series or a study. They are stored in
+  /// the Series and Studies tables and maintained by insert() and the
+  /// remove methods, the Images table is not scanned.
+  Q_INVOKABLE int instanceCountForSeries(const QString seriesUID);
+  Q_INVOKABLE qint64 totalBytesForSeries(const QString seriesUID);
+  Q_INVOKABLE QDateTime firstInsertDateTimeForSeries(const QString seriesUID);
+  Q_INVOKABLE QDateTime lastInsertDateTimeForSeries(const QString seriesUID);
+  Q_INVOKABLE int seriesCountForStudy(const QString studyUID);
+  Q_INVOKABLE int instanceCountForStudy(const QString studyUID);
+  Q_INVOKABLE QStringList modalitiesForStudy(const QString studyUID);
   Q_INVOKABLE QString fileForInstance (const QString sopInstanceUID);
   Q_INVOKABLE QString seriesForFile (QString fileName);
   Q_INVOKABLE QString instanceForFile (const QString fileName);
@@ -192,6 +271,85 @@ public:
                             bool storeFile = true, bool generateThumbnail = true,
                             bool createHierarchy = true,
                             const QString& destinationDirectoryName = QString() );
+  /// Insert a dataset that has already been read from \a filePath.
+  /// This avoids parsing the file again, e.g. when the headers are
+  /// parsed on worker threads by ctkDICOMIndexer.
+  void insert ( const ctkDICOMItem& ctkDataset, const QString& filePath,
+                bool storeFile = true, bool generateThumbnail = true);
+  /// Insert the instance \a filePath described by \a dataset, which only
+  /// contains the attributes of the DICOMDIR records referencing it
+  /// (see ctkDICOMIndexer::addDicomdir). The file is neither read, copied
+  /// nor thumbnailed: the tags to precache that are not in \a dataset are
+  /// read from the file the first time they are requested.
+  void insertDirectoryRecord ( const ctkDICOMItem& dataset, const QString& filePath );
+
+  ///
+  /// \brief Group the following inserts into a bulk insert session.
+  ///
+  /// Between beginBulkInsert() and endBulkInsert() the statements used by
+  /// insert() are prepared once and reused, and the inserted instances are
+  /// committed in transactions of bulkInsertTransactionSize() instances or
+  /// every bulkInsertCommitInterval() milliseconds, whichever comes first.
+  /// Sessions can be nested, only the outermost endBulkInsert() commits.
+  Q_INVOKABLE void beginBulkInsert();
+  Q_INVOKABLE void endBulkInsert();
+  Q_INVOKABLE bool isBulkInserting()const;
+  /// End the session like endBulkInsert() but roll back the instances
+  /// inserted since the last commit of the session instead of committing
+  /// them. The instances committed before stay in the database. Within
+  /// nested sessions the outermost endBulkInsert() rolls back.
+  Q_INVOKABLE void abortBulkInsert();
+
+  /// Number of instances committed at once during a bulk insert.
+  /// Default is 100.
+  void setBulkInsertTransactionSize(int instanceCount);
+  int bulkInsertTransactionSize()const;
+
+  /// Maximum time in milliseconds a bulk insert transaction stays open.
+  /// Default is 1000.
+  void setBulkInsertCommitInterval(int msec);
+  int bulkInsertCommitInterval()const;
+
+  ///
+  /// \brief Timing of the insert phases
+  ///
+  /// When the statistics are enabled, the number of calls and the time
+  /// spent are accumulated for each phase of insert(). The headers parsed
+  /// by the callers, e.g. ctkDICOMIndexer, are timed by them (see
+  /// addInsertPhaseTime()). The thumbnail phase only queues the
+  /// thumbnails, they are generated by thumbnailQueue().
+  /// The statistics can also be enabled by setting the
+  /// CTK_DICOM_DATABASE_STATISTICS environment variable to the log
+  /// interval in seconds, 0 to enable them without logging.
+  enum InsertPhase
+    {
+    ParsePhase = 0,
+    InstanceCheckPhase,
+    PatientPhase,
+    StudyPhase,
+    SeriesPhase,
+    ImagePhase,
+    FileCopyPhase,
+    PrecachePhase,
+    ThumbnailPhase,
+    CommitPhase,
+    InsertPhaseCount
+    };
+  Q_INVOKABLE void setStatisticsEnabled(bool enabled);
+  Q_INVOKABLE bool statisticsEnabled()const;
+  /// Seconds between two log lines of the statistics written by insert(),
+  /// 0 (the default) disables the log.
+  Q_INVOKABLE void setStatisticsLogInterval(int seconds);
+  Q_INVOKABLE int statisticsLogInterval()const;
+  /// Returns the number of "insertedInstances" and, for each phase
+  /// ("parse", "instanceCheck", "patient", "study", "series", "image",
+  /// "fileCopy", "precache", "thumbnail" and "commit"), a map with the
+  /// "count" of timed calls and the total "seconds".
+  Q_INVOKABLE QVariantMap statistics()const;
+  Q_INVOKABLE void resetStatistics();
+  /// Add the time of a phase run outside of the database. Ignored if the
+  /// statistics are disabled. This method is thread safe.
+  void addInsertPhaseTime(InsertPhase phase, qint64 nanoseconds);
 
   /// Check if file is already in database and up-to-date
   bool fileExistsAndUpToDate(const QString& filePath);
@@ -201,8 +359,39 @@ public:
   Q_INVOKABLE bool removeSeries(const QString& seriesInstanceUID);
   Q_INVOKABLE bool removeStudy(const QString& studyInstanceUID);
   Q_INVOKABLE bool removePatient(const QString& patientID);
+  ///
+  /// Remove many series, studies or patients (database UIDs) at once.
+  /// The rows are deleted by a few set-based statements within a single
+  /// transaction, and the stored files and thumbnails are then removed by
+  /// a background thread (see waitForFileRemoval()).
+  /// If incrementalVacuum is true, the free pages are returned to the file
+  /// system afterwards. This requires a database created with
+  /// auto_vacuum = INCREMENTAL, which is the case of the databases
+  /// initialized by this class.
+  Q_INVOKABLE bool removeSeries(const QStringList& seriesInstanceUIDs, bool incrementalVacuum = false);
+  Q_INVOKABLE bool removeStudies(const QStringList& studyInstanceUIDs, bool incrementalVacuum = false);
+  Q_INVOKABLE bool removePatients(const QStringList& patientUIDs, bool incrementalVacuum = false);
+  /// Block until the files of the removed series are deleted.
+  Q_INVOKABLE void waitForFileRemoval();
+  /// remove the images of the given files from the database, including
+  /// their thumbnails, and the series, studies and patients left empty.
+  /// The files themselves are not touched.
+  Q_INVOKABLE bool removeFiles(const QStringList& fileNames);
+  /// remove the series, studies and patients left empty, in a single
+  /// transaction which is rolled back if operationToken() is canceled.
   bool cleanup();
 
+  /// Insert time stamps of all the files below directoryName, read by
+  /// a single query.
+  Q_INVOKABLE QHash<QString, QDateTime> insertDateTimesForDirectory(const QString& directoryName);
+
+  /// Fingerprints of the content of directoryName and of its
+  /// subdirectories, as stored by setDirectoryFingerprints().
+  /// \sa ctkDICOMIndexer::refreshDatabase
+  Q_INVOKABLE QHash<QString, QString> directoryFingerprints(const QString& directoryName);
+  Q_INVOKABLE bool setDirectoryFingerprints(const QHash<QString, QString>& fingerprints);
+  Q_INVOKABLE bool removeDirectoryFingerprints(const QStringList& directoryNames);
+
   ///
   /// \brief access element values for given instance
   /// @param sopInstanceUID A string with the uid for a given instance
@@ -240,6 +429,63 @@ public:
   /// Insert lists of tags into the cache as a batch query operation
   Q_INVOKABLE bool cacheTags (const QStringList sopInstanceUIDs, const QStringList tags, const QStringList values);
 
+  ///
+  /// \brief Bulk version of instanceValue()
+  ///
+  /// The values that are not yet in memory are fetched from the tag cache
+  /// with one query per chunk of instances, the values missing from the tag
+  /// cache are read from the files.
+  /// @Returns for each instance of sopInstanceUIDs the list of values of tags
+  QList<QStringList> instanceValues (const QStringList sopInstanceUIDs, const QStringList tags);
+
+  ///
+  /// \brief Bulk version of fileValue()
+  ///
+  /// Each file with values missing from the tag cache is parsed once, up to
+  /// the last missing tag, for all its missing values. The values read from
+  /// the files are written into the tag cache in one batch.
+  /// @Returns for each file of fileNames the list of values of tags
+  QList<QStringList> fileValues (const QStringList fileNames, const QList<DcmTagKey> tags);
+
+  ///
+  /// \brief In-memory least recently used cache in front of the tag cache
+  ///
+  /// cachedTag() first looks up the value in this cache and only queries
+  /// the tag cache database on a miss. Default size is 100000 values.
+  void setTagValueCacheSize(int entryCount);
+  int tagValueCacheSize()const;
+  /// Number of cachedTag() lookups answered from memory (hits) or not (misses)
+  int tagValueCacheHits()const;
+  int tagValueCacheMisses()const;
+  void resetTagValueCacheStatistics();
+
+  ///
+  /// \brief Export the metadata of all the instances for analytics
+  ///
+  /// One row is written per instance, with the columns of its Patients,
+  /// Studies, Series and Images rows followed by one column per tag of
+  /// \a tags. The tag values are taken from the tag cache only, tags that
+  /// are not cached are exported empty (see instanceValues() to cache
+  /// them). The tables and the tag cache are each read by a single query
+  /// sorted by SOPInstanceUID and merged while the rows are written, so
+  /// that at most rowGroupSize rows are held in memory.
+  ///
+  /// ExportCSV writes UTF-8 comma-separated values with a header line.
+  /// ExportColumnar writes, with a QDataStream (Qt_4_6):
+  ///  - the quint32 magic 0x43544b4d ("CTKM") and the quint32 version 1
+  ///  - the QStringList of column names
+  ///  - groups of rows, each a qint32 row count followed by one
+  ///    QStringList of values per column
+  ///  - a qint32 0 ending the groups
+  enum ExportFormat
+    {
+    ExportCSV = 0,
+    ExportColumnar
+    };
+  /// @Returns false if \a device is not writable or a query failed
+  bool exportMetadata(QIODevice* device, const QStringList& tags,
+                      ExportFormat format = ExportCSV, int rowGroupSize = 4096);
+
 
 Q_SIGNALS:
   /// Things inserted to database.
@@ -269,6 +515,10 @@ Q_SIGNALS:
   /// Indicates schema update finished
   void schemaUpdated();
 
+protected Q_SLOTS:
+  /// Remove the reader connection of the finished thread.
+  void onReaderThreadFinished();
+
 protected:
   QScopedPointer<ctkDICOMDatabasePrivate> d_ptr;
 
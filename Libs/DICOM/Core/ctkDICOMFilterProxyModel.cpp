@@ -18,6 +18,10 @@
 
 =========================================================================*/
 
+// Qt includes
+#include <QRegExp>
+#include <QTimer>
+
 #include "ctkDICOMFilterProxyModel.h"
 
 #include "ctkDICOMModel.h"
@@ -27,6 +31,38 @@
 static ctkLogger logger("org.commontk.DICOM.Core.ctkDICOMFilterProxyModel");
 
 
+//----------------------------------------------------------------------------
+// Search text compiled once, when it is set
+class ctkDICOMSearchPattern
+{
+public:
+  ctkDICOMSearchPattern() : UseRegExp(false){}
+
+  void setText(const QString& text){
+    this->Text = text;
+    this->UseRegExp = ctkDICOMSearchPattern::hasMetaCharacters(text);
+    this->RegExp = this->UseRegExp ? QRegExp(text) : QRegExp();
+  }
+
+  bool matches(const QString& value)const{
+    return this->UseRegExp ? value.contains(this->RegExp) : value.contains(this->Text);
+  }
+
+  static bool hasMetaCharacters(const QString& text){
+    static const QString metaCharacters("\\^$.|?*+()[]{}");
+    for (int i = 0; i < text.size(); ++i){
+      if (metaCharacters.contains(text.at(i))){
+        return true;
+      }
+    }
+    return false;
+  }
+
+  QString Text;
+  bool UseRegExp;
+  QRegExp RegExp;
+};
+
 //----------------------------------------------------------------------------
 class ctkDICOMFilterProxyModelPrivate
 {
@@ -36,23 +72,84 @@ protected:
 
 public:
   ctkDICOMFilterProxyModelPrivate(ctkDICOMFilterProxyModel* parent = 0);
+  void init();
+
+  /// Update the filter after filterDelay ms, or now without delay
+  void scheduleFilter();
 
-  QString searchTextName;
-  QString searchTextStudy;
-  QString searchTextSeries;
+  /// Pass the search texts to the source model, or remove them if
+  /// SqlFiltering is disabled. Return false if the source model isn't a
+  /// ctkDICOMModel.
+  bool updateSearchParameters();
+
+  ctkDICOMSearchPattern searchTextName;
+  ctkDICOMSearchPattern searchTextStudy;
+  ctkDICOMSearchPattern searchTextSeries;
   QString searchTextID;
+
+  QTimer* filterTimer;
+  bool SqlFiltering;
 };
 
 //----------------------------------------------------------------------------
-ctkDICOMFilterProxyModelPrivate::ctkDICOMFilterProxyModelPrivate(ctkDICOMFilterProxyModel* parent): q_ptr(parent){
+ctkDICOMFilterProxyModelPrivate::ctkDICOMFilterProxyModelPrivate(ctkDICOMFilterProxyModel* parent): q_ptr(parent),
+    filterTimer(0), SqlFiltering(false){
 
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModelPrivate::init(){
+    Q_Q(ctkDICOMFilterProxyModel);
+    this->filterTimer = new QTimer(q);
+    this->filterTimer->setSingleShot(true);
+    this->filterTimer->setInterval(300);
+    QObject::connect(this->filterTimer, SIGNAL(timeout()), q, SLOT(applyPendingFilter()));
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModelPrivate::scheduleFilter(){
+    Q_Q(ctkDICOMFilterProxyModel);
+    if(this->filterTimer->interval() <= 0){
+        q->invalidateFilter();
+        return;
+    }
+    // restart the timer, the filter is updated when the text doesn't change anymore
+    this->filterTimer->start();
+}
+
+//----------------------------------------------------------------------------
+bool ctkDICOMFilterProxyModelPrivate::updateSearchParameters(){
+    Q_Q(ctkDICOMFilterProxyModel);
+    ctkDICOMModel* model = qobject_cast<ctkDICOMModel*>(q->sourceModel());
+    if(!model){
+        return false;
+    }
+    QMap<QString, QVariant> parameters = model->searchParameters();
+    QMap<QString, QVariant> searchTexts;
+    searchTexts["Name"] = this->searchTextName.Text;
+    searchTexts["Study"] = this->searchTextStudy.Text;
+    searchTexts["Series"] = this->searchTextSeries.Text;
+    searchTexts["ID"] = this->searchTextID;
+    bool changed = false;
+    foreach(const QString& key, searchTexts.keys()){
+        QString text = this->SqlFiltering ? searchTexts[key].toString() : QString();
+        if(parameters.value(key).toString() != text){
+            parameters[key] = text;
+            changed = true;
+        }
+    }
+    if(changed){
+        model->setSearchParameters(parameters);
+    }
+    return true;
+}
+
 //----------------------------------------------------------------------------
 ctkDICOMFilterProxyModel::ctkDICOMFilterProxyModel(QObject *parent):Superclass(parent),
     d_ptr(new ctkDICOMFilterProxyModelPrivate(this))
 {
-
+    Q_D(ctkDICOMFilterProxyModel);
+    d->init();
 }
 
 //----------------------------------------------------------------------------
@@ -63,61 +160,117 @@ ctkDICOMFilterProxyModel::~ctkDICOMFilterProxyModel(){
 //----------------------------------------------------------------------------
 void ctkDICOMFilterProxyModel::setNameSearchText(const QString &text){
     Q_D(ctkDICOMFilterProxyModel);
-    d->searchTextName = text;
-    this->invalidateFilter();
+    if(text == d->searchTextName.Text){
+        return;
+    }
+    d->searchTextName.setText(text);
+    d->scheduleFilter();
 }
 
 //----------------------------------------------------------------------------
 void ctkDICOMFilterProxyModel::setStudySearchText(const QString &text){
     Q_D(ctkDICOMFilterProxyModel);
-    d->searchTextStudy = text;
-    this->invalidateFilter();
+    if(text == d->searchTextStudy.Text){
+        return;
+    }
+    d->searchTextStudy.setText(text);
+    d->scheduleFilter();
 }
 
 //----------------------------------------------------------------------------
 void ctkDICOMFilterProxyModel::setSeriesSearchText(const QString &text){
     Q_D(ctkDICOMFilterProxyModel);
-    d->searchTextSeries = text;
-    this->invalidateFilter();
+    if(text == d->searchTextSeries.Text){
+        return;
+    }
+    d->searchTextSeries.setText(text);
+    d->scheduleFilter();
 }
 
 //----------------------------------------------------------------------------
 void ctkDICOMFilterProxyModel::setIdSearchText(const QString &text){
     Q_D(ctkDICOMFilterProxyModel);
+    if(text == d->searchTextID){
+        return;
+    }
     d->searchTextID = text;
+    d->scheduleFilter();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModel::setFilterDelay(int delay){
+    Q_D(ctkDICOMFilterProxyModel);
+    d->filterTimer->setInterval(delay);
+}
+
+//----------------------------------------------------------------------------
+int ctkDICOMFilterProxyModel::filterDelay()const{
+    Q_D(const ctkDICOMFilterProxyModel);
+    return d->filterTimer->interval();
+}
+
+//----------------------------------------------------------------------------
+bool ctkDICOMFilterProxyModel::isFilterPending()const{
+    Q_D(const ctkDICOMFilterProxyModel);
+    return d->filterTimer->isActive();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModel::applyPendingFilter(){
+    Q_D(ctkDICOMFilterProxyModel);
+    d->filterTimer->stop();
+    if(d->SqlFiltering && d->updateSearchParameters()){
+        return;
+    }
     this->invalidateFilter();
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMFilterProxyModel::setSqlFiltering(bool enable){
+    Q_D(ctkDICOMFilterProxyModel);
+    if(enable == d->SqlFiltering){
+        return;
+    }
+    d->SqlFiltering = enable;
+    d->filterTimer->stop();
+    // move the search texts to the source model or back
+    d->updateSearchParameters();
+    this->invalidateFilter();
+}
+
+//----------------------------------------------------------------------------
+bool ctkDICOMFilterProxyModel::sqlFiltering()const{
+    Q_D(const ctkDICOMFilterProxyModel);
+    return d->SqlFiltering;
+}
+
+//----------------------------------------------------------------------------
 bool ctkDICOMFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const{
     Q_D(const ctkDICOMFilterProxyModel);
 
-    ctkDICOMModel* model = const_cast<ctkDICOMModel*>(qobject_cast<const ctkDICOMModel*>(this->sourceModel()));
-
-    if(model){
-        QModelIndex index = model->index(source_row, 0, source_parent);
-        if(model->data(index, ctkDICOMModel::TypeRole) == static_cast<int>(ctkDICOMModel::PatientType)){
-            QRegExp regExp = QRegExp(d->searchTextName);
-            if(model->data(index, Qt::DisplayRole).toString().contains(regExp)){
-                return true;
-            }else{
-                return false;
-            }
-        }else if(model->data(index, ctkDICOMModel::TypeRole) == static_cast<int>(ctkDICOMModel::StudyType)){
-            QRegExp regExp = QRegExp(d->searchTextStudy);
-            if(model->data(index, Qt::DisplayRole).toString().contains(regExp)){
-                return true;
-            }else{
-                return false;
-            }
-        }else if(model->data(index, ctkDICOMModel::TypeRole) == static_cast<int>(ctkDICOMModel::SeriesType)){
-            QRegExp regExp = QRegExp(d->searchTextSeries);
-            if(model->data(index, Qt::DisplayRole).toString().contains(regExp)){
-                return true;
-            }else{
-                return false;
-            }
-        }
+    const QAbstractItemModel* model = this->sourceModel();
+    if(d->SqlFiltering || !qobject_cast<const ctkDICOMModel*>(model)){
+        // the source model only contains the matching rows
+        return true;
     }
 
-    return true;
+    QModelIndex index = model->index(source_row, 0, source_parent);
+    const ctkDICOMSearchPattern* pattern = 0;
+    switch(model->data(index, ctkDICOMModel::TypeRole).toInt()){
+    case ctkDICOMModel::PatientType:
+        pattern = &d->searchTextName;
+        break;
+    case ctkDICOMModel::StudyType:
+        pattern = &d->searchTextStudy;
+        break;
+    case ctkDICOMModel::SeriesType:
+        pattern = &d->searchTextSeries;
+        break;
+    default:
+        return true;
+    }
+    if(pattern->Text.isEmpty()){
+        return true;
+    }
+    return pattern->matches(model->data(index, Qt::DisplayRole).toString());
 }
@@ -29,8 +29,16 @@
 class ctkDICOMFilterProxyModelPrivate;
 
 /// \ingroup DICOM_Core
+/// Filters the patients, studies and series of a ctkDICOMModel by their
+/// display text. A search text without regular expression metacharacters is
+/// matched as a plain substring. The filter is updated filterDelay ms after
+/// the last change of a search text, so that typing re-filters the rows once.
+/// With sqlFiltering, the search texts are passed to the source ctkDICOMModel
+/// instead, which fetches only the matching rows from the database.
 class CTK_DICOM_CORE_EXPORT ctkDICOMFilterProxyModel : public QSortFilterProxyModel{
     Q_OBJECT
+    Q_PROPERTY(int filterDelay READ filterDelay WRITE setFilterDelay)
+    Q_PROPERTY(bool sqlFiltering READ sqlFiltering WRITE setSqlFiltering)
 
 public:
     typedef QSortFilterProxyModel Superclass;
@@ -39,6 +47,23 @@ public:
 
     virtual bool filterAcceptsRow ( int source_row, const QModelIndex & source_parent ) const;
 
+    /// Delay in ms between the last change of a search text and the update
+    /// of the filter, 300ms by default. With 0, the filter is updated by the
+    /// setters.
+    void setFilterDelay(int delay);
+    int filterDelay()const;
+
+    /// Return true if a search text changed and the filter is not updated yet
+    bool isFilterPending()const;
+
+    /// Filter the rows with SQL conditions on the queries of the source
+    /// ctkDICOMModel (see ctkDICOMModel::setSearchParameters()) rather than
+    /// by matching the fetched rows. The search texts are then matched as
+    /// substrings, regular expressions are not supported. False by default.
+    /// Ignored if the source model isn't a ctkDICOMModel.
+    void setSqlFiltering(bool enable);
+    bool sqlFiltering()const;
+
 protected:
     QScopedPointer<ctkDICOMFilterProxyModelPrivate> d_ptr;
 
@@ -51,6 +76,9 @@ public Q_SLOTS:
     void setStudySearchText(const QString& text);
     void setSeriesSearchText(const QString& text);
     void setIdSearchText(const QString& text);
+
+    /// Update the filter now if a search text changed
+    void applyPendingFilter();
 };
 
 #endif
@@ -30,12 +30,26 @@
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QDebug>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#if QT_VERSION >= 0x040800
+# include <QElapsedTimer>
+#else
+# include <QTime>
+#endif
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
 
 // ctkDICOM includes
 #include "ctkLogger.h"
 #include "ctkDICOMIndexer.h"
 #include "ctkDICOMIndexer_p.h"
 #include "ctkDICOMDatabase.h"
+#include "ctkDICOMItem.h"
+#include "ctkDICOMOperationToken.h"
 
 // DCMTK includes
 #include <dcmtk/dcmdata/dcfilefo.h>
@@ -55,20 +69,227 @@ static ctkLogger logger("org.commontk.dicom.DICOMIndexer" );
 //------------------------------------------------------------------------------
 
 
+//------------------------------------------------------------------------------
+/// Parses DICOM headers (up to the pixel data) on a thread of the indexer parser pool and hands
+/// the resulting datasets over to the writer.
+class ctkDICOMIndexerParser : public QRunnable
+{
+public:
+  ctkDICOMIndexerParser(ctkDICOMIndexerPrivate* indexer)
+    : Indexer(indexer)
+  {
+  }
+
+  virtual void run()
+  {
+    QString filePath;
+    while (this->Indexer->takeNextFileToParse(filePath))
+      {
+      ctkDICOMIndexerPrivate::ParsedFile parsedFile;
+      parsedFile.FilePath = filePath;
+      parsedFile.Dataset = new ctkDICOMItem;
+      parsedFile.ParseNanoseconds = 0;
+      if (this->Indexer->TimeParsers)
+        {
+#if QT_VERSION >= 0x040800
+        QElapsedTimer timer;
+        timer.start();
+        parsedFile.Dataset->InitializeFromFileHeader(filePath);
+        parsedFile.ParseNanoseconds = timer.nsecsElapsed();
+#else
+        QTime timer;
+        timer.start();
+        parsedFile.Dataset->InitializeFromFileHeader(filePath);
+        parsedFile.ParseNanoseconds = static_cast<qint64>(timer.elapsed()) * 1000000;
+#endif
+        }
+      else
+        {
+        parsedFile.Dataset->InitializeFromFileHeader(filePath);
+        }
+      this->Indexer->enqueueParsedFile(parsedFile);
+      }
+    this->Indexer->parserFinished();
+  }
+
+private:
+  ctkDICOMIndexerPrivate* Indexer;
+};
+
 //------------------------------------------------------------------------------
 // ctkDICOMIndexerPrivate methods
 
 //------------------------------------------------------------------------------
-ctkDICOMIndexerPrivate::ctkDICOMIndexerPrivate(ctkDICOMIndexer& o) : q_ptr(&o), Canceled(false)
+ctkDICOMIndexerPrivate::ctkDICOMIndexerPrivate(ctkDICOMIndexer& o)
+  : q_ptr(&o)
+  , Canceled(false)
+  , NumberOfParserThreads(0)
+  , MaximumQueueSize(64)
+  , NextFileToParse(0)
+  , ActiveParsers(0)
+  , TimeParsers(false)
 {
 }
 
 //------------------------------------------------------------------------------
 ctkDICOMIndexerPrivate::~ctkDICOMIndexerPrivate()
 {
+  this->stopParsers();
 }
 
 //------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivate::startParsers(const QStringList& filesToParse, bool timeParsers)
+{
+  int threadCount = this->NumberOfParserThreads > 0 ?
+    this->NumberOfParserThreads : QThread::idealThreadCount();
+  threadCount = qMax(1, qMin(threadCount, filesToParse.count()));
+  this->ParserPool.setMaxThreadCount(threadCount);
+
+  {
+  QMutexLocker locker(&this->QueueMutex);
+  this->FilesToParse = filesToParse;
+  this->NextFileToParse = 0;
+  this->ActiveParsers = filesToParse.isEmpty() ? 0 : threadCount;
+  this->TimeParsers = timeParsers;
+  }
+
+  for (int i = 0; i < this->ActiveParsers; ++i)
+    {
+    this->ParserPool.start(new ctkDICOMIndexerParser(this));
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivate::stopParsers()
+{
+  {
+  QMutexLocker locker(&this->QueueMutex);
+  this->FilesToParse.clear();
+  this->NextFileToParse = 0;
+  this->QueueNotFull.wakeAll();
+  }
+  this->ParserPool.waitForDone();
+
+  QMutexLocker locker(&this->QueueMutex);
+  while (!this->ParsedFiles.isEmpty())
+    {
+    delete this->ParsedFiles.dequeue().Dataset;
+    }
+  this->ActiveParsers = 0;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMIndexerPrivate::directoryFingerprint(const QString& directoryName,
+                                                     const QFileInfoList& files)
+{
+  // The modification time of a directory changes when files are added,
+  // removed or renamed but not when they are modified, hence the size
+  // and modification time of the files are part of the fingerprint.
+  qint64 totalSize = 0;
+  uint lastModified = 0;
+  foreach(const QFileInfo& fileInfo, files)
+    {
+    totalSize += fileInfo.size();
+    lastModified = qMax(lastModified, fileInfo.lastModified().toTime_t());
+    }
+
+  qint64 inode = 0;
+#ifndef _WIN32
+  struct stat status;
+  if (stat(QFile::encodeName(directoryName).constData(), &status) == 0)
+    {
+    inode = static_cast<qint64>(status.st_ino);
+    }
+#endif
+
+  return QString("%1:%2:%3:%4:%5")
+    .arg(QFileInfo(directoryName).lastModified().toTime_t())
+    .arg(inode)
+    .arg(files.count())
+    .arg(totalSize)
+    .arg(lastModified);
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMIndexerPrivate::takeNextFileToParse(QString& filePath)
+{
+  QMutexLocker locker(&this->QueueMutex);
+  if (this->Canceled || this->NextFileToParse >= this->FilesToParse.count())
+    {
+    return false;
+    }
+  filePath = this->FilesToParse[this->NextFileToParse++];
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivate::enqueueParsedFile(const ParsedFile& parsedFile)
+{
+  QMutexLocker locker(&this->QueueMutex);
+  while (this->ParsedFiles.count() >= this->MaximumQueueSize &&
+         !this->Canceled && !this->FilesToParse.isEmpty())
+    {
+    this->QueueNotFull.wait(&this->QueueMutex);
+    }
+  if (this->Canceled || this->FilesToParse.isEmpty())
+    {
+    // nobody will consume it anymore
+    delete parsedFile.Dataset;
+    return;
+    }
+  this->ParsedFiles.enqueue(parsedFile);
+  this->QueueNotEmpty.wakeOne();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivate::parserFinished()
+{
+  QMutexLocker locker(&this->QueueMutex);
+  --this->ActiveParsers;
+  this->QueueNotEmpty.wakeAll();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMIndexerPrivate::dequeueParsedFile(ParsedFile& parsedFile)
+{
+  QMutexLocker locker(&this->QueueMutex);
+  while (this->ParsedFiles.isEmpty() && this->ActiveParsers > 0 && !this->Canceled)
+    {
+    this->QueueNotEmpty.wait(&this->QueueMutex);
+    }
+  if (this->Canceled || this->ParsedFiles.isEmpty())
+    {
+    return false;
+    }
+  parsedFile = this->ParsedFiles.dequeue();
+  this->QueueNotFull.wakeOne();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMIndexerPrivate::isCanceled()
+{
+  QMutexLocker locker(&this->QueueMutex);
+  return this->Canceled;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivate::startPhase(const QString& phase, int totalItems)
+{
+  if (this->OperationToken)
+    {
+    this->OperationToken->startPhase(phase, totalItems);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivate::setItemsDone(int itemsDone)
+{
+  if (this->OperationToken)
+    {
+    this->OperationToken->setItemsDone(itemsDone);
+    }
+}
 
 //------------------------------------------------------------------------------
 // ctkDICOMIndexer methods
@@ -84,6 +305,44 @@ ctkDICOMIndexer::~ctkDICOMIndexer()
 {
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMIndexer::setNumberOfParserThreads(int threadCount)
+{
+  Q_D(ctkDICOMIndexer);
+  d->NumberOfParserThreads = threadCount;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMIndexer::numberOfParserThreads()const
+{
+  Q_D(const ctkDICOMIndexer);
+  return d->NumberOfParserThreads;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexer::setOperationToken(ctkDICOMOperationToken* token)
+{
+  Q_D(ctkDICOMIndexer);
+  if (d->OperationToken)
+    {
+    disconnect(d->OperationToken, SIGNAL(canceled()), this, SLOT(cancel()));
+    }
+  d->OperationToken = token;
+  if (token)
+    {
+    // cancel() is thread safe, the indexing is stopped without waiting for
+    // the event loop of the indexer thread
+    connect(token, SIGNAL(canceled()), this, SLOT(cancel()), Qt::DirectConnection);
+    }
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMOperationToken* ctkDICOMIndexer::operationToken()const
+{
+  Q_D(const ctkDICOMIndexer);
+  return d->OperationToken;
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMIndexer::addFile(ctkDICOMDatabase& database,
                                    const QString filePath,
@@ -105,6 +364,7 @@ void ctkDICOMIndexer::addDirectory(ctkDICOMDatabase& ctkDICOMDatabase,
                                    const QString& directoryName,
                                    const QString& destinationDirectoryName)
 {
+  Q_D(ctkDICOMIndexer);
   QStringList listOfFiles;
   QDir directory(directoryName);
 
@@ -114,10 +374,16 @@ void ctkDICOMIndexer::addDirectory(ctkDICOMDatabase& ctkDICOMDatabase,
   }
   else
   {
+    d->startPhase("Scanning directory", 0);
     QDirIterator it(directoryName,QDir::Files,QDirIterator::Subdirectories);
     while(it.hasNext())
     {
       listOfFiles << it.next();
+      if (d->OperationToken && d->OperationToken->isCanceled())
+      {
+        emit this->indexingComplete();
+        return;
+      }
     }
     emit foundFilesToIndex(listOfFiles.count());
     addListOfFiles(ctkDICOMDatabase,listOfFiles,destinationDirectoryName);
@@ -130,42 +396,132 @@ void ctkDICOMIndexer::addListOfFiles(ctkDICOMDatabase& ctkDICOMDatabase,
                                      const QString& destinationDirectoryName)
 {
   Q_D(ctkDICOMIndexer);
-  d->Canceled = false;
-  int CurrentFileIndex = 0;
-  foreach(QString filePath, listOfFiles)
   {
-    int percent = ( 100 * CurrentFileIndex ) / listOfFiles.size();
+  QMutexLocker locker(&d->QueueMutex);
+  d->Canceled = d->OperationToken && d->OperationToken->isCanceled();
+  }
+  if (listOfFiles.isEmpty())
+    {
+    emit this->indexingComplete();
+    return;
+    }
+
+  if (!destinationDirectoryName.isEmpty())
+    {
+    logger.warn("Ignoring destinationDirectoryName parameter, just taking it as indication we should copy!");
+    }
+  bool storeFile = !destinationDirectoryName.isEmpty();
+
+  // Files already indexed are not parsed again.
+  int currentFileIndex = 0;
+  QStringList filesToParse;
+  d->startPhase("Checking files", listOfFiles.count());
+  for (int i = 0; i < listOfFiles.count(); ++i)
+    {
+    if (d->isCanceled())
+      {
+      emit this->indexingComplete();
+      return;
+      }
+    const QString& filePath = listOfFiles[i];
+    if (ctkDICOMDatabase.fileExistsAndUpToDate(filePath))
+      {
+      logger.debug( "File " + filePath + " already added.");
+      ++currentFileIndex;
+      }
+    else
+      {
+      filesToParse << filePath;
+      }
+    d->setItemsDone(i + 1);
+    }
+
+  // Headers are parsed by the parser pool while this thread, which owns
+  // the database connection, writes the parsed datasets in a bulk insert.
+  d->startParsers(filesToParse, ctkDICOMDatabase.statisticsEnabled());
+  d->startPhase("Indexing files", filesToParse.count());
+
+  ctkDICOMDatabase.beginBulkInsert();
+  ctkDICOMIndexerPrivate::ParsedFile parsedFile;
+  int indexedFiles = 0;
+  while (d->dequeueParsedFile(parsedFile))
+    {
+    int percent = ( 100 * currentFileIndex ) / listOfFiles.size();
     emit this->progress(percent);
-    this->addFile(ctkDICOMDatabase, filePath, destinationDirectoryName);
-    CurrentFileIndex++;
+    emit this->indexingFilePath(parsedFile.FilePath);
 
-    if( d->Canceled )
+    if (d->TimeParsers)
       {
-      break;
+      ctkDICOMDatabase.addInsertPhaseTime(ctkDICOMDatabase::ParsePhase,
+                                          parsedFile.ParseNanoseconds);
       }
-  }
+    if (parsedFile.Dataset->IsInitialized())
+      {
+      ctkDICOMDatabase.insert(*parsedFile.Dataset, parsedFile.FilePath, storeFile, true);
+      }
+    else
+      {
+      logger.warn(QString("Could not read DICOM file:") + parsedFile.FilePath);
+      }
+    delete parsedFile.Dataset;
+    ++currentFileIndex;
+    d->setItemsDone(++indexedFiles);
+    }
+  if (d->isCanceled())
+    {
+    // only the completely inserted files are left in the database
+    ctkDICOMDatabase.abortBulkInsert();
+    }
+  else
+    {
+    ctkDICOMDatabase.endBulkInsert();
+    }
+
+  d->stopParsers();
   emit this->indexingComplete();
 }
 
+//------------------------------------------------------------------------------
+/// Copy the attributes of a DICOMDIR record, but not the elements
+/// describing the directory structure (group 0x0004), into dataset.
+static void copyDirectoryRecordAttributes(DcmDirectoryRecord* record, DcmItem* dataset)
+{
+  for (unsigned long i = 0; i < record->card(); ++i)
+    {
+    DcmElement* element = record->getElement(i);
+    if (!element || element->getGTag() == 0x0004)
+      {
+      continue;
+      }
+    dataset->insert(OFstatic_cast(DcmElement*, element->clone()), true);
+    }
+}
+
 //------------------------------------------------------------------------------
 bool ctkDICOMIndexer::addDicomdir(ctkDICOMDatabase& ctkDICOMDatabase,
                  const QString& directoryName,
                  const QString& destinationDirectoryName
                  )
 {
+  Q_D(ctkDICOMIndexer);
   //Initialize dicomdir with directory path
   QString dcmFilePath = directoryName;
   dcmFilePath.append("/DICOMDIR");
-  DcmDicomDir* dicomDir = new DcmDicomDir(dcmFilePath.toStdString().c_str());
+  DcmDicomDir dicomDir(dcmFilePath.toStdString().c_str());
+
+  // Unless the files have to be copied, the database is populated from the
+  // directory records only and the instance files are not opened.
+  const bool useDirectoryRecords = destinationDirectoryName.isEmpty();
 
   //Values to store records data at the moment only uid needed
-  OFString patientsName, studyInstanceUID, seriesInstanceUID, sopInstanceUID, referencedFileName ;
+  OFString patientsName, studyInstanceUID, seriesInstanceUID, sopInstanceUID, sopClassUID, referencedFileName ;
 
   //Variables for progress operations
   QString instanceFilePath;
   QStringList listOfInstances;
+  QList<ctkDICOMItem> listOfDatasets;
 
-  DcmDirectoryRecord* rootRecord = &(dicomDir->getRootRecord());
+  DcmDirectoryRecord* rootRecord = &(dicomDir.getRootRecord());
   DcmDirectoryRecord* patientRecord = NULL;
   DcmDirectoryRecord* studyRecord = NULL;
   DcmDirectoryRecord* seriesRecord = NULL;
@@ -227,12 +583,63 @@ bool ctkDICOMIndexer::addDicomdir(ctkDICOMDatabase& ctkDICOMDatabase,
             instanceFilePath.append(QString( referencedFileName.c_str() ));
             instanceFilePath.replace("\\","/");
             listOfInstances << instanceFilePath;
+
+            if (useDirectoryRecords)
+              {
+              // the records from the patient down to the instance hold all
+              // the attributes of the Patients, Studies and Series tables
+              DcmDataset* dataset = new DcmDataset;
+              copyDirectoryRecordAttributes(patientRecord, dataset);
+              copyDirectoryRecordAttributes(studyRecord, dataset);
+              copyDirectoryRecordAttributes(seriesRecord, dataset);
+              copyDirectoryRecordAttributes(fileRecord, dataset);
+              dataset->putAndInsertString(DCM_SOPInstanceUID, sopInstanceUID.c_str());
+              if (fileRecord->findAndGetOFString(DCM_ReferencedSOPClassUIDInFile, sopClassUID).good())
+                {
+                dataset->putAndInsertString(DCM_SOPClassUID, sopClassUID.c_str());
+                }
+              ctkDICOMItem instanceDataset;
+              instanceDataset.InitializeFromItem(dataset, true);
+              listOfDatasets << instanceDataset;
+              }
           }
         }
       }
     }
     emit foundFilesToIndex(listOfInstances.count());
-    addListOfFiles(ctkDICOMDatabase,listOfInstances,destinationDirectoryName);
+    if (useDirectoryRecords)
+      {
+      {
+      QMutexLocker locker(&d->QueueMutex);
+      d->Canceled = d->OperationToken && d->OperationToken->isCanceled();
+      }
+      d->startPhase("Indexing directory records", listOfDatasets.count());
+      ctkDICOMDatabase.beginBulkInsert();
+      for (int i = 0; i < listOfDatasets.count(); ++i)
+        {
+        if (d->isCanceled())
+          {
+          break;
+          }
+        emit this->progress(( 100 * i ) / listOfDatasets.count());
+        emit this->indexingFilePath(listOfInstances[i]);
+        ctkDICOMDatabase.insertDirectoryRecord(listOfDatasets[i], listOfInstances[i]);
+        d->setItemsDone(i + 1);
+        }
+      if (d->isCanceled())
+        {
+        ctkDICOMDatabase.abortBulkInsert();
+        }
+      else
+        {
+        ctkDICOMDatabase.endBulkInsert();
+        }
+      emit this->indexingComplete();
+      }
+    else
+      {
+      addListOfFiles(ctkDICOMDatabase,listOfInstances,destinationDirectoryName);
+      }
   }
   return success;
 }
@@ -240,42 +647,97 @@ bool ctkDICOMIndexer::addDicomdir(ctkDICOMDatabase& ctkDICOMDatabase,
 //------------------------------------------------------------------------------
 void ctkDICOMIndexer::refreshDatabase(ctkDICOMDatabase& dicomDatabase, const QString& directoryName)
 {
-  Q_UNUSED(dicomDatabase);
-  Q_UNUSED(directoryName);
-  /*
-   * Probably this should go to the database class as well
-   * Or we have to extend the interface to make possible what we do here
-   * without using SQL directly
-
-  /// get all filenames from the database
-  QSqlQuery allFilesQuery(dicomDatabase.database());
-  QStringList databaseFileNames;
-  QStringList filesToRemove;
-  this->loggedExec(allFilesQuery, "SELECT Filename from Images;");
-
-  while (allFilesQuery.next())
+  Q_D(ctkDICOMIndexer);
+
+  // Everything known about the directory is read with one query per table
+  // instead of one query per file.
+  QHash<QString, QDateTime> insertTimes = dicomDatabase.insertDateTimesForDirectory(directoryName);
+  QHash<QString, QString> storedFingerprints = dicomDatabase.directoryFingerprints(directoryName);
+
+  QHash<QString, QString> changedFingerprints;
+  QStringList filesToIndex;
+  QSet<QString> existingFiles;
+  QSet<QString> existingDirectories;
+
+  QStringList directoriesToScan;
+  directoriesToScan << directoryName;
+  while (!directoriesToScan.isEmpty())
+    {
+    QString dirName = directoriesToScan.takeLast();
+    QDir dir(dirName);
+    existingDirectories.insert(dirName);
+
+    foreach(const QString& subdirectory, dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+      {
+      directoriesToScan << dir.filePath(subdirectory);
+      }
+
+    QFileInfoList files = dir.entryInfoList(QDir::Files);
+    QString fingerprint = d->directoryFingerprint(dirName, files);
+    bool unchanged = (storedFingerprints.value(dirName) == fingerprint);
+    if (!unchanged)
+      {
+      changedFingerprints.insert(dirName, fingerprint);
+      }
+    foreach(const QFileInfo& fileInfo, files)
+      {
+      QString filePath = dir.filePath(fileInfo.fileName());
+      existingFiles.insert(filePath);
+      if (unchanged)
+        {
+        continue;
+        }
+      QHash<QString, QDateTime>::const_iterator insertTime = insertTimes.find(filePath);
+      if (insertTime == insertTimes.constEnd()
+          || !(fileInfo.lastModified() < insertTime.value()))
+        {
+        filesToIndex << filePath;
+        }
+      }
+    }
+
+  // files that are in the database but not on disk anymore
+  QStringList deletedFiles;
+  QHash<QString, QDateTime>::const_iterator it;
+  for (it = insertTimes.constBegin(); it != insertTimes.constEnd(); ++it)
     {
-    QString fileName = allFilesQuery.value(0).toString();
-    databaseFileNames.append(fileName);
-    if (! QFile::exists(fileName) )
+    if (!existingFiles.contains(it.key()))
       {
-      filesToRemove.append(fileName);
+      deletedFiles << it.key();
       }
     }
+  if (!deletedFiles.isEmpty())
+    {
+    logger.debug(QString("Removing %1 deleted files").arg(deletedFiles.count()));
+    dicomDatabase.removeFiles(deletedFiles);
+    }
 
-  QSet<QString> filesytemFiles;
-  QDirIterator dirIt(directoryName);
-  while (dirIt.hasNext())
+  QStringList deletedDirectories;
+  foreach(const QString& dirName, storedFingerprints.keys())
     {
-    filesytemFiles.insert(dirIt.next());
+    if (!existingDirectories.contains(dirName))
+      {
+      deletedDirectories << dirName;
+      }
     }
+  dicomDatabase.removeDirectoryFingerprints(deletedDirectories);
+
+  logger.debug(QString("Refreshing %1 files in %2 changed directories")
+               .arg(filesToIndex.count()).arg(changedFingerprints.count()));
+  emit foundFilesToIndex(filesToIndex.count());
+  this->addListOfFiles(dicomDatabase, filesToIndex);
 
-  // TODO: it looks like this function was never finished...
-  //
-  // I guess the next step is to remove all filesToRemove from the database
-  // and also to add filesystemFiles into the database tables
-  */
+  // the fingerprints are only stored once the directories are indexed
+  bool canceled;
+  {
+  QMutexLocker locker(&d->QueueMutex);
+  canceled = d->Canceled;
   }
+  if (!canceled)
+    {
+    dicomDatabase.setDirectoryFingerprints(changedFingerprints);
+    }
+}
 
 //------------------------------------------------------------------------------
 void ctkDICOMIndexer::waitForImportFinished()
@@ -288,5 +750,8 @@ void ctkDICOMIndexer::waitForImportFinished()
 void ctkDICOMIndexer::cancel()
 {
   Q_D(ctkDICOMIndexer);
+  QMutexLocker locker(&d->QueueMutex);
   d->Canceled = true;
+  d->QueueNotEmpty.wakeAll();
+  d->QueueNotFull.wakeAll();
 }
@@ -29,6 +29,7 @@
 #include "ctkDICOMDatabase.h"
 
 class ctkDICOMIndexerPrivate;
+class ctkDICOMOperationToken;
 
 /// \ingroup DICOM_Core
 ///
@@ -41,6 +42,31 @@ public:
   explicit ctkDICOMIndexer(QObject *parent = 0);
   virtual ~ctkDICOMIndexer();
 
+  ///
+  /// \brief Number of threads used to parse the DICOM headers.
+  ///
+  /// addListOfFiles() parses the files on a pool of threads while the
+  /// calling thread, which owns the database connection, inserts the
+  /// parsed datasets into the database.
+  /// A value of 0 (default) uses QThread::idealThreadCount().
+  ///
+  void setNumberOfParserThreads(int threadCount);
+  int numberOfParserThreads()const;
+
+  ///
+  /// \brief Token canceling and following the progress of the indexing.
+  ///
+  /// The token reports the phases of addDirectory(), addListOfFiles() and
+  /// addDicomdir() with the number of files done and the estimated time
+  /// remaining. Canceling the token cancels the indexing like cancel():
+  /// the files inserted since the last commit of the bulk insert session
+  /// are rolled back (see ctkDICOMDatabase::abortBulkInsert()), the
+  /// database only contains completely inserted files.
+  /// The token is not owned by the indexer.
+  ///
+  void setOperationToken(ctkDICOMOperationToken* token);
+  ctkDICOMOperationToken* operationToken()const;
+
   ///
   /// \brief Adds directory to database and optionally copies files to
   /// destinationDirectory.
@@ -56,6 +82,9 @@ public:
   /// destinationDirectory.
   /// Scan the directory using Dcmtk and populate the database with all the
   /// DICOM images accordingly.
+  /// If no destinationDirectory is given, the patients, studies, series and
+  /// instances are inserted from the DICOMDIR records only, the referenced
+  /// files are not opened (see ctkDICOMDatabase::insertDirectoryRecord).
   /// \return Returns false if there was an error while processing the DICOMDIR file.
   ///
   Q_INVOKABLE bool addDicomdir(ctkDICOMDatabase& database, const QString& directoryName,
@@ -81,6 +110,15 @@ public:
   Q_INVOKABLE void addFile(ctkDICOMDatabase& database, const QString filePath,
                     const QString& destinationDirectoryName = "");
 
+  ///
+  /// \brief Brings the database up to date with the content of directoryName.
+  ///
+  /// New and modified files are indexed and the files that do not exist
+  /// anymore are removed from the database. A fingerprint of each
+  /// directory (modification time, inode, number, size and modification
+  /// time of its files) is stored in the database, the files of the
+  /// directories whose fingerprint did not change are not looked up.
+  ///
   Q_INVOKABLE void refreshDatabase(ctkDICOMDatabase& database, const QString& directoryName);
 
   ///
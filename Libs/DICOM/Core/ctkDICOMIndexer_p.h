@@ -21,10 +21,19 @@
 #ifndef CTKDICOMINDEXERPRIVATE_H
 #define CTKDICOMINDEXERPRIVATE_H
 
+#include <QFileInfo>
+#include <QMutex>
 #include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 #include "ctkDICOMIndexer.h"
 
+class ctkDICOMItem;
+class ctkDICOMOperationToken;
+
 //------------------------------------------------------------------------------
 class ctkDICOMIndexerPrivate : public QObject
 {
@@ -39,9 +48,64 @@ public:
   ctkDICOMIndexerPrivate(ctkDICOMIndexer&);
   ~ctkDICOMIndexerPrivate();
 
+  /// A file whose header has been parsed by one of the parser threads
+  /// and which is waiting to be written into the database.
+  struct ParsedFile
+  {
+    QString FilePath;
+    ctkDICOMItem* Dataset;
+    /// Time spent parsing the header, only measured if TimeParsers is set.
+    qint64 ParseNanoseconds;
+  };
+
+  /// Start the parser threads on \a filesToParse. The parse time of the
+  /// files is measured if \a timeParsers is true.
+  void startParsers(const QStringList& filesToParse, bool timeParsers = false);
+  /// Ask the parser threads to stop, wait for them and discard
+  /// the datasets they left in the queue.
+  void stopParsers();
+
+  /// Called from the parser threads.
+  /// Returns false when there is no file left to parse.
+  bool takeNextFileToParse(QString& filePath);
+  /// Called from the parser threads. Blocks while the queue is full.
+  void enqueueParsedFile(const ParsedFile& parsedFile);
+  /// Called from the parser threads when they are done.
+  void parserFinished();
+  /// Called from the writer (calling) thread. Blocks until a parsed file
+  /// is available. Returns false once all the files have been consumed
+  /// or the indexing has been canceled.
+  bool dequeueParsedFile(ParsedFile& parsedFile);
+
+  /// Fingerprint of the files of a directory (not recursive) stored in
+  /// the Directories table by refreshDatabase().
+  QString directoryFingerprint(const QString& directoryName, const QFileInfoList& files);
+
+  /// Thread safe
+  bool isCanceled();
+  /// Report a phase or the progress of the phase to OperationToken
+  void startPhase(const QString& phase, int totalItems);
+  void setItemsDone(int itemsDone);
+
 public:
   ctkDICOMAbstractThumbnailGenerator* thumbnailGenerator;
   bool                    Canceled;
+  QPointer<ctkDICOMOperationToken> OperationToken;
+
+  /// Number of threads parsing DICOM headers, 0 means one per core.
+  int NumberOfParserThreads;
+  /// Number of parsed datasets that can wait for the writer.
+  int MaximumQueueSize;
+
+  QThreadPool ParserPool;
+  QMutex QueueMutex;
+  QWaitCondition QueueNotEmpty;
+  QWaitCondition QueueNotFull;
+  QQueue<ParsedFile> ParsedFiles;
+  QStringList FilesToParse;
+  int NextFileToParse;
+  int ActiveParsers;
+  bool TimeParsers;
 };
 
 
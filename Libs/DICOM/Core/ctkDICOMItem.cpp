@@ -27,13 +27,101 @@
 
 #include <stdexcept>
 
+namespace
+{
+
+/// Codecs for the character sets that might be named in DICOM files.
+/// Built once per process and never modified afterwards, so it can be
+/// read by any number of threads without locking.
+class ctkDICOMCharacterSetCodecs
+{
+public:
+  ctkDICOMCharacterSetCodecs();
+  /// Return 0 if the character set is unknown
+  QTextCodec* codec(const QString& dicomCharacterSet)const
+  {
+    return this->Codecs.value(dicomCharacterSet, 0);
+  }
+private:
+  void insert(const char* dicomName, const char* qtName);
+  QHash<QString, QTextCodec*> Codecs;
+};
+
+ctkDICOMCharacterSetCodecs::ctkDICOMCharacterSetCodecs()
+{
+  // For each encoding we store the codec Qt uses for the same encoding.
+  // This is because there is not yet a standard naming scheme but lots of aliases
+  // out in the real world: e.g. http://www.openi18n.org/subgroups/sa/locnameguide/final/CodesetAliasTable.html
+
+  //            DICOM        Qt
+  this->insert("ISO_IR 6", "UTF-8"); // actually ASCII, but ok
+  this->insert("ISO_IR 100", "ISO-8859-1");
+  this->insert("ISO_IR 101", "ISO-8859-2");
+  this->insert("ISO_IR 109", "ISO-8859-3");
+  this->insert("ISO_IR 110", "ISO-8859-4");
+  this->insert("ISO_IR 144", "ISO-8859-5");
+  this->insert("ISO_IR 127", "ISO-8859-6");
+  this->insert("ISO_IR 126", "ISO-8859-7");
+  this->insert("ISO_IR 138", "ISO-8859-8");
+  this->insert("ISO_IR 148", "ISO-8859-9");
+  this->insert("ISO_IR 179", "ISO-8859-13");
+  this->insert("ISO_IR 192", "UTF-8");
+  // japanese
+  this->insert("ISO 2022 IR 13", "ISO 2022-JP"); // Single byte charset, JIS X 0201: Katakana, Romaji
+  this->insert("ISO 2022 IR 87", "ISO 2022-JP"); // Multi byte charset, JIS X 0208: Kanji, Kanji set
+  this->insert("ISO 2022 IR 159", "ISO 2022-JP");
+  // korean
+  this->insert("ISO 2022 IR 149", "EUC-KR"); // Multi byte charset, KS X 1001: Hangul, Hanja
+
+  // use all names that Qt knows by itself
+  foreach( QByteArray c, QTextCodec::availableCodecs() )
+  {
+    this->insert( c.constData(), c.constData() );
+  }
+}
+
+void ctkDICOMCharacterSetCodecs::insert(const char* dicomName, const char* qtName)
+{
+  QTextCodec* codec = QTextCodec::codecForName( qtName );
+  if (!codec)
+  {
+    std::cerr << "Could not create QTextCodec object for '" << qtName << "'. Using default encoding instead." << std::endl;
+    codec = QTextCodec::codecForName("UTF-8"); // uses Latin1
+  }
+  // Codecs are owned by Qt
+  this->Codecs.insert( QString::fromLatin1(dicomName), codec );
+}
+
+}
+
+Q_GLOBAL_STATIC(ctkDICOMCharacterSetCodecs, dicomCharacterSetCodecs)
+
 
-class ctkDICOMItemPrivate
+class ctkDICOMItemPrivate : public QSharedData
 {
   public:
 
     ctkDICOMItemPrivate() : m_DcmItem(0), m_TakeOwnership(true) {}
 
+    /// Called by QExplicitlySharedDataPointer::detach(), the copy always owns its item.
+    ctkDICOMItemPrivate(const ctkDICOMItemPrivate& other)
+      : QSharedData(other)
+      , m_SpecificCharacterSet(other.m_SpecificCharacterSet)
+      , m_DICOMDataSetInitialized(other.m_DICOMDataSetInitialized)
+      , m_StrictErrorHandling(other.m_StrictErrorHandling)
+      , m_DcmItem(other.m_DcmItem ? static_cast<DcmItem*>(other.m_DcmItem->clone()) : 0)
+      , m_TakeOwnership(true)
+    {
+    }
+
+    ~ctkDICOMItemPrivate()
+    {
+      if (m_TakeOwnership)
+      {
+        delete m_DcmItem;
+      }
+    }
+
     QString m_SpecificCharacterSet;
 
     bool m_DICOMDataSetInitialized;
@@ -54,28 +142,41 @@ ctkDICOMItem::ctkDICOMItem(bool strictErrorHandling)
   d->m_StrictErrorHandling = strictErrorHandling;
 }
 
+ctkDICOMItem::ctkDICOMItem(const ctkDICOMItem& other)
+:d_ptr(other.d_ptr)
+{
+}
+
 ctkDICOMItem::~ctkDICOMItem()
 {
-  Q_D(ctkDICOMItem);
-  if ( d->m_TakeOwnership)
-  {
-    delete d->m_DcmItem;
-  }
+  // the item is deleted with the last copy sharing it
 }
 
+ctkDICOMItem& ctkDICOMItem::operator=(const ctkDICOMItem& other)
+{
+  d_ptr = other.d_ptr;
+  return *this;
+}
 
-void ctkDICOMItem::InitializeFromItem(DcmItem *dataset, bool takeOwnership)
+void ctkDICOMItem::Detach()
 {
-  Q_D(ctkDICOMItem);
+  d_ptr.detach();
+}
+
 
-  if(d->m_DcmItem != dataset)
+void ctkDICOMItem::InitializeFromItem(DcmItem *dataset, bool takeOwnership)
+{
+  if(d_ptr->m_DcmItem != dataset)
   {
-    if (d->m_TakeOwnership)
-    {
-      delete d->m_DcmItem;
-    }
-    d->m_DcmItem = NULL;
+    // don't clone an item that is going to be replaced, the previous
+    // item is released when no other copy shares it anymore
+    ctkDICOMItemPrivate* newPrivate = new ctkDICOMItemPrivate;
+    newPrivate->m_SpecificCharacterSet = d_ptr->m_SpecificCharacterSet;
+    newPrivate->m_DICOMDataSetInitialized = d_ptr->m_DICOMDataSetInitialized;
+    newPrivate->m_StrictErrorHandling = d_ptr->m_StrictErrorHandling;
+    d_ptr = newPrivate;
   }
+  Q_D(ctkDICOMItem);
 
   if (dataset)
   {
@@ -115,7 +216,8 @@ void ctkDICOMItem::InitializeFromFile(const QString& filename,
   DcmDataset *dataset;
 
   DcmFileFormat fileformat;
-  OFCondition status = fileformat.loadFile(filename.toLatin1().data(), readXfer, groupLength, maxReadLength, readMode);
+  // the local 8 bit encoding is what the file system expects, unlike Latin1
+  OFCondition status = fileformat.loadFile(QFile::encodeName(filename).constData(), readXfer, groupLength, maxReadLength, readMode);
   dataset = fileformat.getAndRemoveDataset();
 
   if (!status.good())
@@ -128,46 +230,175 @@ void ctkDICOMItem::InitializeFromFile(const QString& filename,
   InitializeFromItem(dataset, true);
 }
 
+void ctkDICOMItem::InitializeFromFileHeader(const QString& filename)
+{
+  this->InitializeFromFileUntilTag(filename, DCM_PixelData);
+}
+
+void ctkDICOMItem::InitializeFromFileUntilTag(const QString& filename, const DcmTagKey& stopTag)
+{
+  DcmDataset *dataset;
+
+  DcmFileFormat fileformat;
+#ifdef CTK_DCMTK_HAS_LOADFILEUNTILTAG
+  OFCondition status = fileformat.loadFileUntilTag(QFile::encodeName(filename).constData(),
+    EXS_Unknown, EGL_noChange, DCM_MaxReadLength, ERM_autoDetect, stopTag);
+#else
+  // Element values longer than maxReadLength (e.g. the pixel data) are not
+  // read into memory, DCMTK seeks over them and loads them on demand.
+  const Uint32 headerMaxReadLength = 1024;
+  OFCondition status = fileformat.loadFile(QFile::encodeName(filename).constData(),
+    EXS_Unknown, EGL_noChange,
+    stopTag <= DCM_PixelData ? headerMaxReadLength : DCM_MaxReadLength,
+    ERM_autoDetect);
+#endif
+  dataset = fileformat.getAndRemoveDataset();
+
+  if (!status.good())
+  {
+    qDebug() << "Could not load header of " << filename << "\nDCMTK says: " << status.text();
+    delete dataset;
+    return;
+  }
+
+  InitializeFromItem(dataset, true);
+}
+
+bool ctkDICOMItem::InitializeFromMappedFile(const QString& filename,
+                                            const DcmTagKey& stopTag,
+                                            const E_TransferSyntax readXfer,
+                                            const E_GrpLenEncoding groupLength)
+{
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    qDebug() << "Could not open " << filename << ": " << file.errorString();
+    return false;
+  }
+  const qint64 size = file.size();
+  // DcmInputBufferStream lengths are 32 bit with older DCMTK versions
+  uchar* data = (size > 0 && size <= 0xffffffffLL) ? file.map(0, size) : 0;
+  if (!data)
+  {
+    qDebug() << "Could not map " << filename << ": " << file.errorString();
+    return false;
+  }
+
+  DcmInputBufferStream dcmbuffer;
+  dcmbuffer.setBuffer( data, size );
+  dcmbuffer.setEos();
+
+  DcmFileFormat fileformat;
+  fileformat.transferInit();
+#ifdef CTK_DCMTK_HAS_LOADFILEUNTILTAG
+  OFCondition status = fileformat.readUntilTag(dcmbuffer, readXfer, groupLength,
+                                               DCM_MaxReadLength, stopTag);
+#else
+  Q_UNUSED(stopTag);
+  OFCondition status = fileformat.read(dcmbuffer, readXfer, groupLength);
+#endif
+  fileformat.transferEnd();
+
+  // the values have been copied, a memory stream can not be read lazily
+  file.unmap(data);
+
+  DcmDataset* dataset = fileformat.getAndRemoveDataset();
+  if (!status.good())
+  {
+    qDebug() << "Could not load " << filename << "\nDCMTK says: " << status.text();
+    delete dataset;
+    return false;
+  }
+
+  InitializeFromItem(dataset, true);
+  return true;
+}
+
 void ctkDICOMItem::Serialize()
 {
-  Q_D(ctkDICOMItem);
   EnsureDcmDataSetIsInitialized();
 
-  // store content of current DcmDataset (our parent) as QByteArray into m_ctkDICOMItem
-  Uint32 buffersize = 1024*1024; // reserve 1MB
-  char* writebuffer = new char[buffersize];
+  QString stringbuffer = QString::fromLatin1(this->SerializeToByteArray().toBase64());
+  this->SetStoredSerialization( stringbuffer );
+}
 
-  // write into buffer
-  DcmOutputBufferStream dcmbuffer(writebuffer, buffersize);
-  d->m_DcmItem->transferInit();
-  OFCondition condition = d->m_DcmItem->write(dcmbuffer, EXS_LittleEndianImplicit, EET_UndefinedLength, NULL );
-  d->m_DcmItem->transferEnd();
-  if ( condition.bad() )
+QByteArray ctkDICOMItem::SerializeToByteArray() const
+{
+  Q_D(const ctkDICOMItem);
+  EnsureDcmDataSetIsInitialized();
+
+  QByteArray buffer;
+  if (!d->m_DcmItem)
   {
-    std::cerr << "Could not DcmDataset::write(..): " << condition.text() << std::endl;
+    return buffer;
   }
 
-  // get written contents of buffer
+  // the encoded length is known beforehand, reserve it plus the item
+  // tag and delimitation written when the item is not a DcmDataset
+  buffer.resize( static_cast<int>(d->m_DcmItem->getLength(EXS_LittleEndianImplicit, EET_UndefinedLength)) + 16 );
+  OFCondition condition;
   offile_off_t datasetsize = 0;
-  void* readbuffer = NULL;
-  dcmbuffer.flushBuffer(readbuffer, datasetsize);
+  for (;;)
+  {
+    // write into buffer
+    DcmOutputBufferStream dcmbuffer(buffer.data(), buffer.size());
+    d->m_DcmItem->transferInit();
+    condition = d->m_DcmItem->write(dcmbuffer, EXS_LittleEndianImplicit, EET_UndefinedLength, NULL );
+    d->m_DcmItem->transferEnd();
+
+    // get written contents of buffer
+    void* readbuffer = NULL;
+    dcmbuffer.flushBuffer(readbuffer, datasetsize);
+    if ( condition != EC_StreamNotifyClient )
+    {
+      break;
+    }
+    // the buffer is full, which only happens if the length was underestimated
+    buffer.resize( 2 * buffer.size() );
+  }
+  if ( condition.bad() )
+  {
+    std::cerr << "Could not DcmDataset::write(..): " << condition.text() << std::endl;
+  }
 
-  //std::cerr << "** " << (void*)this << " ctkDICOMItem: Serializing Dataset into " << datasetsize << " bytes" << std::endl;
+  buffer.resize( static_cast<int>(datasetsize) );
+  return buffer;
+}
 
-  // construct Qt type from that contents
-  QByteArray qtArray = QByteArray::fromRawData( static_cast<const char*>(readbuffer), datasetsize );
-  //std::cerr << "** Buffer size: " << qtArray.size() << std::endl;
-  QString stringbuffer = QString::fromLatin1(qtArray.toBase64());
+bool ctkDICOMItem::InitializeFromByteArray(const QByteArray& buffer)
+{
+  // the dataset is read from the array directly, no copy is made
+  DcmInputBufferStream dcmbuffer;
+  dcmbuffer.setBuffer( buffer.constData(), buffer.size() );
+  dcmbuffer.setEos();
 
-  //std::cerr << "** String of size " << stringbuffer.size() << " looks like this:\n" << stringbuffer.toStdString() << std::endl << std::endl;
+  DcmDataset* dataset = new DcmDataset;
+  dataset->transferInit();
+  OFCondition condition = dataset->read( dcmbuffer, EXS_LittleEndianImplicit );
+  dataset->transferEnd();
 
-  this->SetStoredSerialization( stringbuffer );
+  // do this in all cases, even when reading reported an error
+  this->InitializeFromItem(dataset, true);
 
-  delete[] writebuffer;
+  if ( condition.bad() )
+  {
+    std::cerr << "** Condition code of Dataset::read() is "
+              << condition.code() << std::endl;
+    std::cerr << "** Buffer state: " << dcmbuffer.status().code()
+              << " " <<  dcmbuffer.good()
+              << " " << dcmbuffer.eos()
+              << " tell " << dcmbuffer.tell()
+              << " avail " << dcmbuffer.avail() << std::endl;
+    std::cerr << "Could not DcmDataset::read(..): "
+              << condition.text() << std::endl;
+    return false;
+  }
+  return true;
 }
 
 void ctkDICOMItem::MarkForInitialization()
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   d->m_DICOMDataSetInitialized = false;
 }
@@ -187,6 +418,7 @@ void ctkDICOMItem::EnsureDcmDataSetIsInitialized() const
 
 void ctkDICOMItem::Deserialize()
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   // read attribute m_ctkDICOMItem
   // construct a DcmDataset from it
@@ -204,40 +436,7 @@ void ctkDICOMItem::Deserialize()
     return; // TODO nicer: hold three states: newly created / loaded but not initialized / restored from DB
   }
 
-
-  //std::cerr << "** " << (void*)this << " ctkDICOMItem: Deserialize Dataset from string of size " << stringbuffer.size() << "\n" << stringbuffer.toStdString() << std::endl;
-
-  QByteArray qtArray = QByteArray::fromBase64( stringbuffer.toLatin1() );
-  //std::cerr << "** " << (void*)this << " ctkDICOMItem: Deserialize Dataset from byte array of size " << qtArray.size() << std::endl;
-
-  DcmInputBufferStream dcmbuffer;
-  dcmbuffer.setBuffer( qtArray.data(), qtArray.size() );
-  //std::cerr << "** Buffer state: " << dcmbuffer.status().code() << " " <<  dcmbuffer.good() << " " << dcmbuffer.eos() << " tell " << dcmbuffer.tell() << " avail " << dcmbuffer.avail() << std::endl;
-
-  DcmDataset dataset;
-  dataset.transferInit();
-  //std::cerr << "** Dataset state: " << dataset.transferState() << std::endl << std::endl;
-  OFCondition condition = dataset.read( dcmbuffer, EXS_LittleEndianImplicit );
-  dataset.transferEnd();
-
-  // do this in all cases, even when reading reported an error
-  this->InitializeFromItem(&dataset);
-
-  if ( condition.bad() )
-  {
-    std::cerr << "** Condition code of Dataset::read() is "
-              << condition.code() << std::endl;
-    std::cerr << "** Buffer state: " << dcmbuffer.status().code()
-              << " " <<  dcmbuffer.good()
-              << " " << dcmbuffer.eos()
-              << " tell " << dcmbuffer.tell()
-              << " avail " << dcmbuffer.avail() << std::endl;
-    std::cerr << "** Dataset state: "
-              << static_cast<int>(dataset.transferState()) << std::endl;
-    std::cerr << "Could not DcmDataset::read(..): "
-              << condition.text() << std::endl;
-    //throw std::invalid_argument( std::string("Could not DcmDataset::read(..): ") + condition.text() );
-  }
+  this->InitializeFromByteArray( QByteArray::fromBase64( stringbuffer.toLatin1() ) );
 }
 
 DcmItem& ctkDICOMItem::GetDcmItem() const
@@ -272,6 +471,7 @@ bool ctkDICOMItem::CheckCondition(const OFCondition& condition)
 
 bool ctkDICOMItem::CopyElement( DcmDataset* dataset, const DcmTagKey& tag, int type )
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   switch (type)
   {
@@ -336,89 +536,34 @@ bool ctkDICOMItem::CopyElement( DcmDataset* dataset, const DcmTagKey& tag, int t
 QString ctkDICOMItem::Decode( const DcmTag& tag, const OFString& raw ) const
 {
   Q_D(const ctkDICOMItem);
+  if ( d->m_SpecificCharacterSet.isEmpty() )
+  {
+    return QString::fromLatin1(raw.c_str());
+  }
   // decode for types LO, LT, PN, SH, ST, UT
-  QString vr = TagVR(tag);
-  if ( !d->m_SpecificCharacterSet.isEmpty()
-    && (vr == "LO" ||
-        vr == "LT" ||
-        vr == "PN" ||
-        vr == "SH" ||
-        vr == "ST" ||
-        vr == "UT" ) )
-  {
-    //std::cout << "Decode from encoding " << d->m_SpecificCharacterSet.toStdString() << std::endl;
-    static QMap<QString, QTextDecoder*> decoders;
-    static QMap<QString, QString> qtEncodingNamesForDICOMEncodingNames;
-
-    if (qtEncodingNamesForDICOMEncodingNames.isEmpty())
-    {
-      // runs only once and fills up a map of encoding names that might be named in DICOM files.
-      // for each encoding we store the name that Qt uses for the same encoding.
-      // This is because there is not yet a standard naming scheme but lots of aliases
-      // out in the real world: e.g. http://www.openi18n.org/subgroups/sa/locnameguide/final/CodesetAliasTable.html
-
-                                              //    DICOM        Qt
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 6", "UTF-8"); // actually ASCII, but ok
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 100", "ISO-8859-1");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 101", "ISO-8859-2");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 109", "ISO-8859-3");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 110", "ISO-8859-4");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 144", "ISO-8859-5");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 127", "ISO-8859-6");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 126", "ISO-8859-7");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 138", "ISO-8859-8");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 148", "ISO-8859-9");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 179", "ISO-8859-13");
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO_IR 192", "UTF-8");
-      // japanese
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO 2022 IR 13", "ISO 2022-JP"); // Single byte charset, JIS X 0201: Katakana, Romaji
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO 2022 IR 87", "ISO 2022-JP"); // Multi byte charset, JIS X 0208: Kanji, Kanji set
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO 2022 IR 159", "ISO 2022-JP");
-      // korean
-      qtEncodingNamesForDICOMEncodingNames.insert("ISO 2022 IR 149", "EUC-KR"); // Multi byte charset, KS X 1001: Hangul, Hanja
-
-      // use all names that Qt knows by itself
-      foreach( QByteArray c, QTextCodec::availableCodecs() )
-      {
-        qtEncodingNamesForDICOMEncodingNames.insert( c.constData(), c.constData() );
-      }
-
-    }
-
-    if ( qtEncodingNamesForDICOMEncodingNames.contains(d->m_SpecificCharacterSet) )
-    {
-      QString encodingName( qtEncodingNamesForDICOMEncodingNames[d->m_SpecificCharacterSet] );
-      if ( !decoders.contains( encodingName ) )
-      {
-        QTextCodec* codec = QTextCodec::codecForName( encodingName.toLatin1() );
-        if (!codec)
-        {
-          std::cerr << "Could not create QTextCodec object for '" << encodingName.toStdString() << "'. Using default encoding instead." << std::endl;
-          decoders.insert( encodingName, QTextCodec::codecForName("UTF-8")->makeDecoder() ); // uses Latin1
-        }
-        else
-        {
-          // initialize a QTextDecoder for given encoding
-          decoders.insert( encodingName, codec->makeDecoder() );
-          // We are responsible for deleting the QTextDecoder objects
-          // created by makeDecoder(). BUT as these objects are stored
-          // in a static map that lives until application end AND
-          // nothing application relevant happens during their
-          // destruction, we just let them be destructed by C++ on
-          // application exit.
-          // Any potential leaks that are found by this behavior can
-          // be suppressed.
-        }
-      }
+  switch ( tag.getEVR() )
+  {
+    case EVR_LO:
+    case EVR_LT:
+    case EVR_PN:
+    case EVR_SH:
+    case EVR_ST:
+    case EVR_UT:
+      break;
+    default:
+      return QString::fromLatin1(raw.c_str());
+  }
 
-      //std::cout << "Decode '" <<  raw.c_str() << "' to '" << decoders[encodingName]->toUnicode( raw.c_str() ).toLocal8Bit().constData() << "'" << std::endl;
-      return decoders[encodingName]->toUnicode( raw.c_str() );
-    }
-    else
-    {
-      std::cerr << "DICOM dataset contains some encoding that we never thought we would see(" << d->m_SpecificCharacterSet.toStdString() << "). Using default encoding." << std::endl;
-    }
+  //std::cout << "Decode from encoding " << d->m_SpecificCharacterSet.toStdString() << std::endl;
+  const ctkDICOMCharacterSetCodecs* characterSets = dicomCharacterSetCodecs();
+  QTextCodec* codec = characterSets ? characterSets->codec( d->m_SpecificCharacterSet ) : 0;
+  if ( codec )
+  {
+    // QTextCodec::toUnicode() keeps no state between calls, unlike a
+    // QTextDecoder, so the codecs can be shared by all the threads.
+    return codec->toUnicode( raw.c_str() );
   }
+  std::cerr << "DICOM dataset contains some encoding that we never thought we would see(" << d->m_SpecificCharacterSet.toStdString() << "). Using default encoding." << std::endl;
 
   return QString::fromLatin1(raw.c_str()); // Latin1 is ISO 8859, which is the default character set of DICOM (PS 3.5-2008, Page 18)
 
@@ -689,6 +834,7 @@ int ctkDICOMItem::GetElementAsUnsignedShort( const DcmTag& tag, unsigned long po
 
 bool ctkDICOMItem::SetElementAsString( const DcmTag& tag, QString string )
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   this->EnsureDcmDataSetIsInitialized();
   // TODO: Evaluate DICOM tag for proper encoding (see GetElementAsString())
@@ -705,6 +851,7 @@ bool ctkDICOMItem::SetElementAsStringList( const DcmTag& /*tag*/, QStringList /*
 
 bool ctkDICOMItem::SetElementAsPersonName( const DcmTag& tag, ctkDICOMPersonName personName )
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   this->EnsureDcmDataSetIsInitialized();
   DcmPersonName* dcmPersonName = new DcmPersonName( tag ); // TODO leak?
@@ -734,6 +881,7 @@ bool ctkDICOMItem::SetElementAsPersonNameList( const DcmTag& tag, ctkDICOMPerson
 
 bool ctkDICOMItem::SetElementAsDate( const DcmTag& tag, QDate date )
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   this->EnsureDcmDataSetIsInitialized();
   OFDate ofDate( date.year(), date.month(), date.day() );
@@ -749,6 +897,7 @@ bool ctkDICOMItem::SetElementAsDate( const DcmTag& tag, QDate date )
 
 bool ctkDICOMItem::SetElementAsTime( const DcmTag& tag, QTime time )
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   this->EnsureDcmDataSetIsInitialized();
   OFTime ofTime( time.hour(), time.minute(), time.second() );
@@ -764,6 +913,7 @@ bool ctkDICOMItem::SetElementAsTime( const DcmTag& tag, QTime time )
 
 bool ctkDICOMItem::SetElementAsDateTime( const DcmTag& tag, QDateTime dateTime )
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   this->EnsureDcmDataSetIsInitialized();
   QDate date = dateTime.date();
@@ -783,6 +933,7 @@ bool ctkDICOMItem::SetElementAsDateTime( const DcmTag& tag, QDateTime dateTime )
 
 bool ctkDICOMItem::SetElementAsInteger( const DcmTag& tag, long value, unsigned long pos )
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   this->EnsureDcmDataSetIsInitialized();
   //std::cerr << "TagVR: " << TagVR( tag ).toStdString() << std::endl;
@@ -791,6 +942,7 @@ bool ctkDICOMItem::SetElementAsInteger( const DcmTag& tag, long value, unsigned
 
 bool ctkDICOMItem::SetElementAsSignedShort( const DcmTag& tag, int value, unsigned long pos )
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   this->EnsureDcmDataSetIsInitialized();
   //std::cerr << "TagVR: " << TagVR( tag ).toStdString() << std::endl;
@@ -799,6 +951,7 @@ bool ctkDICOMItem::SetElementAsSignedShort( const DcmTag& tag, int value, unsign
 
 bool ctkDICOMItem::SetElementAsUnsignedShort( const DcmTag& tag, int value, unsigned long pos )
 {
+  this->Detach();
   Q_D(ctkDICOMItem);
   this->EnsureDcmDataSetIsInitialized();
   //std::cerr << "TagVR: " << TagVR( tag ).toStdString() << std::endl;
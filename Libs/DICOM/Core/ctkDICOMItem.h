@@ -59,6 +59,10 @@ class ctkDICOMItemPrivate;
 ///  A subclass could possibly want to store the internal DcmDataset.
 ///  For this purpose, the internal DcmDataset is serialized into a memory buffer using DcmDataset::write(..). This buffer
 ///  is stored in a base64 encoded string. For deserialization we decode the string and use DcmDataset::read(..).
+///
+///  ctkDICOMItem is implicitly shared: copying an item only copies a pointer and the internal DcmItem is
+///  cloned the first time one of the copies is modified. Items can be passed by value between threads
+///  without serializing them, as long as each thread uses its own copy.
 class ctkDICOMItem;
 
 typedef ctkDICOMItem ctkDICOMItem;
@@ -73,8 +77,12 @@ public:
     ///
     /// @param strictErrorHandling If set to false (the default) only critical errors throw exceptions.
     ctkDICOMItem(bool strictErrorHandling = false);
+    /// \brief Shallow copy, the dataset is shared until one of the items is modified.
+    ctkDICOMItem(const ctkDICOMItem& other);
     virtual ~ctkDICOMItem();
 
+    ctkDICOMItem& operator=(const ctkDICOMItem& other);
+
     /// \brief For initialization from a DcmDataset in a constructor / assignment.
     ///
     /// This method should be overwritten by all derived classes. It should
@@ -93,6 +101,45 @@ public:
                     const Uint32 maxReadLength = DCM_MaxReadLength,
                     const E_FileReadMode readMode = ERM_autoDetect);
 
+    ///
+    /// \brief For initialization from the header of a file.
+    ///
+    /// Only the elements preceding the pixel data (7FE0,0010) are parsed,
+    /// which is all that is needed to index a file. When the DCMTK in use
+    /// can not stop parsing at a given tag, the file is read with a bounded
+    /// maxReadLength instead so that large element values are skipped.
+    ///
+    virtual void InitializeFromFileHeader(const QString& filename);
+
+    ///
+    /// \brief For initialization from the beginning of a file.
+    ///
+    /// Only the elements preceding \a stopTag are parsed. Use it to read a
+    /// few elements of a file without parsing the elements that follow them.
+    /// When the DCMTK in use can not stop parsing at a given tag, the file
+    /// is read as in InitializeFromFileHeader() if \a stopTag is not past
+    /// the pixel data, or entirely otherwise.
+    ///
+    virtual void InitializeFromFileUntilTag(const QString& filename, const DcmTagKey& stopTag);
+
+    ///
+    /// \brief For initialization from a memory-mapped file.
+    ///
+    /// The file is mapped with QFile::map() and DCMTK parses it from memory
+    /// instead of reading it through a file stream, so repeated reads of the
+    /// same files are served from the page cache without read() copies.
+    /// The element values are copied out of the mapping while parsing and
+    /// the mapping is released before returning.
+    /// Parsing stops at \a stopTag when the DCMTK in use supports it, pass
+    /// DCM_PixelData to only read the header. DCMTK can not postpone the
+    /// loading of large values (maxReadLength) from a memory stream, it
+    /// needs a file it can reopen.
+    /// \returns false if the file could not be mapped or parsed.
+    ///
+    bool InitializeFromMappedFile(const QString& filename,
+                    const DcmTagKey& stopTag = DCM_UndefinedTagKey,
+                    const E_TransferSyntax readXfer = EXS_Unknown,
+                    const E_GrpLenEncoding groupLength = EGL_noChange);
 
 
     /// \brief Save dataset to file
@@ -114,6 +161,19 @@ public:
     /// the internal DcmDataset is created using DcmDataset::read(..).
     void Deserialize();
 
+    /// \brief Binary serialization of the internal DcmDataset.
+    ///
+    /// The dataset is written with DcmDataset::write(..) directly into the returned
+    /// array, which is sized from the encoded length of the dataset. Unlike Serialize(),
+    /// there is no base64 encoding and no limit on the size of the dataset.
+    QByteArray SerializeToByteArray() const;
+
+    /// \brief For initialization from the output of SerializeToByteArray().
+    ///
+    /// The dataset is read with DcmDataset::read(..) directly from buffer.
+    /// \returns false if the buffer could not be read completely.
+    bool InitializeFromByteArray(const QByteArray& buffer);
+
 
     /// \brief To be called from InitializeData, flags status as dirty.
     ///
@@ -252,7 +312,15 @@ protected:
     ///
     virtual void SetStoredSerialization(QString serializedDataset);
 
-  QScopedPointer<ctkDICOMItemPrivate> d_ptr;
+  QExplicitlySharedDataPointer<ctkDICOMItemPrivate> d_ptr;
+
+  ///
+  /// \brief Give this item its own copy of the shared dataset.
+  ///
+  /// Called by all the methods modifying the dataset. Subclasses modifying the
+  /// item returned by GetDcmItem() must call it first.
+  ///
+  void Detach();
 
   DcmItem& GetDcmItem() const;
 
@@ -260,5 +328,7 @@ private:
   Q_DECLARE_PRIVATE(ctkDICOMItem);
 };
 
+Q_DECLARE_METATYPE(ctkDICOMItem)
+
 #endif
 
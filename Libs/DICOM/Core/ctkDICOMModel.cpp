@@ -29,11 +29,9 @@
 #include <QTime>
 #include <QDebug>
 
-// dcmtk includes
-#include "dcvrpn.h"
-
 // ctkDICOMCore includes
 #include "ctkDICOMModel.h"
+#include "ctkDICOMPersonName.h"
 #include "ctkLogger.h"
 
 static ctkLogger logger ( "org.commontk.dicom.DICOMModel" );
@@ -64,7 +62,14 @@ public:
   QVariant value(Node* parentValue, int row, int field)const;
   QVariant value(const QModelIndex& indexValue, int row, int field)const;
   QString  generateQuery(const QString& fields, const QString& table, const QString& conditions = QString())const;
+  /// Keep the UID field and the fields aliased to a header, returns them as
+  /// a comma separated list and their aliases in columns.
+  QString  projectFields(const QStringList& fields, QStringList& columns)const;
   void updateQueries(Node* node)const;
+  /// Bind the values of the conditions of node to query
+  void bindConditionValues(QSqlQuery& query, Node* node)const;
+  /// Number of children of node in the database, counted once with COUNT(*).
+  int totalRowCount(Node* node)const;
 
   Node*        RootNode;
   QSqlDatabase DataBase;
@@ -93,7 +98,18 @@ struct Node
   Node*                           Parent;
   QVector<Node*>                  Children;
   int                             Row;
-  QSqlQuery                       Query;
+  /// Query of the children, fetched page by page with LIMIT/OFFSET
+  QString                         Fields;
+  QString                         Table;
+  QString                         Conditions;
+  /// Values bound to the placeholders of Conditions
+  QVariantList                    ConditionValues;
+  /// Aliases of the fetched fields, the UID is always the first one
+  QStringList                     Columns;
+  /// Values of the children fetched so far
+  QVector<QVector<QVariant> >     Rows;
+  /// Number of children in the database, -1 if not counted yet
+  int                             TotalRowCount;
   QString                         UID;
   int                             RowCount;
   bool                            AtEnd;
@@ -276,13 +292,11 @@ QVariant ctkDICOMModelPrivate::value(Node* parentNode, int row, int column) cons
     return QVariant();
     }
 
-  if (!parentNode->Query.seek(row))
+  if (row >= parentNode->Rows.size() || column >= parentNode->Rows[row].size())
     {
-    qDebug() << parentNode->Query.lastError();
-    Q_ASSERT(parentNode->Query.seek(row));
     return QVariant();
     }
-  QVariant res = parentNode->Query.value(column);
+  QVariant res = parentNode->Rows[row][column];
   Q_ASSERT(res.isValid());
   return res;
 }
@@ -297,18 +311,53 @@ QString ctkDICOMModelPrivate::generateQuery(const QString& fields, const QString
     }
   if (!this->Sort.isEmpty())
     {
-    res += QString(" ORDER BY ") + this->Sort;
+    // the UID keeps the order of the pages stable when sorted values are equal
+    res += QString(" ORDER BY ") + this->Sort + QString(", UID");
     }
   logger.debug ( "ctkDICOMModelPrivate::generateQuery: query is: " + res );
   return res;
 }
 
+//------------------------------------------------------------------------------
+// Pattern matching the values containing text with LIKE ... ESCAPE '\'
+static QString likeSubstringPattern(const QString& text)
+{
+  QString escaped = text;
+  escaped.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+  return QString("%") + escaped + QString("%");
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMModelPrivate::projectFields(const QStringList& fields, QStringList& columns)const
+{
+  QStringList headerNames;
+  for (int i = 0; i < this->Headers.size(); ++i)
+    {
+    headerNames << this->Headers[i][Qt::DisplayRole].toString();
+    }
+  QStringList projectedFields;
+  columns.clear();
+  foreach(const QString& field, fields)
+    {
+    QString alias = field.section(" as ", -1).remove('"');
+    // the UID identifies the nodes, it is always fetched
+    if (projectedFields.isEmpty() || headerNames.contains(alias))
+      {
+      projectedFields << field;
+      columns << alias;
+      }
+    }
+  return projectedFields.join(", ");
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMModelPrivate::updateQueries(Node* node)const
 {
   // are you kidding me, it should be virtualized here :-)
-  QString query;
+  QStringList fields;
+  QString table;
   QString condition;
+  QVariantList values;
   switch(node->Type)
     {
     default:
@@ -317,58 +366,129 @@ void ctkDICOMModelPrivate::updateQueries(Node* node)const
     case ctkDICOMModel::RootType:
       //query = QString("SELECT  FROM ");
       if(this->SearchParameters["Name"].toString() != ""){
-        condition.append("PatientsName LIKE \"%" + this->SearchParameters["Name"].toString() + "%\"");
+        condition.append("PatientsName LIKE ? ESCAPE '\\'");
+        values << likeSubstringPattern(this->SearchParameters["Name"].toString());
       }
-      query = this->generateQuery("UID as UID, PatientsName as Name, PatientsAge as Age, PatientsBirthDate as Date, PatientID as \"Subject ID\"","Patients", condition);
-      logger.debug ( "ctkDICOMModelPrivate::updateQueries for Root: query is: " + query );
+      fields << "UID as UID" << "PatientsName as Name" << "PatientsAge as Age"
+             << "PatientsBirthDate as Date" << "PatientID as \"Subject ID\"";
+      table = "Patients";
       break;
     case ctkDICOMModel::PatientType:
       //query = QString("SELECT  FROM Studies WHERE PatientsUID='%1'").arg(node->UID);
       if(this->SearchParameters["Study"].toString() != "")
         {
-        condition.append("StudyDescription LIKE \"%" + this->SearchParameters["Study"].toString() + "%\"" + " AND ");
+        condition.append("StudyDescription LIKE ? ESCAPE '\\' AND ");
+        values << likeSubstringPattern(this->SearchParameters["Study"].toString());
         }
       if(this->SearchParameters["Modalities"].value<QStringList>().count() > 0)
         {
-        condition.append("ModalitiesInStudy IN (\"" + this->SearchParameters["Modalities"].value<QStringList>().join("\",\"") + "\") AND ");
+        QStringList modalities = this->SearchParameters["Modalities"].value<QStringList>();
+        QStringList placeholders;
+        foreach(const QString& modality, modalities)
+          {
+          placeholders << "?";
+          values << modality;
+          }
+        condition.append("ModalitiesInStudy IN (" + placeholders.join(",") + ") AND ");
         }
       if(this->SearchParameters["StartDate"].toString() != "" &&
          this->SearchParameters["EndDate"].toString() != "")
         {
-          condition.append(" ( StudyDate BETWEEN \'" + QDate::fromString(this->SearchParameters["StartDate"].toString(), "yyyyMMdd").toString("yyyy-MM-dd")
-                           + "\' AND \'" + QDate::fromString(this->SearchParameters["EndDate"].toString(), "yyyyMMdd").toString("yyyy-MM-dd") + "\' ) AND ");
+        condition.append(" ( StudyDate BETWEEN ? AND ? ) AND ");
+        values << QDate::fromString(this->SearchParameters["StartDate"].toString(), "yyyyMMdd").toString("yyyy-MM-dd")
+               << QDate::fromString(this->SearchParameters["EndDate"].toString(), "yyyyMMdd").toString("yyyy-MM-dd");
         }
-      query = this->generateQuery("StudyInstanceUID as UID, StudyDescription as Name, ModalitiesInStudy as Scan, StudyDate as Date, AccessionNumber as Number, InstitutionName as Institution, ReferringPhysician as Referrer, PerformingPhysiciansName as Performer", "Studies", condition + QString("PatientsUID='%1'").arg(node->UID));
-      logger.debug ( "ctkDICOMModelPrivate::updateQueries for Patient: query is: " + query );
+      fields << "StudyInstanceUID as UID" << "StudyDescription as Name" << "ModalitiesInStudy as Scan"
+             << "StudyDate as Date" << "AccessionNumber as Number" << "InstitutionName as Institution"
+             << "ReferringPhysician as Referrer" << "PerformingPhysiciansName as Performer";
+      table = "Studies";
+      condition.append("PatientsUID=?");
+      values << node->UID;
       break;
     case ctkDICOMModel::StudyType:
       //query = QString("SELECT SeriesInstanceUID as UID, SeriesDescription as Name, BodyPartExamined as Scan, SeriesDate as Date, AcquisitionNumber as Number FROM Series WHERE StudyInstanceUID='%1'").arg(node->UID);
       if(this->SearchParameters["Series"].toString() != "")
         {
-        condition.append("SeriesDescription LIKE \"%" + this->SearchParameters["Series"].toString() + "%\"" + " AND ");
+        condition.append("SeriesDescription LIKE ? ESCAPE '\\' AND ");
+        values << likeSubstringPattern(this->SearchParameters["Series"].toString());
         }
-      query = this->generateQuery("SeriesInstanceUID as UID, SeriesDescription as Name, Modality as Age, SeriesNumber as Scan, BodyPartExamined as \"Subject ID\", SeriesDate as Date, AcquisitionNumber as Number","Series",condition + QString("StudyInstanceUID='%1'").arg(node->UID));
-      logger.debug ( "ctkDICOMModelPrivate::updateQueries for Study: query is: " + query );
+      fields << "SeriesInstanceUID as UID" << "SeriesDescription as Name" << "Modality as Age"
+             << "SeriesNumber as Scan" << "BodyPartExamined as \"Subject ID\"" << "SeriesDate as Date"
+             << "AcquisitionNumber as Number";
+      table = "Series";
+      condition.append("StudyInstanceUID=?");
+      values << node->UID;
       break;
     case ctkDICOMModel::SeriesType:
       if(this->SearchParameters["ID"].toString() != "")
         {
-        condition.append("SOPInstanceUID LIKE \"%" + this->SearchParameters["ID"].toString() + "%\"" + " AND ");
+        condition.append("SOPInstanceUID LIKE ? ESCAPE '\\' AND ");
+        values << likeSubstringPattern(this->SearchParameters["ID"].toString());
         }
       //query = QString("SELECT Filename as UID, Filename as Name, SeriesInstanceUID as Date FROM Images WHERE SeriesInstanceUID='%1'").arg(node->UID);
-      query = this->generateQuery("SOPInstanceUID as UID, Filename as Name, SeriesInstanceUID as Date", "Images", condition + QString("SeriesInstanceUID='%1'").arg(node->UID));
-      logger.debug ( "ctkDICOMModelPrivate::updateQueries for Series: query is: " + query );
+      fields << "SOPInstanceUID as UID" << "Filename as Name" << "SeriesInstanceUID as Date";
+      table = "Images";
+      condition.append("SeriesInstanceUID=?");
+      values << node->UID;
       break;
     case ctkDICOMModel::ImageType:
       break;
     }
-  node->Query = QSqlQuery(query, this->DataBase);
+  // only the columns shown by the headers are fetched, the rows are fetched
+  // on demand by fetch() and counted by totalRowCount()
+  node->Fields = this->projectFields(fields, node->Columns);
+  node->Table = table;
+  node->Conditions = condition;
+  node->ConditionValues = values;
+  node->Rows.clear();
+  node->TotalRowCount = -1;
   foreach(Node* child, node->Children)
     {
     this->updateQueries(child);
     }
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMModelPrivate::bindConditionValues(QSqlQuery& query, Node* node)const
+{
+  foreach(const QVariant& value, node->ConditionValues)
+    {
+    query.addBindValue(value);
+    }
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMModelPrivate::totalRowCount(Node* node)const
+{
+  if (node->TotalRowCount >= 0)
+    {
+    return node->TotalRowCount;
+    }
+  node->TotalRowCount = 0;
+  if (node->Table.isEmpty())
+    {
+    return 0;
+    }
+  QString countQuery = QString("SELECT COUNT(*) FROM ") + node->Table;
+  if (!node->Conditions.isEmpty())
+    {
+    countQuery += QString(" WHERE ") + node->Conditions;
+    }
+  QSqlQuery query(this->DataBase);
+  query.prepare(countQuery);
+  this->bindConditionValues(query, node);
+  if (!query.exec())
+    {
+    logger.error("ctkDICOMModelPrivate::totalRowCount: " + query.lastError().text());
+    return 0;
+    }
+  if (query.next())
+    {
+    node->TotalRowCount = query.value(0).toInt();
+    }
+  return node->TotalRowCount;
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMModelPrivate::fetch(const QModelIndex& indexValue, int limit)
 {
@@ -380,29 +500,37 @@ void ctkDICOMModelPrivate::fetch(const QModelIndex& indexValue, int limit)
     }
   node->Fetching = true;
 
-  int newRowCount;
-  const int oldRowCount = node->RowCount;
-
-  // try to seek directly
-  if (node->Query.seek(limit - 1))
-    {
-    newRowCount = limit;
-    }
-  else
+  // only fetch the page of rows between the cached rows and limit
+  const int totalCount = this->totalRowCount(node);
+  const int oldRowCount = node->Rows.size();
+  limit = qMin(limit, totalCount);
+  if (limit > oldRowCount)
     {
-    newRowCount = qMax(oldRowCount, 1);
-    if (node->Query.seek(newRowCount - 1))
+    QSqlQuery query(this->DataBase);
+    query.setForwardOnly(true);
+    QString pageQuery = this->generateQuery(node->Fields, node->Table, node->Conditions)
+      + QString(" LIMIT %1 OFFSET %2").arg(limit - oldRowCount).arg(oldRowCount);
+    query.prepare(pageQuery);
+    this->bindConditionValues(query, node);
+    if (!query.exec())
       {
-      while (node->Query.next())
-        {
-        ++newRowCount;
-        }
+      logger.error("ctkDICOMModelPrivate::fetch: " + query.lastError().text());
       }
-    else
+    const int columnCount = node->Columns.size();
+    while (query.next())
       {
-      // empty or invalid query
-      newRowCount = 0;
+      QVector<QVariant> row(columnCount);
+      for (int column = 0; column < columnCount; ++column)
+        {
+        row[column] = query.value(column);
+        }
+      node->Rows.append(row);
       }
+    }
+  int newRowCount = node->Rows.size();
+  // fewer rows than requested means the table changed since it was counted
+  if (newRowCount >= totalCount || newRowCount < limit)
+    {
     node->AtEnd = true; // this is the end.
     }
   if (newRowCount > 0 && newRowCount > node->RowCount)
@@ -492,7 +620,7 @@ QVariant ctkDICOMModel::data ( const QModelIndex & dataIndex, int role ) const
     const_cast<ctkDICOMModelPrivate *>(d)->fetch(dataIndex, dataIndex.row());
     }
   QString columnName = d->Headers[dataIndex.column()][Qt::DisplayRole].toString();
-  int field = parentNode->Query.record().indexOf(columnName);
+  int field = parentNode->Columns.indexOf(columnName);
   if (field < 0)
     {
     // Not all the columns are in the record, it's ok to have no field here.
@@ -512,48 +640,43 @@ QVariant ctkDICOMModel::data ( const QModelIndex & dataIndex, int role ) const
 
   if (columnName.compare("Name")==0)
     {
-    OFString dicomName = dataValue.toString().toStdString().c_str();
-    OFString formattedName;
-    OFString lastName, firstName, middleName, namePrefix, nameSuffix;
-    OFCondition l_error = DcmPersonName::getNameComponentsFromString(dicomName,
-                                          lastName, firstName, middleName, namePrefix, nameSuffix);
-    if (l_error.good())
+    // The value is parsed in a single pass, ideographic and phonetic
+    // representations included, without converting it to a std::string
+    ctkDICOMPersonName name = ctkDICOMPersonName::fromDicomValue(dataValue.toString());
+    QString formattedName;
+    /* concatenate name components per this convention
+     * Last, First Middle, Suffix (Prefix)
+     * */
+    if (!name.lastName().isEmpty())
       {
-      formattedName.clear();
-      /* concatenate name components per this convention
-       * Last, First Middle, Suffix (Prefix)
-       * */
-      if (!lastName.empty())
+      formattedName += name.lastName();
+      if ( !(name.firstName().isEmpty() && name.middleName().isEmpty()) )
         {
-        formattedName += lastName;
-        if ( !(firstName.empty() && middleName.empty()) )
-          {
-          formattedName += ",";
-          }
-        }
-      if (!firstName.empty())
-        {
-        formattedName += " ";
-        formattedName += firstName;
-        }
-      if (!middleName.empty())
-        {
-        formattedName += " ";
-        formattedName += middleName;
-        }
-      if (!nameSuffix.empty())
-        {
-        formattedName += ", ";
-        formattedName += nameSuffix;
-        }
-      if (!namePrefix.empty())
-        {
-        formattedName += " (";
-        formattedName += namePrefix;
-        formattedName += ")";
+        formattedName += ",";
         }
       }
-      return QString(formattedName.c_str());
+    if (!name.firstName().isEmpty())
+      {
+      formattedName += " ";
+      formattedName += name.firstName();
+      }
+    if (!name.middleName().isEmpty())
+      {
+      formattedName += " ";
+      formattedName += name.middleName();
+      }
+    if (!name.nameSuffix().isEmpty())
+      {
+      formattedName += ", ";
+      formattedName += name.nameSuffix();
+      }
+    if (!name.namePrefix().isEmpty())
+      {
+      formattedName += " (";
+      formattedName += name.namePrefix();
+      formattedName += ")";
+      }
+    return formattedName;
     }
 
   return dataValue;
@@ -613,7 +736,7 @@ bool ctkDICOMModel::hasChildren ( const QModelIndex & parentIndex ) const
     // We don't want to fetch the data because we don't want to add children
     // to the index yet (it would be a mess to add rows inside a hasChildren)
     //const_cast<qCTKDCMTKModelPrivate*>(d)->fetch(parentIndex, 1);
-    bool res = node->Query.seek(0);
+    bool res = d->totalRowCount(node) > 0;
     if (!res)
       {
       // now we know there is no children to the node, don't try next time.
@@ -863,16 +986,6 @@ void ctkDICOMModel::setDatabase(const QSqlDatabase &db)
 
   this->endResetModel();
 
-  // TODO, use hasQuerySize everywhere, not only in setDataBase()
-  bool hasQuerySize = d->RootNode->Query.driver()->hasFeature(QSqlDriver::QuerySize);
-  if (hasQuerySize && d->RootNode->Query.size() > 0)
-    {
-    int newRowCount= d->RootNode->Query.size();
-    beginInsertRows(QModelIndex(), 0, qMax(0, newRowCount - 1));
-    d->RootNode->RowCount = newRowCount;
-    d->RootNode->AtEnd = true;
-    endInsertRows();
-    }
   d->fetch(QModelIndex(), 256);
 }
 
@@ -899,19 +1012,23 @@ void ctkDICOMModel::setDatabase(const QSqlDatabase &db,const QMap<QString, QVari
 
   this->endResetModel();
 
-  // TODO, use hasQuerySize everywhere, not only in setDataBase()
-  bool hasQuerySize = d->RootNode->Query.driver()->hasFeature(QSqlDriver::QuerySize);
-  if (hasQuerySize && d->RootNode->Query.size() > 0)
-    {
-    int newRowCount= d->RootNode->Query.size();
-    beginInsertRows(QModelIndex(), 0, qMax(0, newRowCount - 1));
-    d->RootNode->RowCount = newRowCount;
-    d->RootNode->AtEnd = true;
-    endInsertRows();
-    }
   d->fetch(QModelIndex(), 256);
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMModel::setSearchParameters(const QMap<QString, QVariant>& parameters)
+{
+  Q_D(ctkDICOMModel);
+  this->setDatabase(d->DataBase, parameters);
+}
+
+//------------------------------------------------------------------------------
+QMap<QString, QVariant> ctkDICOMModel::searchParameters()const
+{
+  Q_D(const ctkDICOMModel);
+  return d->SearchParameters;
+}
+
 //------------------------------------------------------------------------------
 ctkDICOMModel::IndexType  ctkDICOMModel::endLevel()const
 {
@@ -62,6 +62,15 @@ public:
   void setDatabase(const QSqlDatabase& dataBase);
   void setDatabase(const QSqlDatabase& dataBase, const QMap<QString,QVariant>& parameters);
 
+  /// Restrict the rows to the entries matching the search parameters, with
+  /// SQL conditions on the queries of the model: the rows that don't match
+  /// are not fetched. Recognized parameters are the substrings "Name"
+  /// (patients), "Study" (studies), "Series" (series) and "ID" (images), the
+  /// "Modalities" of the studies and their "StartDate" and "EndDate"
+  /// (yyyyMMdd). The model is reset.
+  void setSearchParameters(const QMap<QString,QVariant>& parameters);
+  QMap<QString,QVariant> searchParameters()const;
+
   /// Set it before populating the model
   ctkDICOMModel::IndexType endLevel()const;
   void setEndLevel(ctkDICOMModel::IndexType level);
@@ -0,0 +1,198 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+
+// ctkDICOM includes
+#include "ctkDICOMOperationToken.h"
+
+//------------------------------------------------------------------------------
+class ctkDICOMOperationTokenPrivate
+{
+  Q_DECLARE_PUBLIC(ctkDICOMOperationToken);
+
+protected:
+  ctkDICOMOperationToken* const q_ptr;
+
+public:
+  ctkDICOMOperationTokenPrivate(ctkDICOMOperationToken&);
+
+  /// Protects the members below, which are read from other threads.
+  mutable QMutex Mutex;
+  bool Canceled;
+  QString Phase;
+  int ItemsDone;
+  int TotalItems;
+  QElapsedTimer PhaseTimer;
+  /// Time of the last progress() emission
+  qint64 LastProgress;
+
+  /// Mutex must be locked.
+  int estimatedSecondsRemaining()const;
+};
+
+//------------------------------------------------------------------------------
+// ctkDICOMOperationTokenPrivate methods
+
+//------------------------------------------------------------------------------
+ctkDICOMOperationTokenPrivate::ctkDICOMOperationTokenPrivate(ctkDICOMOperationToken& o)
+  : q_ptr(&o)
+  , Canceled(false)
+  , ItemsDone(0)
+  , TotalItems(0)
+  , LastProgress(0)
+{
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMOperationTokenPrivate::estimatedSecondsRemaining()const
+{
+  if (this->ItemsDone <= 0 || this->TotalItems <= 0 || !this->PhaseTimer.isValid())
+    {
+    return -1;
+    }
+  qint64 elapsed = this->PhaseTimer.elapsed();
+  qint64 remainingItems = qMax(0, this->TotalItems - this->ItemsDone);
+  return static_cast<int>((elapsed * remainingItems) / (1000 * qint64(this->ItemsDone)));
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMOperationToken methods
+
+//------------------------------------------------------------------------------
+ctkDICOMOperationToken::ctkDICOMOperationToken(QObject* parent)
+  : QObject(parent)
+  , d_ptr(new ctkDICOMOperationTokenPrivate(*this))
+{
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMOperationToken::~ctkDICOMOperationToken()
+{
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMOperationToken::isCanceled()const
+{
+  Q_D(const ctkDICOMOperationToken);
+  QMutexLocker locker(&d->Mutex);
+  return d->Canceled;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMOperationToken::phase()const
+{
+  Q_D(const ctkDICOMOperationToken);
+  QMutexLocker locker(&d->Mutex);
+  return d->Phase;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMOperationToken::itemsDone()const
+{
+  Q_D(const ctkDICOMOperationToken);
+  QMutexLocker locker(&d->Mutex);
+  return d->ItemsDone;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMOperationToken::totalItems()const
+{
+  Q_D(const ctkDICOMOperationToken);
+  QMutexLocker locker(&d->Mutex);
+  return d->TotalItems;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMOperationToken::estimatedSecondsRemaining()const
+{
+  Q_D(const ctkDICOMOperationToken);
+  QMutexLocker locker(&d->Mutex);
+  return d->estimatedSecondsRemaining();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMOperationToken::startPhase(const QString& phase, int totalItems)
+{
+  Q_D(ctkDICOMOperationToken);
+  {
+  QMutexLocker locker(&d->Mutex);
+  d->Phase = phase;
+  d->ItemsDone = 0;
+  d->TotalItems = qMax(0, totalItems);
+  d->PhaseTimer.start();
+  d->LastProgress = 0;
+  }
+  emit this->phaseChanged(phase);
+  emit this->progress(0, qMax(0, totalItems), -1);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMOperationToken::setItemsDone(int itemsDone)
+{
+  Q_D(ctkDICOMOperationToken);
+  int totalItems;
+  int secondsRemaining;
+  {
+  QMutexLocker locker(&d->Mutex);
+  d->ItemsDone = itemsDone;
+  // the signal is throttled, an item is usually done in a few milliseconds
+  qint64 now = d->PhaseTimer.elapsed();
+  if (now - d->LastProgress < 100 && itemsDone < d->TotalItems)
+    {
+    return;
+    }
+  d->LastProgress = now;
+  totalItems = d->TotalItems;
+  secondsRemaining = d->estimatedSecondsRemaining();
+  }
+  emit this->progress(itemsDone, totalItems, secondsRemaining);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMOperationToken::cancel()
+{
+  Q_D(ctkDICOMOperationToken);
+  {
+  QMutexLocker locker(&d->Mutex);
+  if (d->Canceled)
+    {
+    return;
+    }
+  d->Canceled = true;
+  }
+  emit this->canceled();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMOperationToken::reset()
+{
+  Q_D(ctkDICOMOperationToken);
+  QMutexLocker locker(&d->Mutex);
+  d->Canceled = false;
+  d->Phase.clear();
+  d->ItemsDone = 0;
+  d->TotalItems = 0;
+  d->PhaseTimer.invalidate();
+  d->LastProgress = 0;
+}
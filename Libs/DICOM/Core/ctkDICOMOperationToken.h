@@ -0,0 +1,88 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMOperationToken_h
+#define __ctkDICOMOperationToken_h
+
+// Qt includes
+#include <QObject>
+
+#include "ctkDICOMCoreExport.h"
+
+class ctkDICOMOperationTokenPrivate;
+
+/// \ingroup DICOM_Core
+///
+/// \brief Cancels and follows the progress of a long database operation.
+///
+/// The token is given to the object running the operation (see
+/// ctkDICOMDatabase::setOperationToken() and
+/// ctkDICOMIndexer::setOperationToken()), which reports its phases and the
+/// number of items it has processed. cancel() can be called from any
+/// thread: the operation stops at the next item and rolls back what it has
+/// not committed yet, leaving the database in a consistent state.
+///
+/// The signals are emitted from the thread running the operation, use a
+/// queued connection to update widgets. progress() is emitted at most
+/// every 100 ms, and when the last item of a phase is done.
+///
+class CTK_DICOM_CORE_EXPORT ctkDICOMOperationToken : public QObject
+{
+  Q_OBJECT
+public:
+  explicit ctkDICOMOperationToken(QObject* parent = 0);
+  virtual ~ctkDICOMOperationToken();
+
+  /// Thread safe
+  bool isCanceled()const;
+
+  QString phase()const;
+  int itemsDone()const;
+  /// 0 if unknown
+  int totalItems()const;
+  /// Estimated from the rate of the current phase, -1 if unknown
+  int estimatedSecondsRemaining()const;
+
+  /// Called by the operations: start a phase of totalItems items.
+  void startPhase(const QString& phase, int totalItems);
+  /// Called by the operations after each item.
+  void setItemsDone(int itemsDone);
+
+public Q_SLOTS:
+  /// Request the cancellation of the operation, thread safe.
+  void cancel();
+  /// Clear the cancellation, to run another operation with the token.
+  void reset();
+
+Q_SIGNALS:
+  void phaseChanged(const QString& phase);
+  void progress(int itemsDone, int totalItems, int estimatedSecondsRemaining);
+  /// Emitted from the thread calling cancel()
+  void canceled();
+
+protected:
+  QScopedPointer<ctkDICOMOperationTokenPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDICOMOperationToken);
+  Q_DISABLE_COPY(ctkDICOMOperationToken);
+};
+
+#endif
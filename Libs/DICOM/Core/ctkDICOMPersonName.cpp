@@ -21,6 +21,7 @@
 
 // Qt include
 #include <QSharedData>
+#include <QStringList>
 
 // CTK DICOM Core
 #include "ctkDICOMPersonName.h"
@@ -29,13 +30,56 @@
 class ctkDICOMPersonNameData : public QSharedData
 {
 public:
+  enum
+  {
+    Ideographic = 0,
+    Phonetic,
+    OtherGroupCount
+  };
+  enum
+  {
+    ComponentCount = 5
+  };
+
+  void updateKeys();
+
   QString m_LastName;
   QString m_FirstName;
   QString m_MiddleName;
   QString m_NamePrefix;
   QString m_NameSuffix;
+
+  /// Components of the ideographic and phonetic representations
+  QString m_OtherGroups[OtherGroupCount][ComponentCount];
+
+  QString m_SortKey;
+  QString m_SearchKey;
 };
 
+//------------------------------------------------------------------------------
+void ctkDICOMPersonNameData::updateKeys()
+{
+  // separator sorting before any printable character, "Smith" < "Smithson"
+  const QChar separator(1);
+  this->m_SortKey = ctkDICOMPersonName::normalizedKey(this->m_LastName) + separator
+    + ctkDICOMPersonName::normalizedKey(this->m_FirstName) + separator
+    + ctkDICOMPersonName::normalizedKey(this->m_MiddleName) + separator
+    + ctkDICOMPersonName::normalizedKey(this->m_NameSuffix);
+
+  QStringList components;
+  components << this->m_NamePrefix << this->m_FirstName << this->m_MiddleName
+             << this->m_LastName << this->m_NameSuffix;
+  for (int group = 0; group < OtherGroupCount; ++group)
+    {
+    for (int component = 0; component < ComponentCount; ++component)
+      {
+      components << this->m_OtherGroups[group][component];
+      }
+    }
+  components.removeAll(QString());
+  this->m_SearchKey = ctkDICOMPersonName::normalizedKey(components.join(" "));
+}
+
 //------------------------------------------------------------------------------
 ctkDICOMPersonName::ctkDICOMPersonName(const QString& lastName,
                              const QString& firstName,
@@ -49,6 +93,7 @@ ctkDICOMPersonName::ctkDICOMPersonName(const QString& lastName,
   d->m_MiddleName = middleName;
   d->m_NamePrefix = namePrefix;
   d->m_NameSuffix = nameSuffix;
+  d->updateKeys();
 }
 
 //------------------------------------------------------------------------------
@@ -69,6 +114,66 @@ ctkDICOMPersonName::~ctkDICOMPersonName()
 {
 }
 
+//------------------------------------------------------------------------------
+ctkDICOMPersonName ctkDICOMPersonName::fromDicomValue(const QString& value)
+{
+  QString components[1 + ctkDICOMPersonNameData::OtherGroupCount][ctkDICOMPersonNameData::ComponentCount];
+  const int size = value.size();
+  const QChar* data = value.constData();
+  int group = 0;
+  int component = 0;
+  int start = 0;
+  for (int i = 0; i <= size; ++i)
+    {
+    // the end of the value ends the last group
+    const QChar c = i < size ? data[i] : QChar('=');
+    if (c != QLatin1Char('^') && c != QLatin1Char('='))
+      {
+      continue;
+      }
+    if (group <= ctkDICOMPersonNameData::OtherGroupCount &&
+        component < ctkDICOMPersonNameData::ComponentCount)
+      {
+      int begin = start;
+      int end = i;
+      while (begin < end && data[begin].isSpace())
+        {
+        ++begin;
+        }
+      while (end > begin && data[end - 1].isSpace())
+        {
+        --end;
+        }
+      if (end > begin)
+        {
+        components[group][component] = QString(data + begin, end - begin);
+        }
+      }
+    if (c == QLatin1Char('^'))
+      {
+      ++component;
+      }
+    else
+      {
+      ++group;
+      component = 0;
+      }
+    start = i + 1;
+    }
+
+  ctkDICOMPersonName name(components[0][0], components[0][1], components[0][2],
+                          components[0][3], components[0][4]);
+  for (int otherGroup = 0; otherGroup < ctkDICOMPersonNameData::OtherGroupCount; ++otherGroup)
+    {
+    for (int i = 0; i < ctkDICOMPersonNameData::ComponentCount; ++i)
+      {
+      name.d->m_OtherGroups[otherGroup][i] = components[otherGroup + 1][i];
+      }
+    }
+  name.d->updateKeys();
+  return name;
+}
+
 //------------------------------------------------------------------------------
 QString ctkDICOMPersonName::formattedName() const
 {
@@ -120,6 +225,54 @@ QString ctkDICOMPersonName::nameSuffix() const
   return d->m_NameSuffix;
 }
 
+//------------------------------------------------------------------------------
+ctkDICOMPersonName ctkDICOMPersonName::ideographicName() const
+{
+  const QString* group = d->m_OtherGroups[ctkDICOMPersonNameData::Ideographic];
+  return ctkDICOMPersonName(group[0], group[1], group[2], group[3], group[4]);
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMPersonName ctkDICOMPersonName::phoneticName() const
+{
+  const QString* group = d->m_OtherGroups[ctkDICOMPersonNameData::Phonetic];
+  return ctkDICOMPersonName(group[0], group[1], group[2], group[3], group[4]);
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMPersonName::sortKey() const
+{
+  return d->m_SortKey;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMPersonName::searchKey() const
+{
+  return d->m_SearchKey;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMPersonName::normalizedKey(const QString& text)
+{
+  if (text.isEmpty())
+    {
+    return text;
+    }
+  // decomposed, the diacritics are separate combining marks
+  const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+  QString key;
+  key.reserve(decomposed.size());
+  for (int i = 0; i < decomposed.size(); ++i)
+    {
+    const QChar c = decomposed.at(i);
+    if (c.category() != QChar::Mark_NonSpacing)
+      {
+      key += c;
+      }
+    }
+  return key.toCaseFolded();
+}
+
 //------------------------------------------------------------------------------
 ctkDICOMPersonName::operator QString() const
 {
@@ -50,6 +50,16 @@ public:
   ctkDICOMPersonName& operator=(const ctkDICOMPersonName& other);
 
   virtual ~ctkDICOMPersonName();
+
+  ///
+  /// \brief Parse a DICOM PN value in a single pass
+  ///
+  /// The value is "Last^First^Middle^Prefix^Suffix", optionally followed by
+  /// its ideographic and phonetic representations separated by '='. The
+  /// components of the alphabetic representation are returned by lastName()
+  /// to nameSuffix(), those of the others by ideographicName() and
+  /// phoneticName(). Surrounding spaces are removed.
+  static ctkDICOMPersonName fromDicomValue(const QString& value);
   ///
   /// \brief "Lastname, FirstName MiddleName, Suffix" (useful for alphabetical sorting)
   ///
@@ -61,6 +71,28 @@ public:
   QString namePrefix() const;
   QString nameSuffix() const;
 
+  /// Ideographic and phonetic representations of the name, empty if the
+  /// parsed value had none
+  /// \sa fromDicomValue()
+  ctkDICOMPersonName ideographicName() const;
+  ctkDICOMPersonName phoneticName() const;
+
+  ///
+  /// \brief Key to sort the names: last, first and middle names and suffix,
+  /// case folded and without diacritics. Computed once per name.
+  ///
+  QString sortKey() const;
+  ///
+  /// \brief Key to search the names: the components of all the
+  /// representations, case folded and without diacritics, separated by spaces.
+  /// Computed once per name, to be matched against the normalizedKey() of the
+  /// search text.
+  ///
+  QString searchKey() const;
+
+  /// Case folded \a text without combining diacritical marks
+  static QString normalizedKey(const QString& text);
+
   /// cast operator
   operator QString() const;
   std::string toStdString() const;
@@ -29,6 +29,12 @@
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 // ctkDICOMCore includes
 #include "ctkDICOMQuery.h"
@@ -52,6 +58,8 @@
 
 static ctkLogger logger ( "org.commontk.dicom.DICOMQuery" );
 
+class ctkDICOMQueryPrivate;
+
 //------------------------------------------------------------------------------
 // A customized implemenation so that Qt signals can be emitted
 // when query results are obtained
@@ -59,23 +67,28 @@ class ctkDICOMQuerySCUPrivate : public DcmSCU
 {
 public:
   ctkDICOMQuery *query;
+  /// If set, the responses are handed to StudyQuery as they arrive
+  /// instead of being accumulated in the response list
+  ctkDICOMQueryPrivate *StudyQuery;
   ctkDICOMQuerySCUPrivate()
     {
     this->query = 0;
+    this->StudyQuery = 0;
     };
   ~ctkDICOMQuerySCUPrivate() {};
   virtual OFCondition handleFINDResponse(const T_ASC_PresentationContextID  presID,
                                          QRResponse *response,
-                                         OFBool &waitForNextResponse)
-    {
-      if (this->query)
-        {
-        logger.debug ( "FIND RESPONSE" );
-        emit this->query->debug("Got a find response!");
-        return this->DcmSCU::handleFINDResponse(presID, response, waitForNextResponse);
-        }
-      return DIMSE_NULLKEY;
-    };
+                                         OFBool &waitForNextResponse);
+};
+
+//------------------------------------------------------------------------------
+/// Series level C-FIND of one study
+struct ctkDICOMQuerySeriesResult
+{
+  int StudyIndex;
+  bool Success;
+  /// Owned by the result, with the patient elements of the study added
+  QList<DcmDataset*> Datasets;
 };
 
 //------------------------------------------------------------------------------
@@ -86,7 +99,20 @@ public:
   ~ctkDICOMQueryPrivate();
 
   /// Add a StudyInstanceUID to be queried
-  void addStudyInstanceUIDAndDataset(const QString& StudyInstanceUID, DcmDataset* dataset );
+  void addStudyInstanceUIDAndDataset(const QString& StudyInstanceUID, const ctkDICOMItem& dataset );
+
+  /// Called for each response of the study level query, as it arrives.
+  /// Takes ownership of dataset.
+  void handleStudyResponse(DcmDataset* dataset);
+
+  /// Called from the series query threads.
+  /// Returns false if there is no study left to query.
+  bool takeNextStudy(int& studyIndex);
+  void addSeriesResult(const ctkDICOMQuerySeriesResult& result);
+
+  /// Run the series level queries on up to MaximumAssociations
+  /// associations and insert the results into database as they arrive.
+  bool querySeries(ctkDICOMDatabase& database, Uint16 presentationContext);
 
   QString                 CallingAETitle;
   QString                 CalledAETitle;
@@ -97,10 +123,146 @@ public:
   ctkDICOMQuerySCUPrivate SCU;
   DcmDataset*             Query;
   QStringList             StudyInstanceUIDList;
-  QList<DcmDataset*>      StudyDatasetList;
+  QList<ctkDICOMItem>     StudyDatasetList;
   bool                    Canceled;
+  /// Database the results are inserted into, only set during query()
+  ctkDICOMDatabase*       Database;
+  int                     MaximumAssociations;
+
+  /// Query sent for each study, without the StudyInstanceUID
+  DcmDataset*             SeriesQuery;
+  QThreadPool             SeriesQueryPool;
+
+  /// Protects the members below, which are shared with the series query threads.
+  mutable QMutex                    Mutex;
+  QWaitCondition                    SeriesResultAvailable;
+  QQueue<int>                       PendingStudies;
+  QQueue<ctkDICOMQuerySeriesResult> SeriesResults;
+
+  ctkDICOMQuery* q_ptr;
+  Q_DECLARE_PUBLIC(ctkDICOMQuery);
 };
 
+//------------------------------------------------------------------------------
+/// Sends the series level queries on its own association. The first task
+/// reuses the association of the study level query, the others negotiate a
+/// new one and give up if the peer refuses it.
+class ctkDICOMQuerySeriesTask : public QRunnable
+{
+public:
+  ctkDICOMQuerySeriesTask(ctkDICOMQueryPrivate* query,
+                          ctkDICOMQuerySCUPrivate* scu, Uint16 presentationContext)
+    : Query(query)
+    , SCU(scu)
+    , PresentationContext(presentationContext)
+  {
+  }
+
+  virtual void run();
+
+protected:
+  /// Negotiate a new association with the settings of the study level query.
+  bool negotiateAssociation(ctkDICOMQuerySCUPrivate& scu);
+  ctkDICOMQuerySeriesResult querySeries(ctkDICOMQuerySCUPrivate& scu, int studyIndex);
+
+  ctkDICOMQueryPrivate* Query;
+  /// Not owned, null if the task negotiates its own association
+  ctkDICOMQuerySCUPrivate* SCU;
+  Uint16 PresentationContext;
+};
+
+//------------------------------------------------------------------------------
+void ctkDICOMQuerySeriesTask::run()
+{
+  ctkDICOMQuerySCUPrivate ownSCU;
+  ctkDICOMQuerySCUPrivate* scu = this->SCU;
+  if (!scu)
+    {
+    ownSCU.query = this->Query->q_ptr;
+    if (!this->negotiateAssociation(ownSCU))
+      {
+      return;
+      }
+    scu = &ownSCU;
+    }
+
+  int studyIndex;
+  while (this->Query->takeNextStudy(studyIndex))
+    {
+    this->Query->addSeriesResult(this->querySeries(*scu, studyIndex));
+    }
+
+  if (scu == &ownSCU)
+    {
+    ownSCU.closeAssociation( DCMSCU_RELEASE_ASSOCIATION );
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMQuerySeriesTask::negotiateAssociation(ctkDICOMQuerySCUPrivate& scu)
+{
+  scu.setAETitle( this->Query->SCU.getAETitle() );
+  scu.setPeerAETitle( this->Query->SCU.getPeerAETitle() );
+  scu.setPeerHostName( this->Query->SCU.getPeerHostName() );
+  scu.setPeerPort( this->Query->SCU.getPeerPort() );
+
+  OFList<OFString> transferSyntaxes;
+  transferSyntaxes.push_back ( UID_LittleEndianExplicitTransferSyntax );
+  transferSyntaxes.push_back ( UID_BigEndianExplicitTransferSyntax );
+  transferSyntaxes.push_back ( UID_LittleEndianImplicitTransferSyntax );
+  scu.addPresentationContext ( UID_FINDStudyRootQueryRetrieveInformationModel, transferSyntaxes );
+
+  if ( !scu.initNetwork().good() )
+    {
+    return false;
+    }
+  OFCondition result = scu.negotiateAssociation();
+  if ( result.bad() )
+    {
+    // most likely the peer does not accept more associations
+    logger.debug( "Series query association refused: " + QString(result.text()) );
+    return false;
+    }
+  this->PresentationContext = scu.findPresentationContextID ( UID_FINDStudyRootQueryRetrieveInformationModel, "");
+  return true;
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMQuerySeriesResult ctkDICOMQuerySeriesTask::querySeries(ctkDICOMQuerySCUPrivate& scu,
+                                                               int studyIndex)
+{
+  ctkDICOMQuerySeriesResult result;
+  result.StudyIndex = studyIndex;
+
+  // the study datasets are not modified while the series are queried
+  const ctkDICOMItem& studyDataset = this->Query->StudyDatasetList[studyIndex];
+  OFString patientName, patientID;
+  studyDataset.findAndGetOFString(DCM_PatientName, patientName);
+  studyDataset.findAndGetOFString(DCM_PatientID, patientID);
+
+  DcmDataset query(*this->Query->SeriesQuery);
+  query.putAndInsertString ( DCM_StudyInstanceUID,
+    this->Query->StudyInstanceUIDList[studyIndex].toStdString().c_str() );
+
+  OFList<QRResponse *> responses;
+  OFCondition status = scu.sendFINDRequest ( this->PresentationContext, &query, &responses );
+  result.Success = status.good();
+  for ( OFIterator<QRResponse*> it = responses.begin(); it != responses.end(); it++ )
+    {
+    DcmDataset *dataset = (*it)->m_dataset;
+    if ( dataset != NULL && result.Success )
+      {
+      // add the patient elements not provided for the series level query
+      dataset->putAndInsertString( DCM_PatientName, patientName.c_str() );
+      dataset->putAndInsertString( DCM_PatientID, patientID.c_str() );
+      result.Datasets.append( dataset );
+      (*it)->m_dataset = NULL;
+      }
+    delete *it;
+    }
+  return result;
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMQueryPrivate methods
 
@@ -110,22 +272,173 @@ ctkDICOMQueryPrivate::ctkDICOMQueryPrivate()
   this->Query = new DcmDataset();
   this->Port = 0;
   this->Canceled = false;
+  this->Database = 0;
   this->PreferCGET = false;
+  this->MaximumAssociations = 4;
+  this->SeriesQuery = new DcmDataset();
+  this->q_ptr = 0;
 }
 
 //------------------------------------------------------------------------------
 ctkDICOMQueryPrivate::~ctkDICOMQueryPrivate()
 {
   delete this->Query;
+  delete this->SeriesQuery;
 }
 
 //------------------------------------------------------------------------------
-void ctkDICOMQueryPrivate::addStudyInstanceUIDAndDataset( const QString& s, DcmDataset* dataset )
+void ctkDICOMQueryPrivate::addStudyInstanceUIDAndDataset( const QString& s, const ctkDICOMItem& dataset )
 {
   this->StudyInstanceUIDList.append ( s );
   this->StudyDatasetList.append ( dataset );
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMQueryPrivate::handleStudyResponse(DcmDataset* dataset)
+{
+  Q_Q(ctkDICOMQuery);
+  ctkDICOMItem study;
+  study.InitializeFromItem(dataset, true /* take ownership */);
+  if (this->Canceled)
+    {
+    return;
+    }
+  // inserted in the bulk insert session started by query(), which commits
+  // the results in small batches
+  this->Database->insert ( study, false /* do not store to disk*/, false /* no thumbnail*/);
+  QString studyInstanceUID = study.GetStudyInstanceUID();
+  this->addStudyInstanceUIDAndDataset ( studyInstanceUID, study );
+  emit q->studyFound(study);
+  emit q->progress(QString("Processing: ") + studyInstanceUID);
+}
+
+//------------------------------------------------------------------------------
+OFCondition ctkDICOMQuerySCUPrivate::handleFINDResponse(const T_ASC_PresentationContextID  presID,
+                                                        QRResponse *response,
+                                                        OFBool &waitForNextResponse)
+{
+  if (this->query)
+    {
+    logger.debug ( "FIND RESPONSE" );
+    emit this->query->debug("Got a find response!");
+    OFCondition condition = this->DcmSCU::handleFINDResponse(presID, response, waitForNextResponse);
+    if (this->StudyQuery && response && response->m_dataset)
+      {
+      // the last response is always empty
+      this->StudyQuery->handleStudyResponse(response->m_dataset);
+      response->m_dataset = NULL;
+      }
+    return condition;
+    }
+  return DIMSE_NULLKEY;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMQueryPrivate::takeNextStudy(int& studyIndex)
+{
+  QMutexLocker locker(&this->Mutex);
+  if (this->Canceled || this->PendingStudies.isEmpty())
+    {
+    return false;
+    }
+  studyIndex = this->PendingStudies.dequeue();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMQueryPrivate::addSeriesResult(const ctkDICOMQuerySeriesResult& result)
+{
+  QMutexLocker locker(&this->Mutex);
+  this->SeriesResults.enqueue(result);
+  this->SeriesResultAvailable.wakeAll();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMQueryPrivate::querySeries(ctkDICOMDatabase& database, Uint16 presentationContext)
+{
+  Q_Q(ctkDICOMQuery);
+  const int studyCount = this->StudyInstanceUIDList.count();
+  {
+  QMutexLocker locker(&this->Mutex);
+  this->PendingStudies.clear();
+  for (int i = 0; i < studyCount; ++i)
+    {
+    this->PendingStudies.enqueue(i);
+    }
+  this->SeriesResults.clear();
+  }
+
+  // one thread per association, the first one reuses the study level association
+  const int associationCount = qMax(1, qMin(this->MaximumAssociations, studyCount));
+  this->SeriesQueryPool.setMaxThreadCount(associationCount);
+  this->SeriesQueryPool.start(
+    new ctkDICOMQuerySeriesTask(this, &this->SCU, presentationContext));
+  for (int i = 1; i < associationCount; ++i)
+    {
+    this->SeriesQueryPool.start(new ctkDICOMQuerySeriesTask(this, 0, 0));
+    }
+
+  // the results are inserted from this thread, which owns the database
+  // connection, as they arrive
+  int completedStudies = 0;
+  bool canceled = false;
+  while (completedStudies < studyCount && !canceled)
+    {
+    QQueue<ctkDICOMQuerySeriesResult> results;
+    {
+    QMutexLocker locker(&this->Mutex);
+    if (this->SeriesResults.isEmpty())
+      {
+      // wake up regularly to check whether the query has been canceled
+      this->SeriesResultAvailable.wait(&this->Mutex, 100);
+      }
+    results = this->SeriesResults;
+    this->SeriesResults.clear();
+    canceled = this->Canceled;
+    }
+
+    foreach(const ctkDICOMQuerySeriesResult& result, results)
+      {
+      const QString& studyInstanceUID = this->StudyInstanceUIDList[result.StudyIndex];
+      foreach(DcmDataset* dataset, result.Datasets)
+        {
+        ctkDICOMItem series;
+        series.InitializeFromItem(dataset, true /* take ownership */);
+        if (!canceled)
+          {
+          database.insert ( series, false /* do not store */, false /* no thumbnail */ );
+          emit q->seriesFound(series);
+          }
+        }
+      ++completedStudies;
+      if (result.Success)
+        {
+        logger.debug ( "Find succeded on Series level for Study: " + studyInstanceUID );
+        emit q->progress(QString("Find succeded on Series level for Study: ") + studyInstanceUID);
+        }
+      else
+        {
+        logger.error ( "Find on Series level failed for Study: " + studyInstanceUID );
+        emit q->progress(QString("Find on Series level failed for Study: ") + studyInstanceUID);
+        }
+      emit q->progress(50 + (50 * completedStudies) / (studyCount + 1));
+      }
+    }
+
+  // wait for the tasks to finish, they don't take new studies once canceled
+  this->SeriesQueryPool.waitForDone();
+  {
+  QMutexLocker locker(&this->Mutex);
+  foreach(const ctkDICOMQuerySeriesResult& result, this->SeriesResults)
+    {
+    qDeleteAll(result.Datasets);
+    }
+  this->SeriesResults.clear();
+  this->PendingStudies.clear();
+  }
+  return !canceled;
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMQuery methods
 
@@ -135,7 +448,9 @@ ctkDICOMQuery::ctkDICOMQuery(QObject* parentObject)
   , d_ptr(new ctkDICOMQueryPrivate)
 {
   Q_D(ctkDICOMQuery);
+  d->q_ptr = this;
   d->SCU.query = this; // give the dcmtk level access to this for emitting signals
+  qRegisterMetaType<ctkDICOMItem>("ctkDICOMItem");
 }
 
 //------------------------------------------------------------------------------
@@ -214,6 +529,20 @@ bool ctkDICOMQuery::preferCGET()const
   return d->PreferCGET;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMQuery::setMaximumAssociations ( int associationCount )
+{
+  Q_D(ctkDICOMQuery);
+  d->MaximumAssociations = qMax(1, associationCount);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMQuery::maximumAssociations()const
+{
+  Q_D(const ctkDICOMQuery);
+  return d->MaximumAssociations;
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMQuery::setFilters( const QMap<QString,QVariant>& filters )
 {
@@ -260,6 +589,7 @@ bool ctkDICOMQuery::query(ctkDICOMDatabase& database )
   if (d->Canceled) {return false;}
 
   d->StudyInstanceUIDList.clear();
+  d->StudyDatasetList.clear();
   d->SCU.setAETitle ( OFString(this->callingAETitle().toStdString().c_str()) );
   d->SCU.setPeerAETitle ( OFString(this->calledAETitle().toStdString().c_str()) );
   d->SCU.setPeerHostName ( OFString(this->host().toStdString().c_str()) );
@@ -398,11 +728,24 @@ bool ctkDICOMQuery::query(ctkDICOMDatabase& database )
   emit progress(40);
   if (d->Canceled) {return false;}
 
+  // The responses are inserted as they arrive (see handleFINDResponse()),
+  // in a bulk insert session shared with the series datasets.
+  database.beginBulkInsert();
+  d->Database = &database;
+  d->SCU.StudyQuery = d;
   OFCondition status = d->SCU.sendFINDRequest ( presentationContext, d->Query, &responses );
+  d->SCU.StudyQuery = 0;
+  // only the empty responses are left in the list
+  for ( OFIterator<QRResponse*> it = responses.begin(); it != responses.end(); it++ )
+    {
+    delete *it;
+    }
   if ( !status.good() )
     {
     logger.error ( "Find failed" );
     emit progress("Find failed");
+    database.endBulkInsert();
+    d->Database = 0;
     d->SCU.closeAssociation ( DCMSCU_RELEASE_ASSOCIATION );
     emit progress(100);
     return false;
@@ -410,92 +753,43 @@ bool ctkDICOMQuery::query(ctkDICOMDatabase& database )
   logger.debug ( "Find succeded");
   emit progress("Find succeded");
   emit progress(50);
-  if (d->Canceled) {return false;}
-
-  for ( OFIterator<QRResponse*> it = responses.begin(); it != responses.end(); it++ )
+  if (d->Canceled)
     {
-    DcmDataset *dataset = (*it)->m_dataset;
-    if ( dataset != NULL ) // the last response is always empty
-      {
-      database.insert ( dataset, false /* do not store to disk*/, false /* no thumbnail*/);
-      OFString StudyInstanceUID;
-      dataset->findAndGetOFString ( DCM_StudyInstanceUID, StudyInstanceUID );
-      d->addStudyInstanceUIDAndDataset ( StudyInstanceUID.c_str(), dataset );
-      emit progress(QString("Processing: ") + QString(StudyInstanceUID.c_str()));
-      emit progress(50);
-      if (d->Canceled) {return false;}
-      }
+    database.endBulkInsert();
+    d->Database = 0;
+    return false;
     }
 
   /* Only ask for series attributes now. This requires kicking out the rest of former query. */
-  d->Query->clear();
-  d->Query->insertEmptyElement ( DCM_SeriesNumber );
-  d->Query->insertEmptyElement ( DCM_SeriesDescription );
-  d->Query->insertEmptyElement ( DCM_SeriesInstanceUID );
-  d->Query->insertEmptyElement ( DCM_SeriesDate );
-  d->Query->insertEmptyElement ( DCM_SeriesTime );
-  d->Query->insertEmptyElement ( DCM_Modality );
-  d->Query->insertEmptyElement ( DCM_NumberOfSeriesRelatedInstances ); // Number of images in the series
+  d->SeriesQuery->clear();
+  d->SeriesQuery->insertEmptyElement ( DCM_SeriesNumber );
+  d->SeriesQuery->insertEmptyElement ( DCM_SeriesDescription );
+  d->SeriesQuery->insertEmptyElement ( DCM_SeriesInstanceUID );
+  d->SeriesQuery->insertEmptyElement ( DCM_SeriesDate );
+  d->SeriesQuery->insertEmptyElement ( DCM_SeriesTime );
+  d->SeriesQuery->insertEmptyElement ( DCM_Modality );
+  d->SeriesQuery->insertEmptyElement ( DCM_NumberOfSeriesRelatedInstances ); // Number of images in the series
 
   /* Add user-defined filters */
-  d->Query->putAndInsertOFStringArray(DCM_SeriesDescription, seriesDescription.toLatin1().data());
+  d->SeriesQuery->putAndInsertOFStringArray(DCM_SeriesDescription, seriesDescription.toLatin1().data());
 
   // Now search each within each Study that was identified
-  d->Query->putAndInsertString ( DCM_QueryRetrieveLevel, "SERIES" );
-  float progressRatio = 25. / d->StudyInstanceUIDList.count();
-  int i = 0; 
+  d->SeriesQuery->putAndInsertString ( DCM_QueryRetrieveLevel, "SERIES" );
 
-  QListIterator<DcmDataset*> datasetIterator(d->StudyDatasetList);
-  foreach ( QString StudyInstanceUID, d->StudyInstanceUIDList )
-    {
-    DcmDataset *studyDataset = datasetIterator.next();
-    DcmElement *patientName, *patientID;
-    studyDataset->findAndGetElement(DCM_PatientName, patientName);
-    studyDataset->findAndGetElement(DCM_PatientID, patientID);
-
-    logger.debug ( "Starting Series C-FIND for Study: " + StudyInstanceUID );
-    emit progress(QString("Starting Series C-FIND for Study: ") + StudyInstanceUID);
-    emit progress(50 + (progressRatio * i++));
-    if (d->Canceled) {return false;}
-
-    d->Query->putAndInsertString ( DCM_StudyInstanceUID, StudyInstanceUID.toStdString().c_str() );
-    OFList<QRResponse *> responses;
-    status = d->SCU.sendFINDRequest ( presentationContext, d->Query, &responses );
-    if ( status.good() )
-      {
-      for ( OFIterator<QRResponse*> it = responses.begin(); it != responses.end(); it++ )
-        {
-        DcmDataset *dataset = (*it)->m_dataset;
-        if ( dataset != NULL )
-          {
-          // add the patient elements not provided for the series level query
-          dataset->insert( patientName, true );
-          dataset->insert( patientID, true );
-          // insert series dataset 
-          database.insert ( dataset, false /* do not store */, false /* no thumbnail */ );
-          }
-        }
-      logger.debug ( "Find succeded on Series level for Study: " + StudyInstanceUID );
-      emit progress(QString("Find succeded on Series level for Study: ") + StudyInstanceUID);
-      emit progress(50 + (progressRatio * i++));
-      if (d->Canceled) {return false;}
-      }
-    else
-      {
-      logger.error ( "Find on Series level failed for Study: " + StudyInstanceUID );
-      emit progress(QString("Find on Series level failed for Study: ") + StudyInstanceUID);
-      }
-    emit progress(50 + (progressRatio * i++));
-    if (d->Canceled) {return false;}
-    }
+  logger.debug ( "Starting Series C-FIND for " + QString::number(d->StudyInstanceUIDList.count()) + " studies" );
+  emit progress(QString("Starting Series C-FIND for %1 studies").arg(d->StudyInstanceUIDList.count()));
+  bool success = d->querySeries(database, presentationContext);
+  database.endBulkInsert();
+  d->Database = 0;
   d->SCU.closeAssociation ( DCMSCU_RELEASE_ASSOCIATION );
   emit progress(100);
-  return true;
+  return success;
 }
 
 //----------------------------------------------------------------------------
 void ctkDICOMQuery::cancel()
 {
   Q_D(ctkDICOMQuery);
+  QMutexLocker locker(&d->Mutex);
   d->Canceled = true;
 }
@@ -44,6 +44,7 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMQuery : public QObject
   Q_PROPERTY(QString host READ host WRITE setHost);
   Q_PROPERTY(int port READ port WRITE setPort);
   Q_PROPERTY(bool preferCGET READ preferCGET WRITE setPreferCGET);
+  Q_PROPERTY(int maximumAssociations READ maximumAssociations WRITE setMaximumAssociations);
 
 public:
   explicit ctkDICOMQuery(QObject* parent = 0);
@@ -68,6 +69,13 @@ public:
   /// false by default
   void setPreferCGET ( bool preferCGET );
   bool preferCGET()const;
+  /// Maximum number of associations used to send the series level
+  /// queries of the studies found by query() in parallel. Associations
+  /// refused by the peer are not retried, so the actual number is limited
+  /// by the number of associations the peer accepts.
+  /// 4 by default.
+  void setMaximumAssociations ( int associationCount );
+  int maximumAssociations()const;
 
   /// Query a remote DICOM Image Store SCP
   /// You must at least set the host and port before calling query()
@@ -98,16 +106,25 @@ public:
 
 Q_SIGNALS:
   /// Signal is emitted inside the query() function. It ranges from 0 to 100.
-  /// In case of an error, you are assured that the progress value 100 is fired
+  /// In case of an error, you are assured that the progress value 100 is fired.
+  /// It is emitted each time the series of a study have been queried.
   void progress(int progress);
   /// Signal is emitted inside the query() function. It sends the different step
   /// the function is at.
   void progress(const QString& message);
   /// Signal is emitted inside the query() function. It sends 
-  /// detailed feedback for debugging
+  /// detailed feedback for debugging.
+  /// It can be emitted from the threads sending the series level queries.
   void debug(const QString& message);
   /// Signal is emitted inside the query() function. It send any error messages
   void error(const QString& message);
+  /// Emitted inside the query() function for each study found, as soon as
+  /// the C-FIND response is received and the study is inserted into the
+  /// database.
+  void studyFound(const ctkDICOMItem& study);
+  /// Emitted inside the query() function for each series found, once it is
+  /// inserted into the database.
+  void seriesFound(const ctkDICOMItem& series);
   /// Signal is emitted inside the query() function when finished with value 
   /// true for success or false for error
   void done(const bool& error);
@@ -21,6 +21,15 @@
 #include <stdexcept>
 
 // Qt includes
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QQueue>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 // ctkDICOMCore includes
 #include "ctkDICOMRetrieve.h"
@@ -49,6 +58,8 @@
 
 static ctkLogger logger("org.commontk.dicom.DICOMRetrieve");
 
+class ctkDICOMRetrievePrivate;
+
 //------------------------------------------------------------------------------
 // A customized local implemenation of the DcmSCU so that Qt signals can be emitted
 // when retrieve results are obtained
@@ -56,9 +67,17 @@ class ctkDICOMRetrieveSCUPrivate : public DcmSCU
 {
 public:
   ctkDICOMRetrieve *retrieve;
+  /// Set while the incoming datasets are written behind: they are queued
+  /// for the thread inserting them into the database instead of being
+  /// inserted by the handler
+  ctkDICOMRetrievePrivate *Batch;
+  /// Throttles the incoming datasets, see throttleIncomingDataset()
+  ctkDICOMRetrievePrivate *Throttle;
   ctkDICOMRetrieveSCUPrivate()
     {
     this->retrieve = 0;
+    this->Batch = 0;
+    this->Throttle = 0;
     };
   ~ctkDICOMRetrieveSCUPrivate() {};
 
@@ -92,8 +111,14 @@ public:
         incomingObject->findAndGetOFString(DCM_SOPInstanceUID, instanceUID);
         QString qInstanceUID(instanceUID.c_str());
         emit this->retrieve->progress("Got STORE request for " + qInstanceUID);
-        emit this->retrieve->progress(0);
+        this->throttleIncomingDataset(incomingObject);
         continueCGETSession = !this->retrieve->wasCanceled();
+        if (this->Batch && this->retrieve->database())
+          {
+          // the dataset is deleted by DcmSCU once handled
+          return this->queueIncomingDataset(new DcmDataset(*incomingObject));
+          }
+        emit this->retrieve->progress(0);
         if (this->retrieve && this->retrieve->database())
           {
           this->retrieve->database()->insert(incomingObject);
@@ -118,15 +143,73 @@ public:
       if (this->retrieve)
         {
         emit this->retrieve->progress("Got CGET response");
-        emit this->retrieve->progress(0);
+        if (!this->Batch)
+          {
+          emit this->retrieve->progress(0);
+          }
         continueCGETSession = !this->retrieve->wasCanceled();
         return this->DcmSCU::handleCGETResponse(presID, response, continueCGETSession);
         }
       //return false;
       return EC_IllegalCall;
     };
+
+  /// Defined after ctkDICOMRetrievePrivate
+  OFCondition queueIncomingDataset(DcmDataset* dataset);
+  /// Delay the handling of the dataset to keep the transfer rate under the
+  /// cap in effect. Defined after ctkDICOMRetrievePrivate
+  void throttleIncomingDataset(DcmDataset* dataset);
 };
 
+//------------------------------------------------------------------------------
+/// Presentation contexts used for both C-MOVE and C-GET
+static void addRetrievePresentationContexts(DcmSCU& scu)
+{
+  OFList<OFString> transferSyntaxes;
+  transferSyntaxes.push_back ( UID_LittleEndianExplicitTransferSyntax );
+  transferSyntaxes.push_back ( UID_BigEndianExplicitTransferSyntax );
+  transferSyntaxes.push_back ( UID_LittleEndianImplicitTransferSyntax );
+  scu.addPresentationContext (
+      UID_MOVEStudyRootQueryRetrieveInformationModel, transferSyntaxes );
+  scu.addPresentationContext (
+      UID_GETStudyRootQueryRetrieveInformationModel, transferSyntaxes );
+
+  for (Uint16 i = 0; i < numberOfDcmLongSCUStorageSOPClassUIDs; i++)
+    {
+    scu.addPresentationContext(dcmLongSCUStorageSOPClassUIDs[i],
+        transferSyntaxes, ASC_SC_ROLE_SCP);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Number of retrieveSeriesBatch() associations opened to each peer
+/// ("host:port") by all the ctkDICOMRetrieve objects of the application
+static QMutex PeerAssociationsMutex;
+static QHash<QString, int> PeerAssociations;
+
+//------------------------------------------------------------------------------
+static bool acquirePeerAssociation(const QString& peer, int maximumAssociations, bool force)
+{
+  QMutexLocker locker(&PeerAssociationsMutex);
+  int& associations = PeerAssociations[peer];
+  if (!force && associations >= maximumAssociations)
+    {
+    return false;
+    }
+  ++associations;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void releasePeerAssociation(const QString& peer)
+{
+  QMutexLocker locker(&PeerAssociationsMutex);
+  if (--PeerAssociations[peer] <= 0)
+    {
+    PeerAssociations.remove(peer);
+    }
+}
+
 
 //------------------------------------------------------------------------------
 class ctkDICOMRetrievePrivate: public QObject
@@ -160,8 +243,281 @@ public:
   bool get ( const QString& studyInstanceUID,
                   const QString& seriesInstanceUID,
                   const RetrieveType retrieveType );
+
+  /// Run the C-GETs of seriesInstanceUIDs on a pool of associations and
+  /// insert the received datasets into Database from the calling thread.
+  bool getSeriesBatch ( const QString& studyInstanceUID,
+                        const QStringList& seriesInstanceUIDs );
+
+  /// Send the C-GET request with SCU on a thread of BatchPool while the
+  /// calling thread inserts the incoming datasets (see writeIncomingDatasets())
+  OFCondition sendCGETRequestWriteBehind(T_ASC_PresentationContextID presID,
+                                         DcmDataset* retrieveParameters,
+                                         OFList<RetrieveResponse*>* responses);
+  /// Insert the datasets queued by the running tasks into Database in
+  /// batches, until all the tasks are done. Must be called from the thread
+  /// owning Database.
+  void writeIncomingDatasets();
+
+  /// Called from the batch tasks. Returns false if there is no series left.
+  bool takeNextBatchSeries(int& seriesIndex);
+  void addBatchSeriesResult(int seriesIndex, bool success);
+  void batchTaskDone();
+  /// Called from the SCU handlers, blocks only if the queue is full
+  void addIncomingDataset(DcmDataset* dataset);
+  /// Wait msec or until the batch is canceled. Returns false if canceled.
+  bool waitBeforeRetry(int msec);
+
+  /// Reset the transfer rate at the start of a C-GET retrieve
+  void startTransfer();
+  /// Account for bytes received by a SCU handler and wait as long as
+  /// needed to stay under the cap in effect
+  void throttleTransfer(qint64 bytes);
+  /// Average rate since startTransfer() and cap applied to the transfer
+  void transferRate(qint64& bytesPerSecond, qint64& maximumBytesPerSecond);
+  /// Caps in effect at the current time of day. ThrottleMutex must be locked.
+  qint64 effectiveMaximumBytesPerSecond()const;
+  int effectiveMaximumAssociations()const;
+
+  int MaximumAssociations;
+  int MaximumRetries;
+  int MaximumQueuedDatasets;
+
+  struct ThrottleProfile
+    {
+    QTime StartTime;
+    QTime EndTime;
+    qint64 MaximumBytesPerSecond;
+    int MaximumAssociations;
+    };
+  /// Protects the throttling members below, which are used by the SCU
+  /// handlers of the batch tasks.
+  mutable QMutex    ThrottleMutex;
+  qint64            MaximumBytesPerSecond;
+  QList<ThrottleProfile> ThrottleProfiles;
+  QElapsedTimer     TransferTimer;
+  qint64            TransferredBytes;
+  /// Time since TransferTimer started at which TransferredBytes are
+  /// within the cap
+  qint64            TransferDeadline;
+  qint64            TransferMaximumBytesPerSecond;
+  /// First profile containing the current time of day, or 0.
+  /// ThrottleMutex must be locked.
+  const ThrottleProfile* currentThrottleProfile()const;
+
+  /// Caps of the running retrieveSeriesBatch()
+  int               BatchMaximumAssociations;
+
+  QString           BatchStudyInstanceUID;
+  QStringList       BatchSeriesInstanceUIDs;
+  QThreadPool       BatchPool;
+  /// Protects the members below, which are shared with the batch tasks.
+  QMutex            BatchMutex;
+  QWaitCondition    BatchChanged;
+  QWaitCondition    IncomingDatasetsConsumed;
+  QWaitCondition    BatchCanceled;
+  QQueue<int>       BatchPendingSeries;
+  QQueue<DcmDataset*>      IncomingDatasets;
+  QQueue<QPair<int, bool> > BatchResults;
+  int               BatchRunningTasks;
+  int               BatchCompletedSeries;
+  int               BatchFailedSeries;
 };
 
+//------------------------------------------------------------------------------
+OFCondition ctkDICOMRetrieveSCUPrivate::queueIncomingDataset(DcmDataset* dataset)
+{
+  this->Batch->addIncomingDataset(dataset);
+  return EC_Normal;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveSCUPrivate::throttleIncomingDataset(DcmDataset* dataset)
+{
+  if (!this->Throttle)
+    {
+    return;
+    }
+  this->Throttle->throttleTransfer(dataset->getLength(dataset->getOriginalXfer()));
+  if (!this->Batch)
+    {
+    // otherwise reported by the thread inserting the datasets
+    qint64 bytesPerSecond, maximumBytesPerSecond;
+    this->Throttle->transferRate(bytesPerSecond, maximumBytesPerSecond);
+    emit this->retrieve->transferRate(bytesPerSecond, maximumBytesPerSecond);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Sends a single C-GET request with the main SCU, see
+/// ctkDICOMRetrievePrivate::sendCGETRequestWriteBehind()
+class ctkDICOMRetrieveGetTask : public QRunnable
+{
+public:
+  ctkDICOMRetrieveGetTask(ctkDICOMRetrievePrivate* retrieve,
+                          T_ASC_PresentationContextID presID,
+                          DcmDataset* retrieveParameters,
+                          OFList<RetrieveResponse*>* responses,
+                          OFCondition* status)
+    : Retrieve(retrieve)
+    , PresID(presID)
+    , RetrieveParameters(retrieveParameters)
+    , Responses(responses)
+    , Status(status)
+  {
+  }
+
+  virtual void run();
+
+protected:
+  ctkDICOMRetrievePrivate* Retrieve;
+  T_ASC_PresentationContextID PresID;
+  DcmDataset* RetrieveParameters;
+  OFList<RetrieveResponse*>* Responses;
+  OFCondition* Status;
+};
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveGetTask::run()
+{
+  *this->Status = this->Retrieve->SCU.sendCGETRequest (
+                    this->PresID, this->RetrieveParameters, this->Responses );
+  this->Retrieve->batchTaskDone();
+}
+
+//------------------------------------------------------------------------------
+/// C-GETs series of a retrieveSeriesBatch() on its own association.
+class ctkDICOMRetrieveBatchTask : public QRunnable
+{
+public:
+  ctkDICOMRetrieveBatchTask(ctkDICOMRetrievePrivate* retrieve, bool firstTask)
+    : Retrieve(retrieve)
+    , FirstTask(firstTask)
+  {
+  }
+
+  virtual void run();
+
+protected:
+  /// Returns false on transient failures (association or network errors),
+  /// worth retrying. success is set to the outcome of the C-GET otherwise.
+  bool getSeries(ctkDICOMRetrieveSCUPrivate& scu, int seriesIndex, bool& success);
+
+  ctkDICOMRetrievePrivate* Retrieve;
+  /// The first task of a batch ignores the per-peer association cap
+  bool FirstTask;
+};
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieveBatchTask::run()
+{
+  const ctkDICOMRetrieveSCUPrivate& mainSCU = this->Retrieve->SCU;
+  QString peer = QString("%1:%2").arg(mainSCU.getPeerHostName().c_str()).arg(mainSCU.getPeerPort());
+  if (!acquirePeerAssociation(peer, this->Retrieve->BatchMaximumAssociations, this->FirstTask))
+    {
+    this->Retrieve->batchTaskDone();
+    return;
+    }
+
+  ctkDICOMRetrieveSCUPrivate scu;
+  scu.retrieve = mainSCU.retrieve;
+  scu.Batch = this->Retrieve;
+  scu.Throttle = this->Retrieve;
+  scu.setAETitle( mainSCU.getAETitle() );
+  scu.setPeerAETitle( mainSCU.getPeerAETitle() );
+  scu.setPeerHostName( mainSCU.getPeerHostName() );
+  scu.setPeerPort( mainSCU.getPeerPort() );
+  addRetrievePresentationContexts(scu);
+  bool networkInitialized = scu.initNetwork().good();
+
+  int seriesIndex;
+  while (networkInitialized && this->Retrieve->takeNextBatchSeries(seriesIndex))
+    {
+    bool success = false;
+    for (int attempt = 0; ; ++attempt)
+      {
+      if (this->getSeries(scu, seriesIndex, success))
+        {
+        break;
+        }
+      if (scu.isConnected())
+        {
+        scu.closeAssociation(DCMSCU_ABORT_ASSOCIATION);
+        }
+      if (attempt >= this->Retrieve->MaximumRetries
+          || !this->Retrieve->waitBeforeRetry(500 * (1 << attempt)))
+        {
+        break;
+        }
+      logger.debug ( "Retrying GET of series " + this->Retrieve->BatchSeriesInstanceUIDs[seriesIndex] );
+      }
+    this->Retrieve->addBatchSeriesResult(seriesIndex, success);
+    }
+
+  if (scu.isConnected())
+    {
+    scu.closeAssociation(DCMSCU_RELEASE_ASSOCIATION);
+    }
+  releasePeerAssociation(peer);
+  this->Retrieve->batchTaskDone();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieveBatchTask::getSeries(ctkDICOMRetrieveSCUPrivate& scu,
+                                          int seriesIndex, bool& success)
+{
+  success = false;
+  if (!scu.isConnected() && !scu.negotiateAssociation().good())
+    {
+    logger.error ( "Error negotiating association" );
+    return false;
+    }
+  T_ASC_PresentationContextID presID = scu.findPresentationContextID(
+                                          UID_GETStudyRootQueryRetrieveInformationModel,
+                                          "" /* don't care about transfer syntax */ );
+  if (presID == 0)
+    {
+    logger.error ( "GET Request failed: No valid Study Root GET Presentation Context available" );
+    return true;
+    }
+
+  const QString& seriesInstanceUID = this->Retrieve->BatchSeriesInstanceUIDs[seriesIndex];
+  DcmDataset retrieveParameters;
+  retrieveParameters.putAndInsertString ( DCM_QueryRetrieveLevel, "SERIES" );
+  retrieveParameters.putAndInsertString ( DCM_SeriesInstanceUID,
+                                          seriesInstanceUID.toStdString().c_str() );
+  retrieveParameters.putAndInsertString ( DCM_StudyInstanceUID,
+                                          this->Retrieve->BatchStudyInstanceUID.toStdString().c_str() );
+
+  OFList<RetrieveResponse*> responses;
+  OFCondition status = scu.sendCGETRequest ( presID, &retrieveParameters, &responses );
+  // Select the last GET response to output meaningful status information
+  RetrieveResponse* lastResponse = 0;
+  for ( OFIterator<RetrieveResponse*> it = responses.begin(); it != responses.end(); it++ )
+    {
+    lastResponse = *it;
+    }
+  if (lastResponse)
+    {
+    logger.debug ( "GET responses report for series: " + seriesInstanceUID + "\n"
+      + QString::number(static_cast<unsigned int>(lastResponse->m_numberOfCompletedSubops))
+          + " images transferred, and\n"
+      + QString::number(static_cast<unsigned int>(lastResponse->m_numberOfWarningSubops))
+          + " images transferred with warning, and\n"
+      + QString::number(static_cast<unsigned int>(lastResponse->m_numberOfFailedSubops))
+          + " images transfers failed");
+    success = status.good()
+      && (lastResponse->m_status == STATUS_Success
+          || lastResponse->m_status == STATUS_GET_Warning_SubOperationsCompleteOneOrMoreFailures);
+    }
+  for ( OFIterator<RetrieveResponse*> it = responses.begin(); it != responses.end(); it++ )
+    {
+    delete *it;
+    }
+  // a request that failed without any response is a network failure
+  return status.good() || lastResponse != 0;
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMRetrievePrivate methods
 
@@ -174,6 +530,18 @@ ctkDICOMRetrievePrivate::ctkDICOMRetrievePrivate(ctkDICOMRetrieve& obj)
   this->KeepAssociationOpen = true;
   this->ConnectionParamsChanged = false;
   this->LastRetrieveType = RetrieveNone;
+  this->MaximumAssociations = 4;
+  this->MaximumRetries = 2;
+  this->MaximumQueuedDatasets = 32;
+  this->BatchRunningTasks = 0;
+  this->BatchCompletedSeries = 0;
+  this->BatchFailedSeries = 0;
+  this->MaximumBytesPerSecond = 0;
+  this->TransferredBytes = 0;
+  this->TransferDeadline = 0;
+  this->TransferMaximumBytesPerSecond = 0;
+  this->BatchMaximumAssociations = this->MaximumAssociations;
+  this->SCU.Throttle = this;
 
   // Register the JPEG libraries in case we need them
   // (registration only happens once, so it's okay to call repeatedly)
@@ -187,20 +555,7 @@ ctkDICOMRetrievePrivate::ctkDICOMRetrievePrivate(ctkDICOMRetrieve& obj)
   DcmRLEDecoderRegistration::registerCodecs();
 
   logger.info ( "Setting Transfer Syntaxes" );
-  OFList<OFString> transferSyntaxes;
-  transferSyntaxes.push_back ( UID_LittleEndianExplicitTransferSyntax );
-  transferSyntaxes.push_back ( UID_BigEndianExplicitTransferSyntax );
-  transferSyntaxes.push_back ( UID_LittleEndianImplicitTransferSyntax );
-  this->SCU.addPresentationContext ( 
-      UID_MOVEStudyRootQueryRetrieveInformationModel, transferSyntaxes );
-  this->SCU.addPresentationContext ( 
-      UID_GETStudyRootQueryRetrieveInformationModel, transferSyntaxes );
-
-  for (Uint16 i = 0; i < numberOfDcmLongSCUStorageSOPClassUIDs; i++)
-    {
-    this->SCU.addPresentationContext(dcmLongSCUStorageSOPClassUIDs[i], 
-        transferSyntaxes, ASC_SC_ROLE_SCP);
-    }
+  addRetrievePresentationContexts(this->SCU);
 }
 
 //------------------------------------------------------------------------------
@@ -411,8 +766,11 @@ bool ctkDICOMRetrievePrivate::get ( const QString& studyInstanceUID,
   emit q->progress("Found Presentation Context");
   emit q->progress(1);
 
+  this->startTransfer();
+
   // do the actual move request
-  OFCondition status = this->SCU.sendCGETRequest ( 
+  // (the incoming instances are inserted while the next ones are received)
+  OFCondition status = this->sendCGETRequestWriteBehind (
                           presID, retrieveParameters, &responses );
 
   emit q->progress("Sent Get Request");
@@ -499,6 +857,267 @@ bool ctkDICOMRetrievePrivate::get ( const QString& studyInstanceUID,
   return true;
 }
 
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrievePrivate::getSeriesBatch ( const QString& studyInstanceUID,
+                                               const QStringList& seriesInstanceUIDs )
+{
+  Q_Q(ctkDICOMRetrieve);
+  const int seriesCount = seriesInstanceUIDs.count();
+  {
+  QMutexLocker locker(&this->ThrottleMutex);
+  this->BatchMaximumAssociations = this->effectiveMaximumAssociations();
+  }
+  const int taskCount = qMax(1, qMin(this->BatchMaximumAssociations, seriesCount));
+
+  this->BatchStudyInstanceUID = studyInstanceUID;
+  this->BatchSeriesInstanceUIDs = seriesInstanceUIDs;
+  {
+  QMutexLocker locker(&this->BatchMutex);
+  this->BatchPendingSeries.clear();
+  for (int i = 0; i < seriesCount; ++i)
+    {
+    this->BatchPendingSeries.enqueue(i);
+    }
+  this->BatchRunningTasks = taskCount;
+  }
+
+  emit q->progress(QString("Retrieving %1 series").arg(seriesCount));
+  emit q->progress(0);
+
+  this->BatchCompletedSeries = 0;
+  this->BatchFailedSeries = 0;
+  this->startTransfer();
+  this->BatchPool.setMaxThreadCount(taskCount);
+  for (int i = 0; i < taskCount; ++i)
+    {
+    this->BatchPool.start(new ctkDICOMRetrieveBatchTask(this, i == 0));
+    }
+  this->writeIncomingDatasets();
+
+  emit q->progress(100);
+  return this->BatchCompletedSeries == seriesCount && this->BatchFailedSeries == 0;
+}
+
+//------------------------------------------------------------------------------
+OFCondition ctkDICOMRetrievePrivate::sendCGETRequestWriteBehind(
+  T_ASC_PresentationContextID presID, DcmDataset* retrieveParameters,
+  OFList<RetrieveResponse*>* responses)
+{
+  if (!this->Database)
+    {
+    return this->SCU.sendCGETRequest ( presID, retrieveParameters, responses );
+    }
+
+  // the SCU is not used by this thread until the task is done
+  OFCondition status;
+  {
+  QMutexLocker locker(&this->BatchMutex);
+  this->BatchRunningTasks = 1;
+  }
+  this->SCU.Batch = this;
+  this->BatchPool.start(new ctkDICOMRetrieveGetTask(
+    this, presID, retrieveParameters, responses, &status));
+  this->writeIncomingDatasets();
+  this->SCU.Batch = 0;
+  return status;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrievePrivate::writeIncomingDatasets()
+{
+  Q_Q(ctkDICOMRetrieve);
+  // the instances are inserted in a single bulk insert session, which
+  // commits them in batches
+  this->Database->beginBulkInsert();
+  for (;;)
+    {
+    QQueue<DcmDataset*> datasets;
+    QQueue<QPair<int, bool> > results;
+    int runningTasks;
+    {
+    QMutexLocker locker(&this->BatchMutex);
+    if (this->IncomingDatasets.isEmpty() && this->BatchResults.isEmpty()
+        && this->BatchRunningTasks > 0)
+      {
+      this->BatchChanged.wait(&this->BatchMutex, 100);
+      }
+    datasets = this->IncomingDatasets;
+    this->IncomingDatasets.clear();
+    results = this->BatchResults;
+    this->BatchResults.clear();
+    runningTasks = this->BatchRunningTasks;
+    this->IncomingDatasetsConsumed.wakeAll();
+    }
+
+    foreach(DcmDataset* dataset, datasets)
+      {
+      ctkDICOMItem item;
+      item.InitializeFromItem(dataset, true /* take ownership */);
+      this->Database->insert(item);
+      }
+    if (!datasets.isEmpty())
+      {
+      qint64 bytesPerSecond, maximumBytesPerSecond;
+      this->transferRate(bytesPerSecond, maximumBytesPerSecond);
+      emit q->transferRate(bytesPerSecond, maximumBytesPerSecond);
+      }
+    for (int i = 0; i < results.count(); ++i)
+      {
+      const QString& seriesInstanceUID = this->BatchSeriesInstanceUIDs[results[i].first];
+      ++this->BatchCompletedSeries;
+      if (!results[i].second)
+        {
+        ++this->BatchFailedSeries;
+        logger.error ( "GET of series " + seriesInstanceUID + " failed" );
+        }
+      emit q->seriesRetrieved(seriesInstanceUID, results[i].second);
+      emit q->progress(QString("Retrieved %1 of %2 series")
+        .arg(this->BatchCompletedSeries).arg(this->BatchSeriesInstanceUIDs.count()));
+      emit q->progress((100 * this->BatchCompletedSeries) / this->BatchSeriesInstanceUIDs.count());
+      }
+    if (runningTasks == 0 && datasets.isEmpty() && results.isEmpty())
+      {
+      break;
+      }
+    }
+  this->BatchPool.waitForDone();
+  this->Database->endBulkInsert();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrievePrivate::takeNextBatchSeries(int& seriesIndex)
+{
+  QMutexLocker locker(&this->BatchMutex);
+  if (this->WasCanceled || this->BatchPendingSeries.isEmpty())
+    {
+    return false;
+    }
+  seriesIndex = this->BatchPendingSeries.dequeue();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrievePrivate::addBatchSeriesResult(int seriesIndex, bool success)
+{
+  QMutexLocker locker(&this->BatchMutex);
+  this->BatchResults.enqueue(qMakePair(seriesIndex, success));
+  this->BatchChanged.wakeAll();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrievePrivate::batchTaskDone()
+{
+  QMutexLocker locker(&this->BatchMutex);
+  --this->BatchRunningTasks;
+  this->BatchChanged.wakeAll();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrievePrivate::addIncomingDataset(DcmDataset* dataset)
+{
+  // back-pressure, bounds the memory used when the network is faster
+  // than the database
+  QMutexLocker locker(&this->BatchMutex);
+  while (this->IncomingDatasets.count() >= this->MaximumQueuedDatasets && !this->WasCanceled)
+    {
+    this->IncomingDatasetsConsumed.wait(&this->BatchMutex);
+    }
+  this->IncomingDatasets.enqueue(dataset);
+  this->BatchChanged.wakeAll();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrievePrivate::waitBeforeRetry(int msec)
+{
+  QMutexLocker locker(&this->BatchMutex);
+  if (!this->WasCanceled)
+    {
+    this->BatchCanceled.wait(&this->BatchMutex, msec);
+    }
+  return !this->WasCanceled;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrievePrivate::startTransfer()
+{
+  QMutexLocker locker(&this->ThrottleMutex);
+  this->TransferTimer.start();
+  this->TransferredBytes = 0;
+  this->TransferDeadline = 0;
+  this->TransferMaximumBytesPerSecond = this->effectiveMaximumBytesPerSecond();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrievePrivate::throttleTransfer(qint64 bytes)
+{
+  qint64 wait = 0;
+  {
+  QMutexLocker locker(&this->ThrottleMutex);
+  const qint64 now = this->TransferTimer.elapsed();
+  this->TransferredBytes += bytes;
+  // the profiles are checked for each dataset, long transfers follow them
+  this->TransferMaximumBytesPerSecond = this->effectiveMaximumBytesPerSecond();
+  if (this->TransferMaximumBytesPerSecond > 0)
+    {
+    // at most one second of idle time is saved up for bursts
+    this->TransferDeadline = qMax(this->TransferDeadline, now - 1000)
+      + (1000 * bytes) / this->TransferMaximumBytesPerSecond;
+    wait = this->TransferDeadline - now;
+    }
+  else
+    {
+    this->TransferDeadline = now;
+    }
+  }
+  if (wait > 0)
+    {
+    // stops reading from the association, which slows down the peer
+    this->waitBeforeRetry(static_cast<int>(wait));
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrievePrivate::transferRate(qint64& bytesPerSecond, qint64& maximumBytesPerSecond)
+{
+  QMutexLocker locker(&this->ThrottleMutex);
+  bytesPerSecond = (1000 * this->TransferredBytes) / qMax(qint64(1), this->TransferTimer.elapsed());
+  maximumBytesPerSecond = this->TransferMaximumBytesPerSecond;
+}
+
+//------------------------------------------------------------------------------
+const ctkDICOMRetrievePrivate::ThrottleProfile* ctkDICOMRetrievePrivate::currentThrottleProfile()const
+{
+  const QTime now = QTime::currentTime();
+  for (int i = 0; i < this->ThrottleProfiles.count(); ++i)
+    {
+    const ThrottleProfile& profile = this->ThrottleProfiles.at(i);
+    bool inProfile = profile.StartTime < profile.EndTime ?
+      (now >= profile.StartTime && now < profile.EndTime) :
+      (now >= profile.StartTime || now < profile.EndTime);
+    if (inProfile)
+      {
+      return &profile;
+      }
+    }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMRetrievePrivate::effectiveMaximumBytesPerSecond()const
+{
+  const ThrottleProfile* profile = this->currentThrottleProfile();
+  return profile && profile->MaximumBytesPerSecond >= 0 ?
+    profile->MaximumBytesPerSecond : this->MaximumBytesPerSecond;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMRetrievePrivate::effectiveMaximumAssociations()const
+{
+  const ThrottleProfile* profile = this->currentThrottleProfile();
+  return profile && profile->MaximumAssociations > 0 ?
+    profile->MaximumAssociations : this->MaximumAssociations;
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMRetrieve methods
 
@@ -708,10 +1327,114 @@ bool ctkDICOMRetrieve::getSeries(const QString& studyInstanceUID,
   return d->get ( studyInstanceUID, seriesInstanceUID, ctkDICOMRetrievePrivate::RetrieveSeries );
 }
 
+//------------------------------------------------------------------------------
+bool ctkDICOMRetrieve::retrieveSeriesBatch(const QString& studyInstanceUID,
+                                           const QStringList& seriesInstanceUIDs)
+{
+  if (studyInstanceUID.isEmpty() || seriesInstanceUIDs.isEmpty())
+    {
+    logger.error("Cannot receive series: Either Study or Series Instance UIDs empty.");
+    return false;
+    }
+  Q_D(ctkDICOMRetrieve);
+  if (!d->Database)
+    {
+    logger.error("Cannot receive series: No database set.");
+    return false;
+    }
+  logger.info ( "Starting retrieveSeriesBatch" );
+  return d->getSeriesBatch ( studyInstanceUID, seriesInstanceUIDs );
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieve::setMaximumAssociations(int associationCount)
+{
+  Q_D(ctkDICOMRetrieve);
+  d->MaximumAssociations = qMax(1, associationCount);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMRetrieve::maximumAssociations()const
+{
+  Q_D(const ctkDICOMRetrieve);
+  return d->MaximumAssociations;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieve::setMaximumRetries(int retryCount)
+{
+  Q_D(ctkDICOMRetrieve);
+  d->MaximumRetries = qMax(0, retryCount);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMRetrieve::maximumRetries()const
+{
+  Q_D(const ctkDICOMRetrieve);
+  return d->MaximumRetries;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieve::setMaximumBytesPerSecond(qint64 bytesPerSecond)
+{
+  Q_D(ctkDICOMRetrieve);
+  QMutexLocker locker(&d->ThrottleMutex);
+  d->MaximumBytesPerSecond = qMax(qint64(0), bytesPerSecond);
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMRetrieve::maximumBytesPerSecond()const
+{
+  Q_D(const ctkDICOMRetrieve);
+  QMutexLocker locker(&d->ThrottleMutex);
+  return d->MaximumBytesPerSecond;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieve::addThrottleProfile(const QTime& startTime, const QTime& endTime,
+                                          qint64 maximumBytesPerSecond, int maximumAssociations)
+{
+  Q_D(ctkDICOMRetrieve);
+  ctkDICOMRetrievePrivate::ThrottleProfile profile;
+  profile.StartTime = startTime;
+  profile.EndTime = endTime;
+  profile.MaximumBytesPerSecond = maximumBytesPerSecond;
+  profile.MaximumAssociations = maximumAssociations;
+  QMutexLocker locker(&d->ThrottleMutex);
+  d->ThrottleProfiles.append(profile);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieve::removeAllThrottleProfiles()
+{
+  Q_D(ctkDICOMRetrieve);
+  QMutexLocker locker(&d->ThrottleMutex);
+  d->ThrottleProfiles.clear();
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMRetrieve::effectiveMaximumBytesPerSecond()const
+{
+  Q_D(const ctkDICOMRetrieve);
+  QMutexLocker locker(&d->ThrottleMutex);
+  return d->effectiveMaximumBytesPerSecond();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMRetrieve::effectiveMaximumAssociations()const
+{
+  Q_D(const ctkDICOMRetrieve);
+  QMutexLocker locker(&d->ThrottleMutex);
+  return d->effectiveMaximumAssociations();
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMRetrieve::cancel()
 {
   Q_D(ctkDICOMRetrieve);
+  QMutexLocker locker(&d->BatchMutex);
   d->WasCanceled = true;
+  d->BatchCanceled.wakeAll();
+  d->IncomingDatasetsConsumed.wakeAll();
 }
 
@@ -26,6 +26,8 @@
 #include <QObject>
 #include <QDir>
 #include <QSharedPointer>
+#include <QStringList>
+#include <QTime>
 
 #include "ctkDICOMCoreExport.h"
 
@@ -45,6 +47,9 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMRetrieve : public QObject
   Q_PROPERTY(QString moveDestinationAETitle READ moveDestinationAETitle WRITE setMoveDestinationAETitle);
   Q_PROPERTY(bool keepAssociationOpen READ keepAssociationOpen WRITE setKeepAssociationOpen);
   Q_PROPERTY(bool wasCanceled READ wasCanceled WRITE setWasCanceled);
+  Q_PROPERTY(int maximumAssociations READ maximumAssociations WRITE setMaximumAssociations);
+  Q_PROPERTY(int maximumRetries READ maximumRetries WRITE setMaximumRetries);
+  Q_PROPERTY(qint64 maximumBytesPerSecond READ maximumBytesPerSecond WRITE setMaximumBytesPerSecond);
 
 public:
   explicit ctkDICOMRetrieve(QObject* parent = 0);
@@ -78,6 +83,39 @@ public:
   /// (default false)
   Q_INVOKABLE void setWasCanceled(const bool wasCanceled);
   Q_INVOKABLE bool wasCanceled();
+  /// Maximum number of associations opened to the peer host by
+  /// retrieveSeriesBatch(). The limit applies to all the ctkDICOMRetrieve
+  /// objects retrieving from the same host and port, except that each
+  /// batch always uses at least one association.
+  /// (default 4)
+  Q_INVOKABLE void setMaximumAssociations(int associationCount);
+  Q_INVOKABLE int maximumAssociations()const;
+  /// Number of times retrieveSeriesBatch() retries the C-GET of a series
+  /// after an association or network failure. Failures reported by the
+  /// peer are not retried.
+  /// (default 2)
+  Q_INVOKABLE void setMaximumRetries(int retryCount);
+  Q_INVOKABLE int maximumRetries()const;
+  /// Maximum rate at which the instances are received by C-GET, in bytes
+  /// per second, shared by all the associations of a retrieveSeriesBatch().
+  /// The handling of the incoming instances is delayed to keep the average
+  /// rate under the cap, which slows down the peer through the network.
+  /// It does not apply to C-MOVE, the instances are then sent to the move
+  /// destination. 0 for no limit.
+  /// (default 0)
+  Q_INVOKABLE void setMaximumBytesPerSecond(qint64 bytesPerSecond);
+  Q_INVOKABLE qint64 maximumBytesPerSecond()const;
+  /// Add a time of day profile: from startTime to endTime (wrapping
+  /// around midnight if endTime is not after startTime), the given caps
+  /// replace maximumBytesPerSecond() and maximumAssociations(). A negative
+  /// maximumBytesPerSecond or a maximumAssociations of 0 keeps the default
+  /// cap. The first profile containing the current time is used.
+  Q_INVOKABLE void addThrottleProfile(const QTime& startTime, const QTime& endTime,
+                                      qint64 maximumBytesPerSecond, int maximumAssociations = 0);
+  Q_INVOKABLE void removeAllThrottleProfiles();
+  /// Caps in effect at the current time of day, see addThrottleProfile()
+  Q_INVOKABLE qint64 effectiveMaximumBytesPerSecond()const;
+  Q_INVOKABLE int effectiveMaximumAssociations()const;
   /// where to insert new data sets obtained via get (must be set for
   /// get to succee
   Q_INVOKABLE void setDatabase(ctkDICOMDatabase& dicomDatabase);
@@ -90,11 +128,21 @@ public Q_SLOTS:
                        const QString& seriesInstanceUID );
   /// Use CMOVE to ask peer host to store data to move destination
   Q_INVOKABLE bool moveStudy( const QString& studyInstanceUID );
-  /// Use CGET to ask peer host to store data to us
+  /// Use CGET to ask peer host to store data to us.
+  /// The C-GET session runs on a worker thread and the received instances
+  /// are inserted into the database by the calling thread while the next
+  /// ones are being received.
   Q_INVOKABLE bool getSeries( const QString& studyInstanceUID,
                        const QString& seriesInstanceUID );
   /// Use CGET to ask peer host to store data to us
   Q_INVOKABLE bool getStudy( const QString& studyInstanceUID );
+  /// Use CGET to retrieve several series of a study in parallel, on up to
+  /// maximumAssociations() associations. The received datasets are inserted
+  /// into the database from the calling thread. progress(int) reports the
+  /// fraction of series retrieved and cancel() stops all the associations.
+  /// Returns true if all the series were retrieved.
+  Q_INVOKABLE bool retrieveSeriesBatch( const QString& studyInstanceUID,
+                       const QStringList& seriesInstanceUIDs );
   /// Cancel the current operation
   Q_INVOKABLE void cancel();
 
@@ -110,6 +158,13 @@ Q_SIGNALS:
   void debug(const QString& message);
   /// Signal is emitted inside the retrieve() function. It send any error messages
   void error(const QString& message);
+  /// Emitted by retrieveSeriesBatch() when the C-GET of a series is done
+  void seriesRetrieved(const QString& seriesInstanceUID, bool success);
+  /// Emitted by the C-GET retrieves as instances are received:
+  /// bytesPerSecond is the average rate achieved since the retrieve
+  /// started and maximumBytesPerSecond the cap it is throttled to (0 if
+  /// not throttled)
+  void transferRate(qint64 bytesPerSecond, qint64 maximumBytesPerSecond);
   /// Signal is emitted inside the retrieve() function when finished with value 
   /// true for success or false for error
   void done(const bool& error);
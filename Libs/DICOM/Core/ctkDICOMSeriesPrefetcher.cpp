@@ -0,0 +1,526 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QStringList>
+#include <QThreadPool>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMSeriesPrefetcher.h"
+#include "ctkLogger.h"
+
+#ifdef Q_OS_LINUX
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------
+static ctkLogger logger("org.commontk.dicom.DICOMSeriesPrefetcher" );
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+/// Load at most maxBytes of filePath into the page cache and return the
+/// number of bytes loaded.
+static qint64 ctkDICOMPrefetchFile(const QString& filePath, qint64 maxBytes)
+{
+#ifdef Q_OS_LINUX
+  int fd = ::open(QFile::encodeName(filePath).constData(), O_RDONLY);
+  if (fd < 0)
+    {
+    return 0;
+    }
+  qint64 length = 0;
+  struct stat fileStat;
+  if (::fstat(fd, &fileStat) == 0)
+    {
+    length = qMin(static_cast<qint64>(fileStat.st_size), maxBytes);
+    // the pages are read asynchronously by the kernel
+    ::posix_fadvise(fd, 0, length, POSIX_FADV_WILLNEED);
+    }
+  ::close(fd);
+  return length;
+#else
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return 0;
+    }
+  char buffer[65536];
+  qint64 length = 0;
+  while (length < maxBytes)
+    {
+    qint64 read = file.read(buffer, qMin(maxBytes - length, static_cast<qint64>(sizeof(buffer))));
+    if (read <= 0)
+      {
+      break;
+      }
+    length += read;
+    }
+  return length;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/// Let the system reclaim the pages of filePath.
+static void ctkDICOMReleaseFile(const QString& filePath)
+{
+#ifdef Q_OS_LINUX
+  int fd = ::open(QFile::encodeName(filePath).constData(), O_RDONLY);
+  if (fd >= 0)
+    {
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+    }
+#else
+  Q_UNUSED(filePath);
+#endif
+}
+
+//------------------------------------------------------------------------------
+struct ctkDICOMPrefetchedSeries
+{
+  enum State
+  {
+    Queued,
+    Loading,
+    Loaded
+  };
+  ctkDICOMPrefetchedSeries()
+    : SeriesState(Queued)
+    , Hint(ctkDICOMSeriesPrefetcher::HoverHint)
+    , Bytes(0)
+  {
+  }
+  State SeriesState;
+  int Hint;
+  qint64 Bytes;
+  QStringList Files;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMSeriesPrefetcherPrivate
+{
+  Q_DECLARE_PUBLIC(ctkDICOMSeriesPrefetcher);
+
+protected:
+  ctkDICOMSeriesPrefetcher* const q_ptr;
+
+public:
+  ctkDICOMSeriesPrefetcherPrivate(ctkDICOMSeriesPrefetcher&);
+
+  /// Called from the pool threads.
+  void load(const QString& seriesUID, int generation);
+
+  ctkDICOMDatabase* Database;
+  QThreadPool Pool;
+
+  /// Protects the members below.
+  mutable QMutex Mutex;
+  qint64 SeriesBudget;
+  qint64 TotalBudget;
+  QHash<QString, ctkDICOMPrefetchedSeries> Series;
+  /// Loaded series, the least recently used first.
+  QStringList LoadedSeries;
+  qint64 PrefetchedBytes;
+  int Hits;
+  int Misses;
+  /// Incremented by cancel(), tasks queued before are discarded.
+  int Generation;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMSeriesPrefetchTask : public QRunnable
+{
+public:
+  ctkDICOMSeriesPrefetchTask(ctkDICOMSeriesPrefetcherPrivate* prefetcher,
+                             const QString& seriesUID, int generation)
+    : Prefetcher(prefetcher)
+    , SeriesUID(seriesUID)
+    , Generation(generation)
+  {
+  }
+
+  virtual void run()
+  {
+    this->Prefetcher->load(this->SeriesUID, this->Generation);
+  }
+
+private:
+  ctkDICOMSeriesPrefetcherPrivate* Prefetcher;
+  QString SeriesUID;
+  int Generation;
+};
+
+//------------------------------------------------------------------------------
+// ctkDICOMSeriesPrefetcherPrivate methods
+
+//------------------------------------------------------------------------------
+ctkDICOMSeriesPrefetcherPrivate::ctkDICOMSeriesPrefetcherPrivate(ctkDICOMSeriesPrefetcher& o)
+  : q_ptr(&o)
+  , Database(0)
+  , SeriesBudget(Q_INT64_C(256) * 1024 * 1024)
+  , TotalBudget(Q_INT64_C(1024) * 1024 * 1024)
+  , PrefetchedBytes(0)
+  , Hits(0)
+  , Misses(0)
+  , Generation(0)
+{
+  this->Pool.setMaxThreadCount(2);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSeriesPrefetcherPrivate::load(const QString& seriesUID, int generation)
+{
+  Q_Q(ctkDICOMSeriesPrefetcher);
+  QStringList files;
+  qint64 budget;
+  {
+  QMutexLocker locker(&this->Mutex);
+  QHash<QString, ctkDICOMPrefetchedSeries>::iterator series = this->Series.find(seriesUID);
+  // the same series can be queued several times with increasing hints,
+  // only the first task to run loads it
+  if (generation != this->Generation || series == this->Series.end() ||
+      series->SeriesState != ctkDICOMPrefetchedSeries::Queued)
+    {
+    return;
+    }
+  series->SeriesState = ctkDICOMPrefetchedSeries::Loading;
+  files = series->Files;
+  budget = this->SeriesBudget;
+  }
+
+  qint64 bytes = 0;
+  bool canceled = false;
+  foreach(const QString& file, files)
+    {
+    if (bytes >= budget)
+      {
+      break;
+      }
+    {
+    QMutexLocker locker(&this->Mutex);
+    canceled = (generation != this->Generation);
+    }
+    if (canceled)
+      {
+      break;
+      }
+    bytes += ctkDICOMPrefetchFile(file, budget - bytes);
+    }
+
+  QStringList releasedFiles;
+  {
+  QMutexLocker locker(&this->Mutex);
+  QHash<QString, ctkDICOMPrefetchedSeries>::iterator series = this->Series.find(seriesUID);
+  if (series == this->Series.end() ||
+      series->SeriesState != ctkDICOMPrefetchedSeries::Loading)
+    {
+    // forgotten by clear()
+    return;
+    }
+  if (canceled)
+    {
+    this->Series.erase(series);
+    return;
+    }
+  series->SeriesState = ctkDICOMPrefetchedSeries::Loaded;
+  series->Bytes = bytes;
+  this->LoadedSeries << seriesUID;
+  this->PrefetchedBytes += bytes;
+  // keep at least the series just loaded
+  while (this->PrefetchedBytes > this->TotalBudget && this->LoadedSeries.count() > 1)
+    {
+    ctkDICOMPrefetchedSeries evicted = this->Series.take(this->LoadedSeries.takeFirst());
+    this->PrefetchedBytes -= evicted.Bytes;
+    releasedFiles << evicted.Files;
+    }
+  }
+
+  foreach(const QString& file, releasedFiles)
+    {
+    ctkDICOMReleaseFile(file);
+    }
+  logger.debug(QString("Prefetched %1 bytes of series ").arg(bytes) + seriesUID);
+  emit q->seriesPrefetched(seriesUID, bytes);
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMSeriesPrefetcher methods
+
+//------------------------------------------------------------------------------
+ctkDICOMSeriesPrefetcher::ctkDICOMSeriesPrefetcher(QObject* parentObject)
+  : QObject(parentObject)
+  , d_ptr(new ctkDICOMSeriesPrefetcherPrivate(*this))
+{
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMSeriesPrefetcher::~ctkDICOMSeriesPrefetcher()
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  this->cancel();
+  d->Pool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSeriesPrefetcher::setDatabase(ctkDICOMDatabase* database)
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  if (d->Database == database)
+    {
+    return;
+    }
+  this->clear();
+  d->Database = database;
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMDatabase* ctkDICOMSeriesPrefetcher::database()const
+{
+  Q_D(const ctkDICOMSeriesPrefetcher);
+  return d->Database;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSeriesPrefetcher::setSeriesBudget(qint64 bytes)
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  d->SeriesBudget = qMax(Q_INT64_C(0), bytes);
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMSeriesPrefetcher::seriesBudget()const
+{
+  Q_D(const ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  return d->SeriesBudget;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSeriesPrefetcher::setTotalBudget(qint64 bytes)
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  d->TotalBudget = qMax(Q_INT64_C(0), bytes);
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMSeriesPrefetcher::totalBudget()const
+{
+  Q_D(const ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  return d->TotalBudget;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSeriesPrefetcher::setMaximumThreadCount(int threadCount)
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  d->Pool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMSeriesPrefetcher::maximumThreadCount()const
+{
+  Q_D(const ctkDICOMSeriesPrefetcher);
+  return d->Pool.maxThreadCount();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMSeriesPrefetcher::prefetchSeries(const QString& seriesUID, int hint)
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  if (!d->Database || !d->Database->isOpen() || seriesUID.isEmpty())
+    {
+    return false;
+    }
+  int generation;
+  {
+  QMutexLocker locker(&d->Mutex);
+  QHash<QString, ctkDICOMPrefetchedSeries>::iterator series = d->Series.find(seriesUID);
+  if (series != d->Series.end())
+    {
+    if (series->SeriesState != ctkDICOMPrefetchedSeries::Queued || series->Hint >= hint)
+      {
+      return false;
+      }
+    // queue it again with the higher hint, the task queued first will
+    // find it is not queued anymore
+    series->Hint = hint;
+    generation = d->Generation;
+    }
+  else
+    {
+    generation = -1;
+    }
+  }
+
+  if (generation < 0)
+    {
+    QStringList files = d->Database->filesForSeries(seriesUID);
+    if (files.isEmpty())
+      {
+      return false;
+      }
+    QMutexLocker locker(&d->Mutex);
+    if (d->Series.contains(seriesUID))
+      {
+      return false;
+      }
+    if (hint == HoverHint)
+      {
+      // only the last hovered series is worth loading
+      QHash<QString, ctkDICOMPrefetchedSeries>::iterator it = d->Series.begin();
+      while (it != d->Series.end())
+        {
+        if (it->Hint == HoverHint && it->SeriesState == ctkDICOMPrefetchedSeries::Queued)
+          {
+          it = d->Series.erase(it);
+          }
+        else
+          {
+          ++it;
+          }
+        }
+      }
+    ctkDICOMPrefetchedSeries series;
+    series.Hint = hint;
+    series.Files = files;
+    d->Series.insert(seriesUID, series);
+    generation = d->Generation;
+    }
+  d->Pool.start(new ctkDICOMSeriesPrefetchTask(d, seriesUID, generation), hint);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMSeriesPrefetcher::isSeriesPrefetched(const QString& seriesUID)const
+{
+  Q_D(const ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  QHash<QString, ctkDICOMPrefetchedSeries>::const_iterator series = d->Series.find(seriesUID);
+  return series != d->Series.end() &&
+    series->SeriesState == ctkDICOMPrefetchedSeries::Loaded;
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMSeriesPrefetcher::prefetchedBytes()const
+{
+  Q_D(const ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  return d->PrefetchedBytes;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMSeriesPrefetcher::seriesOpened(const QString& seriesUID)
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  int index = d->LoadedSeries.indexOf(seriesUID);
+  if (index < 0)
+    {
+    ++d->Misses;
+    return false;
+    }
+  ++d->Hits;
+  // most recently used, evicted last
+  d->LoadedSeries.move(index, d->LoadedSeries.count() - 1);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMSeriesPrefetcher::hits()const
+{
+  Q_D(const ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  return d->Hits;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMSeriesPrefetcher::misses()const
+{
+  Q_D(const ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  return d->Misses;
+}
+
+//------------------------------------------------------------------------------
+double ctkDICOMSeriesPrefetcher::hitRate()const
+{
+  Q_D(const ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  int opened = d->Hits + d->Misses;
+  return opened ? static_cast<double>(d->Hits) / opened : 0.;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSeriesPrefetcher::resetStatistics()
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  d->Hits = 0;
+  d->Misses = 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSeriesPrefetcher::waitForDone()
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  d->Pool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSeriesPrefetcher::cancel()
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  ++d->Generation;
+  QHash<QString, ctkDICOMPrefetchedSeries>::iterator it = d->Series.begin();
+  while (it != d->Series.end())
+    {
+    if (it->SeriesState == ctkDICOMPrefetchedSeries::Queued)
+      {
+      it = d->Series.erase(it);
+      }
+    else
+      {
+      ++it;
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSeriesPrefetcher::clear()
+{
+  Q_D(ctkDICOMSeriesPrefetcher);
+  QMutexLocker locker(&d->Mutex);
+  ++d->Generation;
+  d->Series.clear();
+  d->LoadedSeries.clear();
+  d->PrefetchedBytes = 0;
+}
@@ -0,0 +1,127 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMSeriesPrefetcher_h
+#define __ctkDICOMSeriesPrefetcher_h
+
+// Qt includes
+#include <QObject>
+
+#include "ctkDICOMCoreExport.h"
+
+class ctkDICOMDatabase;
+class ctkDICOMSeriesPrefetcherPrivate;
+
+/// \ingroup DICOM_Core
+///
+/// \brief Reads the files of series into the page cache before they are opened.
+///
+/// Browsers give hints about the series the user is likely to open next:
+/// the selected series and the one under the mouse cursor. The files of
+/// these series are loaded on a pool of threads, so that opening them
+/// later doesn't wait for the disk. On Linux the kernel is asked to read
+/// the files ahead (posix_fadvise()), on the other platforms the files are
+/// read and their content discarded.
+///
+/// At most seriesBudget() bytes are loaded per series and the series
+/// loaded last are kept within totalBudget(): older series are forgotten,
+/// and on Linux their pages are released. Call seriesOpened() when a series
+/// is opened to keep track of the hit rate of the hints.
+///
+class CTK_DICOM_CORE_EXPORT ctkDICOMSeriesPrefetcher : public QObject
+{
+  Q_OBJECT
+  Q_PROPERTY(qint64 seriesBudget READ seriesBudget WRITE setSeriesBudget)
+  Q_PROPERTY(qint64 totalBudget READ totalBudget WRITE setTotalBudget)
+  Q_PROPERTY(int maximumThreadCount READ maximumThreadCount WRITE setMaximumThreadCount)
+public:
+  enum Hint
+  {
+    /// The series is under the mouse cursor. Only the last hovered series
+    /// is prefetched, the previous one is dropped if not started yet.
+    HoverHint = 0,
+    /// The series is selected.
+    SelectionHint = 1
+  };
+
+  explicit ctkDICOMSeriesPrefetcher(QObject* parent = 0);
+  virtual ~ctkDICOMSeriesPrefetcher();
+
+  /// Database the files of the series are looked up in.
+  void setDatabase(ctkDICOMDatabase* database);
+  ctkDICOMDatabase* database()const;
+
+  /// Maximum number of bytes loaded per series, 256 MB by default.
+  void setSeriesBudget(qint64 bytes);
+  qint64 seriesBudget()const;
+
+  /// Maximum number of bytes of the series kept prefetched, 1 GB by default.
+  void setTotalBudget(qint64 bytes);
+  qint64 totalBudget()const;
+
+  /// Number of series loaded at the same time, 2 by default.
+  void setMaximumThreadCount(int threadCount);
+  int maximumThreadCount()const;
+
+  /// Queue the loading of the files of seriesUID. Returns false if the
+  /// series is already prefetched or queued with the same or a higher hint,
+  /// or if it has no files.
+  bool prefetchSeries(const QString& seriesUID, int hint = SelectionHint);
+
+  /// Returns true if the files of seriesUID have been loaded.
+  bool isSeriesPrefetched(const QString& seriesUID)const;
+
+  /// Number of bytes of the prefetched series.
+  qint64 prefetchedBytes()const;
+
+  /// Record that seriesUID is being opened. Returns true, and counts a hit,
+  /// if the series has been prefetched, counts a miss otherwise.
+  bool seriesOpened(const QString& seriesUID);
+
+  /// Statistics of seriesOpened() since the last resetStatistics().
+  int hits()const;
+  int misses()const;
+  /// Ratio of hits in the opened series, 0. if none has been opened.
+  double hitRate()const;
+  void resetStatistics();
+
+  /// Wait for the queued series to be loaded.
+  void waitForDone();
+
+public Q_SLOTS:
+  /// Drop the series that are not being loaded yet.
+  void cancel();
+
+  /// Cancel and forget the prefetched series.
+  void clear();
+
+Q_SIGNALS:
+  /// Emitted from the thread that loaded the series.
+  void seriesPrefetched(const QString& seriesUID, qint64 bytes);
+
+protected:
+  QScopedPointer<ctkDICOMSeriesPrefetcherPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDICOMSeriesPrefetcher);
+  Q_DISABLE_COPY(ctkDICOMSeriesPrefetcher);
+};
+
+#endif
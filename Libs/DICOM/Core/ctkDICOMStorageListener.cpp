@@ -0,0 +1,613 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMIndexer.h"
+#include "ctkDICOMStorageListener.h"
+#include "ctkLogger.h"
+
+// DCMTK includes
+#include "dcmtk/dcmnet/assoc.h"
+#include "dcmtk/dcmnet/dimse.h"
+#include "dcmtk/dcmnet/diutil.h"
+#include <dcmtk/dcmdata/dcuid.h>
+
+// STD includes
+#include <cstdio>
+
+//------------------------------------------------------------------------------
+static ctkLogger logger("org.commontk.dicom.DICOMStorageListener" );
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+/// The objects are stored as they are received, any transfer syntax can
+/// be accepted.
+static const char* ctkDICOMStorageTransferSyntaxes[] =
+{
+  UID_LittleEndianExplicitTransferSyntax,
+  UID_BigEndianExplicitTransferSyntax,
+  UID_LittleEndianImplicitTransferSyntax,
+  UID_DeflatedExplicitVRLittleEndianTransferSyntax,
+  UID_JPEGProcess1TransferSyntax,
+  UID_JPEGProcess2_4TransferSyntax,
+  UID_JPEGProcess14SV1TransferSyntax,
+  UID_JPEGProcess14TransferSyntax,
+  UID_JPEGLSLosslessTransferSyntax,
+  UID_JPEGLSLossyTransferSyntax,
+  UID_JPEG2000LosslessOnlyTransferSyntax,
+  UID_JPEG2000TransferSyntax,
+  UID_RLELosslessTransferSyntax
+};
+static const int ctkDICOMStorageTransferSyntaxCount =
+  sizeof(ctkDICOMStorageTransferSyntaxes) / sizeof(const char*);
+
+/// Seconds to wait for an association request or a command before
+/// checking if the listener is stopping.
+static const int ctkDICOMStoragePollTimeout = 1;
+/// Seconds without data after which a transfer is aborted.
+static const int ctkDICOMStorageDataTimeout = 30;
+
+//------------------------------------------------------------------------------
+class ctkDICOMStorageListenerPrivate
+{
+  Q_DECLARE_PUBLIC(ctkDICOMStorageListener);
+
+protected:
+  ctkDICOMStorageListener* const q_ptr;
+
+public:
+  ctkDICOMStorageListenerPrivate(ctkDICOMStorageListener&);
+
+  /// Called from AcceptThread.
+  void acceptAssociations();
+  /// Called from the association pool threads.
+  void serveAssociation(T_ASC_Association* association);
+  OFCondition storeInstance(T_ASC_Association* association,
+                            T_ASC_PresentationContextID presentationContextID,
+                            T_DIMSE_C_StoreRQ& request, const QString& callingAETitle);
+  bool isStopping()const;
+
+  QString AETitle;
+  int Port;
+  int MaximumAssociations;
+  ctkDICOMDatabase* Database;
+  QString StorageDirectory;
+  /// Directory of the running listener.
+  QString ActiveStorageDirectory;
+
+  T_ASC_Network* Network;
+  QThread* AcceptThread;
+  QThreadPool AssociationPool;
+  QTimer* InsertTimer;
+  ctkDICOMIndexer* Indexer;
+
+  /// Protects the members below, shared with the network threads.
+  mutable QMutex Mutex;
+  bool Stopping;
+  int ActiveAssociations;
+  int ReceivedFiles;
+  int UnnamedFiles;
+  QStringList PendingFiles;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMStorageAcceptThread : public QThread
+{
+public:
+  ctkDICOMStorageAcceptThread(ctkDICOMStorageListenerPrivate* listener)
+    : Listener(listener)
+  {
+  }
+
+  virtual void run()
+  {
+    this->Listener->acceptAssociations();
+  }
+
+private:
+  ctkDICOMStorageListenerPrivate* Listener;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMStorageAssociationTask : public QRunnable
+{
+public:
+  ctkDICOMStorageAssociationTask(ctkDICOMStorageListenerPrivate* listener,
+                                 T_ASC_Association* association)
+    : Listener(listener)
+    , Association(association)
+  {
+  }
+
+  virtual void run()
+  {
+    this->Listener->serveAssociation(this->Association);
+  }
+
+private:
+  ctkDICOMStorageListenerPrivate* Listener;
+  T_ASC_Association* Association;
+};
+
+//------------------------------------------------------------------------------
+// ctkDICOMStorageListenerPrivate methods
+
+//------------------------------------------------------------------------------
+ctkDICOMStorageListenerPrivate::ctkDICOMStorageListenerPrivate(ctkDICOMStorageListener& o)
+  : q_ptr(&o)
+  , AETitle("CTKSTORESCP")
+  , Port(11112)
+  , MaximumAssociations(4)
+  , Database(0)
+  , Network(0)
+  , AcceptThread(0)
+  , InsertTimer(0)
+  , Indexer(0)
+  , Stopping(true)
+  , ActiveAssociations(0)
+  , ReceivedFiles(0)
+  , UnnamedFiles(0)
+{
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMStorageListenerPrivate::isStopping()const
+{
+  QMutexLocker locker(&this->Mutex);
+  return this->Stopping;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListenerPrivate::acceptAssociations()
+{
+  while (!this->isStopping())
+    {
+    T_ASC_Association* association = 0;
+    OFCondition status = ASC_receiveAssociation(this->Network, &association,
+      ASC_DEFAULTMAXPDU, NULL, NULL, OFFalse, DUL_NOBLOCK, ctkDICOMStoragePollTimeout);
+    if (status.good())
+      {
+      // served once a thread is available
+      this->AssociationPool.start(new ctkDICOMStorageAssociationTask(this, association));
+      continue;
+      }
+    if (status != DUL_NOASSOCIATIONREQUEST)
+      {
+      logger.warn(QString("Failed to receive association: ") + status.text());
+      }
+    if (association)
+      {
+      ASC_dropSCPAssociation(association);
+      ASC_destroyAssociation(&association);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListenerPrivate::serveAssociation(T_ASC_Association* association)
+{
+  const QString callingAETitle(association->params->DULparams.callingAPTitle);
+  if (this->isStopping())
+    {
+    T_ASC_RejectParameters rejection =
+      {
+      ASC_RESULT_REJECTEDTRANSIENT,
+      ASC_SOURCE_SERVICEPROVIDER_PRESENTATION_RELATED,
+      ASC_REASON_SP_PRES_TEMPORARYCONGESTION
+      };
+    ASC_rejectAssociation(association, &rejection);
+    ASC_dropSCPAssociation(association);
+    ASC_destroyAssociation(&association);
+    return;
+    }
+
+  {
+  QMutexLocker locker(&this->Mutex);
+  ++this->ActiveAssociations;
+  }
+
+  const char* verificationSyntaxes[] = { UID_VerificationSOPClass };
+  OFCondition status = ASC_acceptContextsWithPreferredTransferSyntaxes(
+    association->params, verificationSyntaxes, 1,
+    ctkDICOMStorageTransferSyntaxes, ctkDICOMStorageTransferSyntaxCount);
+  if (status.good())
+    {
+    status = ASC_acceptContextsWithPreferredTransferSyntaxes(
+      association->params, dcmAllStorageSOPClassUIDs, numberOfAllDcmStorageSOPClassUIDs,
+      ctkDICOMStorageTransferSyntaxes, ctkDICOMStorageTransferSyntaxCount);
+    }
+  if (status.good())
+    {
+    ASC_setAPTitles(association->params, NULL, NULL, this->AETitle.toLatin1().constData());
+    status = ASC_acknowledgeAssociation(association);
+    }
+  if (status.bad())
+    {
+    logger.warn("Failed to accept association from " + callingAETitle + ": " + status.text());
+    }
+  else
+    {
+    logger.debug("Association accepted from " + callingAETitle);
+    }
+
+  while (status.good())
+    {
+    T_DIMSE_Message message;
+    T_ASC_PresentationContextID presentationContextID = 0;
+    status = DIMSE_receiveCommand(association, DIMSE_NONBLOCKING, ctkDICOMStoragePollTimeout,
+                                  &presentationContextID, &message, NULL);
+    if (status == DIMSE_NODATAAVAILABLE)
+      {
+      if (this->isStopping())
+        {
+        ASC_abortAssociation(association);
+        break;
+        }
+      status = EC_Normal;
+      continue;
+      }
+    if (status == DUL_PEERREQUESTEDRELEASE)
+      {
+      ASC_acknowledgeRelease(association);
+      break;
+      }
+    if (status.bad())
+      {
+      // aborted by the peer or network error
+      break;
+      }
+
+    switch (message.CommandField)
+      {
+      case DIMSE_C_ECHO_RQ:
+        status = DIMSE_sendEchoResponse(association, presentationContextID,
+                                        &message.msg.CEchoRQ, STATUS_Success, NULL);
+        break;
+      case DIMSE_C_STORE_RQ:
+        status = this->storeInstance(association, presentationContextID,
+                                     message.msg.CStoreRQ, callingAETitle);
+        break;
+      default:
+        logger.warn(QString("Unsupported command 0x%1 from ")
+                    .arg(message.CommandField, 0, 16) + callingAETitle);
+        status = DIMSE_BADCOMMANDTYPE;
+        break;
+      }
+    if (status.bad())
+      {
+      ASC_abortAssociation(association);
+      }
+    }
+
+  ASC_dropSCPAssociation(association);
+  ASC_destroyAssociation(&association);
+
+  QMutexLocker locker(&this->Mutex);
+  --this->ActiveAssociations;
+}
+
+//------------------------------------------------------------------------------
+OFCondition ctkDICOMStorageListenerPrivate::storeInstance(
+  T_ASC_Association* association, T_ASC_PresentationContextID presentationContextID,
+  T_DIMSE_C_StoreRQ& request, const QString& callingAETitle)
+{
+  Q_Q(ctkDICOMStorageListener);
+  // the UID is only used as a file name if it can't escape the directory
+  QString fileName(request.AffectedSOPInstanceUID);
+  if (!QRegExp("[0-9.]+").exactMatch(fileName))
+    {
+    QMutexLocker locker(&this->Mutex);
+    fileName = QString("received-%1").arg(++this->UnnamedFiles);
+    }
+  const QString filePath = this->ActiveStorageDirectory + "/" + fileName;
+  const QString temporaryPath = filePath + ".part";
+
+  // the data set is written to the file as it is received, a NULL
+  // data set selects the bit preserving mode
+  OFCondition status = DIMSE_storeProvider(association, presentationContextID, &request,
+    QFile::encodeName(temporaryPath).data(), OFTrue /* use meta-header */, NULL,
+    NULL, NULL, DIMSE_NONBLOCKING, ctkDICOMStorageDataTimeout);
+  if (status.bad())
+    {
+    logger.warn("Failed to receive " + fileName + " from " + callingAETitle + ": " + status.text());
+    QFile::remove(temporaryPath);
+    return status;
+    }
+  // rename() replaces a file sent again atomically on POSIX systems
+  if (std::rename(QFile::encodeName(temporaryPath).constData(),
+                  QFile::encodeName(filePath).constData()) != 0)
+    {
+    QFile::remove(filePath);
+    if (!QFile::rename(temporaryPath, filePath))
+      {
+      logger.error("Failed to write " + filePath);
+      QFile::remove(temporaryPath);
+      // the response has been sent, the association can go on
+      return EC_Normal;
+      }
+    }
+
+  {
+  QMutexLocker locker(&this->Mutex);
+  ++this->ReceivedFiles;
+  if (!this->PendingFiles.contains(filePath))
+    {
+    this->PendingFiles << filePath;
+    }
+  }
+  emit q->fileReceived(filePath, callingAETitle);
+  return EC_Normal;
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMStorageListener methods
+
+//------------------------------------------------------------------------------
+ctkDICOMStorageListener::ctkDICOMStorageListener(QObject* parentObject)
+  : QObject(parentObject)
+  , d_ptr(new ctkDICOMStorageListenerPrivate(*this))
+{
+  Q_D(ctkDICOMStorageListener);
+  d->AcceptThread = new ctkDICOMStorageAcceptThread(d);
+  d->InsertTimer = new QTimer(this);
+  d->InsertTimer->setInterval(1000);
+  this->connect(d->InsertTimer, SIGNAL(timeout()), SLOT(insertReceivedFiles()));
+  d->Indexer = new ctkDICOMIndexer(this);
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMStorageListener::~ctkDICOMStorageListener()
+{
+  Q_D(ctkDICOMStorageListener);
+  this->stop();
+  delete d->AcceptThread;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListener::setAETitle(const QString& title)
+{
+  Q_D(ctkDICOMStorageListener);
+  if (this->isListening())
+    {
+    logger.warn("The AE title can't be changed while listening");
+    return;
+    }
+  d->AETitle = title;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMStorageListener::AETitle()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  return d->AETitle;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListener::setPort(int port)
+{
+  Q_D(ctkDICOMStorageListener);
+  if (this->isListening())
+    {
+    logger.warn("The port can't be changed while listening");
+    return;
+    }
+  d->Port = port;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMStorageListener::port()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  return d->Port;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListener::setMaximumAssociations(int count)
+{
+  Q_D(ctkDICOMStorageListener);
+  d->MaximumAssociations = qMax(1, count);
+  d->AssociationPool.setMaxThreadCount(d->MaximumAssociations);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMStorageListener::maximumAssociations()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  return d->MaximumAssociations;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListener::setInsertInterval(int msec)
+{
+  Q_D(ctkDICOMStorageListener);
+  d->InsertTimer->setInterval(qMax(0, msec));
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMStorageListener::insertInterval()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  return d->InsertTimer->interval();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListener::setDatabase(ctkDICOMDatabase* database)
+{
+  Q_D(ctkDICOMStorageListener);
+  if (this->isListening())
+    {
+    logger.warn("The database can't be changed while listening");
+    return;
+    }
+  d->Database = database;
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMDatabase* ctkDICOMStorageListener::database()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  return d->Database;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListener::setStorageDirectory(const QString& directory)
+{
+  Q_D(ctkDICOMStorageListener);
+  if (this->isListening())
+    {
+    logger.warn("The storage directory can't be changed while listening");
+    return;
+    }
+  d->StorageDirectory = directory;
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMStorageListener::storageDirectory()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  if (d->StorageDirectory.isEmpty() && d->Database && !d->Database->isInMemory())
+    {
+    return d->Database->databaseDirectory() + "/dicom/incoming";
+    }
+  return d->StorageDirectory;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMStorageListener::start()
+{
+  Q_D(ctkDICOMStorageListener);
+  if (this->isListening())
+    {
+    return true;
+    }
+  d->ActiveStorageDirectory = this->storageDirectory();
+  if (d->ActiveStorageDirectory.isEmpty() || !QDir().mkpath(d->ActiveStorageDirectory))
+    {
+    logger.error("Invalid storage directory: " + d->ActiveStorageDirectory);
+    return false;
+    }
+
+  OFCondition status = ASC_initializeNetwork(NET_ACCEPTOR, d->Port,
+                                             ctkDICOMStorageDataTimeout, &d->Network);
+  if (status.bad())
+    {
+    logger.error(QString("Unable to listen on port %1: ").arg(d->Port) + status.text());
+    d->Network = 0;
+    return false;
+    }
+
+  {
+  QMutexLocker locker(&d->Mutex);
+  d->Stopping = false;
+  d->ReceivedFiles = 0;
+  }
+  d->AssociationPool.setMaxThreadCount(d->MaximumAssociations);
+  d->AcceptThread->start();
+  d->InsertTimer->start();
+  logger.info(QString("Listening on port %1 as ").arg(d->Port) + d->AETitle);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMStorageListener::isListening()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  return d->Network != 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListener::stop()
+{
+  Q_D(ctkDICOMStorageListener);
+  if (!this->isListening())
+    {
+    return;
+    }
+  {
+  QMutexLocker locker(&d->Mutex);
+  d->Stopping = true;
+  }
+  d->AcceptThread->wait();
+  d->AssociationPool.waitForDone();
+  ASC_dropNetwork(&d->Network);
+  d->Network = 0;
+  d->InsertTimer->stop();
+  this->insertReceivedFiles();
+  logger.info(QString("Stopped listening on port %1").arg(d->Port));
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMStorageListener::activeAssociations()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  QMutexLocker locker(&d->Mutex);
+  return d->ActiveAssociations;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMStorageListener::receivedFiles()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  QMutexLocker locker(&d->Mutex);
+  return d->ReceivedFiles;
+}
+
+//------------------------------------------------------------------------------
+QStringList ctkDICOMStorageListener::pendingFiles()const
+{
+  Q_D(const ctkDICOMStorageListener);
+  QMutexLocker locker(&d->Mutex);
+  return d->PendingFiles;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMStorageListener::insertReceivedFiles()
+{
+  Q_D(ctkDICOMStorageListener);
+  if (!d->Database || !d->Database->isOpen())
+    {
+    return;
+    }
+  QStringList files;
+  {
+  QMutexLocker locker(&d->Mutex);
+  files = d->PendingFiles;
+  d->PendingFiles.clear();
+  }
+  if (files.isEmpty())
+    {
+    return;
+    }
+  // parsed on the indexer threads, inserted in a bulk insert session
+  d->Indexer->addListOfFiles(*d->Database, files);
+  emit filesInserted(files);
+}
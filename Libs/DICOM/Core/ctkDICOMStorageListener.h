@@ -0,0 +1,130 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMStorageListener_h
+#define __ctkDICOMStorageListener_h
+
+// Qt includes
+#include <QObject>
+#include <QStringList>
+
+#include "ctkDICOMCoreExport.h"
+
+class ctkDICOMDatabase;
+class ctkDICOMStorageListenerPrivate;
+
+/// \ingroup DICOM_Core
+///
+/// \brief Storage SCP receiving the objects sent to a DICOM node.
+///
+/// The associations are accepted by a listener thread and served on a pool
+/// of maximumAssociations() threads, so that several modalities can send
+/// at the same time. Verification (C-ECHO) and all the storage SOP classes
+/// are accepted. The incoming objects are written as they are received to
+/// storageDirectory(), without being decoded.
+///
+/// The received files are inserted into database() every insertInterval()
+/// milliseconds by a ctkDICOMIndexer, which parses them on a pool of
+/// threads and inserts them in a bulk insert session. The inserts are done
+/// in the thread of the listener, move it to a worker thread owning its own
+/// database connection to keep them away from the GUI thread.
+///
+class CTK_DICOM_CORE_EXPORT ctkDICOMStorageListener : public QObject
+{
+  Q_OBJECT
+  Q_PROPERTY(QString AETitle READ AETitle WRITE setAETitle)
+  Q_PROPERTY(int port READ port WRITE setPort)
+  Q_PROPERTY(int maximumAssociations READ maximumAssociations WRITE setMaximumAssociations)
+  Q_PROPERTY(int insertInterval READ insertInterval WRITE setInsertInterval)
+  Q_PROPERTY(QString storageDirectory READ storageDirectory WRITE setStorageDirectory)
+  Q_PROPERTY(bool listening READ isListening)
+
+public:
+  explicit ctkDICOMStorageListener(QObject* parent = 0);
+  virtual ~ctkDICOMStorageListener();
+
+  /// Application entity title of the listener, "CTKSTORESCP" by default.
+  /// The called AE title of the associations is not checked.
+  void setAETitle(const QString& title);
+  QString AETitle()const;
+
+  /// TCP port the associations are accepted on, 11112 by default.
+  void setPort(int port);
+  int port()const;
+
+  /// Number of associations served at the same time, 4 by default. The
+  /// associations accepted beyond wait for a thread.
+  void setMaximumAssociations(int count);
+  int maximumAssociations()const;
+
+  /// Milliseconds between two inserts of the received files, 1000 by default.
+  void setInsertInterval(int msec);
+  int insertInterval()const;
+
+  /// Database the received files are inserted into. The files are not
+  /// inserted if there is no database.
+  void setDatabase(ctkDICOMDatabase* database);
+  ctkDICOMDatabase* database()const;
+
+  /// Directory the received files are written to. By default, the
+  /// "dicom/incoming" directory of the database, so that the files are
+  /// removed with the patients, studies and series they belong to.
+  void setStorageDirectory(const QString& directory);
+  QString storageDirectory()const;
+
+  /// Start accepting associations. The properties can't be changed while
+  /// listening. Returns false if the port can't be opened.
+  bool start();
+  bool isListening()const;
+
+  /// Number of associations being served.
+  int activeAssociations()const;
+
+  /// Number of files received since start().
+  int receivedFiles()const;
+
+  /// Received files not inserted into the database yet.
+  QStringList pendingFiles()const;
+
+public Q_SLOTS:
+  /// Stop accepting associations, wait for the running ones to be released
+  /// or aborted and insert the files received.
+  void stop();
+
+  /// Insert the received files now rather than at the next insertInterval().
+  void insertReceivedFiles();
+
+Q_SIGNALS:
+  /// Emitted from the association threads, use a queued connection to
+  /// update widgets.
+  void fileReceived(const QString& filePath, const QString& callingAETitle);
+
+  /// Emitted once received files have been inserted into the database.
+  void filesInserted(const QStringList& filePaths);
+
+protected:
+  QScopedPointer<ctkDICOMStorageListenerPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDICOMStorageListener);
+  Q_DISABLE_COPY(ctkDICOMStorageListener);
+};
+
+#endif
@@ -21,9 +21,14 @@
 // Qt includes
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QProcess>
 #include <QTextStream>
+#include <QVector>
+
+// STD includes
+#include <algorithm>
 
 // ctkDICOM includes
 #include "ctkDICOMTester.h"
@@ -33,6 +38,21 @@
 static ctkLogger logger("org.commontk.dicom.DICOMTester" );
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+namespace
+{
+/// storeSCU process of ctkDICOMTester::generateLoad() and its statistics
+struct ctkDICOMTesterAssociation
+{
+  QProcess*       Process;
+  QElapsedTimer   Timer;
+  int             Sending;
+  int             Instances;
+  int             Failures;
+  QVector<qint64> Latencies;
+};
+}
+
 //------------------------------------------------------------------------------
 class ctkDICOMTesterPrivate
 {
@@ -50,6 +70,9 @@ public:
   QString findStoreSCUExecutable()const;
   QString findStoreSCPExecutable()const;
   void printProcessOutputs(const QString& program, QProcess* process)const;
+  QStringList storeSCUArguments()const;
+  static QVariantMap loadReport(int instances, int failures, qint64 elapsedMs,
+                                QVector<qint64> latencies);
   
   QProcess*   DCMQRSCPProcess;
   QProcess*   STORESCPProcess;
@@ -175,6 +198,36 @@ void ctkDICOMTesterPrivate::printProcessOutputs(const QString& program, QProcess
     }
 }
 
+//------------------------------------------------------------------------------
+QStringList ctkDICOMTesterPrivate::storeSCUArguments()const
+{
+  // usage of storescu:
+  // storescu -aec CTK_AE -aet CTK_AE localhost 11112 ./CMakeExternals/Source/CTKData/Data/DICOM/MRHEAD/*.IMA
+  QStringList storescuArgs;
+  storescuArgs << "-aec" << "CTK_AE";
+  storescuArgs << "-aet" << "CTK_AE";
+  storescuArgs << "localhost" <<  QString::number(this->DCMQRSCPPort);
+  return storescuArgs;
+}
+
+//------------------------------------------------------------------------------
+QVariantMap ctkDICOMTesterPrivate::loadReport(int instances, int failures, qint64 elapsedMs,
+                                              QVector<qint64> latencies)
+{
+  QVariantMap report;
+  report["Instances"] = instances;
+  report["Failures"] = failures;
+  report["Seconds"] = elapsedMs / 1000.;
+  report["ImagesPerSecond"] = elapsedMs > 0 ? (instances - failures) * 1000. / elapsedMs : 0.;
+  std::sort(latencies.begin(), latencies.end());
+  const int count = latencies.count();
+  report["LatencyMedianMs"] = count ? latencies[(count - 1) / 2] : 0;
+  report["LatencyP95Ms"] = count ? latencies[qMin(count - 1, count * 95 / 100)] : 0;
+  report["LatencyP99Ms"] = count ? latencies[qMin(count - 1, count * 99 / 100)] : 0;
+  report["LatencyMaxMs"] = count ? latencies[count - 1] : 0;
+  return report;
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMTester methods
 
@@ -332,12 +385,7 @@ bool ctkDICOMTester::storeData(const QStringList& data)
     }
 
   QProcess storeSCU(this);
-  // usage of storescu:
-  // storescu -aec CTK_AE -aet CTK_AE localhost 11112 ./CMakeExternals/Source/CTKData/Data/DICOM/MRHEAD/*.IMA
-  QStringList storescuArgs;
-  storescuArgs << "-aec" << "CTK_AE";
-  storescuArgs << "-aet" << "CTK_AE";
-  storescuArgs << "localhost" <<  QString::number(d->DCMQRSCPPort);
+  QStringList storescuArgs = d->storeSCUArguments();
   storescuArgs << data;
   
   storeSCU.start(d->StoreSCUExecutable, storescuArgs);
@@ -346,3 +394,105 @@ bool ctkDICOMTester::storeData(const QStringList& data)
   d->printProcessOutputs("StoreSCU", &storeSCU);
   return res;
 }
+
+//------------------------------------------------------------------------------
+QVariantMap ctkDICOMTester::generateLoad(const QStringList& instanceMix,
+                                         int concurrentAssociations,
+                                         int instanceCount,
+                                         int instancesPerAssociation)
+{
+  Q_D(ctkDICOMTester);
+
+  // There is no point of calling storescu if no-one is listening
+  if (!d->DCMQRSCPProcess || instanceMix.isEmpty())
+    {
+    return QVariantMap();
+    }
+  concurrentAssociations = qMax(concurrentAssociations, 1);
+  instancesPerAssociation = qMax(instancesPerAssociation, 1);
+
+  QVector<ctkDICOMTesterAssociation> associations(concurrentAssociations);
+
+  int nextInstance = 0;
+  QElapsedTimer loadTimer;
+  loadTimer.start();
+  int running = 0;
+  for (int i = 0; i < associations.count(); ++i)
+    {
+    ctkDICOMTesterAssociation& association = associations[i];
+    association.Process = new QProcess(this);
+    association.Sending = 0;
+    association.Instances = 0;
+    association.Failures = 0;
+    }
+  do
+    {
+    running = 0;
+    for (int i = 0; i < associations.count(); ++i)
+      {
+      ctkDICOMTesterAssociation& association = associations[i];
+      if (association.Sending > 0)
+        {
+        if (association.Process->state() != QProcess::NotRunning &&
+            !association.Process->waitForFinished(1))
+          {
+          ++running;
+          continue;
+          }
+        association.Latencies << association.Timer.elapsed();
+        association.Instances += association.Sending;
+        if (association.Process->exitStatus() != QProcess::NormalExit ||
+            association.Process->exitCode() != 0)
+          {
+          association.Failures += association.Sending;
+          d->printProcessOutputs("StoreSCU", association.Process);
+          }
+        association.Sending = 0;
+        }
+      if (nextInstance >= instanceCount)
+        {
+        continue;
+        }
+      // Next association of the worker, the mix is cycled through
+      QStringList storescuArgs = d->storeSCUArguments();
+      for (; association.Sending < instancesPerAssociation && nextInstance < instanceCount;
+           ++association.Sending, ++nextInstance)
+        {
+        storescuArgs << instanceMix[nextInstance % instanceMix.count()];
+        }
+      association.Timer.start();
+      association.Process->start(d->StoreSCUExecutable, storescuArgs);
+      if (!association.Process->waitForStarted(-1))
+        {
+        association.Instances += association.Sending;
+        association.Failures += association.Sending;
+        association.Sending = 0;
+        continue;
+        }
+      ++running;
+      }
+    }
+  while (running > 0);
+  const qint64 elapsed = loadTimer.elapsed();
+
+  QVariantList associationReports;
+  QVector<qint64> latencies;
+  int instances = 0;
+  int failures = 0;
+  for (int i = 0; i < associations.count(); ++i)
+    {
+    const ctkDICOMTesterAssociation& association = associations[i];
+    associationReports << ctkDICOMTesterPrivate::loadReport(
+      association.Instances, association.Failures, elapsed, association.Latencies);
+    latencies << association.Latencies;
+    instances += association.Instances;
+    failures += association.Failures;
+    delete association.Process;
+    }
+  QVariantMap report = ctkDICOMTesterPrivate::loadReport(instances, failures, elapsed, latencies);
+  report["Associations"] = associationReports;
+  logger.info(QString("Load of %1 instances over %2 associations: %3 images/s, %4 failures")
+              .arg(instances).arg(concurrentAssociations)
+              .arg(report["ImagesPerSecond"].toDouble()).arg(failures));
+  return report;
+}
@@ -23,6 +23,7 @@
 
 // Qt includes
 #include <QObject>
+#include <QVariantMap>
 class QProcess;
 
 // CTKDICOMCore includes
@@ -89,6 +90,24 @@ public:
   ///
   Q_INVOKABLE bool storeData(const QStringList& data);
 
+  ///  Generates load on the running DCMQRSCP: \a concurrentAssociations
+  /// storeSCU processes are kept running at all times, each association
+  /// sending the next \a instancesPerAssociation files of the \a instanceMix
+  /// list, cycled, until \a instanceCount instances have been sent.
+  /// Files can be repeated in \a instanceMix to weight the mix.
+  /// It waits for the last association to finish and returns a report with
+  /// the aggregate "Instances", "Failures", "Seconds", "ImagesPerSecond",
+  /// "LatencyMedianMs", "LatencyP95Ms", "LatencyP99Ms" and "LatencyMaxMs",
+  /// the latency being the duration of an association. "Associations" lists
+  /// the same report for each of the concurrent associations.
+  /// An empty map is returned if dcmqrscp is not running.
+  /// \sa startDCMQRSCP(), storeData()
+  ///
+  Q_INVOKABLE QVariantMap generateLoad(const QStringList& instanceMix,
+                                       int concurrentAssociations,
+                                       int instanceCount,
+                                       int instancesPerAssociation = 1);
+
 protected:
   QScopedPointer<ctkDICOMTesterPrivate> d_ptr;
 
@@ -0,0 +1,269 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+
+// ctkDICOM includes
+#include "ctkLogger.h"
+#include "ctkDICOMAbstractThumbnailGenerator.h"
+#include "ctkDICOMThumbnailQueue.h"
+
+// DCMTK includes
+#include <dcmtk/dcmimgle/dcmimage.h>
+
+//------------------------------------------------------------------------------
+static ctkLogger logger("org.commontk.dicom.DICOMThumbnailQueue" );
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+class ctkDICOMThumbnailQueuePrivate
+{
+  Q_DECLARE_PUBLIC(ctkDICOMThumbnailQueue);
+
+protected:
+  ctkDICOMThumbnailQueue* const q_ptr;
+
+public:
+  ctkDICOMThumbnailQueuePrivate(ctkDICOMThumbnailQueue&);
+
+  /// Called from the pool threads.
+  void generate(const QString& dicomFilePath, const QString& thumbnailPath, int generation);
+
+  ctkDICOMAbstractThumbnailGenerator* ThumbnailGenerator;
+  QThreadPool Pool;
+
+  /// Protects the members below.
+  mutable QMutex Mutex;
+  /// Thumbnails waiting for a thread, with the highest priority they
+  /// have been queued with.
+  QHash<QString, int> Pending;
+  int Running;
+  /// Incremented by cancel(), tasks queued before are discarded.
+  int Generation;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMThumbnailTask : public QRunnable
+{
+public:
+  ctkDICOMThumbnailTask(ctkDICOMThumbnailQueuePrivate* queue,
+                        const QString& dicomFilePath, const QString& thumbnailPath,
+                        int generation)
+    : Queue(queue)
+    , DICOMFilePath(dicomFilePath)
+    , ThumbnailPath(thumbnailPath)
+    , Generation(generation)
+  {
+  }
+
+  virtual void run()
+  {
+    this->Queue->generate(this->DICOMFilePath, this->ThumbnailPath, this->Generation);
+  }
+
+private:
+  ctkDICOMThumbnailQueuePrivate* Queue;
+  QString DICOMFilePath;
+  QString ThumbnailPath;
+  int Generation;
+};
+
+//------------------------------------------------------------------------------
+// ctkDICOMThumbnailQueuePrivate methods
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailQueuePrivate::ctkDICOMThumbnailQueuePrivate(ctkDICOMThumbnailQueue& o)
+  : q_ptr(&o)
+  , ThumbnailGenerator(0)
+  , Running(0)
+  , Generation(0)
+{
+  this->Pool.setMaxThreadCount(1);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailQueuePrivate::generate(const QString& dicomFilePath,
+                                             const QString& thumbnailPath,
+                                             int generation)
+{
+  Q_Q(ctkDICOMThumbnailQueue);
+  ctkDICOMAbstractThumbnailGenerator* generator;
+  {
+  QMutexLocker locker(&this->Mutex);
+  // the same thumbnail can be queued several times with increasing
+  // priorities, only the first task to run generates it
+  if (generation != this->Generation || !this->Pending.contains(thumbnailPath))
+    {
+    return;
+    }
+  this->Pending.remove(thumbnailPath);
+  generator = this->ThumbnailGenerator;
+  ++this->Running;
+  }
+
+  bool generated = false;
+  if (generator && !ctkDICOMThumbnailQueue::isThumbnailUpToDate(dicomFilePath, thumbnailPath))
+    {
+    QDir().mkpath(QFileInfo(thumbnailPath).absolutePath());
+    DicomImage dcmImage(QDir::toNativeSeparators(dicomFilePath).toLatin1());
+    generated = generator->generateThumbnail(&dcmImage, thumbnailPath);
+    if (!generated)
+      {
+      logger.warn("Failed to generate thumbnail " + thumbnailPath);
+      }
+    }
+
+  {
+  QMutexLocker locker(&this->Mutex);
+  --this->Running;
+  }
+
+  if (generated)
+    {
+    emit q->thumbnailGenerated(thumbnailPath);
+    }
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMThumbnailQueue methods
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailQueue::ctkDICOMThumbnailQueue(QObject* parent)
+  : QObject(parent)
+  , d_ptr(new ctkDICOMThumbnailQueuePrivate(*this))
+{
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailQueue::~ctkDICOMThumbnailQueue()
+{
+  Q_D(ctkDICOMThumbnailQueue);
+  this->cancel();
+  d->Pool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailQueue::setThumbnailGenerator(ctkDICOMAbstractThumbnailGenerator* generator)
+{
+  Q_D(ctkDICOMThumbnailQueue);
+  QMutexLocker locker(&d->Mutex);
+  d->ThumbnailGenerator = generator;
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMAbstractThumbnailGenerator* ctkDICOMThumbnailQueue::thumbnailGenerator()const
+{
+  Q_D(const ctkDICOMThumbnailQueue);
+  QMutexLocker locker(&d->Mutex);
+  return d->ThumbnailGenerator;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailQueue::setMaximumThreadCount(int threadCount)
+{
+  Q_D(ctkDICOMThumbnailQueue);
+  d->Pool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailQueue::maximumThreadCount()const
+{
+  Q_D(const ctkDICOMThumbnailQueue);
+  return d->Pool.maxThreadCount();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMThumbnailQueue::addThumbnail(const QString& dicomFilePath,
+                                          const QString& thumbnailPath,
+                                          int priority)
+{
+  Q_D(ctkDICOMThumbnailQueue);
+  int generation;
+  {
+  QMutexLocker locker(&d->Mutex);
+  if (!d->ThumbnailGenerator)
+    {
+    return false;
+    }
+  QHash<QString, int>::iterator pending = d->Pending.find(thumbnailPath);
+  if (pending != d->Pending.end())
+    {
+    if (pending.value() >= priority)
+      {
+      return false;
+      }
+    // queue it again with the higher priority, the task queued first
+    // will find it is not pending anymore
+    pending.value() = priority;
+    }
+  else
+    {
+    if (isThumbnailUpToDate(dicomFilePath, thumbnailPath))
+      {
+      return false;
+      }
+    d->Pending.insert(thumbnailPath, priority);
+    }
+  generation = d->Generation;
+  }
+  d->Pool.start(new ctkDICOMThumbnailTask(d, dicomFilePath, thumbnailPath, generation), priority);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailQueue::pendingThumbnails()const
+{
+  Q_D(const ctkDICOMThumbnailQueue);
+  QMutexLocker locker(&d->Mutex);
+  return d->Pending.count() + d->Running;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMThumbnailQueue::isThumbnailUpToDate(const QString& dicomFilePath,
+                                                 const QString& thumbnailPath)
+{
+  QFileInfo thumbnailInfo(thumbnailPath);
+  return thumbnailInfo.exists()
+    && thumbnailInfo.lastModified() > QFileInfo(dicomFilePath).lastModified();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailQueue::waitForDone()
+{
+  Q_D(ctkDICOMThumbnailQueue);
+  d->Pool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailQueue::cancel()
+{
+  Q_D(ctkDICOMThumbnailQueue);
+  QMutexLocker locker(&d->Mutex);
+  ++d->Generation;
+  d->Pending.clear();
+}
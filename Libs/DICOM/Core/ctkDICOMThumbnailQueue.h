@@ -0,0 +1,100 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMThumbnailQueue_h
+#define __ctkDICOMThumbnailQueue_h
+
+// Qt includes
+#include <QObject>
+
+#include "ctkDICOMCoreExport.h"
+
+class ctkDICOMAbstractThumbnailGenerator;
+class ctkDICOMThumbnailQueuePrivate;
+
+/// \ingroup DICOM_Core
+///
+/// \brief Generates thumbnails of DICOM files on a pool of threads.
+///
+/// Decoding the pixel data and encoding the thumbnails is done outside of
+/// the thread that queues the thumbnails, e.g. the thread inserting files
+/// into the database. Thumbnails are generated by priority: the ones
+/// requested for display first, then the series representative thumbnails
+/// and last the other instances. A thumbnail that is already queued or
+/// that is up to date is not generated again.
+///
+/// The thumbnail generator must be thread safe if more than one thread is
+/// used (see setMaximumThreadCount()).
+///
+class CTK_DICOM_CORE_EXPORT ctkDICOMThumbnailQueue : public QObject
+{
+  Q_OBJECT
+  Q_PROPERTY(int maximumThreadCount READ maximumThreadCount WRITE setMaximumThreadCount)
+public:
+  enum Priority
+  {
+    InstancePriority = 0,
+    SeriesPriority = 1,
+    RequestedPriority = 2
+  };
+
+  explicit ctkDICOMThumbnailQueue(QObject* parent = 0);
+  virtual ~ctkDICOMThumbnailQueue();
+
+  void setThumbnailGenerator(ctkDICOMAbstractThumbnailGenerator* generator);
+  ctkDICOMAbstractThumbnailGenerator* thumbnailGenerator()const;
+
+  /// Number of threads generating thumbnails, 1 by default.
+  void setMaximumThreadCount(int threadCount);
+  int maximumThreadCount()const;
+
+  /// Queue the generation of thumbnailPath from dicomFilePath.
+  /// Returns false if there is no generator, if the thumbnail is up to
+  /// date or if it is already queued.
+  bool addThumbnail(const QString& dicomFilePath, const QString& thumbnailPath,
+                    int priority = InstancePriority);
+
+  /// Number of queued or running thumbnail generations.
+  int pendingThumbnails()const;
+
+  /// Returns true if thumbnailPath exists and is newer than dicomFilePath.
+  static bool isThumbnailUpToDate(const QString& dicomFilePath, const QString& thumbnailPath);
+
+  /// Wait for the queued thumbnails to be generated.
+  void waitForDone();
+
+public Q_SLOTS:
+  /// Discard the thumbnails that are not being generated yet.
+  void cancel();
+
+Q_SIGNALS:
+  /// Emitted from the thread that generated the thumbnail, use a queued
+  /// connection to update widgets.
+  void thumbnailGenerated(const QString& thumbnailPath);
+
+protected:
+  QScopedPointer<ctkDICOMThumbnailQueuePrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDICOMThumbnailQueue);
+  Q_DISABLE_COPY(ctkDICOMThumbnailQueue);
+};
+
+#endif
@@ -56,6 +56,20 @@ int ctkDICOMImageTest1( int argc, char * argv [] )
     return EXIT_FAILURE;
     }
   qtImage.setPixmap(pixmap);
+
+  // the converted frame is cached
+  if (ctkImage.frameCacheUsage() <= 0 ||
+      ctkImage.frame(0) != ctkImage.frame(0))
+    {
+    std::cerr << "The frame was not cached: " << ctkImage.frameCacheUsage() << std::endl;
+    return EXIT_FAILURE;
+    }
+  ctkImage.setFrameCacheSize(0);
+  if (ctkImage.frameCacheUsage() != 0 || ctkImage.frame(0).isNull())
+    {
+    std::cerr << "The frame cache should be disabled: " << ctkImage.frameCacheUsage() << std::endl;
+    return EXIT_FAILURE;
+    }
   qtImage.show();
 
   if (argc > 2 && QString(argv[2]) == "-I")
@@ -0,0 +1,142 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QDir>
+#include <QLineEdit>
+#include <QTableView>
+#include <QTimer>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// ctkDICOMWidgets includes
+#include "ctkDICOMTableView.h"
+
+// STD includes
+#include <iostream>
+
+//------------------------------------------------------------------------------
+static QString columnValue(QTableView* tableView, const QString& columnName)
+{
+  QAbstractItemModel* model = tableView->model();
+  for (int i = 0; i < model->columnCount(); ++i)
+    {
+    if (model->headerData(i, Qt::Horizontal).toString() == columnName)
+      {
+      return model->index(0, i).data().toString();
+      }
+    }
+  return QString();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMTableViewTest1( int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMTableViewTest1: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDICOMDatabase database;
+  QDir databaseDirectory = QDir::temp();
+  QFileInfo databaseFile(databaseDirectory, QString("ctkDICOMTableViewTest1.sql"));
+  databaseDirectory.remove(databaseFile.fileName());
+  database.openDatabase(databaseFile.absoluteFilePath());
+  if (!database.initializeDatabase())
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+  database.insert(argv[1], false, false);
+
+  ctkDICOMTableView tableView(&database, "Patients");
+  tableView.waitForQuery();
+  QTableView* view = tableView.tableView();
+  if (view->model()->rowCount() != 1 || !tableView.uidsForQuery().isEmpty())
+    {
+    std::cerr << "ctkDICOMTableView: expected 1 patient, got "
+              << view->model()->rowCount() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const QString patientsName = columnValue(view, "PatientsName");
+  QLineEdit* searchBox = tableView.findChild<QLineEdit*>();
+  if (patientsName.length() < 2 || !searchBox)
+    {
+    std::cerr << "ctkDICOMTableView: invalid patient name or search box" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the filter is applied once the text did not change for filterDelay ms
+  searchBox->setText("no patient matches this text");
+  if (view->model()->rowCount() != 1)
+    {
+    std::cerr << "ctkDICOMTableView: filter applied before filterDelay" << std::endl;
+    return EXIT_FAILURE;
+    }
+  tableView.waitForQuery();
+  if (view->model()->rowCount() != 0 || !tableView.filterActive() ||
+      tableView.uidsForQuery() != QStringList("#"))
+    {
+    std::cerr << "ctkDICOMTableView: expected no patient to match the filter" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // case insensitive match of a part of the patient name
+  searchBox->setText(patientsName.mid(1).toLower());
+  tableView.waitForQuery();
+  if (view->model()->rowCount() != 1 || tableView.uidsForQuery().count() != 1)
+    {
+    std::cerr << "ctkDICOMTableView: expected the patient to match "
+              << qPrintable(patientsName.mid(1).toLower()) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the wildcards of the former filter are supported, '%' and '_' are not
+  searchBox->setText(patientsName.left(1) + "*" + patientsName.right(1));
+  tableView.waitForQuery();
+  if (view->model()->rowCount() != 1)
+    {
+    std::cerr << "ctkDICOMTableView: expected '*' to match any text" << std::endl;
+    return EXIT_FAILURE;
+    }
+  searchBox->setText(patientsName.left(1) + "%" + patientsName.right(1));
+  tableView.waitForQuery();
+  if (view->model()->rowCount() != 0)
+    {
+    std::cerr << "ctkDICOMTableView: expected '%' to be escaped" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  tableView.show();
+  if (argc <= 2 || QString(argv[2]) != "-I")
+    {
+    QTimer::singleShot(200, &app, SLOT(quit()));
+    }
+  int res = app.exec();
+  database.closeDatabase();
+  return res;
+}
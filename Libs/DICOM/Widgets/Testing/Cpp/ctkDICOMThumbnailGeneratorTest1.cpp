@@ -0,0 +1,139 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QImage>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// ctkDICOMWidgets includes
+#include "ctkDICOMThumbnailGenerator.h"
+
+// STD includes
+#include <iostream>
+
+//------------------------------------------------------------------------------
+static QStringList thumbnailFiles(const QString& directory)
+{
+  QStringList files;
+  QDir thumbnailDirectory(directory);
+  foreach(const QString& study, thumbnailDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+    QDir studyDirectory(thumbnailDirectory.absoluteFilePath(study));
+    foreach(const QString& series, studyDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+      {
+      QDir seriesDirectory(studyDirectory.absoluteFilePath(series));
+      foreach(const QString& file, seriesDirectory.entryList(QDir::Files))
+        {
+        files << seriesDirectory.absoluteFilePath(file);
+        }
+      }
+    }
+  return files;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailGeneratorTest1( int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "ctkDICOMThumbnailGeneratorTest1: missing dicom filePath argument";
+    std::cerr << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QDir databaseDirectory(QDir::temp().absoluteFilePath("ctkDICOMThumbnailGeneratorTest1"));
+  QDir().mkpath(databaseDirectory.absolutePath());
+  databaseDirectory.remove("ctkDICOM.sql");
+  const QString thumbnailDirectory = databaseDirectory.absoluteFilePath("thumbs");
+  foreach(const QString& file, thumbnailFiles(thumbnailDirectory))
+    {
+    QFile::remove(file);
+    }
+
+  // imported without thumbnail generator
+  ctkDICOMDatabase database;
+  database.openDatabase(databaseDirectory.absoluteFilePath("ctkDICOM.sql"));
+  if (!database.initializeDatabase())
+    {
+    std::cerr << "ctkDICOMDatabase::initializeDatabase() failed." << std::endl;
+    return EXIT_FAILURE;
+    }
+  database.insert(argv[1], false, false);
+
+  ctkDICOMThumbnailGenerator generator;
+  generator.setMaximumBatchThreadCount(2);
+  if (generator.maximumBatchThreadCount() != 2)
+    {
+    std::cerr << "ctkDICOMThumbnailGenerator::setMaximumBatchThreadCount() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (generator.generateSeriesThumbnails(&database) != 1)
+    {
+    std::cerr << "ctkDICOMThumbnailGenerator::generateSeriesThumbnails(): "
+              << "expected 1 series" << std::endl;
+    return EXIT_FAILURE;
+    }
+  generator.waitForBatch();
+  QStringList thumbnails = thumbnailFiles(thumbnailDirectory);
+  if (generator.isBatchRunning() || thumbnails.count() != 1 ||
+      !thumbnails[0].endsWith(".png") || generator.batchThroughput() < 0.)
+    {
+    std::cerr << "ctkDICOMThumbnailGenerator::generateSeriesThumbnails(): "
+              << "expected 1 thumbnail, got " << thumbnails.count() << std::endl;
+    return EXIT_FAILURE;
+    }
+  QImage thumbnail(thumbnails[0]);
+  if (thumbnail.isNull() || qMax(thumbnail.width(), thumbnail.height()) != 128)
+    {
+    std::cerr << "ctkDICOMThumbnailGenerator::generateSeriesThumbnails(): "
+              << "invalid thumbnail " << qPrintable(thumbnails[0]) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the series with a thumbnail are skipped unless regenerate is true
+  QDateTime lastModified = QFileInfo(thumbnails[0]).lastModified();
+  generator.generateSeriesThumbnails(&database);
+  generator.waitForBatch();
+  if (QFileInfo(thumbnails[0]).lastModified() != lastModified)
+    {
+    std::cerr << "ctkDICOMThumbnailGenerator::generateSeriesThumbnails(): "
+              << "thumbnail should not be regenerated" << std::endl;
+    return EXIT_FAILURE;
+    }
+  generator.generateSeriesThumbnails(&database, true);
+  generator.waitForBatch();
+  if (thumbnailFiles(thumbnailDirectory) != thumbnails)
+    {
+    std::cerr << "ctkDICOMThumbnailGenerator::generateSeriesThumbnails(): "
+              << "thumbnail should be replaced" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  database.closeDatabase();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QLineEdit>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTableView>
+#include <QVariant>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+
+// ctkDICOMWidgets includes
+#include "ctkDICOMTableManager.h"
+#include "ctkDICOMTableView.h"
+
+// CTK includes
+#include "ctkInteractionBenchmark.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+// Fill the database with patients x studies x series synthetic entries,
+// without any file. Only the tables displayed by ctkDICOMTableManager are
+// populated.
+bool populateDatabase(ctkDICOMDatabase& database,
+                      int patients, int studies, int series)
+{
+  QSqlDatabase db = database.database();
+  db.transaction();
+  QSqlQuery insertPatient(db);
+  insertPatient.prepare("INSERT INTO Patients (UID, PatientsName, PatientID, PatientsBirthDate) "
+                        "VALUES (?, ?, ?, ?)");
+  QSqlQuery insertStudy(db);
+  insertStudy.prepare("INSERT INTO Studies (StudyInstanceUID, PatientsUID, StudyID, StudyDate, "
+                      "StudyDescription, ModalitiesInStudy, SeriesCount, InstanceCount) "
+                      "VALUES (?, ?, ?, ?, ?, 'MR', ?, ?)");
+  QSqlQuery insertSeries(db);
+  insertSeries.prepare("INSERT INTO Series (SeriesInstanceUID, StudyInstanceUID, SeriesNumber, "
+                       "SeriesDescription, Modality, InstanceCount) "
+                       "VALUES (?, ?, ?, ?, 'MR', 100)");
+  for (int p = 1; p <= patients; ++p)
+    {
+    insertPatient.addBindValue(p);
+    insertPatient.addBindValue(QString("Patient^%1").arg(p, 6, 10, QChar('0')));
+    insertPatient.addBindValue(QString("ID%1").arg(p));
+    insertPatient.addBindValue(QString("19%1-01-01").arg(10 + p % 90));
+    if (!insertPatient.exec())
+      {
+      std::cerr << qPrintable(insertPatient.lastError().text()) << std::endl;
+      db.rollback();
+      return false;
+      }
+    for (int s = 1; s <= studies; ++s)
+      {
+      QString studyUID = QString("1.2.826.0.1.%1.%2").arg(p).arg(s);
+      insertStudy.addBindValue(studyUID);
+      insertStudy.addBindValue(p);
+      insertStudy.addBindValue(QString::number(s));
+      insertStudy.addBindValue(QString("20%1-06-01").arg(10 + s % 10));
+      insertStudy.addBindValue(QString("Study %1").arg(s));
+      insertStudy.addBindValue(series);
+      insertStudy.addBindValue(series * 100);
+      if (!insertStudy.exec())
+        {
+        std::cerr << qPrintable(insertStudy.lastError().text()) << std::endl;
+        db.rollback();
+        return false;
+        }
+      for (int r = 1; r <= series; ++r)
+        {
+        insertSeries.addBindValue(QString("%1.%2").arg(studyUID).arg(r));
+        insertSeries.addBindValue(studyUID);
+        insertSeries.addBindValue(r);
+        insertSeries.addBindValue(QString("Series %1").arg(r));
+        if (!insertSeries.exec())
+          {
+          std::cerr << qPrintable(insertSeries.lastError().text()) << std::endl;
+          db.rollback();
+          return false;
+          }
+        }
+      }
+    }
+  return db.commit();
+}
+
+//------------------------------------------------------------------------------
+void waitForTables(ctkDICOMTableManager& manager)
+{
+  manager.patientsTable()->waitForQuery();
+  manager.studiesTable()->waitForQuery();
+  manager.seriesTable()->waitForQuery();
+}
+
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMWidgetsInteractionBenchmark(int argc, char * argv [])
+{
+  QApplication app(argc, argv);
+
+  // Optional argument: file the JSON summary is written into
+  QString output = argc > 1 ? QString(argv[1]) : QString();
+
+  const int patients = 5000;
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:");
+  if (!populateDatabase(database, patients, 4, 5))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to populate the database" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkInteractionBenchmark benchmark("CTKDICOMWidgets");
+
+  ctkDICOMTableManager manager(0);
+  manager.resize(1200, 800);
+  manager.show();
+  benchmark.start();
+  manager.setDICOMDatabase(&database);
+  waitForTables(manager);
+  benchmark.stop("ctkDICOMTableManager", "setDICOMDatabase");
+  benchmark.recordFrame("ctkDICOMTableManager", &manager);
+
+  QTableView* patientsView = manager.patientsTable()->tableView();
+  if (patientsView->model()->rowCount() == 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - No patient displayed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Selecting patients one after the other, as with the arrow keys
+  for (int row = 0; row < 100 && row < patientsView->model()->rowCount(); ++row)
+    {
+    benchmark.start();
+    patientsView->selectRow(row);
+    waitForTables(manager);
+    benchmark.stop("ctkDICOMTableManager", "selectPatient");
+    benchmark.recordFrame("ctkDICOMTableManager", &manager);
+    }
+
+  // Selecting all the patients
+  benchmark.start();
+  patientsView->selectAll();
+  waitForTables(manager);
+  benchmark.stop("ctkDICOMTableManager", "selectAllPatients");
+  benchmark.recordFrame("ctkDICOMTableManager", &manager);
+
+  // Typing a filter, one character at a time
+  QLineEdit* searchBox = manager.patientsTable()->findChild<QLineEdit*>();
+  if (!searchBox)
+    {
+    std::cerr << "Line " << __LINE__ << " - No search box" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const QString filter("Patient^0042");
+  for (int i = 1; i <= filter.length(); ++i)
+    {
+    benchmark.start();
+    searchBox->setText(filter.left(i));
+    waitForTables(manager);
+    benchmark.stop("ctkDICOMTableManager", "filter");
+    benchmark.recordFrame("ctkDICOMTableManager", &manager);
+    }
+  searchBox->clear();
+  waitForTables(manager);
+
+  // Scrolling the patients table, a page at a time
+  for (int i = 0; i < 50; ++i)
+    {
+    benchmark.start();
+    patientsView->scrollTo(patientsView->model()->index(
+      (i * 40) % patientsView->model()->rowCount(), 0));
+    benchmark.stop("ctkDICOMTableManager", "scroll");
+    benchmark.recordFrame("ctkDICOMTableManager", patientsView->viewport());
+    }
+
+  return benchmark.writeJSON(output) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -48,6 +48,7 @@
 #include "ctkDICOMFilterProxyModel.h"
 #include "ctkDICOMIndexer.h"
 #include "ctkDICOMModel.h"
+#include "ctkDICOMSeriesPrefetcher.h"
 
 // ctkDICOMWidgets includes
 #include "ctkDICOMAppWidget.h"
@@ -83,12 +84,16 @@ public:
   ctkDICOMModel DICOMModel;
   ctkDICOMFilterProxyModel DICOMProxyModel;
   QSharedPointer<ctkDICOMIndexer> DICOMIndexer;
+  ctkDICOMSeriesPrefetcher SeriesPrefetcher;
   QProgressDialog *IndexerProgress;
   QProgressDialog *UpdateSchemaProgress;
 
   void showIndexerDialog();
   void showUpdateSchemaDialog();
 
+  /// Returns the UID of the series at index, empty if it is not a series.
+  QString seriesUID(const QModelIndex& index)const;
+
   // used when suspending the ctkDICOMModel
   QSqlDatabase EmptyDatabase;
 
@@ -112,6 +117,7 @@ ctkDICOMAppWidgetPrivate::ctkDICOMAppWidgetPrivate(ctkDICOMAppWidget* parent): q
   DICOMDatabase = QSharedPointer<ctkDICOMDatabase> (new ctkDICOMDatabase);
   ThumbnailGenerator = QSharedPointer <ctkDICOMThumbnailGenerator> (new ctkDICOMThumbnailGenerator);
   DICOMDatabase->setThumbnailGenerator(ThumbnailGenerator.data());
+  SeriesPrefetcher.setDatabase(DICOMDatabase.data());
   DICOMIndexer = QSharedPointer<ctkDICOMIndexer> (new ctkDICOMIndexer);
   IndexerProgress = 0;
   UpdateSchemaProgress = 0;
@@ -227,6 +233,19 @@ void ctkDICOMAppWidgetPrivate::showIndexerDialog()
   IndexerProgress->show();
 }
 
+//----------------------------------------------------------------------------
+QString ctkDICOMAppWidgetPrivate::seriesUID(const QModelIndex& index)const
+{
+  const ctkDICOMModel* model = qobject_cast<const ctkDICOMModel*>(index.model());
+  QModelIndex index0 = index.sibling(index.row(), 0);
+  if (!model ||
+      model->data(index0, ctkDICOMModel::TypeRole) != static_cast<int>(ctkDICOMModel::SeriesType))
+    {
+    return QString();
+    }
+  return model->data(index0, ctkDICOMModel::UIDRole).toString();
+}
+
 //----------------------------------------------------------------------------
 // ctkDICOMAppWidget methods
 
@@ -267,6 +286,9 @@ ctkDICOMAppWidget::ctkDICOMAppWidget(QWidget* _parent):Superclass(_parent),
   // Treeview signals
   connect(d->TreeView, SIGNAL(collapsed(QModelIndex)), this, SLOT(onTreeCollapsed(QModelIndex)));
   connect(d->TreeView, SIGNAL(expanded(QModelIndex)), this, SLOT(onTreeExpanded(QModelIndex)));
+  // hovered series are prefetched
+  d->TreeView->setMouseTracking(true);
+  connect(d->TreeView, SIGNAL(entered(QModelIndex)), this, SLOT(onTreeEntered(QModelIndex)));
 
   //Set ToolBar button style
   d->ToolBar->setToolButtonStyle(Qt::ToolButtonTextUnderIcon);
@@ -324,6 +346,7 @@ ctkDICOMAppWidget::~ctkDICOMAppWidget()
 {
   Q_D(ctkDICOMAppWidget);
 
+  d->SeriesPrefetcher.cancel();
   d->QueryRetrieveWidget->deleteLater();
   d->ImportDialog->deleteLater();
 }
@@ -425,6 +448,7 @@ void ctkDICOMAppWidget::setDatabaseDirectory(const QString& directory)
   // update the button and let any connected slots know about the change
   d->DirectoryButton->setDirectory(directory);
   d->ThumbnailsWidget->setDatabaseDirectory(directory);
+  d->ThumbnailsWidget->setDICOMDatabase(d->DICOMDatabase.data());
   d->ImagePreview->setDatabaseDirectory(directory);
   emit databaseDirectoryChanged(directory);
 }
@@ -464,6 +488,13 @@ ctkDICOMDatabase* ctkDICOMAppWidget::database(){
   return d->DICOMDatabase.data();
 }
 
+//----------------------------------------------------------------------------
+ctkDICOMSeriesPrefetcher* ctkDICOMAppWidget::seriesPrefetcher()
+{
+  Q_D(ctkDICOMAppWidget);
+  return &d->SeriesPrefetcher;
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMAppWidget::setSearchWidgetPopUpMode(bool flag){
   Q_D(ctkDICOMAppWidget);
@@ -619,6 +650,11 @@ void ctkDICOMAppWidget::onThumbnailDoubleClicked(const ctkThumbnailLabel& widget
 
     if(model && (model->data(index0,ctkDICOMModel::TypeRole) != static_cast<int>(ctkDICOMModel::ImageType)))
       {
+        QString seriesUID = d->seriesUID(index0);
+        if (!seriesUID.isEmpty())
+          {
+          d->SeriesPrefetcher.seriesOpened(seriesUID);
+          }
         this->onModelSelected(index0);
         d->TreeView->setCurrentIndex(index0);
         d->ThumbnailsWidget->addThumbnails(index0);
@@ -743,6 +779,11 @@ Q_D(ctkDICOMAppWidget);
           d->NextStudyButton->hide();
           d->PrevStudyButton->hide();
           }
+        QString seriesUID = d->seriesUID(index0);
+        if (!seriesUID.isEmpty())
+          {
+          d->SeriesPrefetcher.prefetchSeries(seriesUID, ctkDICOMSeriesPrefetcher::SelectionHint);
+          }
         d->ActionRemove->setEnabled(
             model->data(index0,ctkDICOMModel::TypeRole) == static_cast<int>(ctkDICOMModel::SeriesType) ||
             model->data(index0,ctkDICOMModel::TypeRole) == static_cast<int>(ctkDICOMModel::StudyType) ||
@@ -958,6 +999,17 @@ void ctkDICOMAppWidget::onTreeExpanded(const QModelIndex &index){
     d->TreeView->resizeColumnToContents(0);
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMAppWidget::onTreeEntered(const QModelIndex &index)
+{
+  Q_D(ctkDICOMAppWidget);
+  QString seriesUID = d->seriesUID(index);
+  if (!seriesUID.isEmpty())
+    {
+    d->SeriesPrefetcher.prefetchSeries(seriesUID, ctkDICOMSeriesPrefetcher::HoverHint);
+    }
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMAppWidget::onAutoPlayCheckboxStateChanged(int state){
     Q_D(ctkDICOMAppWidget);
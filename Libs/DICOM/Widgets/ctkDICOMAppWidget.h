@@ -30,6 +30,7 @@ class ctkDICOMAppWidgetPrivate;
 class ctkThumbnailLabel;
 class QModelIndex;
 class ctkDICOMDatabase;
+class ctkDICOMSeriesPrefetcher;
 
 /// \ingroup DICOM_Widgets
 class CTK_DICOM_WIDGETS_EXPORT ctkDICOMAppWidget : public QWidget
@@ -68,6 +69,11 @@ public:
   bool searchWidgetPopUpMode();
   ctkDICOMDatabase* database();
 
+  /// Prefetches the files of the selected and hovered series of the tree
+  /// view and keeps track of the series that are opened. The budgets and
+  /// the hit rate statistics can be accessed from it.
+  ctkDICOMSeriesPrefetcher* seriesPrefetcher();
+
   /// Option to show or not import summary dialog.
   /// Since the summary dialog is modal, we give the option
   /// of disabling it for batch modes or testing.
@@ -139,6 +145,9 @@ protected Q_SLOTS:
     /// To be called when an entry of the tree list is expanded
     void onTreeExpanded(const QModelIndex& index);
 
+    /// To be called when the mouse enters an entry of the tree list
+    void onTreeEntered(const QModelIndex& index);
+
     /// To be called when auto-play checkbox state changed
     void onAutoPlayCheckboxStateChanged(int state);
 
@@ -34,6 +34,7 @@
 #include <QProgressDialog>
 #include <QSettings>
 #include <QStringListModel>
+#include <QTimer>
 #include <QWidgetAction>
 
 // ctkWidgets includes
@@ -42,6 +43,7 @@
 #include "ctkMessageBox.h"
 
 // ctkDICOMCore includes
+#include "ctkDICOMBackgroundIndexer.h"
 #include "ctkDICOMDatabase.h"
 #include "ctkDICOMIndexer.h"
 
@@ -51,6 +53,7 @@
 #include "ctkDICOMQueryRetrieveWidget.h"
 #include "ctkDICOMQueryWidget.h"
 #include "ctkDICOMTableManager.h"
+#include "ctkDICOMThumbnailGenerator.h"
 
 #include "ui_ctkDICOMBrowser.h"
 
@@ -73,12 +76,28 @@ public:
 
   QSharedPointer<ctkDICOMDatabase> DICOMDatabase;
   QSharedPointer<ctkDICOMIndexer> DICOMIndexer;
+  QSharedPointer<ctkDICOMBackgroundIndexer> BackgroundIndexer;
   QProgressDialog *IndexerProgress;
+  QProgressDialog *BackgroundIndexerProgress;
   QProgressDialog *UpdateSchemaProgress;
   QProgressDialog *ExportProgress;
+  QProgressDialog *ThumbnailProgress;
+
+  /// Generates the thumbnails of onGenerateThumbnailsAction()
+  QScopedPointer<ctkDICOMThumbnailGenerator> ThumbnailGenerator;
 
   void showIndexerDialog();
+  void showBackgroundIndexerDialog();
   void showUpdateSchemaDialog();
+  void showThumbnailDialog();
+
+  /// Refresh the table views once RefreshTimer times out. Calling it
+  /// again before that does nothing, so that the views are refreshed at
+  /// most once per RefreshTimer interval during a background import.
+  void scheduleTableViewsUpdate();
+
+  bool AsynchronousImport;
+  QTimer* RefreshTimer;
 
   // used when suspending the ctkDICOMModel
   QSqlDatabase EmptyDatabase;
@@ -98,14 +117,19 @@ public:
 ctkDICOMBrowserPrivate::ctkDICOMBrowserPrivate(ctkDICOMBrowser* parent): q_ptr(parent){
   DICOMDatabase = QSharedPointer<ctkDICOMDatabase> (new ctkDICOMDatabase);
   DICOMIndexer = QSharedPointer<ctkDICOMIndexer> (new ctkDICOMIndexer);
+  BackgroundIndexer = QSharedPointer<ctkDICOMBackgroundIndexer> (new ctkDICOMBackgroundIndexer);
   IndexerProgress = 0;
+  BackgroundIndexerProgress = 0;
   UpdateSchemaProgress = 0;
   ExportProgress = 0;
+  ThumbnailProgress = 0;
   DisplayImportSummary = true;
   PatientsAddedDuringImport = 0;
   StudiesAddedDuringImport = 0;
   SeriesAddedDuringImport = 0;
   InstancesAddedDuringImport = 0;
+  AsynchronousImport = false;
+  RefreshTimer = 0;
 }
 
 ctkDICOMBrowserPrivate::~ctkDICOMBrowserPrivate()
@@ -114,6 +138,10 @@ ctkDICOMBrowserPrivate::~ctkDICOMBrowserPrivate()
     {
     delete IndexerProgress;
     }
+  if ( BackgroundIndexerProgress )
+    {
+    delete BackgroundIndexerProgress;
+    }
   if ( UpdateSchemaProgress )
     {
     delete UpdateSchemaProgress;
@@ -122,6 +150,10 @@ ctkDICOMBrowserPrivate::~ctkDICOMBrowserPrivate()
     {
     delete ExportProgress;
     }
+  if ( ThumbnailProgress )
+    {
+    delete ThumbnailProgress;
+    }
 }
 
 void ctkDICOMBrowserPrivate::showUpdateSchemaDialog()
@@ -203,6 +235,79 @@ void ctkDICOMBrowserPrivate::showIndexerDialog()
   IndexerProgress->show();
 }
 
+void ctkDICOMBrowserPrivate::showBackgroundIndexerDialog()
+{
+  Q_Q(ctkDICOMBrowser);
+  if (BackgroundIndexerProgress == 0)
+    {
+    //
+    // Set up the Background Indexer Progress Dialog
+    //
+    BackgroundIndexerProgress = new QProgressDialog( q->tr("DICOM Import"), "Cancel", 0, 100, q,
+         Qt::WindowTitleHint | Qt::WindowSystemMenuHint);
+
+    // We don't want the progress dialog to resize itself, so we bypass the label
+    // by creating our own
+    QLabel* progressLabel = new QLabel(q->tr("Initialization..."));
+    BackgroundIndexerProgress->setLabel(progressLabel);
+    // the import runs in the background, the browser remains usable
+    BackgroundIndexerProgress->setWindowModality(Qt::NonModal);
+    BackgroundIndexerProgress->setAutoClose(false);
+    BackgroundIndexerProgress->setAutoReset(false);
+    BackgroundIndexerProgress->setMinimumDuration(0);
+    BackgroundIndexerProgress->setValue(0);
+
+    q->connect(BackgroundIndexerProgress, SIGNAL(canceled()),
+            BackgroundIndexer.data(), SLOT(cancel()));
+
+    q->connect(BackgroundIndexer.data(), SIGNAL(progress(int)),
+            BackgroundIndexerProgress, SLOT(setValue(int)));
+    q->connect(BackgroundIndexer.data(), SIGNAL(indexingFilePath(QString)),
+            progressLabel, SLOT(setText(QString)));
+
+    // close the dialog once all the queued directories are imported
+    q->connect(BackgroundIndexer.data(), SIGNAL(allIndexingComplete()),
+            BackgroundIndexerProgress, SLOT(close()));
+    }
+  BackgroundIndexerProgress->show();
+}
+
+void ctkDICOMBrowserPrivate::showThumbnailDialog()
+{
+  Q_Q(ctkDICOMBrowser);
+  if (ThumbnailProgress == 0)
+    {
+    //
+    // Set up the Thumbnail Progress Dialog
+    //
+    ThumbnailProgress = new QProgressDialog( q->tr("DICOM Thumbnails"), "Cancel", 0, 100, q,
+         Qt::WindowTitleHint | Qt::WindowSystemMenuHint);
+
+    // We don't want the progress dialog to resize itself, so we bypass the label
+    // by creating our own
+    QLabel* progressLabel = new QLabel(q->tr("Initialization..."));
+    ThumbnailProgress->setLabel(progressLabel);
+    // the thumbnails are generated in the background, the browser remains usable
+    ThumbnailProgress->setWindowModality(Qt::NonModal);
+    ThumbnailProgress->setAutoClose(false);
+    ThumbnailProgress->setAutoReset(false);
+    ThumbnailProgress->setMinimumDuration(0);
+
+    q->connect(ThumbnailProgress, SIGNAL(canceled()),
+            ThumbnailGenerator.data(), SLOT(cancelBatch()));
+    }
+  ThumbnailProgress->setValue(0);
+  ThumbnailProgress->show();
+}
+
+void ctkDICOMBrowserPrivate::scheduleTableViewsUpdate()
+{
+  if (!RefreshTimer->isActive())
+    {
+    RefreshTimer->start();
+    }
+}
+
 //----------------------------------------------------------------------------
 // ctkDICOMBrowser methods
 
@@ -214,6 +319,12 @@ ctkDICOMBrowser::ctkDICOMBrowser(QWidget* _parent):Superclass(_parent),
 
   d->setupUi(this);
 
+  d->ThumbnailGenerator.reset(new ctkDICOMThumbnailGenerator);
+  connect(d->ThumbnailGenerator.data(), SIGNAL(batchProgress(int,int,double)),
+          this, SLOT(onThumbnailBatchProgress(int,int,double)));
+  connect(d->ThumbnailGenerator.data(), SIGNAL(batchFinished(int)),
+          this, SLOT(onThumbnailBatchFinished(int)));
+
   // signals related to tracking inserts
   connect(d->DICOMDatabase.data(), SIGNAL(patientAdded(int,QString,QString,QString)), this,
                               SLOT(onPatientAdded(int,QString,QString,QString)));
@@ -221,6 +332,19 @@ ctkDICOMBrowser::ctkDICOMBrowser(QWidget* _parent):Superclass(_parent),
   connect(d->DICOMDatabase.data(), SIGNAL(seriesAdded(QString)), this, SLOT(onSeriesAdded(QString)));
   connect(d->DICOMDatabase.data(), SIGNAL(instanceAdded(QString)), this, SLOT(onInstanceAdded(QString)));
 
+  // signals related to tracking background inserts, they are batched
+  connect(d->BackgroundIndexer.data(), SIGNAL(patientsAdded(QStringList)), this, SLOT(onPatientsAdded(QStringList)));
+  connect(d->BackgroundIndexer.data(), SIGNAL(studiesAdded(QStringList)), this, SLOT(onStudiesAdded(QStringList)));
+  connect(d->BackgroundIndexer.data(), SIGNAL(seriesAdded(QStringList)), this, SLOT(onSeriesAdded(QStringList)));
+  connect(d->BackgroundIndexer.data(), SIGNAL(instancesAdded(QStringList)), this, SLOT(onInstancesAdded(QStringList)));
+  connect(d->BackgroundIndexer.data(), SIGNAL(allIndexingComplete()), this, SLOT(onBackgroundImportFinished()));
+
+  // the views are refreshed at most every 300ms while importing in the background
+  d->RefreshTimer = new QTimer(this);
+  d->RefreshTimer->setSingleShot(true);
+  d->RefreshTimer->setInterval(300);
+  connect(d->RefreshTimer, SIGNAL(timeout()), this, SLOT(onRefreshTableViews()));
+
   connect(d->tableDensityComboBox ,SIGNAL(currentIndexChanged (const QString&)),
      this, SLOT(onTablesDensityComboBox(QString)));
 
@@ -285,6 +409,8 @@ ctkDICOMBrowser::~ctkDICOMBrowser()
 {
   Q_D(ctkDICOMBrowser);
 
+  d->BackgroundIndexer->cancel();
+  d->ThumbnailGenerator->cancelBatch();
   d->QueryRetrieveWidget->deleteLater();
   d->ImportDialog->deleteLater();
 }
@@ -305,6 +431,38 @@ void ctkDICOMBrowser::setDisplayImportSummary(bool onOff)
   d->DisplayImportSummary = onOff;
 }
 
+//----------------------------------------------------------------------------
+bool ctkDICOMBrowser::asynchronousImport()const
+{
+  Q_D(const ctkDICOMBrowser);
+
+  return d->AsynchronousImport;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::setAsynchronousImport(bool onOff)
+{
+  Q_D(ctkDICOMBrowser);
+
+  d->AsynchronousImport = onOff;
+}
+
+//----------------------------------------------------------------------------
+bool ctkDICOMBrowser::isImporting()const
+{
+  Q_D(const ctkDICOMBrowser);
+
+  return d->BackgroundIndexer->isIndexing();
+}
+
+//----------------------------------------------------------------------------
+ctkDICOMBackgroundIndexer* ctkDICOMBrowser::backgroundIndexer()
+{
+  Q_D(ctkDICOMBrowser);
+
+  return d->BackgroundIndexer.data();
+}
+
 //----------------------------------------------------------------------------
 int ctkDICOMBrowser::patientsAddedDuringImport()
 {
@@ -466,21 +624,11 @@ void ctkDICOMBrowser::onRemoveAction()
 {
   Q_D(ctkDICOMBrowser);
   QStringList selectedSeriesUIDs = d->dicomTableManager->currentSeriesSelection();
-
-  foreach (const QString& uid, selectedSeriesUIDs)
-    {
-      d->DICOMDatabase->removeSeries(uid);
-    }
+  d->DICOMDatabase->removeSeries(selectedSeriesUIDs);
   QStringList selectedStudiesUIDs = d->dicomTableManager->currentStudiesSelection();
-  foreach (const QString& uid, selectedStudiesUIDs)
-    {
-      d->DICOMDatabase->removeStudy(uid);
-    }
+  d->DICOMDatabase->removeStudies(selectedStudiesUIDs);
   QStringList selectedPatientUIDs = d->dicomTableManager->currentPatientsSelection();
-  foreach (const QString& uid, selectedPatientUIDs)
-    {
-      d->DICOMDatabase->removePatient(uid);
-    }
+  d->DICOMDatabase->removePatients(selectedPatientUIDs);
   // Update the table views
   d->dicomTableManager->updateTableViews();
 }
@@ -553,6 +701,51 @@ void ctkDICOMBrowser::onRepairAction()
     }
   }
 }
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::onGenerateThumbnailsAction()
+{
+  Q_D(ctkDICOMBrowser);
+  if (d->ThumbnailGenerator->isBatchRunning())
+    {
+    d->showThumbnailDialog();
+    return;
+    }
+  const int seriesCount = d->ThumbnailGenerator->generateSeriesThumbnails(d->DICOMDatabase.data());
+  if (seriesCount == 0)
+    {
+    QMessageBox::information(this, "DICOM Thumbnails", "The database does not contain any series.");
+    return;
+    }
+  d->showThumbnailDialog();
+  d->ThumbnailProgress->setMaximum(seriesCount);
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::onThumbnailBatchProgress(int processedSeries, int totalSeries,
+                                               double imagesPerSecond)
+{
+  Q_D(ctkDICOMBrowser);
+  if (!d->ThumbnailProgress || !d->ThumbnailProgress->isVisible())
+    {
+    return;
+    }
+  d->ThumbnailProgress->setMaximum(totalSeries);
+  d->ThumbnailProgress->setValue(processedSeries);
+  d->ThumbnailProgress->setLabelText(tr("%1 of %2 series, %3 images/s")
+    .arg(processedSeries).arg(totalSeries).arg(imagesPerSecond, 0, 'f', 1));
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::onThumbnailBatchFinished(int generatedThumbnails)
+{
+  Q_D(ctkDICOMBrowser);
+  Q_UNUSED(generatedThumbnails);
+  if (d->ThumbnailProgress)
+    {
+    d->ThumbnailProgress->close();
+    }
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMBrowser::onTablesDensityComboBox(QString density)
 {
@@ -607,6 +800,66 @@ void ctkDICOMBrowser::onInstanceAdded(QString instanceUID)
   ++d->InstancesAddedDuringImport;
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::onPatientsAdded(QStringList patientIDs)
+{
+  Q_D(ctkDICOMBrowser);
+  d->PatientsAddedDuringImport += patientIDs.count();
+  d->scheduleTableViewsUpdate();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::onStudiesAdded(QStringList studyUIDs)
+{
+  Q_D(ctkDICOMBrowser);
+  d->StudiesAddedDuringImport += studyUIDs.count();
+  d->scheduleTableViewsUpdate();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::onSeriesAdded(QStringList seriesUIDs)
+{
+  Q_D(ctkDICOMBrowser);
+  d->SeriesAddedDuringImport += seriesUIDs.count();
+  d->scheduleTableViewsUpdate();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::onInstancesAdded(QStringList instanceUIDs)
+{
+  Q_D(ctkDICOMBrowser);
+  d->InstancesAddedDuringImport += instanceUIDs.count();
+  d->scheduleTableViewsUpdate();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::onRefreshTableViews()
+{
+  Q_D(ctkDICOMBrowser);
+  d->dicomTableManager->refreshTableViews();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMBrowser::onBackgroundImportFinished()
+{
+  Q_D(ctkDICOMBrowser);
+
+  d->RefreshTimer->stop();
+  d->dicomTableManager->refreshTableViews();
+  emit directoryImported();
+
+  // display summary result
+  if (d->DisplayImportSummary)
+  {
+    QString message = "Directory import completed.\n\n";
+    message += QString("%1 New Patients\n").arg(QString::number(d->PatientsAddedDuringImport));
+    message += QString("%1 New Studies\n").arg(QString::number(d->StudiesAddedDuringImport));
+    message += QString("%1 New Series\n").arg(QString::number(d->SeriesAddedDuringImport));
+    message += QString("%1 New Instances\n").arg(QString::number(d->InstancesAddedDuringImport));
+    QMessageBox::information(this,"DICOM Directory Import", message);
+  }
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMBrowser::onImportDirectory(QString directory)
 {
@@ -637,17 +890,29 @@ void ctkDICOMBrowser::onImportDirectory(QString directory)
       copyOnImport->setCheckState(Qt::Unchecked);
     }
 
-    // reset counts
-    d->PatientsAddedDuringImport = 0;
-    d->StudiesAddedDuringImport = 0;
-    d->SeriesAddedDuringImport = 0;
-    d->InstancesAddedDuringImport = 0;
+    // reset counts, unless directories are still being imported in the
+    // background in which case the summary covers all of them
+    if (!d->BackgroundIndexer->isIndexing())
+    {
+      d->PatientsAddedDuringImport = 0;
+      d->StudiesAddedDuringImport = 0;
+      d->SeriesAddedDuringImport = 0;
+      d->InstancesAddedDuringImport = 0;
+    }
 
     if (copyOnImport->checkState() == Qt::Checked)
     {
       targetDirectory = d->DICOMDatabase->databaseDirectory();
     }
 
+    if (d->AsynchronousImport)
+    {
+      // the summary is displayed by onBackgroundImportFinished()
+      d->showBackgroundIndexerDialog();
+      d->BackgroundIndexer->addDirectory(*d->DICOMDatabase,directory,targetDirectory);
+      return;
+    }
+
     // show progress dialog and perform indexing
     d->showIndexerDialog();
     d->DICOMIndexer->addDirectory(*d->DICOMDatabase,directory,targetDirectory);
@@ -774,11 +1039,8 @@ void ctkDICOMBrowser::onPatientsRightClicked(const QPoint &point)
       && this->confirmDeleteSelectedUIDs(selectedPatientsUIDs))
     {
     qDebug() << "Deleting " << numPatients << " patients";
-    foreach (const QString& uid, selectedPatientsUIDs)
-      {
-      d->DICOMDatabase->removePatient(uid);
-      d->dicomTableManager->updateTableViews();
-      }
+    d->DICOMDatabase->removePatients(selectedPatientsUIDs);
+    d->dicomTableManager->updateTableViews();
     }
   else if (selectedAction == exportAction)
     {
@@ -834,11 +1096,8 @@ void ctkDICOMBrowser::onStudiesRightClicked(const QPoint &point)
   if (selectedAction == deleteAction
       && this->confirmDeleteSelectedUIDs(selectedStudiesUIDs))
     {
-    foreach (const QString& uid, selectedStudiesUIDs)
-      {
-      d->DICOMDatabase->removeStudy(uid);
-      d->dicomTableManager->updateTableViews();
-      }
+    d->DICOMDatabase->removeStudies(selectedStudiesUIDs);
+    d->dicomTableManager->updateTableViews();
     }
   else if (selectedAction == exportAction)
     {
@@ -893,11 +1152,8 @@ void ctkDICOMBrowser::onSeriesRightClicked(const QPoint &point)
   if (selectedAction == deleteAction
       && this->confirmDeleteSelectedUIDs(selectedSeriesUIDs))
     {
-    foreach (const QString& uid, selectedSeriesUIDs)
-      {
-      d->DICOMDatabase->removeSeries(uid);
-      d->dicomTableManager->updateTableViews();
-      }
+    d->DICOMDatabase->removeSeries(selectedSeriesUIDs);
+    d->dicomTableManager->updateTableViews();
     }
   else if (selectedAction == exportAction)
     {
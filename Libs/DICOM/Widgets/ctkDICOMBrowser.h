@@ -27,6 +27,7 @@
 
 #include "ctkDICOMWidgetsExport.h"
 
+class ctkDICOMBackgroundIndexer;
 class ctkDICOMBrowserPrivate;
 class ctkThumbnailLabel;
 class QMenu;
@@ -42,6 +43,7 @@ class CTK_DICOM_WIDGETS_EXPORT ctkDICOMBrowser : public QWidget
   Q_PROPERTY(QString databaseDirectory READ databaseDirectory WRITE setDatabaseDirectory)
   Q_PROPERTY(QStringList tagsToPrecache READ tagsToPrecache WRITE setTagsToPrecache)
   Q_PROPERTY(bool displayImportSummary READ displayImportSummary WRITE setDisplayImportSummary)
+  Q_PROPERTY(bool asynchronousImport READ asynchronousImport WRITE setAsynchronousImport)
   Q_PROPERTY(ctkDICOMTableManager* dicomTableManager READ dicomTableManager)
 
 public:
@@ -73,6 +75,19 @@ public:
   /// of disabling it for batch modes or testing.
   void setDisplayImportSummary(bool);
   bool displayImportSummary();
+
+  /// Option to import directories on a worker thread. The import dialog
+  /// is then not modal, the browser can be used while the files are being
+  /// imported and the tables are refreshed as the data arrives.
+  /// The directories imported this way are queued, directoryImported() is
+  /// emitted once all of them are imported. Disabled by default.
+  /// \sa ctkDICOMBackgroundIndexer
+  void setAsynchronousImport(bool);
+  bool asynchronousImport()const;
+  /// Returns true while a background import is running.
+  bool isImporting()const;
+  ctkDICOMBackgroundIndexer* backgroundIndexer();
+
   /// Accessors to status of last directory import operation
   int patientsAddedDuringImport();
   int studiesAddedDuringImport();
@@ -88,6 +103,10 @@ public Q_SLOTS:
   void openQueryDialog();
   void onRemoveAction();
   void onRepairAction();
+  /// Generate the missing series thumbnails of the database in the
+  /// background, with a progress dialog.
+  /// \sa ctkDICOMThumbnailGenerator::generateSeriesThumbnails()
+  void onGenerateThumbnailsAction();
 
   void onTablesDensityComboBox(QString);
 
@@ -103,6 +122,12 @@ public Q_SLOTS:
   void onSeriesAdded(QString);
   void onInstanceAdded(QString);
 
+  /// slots to capture the batched status updates of a background import
+  void onPatientsAdded(QStringList);
+  void onStudiesAdded(QStringList);
+  void onSeriesAdded(QStringList);
+  void onInstancesAdded(QStringList);
+
 Q_SIGNALS:
   /// Emited when directory is changed
   void databaseDirectoryChanged(const QString&);
@@ -125,6 +150,10 @@ protected:
 protected Q_SLOTS:
     void onModelSelected(const QItemSelection&, const QItemSelection&);
 
+    /// Update the thumbnail progress dialog
+    void onThumbnailBatchProgress(int processedSeries, int totalSeries, double imagesPerSecond);
+    void onThumbnailBatchFinished(int generatedThumbnails);
+
     /// Called when a right mouse click is made in the patients table
     void onPatientsRightClicked(const QPoint &point);
 
@@ -147,6 +176,12 @@ protected Q_SLOTS:
     /// To be called when dialog finishes
     void onQueryRetrieveFinished();
 
+    /// Called when all the directories queued for background import are imported
+    void onBackgroundImportFinished();
+
+    /// Called when the refresh timer times out during a background import
+    void onRefreshTableViews();
+
 private:
   Q_DECLARE_PRIVATE(ctkDICOMBrowser);
   Q_DISABLE_COPY(ctkDICOMBrowser);
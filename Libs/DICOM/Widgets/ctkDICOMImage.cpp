@@ -20,8 +20,13 @@
 =========================================================================*/
 
 // Qt includes
+#include <QCache>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
 #include <QString>
+#include <QThreadPool>
 
 // ctkDICOMCore includes
 #include "ctkDICOMImage.h"
@@ -43,6 +48,30 @@ public:
 
   ::DicomImage* DicomImage;
 
+  /// Protects DicomImage, which is used by the prefetching thread
+  QMutex DicomImageMutex;
+  /// Key of frame in FrameCache for the current window
+  QString frameKey(int frame);
+  /// Convert frame, returns the key of the converted frame in key
+  QImage convertFrame(int frame, QString& key);
+
+  /// Protects the members below
+  QMutex CacheMutex;
+  /// Frames by frameKey(), the cost is the size of the frame in kilobytes
+  QCache<QString, QImage> FrameCache;
+  int PrefetchFrameCount;
+  int LastFrame;
+  /// Incremented when the prefetched frames are not wanted anymore
+  int PrefetchGeneration;
+  /// Insert image in the cache if it is not disabled
+  void cacheFrame(const QString& key, const QImage& image);
+
+  /// Prefetch the frames after frame in the scroll direction
+  void prefetch(int frame, int direction);
+  /// Called from the prefetching thread
+  void prefetchFrame(int frame, int generation);
+  QThreadPool PrefetchPool;
+
 protected:
   ctkDICOMImage* const q_ptr;
 
@@ -50,9 +79,145 @@ private:
   Q_DISABLE_COPY(ctkDICOMImagePrivate);
 };
 
+//------------------------------------------------------------------------------
+class ctkDICOMImagePrefetchTask : public QRunnable
+{
+public:
+  ctkDICOMImagePrefetchTask(ctkDICOMImagePrivate* image, int frame, int generation)
+    : Image(image)
+    , Frame(frame)
+    , Generation(generation)
+  {
+  }
+
+  virtual void run()
+  {
+    this->Image->prefetchFrame(this->Frame, this->Generation);
+  }
+
+private:
+  ctkDICOMImagePrivate* Image;
+  int Frame;
+  int Generation;
+};
+
 //------------------------------------------------------------------------------
 ctkDICOMImagePrivate::ctkDICOMImagePrivate(ctkDICOMImage& o):q_ptr(&o)
 {
+  this->DicomImage = 0;
+  this->FrameCache.setMaxCost(64 * 1024);
+  this->PrefetchFrameCount = 4;
+  this->LastFrame = -1;
+  this->PrefetchGeneration = 0;
+  this->PrefetchPool.setMaxThreadCount(1);
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMImagePrivate::frameKey(int frame)
+{
+  double center = 0.;
+  double width = 0.;
+  // only monochrome images have a window
+  this->DicomImage->getWindow(center, width);
+  return QString("%1/%2/%3").arg(frame).arg(center).arg(width);
+}
+
+//------------------------------------------------------------------------------
+QImage ctkDICOMImagePrivate::convertFrame(int frame, QString& key)
+{
+  QMutexLocker locker(&this->DicomImageMutex);
+
+  // this way of converting the dicom image to a qpixmap was adopted from some code from
+  // the DCMTK forum, posted by Joerg Riesmayer, see http://forum.dcmtk.org/viewtopic.php?t=120
+  QImage image;
+  if ((this->DicomImage != NULL) && (this->DicomImage->getStatus() == EIS_Normal))
+    {
+    key = this->frameKey(frame);
+    /* get image extension */
+    const unsigned long width = this->DicomImage->getWidth();
+    const unsigned long height = this->DicomImage->getHeight();
+    QString header = QString("P5 %1 %2 255\n").arg(width).arg(height);
+    const unsigned long offset = header.length();
+    const unsigned long length = width * height + offset;
+    /* create output buffer for DicomImage class */
+    QByteArray buffer;
+    buffer.append(header);
+    buffer.resize(length);
+
+    /* copy PGM header to buffer */
+
+    if (this->DicomImage->getOutputData(static_cast<void *>(buffer.data() + offset), length - offset, 8, frame))
+      {
+
+      if (!image.loadFromData( buffer ))
+        {
+        logger.error("QImage couldn't created");
+        }
+      }
+    }
+  return image;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImagePrivate::cacheFrame(const QString& key, const QImage& image)
+{
+  // called with CacheMutex locked
+  if (image.isNull() || this->FrameCache.maxCost() <= 0)
+    {
+    return;
+    }
+  this->FrameCache.insert(key, new QImage(image), qMax(1, image.byteCount() / 1024));
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImagePrivate::prefetch(int frame, int direction)
+{
+  int generation;
+  {
+  QMutexLocker locker(&this->CacheMutex);
+  if (this->FrameCache.maxCost() <= 0)
+    {
+    return;
+    }
+  generation = this->PrefetchGeneration;
+  }
+  const int frameCount = static_cast<int>(this->DicomImage->getFrameCount());
+  for (int i = 1; i <= this->PrefetchFrameCount; ++i)
+    {
+    int nextFrame = frame + i * direction;
+    if (nextFrame < 0 || nextFrame >= frameCount)
+      {
+      break;
+      }
+    this->PrefetchPool.start(new ctkDICOMImagePrefetchTask(this, nextFrame, generation));
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImagePrivate::prefetchFrame(int frame, int generation)
+{
+  {
+  QMutexLocker locker(&this->CacheMutex);
+  if (generation != this->PrefetchGeneration)
+    {
+    return;
+    }
+  }
+  QString key;
+  {
+  QMutexLocker locker(&this->DicomImageMutex);
+  key = this->frameKey(frame);
+  }
+  {
+  QMutexLocker locker(&this->CacheMutex);
+  if (this->FrameCache.contains(key))
+    {
+    return;
+    }
+  }
+  QImage image = this->convertFrame(frame, key);
+  QMutexLocker locker(&this->CacheMutex);
+  this->cacheFrame(key, image);
 }
 
 //------------------------------------------------------------------------------
@@ -81,6 +246,12 @@ ctkDICOMImage::ctkDICOMImage(DicomImage* dicomImage, QObject* parentValue)
 //------------------------------------------------------------------------------
 ctkDICOMImage::~ctkDICOMImage()
 {
+  Q_D(ctkDICOMImage);
+  {
+  QMutexLocker locker(&d->CacheMutex);
+  ++d->PrefetchGeneration;
+  }
+  d->PrefetchPool.waitForDone();
 }
 
 //------------------------------------------------------------------------------
@@ -104,34 +275,111 @@ DicomImage* ctkDICOMImage::dicomImage() const
 //------------------------------------------------------------------------------
 QImage ctkDICOMImage::frame(int frame) const
 {
-  Q_D(const ctkDICOMImage);
+  ctkDICOMImagePrivate* d = const_cast<ctkDICOMImagePrivate*>(this->d_func());
+  if (!d->DicomImage)
+    {
+    return QImage();
+    }
+
+  QString key;
+  {
+  QMutexLocker locker(&d->DicomImageMutex);
+  key = d->frameKey(frame);
+  }
 
-  // this way of converting the dicom image to a qpixmap was adopted from some code from
-  // the DCMTK forum, posted by Joerg Riesmayer, see http://forum.dcmtk.org/viewtopic.php?t=120
   QImage image;
-  if ((d->DicomImage != NULL) && (d->DicomImage->getStatus() == EIS_Normal))
+  int direction = 0;
+  {
+  QMutexLocker locker(&d->CacheMutex);
+  if (d->LastFrame >= 0 && frame != d->LastFrame)
     {
-    /* get image extension */
-    const unsigned long width = d->DicomImage->getWidth();
-    const unsigned long height = d->DicomImage->getHeight();
-    QString header = QString("P5 %1 %2 255\n").arg(width).arg(height);
-    const unsigned long offset = header.length();
-    const unsigned long length = width * height + offset;
-    /* create output buffer for DicomImage class */
-    QByteArray buffer;
-    buffer.append(header);
-    buffer.resize(length);
+    direction = frame > d->LastFrame ? 1 : -1;
+    }
+  d->LastFrame = frame;
+  // the frames prefetched in the other direction are not needed anymore
+  ++d->PrefetchGeneration;
+  QImage* cachedImage = d->FrameCache.object(key);
+  if (cachedImage)
+    {
+    image = *cachedImage;
+    }
+  }
 
-    /* copy PGM header to buffer */
+  if (image.isNull())
+    {
+    image = d->convertFrame(frame, key);
+    QMutexLocker locker(&d->CacheMutex);
+    d->cacheFrame(key, image);
+    }
+  if (direction != 0)
+    {
+    d->prefetch(frame, direction);
+    }
+  return image;
+}
 
-    if (d->DicomImage->getOutputData(static_cast<void *>(buffer.data() + offset), length - offset, 8, frame))
-      {
+//------------------------------------------------------------------------------
+void ctkDICOMImage::setFrameCacheSize(int kilobytes)
+{
+  Q_D(ctkDICOMImage);
+  QMutexLocker locker(&d->CacheMutex);
+  d->FrameCache.setMaxCost(qMax(0, kilobytes));
+}
 
-      if (!image.loadFromData( buffer ))
-        {
-        logger.error("QImage couldn't created");
-        }
-      }
+//------------------------------------------------------------------------------
+int ctkDICOMImage::frameCacheSize() const
+{
+  Q_D(const ctkDICOMImage);
+  QMutexLocker locker(const_cast<QMutex*>(&d->CacheMutex));
+  return d->FrameCache.maxCost();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMImage::frameCacheUsage() const
+{
+  Q_D(const ctkDICOMImage);
+  QMutexLocker locker(const_cast<QMutex*>(&d->CacheMutex));
+  return d->FrameCache.totalCost();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImage::setPrefetchFrameCount(int count)
+{
+  Q_D(ctkDICOMImage);
+  d->PrefetchFrameCount = qMax(0, count);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMImage::prefetchFrameCount() const
+{
+  Q_D(const ctkDICOMImage);
+  return d->PrefetchFrameCount;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImage::setWindow(double center, double width)
+{
+  Q_D(ctkDICOMImage);
+  if (!d->DicomImage)
+    {
+    return;
     }
-  return image;
+  QMutexLocker locker(&d->DicomImageMutex);
+  d->DicomImage->setWindow(center, width);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImage::waitForPrefetch()
+{
+  Q_D(ctkDICOMImage);
+  d->PrefetchPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImage::clearFrameCache()
+{
+  Q_D(ctkDICOMImage);
+  QMutexLocker locker(&d->CacheMutex);
+  ++d->PrefetchGeneration;
+  d->FrameCache.clear();
 }
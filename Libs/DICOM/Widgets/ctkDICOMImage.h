@@ -37,10 +37,19 @@ class DicomImage;
 ///
 /// This class wraps a DicomImage object and exposes it as a Qt class.
 ///
+/// The converted frames are cached by frame and window, and the frames
+/// following the requested one in the direction of the last requests are
+/// converted in advance on a worker thread, see prefetchFrameCount.
+/// The DicomImage must not be modified while frames are being prefetched:
+/// use setWindow() or call waitForPrefetch() first.
+///
 class CTK_DICOM_WIDGETS_EXPORT ctkDICOMImage : public QObject
 {
   Q_OBJECT
   Q_PROPERTY(unsigned long frameCount READ frameCount);
+  Q_PROPERTY(int frameCacheSize READ frameCacheSize WRITE setFrameCacheSize);
+  Q_PROPERTY(int frameCacheUsage READ frameCacheUsage);
+  Q_PROPERTY(int prefetchFrameCount READ prefetchFrameCount WRITE setPrefetchFrameCount);
 public:
   ///  \brief Construct a ctkDICOMImage
   /// The dicomImage pointer must remain valid during all the life of
@@ -73,6 +82,41 @@ public:
   ///
   unsigned long frameCount() const;
 
+  ///
+  /// \brief Maximum memory used by the cached frames, in kilobytes.
+  /// 64 MB by default, 0 disables the cache and the prefetching.
+  ///
+  void setFrameCacheSize(int kilobytes);
+  int frameCacheSize() const;
+
+  ///
+  /// \brief Memory used by the cached frames, in kilobytes.
+  ///
+  int frameCacheUsage() const;
+
+  ///
+  /// \brief Number of frames converted in advance, 4 by default.
+  ///
+  void setPrefetchFrameCount(int count);
+  int prefetchFrameCount() const;
+
+  ///
+  /// \brief Set the VOI window of a monochrome image.
+  /// The cached frames of the other windows are kept.
+  /// \sa DicomImage::setWindow()
+  ///
+  void setWindow(double center, double width);
+
+  ///
+  /// \brief Wait for the frames being prefetched to be converted.
+  ///
+  void waitForPrefetch();
+
+  ///
+  /// \brief Remove the cached frames.
+  ///
+  void clearFrameCache();
+
 protected:
   QScopedPointer<ctkDICOMImagePrivate> d_ptr;
 
@@ -44,7 +44,9 @@
 #include <QLabel>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QPersistentModelIndex>
 #include <QResizeEvent>
+#include <QVector>
 
 static ctkLogger logger("org.commontk.DICOM.Widgets.ctkDICOMItemView");
 
@@ -65,9 +67,27 @@ public:
   double DicomIntensityWindow;
   bool AutoWindowLevel;
 
+  /// Pixels of RawImageIndex rendered once at 16 bits with a window
+  /// covering all the modality values, so that interactive window/level
+  /// changes are applied through a lookup table instead of DCMTK.
+  QPersistentModelIndex RawImageIndex;
+  QVector<quint16> RawPixels;
+  int RawWidth;
+  int RawHeight;
+  double RawWindowCenter;
+  double RawWindowWidth;
+  bool RawInverted;
+
   void init();
 
+  QString dicomPath(const QModelIndex& imageIndex);
   void setImage(const QModelIndex& imageIndex, bool defaultIntensity = true);
+  /// Render the 16 bits pixels of a monochrome image, returns false otherwise
+  bool loadRawPixels(const QModelIndex& imageIndex);
+  /// Display the current image with DicomIntensityLevel and
+  /// DicomIntensityWindow applied on the 16 bits pixels.
+  /// Returns false if the fast path can't be used for the image.
+  bool applyWindowLevel();
 
   void onPatientModelSelected(const QModelIndex& index);
   void onStudyModelSelected(const QModelIndex& index);
@@ -84,7 +104,12 @@ private:
 //--------------------------------------------------------------------------
 ctkDICOMItemViewPrivate::ctkDICOMItemViewPrivate(
   ctkDICOMItemView& object )
-  : q_ptr( & object )
+  : RawWidth(0)
+  , RawHeight(0)
+  , RawWindowCenter(0.)
+  , RawWindowWidth(1.)
+  , RawInverted(false)
+  , q_ptr( & object )
 {
 }
 
@@ -110,6 +135,19 @@ void ctkDICOMItemViewPrivate::init()
   */
 }
 
+// -------------------------------------------------------------------------
+QString ctkDICOMItemViewPrivate::dicomPath(const QModelIndex &imageIndex){
+    const QAbstractItemModel* model = imageIndex.model();
+    QModelIndex seriesIndex = imageIndex.parent();
+    QModelIndex studyIndex = seriesIndex.parent();
+
+    QString dicomPath = this->DatabaseDirectory;
+    dicomPath.append("/dicom/").append(model->data(studyIndex ,ctkDICOMModel::UIDRole).toString());
+    dicomPath.append("/").append(model->data(seriesIndex ,ctkDICOMModel::UIDRole).toString());
+    dicomPath.append("/").append(model->data(imageIndex ,ctkDICOMModel::UIDRole).toString());
+    return dicomPath;
+}
+
 // -------------------------------------------------------------------------
 void ctkDICOMItemViewPrivate::setImage(const QModelIndex &imageIndex, bool defaultIntensity){
     Q_Q(ctkDICOMItemView);
@@ -118,12 +156,7 @@ void ctkDICOMItemViewPrivate::setImage(const QModelIndex &imageIndex, bool defau
 
     if(model){
         QModelIndex seriesIndex = imageIndex.parent();
-        QModelIndex studyIndex = seriesIndex.parent();
-
-        QString dicomPath = this->DatabaseDirectory;
-        dicomPath.append("/dicom/").append(model->data(studyIndex ,ctkDICOMModel::UIDRole).toString());
-        dicomPath.append("/").append(model->data(seriesIndex ,ctkDICOMModel::UIDRole).toString());
-        dicomPath.append("/").append(model->data(imageIndex ,ctkDICOMModel::UIDRole).toString());
+        QString dicomPath = this->dicomPath(imageIndex);
 
         if (QFile(dicomPath).exists()){
           DicomImage dcmImage(  QDir::toNativeSeparators(dicomPath).toStdString().c_str() );
@@ -139,6 +172,88 @@ void ctkDICOMItemViewPrivate::setImage(const QModelIndex &imageIndex, bool defau
     }
 }
 
+// -------------------------------------------------------------------------
+bool ctkDICOMItemViewPrivate::loadRawPixels(const QModelIndex &imageIndex){
+    this->RawImageIndex = QPersistentModelIndex();
+    this->RawPixels.clear();
+    if (!imageIndex.model()){
+        return false;
+    }
+    DicomImage dcmImage( QDir::toNativeSeparators(this->dicomPath(imageIndex)).toStdString().c_str() );
+    double minimum = 0.;
+    double maximum = 0.;
+    if (dcmImage.getStatus() != EIS_Normal || !dcmImage.isMonochrome()
+        || !dcmImage.getMinMaxValues(minimum, maximum)){
+        return false;
+    }
+    // linear VOI window whose edges are the extreme modality values,
+    // it is inverted when the window/level is applied
+    this->RawWindowWidth = maximum - minimum + 1.;
+    this->RawWindowCenter = minimum + this->RawWindowWidth / 2.;
+    dcmImage.setWindow(this->RawWindowCenter, this->RawWindowWidth);
+    this->RawWidth = static_cast<int>(dcmImage.getWidth());
+    this->RawHeight = static_cast<int>(dcmImage.getHeight());
+    // MONOCHROME1 images are inverted by DCMTK
+    this->RawInverted = (dcmImage.getPhotometricInterpretation() == EPI_Monochrome1);
+    this->RawPixels.resize(this->RawWidth * this->RawHeight);
+    if (!dcmImage.getOutputData(static_cast<void *>(this->RawPixels.data()),
+                                this->RawPixels.size() * sizeof(quint16), 16, 0)){
+        this->RawPixels.clear();
+        return false;
+    }
+    this->RawImageIndex = imageIndex;
+    return true;
+}
+
+// -------------------------------------------------------------------------
+bool ctkDICOMItemViewPrivate::applyWindowLevel(){
+    Q_Q(ctkDICOMItemView);
+
+    if (!this->CurrentImageIndex.isValid()){
+        return false;
+    }
+    if (this->RawImageIndex != this->CurrentImageIndex
+        && !this->loadRawPixels(this->CurrentImageIndex)){
+        return false;
+    }
+
+    // lookup table from the 16 bits pixels to the displayed 8 bits
+    // values, computed like the linear VOI function of DCMTK
+    const double center = this->DicomIntensityLevel;
+    const double width = qMax(1., this->DicomIntensityWindow);
+    QVector<uchar> lut(65536);
+    for (int value = 0; value < 65536; ++value){
+        double rawValue = (this->RawInverted ? 65535 - value : value) / 65535.;
+        double modalityValue = (rawValue - 0.5) * (this->RawWindowWidth - 1.)
+          + this->RawWindowCenter - 0.5;
+        double output = ((modalityValue - (center - 0.5)) / (width - 1.) + 0.5) * 255.;
+        if (width <= 1.){
+            output = modalityValue < center - 0.5 ? 0. : 255.;
+        }
+        int displayed = static_cast<int>(qBound(0., output + 0.5, 255.));
+        lut[value] = static_cast<uchar>(this->RawInverted ? 255 - displayed : displayed);
+    }
+
+    QImage image(this->RawWidth, this->RawHeight, QImage::Format_Indexed8);
+    QVector<QRgb> grayTable(256);
+    for (int i = 0; i < 256; ++i){
+        grayTable[i] = qRgb(i, i, i);
+    }
+    image.setColorTable(grayTable);
+    const quint16* pixels = this->RawPixels.constData();
+    const uchar* table = lut.constData();
+    for (int y = 0; y < this->RawHeight; ++y){
+        uchar* line = image.scanLine(y);
+        const quint16* rawLine = pixels + y * this->RawWidth;
+        for (int x = 0; x < this->RawWidth; ++x){
+            line[x] = table[rawLine[x]];
+        }
+    }
+    q->clearImages();
+    q->addImage(image);
+    return true;
+}
+
 // -------------------------------------------------------------------------
 void ctkDICOMItemViewPrivate::onPatientModelSelected(const QModelIndex &index){
     Q_Q(ctkDICOMItemView);
@@ -287,8 +402,9 @@ void ctkDICOMItemView::addImage( DicomImage & dcmImage, bool defaultIntensity )
           else
           {
             dcmImage.setMinMaxWindow(OFTrue /* ignore extreme values */);
-            dcmImage.getWindow(d->DicomIntensityLevel, d->DicomIntensityWindow);
           }
+          // start the interactive window/level from the displayed one
+          dcmImage.getWindow(d->DicomIntensityLevel, d->DicomIntensityWindow);
       }
     } 
     else 
@@ -377,7 +493,10 @@ void ctkDICOMItemView::mouseMoveEvent(QMouseEvent* event){
         d->DicomIntensityLevel -= (5*(nowPos.y()-d->OldMousePos.y()));
         d->AutoWindowLevel = false;
 
-        d->setImage(d->CurrentImageIndex, false);
+        // the pixels are rendered by DCMTK only once per image
+        if (!d->applyWindowLevel()){
+            d->setImage(d->CurrentImageIndex, false);
+        }
 
         d->OldMousePos = event->pos();
     }
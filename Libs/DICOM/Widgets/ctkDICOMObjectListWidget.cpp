@@ -43,6 +43,9 @@ public:
   ~ctkDICOMObjectListWidgetPrivate();
   void populateDICOMObjectTreeView(const QString& fileName);
   void setPathLabel(const QString& currentFile);
+  /// Select the first row matching text, or the next one after the
+  /// current row if next is true
+  void search(const QString& text, bool next);
 
   QString currentFile;
   QStringList fileList;
@@ -65,9 +68,33 @@ ctkDICOMObjectListWidgetPrivate::~ctkDICOMObjectListWidgetPrivate()
 //----------------------------------------------------------------------------
 void ctkDICOMObjectListWidgetPrivate::populateDICOMObjectTreeView(const QString& fileName)
 {
+  // the rows are fetched by the model when they are expanded
   this->dicomObjectModel->setFile(fileName);
   this->dcmObjectTreeView->setModel(this->dicomObjectModel);
-  this->dcmObjectTreeView->expandAll();
+}
+
+// --------------------------------------------------------------------------
+void ctkDICOMObjectListWidgetPrivate::search(const QString& text, bool next)
+{
+  // while typing, the first matching row is selected, the next ones
+  // with return
+  QModelIndex start;
+  if (next)
+    {
+    start = this->dcmObjectTreeView->currentIndex();
+    start = start.sibling(start.row(), 0);
+    }
+  QModelIndex found = this->dicomObjectModel->findNext(text, start);
+  if (!found.isValid() && start.isValid())
+    {
+    // wrap around
+    found = this->dicomObjectModel->findNext(text);
+    }
+  if (found.isValid())
+    {
+    this->dcmObjectTreeView->setCurrentIndex(found);
+    this->dcmObjectTreeView->scrollTo(found);
+    }
 }
 
 // --------------------------------------------------------------------------
@@ -95,6 +122,8 @@ ctkDICOMObjectListWidget::ctkDICOMObjectListWidget(QWidget* _parent):Superclass(
   connect(d->dcmObjectTreeView, SIGNAL(doubleClicked(const QModelIndex&))
                                ,this, SLOT(openLookupUrl(const QModelIndex&)));
   connect(d->copyPathPushButton , SIGNAL(clicked(bool)),this, SLOT(copyPath()));
+  connect(d->searchLineEdit, SIGNAL(textEdited(QString)), this, SLOT(onSearchTextEdited(QString)));
+  connect(d->searchLineEdit, SIGNAL(returnPressed()), this, SLOT(onSearchNext()));
 }
 
 //----------------------------------------------------------------------------
@@ -167,3 +196,17 @@ void ctkDICOMObjectListWidget::copyPath()
   QClipboard *clipboard = QApplication::clipboard();
   clipboard->setText(d->currentFile);
 }
+
+// --------------------------------------------------------------------------
+void ctkDICOMObjectListWidget::onSearchTextEdited(const QString& text)
+{
+  Q_D(ctkDICOMObjectListWidget);
+  d->search(text, false);
+}
+
+// --------------------------------------------------------------------------
+void ctkDICOMObjectListWidget::onSearchNext()
+{
+  Q_D(ctkDICOMObjectListWidget);
+  d->search(d->searchLineEdit->text(), true);
+}
@@ -62,6 +62,8 @@ protected Q_SLOTS:
   void openLookupUrl(const QModelIndex&);
   void updateWidget();
   void copyPath();
+  void onSearchTextEdited(const QString& text);
+  void onSearchNext();
 };
 
 #endif
@@ -20,8 +20,7 @@
 =============================================================================*/
 
 // Qt include
-#include <QSharedData>
-#include <QStandardItem>
+#include <QList>
 #include <QString>
 #include <QStringList>
 
@@ -31,6 +30,8 @@
 #include "dcmtk/dcmdata/dcfilefo.h"
 #include "dcmtk/dcmdata/dcmetinf.h"
 #include "dcmtk/dcmdata/dcitem.h"
+#include "dcmtk/dcmdata/dcpixseq.h"
+#include "dcmtk/dcmdata/dcsequen.h"
 #include "dcmtk/ofstd/ofcond.h"
 #include "dcmtk/ofstd/ofstring.h"
 #include "dcmtk/ofstd/ofstd.h"
@@ -38,6 +39,33 @@
 // CTK DICOM Core
 #include "ctkDICOMObjectModel.h"
 
+//------------------------------------------------------------------------------
+/// A row of the model: an element of a dataset or of an item, or an item
+/// of a sequence.
+struct ctkDICOMObjectModelNode
+{
+  ctkDICOMObjectModelNode(ctkDICOMObjectModelNode* parent, int row, DcmObject* object)
+    : Parent(parent)
+    , Row(row)
+    , Object(object)
+    , ValueComputed(false)
+  {
+  }
+  ~ctkDICOMObjectModelNode()
+  {
+    qDeleteAll(this->Children);
+  }
+
+  ctkDICOMObjectModelNode* Parent;
+  int Row;
+  DcmObject* Object;
+  /// Fetched children, see ctkDICOMObjectModel::fetchMore()
+  QList<ctkDICOMObjectModelNode*> Children;
+  /// Value is only computed when it is displayed or searched
+  bool ValueComputed;
+  QString Value;
+};
+
 //------------------------------------------------------------------------------
 class ctkDICOMObjectModelPrivate
 {
@@ -49,139 +77,148 @@ protected:
 public:
   ctkDICOMObjectModelPrivate(ctkDICOMObjectModel&);
   virtual ~ctkDICOMObjectModelPrivate();
-  
-  void init();
-  void itemInsert( DcmItem *dataset, QStandardItem *parent);
-  void seqInsert( DcmSequenceOfItems *dataset, QStandardItem *parent);
-  QString getTagValue( DcmElement *dcmElem);
-  QStandardItem* populateModelRow(const QString& tagName,const QString& tagHexName,
-  const QString& tagValue, const QString& VRName,
-  const QString& elementLengthQString, QStandardItem *parent);
+
+  /// Number of children of the node in the dataset, fetched or not
+  int objectCount(const ctkDICOMObjectModelNode* node)const;
+  DcmObject* childObject(const ctkDICOMObjectModelNode* node, int row)const;
+  ctkDICOMObjectModelNode* nodeFromIndex(const QModelIndex& index)const;
+  QModelIndex indexFromNode(ctkDICOMObjectModelNode* node, int column = 0)const;
+  /// Fetch all the children of node
+  void fetchAll(ctkDICOMObjectModelNode* node);
+  const QString& value(ctkDICOMObjectModelNode* node)const;
+  QString getTagValue( DcmElement *dcmElem)const;
+  /// Next node in the order of the file, fetching the rows on the way
+  ctkDICOMObjectModelNode* nextNode(ctkDICOMObjectModelNode* node);
 
   DcmFileFormat fileFormat;
-  QStandardItem *rootItem;
+  ctkDICOMObjectModelNode* RootNode;
+  QStringList HeaderLabels;
+  /// Number of rows added by fetchMore()
+  int FetchBatchSize;
 };
 
 //------------------------------------------------------------------------------
 ctkDICOMObjectModelPrivate::ctkDICOMObjectModelPrivate(ctkDICOMObjectModel& o):q_ptr(&o)
 {
+  this->RootNode = 0;
+  this->FetchBatchSize = 256;
+  this->HeaderLabels << "Tag" << "Attribute" << "Value" << "VR" << "Length";
 }
 
 //------------------------------------------------------------------------------
 ctkDICOMObjectModelPrivate::~ctkDICOMObjectModelPrivate()
 {
+  delete this->RootNode;
 }
 
 //------------------------------------------------------------------------------
-void ctkDICOMObjectModelPrivate::init()
+int ctkDICOMObjectModelPrivate::objectCount(const ctkDICOMObjectModelNode* node)const
 {
-  Q_Q(ctkDICOMObjectModel);
-  QStringList horizontalHeaderLabels;
-  horizontalHeaderLabels.append( QString("Tag"));
-  horizontalHeaderLabels.append( QString("Attribute"));
-  horizontalHeaderLabels.append( QString("Value"));
-  horizontalHeaderLabels.append( QString("VR"));
-  horizontalHeaderLabels.append( QString("Length"));
-  q->setHorizontalHeaderLabels(horizontalHeaderLabels);
+  if (!node || !node->Object)
+    {
+    return 0;
+    }
+  // the fragments of the encapsulated pixel data are not displayed
+  if (dynamic_cast<DcmPixelSequence*>(node->Object))
+    {
+    return 0;
+    }
+  DcmSequenceOfItems* sequence = dynamic_cast<DcmSequenceOfItems*>(node->Object);
+  if (sequence)
+    {
+    return static_cast<int>(sequence->card());
+    }
+  DcmItem* item = dynamic_cast<DcmItem*>(node->Object);
+  if (item)
+    {
+    return static_cast<int>(item->card());
+    }
+  return 0;
 }
 
 //------------------------------------------------------------------------------
-void ctkDICOMObjectModelPrivate::itemInsert( DcmItem *dataset, QStandardItem *parent)
+DcmObject* ctkDICOMObjectModelPrivate::childObject(const ctkDICOMObjectModelNode* node, int row)const
 {
-  DcmStack stack;
-  dataset->nextObject( stack, OFTrue);
-  for( ; stack.top(); dataset->nextObject( stack, OFFalse))
+  DcmSequenceOfItems* sequence = dynamic_cast<DcmSequenceOfItems*>(node->Object);
+  if (sequence)
     {
-    DcmObject *dO =  stack.top();
-    // put in the visit node function
-    QString tagValue = "";
-    DcmTag tag = dO->getTag();
-	  // std::cout<<tag;
-    QString tagName = tag.getTagName();
-    //
-    DcmTagKey tagX = tag.getXTag();
-    QString tagHexName = tagX.toString().c_str();
-    //
-    DcmVR VR = dO->getVR();
-    QString VRName = VR.getVRName();
-    //
-    // Getting length
-    int elementLength;
-    elementLength = dO->getLength();
-    QString elementLengthQString = QString::number(elementLength);
-    //
-    DcmTag tagKey = tag.getXTag();
-    if( tagKey == DCM_SequenceDelimitationItem
-        || tagKey == DCM_ItemDelimitationItem
-        || "Item" == tagName)
-      {
-      return;
-      }
-
-    DcmElement *dcmElem = dynamic_cast<DcmElement *> (dO);
-    tagValue = getTagValue(dcmElem);
-
-    // Populate QStandardModel with current DICOM element tag name and value
-    QStandardItem *tagItem = populateModelRow(tagName,tagHexName,tagValue,VRName,elementLengthQString,parent);
-
-    // Check if the DICOM object is a SQ Data element and extract the nested DICOM objects
-    if( dcmElem && !dcmElem->isLeaf())
-      {
-      // now dcmElem points to a sequence of items
-      ctkDICOMObjectModelPrivate::seqInsert( dynamic_cast<DcmSequenceOfItems*> (dcmElem), tagItem);
-      }
-  }
+    return sequence->getItem(row);
+    }
+  DcmItem* item = dynamic_cast<DcmItem*>(node->Object);
+  if (item)
+    {
+    return item->getElement(row);
+    }
+  return 0;
 }
 
 //------------------------------------------------------------------------------
-void ctkDICOMObjectModelPrivate::seqInsert( DcmSequenceOfItems *dataset, QStandardItem *parent)
+ctkDICOMObjectModelNode* ctkDICOMObjectModelPrivate::nodeFromIndex(const QModelIndex& index)const
 {
-  DcmObject *dO = dataset->nextInContainer(NULL);
-
-  for( ; dO; dO = dataset->nextInContainer(dO))
+  if (!index.isValid())
     {
-    DcmElement *dcmElem = dynamic_cast<DcmElement *> (dO);
-    QString tagValue = "";
-    DcmTag tag = dO->getTag();
-    DcmTag tagKey = tag.getXTag();
-    if( tagKey == DCM_SequenceDelimitationItem
-        || tagKey == DCM_ItemDelimitationItem)
-      {
-      return;
-      }
-
-    QString tagName = tag.getTagName();
-    DcmTagKey tagX = tag.getXTag();
-    QString tagHexName = tagX.toString().c_str();
-    DcmVR VR = dO->getVR();
-    QString VRName = VR.getVRName();
-
-    // Getting length
-    int elementLength;
-    elementLength = dO->getLength();
-    QString elementLengthQString = QString::number(elementLength);
+    return this->RootNode;
+    }
+  return static_cast<ctkDICOMObjectModelNode*>(index.internalPointer());
+}
 
-    if( dcmElem)
-      {
-      tagValue = getTagValue(dcmElem);
-      }
+//------------------------------------------------------------------------------
+QModelIndex ctkDICOMObjectModelPrivate::indexFromNode(ctkDICOMObjectModelNode* node, int column)const
+{
+  Q_Q(const ctkDICOMObjectModel);
+  if (!node || node == this->RootNode)
+    {
+    return QModelIndex();
+    }
+  return q->createIndex(node->Row, column, node);
+}
 
-    QStandardItem *tagItem = populateModelRow(tagName,tagHexName,tagValue,VRName,elementLengthQString,parent);
+//------------------------------------------------------------------------------
+void ctkDICOMObjectModelPrivate::fetchAll(ctkDICOMObjectModelNode* node)
+{
+  Q_Q(ctkDICOMObjectModel);
+  QModelIndex index = this->indexFromNode(node);
+  while (q->canFetchMore(index))
+    {
+    q->fetchMore(index);
+    }
+}
 
-   if( dcmElem && !dcmElem->isLeaf())
-      {
-      ctkDICOMObjectModelPrivate::seqInsert( dynamic_cast<DcmSequenceOfItems*> (dcmElem), tagItem);
-      }
-    else if( tag.getXTag() == DCM_Item)
+//------------------------------------------------------------------------------
+const QString& ctkDICOMObjectModelPrivate::value(ctkDICOMObjectModelNode* node)const
+{
+  if (!node->ValueComputed)
+    {
+    node->ValueComputed = true;
+    DcmElement* dcmElem = dynamic_cast<DcmElement*>(node->Object);
+    if (dcmElem && dcmElem->isLeaf())
       {
-      itemInsert( dynamic_cast<DcmItem*> (dO), tagItem);
+      node->Value = this->getTagValue(dcmElem);
       }
-   }
+    }
+  return node->Value;
 }
 
 //------------------------------------------------------------------------------
-QString ctkDICOMObjectModelPrivate::getTagValue( DcmElement *dcmElem)
+QString ctkDICOMObjectModelPrivate::getTagValue( DcmElement *dcmElem)const
 {
+  // binary values can be very large (e.g. pixel data), they are not
+  // converted to strings
+  switch (dcmElem->getVR())
+    {
+    case EVR_OB:
+    case EVR_OW:
+    case EVR_OF:
+    case EVR_ox:
+    case EVR_UN:
+      return QString("(%1 bytes)").arg(dcmElem->getLength());
+    default:
+      break;
+    }
+
+  // only the first values of long multi-valued elements are displayed
+  const int maxValues = 16;
+  const int maxLength = 256;
   QString tagValue = "";
   std::ostringstream value;
   OFString part;
@@ -194,7 +231,7 @@ QString ctkDICOMObjectModelPrivate::getTagValue( DcmElement *dcmElem)
     value << "[" << mult << "] ";
     }
 
-  for( pos=0; pos < mult; pos++)
+  for( pos=0; pos < mult && pos < maxValues; pos++)
     {
     value << sep;
     OFCondition status = dcmElem->getOFString( part, pos);
@@ -209,39 +246,39 @@ QString ctkDICOMObjectModelPrivate::getTagValue( DcmElement *dcmElem)
       value << " ...";
       }
   tagValue = value.str().c_str();
+  if (tagValue.length() > maxLength)
+    {
+    tagValue = tagValue.left(maxLength) + " ...";
+    }
 
   return tagValue;
 }
 
 //------------------------------------------------------------------------------
-QStandardItem* ctkDICOMObjectModelPrivate::populateModelRow(const QString& tagName,
-   const QString& tagHexName, const QString& tagValue,const QString& VRName,
-   const QString& elementLengthQString, QStandardItem *parent)
+ctkDICOMObjectModelNode* ctkDICOMObjectModelPrivate::nextNode(ctkDICOMObjectModelNode* node)
 {
-  // Create items
-  QStandardItem *VRItem = new QStandardItem( VRName);
-  QStandardItem *tagItem = new QStandardItem( tagName);
-  QStandardItem *tagHexItem = new QStandardItem( tagHexName);
-  QStandardItem *lengthItem = new QStandardItem( elementLengthQString);
-  QStandardItem *valItem = new QStandardItem( tagValue);
-
-  VRItem->setFlags(VRItem->flags() & ~Qt::ItemIsEditable);
-  tagItem->setFlags(tagItem->flags() & ~Qt::ItemIsEditable);
-  tagHexItem->setFlags(tagHexItem->flags() & ~Qt::ItemIsEditable);
-  lengthItem->setFlags(lengthItem->flags() & ~Qt::ItemIsEditable);
-  valItem->setFlags(valItem->flags() & ~Qt::ItemIsEditable);
-
-  // Insert items
-  QList<QStandardItem *> modelRow;
-
-  modelRow.append( tagHexItem);
-  modelRow.append( tagItem);
-  modelRow.append( valItem);
-  modelRow.append( VRItem);
-  modelRow.append( lengthItem);
-  parent->appendRow( modelRow);
-
-  return tagHexItem;
+  if (this->objectCount(node) > 0)
+    {
+    if (node->Children.isEmpty())
+      {
+      this->fetchAll(node);
+      }
+    return node->Children.value(0);
+    }
+  while (node && node->Parent)
+    {
+    ctkDICOMObjectModelNode* parent = node->Parent;
+    if (node->Row + 1 < this->objectCount(parent))
+      {
+      if (node->Row + 1 >= parent->Children.count())
+        {
+        this->fetchAll(parent);
+        }
+      return parent->Children.value(node->Row + 1);
+      }
+    node = parent;
+    }
+  return 0;
 }
 
 //------------------------------------------------------------------------------
@@ -249,8 +286,6 @@ ctkDICOMObjectModel::ctkDICOMObjectModel(QObject* parentObject)
   : Superclass(parentObject)
   , d_ptr(new ctkDICOMObjectModelPrivate(*this))
 {
-  Q_D(ctkDICOMObjectModel);
-  d->init();
 }
 
 //------------------------------------------------------------------------------
@@ -263,19 +298,182 @@ void ctkDICOMObjectModel::setFile(const QString &fileName)
 {
   Q_D(ctkDICOMObjectModel);
 
+  this->beginResetModel();
+  delete d->RootNode;
+  d->RootNode = 0;
+
   OFCondition status = d->fileFormat.loadFile( fileName.toLatin1().data());
   if( !status.good() )
     {
     // TODO: Through an error message.
     }
 
-  DcmDataset *dataset = d->fileFormat.getDataset();
-  d->rootItem = this->invisibleRootItem();
+  d->RootNode = new ctkDICOMObjectModelNode(0, 0, d->fileFormat.getDataset());
+  this->endResetModel();
+}
 
-  if(d->rootItem->hasChildren())
+//------------------------------------------------------------------------------
+QModelIndex ctkDICOMObjectModel::index(int row, int column, const QModelIndex& parentIndex)const
+{
+  Q_D(const ctkDICOMObjectModel);
+  ctkDICOMObjectModelNode* parentNode = d->nodeFromIndex(parentIndex);
+  if (!parentNode || row < 0 || row >= parentNode->Children.count()
+      || column < 0 || column >= d->HeaderLabels.count())
     {
-    d->rootItem->removeRows(0, d->rootItem->rowCount());
+    return QModelIndex();
     }
+  return this->createIndex(row, column, parentNode->Children[row]);
+}
+
+//------------------------------------------------------------------------------
+QModelIndex ctkDICOMObjectModel::parent(const QModelIndex& index)const
+{
+  Q_D(const ctkDICOMObjectModel);
+  if (!index.isValid())
+    {
+    return QModelIndex();
+    }
+  return d->indexFromNode(d->nodeFromIndex(index)->Parent);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMObjectModel::rowCount(const QModelIndex& parentIndex)const
+{
+  Q_D(const ctkDICOMObjectModel);
+  if (parentIndex.column() > 0)
+    {
+    return 0;
+    }
+  ctkDICOMObjectModelNode* node = d->nodeFromIndex(parentIndex);
+  return node ? node->Children.count() : 0;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMObjectModel::columnCount(const QModelIndex& parentIndex)const
+{
+  Q_D(const ctkDICOMObjectModel);
+  Q_UNUSED(parentIndex);
+  return d->HeaderLabels.count();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMObjectModel::hasChildren(const QModelIndex& parentIndex)const
+{
+  Q_D(const ctkDICOMObjectModel);
+  if (parentIndex.column() > 0)
+    {
+    return false;
+    }
+  return d->objectCount(d->nodeFromIndex(parentIndex)) > 0;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMObjectModel::canFetchMore(const QModelIndex& parentIndex)const
+{
+  Q_D(const ctkDICOMObjectModel);
+  ctkDICOMObjectModelNode* node = d->nodeFromIndex(parentIndex);
+  return node && node->Children.count() < d->objectCount(node);
+}
 
-  d->itemInsert( dataset, d->rootItem);
+//------------------------------------------------------------------------------
+void ctkDICOMObjectModel::fetchMore(const QModelIndex& parentIndex)
+{
+  Q_D(ctkDICOMObjectModel);
+  ctkDICOMObjectModelNode* node = d->nodeFromIndex(parentIndex);
+  if (!node)
+    {
+    return;
+    }
+  const int first = node->Children.count();
+  const int last = qMin(d->objectCount(node), first + d->FetchBatchSize) - 1;
+  if (last < first)
+    {
+    return;
+    }
+  this->beginInsertRows(parentIndex.sibling(parentIndex.row(), 0), first, last);
+  for (int row = first; row <= last; ++row)
+    {
+    node->Children << new ctkDICOMObjectModelNode(node, row, d->childObject(node, row));
+    }
+  this->endInsertRows();
+}
+
+//------------------------------------------------------------------------------
+QVariant ctkDICOMObjectModel::data(const QModelIndex& index, int role)const
+{
+  Q_D(const ctkDICOMObjectModel);
+  if (!index.isValid() || role != Qt::DisplayRole)
+    {
+    return QVariant();
+    }
+  ctkDICOMObjectModelNode* node = d->nodeFromIndex(index);
+  if (!node->Object)
+    {
+    return QVariant();
+    }
+  DcmTag tag = node->Object->getTag();
+  switch (index.column())
+    {
+    case TagColumn:
+      return QString(tag.getXTag().toString().c_str());
+    case AttributeColumn:
+      return QString(tag.getTagName());
+    case ValueColumn:
+      return d->value(node);
+    case VRColumn:
+      return QString(DcmVR(node->Object->getVR()).getVRName());
+    case LengthColumn:
+      return QString::number(node->Object->getLength());
+    default:
+      break;
+    }
+  return QVariant();
+}
+
+//------------------------------------------------------------------------------
+QVariant ctkDICOMObjectModel::headerData(int section, Qt::Orientation orientation, int role)const
+{
+  Q_D(const ctkDICOMObjectModel);
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole
+      || section < 0 || section >= d->HeaderLabels.count())
+    {
+    return QVariant();
+    }
+  return d->HeaderLabels[section];
+}
+
+//------------------------------------------------------------------------------
+Qt::ItemFlags ctkDICOMObjectModel::flags(const QModelIndex& index)const
+{
+  if (!index.isValid())
+    {
+    return Qt::NoItemFlags;
+    }
+  return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+//------------------------------------------------------------------------------
+QModelIndex ctkDICOMObjectModel::findNext(const QString& text, const QModelIndex& start)
+{
+  Q_D(ctkDICOMObjectModel);
+  if (!d->RootNode || text.isEmpty())
+    {
+    return QModelIndex();
+    }
+  ctkDICOMObjectModelNode* node = d->nextNode(start.isValid() ? d->nodeFromIndex(start) : d->RootNode);
+  for ( ; node; node = d->nextNode(node))
+    {
+    if (!node->Object)
+      {
+      continue;
+      }
+    DcmTag tag = node->Object->getTag();
+    if (QString(tag.getXTag().toString().c_str()).contains(text, Qt::CaseInsensitive)
+        || QString(tag.getTagName()).contains(text, Qt::CaseInsensitive)
+        || d->value(node).contains(text, Qt::CaseInsensitive))
+      {
+      return d->indexFromNode(node);
+      }
+    }
+  return QModelIndex();
 }
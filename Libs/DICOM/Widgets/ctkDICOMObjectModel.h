@@ -22,12 +22,9 @@
 #ifndef __ctkDICOMObjectModel_h
 #define __ctkDICOMObjectModel_h
 
-// STD includes
-#include <string>
-
 // Qt includes
+#include <QAbstractItemModel>
 #include <QMetaType>
-#include <QStandardItemModel>
 #include <QString>
 
 #include "ctkDICOMCoreExport.h"
@@ -37,19 +34,52 @@ class ctkDICOMObjectModelPrivate;
 ///
 /// \brief Provides a Qt MVC-compatible wrapper around a ctkDICOMItem.
 ///
+/// The rows are created on demand from the dataset of the file: the
+/// elements of the dataset, of the items of a sequence and the items of a
+/// sequence are only added when they are fetched (see fetchMore()), by
+/// batches. The values are only converted to strings when they are
+/// displayed and the binary values (e.g. OB, OW, UN) are not converted.
+///
 class CTK_DICOM_CORE_EXPORT ctkDICOMObjectModel
-  : public QStandardItemModel
+  : public QAbstractItemModel
 {
   Q_OBJECT
-  typedef QStandardItemModel Superclass;
+  typedef QAbstractItemModel Superclass;
   //Q_PROPERTY(setFile);
 
 public:
+  enum Column
+  {
+    TagColumn = 0,
+    AttributeColumn,
+    ValueColumn,
+    VRColumn,
+    LengthColumn
+  };
 
   explicit ctkDICOMObjectModel(QObject* parent = 0);
   virtual ~ctkDICOMObjectModel();
   Q_INVOKABLE void setFile (const QString& fileName);
 
+  virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex())const;
+  virtual QModelIndex parent(const QModelIndex& index)const;
+  virtual int rowCount(const QModelIndex& parent = QModelIndex())const;
+  virtual int columnCount(const QModelIndex& parent = QModelIndex())const;
+  virtual bool hasChildren(const QModelIndex& parent = QModelIndex())const;
+  virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole)const;
+  virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole)const;
+  virtual Qt::ItemFlags flags(const QModelIndex& index)const;
+
+  virtual bool canFetchMore(const QModelIndex& parent)const;
+  virtual void fetchMore(const QModelIndex& parent);
+
+  /// Returns the first row after start, in the order of the file, whose
+  /// tag, attribute name or value contains text (case insensitive).
+  /// The search starts at the first row if start is invalid. Only the
+  /// rows up to the returned one are fetched.
+  /// Returns an invalid index if no row after start matches.
+  Q_INVOKABLE QModelIndex findNext(const QString& text, const QModelIndex& start = QModelIndex());
+
 protected:
   QScopedPointer<ctkDICOMObjectModelPrivate> d_ptr;
 
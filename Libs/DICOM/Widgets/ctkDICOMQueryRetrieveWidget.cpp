@@ -176,6 +176,8 @@ void ctkDICOMQueryRetrieveWidget::query()
   progress.setMinimumDuration(0);
   progress.setValue(0);
   progress.show();
+  // the results are shown as they are inserted into the database
+  d->dicomTableManager->setDICOMDatabase(&(d->QueryResultDatabase));
   foreach (d->CurrentServer, d->ServerNodeWidget->selectedServerNodes())
     {
     if (progress.wasCanceled())
@@ -205,6 +207,8 @@ void ctkDICOMQueryRetrieveWidget::query()
               progressLabel, SLOT(setText(QString)));
       connect(query, SIGNAL(progress(int)),
               this, SLOT(onQueryProgressChanged(int)));
+      connect(query, SIGNAL(studyFound(ctkDICOMItem)),
+              this, SLOT(onQueryResultFound()));
 
       // run the query against the selected server and put results in database
       query->query ( d->QueryResultDatabase );
@@ -213,6 +217,8 @@ void ctkDICOMQueryRetrieveWidget::query()
                  progressLabel, SLOT(setText(QString)));
       disconnect(query, SIGNAL(progress(int)),
                  this, SLOT(onQueryProgressChanged(int)));
+      disconnect(query, SIGNAL(studyFound(ctkDICOMItem)),
+                 this, SLOT(onQueryResultFound()));
       disconnect(&progress, SIGNAL(canceled()), query, SLOT(cancel()));
       }
     catch (std::exception e)
@@ -233,9 +239,8 @@ void ctkDICOMQueryRetrieveWidget::query()
   if (!progress.wasCanceled())
     {
     d->Model.setDatabase(d->QueryResultDatabase.database());
-    
-    d->dicomTableManager->setDICOMDatabase(&(d->QueryResultDatabase));
     }
+  d->dicomTableManager->refreshTableViews();
   d->RetrieveButton->setEnabled(d->QueriesByStudyUID.keys().size() != 0);
 
   progress.setValue(progress.maximum());
@@ -378,6 +383,14 @@ void ctkDICOMQueryRetrieveWidget::cancel()
   emit canceled();
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMQueryRetrieveWidget::onQueryResultFound()
+{
+  // the query runs in this thread, let the table views refresh with the
+  // results inserted so far
+  QApplication::processEvents();
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMQueryRetrieveWidget::onQueryProgressChanged(int value)
 {
@@ -70,6 +70,8 @@ Q_SIGNALS:
 
 protected Q_SLOTS:
   void onQueryProgressChanged(int value);
+  /// Called for each study found by the running query
+  void onQueryResultFound();
   void updateRetrieveProgress(int value);
 
 protected:
@@ -224,7 +224,7 @@ void ctkDICOMTableManager::onPatientsSelectionChanged(const QStringList &uids)
     }
   else
     {
-      patientCondition.second = d->patientsTable->uidsForAllRows();
+      patientCondition.second = d->patientsTable->uidsForQuery();
     }
   d->studiesTable->addSqlWhereCondition(patientCondition);
   d->seriesTable->addSqlWhereCondition(patientCondition);
@@ -242,7 +242,7 @@ void ctkDICOMTableManager::onStudiesSelectionChanged(const QStringList &uids)
     }
   else
     {
-      studiesCondition.second = d->studiesTable->uidsForAllRows();
+      studiesCondition.second = d->studiesTable->uidsForQuery();
     }
   d->seriesTable->addSqlWhereCondition(studiesCondition);
 }
@@ -269,6 +269,15 @@ void ctkDICOMTableManager::updateTableViews()
   d->seriesTable->setQuery();
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMTableManager::refreshTableViews()
+{
+  Q_D(ctkDICOMTableManager);
+  d->patientsTable->refresh();
+  d->studiesTable->refresh();
+  d->seriesTable->refresh();
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMTableManager::resizeEvent(QResizeEvent *e)
 {
@@ -94,6 +94,12 @@ public:
 
   void updateTableViews();
 
+  /**
+   * @brief Refresh the content of the tables without resetting the
+   * current selection, e.g. while importing data.
+   */
+  void refreshTableViews();
+
   enum DisplayDensity
   {
     Compact = 0,
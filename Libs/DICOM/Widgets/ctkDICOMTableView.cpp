@@ -23,9 +23,104 @@
 #include "ui_ctkDICOMTableView.h"
 
 // Qt includes
+#include <QAbstractTableModel>
+#include <QItemSelectionModel>
 #include <QMouseEvent>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
 #include <QSortFilterProxyModel>
-#include <QSqlQueryModel>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+// ctk includes
+#include "ctkLogger.h"
+
+//------------------------------------------------------------------------------
+static ctkLogger logger("org.commontk.dicom.DICOMTableView" );
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+static QString quotedValues(const QStringList& values)
+{
+  QStringList quoted;
+  foreach(QString value, values)
+    {
+    quoted << "'" + value.replace("'", "''") + "'";
+    }
+  return quoted.join(",");
+}
+
+//------------------------------------------------------------------------------
+/// Rows returned by a query, filled in the worker thread.
+struct ctkDICOMTableViewQueryResult
+{
+  ctkDICOMTableViewQueryResult()
+    : Generation(-1)
+    , Failed(false)
+  {
+  }
+
+  int Generation;
+  bool Failed;
+  QStringList ColumnNames;
+  QList<QVector<QVariant> > Rows;
+};
+
+//------------------------------------------------------------------------------
+/// Read-only model of the rows of the last query.
+class ctkDICOMTableViewModel : public QAbstractTableModel
+{
+public:
+  ctkDICOMTableViewModel(QObject* parent)
+    : QAbstractTableModel(parent)
+  {
+  }
+
+  void setResult(const ctkDICOMTableViewQueryResult& result)
+  {
+    this->beginResetModel();
+    this->ColumnNames = result.ColumnNames;
+    this->Rows = result.Rows;
+    this->endResetModel();
+  }
+
+  virtual int rowCount(const QModelIndex& parent = QModelIndex()) const
+  {
+    return parent.isValid() ? 0 : this->Rows.count();
+  }
+
+  virtual int columnCount(const QModelIndex& parent = QModelIndex()) const
+  {
+    return parent.isValid() ? 0 : this->ColumnNames.count();
+  }
+
+  virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const
+  {
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+      {
+      return QVariant();
+      }
+    return this->Rows.at(index.row()).value(index.column());
+  }
+
+  virtual QVariant headerData(int section, Qt::Orientation orientation,
+                              int role = Qt::DisplayRole) const
+  {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+      {
+      return this->ColumnNames.value(section);
+      }
+    return QAbstractTableModel::headerData(section, orientation, role);
+  }
+
+  QStringList ColumnNames;
+  QList<QVector<QVariant> > Rows;
+};
 
 //------------------------------------------------------------------------------
 class ctkDICOMTableViewPrivate : public Ui_ctkDICOMTableView
@@ -49,36 +144,154 @@ public:
 
   QString queryTableName() const;
 
+  /// Text columns of the table the filter text is matched against.
+  QStringList filterColumns();
+
+  /// Run the query of the given generation on connection.
+  /// Called from the worker thread, or from the main thread if the
+  /// database can't be shared.
+  void runQuery(QSqlDatabase connection, const QString& query,
+                const QVariantList& bindValues, int generation);
+
+  /// Returns true if generation is not the generation of the last query.
+  bool isCanceled(int generation) const;
+
+  /// Update the table with the rows of the last query.
+  /// Returns true if queryChanged() must be emitted.
+  bool applyResult(const ctkDICOMTableViewQueryResult& result);
+
   ctkDICOMDatabase* dicomDatabase;
-  QSqlQueryModel dicomSQLModel;
+  ctkDICOMTableViewModel* dicomSQLModel;
+  /// Only used for sorting, the filter is done in SQL
   QSortFilterProxyModel* dicomSQLFilterModel;
   QString queryForeignKey;
 
   QStringList currentSelection;
+
+  /// uids of the last query, used by refresh()
+  QStringList lastQueryUIDs;
+
+  /// Coalesces the database change notifications
+  QTimer* refreshTimer;
+  /// Started by each change of the filter text
+  QTimer* filterTimer;
   //Key = QString for columns, Values = QStringList
   QHash<QString, QStringList> sqlWhereConditions;
 
+  /// Table and columns of filterColumns()
+  QString FilterColumnsTableName;
+  QStringList FilterColumns;
+
+  /// Filter of the displayed rows, the query is not restricted if empty
+  QString AppliedFilterText;
+  bool QueryRestricted;
+
+  /// Last query, run again on the main connection if the worker thread
+  /// can't open the database
+  QString LastQuery;
+  QVariantList LastBindValues;
+  bool QueryRunning;
+
+  /// What to do when the results of the pending query are applied
+  bool EmitQueryChanged;
+  bool ClearSelection;
+  bool SelectAll;
+  QStringList SelectionToRestore;
+
+  QThreadPool QueryPool;
+  /// Protects the members below, shared with the worker thread.
+  mutable QMutex QueryMutex;
+  /// Incremented by each query, the queries of a previous generation
+  /// are canceled.
+  int QueryGeneration;
+  ctkDICOMTableViewQueryResult QueryResult;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMTableViewQueryTask : public QRunnable
+{
+public:
+  ctkDICOMTableViewQueryTask(ctkDICOMTableView* view, ctkDICOMTableViewPrivate* viewPrivate,
+                             ctkDICOMDatabase* database,
+                             const QString& query, const QVariantList& bindValues,
+                             int generation)
+    : View(view)
+    , ViewPrivate(viewPrivate)
+    , Database(database)
+    , Query(query)
+    , BindValues(bindValues)
+    , Generation(generation)
+  {
+  }
+
+  virtual void run()
+  {
+    if (this->ViewPrivate->isCanceled(this->Generation))
+      {
+      return;
+      }
+    this->ViewPrivate->runQuery(this->Database->readerConnection(), this->Query,
+                                this->BindValues, this->Generation);
+    if (this->ViewPrivate->isCanceled(this->Generation))
+      {
+      return;
+      }
+    QMetaObject::invokeMethod(this->View, "onQueryFinished", Qt::QueuedConnection);
+  }
+
+private:
+  ctkDICOMTableView* View;
+  ctkDICOMTableViewPrivate* ViewPrivate;
+  ctkDICOMDatabase* Database;
+  QString Query;
+  QVariantList BindValues;
+  int Generation;
 };
 
 //------------------------------------------------------------------------------
 ctkDICOMTableViewPrivate::ctkDICOMTableViewPrivate(ctkDICOMTableView &obj)
   : q_ptr(&obj)
+  , refreshTimer(0)
+  , filterTimer(0)
+  , QueryRestricted(false)
+  , QueryRunning(false)
+  , EmitQueryChanged(false)
+  , ClearSelection(false)
+  , SelectAll(false)
+  , QueryGeneration(0)
 {
+  this->dicomSQLModel = new ctkDICOMTableViewModel(&obj);
   this->dicomSQLFilterModel = new QSortFilterProxyModel(&obj);
   this->dicomDatabase = new ctkDICOMDatabase(&obj);
+  this->QueryPool.setMaxThreadCount(1);
 }
 
 //------------------------------------------------------------------------------
 ctkDICOMTableViewPrivate::ctkDICOMTableViewPrivate(ctkDICOMTableView &obj, ctkDICOMDatabase* db)
   : q_ptr(&obj)
   , dicomDatabase(db)
+  , refreshTimer(0)
+  , filterTimer(0)
+  , QueryRestricted(false)
+  , QueryRunning(false)
+  , EmitQueryChanged(false)
+  , ClearSelection(false)
+  , SelectAll(false)
+  , QueryGeneration(0)
 {
+  this->dicomSQLModel = new ctkDICOMTableViewModel(&obj);
   this->dicomSQLFilterModel = new QSortFilterProxyModel(&obj);
+  this->QueryPool.setMaxThreadCount(1);
 }
 
 //------------------------------------------------------------------------------
 ctkDICOMTableViewPrivate::~ctkDICOMTableViewPrivate()
 {
+  {
+  QMutexLocker locker(&this->QueryMutex);
+  ++this->QueryGeneration;
+  }
+  this->QueryPool.waitForDone();
 }
 
 //------------------------------------------------------------------------------
@@ -92,9 +305,7 @@ void ctkDICOMTableViewPrivate::init()
 
   this->tblDicomDatabaseView->viewport()->installEventFilter(q);
 
-  this->dicomSQLFilterModel->setSourceModel(&this->dicomSQLModel);
-  this->dicomSQLFilterModel->setFilterKeyColumn(-1);
-  this->dicomSQLFilterModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+  this->dicomSQLFilterModel->setSourceModel(this->dicomSQLModel);
   this->tblDicomDatabaseView->setModel(this->dicomSQLFilterModel);
   this->tblDicomDatabaseView->setColumnHidden(0, true);
   this->tblDicomDatabaseView->setSortingEnabled(true);
@@ -122,10 +333,20 @@ void ctkDICOMTableViewPrivate::init()
                    SIGNAL(customContextMenuRequested(const QPoint&)),
                    q, SLOT(onCustomContextMenuRequested(const QPoint&)));
 
+  // The table is queried again once the user stopped typing.
+  this->filterTimer = new QTimer(q);
+  this->filterTimer->setSingleShot(true);
+  this->filterTimer->setInterval(300);
   QObject::connect(this->leSearchBox, SIGNAL(textChanged(QString)),
-                   this->dicomSQLFilterModel, SLOT(setFilterWildcard(QString)));
-
-  QObject::connect(this->leSearchBox, SIGNAL(textChanged(QString)), q, SLOT(onFilterChanged()));
+                   this->filterTimer, SLOT(start()));
+  QObject::connect(this->filterTimer, SIGNAL(timeout()), q, SLOT(onFilterChanged()));
+
+  // The database can change many times per second while files are being
+  // imported, the table is refreshed at most once per interval.
+  this->refreshTimer = new QTimer(q);
+  this->refreshTimer->setSingleShot(true);
+  this->refreshTimer->setInterval(300);
+  QObject::connect(this->refreshTimer, SIGNAL(timeout()), q, SLOT(refresh()));
 }
 
 //------------------------------------------------------------------------------
@@ -149,6 +370,127 @@ QString ctkDICOMTableViewPrivate::queryTableName() const
   return this->lblTableName->text();
 }
 
+//----------------------------------------------------------------------------
+QStringList ctkDICOMTableViewPrivate::filterColumns()
+{
+  const QString tableName = this->queryTableName();
+  if (tableName != this->FilterColumnsTableName)
+    {
+    this->FilterColumnsTableName = tableName;
+    this->FilterColumns.clear();
+    QSqlRecord record = this->dicomDatabase->database().record(tableName);
+    for (int i = 0; i < record.count(); ++i)
+      {
+      // the UID columns are hidden
+      if (!record.fieldName(i).contains("UID"))
+        {
+        this->FilterColumns << record.fieldName(i);
+        }
+      }
+    }
+  return this->FilterColumns;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMTableViewPrivate::runQuery(QSqlDatabase connection, const QString& queryString,
+                                        const QVariantList& bindValues, int generation)
+{
+  ctkDICOMTableViewQueryResult result;
+  result.Generation = generation;
+  if (!connection.isValid() || !connection.isOpen())
+    {
+    // applied from the main thread with the main connection
+    result.Failed = true;
+    }
+  else
+    {
+    QSqlQuery query(connection);
+    query.setForwardOnly(true);
+    query.prepare(queryString);
+    foreach(const QVariant& value, bindValues)
+      {
+      query.addBindValue(value);
+      }
+    if (!query.exec())
+      {
+      logger.error("Query failed: " + query.lastError().text());
+      }
+    else
+      {
+      QSqlRecord record = query.record();
+      for (int i = 0; i < record.count(); ++i)
+        {
+        result.ColumnNames << record.fieldName(i);
+        }
+      const int columnCount = record.count();
+      while (query.next())
+        {
+        // stop early if a new query has been started meanwhile
+        if ((result.Rows.count() % 256) == 0 && this->isCanceled(generation))
+          {
+          return;
+          }
+        QVector<QVariant> row(columnCount);
+        for (int i = 0; i < columnCount; ++i)
+          {
+          row[i] = query.value(i);
+          }
+        result.Rows << row;
+        }
+      }
+    }
+
+  QMutexLocker locker(&this->QueryMutex);
+  if (generation == this->QueryGeneration)
+    {
+    this->QueryResult = result;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool ctkDICOMTableViewPrivate::isCanceled(int generation) const
+{
+  QMutexLocker locker(&this->QueryMutex);
+  return generation != this->QueryGeneration;
+}
+
+//----------------------------------------------------------------------------
+bool ctkDICOMTableViewPrivate::applyResult(const ctkDICOMTableViewQueryResult& result)
+{
+  if (this->ClearSelection)
+    {
+    this->tblDicomDatabaseView->clearSelection();
+    }
+  this->dicomSQLModel->setResult(result);
+  this->hideUIDColumns();
+
+  this->showFilterActiveWarning(this->dicomSQLModel->rowCount() == 0 &&
+                                !this->AppliedFilterText.isEmpty());
+
+  if (!this->SelectionToRestore.isEmpty())
+    {
+    // restore the selection, the model was reset by the query
+    QItemSelection selection;
+    QAbstractItemModel* tableModel = this->tblDicomDatabaseView->model();
+    for (int i = 0; i < tableModel->rowCount(); ++i)
+      {
+      QModelIndex index = tableModel->index(i, 0);
+      if (this->SelectionToRestore.contains(index.data().toString()))
+        {
+        selection.select(index, index);
+        }
+      }
+    this->tblDicomDatabaseView->selectionModel()->select(selection,
+      QItemSelectionModel::Select | QItemSelectionModel::Rows);
+    }
+
+  const bool emitQueryChanged = this->EmitQueryChanged;
+  this->EmitQueryChanged = false;
+  this->ClearSelection = false;
+  this->SelectionToRestore.clear();
+  return emitQueryChanged;
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMTableViewPrivate::showFilterActiveWarning(bool showWarning)
 {
@@ -192,10 +534,10 @@ ctkDICOMTableView::ctkDICOMTableView (ctkDICOMDatabase* dicomDataBase, QString q
   : Superclass(parent)
   , d_ptr(new ctkDICOMTableViewPrivate(*this))
 {
-  this->setDicomDataBase(dicomDataBase);
   Q_D(ctkDICOMTableView);
   d->init();
   this->setQueryTableName(queryTableName);
+  this->setDicomDataBase(dicomDataBase);
 }
 
 //------------------------------------------------------------------------------
@@ -215,8 +557,9 @@ void ctkDICOMTableView::setDicomDataBase(ctkDICOMDatabase *dicomDatabase)
   d->dicomDatabase = dicomDatabase;
   //Create connections for new database
   QObject::connect(d->dicomDatabase, SIGNAL(instanceAdded(const QString&)),
-                   this, SLOT(onInstanceAdded()));
-  QObject::connect(d->dicomDatabase, SIGNAL(databaseChanged()), this, SLOT(onDatabaseChanged()));
+                   this, SLOT(onInstanceAdded()), Qt::UniqueConnection);
+  QObject::connect(d->dicomDatabase, SIGNAL(databaseChanged()), this, SLOT(onDatabaseChanged()),
+                   Qt::UniqueConnection);
 
   this->setQuery();
   d->hideUIDColumns();
@@ -245,51 +588,124 @@ void ctkDICOMTableView::onSelectionChanged()
 //------------------------------------------------------------------------------
 void ctkDICOMTableView::onDatabaseChanged()
 {
-  setQuery();
+  Q_D(ctkDICOMTableView);
+  if (!d->refreshTimer->isActive())
+    {
+    d->refreshTimer->start();
+    }
 }
 
 //------------------------------------------------------------------------------
 void ctkDICOMTableView::onUpdateQuery(const QStringList& uids)
 {
   Q_D(ctkDICOMTableView);
+  d->EmitQueryChanged = true;
+  this->setQuery(uids);
+}
 
-  setQuery(uids);
+//------------------------------------------------------------------------------
+void ctkDICOMTableView::onFilterChanged()
+{
+  Q_D(ctkDICOMTableView);
+  d->filterTimer->stop();
+  d->EmitQueryChanged = true;
+  d->ClearSelection = true;
+  d->SelectionToRestore.clear();
+  this->setQuery(d->lastQueryUIDs);
+}
 
-  d->showFilterActiveWarning( d->dicomSQLFilterModel->rowCount() == 0 &&
-                              d->leSearchBox->text().length() != 0 );
+//------------------------------------------------------------------------------
+void ctkDICOMTableView::onInstanceAdded()
+{
+  Q_D(ctkDICOMTableView);
+  d->sqlWhereConditions.clear();
+  d->tblDicomDatabaseView->clearSelection();
+  d->leSearchBox->clear();
+  d->lastQueryUIDs.clear();
+  if (!d->refreshTimer->isActive())
+    {
+    d->refreshTimer->start();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMTableView::refresh()
+{
+  Q_D(ctkDICOMTableView);
+  d->refreshTimer->stop();
 
-  const QStringList& newUIDS = this->uidsForAllRows();
-  emit queryChanged(newUIDS);
+  // restored once the model is reset by the query
+  d->SelectionToRestore = this->currentSelection();
+  this->setQuery(d->lastQueryUIDs);
 }
 
 //------------------------------------------------------------------------------
-void ctkDICOMTableView::onFilterChanged()
+void ctkDICOMTableView::onQueryFinished()
 {
   Q_D(ctkDICOMTableView);
+  ctkDICOMTableViewQueryResult result;
+  {
+  QMutexLocker locker(&d->QueryMutex);
+  if (d->QueryResult.Generation != d->QueryGeneration)
+    {
+    // canceled, or already applied by waitForQuery()
+    return;
+    }
+  result = d->QueryResult;
+  d->QueryResult = ctkDICOMTableViewQueryResult();
+  }
 
-  const QStringList uids = this->uidsForAllRows();
+  d->QueryRunning = false;
+  if (result.Failed)
+    {
+    // the worker thread could not open the database, use the main connection
+    logger.warn("Unable to query " + d->queryTableName() + " in the background");
+    d->runQuery(d->dicomDatabase->database(), d->LastQuery, d->LastBindValues, result.Generation);
+    QMutexLocker locker(&d->QueryMutex);
+    result = d->QueryResult;
+    d->QueryResult = ctkDICOMTableViewQueryResult();
+    }
 
-  d->showFilterActiveWarning( d->dicomSQLFilterModel->rowCount() == 0 &&
-                              d->dicomSQLModel.rowCount() != 0);
+  if (d->applyResult(result))
+    {
+    emit queryChanged(this->uidsForQuery());
+    }
+  if (d->SelectAll)
+    {
+    d->SelectAll = false;
+    d->tblDicomDatabaseView->selectAll();
+    }
+}
 
-  d->tblDicomDatabaseView->clearSelection();
-  emit queryChanged(uids);
+//------------------------------------------------------------------------------
+bool ctkDICOMTableView::isQueryRunning() const
+{
+  Q_D(const ctkDICOMTableView);
+  return d->QueryRunning;
 }
 
 //------------------------------------------------------------------------------
-void ctkDICOMTableView::onInstanceAdded()
+void ctkDICOMTableView::waitForQuery()
 {
   Q_D(ctkDICOMTableView);
-  d->sqlWhereConditions.clear();
-  d->tblDicomDatabaseView->clearSelection();
-  d->leSearchBox->clear();
-  setQuery();
+  if (d->filterTimer->isActive())
+    {
+    this->onFilterChanged();
+    }
+  d->QueryPool.waitForDone();
+  this->onQueryFinished();
 }
 
 //------------------------------------------------------------------------------
 void ctkDICOMTableView::selectAll()
 {
   Q_D(ctkDICOMTableView);
+  if (d->QueryRunning)
+    {
+    // select the rows of the running query
+    d->SelectAll = true;
+    return;
+    }
   d->tblDicomDatabaseView->selectAll();
 }
 
@@ -317,13 +733,22 @@ bool ctkDICOMTableView::eventFilter(QObject *obj, QEvent *event)
 void ctkDICOMTableView::setQuery(const QStringList &uids)
 {
   Q_D(ctkDICOMTableView);
+  d->lastQueryUIDs = uids;
+  if (d->dicomDatabase == 0 || !d->dicomDatabase->isOpen())
+    {
+    return;
+    }
+
   QString query = ("select distinct %1.* from Patients, Series, Studies where "
                    "Patients.UID = Studies.PatientsUID and Studies.StudyInstanceUID = Series.StudyInstanceUID");
+  d->QueryRestricted = false;
 
+  // the uid lists can be longer than the number of parameters SQLite
+  // accepts, they are quoted in the query instead
   if (!uids.empty() && d->queryForeignKey.length() != 0)
     {
-      query += " and %1."+d->queryForeignKey+" in ( '";
-      query.append(uids.join("','")).append("')");
+      query += " and %1."+d->queryForeignKey+" in ( "+quotedValues(uids)+")";
+      d->QueryRestricted = true;
     }
   if (!d->sqlWhereConditions.empty())
     {
@@ -332,97 +757,54 @@ void ctkDICOMTableView::setQuery(const QStringList &uids)
         {
           if (!i.value().empty())
             {
-              query += " and "+i.key()+" in ( '";
-              query.append(i.value().join("','")).append("')");
+              query += " and "+i.key()+" in ( "+quotedValues(i.value())+")";
+              d->QueryRestricted = true;
             }
           ++i;
         }
     }
-  if (d->dicomDatabase != 0 && d->dicomDatabase->isOpen())
-    {
-    d->dicomSQLModel.setQuery(query.arg(d->queryTableName()), d->dicomDatabase->database());
-    }
-}
-
-void ctkDICOMTableView::addSqlWhereCondition(const std::pair<QString, QStringList> &condition)
-{
-  Q_D(ctkDICOMTableView);
-  d->sqlWhereConditions.insert(condition.first, condition.second);
-}
 
-//------------------------------------------------------------------------------
-QStringList ctkDICOMTableView::uidsForAllRows() const
-{
-  Q_D(const ctkDICOMTableView);
-  QAbstractItemModel* tableModel = d->tblDicomDatabaseView->model();
-  int numberOfRows = tableModel->rowCount();
-  QStringList uids;
-  if (numberOfRows == 0)
-    {
-      //Return invalid UID if there are no rows
-      uids << QString("#");
-    }
-  else
+  QVariantList bindValues;
+  d->AppliedFilterText = d->leSearchBox->text().trimmed();
+  const QStringList filterColumns = d->filterColumns();
+  if (!d->AppliedFilterText.isEmpty() && !filterColumns.isEmpty())
     {
-      for(int i = 0; i < numberOfRows; ++i)
-        {
-          uids << QString("%1").arg(tableModel->index(i,0).data().toString());
-        }
+    // same wildcards as the former QSortFilterProxyModel filter, the
+    // text can be anywhere in the value
+    QString pattern = d->AppliedFilterText;
+    pattern.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+    pattern.replace("*", "%").replace("?", "_");
+    pattern = "%" + pattern + "%";
+
+    QStringList filterConditions;
+    foreach(const QString& column, filterColumns)
+      {
+      filterConditions << "%1." + column + " like ? escape '\\'";
+      bindValues << pattern;
+      }
+    query += " and ( " + filterConditions.join(" or ") + " )";
+    d->QueryRestricted = true;
     }
-  return uids;
-}
-
-//------------------------------------------------------------------------------
-QStringList ctkDICOMTableView::currentSelection() const
-{
-  Q_D(const ctkDICOMTableView);
 
-  QModelIndexList currentSelection = d->tblDicomDatabaseView->selectionModel()->selectedRows(0);
-  QStringList uids;
+  d->LastQuery = query.arg(d->queryTableName());
+  d->LastBindValues = bindValues;
+  int generation;
+  {
+  QMutexLocker locker(&d->QueryMutex);
+  generation = ++d->QueryGeneration;
+  }
 
-  foreach(QModelIndex i, currentSelection)
+  if (d->dicomDatabase->isInMemory())
     {
-      uids<< i.data().toString();
+    // in-memory databases can't be shared with the worker thread
+    d->runQuery(d->dicomDatabase->database(), d->LastQuery, d->LastBindValues, generation);
+    d->QueryRunning = true;
+    this->onQueryFinished();
+    return;
     }
 
-  return  uids;
-}
-
-//------------------------------------------------------------------------------
-bool ctkDICOMTableView::filterActive()
-{
-  Q_D(ctkDICOMTableView);
-  return (d->leSearchBox->text().length() != 0);
-}
-
-//------------------------------------------------------------------------------
-void ctkDICOMTableView::setTableSectionSize(int size)
-{
-  Q_D(ctkDICOMTableView);
-  d->tblDicomDatabaseView->verticalHeader()->setDefaultSectionSize(size);
-}
-
-//------------------------------------------------------------------------------
-int ctkDICOMTableView::tableSectionSize()
-{
-  Q_D(ctkDICOMTableView);
-  return d->tblDicomDatabaseView->verticalHeader()->defaultSectionSize();
-}
-
-//------------------------------------------------------------------------------
-void ctkDICOMTableView::onCustomContextMenuRequested(const QPoint &point)
-{
-  Q_D(ctkDICOMTableView);
-
-  // translate the local point to a global
-  QPoint globalPosition = d->tblDicomDatabaseView->mapToGlobal(point);
-
-  emit customContextMenuRequested(globalPosition);
-}
-
-//------------------------------------------------------------------------------
-QTableView* ctkDICOMTableView::tableView()
-{
-  Q_D( ctkDICOMTableView );
-  return(d->tblDicomDatabaseView);
+  d->QueryRunning = true;
+  d->QueryPool.start(new ctkDICOMTableViewQueryTask(this, d, d->dicomDatabase,
+                                                    d->LastQuery, d->LastBindValues,
+                                                    generation));
 }
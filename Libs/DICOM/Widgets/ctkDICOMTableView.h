@@ -38,6 +38,11 @@ class QTableView;
  * The ctkDICOMTableView holds a QTableView which displays the content of the selected
  * ctkDICOMDatabase. It also holds a ctkSearchBox which allows filtering of the table content.
  *
+ * The filter text is matched in SQL against the text columns of the table, once
+ * the user stopped typing for filterDelay milliseconds. The queries run on a read-only
+ * connection in a worker thread when the database is a file, a new query cancels
+ * the one in progress. Use waitForQuery() to wait for the results.
+ *
  * @ingroup DICOM_Widgets
  */
 class CTK_DICOM_WIDGETS_EXPORT ctkDICOMTableView : public QWidget
@@ -45,6 +50,7 @@ class CTK_DICOM_WIDGETS_EXPORT ctkDICOMTableView : public QWidget
   Q_OBJECT
   Q_PROPERTY(bool filterActive READ filterActive)
   Q_PROPERTY( QTableView* tblDicomDatabaseView READ tableView )
+  Q_PROPERTY(int filterDelay READ filterDelay WRITE setFilterDelay)
 
 public:
   typedef QWidget Superclass;
@@ -115,8 +121,31 @@ public:
    */
   QStringList uidsForAllRows() const;
 
+  /**
+   * @brief Getting the UIDs to restrict the dependent tables to
+   * @return the uids for all rows, or an empty list if the table is not
+   * filtered and displays all the entries of the database
+   */
+  QStringList uidsForQuery() const;
+
   bool filterActive();
 
+  /**
+   * @brief Delay in ms between the last change of the filter text and the query, 300ms by default
+   */
+  void setFilterDelay(int delay);
+  int filterDelay() const;
+
+  /**
+   * @brief Returns true while a query is running in the worker thread
+   */
+  bool isQueryRunning() const;
+
+  /**
+   * @brief Wait for the running query and update the table with its results
+   */
+  void waitForQuery();
+
   void setTableSectionSize(int);
   int tableSectionSize();
 
@@ -147,6 +176,12 @@ public Q_SLOTS:
    */
   void onCustomContextMenuRequested(const QPoint &point);
 
+  /**
+   * @brief Runs the last query again and restores the selection.
+   * Called when the underlying database changes, at most once every 300ms.
+   */
+  void refresh();
+
 protected Q_SLOTS:
   /**
    * @brief Called when the underlying database changes
@@ -154,7 +189,7 @@ protected Q_SLOTS:
   void onDatabaseChanged();
 
   /**
-   * @brief Called when the text of the ctkSearchBox has changed
+   * @brief Called when the text of the ctkSearchBox has not changed for filterDelay ms
    */
   void onFilterChanged();
 
@@ -163,6 +198,11 @@ protected Q_SLOTS:
    */
   void onInstanceAdded();
 
+  /**
+   * @brief Called when the worker thread finished a query, updates the table
+   */
+  void onQueryFinished();
+
   void selectAll();
 
 protected:
@@ -182,7 +222,7 @@ Q_SIGNALS:
 
   /**
    * @brief Is emitted when the query text has changed
-   * @param uids the list of uids of the objects included in the query
+   * @param uids the list of uids of the objects included in the query, see uidsForQuery()
    */
   void queryChanged(const QStringList &uids);
 
@@ -20,18 +20,42 @@
 =========================================================================*/
 
 // ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
 #include "ctkDICOMThumbnailGenerator.h"
 #include "ctkLogger.h"
 
 // Qt includes
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QImage>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QTime>
 
 // DCMTK includes
 #include "dcmimage.h"
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcfilefo.h>
+
+// STD includes
+#include <cstdio>
 
 static ctkLogger logger ( "org.commontk.dicom.DICOMThumbnailGenerator" );
 struct Node;
 
+//------------------------------------------------------------------------------
+/// A series queued by generateSeriesThumbnails().
+struct ctkDICOMThumbnailBatchSeries
+{
+  QString StudyInstanceUID;
+  QString SeriesInstanceUID;
+  QStringList Files;
+};
+
 //------------------------------------------------------------------------------
 class ctkDICOMThumbnailGeneratorPrivate
 {
@@ -41,6 +65,29 @@ public:
   ctkDICOMThumbnailGeneratorPrivate(ctkDICOMThumbnailGenerator&);
   virtual ~ctkDICOMThumbnailGeneratorPrivate();
 
+  /// Called from the pool threads.
+  void generateSeriesThumbnail(const ctkDICOMThumbnailBatchSeries& series, int batch);
+
+  /// Generate the thumbnail of a frame of filePath, scaled down by DCMTK.
+  bool generateScaledThumbnail(const QString& filePath, unsigned long frame,
+                               const QString& thumbnailPath);
+
+  QThreadPool BatchPool;
+
+  /// Protects the members below, shared with the pool threads.
+  mutable QMutex BatchMutex;
+  /// Incremented by each batch and by cancelBatch(), the series of a
+  /// previous batch are discarded.
+  int Batch;
+  ctkDICOMDatabase* BatchDatabase;
+  bool BatchRegenerate;
+  int BatchSeriesCount;
+  int ProcessedSeriesCount;
+  int DecodedImageCount;
+  int GeneratedThumbnailCount;
+  QTime BatchTime;
+  double BatchThroughput;
+
 protected:
   ctkDICOMThumbnailGenerator* const q_ptr;
 
@@ -49,15 +96,207 @@ private:
 };
 
 //------------------------------------------------------------------------------
-ctkDICOMThumbnailGeneratorPrivate::ctkDICOMThumbnailGeneratorPrivate(ctkDICOMThumbnailGenerator& o):q_ptr(&o)
+class ctkDICOMThumbnailBatchTask : public QRunnable
 {
+public:
+  ctkDICOMThumbnailBatchTask(ctkDICOMThumbnailGeneratorPrivate* generator,
+                             const ctkDICOMThumbnailBatchSeries& series, int batch)
+    : Generator(generator)
+    , Series(series)
+    , Batch(batch)
+  {
+  }
 
+  virtual void run()
+  {
+    this->Generator->generateSeriesThumbnail(this->Series, this->Batch);
+  }
+
+private:
+  ctkDICOMThumbnailGeneratorPrivate* Generator;
+  ctkDICOMThumbnailBatchSeries Series;
+  int Batch;
+};
+
+//------------------------------------------------------------------------------
+/// Read the header of filePath, the pixel data is not loaded.
+static bool readSliceHeader(const QString& filePath, QString& sopInstanceUID,
+                            long& instanceNumber, long& numberOfFrames)
+{
+  DcmFileFormat fileFormat;
+  OFCondition status = fileFormat.loadFile(
+    QDir::toNativeSeparators(filePath).toLatin1().data(),
+    EXS_Unknown, EGL_noChange, 64 /* maxReadLength */);
+  if (status.bad())
+    {
+    return false;
+    }
+  DcmDataset* dataset = fileFormat.getDataset();
+  OFString uid;
+  if (dataset->findAndGetOFString(DCM_SOPInstanceUID, uid).bad())
+    {
+    return false;
+    }
+  sopInstanceUID = QString(uid.c_str());
+  Sint32 value = 0;
+  instanceNumber = dataset->findAndGetSint32(DCM_InstanceNumber, value).good() ? value : 0;
+  value = 1;
+  numberOfFrames = dataset->findAndGetSint32(DCM_NumberOfFrames, value).good() ? value : 1;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailGeneratorPrivate::ctkDICOMThumbnailGeneratorPrivate(ctkDICOMThumbnailGenerator& o)
+  : Batch(0)
+  , BatchDatabase(0)
+  , BatchRegenerate(false)
+  , BatchSeriesCount(0)
+  , ProcessedSeriesCount(0)
+  , DecodedImageCount(0)
+  , GeneratedThumbnailCount(0)
+  , BatchThroughput(0.)
+  , q_ptr(&o)
+{
 }
 
 //------------------------------------------------------------------------------
 ctkDICOMThumbnailGeneratorPrivate::~ctkDICOMThumbnailGeneratorPrivate()
 {
+  {
+  QMutexLocker locker(&this->BatchMutex);
+  ++this->Batch;
+  }
+  this->BatchPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailGeneratorPrivate::generateSeriesThumbnail(
+  const ctkDICOMThumbnailBatchSeries& series, int batch)
+{
+  Q_Q(ctkDICOMThumbnailGenerator);
+  ctkDICOMDatabase* database;
+  bool regenerate;
+  {
+  QMutexLocker locker(&this->BatchMutex);
+  if (batch != this->Batch)
+    {
+    return;
+    }
+  database = this->BatchDatabase;
+  regenerate = this->BatchRegenerate;
+  }
+
+  bool decoded = false;
+  bool generated = false;
+  // thumbnailPathForInstance() only depends on the database directory
+  QDir seriesDirectory = QFileInfo(database->thumbnailPathForInstance(
+    series.StudyInstanceUID, series.SeriesInstanceUID, "series")).absoluteDir();
+  if (regenerate || seriesDirectory.entryList(QStringList("*.png"), QDir::Files).isEmpty())
+    {
+    // order the slices by instance number to pick the middle one
+    QMap<long, QPair<QString, QString> > slices;
+    long numberOfFrames = 1;
+    foreach(const QString& filePath, series.Files)
+      {
+      QString sopInstanceUID;
+      long instanceNumber;
+      if (readSliceHeader(filePath, sopInstanceUID, instanceNumber, numberOfFrames))
+        {
+        slices.insertMulti(instanceNumber, qMakePair(filePath, sopInstanceUID));
+        }
+      }
+    if (!slices.isEmpty())
+      {
+      QMap<long, QPair<QString, QString> >::const_iterator middle = slices.constBegin() + (slices.count() / 2);
+      const QString thumbnailPath = database->thumbnailPathForInstance(
+        series.StudyInstanceUID, series.SeriesInstanceUID, middle.value().second);
+      // the middle frame if the series is a single multi-frame file
+      const unsigned long frame = slices.count() == 1 ? numberOfFrames / 2 : 0;
+      decoded = true;
+      generated = this->generateScaledThumbnail(middle.value().first, frame, thumbnailPath);
+      }
+    }
+
+  QMutexLocker locker(&this->BatchMutex);
+  if (batch != this->Batch)
+    {
+    return;
+    }
+  ++this->ProcessedSeriesCount;
+  if (decoded)
+    {
+    ++this->DecodedImageCount;
+    }
+  if (generated)
+    {
+    ++this->GeneratedThumbnailCount;
+    }
+  const int elapsed = this->BatchTime.elapsed();
+  this->BatchThroughput = elapsed > 0 ? this->DecodedImageCount * 1000. / elapsed : 0.;
+  const int processed = this->ProcessedSeriesCount;
+  const int total = this->BatchSeriesCount;
+  const int generatedCount = this->GeneratedThumbnailCount;
+  const double throughput = this->BatchThroughput;
+  locker.unlock();
+
+  emit q->batchProgress(processed, total, throughput);
+  if (processed == total)
+    {
+    logger.info(QString("Generated %1 thumbnails of %2 series, %3 images/s")
+                .arg(generatedCount).arg(total).arg(throughput, 0, 'f', 1));
+    emit q->batchFinished(generatedCount);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMThumbnailGeneratorPrivate::generateScaledThumbnail(const QString& filePath,
+                                                                unsigned long frame,
+                                                                const QString& thumbnailPath)
+{
+  Q_Q(ctkDICOMThumbnailGenerator);
+  // only the frame to render is decoded
+  DicomImage dcmImage(QDir::toNativeSeparators(filePath).toLatin1(),
+                      CIF_UsePartialAccessToPixelData, frame, 1);
+  if (dcmImage.getStatus() != EIS_Normal)
+    {
+    logger.warn("Unable to decode " + filePath + ": "
+                + DicomImage::getString(dcmImage.getStatus()));
+    return false;
+    }
+  // render the scaled image rather than the full resolution one, the
+  // longest side is the size of the thumbnails
+  const unsigned long width = dcmImage.getWidth();
+  const unsigned long height = dcmImage.getHeight();
+  QScopedPointer<DicomImage> scaledImage;
+  if (width > 128 || height > 128)
+    {
+    scaledImage.reset(width >= height ?
+      dcmImage.createScaledImage(128ul, 0ul, 1 /* interpolate */, 1 /* aspect */) :
+      dcmImage.createScaledImage(0ul, 128ul, 1 /* interpolate */, 1 /* aspect */));
+    }
+  DicomImage* image = scaledImage.isNull() ? &dcmImage : scaledImage.data();
 
+  QDir().mkpath(QFileInfo(thumbnailPath).absolutePath());
+  const QString temporaryPath = thumbnailPath + ".part";
+  if (!q->generateThumbnail(image, temporaryPath))
+    {
+    QFile::remove(temporaryPath);
+    return false;
+    }
+  // rename() replaces the thumbnail atomically on POSIX systems, other
+  // systems require the thumbnail to be removed first
+  if (std::rename(QFile::encodeName(temporaryPath).constData(),
+                  QFile::encodeName(thumbnailPath).constData()) != 0)
+    {
+    QFile::remove(thumbnailPath);
+    if (!QFile::rename(temporaryPath, thumbnailPath))
+      {
+      logger.warn("Unable to write thumbnail " + thumbnailPath);
+      QFile::remove(temporaryPath);
+      return false;
+      }
+    }
+  return true;
 }
 
 
@@ -73,6 +312,115 @@ ctkDICOMThumbnailGenerator::~ctkDICOMThumbnailGenerator()
 {
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailGenerator::setMaximumBatchThreadCount(int threadCount)
+{
+  Q_D(ctkDICOMThumbnailGenerator);
+  d->BatchPool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailGenerator::maximumBatchThreadCount()const
+{
+  Q_D(const ctkDICOMThumbnailGenerator);
+  return d->BatchPool.maxThreadCount();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailGenerator::generateSeriesThumbnails(ctkDICOMDatabase* database,
+                                                         bool regenerate)
+{
+  Q_D(ctkDICOMThumbnailGenerator);
+  if (!database || !database->isOpen() || this->isBatchRunning())
+    {
+    return 0;
+    }
+
+  QList<ctkDICOMThumbnailBatchSeries> seriesList;
+  foreach(const QString& patient, database->patients())
+    {
+    foreach(const QString& study, database->studiesForPatient(patient))
+      {
+      foreach(const QString& seriesInstanceUID, database->seriesForStudy(study))
+        {
+        ctkDICOMThumbnailBatchSeries series;
+        series.StudyInstanceUID = study;
+        series.SeriesInstanceUID = seriesInstanceUID;
+        series.Files = database->filesForSeries(seriesInstanceUID);
+        if (!series.Files.isEmpty())
+          {
+          seriesList << series;
+          }
+        }
+      }
+    }
+  if (seriesList.isEmpty())
+    {
+    return 0;
+    }
+
+  int batch;
+  {
+  QMutexLocker locker(&d->BatchMutex);
+  batch = ++d->Batch;
+  d->BatchDatabase = database;
+  d->BatchRegenerate = regenerate;
+  d->BatchSeriesCount = seriesList.count();
+  d->ProcessedSeriesCount = 0;
+  d->DecodedImageCount = 0;
+  d->GeneratedThumbnailCount = 0;
+  d->BatchThroughput = 0.;
+  d->BatchTime.start();
+  }
+  foreach(const ctkDICOMThumbnailBatchSeries& series, seriesList)
+    {
+    d->BatchPool.start(new ctkDICOMThumbnailBatchTask(d, series, batch));
+    }
+  return seriesList.count();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMThumbnailGenerator::isBatchRunning()const
+{
+  Q_D(const ctkDICOMThumbnailGenerator);
+  QMutexLocker locker(&d->BatchMutex);
+  return d->BatchDatabase != 0 && d->ProcessedSeriesCount < d->BatchSeriesCount;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailGenerator::waitForBatch()
+{
+  Q_D(ctkDICOMThumbnailGenerator);
+  d->BatchPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+double ctkDICOMThumbnailGenerator::batchThroughput()const
+{
+  Q_D(const ctkDICOMThumbnailGenerator);
+  QMutexLocker locker(&d->BatchMutex);
+  return d->BatchThroughput;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailGenerator::cancelBatch()
+{
+  Q_D(ctkDICOMThumbnailGenerator);
+  int generatedCount;
+  {
+  QMutexLocker locker(&d->BatchMutex);
+  if (d->BatchDatabase == 0 || d->ProcessedSeriesCount >= d->BatchSeriesCount)
+    {
+    return;
+    }
+  ++d->Batch;
+  // the series being processed are not reported anymore
+  d->BatchSeriesCount = d->ProcessedSeriesCount;
+  generatedCount = d->GeneratedThumbnailCount;
+  }
+  emit batchFinished(generatedCount);
+}
+
 //------------------------------------------------------------------------------
 bool ctkDICOMThumbnailGenerator::generateThumbnail(DicomImage *dcmImage, const QString &path){
     QImage image;
@@ -26,6 +26,7 @@
 #include "ctkDICOMWidgetsExport.h"
 #include "ctkDICOMAbstractThumbnailGenerator.h"
 
+class ctkDICOMDatabase;
 class ctkDICOMThumbnailGeneratorPrivate;
 class DicomImage;
 
@@ -33,9 +34,15 @@ class DicomImage;
 ///
 /// \brief  thumbnail generator class
 ///
+/// generateSeriesThumbnails() backfills the thumbnails of a database that
+/// has been imported without them, e.g. with a database without thumbnail
+/// generator. One thumbnail is generated per series, from its middle slice,
+/// on a pool of threads. generateThumbnail() is thread safe.
+///
 class CTK_DICOM_WIDGETS_EXPORT ctkDICOMThumbnailGenerator : public ctkDICOMAbstractThumbnailGenerator
 {
   Q_OBJECT
+  Q_PROPERTY(int maximumBatchThreadCount READ maximumBatchThreadCount WRITE setMaximumBatchThreadCount)
 public:
   ///  \brief Construct a ctkDICOMThumbnailGenerator object
   ///
@@ -44,6 +51,45 @@ public:
 
   virtual bool generateThumbnail(DicomImage* dcmImage, const QString& path );
 
+  /// Number of threads used by generateSeriesThumbnails(), the number of
+  /// cores by default.
+  void setMaximumBatchThreadCount(int threadCount);
+  int maximumBatchThreadCount()const;
+
+  /// Generate the thumbnail of the middle slice of each series of database,
+  /// ordered by instance number (or the middle frame of a multi-frame
+  /// series of one file). The image is scaled down by DCMTK before being
+  /// rendered and the thumbnail is written to a temporary file renamed
+  /// once complete, so that it can't be read partially written.
+  /// Series that already have a thumbnail are skipped unless regenerate
+  /// is true.
+  /// The series are listed from the calling thread, the thumbnails are
+  /// generated asynchronously. Progress is reported by batchProgress().
+  /// Returns the number of series queued, 0 if a batch is already running.
+  int generateSeriesThumbnails(ctkDICOMDatabase* database, bool regenerate = false);
+
+  /// Returns true until the queued series of generateSeriesThumbnails()
+  /// are processed or canceled.
+  bool isBatchRunning()const;
+
+  /// Wait for the series queued by generateSeriesThumbnails().
+  void waitForBatch();
+
+  /// Images decoded per second by the running or the last batch.
+  double batchThroughput()const;
+
+public Q_SLOTS:
+  /// Discard the series that are not processed yet.
+  void cancelBatch();
+
+Q_SIGNALS:
+  /// Emitted from the pool threads each time a series is processed,
+  /// use a queued connection to update widgets.
+  void batchProgress(int processedSeries, int totalSeries, double imagesPerSecond);
+
+  /// Emitted from a pool thread once all the series are processed or canceled.
+  void batchFinished(int generatedThumbnails);
+
 protected:
   QScopedPointer<ctkDICOMThumbnailGeneratorPrivate> d_ptr;
 
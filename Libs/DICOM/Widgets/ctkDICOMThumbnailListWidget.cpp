@@ -19,44 +19,89 @@
 =========================================================================*/
 
 // Qt include
-#include <QDateTime>
+#include <QAbstractListModel>
 #include <QDir>
-#include <QFile>
 #include <QFileInfo>
-#include <QGridLayout>
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QListView>
 #include <QMetaType>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPersistentModelIndex>
 #include <QPixmap>
-#include <QPushButton>
-#include <QResizeEvent>
+#include <QPixmapCache>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QVBoxLayout>
 
 // ctk includes
 #include "ctkLogger.h"
 
 // ctkWidgets includes
-#include "ctkFlowLayout.h"
 #include "ctkThumbnailListWidget_p.h"
 #include "ui_ctkThumbnailListWidget.h"
 
 //ctkDICOMCore includes
 #include "ctkDICOMDatabase.h"
-#include "ctkDICOMFilterProxyModel.h"
 #include "ctkDICOMModel.h"
+#include "ctkDICOMThumbnailQueue.h"
 
 // ctkDICOMWidgets includes
 #include "ctkDICOMThumbnailListWidget.h"
 #include "ctkThumbnailLabel.h"
 
-// STD includes
-#include <iostream>
-
-// DCMTK includes
-#include <dcmimage.h>
-
 static ctkLogger logger("org.commontk.DICOM.Widgets.ctkDICOMThumbnailListWidget");
 
 Q_DECLARE_METATYPE(QPersistentModelIndex);
 
+class ctkDICOMThumbnailListWidgetPrivate;
+
+//----------------------------------------------------------------------------
+/// A thumbnail of the list, the pixmap is only looked up when the cell
+/// is painted.
+struct ctkDICOMThumbnailListItem
+{
+  QPersistentModelIndex SourceIndex;
+  QString Text;
+  QString StudyInstanceUID;
+  QString SeriesInstanceUID;
+  QString SOPInstanceUID;
+  QString ThumbnailPath;
+  /// The thumbnail file has been looked for
+  bool Checked;
+  /// The thumbnail file is being generated, a placeholder is displayed
+  bool Generating;
+};
+
+//----------------------------------------------------------------------------
+/// Model of the list view, the data is held by ctkDICOMThumbnailListWidgetPrivate
+class ctkDICOMThumbnailListModel : public QAbstractListModel
+{
+public:
+  ctkDICOMThumbnailListModel(ctkDICOMThumbnailListWidgetPrivate* widget, QObject* parent)
+    : QAbstractListModel(parent)
+    , Widget(widget)
+  {
+  }
+
+  virtual int rowCount(const QModelIndex& parent = QModelIndex())const;
+  virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole)const;
+
+  void beginReset() { this->beginResetModel(); }
+  void endReset() { this->endResetModel(); }
+  void rowChanged(int row)
+  {
+    QModelIndex changed = this->index(row, 0);
+    emit dataChanged(changed, changed);
+  }
+
+private:
+  ctkDICOMThumbnailListWidgetPrivate* Widget;
+};
+
 //----------------------------------------------------------------------------
 class ctkDICOMThumbnailListWidgetPrivate : ctkThumbnailListWidgetPrivate
 {
@@ -66,10 +111,48 @@ public:
 
   ctkDICOMThumbnailListWidgetPrivate(ctkDICOMThumbnailListWidget* parent);
 
+  void initView();
+
   QString DatabaseDirectory;
   QModelIndex CurrentSelectedModel;
-
-  void addThumbnailWidget(const QModelIndex &imageIndex, const QModelIndex& sourceIndex, const QString& text);
+  ctkDICOMDatabase* DICOMDatabase;
+
+  QListView* View;
+  ctkDICOMThumbnailListModel* Model;
+  QList<ctkDICOMThumbnailListItem> Items;
+  /// Rows of the items displaying a thumbnail file, as the thumbnail or
+  /// as the placeholder of their series
+  QHash<QString, QList<int> > RowsForThumbnail;
+  /// First thumbnail found in the directory of a series, see placeholderThumbnail()
+  QHash<QString, QString> SeriesPlaceholders;
+
+  /// Decodes the thumbnail files
+  QThreadPool LoadPool;
+  /// Thumbnails being decoded, only used in the GUI thread
+  QSet<QString> Loading;
+  /// Protects Generation, incremented when the items are cleared so that
+  /// the decodings queued for the previous items are discarded
+  QMutex GenerationMutex;
+  int Generation;
+  int generation();
+
+  /// Label given to the signals of ctkThumbnailListWidget
+  ctkThumbnailLabel* SelectedLabel;
+  void updateSelectedLabel(int row);
+
+  /// Returns another thumbnail of the series to display while the
+  /// thumbnail of the image is being generated, empty if there is none.
+  QString placeholderThumbnail(const QString& thumbnailPath);
+
+  /// Returns the icon of the item at row, queues the decoding of the
+  /// thumbnail file if it is not in the pixmap cache yet.
+  QVariant decoration(int row);
+  /// Returns the cached pixmap of thumbnailPath, queues its decoding
+  /// and returns a null pixmap if it is not cached.
+  QPixmap cachedPixmap(const QString& thumbnailPath, int row);
+
+  void clearItems();
+  void addThumbnailItem(const QModelIndex &imageIndex, const QModelIndex& sourceIndex, const QString& text);
 
   void addPatientThumbnails(const QModelIndex& patientIndex);
   void addStudyThumbnails(const QModelIndex& studyIndex);
@@ -79,6 +162,70 @@ private:
   Q_DISABLE_COPY( ctkDICOMThumbnailListWidgetPrivate );
 };
 
+//----------------------------------------------------------------------------
+class ctkDICOMThumbnailLoadTask : public QRunnable
+{
+public:
+  ctkDICOMThumbnailLoadTask(ctkDICOMThumbnailListWidgetPrivate* widget,
+                            QObject* receiver,
+                            const QString& thumbnailPath, int generation)
+    : Widget(widget)
+    , Receiver(receiver)
+    , ThumbnailPath(thumbnailPath)
+    , Generation(generation)
+  {
+  }
+
+  virtual void run()
+  {
+    QImage image;
+    // the items have changed since the decoding was queued
+    if (this->Widget->generation() == this->Generation)
+      {
+      image.load(this->ThumbnailPath);
+      }
+    // QPixmap can only be used in the GUI thread
+    QMetaObject::invokeMethod(this->Receiver, "onThumbnailLoaded", Qt::QueuedConnection,
+                              Q_ARG(QString, this->ThumbnailPath),
+                              Q_ARG(QImage, image),
+                              Q_ARG(int, this->Generation));
+  }
+
+private:
+  ctkDICOMThumbnailListWidgetPrivate* Widget;
+  QObject* Receiver;
+  QString ThumbnailPath;
+  int Generation;
+};
+
+//----------------------------------------------------------------------------
+// ctkDICOMThumbnailListModel methods
+
+//----------------------------------------------------------------------------
+int ctkDICOMThumbnailListModel::rowCount(const QModelIndex& parent)const
+{
+  return parent.isValid() ? 0 : this->Widget->Items.count();
+}
+
+//----------------------------------------------------------------------------
+QVariant ctkDICOMThumbnailListModel::data(const QModelIndex& index, int role)const
+{
+  if (!index.isValid() || index.row() >= this->Widget->Items.count())
+    {
+    return QVariant();
+    }
+  switch (role)
+    {
+    case Qt::DisplayRole:
+      return this->Widget->Items[index.row()].Text;
+    case Qt::DecorationRole:
+      return this->Widget->decoration(index.row());
+    default:
+      break;
+    }
+  return QVariant();
+}
+
 //----------------------------------------------------------------------------
 // ctkDICOMThumbnailListWidgetPrivate methods
 
@@ -86,8 +233,155 @@ private:
 ctkDICOMThumbnailListWidgetPrivate
 ::ctkDICOMThumbnailListWidgetPrivate(ctkDICOMThumbnailListWidget* parent)
   : Superclass(parent)
+  , DICOMDatabase(0)
+  , View(0)
+  , Model(0)
+  , Generation(0)
+  , SelectedLabel(0)
+{
+  this->LoadPool.setMaxThreadCount(2);
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidgetPrivate::initView()
+{
+  Q_Q(ctkDICOMThumbnailListWidget);
+
+  // the list view replaces the scroll area of ctkThumbnailListWidget
+  this->ScrollArea->hide();
+
+  this->Model = new ctkDICOMThumbnailListModel(this, q);
+  this->View = new QListView(q);
+  this->View->setViewMode(QListView::IconMode);
+  this->View->setMovement(QListView::Static);
+  this->View->setResizeMode(QListView::Adjust);
+  this->View->setWrapping(true);
+  this->View->setUniformItemSizes(true);
+  this->View->setLayoutMode(QListView::Batched);
+  this->View->setSelectionMode(QAbstractItemView::SingleSelection);
+  this->View->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  this->View->setModel(this->Model);
+  q->layout()->addWidget(this->View);
+
+  this->SelectedLabel = new ctkThumbnailLabel(q);
+  this->SelectedLabel->hide();
+
+  QObject::connect(this->View, SIGNAL(clicked(QModelIndex)),
+                   q, SLOT(onViewClicked(QModelIndex)));
+  QObject::connect(this->View, SIGNAL(doubleClicked(QModelIndex)),
+                   q, SLOT(onViewDoubleClicked(QModelIndex)));
+
+  q->setThumbnailSize(this->ThumbnailSize);
+}
+
+//----------------------------------------------------------------------------
+int ctkDICOMThumbnailListWidgetPrivate::generation()
+{
+  QMutexLocker locker(&this->GenerationMutex);
+  return this->Generation;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidgetPrivate::updateSelectedLabel(int row)
+{
+  const ctkDICOMThumbnailListItem& item = this->Items[row];
+  this->SelectedLabel->setText(item.Text);
+  this->SelectedLabel->setProperty("thumbnailPath", item.ThumbnailPath);
+  QVariant var;
+  var.setValue(item.SourceIndex);
+  this->SelectedLabel->setProperty("sourceIndex", var);
+}
+
+//----------------------------------------------------------------------------
+QString ctkDICOMThumbnailListWidgetPrivate
+::placeholderThumbnail(const QString& thumbnailPath)
+{
+  QDir seriesDirectory = QFileInfo(thumbnailPath).absoluteDir();
+  QHash<QString, QString>::const_iterator placeholder =
+    this->SeriesPlaceholders.constFind(seriesDirectory.path());
+  if (placeholder != this->SeriesPlaceholders.constEnd())
+    {
+    return placeholder.value();
+    }
+  QStringList thumbnails = seriesDirectory.entryList(QStringList("*.png"), QDir::Files);
+  if (thumbnails.isEmpty())
+    {
+    // look again once a thumbnail of the series has been generated
+    return QString();
+    }
+  QString placeholderPath = seriesDirectory.absoluteFilePath(thumbnails.first());
+  this->SeriesPlaceholders.insert(seriesDirectory.path(), placeholderPath);
+  return placeholderPath;
+}
+
+//----------------------------------------------------------------------------
+QVariant ctkDICOMThumbnailListWidgetPrivate::decoration(int row)
+{
+  ctkDICOMThumbnailListItem& item = this->Items[row];
+  if (!item.Checked)
+    {
+    item.Checked = true;
+    // Thumbnails are generated lazily: ask for this one and display
+    // another image of the series until it is ready.
+    item.Generating = !QFileInfo(item.ThumbnailPath).exists()
+      && this->DICOMDatabase
+      && this->DICOMDatabase->requestThumbnail(
+        item.StudyInstanceUID, item.SeriesInstanceUID, item.SOPInstanceUID);
+    }
+  QString pixmapPath = item.ThumbnailPath;
+  if (item.Generating)
+    {
+    pixmapPath = this->placeholderThumbnail(item.ThumbnailPath);
+    }
+  if (pixmapPath.isEmpty())
+    {
+    return QVariant();
+    }
+  QPixmap pixmap = this->cachedPixmap(pixmapPath, row);
+  if (pixmap.isNull())
+    {
+    return QVariant();
+    }
+  // unlike a QPixmap, an icon is scaled down to the icon size of the view
+  return QIcon(pixmap);
+}
+
+//----------------------------------------------------------------------------
+QPixmap ctkDICOMThumbnailListWidgetPrivate::cachedPixmap(const QString& thumbnailPath, int row)
 {
+  Q_Q(ctkDICOMThumbnailListWidget);
+  QPixmap pixmap;
+  if (QPixmapCache::find(thumbnailPath, &pixmap))
+    {
+    return pixmap;
+    }
+  QList<int>& rows = this->RowsForThumbnail[thumbnailPath];
+  if (!rows.contains(row))
+    {
+    rows << row;
+    }
+  if (!this->Loading.contains(thumbnailPath))
+    {
+    this->Loading.insert(thumbnailPath);
+    this->LoadPool.start(new ctkDICOMThumbnailLoadTask(this, q, thumbnailPath, this->generation()));
+    }
+  return pixmap;
+}
 
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidgetPrivate::clearItems()
+{
+  {
+  QMutexLocker locker(&this->GenerationMutex);
+  ++this->Generation;
+  }
+  this->Model->beginReset();
+  this->Items.clear();
+  this->RowsForThumbnail.clear();
+  this->SeriesPlaceholders.clear();
+  this->Loading.clear();
+  this->Model->endReset();
+  this->CurrentThumbnail = -1;
 }
 
 //----------------------------------------------------------------------------
@@ -112,7 +406,7 @@ void ctkDICOMThumbnailListWidgetPrivate
       const int imageCount = model->rowCount(seriesIndex);
       QModelIndex imageIndex = seriesIndex.child(imageCount/2, 0);
       QString study = model->data(studyIndex, Qt::DisplayRole).toString();
-      this->addThumbnailWidget(imageIndex, studyIndex, study);
+      this->addThumbnailItem(imageIndex, studyIndex, study);
       }
     }
 }
@@ -138,7 +432,7 @@ void ctkDICOMThumbnailListWidgetPrivate
     model->fetchMore(seriesIndex);
     int imageCount = model->rowCount(seriesIndex);
     QModelIndex imageIndex = seriesIndex.child(imageCount/2, 0);
-    this->addThumbnailWidget(imageIndex, seriesIndex, model->data(seriesIndex, Qt::DisplayRole).toString());
+    this->addThumbnailItem(imageIndex, seriesIndex, model->data(seriesIndex, Qt::DisplayRole).toString());
     }
 }
 
@@ -146,7 +440,6 @@ void ctkDICOMThumbnailListWidgetPrivate
 void ctkDICOMThumbnailListWidgetPrivate
 ::addSeriesThumbnails(const QModelIndex &index)
 {
-  QModelIndex studyIndex = index.parent();
   QModelIndex seriesIndex = index;
 
   ctkDICOMModel* model = const_cast<ctkDICOMModel*>(qobject_cast<const ctkDICOMModel*>(index.model()));
@@ -155,7 +448,11 @@ void ctkDICOMThumbnailListWidgetPrivate
     {
     return;
     }
-  model->fetchMore(seriesIndex);
+  // the model fetches the images by pages, get them all
+  while (model->canFetchMore(seriesIndex))
+    {
+    model->fetchMore(seriesIndex);
+    }
 
   const int imageCount = model->rowCount(seriesIndex);
   logger.debug(QString("Thumbs: %1").arg(imageCount));
@@ -163,18 +460,16 @@ void ctkDICOMThumbnailListWidgetPrivate
     {
     QModelIndex imageIndex = seriesIndex.child(i,0);
 
-    this->addThumbnailWidget(imageIndex, imageIndex, QString("Image %1").arg(i));
+    this->addThumbnailItem(imageIndex, imageIndex, QString("Image %1").arg(i));
     }
 }
 
 //----------------------------------------------------------------------------
 void ctkDICOMThumbnailListWidgetPrivate
-::addThumbnailWidget(const QModelIndex& imageIndex,
-                     const QModelIndex& sourceIndex, const QString &text)
+::addThumbnailItem(const QModelIndex& imageIndex,
+                   const QModelIndex& sourceIndex, const QString &text)
 {
-  ctkDICOMModel* model = const_cast<ctkDICOMModel*>(
-    qobject_cast<const ctkDICOMModel*>(imageIndex.model()));
-
+  const QAbstractItemModel* model = imageIndex.model();
   if(!model)
     {
     return;
@@ -182,31 +477,17 @@ void ctkDICOMThumbnailListWidgetPrivate
   QModelIndex seriesIndex = imageIndex.parent();
   QModelIndex studyIndex = seriesIndex.parent();
 
-  QString thumbnailPath = this->DatabaseDirectory +
-                          "/thumbs/" + model->data(studyIndex ,ctkDICOMModel::UIDRole).toString() + "/" +
-                          model->data(seriesIndex ,ctkDICOMModel::UIDRole).toString() + "/" +
-                          model->data(imageIndex, ctkDICOMModel::UIDRole).toString() + ".png";
-  if(!QFileInfo(thumbnailPath).exists())
-    {
-    return;
-    }
-  ctkThumbnailLabel* widget = new ctkThumbnailLabel(this->ScrollAreaContentWidget);
-
-  QString widgetLabel = text;
-  widget->setText( widgetLabel );
-  QPixmap pix(thumbnailPath);
-  logger.debug("Setting pixmap to " + thumbnailPath);
-  if(this->ThumbnailSize.isValid())
-    {
-    widget->setFixedSize(this->ThumbnailSize);
-    }
-  widget->setPixmap(pix);
-
-  QVariant var;
-  var.setValue(QPersistentModelIndex(sourceIndex));
-  widget->setProperty("sourceIndex", var);
-
-  this->addThumbnail(widget);
+  ctkDICOMThumbnailListItem item;
+  item.SourceIndex = sourceIndex;
+  item.Text = text;
+  item.StudyInstanceUID = model->data(studyIndex ,ctkDICOMModel::UIDRole).toString();
+  item.SeriesInstanceUID = model->data(seriesIndex ,ctkDICOMModel::UIDRole).toString();
+  item.SOPInstanceUID = model->data(imageIndex, ctkDICOMModel::UIDRole).toString();
+  item.ThumbnailPath = this->DatabaseDirectory + "/thumbs/" +
+    item.StudyInstanceUID + "/" + item.SeriesInstanceUID + "/" + item.SOPInstanceUID + ".png";
+  item.Checked = false;
+  item.Generating = false;
+  this->Items << item;
 }
 
 //----------------------------------------------------------------------------
@@ -216,13 +497,16 @@ void ctkDICOMThumbnailListWidgetPrivate
 ctkDICOMThumbnailListWidget::ctkDICOMThumbnailListWidget(QWidget* _parent)
   : Superclass(new ctkDICOMThumbnailListWidgetPrivate(this), _parent)
 {
-
+  Q_D(ctkDICOMThumbnailListWidget);
+  d->initView();
 }
 
 //----------------------------------------------------------------------------
 ctkDICOMThumbnailListWidget::~ctkDICOMThumbnailListWidget()
 {
-
+  Q_D(ctkDICOMThumbnailListWidget);
+  d->clearItems();
+  d->LoadPool.waitForDone();
 }
 
 //----------------------------------------------------------------------------
@@ -232,6 +516,101 @@ void ctkDICOMThumbnailListWidget::setDatabaseDirectory(const QString &directory)
   d->DatabaseDirectory = directory;
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::setDICOMDatabase(ctkDICOMDatabase* database)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+
+  if (d->DICOMDatabase)
+    {
+    disconnect(d->DICOMDatabase->thumbnailQueue(), SIGNAL(thumbnailGenerated(QString)),
+               this, SLOT(onThumbnailGenerated(QString)));
+    }
+  d->DICOMDatabase = database;
+  if (d->DICOMDatabase)
+    {
+    // the thumbnails are generated on other threads
+    connect(d->DICOMDatabase->thumbnailQueue(), SIGNAL(thumbnailGenerated(QString)),
+            this, SLOT(onThumbnailGenerated(QString)), Qt::QueuedConnection);
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::onThumbnailGenerated(const QString& thumbnailPath)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+
+  QPixmapCache::remove(thumbnailPath);
+  for (int row = 0; row < d->Items.count(); ++row)
+    {
+    ctkDICOMThumbnailListItem& item = d->Items[row];
+    if (item.ThumbnailPath == thumbnailPath)
+      {
+      item.Generating = false;
+      d->Model->rowChanged(row);
+      }
+    else if (item.Generating)
+      {
+      // the series may not have had a placeholder yet
+      d->Model->rowChanged(row);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::onThumbnailLoaded(const QString& thumbnailPath,
+                                                    const QImage& image, int generation)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+
+  if (generation != d->generation())
+    {
+    return;
+    }
+  d->Loading.remove(thumbnailPath);
+  if (image.isNull())
+    {
+    logger.warn("Failed to load thumbnail " + thumbnailPath);
+    return;
+    }
+  QPixmapCache::insert(thumbnailPath, QPixmap::fromImage(image));
+  foreach (int row, d->RowsForThumbnail.take(thumbnailPath))
+    {
+    d->Model->rowChanged(row);
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::onViewClicked(const QModelIndex& viewIndex)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+
+  if (!viewIndex.isValid())
+    {
+    return;
+    }
+  d->CurrentThumbnail = viewIndex.row();
+  d->updateSelectedLabel(viewIndex.row());
+  emit thumbnailSelected(d->Items[viewIndex.row()].SourceIndex);
+  emit selected(*d->SelectedLabel);
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::onViewDoubleClicked(const QModelIndex& viewIndex)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+
+  if (!viewIndex.isValid())
+    {
+    return;
+    }
+  d->updateSelectedLabel(viewIndex.row());
+  // the slots may change the displayed thumbnails
+  QPersistentModelIndex sourceIndex = d->Items[viewIndex.row()].SourceIndex;
+  emit thumbnailDoubleClicked(sourceIndex);
+  emit doubleClicked(*d->SelectedLabel);
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMThumbnailListWidget::selectThumbnailFromIndex(const QModelIndex &index){
   Q_D(ctkDICOMThumbnailListWidget);
@@ -245,34 +624,99 @@ void ctkDICOMThumbnailListWidget::selectThumbnailFromIndex(const QModelIndex &in
     return;
     }
 
-  ctkDICOMModel* model = const_cast<ctkDICOMModel*>(qobject_cast<const ctkDICOMModel*>(index.model()));
-
-  if(model)
+  for (int row = 0; row < d->Items.count(); ++row)
     {
-    int count = d->ScrollAreaContentWidget->layout()->count();
-
-    for(int i=0; i<count; i++)
+    if (d->Items[row].SourceIndex == index)
       {
-      ctkThumbnailLabel* thumbnailWidget = qobject_cast<ctkThumbnailLabel*>(d->ScrollAreaContentWidget->layout()->itemAt(i)->widget());
-      if(thumbnailWidget->property("sourceIndex").value<QPersistentModelIndex>() == index)
-        {
-        thumbnailWidget->setSelected(true);
-        d->ScrollArea->ensureWidgetVisible(thumbnailWidget);
-        }
-      else
-        {
-        thumbnailWidget->setSelected(false);
-        }
+      this->setCurrentThumbnail(row);
+      return;
       }
     }
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::setCurrentThumbnail(int index)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+
+  if (index < 0 || index >= d->Items.count())
+    {
+    return;
+    }
+  QModelIndex viewIndex = d->Model->index(index, 0);
+  d->View->setCurrentIndex(viewIndex);
+  d->View->scrollTo(viewIndex);
+  d->CurrentThumbnail = index;
+}
+
+//----------------------------------------------------------------------------
+int ctkDICOMThumbnailListWidget::currentThumbnail()
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+  return d->CurrentThumbnail;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::clearThumbnails()
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+  d->clearItems();
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::setFlow(Qt::Orientation orientation)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+  d->View->setFlow(orientation == Qt::Horizontal ?
+                   QListView::LeftToRight : QListView::TopToBottom);
+}
+
+//----------------------------------------------------------------------------
+Qt::Orientation ctkDICOMThumbnailListWidget::flow()const
+{
+  Q_D(const ctkDICOMThumbnailListWidget);
+  return d->View->flow() == QListView::LeftToRight ? Qt::Horizontal : Qt::Vertical;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::setThumbnailSize(QSize size)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+  d->ThumbnailSize = size;
+  QSize iconSize = size.isValid() ? size : QSize(128, 128);
+  d->View->setIconSize(iconSize);
+  // the cells don't depend on the thumbnails being decoded
+  d->View->setGridSize(iconSize + QSize(8, d->View->fontMetrics().height() + 8));
+}
+
+//----------------------------------------------------------------------------
+QSize ctkDICOMThumbnailListWidget::thumbnailSize()const
+{
+  Q_D(const ctkDICOMThumbnailListWidget);
+  return d->ThumbnailSize;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMThumbnailListWidget::setMaximumLoadingThreadCount(int threadCount)
+{
+  Q_D(ctkDICOMThumbnailListWidget);
+  d->LoadPool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+//----------------------------------------------------------------------------
+int ctkDICOMThumbnailListWidget::maximumLoadingThreadCount()const
+{
+  Q_D(const ctkDICOMThumbnailListWidget);
+  return d->LoadPool.maxThreadCount();
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMThumbnailListWidget::addThumbnails(const QModelIndex &index)
 {
   Q_D(ctkDICOMThumbnailListWidget);
 
-  this->clearThumbnails();
+  // the pending decodings of the previous selection are discarded
+  d->clearItems();
 
   ctkDICOMModel* model = const_cast<ctkDICOMModel*>(qobject_cast<const ctkDICOMModel*>(index.model()));
 
@@ -282,6 +726,7 @@ void ctkDICOMThumbnailListWidget::addThumbnails(const QModelIndex &index)
 
     d->CurrentSelectedModel = index0;
 
+    d->Model->beginReset();
     if ( model->data(index0,ctkDICOMModel::TypeRole) == static_cast<int>(ctkDICOMModel::PatientType) )
       {
       d->addPatientThumbnails(index0);
@@ -294,6 +739,7 @@ void ctkDICOMThumbnailListWidget::addThumbnails(const QModelIndex &index)
       {
       d->addSeriesThumbnails(index0);
       }
+    d->Model->endReset();
     }
 
   this->setCurrentThumbnail(0);
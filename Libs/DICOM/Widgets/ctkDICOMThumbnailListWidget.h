@@ -24,14 +24,28 @@
 #include "ctkDICOMWidgetsExport.h"
 #include "ctkThumbnailListWidget.h"
 
+class QImage;
 class QModelIndex;
+class ctkDICOMDatabase;
 class ctkDICOMThumbnailListWidgetPrivate;
 class ctkThumbnailWidget;
 
 /// \ingroup DICOM_Widgets
+///
+/// Displays the thumbnails of the children of a patient, study or series
+/// of a ctkDICOMModel.
+///
+/// The thumbnails are displayed by a list view: only the visible cells are
+/// painted and their thumbnail files are decoded on a pool of threads.
+/// The decoded thumbnails are kept in the QPixmapCache, its cache limit
+/// bounds the memory used by the thumbnails. Selecting another item of
+/// the model discards the thumbnails that are not decoded yet.
 class CTK_DICOM_WIDGETS_EXPORT ctkDICOMThumbnailListWidget : public ctkThumbnailListWidget
 {
   Q_OBJECT
+  Q_PROPERTY(int currentThumbnail READ currentThumbnail WRITE setCurrentThumbnail)
+  Q_PROPERTY(Qt::Orientation flow READ flow WRITE setFlow)
+  Q_PROPERTY(QSize thumbnailSize READ thumbnailSize WRITE setThumbnailSize)
 public:
   typedef ctkThumbnailListWidget Superclass;
   explicit ctkDICOMThumbnailListWidget(QWidget* parent=0);
@@ -39,14 +53,54 @@ public:
 
   void setDatabaseDirectory(const QString& directory);
 
+  /// Database used to request the thumbnails that have not been
+  /// generated yet. Without database, images without thumbnail are
+  /// displayed without pixmap.
+  void setDICOMDatabase(ctkDICOMDatabase* database);
+
   void selectThumbnailFromIndex(const QModelIndex& index);
 
+  /// Select the thumbnail at index
+  void setCurrentThumbnail(int index);
+  int currentThumbnail();
+
+  /// Remove the thumbnails and discard the pending decodings
+  void clearThumbnails();
+
+  /// Flow of the thumbnails
+  ///  - Qt::Horizontal: left to right
+  ///  - Qt::Vertical: top to bottom
+  void setFlow(Qt::Orientation orientation);
+  Qt::Orientation flow()const;
+
+  QSize thumbnailSize()const;
+
+  /// Number of threads decoding the thumbnail files, 2 by default.
+  void setMaximumLoadingThreadCount(int threadCount);
+  int maximumLoadingThreadCount()const;
+
 private:
   Q_DECLARE_PRIVATE(ctkDICOMThumbnailListWidget);
   Q_DISABLE_COPY(ctkDICOMThumbnailListWidget);
 
 public Q_SLOTS:
   void addThumbnails(const QModelIndex& index);
+
+  /// Size of the cells of the thumbnails, 128x128 if the size is invalid
+  void setThumbnailSize(QSize size);
+
+Q_SIGNALS:
+  /// Emitted with the index of the ctkDICOMModel of the thumbnail
+  void thumbnailSelected(const QModelIndex& sourceIndex);
+  void thumbnailDoubleClicked(const QModelIndex& sourceIndex);
+
+protected Q_SLOTS:
+  /// Update the thumbnail displayed for thumbnailPath
+  void onThumbnailGenerated(const QString& thumbnailPath);
+  /// Called in the GUI thread when a thumbnail file has been decoded
+  void onThumbnailLoaded(const QString& thumbnailPath, const QImage& image, int generation);
+  void onViewClicked(const QModelIndex& viewIndex);
+  void onViewDoubleClicked(const QModelIndex& viewIndex);
 };
 
 #endif
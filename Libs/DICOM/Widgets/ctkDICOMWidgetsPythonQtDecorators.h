@@ -21,10 +21,14 @@
 #ifndef __ctkDICOMWidgetsPythonQtDecorators_h
 #define __ctkDICOMWidgetsPythonQtDecorators_h
 
+// Qt includes
+#include <QImage>
+
 // PythonQt includes
 #include <PythonQt.h>
 
 // CTK includes
+#include <ctkDICOMImage.h>
 
 // NOTE:
 //
@@ -33,6 +37,85 @@
 // for non-static methods.
 //
 
+//-----------------------------------------------------------------------------
+/// Read-only python buffer on the pixels of a QImage. It holds a shallow
+/// copy of the image so the pixels stay valid as long as the buffer, or an
+/// array viewing it, is alive.
+struct ctkDICOMImageBuffer
+{
+  PyObject_HEAD
+  QImage* Image;
+};
+
+//-----------------------------------------------------------------------------
+static void ctkDICOMImageBuffer_dealloc(ctkDICOMImageBuffer* self)
+{
+  delete self->Image;
+  PyObject_Del(self);
+}
+
+//-----------------------------------------------------------------------------
+static int ctkDICOMImageBuffer_getbuffer(ctkDICOMImageBuffer* self, Py_buffer* view, int flags)
+{
+  // constBits() doesn't detach the image from the frame cache
+  return PyBuffer_FillInfo(view, reinterpret_cast<PyObject*>(self),
+                           const_cast<uchar*>(self->Image->constBits()),
+                           self->Image->byteCount(), 1, flags);
+}
+
+#if PY_MAJOR_VERSION < 3
+//-----------------------------------------------------------------------------
+static Py_ssize_t ctkDICOMImageBuffer_getreadbuffer(ctkDICOMImageBuffer* self,
+                                                    Py_ssize_t segment, void** ptr)
+{
+  if (segment != 0)
+    {
+    PyErr_SetString(PyExc_SystemError, "accessing non-existent buffer segment");
+    return -1;
+    }
+  *ptr = const_cast<uchar*>(self->Image->constBits());
+  return self->Image->byteCount();
+}
+
+//-----------------------------------------------------------------------------
+static Py_ssize_t ctkDICOMImageBuffer_getsegcount(ctkDICOMImageBuffer* self, Py_ssize_t* length)
+{
+  if (length)
+    {
+    *length = self->Image->byteCount();
+    }
+  return 1;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+static PyTypeObject* ctkDICOMImageBufferType()
+{
+  static PyBufferProcs bufferProcs;
+  static PyTypeObject type;
+  if (!type.tp_name)
+    {
+    bufferProcs.bf_getbuffer = reinterpret_cast<getbufferproc>(ctkDICOMImageBuffer_getbuffer);
+#if PY_MAJOR_VERSION < 3
+    bufferProcs.bf_getreadbuffer = reinterpret_cast<readbufferproc>(ctkDICOMImageBuffer_getreadbuffer);
+    bufferProcs.bf_getsegcount = reinterpret_cast<segcountproc>(ctkDICOMImageBuffer_getsegcount);
+    bufferProcs.bf_getcharbuffer = reinterpret_cast<charbufferproc>(ctkDICOMImageBuffer_getreadbuffer);
+#endif
+    Py_REFCNT(&type) = 1;
+    type.tp_name = "ctk.ctkDICOMImageBuffer";
+    type.tp_basicsize = sizeof(ctkDICOMImageBuffer);
+    type.tp_dealloc = reinterpret_cast<destructor>(ctkDICOMImageBuffer_dealloc);
+    type.tp_as_buffer = &bufferProcs;
+    type.tp_flags = Py_TPFLAGS_DEFAULT;
+#if PY_MAJOR_VERSION < 3
+    type.tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+    type.tp_doc = "Read-only buffer on the pixels of a ctkDICOMImage frame";
+    PyType_Ready(&type);
+    }
+  return &type;
+}
+
 /// \ingroup DICOM_Widgets
 class ctkDICOMWidgetsPythonQtDecorators : public QObject
 {
@@ -45,9 +128,22 @@ public:
 
 public Q_SLOTS:
 
-  //
-  // None yet - refer to other libs for examples
-  //
+  // ctkDICOMImage
+
+  /// Pixels of the frame, without copy, for numpy.frombuffer(). The rows
+  /// are frame(frame).bytesPerLine() bytes long, in the frame(frame).format()
+  /// layout.
+  PythonQtObjectPtr frameBuffer(ctkDICOMImage* image, int frame = 0)const
+  {
+    ctkDICOMImageBuffer* buffer = PyObject_New(ctkDICOMImageBuffer, ctkDICOMImageBufferType());
+    PythonQtObjectPtr result;
+    if (buffer)
+      {
+      buffer->Image = new QImage(image->frame(frame));
+      result.setNewRef(reinterpret_cast<PyObject*>(buffer));
+      }
+    return result;
+  }
 
 };
 
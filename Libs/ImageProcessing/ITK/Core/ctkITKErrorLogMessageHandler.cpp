@@ -83,7 +83,7 @@ public:
 void ctkITKOutputWindow::DisplayText(const char* text)
 {
   Q_ASSERT(this->MessageHandler);
-  this->MessageHandler->handleMessage(
+  this->MessageHandler->bufferMessage(
         ctk::qtHandleToString(QThread::currentThreadId()),
         ctkErrorLogLevel::Info,
         this->MessageHandler->handlerPrettyName(), ctkErrorLogContext(), text);
@@ -97,7 +97,7 @@ void ctkITKOutputWindow::DisplayErrorText(const char* text)
   ctkErrorLogContext context;
   this->parseText(text, context);
 
-  this->MessageHandler->handleMessage(
+  this->MessageHandler->bufferMessage(
         ctk::qtHandleToString(QThread::currentThreadId()),
         ctkErrorLogLevel::Error,
         this->MessageHandler->handlerPrettyName(), context, text);
@@ -111,7 +111,7 @@ void ctkITKOutputWindow::DisplayWarningText(const char* text)
   ctkErrorLogContext context;
   this->parseText(text, context);
 
-  this->MessageHandler->handleMessage(
+  this->MessageHandler->bufferMessage(
         ctk::qtHandleToString(QThread::currentThreadId()),
         ctkErrorLogLevel::Warning,
         this->MessageHandler->handlerPrettyName(), context, text);
@@ -131,7 +131,7 @@ void ctkITKOutputWindow::DisplayDebugText(const char* text)
   ctkErrorLogContext context;
   this->parseText(text, context);
 
-  this->MessageHandler->handleMessage(
+  this->MessageHandler->bufferMessage(
         ctk::qtHandleToString(QThread::currentThreadId()),
         ctkErrorLogLevel::Debug,
         this->MessageHandler->handlerPrettyName(), context, text);
@@ -0,0 +1,198 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkEABatchTestSuite_p.h"
+
+#include <ctkPluginContext.h>
+
+#include <service/event/ctkEventAdmin.h>
+#include <service/event/ctkEventConstants.h>
+
+#include <QTest>
+
+//----------------------------------------------------------------------------
+ctkEABatchTestHelper::ctkEABatchTestHelper()
+  : calls(0)
+{
+
+}
+
+//----------------------------------------------------------------------------
+void ctkEABatchTestHelper::handleEvent(const ctkEvent& event)
+{
+  QMutexLocker l(&mutex);
+  received.push_back(event);
+  ++calls;
+}
+
+//----------------------------------------------------------------------------
+void ctkEABatchTestHelper::handleEvents(const QList<ctkEvent>& events)
+{
+  QMutexLocker l(&mutex);
+  received.append(events);
+  ++calls;
+}
+
+//----------------------------------------------------------------------------
+QList<ctkEvent> ctkEABatchTestHelper::waitForEvents(int count) const
+{
+  for (int i = 0; i < 50; ++i)
+  {
+    {
+      QMutexLocker l(&mutex);
+      if (received.size() >= count)
+      {
+        break;
+      }
+    }
+    QTest::qWait(20);
+  }
+  // allow for the delivery of unexpected events
+  QTest::qWait(50);
+
+  QMutexLocker l(&mutex);
+  return received;
+}
+
+//----------------------------------------------------------------------------
+int ctkEABatchTestHelper::callCount() const
+{
+  QMutexLocker l(&mutex);
+  return calls;
+}
+
+//----------------------------------------------------------------------------
+ctkEABatchTestSuite::ctkEABatchTestSuite(ctkPluginContext* pc, long eventPluginId)
+  : context(pc), eventPluginId(eventPluginId), eventAdmin(0)
+{
+
+}
+
+//----------------------------------------------------------------------------
+void ctkEABatchTestSuite::init()
+{
+  context->getPlugin(eventPluginId)->start();
+  reference = context->getServiceReference<ctkEventAdmin>();
+  eventAdmin = context->getService<ctkEventAdmin>(reference);
+}
+
+//----------------------------------------------------------------------------
+void ctkEABatchTestSuite::cleanup()
+{
+  context->ungetService(reference);
+  context->getPlugin(eventPluginId)->stop();
+}
+
+//----------------------------------------------------------------------------
+QList<ctkDictionary> ctkEABatchTestSuite::createBatch(int size) const
+{
+  QList<ctkDictionary> batch;
+  for (int i = 0; i < size; ++i)
+  {
+    ctkDictionary properties;
+    properties.insert("index", i);
+    properties.insert("parity", i % 2 ? "odd" : "even");
+    batch.push_back(properties);
+  }
+  return batch;
+}
+
+//----------------------------------------------------------------------------
+void ctkEABatchTestSuite::testPostEvents()
+{
+  ctkDictionary properties;
+  properties.insert(ctkEventConstants::EVENT_TOPIC, "a/b/c");
+  ctkEABatchTestHelper handler;
+  ctkServiceRegistration handlerRegistration = context->registerService<ctkEventHandler>(&handler, properties);
+
+  eventAdmin->postEvents("a/b/c", createBatch(10));
+  QList<ctkEvent> events = handler.waitForEvents(10);
+  handlerRegistration.unregister();
+
+  QCOMPARE(events.size(), 10);
+  QCOMPARE(handler.callCount(), 10);
+  for (int i = 0; i < events.size(); ++i)
+  {
+    QCOMPARE(events[i].getTopic(), QString("a/b/c"));
+    QCOMPARE(events[i].getProperty("index").toInt(), i);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkEABatchTestSuite::testBatchDelivery()
+{
+  ctkDictionary properties;
+  properties.insert(ctkEventConstants::EVENT_TOPIC, "a/b/*");
+  properties.insert(ctkEventConstants::EVENT_DELIVERY, ctkEventConstants::DELIVERY_BATCH);
+  ctkEABatchTestHelper handler;
+  ctkServiceRegistration handlerRegistration = context->registerService<ctkEventHandler>(&handler, properties);
+
+  eventAdmin->postEvents("a/b/c", createBatch(10));
+  QList<ctkEvent> events = handler.waitForEvents(10);
+  handlerRegistration.unregister();
+
+  QCOMPARE(events.size(), 10);
+  QCOMPARE(handler.callCount(), 1);
+  for (int i = 0; i < events.size(); ++i)
+  {
+    QCOMPARE(events[i].getProperty("index").toInt(), i);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkEABatchTestSuite::testBatchDeliveryWithFilter()
+{
+  ctkDictionary properties;
+  properties.insert(ctkEventConstants::EVENT_TOPIC, "a/b/c");
+  properties.insert(ctkEventConstants::EVENT_FILTER, "(parity=odd)");
+  properties.insert(ctkEventConstants::EVENT_DELIVERY, ctkEventConstants::DELIVERY_BATCH);
+  ctkEABatchTestHelper handler;
+  ctkServiceRegistration handlerRegistration = context->registerService<ctkEventHandler>(&handler, properties);
+
+  eventAdmin->postEvents("a/b/c", createBatch(10));
+  QList<ctkEvent> events = handler.waitForEvents(5);
+  handlerRegistration.unregister();
+
+  QCOMPARE(events.size(), 5);
+  QCOMPARE(handler.callCount(), 1);
+  for (int i = 0; i < events.size(); ++i)
+  {
+    QCOMPARE(events[i].getProperty("index").toInt(), 2*i + 1);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkEABatchTestSuite::testCoalescedDelivery()
+{
+  ctkDictionary properties;
+  properties.insert(ctkEventConstants::EVENT_TOPIC, "a/b/c");
+  properties.insert(ctkEventConstants::EVENT_DELIVERY, ctkEventConstants::DELIVERY_COALESCE);
+  ctkEABatchTestHelper handler;
+  ctkServiceRegistration handlerRegistration = context->registerService<ctkEventHandler>(&handler, properties);
+
+  eventAdmin->postEvents("a/b/c", createBatch(10));
+  QList<ctkEvent> events = handler.waitForEvents(1);
+  handlerRegistration.unregister();
+
+  QCOMPARE(events.size(), 1);
+  QCOMPARE(events[0].getProperty("index").toInt(), 9);
+}
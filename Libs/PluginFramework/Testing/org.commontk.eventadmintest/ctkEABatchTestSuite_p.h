@@ -0,0 +1,118 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEABATCHTESTSUITE_P_H
+#define CTKEABATCHTESTSUITE_P_H
+
+#include <QObject>
+#include <QMutex>
+
+#include <ctkServiceReference.h>
+#include <ctkTestSuiteInterface.h>
+
+#include <service/event/ctkEventHandler.h>
+
+class ctkPluginContext;
+struct ctkEventAdmin;
+
+class ctkEABatchTestHelper : public QObject, public ctkEventHandler
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkEventHandler)
+
+private:
+
+  mutable QMutex mutex;
+  QList<ctkEvent> received;
+  int calls;
+
+public:
+
+  ctkEABatchTestHelper();
+
+  void handleEvent(const ctkEvent& event);
+
+  void handleEvents(const QList<ctkEvent>& events);
+
+  /*
+   * Wait until count events were received or a timeout occurred.
+   */
+  QList<ctkEvent> waitForEvents(int count) const;
+
+  /*
+   * The number of calls of handleEvent() and handleEvents().
+   */
+  int callCount() const;
+
+};
+
+
+class ctkEABatchTestSuite : public QObject,
+    public ctkTestSuiteInterface
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkTestSuiteInterface)
+
+public:
+
+  ctkEABatchTestSuite(ctkPluginContext* pc, long eventPluginId);
+
+private Q_SLOTS:
+
+  void init();
+  void cleanup();
+
+  /*
+   * Ensures ctkEventAdmin delivers the events posted in a batch one by one
+   * and in order to a ctkEventHandler without delivery qualities.
+   */
+  void testPostEvents();
+
+  /*
+   * Ensures ctkEventAdmin delivers the events posted in a batch in one call
+   * to a ctkEventHandler registered with DELIVERY_BATCH.
+   */
+  void testBatchDelivery();
+
+  /*
+   * Ensures ctkEventAdmin only delivers the matching events of a batch to a
+   * ctkEventHandler registered with DELIVERY_BATCH and an EVENT_FILTER.
+   */
+  void testBatchDeliveryWithFilter();
+
+  /*
+   * Ensures ctkEventAdmin only delivers the last event of a batch to a
+   * ctkEventHandler registered with DELIVERY_COALESCE.
+   */
+  void testCoalescedDelivery();
+
+private:
+
+  QList<ctkDictionary> createBatch(int size) const;
+
+  ctkPluginContext* context;
+  long eventPluginId;
+  ctkEventAdmin* eventAdmin;
+  ctkServiceReference reference;
+};
+
+#endif // CTKEABATCHTESTSUITE_P_H
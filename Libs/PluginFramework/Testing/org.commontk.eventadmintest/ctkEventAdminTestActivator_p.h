@@ -52,6 +52,7 @@ private:
   QObject* scenario2TestSuite;
   QObject* scenario3TestSuite;
   QObject* scenario4TestSuite;
+  QObject* batchTestSuite;
 };
 
 #endif // CTKEVENTADMINTESTACTIVATOR_H
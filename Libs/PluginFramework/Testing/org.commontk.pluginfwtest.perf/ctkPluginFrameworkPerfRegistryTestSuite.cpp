@@ -30,6 +30,37 @@
 
 #include <QTest>
 #include <QDebug>
+#include <QThread>
+
+//----------------------------------------------------------------------------
+/// Looks up the perf test services from its own thread.
+class ctkServiceLookupThread : public QThread
+{
+public:
+
+  ctkServiceLookupThread(ctkPluginContext* pc, int nLookups, int nServices)
+    : pc(pc), nLookups(nLookups), nServices(nServices), nFailed(0)
+  {}
+
+  void run()
+  {
+    QString filter("(service.pid=my.service.%1)");
+    for(int i = 0; i < nLookups; i++)
+    {
+      QList<ctkServiceReference> refs =
+          pc->getServiceReferences<IPerfTestService>(filter.arg(i % nServices));
+      if (refs.size() != 1 || !pc->getServiceReference<IPerfTestService>())
+      {
+        ++nFailed;
+      }
+    }
+  }
+
+  ctkPluginContext* pc;
+  int nLookups;
+  int nServices;
+  int nFailed;
+};
 
 //----------------------------------------------------------------------------
 ctkPluginFrameworkPerfRegistryTestSuite::ctkPluginFrameworkPerfRegistryTestSuite(ctkPluginContext* context)
@@ -37,6 +68,7 @@ ctkPluginFrameworkPerfRegistryTestSuite::ctkPluginFrameworkPerfRegistryTestSuite
   , pc(context)
   , nListeners(100)
   , nServices(1000)
+  , nLookups(2000)
   , nRegistered(0)
   , nUnregistering(0)
   , nModified(0)
@@ -157,15 +189,106 @@ void ctkPluginFrameworkPerfRegistryTestSuite::modifyServices()
 {
   log() << "modifying " << regs.size() << "services, listener count=" << listeners.size();
 
+  QString pid("my.service.%1");
+
   for(int i = 0; i < regs.size(); i++)
   {
     ctkServiceRegistration reg = regs[i];
     ctkDictionary props;
+    // the properties are replaced, keep the pid looked up by the tests below
+    props.insert("service.pid", pid.arg(i));
     props.insert("perf.service.value", i * 2);
     reg.setProperties(props);
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkPerfRegistryTestSuite::testConcurrentLookups()
+{
+  qDebug() << "Look up the services from one and from several threads, and"
+           << "check that each of the" << nLookups << "lookups finds its service";
+
+  int nThreads = qMax(2, QThread::idealThreadCount());
+
+  ctkHighPrecisionTimer t;
+  t.start();
+  int nFailed = lookupServices(1);
+  int ms = t.elapsedMilli();
+  log() << nLookups << "lookups in 1 thread took" << ms << "ms";
+  QVERIFY2(nFailed == 0, "All the lookups must find their service");
+
+  t.start();
+  nFailed = lookupServices(nThreads);
+  int concurrentMs = t.elapsedMilli();
+  log() << nLookups << "lookups in" << nThreads << "threads took" << concurrentMs << "ms";
+  QVERIFY2(nFailed == 0, "All the concurrent lookups must find their service");
+}
+
+//----------------------------------------------------------------------------
+int ctkPluginFrameworkPerfRegistryTestSuite::lookupServices(int nThreads)
+{
+  QList<ctkServiceLookupThread*> threads;
+  for(int i = 0; i < nThreads; i++)
+  {
+    threads.push_back(new ctkServiceLookupThread(pc, nLookups / nThreads, qMax(1, regs.size())));
+  }
+  foreach(ctkServiceLookupThread* thread, threads)
+  {
+    thread->start();
+  }
+
+  int nFailed = 0;
+  foreach(ctkServiceLookupThread* thread, threads)
+  {
+    thread->wait();
+    nFailed += thread->nFailed;
+    delete thread;
+  }
+  return nFailed;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkPerfRegistryTestSuite::testFilteredLookups_data()
+{
+  QTest::addColumn<QString>("filter");
+  QTest::addColumn<int>("factor");
+
+  // %1 is replaced by the index of the service times factor, modifyServices()
+  // set perf.service.value to twice the index
+  QTest::newRow("equality") << QString("(service.pid=my.service.%1)") << 1;
+  QTest::newRow("conjunction") << QString("(&(service.pid=my.service.%1)(perf.service.value>=0))") << 1;
+  QTest::newRow("negation") << QString("(&(service.pid=my.service.%1)(!(perf.service.value<=-1)))") << 1;
+  QTest::newRow("range") << QString("(&(perf.service.value>=%1)(perf.service.value<=%1))") << 2;
+  QTest::newRow("disjunction") << QString("(|(perf.service.value=%1)(service.pid=none))") << 2;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkPerfRegistryTestSuite::testFilteredLookups()
+{
+  QFETCH(QString, filter);
+  QFETCH(int, factor);
+
+  QVERIFY(!regs.isEmpty());
+
+  int nFailed = 0;
+  ctkHighPrecisionTimer t;
+  t.start();
+  for(int i = 0; i < nLookups; i++)
+  {
+    QList<ctkServiceReference> refs =
+        pc->getServiceReferences<IPerfTestService>(filter.arg((i % regs.size()) * factor));
+    if (refs.size() != 1)
+    {
+      ++nFailed;
+    }
+  }
+  int ms = t.elapsedMilli();
+  log() << nLookups << "lookups with" << filter << "among" << regs.size()
+        << "services took" << ms << "ms";
+  QTest::setBenchmarkResult(ms, QTest::WalltimeMilliseconds);
+  QVERIFY2(nFailed == 0, "All the lookups must find their service");
+}
+
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkPerfRegistryTestSuite::testUnregisterServices()
 {
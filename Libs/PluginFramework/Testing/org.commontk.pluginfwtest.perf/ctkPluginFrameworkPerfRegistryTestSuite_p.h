@@ -44,6 +44,7 @@ private:
 
   int nListeners;
   int nServices;
+  int nLookups;
 
   int nRegistered;
   int nUnregistering;
@@ -70,6 +71,7 @@ private:
   void registerServices(int n);
   void modifyServices();
   void unregisterServices();
+  int lookupServices(int nThreads);
 
 private Q_SLOTS:
 
@@ -80,6 +82,9 @@ private Q_SLOTS:
   void testRegisterServices();
 
   void testModifyServices();
+  void testConcurrentLookups();
+  void testFilteredLookups_data();
+  void testFilteredLookups();
   void testUnregisterServices();
 };
 
@@ -0,0 +1,313 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkPluginFrameworkStartupBenchmark_p.h"
+
+#include <ctkCommandLineParser.h>
+#include <ctkException.h>
+#include <ctkPlugin.h>
+#include <ctkPluginConstants.h>
+#include <ctkPluginContext.h>
+#include <ctkPluginEvent.h>
+#include <ctkPluginFramework.h>
+#include <ctkPluginFrameworkFactory.h>
+
+#include "ctkPluginFrameworkTestUtil.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#include <cstdlib>
+
+namespace {
+
+//----------------------------------------------------------------------------
+QString ctkTraceEscape(const QString& str)
+{
+  QString res(str);
+  res.replace('\\', "\\\\");
+  res.replace('"', "\\\"");
+  return res;
+}
+
+}
+
+//----------------------------------------------------------------------------
+ctkPluginStartupRecorder::ctkPluginStartupRecorder()
+  : round(0)
+{
+  timer.start();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartupRecorder::startRound(int round)
+{
+  this->round = round;
+  startRequests.clear();
+  activations.clear();
+  timer.start();
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkPluginStartupRecorder::now()
+{
+  return timer.elapsedMicro();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartupRecorder::addEvent(const QString& name, const QString& plugin,
+                                        qint64 ts, qint64 dur)
+{
+  Event event;
+  event.name = name;
+  event.plugin = plugin;
+  event.round = round;
+  event.ts = ts;
+  event.dur = dur;
+  events.push_back(event);
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartupRecorder::startRequested(long pluginId)
+{
+  startRequests.insert(pluginId, now());
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkPluginStartupRecorder::totalDuration(const QString& name, int round) const
+{
+  qint64 total = 0;
+  foreach(const Event& event, events)
+  {
+    if (event.round == round && event.name == name)
+    {
+      total += event.dur;
+    }
+  }
+  return total;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStartupRecorder::pluginChanged(const ctkPluginEvent& event)
+{
+  QSharedPointer<ctkPlugin> plugin = event.getPlugin();
+  const long id = plugin->getPluginId();
+  const qint64 ts = now();
+
+  switch (event.getType())
+  {
+  case ctkPluginEvent::RESOLVED:
+    // Plugins resolved as a dependency of another one have no resolve
+    // phase of their own, they are part of the resolve phase of that one.
+    if (startRequests.contains(id))
+    {
+      qint64 begin = startRequests.take(id);
+      addEvent("resolve", plugin->getSymbolicName(), begin, ts - begin);
+    }
+    break;
+  case ctkPluginEvent::STARTING:
+    startRequests.remove(id);
+    activations.insert(id, ts);
+    break;
+  case ctkPluginEvent::STARTED:
+    if (activations.contains(id))
+    {
+      // Includes loading the plugin library and the activator start() call
+      qint64 begin = activations.take(id);
+      addEvent("activate", plugin->getSymbolicName(), begin, ts - begin);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool ctkPluginStartupRecorder::writeTrace(const QString& fileName) const
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+  {
+    return false;
+  }
+
+  QTextStream out(&file);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  for (int i = 0; i < events.size(); ++i)
+  {
+    const Event& event = events[i];
+    QString name = event.plugin.isEmpty() ? event.name : event.plugin + " " + event.name;
+    out << "{\"name\":\"" << ctkTraceEscape(name) << "\",\"cat\":\"" << event.name
+        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.round
+        << ",\"ts\":" << event.ts << ",\"dur\":" << event.dur
+        << ",\"args\":{\"plugin\":\"" << ctkTraceEscape(event.plugin) << "\"}}"
+        << (i + 1 < events.size() ? ",\n" : "\n");
+  }
+  out << "]}\n";
+  return out.status() == QTextStream::Ok;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  QCoreApplication app(argc, argv);
+
+  app.setOrganizationName("CTK");
+  app.setOrganizationDomain("commontk.org");
+  app.setApplicationName("ctkPluginFrameworkStartupBenchmark");
+
+  ctkCommandLineParser parser;
+  parser.setArgumentPrefix("--", "-");
+  parser.addArgument("plugins", "p", QVariant::String,
+                     "Comma separated list of the test plugins to install and start",
+                     "pluginA_test,pluginA1_test,pluginA2_test,pluginS_test,"
+                     "pluginSL1_test,pluginSL3_test,pluginSL4_test");
+  parser.addArgument("rounds", "r", QVariant::Int,
+                     "Number of times the framework is started", 3);
+  parser.addArgument("trace", "t", QVariant::String,
+                     "Write the timeline of the rounds to this Chrome trace (JSON) file");
+  parser.addArgument("help", "h", QVariant::Bool, "Show this help text");
+
+  bool ok = false;
+  QHash<QString, QVariant> parsedArgs = parser.parseArguments(QCoreApplication::arguments(), &ok);
+  if (!ok)
+  {
+    QTextStream(stderr, QIODevice::WriteOnly) << "Error parsing arguments: "
+                                              << parser.errorString() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  if (parsedArgs.contains("help"))
+  {
+    QTextStream(stdout, QIODevice::WriteOnly) << parser.helpText();
+    return EXIT_SUCCESS;
+  }
+
+  QString pluginDir;
+#ifdef CMAKE_INTDIR
+  pluginDir = qApp->applicationDirPath() + "/../test_plugins/" CMAKE_INTDIR "/";
+#else
+  pluginDir = qApp->applicationDirPath() + "/test_plugins/";
+#endif
+
+  const QStringList pluginNames = parsedArgs.value("plugins").toString().split(',', QString::SkipEmptyParts);
+  const int nRounds = qMax(1, parsedArgs.value("rounds").toInt());
+
+  ctkPluginStartupRecorder recorder;
+  bool failed = false;
+
+  for (int round = 0; round < nRounds; ++round)
+  {
+    ctkProperties fwProps;
+    fwProps.insert(ctkPluginConstants::FRAMEWORK_STORAGE,
+                   QDir::temp().filePath("ctkPluginFrameworkStartupBenchmark"));
+    fwProps.insert(ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN, ctkPluginConstants::FRAMEWORK_STORAGE_CLEAN_ONFIRSTINIT);
+    fwProps.insert("pluginfw.testDir", pluginDir);
+
+#if defined(Q_CC_GNU) && ((__GNUC__ < 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ < 5)))
+    fwProps.insert(ctkPluginConstants::FRAMEWORK_PLUGIN_LOAD_HINTS, QVariant::fromValue<QLibrary::LoadHints>(QLibrary::ExportExternalSymbolsHint));
+#endif
+
+    ctkPluginFrameworkFactory fwFactory(fwProps);
+    QSharedPointer<ctkPluginFramework> framework = fwFactory.getFramework();
+
+    recorder.startRound(round);
+
+    qint64 ts = recorder.now();
+    framework->init();
+    recorder.addEvent("init", QString(), ts, recorder.now() - ts);
+
+    ctkPluginContext* context = framework->getPluginContext();
+    context->connectPluginListener(&recorder, SLOT(pluginChanged(ctkPluginEvent)), Qt::DirectConnection);
+
+    ts = recorder.now();
+    framework->start();
+    recorder.addEvent("framework start", QString(), ts, recorder.now() - ts);
+
+    QList<QSharedPointer<ctkPlugin> > plugins;
+    foreach(const QString& pluginName, pluginNames)
+    {
+      try
+      {
+        ts = recorder.now();
+        QSharedPointer<ctkPlugin> plugin = ctkPluginFrameworkTestUtil::installPlugin(context, pluginName.trimmed());
+        recorder.addEvent("install", plugin->getSymbolicName(), ts, recorder.now() - ts);
+        plugins.push_back(plugin);
+      }
+      catch (const ctkException& e)
+      {
+        qCritical() << "Installing" << pluginName << "failed:" << e.what();
+        failed = true;
+      }
+    }
+
+    foreach(const QSharedPointer<ctkPlugin>& plugin, plugins)
+    {
+      try
+      {
+        recorder.startRequested(plugin->getPluginId());
+        plugin->start();
+      }
+      catch (const ctkException& e)
+      {
+        qCritical() << "Starting" << plugin->getSymbolicName() << "failed:" << e.what();
+        failed = true;
+      }
+      if (plugin->getState() != ctkPlugin::ACTIVE)
+      {
+        failed = true;
+      }
+    }
+
+    ts = recorder.now();
+    context->disconnectPluginListener(&recorder);
+    framework->stop();
+    framework->waitForStop(10000);
+    recorder.addEvent("framework stop", QString(), ts, recorder.now() - ts);
+  }
+
+  QTextStream out(stdout, QIODevice::WriteOnly);
+  out << "Startup of " << pluginNames.size() << " plugins, average over "
+      << nRounds << " rounds:\n";
+  const char* phases[] = { "init", "framework start", "install", "resolve", "activate", "framework stop" };
+  for (unsigned int i = 0; i < sizeof(phases) / sizeof(phases[0]); ++i)
+  {
+    qint64 total = 0;
+    for (int round = 0; round < nRounds; ++round)
+    {
+      total += recorder.totalDuration(phases[i], round);
+    }
+    out << "  " << phases[i] << ": " << (total / nRounds) / 1000.0 << " ms\n";
+  }
+  out.flush();
+
+  QString traceFile = parsedArgs.value("trace").toString();
+  if (!traceFile.isEmpty() && !recorder.writeTrace(traceFile))
+  {
+    qCritical() << "Writing the trace to" << traceFile << "failed";
+    failed = true;
+  }
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
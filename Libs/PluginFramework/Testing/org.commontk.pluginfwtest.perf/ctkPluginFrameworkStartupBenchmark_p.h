@@ -0,0 +1,98 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKPLUGINFRAMEWORKSTARTUPBENCHMARK_P_H
+#define CTKPLUGINFRAMEWORKSTARTUPBENCHMARK_P_H
+
+#include <ctkHighPrecisionTimer.h>
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class ctkPluginEvent;
+
+/**
+ * Records the timeline of the framework startup phases and of the
+ * install, resolve and activate phases of each plugin. The timeline is
+ * written in the Chrome trace event format, which can be loaded in
+ * chrome://tracing or any compatible viewer.
+ */
+class ctkPluginStartupRecorder : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  struct Event
+  {
+    QString name;
+    QString plugin;
+    int round;
+    /// Start of the phase, in microseconds since the start of the round.
+    qint64 ts;
+    /// Duration of the phase, in microseconds.
+    qint64 dur;
+  };
+
+  ctkPluginStartupRecorder();
+
+  /**
+   * Restart the clock for a new round of the benchmark.
+   */
+  void startRound(int round);
+
+  /**
+   * Microseconds elapsed since the start of the current round.
+   */
+  qint64 now();
+
+  void addEvent(const QString& name, const QString& plugin, qint64 ts, qint64 dur);
+
+  /**
+   * Remember that plugin is about to be started, its resolve phase
+   * ends with the RESOLVED event.
+   */
+  void startRequested(long pluginId);
+
+  /**
+   * Sum of the durations of the events called name in round, in microseconds.
+   */
+  qint64 totalDuration(const QString& name, int round) const;
+
+  bool writeTrace(const QString& fileName) const;
+
+public Q_SLOTS:
+
+  void pluginChanged(const ctkPluginEvent& event);
+
+private:
+
+  ctkHighPrecisionTimer timer;
+  int round;
+  QList<Event> events;
+  QHash<long, qint64> startRequests;
+  QHash<long, qint64> activations;
+};
+
+#endif // CTKPLUGINFRAMEWORKSTARTUPBENCHMARK_P_H
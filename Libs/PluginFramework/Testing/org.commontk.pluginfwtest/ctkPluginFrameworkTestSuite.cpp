@@ -26,6 +26,7 @@
 #include <ctkPluginConstants.h>
 #include <ctkPluginException.h>
 #include <ctkServiceException.h>
+#include <service/debug/ctkFrameworkProfiler.h>
 
 #include <QDir>
 #include <QTest>
@@ -539,6 +540,35 @@ void ctkPluginFrameworkTestSuite::frame070a()
   QVERIFY2(versionA1 != versionA, "framework test plug-in, update of plug-in failed, version info unchanged :FRAME070A:Fail");
 }
 
+//----------------------------------------------------------------------------
+// Profile service lookups with the framework profiler service
+void ctkPluginFrameworkTestSuite::frame080a()
+{
+  ctkServiceReference ref = pc->getServiceReference<ctkFrameworkProfiler>();
+  QVERIFY2(ref, "framework test plugin, no ctkFrameworkProfiler service :FRAME080A:FAIL");
+  ctkFrameworkProfiler* profiler = pc->getService<ctkFrameworkProfiler>(ref);
+  QVERIFY(profiler != 0);
+
+  const bool wasEnabled = profiler->isEnabled();
+  profiler->setEnabled(true);
+  profiler->reset();
+
+  const QString clazz = qobject_interface_iid<ctkFrameworkProfiler*>();
+  pc->getServiceReferences(clazz, "(service.id>=0)");
+  pc->getServiceReferences(clazz, "(service.id>=0)");
+
+  const QString dump = profiler->dump();
+  profiler->setEnabled(wasEnabled);
+
+  QVERIFY2(dump.contains(clazz + " (service.id>=0): 2,"),
+           qPrintable("framework test plugin, lookups not profiled :FRAME080A:FAIL\n" + dump));
+
+  profiler->reset();
+  QVERIFY(!profiler->dump().contains(clazz + " (service.id>=0)"));
+
+  pc->ungetService(ref);
+}
+
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkTestSuite::frameworkListener(const ctkPluginFrameworkEvent& fwEvent)
 {
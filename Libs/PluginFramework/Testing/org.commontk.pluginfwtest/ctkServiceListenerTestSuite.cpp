@@ -316,6 +316,54 @@ void ctkServiceListenerTestSuite::frameSL25a()
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkServiceListenerTestSuite::frameSL30a()
+{
+  ctkServiceListener sListen(pc, false);
+  pc->connectServiceListener(&sListen, "serviceChanged", "(batchtest=1)");
+
+  QObject service1;
+  QObject service2;
+  ctkDictionary props;
+  props.insert("batchtest", 1);
+
+  pc->beginServiceBatch();
+  ctkServiceRegistration reg1 = pc->registerService("QObject", &service1, props);
+  pc->beginServiceBatch();
+  ctkServiceRegistration reg2 = pc->registerService("QObject", &service2, props);
+  pc->endServiceBatch();
+  props.insert("modified", 1);
+  reg1.setProperties(props);
+  props.insert("modified", 2);
+  reg1.setProperties(props);
+  QVERIFY2(sListen.events.isEmpty(), "Service events delivered during the batch");
+  pc->endServiceBatch();
+
+  QList<ctkServiceEvent::Type> expectedServiceEventTypes;
+  expectedServiceEventTypes << ctkServiceEvent::REGISTERED
+                            << ctkServiceEvent::REGISTERED
+                            << ctkServiceEvent::MODIFIED;
+  QVERIFY(sListen.checkEvents(expectedServiceEventTypes));
+  QCOMPARE(sListen.events[2].getServiceReference().getProperty("modified").toInt(), 2);
+
+  // Without a batch, the events are delivered immediately
+  reg1.unregister();
+  reg2.unregister();
+  expectedServiceEventTypes << ctkServiceEvent::UNREGISTERING
+                            << ctkServiceEvent::UNREGISTERING;
+  QVERIFY(sListen.checkEvents(expectedServiceEventTypes));
+
+  pc->disconnectServiceListener(&sListen, "serviceChanged");
+
+  try
+  {
+    pc->endServiceBatch();
+    QFAIL("endServiceBatch() without a batch should throw");
+  }
+  catch (const ctkIllegalStateException&)
+  {}
+}
+
 //----------------------------------------------------------------------------
 bool ctkServiceListenerTestSuite::runStartStopTest(
   const QString& tcName, int cnt, QSharedPointer<ctkPlugin> targetPlugin,
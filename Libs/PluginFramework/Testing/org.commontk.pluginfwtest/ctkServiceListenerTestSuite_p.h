@@ -63,6 +63,11 @@ private Q_SLOTS:
 //    void frameSL20a();
     void frameSL25a();
 
+    // Checks that the service events of a batch are
+    // delivered when the batch ends, with the superseded
+    // MODIFIED events dropped.
+    void frameSL30a();
+
 private:
 
     ctkPluginContext* pc;
@@ -220,6 +220,50 @@ void ctkServiceTrackerTestSuite::runTest()
   delete st1;
 }
 
+//----------------------------------------------------------------------------
+void ctkServiceTrackerTestSuite::testSnapshot()
+{
+  ctkServiceTracker<> tracker(pc, ctkLDAPSearchFilter("(snapshottest=1)"));
+  tracker.open();
+  QVERIFY(tracker.getServices().isEmpty());
+  int trackingCount = tracker.getTrackingCount();
+
+  QObject service1;
+  QObject service2;
+  ctkDictionary props;
+  props.insert("snapshottest", 1);
+
+  ctkServiceRegistration reg1 = pc->registerService("QObject", &service1, props);
+  QVERIFY(tracker.getTrackingCount() != trackingCount);
+  QList<QObject*> services = tracker.getServices();
+  QCOMPARE(services.size(), 1);
+  QCOMPARE(services.front(), &service1);
+
+  // Nothing changed, the same list is returned
+  trackingCount = tracker.getTrackingCount();
+  QList<QObject*> sameServices = tracker.getServices();
+  QCOMPARE(tracker.getTrackingCount(), trackingCount);
+  QVERIFY(sameServices.constBegin() == services.constBegin());
+
+  ctkServiceRegistration reg2 = pc->registerService("QObject", &service2, props);
+  services = tracker.getServices();
+  QList<ctkServiceReference> references = tracker.getServiceReferences();
+  QCOMPARE(services.size(), 2);
+  QCOMPARE(references.size(), 2);
+  for (int i = 0; i < references.size(); ++i)
+  {
+    QCOMPARE(tracker.getService(references[i]), services[i]);
+  }
+
+  reg1.unregister();
+  reg2.unregister();
+  QVERIFY(tracker.getServices().isEmpty());
+
+  tracker.close();
+  QCOMPARE(tracker.getTrackingCount(), -1);
+  QVERIFY(tracker.getServices().isEmpty());
+}
+
 ctkServiceTrackerTestWorker::ctkServiceTrackerTestWorker(ctkPluginContext* pc)
   : waitSuccess(false), pc(pc)
 {
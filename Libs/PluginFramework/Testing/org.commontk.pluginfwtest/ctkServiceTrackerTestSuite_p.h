@@ -54,6 +54,10 @@ private Q_SLOTS:
     // service in the stop()-method.
     void runTest();
 
+    // Checks that the tracked services are shared between
+    // calls while the tracking count does not change.
+    void testSnapshot();
+
 Q_SIGNALS:
 
     void serviceControl(int service, const QString operation, long rank);
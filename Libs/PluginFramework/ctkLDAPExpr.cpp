@@ -23,6 +23,8 @@ limitations under the License.
 
 #include <ctkException.h>
 
+#include <QCache>
+#include <QMutex>
 #include <QSet>
 #include <QVariant>
 #include <QStringList>
@@ -99,19 +101,36 @@ class ctkLDAPExprData : public QSharedData
 public:
 
   ctkLDAPExprData( int op, QList<ctkLDAPExpr> args )
-    : m_operator(op), m_args(args)
+    : m_operator(op), m_args(args), m_attrAtom(-1)
   {
   }
 
   ctkLDAPExprData( int op, QString attrName, QString attrValue )
-    : m_operator(op), m_attrName(attrName), m_attrValue(attrValue)
+    : m_operator(op), m_attrName(attrName), m_attrValue(attrValue),
+      m_attrAtom(ctkServiceProperties::intern(attrName))
   {
+    // Parse the value once for all the comparisons, the conversions
+    // are the ones ctkLDAPExpr::compare() used to do on every call.
+    m_hasWildcard = m_attrValue.indexOf(ctkLDAPExpr::WILDCARD) >= 0;
+    m_isWildcard = m_attrValue == ctkLDAPExpr::WILDCARD_QString;
+    m_intValue = m_attrValue.toInt();
+    m_longLongValue = m_attrValue.toLongLong();
+    m_floatValue = m_attrValue.toFloat();
+    m_doubleValue = m_attrValue.toDouble();
+    if (op == ctkLDAPExpr::APPROX)
+    {
+      m_approxValue = ctkLDAPExpr::fixupString(m_attrValue);
+    }
   }
 
   ctkLDAPExprData( const ctkLDAPExprData& other )
     : QSharedData(other), m_operator(other.m_operator),
     m_args(other.m_args), m_attrName(other.m_attrName),
-    m_attrValue(other.m_attrValue)
+    m_attrValue(other.m_attrValue), m_attrAtom(other.m_attrAtom),
+    m_hasWildcard(other.m_hasWildcard),
+    m_isWildcard(other.m_isWildcard), m_intValue(other.m_intValue),
+    m_longLongValue(other.m_longLongValue), m_floatValue(other.m_floatValue),
+    m_doubleValue(other.m_doubleValue), m_approxValue(other.m_approxValue)
   {
   }
 
@@ -123,8 +142,36 @@ public:
   QString m_attrName;
   //!
   QString m_attrValue;
+  //! The atom of the attribute name, see ctkServiceProperties::intern()
+  int m_attrAtom;
+
+  //! The value contains a wildcard
+  bool m_hasWildcard;
+  //! The value is a single wildcard
+  bool m_isWildcard;
+  //! The value converted for numeric comparisons
+  int m_intValue;
+  qlonglong m_longLongValue;
+  float m_floatValue;
+  double m_doubleValue;
+  //! The value without spaces and in lower case, for APPROX
+  QString m_approxValue;
+};
+
+//----------------------------------------------------------------------------
+/// Bounded cache of the expressions returned by ctkLDAPExpr::compiled().
+struct ctkLDAPExprCache
+{
+  ctkLDAPExprCache()
+    : Cache(256)
+  {}
+
+  QMutex Mutex;
+  QCache<QString, ctkLDAPExpr> Cache;
 };
 
+Q_GLOBAL_STATIC(ctkLDAPExprCache, ctkLDAPExprCacheInstance)
+
 //----------------------------------------------------------------------------
 ctkLDAPExpr::ctkLDAPExpr()
 {
@@ -240,6 +287,54 @@ bool ctkLDAPExpr::getMatchedObjectClasses(QSet<QString>& objClasses) const
   return false;
 }
 
+//----------------------------------------------------------------------------
+bool ctkLDAPExpr::getIndexClauses(QSet<QString>& clauses) const
+{
+  if (d->m_operator == EQ)
+  {
+    bool isNumber = false;
+    d->m_attrValue.toDouble(&isNumber);
+    if (d->m_hasWildcard || isNumber)
+    {
+      return false;
+    }
+    clauses.insert(d->m_attrName.toLower() + '=' + d->m_attrValue);
+    return true;
+  }
+  else if (d->m_operator == AND)
+  {
+    // any operand is required, use the one with the fewest clauses
+    bool result = false;
+    QSet<QString> best;
+    for (int i = 0; i < d->m_args.size(); i++)
+    {
+      QSet<QString> r;
+      if (d->m_args[i].getIndexClauses(r) &&
+          (!result || r.size() < best.size()))
+      {
+        best = r;
+        result = true;
+      }
+    }
+    clauses += best;
+    return result;
+  }
+  else if (d->m_operator == OR)
+  {
+    QSet<QString> r;
+    for (int i = 0; i < d->m_args.size(); i++)
+    {
+      if (!d->m_args[i].getIndexClauses(r))
+      {
+        return false;
+      }
+    }
+    clauses += r;
+    return true;
+  }
+  return false;
+}
+
 //----------------------------------------------------------------------------
 bool ctkLDAPExpr::isSimple( 
   const QStringList& keywords,
@@ -280,14 +375,51 @@ bool ctkLDAPExpr::query( const QString &filter, const ctkDictionary &pd )
   return ctkLDAPExpr(filter).evaluate(pd, false);
 }
 
+//----------------------------------------------------------------------------
+ctkLDAPExpr ctkLDAPExpr::compiled( const QString &filter )
+{
+  ctkLDAPExprCache* cache = ctkLDAPExprCacheInstance();
+  {
+    QMutexLocker lock(&cache->Mutex);
+    ctkLDAPExpr* expr = cache->Cache.object(filter);
+    if (expr)
+    {
+      return *expr;
+    }
+  }
+
+  // Parse outside of the lock, malformed filters throw and are not cached
+  ctkLDAPExpr expr(filter);
+
+  QMutexLocker lock(&cache->Mutex);
+  cache->Cache.insert(filter, new ctkLDAPExpr(expr));
+  return expr;
+}
+
+//----------------------------------------------------------------------------
+void ctkLDAPExpr::setCompiledCacheSize( int size )
+{
+  ctkLDAPExprCache* cache = ctkLDAPExprCacheInstance();
+  QMutexLocker lock(&cache->Mutex);
+  cache->Cache.setMaxCost(size);
+}
+
+//----------------------------------------------------------------------------
+int ctkLDAPExpr::compiledCacheSize()
+{
+  ctkLDAPExprCache* cache = ctkLDAPExprCacheInstance();
+  QMutexLocker lock(&cache->Mutex);
+  return cache->Cache.maxCost();
+}
+
 //----------------------------------------------------------------------------
 bool ctkLDAPExpr::evaluate( const ctkServiceProperties &p, bool matchCase ) const
 {
   if ((d->m_operator & SIMPLE) != 0) {
-    // try case sensitive match first
-    int index = p.findCaseSensitive(d->m_attrName);
-    if (index < 0 && !matchCase) index = p.find(d->m_attrName);
-    return index < 0 ? false : compare(p.value(index), d->m_operator, d->m_attrValue);
+    // the keys of the properties differ by more than their case
+    int index = p.find(d->m_attrAtom);
+    if (index >= 0 && matchCase && p.key(index) != d->m_attrName) index = -1;
+    return index < 0 ? false : compare(p.value(index));
   } else { // (d->m_operator & COMPLEX) != 0
     switch (d->m_operator) {
     case AND:
@@ -311,17 +443,19 @@ bool ctkLDAPExpr::evaluate( const ctkServiceProperties &p, bool matchCase ) cons
 }
 
 //----------------------------------------------------------------------------
-bool ctkLDAPExpr::compare( const QVariant &obj, int op, const QString &s ) const
+bool ctkLDAPExpr::compare( const QVariant &obj ) const
 {
+  const int op = d->m_operator;
+  const QString& s = d->m_attrValue;
   if (obj.isNull())
     return false;
-  if (op == EQ && s == WILDCARD_QString )
+  if (op == EQ && d->m_isWildcard)
     return true;
   try {
     if ( obj.canConvert<QString>( ) ) {
-      return compareString(obj.toString(), op, s);
+      return compareString(obj.toString());
     } else if (obj.canConvert<char>( ) ) {
-      return compareString(obj.toString(), op, s);
+      return compareString(obj.toString());
     } else if (obj.canConvert<bool>( ) ) {
       if (op==LE || op==GE)
         return false;
@@ -335,45 +469,45 @@ bool ctkLDAPExpr::compare( const QVariant &obj, int op, const QString &s ) const
     {
       switch(op) {
       case LE:
-        return obj.toInt() <= s.toInt();
+        return obj.toInt() <= d->m_intValue;
       case GE:
-        return obj.toInt() >= s.toInt();
+        return obj.toInt() >= d->m_intValue;
       default: /*APPROX and EQ*/
-        return s.toInt( ) == obj.toInt();
+        return d->m_intValue == obj.toInt();
       }
     } else if ( obj.canConvert<float>( ) ) {
       switch(op) {
       case LE:
-        return obj.toFloat() <= s.toFloat();
+        return obj.toFloat() <= d->m_floatValue;
       case GE:
-        return obj.toFloat() >= s.toFloat();
+        return obj.toFloat() >= d->m_floatValue;
       default: /*APPROX and EQ*/
-        return s.toFloat() == obj.toFloat();
+        return d->m_floatValue == obj.toFloat();
       }
     } else if (obj.canConvert<double>()) {
       switch(op) {
       case LE:
-        return obj.toDouble() <= s.toDouble();
+        return obj.toDouble() <= d->m_doubleValue;
       case GE:
-        return obj.toDouble() >= s.toDouble();
+        return obj.toDouble() >= d->m_doubleValue;
       default: /*APPROX and EQ*/
-        return s.toDouble( ) == obj.toDouble( );
+        return d->m_doubleValue == obj.toDouble( );
       }
     } else if (obj.canConvert<qlonglong>( )) {
       switch(op) {
       case LE:
-        return obj.toLongLong() <= s.toLongLong( );
+        return obj.toLongLong() <= d->m_longLongValue;
       case GE:
-        return obj.toLongLong() >= s.toLongLong( );
+        return obj.toLongLong() >= d->m_longLongValue;
       default: /*APPROX and EQ*/
-        return obj.toLongLong() == s.toLongLong( );
+        return obj.toLongLong() == d->m_longLongValue;
       }
     } 
     else if (obj.canConvert< QList<QVariant> >()) {
       QList<QVariant> list = obj.toList();
       QList<QVariant>::Iterator it;
       for (it=list.begin(); it != list.end( ); it++)
-         if (compare(*it, op, s))
+         if (compare(*it))
            return true;
     } 
   } catch (...) {
@@ -384,17 +518,20 @@ bool ctkLDAPExpr::compare( const QVariant &obj, int op, const QString &s ) const
 }
 
 //----------------------------------------------------------------------------
-bool ctkLDAPExpr::compareString( const QString &s1, int op, const QString &s2 )
+bool ctkLDAPExpr::compareString( const QString &s1 ) const
 {
-  switch(op) {
+  const QString& s2 = d->m_attrValue;
+  switch(d->m_operator) {
   case LE:
     return s1.compare(s2) <= 0;
   case GE:
     return s1.compare(s2) >= 0;
   case EQ:
+    if (!d->m_hasWildcard)
+      return !s1.isNull() && s1 == s2;
     return patSubstr(s1,s2);
   case APPROX:
-    return fixupString(s2) == fixupString(s1);
+    return d->m_approxValue == fixupString(s1);
   default:
     return false;
   }
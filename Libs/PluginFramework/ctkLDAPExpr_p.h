@@ -84,6 +84,20 @@ public:
    */
   bool getMatchedObjectClasses(QSet<QString>& objClasses) const;
 
+  /**
+   * Get a set of equality clauses of which the properties must satisfy
+   * at least one for this expression to match. The clauses are strings
+   * <code><it>name</it>=<it>value</it></code> with <it>name</it> in lower
+   * case. Only <code>(<it>name</it>=<it>value</it>)</code> expressions
+   * whose value contains no wildcard and is not a number are used, because
+   * they match string properties by plain string equality.
+   *
+   * \param clauses The clauses will be added to clauses.
+   * \return <code>false</code> if no such set can be determined, e.g.
+   *         for NOT expressions; <code>true</code> otherwise.
+   */
+  bool getIndexClauses(QSet<QString>& clauses) const;
+
   /**
    * Checks if this LDAP expression is "simple". The definition of
    * a simple filter is:
@@ -123,6 +137,22 @@ public:
   //!
   static bool query(const QString &filter, const ctkDictionary &pd);
 
+  /**
+   * Returns the parsed expression of <code>filter</code>. The expressions
+   * are kept in a bounded cache shared by the whole process, so that the
+   * same filter string is only parsed once. This method is thread safe.
+   *
+   * 	hrows ctkInvalidArgumentException if <code>filter</code> is malformed.
+   */
+  static ctkLDAPExpr compiled(const QString &filter);
+
+  /**
+   * Set the maximum number of expressions kept by compiled(),
+   * 256 by default.
+   */
+  static void setCompiledCacheSize(int size);
+  static int compiledCacheSize();
+
   //! Evaluate this LDAP filter.
   bool evaluate(const ctkServiceProperties &p, bool matchCase) const;
 
@@ -132,6 +162,8 @@ public:
 
 private:
 
+  friend class ctkLDAPExprData;
+
   class ParseState;
 
   //!
@@ -146,11 +178,11 @@ private:
   //!
   static ctkLDAPExpr parseSimple(ParseState &ps);
 
-  //!
-  bool compare(const QVariant &obj, int op, const QString &s) const;
+  //! Compare obj with the pre-parsed value of this simple expression.
+  bool compare(const QVariant &obj) const;
 
   //!
-  static bool compareString(const QString &s1, int op, const QString &s2);
+  bool compareString(const QString &s) const;
 
   //!
   static QString fixupString(const QString &s);
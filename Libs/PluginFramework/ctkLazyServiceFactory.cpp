@@ -0,0 +1,116 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkLazyServiceFactory_p.h"
+
+#include "ctkPlugin_p.h"
+#include "ctkPluginConstants.h"
+#include "ctkPluginContext.h"
+#include "ctkPluginFrameworkContext_p.h"
+#include "ctkServices_p.h"
+
+#include <QDebug>
+
+//----------------------------------------------------------------------------
+ctkLazyServiceFactory::ctkLazyServiceFactory(ctkPluginPrivate* plugin, const QString& clazz)
+  : plugin(plugin), clazz(clazz)
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkLazyServiceFactory::activate()
+{
+  if (plugin->state == ctkPlugin::STARTING)
+  {
+    if (plugin->fwCtx->debug.lazy_activation)
+    {
+      qDebug() << "activating #" << plugin->id << "for service" << clazz;
+    }
+    plugin->finalizeActivation();
+  }
+}
+
+//----------------------------------------------------------------------------
+QObject* ctkLazyServiceFactory::getService(QSharedPointer<ctkPlugin> requester,
+                                           ctkServiceRegistration registration)
+{
+  ctkPluginContext* context = requester->getPluginContext();
+  if (!context)
+  {
+    return 0;
+  }
+
+  // The best ranked service of the plugin, other than this one
+  ctkServiceReference self = registration.getReference();
+  ctkServiceReference best;
+  foreach (ctkServiceRegistration sr, plugin->fwCtx->services->getRegisteredByPlugin(plugin))
+  {
+    ctkServiceReference ref = sr.getReference();
+    if (ref == self ||
+        !ref.getProperty(ctkPluginConstants::OBJECTCLASS).toStringList().contains(clazz))
+    {
+      continue;
+    }
+    if (!best || best < ref)
+    {
+      best = ref;
+    }
+  }
+  if (!best)
+  {
+    return 0;
+  }
+
+  QObject* service = context->getService(best);
+  if (service)
+  {
+    QMutexLocker lock(&mutex);
+    references.insert(requester.data(), best);
+  }
+  return service;
+}
+
+//----------------------------------------------------------------------------
+void ctkLazyServiceFactory::ungetService(QSharedPointer<ctkPlugin> requester,
+                                         ctkServiceRegistration registration,
+                                         QObject* service)
+{
+  Q_UNUSED(registration)
+  Q_UNUSED(service)
+
+  ctkServiceReference ref;
+  {
+    QMutexLocker lock(&mutex);
+    ref = references.take(requester.data());
+  }
+  ctkPluginContext* context = requester->getPluginContext();
+  if (ref && context)
+  {
+    try
+    {
+      context->ungetService(ref);
+    }
+    catch (const ctkIllegalStateException&)
+    {
+      // the service has been unregistered with its plugin
+    }
+  }
+}
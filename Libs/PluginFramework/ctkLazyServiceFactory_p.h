@@ -0,0 +1,74 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKLAZYSERVICEFACTORY_P_H
+#define CTKLAZYSERVICEFACTORY_P_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+
+#include "ctkServiceFactory.h"
+#include "ctkServiceReference.h"
+
+class ctkPluginPrivate;
+
+/**
+ * \ingroup PluginFramework
+ *
+ * Service factory registered for each service a lazily activated plugin
+ * declares in its Plugin-ProvideServices manifest header. The plugin,
+ * and so its shared library, is activated when the service is first
+ * requested. The factory then hands out the service the plugin
+ * registered under the same class.
+ */
+class ctkLazyServiceFactory : public QObject, public ctkServiceFactory
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkServiceFactory)
+
+public:
+
+  ctkLazyServiceFactory(ctkPluginPrivate* plugin, const QString& clazz);
+
+  /**
+   * Activate the plugin if it is waiting for lazy activation. Called
+   * before getService(), outside of the locks of the registration.
+   */
+  void activate();
+
+  QObject* getService(QSharedPointer<ctkPlugin> plugin, ctkServiceRegistration registration);
+
+  void ungetService(QSharedPointer<ctkPlugin> plugin, ctkServiceRegistration registration,
+                    QObject* service);
+
+private:
+
+  ctkPluginPrivate* const plugin;
+  const QString clazz;
+
+  QMutex mutex;
+  /** The service of the plugin handed out to each requesting plugin. */
+  QHash<ctkPlugin*, ctkServiceReference> references;
+};
+
+#endif // CTKLAZYSERVICEFACTORY_P_H
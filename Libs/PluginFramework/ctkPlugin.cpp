@@ -107,6 +107,7 @@ void ctkPlugin::start(const StartOptions& options)
     d->pluginContext.reset(new ctkPluginContext(this->d_func()));
     ctkPluginEvent pluginEvent(ctkPluginEvent::LAZY_ACTIVATION, d->q_ptr);
     d->fwCtx->listeners.emitPluginChanged(pluginEvent);
+    d->registerLazyServices();
   }
   else
   {
@@ -122,6 +122,38 @@ struct CTK_PLUGINFW_EXPORT ctkPluginConstants {
    */
   static const QString FRAMEWORK_PRELOAD_LIBRARIES; // = "org.commontk.pluginfw.preloadlibs"
 
+  /**
+   * Specifies the number of threads used to start the plugins which are
+   * started when the framework is launched. The value of this property must
+   * be convertible to an int. A value of 1 or less, the default, starts the
+   * plugins one at a time. Otherwise the plugins are started in waves: a
+   * plugin is started once the plugins it requires (see #REQUIRE_PLUGIN)
+   * have been started, independent plugins are started concurrently.
+   *
+   * The activators of these plugins are called from a worker thread. They
+   * must be thread safe, and QObjects they create which need an event loop
+   * must be moved to the main thread. The activator itself is moved to the
+   * main thread once started.
+   */
+  static const QString FRAMEWORK_PARALLEL_ACTIVATION; // = "org.commontk.pluginfw.parallelActivation"
+
+  /**
+   * Specifies the number of threads used to load the libraries of the
+   * plugins which are eagerly activated when the framework is launched, or
+   * by ctkPluginFrameworkLauncher. The value of this property must be
+   * convertible to an int. A value of 1 or less, the default, loads each
+   * library when its plugin is started. Otherwise the libraries are loaded
+   * in waves before the first activator runs: a library is loaded once the
+   * libraries of the plugins it requires (see #REQUIRE_PLUGIN) have been
+   * loaded, independent libraries are loaded concurrently.
+   *
+   * Only the libraries are loaded concurrently, the activators are still
+   * called one at a time from the calling thread. Plugins with a lazy
+   * activation policy which are started with ctkPlugin::START_ACTIVATION_POLICY
+   * are not loaded until they are activated.
+   */
+  static const QString FRAMEWORK_PARALLEL_LOADING; // = "org.commontk.pluginfw.parallelLoading"
+
   /**
    * Manifest header identifying the plugin's symbolic name.
    *
@@ -239,6 +271,24 @@ struct CTK_PLUGINFW_EXPORT ctkPluginConstants {
    */
   static const QString PLUGIN_ACTIVATIONPOLICY; // = "Plugin-ActivationPolicy"
 
+  /**
+   * Manifest header listing the classes, separated by commas, of the
+   * services a plugin registers from its activator.
+   *
+   * <p>
+   * When a plugin with the lazy activation policy is started with the
+   * ctkPlugin#START_ACTIVATION_POLICY option, the framework registers a
+   * service factory for each of these classes, without loading the
+   * plugin's shared library. The plugin is activated when one of these
+   * services is first requested with ctkPluginContext::getService(), and
+   * the service the plugin registered under the same class is returned.
+   *
+   * <pre>
+   *       Plugin-ProvideServices: org.commontk.service.event.EventAdmin
+   * </pre>
+   */
+  static const QString PLUGIN_PROVIDE_SERVICES; // = "Plugin-ProvideServices"
+
   /**
    * Manifest header identifying the location from which a new plugin version
    * is obtained during a plugin update operation.
@@ -20,6 +20,7 @@
 =============================================================================*/
 
 #include "ctkPlugin_p.h"
+#include "ctkPluginConstants.h"
 #include "ctkPluginContext.h"
 #include "ctkPluginContext_p.h"
 #include "ctkPluginFrameworkContext_p.h"
@@ -140,7 +141,17 @@ QList<ctkServiceReference> ctkPluginContext::getServiceReferences(const QString&
 {
   Q_D(ctkPluginContext);
   d->isPluginContextValid();
-  return d->plugin->fwCtx->services->get(clazz, filter, 0);
+  ctkPluginFrameworkProfiler& profiler = d->plugin->fwCtx->profiler;
+  if (!profiler.isEnabled())
+  {
+    return d->plugin->fwCtx->services->get(clazz, filter, 0);
+  }
+
+  ctkPluginFrameworkProfiler::Timer timer;
+  timer.start();
+  QList<ctkServiceReference> refs = d->plugin->fwCtx->services->get(clazz, filter, 0);
+  profiler.recordLookup(clazz, filter, timer.nsecsElapsed());
+  return refs;
 }
 
 //----------------------------------------------------------------------------
@@ -148,7 +159,17 @@ ctkServiceReference ctkPluginContext::getServiceReference(const QString& clazz)
 {
   Q_D(ctkPluginContext);
   d->isPluginContextValid();
-  return d->plugin->fwCtx->services->get(d->plugin, clazz);
+  ctkPluginFrameworkProfiler& profiler = d->plugin->fwCtx->profiler;
+  if (!profiler.isEnabled())
+  {
+    return d->plugin->fwCtx->services->get(d->plugin, clazz);
+  }
+
+  ctkPluginFrameworkProfiler::Timer timer;
+  timer.start();
+  ctkServiceReference ref = d->plugin->fwCtx->services->get(d->plugin, clazz);
+  profiler.recordLookup(clazz, QString(), timer.nsecsElapsed());
+  return ref;
 }
 
 //----------------------------------------------------------------------------
@@ -162,6 +183,11 @@ QObject* ctkPluginContext::getService(const ctkServiceReference& reference)
     throw ctkInvalidArgumentException("Default constructed ctkServiceReference is not a valid input to getService()");
   }
   ctkServiceReference internalRef(reference);
+  ctkPluginFrameworkProfiler& profiler = d->plugin->fwCtx->profiler;
+  if (profiler.isEnabled())
+  {
+    profiler.recordGetService(reference.getProperty(ctkPluginConstants::OBJECTCLASS).toStringList().value(0));
+  }
   return internalRef.d_func()->getService(d->plugin->q_func());
 }
 
@@ -171,6 +197,11 @@ bool ctkPluginContext::ungetService(const ctkServiceReference& reference)
   Q_D(ctkPluginContext);
   d->isPluginContextValid();
   ctkServiceReference ref = reference;
+  ctkPluginFrameworkProfiler& profiler = d->plugin->fwCtx->profiler;
+  if (profiler.isEnabled() && ref)
+  {
+    profiler.recordUngetService(ref.getProperty(ctkPluginConstants::OBJECTCLASS).toStringList().value(0));
+  }
   return ref.d_func()->ungetService(d->plugin->q_func(), true);
 }
 
@@ -240,3 +271,19 @@ void ctkPluginContext::disconnectServiceListener(QObject* receiver,
   d->isPluginContextValid();
   d->plugin->fwCtx->listeners.removeServiceSlot(getPlugin(), receiver, slot);
 }
+
+//----------------------------------------------------------------------------
+void ctkPluginContext::beginServiceBatch()
+{
+  Q_D(ctkPluginContext);
+  d->isPluginContextValid();
+  d->plugin->fwCtx->listeners.beginServiceBatch();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginContext::endServiceBatch()
+{
+  Q_D(ctkPluginContext);
+  d->isPluginContextValid();
+  d->plugin->fwCtx->listeners.endServiceBatch();
+}
@@ -723,6 +723,43 @@ public:
    */
   void disconnectServiceListener(QObject* receiver, const char* slot);
 
+  /**
+   * Starts batching the service events caused by the calling thread.
+   *
+   * <p>
+   * Until the matching call to endServiceBatch(), the service events
+   * caused by registering, modifying or unregistering services in the
+   * calling thread are queued instead of being delivered to the service
+   * listeners. This is useful for a plug-in registering many services,
+   * for instance in its activator.
+   *
+   * <p>
+   * Batches can be nested, the events are delivered when the outermost
+   * batch ends. Service events caused by other threads are not batched.
+   *
+   * @throws ctkIllegalStateException If this ctkPluginContext is no
+   *         longer valid.
+   * @see endServiceBatch()
+   */
+  void beginServiceBatch();
+
+  /**
+   * Ends a batch started with beginServiceBatch().
+   *
+   * <p>
+   * When the outermost batch ends, the queued events are delivered to each
+   * service listener in one pass, listener after listener. Each listener
+   * receives its events in the order they occurred, but a
+   * <code>MODIFIED</code> event is dropped if the same listener receives a
+   * later <code>MODIFIED</code> event for the same service. Listeners
+   * disconnected during the batch receive no events.
+   *
+   * @throws ctkIllegalStateException If this ctkPluginContext is no
+   *         longer valid or if no batch was started by the calling thread.
+   * @see beginServiceBatch()
+   */
+  void endServiceBatch();
+
 protected:
 
   friend class ctkPluginFrameworkPrivate;
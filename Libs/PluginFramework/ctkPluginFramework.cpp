@@ -123,6 +123,26 @@ void ctkPluginFramework::start(const ctkPlugin::StartOptions& options)
   d->activate(d->pluginContext.data());
 
   // Start plugins according to their autostart setting.
+  const int activationThreads =
+      d->fwCtx->props.value(ctkPluginConstants::FRAMEWORK_PARALLEL_ACTIVATION).toInt();
+  QList<QSharedPointer<ctkPlugin> > concurrentPlugins;
+  QList<int> concurrentOptions;
+  const int loadThreads =
+      d->fwCtx->props.value(ctkPluginConstants::FRAMEWORK_PARALLEL_LOADING).toInt();
+  if (loadThreads > 1 && activationThreads <= 1)
+  {
+    QList<QSharedPointer<ctkPlugin> > eagerPlugins;
+    foreach (const QString& location, pluginsToStart)
+    {
+      QSharedPointer<ctkPlugin> plugin = d->fwCtx->plugins->getPlugin(location);
+      if (plugin && ctkPlugins::isEagerStart(plugin.data(),
+                                             plugin->d_func()->archive->getAutostartSetting()))
+      {
+        eagerPlugins << plugin;
+      }
+    }
+    d->fwCtx->plugins->loadPluginLibrariesConcurrently(eagerPlugins, loadThreads);
+  }
   QStringListIterator i(pluginsToStart);
   while (i.hasNext())
   {
@@ -136,6 +156,12 @@ void ctkPluginFramework::start(const ctkPlugin::StartOptions& options)
         // Transient start according to the plugins activation policy.
         option |= ctkPlugin::START_ACTIVATION_POLICY;
       }
+      if (activationThreads > 1)
+      {
+        concurrentPlugins << plugin;
+        concurrentOptions << static_cast<int>(option);
+        continue;
+      }
       plugin->start(option);
     }
     catch (const ctkPluginException& pe)
@@ -143,6 +169,11 @@ void ctkPluginFramework::start(const ctkPlugin::StartOptions& options)
       d->fwCtx->listeners.frameworkError(plugin, pe);
     }
   }
+  if (!concurrentPlugins.isEmpty())
+  {
+    d->fwCtx->plugins->startPluginsConcurrently(concurrentPlugins, concurrentOptions,
+                                                activationThreads);
+  }
 
   {
     ctkPluginPrivate::Locker sync(&d->lock);
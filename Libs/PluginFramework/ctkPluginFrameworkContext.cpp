@@ -50,6 +50,7 @@ ctkPluginFrameworkContext::ctkPluginFrameworkContext()
   }
 
   initProperties();
+  profiler.setEnabled(debug.profiling);
   log() << "created";
 }
 
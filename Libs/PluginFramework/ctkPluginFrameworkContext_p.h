@@ -32,6 +32,7 @@
 #include "ctkPlugins_p.h"
 #include "ctkPluginFrameworkListeners_p.h"
 #include "ctkPluginFrameworkDebug_p.h"
+#include "ctkPluginFrameworkProfiler_p.h"
 
 
 class ctkPlugin;
@@ -103,6 +104,11 @@ public:
    */
   ctkPluginFrameworkDebug debug;
 
+  /**
+   * Profiling data, registered as the ctkFrameworkProfiler service.
+   */
+  ctkPluginFrameworkProfiler profiler;
+
   /**
    * Contruct a framework context
    *
@@ -37,9 +37,11 @@ QString ctkPluginFrameworkDebug::OPTION_DEBUG_SERVICE_REFERENCE = CTK_OSGI + "/d
 QString ctkPluginFrameworkDebug::OPTION_DEBUG_STARTLEVEL = CTK_OSGI + "/debug/startlevel";
 QString ctkPluginFrameworkDebug::OPTION_DEBUG_URL = CTK_OSGI + "/debug/url";
 QString ctkPluginFrameworkDebug::OPTION_DEBUG_RESOLVE = CTK_OSGI + "/debug/resolve";
+QString ctkPluginFrameworkDebug::OPTION_DEBUG_PROFILING = CTK_OSGI + "/debug/profiling";
 
 //----------------------------------------------------------------------------
 ctkPluginFrameworkDebug::ctkPluginFrameworkDebug()
+  : profiling(false)
 {
   ctkPluginFrameworkDebugOptions* dbgOptions = ctkPluginFrameworkDebugOptions::getDefault();
   if (dbgOptions != NULL)
@@ -54,5 +56,6 @@ ctkPluginFrameworkDebug::ctkPluginFrameworkDebug()
     startlevel = dbgOptions->getBooleanOption(OPTION_DEBUG_STARTLEVEL, false);
     url = dbgOptions->getBooleanOption(OPTION_DEBUG_URL, false);
     resolve = dbgOptions->getBooleanOption(OPTION_DEBUG_RESOLVE, false);
+    profiling = dbgOptions->getBooleanOption(OPTION_DEBUG_PROFILING, false);
   }
 }
@@ -93,6 +93,12 @@ public:
   static QString OPTION_DEBUG_RESOLVE;
   bool resolve;
 
+  /**
+   * Enable the ctkFrameworkProfiler service on startup
+   */
+  static QString OPTION_DEBUG_PROFILING;
+  bool profiling;
+
 };
 
 #endif // CTKPLUGINFRAMEWORKDEBUG_P_H
@@ -23,9 +23,12 @@
 #include "ctkPluginFrameworkFactory.h"
 #include "ctkPluginFrameworkProperties_p.h"
 #include "ctkPluginFramework.h"
+#include "ctkPluginConstants.h"
 #include "ctkPluginContext.h"
 #include "ctkPluginException.h"
+#include "ctkPluginFrameworkContext_p.h"
 #include "ctkPlugin_p.h"
+#include "ctkPlugins_p.h"
 #include "ctkDefaultApplicationLauncher_p.h"
 #include "ctkLocationManager_p.h"
 #include "ctkBasicLocation_p.h"
@@ -34,6 +37,7 @@
 
 #include <QStringList>
 #include <QDirIterator>
+#include <QFile>
 #include <QFileInfo>
 #include <QDebug>
 #include <QRunnable>
@@ -82,6 +86,8 @@ const QString ctkPluginFrameworkLauncher::PROP_APPLICATION_LAUNCHDEFAULT = "ctk.
 
 const QString ctkPluginFrameworkLauncher::PROP_OSGI_RELAUNCH = "ctk.pluginfw.relaunch";
 
+const QString ctkPluginFrameworkLauncher::PROP_STARTUP_PROFILE = "ctk.pluginfw.startupProfile";
+
 static const QString PROP_FORCED_RESTART = "ctk.forcedRestart";
 
 class ctkPluginFrameworkLauncherPrivate
@@ -255,8 +261,10 @@ public:
     if (pc == 0 && fwFactory == 0)
     {
       fwFactory.reset(new ctkPluginFrameworkFactory(fwProps));
+      enableStartupProfile();
       try
       {
+        ctkPluginFrameworkProfiler::TimelineScope timelineScope(profiler(), "framework", "init");
         fwFactory->getFramework()->init();
         pc = fwFactory->getFramework()->getPluginContext();
       }
@@ -271,6 +279,57 @@ public:
     return install(QUrl::fromLocalFile(pluginPath), pc);
   }
 
+  //----------------------------------------------------------------------------
+  QString startupProfileFile() const
+  {
+    QVariant file = fwProps.value(ctkPluginFrameworkLauncher::PROP_STARTUP_PROFILE);
+    if (!file.isValid())
+    {
+      file = ctkPluginFrameworkProperties::getProperty(ctkPluginFrameworkLauncher::PROP_STARTUP_PROFILE);
+    }
+    return file.toString();
+  }
+
+  //----------------------------------------------------------------------------
+  ctkPluginFrameworkProfiler& profiler() const
+  {
+    QSharedPointer<ctkPluginFramework> framework = fwFactory->getFramework();
+    return static_cast<ctkPlugin*>(framework.data())->d_func()->fwCtx->profiler;
+  }
+
+  //----------------------------------------------------------------------------
+  void enableStartupProfile()
+  {
+    if (fwFactory && !startupProfileFile().isEmpty())
+    {
+      profiler().setTimelineEnabled(true);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void writeStartupProfile()
+  {
+    QString fileName = startupProfileFile();
+    if (!fwFactory || fileName.isEmpty() || !profiler().isTimelineEnabled())
+    {
+      return;
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      qWarning() << "Failed to write the startup profile" << fileName << ":" << file.errorString();
+      return;
+    }
+    if (fileName.endsWith(".json", Qt::CaseInsensitive))
+    {
+      file.write(profiler().timelineToChromeTrace());
+    }
+    else
+    {
+      file.write(profiler().timelineReport().toUtf8());
+    }
+  }
+
   //----------------------------------------------------------------------------
   void resolvePlugin(const QSharedPointer<ctkPlugin>& plugin)
   {
@@ -280,6 +339,36 @@ public:
     }
   }
 
+  /*
+   * Load the libraries of the plugins which are activated by starting them with
+   * startOptions, see ctkPluginConstants::FRAMEWORK_PARALLEL_LOADING.
+   */
+  //----------------------------------------------------------------------------
+  void loadEagerPlugins(const QList<QSharedPointer<ctkPlugin> >& plugins, ctkPlugin::StartOptions startOptions)
+  {
+    QSharedPointer<ctkPluginFramework> fw = fwFactory->getFramework();
+    const int loadThreads = fw->getPluginContext()->getProperty(
+                              ctkPluginConstants::FRAMEWORK_PARALLEL_LOADING).toInt();
+    if (loadThreads <= 1)
+    {
+      return;
+    }
+
+    QList<QSharedPointer<ctkPlugin> > eagerPlugins;
+    foreach(QSharedPointer<ctkPlugin> plugin, plugins)
+    {
+      if (plugin && ctkPlugins::isEagerStart(plugin.data(), startOptions))
+      {
+        eagerPlugins.push_back(plugin);
+      }
+    }
+    if (!eagerPlugins.isEmpty())
+    {
+      static_cast<ctkPlugin*>(fw.data())->d_func()->fwCtx->plugins->loadPluginLibrariesConcurrently(
+            eagerPlugins, loadThreads);
+    }
+  }
+
   /*
    * Ensure all basic plugins are installed, resolved and scheduled to start. Returns a list containing
    * all basic bundles that are marked to start.
@@ -354,6 +443,8 @@ public:
       this->resolvePlugin(plugin);
     }
 
+    this->loadEagerPlugins(startEntries, startOptions);
+
     foreach(QSharedPointer<ctkPlugin> plugin, startEntries)
     {
       plugin->start(startOptions);
@@ -516,8 +607,16 @@ ctkPluginContext* ctkPluginFrameworkLauncher::startup(QRunnable* endSplashHandle
   //registerFrameworkShutdownHandlers();
   //publishSplashScreen(endSplashHandler);
   //consoleMgr = ConsoleManager.startConsole(framework);
-  d->fwFactory->getFramework()->start();
-  d->loadBasicPlugins();
+  d->enableStartupProfile();
+  {
+    ctkPluginFrameworkProfiler::TimelineScope timelineScope(d->profiler(), "framework", "start");
+    d->fwFactory->getFramework()->start();
+  }
+  {
+    ctkPluginFrameworkProfiler::TimelineScope timelineScope(d->profiler(), "framework", "load basic plugins");
+    d->loadBasicPlugins();
+  }
+  d->writeStartupProfile();
 
   d->running = true;
   
@@ -568,8 +667,10 @@ bool ctkPluginFrameworkLauncher::start(const QString& symbolicName, ctkPlugin::S
   // instantiate and start the framework
   if (context == 0 && d->fwFactory == 0) {
     d->fwFactory.reset(new ctkPluginFrameworkFactory(d->fwProps));
+    d->enableStartupProfile();
     try
     {
+      ctkPluginFrameworkProfiler::TimelineScope timelineScope(d->profiler(), "framework", "start");
       d->fwFactory->getFramework()->start();
     }
     catch (const ctkPluginException& exc)
@@ -606,10 +707,12 @@ bool ctkPluginFrameworkLauncher::start(const QString& symbolicName, ctkPlugin::S
     catch (const ctkPluginException& exc)
     {
       qWarning() << "Failed to install plugin:" << exc;
+      d->writeStartupProfile();
       return false;
     }
   }
 
+  d->writeStartupProfile();
   return true;
 }
 
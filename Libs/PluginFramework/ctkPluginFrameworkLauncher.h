@@ -83,6 +83,16 @@ public:
 
   static const QString PROP_OSGI_RELAUNCH; // = "ctk.pluginfw.relaunch";
 
+  /**
+   * File the startup profile is written into when the framework has
+   * been started by #startup or #start: the wall time of the framework
+   * start and of each plugin install, resolve, library load, activator
+   * start and service registration. The profile is written in the Chrome
+   * trace event format if the file name ends with ".json", as a text
+   * report otherwise.
+   */
+  static const QString PROP_STARTUP_PROFILE; // = "ctk.pluginfw.startupProfile";
+
 
   /**
    * Specify the set of framework properties to be used when
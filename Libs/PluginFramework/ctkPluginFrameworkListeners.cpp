@@ -28,12 +28,40 @@
 #include "ctkServiceReference_p.h"
 
 #include <QStringListIterator>
+#include <QThread>
+#include <QVector>
 #include <QDebug>
 
 const int ctkPluginFrameworkListeners::OBJECTCLASS_IX = 0;
 const int ctkPluginFrameworkListeners::SERVICE_ID_IX = 1;
 const int ctkPluginFrameworkListeners::SERVICE_PID_IX = 2;
 
+//----------------------------------------------------------------------------
+static void ctkAddIndexClauses(QSet<QString>& clauses, const QString& key,
+                               const QVariant& value)
+{
+  if (value.type() == QVariant::List || value.type() == QVariant::StringList)
+  {
+    foreach (const QVariant& item, value.toList())
+    {
+      ctkAddIndexClauses(clauses, key, item);
+    }
+  }
+  else if (!value.isNull())
+  {
+    clauses.insert(key + '=' + value.toString());
+  }
+}
+
+//----------------------------------------------------------------------------
+template<class Type>
+static QString ctkEventName(const char* event, Type type)
+{
+  QString typeName;
+  QDebug(&typeName) << type;
+  return QString(event) + " " + typeName.trimmed();
+}
+
 //----------------------------------------------------------------------------
 ctkPluginFrameworkListeners::ctkPluginFrameworkListeners(ctkPluginFrameworkContext* pluginFw)
   : pluginFw(pluginFw)
@@ -133,6 +161,49 @@ QSet<ctkServiceSlotEntry> ctkPluginFrameworkListeners::getMatchingServiceSlots(
       << "listeners with complicated filters";
   }
 
+  // Evaluate the indexed listeners whose clauses the service has
+  if (!indexedListeners.isEmpty())
+  {
+    const ctkServiceProperties& props = sr.d_func()->getProperties();
+    QSet<QString> clauses;
+    QStringList keys = props.keys();
+    for (int i = 0; i < keys.size(); ++i)
+    {
+      ctkAddIndexClauses(clauses, keys[i].toLower(), props.value(i));
+    }
+
+    QSet<ctkServiceSlotEntry> evaluated;
+    int nIndexedMatches = 0;
+    foreach (const QString& clause, clauses)
+    {
+      QHash<QString, QList<ctkServiceSlotEntry> >::const_iterator it =
+          indexedListeners.find(clause);
+      if (it == indexedListeners.end()) continue;
+      foreach (const ctkServiceSlotEntry& sse, it.value())
+      {
+        if (evaluated.contains(sse)) continue;
+        evaluated.insert(sse);
+        if (sse.getLDAPExpr().evaluate(props, false))
+        {
+          set.insert(sse);
+          ++nIndexedMatches;
+        }
+      }
+    }
+    n += evaluated.size();
+
+    if (pluginFw->debug.ldap)
+    {
+      qDebug() << "Added" << nIndexedMatches << "out of" << evaluated.size()
+        << "evaluated of" << indexedClauses.size() << "listeners with indexed filters";
+    }
+  }
+
+  if (pluginFw->debug.ldap)
+  {
+    qDebug() << "Evaluated" << n << "filters for service event";
+  }
+
   // Check the cache
   QStringList c = sr.d_func()->getProperty(ctkPluginConstants::OBJECTCLASS, lockProps).toStringList();
   foreach (QString objClass, c)
@@ -165,13 +236,32 @@ void ctkPluginFrameworkListeners::frameworkError(QSharedPointer<ctkPlugin> p, co
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkListeners::emitFrameworkEvent(const ctkPluginFrameworkEvent& event)
 {
+  if (!pluginFw->profiler.isEnabled())
+  {
+    emit frameworkEvent(event);
+    return;
+  }
+
+  ctkPluginFrameworkProfiler::Timer timer;
+  timer.start();
   emit frameworkEvent(event);
+  pluginFw->profiler.recordDispatch(ctkEventName("FrameworkEvent", event.getType()), timer.nsecsElapsed());
 }
 
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkListeners::emitPluginChanged(const ctkPluginEvent& event)
 {
-  emit pluginChangedDirect(event);
+  if (pluginFw->profiler.isEnabled())
+  {
+    ctkPluginFrameworkProfiler::Timer timer;
+    timer.start();
+    emit pluginChangedDirect(event);
+    pluginFw->profiler.recordDispatch(ctkEventName("PluginEvent", event.getType()), timer.nsecsElapsed());
+  }
+  else
+  {
+    emit pluginChangedDirect(event);
+  }
 
   if (!(event.getType() == ctkPluginEvent::STARTING ||
       event.getType() == ctkPluginEvent::STOPPING ||
@@ -196,12 +286,24 @@ void ctkPluginFrameworkListeners::serviceChanged(
     const ctkServiceEvent& evt,
     QSet<ctkServiceSlotEntry>& matchBefore)
 {
+  if (queueServiceEvent(receivers, evt, matchBefore))
+  {
+    return;
+  }
+
   ctkServiceReference sr = evt.getServiceReference();
   //QStringList classes = sr.getProperty(ctkPluginConstants::OBJECTCLASS).toStringList();
   int n = 0;
 
   //framework.hooks.filterServiceEventReceivers(evt, receivers);
 
+  const bool profiling = pluginFw->profiler.isEnabled();
+  ctkPluginFrameworkProfiler::Timer timer;
+  if (profiling)
+  {
+    timer.start();
+  }
+
   foreach (ctkServiceSlotEntry l, receivers)
   {
     if (!matchBefore.isEmpty())
@@ -232,12 +334,131 @@ void ctkPluginFrameworkListeners::serviceChanged(
     //}
   }
 
+  if (profiling)
+  {
+    QString event = ctkEventName("ServiceEvent", evt.getType());
+    event += " " + sr.getProperty(ctkPluginConstants::OBJECTCLASS).toStringList().value(0);
+    pluginFw->profiler.recordDispatch(event, timer.nsecsElapsed());
+  }
+
   if (pluginFw->debug.ldap)
   {
     qDebug() << "Notified" << n << " listeners";
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkListeners::beginServiceBatch()
+{
+  QMutexLocker lock(&batchMutex);
+  ++serviceBatches[QThread::currentThread()].depth;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkListeners::endServiceBatch()
+{
+  QList<QPair<QSet<ctkServiceSlotEntry>, ctkServiceEvent> > events;
+  {
+    QMutexLocker lock(&batchMutex);
+    QHash<QThread*, ServiceBatch>::iterator batch = serviceBatches.find(QThread::currentThread());
+    if (batch == serviceBatches.end())
+    {
+      throw ctkIllegalStateException("endServiceBatch() called without beginServiceBatch()");
+    }
+    if (--batch->depth > 0)
+    {
+      return;
+    }
+    events = batch->events;
+    serviceBatches.erase(batch);
+  }
+
+  // Group the events by listener, keeping the order of both
+  QList<ctkServiceSlotEntry> listeners;
+  QHash<ctkServiceSlotEntry, QList<ctkServiceEvent> > listenerEvents;
+  for (int i = 0; i < events.size(); ++i)
+  {
+    foreach (ctkServiceSlotEntry l, events[i].first)
+    {
+      QHash<ctkServiceSlotEntry, QList<ctkServiceEvent> >::iterator it = listenerEvents.find(l);
+      if (it == listenerEvents.end())
+      {
+        listeners.push_back(l);
+        it = listenerEvents.insert(l, QList<ctkServiceEvent>());
+      }
+      it->push_back(events[i].second);
+    }
+  }
+
+  int n = 0;
+  foreach (ctkServiceSlotEntry l, listeners)
+  {
+    if (l.isRemoved()) continue;
+
+    // A MODIFIED event is superseded by a later one for the same service
+    const QList<ctkServiceEvent>& evts = listenerEvents[l];
+    QVector<bool> superseded(evts.size(), false);
+    QSet<qlonglong> modified;
+    for (int i = evts.size() - 1; i >= 0; --i)
+    {
+      if (evts[i].getType() == ctkServiceEvent::MODIFIED)
+      {
+        const qlonglong sid = evts[i].getServiceReference().getProperty(ctkPluginConstants::SERVICE_ID).toLongLong();
+        superseded[i] = modified.contains(sid);
+        modified.insert(sid);
+      }
+    }
+
+    for (int i = 0; i < evts.size(); ++i)
+    {
+      if (superseded[i]) continue;
+      try
+      {
+        ++n;
+        l.invokeSlot(evts[i]);
+      }
+      catch (const ctkException& pe)
+      {
+        frameworkError(l.getPlugin(), pe);
+      }
+      catch (const std::exception& e)
+      {
+        frameworkError(l.getPlugin(), ctkRuntimeException(e.what()));
+      }
+    }
+  }
+
+  if (pluginFw->debug.ldap)
+  {
+    qDebug() << "Notified" << n << "batched events to" << listeners.size() << "listeners";
+  }
+}
+
+//----------------------------------------------------------------------------
+bool ctkPluginFrameworkListeners::queueServiceEvent(const QSet<ctkServiceSlotEntry>& receivers,
+                                                    const ctkServiceEvent& evt,
+                                                    QSet<ctkServiceSlotEntry>& matchBefore)
+{
+  QMutexLocker lock(&batchMutex);
+  QHash<QThread*, ServiceBatch>::iterator batch = serviceBatches.find(QThread::currentThread());
+  if (batch == serviceBatches.end())
+  {
+    return false;
+  }
+
+  // Same bookkeeping as for a direct delivery,
+  // for the MODIFIED_ENDMATCH event that follows
+  if (!matchBefore.isEmpty())
+  {
+    foreach (ctkServiceSlotEntry l, receivers)
+    {
+      matchBefore.remove(l);
+    }
+  }
+  batch->events.push_back(qMakePair(receivers, evt));
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void ctkPluginFrameworkListeners::removeFromCache(const ctkServiceSlotEntry& sse)
 {
@@ -260,6 +481,18 @@ void ctkPluginFrameworkListeners::removeFromCache(const ctkServiceSlotEntry& sse
       }
     }
   }
+  else if (indexedClauses.contains(sse))
+  {
+    foreach (const QString& clause, indexedClauses.take(sse))
+    {
+      QList<ctkServiceSlotEntry>& sses = indexedListeners[clause];
+      sses.removeAll(sse);
+      if (sses.isEmpty())
+      {
+        indexedListeners.remove(clause);
+      }
+    }
+  }
   else
   {
     complicatedListeners.removeAll(sse);
@@ -292,6 +525,16 @@ void ctkPluginFrameworkListeners::checkSimple(const ctkServiceSlotEntry& sse)
     }
     else
     {
+      QSet<QString> clauses;
+      if (sse.getLDAPExpr().getIndexClauses(clauses))
+      {
+        indexedClauses.insert(sse, clauses);
+        foreach (const QString& clause, clauses)
+        {
+          indexedListeners[clause].push_back(sse);
+        }
+        return;
+      }
       if (pluginFw->debug.ldap)
       {
         qDebug() << "## DEBUG: Too complicated filter:" << sse.getFilter();
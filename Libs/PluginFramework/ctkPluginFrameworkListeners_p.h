@@ -26,6 +26,7 @@
 #include <QHash>
 #include <QSet>
 #include <QMutex>
+#include <QPair>
 
 #include "ctkPluginEvent.h"
 #include "ctkPluginFrameworkEvent.h"
@@ -33,6 +34,8 @@
 #include "ctkServiceSlotEntry_p.h"
 #include "ctkServiceEvent.h"
 
+class QThread;
+
 /**
  * \ingroup PluginFramework
  */
@@ -94,6 +97,20 @@ public:
   void serviceChanged(const QSet<ctkServiceSlotEntry>& receivers,
                       const ctkServiceEvent& evt);
 
+  /**
+   * Starts queuing the service events of the calling thread.
+   */
+  void beginServiceBatch();
+
+  /**
+   * Delivers the service events queued since the outermost
+   * beginServiceBatch() call of the calling thread.
+   *
+   * @throws ctkIllegalStateException If the calling thread has
+   *         not started a batch.
+   */
+  void endServiceBatch();
+
   void emitPluginChanged(const ctkPluginEvent& event);
 
   void emitFrameworkEvent(const ctkPluginFrameworkEvent& event);
@@ -121,6 +138,12 @@ private:
   // Service listeners with complicated or empty filters
   QList<ctkServiceSlotEntry> complicatedListeners;
 
+  // Service listeners whose filter requires one of a set of equality
+  // clauses "name=value" on any property (see ctkLDAPExpr::getIndexClauses()).
+  // They are only evaluated for the services having one of these clauses.
+  QHash<QString, QList<ctkServiceSlotEntry> > indexedListeners;
+  QHash<ctkServiceSlotEntry, QSet<QString> > indexedClauses;
+
   // Service listeners with "simple" filters are cached
   QList<QHash<QString, QList<ctkServiceSlotEntry> > > cache;
 
@@ -128,6 +151,28 @@ private:
 
   ctkPluginFrameworkContext* pluginFw;
 
+  struct ServiceBatch
+  {
+    ServiceBatch() : depth(0) {}
+
+    int depth;
+    QList<QPair<QSet<ctkServiceSlotEntry>, ctkServiceEvent> > events;
+  };
+
+  QMutex batchMutex;
+
+  // The service batches by thread
+  QHash<QThread*, ServiceBatch> serviceBatches;
+
+  /**
+   * Queues the event if the calling thread has started a batch.
+   *
+   * @return <code>true</code> if the event was queued.
+   */
+  bool queueServiceEvent(const QSet<ctkServiceSlotEntry>& receivers,
+                         const ctkServiceEvent& evt,
+                         QSet<ctkServiceSlotEntry>& matchBefore);
+
   /**
    * Remove all references to a service slot from the service listener
    * cache.
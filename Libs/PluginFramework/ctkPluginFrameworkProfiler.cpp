@@ -0,0 +1,380 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkPluginFrameworkProfiler_p.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+
+namespace {
+
+//----------------------------------------------------------------------------
+bool ctkGreaterValue(const QPair<qint64, QString>& a, const QPair<qint64, QString>& b)
+{
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+//----------------------------------------------------------------------------
+QString ctkMsecs(qint64 nsecs)
+{
+  return QString::number(nsecs / 1000000.0, 'f', 3);
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkJsonString(const QString& text)
+{
+  QByteArray json("\"");
+  const QByteArray utf8 = text.toUtf8();
+  for (int i = 0; i < utf8.size(); ++i)
+  {
+    const char c = utf8[i];
+    if (c == '"' || c == '\\')
+    {
+      json += '\\';
+      json += c;
+    }
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      json += QString("\\u%1").arg(static_cast<int>(c), 4, 16, QChar('0')).toLatin1();
+    }
+    else
+    {
+      json += c;
+    }
+  }
+  json += '"';
+  return json;
+}
+
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::Timer::start()
+{
+  timer.start();
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkPluginFrameworkProfiler::Timer::nsecsElapsed() const
+{
+#if QT_VERSION >= 0x040800
+  return timer.nsecsElapsed();
+#else
+  return static_cast<qint64>(timer.elapsed()) * 1000000;
+#endif
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkProfiler::TimelineScope::TimelineScope(ctkPluginFrameworkProfiler& profiler,
+                                                         const char* category, const QString& name)
+  : profiler(profiler), category(category), startNsecs(-1)
+{
+  if (profiler.isTimelineEnabled())
+  {
+    this->name = name;
+    startNsecs = profiler.timelineNsecs();
+  }
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkProfiler::TimelineScope::~TimelineScope()
+{
+  if (startNsecs >= 0)
+  {
+    profiler.recordTimelineEvent(category, name, startNsecs,
+                                 profiler.timelineNsecs() - startNsecs);
+  }
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkProfiler::Statistics::Statistics()
+  : count(0), totalNsecs(0), maxNsecs(0)
+{
+  for (int i = 0; i < BucketCount; ++i)
+  {
+    buckets[i] = 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::Statistics::add(qint64 nsecs)
+{
+  ++count;
+  totalNsecs += nsecs;
+  maxNsecs = qMax(maxNsecs, nsecs);
+
+  int bucket = 0;
+  for (qint64 limit = 1000; bucket < BucketCount - 1 && nsecs >= limit; limit *= 10)
+  {
+    ++bucket;
+  }
+  ++buckets[bucket];
+}
+
+//----------------------------------------------------------------------------
+ctkPluginFrameworkProfiler::ctkPluginFrameworkProfiler()
+  : enabled(false)
+  , timelineEnabled(false)
+{
+}
+
+//----------------------------------------------------------------------------
+bool ctkPluginFrameworkProfiler::isEnabled() const
+{
+  return enabled;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::setEnabled(bool enabled)
+{
+  QMutexLocker lock(&mutex);
+  this->enabled = enabled;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::reset()
+{
+  QMutexLocker lock(&mutex);
+  lookups.clear();
+  usage.clear();
+  dispatches.clear();
+  activatorStarts.clear();
+  activatorStops.clear();
+}
+
+//----------------------------------------------------------------------------
+QString ctkPluginFrameworkProfiler::dump() const
+{
+  QMutexLocker lock(&mutex);
+
+  QStringList lines;
+  dumpStatistics(lines, "Service lookups", lookups, true);
+
+  lines << "Service usage (getService, ungetService):";
+  QList<QPair<qint64, QString> > sorted;
+  QHash<QString, QPair<qint64, qint64> >::const_iterator i = usage.begin();
+  for (; i != usage.end(); ++i)
+  {
+    sorted << qMakePair(i.value().first + i.value().second, i.key());
+  }
+  std::sort(sorted.begin(), sorted.end(), ctkGreaterValue);
+  for (int j = 0; j < sorted.size(); ++j)
+  {
+    const QPair<qint64, qint64>& counts = usage[sorted[j].second];
+    lines << QString("  %1: %2, %3").arg(sorted[j].second).arg(counts.first).arg(counts.second);
+  }
+  lines << QString();
+
+  dumpStatistics(lines, "Listener dispatch", dispatches, true);
+  dumpStatistics(lines, "Plugin activator start", activatorStarts, false);
+  dumpStatistics(lines, "Plugin activator stop", activatorStops, false);
+
+  return lines.join("\n");
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::dumpStatistics(QStringList& lines, const QString& title,
+                                                const StatisticsHash& statistics, bool histogram)
+{
+  lines << (histogram ? title + " (count, total ms, max ms, <1us <10us <100us <1ms <10ms <100ms >=100ms):"
+                      : title + " (count, total ms, max ms):");
+
+  QList<QPair<qint64, QString> > sorted;
+  for (StatisticsHash::const_iterator i = statistics.begin(); i != statistics.end(); ++i)
+  {
+    sorted << qMakePair(i.value().totalNsecs, i.key());
+  }
+  std::sort(sorted.begin(), sorted.end(), ctkGreaterValue);
+
+  for (int j = 0; j < sorted.size(); ++j)
+  {
+    const Statistics& s = statistics[sorted[j].second];
+    QString line = QString("  %1: %2, %3, %4").arg(sorted[j].second).arg(s.count)
+        .arg(ctkMsecs(s.totalNsecs)).arg(ctkMsecs(s.maxNsecs));
+    if (histogram)
+    {
+      line += ",";
+      for (int k = 0; k < Statistics::BucketCount; ++k)
+      {
+        line += QString(" %1").arg(s.buckets[k]);
+      }
+    }
+    lines << line;
+  }
+  lines << QString();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::recordLookup(const QString& clazz, const QString& filter, qint64 nsecs)
+{
+  QString key = clazz.isEmpty() ? QString("*") : clazz;
+  if (!filter.isEmpty())
+  {
+    key += " " + filter;
+  }
+
+  QMutexLocker lock(&mutex);
+  lookups[key].add(nsecs);
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::recordGetService(const QString& clazz)
+{
+  QMutexLocker lock(&mutex);
+  ++usage[clazz].first;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::recordUngetService(const QString& clazz)
+{
+  QMutexLocker lock(&mutex);
+  ++usage[clazz].second;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::recordDispatch(const QString& event, qint64 nsecs)
+{
+  QMutexLocker lock(&mutex);
+  dispatches[event].add(nsecs);
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::recordActivatorStart(const QString& symbolicName, qint64 nsecs)
+{
+  QMutexLocker lock(&mutex);
+  activatorStarts[symbolicName].add(nsecs);
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::recordActivatorStop(const QString& symbolicName, qint64 nsecs)
+{
+  QMutexLocker lock(&mutex);
+  activatorStops[symbolicName].add(nsecs);
+}
+
+//----------------------------------------------------------------------------
+bool ctkPluginFrameworkProfiler::isTimelineEnabled() const
+{
+  return timelineEnabled;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::setTimelineEnabled(bool enabled)
+{
+  QMutexLocker lock(&mutex);
+  if (enabled && !timelineEnabled)
+  {
+    timeline.clear();
+    timelineThreads.clear();
+    timelineTimer.start();
+  }
+  timelineEnabled = enabled;
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkPluginFrameworkProfiler::timelineNsecs() const
+{
+  return timelineTimer.nsecsElapsed();
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkProfiler::recordTimelineEvent(const char* category, const QString& name,
+                                                     qint64 startNsecs, qint64 nsecs)
+{
+  TimelineEvent event;
+  event.category = QString::fromLatin1(category);
+  event.name = name;
+  event.startNsecs = startNsecs;
+  event.nsecs = nsecs;
+
+  Qt::HANDLE thread = QThread::currentThreadId();
+  QMutexLocker lock(&mutex);
+  event.thread = timelineThreads.indexOf(thread);
+  if (event.thread < 0)
+  {
+    event.thread = timelineThreads.size();
+    timelineThreads << thread;
+  }
+  timeline << event;
+}
+
+//----------------------------------------------------------------------------
+QString ctkPluginFrameworkProfiler::timelineReport() const
+{
+  QMutexLocker lock(&mutex);
+
+  // The events are recorded when they end, the nested ones first
+  QList<QPair<qint64, int> > byStart;
+  QList<QPair<qint64, QString> > byDuration;
+  for (int i = 0; i < timeline.size(); ++i)
+  {
+    byStart << qMakePair(timeline[i].startNsecs, i);
+    byDuration << qMakePair(timeline[i].nsecs,
+                            timeline[i].category + " " + timeline[i].name);
+  }
+  std::sort(byStart.begin(), byStart.end());
+  std::sort(byDuration.begin(), byDuration.end(), ctkGreaterValue);
+
+  QStringList lines;
+  lines << "Startup timeline (start ms, duration ms, thread, category, name):";
+  for (int j = 0; j < byStart.size(); ++j)
+  {
+    const TimelineEvent& event = timeline[byStart[j].second];
+    lines << QString("  %1, %2, %3, %4, %5").arg(ctkMsecs(event.startNsecs))
+             .arg(ctkMsecs(event.nsecs)).arg(event.thread).arg(event.category).arg(event.name);
+  }
+  lines << QString();
+
+  lines << "Slowest startup steps (duration ms):";
+  for (int j = 0; j < byDuration.size() && j < 10; ++j)
+  {
+    lines << QString("  %1: %2").arg(byDuration[j].second).arg(ctkMsecs(byDuration[j].first));
+  }
+  lines << QString();
+
+  return lines.join("\n");
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkPluginFrameworkProfiler::timelineToChromeTrace() const
+{
+  QMutexLocker lock(&mutex);
+
+  QByteArray json("{\"traceEvents\":[");
+  for (int i = 0; i < timeline.size(); ++i)
+  {
+    const TimelineEvent& event = timeline[i];
+    if (i > 0)
+    {
+      json += ',';
+    }
+    json += "\n{\"name\":" + ctkJsonString(event.name)
+        + ",\"cat\":" + ctkJsonString(event.category)
+        + ",\"ph\":\"X\",\"ts\":" + QByteArray::number(event.startNsecs / 1000.0, 'f', 3)
+        + ",\"dur\":" + QByteArray::number(event.nsecs / 1000.0, 'f', 3)
+        + ",\"pid\":1,\"tid\":" + QByteArray::number(event.thread) + "}";
+  }
+  json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return json;
+}
@@ -0,0 +1,175 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKPLUGINFRAMEWORKPROFILER_P_H
+#define CTKPLUGINFRAMEWORKPROFILER_P_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QStringList>
+
+#if QT_VERSION >= 0x040800
+#include <QElapsedTimer>
+#else
+#include <QTime>
+#endif
+
+#include "service/debug/ctkFrameworkProfiler.h"
+
+/**
+ * \ingroup PluginFramework
+ *
+ * The ctkFrameworkProfiler implementation of a framework instance.
+ *
+ * The framework only calls the record methods if isEnabled() returns
+ * true, which is checked without locking.
+ *
+ * Independently, a timeline of the framework start, plugin install,
+ * resolve, library load and activator start and of the service
+ * registrations can be recorded, see setTimelineEnabled(). The
+ * ctkPluginFrameworkLauncher enables it to profile the startup.
+ */
+class ctkPluginFrameworkProfiler : public QObject, public ctkFrameworkProfiler
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkFrameworkProfiler)
+
+public:
+
+  /**
+   * Measures a duration in nanoseconds, with a millisecond
+   * resolution on Qt versions older than 4.8.
+   */
+  class Timer
+  {
+  public:
+    void start();
+    qint64 nsecsElapsed() const;
+
+  private:
+#if QT_VERSION >= 0x040800
+    QElapsedTimer timer;
+#else
+    QTime timer;
+#endif
+  };
+
+  /**
+   * Records the lifetime of the scope in the timeline, if the timeline
+   * is enabled when the scope starts.
+   */
+  class TimelineScope
+  {
+  public:
+    TimelineScope(ctkPluginFrameworkProfiler& profiler, const char* category, const QString& name);
+    ~TimelineScope();
+
+  private:
+    ctkPluginFrameworkProfiler& profiler;
+    const char* category;
+    QString name;
+    qint64 startNsecs;
+
+    TimelineScope(const TimelineScope&);
+    void operator=(const TimelineScope&);
+  };
+
+  ctkPluginFrameworkProfiler();
+
+  bool isEnabled() const;
+  void setEnabled(bool enabled);
+  void reset();
+  QString dump() const;
+
+  void recordLookup(const QString& clazz, const QString& filter, qint64 nsecs);
+  void recordGetService(const QString& clazz);
+  void recordUngetService(const QString& clazz);
+  void recordDispatch(const QString& event, qint64 nsecs);
+  void recordActivatorStart(const QString& symbolicName, qint64 nsecs);
+  void recordActivatorStop(const QString& symbolicName, qint64 nsecs);
+
+  /** The timeline is disabled by default, checked without locking. */
+  bool isTimelineEnabled() const;
+  /** Enabling the timeline clears it and restarts its clock. */
+  void setTimelineEnabled(bool enabled);
+  /** Nanoseconds since the timeline was enabled. */
+  qint64 timelineNsecs() const;
+  void recordTimelineEvent(const char* category, const QString& name,
+                           qint64 startNsecs, qint64 nsecs);
+  /** The timeline events sorted by start time, then the slowest ones. */
+  QString timelineReport() const;
+  /** The timeline in the Chrome trace event format, see chrome://tracing. */
+  QByteArray timelineToChromeTrace() const;
+
+private:
+
+  /**
+   * Duration statistics, with a histogram of decades from 1 microsecond
+   * to 100 milliseconds.
+   */
+  struct Statistics
+  {
+    enum { BucketCount = 7 };
+
+    Statistics();
+    void add(qint64 nsecs);
+
+    qint64 count;
+    qint64 totalNsecs;
+    qint64 maxNsecs;
+    qint64 buckets[BucketCount];
+  };
+
+  typedef QHash<QString, Statistics> StatisticsHash;
+
+  static void dumpStatistics(QStringList& lines, const QString& title,
+                             const StatisticsHash& statistics, bool histogram);
+
+  bool enabled;
+
+  mutable QMutex mutex;
+  StatisticsHash lookups;
+  QHash<QString, QPair<qint64, qint64> > usage; // <getService, ungetService>
+  StatisticsHash dispatches;
+  StatisticsHash activatorStarts;
+  StatisticsHash activatorStops;
+
+  struct TimelineEvent
+  {
+    QString category;
+    QString name;
+    qint64 startNsecs;
+    qint64 nsecs;
+    int thread;
+  };
+
+  bool timelineEnabled;
+  Timer timelineTimer;
+  QList<TimelineEvent> timeline;
+  QList<Qt::HANDLE> timelineThreads;
+};
+
+#endif // CTKPLUGINFRAMEWORKPROFILER_P_H
@@ -100,6 +100,8 @@ void ctkPluginFrameworkPrivate::activate(ctkPluginContext* context)
   ctkPluginFrameworkDebugOptions* dbgOptions = ctkPluginFrameworkDebugOptions::getDefault();
   dbgOptions->start(context);
   context->registerService<ctkDebugOptions>(dbgOptions);
+
+  registrations.push_back(context->registerService<ctkFrameworkProfiler>(&fwCtx->profiler));
 }
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,94 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkPluginResourceTree_p.h"
+
+//----------------------------------------------------------------------------
+ctkPluginResourceTree::ctkPluginResourceTree()
+{
+
+}
+
+//----------------------------------------------------------------------------
+ctkPluginResourceTree::~ctkPluginResourceTree()
+{
+
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginResourceTree::insert(const QString& path, qint64 size)
+{
+  Node* node = &root;
+  foreach(const QString& component, path.split('/', QString::SkipEmptyParts))
+  {
+    Node*& child = node->children[component];
+    if (child == 0)
+    {
+      child = new Node;
+    }
+    node = child;
+  }
+  if (node != &root)
+  {
+    node->size = size;
+  }
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkPluginResourceTree::size(const QString& path) const
+{
+  const Node* node = find(path);
+  return node ? node->size : -1;
+}
+
+//----------------------------------------------------------------------------
+QStringList ctkPluginResourceTree::entries(const QString& path) const
+{
+  QStringList result;
+  const Node* node = find(path);
+  if (node == 0)
+  {
+    return result;
+  }
+
+  QMap<QString, Node*>::const_iterator i = node->children.begin();
+  for (; i != node->children.end(); ++i)
+  {
+    result << (i.value()->size < 0 ? i.key() + "/" : i.key());
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+const ctkPluginResourceTree::Node* ctkPluginResourceTree::find(const QString& path) const
+{
+  const Node* node = &root;
+  foreach(const QString& component, path.split('/', QString::SkipEmptyParts))
+  {
+    QMap<QString, Node*>::const_iterator i = node->children.find(component);
+    if (i == node->children.end())
+    {
+      return 0;
+    }
+    node = i.value();
+  }
+  return node;
+}
@@ -0,0 +1,88 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKPLUGINRESOURCETREE_P_H
+#define CTKPLUGINRESOURCETREE_P_H
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+/**
+ * \ingroup PluginFramework
+ *
+ * In-memory path trie of the resources of one plugin archive.
+ *
+ * It answers <code>findResourcesPath()</code> and negative
+ * <code>getPluginResource()</code> lookups without querying
+ * the plugin database.
+ */
+class ctkPluginResourceTree
+{
+
+public:
+
+  ctkPluginResourceTree();
+  ~ctkPluginResourceTree();
+
+  /**
+   * Add the resource <code>path</code> of <code>size</code> bytes.
+   * Missing parent directories are created.
+   */
+  void insert(const QString& path, qint64 size);
+
+  /**
+   * Returns the size of the resource <code>path</code>, or -1 if
+   * there is no such resource.
+   */
+  qint64 size(const QString& path) const;
+
+  /**
+   * Returns the entries directly under the directory <code>path</code>.
+   * Directory entries end with a '/'.
+   */
+  QStringList entries(const QString& path) const;
+
+  /**
+   * The prefix of the Qt resources of the plugin library,
+   * e.g. <code>":/org.commontk.eventadmin"</code>.
+   */
+  QString qtResourcePrefix;
+
+private:
+
+  struct Node
+  {
+    Node() : size(-1) {}
+    ~Node() { qDeleteAll(children); }
+
+    qint64 size; // -1 for directories
+    QMap<QString, Node*> children;
+  };
+
+  const Node* find(const QString& path) const;
+
+  Node root;
+
+  Q_DISABLE_COPY(ctkPluginResourceTree)
+};
+
+#endif // CTKPLUGINRESOURCETREE_P_H
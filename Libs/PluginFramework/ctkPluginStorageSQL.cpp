@@ -28,15 +28,23 @@
 #include "ctkPluginStorage_p.h"
 #include "ctkPluginFrameworkUtil_p.h"
 #include "ctkPluginFrameworkContext_p.h"
+#include "ctkPluginResourceTree_p.h"
 #include "ctkServiceException.h"
 
+#include <QDataStream>
+#include <QFile>
 #include <QFileInfo>
+#include <QResource>
 #include <QUrl>
 
 //database table names
 #define PLUGINS_TABLE "Plugins"
 #define PLUGIN_RESOURCES_TABLE "PluginResources"
 
+// snapshot file format
+static const quint32 ctkPluginStorageSnapshotMagic = 0x43544b50; // "CTKP"
+static const qint32 ctkPluginStorageSnapshotVersion = 1;
+
 //----------------------------------------------------------------------------
 enum TBindIndexes
 {
@@ -50,18 +58,36 @@ enum TBindIndexes
   EBindIndex7
 };
 
+//----------------------------------------------------------------------------
+static QString ctkPluginResourcePrefix(const QString& libLocation)
+{
+  QString resourcePrefix = QFileInfo(libLocation).baseName();
+  if (resourcePrefix.startsWith("lib"))
+  {
+    resourcePrefix = resourcePrefix.mid(3);
+  }
+  resourcePrefix.replace("_", ".");
+  return QString(":/") + resourcePrefix + "/";
+}
+
 //----------------------------------------------------------------------------
 ctkPluginStorageSQL::ctkPluginStorageSQL(ctkPluginFrameworkContext *framework)
   : m_isDatabaseOpen(false)
   , m_inTransaction(false)
   , m_framework(framework)
   , m_nextFreeId(-1)
+  , m_snapshotLoaded(false)
+  , m_snapshotDirty(false)
 {
   // See if we have a storage database
   m_databasePath = ctkPluginFrameworkUtil::getFileStorage(framework, "").absoluteFilePath("plugins.db");
 
   this->open();
-  restorePluginArchives();
+  if (!m_snapshotLoaded)
+  {
+    restorePluginArchives();
+    writeSnapshot();
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -170,6 +196,13 @@ void ctkPluginStorageSQL::open()
     }
   }
 
+  // Use the snapshot of the last launch if nothing changed since
+  m_snapshotLoaded = readSnapshot();
+  if (m_snapshotLoaded)
+  {
+    return;
+  }
+
   // silently remove any plugin marked as uninstalled
   cleanupDB();
 
@@ -415,13 +448,7 @@ void ctkPluginStorageSQL::insertArchive(QSharedPointer<ctkPluginArchiveSQL> pa,
   QFileInfo fileInfo(pa->getLibLocation());
   QString libTimestamp = getStringFromQDateTime(fileInfo.lastModified());
 
-  QString resourcePrefix = fileInfo.baseName();
-  if (resourcePrefix.startsWith("lib"))
-  {
-    resourcePrefix = resourcePrefix.mid(3);
-  }
-  resourcePrefix.replace("_", ".");
-  resourcePrefix = QString(":/") + resourcePrefix + "/";
+  QString resourcePrefix = ctkPluginResourcePrefix(pa->getLibLocation());
 
   // Load the plugin and cache the resources
 
@@ -466,6 +493,7 @@ void ctkPluginStorageSQL::insertArchive(QSharedPointer<ctkPluginArchiveSQL> pa,
   executeQuery(query, statement, bindValues);
 
   pa->key = query->lastInsertId().toInt();
+  removeResourceTree(pa->key);
 
   // Write the plug-in resource data into the database
   QDirIterator dirIter(resourcePrefix, QDirIterator::Subdirectories);
@@ -595,6 +623,7 @@ void ctkPluginStorageSQL::removeArchiveFromDB(ctkPluginArchiveSQL* pa, QSqlQuery
   bindValues.append(pa->key);
 
   executeQuery(query, statement, bindValues);
+  removeResourceTree(pa->key);
 }
 
 QList<QSharedPointer<ctkPluginArchive> > ctkPluginStorageSQL::getAllPluginArchives() const
@@ -666,41 +695,7 @@ void ctkPluginStorageSQL::setAutostartSetting(int key, int autostart)
 //----------------------------------------------------------------------------
 QStringList ctkPluginStorageSQL::findResourcesPath(int archiveKey, const QString& path) const
 {
-  checkConnection();
-
-  QString statement = "SELECT SUBSTR(ResourcePath,?) FROM PluginResources WHERE K=? AND SUBSTR(ResourcePath,1,?)=?";
-
-  QString resourcePath = path.startsWith('/') ? path : QString("/") + path;
-  if (!resourcePath.endsWith('/'))
-    resourcePath += "/";
-
-  QList<QVariant> bindValues;
-  bindValues.append(resourcePath.size()+1);
-  bindValues.append(archiveKey);
-  bindValues.append(resourcePath.size());
-  bindValues.append(resourcePath);
-
-  QSqlDatabase database = QSqlDatabase::database(m_connectionName);
-  QSqlQuery query(database);
-
-  executeQuery(&query, statement, bindValues);
-
-  QSet<QString> paths;
-  while (query.next())
-  {
-    QString currPath = query.value(EBindIndex).toString();
-    QStringList components = currPath.split('/', QString::SkipEmptyParts);
-    if (components.size() == 1)
-    {
-      paths << components.front();
-    }
-    else if (components.size() == 2)
-    {
-      paths << components.front() + "/";
-    }
-  }
-
-  return paths.toList();
+  return getResourceTree(archiveKey)->entries(path);
 }
 
 //----------------------------------------------------------------------------
@@ -708,6 +703,11 @@ void ctkPluginStorageSQL::executeQuery(QSqlQuery *query, const QString &statemen
 {
   Q_ASSERT(query != 0);
 
+  if (!statement.trimmed().startsWith("SELECT", Qt::CaseInsensitive))
+  {
+    invalidateSnapshot();
+  }
+
   bool success = false;
   enum {Prepare =0 , Execute=1};
 
@@ -773,6 +773,10 @@ void ctkPluginStorageSQL::close()
     {
       if(database.isOpen())
       {
+        if (m_snapshotDirty)
+        {
+          writeSnapshot();
+        }
         database.close();
         m_isDatabaseOpen = false;
         return;
@@ -809,6 +813,29 @@ QString ctkPluginStorageSQL::getDatabasePath() const
 //----------------------------------------------------------------------------
 QByteArray ctkPluginStorageSQL::getPluginResource(int key, const QString& res) const
 {
+  QString resourcePath = res.startsWith('/') ? res : QString("/") + res;
+
+  QSharedPointer<ctkPluginResourceTree> resourceTree = getResourceTree(key);
+  const qint64 size = resourceTree->size(resourcePath);
+  if (size < 0)
+  {
+    return QByteArray();
+  }
+
+  // The Qt resources are registered while the plugin library is loaded,
+  // read them from the library instead of the database
+  QResource qtResource(resourceTree->qtResourcePrefix + resourcePath);
+  if (qtResource.isValid() && qtResource.data() != 0)
+  {
+    QByteArray data = qtResource.isCompressed()
+        ? qUncompress(qtResource.data(), static_cast<int>(qtResource.size()))
+        : QByteArray(reinterpret_cast<const char*>(qtResource.data()), static_cast<int>(qtResource.size()));
+    if (data.size() == size)
+    {
+      return data;
+    }
+  }
+
   checkConnection();
 
   QSqlDatabase database = QSqlDatabase::database(m_connectionName);
@@ -816,7 +843,6 @@ QByteArray ctkPluginStorageSQL::getPluginResource(int key, const QString& res) c
 
   QString statement = "SELECT Resource FROM PluginResources WHERE K=? AND ResourcePath=?";
 
-  QString resourcePath = res.startsWith('/') ? res : QString("/") + res;
   QList<QVariant> bindValues;
   bindValues.append(key);
   bindValues.append(resourcePath);
@@ -831,6 +857,57 @@ QByteArray ctkPluginStorageSQL::getPluginResource(int key, const QString& res) c
   return QByteArray();
 }
 
+//----------------------------------------------------------------------------
+QSharedPointer<ctkPluginResourceTree> ctkPluginStorageSQL::getResourceTree(int key) const
+{
+  {
+    QMutexLocker lock(&m_resourceTreesLock);
+    QSharedPointer<ctkPluginResourceTree> resourceTree = m_resourceTrees.value(key);
+    if (resourceTree)
+    {
+      return resourceTree;
+    }
+  }
+
+  checkConnection();
+
+  QSqlDatabase database = QSqlDatabase::database(m_connectionName);
+  QSqlQuery query(database);
+
+  QSharedPointer<ctkPluginResourceTree> resourceTree(new ctkPluginResourceTree);
+
+  QList<QVariant> bindValues;
+  bindValues.append(key);
+
+  executeQuery(&query, "SELECT LocalPath FROM " PLUGINS_TABLE " WHERE K=?", bindValues);
+  if (query.next())
+  {
+    // without the trailing '/', the resource paths start with one
+    resourceTree->qtResourcePrefix = ctkPluginResourcePrefix(query.value(EBindIndex).toString());
+    resourceTree->qtResourcePrefix.chop(1);
+  }
+  query.finish();
+
+  // The length of a BLOB is read from the record header, not its content
+  executeQuery(&query, "SELECT ResourcePath, LENGTH(Resource) FROM " PLUGIN_RESOURCES_TABLE " WHERE K=?",
+               bindValues);
+  while (query.next())
+  {
+    resourceTree->insert(query.value(EBindIndex).toString(), query.value(EBindIndex1).toLongLong());
+  }
+
+  QMutexLocker lock(&m_resourceTreesLock);
+  m_resourceTrees.insert(key, resourceTree);
+  return resourceTree;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStorageSQL::removeResourceTree(int key)
+{
+  QMutexLocker lock(&m_resourceTreesLock);
+  m_resourceTrees.remove(key);
+}
+
 //----------------------------------------------------------------------------
 void ctkPluginStorageSQL::createTables()
 {
@@ -1102,6 +1179,186 @@ void ctkPluginStorageSQL::restorePluginArchives()
   }
 }
 
+//----------------------------------------------------------------------------
+QString ctkPluginStorageSQL::getSnapshotPath() const
+{
+  return m_databasePath + ".snapshot";
+}
+
+//----------------------------------------------------------------------------
+bool ctkPluginStorageSQL::readSnapshot()
+{
+  QFile file(getSnapshotPath());
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_4_6);
+
+  quint32 magic = 0;
+  qint32 version = 0;
+  in >> magic >> version;
+  if (magic != ctkPluginStorageSnapshotMagic || version != ctkPluginStorageSnapshotVersion)
+  {
+    return false;
+  }
+
+  // The database must not have been modified since the snapshot was written
+  QDateTime databaseModified;
+  qint64 databaseSize = 0;
+  in >> databaseModified >> databaseSize;
+  QFileInfo databaseInfo(m_databasePath);
+  if (databaseInfo.lastModified() != databaseModified || databaseInfo.size() != databaseSize)
+  {
+    return false;
+  }
+
+  qint32 nextFreeId = 0;
+  QHash<qint32, qint32> generations;
+  qint32 count = 0;
+  in >> nextFreeId >> generations >> count;
+
+  QList<QSharedPointer<ctkPluginArchive> > archives;
+  for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+  {
+    qint64 id = 0;
+    QString location, localPath, lastModified, timestamp;
+    qint32 startLevel = 0, autoStart = 0, key = 0;
+    QByteArray manifest;
+    in >> id >> location >> localPath >> startLevel >> lastModified
+       >> autoStart >> key >> timestamp >> manifest;
+
+    // Same check as updateDB(): fall back to it if a plugin changed
+    QDateTime pluginLastModified = QFileInfo(localPath).lastModified();
+    pluginLastModified = getQDateTimeFromString(getStringFromQDateTime(pluginLastModified));
+    if (pluginLastModified > getQDateTimeFromString(timestamp))
+    {
+      return false;
+    }
+
+    try
+    {
+      QSharedPointer<ctkPluginArchiveSQL> pa(new ctkPluginArchiveSQL(this, QUrl(location), localPath, id,
+                                                                     startLevel,
+                                                                     getQDateTimeFromString(lastModified),
+                                                                     autoStart));
+      pa->key = key;
+      pa->readManifest(manifest);
+      archives.append(pa);
+    }
+    catch (const ctkPluginException&)
+    {
+      return false;
+    }
+  }
+  if (in.status() != QDataStream::Ok)
+  {
+    return false;
+  }
+
+  m_archives = archives;
+  m_nextFreeId = nextFreeId;
+  m_generations.clear();
+  for (QHash<qint32, qint32>::const_iterator i = generations.begin(); i != generations.end(); ++i)
+  {
+    m_generations.insert(i.key(), i.value());
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStorageSQL::writeSnapshot()
+{
+  QString snapshotPath = getSnapshotPath();
+  QString tmpPath = snapshotPath + ".tmp";
+  try
+  {
+    checkConnection();
+
+    QSqlQuery query(QSqlDatabase::database(m_connectionName));
+
+    // Same rows as restorePluginArchives()
+    QString statement = "SELECT ID, Location, LocalPath, StartLevel, LastModified, AutoStart, K, Timestamp, MAX(Generation)"
+                        " FROM " PLUGINS_TABLE " WHERE StartLevel != -2 GROUP BY ID"
+                        " ORDER BY ID";
+    executeQuery(&query, statement);
+
+    QByteArray archives;
+    QDataStream archivesOut(&archives, QIODevice::WriteOnly);
+    archivesOut.setVersion(QDataStream::Qt_4_6);
+    qint32 count = 0;
+    while (query.next())
+    {
+      const int key = query.value(EBindIndex6).toInt();
+      archivesOut << static_cast<qint64>(query.value(EBindIndex).toLongLong())
+                  << query.value(EBindIndex1).toString()
+                  << query.value(EBindIndex2).toString()
+                  << static_cast<qint32>(query.value(EBindIndex3).toInt())
+                  << query.value(EBindIndex4).toString()
+                  << static_cast<qint32>(query.value(EBindIndex5).toInt())
+                  << static_cast<qint32>(key)
+                  << query.value(EBindIndex7).toString()
+                  << getPluginResource(key, "META-INF/MANIFEST.MF");
+      ++count;
+    }
+    query.finish();
+    query.clear();
+
+    // The uninstalled plugins are included to never reuse their ids
+    QHash<qint32, qint32> generations;
+    qint32 nextFreeId = 1;
+    statement = "SELECT ID,MAX(Generation) FROM " PLUGINS_TABLE " GROUP BY ID";
+    executeQuery(&query, statement);
+    while (query.next())
+    {
+      const qint32 id = query.value(EBindIndex).toInt();
+      generations.insert(id, query.value(EBindIndex1).toInt() + 1);
+      nextFreeId = qMax(nextFreeId, id + 1);
+    }
+    query.finish();
+    query.clear();
+
+    QFile file(tmpPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+    QFileInfo databaseInfo(m_databasePath);
+    out << ctkPluginStorageSnapshotMagic << ctkPluginStorageSnapshotVersion
+        << databaseInfo.lastModified() << static_cast<qint64>(databaseInfo.size())
+        << nextFreeId << generations << count;
+    file.write(archives);
+    file.close();
+
+    QFile::remove(snapshotPath);
+    if (file.error() != QFile::NoError || !QFile::rename(tmpPath, snapshotPath))
+    {
+      QFile::remove(tmpPath);
+      return;
+    }
+    m_snapshotDirty = false;
+  }
+  catch (const ctkPluginDatabaseException& e)
+  {
+    qWarning() << "Writing the plugin storage snapshot failed:" << e.what();
+    QFile::remove(tmpPath);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkPluginStorageSQL::invalidateSnapshot() const
+{
+  if (!m_snapshotDirty)
+  {
+    m_snapshotDirty = true;
+    QFile::remove(getSnapshotPath());
+  }
+}
+
 //----------------------------------------------------------------------------
 QString ctkPluginStorageSQL::getStringFromQDateTime(const QDateTime& dateTime) const
 {
@@ -25,6 +25,7 @@
 #include "ctkPluginStorage_p.h"
 
 #include <QMutex>
+#include <QSharedPointer>
 #include <QLibrary>
 #include <QSqlQuery>
 #include <QDebug>
@@ -35,6 +36,7 @@
 // CTK class forward declarations
 class ctkPluginFrameworkContext;
 class ctkPluginArchiveSQL;
+class ctkPluginResourceTree;
 
 /**
  * \ingroup PluginFramework
@@ -318,6 +320,43 @@ private:
    */
   void rollbackTransaction(QSqlQuery* query);
 
+  /**
+   * Reads the snapshot of the plugin archives written by writeSnapshot().
+   * The snapshot is only used if neither the database nor any of the
+   * plugin files changed since it was written, which saves cleanupDB(),
+   * updateDB(), initNextFreeIds() and restorePluginArchives() on launch.
+   *
+   * @return <code>true</code> if the archives were restored from the snapshot.
+   */
+  bool readSnapshot();
+
+  /**
+   * Writes a compact binary snapshot of the restored plugin archives,
+   * their manifests and the next free ids next to the database.
+   */
+  void writeSnapshot();
+
+  /**
+   * Removes the snapshot, called when the database is modified. A new
+   * snapshot is written when the database is closed.
+   */
+  void invalidateSnapshot() const;
+
+  QString getSnapshotPath() const;
+
+  /**
+   * Returns the resource tree of the plugin archive with the given
+   * key, reading the resource paths from the database on first use.
+   *
+   * @throws ctkPluginDatabaseException
+   */
+  QSharedPointer<ctkPluginResourceTree> getResourceTree(int key) const;
+
+  /**
+   * Forgets the resource tree of the given key.
+   */
+  void removeResourceTree(int key);
+
   /**
    * Returns a string representation of a QDateTime instance.
    */
@@ -355,6 +394,23 @@ private:
    * Keep track of the next free generation for each plugin
    */
   QHash<int,int> /* <plugin id, generation> */ m_generations;
+
+  /**
+   * True if the archives were restored from the snapshot
+   */
+  bool m_snapshotLoaded;
+
+  /**
+   * True if the database was modified since the snapshot was written
+   */
+  mutable bool m_snapshotDirty;
+
+  mutable QMutex m_resourceTreesLock;
+
+  /**
+   * The resource trees of the plugin archives, by key
+   */
+  mutable QHash<int, QSharedPointer<ctkPluginResourceTree> > m_resourceTrees;
 };
 
 
@@ -21,6 +21,7 @@
 
 #include "ctkPlugin_p.h"
 #include "ctkPluginConstants.h"
+#include "ctkLazyServiceFactory_p.h"
 #include "ctkPluginDatabaseException.h"
 #include "ctkPluginArchive_p.h"
 #include "ctkPluginFrameworkContext_p.h"
@@ -168,6 +169,7 @@ ctkPluginPrivate::ctkPluginPrivate(QWeakPointer<ctkPlugin> qq,
 ctkPluginPrivate::~ctkPluginPrivate()
 {
   qDeleteAll(require);
+  qDeleteAll(lazyServiceFactories);
 }
 
 //----------------------------------------------------------------------------
@@ -191,7 +193,10 @@ ctkPlugin::State ctkPluginPrivate::getUpdatedState_unlocked()
       if (state == ctkPlugin::INSTALLED)
       {
         operation.fetchAndStoreOrdered(RESOLVING);
-        fwCtx->resolvePlugin(this);
+        {
+          ctkPluginFrameworkProfiler::TimelineScope timelineScope(fwCtx->profiler, "resolve", symbolicName);
+          fwCtx->resolvePlugin(this);
+        }
         state = ctkPlugin::RESOLVED;
         // TODO plugin threading
         //bundleThread().bundleChanged(new BundleEvent(BundleEvent.RESOLVED, this));
@@ -390,6 +395,28 @@ void ctkPluginPrivate::finalizeActivation()
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkPluginPrivate::registerLazyServices()
+{
+  QString provided = archive ? archive->getAttribute(ctkPluginConstants::PLUGIN_PROVIDE_SERVICES)
+                             : QString();
+  foreach (QString clazz, provided.split(',', QString::SkipEmptyParts))
+  {
+    clazz = clazz.trimmed();
+    if (clazz.isEmpty()) continue;
+    ctkLazyServiceFactory* factory = new ctkLazyServiceFactory(this, clazz);
+    lazyServiceFactories << factory;
+    try
+    {
+      fwCtx->services->registerService(this, QStringList(clazz), factory, ctkDictionary());
+    }
+    catch (const ctkException& e)
+    {
+      fwCtx->listeners.frameworkError(this->q_func(), e);
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 const ctkRuntimeException* ctkPluginPrivate::stop0()
 {
@@ -427,7 +454,17 @@ const ctkRuntimeException* ctkPluginPrivate::stop1()
   {
     try
     {
-      pluginActivator->stop(pluginContext.data());
+      if (fwCtx->profiler.isEnabled())
+      {
+        ctkPluginFrameworkProfiler::Timer timer;
+        timer.start();
+        pluginActivator->stop(pluginContext.data());
+        fwCtx->profiler.recordActivatorStop(symbolicName, timer.nsecsElapsed());
+      }
+      else
+      {
+        pluginActivator->stop(pluginContext.data());
+      }
       if (state != ctkPlugin::STOPPING)
       {
         if (state == ctkPlugin::UNINSTALLED)
@@ -515,6 +552,7 @@ void ctkPluginPrivate::update0(const QUrl& updateLocation, bool wasActive)
     newArchive = fwCtx->storage->updatePluginArchive(archive, updateUrl, updateUrl.toLocalFile());
     //checkCertificates(newArchive);
     checkManifestHeaders();
+    fwCtx->plugins->symbolicNameChanged(this->q_func().data());
     newArchive->setStartLevel(oldStartLevel);
     fwCtx->storage->replacePluginArchive(archive, newArchive);
   }
@@ -524,6 +562,8 @@ void ctkPluginPrivate::update0(const QUrl& updateLocation, bool wasActive)
     {
       newArchive->purge();
     }
+    // checkManifestHeaders() may have read the symbolic name before failing
+    fwCtx->plugins->symbolicNameChanged(this->q_func().data());
     operation.fetchAndStoreOrdered(IDLE);
     if (wasActive)
     {
@@ -725,7 +765,10 @@ ctkPluginException* ctkPluginPrivate::start0()
 
   ctkPluginException::Type error_type = ctkPluginException::MANIFEST_ERROR;
   try {
-    pluginLoader.load();
+    {
+      ctkPluginFrameworkProfiler::TimelineScope timelineScope(fwCtx->profiler, "load", symbolicName);
+      pluginLoader.load();
+    }
     if (!pluginLoader.isLoaded())
     {
       error_type = ctkPluginException::ACTIVATOR_ERROR;
@@ -740,7 +783,20 @@ ctkPluginException* ctkPluginPrivate::start0()
                                ctkPluginException::ACTIVATOR_ERROR);
     }
 
-    pluginActivator->start(pluginContext.data());
+    {
+      ctkPluginFrameworkProfiler::TimelineScope timelineScope(fwCtx->profiler, "activator", symbolicName);
+      if (fwCtx->profiler.isEnabled())
+      {
+        ctkPluginFrameworkProfiler::Timer timer;
+        timer.start();
+        pluginActivator->start(pluginContext.data());
+        fwCtx->profiler.recordActivatorStart(symbolicName, timer.nsecsElapsed());
+      }
+      else
+      {
+        pluginActivator->start(pluginContext.data());
+      }
+    }
 
     if (state != ctkPlugin::STARTING)
     {
@@ -812,6 +868,9 @@ void ctkPluginPrivate::removePluginResources()
     }
   }
 
+  qDeleteAll(lazyServiceFactories);
+  lazyServiceFactories.clear();
+
   QList<ctkServiceRegistration> s = fwCtx->services->getUsedByPlugin(q_func());
   QListIterator<ctkServiceRegistration> i2(s);
   while (i2.hasNext())
@@ -34,6 +34,7 @@
 #include <QWaitCondition>
 
 
+class ctkLazyServiceFactory;
 class ctkPluginActivator;
 class ctkPluginArchive;
 class ctkPluginFrameworkContext;
@@ -153,6 +154,14 @@ public:
    */
   void finalizeActivation();
 
+  /**
+   * Register a ctkLazyServiceFactory for each class listed in the
+   * Plugin-ProvideServices manifest header. Called when the plugin enters
+   * the STARTING state waiting for lazy activation. The factories are
+   * unregistered with the other services of the plugin when it stops.
+   */
+  void registerLazyServices();
+
   const ctkRuntimeException* stop0();
 
   /**
@@ -287,6 +296,9 @@ public:
   /** List of ctkRequirePlugin entries. */
   QList<ctkRequirePlugin*> require;
 
+  /** Factories registered by registerLazyServices(). */
+  QList<ctkLazyServiceFactory*> lazyServiceFactories;
+
 private:
 
   /** Rember if plugin was started */
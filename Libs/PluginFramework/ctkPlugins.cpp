@@ -19,6 +19,11 @@
 
 =============================================================================*/
 
+#include <QCoreApplication>
+#include <QRunnable>
+#include <QScopedPointer>
+#include <QThread>
+#include <QThreadPool>
 #include <QUrl>
 
 #include "ctkPlugin_p.h"
@@ -26,11 +31,82 @@
 #include "ctkPluginException.h"
 #include "ctkPluginFrameworkContext_p.h"
 #include "ctkPlugins_p.h"
+#include "ctkRequirePlugin_p.h"
 #include "ctkVersionRange_p.h"
 
 #include <stdexcept>
 #include <iostream>
 
+//----------------------------------------------------------------------------
+/// Start one plugin of startPluginsConcurrently() on a pool thread.
+class ctkPluginStartTask : public QRunnable
+{
+public:
+
+  ctkPluginStartTask(ctkPlugin* plugin, int options, QPluginLoader* pluginLoader)
+    : plugin(plugin), options(options), pluginLoader(pluginLoader), exception(0)
+  {
+    this->setAutoDelete(false);
+  }
+
+  ~ctkPluginStartTask()
+  {
+    delete exception;
+  }
+
+  virtual void run()
+  {
+    try
+    {
+      plugin->start(ctkPlugin::StartOptions(options));
+    }
+    catch (const ctkException& e)
+    {
+      exception = e.clone();
+    }
+    catch (const std::exception& e)
+    {
+      exception = new ctkRuntimeException(e.what());
+    }
+
+    // The activator was created in this thread
+    QObject* activator = pluginLoader->isLoaded() ? pluginLoader->instance() : 0;
+    if (activator && activator->thread() == QThread::currentThread())
+    {
+      activator->moveToThread(QCoreApplication::instance() ?
+                                QCoreApplication::instance()->thread() : 0);
+    }
+  }
+
+  ctkPlugin* plugin;
+  int options;
+  QPluginLoader* pluginLoader;
+  ctkException* exception;
+};
+
+//----------------------------------------------------------------------------
+/// Load the library of one plugin of loadPluginLibrariesConcurrently() on a pool thread.
+class ctkPluginLoadTask : public QRunnable
+{
+public:
+
+  ctkPluginLoadTask(ctkPluginPrivate* plugin)
+    : plugin(plugin)
+  {
+  }
+
+  virtual void run()
+  {
+    // Errors are reported by ctkPluginPrivate::start0(), which loads
+    // the library again
+    ctkPluginFrameworkProfiler::TimelineScope timelineScope(plugin->fwCtx->profiler, "load",
+                                                            plugin->symbolicName);
+    plugin->pluginLoader.load();
+  }
+
+  ctkPluginPrivate* plugin;
+};
+
 //----------------------------------------------------------------------------
 void ctkPlugins::checkIllegalState() const
 {
@@ -45,6 +121,33 @@ ctkPlugins::ctkPlugins(ctkPluginFrameworkContext* fw)
 {
   fwCtx = fw;
   plugins.insert(fw->systemPlugin->getLocation(), fw->systemPlugin);
+  addToNameIndex(fw->systemPlugin.data());
+}
+
+//----------------------------------------------------------------------------
+void ctkPlugins::addToNameIndex(ctkPlugin* plugin)
+{
+  const QString name = plugin->getSymbolicName();
+  pluginsByName[name].push_back(plugin);
+  indexedNames.insert(plugin, name);
+}
+
+//----------------------------------------------------------------------------
+void ctkPlugins::removeFromNameIndex(ctkPlugin* plugin)
+{
+  QHash<ctkPlugin*, QString>::iterator it = indexedNames.find(plugin);
+  if (it == indexedNames.end()) return;
+
+  QHash<QString, QList<ctkPlugin*> >::iterator nameIt = pluginsByName.find(it.value());
+  if (nameIt != pluginsByName.end())
+  {
+    nameIt.value().removeAll(plugin);
+    if (nameIt.value().isEmpty())
+    {
+      pluginsByName.erase(nameIt);
+    }
+  }
+  indexedNames.erase(it);
 }
 
 //----------------------------------------------------------------------------
@@ -52,6 +155,8 @@ void ctkPlugins::clear()
 {
   QWriteLocker lock(&pluginsLock);
   plugins.clear();
+  pluginsByName.clear();
+  indexedNames.clear();
   fwCtx = 0;
 }
 
@@ -59,6 +164,7 @@ void ctkPlugins::clear()
 QSharedPointer<ctkPlugin> ctkPlugins::install(const QUrl& location, QIODevice* in)
 {
   checkIllegalState();
+  ctkPluginFrameworkProfiler::TimelineScope timelineScope(fwCtx->profiler, "install", location.toString());
 
   QSharedPointer<ctkPlugin> res;
   {
@@ -120,7 +226,9 @@ QSharedPointer<ctkPlugin> ctkPlugins::install(const QUrl& location, QIODevice* i
 
       res = QSharedPointer<ctkPlugin>(new ctkPlugin());
       res->init(res, fwCtx, pa);
+      QWriteLocker pluginsLocker(&pluginsLock);
       plugins.insert(location.toString(), res);
+      addToNameIndex(res.data());
     }
     catch (const ctkException& e)
     {
@@ -151,7 +259,21 @@ QSharedPointer<ctkPlugin> ctkPlugins::install(const QUrl& location, QIODevice* i
 void ctkPlugins::remove(const QUrl& location)
 {
   QWriteLocker lock(&pluginsLock);
-  plugins.remove(location.toString());
+  QHash<QString, QSharedPointer<ctkPlugin> >::iterator it = plugins.find(location.toString());
+  if (it != plugins.end())
+  {
+    removeFromNameIndex(it.value().data());
+    plugins.erase(it);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkPlugins::symbolicNameChanged(ctkPlugin* plugin)
+{
+  QWriteLocker lock(&pluginsLock);
+  if (indexedNames.value(plugin) == plugin->getSymbolicName()) return;
+  removeFromNameIndex(plugin);
+  addToNameIndex(plugin);
 }
 
 //----------------------------------------------------------------------------
@@ -194,13 +316,13 @@ QSharedPointer<ctkPlugin> ctkPlugins::getPlugin(const QString& name, const ctkVe
   {
     QReadLocker lock(&pluginsLock);
 
-    QHashIterator<QString, QSharedPointer<ctkPlugin> > it(plugins);
+    QListIterator<ctkPlugin*> it(pluginsByName.value(name));
     while (it.hasNext())
     {
-      QSharedPointer<ctkPlugin> plugin = it.next().value();
-      if ((name == plugin->getSymbolicName()) && (version == plugin->getVersion()))
+      ctkPlugin* plugin = it.next();
+      if (version == plugin->getVersion())
       {
-        return plugin;
+        return plugin->d_func()->q_func().toStrongRef();
       }
     }
   }
@@ -221,22 +343,8 @@ QList<QSharedPointer<ctkPlugin> > ctkPlugins::getPlugins() const
 //----------------------------------------------------------------------------
 QList<ctkPlugin*> ctkPlugins::getPlugins(const QString& name) const
 {
-  QList<ctkPlugin*> res;
-
-  {
-    QReadLocker lock(&pluginsLock);
-    QHashIterator<QString, QSharedPointer<ctkPlugin> > it(plugins);
-    while (it.hasNext())
-    {
-      ctkPlugin* plugin = it.next().value().data();
-      if (name == plugin->getSymbolicName())
-      {
-        res.push_back(plugin);
-      }
-    }
-  }
-
-  return res;
+  QReadLocker lock(&pluginsLock);
+  return pluginsByName.value(name);
 }
 
 //----------------------------------------------------------------------------
@@ -303,7 +411,9 @@ void ctkPlugins::load()
       {
         QSharedPointer<ctkPlugin> plugin(new ctkPlugin());
         plugin->init(plugin, fwCtx, pa);
+        QWriteLocker pluginsLocker(&pluginsLock);
         plugins.insert(pa->getPluginLocation().toString(), plugin);
+        addToNameIndex(plugin.data());
       }
       catch (const std::exception& e)
       {
@@ -351,3 +461,152 @@ void ctkPlugins::startPlugins(const QList<ctkPlugin*>& slist) const
     }
   }
 }
+
+//----------------------------------------------------------------------------
+int ctkPlugins::addToStartWaves(ctkPlugin* plugin, QHash<ctkPlugin*, int>& waves) const
+{
+  if (waves.contains(plugin))
+  {
+    return waves[plugin];
+  }
+  // Guard against cycles in the Require-Plugin headers
+  waves.insert(plugin, 0);
+
+  int wave = 0;
+  QListIterator<ctkRequirePlugin*> i(plugin->d_func()->require);
+  while (i.hasNext())
+  {
+    ctkRequirePlugin* pr = i.next();
+    // The same plugin as ctkPluginPrivate::startDependencies()
+    QList<ctkPlugin*> pl = getPlugins(pr->name, pr->pluginRange);
+    if (!pl.isEmpty())
+    {
+      wave = qMax(wave, addToStartWaves(pl.front(), waves) + 1);
+    }
+  }
+  waves.insert(plugin, wave);
+  return wave;
+}
+
+//----------------------------------------------------------------------------
+void ctkPlugins::startPluginsConcurrently(const QList<QSharedPointer<ctkPlugin> >& plugins,
+                                          const QList<int>& options, int threadCount) const
+{
+  // Resolve first to avoid dead lock
+  foreach (const QSharedPointer<ctkPlugin>& plugin, plugins)
+  {
+    plugin->d_func()->getUpdatedState();
+  }
+
+  QHash<ctkPlugin*, int> waves;
+  int waveCount = 0;
+  foreach (const QSharedPointer<ctkPlugin>& plugin, plugins)
+  {
+    waveCount = qMax(waveCount, addToStartWaves(plugin.data(), waves) + 1);
+  }
+
+  // The required plugins which are not in plugins are started like
+  // ctkPluginPrivate::startDependencies() does.
+  QHash<ctkPlugin*, int> startOptions;
+  for (QHashIterator<ctkPlugin*, int> i(waves); i.hasNext();)
+  {
+    startOptions.insert(i.next().key(), ctkPlugin::START_TRANSIENT);
+  }
+  for (int i = 0; i < plugins.size(); ++i)
+  {
+    startOptions.insert(plugins[i].data(), options[i]);
+  }
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(qMax(1, threadCount));
+  for (int wave = 0; wave < waveCount; ++wave)
+  {
+    // Keep the order of plugins within a wave
+    QList<ctkPlugin*> wavePlugins;
+    foreach (const QSharedPointer<ctkPlugin>& plugin, plugins)
+    {
+      if (waves[plugin.data()] == wave) wavePlugins << plugin.data();
+    }
+    for (QHashIterator<ctkPlugin*, int> i(waves); i.hasNext();)
+    {
+      i.next();
+      if (i.value() == wave && !wavePlugins.contains(i.key())) wavePlugins << i.key();
+    }
+
+    QList<ctkPluginStartTask*> tasks;
+    foreach (ctkPlugin* plugin, wavePlugins)
+    {
+      if (plugin->d_func()->getUpdatedState() != ctkPlugin::RESOLVED &&
+          plugin->d_func()->getUpdatedState() != ctkPlugin::STARTING)
+      {
+        continue;
+      }
+      ctkPluginStartTask* task = new ctkPluginStartTask(plugin, startOptions[plugin],
+                                                        &plugin->d_func()->pluginLoader);
+      tasks << task;
+      pool.start(task);
+    }
+    pool.waitForDone();
+
+    // Report the errors in start order, from the calling thread
+    QScopedPointer<ctkException> unexpected;
+    foreach (ctkPluginStartTask* task, tasks)
+    {
+      if (task->exception)
+      {
+        ctkPluginException* pe = dynamic_cast<ctkPluginException*>(task->exception);
+        if (pe)
+        {
+          fwCtx->listeners.frameworkError(task->plugin->d_func()->q_func(), *pe);
+        }
+        else if (!unexpected)
+        {
+          unexpected.reset(task->exception->clone());
+        }
+      }
+      delete task;
+    }
+    if (unexpected)
+    {
+      unexpected->rethrow();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+bool ctkPlugins::isEagerStart(ctkPlugin* plugin, int options)
+{
+  return !(options & ctkPlugin::START_ACTIVATION_POLICY) || plugin->d_func()->eagerActivation;
+}
+
+//----------------------------------------------------------------------------
+void ctkPlugins::loadPluginLibrariesConcurrently(const QList<QSharedPointer<ctkPlugin> >& plugins,
+                                                 int threadCount) const
+{
+  QHash<ctkPlugin*, int> waves;
+  int waveCount = 0;
+  foreach (const QSharedPointer<ctkPlugin>& plugin, plugins)
+  {
+    // Resolve first, the required plugins are only known once resolved
+    plugin->d_func()->getUpdatedState();
+    waveCount = qMax(waveCount, addToStartWaves(plugin.data(), waves) + 1);
+  }
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(qMax(1, threadCount));
+  for (int wave = 0; wave < waveCount; ++wave)
+  {
+    for (QHashIterator<ctkPlugin*, int> i(waves); i.hasNext();)
+    {
+      i.next();
+      ctkPluginPrivate* pd = i.key()->d_func();
+      if (i.value() != wave || pd->pluginLoader.isLoaded() ||
+          (pd->state != ctkPlugin::RESOLVED && pd->state != ctkPlugin::STARTING))
+      {
+        continue;
+      }
+      pool.start(new ctkPluginLoadTask(pd));
+    }
+    pool.waitForDone();
+  }
+}
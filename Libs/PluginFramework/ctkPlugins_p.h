@@ -52,11 +52,29 @@ private:
    */
   QHash<QString, QSharedPointer<ctkPlugin> > plugins;
 
+  /**
+   * Index of the installed plugins by symbolic name, so that resolving
+   * a Require-Plugin header doesn't scan all the plugins. Protected by
+   * pluginsLock.
+   */
+  QHash<QString, QList<ctkPlugin*> > pluginsByName;
+
+  /**
+   * The symbolic name each plugin is filed under in pluginsByName.
+   */
+  QHash<ctkPlugin*, QString> indexedNames;
+
   /**
    * Link to framework object.
    */
   ctkPluginFrameworkContext* fwCtx;
 
+  /**
+   * Add plugin, and recursively the plugins it requires, to the start
+   * waves of startPluginsConcurrently(). Returns the wave of plugin.
+   */
+  int addToStartWaves(ctkPlugin* plugin, QHash<ctkPlugin*, int>& waves) const;
+
   /**
    * Read write lock for protecting the plugins object
    */
@@ -69,6 +87,16 @@ private:
 
   void checkIllegalState() const;
 
+  /**
+   * Add plugin to pluginsByName. Must be called with pluginsLock held for writing.
+   */
+  void addToNameIndex(ctkPlugin* plugin);
+
+  /**
+   * Remove plugin from pluginsByName. Must be called with pluginsLock held for writing.
+   */
+  void removeFromNameIndex(ctkPlugin* plugin);
+
 public:
 
   /**
@@ -96,6 +124,15 @@ public:
   void remove(const QUrl& location);
 
 
+  /**
+   * File plugin under its current symbolic name. Called when the
+   * manifest of an installed plugin has been re-read by an update.
+   *
+   * @param plugin The plugin whose symbolic name may have changed
+   */
+  void symbolicNameChanged(ctkPlugin* plugin);
+
+
   /**
    * Get the plugin that has the specified plugin identifier.
    *
@@ -179,6 +216,41 @@ public:
    */
   void startPlugins(const QList<ctkPlugin*>& slist) const;
 
+  /**
+   * Start a list of plugins on <code>threadCount</code> threads, see
+   * ctkPluginConstants::FRAMEWORK_PARALLEL_ACTIVATION. The plugins
+   * they require are started before them, with START_TRANSIENT.
+   * The ctkPluginExceptions thrown by the plugins are reported as
+   * framework errors, other exceptions are rethrown once the plugins
+   * being started are done.
+   *
+   * @param plugins ctkPlugins to start.
+   * @param options The start options of each plugin in <code>plugins</code>.
+   * @param threadCount Maximum number of plugins started at the same time.
+   */
+  void startPluginsConcurrently(const QList<QSharedPointer<ctkPlugin> >& plugins,
+                                const QList<int>& options, int threadCount) const;
+
+  /**
+   * Whether starting <code>plugin</code> with <code>options</code>
+   * activates it immediately, instead of waiting for lazy activation.
+   */
+  static bool isEagerStart(ctkPlugin* plugin, int options);
+
+  /**
+   * Load the libraries of a list of plugins, and of the plugins they
+   * require, on <code>threadCount</code> threads, see
+   * ctkPluginConstants::FRAMEWORK_PARALLEL_LOADING. The plugins are
+   * resolved first. A library is loaded once the libraries of the plugins
+   * it requires are loaded. The activators are not created, load errors
+   * are reported when the plugins are started.
+   *
+   * @param plugins ctkPlugins whose libraries are loaded.
+   * @param threadCount Maximum number of libraries loaded at the same time.
+   */
+  void loadPluginLibrariesConcurrently(const QList<QSharedPointer<ctkPlugin> >& plugins,
+                                       int threadCount) const;
+
 
 };
 
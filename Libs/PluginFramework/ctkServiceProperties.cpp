@@ -23,20 +23,47 @@ limitations under the License.
 
 #include <ctkException.h>
 
+#include <QHash>
+#include <QReadWriteLock>
+
+#include <algorithm>
+
+//----------------------------------------------------------------------------
+/// Global table of the atoms of the case folded property keys.
+struct ctkServicePropertyAtoms
+{
+  QReadWriteLock Lock;
+  QHash<QString, int> Atoms;
+};
+
+Q_GLOBAL_STATIC(ctkServicePropertyAtoms, ctkServicePropertyAtomsInstance)
+
+//----------------------------------------------------------------------------
+static bool ctkAtomLessThan(const QPair<int,int>& a, const QPair<int,int>& b)
+{
+  return a.first < b.first;
+}
+
 //----------------------------------------------------------------------------
 ctkServiceProperties::ctkServiceProperties(const ctkProperties& props)
 {
   for(ctkProperties::ConstIterator i = props.begin(), end = props.end();
       i != end; ++i)
   {
-    if (find(i.key()) != -1)
+    atoms.append(qMakePair(intern(i.key()), ks.size()));
+    ks.append(i.key());
+    vs.append(i.value());
+  }
+
+  std::sort(atoms.begin(), atoms.end(), ctkAtomLessThan);
+  for (int i = 1; i < atoms.size(); ++i)
+  {
+    if (atoms[i].first == atoms[i-1].first)
     {
       QString msg("ctkProperties object contains case variants of the key: ");
-      msg += i.key();
+      msg += ks[atoms[i].second];
       throw ctkInvalidArgumentException(msg);
     }
-    ks.append(i.key());
-    vs.append(i.value());
   }
 }
 
@@ -54,6 +81,12 @@ QVariant ctkServiceProperties::value(int index) const
   return (index < 0 || index >= vs.size()) ? QVariant() : vs[index];
 }
 
+//----------------------------------------------------------------------------
+QString ctkServiceProperties::key(int index) const
+{
+  return (index < 0 || index >= ks.size()) ? QString() : ks[index];
+}
+
 //----------------------------------------------------------------------------
 QStringList ctkServiceProperties::keys() const
 {
@@ -68,21 +101,49 @@ QStringList ctkServiceProperties::keys() const
 //----------------------------------------------------------------------------
 int ctkServiceProperties::find(const QString &key) const
 {
-  for (int i = 0; i < ks.size(); ++i)
-  {
-    if (ks[i].compare(key, Qt::CaseInsensitive) == 0)
-      return i;
-  }
-  return -1;
+  return find(atom(key));
 }
 
 //----------------------------------------------------------------------------
 int ctkServiceProperties::findCaseSensitive(const QString &key) const
 {
-  for (int i = 0; i < ks.size(); ++i)
+  int index = find(key);
+  return (index >= 0 && ks[index] == key) ? index : -1;
+}
+
+//----------------------------------------------------------------------------
+int ctkServiceProperties::find(int atom) const
+{
+  if (atom < 0) return -1;
+  const QPair<int,int>* end = atoms.constData() + atoms.size();
+  const QPair<int,int>* it = std::lower_bound(atoms.constData(), end,
+                                              qMakePair(atom, 0), ctkAtomLessThan);
+  return (it != end && it->first == atom) ? it->second : -1;
+}
+
+//----------------------------------------------------------------------------
+int ctkServiceProperties::intern(const QString& key)
+{
+  const QString folded = key.toLower();
+  ctkServicePropertyAtoms* atoms = ctkServicePropertyAtomsInstance();
+  {
+    QReadLocker lock(&atoms->Lock);
+    QHash<QString, int>::const_iterator it = atoms->Atoms.find(folded);
+    if (it != atoms->Atoms.end()) return it.value();
+  }
+  QWriteLocker lock(&atoms->Lock);
+  QHash<QString, int>::iterator it = atoms->Atoms.find(folded);
+  if (it == atoms->Atoms.end())
   {
-    if (ks[i] == key)
-      return i;
+    it = atoms->Atoms.insert(folded, atoms->Atoms.size());
   }
-  return -1;
+  return it.value();
+}
+
+//----------------------------------------------------------------------------
+int ctkServiceProperties::atom(const QString& key)
+{
+  ctkServicePropertyAtoms* atoms = ctkServicePropertyAtomsInstance();
+  QReadLocker lock(&atoms->Lock);
+  return atoms->Atoms.value(key.toLower(), -1);
 }
@@ -22,11 +22,22 @@ limitations under the License.
 #ifndef CTKSERVICEPROPERTIES_P_H
 #define CTKSERVICEPROPERTIES_P_H
 
+#include <QPair>
 #include <QVarLengthArray>
 #include <QVariant>
 
 #include "ctkPluginFramework_global.h"
 
+/**
+ * \ingroup PluginFramework
+ *
+ * Flat, read-only copy of the properties of a service or an event.
+ *
+ * The keys are interned in a global table of atoms, one per case folded
+ * key, and looked up in an array sorted by atom. A case insensitive lookup
+ * of a key whose atom is known, e.g. the attribute of a parsed LDAP
+ * filter, is a binary search on integers.
+ */
 class ctkServiceProperties
 {
 
@@ -35,6 +46,9 @@ private:
   QVarLengthArray<QString,10> ks;
   QVarLengthArray<QVariant,10> vs;
 
+  // <atom, index in ks and vs>, sorted by atom
+  QVarLengthArray<QPair<int,int>,10> atoms;
+
   QMap<QString, QVariant> map;
 
 public:
@@ -47,8 +61,27 @@ public:
   int find(const QString& key) const;
   int findCaseSensitive(const QString& key) const;
 
+  /**
+   * Returns the index of the key with the given atom, or -1.
+   */
+  int find(int atom) const;
+
+  QString key(int index) const;
+
   QStringList keys() const;
 
+  /**
+   * Returns the atom of the case folded <code>key</code>, adding it to
+   * the global table of atoms if needed.
+   */
+  static int intern(const QString& key);
+
+  /**
+   * Returns the atom of the case folded <code>key</code>, or -1 if
+   * it was never interned, and so is the key of no properties.
+   */
+  static int atom(const QString& key);
+
 };
 
 #endif // CTKSERVICEPROPERTIES_P_H
@@ -24,6 +24,7 @@
 #include <QObject>
 #include <QMutexLocker>
 
+#include "ctkLazyServiceFactory_p.h"
 #include "ctkPlugin_p.h"
 #include "ctkPluginConstants.h"
 #include "ctkPluginFrameworkContext_p.h"
@@ -49,6 +50,23 @@ ctkServiceReferencePrivate::~ctkServiceReferencePrivate()
 //----------------------------------------------------------------------------
 QObject* ctkServiceReferencePrivate::getService(QSharedPointer<ctkPlugin> plugin)
 {
+  // Activate a lazy plugin before taking the lock, its activator
+  // registers services and may fail, which unregisters this one.
+  if (ctkLazyServiceFactory* lazyFactory = qobject_cast<ctkLazyServiceFactory*>(registration->getService()))
+  {
+    try
+    {
+      lazyFactory->activate();
+    }
+    catch (const ctkException& pe)
+    {
+      ctkServiceException se("Lazy activation of the plugin failed",
+                             ctkServiceException::FACTORY_EXCEPTION, pe);
+      plugin->d_func()->fwCtx->listeners.frameworkError(registration->plugin->q_func(), se);
+      return 0;
+    }
+  }
+
   QObject* s = 0;
   {
     QMutexLocker lock(&registration->propsLock);
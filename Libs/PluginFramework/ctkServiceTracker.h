@@ -215,6 +215,10 @@ public:
    * Return a list of <code>ctkServiceReference</code>s for all services being
    * tracked by this <code>ctkServiceTracker</code>.
    *
+   * <p>
+   * The list is shared with the other callers until the tracked services
+   * change, so repeated calls neither copy nor lock the tracked services.
+   *
    * @return List of <code>ctkServiceReference</code>s.
    */
   virtual QList<ctkServiceReference> getServiceReferences() const;
@@ -257,10 +261,10 @@ public:
    * <code>ctkServiceTracker</code>.
    *
    * <p>
-   * This implementation calls getServiceReferences() to get the list
-   * of references for the tracked services and then calls
-   * getService(const ctkServiceReference&) for each reference to get the
-   * tracked service object.
+   * The list is in the same order as the one returned by
+   * getServiceReferences() and shared with the other callers until the
+   * tracked services change, so repeated calls neither copy nor lock the
+   * tracked services.
    *
    * @return A list of service objects or an empty list if no services
    *         are being tracked.
@@ -314,7 +318,9 @@ public:
    * comparing a tracking count value previously collected with the current
    * tracking count value. If the value has not changed, then no service has
    * been added, modified or removed from this <code>ctkServiceTracker</code>
-   * since the previous tracking count was collected.
+   * since the previous tracking count was collected. This method does not
+   * lock the tracked services, callers can use it to skip re-fetching the
+   * tracked services when nothing changed.
    *
    * @return The tracking count for this <code>ctkServiceTracker</code> or -1 if
    *         this <code>ctkServiceTracker</code> is not open.
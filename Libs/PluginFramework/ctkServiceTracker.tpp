@@ -148,6 +148,10 @@ void ctkServiceTracker<S,T>::close()
     outgoing->close();
     references = getServiceReferences();
     d->trackedService.clear();;
+    {
+      QMutexLocker lockS(&d->snapshotMutex);
+      d->snapshot.clear();
+    }
     try
     {
       d->context->disconnectServiceListener(outgoing.data(), "serviceChanged");
@@ -217,10 +221,7 @@ QList<ctkServiceReference> ctkServiceTracker<S,T>::getServiceReferences() const
   { /* if ServiceTracker is not open */
     return QList<ctkServiceReference>();
   }
-  {
-    QMutexLocker lockT(t.data());
-    return d->getServiceReferences_unlocked(t.data());
-  }
+  return d->getSnapshot(t)->references;
 }
 
 //----------------------------------------------------------------------------
@@ -330,17 +331,7 @@ QList<T> ctkServiceTracker<S,T>::getServices() const
   { /* if ServiceTracker is not open */
     return QList<T>();
   }
-  {
-    QMutexLocker lockT(t.data());
-    QList<ctkServiceReference> references = d->getServiceReferences_unlocked(t.data());
-    QList<T> objects;
-    foreach (ctkServiceReference ref, references)
-    {
-      //objects << getService(ref);
-      objects << t->getCustomizedObject(ref);
-    }
-    return objects;
-  }
+  return d->getSnapshot(t)->services;
 }
 
 //----------------------------------------------------------------------------
@@ -417,10 +408,7 @@ int ctkServiceTracker<S,T>::getTrackingCount() const
   { /* if ServiceTracker is not open */
     return -1;
   }
-  {
-    QMutexLocker lockT(t.data());
-    return t->getTrackingCount();
-  }
+  return t->getTrackingCount();
 }
 
 //----------------------------------------------------------------------------
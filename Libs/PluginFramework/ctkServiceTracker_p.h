@@ -71,6 +71,25 @@ public:
 
   QList<ctkServiceReference> getServiceReferences_unlocked(ctkTrackedService<S,T>* t) const;
 
+  /**
+   * Immutable copy of the tracked references and their customized
+   * objects, taken at the given tracking count.
+   */
+  struct Snapshot
+  {
+    const ctkTrackedService<S,T>* tracked;
+    int trackingCount;
+    QList<ctkServiceReference> references;
+    QList<T> services;
+  };
+
+  /**
+   * Returns the snapshot of the tracked services of <code>t</code>, taking
+   * a new one if the tracking count changed since the last one was taken.
+   * The lock of <code>t</code> is only taken in that case.
+   */
+  QSharedPointer<const Snapshot> getSnapshot(const QSharedPointer<ctkTrackedService<S,T> >& t) const;
+
   /* set this to true to compile in debug messages */
   static const bool	DEBUG_FLAG; //	= false;
 
@@ -149,6 +168,13 @@ public:
 
   mutable QMutex mutex;
 
+  /**
+   * The last snapshot taken by getSnapshot(), guarded by snapshotMutex.
+   * This mutex is never held while locking the tracked services.
+   */
+  mutable QSharedPointer<const Snapshot> snapshot;
+  mutable QMutex snapshotMutex;
+
 private:
 
   inline ctkServiceTracker<S,T>* q_func()
@@ -136,6 +136,37 @@ QSharedPointer<ctkTrackedService<S,T> > ctkServiceTrackerPrivate<S,T>::tracked()
   return trackedService;
 }
 
+//----------------------------------------------------------------------------
+template<class S, class T>
+QSharedPointer<const typename ctkServiceTrackerPrivate<S,T>::Snapshot>
+ctkServiceTrackerPrivate<S,T>::getSnapshot(const QSharedPointer<ctkTrackedService<S,T> >& t) const
+{
+  {
+    QMutexLocker lock(&snapshotMutex);
+    if (snapshot && snapshot->tracked == t.data() &&
+        snapshot->trackingCount == t->getTrackingCount())
+    {
+      return snapshot;
+    }
+  }
+
+  QSharedPointer<Snapshot> newSnapshot(new Snapshot);
+  newSnapshot->tracked = t.data();
+  {
+    QMutexLocker lockT(t.data());
+    newSnapshot->trackingCount = t->getTrackingCount();
+    newSnapshot->references = getServiceReferences_unlocked(t.data());
+    foreach (ctkServiceReference ref, newSnapshot->references)
+    {
+      newSnapshot->services << t->getCustomizedObject(ref);
+    }
+  }
+
+  QMutexLocker lock(&snapshotMutex);
+  snapshot = newSnapshot;
+  return newSnapshot;
+}
+
 //----------------------------------------------------------------------------
 template<class S, class T>
 void ctkServiceTrackerPrivate<S,T>::modified()
@@ -22,7 +22,8 @@
 #include "ctkServices_p.h"
 
 #include <QStringListIterator>
-#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
 #include <QBuffer>
 
 #include <algorithm>
@@ -63,7 +64,7 @@ ctkDictionary ctkServices::createServiceProperties(const ctkDictionary& in,
 
 //----------------------------------------------------------------------------
 ctkServices::ctkServices(ctkPluginFrameworkContext* fwCtx)
-  : mutex(), framework(fwCtx)
+  : lock(), framework(fwCtx)
 {
 
 }
@@ -93,6 +94,10 @@ ctkServiceRegistration ctkServices::registerService(ctkPluginPrivate* plugin,
     throw ctkInvalidArgumentException("Can't register 0 as a service");
   }
 
+  ctkPluginFrameworkProfiler& profiler = plugin->fwCtx->profiler;
+  ctkPluginFrameworkProfiler::TimelineScope timelineScope(profiler, "service",
+    profiler.isTimelineEnabled() ? classes.join(", ") + " (" + plugin->symbolicName + ")" : QString());
+
   // Check if service implements claimed classes and that they exist.
   for (QStringListIterator i(classes); i.hasNext();)
   {
@@ -116,7 +121,7 @@ ctkServiceRegistration ctkServices::registerService(ctkPluginPrivate* plugin,
   ctkServiceRegistration res(plugin, service,
                              createServiceProperties(properties, classes));
   {
-    QMutexLocker lock(&mutex);
+    QWriteLocker locker(&lock);
     services.insert(res, classes);
     for (QStringListIterator i(classes); i.hasNext(); )
     {
@@ -139,7 +144,7 @@ ctkServiceRegistration ctkServices::registerService(ctkPluginPrivate* plugin,
 void ctkServices::updateServiceRegistrationOrder(const ctkServiceRegistration& sr,
                                               const QStringList& classes)
 {
-  QMutexLocker lock(&mutex);
+  QWriteLocker locker(&lock);
   for (QStringListIterator i(classes); i.hasNext(); )
   {
     QList<ctkServiceRegistration>& s = classServices[i.next()];
@@ -157,14 +162,14 @@ bool ctkServices::checkServiceClass(QObject* service, const QString& cls) const
 //----------------------------------------------------------------------------
 QList<ctkServiceRegistration> ctkServices::get(const QString& clazz) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker locker(&lock);
   return classServices.value(clazz);
 }
 
 //----------------------------------------------------------------------------
 ctkServiceReference ctkServices::get(ctkPluginPrivate* plugin, const QString& clazz) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker locker(&lock);
   try {
     QList<ctkServiceReference> srs = get_unlocked(clazz, QString(), plugin);
     if (framework->debug.service_reference)
@@ -186,7 +191,7 @@ ctkServiceReference ctkServices::get(ctkPluginPrivate* plugin, const QString& cl
 QList<ctkServiceReference> ctkServices::get(const QString& clazz, const QString& filter,
                                             ctkPluginPrivate* plugin) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker locker(&lock);
   return get_unlocked(clazz, filter, plugin);
 }
 
@@ -203,7 +208,7 @@ QList<ctkServiceReference> ctkServices::get_unlocked(const QString& clazz, const
   {
     if (!filter.isEmpty())
     {
-      ldap = ctkLDAPExpr(filter);
+      ldap = ctkLDAPExpr::compiled(filter);
       QSet<QString> matched;
       if (ldap.getMatchedObjectClasses(matched))
       {
@@ -245,7 +250,7 @@ QList<ctkServiceReference> ctkServices::get_unlocked(const QString& clazz, const
     }
     if (!filter.isEmpty())
     {
-      ldap = ctkLDAPExpr(filter);
+      ldap = ctkLDAPExpr::compiled(filter);
     }
   }
 
@@ -269,7 +274,7 @@ QList<ctkServiceReference> ctkServices::get_unlocked(const QString& clazz, const
 //----------------------------------------------------------------------------
 void ctkServices::removeServiceRegistration(const ctkServiceRegistration& sr)
 {
-  QMutexLocker lock(&mutex);
+  QWriteLocker locker(&lock);
 
   QStringList classes = sr.d_func()->properties.value(ctkPluginConstants::OBJECTCLASS).toStringList();
   services.remove(sr);
@@ -291,7 +296,7 @@ void ctkServices::removeServiceRegistration(const ctkServiceRegistration& sr)
 //----------------------------------------------------------------------------
 QList<ctkServiceRegistration> ctkServices::getRegisteredByPlugin(ctkPluginPrivate* p) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker locker(&lock);
 
   QList<ctkServiceRegistration> res;
   for (QHashIterator<ctkServiceRegistration, QStringList> i(services); i.hasNext(); )
@@ -308,7 +313,7 @@ QList<ctkServiceRegistration> ctkServices::getRegisteredByPlugin(ctkPluginPrivat
 //----------------------------------------------------------------------------
 QList<ctkServiceRegistration> ctkServices::getUsedByPlugin(QSharedPointer<ctkPlugin> p) const
 {
-  QMutexLocker lock(&mutex);
+  QReadLocker locker(&lock);
 
   QList<ctkServiceRegistration> res;
   for (QHashIterator<ctkServiceRegistration, QStringList> i(services); i.hasNext(); )
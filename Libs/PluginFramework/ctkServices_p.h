@@ -25,7 +25,7 @@
 
 #include <QHash>
 #include <QObject>
-#include <QMutex>
+#include <QReadWriteLock>
 #include <QStringList>
 
 #include "ctkPlugin_p.h"
@@ -41,7 +41,11 @@ class ctkServices {
 
 public:
 
-  mutable QMutex mutex;
+  /**
+   * Protects services and classServices. The lookups, which vastly
+   * outnumber the registrations, only take it for reading.
+   */
+  mutable QReadWriteLock lock;
 
   /**
    * Creates a new ctkDictionary object containing <code>in</code>
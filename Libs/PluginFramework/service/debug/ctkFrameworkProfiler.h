@@ -0,0 +1,83 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKFRAMEWORKPROFILER_H
+#define CTKFRAMEWORKPROFILER_H
+
+#include <ctkPluginFrameworkExport.h>
+
+#include <QString>
+
+/**
+ * Profiles the service registry, the listener dispatch and the plug-in
+ * activators of the framework.
+ *
+ * <p>
+ * The framework registers this service when it is started. Profiling is
+ * disabled by default, it is enabled with the
+ * <code>org.commontk.pluginfw/debug/profiling</code> debug option or by
+ * calling {@link #setEnabled(bool)}. The following is recorded:
+ * <ul>
+ * <li>The count and latency histogram of the service lookups, per
+ * service class and filter.</li>
+ * <li>The number of <code>getService</code> and <code>ungetService</code>
+ * calls, per service class.</li>
+ * <li>The time spent in the synchronous listeners, per event type.</li>
+ * <li>The start and stop durations of the plug-in activators.</li>
+ * </ul>
+ * </p>
+ */
+struct CTK_PLUGINFW_EXPORT ctkFrameworkProfiler
+{
+
+  virtual ~ctkFrameworkProfiler() {}
+
+  /**
+   * Returns <code>true</code> if profiling is enabled.
+   */
+  virtual bool isEnabled() const = 0;
+
+  /**
+   * Enables or disables profiling. The data recorded so far is kept.
+   *
+   * @param enabled Whether to profile the framework.
+   */
+  virtual void setEnabled(bool enabled) = 0;
+
+  /**
+   * Clears the data recorded so far.
+   */
+  virtual void reset() = 0;
+
+  /**
+   * Returns a human readable report of the data recorded so far. The
+   * entries of each section are sorted by decreasing total time, or
+   * by decreasing count for the service usage.
+   *
+   * @return The profiling report.
+   */
+  virtual QString dump() const = 0;
+
+};
+
+Q_DECLARE_INTERFACE(ctkFrameworkProfiler, "org.commontk.service.debug.FrameworkProfiler")
+
+#endif // CTKFRAMEWORKPROFILER_H
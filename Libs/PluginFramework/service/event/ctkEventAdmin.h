@@ -48,6 +48,26 @@ struct ctkEventAdmin
    */
   virtual void postEvent(const ctkEvent& event) = 0;
 
+  /**
+   * Initiate asynchronous, ordered delivery of a batch of events published
+   * under the same topic. This is equivalent to calling postEvent() for each
+   * of the events, but the matching event handlers are determined once for
+   * the whole batch.
+   *
+   * Event handlers registered with the {@link ctkEventConstants#DELIVERY_BATCH}
+   * delivery quality receive the matching events of the batch in one call of
+   * ctkEventHandler::handleEvents(). Event handlers registered with the
+   * {@link ctkEventConstants#DELIVERY_COALESCE} delivery quality only receive
+   * the last matching event of the batch.
+   *
+   * @param topic The topic of the events.
+   * @param properties The properties of each event, in delivery order.
+   *
+   * @throws ctkInvalidArgumentException If <code>topic</code> is not a valid
+   *         topic name.
+   */
+  virtual void postEvents(const QString& topic, const QList<ctkDictionary>& properties) = 0;
+
   /**
    * Initiate synchronous delivery of an event. This method does not return to
    * the caller until delivery of the event is completed.
@@ -0,0 +1,88 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKEVENTADMINMETRICS_H
+#define CTKEVENTADMINMETRICS_H
+
+#include "ctkEvent.h"
+
+
+/**
+ * \ingroup EventAdmin
+ *
+ * Delivery metrics of an Event Admin service. Event Admin implementations
+ * may register this service to help finding the event handlers slowing
+ * down the event delivery.
+ *
+ * Latencies are measured in microseconds, from the call of the event
+ * handler to its return.
+ *
+ * @remarks This class is thread safe.
+ */
+struct ctkEventAdminMetrics
+{
+  virtual ~ctkEventAdminMetrics() {}
+
+  /**
+   * Returns a snapshot of the metrics collected since the last reset().
+   * The dictionary contains the following keys:
+   * <ul>
+   * <li><code>uptime</code> - The seconds since the last reset (double).</li>
+   * <li><code>topics</code> - A QVariantMap from the topic of the published
+   *     events to a QVariantMap with the <code>count</code> of events and
+   *     their publish <code>rate</code> per second.</li>
+   * <li><code>handlers</code> - A QVariantList with a QVariantMap per event
+   *     handler, with the keys <code>name</code>, <code>plugin</code>,
+   *     <code>deliveries</code>, <code>meanLatency</code>,
+   *     <code>maxLatency</code>, <code>timeouts</code> and
+   *     <code>histogram</code>. The histogram is a QVariantList with the
+   *     number of deliveries which took less than 100us, 1ms, 10ms, 100ms,
+   *     1s and more.</li>
+   * <li><code>asyncQueueDepth</code> and <code>asyncQueueMaxDepth</code> -
+   *     The current and maximum number of handler tasks waiting for
+   *     asynchronous delivery.</li>
+   * <li><code>timeouts</code> - The number of handlers which exceeded the
+   *     delivery timeout.</li>
+   * <li><code>blacklisted</code> - The number of handlers blacklisted,
+   *     due to a timeout or an invalid filter.</li>
+   * </ul>
+   */
+  virtual ctkDictionary getMetrics() const = 0;
+
+  /**
+   * Returns a human readable report of the event handlers with the highest
+   * maximum delivery latency, one line per handler, slowest first.
+   *
+   * @param maxHandlers The maximum number of handlers in the report.
+   */
+  virtual QString getSlowHandlerReport(int maxHandlers = 10) const = 0;
+
+  /**
+   * Clears the collected metrics.
+   */
+  virtual void reset() = 0;
+
+};
+
+
+Q_DECLARE_INTERFACE(ctkEventAdminMetrics, "org.commontk.service.event.EventAdminMetrics")
+
+#endif // CTKEVENTADMINMETRICS_H
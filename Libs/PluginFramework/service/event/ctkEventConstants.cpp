@@ -28,6 +28,8 @@ const QString ctkEventConstants::EVENT_FILTER = "event.filter";
 const QString ctkEventConstants::EVENT_DELIVERY = "event.delivery";
 const QString ctkEventConstants::DELIVERY_ASYNC_ORDERED = "async.ordered";
 const QString ctkEventConstants::DELIVERY_ASYNC_UNORDERED = "async.unordered";
+const QString ctkEventConstants::DELIVERY_BATCH = "batch";
+const QString ctkEventConstants::DELIVERY_COALESCE = "coalesce";
 
 const QString ctkEventConstants::PLUGIN_SYMBOLICNAME = "plugin.symbolicName";
 const QString ctkEventConstants::PLUGIN_ID = "plugin.id";
@@ -125,6 +125,26 @@ struct CTK_PLUGINFW_EXPORT ctkEventConstants {
    */
   static const QString DELIVERY_ASYNC_UNORDERED; // = "async.unordered"
 
+  /**
+   * Event Handler delivery quality value specifying the Event Handler
+   * receives the events published by ctkEventAdmin::postEvents() in one call
+   * of ctkEventHandler::handleEvents() per batch, instead of one call of
+   * ctkEventHandler::handleEvent() per event.
+   *
+   * @see #EVENT_DELIVERY
+   */
+  static const QString DELIVERY_BATCH; // = "batch"
+
+  /**
+   * Event Handler delivery quality value specifying the Event Handler is only
+   * interested in the latest value of a topic: of the events published by
+   * ctkEventAdmin::postEvents(), only the last one matching the handler is
+   * delivered to it.
+   *
+   * @see #EVENT_DELIVERY
+   */
+  static const QString DELIVERY_COALESCE; // = "coalesce"
+
   /**
    * The Plugin Symbolic Name of the plugin relevant to the event. The type of
    * the value for this event property is <code>QString</code>.
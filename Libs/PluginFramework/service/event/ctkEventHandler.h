@@ -79,6 +79,22 @@ struct ctkEventHandler
    * @param event The event that occurred.
    */
   virtual void handleEvent(const ctkEvent& event) = 0;
+
+  /**
+   * Called by the {@link ctkEventAdmin} service to notify the listener of a
+   * batch of events published by ctkEventAdmin::postEvents(), if the listener
+   * was registered with the {@link ctkEventConstants#DELIVERY_BATCH} delivery
+   * quality. The default implementation calls handleEvent() for each event.
+   *
+   * @param events The events that occurred, in delivery order.
+   */
+  virtual void handleEvents(const QList<ctkEvent>& events)
+  {
+    for (int i = 0; i < events.size(); ++i)
+    {
+      handleEvent(events.at(i));
+    }
+  }
 };
 
 Q_DECLARE_INTERFACE(ctkEventHandler, "org.commontk.service.event.EventHandler")
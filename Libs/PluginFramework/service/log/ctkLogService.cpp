@@ -46,7 +46,7 @@ ctkLogStreamWithServiceRef::ctkLogStreamWithServiceRef(const ctkLogStreamWithSer
 //----------------------------------------------------------------------------
 ctkLogStreamWithServiceRef::~ctkLogStreamWithServiceRef()
 {
-  if (!logged)
+  if (!logged && enabled)
   {
     logService->log(sr, level, msg, exc, file, function, line);
     logged = true;
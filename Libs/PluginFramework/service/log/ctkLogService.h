@@ -155,6 +155,20 @@ struct CTK_PLUGINFW_EXPORT ctkLogService
    */
   virtual int getLogLevel() const = 0;
 
+  /**
+   * Whether a message with the given level is accepted into the log, see
+   * getLogLevel(). The CTK_DEBUG and related macros check this before
+   * formatting a message, so that filtered messages cost one virtual call.
+   *
+   * \param level The severity of the message.
+   * \return <code>true</code> if a message with <code>level</code> is not
+   *         discarded by the log service.
+   */
+  bool isLogged(int level) const
+  {
+    return getLogLevel() >= level;
+  }
+
 };
 
 Q_DECLARE_INTERFACE(ctkLogService, "org.commontk.service.log.LogService")
@@ -196,82 +210,82 @@ public:
  */
 
 #define CTK_DEBUG(logService) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_DEBUG) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_DEBUG)) ? \
   ctkLogStream(logService, ctkLogService::LOG_DEBUG, 0, __FILE__, __FUNCTION__, __LINE__) : \
   ctkNullLogStream())
 
 #define CTK_DEBUG_EXC(logService, exc) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_DEBUG) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_DEBUG)) ? \
   ctkLogStream(logService, ctkLogService::LOG_DEBUG, exc, __FILE__, __FUNCTION__, __LINE__) : \
   ctkNullLogStream())
 
 #define CTK_DEBUG_SR(logService, serviceRef) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_DEBUG) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_DEBUG)) ? \
   static_cast<ctkLogStream>(ctkLogStreamWithServiceRef(logService, serviceRef, ctkLogService::LOG_DEBUG, 0, __FILE__, __FUNCTION__, __LINE__)) : \
   static_cast<ctkLogStream>(ctkNullLogStream()))
 
 #define CTK_DEBUG_SR_EXC(logService, serviceRef, exc) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_DEBUG) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_DEBUG)) ? \
   static_cast<ctkLogStream>(ctkLogStreamWithServiceRef(logService, serviceRef, ctkLogService::LOG_DEBUG, exc, __FILE__, __FUNCTION__, __LINE__)) : \
   static_cast<ctkLogStream>(ctkNullLogStream()))
 
 #define CTK_INFO(logService) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_INFO) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_INFO)) ? \
   ctkLogStream(logService, ctkLogService::LOG_INFO, 0, __FILE__, __FUNCTION__, __LINE__) : \
   ctkNullLogStream())
 
 #define CTK_INFO_EXC(logService, exc) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_INFO) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_INFO)) ? \
   ctkLogStream(logService, ctkLogService::LOG_INFO, exc, __FILE__, __FUNCTION__, __LINE__) : \
   ctkNullLogStream())
 
 #define CTK_INFO_SR(logService, serviceRef) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_INFO) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_INFO)) ? \
   static_cast<ctkLogStream>(ctkLogStreamWithServiceRef(logService, serviceRef, ctkLogService::LOG_INFO, 0, __FILE__, __FUNCTION__, __LINE__)) : \
   static_cast<ctkLogStream>(ctkNullLogStream()))
 
 #define CTK_INFO_SR_EXC(logService, serviceRef, exc) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_INFO) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_INFO)) ? \
   static_cast<ctkLogStream>(ctkLogStreamWithServiceRef(logService, serviceRef, ctkLogService::LOG_INFO, exc, __FILE__, __FUNCTION__, __LINE__)) : \
   static_cast<ctkLogStream>(ctkNullLogStream()))
 
 #define CTK_WARN(logService) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_WARNING) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_WARNING)) ? \
   ctkLogStream(logService, ctkLogService::LOG_WARNING, 0, __FILE__, __FUNCTION__, __LINE__) : \
   ctkNullLogStream())
 
 #define CTK_WARN_EXC(logService, exc) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_WARNING) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_WARNING)) ? \
   ctkLogStream(logService, ctkLogService::LOG_WARNING, exc, __FILE__, __FUNCTION__, __LINE__) : \
   ctkNullLogStream())
 
 #define CTK_WARN_SR(logService, serviceRef) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_WARNING) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_WARNING)) ? \
   static_cast<ctkLogStream>(ctkLogStreamWithServiceRef(logService, serviceRef, ctkLogService::LOG_WARNING, 0, __FILE__, __FUNCTION__, __LINE__)) : \
   static_cast<ctkLogStream>(ctkNullLogStream()))
 
 #define CTK_WARN_SR_EXC(logService, serviceRef, exc) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_WARNING) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_WARNING)) ? \
   static_cast<ctkLogStream>(ctkLogStreamWithServiceRef(logService, serviceRef, ctkLogService::LOG_WARNING, exc, __FILE__, __FUNCTION__, __LINE__)) : \
   static_cast<ctkLogStream>(ctkNullLogStream()))
 
 #define CTK_ERROR(logService) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_ERROR) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_ERROR)) ? \
   ctkLogStream(logService, ctkLogService::LOG_ERROR, 0, __FILE__, __FUNCTION__, __LINE__) : \
   ctkNullLogStream())
 
 #define CTK_ERROR_EXC(logService, exc) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_ERROR) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_ERROR)) ? \
   ctkLogStream(logService, ctkLogService::LOG_ERROR, exc, __FILE__, __FUNCTION__, __LINE__) : \
   ctkNullLogStream())
 
 #define CTK_ERROR_SR(logService, serviceRef) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_ERRO) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_ERROR)) ? \
   static_cast<ctkLogStream>(ctkLogStreamWithServiceRef(logService, serviceRef, ctkLogService::LOG_ERROR, 0, __FILE__, __FUNCTION__, __LINE__)) : \
   static_cast<ctkLogStream>(ctkNullLogStream()))
 
 #define CTK_ERROR_SR_EXC(logService, serviceRef, exc) \
-  ((logService && logService->getLogLevel() >= ctkLogService::LOG_ERROR) ? \
+  ((logService && logService->isLogged(ctkLogService::LOG_ERROR)) ? \
   static_cast<ctkLogStream>(ctkLogStreamWithServiceRef(logService, serviceRef, ctkLogService::LOG_ERROR, exc, __FILE__, __FUNCTION__, __LINE__)) : \
   static_cast<ctkLogStream>(ctkNullLogStream()))
 
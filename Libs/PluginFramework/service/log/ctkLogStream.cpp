@@ -26,26 +26,27 @@
 //----------------------------------------------------------------------------
 ctkLogStream::ctkLogStream(ctkLogService* logService, int level, const std::exception* exc,
                            const char* file, const char* function, int line)
-  : logged(false), logService(logService), level(level), exc(exc),
+  : logged(false), enabled(logService && logService->isLogged(level)),
+    logService(logService), level(level), exc(exc),
     file(file), function(function), line(line)
 {
-  ts.setString(&msg);
+  if (enabled) ts.setString(&msg);
 }
 
 //----------------------------------------------------------------------------
 ctkLogStream::ctkLogStream(const ctkLogStream& logStream)
- : msg(logStream.msg), logged(false),
+ : msg(logStream.msg), logged(false), enabled(logStream.enabled),
    logService(logStream.logService), level(logStream.level),
    exc(logStream.exc), file(logStream.file), function(logStream.function),
    line(logStream.line)
 {
-  ts.setString(&msg);
+  if (enabled) ts.setString(&msg);
 }
 
 //----------------------------------------------------------------------------
 ctkLogStream::~ctkLogStream()
 {
-  if (!logged && logService)
+  if (!logged && enabled)
   {
     logService->log(level, msg, exc, file, function, line);
   }
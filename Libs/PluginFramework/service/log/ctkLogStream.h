@@ -42,22 +42,31 @@ public:
 
   virtual ~ctkLogStream();
 
+  /**
+   * Whether the message is passed to the log service. The streaming
+   * operators do not format anything into a message which is not logged.
+   */
+  bool isLogged() const
+  {
+    return enabled;
+  }
+
   template<class T>
   ctkLogStream& operator <<(const T& t)
   {
-    ts << t;
+    if (enabled) ts << t;
     return *this;
   }
 
   ctkLogStream& operator <<(const char* c)
   {
-    ts << c;
+    if (enabled) ts << c;
     return *this;
   }
 
   ctkLogStream& operator <<(bool b)
   {
-    ts << (b ? "true" : "false");
+    if (enabled) ts << (b ? "true" : "false");
     return *this;
   }
 
@@ -66,6 +75,7 @@ protected:
   QString msg;
   QTextStream ts;
   bool logged;
+  bool enabled;
 
   ctkLogService* logService;
   int level;
@@ -0,0 +1,92 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// QT includes
+#include <QDataStream>
+#include <QTextStream>
+
+// CTKQtTesting includes
+#include "ctkBinaryEventObserver.h"
+
+//-----------------------------------------------------------------------------
+// ctkBinaryEventObserver methods
+
+//-----------------------------------------------------------------------------
+ctkBinaryEventObserver::ctkBinaryEventObserver(QObject* p)
+  : Superclass(p)
+{
+  this->DataStream = NULL;
+}
+
+//-----------------------------------------------------------------------------
+ctkBinaryEventObserver::~ctkBinaryEventObserver()
+{
+  delete this->DataStream;
+}
+
+//-----------------------------------------------------------------------------
+void ctkBinaryEventObserver::setStream(QTextStream* stream)
+{
+  delete this->DataStream;
+  this->DataStream = NULL;
+  this->Strings.clear();
+  pqEventObserver::setStream(stream);
+  if (this->Stream && this->Stream->device())
+    {
+    this->Stream->flush();
+    QIODevice* device = this->Stream->device();
+    // the events are written as is, without end of line conversions
+    device->setTextModeEnabled(false);
+    this->DataStream = new QDataStream(device);
+    this->DataStream->setVersion(QDataStream::Qt_4_6);
+    *this->DataStream << quint32(0x43544b45) << quint32(1);
+    this->EventTime.start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkBinaryEventObserver::onRecordEvent(const QString& widget,
+                                           const QString& command,
+                                           const QString& arguments)
+{
+  if (!this->DataStream)
+    {
+    return;
+    }
+  *this->DataStream << quint32(this->EventTime.restart());
+  this->writeString(widget);
+  this->writeString(command);
+  this->writeString(arguments);
+  emit this->eventRecorded(widget, command, arguments);
+}
+
+//-----------------------------------------------------------------------------
+void ctkBinaryEventObserver::writeString(const QString& value)
+{
+  QHash<QString, quint32>::const_iterator it = this->Strings.constFind(value);
+  if (it != this->Strings.constEnd())
+    {
+    *this->DataStream << it.value();
+    return;
+    }
+  quint32 index = this->Strings.count();
+  this->Strings.insert(value, index);
+  *this->DataStream << index << value;
+}
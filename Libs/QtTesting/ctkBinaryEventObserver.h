@@ -0,0 +1,77 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkBinaryEventObserver_h
+#define __ctkBinaryEventObserver_h
+
+// QT includes
+#include <QHash>
+#include <QString>
+#include <QTime>
+
+// QtTesting includes
+#include <pqEventObserver.h>
+
+// CTKQtTesting includes
+#if !defined(NO_SYMBOL_EXPORT)
+# include "ctkQtTestingExport.h"
+#else
+# define CTK_QTTESTING_EXPORT
+#endif
+
+class QDataStream;
+class QTextStream;
+
+//-----------------------------------------------------------------------------
+/// Records the events in a compact binary format, read by
+/// ctkBinaryEventSource. Each string (widget, command or arguments) is
+/// written once and then referred to by its index. The time elapsed since
+/// the previous event is recorded with each event.
+/// The format, written with a QDataStream (Qt_4_6), is:
+///  - the quint32 magic 0x43544b45 ("CTKE") and the quint32 version 1
+///  - for each event, the quint32 milliseconds elapsed since the previous
+///    event and its widget, command and arguments strings. A string is
+///    written as its quint32 index in the table of the strings already
+///    written; if the index is the size of the table, the QString follows
+///    and is appended to the table.
+class CTK_QTTESTING_EXPORT ctkBinaryEventObserver : public pqEventObserver
+{
+  Q_OBJECT
+
+public:
+  typedef pqEventObserver Superclass;
+
+  ctkBinaryEventObserver(QObject* parent = 0);
+  ~ctkBinaryEventObserver();
+
+  virtual void setStream(QTextStream* stream);
+  virtual void onRecordEvent(const QString& widget,
+                             const QString& command,
+                             const QString& arguments);
+
+protected:
+  void writeString(const QString& value);
+
+  QDataStream* DataStream;
+  QHash<QString, quint32> Strings;
+  QTime EventTime;
+};
+
+#endif // __ctkBinaryEventObserver_h
@@ -0,0 +1,220 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// QT includes
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+
+// QtTesting includes
+#include <pqEventDispatcher.h>
+
+// CTKQtTesting includes
+#include "ctkBinaryEventSource.h"
+
+//-----------------------------------------------------------------------------
+// ctkBinaryEventSource methods
+
+//-----------------------------------------------------------------------------
+ctkBinaryEventSource::ctkBinaryEventSource(QObject* p)
+  : Superclass(p)
+{
+  this->File = NULL;
+  this->DataStream = NULL;
+  this->Synchronous = false;
+  this->IdleTimeout = 5000;
+  this->PreviousPlaybackDelay = 0;
+}
+
+//-----------------------------------------------------------------------------
+ctkBinaryEventSource::~ctkBinaryEventSource()
+{
+  this->setSynchronousPlayback(false);
+  delete this->DataStream;
+  delete this->File;
+}
+
+//-----------------------------------------------------------------------------
+void ctkBinaryEventSource::setSynchronousPlayback(bool synchronous)
+{
+  if (synchronous == this->Synchronous)
+    {
+    return;
+    }
+  this->Synchronous = synchronous;
+  if (synchronous)
+    {
+    this->PreviousPlaybackDelay = pqEventDispatcher::eventPlaybackDelay();
+    pqEventDispatcher::setEventPlaybackDelay(0);
+    }
+  else
+    {
+    pqEventDispatcher::setEventPlaybackDelay(this->PreviousPlaybackDelay);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool ctkBinaryEventSource::synchronousPlayback()const
+{
+  return this->Synchronous;
+}
+
+//-----------------------------------------------------------------------------
+void ctkBinaryEventSource::setIdleTimeout(int msecs)
+{
+  this->IdleTimeout = msecs;
+}
+
+//-----------------------------------------------------------------------------
+int ctkBinaryEventSource::idleTimeout()const
+{
+  return this->IdleTimeout;
+}
+
+//-----------------------------------------------------------------------------
+void ctkBinaryEventSource::setContent(const QString& filename)
+{
+  delete this->DataStream;
+  this->DataStream = NULL;
+  delete this->File;
+  this->File = NULL;
+  this->Strings.clear();
+  this->Steps.clear();
+
+  this->File = new QFile(filename);
+  if (!this->File->open(QIODevice::ReadOnly))
+    {
+    qCritical() << "Failed to load " << filename;
+    return;
+    }
+  this->DataStream = new QDataStream(this->File);
+  this->DataStream->setVersion(QDataStream::Qt_4_6);
+  quint32 magic = 0;
+  quint32 version = 0;
+  *this->DataStream >> magic >> version;
+  if (magic != 0x43544b45 || version != 1)
+    {
+    qCritical() << filename << "invalid event file for qtTesting !";
+    delete this->DataStream;
+    this->DataStream = NULL;
+    }
+}
+
+//-----------------------------------------------------------------------------
+int ctkBinaryEventSource::getNextEvent(QString& widget, QString& command, QString& arguments)
+{
+  if (!this->DataStream)
+    {
+    return FAILURE;
+    }
+  // the previous step is over once the application is done with it
+  if (this->Synchronous)
+    {
+    this->waitForApplicationIdle();
+    }
+  this->finishStep();
+  if (this->DataStream->atEnd())
+    {
+    return DONE;
+    }
+  quint32 recordedTime = 0;
+  *this->DataStream >> recordedTime;
+  widget = this->readString();
+  command = this->readString();
+  arguments = this->readString();
+  if (this->DataStream->status() != QDataStream::Ok)
+    {
+    qCritical() << "Truncated event file for qtTesting !";
+    return FAILURE;
+    }
+
+  StepTiming step;
+  step.Widget = widget;
+  step.Command = command;
+  step.RecordedTime = static_cast<int>(recordedTime);
+  step.PlaybackTime = -1;
+  this->Steps << step;
+  this->StepTime.start();
+  return SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkBinaryEventSource::readString()
+{
+  quint32 index = 0;
+  *this->DataStream >> index;
+  if (index == static_cast<quint32>(this->Strings.count()))
+    {
+    QString value;
+    *this->DataStream >> value;
+    this->Strings << value;
+    return value;
+    }
+  return this->Strings.value(index);
+}
+
+//-----------------------------------------------------------------------------
+void ctkBinaryEventSource::finishStep()
+{
+  if (!this->Steps.isEmpty() && this->Steps.last().PlaybackTime < 0)
+    {
+    this->Steps.last().PlaybackTime = this->StepTime.elapsed();
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool ctkBinaryEventSource::isApplicationIdle()
+{
+  return !QCoreApplication::hasPendingEvents();
+}
+
+//-----------------------------------------------------------------------------
+void ctkBinaryEventSource::waitForApplicationIdle()
+{
+  QTime timer;
+  timer.start();
+  do
+    {
+    pqEventDispatcher::processEventsAndWait(1);
+    }
+  while (!this->isApplicationIdle() && timer.elapsed() < this->IdleTimeout);
+}
+
+//-----------------------------------------------------------------------------
+QList<ctkBinaryEventSource::StepTiming> ctkBinaryEventSource::stepTimings()const
+{
+  return this->Steps;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkBinaryEventSource::timingReport()const
+{
+  QString report;
+  QTextStream stream(&report);
+  for (int i = 0; i < this->Steps.count(); ++i)
+    {
+    const StepTiming& step = this->Steps[i];
+    stream << i << '\t' << step.Widget << '\t' << step.Command << '\t'
+           << step.RecordedTime << '\t' << step.PlaybackTime << '\n';
+    }
+  return report;
+}
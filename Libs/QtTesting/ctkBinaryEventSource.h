@@ -0,0 +1,110 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkBinaryEventSource_h
+#define __ctkBinaryEventSource_h
+
+// QT includes
+#include <QList>
+#include <QStringList>
+#include <QTime>
+
+// QtTesting includes
+#include <pqEventSource.h>
+
+// CTKQtTesting includes
+#if !defined(NO_SYMBOL_EXPORT)
+# include "ctkQtTestingExport.h"
+#else
+# define CTK_QTTESTING_EXPORT
+#endif
+
+class QDataStream;
+class QFile;
+
+//-----------------------------------------------------------------------------
+/// Plays back the events recorded by ctkBinaryEventObserver.
+///
+/// In synchronous playback, the fixed delay of pqEventDispatcher between
+/// two events is disabled: instead, each event is played as soon as the
+/// application is idle (see isApplicationIdle()), or after idleTimeout()
+/// milliseconds.
+///
+/// The time each step took to play, from the moment the event is
+/// dispatched until the next one is requested, is measured and can be
+/// compared with the time recorded, see timingReport().
+class CTK_QTTESTING_EXPORT ctkBinaryEventSource : public pqEventSource
+{
+  Q_OBJECT
+
+public:
+  typedef pqEventSource Superclass;
+
+  ctkBinaryEventSource(QObject* parent = 0);
+  ~ctkBinaryEventSource();
+
+  virtual void setContent(const QString& filename);
+  int getNextEvent(QString& widget, QString& command, QString& arguments);
+
+  /// Disabled by default.
+  void setSynchronousPlayback(bool synchronous);
+  bool synchronousPlayback()const;
+
+  /// Maximum time to wait for the application to be idle, in milliseconds.
+  /// Default is 5000.
+  void setIdleTimeout(int msecs);
+  int idleTimeout()const;
+
+  struct StepTiming
+    {
+    QString Widget;
+    QString Command;
+    /// Milliseconds elapsed before the event while recording
+    int RecordedTime;
+    /// Milliseconds the step took to play back, -1 while it is playing
+    int PlaybackTime;
+    };
+  /// Timings of the steps played since the last setContent()
+  QList<StepTiming> stepTimings()const;
+  /// Tab separated step, widget, command, recorded and playback
+  /// milliseconds of the steps played, one step per line
+  QString timingReport()const;
+
+protected:
+  /// Return true if the next event can be played in synchronous playback.
+  /// By default, the application is idle when no event is pending.
+  /// Reimplement it to also wait for e.g. renderings to complete.
+  virtual bool isApplicationIdle();
+  void waitForApplicationIdle();
+
+  QString readString();
+  void finishStep();
+
+  QFile* File;
+  QDataStream* DataStream;
+  QStringList Strings;
+  bool Synchronous;
+  int IdleTimeout;
+  int PreviousPlaybackDelay;
+  QList<StepTiming> Steps;
+  QTime StepTime;
+};
+
+#endif // __ctkBinaryEventSource_h
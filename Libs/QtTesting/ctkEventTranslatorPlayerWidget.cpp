@@ -26,6 +26,8 @@
 #include <QVBoxLayout>
 
 // CTKTesting includes
+#include "ctkBinaryEventObserver.h"
+#include "ctkBinaryEventSource.h"
 #include "ctkCallback.h"
 #include "ctkEventTranslatorPlayerWidget.h"
 #include "ctkQtTestingUtility.h"
@@ -132,6 +134,8 @@ void ctkEventTranslatorPlayerWidget::setTestUtility(pqTestUtility* newTestUtilit
   ctkXMLEventSource* eventSource = new ctkXMLEventSource(d->TestUtility);
   eventSource->setRestoreSettingsAuto(true);
   d->TestUtility->addEventSource("xml", eventSource);
+  d->TestUtility->addEventObserver("ctkevents", new ctkBinaryEventObserver(d->TestUtility));
+  d->TestUtility->addEventSource("ctkevents", new ctkBinaryEventSource(d->TestUtility));
 }
 
 //-----------------------------------------------------------------------------
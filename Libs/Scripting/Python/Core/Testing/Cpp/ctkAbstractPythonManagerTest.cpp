@@ -32,8 +32,12 @@ private Q_SLOTS:
 
   void testIsPythonInitialized();
 
+  void testQueueString();
+
   void testSetInitializationFlags();
 
+  void testQueuedString();
+
   void testSetSystemExitExceptionHandlerEnabled();
 
   void testPythonErrorOccured();
@@ -54,6 +58,8 @@ private Q_SLOTS:
   void testExecuteFile();
   void testExecuteFile_data();
 
+  void testExecuteStringAsync();
+
   //void testPythonAttributes(); // TODO
 };
 
@@ -75,6 +81,14 @@ void ctkAbstractPythonManagerTester::testIsPythonInitialized()
   QCOMPARE(this->PythonManager.isPythonInitialized(), false);
 }
 
+// ----------------------------------------------------------------------------
+void ctkAbstractPythonManagerTester::testQueueString()
+{
+  this->PythonManager.initializeLater();
+  this->PythonManager.queueString("queuedBeforeInitialization = 6545");
+  QCOMPARE(this->PythonManager.isPythonInitialized(), false);
+}
+
 // ----------------------------------------------------------------------------
 void ctkAbstractPythonManagerTester::testSetInitializationFlags()
 {
@@ -97,6 +111,16 @@ void ctkAbstractPythonManagerTester::testSetInitializationFlags()
   QCOMPARE(this->PythonManager.isPythonInitialized(), true);
 }
 
+// ----------------------------------------------------------------------------
+void ctkAbstractPythonManagerTester::testQueuedString()
+{
+  // initialized by testSetInitializationFlags()
+  QCOMPARE(this->PythonManager.getVariable("queuedBeforeInitialization"), QVariant(6545));
+
+  this->PythonManager.queueString("queuedAfterInitialization = 6546");
+  QCOMPARE(this->PythonManager.getVariable("queuedAfterInitialization"), QVariant(6546));
+}
+
 // ----------------------------------------------------------------------------
 void ctkAbstractPythonManagerTester::testSetSystemExitExceptionHandlerEnabled()
 {
@@ -262,6 +286,22 @@ void ctkAbstractPythonManagerTester::testExecuteFile_data()
                      << false;
 }
 
+// ----------------------------------------------------------------------------
+void ctkAbstractPythonManagerTester::testExecuteStringAsync()
+{
+  QFuture<QVariant> evalFuture = this->PythonManager.executeStringAsync(
+    "6547 + 1", ctkAbstractPythonManager::EvalInput);
+  QFuture<QVariant> fileFuture = this->PythonManager.executeStringAsync(
+    "import threading\nasyncThreadName = threading.current_thread().name");
+  this->PythonManager.waitForAsyncExecution();
+
+  QVERIFY(evalFuture.isFinished());
+  QCOMPARE(evalFuture.result(), QVariant(6548));
+  QVERIFY(fileFuture.isFinished());
+  QVERIFY(this->PythonManager.getVariable("asyncThreadName") != QVariant("MainThread"));
+  QCOMPARE(this->PythonManager.pythonErrorOccured(), false);
+}
+
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(ctkAbstractPythonManagerTest)
 #include "moc_ctkAbstractPythonManagerTest.cpp"
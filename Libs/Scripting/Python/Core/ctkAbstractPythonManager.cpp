@@ -21,6 +21,13 @@
 // Qt includes
 #include <QDir>
 #include <QDebug>
+#include <QFutureInterface>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QTimer>
+#include <QWaitCondition>
 
 // CTK includes
 #include "ctkAbstractPythonManager.h"
@@ -56,6 +63,78 @@ public:
   void (*InitFunction)();
 
   int PythonQtInitializationFlags;
+
+  /// Register with PythonQt the classes recorded by registerClassForPythonQt()
+  /// and registerCPPClassForPythonQt()
+  void registerPendingClasses()const;
+
+  bool DeferredClassRegistration;
+  mutable QList<const QMetaObject*> PendingMetaObjects;
+  mutable QList<QByteArray> PendingCPPClassNames;
+
+  /// Execute the requests of queueString() and queueFile()
+  void executeQueuedRequests();
+
+  struct QueuedRequest
+    {
+    QString Code;
+    bool IsFile;
+    ctkAbstractPythonManager::ExecuteStringMode Mode;
+    };
+  QList<QueuedRequest> QueuedRequests;
+
+  /// Set once initPythonQt() has emitted pythonInitialized()
+  bool PythonInitialized;
+
+  /// Python code executing the script \a filename
+  QString executeFileCode(const QString& filename)const;
+
+  QFuture<QVariant> executeAsync(const QString& code, int start);
+  /// Release the GIL until the pending asynchronous requests are executed
+  /// or for at most \a msecs milliseconds.
+  void yieldGIL(int msecs);
+  void asyncRequestFinished();
+
+  /// Single thread of the executeStringAsync() requests
+  QThreadPool AsyncThreadPool;
+  /// Periodically calls yieldToAsyncExecution()
+  QTimer AsyncTimer;
+  QMutex AsyncMutex;
+  QWaitCondition AsyncRequestsFinished;
+  int PendingAsyncRequests;
+};
+
+//-----------------------------------------------------------------------------
+/// Execute code on the python thread of the manager, with the GIL held
+class ctkAbstractPythonManagerAsyncRequest : public QRunnable
+{
+public:
+  ctkAbstractPythonManagerAsyncRequest(ctkAbstractPythonManagerPrivate* manager,
+                                       const QString& code, int start)
+    : Manager(manager), Code(code), Start(start)
+  {
+    this->Future.reportStarted();
+  }
+
+  void run()
+  {
+    PyGILState_STATE state = PyGILState_Ensure();
+    {
+    QVariant result = PythonQt::self()->getMainModule().evalScript(this->Code, this->Start);
+    // the result may reference python objects, it is released with the GIL held
+    this->Future.reportResult(result);
+    }
+    PyGILState_Release(state);
+    this->Future.reportFinished();
+    this->Manager->asyncRequestFinished();
+  }
+
+  QFutureInterface<QVariant> Future;
+
+private:
+  ctkAbstractPythonManagerPrivate* Manager;
+  QString Code;
+  int Start;
 };
 
 //-----------------------------------------------------------------------------
@@ -67,6 +146,12 @@ ctkAbstractPythonManagerPrivate::ctkAbstractPythonManagerPrivate(ctkAbstractPyth
 {
   this->InitFunction = 0;
   this->PythonQtInitializationFlags = PythonQt::IgnoreSiteModule | PythonQt::RedirectStdOut;
+  this->DeferredClassRegistration = false;
+  this->PythonInitialized = false;
+  this->PendingAsyncRequests = 0;
+  this->AsyncThreadPool.setMaxThreadCount(1);
+  this->AsyncThreadPool.setExpiryTimeout(-1);
+  this->AsyncTimer.setInterval(10);
 }
 
 //-----------------------------------------------------------------------------
@@ -74,6 +159,119 @@ ctkAbstractPythonManagerPrivate::~ctkAbstractPythonManagerPrivate()
 {
 }
 
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManagerPrivate::registerPendingClasses()const
+{
+  if (!PythonQt::self())
+    {
+    return;
+    }
+  // registering a class may register more classes, take the lists first
+  QList<const QMetaObject*> metaObjects = this->PendingMetaObjects;
+  QList<QByteArray> cppClassNames = this->PendingCPPClassNames;
+  this->PendingMetaObjects.clear();
+  this->PendingCPPClassNames.clear();
+  foreach (const QMetaObject* metaObject, metaObjects)
+    {
+    PythonQt::self()->registerClass(metaObject);
+    }
+  foreach (const QByteArray& name, cppClassNames)
+    {
+    PythonQt::self()->registerCPPClass(name.constData());
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManagerPrivate::executeQueuedRequests()
+{
+  Q_Q(ctkAbstractPythonManager);
+  while (!this->QueuedRequests.isEmpty())
+    {
+    QueuedRequest request = this->QueuedRequests.takeFirst();
+    if (request.IsFile)
+      {
+      q->executeFile(request.Code);
+      }
+    else
+      {
+      q->executeString(request.Code, request.Mode);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString ctkAbstractPythonManagerPrivate::executeFileCode(const QString& filename)const
+{
+  QString path = QFileInfo(filename).absolutePath();
+  // See http://nedbatchelder.com/blog/200711/rethrowing_exceptions_in_python.html
+  QStringList code = QStringList()
+      << "import sys"
+      << QString("sys.path.insert(0, '%1')").arg(path)
+      << "_updated_globals = globals()"
+      << QString("_updated_globals['__file__'] = '%1'").arg(filename)
+      << "_ctk_executeFile_exc_info = None"
+      << "try:"
+      << QString("    execfile('%1', _updated_globals)").arg(filename)
+      << "except Exception, e:"
+      << "    _ctk_executeFile_exc_info = sys.exc_info()"
+      << "finally:"
+      << "    del _updated_globals"
+      << QString("    if sys.path[0] == '%1': sys.path.pop(0)").arg(path)
+      << "    if _ctk_executeFile_exc_info:"
+      << "        raise _ctk_executeFile_exc_info[1], None, _ctk_executeFile_exc_info[2]";
+  return code.join("\n");
+}
+
+//-----------------------------------------------------------------------------
+QFuture<QVariant> ctkAbstractPythonManagerPrivate::executeAsync(const QString& code, int start)
+{
+  Q_Q(ctkAbstractPythonManager);
+  if (!q->mainContext())
+    {
+    QFutureInterface<QVariant> failed;
+    failed.reportStarted();
+    failed.reportFinished();
+    return failed.future();
+    }
+  // the main thread holds the GIL once the threads are initialized
+  if (!PyEval_ThreadsInitialized())
+    {
+    PyEval_InitThreads();
+    }
+  ctkAbstractPythonManagerAsyncRequest* request =
+    new ctkAbstractPythonManagerAsyncRequest(this, code, start);
+  QFuture<QVariant> future = request->Future.future();
+  {
+  QMutexLocker locker(&this->AsyncMutex);
+  ++this->PendingAsyncRequests;
+  }
+  this->AsyncThreadPool.start(request);
+  this->AsyncTimer.start();
+  return future;
+}
+
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManagerPrivate::yieldGIL(int msecs)
+{
+  PyThreadState* mainThreadState = PyEval_SaveThread();
+  {
+  QMutexLocker locker(&this->AsyncMutex);
+  if (this->PendingAsyncRequests > 0)
+    {
+    this->AsyncRequestsFinished.wait(&this->AsyncMutex, msecs);
+    }
+  }
+  PyEval_RestoreThread(mainThreadState);
+}
+
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManagerPrivate::asyncRequestFinished()
+{
+  QMutexLocker locker(&this->AsyncMutex);
+  --this->PendingAsyncRequests;
+  this->AsyncRequestsFinished.wakeAll();
+}
+
 //-----------------------------------------------------------------------------
 // ctkAbstractPythonManager methods
 
@@ -81,11 +279,14 @@ ctkAbstractPythonManagerPrivate::~ctkAbstractPythonManagerPrivate()
 ctkAbstractPythonManager::ctkAbstractPythonManager(QObject* _parent) : Superclass(_parent),
   d_ptr(new ctkAbstractPythonManagerPrivate(*this))
 {
+  Q_D(ctkAbstractPythonManager);
+  this->connect(&d->AsyncTimer, SIGNAL(timeout()), SLOT(yieldToAsyncExecution()));
 }
 
 //-----------------------------------------------------------------------------
 ctkAbstractPythonManager::~ctkAbstractPythonManager()
 {
+  this->waitForAsyncExecution();
   if (Py_IsInitialized())
     {
     Py_Finalize();
@@ -122,12 +323,24 @@ bool ctkAbstractPythonManager::initialize()
   return this->isPythonInitialized();
 }
 
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManager::initializeLater()
+{
+  if (PythonQt::self())
+    {
+    return;
+    }
+  QMetaObject::invokeMethod(this, "initialize", Qt::QueuedConnection);
+}
+
 //-----------------------------------------------------------------------------
 PythonQtObjectPtr ctkAbstractPythonManager::mainContext()
 {
+  Q_D(ctkAbstractPythonManager);
   bool initalized = this->initialize();
   if (initalized)
     {
+    d->registerPendingClasses();
     return PythonQt::self()->getMainModule();
     }
   return PythonQtObjectPtr();
@@ -171,6 +384,11 @@ void ctkAbstractPythonManager::initPythonQt(int flags)
   PythonQtObjectPtr _mainContext = PythonQt::self()->getMainModule();
   _mainContext.evalScript(initCode.join("\n"));
 
+  if (!d->DeferredClassRegistration)
+    {
+    d->registerPendingClasses();
+    }
+
   this->preInitialization();
   if (d->InitFunction)
     {
@@ -180,6 +398,9 @@ void ctkAbstractPythonManager::initPythonQt(int flags)
 
   this->executeInitializationScripts();
   emit this->pythonInitialized();
+
+  d->PythonInitialized = true;
+  d->executeQueuedRequests();
 }
 
 //-----------------------------------------------------------------------------
@@ -240,9 +461,13 @@ void ctkAbstractPythonManager::registerPythonQtDecorator(QObject* decorator)
 //-----------------------------------------------------------------------------
 void ctkAbstractPythonManager::registerClassForPythonQt(const QMetaObject* metaobject)
 {
-  if (!PythonQt::self())
+  Q_D(ctkAbstractPythonManager);
+  if (!PythonQt::self() || d->DeferredClassRegistration)
     {
-    qWarning() << Q_FUNC_INFO << " failed: PythonQt is not initialized";
+    if (metaobject)
+      {
+      d->PendingMetaObjects << metaobject;
+      }
     return;
     }
   PythonQt::self()->registerClass(metaobject);
@@ -251,14 +476,36 @@ void ctkAbstractPythonManager::registerClassForPythonQt(const QMetaObject* metao
 //-----------------------------------------------------------------------------
 void ctkAbstractPythonManager::registerCPPClassForPythonQt(const char* name)
 {
-  if (!PythonQt::self())
+  Q_D(ctkAbstractPythonManager);
+  if (!PythonQt::self() || d->DeferredClassRegistration)
     {
-    qWarning() << Q_FUNC_INFO << " failed: PythonQt is not initialized";
+    if (name)
+      {
+      d->PendingCPPClassNames << QByteArray(name);
+      }
     return;
     }
   PythonQt::self()->registerCPPClass(name);
 }
 
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManager::setDeferredClassRegistration(bool deferred)
+{
+  Q_D(ctkAbstractPythonManager);
+  d->DeferredClassRegistration = deferred;
+  if (!deferred)
+    {
+    d->registerPendingClasses();
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool ctkAbstractPythonManager::deferredClassRegistration()const
+{
+  Q_D(const ctkAbstractPythonManager);
+  return d->DeferredClassRegistration;
+}
+
 //-----------------------------------------------------------------------------
 bool ctkAbstractPythonManager::systemExitExceptionHandlerEnabled()const
 {
@@ -306,31 +553,105 @@ QVariant ctkAbstractPythonManager::executeString(const QString& code,
 //-----------------------------------------------------------------------------
 void ctkAbstractPythonManager::executeFile(const QString& filename)
 {
+  Q_D(ctkAbstractPythonManager);
   PythonQtObjectPtr main = ctkAbstractPythonManager::mainContext();
   if (main)
     {
-    QString path = QFileInfo(filename).absolutePath();
-    // See http://nedbatchelder.com/blog/200711/rethrowing_exceptions_in_python.html
-    QStringList code = QStringList()
-        << "import sys"
-        << QString("sys.path.insert(0, '%1')").arg(path)
-        << "_updated_globals = globals()"
-        << QString("_updated_globals['__file__'] = '%1'").arg(filename)
-        << "_ctk_executeFile_exc_info = None"
-        << "try:"
-        << QString("    execfile('%1', _updated_globals)").arg(filename)
-        << "except Exception, e:"
-        << "    _ctk_executeFile_exc_info = sys.exc_info()"
-        << "finally:"
-        << "    del _updated_globals"
-        << QString("    if sys.path[0] == '%1': sys.path.pop(0)").arg(path)
-        << "    if _ctk_executeFile_exc_info:"
-        << "        raise _ctk_executeFile_exc_info[1], None, _ctk_executeFile_exc_info[2]";
-    this->executeString(code.join("\n"));
+    this->executeString(d->executeFileCode(filename));
     //PythonQt::self()->handleError(); // Clear errorOccured flag
     }
 }
 
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManager::queueString(const QString& code,
+                                           ctkAbstractPythonManager::ExecuteStringMode mode)
+{
+  Q_D(ctkAbstractPythonManager);
+  if (d->PythonInitialized)
+    {
+    this->executeString(code, mode);
+    return;
+    }
+  ctkAbstractPythonManagerPrivate::QueuedRequest request;
+  request.Code = code;
+  request.IsFile = false;
+  request.Mode = mode;
+  d->QueuedRequests << request;
+}
+
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManager::queueFile(const QString& filename)
+{
+  Q_D(ctkAbstractPythonManager);
+  if (d->PythonInitialized)
+    {
+    this->executeFile(filename);
+    return;
+    }
+  ctkAbstractPythonManagerPrivate::QueuedRequest request;
+  request.Code = filename;
+  request.IsFile = true;
+  request.Mode = FileInput;
+  d->QueuedRequests << request;
+}
+
+//-----------------------------------------------------------------------------
+QFuture<QVariant> ctkAbstractPythonManager::executeStringAsync(
+  const QString& code, ctkAbstractPythonManager::ExecuteStringMode mode)
+{
+  Q_D(ctkAbstractPythonManager);
+  int start = -1;
+  switch(mode)
+    {
+    case ctkAbstractPythonManager::FileInput: start = Py_file_input; break;
+    case ctkAbstractPythonManager::SingleInput: start = Py_single_input; break;
+    case ctkAbstractPythonManager::EvalInput:
+    default: start = Py_eval_input; break;
+    }
+  return d->executeAsync(code, start);
+}
+
+//-----------------------------------------------------------------------------
+QFuture<QVariant> ctkAbstractPythonManager::executeFileAsync(const QString& filename)
+{
+  Q_D(ctkAbstractPythonManager);
+  return d->executeAsync(d->executeFileCode(filename), Py_file_input);
+}
+
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManager::waitForAsyncExecution()
+{
+  Q_D(ctkAbstractPythonManager);
+  forever
+    {
+    {
+    QMutexLocker locker(&d->AsyncMutex);
+    if (d->PendingAsyncRequests == 0)
+      {
+      break;
+      }
+    }
+    d->yieldGIL(100);
+    }
+  d->AsyncTimer.stop();
+}
+
+//-----------------------------------------------------------------------------
+void ctkAbstractPythonManager::yieldToAsyncExecution()
+{
+  Q_D(ctkAbstractPythonManager);
+  {
+  QMutexLocker locker(&d->AsyncMutex);
+  if (d->PendingAsyncRequests == 0)
+    {
+    d->AsyncTimer.stop();
+    return;
+    }
+  }
+  // the python thread runs for about half of the time
+  d->yieldGIL(d->AsyncTimer.interval());
+}
+
 //-----------------------------------------------------------------------------
 void ctkAbstractPythonManager::setInitializationFunction(void (*initFunction)())
 {
@@ -343,6 +664,8 @@ QStringList ctkAbstractPythonManager::pythonAttributes(const QString& pythonVari
                                                        const QString& module,
                                                        bool appendParenthesis) const
 {
+  Q_D(const ctkAbstractPythonManager);
+  d->registerPendingClasses();
   Q_ASSERT(PyThreadState_GET()->interp);
   PyObject* dict = PyImport_GetModuleDict();
 
@@ -22,6 +22,7 @@
 #define __ctkAbstractPythonManager_h
 
 // Qt includes
+#include <QFuture>
 #include <QObject>
 #include <QList>
 #include <QStringList>
@@ -56,7 +57,15 @@ public:
   /// Return \a True if python has been successfully initialized.
   /// \sa setInitializationFlags, mainContext, isPythonInitialized
   /// \sa preInitialization, executeInitializationScripts, pythonPreInitialized, pythonInitialized
-  bool initialize();
+  Q_INVOKABLE bool initialize();
+
+  /// Schedule initialize() from the event loop and return immediately, so
+  /// that the application can show its GUI before python is initialized.
+  /// Python is still initialized in the main thread: PythonQt and the
+  /// initialization scripts create objects that must live in that thread.
+  /// Calling any function requiring python initializes it right away.
+  /// \sa queueString, queueFile
+  void initializeLater();
 
   /// Return a reference to the python main context.
   /// Calling this function implicitly call initialize() if it hasn't been done.
@@ -65,9 +74,22 @@ public:
   void addObjectToPythonMain(const QString& name, QObject* obj);
   void addWrapperFactory(PythonQtForeignWrapperFactory* factory);
   void registerPythonQtDecorator(QObject* decorator);
+
+  /// The classes registered before python is initialized are registered
+  /// with PythonQt when it is initialized, before preInitialization().
+  /// \sa setDeferredClassRegistration
   void registerClassForPythonQt(const QMetaObject* metaobject);
   void registerCPPClassForPythonQt(const char* name);
 
+  /// If enabled, registerClassForPythonQt() and registerCPPClassForPythonQt()
+  /// only record the classes. They are registered with PythonQt all at once
+  /// the next time python code is executed or inspected through this manager
+  /// (e.g. executeString(), pythonAttributes() or mainContext()), so that
+  /// applications registering many wrappers at startup only pay for them
+  /// once python is used. Disabled by default.
+  void setDeferredClassRegistration(bool deferred);
+  bool deferredClassRegistration()const;
+
   /// \sa PythonQt::systemExitExceptionHandlerEnabled
   bool systemExitExceptionHandlerEnabled()const;
 
@@ -96,6 +118,31 @@ public:
   /// Execute a python script with the given filename.
   void executeFile(const QString& filename);
 
+  /// Execute the code, or the script, right away if python is initialized.
+  /// Otherwise the request is queued and executed, in the order of the
+  /// requests, once python is initialized and pythonInitialized() has been
+  /// emitted. This doesn't trigger the initialization.
+  /// \sa initializeLater
+  void queueString(const QString& code, ExecuteStringMode mode = FileInput);
+  void queueFile(const QString& filename);
+
+  /// Execute the code, or the script, on a dedicated python thread and
+  /// return the future result of the execution. The requests are executed
+  /// one at a time, in order. The output is written through printStdout()
+  /// and printStderr() as it comes.
+  /// While requests are pending, the main thread holds the GIL only
+  /// outside of the time slices it regularly hands to the python thread
+  /// from the event loop, so that the GUI stays responsive. Do not block
+  /// the main thread on the future (e.g. with QFuture::waitForFinished()),
+  /// watch it with a QFutureWatcher or call waitForAsyncExecution().
+  /// \sa executeString, executeFile
+  QFuture<QVariant> executeStringAsync(const QString& code, ExecuteStringMode mode = FileInput);
+  QFuture<QVariant> executeFileAsync(const QString& filename);
+
+  /// Block until the requests of executeStringAsync() and
+  /// executeFileAsync() are executed, releasing the GIL meanwhile.
+  void waitForAsyncExecution();
+
   /// Set function that is initialized after preInitialization and before executeInitializationScripts
   /// \sa preInitialization executeInitializationScripts
   void setInitializationFunction(void (*initFunction)());
@@ -141,6 +188,10 @@ protected Q_SLOTS:
   void printStderr(const QString&);
   void printStdout(const QString&);
 
+  /// Hand the GIL to the python thread for a time slice, called
+  /// periodically while asynchronous requests are pending.
+  void yieldToAsyncExecution();
+
 protected:
 
   void initPythonQt(int flags);
@@ -51,6 +51,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Qt includes
 #include <QAbstractItemView>
 #include <QCoreApplication>
+#include <QHash>
 #include <QIcon>
 #include <QResizeEvent>
 #include <QScrollBar>
@@ -90,13 +91,11 @@ public:
 
   virtual void updateCompletionModel(const QString& completion)
     {
-    // Start by clearing the model
-    this->setModel(0);
-
-    // Don't try to complete the empty string
-    if (completion.isEmpty())
+    // A new completion is requested, the namespaces may have been changed by
+    // code executed outside of the console.
+    if (!this->popup()->isVisible())
       {
-      return;
+      this->clearAttributesCache();
       }
 
     // Search backward through the string for usable characters
@@ -124,15 +123,31 @@ public:
       compareText = compareText.mid(dot+1);
       }
 
+    // While typing the name of an attribute (after a dot, where no preferred
+    // completion applies), only the prefix changes: the model is kept.
+    if (this->model() && !lookup.isEmpty() && !compareText.isEmpty() &&
+        lookup == this->ModelLookup && this->AttributesCache.contains(lookup))
+      {
+      this->setCompletionPrefix(compareText.toLower());
+      this->popup()->setCurrentIndex(this->completionModel()->index(0, 0));
+      return;
+      }
+
+    // Start by clearing the model
+    this->setModel(0);
+    this->ModelLookup = QString();
+
+    // Don't try to complete the empty string
+    if (completion.isEmpty())
+      {
+      return;
+      }
+
     // Lookup python names
     QStringList attrs;
     if (!lookup.isEmpty() || !compareText.isEmpty())
       {
-      bool appendParenthesis = true;
-      attrs = this->PythonManager.pythonAttributes(lookup, QLatin1String("__main__"), appendParenthesis);
-      attrs << this->PythonManager.pythonAttributes(lookup, QLatin1String("__main__.__builtins__"),
-                                                    appendParenthesis);
-      attrs.removeDuplicates();
+      attrs = this->pythonAttributes(lookup);
       }
 
     // Initialize the completion model
@@ -140,6 +155,7 @@ public:
       {
       this->setCompletionMode(QCompleter::PopupCompletion);
       this->setModel(new QStringListModel(attrs, this));
+      this->ModelLookup = lookup;
       this->setCaseSensitivity(Qt::CaseInsensitive);
       this->setCompletionPrefix(compareText.toLower());
       
@@ -191,7 +207,38 @@ public:
       this->popup()->setCurrentIndex(preferredIndex);
       }
     }
+
+  /// Attributes of \a lookup in __main__ and its builtins. Introspecting
+  /// large modules is slow, the lists are cached until clearAttributesCache()
+  /// is called.
+  QStringList pythonAttributes(const QString& lookup)
+    {
+    QHash<QString, QStringList>::const_iterator it =
+      this->AttributesCache.constFind(lookup);
+    if (it != this->AttributesCache.constEnd())
+      {
+      return it.value();
+      }
+    bool appendParenthesis = true;
+    QStringList attrs = this->PythonManager.pythonAttributes(
+      lookup, QLatin1String("__main__"), appendParenthesis);
+    attrs << this->PythonManager.pythonAttributes(
+      lookup, QLatin1String("__main__.__builtins__"), appendParenthesis);
+    attrs.removeDuplicates();
+    this->AttributesCache.insert(lookup, attrs);
+    return attrs;
+    }
+
+  /// To call when code is executed
+  void clearAttributesCache()
+    {
+    this->AttributesCache.clear();
+    }
+
   ctkAbstractPythonManager& PythonManager;
+  QHash<QString, QStringList> AttributesCache;
+  /// Lookup of the attributes of the current model
+  QString ModelLookup;
 };
 
 //----------------------------------------------------------------------------
@@ -421,6 +468,13 @@ void ctkPythonConsole::executeCommand(const QString& command)
 {
   Q_D(ctkPythonConsole);
   d->MultilineStatement = d->push(command);
+  // The command may have added, removed or modified python objects
+  ctkPythonConsoleCompleter* pythonCompleter =
+    dynamic_cast<ctkPythonConsoleCompleter*>(this->completer());
+  if (pythonCompleter)
+    {
+    pythonCompleter->clearAttributesCache();
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,156 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkInteractionBenchmark_h
+#define __ctkInteractionBenchmark_h
+
+// Qt includes
+#include <QCoreApplication>
+#include <QFile>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <QWidget>
+
+// CTK includes
+#include "ctkHighPrecisionTimer.h"
+
+// STD includes
+#include <algorithm>
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+/// \ingroup Testing
+/// Collects the timings of scripted widget interactions.
+/// The event-processing latency of an interaction is the time from start()
+/// until stop() returns, stop() processing all the events the interaction
+/// posted. The frame time of a widget is the duration of a synchronous
+/// repaint(). The samples are summarized per widget and metric by toJSON().
+class ctkInteractionBenchmark
+{
+public:
+  ctkInteractionBenchmark(const QString& suite)
+    : Suite(suite)
+  {
+  }
+
+  /// Start timing an interaction
+  void start()
+  {
+    this->Timer.start();
+  }
+
+  /// Process the pending events and record the time elapsed since start()
+  /// as the \a metric latency of \a widget.
+  void stop(const QString& widget, const QString& metric)
+  {
+    QCoreApplication::sendPostedEvents();
+    QCoreApplication::processEvents();
+    this->addSample(widget, metric, this->Timer.elapsedMicro());
+  }
+
+  /// Repaint \a w synchronously and record the time it took as a "frame"
+  /// sample of \a widget.
+  void recordFrame(const QString& widget, QWidget* w)
+  {
+    ctkHighPrecisionTimer frameTimer;
+    frameTimer.start();
+    w->repaint();
+    this->addSample(widget, "frame", frameTimer.elapsedMicro());
+  }
+
+  void addSample(const QString& widget, const QString& metric, qint64 microseconds)
+  {
+    QVector<qint64>& samples = this->Samples[widget][metric];
+    samples.push_back(microseconds);
+  }
+
+  /// Number of samples recorded for \a metric of \a widget
+  int count(const QString& widget, const QString& metric)const
+  {
+    return this->Samples.value(widget).value(metric).count();
+  }
+
+  /// Summary (count, mean, median, p95 and max in milliseconds) of all the
+  /// recorded metrics.
+  QString toJSON()const
+  {
+    QString json;
+    QTextStream out(&json);
+    out << "{\n  \"suite\": \"" << this->Suite << "\",\n  \"widgets\": {";
+    QStringList widgets = this->Samples.keys();
+    for (int i = 0; i < widgets.count(); ++i)
+      {
+      out << (i ? "," : "") << "\n    \"" << widgets[i] << "\": {";
+      const QMap<QString, QVector<qint64> >& metrics = this->Samples[widgets[i]];
+      QStringList names = metrics.keys();
+      for (int j = 0; j < names.count(); ++j)
+        {
+        QVector<qint64> samples = metrics[names[j]];
+        std::sort(samples.begin(), samples.end());
+        double sum = 0.;
+        for (int k = 0; k < samples.count(); ++k)
+          {
+          sum += samples[k];
+          }
+        int n = samples.count();
+        out << (j ? "," : "") << "\n      \"" << names[j] << "\": {"
+            << "\"count\": " << n
+            << ", \"mean_ms\": " << (n ? sum / n / 1000. : 0.)
+            << ", \"median_ms\": " << (n ? samples[n / 2] / 1000. : 0.)
+            << ", \"p95_ms\": " << (n ? samples[(n * 95 - 1) / 100] / 1000. : 0.)
+            << ", \"max_ms\": " << (n ? samples[n - 1] / 1000. : 0.)
+            << "}";
+        }
+      out << "\n    }";
+      }
+    out << "\n  }\n}\n";
+    out.flush();
+    return json;
+  }
+
+  /// Write toJSON() into \a fileName, or on the standard output if
+  /// \a fileName is empty.
+  bool writeJSON(const QString& fileName = QString())const
+  {
+    if (fileName.isEmpty())
+      {
+      std::cout << qPrintable(this->toJSON()) << std::flush;
+      return true;
+      }
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+      {
+      std::cerr << "Failed to open " << qPrintable(fileName) << std::endl;
+      return false;
+      }
+    QTextStream(&file) << this->toJSON();
+    return true;
+  }
+
+private:
+  QString Suite;
+  ctkHighPrecisionTimer Timer;
+  QMap<QString, QMap<QString, QVector<qint64> > > Samples;
+};
+
+#endif
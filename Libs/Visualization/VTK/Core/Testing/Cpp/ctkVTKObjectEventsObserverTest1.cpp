@@ -69,7 +69,23 @@ int ctkVTKObjectEventsObserverTest1( int argc, char * argv [] )
   double t1 = timerLog->GetElapsedTime();
   qDebug() << events << "events listened by" << objects << "objects (ctkVTKConnection): " << t1 << "seconds";
 
+  // Only the connections of obj are removed
+  vtkObject* obj2 = vtkObject::New();
+  observer->addConnection(obj2, vtkCommand::ModifiedEvent,
+    topObject, SLOT(deleteLater()));
+  int removed = observer->removeAllConnections(obj);
+  if (removed != objects ||
+      observer->containsConnection(obj) ||
+      !observer->containsConnection(obj2, vtkCommand::ModifiedEvent,
+                                    topObject, SLOT(deleteLater())))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with removeAllConnections(vtkObject*): "
+              << removed << " connections removed instead of " << objects << std::endl;
+    return EXIT_FAILURE;
+    }
+
   obj->Delete();
+  obj2->Delete();
 
   delete topObject;
   
@@ -250,6 +250,43 @@ bool ctkVTKObjectTest::test()
     }
   this->resetSlotCalls();
 
+  // Compressed connection: the events are coalesced into one queued slot call
+  QString connection = this->qvtkConnect(object, vtkCommand::ModifiedEvent,
+                                         this, SLOT(onVTKObjectModifiedPublic()));
+  this->qvtkCompress(connection, true);
+  object->Modified();
+  object->Modified();
+  if (d->PublicSlotCalled != 0)
+    {
+    qDebug() << __LINE__ << "qvtkCompress failed" << d->PublicSlotCalled;
+    return false;
+    }
+  QCoreApplication::processEvents();
+  if (d->PublicSlotCalled != 1)
+    {
+    qDebug() << __LINE__ << "qvtkCompress failed" << d->PublicSlotCalled;
+    return false;
+    }
+  this->resetSlotCalls();
+  QCoreApplication::processEvents();
+  if (d->PublicSlotCalled != 0)
+    {
+    qDebug() << __LINE__ << "qvtkCompress failed" << d->PublicSlotCalled;
+    return false;
+    }
+  // Pending events are dropped when the connection is blocked
+  object->Modified();
+  this->qvtkBlock(connection, true);
+  QCoreApplication::processEvents();
+  if (d->PublicSlotCalled != 0)
+    {
+    qDebug() << __LINE__ << "qvtkCompress failed" << d->PublicSlotCalled;
+    return false;
+    }
+  this->qvtkDisconnect(object, vtkCommand::ModifiedEvent,
+                       this, SLOT(onVTKObjectModifiedPublic()));
+  this->resetSlotCalls();
+
   disconnected = this->qvtkDisconnectAll();
   if (disconnected != 0)
     {
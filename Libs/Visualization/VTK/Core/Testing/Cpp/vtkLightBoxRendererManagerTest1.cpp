@@ -230,6 +230,29 @@ int vtkLightBoxRendererManagerTest1(int argc, char* argv[])
   lightBoxRendererManager->SetHighlightedBoxColor(highlightedBoxColor);
 
   int retval = vtkRegressionTestImage(rw.GetPointer());
+
+  // The cached tiles must look like the slices mapped by the renderers
+  if (retval == vtkRegressionTester::PASSED)
+    {
+    // The tiles are mapped in parallel
+    lightBoxRendererManager->SetTileThreadCount(4);
+    lightBoxRendererManager->SetTileReadAhead(1);
+    lightBoxRendererManager->SetTileCaching(true);
+    retval = vtkRegressionTestImage(rw.GetPointer());
+    if (lightBoxRendererManager->GetTileCacheMemoryUsage() == 0)
+      {
+      std::cerr << "line " << __LINE__ << " - Problem with SetTileCaching()" << std::endl;
+      return EXIT_FAILURE;
+      }
+    lightBoxRendererManager->SetTileCacheMemoryBudget(0);
+    if (lightBoxRendererManager->GetTileCacheMemoryUsage() == 0)
+      {
+      std::cerr << "line " << __LINE__
+                << " - Problem with SetTileCacheMemoryBudget(): displayed tiles removed"
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
   if (retval == vtkRegressionTester::DO_INTERACTOR)
     {
     rw->GetInteractor()->Initialize();
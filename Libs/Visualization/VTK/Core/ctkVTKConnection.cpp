@@ -20,10 +20,13 @@
 
 // Qt includes
 #include <QDebug>
+#include <QMetaObject>
+#include <QMutexLocker>
 #include <QPointer>
 #include <QRegExp>
 #include <QString>
 #include <QTextStream>
+#include <QTimer>
 
 // CTK includes
 #include "ctkVTKConnection.h"
@@ -61,6 +64,13 @@ ctkVTKConnectionPrivate::ctkVTKConnectionPrivate(ctkVTKConnection& object)
   this->Blocked     = false;
   this->Id          = convertPointerToString(this);
   this->ObserveDeletion = false;
+  this->Compressed  = false;
+  this->CompressionInterval = 0;
+  this->CompressedEventPending = false;
+  this->PendingEvent = vtkCommand::NoEvent;
+  this->PendingClientData = 0;
+  this->PendingCallData = 0;
+  this->CompressionTimer = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -394,39 +404,18 @@ void ctkVTKConnectionPrivate::execute(vtkObject* vtk_obj, unsigned long vtk_even
     return; 
     }
 
+  if (this->Compressed && vtk_event != vtkCommand::DeleteEvent)
+    {
+    this->compressExecute(vtk_event, client_data, call_data);
+    return;
+    }
+
   QPointer<ctkVTKConnection> connection(q);
   if(!this->ObserveDeletion ||
      vtk_event != vtkCommand::DeleteEvent ||
      this->VTKEvent == vtkCommand::DeleteEvent)
     {
-    vtkObject* callDataAsVtkObject = 0;
-    switch (this->SlotType)
-      {
-      case ctkVTKConnectionPrivate::ARG_VTKOBJECT_AND_VTKOBJECT:
-        if (this->VTKEvent == vtk_event)
-          {
-          callDataAsVtkObject = reinterpret_cast<vtkObject*>( call_data );
-          if (!callDataAsVtkObject)
-            {
-            qCritical() << "The VTKEvent(" << this->VTKEvent<< ") triggered by vtkObject("
-              << this->VTKObject->GetClassName() << ") "
-              << "doesn't return data of type vtkObject." << endl
-              << "The slot (" << this->QtSlot <<  ") owned by "
-              << "QObject(" << this->QtObject->objectName() << ")"
-              << " may be incorrect.";
-            }
-          emit q->emitExecute(vtk_obj, callDataAsVtkObject);
-          }
-        break;
-      case ctkVTKConnectionPrivate::ARG_VTKOBJECT_VOID_ULONG_VOID:
-        emit q->emitExecute(vtk_obj, call_data, vtk_event, client_data);
-        break;
-      default:
-        // Should never reach
-        qCritical() << "Unknown SlotType:" << this->SlotType;
-        return;
-        break;
-      }
+    this->emitExecute(vtk_obj, vtk_event, client_data, call_data);
     }
 
   if (!connection.isNull() &&
@@ -436,6 +425,60 @@ void ctkVTKConnectionPrivate::execute(vtkObject* vtk_obj, unsigned long vtk_even
     }
 }
 
+//-----------------------------------------------------------------------------
+void ctkVTKConnectionPrivate::emitExecute(vtkObject* vtk_obj, unsigned long vtk_event,
+  void* client_data, void* call_data)
+{
+  Q_Q(ctkVTKConnection);
+  vtkObject* callDataAsVtkObject = 0;
+  switch (this->SlotType)
+    {
+    case ctkVTKConnectionPrivate::ARG_VTKOBJECT_AND_VTKOBJECT:
+      if (this->VTKEvent == vtk_event)
+        {
+        callDataAsVtkObject = reinterpret_cast<vtkObject*>( call_data );
+        if (!callDataAsVtkObject)
+          {
+          qCritical() << "The VTKEvent(" << this->VTKEvent<< ") triggered by vtkObject("
+            << this->VTKObject->GetClassName() << ") "
+            << "doesn't return data of type vtkObject." << endl
+            << "The slot (" << this->QtSlot <<  ") owned by "
+            << "QObject(" << this->QtObject->objectName() << ")"
+            << " may be incorrect.";
+          }
+        emit q->emitExecute(vtk_obj, callDataAsVtkObject);
+        }
+      break;
+    case ctkVTKConnectionPrivate::ARG_VTKOBJECT_VOID_ULONG_VOID:
+      emit q->emitExecute(vtk_obj, call_data, vtk_event, client_data);
+      break;
+    default:
+      // Should never reach
+      qCritical() << "Unknown SlotType:" << this->SlotType;
+      break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKConnectionPrivate::compressExecute(unsigned long vtk_event,
+  void* client_data, void* call_data)
+{
+  Q_Q(ctkVTKConnection);
+  QMutexLocker locker(&this->CompressionMutex);
+  this->PendingEvent = vtk_event;
+  this->PendingClientData = client_data;
+  this->PendingCallData = call_data;
+  if (this->CompressedEventPending)
+    {
+    // Coalesced with the event already pending
+    return;
+    }
+  this->CompressedEventPending = true;
+  // The event can be invoked from any thread, the slot is called from the
+  // thread of the connection.
+  QMetaObject::invokeMethod(q, "executeCompressedEvent", Qt::QueuedConnection);
+}
+
 //-----------------------------------------------------------------------------
 void ctkVTKConnection::observeDeletion(bool enable)
 {
@@ -450,6 +493,78 @@ bool ctkVTKConnection::deletionObserved()const
   return d->ObserveDeletion;
 }
 
+//-----------------------------------------------------------------------------
+void ctkVTKConnection::setCompressed(bool compress)
+{
+  Q_D(ctkVTKConnection);
+  d->Compressed = compress;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkVTKConnection::isCompressed()const
+{
+  Q_D(const ctkVTKConnection);
+  return d->Compressed;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKConnection::setCompressionInterval(int msecs)
+{
+  Q_D(ctkVTKConnection);
+  d->CompressionInterval = qMax(0, msecs);
+}
+
+//-----------------------------------------------------------------------------
+int ctkVTKConnection::compressionInterval()const
+{
+  Q_D(const ctkVTKConnection);
+  return d->CompressionInterval;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKConnection::executeCompressedEvent()
+{
+  Q_D(ctkVTKConnection);
+
+  // Rate limit the slot calls
+  if (d->CompressionInterval > 0 && d->LastCompressedExecute.isValid() &&
+      d->LastCompressedExecute.elapsed() < d->CompressionInterval)
+    {
+    if (!d->CompressionTimer)
+      {
+      d->CompressionTimer = new QTimer(this);
+      d->CompressionTimer->setSingleShot(true);
+      QObject::connect(d->CompressionTimer, SIGNAL(timeout()),
+                       this, SLOT(executeCompressedEvent()));
+      }
+    d->CompressionTimer->start(
+      d->CompressionInterval - static_cast<int>(d->LastCompressedExecute.elapsed()));
+    return;
+    }
+
+  unsigned long vtk_event;
+  void* client_data;
+  void* call_data;
+    {
+    QMutexLocker locker(&d->CompressionMutex);
+    if (!d->CompressedEventPending)
+      {
+      return;
+      }
+    d->CompressedEventPending = false;
+    vtk_event = d->PendingEvent;
+    client_data = d->PendingClientData;
+    call_data = d->PendingCallData;
+    }
+
+  if (!d->Connected || d->Blocked || !d->VTKObject)
+    {
+    return;
+    }
+  d->LastCompressedExecute.start();
+  d->emitExecute(d->VTKObject, vtk_event, client_data, call_data);
+}
+
 //-----------------------------------------------------------------------------
 void ctkVTKConnection::disconnect()
 {
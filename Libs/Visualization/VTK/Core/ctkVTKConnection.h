@@ -98,6 +98,24 @@ public:
   /// false by default, it is slower to observe vtk object deletion
   void observeDeletion(bool enable);
   bool deletionObserved()const;
+
+  /// Coalesce the events sent by the vtkObject into one slot call.
+  /// When compressed, the events invoked before the slot is called are not
+  /// sent separately: the slot is called once, from the event loop of the
+  /// connection thread, with the call data of the last event. The call data
+  /// must then stay valid until the slot is called, as with queued
+  /// connections. DeleteEvent is never compressed.
+  /// false by default.
+  /// \sa setCompressionInterval()
+  void setCompressed(bool compress);
+  bool isCompressed()const;
+
+  /// Set the minimum number of milliseconds between two slot calls of a
+  /// compressed connection, the events invoked meanwhile are coalesced.
+  /// 0 by default: the slot is called in the next event loop pass.
+  /// \sa setCompressed()
+  void setCompressionInterval(int msecs);
+  int compressionInterval()const;
   
 Q_SIGNALS:
   /// 
@@ -114,6 +132,8 @@ Q_SIGNALS:
 protected Q_SLOTS:
   void vtkObjectDeleted();
   void qobjectDeleted();
+  /// Call the slot with the pending compressed event
+  void executeCompressedEvent();
 
 protected:
   QScopedPointer<ctkVTKConnectionPrivate> d_ptr;
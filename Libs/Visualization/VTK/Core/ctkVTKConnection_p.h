@@ -22,8 +22,11 @@
 #define __ctkVTKConnection_p_h
 
 // Qt includes
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QString>
 class QObject;
+class QTimer;
 
 // CTK includes
 #include "ctkVTKConnection.h"
@@ -70,6 +73,13 @@ public:
   /// Called by 'DoCallback' to emit signal
   void execute(vtkObject* vtk_obj, unsigned long vtk_event, void* client_data, void* call_data);
 
+  /// Emit the signal corresponding to the slot
+  void emitExecute(vtkObject* vtk_obj, unsigned long vtk_event, void* client_data, void* call_data);
+
+  /// Keep the event as the pending compressed event, and schedule its
+  /// delivery if no event is pending yet.
+  void compressExecute(unsigned long vtk_event, void* client_data, void* call_data);
+
   vtkSmartPointer<vtkCallbackCommand> Callback;
   vtkWeakPointer<vtkObject>           VTKObject;
   const QObject*                      QtObject;
@@ -82,6 +92,17 @@ public:
   bool                                Blocked;
   QString                             Id;
   bool                                ObserveDeletion;
+
+  bool                                Compressed;
+  int                                 CompressionInterval;
+  /// Protects the pending event, that can be set from any thread
+  QMutex                              CompressionMutex;
+  bool                                CompressedEventPending;
+  unsigned long                       PendingEvent;
+  void*                               PendingClientData;
+  void*                               PendingCallData;
+  QTimer*                             CompressionTimer;
+  QElapsedTimer                       LastCompressedExecute;
 };
 
 #endif
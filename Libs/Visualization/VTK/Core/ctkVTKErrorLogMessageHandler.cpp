@@ -80,7 +80,7 @@ void ctkVTKOutputWindow::DisplayText(const char* text)
   ctkErrorLogContext context;
   QString textOnly = this->parseText(text, context);
 
-  this->MessageHandler->handleMessage(
+  this->MessageHandler->bufferMessage(
         ctk::qtHandleToString(QThread::currentThreadId()),
         ctkErrorLogLevel::Info,
         this->MessageHandler->handlerPrettyName(), context, textOnly);
@@ -94,7 +94,7 @@ void ctkVTKOutputWindow::DisplayErrorText(const char* text)
   ctkErrorLogContext context;
   QString textOnly = this->parseText(text, context);
 
-  this->MessageHandler->handleMessage(
+  this->MessageHandler->bufferMessage(
         ctk::qtHandleToString(QThread::currentThreadId()),
         ctkErrorLogLevel::Error,
         this->MessageHandler->handlerPrettyName(), context, textOnly);
@@ -108,7 +108,7 @@ void ctkVTKOutputWindow::DisplayWarningText(const char* text)
   ctkErrorLogContext context;
   this->parseText(text, context);
 
-  this->MessageHandler->handleMessage(
+  this->MessageHandler->bufferMessage(
         ctk::qtHandleToString(QThread::currentThreadId()),
         ctkErrorLogLevel::Warning,
         this->MessageHandler->handlerPrettyName(), context, text);
@@ -128,7 +128,7 @@ void ctkVTKOutputWindow::DisplayDebugText(const char* text)
   ctkErrorLogContext context;
   this->parseText(text, context);
 
-  this->MessageHandler->handleMessage(
+  this->MessageHandler->bufferMessage(
         ctk::qtHandleToString(QThread::currentThreadId()),
         ctkErrorLogLevel::Debug,
         this->MessageHandler->handlerPrettyName(), context, text);
@@ -126,6 +126,22 @@ int qvtkDisconnectAll()                                                 \
   return MyQVTK.removeAllConnections();                                 \
 }
 
+//-----------------------------------------------------------------------------
+/// Define qvtkDisconnectAll(vtkObject* vtk_obj)
+/// \sa qvtkDisconnectAll(), QVTK_OBJECT
+#define QVTK_OBJECT_REMOVEALL_CONNECTION_METHOD2                        \
+/** \brief Disconnect all the connections of \a vtk_obj.*/              \
+/** Utility function that calls removeAllConnections(vtkObject*) on */  \
+/** ctkVTKObjectEventsObserver. Only the connections of \a vtk_obj are*/ \
+/** visited. */                                                         \
+/** \sa ctkVTKObjectEventsObserver::removeAllConnections(vtkObject*),*/ \
+/** qvtkConnect(), qvtkReconnect(), qvtkDisconnect() */                 \
+/** qvtkIsConnected(), QVTK_OBJECT_REMOVEALL_CONNECTION_METHOD2 */      \
+int qvtkDisconnectAll(vtkObject* vtk_obj)                               \
+{                                                                       \
+  return MyQVTK.removeAllConnections(vtk_obj);                          \
+}
+
 //-----------------------------------------------------------------------------
 /// Define qvtkIsConnected()
 /// \sa qvtkIsConnected(), QVTK_OBJECT
@@ -165,6 +181,15 @@ void qvtkBlock(const QString& id, bool blocked)                          \
   MyQVTK.blockConnection(id, blocked);                                   \
 }
 
+//-----------------------------------------------------------------------------
+/// Define qvtkCompress(const QString& id, bool compress, int interval)
+/// \sa qvtkCompress(), QVTK_OBJECT
+#define QVTK_OBJECT_COMPRESS_CONNECTION_METHOD                           \
+void qvtkCompress(const QString& id, bool compress, int interval = 0)    \
+{                                                                        \
+  MyQVTK.compressConnection(id, compress, interval);                     \
+}
+
 //-----------------------------------------------------------------------------
 /// Define qvtkBlockAll()
 /// \sa qvtkBlockAll(), QVTK_OBJECT
@@ -213,8 +238,10 @@ bool qvtkUnblockAll()                                                   \
 /// qvtkReconnect(),qvtkDisconnect(), qvtkDisconnectAll(), qvtkIsConnected(),
 /// QVTK_OBJECT_ADD_CONNECTION_METHOD, QVTK_OBJECT_RECONNECT_METHOD,
 /// QVTK_OBJECT_RECONNECT_METHOD_2, QVTK_OBJECT_REMOVE_CONNECTION_METHOD,
-/// QVTK_OBJECT_REMOVEALL_CONNECTION_METHOD, QVTK_OBJECT_IS_CONNECTION_METHOD,
+/// QVTK_OBJECT_REMOVEALL_CONNECTION_METHOD,
+/// QVTK_OBJECT_REMOVEALL_CONNECTION_METHOD2, QVTK_OBJECT_IS_CONNECTION_METHOD,
 /// QVTK_OBJECT_BLOCK_CONNECTION_METHOD, QVTK_OBJECT_BLOCK_CONNECTION_METHOD2,
+/// QVTK_OBJECT_COMPRESS_CONNECTION_METHOD,
 /// QVTK_OBJECT_UNBLOCK_CONNECTION_METHOD,
 /// QVTK_OBJECT_BLOCKALL_CONNECTION_METHOD,
 /// QVTK_OBJECT_BLOCKALL_CONNECTION_METHOD2,
@@ -226,9 +253,11 @@ protected:                                         \
   QVTK_OBJECT_RECONNECT_METHOD_2                   \
   QVTK_OBJECT_REMOVE_CONNECTION_METHOD             \
   QVTK_OBJECT_REMOVEALL_CONNECTION_METHOD          \
+  QVTK_OBJECT_REMOVEALL_CONNECTION_METHOD2         \
   QVTK_OBJECT_IS_CONNECTION_METHOD                 \
   QVTK_OBJECT_BLOCK_CONNECTION_METHOD              \
   QVTK_OBJECT_BLOCK_CONNECTION_METHOD2             \
+  QVTK_OBJECT_COMPRESS_CONNECTION_METHOD           \
   QVTK_OBJECT_UNBLOCK_CONNECTION_METHOD            \
   QVTK_OBJECT_BLOCKALL_CONNECTION_METHOD           \
   QVTK_OBJECT_BLOCKALL_CONNECTION_METHOD2          \
@@ -19,12 +19,14 @@
 =========================================================================*/
 
 // Qt includes
+#include <QChildEvent>
 #include <QStringList>
 #include <QVariant>
 #include <QList>
 #include <QHash>
 #include <QDebug>
-#include <QMultiMap>
+#include <QMultiHash>
+#include <QPair>
 
 // CTK includes
 #include "ctkVTKObjectEventsObserver.h"
@@ -83,12 +85,29 @@ class ctkVTKObjectEventsObserverPrivate
 protected:
   ctkVTKObjectEventsObserver* const q_ptr;
 public:
-  /// ConnectionIndexType:
-  ///  key = hash (generated from the connection parameters)
-  ///  value = QT connection object name
-  typedef QMultiMap<unsigned long, ctkVTKConnection*> ConnectionIndexType;
+  /// Keys of a connection in the indexes
+  struct ConnectionKeys
+  {
+    QString Id;
+    vtkObject* VTKObject;
+    unsigned long VTKEvent;
+    const QObject* QtObject;
+  };
+  typedef QPair<QPair<vtkObject*, unsigned long>, const QObject*> ConnectionKeyType;
+  static ConnectionKeyType connectionKey(vtkObject* vtk_obj, unsigned long vtk_event,
+                                         const QObject* qt_obj)
+  {
+    return ConnectionKeyType(QPair<vtkObject*, unsigned long>(vtk_obj, vtk_event), qt_obj);
+  }
   ctkVTKObjectEventsObserverPrivate(ctkVTKObjectEventsObserver& object);
 
+  /// Add \a connection to the indexes, once set up
+  void indexConnection(ctkVTKConnection* connection, vtkObject* vtk_obj,
+                       unsigned long vtk_event, const QObject* qt_obj);
+  /// Remove \a connection from the indexes. The connection can be partially
+  /// destroyed, it is not dereferenced.
+  void unindexConnection(QObject* connection);
+
   ///
   /// Return a reference toward the corresponding connection or 0 if doesn't exist
   ctkVTKConnection* findConnection(const QString& id)const;
@@ -109,25 +128,19 @@ public:
     return q->findChildren<ctkVTKConnection*>();
   }
 
-  /// Generate a number from the connection parameters that is most often
-  /// unique for each connection. The slot parameter is not used, as probably
-  /// the same objects with the same event are not connected to different slot.
-  static unsigned long generateConnectionIndexHash(const vtkObject* vtk_obj, unsigned long vtk_event, const QObject* qt_obj)
-  {
-    return reinterpret_cast<const unsigned char*>(vtk_obj)-reinterpret_cast<const unsigned char*>(qt_obj)+vtk_event;
-  }
-
   bool StrictTypeCheck;
   bool AllBlocked;
   bool ObserveDeletion;
 
-  /// An associative container to speed up findConnection.
+  /// Associative containers to speed up findConnection(s).
   /// No need to iterate through all the existing connections and check if it is
-  /// equal with the searched one.
-  /// All the connections are present in the index (to allow quick decision that
-  /// a connection does not exist), but a lazy deletion method is used (items
-  /// not necessarily removed from the index immediately when a connection is deleted).
-  mutable ConnectionIndexType ConnectionIndex;
+  /// equal with the searched one when the vtkObject or the id is known.
+  /// The indexes are updated when a connection is added and when it is
+  /// deleted, whoever deletes it.
+  QHash<QString, ctkVTKConnection*> ConnectionsById;
+  QMultiHash<vtkObject*, ctkVTKConnection*> ConnectionsByObject;
+  QMultiHash<ConnectionKeyType, ctkVTKConnection*> ConnectionsByKey;
+  QHash<QObject*, ConnectionKeys> IndexedConnections;
 };
 
 //-----------------------------------------------------------------------------
@@ -143,17 +156,44 @@ ctkVTKObjectEventsObserverPrivate::ctkVTKObjectEventsObserverPrivate(ctkVTKObjec
 }
 
 //-----------------------------------------------------------------------------
-ctkVTKConnection*
-ctkVTKObjectEventsObserverPrivate::findConnection(const QString& id)const
+void ctkVTKObjectEventsObserverPrivate::indexConnection(
+  ctkVTKConnection* connection, vtkObject* vtk_obj, unsigned long vtk_event,
+  const QObject* qt_obj)
 {
-  foreach(ctkVTKConnection* connection, this->connections())
+  ConnectionKeys keys;
+  keys.Id = connection->id();
+  keys.VTKObject = vtk_obj;
+  keys.VTKEvent = vtk_event;
+  keys.QtObject = qt_obj;
+  this->IndexedConnections.insert(connection, keys);
+  this->ConnectionsById.insert(keys.Id, connection);
+  this->ConnectionsByObject.insert(vtk_obj, connection);
+  this->ConnectionsByKey.insert(connectionKey(vtk_obj, vtk_event, qt_obj), connection);
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKObjectEventsObserverPrivate::unindexConnection(QObject* connection)
+{
+  QHash<QObject*, ConnectionKeys>::iterator keysIt =
+    this->IndexedConnections.find(connection);
+  if (keysIt == this->IndexedConnections.end())
     {
-    if (connection->id() == id)
-      {
-      return connection;
-      }
+    return;
     }
-  return 0;
+  // Only the pointer is used, the connection may be under destruction
+  ctkVTKConnection* indexedConnection = static_cast<ctkVTKConnection*>(connection);
+  this->ConnectionsById.remove(keysIt->Id);
+  this->ConnectionsByObject.remove(keysIt->VTKObject, indexedConnection);
+  this->ConnectionsByKey.remove(
+    connectionKey(keysIt->VTKObject, keysIt->VTKEvent, keysIt->QtObject), indexedConnection);
+  this->IndexedConnections.erase(keysIt);
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKConnection*
+ctkVTKObjectEventsObserverPrivate::findConnection(const QString& id)const
+{
+  return this->ConnectionsById.value(id, 0);
 }
 
 //-----------------------------------------------------------------------------
@@ -164,28 +204,32 @@ ctkVTKObjectEventsObserverPrivate::findConnection(
 {
   // Linear search for connections is prohibitively slow when observing many objects
   // (because connection->isEqual is slow)
-  Q_Q(const ctkVTKObjectEventsObserver);
-
-  if(vtk_obj != NULL && qt_slot != NULL &&
-     qt_obj != NULL && vtk_event != vtkCommand::NoEvent)
+  if (vtk_obj != NULL && vtk_event != vtkCommand::NoEvent && qt_obj != NULL)
     {
-    // All information is specified, so we can use the index to find the connection
-    unsigned long hash=generateConnectionIndexHash(vtk_obj, vtk_event, qt_obj);
-    ConnectionIndexType::iterator connectionIt = this->ConnectionIndex.find(hash);
-    while (connectionIt != this->ConnectionIndex.end() && connectionIt.key() == hash)
+    ConnectionKeyType key = connectionKey(vtk_obj, vtk_event, qt_obj);
+    QMultiHash<ConnectionKeyType, ctkVTKConnection*>::const_iterator connectionIt =
+      this->ConnectionsByKey.find(key);
+    for (; connectionIt != this->ConnectionsByKey.end() &&
+           connectionIt.key() == key; ++connectionIt)
       {
-      ctkVTKConnection* connection=connectionIt.value();
-      if (!q->children().contains(connection))
+      if (connectionIt.value()->isEqual(vtk_obj, vtk_event, qt_obj, qt_slot))
         {
-        // connection has been deleted, so remove it from the index
-        connectionIt=this->ConnectionIndex.erase(connectionIt);
-        continue;
+        return connectionIt.value();
         }
-      if (connection->isEqual(vtk_obj, vtk_event, qt_obj, qt_slot))
+      }
+    return 0;
+    }
+  if (vtk_obj != NULL)
+    {
+    QMultiHash<vtkObject*, ctkVTKConnection*>::const_iterator connectionIt =
+      this->ConnectionsByObject.find(vtk_obj);
+    for (; connectionIt != this->ConnectionsByObject.end() &&
+           connectionIt.key() == vtk_obj; ++connectionIt)
+      {
+      if (connectionIt.value()->isEqual(vtk_obj, vtk_event, qt_obj, qt_slot))
         {
-        return connection;
+        return connectionIt.value();
         }
-      ++connectionIt;
       }
     return 0;
     }
@@ -209,14 +253,27 @@ ctkVTKObjectEventsObserverPrivate::findConnections(
 {
   QList<ctkVTKConnection*> foundConnections;
 
-  if(vtk_obj != NULL && qt_slot != NULL &&
-     qt_obj != NULL && vtk_event != vtkCommand::NoEvent)
+  // Only the connections of the vtkObject (and event and QObject) are visited
+  if (vtk_obj != NULL && vtk_event != vtkCommand::NoEvent && qt_obj != NULL)
     {
-    // All information is specified, so we can use the index to find the connection
-    ctkVTKConnection* connection=findConnection(vtk_obj, vtk_event, qt_obj, qt_slot);
-    if (connection)
+    foreach (ctkVTKConnection* connection,
+             this->ConnectionsByKey.values(connectionKey(vtk_obj, vtk_event, qt_obj)))
       {
-      foundConnections.append(connection);
+      if (connection->isEqual(vtk_obj, vtk_event, qt_obj, qt_slot))
+        {
+        foundConnections.append(connection);
+        }
+      }
+    return foundConnections;
+    }
+  if (vtk_obj != NULL)
+    {
+    foreach (ctkVTKConnection* connection, this->ConnectionsByObject.values(vtk_obj))
+      {
+      if (connection->isEqual(vtk_obj, vtk_event, qt_obj, qt_slot))
+        {
+        foundConnections.append(connection);
+        }
       }
     return foundConnections;
     }
@@ -365,10 +422,10 @@ QString ctkVTKObjectEventsObserver::addConnection(vtkObject* vtk_obj, unsigned l
 
   // Instantiate a new connection, set its parameters and add it to the list
   ctkVTKConnection * connection = ctkVTKConnectionFactory::instance()->createConnection(this);
-  d->ConnectionIndex.insert(ctkVTKObjectEventsObserverPrivate::generateConnectionIndexHash(vtk_obj, vtk_event, qt_obj), connection);
 
   connection->observeDeletion(d->ObserveDeletion);
   connection->setup(vtk_obj, vtk_event, qt_obj, qt_slot, priority, connectionType);
+  d->indexConnection(connection, vtk_obj, vtk_event, qt_obj);
 
   // If required, establish connection
   connection->setBlocked(d->AllBlocked);
@@ -418,6 +475,22 @@ bool ctkVTKObjectEventsObserver::blockConnection(const QString& id, bool blocked
   return oldBlocked;
 }
 
+//-----------------------------------------------------------------------------
+bool ctkVTKObjectEventsObserver::compressConnection(const QString& id, bool compress,
+                                                    int interval)
+{
+  Q_D(ctkVTKObjectEventsObserver);
+  ctkVTKConnection* connection = d->findConnection(id);
+  if (connection == 0)
+    {
+    qWarning() << "no connection for id " << id;
+    return false;
+    }
+  connection->setCompressed(compress);
+  connection->setCompressionInterval(interval);
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 int ctkVTKObjectEventsObserver::blockConnection(bool block, vtkObject* vtk_obj,
   unsigned long vtk_event, const QObject* qt_obj)
@@ -448,30 +521,12 @@ int ctkVTKObjectEventsObserver::removeConnection(vtkObject* vtk_obj, unsigned lo
   QList<ctkVTKConnection*> connections =
     d->findConnections(vtk_obj, vtk_event, qt_obj, qt_slot);
 
+  // The connections are removed from the indexes by childEvent()
   foreach (ctkVTKConnection* connection, connections)
     {
     delete connection;
     }
 
-  // Only remove shadow connections (connections in the index without a corresponding actual connection)
-  // from the index if the index size grew too big (shadow elements ratio >50% and minimum 100)
-  if (static_cast<int>(d->ConnectionIndex.size())>100+children().count()*2)
-  {
-    for (ctkVTKObjectEventsObserverPrivate::ConnectionIndexType::iterator connectionIt=d->ConnectionIndex.begin();
-      connectionIt!=d->ConnectionIndex.end();
-      /*upon deletion the increment is done already, so don't increment here*/)
-    {
-      ctkVTKConnection* connection=connectionIt.value();
-      if (!children().contains(connection))
-        {
-        // connection has been deleted, so remove it from the index
-        connectionIt=d->ConnectionIndex.erase(connectionIt);
-        continue;
-        }
-      ++connectionIt;
-    }
-  }
-
   return connections.count();
 }
 
@@ -481,6 +536,27 @@ int ctkVTKObjectEventsObserver::removeAllConnections()
   return this->removeConnection(0, vtkCommand::NoEvent, 0, 0);
 }
 
+//-----------------------------------------------------------------------------
+int ctkVTKObjectEventsObserver::removeAllConnections(vtkObject* vtk_obj)
+{
+  if (!vtk_obj)
+    {
+    return 0;
+    }
+  return this->removeConnection(vtk_obj, vtkCommand::NoEvent, 0, 0);
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKObjectEventsObserver::childEvent(QChildEvent* event)
+{
+  Q_D(ctkVTKObjectEventsObserver);
+  if (event->removed())
+    {
+    d->unindexConnection(event->child());
+    }
+  this->Superclass::childEvent(event);
+}
+
 //-----------------------------------------------------------------------------
 bool ctkVTKObjectEventsObserver::containsConnection(vtkObject* vtk_obj, unsigned long vtk_event,
   const QObject* qt_obj, const char* qt_slot)const
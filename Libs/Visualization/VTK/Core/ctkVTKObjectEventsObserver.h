@@ -134,6 +134,13 @@ public:
   /// \sa removeConnection()
   int removeAllConnections();
 
+  ///
+  /// Remove all the connections of \a vtk_obj. Only the connections of
+  /// \a vtk_obj are visited, whatever the number of connections.
+  /// Returns the number of connection removed.
+  /// \sa removeConnection()
+  int removeAllConnections(vtkObject* vtk_obj);
+
   ///
   /// Temporarilly block all the connection
   /// Returns the previous value of connectionsBlocked()
@@ -154,6 +161,13 @@ public:
   /// false.
   bool blockConnection(const QString& id, bool blocked);
 
+  /// Enable/Disable the compression of the events of a connection: the
+  /// events invoked before the slot is called are coalesced into one slot
+  /// call, at most one every \a interval milliseconds.
+  /// Return false if the connection doesn't exist.
+  /// \sa ctkVTKConnection::setCompressed()
+  bool compressConnection(const QString& id, bool compress, int interval = 0);
+
   /// Return true if there is at least 1 connection matching the parameters,
   /// false otherwise.
   /// \sa addConnection(), reconnection(), removeConnection(),
@@ -164,6 +178,9 @@ public:
 protected:
   QScopedPointer<ctkVTKObjectEventsObserverPrivate> d_ptr;
 
+  /// Remove the deleted connections from the indexes
+  virtual void childEvent(QChildEvent* event);
+
 private:
   Q_DECLARE_PRIVATE(ctkVTKObjectEventsObserver);
   Q_DISABLE_COPY(ctkVTKObjectEventsObserver);
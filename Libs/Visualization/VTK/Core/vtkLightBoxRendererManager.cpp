@@ -22,14 +22,17 @@
 
 // VTK includes
 #include <vtkAlgorithmOutput.h>
+#include <vtkCallbackCommand.h>
 #include <vtkCamera.h>
 #include <vtkCellArray.h>
 #include <vtkConfigure.h>
 #include <vtkCornerAnnotation.h>
 #include <vtkImageData.h>
 #include <vtkImageMapper.h>
+#include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointData.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataMapper2D.h>
@@ -43,14 +46,127 @@
 #include <vtkWeakPointer.h>
 
 // STD includes
-#include <vector>
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <vector>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkLightBoxRendererManager);
 
 namespace
 {
+//-----------------------------------------------------------------------------
+// TileKey
+//-----------------------------------------------------------------------------
+/// Identify the colors of a slice of the image data mapped through a color
+/// window and level
+struct TileKey
+{
+  int           ZSlice;
+  double        ColorWindow;
+  double        ColorLevel;
+  unsigned long ImageMTime;
+
+  bool operator<(const TileKey& other)const
+  {
+    if (this->ZSlice != other.ZSlice)
+      {
+      return this->ZSlice < other.ZSlice;
+      }
+    if (this->ColorWindow != other.ColorWindow)
+      {
+      return this->ColorWindow < other.ColorWindow;
+      }
+    if (this->ColorLevel != other.ColorLevel)
+      {
+      return this->ColorLevel < other.ColorLevel;
+      }
+    return this->ImageMTime < other.ImageMTime;
+  }
+  bool operator!=(const TileKey& other)const
+  {
+    return *this < other || other < *this;
+  }
+};
+
+//-----------------------------------------------------------------------------
+struct Tile
+{
+  vtkSmartPointer<vtkImageData> Image;
+  vtkIdType                     Size;
+  /// Time of the last render the tile was displayed in
+  unsigned long                 LastUsed;
+};
+
+//-----------------------------------------------------------------------------
+/// Same mapping as vtkImageMapper: the color window is mapped to [0, 255].
+template <class T>
+void MapSlice(T* inPtr, vtkIdType inIncrements[3], int extent[6], int inComponents,
+              unsigned char* outPtr, int outComponents, double colorWindow, double colorLevel)
+{
+  const double shift = colorWindow / 2.0 - colorLevel;
+  const double scale = 255.0 / colorWindow;
+  for (int y = extent[2]; y <= extent[3]; ++y)
+    {
+    T* rowPtr = inPtr + (y - extent[2]) * inIncrements[1];
+    for (int x = extent[0]; x <= extent[1]; ++x)
+      {
+      for (int c = 0; c < outComponents; ++c)
+        {
+        double value = (static_cast<double>(rowPtr[c]) + shift) * scale;
+        value = value < 0. ? 0. : (value > 255. ? 255. : value);
+        *outPtr++ = static_cast<unsigned char>(value);
+        }
+      rowPtr += inComponents;
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Slice to map into a tile, the pointers are set before the threads start.
+struct TileJob
+{
+  void*          InPtr;
+  unsigned char* OutPtr;
+  int            Extent[6];
+};
+
+//-----------------------------------------------------------------------------
+struct TileJobs
+{
+  std::vector<TileJob> Jobs;
+  int                  ScalarType;
+  vtkIdType            InIncrements[3];
+  int                  InComponents;
+  int                  OutComponents;
+  double               ColorWindow;
+  double               ColorLevel;
+};
+
+//-----------------------------------------------------------------------------
+/// Each thread maps every NumberOfThreads-th job
+VTK_THREAD_RETURN_TYPE MapTilesThread(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  TileJobs* jobs = static_cast<TileJobs*>(info->UserData);
+  for (size_t i = info->ThreadID; i < jobs->Jobs.size();
+       i += info->NumberOfThreads)
+    {
+    TileJob& job = jobs->Jobs[i];
+    switch (jobs->ScalarType)
+      {
+      vtkTemplateMacro(MapSlice(static_cast<VTK_TT*>(job.InPtr),
+                                jobs->InIncrements, job.Extent,
+                                jobs->InComponents, job.OutPtr,
+                                jobs->OutComponents,
+                                jobs->ColorWindow, jobs->ColorLevel));
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
 //-----------------------------------------------------------------------------
 // RenderWindowItem
 //-----------------------------------------------------------------------------
@@ -77,6 +193,12 @@ public:
   vtkSmartPointer<vtkImageMapper>             ImageMapper;
   vtkSmartPointer<vtkActor2D>                 HighlightedBoxActor;
   vtkSmartPointer<vtkActor2D>                 ImageActor;
+
+  /// Slice of the image data displayed by the item
+  int                                         ZSlice;
+  /// Tile displayed by the item when tile caching is enabled
+  bool                                        HasTile;
+  TileKey                                     DisplayedTileKey;
 };
 }
 
@@ -88,6 +210,9 @@ RenderWindowItem::RenderWindowItem(const double rendererBackgroundColor[3],
                                    const double highlightedBoxColor[3],
                                    double colorWindow, double colorLevel)
 {
+  this->ZSlice = 0;
+  this->HasTile = false;
+
   // Instantiate a renderer
   this->Renderer = vtkSmartPointer<vtkRenderer>::New();
   this->Renderer->SetBackground(rendererBackgroundColor[0],
@@ -248,6 +373,25 @@ public:
   void updateRenderWindowItemsZIndex(int layoutType);
   void SetItemInput(RenderWindowItem* item);
 
+  /// Set the window/level and slice of the mappers for the current mode
+  void SetupItemMapper(RenderWindowItem* item);
+
+  /// Return the up to date image data
+  vtkImageData* GetUpToDateImageData();
+
+  /// Give each render window item the tile of its slice, from the cache or
+  /// computed if missing.
+  void UpdateTiles();
+  /// Allocate the tile of a slice and add its mapping to \a jobs
+  vtkSmartPointer<vtkImageData> AllocateTile(vtkImageData* image, int zSlice,
+                                             TileJobs& jobs);
+  /// Map the slices of \a jobs, in parallel if there are several
+  void MapTiles(TileJobs& jobs);
+  void PruneTileCache();
+
+  static void OnRenderWindowStart(vtkObject* caller, unsigned long eid,
+                                  void* clientData, void* callData);
+
   vtkSmartPointer<vtkRenderWindow>              RenderWindow;
   int                                           RenderWindowRowCount;
   int                                           RenderWindowColumnCount;
@@ -267,6 +411,16 @@ public:
   double                                        ColorLevel;
   double                                        RendererBackgroundColor[3];
 
+  bool                                          TileCaching;
+  vtkIdType                                     TileCacheMemoryBudget;
+  vtkIdType                                     TileCacheMemoryUsage;
+  unsigned long                                 TileCacheTime;
+  std::map<TileKey, Tile>                       TileCache;
+  int                                           TileThreadCount;
+  int                                           TileReadAhead;
+  vtkSmartPointer<vtkMultiThreader>             TileThreader;
+  vtkSmartPointer<vtkCallbackCommand>           RenderWindowStartCallback;
+
   /// Collection of RenderWindowItem
   std::vector<RenderWindowItem* >                  RenderWindowItemList;
   
@@ -299,6 +453,16 @@ vtkLightBoxRendererManager::vtkInternal::vtkInternal(vtkLightBoxRendererManager*
   this->HighlightedBoxColor[0] = 0.0;
   this->HighlightedBoxColor[1] = 1.0;
   this->HighlightedBoxColor[2] = 0.0;
+  this->TileCaching = false;
+  this->TileCacheMemoryBudget = 128 * 1024 * 1024;
+  this->TileCacheMemoryUsage = 0;
+  this->TileCacheTime = 0;
+  this->TileThreadCount = 0;
+  this->TileReadAhead = 0;
+  this->RenderWindowStartCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->RenderWindowStartCallback->SetCallback(
+    vtkLightBoxRendererManager::vtkInternal::OnRenderWindowStart);
+  this->RenderWindowStartCallback->SetClientData(this);
 
   this->CornerAnnotation->SetMaximumLineHeight(0.07);
   vtkTextProperty *tprop = this->CornerAnnotation->GetTextProperty();
@@ -308,6 +472,10 @@ vtkLightBoxRendererManager::vtkInternal::vtkInternal(vtkLightBoxRendererManager*
 // --------------------------------------------------------------------------
 vtkLightBoxRendererManager::vtkInternal::~vtkInternal()
 {
+  if (this->RenderWindow)
+    {
+    this->RenderWindow->RemoveObserver(this->RenderWindowStartCallback);
+    }
   for(RenderWindowItemListIt it = this->RenderWindowItemList.begin();
       it != this->RenderWindowItemList.end();
       ++it)
@@ -389,7 +557,7 @@ void vtkLightBoxRendererManager::vtkInternal::updateRenderWindowItemsZIndex(int
       assert(itemId <= static_cast<int>(this->RenderWindowItemList.size()));
 
       RenderWindowItem * item = this->RenderWindowItemList.at(itemId);
-      assert(item->ImageMapper->GetInput());
+      assert(this->TileCaching || item->ImageMapper->GetInput());
 
       // Default to ctkVTKSliceView::LeftRightTopBottom
       int zSliceIndex = rowId * this->RenderWindowColumnCount + columnId;
@@ -400,7 +568,8 @@ void vtkLightBoxRendererManager::vtkInternal::updateRenderWindowItemsZIndex(int
                       this->RenderWindowColumnCount + columnId;
         }
 
-      item->ImageMapper->SetZSlice(zSliceIndex);
+      item->ZSlice = zSliceIndex;
+      this->SetupItemMapper(item);
       }
     }
 }
@@ -410,10 +579,13 @@ void vtkLightBoxRendererManager::vtkInternal::updateRenderWindowItemsZIndex(int
 void vtkLightBoxRendererManager::vtkInternal
 ::SetItemInput(RenderWindowItem* item)
 {
+  // With tile caching, the input of the mapper is set by UpdateTiles()
+  item->HasTile = false;
 #if (VTK_MAJOR_VERSION <= 5)
-  item->ImageMapper->SetInput(this->ImageData);
+  item->ImageMapper->SetInput(this->TileCaching ? 0 : this->ImageData.GetPointer());
 #else
-  item->ImageMapper->SetInputConnection(this->ImageDataConnection);
+  item->ImageMapper->SetInputConnection(
+    this->TileCaching ? 0 : this->ImageDataConnection.GetPointer());
   bool hasViewProp = item->Renderer->HasViewProp(item->ImageActor);
   if (!this->ImageDataConnection && hasViewProp)
     {
@@ -428,6 +600,243 @@ void vtkLightBoxRendererManager::vtkInternal
 #endif
 }
 
+// --------------------------------------------------------------------------
+void vtkLightBoxRendererManager::vtkInternal::SetupItemMapper(RenderWindowItem* item)
+{
+  if (this->TileCaching)
+    {
+    // Tiles are already mapped and hold a single slice
+    item->ImageMapper->SetColorWindow(255.);
+    item->ImageMapper->SetColorLevel(127.5);
+    item->ImageMapper->SetZSlice(0);
+    }
+  else
+    {
+    item->ImageMapper->SetColorWindow(this->ColorWindow);
+    item->ImageMapper->SetColorLevel(this->ColorLevel);
+    item->ImageMapper->SetZSlice(item->ZSlice);
+    }
+}
+
+// --------------------------------------------------------------------------
+vtkImageData* vtkLightBoxRendererManager::vtkInternal::GetUpToDateImageData()
+{
+#if (VTK_MAJOR_VERSION <= 5)
+  if (!this->ImageData)
+    {
+    return 0;
+    }
+  this->ImageData->Update();
+  return this->ImageData;
+#else
+  if (!this->ImageDataConnection || !this->ImageDataConnection->GetProducer())
+    {
+    return 0;
+    }
+  vtkAlgorithm* producer = this->ImageDataConnection->GetProducer();
+  int port = this->ImageDataConnection->GetIndex();
+  producer->Update(port);
+  return vtkImageData::SafeDownCast(producer->GetOutputDataObject(port));
+#endif
+}
+
+// --------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> vtkLightBoxRendererManager::vtkInternal
+::AllocateTile(vtkImageData* image, int zSlice, TileJobs& jobs)
+{
+  int extent[6];
+  image->GetExtent(extent);
+  extent[4] = zSlice;
+  extent[5] = zSlice;
+  int outComponents = jobs.OutComponents;
+
+  vtkSmartPointer<vtkImageData> tile = vtkSmartPointer<vtkImageData>::New();
+  tile->SetExtent(extent[0], extent[1], extent[2], extent[3], 0, 0);
+  tile->SetSpacing(image->GetSpacing());
+  tile->SetOrigin(image->GetOrigin());
+#if (VTK_MAJOR_VERSION <= 5)
+  tile->SetScalarTypeToUnsignedChar();
+  tile->SetNumberOfScalarComponents(outComponents);
+  tile->AllocateScalars();
+#else
+  tile->AllocateScalars(VTK_UNSIGNED_CHAR, outComponents);
+#endif
+
+  TileJob job;
+  job.InPtr = image->GetScalarPointer(extent[0], extent[2], extent[4]);
+  job.OutPtr = static_cast<unsigned char*>(tile->GetScalarPointer());
+  std::copy(extent, extent + 6, job.Extent);
+  jobs.Jobs.push_back(job);
+  return tile;
+}
+
+// --------------------------------------------------------------------------
+void vtkLightBoxRendererManager::vtkInternal::MapTiles(TileJobs& jobs)
+{
+  int threadCount = this->TileThreadCount > 0 ?
+    this->TileThreadCount : vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  threadCount = std::min(threadCount, static_cast<int>(jobs.Jobs.size()));
+  if (threadCount <= 1)
+    {
+    vtkMultiThreader::ThreadInfo info;
+    info.ThreadID = 0;
+    info.NumberOfThreads = 1;
+    info.UserData = &jobs;
+    MapTilesThread(&info);
+    return;
+    }
+  if (!this->TileThreader)
+    {
+    this->TileThreader = vtkSmartPointer<vtkMultiThreader>::New();
+    }
+  this->TileThreader->SetNumberOfThreads(threadCount);
+  this->TileThreader->SetSingleMethod(MapTilesThread, &jobs);
+  this->TileThreader->SingleMethodExecute();
+}
+
+// --------------------------------------------------------------------------
+void vtkLightBoxRendererManager::vtkInternal::UpdateTiles()
+{
+  if (!this->TileCaching)
+    {
+    return;
+    }
+  vtkImageData* image = this->GetUpToDateImageData();
+  if (!image || !image->GetPointData()->GetScalars() ||
+      image->GetNumberOfPoints() == 0)
+    {
+    return;
+    }
+  int wholeExtent[6];
+  image->GetExtent(wholeExtent);
+
+  ++this->TileCacheTime;
+
+  TileKey key;
+  key.ColorWindow = this->ColorWindow;
+  key.ColorLevel = this->ColorLevel;
+  key.ImageMTime = std::max(image->GetMTime(),
+                            image->GetPointData()->GetScalars()->GetMTime());
+
+  // Only the dirty tiles are computed, all at once before being displayed.
+  TileJobs jobs;
+  jobs.ScalarType = image->GetScalarType();
+  image->GetIncrements(jobs.InIncrements);
+  jobs.InComponents = image->GetNumberOfScalarComponents();
+  // vtkImageMapper displays up to 4 components
+  jobs.OutComponents = std::min(jobs.InComponents, 4);
+  jobs.ColorWindow = this->ColorWindow;
+  jobs.ColorLevel = this->ColorLevel;
+  int firstSlice = wholeExtent[5];
+  int lastSlice = wholeExtent[4];
+  bool missingTile = false;
+  for(RenderWindowItemListIt it = this->RenderWindowItemList.begin();
+      it != this->RenderWindowItemList.end();
+      ++it)
+    {
+    // Same clamping as vtkImageMapper
+    key.ZSlice = std::max(wholeExtent[4], std::min((*it)->ZSlice, wholeExtent[5]));
+    firstSlice = std::min(firstSlice, key.ZSlice);
+    lastSlice = std::max(lastSlice, key.ZSlice);
+    std::map<TileKey, Tile>::iterator tileIt = this->TileCache.find(key);
+    if (tileIt == this->TileCache.end())
+      {
+      Tile tile;
+      tile.Image = this->AllocateTile(image, key.ZSlice, jobs);
+      tile.Size = tile.Image->GetNumberOfPoints() *
+                  tile.Image->GetNumberOfScalarComponents();
+      this->TileCacheMemoryUsage += tile.Size;
+      tileIt = this->TileCache.insert(std::make_pair(key, tile)).first;
+      missingTile = true;
+      }
+    tileIt->second.LastUsed = this->TileCacheTime;
+    }
+  if (missingTile)
+    {
+    // The displayed slices changed, the next ones are likely to be displayed
+    // soon after.
+    for (int i = 1; i <= this->TileReadAhead; ++i)
+      {
+      int readAheadSlices[2] = {firstSlice - i, lastSlice + i};
+      for (int j = 0; j < 2; ++j)
+        {
+        key.ZSlice = readAheadSlices[j];
+        if (key.ZSlice < wholeExtent[4] || key.ZSlice > wholeExtent[5] ||
+            this->TileCache.find(key) != this->TileCache.end())
+          {
+          continue;
+          }
+        Tile tile;
+        tile.Image = this->AllocateTile(image, key.ZSlice, jobs);
+        tile.Size = tile.Image->GetNumberOfPoints() *
+                    tile.Image->GetNumberOfScalarComponents();
+        this->TileCacheMemoryUsage += tile.Size;
+        // Not displayed yet, the first tiles to remove if over budget
+        tile.LastUsed = this->TileCacheTime - 1;
+        this->TileCache.insert(std::make_pair(key, tile));
+        }
+      }
+    }
+  this->MapTiles(jobs);
+
+  for(RenderWindowItemListIt it = this->RenderWindowItemList.begin();
+      it != this->RenderWindowItemList.end();
+      ++it)
+    {
+    RenderWindowItem* item = *it;
+    key.ZSlice = std::max(wholeExtent[4], std::min(item->ZSlice, wholeExtent[5]));
+    std::map<TileKey, Tile>::iterator tileIt = this->TileCache.find(key);
+    assert(tileIt != this->TileCache.end());
+
+    if (!item->HasTile || item->DisplayedTileKey != key)
+      {
+#if (VTK_MAJOR_VERSION <= 5)
+      item->ImageMapper->SetInput(tileIt->second.Image);
+#else
+      item->ImageMapper->SetInputData(tileIt->second.Image);
+#endif
+      item->DisplayedTileKey = key;
+      item->HasTile = true;
+      }
+    }
+  this->PruneTileCache();
+}
+
+// --------------------------------------------------------------------------
+void vtkLightBoxRendererManager::vtkInternal::PruneTileCache()
+{
+  while (this->TileCacheMemoryUsage > this->TileCacheMemoryBudget)
+    {
+    // Least recently displayed tile, the displayed ones are kept
+    std::map<TileKey, Tile>::iterator oldestIt = this->TileCache.end();
+    for (std::map<TileKey, Tile>::iterator tileIt = this->TileCache.begin();
+         tileIt != this->TileCache.end(); ++tileIt)
+      {
+      if (tileIt->second.LastUsed != this->TileCacheTime &&
+          (oldestIt == this->TileCache.end() ||
+           tileIt->second.LastUsed < oldestIt->second.LastUsed))
+        {
+        oldestIt = tileIt;
+        }
+      }
+    if (oldestIt == this->TileCache.end())
+      {
+      return;
+      }
+    this->TileCacheMemoryUsage -= oldestIt->second.Size;
+    this->TileCache.erase(oldestIt);
+    }
+}
+
+// --------------------------------------------------------------------------
+void vtkLightBoxRendererManager::vtkInternal::OnRenderWindowStart(
+  vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* clientData, void* vtkNotUsed(callData))
+{
+  vtkInternal* self = reinterpret_cast<vtkInternal*>(clientData);
+  self->UpdateTiles();
+}
+
 //---------------------------------------------------------------------------
 // vtkLightBoxRendererManager methods
 
@@ -488,6 +897,9 @@ void vtkLightBoxRendererManager::Initialize(vtkRenderWindow* renderWindow)
     return;
     }
   this->Internal->RenderWindow = renderWindow;
+  // The tiles are updated before the renderers are rendered
+  this->Internal->RenderWindow->AddObserver(
+    vtkCommand::StartEvent, this->Internal->RenderWindowStartCallback);
 
   // Set default Layout
   this->SetRenderWindowLayout(1, 1); // Modified() is invoked by SetRenderWindowLayout
@@ -521,6 +933,7 @@ void vtkLightBoxRendererManager::SetImageDataConnection(vtkAlgorithmOutput* newI
 #else
   this->Internal->ImageDataConnection = newImageDataConnection;
 #endif
+  this->ClearTileCache();
 
   vtkInternal::RenderWindowItemListIt it;
   for(it = this->Internal->RenderWindowItemList.begin();
@@ -694,6 +1107,7 @@ void vtkLightBoxRendererManager::SetRenderWindowLayout(int rowCount, int columnC
                                this->Internal->ColorWindow, this->Internal->ColorLevel);
       item->Renderer->SetLayer(this->Internal->RendererLayer);
       this->Internal->SetItemInput(item);
+      this->Internal->SetupItemMapper(item);
       this->Internal->RenderWindowItemList.push_back(item);
       --extraItem;
       }
@@ -954,18 +1368,126 @@ void vtkLightBoxRendererManager::SetColorWindowAndLevel(double colorWindow, doub
     return;
     }
 
+  vtkInternal::RenderWindowItemListIt it;
+  for(it = this->Internal->RenderWindowItemList.begin();
+      it != this->Internal->RenderWindowItemList.end();
+      ++it)
+  this->Internal->ColorWindow = colorWindow;
+  this->Internal->ColorLevel = colorLevel;
+
   vtkInternal::RenderWindowItemListIt it;
   for(it = this->Internal->RenderWindowItemList.begin();
       it != this->Internal->RenderWindowItemList.end();
       ++it)
     {
-    (*it)->ImageMapper->SetColorWindow(colorWindow);
-    (*it)->ImageMapper->SetColorLevel(colorLevel);
+    this->Internal->SetupItemMapper(*it);
     }
 
-  this->Internal->ColorWindow = colorWindow;
-  this->Internal->ColorLevel = colorLevel;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkLightBoxRendererManager::SetTileCaching(bool enable)
+{
+  if (this->Internal->TileCaching == enable)
+    {
+    return;
+    }
+  this->Internal->TileCaching = enable;
+  if (!enable)
+    {
+    this->ClearTileCache();
+    }
 
+  vtkInternal::RenderWindowItemListIt it;
+  for(it = this->Internal->RenderWindowItemList.begin();
+      it != this->Internal->RenderWindowItemList.end();
+      ++it)
+    {
+    this->Internal->SetItemInput(*it);
+    this->Internal->SetupItemMapper(*it);
+    }
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkLightBoxRendererManager::GetTileCaching()const
+{
+  return this->Internal->TileCaching;
+}
+
+//----------------------------------------------------------------------------
+void vtkLightBoxRendererManager::SetTileCacheMemoryBudget(vtkIdType bytes)
+{
+  if (this->Internal->TileCacheMemoryBudget == bytes)
+    {
+    return;
+    }
+  this->Internal->TileCacheMemoryBudget = bytes;
+  this->Internal->PruneTileCache();
   this->Modified();
 }
 
+//----------------------------------------------------------------------------
+vtkIdType vtkLightBoxRendererManager::GetTileCacheMemoryBudget()const
+{
+  return this->Internal->TileCacheMemoryBudget;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkLightBoxRendererManager::GetTileCacheMemoryUsage()const
+{
+  return this->Internal->TileCacheMemoryUsage;
+}
+
+//----------------------------------------------------------------------------
+void vtkLightBoxRendererManager::SetTileThreadCount(int count)
+{
+  if (this->Internal->TileThreadCount == count)
+    {
+    return;
+    }
+  this->Internal->TileThreadCount = count;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkLightBoxRendererManager::GetTileThreadCount()const
+{
+  return this->Internal->TileThreadCount;
+}
+
+//----------------------------------------------------------------------------
+void vtkLightBoxRendererManager::SetTileReadAhead(int sliceCount)
+{
+  sliceCount = std::max(sliceCount, 0);
+  if (this->Internal->TileReadAhead == sliceCount)
+    {
+    return;
+    }
+  this->Internal->TileReadAhead = sliceCount;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkLightBoxRendererManager::GetTileReadAhead()const
+{
+  return this->Internal->TileReadAhead;
+}
+
+//----------------------------------------------------------------------------
+void vtkLightBoxRendererManager::ClearTileCache()
+{
+  // The displayed tiles stay alive with the mappers until the next render
+  this->Internal->TileCache.clear();
+  this->Internal->TileCacheMemoryUsage = 0;
+  vtkInternal::RenderWindowItemListIt it;
+  for(it = this->Internal->RenderWindowItemList.begin();
+      it != this->Internal->RenderWindowItemList.end();
+      ++it)
+    {
+    (*it)->HasTile = false;
+    }
+}
+
@@ -172,6 +172,52 @@ class CTK_VISUALIZATION_VTK_CORE_EXPORT vtkLightBoxRendererManager : public vtkO
 
   /// Set color Window and color level
   void SetColorWindowAndLevel(double colorWindow, double colorLevel);
+
+  /// \brief Enable/Disable the caching of the tiles
+  /// When enabled, the slice of each render window item is mapped through the
+  /// color window and level once, into a tile of unsigned char colors kept in
+  /// a cache keyed by the slice, the color window, the color level and the
+  /// modification time of the image data. When the window is rendered, only
+  /// the items whose key changed get a new tile: the cached tiles are reused
+  /// when coming back to a previous window/level or slice, and the other
+  /// renders draw the tiles without mapping their pixels again.
+  /// \note By default, the value is false
+  /// \sa SetTileCacheMemoryBudget
+  void SetTileCaching(bool enable);
+  bool GetTileCaching()const;
+
+  /// \brief Set the maximum size in bytes of the tile cache
+  /// The least recently displayed tiles are removed from the cache when its
+  /// size exceeds the budget. The tiles displayed by the render window items
+  /// are always kept.
+  /// \note By default, the value is 128MB
+  void SetTileCacheMemoryBudget(vtkIdType bytes);
+  vtkIdType GetTileCacheMemoryBudget()const;
+
+  /// Return the size in bytes of the tiles in the cache
+  vtkIdType GetTileCacheMemoryUsage()const;
+
+  /// Remove all the tiles from the cache
+  void ClearTileCache();
+
+  /// \brief Set the number of threads computing the missing tiles
+  /// When tile caching is enabled, the tiles missing before a render are
+  /// computed in parallel.
+  /// \note By default, the value is 0: the default number of threads of
+  /// vtkMultiThreader
+  /// \sa SetTileCaching
+  void SetTileThreadCount(int count);
+  int GetTileThreadCount()const;
+
+  /// \brief Set the number of slices before the first and after the last
+  /// displayed slices whose tiles are computed ahead of time
+  /// When a displayed tile is missing, e.g. when scrolling through the
+  /// slices, the tiles of the neighbouring slices are computed with it so
+  /// that the next slices are displayed from the cache.
+  /// \note By default, the value is 0
+  /// \sa SetTileCaching
+  void SetTileReadAhead(int sliceCount);
+  int GetTileReadAhead()const;
   
 protected:
 
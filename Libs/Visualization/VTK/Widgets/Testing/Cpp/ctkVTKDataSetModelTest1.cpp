@@ -406,6 +406,34 @@ int ctkVTKDataSetModelTest1(int argc, char * argv [] )
     return EXIT_FAILURE;
     }
 
+  // The rows of the arrays that are kept are not recreated
+  QStandardItem* intsItem = dataSetModel.itemFromArray(ints.GetPointer());
+  int rowCount = dataSetModel.rowCount();
+  dataSetModel.setDeferUpdates(true);
+  vtkNew<vtkIntArray> intsDeferred;
+  intsDeferred->SetName("IntsDeferred");
+  dataSet->GetPointData()->AddArray(intsDeferred.GetPointer());
+  locations[intsDeferred.GetPointer()] = vtkAssignAttribute::POINT_DATA;
+  dataSet->GetCellData()->RemoveArray("Floats");
+  if (dataSetModel.rowCount() != rowCount)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with deferred updates:\n"
+                  "\tExpected row count: " << rowCount << "\n"
+                  "\tCurrent row count: " << dataSetModel.rowCount() << "\n";
+    return EXIT_FAILURE;
+    }
+  QApplication::processEvents();
+  if (dataSetModel.rowCount() != rowCount ||
+      dataSetModel.itemFromArray(ints.GetPointer()) != intsItem ||
+      dataSetModel.itemFromArray(floats.GetPointer()) != 0 ||
+      !checkItems(__LINE__, QList<vtkAbstractArray*>() << ints.GetPointer()
+                  << intsDeferred.GetPointer(), &dataSetModel, locations))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with deferred updates" << std::endl;
+    return EXIT_FAILURE;
+    }
+  dataSetModel.setDeferUpdates(false);
+
   QComboBox comboBox;
   comboBox.setModel(&dataSetModel);
   comboBox.show();
@@ -0,0 +1,114 @@
+// Qt includes
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <QVector>
+
+// CTKVTK includes
+#include "ctkVTKHistogram.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkDataArray.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//---------------------------------------------------
+bool checkBins(ctkVTKHistogram& histogram, const QVector<int>& expectedBins,
+               qreal minRange, int line)
+{
+  if (histogram.count() != expectedBins.size())
+    {
+    std::cerr << "Line : " << line << " - Failed to build histogram: "
+              << histogram.count() << " bins instead of " << expectedBins.size()
+              << std::endl;
+    return false;
+    }
+  for (int i = 0; i < expectedBins.size(); ++i)
+    {
+    int value = histogram.value(minRange + i).toInt();
+    if (value != expectedBins[i])
+      {
+      std::cerr << "Line : " << line << " - Failed to build histogram: bin "
+                << i << " is " << value << " instead of " << expectedBins[i]
+                << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int ctkVTKHistogramTest5( int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+
+//---------------------------------------------------
+// test 5 :
+//---------------------------------------------------
+
+  // An array large enough to be binned by several threads
+  const int tupleCount = 1 << 19;
+  vtkSmartPointer<vtkDataArray> dataArray;
+  dataArray.TakeReference(vtkDataArray::CreateDataArray(VTK_SHORT));
+  dataArray->SetNumberOfComponents(2);
+  dataArray->SetNumberOfTuples(tupleCount);
+  QVector<int> expectedBins(1000, 0);
+  for (int i = 0; i < tupleCount; ++i)
+    {
+    int value = (i * 7) % 1000 - 500;
+    dataArray->SetComponent(i, 0, 10000);
+    dataArray->SetComponent(i, 1, value);
+    ++expectedBins[value + 500];
+    }
+
+  //------Test build--------------------------------
+  ctkVTKHistogram histogram;
+  histogram.setComponent(1);
+  histogram.setDataArray(dataArray);
+  histogram.build();
+  if (!checkBins(histogram, expectedBins, -500, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  //------Test buildAsync---------------------------
+  ctkVTKHistogram asyncHistogram;
+  asyncHistogram.setComponent(1);
+  asyncHistogram.setDataArray(dataArray);
+
+  QEventLoop loop;
+  QObject::connect(&asyncHistogram, SIGNAL(changed()), &loop, SLOT(quit()));
+  QTimer::singleShot(10000, &loop, SLOT(quit()));
+  asyncHistogram.buildAsync();
+  loop.exec();
+
+  if (asyncHistogram.isBuilding())
+    {
+    std::cerr << "Line : " << __LINE__
+              << " - Problem with ctkVTKHistogram::buildAsync: not finished"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!checkBins(asyncHistogram, expectedBins, -500, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  //------Test build cancels buildAsync-------------
+  asyncHistogram.buildAsync();
+  asyncHistogram.build();
+  if (asyncHistogram.isBuilding() ||
+      !checkBins(asyncHistogram, expectedBins, -500, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+// Qt includes
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <QVector>
+
+// CTKVTK includes
+#include "ctkVTKHistogram.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkDataArray.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//---------------------------------------------------
+bool checkBins(ctkVTKHistogram& histogram, const QVector<int>& expectedBins,
+               qreal minRange, int line)
+{
+  if (histogram.count() != expectedBins.size())
+    {
+    std::cerr << "Line : " << line << " - Failed to build histogram: "
+              << histogram.count() << " bins instead of " << expectedBins.size()
+              << std::endl;
+    return false;
+    }
+  for (int i = 0; i < expectedBins.size(); ++i)
+    {
+    int value = histogram.value(minRange + i).toInt();
+    if (value != expectedBins[i])
+      {
+      std::cerr << "Line : " << line << " - Failed to build histogram: bin "
+                << i << " is " << value << " instead of " << expectedBins[i]
+                << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+int ctkVTKHistogramTest6( int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+
+//---------------------------------------------------
+// test 6 :
+//---------------------------------------------------
+
+  const int tupleCount = 1 << 19;
+  vtkSmartPointer<vtkDataArray> dataArray;
+  dataArray.TakeReference(vtkDataArray::CreateDataArray(VTK_SHORT));
+  dataArray->SetNumberOfComponents(1);
+  dataArray->SetNumberOfTuples(tupleCount);
+  QVector<int> expectedBins(1000, 0);
+  for (int i = 0; i < tupleCount; ++i)
+    {
+    int value = (i * 7) % 1000 - 500;
+    dataArray->SetComponent(i, 0, value);
+    ++expectedBins[value + 500];
+    }
+
+  //------Test bins derived from the base bins------
+  ctkVTKHistogram histogram;
+  histogram.setDataArray(dataArray);
+  histogram.build();
+  if (!checkBins(histogram, expectedBins, -500, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // setRange() builds the bins of the new range
+  histogram.setRange(-100, 99);
+  if (!checkBins(histogram, expectedBins.mid(400, 200), -100, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // the bins of a modified array are computed again
+  histogram.setRange(-500, 499);
+  dataArray->SetComponent(0, 0, 499);
+  dataArray->Modified();
+  --expectedBins[0];
+  ++expectedBins[999];
+  histogram.build();
+  if (!checkBins(histogram, expectedBins, -500, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  //------Test sampled preview----------------------
+  ctkVTKHistogram sampledHistogram;
+  sampledHistogram.setSampleFraction(0.1);
+  sampledHistogram.setDataArray(dataArray);
+  sampledHistogram.build();
+  if (!sampledHistogram.isSampled() || !sampledHistogram.isBuilding())
+    {
+    std::cerr << "Line : " << __LINE__
+              << " - Problem with ctkVTKHistogram::setSampleFraction: no preview"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  int estimatedCount = 0;
+  for (int i = 0; i < sampledHistogram.count(); ++i)
+    {
+    estimatedCount += sampledHistogram.value(-500 + i).toInt();
+    }
+  if (qAbs(estimatedCount - tupleCount) > tupleCount / 20)
+    {
+    std::cerr << "Line : " << __LINE__
+              << " - Problem with ctkVTKHistogram::setSampleFraction: "
+              << estimatedCount << " tuples estimated instead of " << tupleCount
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the preview is refined in the background
+  QEventLoop loop;
+  QObject::connect(&sampledHistogram, SIGNAL(changed()), &loop, SLOT(quit()));
+  QTimer::singleShot(10000, &loop, SLOT(quit()));
+  loop.exec();
+  if (sampledHistogram.isSampled() ||
+      !checkBins(sampledHistogram, expectedBins, -500, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -35,6 +35,7 @@
 #include "ctkCommandLineParser.h"
 
 // STD includes
+#include <cstdlib>
 #include <iostream>
 
 //-----------------------------------------------------------------------------
@@ -77,6 +78,19 @@ int ctkVTKRenderViewTest1(int argc, char * argv [] )
   renderView.lookFromAxis(ctkAxesWidget::Inferior, 0.333333);
   renderView.lookFromAxis(ctkAxesWidget::None, 100.);
 
+  // Renders requested before the scheduled one are coalesced into it
+  renderView.setProfilingEnabled(true);
+  renderView.scheduleRender();
+  renderView.scheduleRender();
+  renderView.scheduleRender();
+  if (renderView.skippedRenderCount() != 2 ||
+      !renderView.profilingReport().contains("\"skippedRenderCount\": 2"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with skippedRenderCount(): "
+              << renderView.skippedRenderCount() << std::endl;
+    return EXIT_FAILURE;
+    }
+
   if (!interactive)
     {
     QTimer::singleShot(200, &app, SLOT(quit()));
@@ -51,6 +51,35 @@ int ctkVTKScalarsToColorsUtilsTest1(int argc, char * argv [] )
   
   QImage image = ctk::scalarsToColorsImage(ctf);
 
+  // Unmodified functions reuse the image
+  QImage sameImage = ctk::scalarsToColorsImage(ctf);
+  if (sameImage.cacheKey() != image.cacheKey())
+    {
+    std::cerr << "Line " << __LINE__ << " - The image of an unmodified function"
+              << " is not reused" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Moving a point only maps the columns around it, the result must be the
+  // same as mapping the whole function.
+  QImage largeImage = ctk::scalarsToColorsImage(ctf, QSize(200, 10));
+  double node[6];
+  ctf->GetNodeValue(3, node);
+  node[0] = 5.2;
+  node[1] = 1.;
+  ctf->SetNodeValue(3, node);
+  QImage movedImage = ctk::scalarsToColorsImage(ctf, QSize(200, 10));
+  vtkSmartPointer<vtkColorTransferFunction> ctfCopy =
+    vtkSmartPointer<vtkColorTransferFunction>::New();
+  ctfCopy->DeepCopy(ctf);
+  QImage expectedImage = ctk::scalarsToColorsImage(ctfCopy, QSize(200, 10));
+  if (movedImage == largeImage || movedImage != expectedImage)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the image of a"
+              << " function with a moved point" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   QLabel label;
   label.setPixmap( QPixmap::fromImage(image));
   label.show();
@@ -67,7 +67,19 @@ int ctkVTKThumbnailViewTest1(int argc, char * argv [] )
 
   thumbnailView.setRendererToListen(renderView.renderer());
 
+  ctkVTKThumbnailView offscreenThumbnailView;
+  offscreenThumbnailView.setWindowTitle("Offscreen thumbnail view");
+  offscreenThumbnailView.setOffscreenRendering(true);
+  offscreenThumbnailView.setRendererToListen(renderView.renderer());
+  if (!offscreenThumbnailView.offscreenRendering())
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with offscreenRendering()"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
   thumbnailView.show();
+  offscreenThumbnailView.show();
   renderView.show();
 
   if (argc < 2 || QString(argv[1]) != "-I" )
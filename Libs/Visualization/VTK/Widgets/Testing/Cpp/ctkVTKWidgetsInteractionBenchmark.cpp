@@ -0,0 +1,152 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QSharedPointer>
+
+// CTK includes
+#include "ctkInteractionBenchmark.h"
+#include "ctkTest.h"
+#include "ctkTransferFunction.h"
+#include "ctkTransferFunctionControlPointsItem.h"
+#include "ctkTransferFunctionGradientItem.h"
+#include "ctkTransferFunctionView.h"
+#include "ctkVTKColorTransferFunction.h"
+#include "ctkVTKScalarsToColorsView.h"
+#include "ctkVTKScalarsToColorsWidget.h"
+
+// VTK includes
+#include <vtkColorTransferFunction.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void dragAcross(ctkInteractionBenchmark& benchmark, const QString& name, QWidget* widget)
+{
+  QPoint pos(widget->width() / 2, widget->height() / 2);
+  QTest::mousePress(widget, Qt::LeftButton, Qt::NoModifier, pos);
+  for (int y = widget->height() / 2; y > 1; y -= 2)
+    {
+    pos.setY(y);
+    benchmark.start();
+    ctkTest::mouseMove(widget, Qt::LeftButton, Qt::NoModifier, pos);
+    benchmark.stop(name, "drag");
+    }
+  QTest::mouseRelease(widget, Qt::LeftButton, Qt::NoModifier, pos);
+}
+
+//-----------------------------------------------------------------------------
+void benchmarkTransferFunctionView(ctkInteractionBenchmark& benchmark)
+{
+  vtkSmartPointer<vtkColorTransferFunction> ctf =
+    vtkSmartPointer<vtkColorTransferFunction>::New();
+  ctf->AddRGBPoint(0., 1., 0., 0.);
+  ctf->AddRGBPoint(1000., 0., 0., 1.);
+
+  QSharedPointer<ctkTransferFunction> transferFunction =
+    QSharedPointer<ctkTransferFunction>(new ctkVTKColorTransferFunction(ctf));
+  ctkTransferFunctionView view(0);
+  view.scene()->addItem(new ctkTransferFunctionGradientItem(transferFunction.data()));
+  view.scene()->addItem(new ctkTransferFunctionControlPointsItem(transferFunction.data()));
+  view.resize(600, 300);
+  view.show();
+  QTest::qWaitForWindowShown(&view);
+
+  // Growing the function, one point per sample
+  for (int i = 1; i < 200; ++i)
+    {
+    benchmark.start();
+    ctf->AddRGBPoint(i * 5., (i % 3) / 2., (i % 5) / 4., (i % 7) / 6.);
+    benchmark.stop("ctkTransferFunctionView", "addPoint");
+    benchmark.recordFrame("ctkTransferFunctionView", view.viewport());
+    }
+  dragAcross(benchmark, "ctkTransferFunctionView", view.viewport());
+}
+
+//-----------------------------------------------------------------------------
+void benchmarkScalarsToColorsWidget(ctkInteractionBenchmark& benchmark)
+{
+  vtkSmartPointer<vtkPiecewiseFunction> opacityFunction =
+    vtkSmartPointer<vtkPiecewiseFunction>::New();
+  opacityFunction->AddPoint(0., 0.);
+  opacityFunction->AddPoint(1000., 1.);
+
+  ctkVTKScalarsToColorsWidget widget(0);
+  widget.view()->addOpacityFunction(opacityFunction);
+  widget.view()->setAxesToChartBounds();
+  widget.resize(600, 400);
+  widget.show();
+  QTest::qWaitForWindowShown(&widget);
+
+  for (int i = 1; i < 200; ++i)
+    {
+    benchmark.start();
+    opacityFunction->AddPoint(i * 5., (i % 10) / 10.);
+    benchmark.stop("ctkVTKScalarsToColorsWidget", "addPoint");
+    benchmark.recordFrame("ctkVTKScalarsToColorsWidget", widget.view());
+    }
+  // Selecting the points through the widget, as the point spinbox does
+  for (int i = 0; i < opacityFunction->GetSize(); i += 4)
+    {
+    benchmark.start();
+    widget.setCurrentPoint(i);
+    benchmark.stop("ctkVTKScalarsToColorsWidget", "setCurrentPoint");
+    }
+  for (int i = 0; i < 50; ++i)
+    {
+    benchmark.start();
+    widget.setXRange(i * 10., 1000. - i * 10.);
+    benchmark.stop("ctkVTKScalarsToColorsWidget", "setXRange");
+    benchmark.recordFrame("ctkVTKScalarsToColorsWidget", widget.view());
+    }
+  dragAcross(benchmark, "ctkVTKScalarsToColorsWidget", widget.view());
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int ctkVTKWidgetsInteractionBenchmark(int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  // Optional argument: file the JSON summary is written into
+  QString output = argc > 1 ? QString(argv[1]) : QString();
+
+  ctkInteractionBenchmark benchmark("CTKVisualizationVTKWidgets");
+  benchmarkTransferFunctionView(benchmark);
+  benchmarkScalarsToColorsWidget(benchmark);
+
+  if (benchmark.count("ctkTransferFunctionView", "frame") == 0 ||
+      benchmark.count("ctkVTKScalarsToColorsWidget", "frame") == 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Missing samples" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return benchmark.writeJSON(output) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -19,9 +19,15 @@
 =========================================================================*/
 
 // Qt includes
+#include <QCoreApplication>
+#include <QStringList>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QDebug>
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+#include <QGuiApplication>
+#include <QScreen>
+#endif
 
 // CTK includes
 #include "ctkVTKAbstractView.h"
@@ -34,10 +40,15 @@
 #include <vtkRenderWindowInteractor.h>
 #include <vtkTextProperty.h>
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+
 //--------------------------------------------------------------------------
 static ctkLogger logger("org.commontk.visualization.vtk.widgets.ctkVTKAbstractView");
 //--------------------------------------------------------------------------
 int ctkVTKAbstractViewPrivate::MultiSamples = 0;  // Default for static var
+double ctkVTKAbstractViewPrivate::MaximumFrameRate = 0.; // Display refresh rate
 //--------------------------------------------------------------------------
 
 // --------------------------------------------------------------------------
@@ -49,11 +60,16 @@ ctkVTKAbstractViewPrivate::ctkVTKAbstractViewPrivate(ctkVTKAbstractView& object)
 {
   this->RenderWindow = vtkSmartPointer<vtkRenderWindow>::New();
   this->CornerAnnotation = vtkSmartPointer<vtkCornerAnnotation>::New();
-  this->RequestTimer = 0;
   this->RenderEnabled = true;
   this->FPSVisible = false;
   this->FPSTimer = 0;
   this->FPS = 0;
+  this->ProfilingEnabled = false;
+  this->FrameTimings.resize(256);
+  this->FrameTimingsCount = 0;
+  this->NextFrameTiming = 0;
+  this->SkippedRenderCount = 0;
+  this->PendingScheduleDelay = -1.;
 }
 
 // --------------------------------------------------------------------------
@@ -69,11 +85,6 @@ void ctkVTKAbstractViewPrivate::init()
   q->layout()->setSpacing(0);
   q->layout()->addWidget(this->VTKWidget);
 
-  this->RequestTimer = new QTimer(q);
-  this->RequestTimer->setSingleShot(true);
-  QObject::connect(this->RequestTimer, SIGNAL(timeout()),
-                   q, SLOT(forceRender()));
-
   this->FPSTimer = new QTimer(q);
   this->FPSTimer->setInterval(1000);
   QObject::connect(this->FPSTimer, SIGNAL(timeout()),
@@ -133,6 +144,166 @@ vtkRenderer* ctkVTKAbstractViewPrivate::firstRenderer()const
     ->GetItemAsObject(0));
 }
 
+//---------------------------------------------------------------------------
+QList<ctkVTKAbstractViewFrameTiming> ctkVTKAbstractViewPrivate::frameTimings()const
+{
+  QList<ctkVTKAbstractViewFrameTiming> timings;
+  const int size = this->FrameTimings.size();
+  const int first = (this->NextFrameTiming - this->FrameTimingsCount + size) % size;
+  for (int i = 0; i < this->FrameTimingsCount; ++i)
+    {
+    timings << this->FrameTimings[(first + i) % size];
+    }
+  return timings;
+}
+
+//---------------------------------------------------------------------------
+void ctkVTKAbstractViewPrivate::updateAnnotationTimer()
+{
+  if (this->FPSVisible || this->ProfilingEnabled)
+    {
+    this->FPSTimer->start();
+    }
+  else
+    {
+    this->FPSTimer->stop();
+    }
+}
+
+//---------------------------------------------------------------------------
+namespace
+{
+struct ctkVTKAbstractViewTimingStatistics
+{
+  double Minimum;
+  double Average;
+  double Percentile99;
+};
+
+//---------------------------------------------------------------------------
+ctkVTKAbstractViewTimingStatistics timingStatistics(QVector<double> values)
+{
+  ctkVTKAbstractViewTimingStatistics statistics;
+  statistics.Minimum = statistics.Average = statistics.Percentile99 = 0.;
+  if (values.isEmpty())
+    {
+    return statistics;
+    }
+  std::sort(values.begin(), values.end());
+  statistics.Minimum = values.first();
+  double sum = 0.;
+  foreach(double value, values)
+    {
+    sum += value;
+    }
+  statistics.Average = sum / values.size();
+  const int percentileIndex =
+    static_cast<int>(std::ceil(0.99 * values.size())) - 1;
+  statistics.Percentile99 = values[qBound(0, percentileIndex, values.size() - 1)];
+  return statistics;
+}
+
+//---------------------------------------------------------------------------
+QString timingStatisticsToJSON(const ctkVTKAbstractViewTimingStatistics& statistics)
+{
+  return QString("{\"min\": %1, \"avg\": %2, \"p99\": %3}")
+    .arg(statistics.Minimum).arg(statistics.Average).arg(statistics.Percentile99);
+}
+} // end namespace
+
+//---------------------------------------------------------------------------
+// ctkVTKAbstractViewRenderScheduler methods
+
+//---------------------------------------------------------------------------
+ctkVTKAbstractViewRenderScheduler::ctkVTKAbstractViewRenderScheduler(QObject* parentObject)
+  : QObject(parentObject)
+{
+  this->TickTimer = new QTimer(this);
+  this->TickTimer->setSingleShot(true);
+  QObject::connect(this->TickTimer, SIGNAL(timeout()),
+                   this, SLOT(renderScheduledViews()));
+  this->Clock.start();
+  this->LastTick = -1000;
+  this->NextTick = 0;
+}
+
+//---------------------------------------------------------------------------
+ctkVTKAbstractViewRenderScheduler* ctkVTKAbstractViewRenderScheduler::instance()
+{
+  // Owned by the application, the timer can't outlive it.
+  static QPointer<ctkVTKAbstractViewRenderScheduler> scheduler;
+  if (scheduler.isNull())
+    {
+    scheduler = new ctkVTKAbstractViewRenderScheduler(QCoreApplication::instance());
+    }
+  return scheduler;
+}
+
+//---------------------------------------------------------------------------
+double ctkVTKAbstractViewRenderScheduler::frameInterval()const
+{
+  double frameRate = ctkVTKAbstractView::maximumFrameRate();
+  if (frameRate <= 0.)
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+    QScreen* screen = qobject_cast<QGuiApplication*>(QCoreApplication::instance()) ?
+      QGuiApplication::primaryScreen() : 0;
+    frameRate = screen ? screen->refreshRate() : 0.;
+#endif
+    if (frameRate <= 0.)
+      {
+      frameRate = 60.;
+      }
+    }
+  return 1000. / frameRate;
+}
+
+//---------------------------------------------------------------------------
+void ctkVTKAbstractViewRenderScheduler::schedule(ctkVTKAbstractView* view,
+                                                 double msecsBeforeRender)
+{
+  if (!this->ScheduledViews.contains(view))
+    {
+    this->ScheduledViews << view;
+    }
+  qint64 now = this->Clock.elapsed();
+  qint64 tick = qMax(now + static_cast<qint64>(msecsBeforeRender),
+                     this->LastTick + static_cast<qint64>(this->frameInterval()));
+  if (!this->TickTimer->isActive() || tick < this->NextTick)
+    {
+    this->NextTick = tick;
+    this->TickTimer->start(static_cast<int>(qMax(tick - now, qint64(0))));
+    }
+}
+
+//---------------------------------------------------------------------------
+void ctkVTKAbstractViewRenderScheduler::unschedule(ctkVTKAbstractView* view)
+{
+  this->ScheduledViews.removeAll(view);
+  if (this->ScheduledViews.isEmpty())
+    {
+    this->TickTimer->stop();
+    }
+}
+
+//---------------------------------------------------------------------------
+void ctkVTKAbstractViewRenderScheduler::renderScheduledViews()
+{
+  this->TickTimer->stop();
+  this->LastTick = this->Clock.elapsed();
+  // Views can be scheduled again while the others are rendered, they are
+  // rendered in the next tick.
+  QList<QPointer<ctkVTKAbstractView> > views = this->ScheduledViews;
+  this->ScheduledViews.clear();
+  foreach(ctkVTKAbstractView* view, views)
+    {
+    if (view)
+      {
+      view->forceRender();
+      }
+    }
+}
+
 //---------------------------------------------------------------------------
 // ctkVTKAbstractView methods
 
@@ -193,15 +364,23 @@ void ctkVTKAbstractView::scheduleRender()
       msecsBeforeRender = 0;
       }
     d->RequestTime.start();
-    d->RequestTimer->start(static_cast<int>(msecsBeforeRender));
+    // The views scheduled meanwhile, e.g. the other views of a layout driven
+    // by the same interaction, are rendered in the same tick.
+    ctkVTKAbstractViewRenderScheduler::instance()->schedule(this, msecsBeforeRender);
     }
   else if (d->RequestTime.elapsed() > msecsBeforeRender)
     {
     // The rendering hasn't still be done, but msecsBeforeRender milliseconds
-    // have already been elapsed, it is likely that RequestTimer has already
+    // have already been elapsed, it is likely that the tick has already
     // timed out, but the event queue hasn't been processed yet, rendering is
-    // done now to ensure the desired framerate is respected.
-    this->forceRender();
+    // done now for all the scheduled views to ensure the desired framerate is
+    // respected.
+    ctkVTKAbstractViewRenderScheduler::instance()->renderScheduledViews();
+    }
+  else
+    {
+    // Coalesced with the render already scheduled
+    ++d->SkippedRenderCount;
     }
 }
 
@@ -210,17 +389,13 @@ void ctkVTKAbstractView::forceRender()
 {
   Q_D(ctkVTKAbstractView);
 
-  if (this->sender() == d->RequestTimer  &&
-      !d->RequestTime.isValid())
+  // The view doesn't need to be rendered in the next tick anymore.
+  double scheduleDelay = 0.;
+  if (d->RequestTime.isValid())
     {
-    // The slot associated to the timeout signal is now called, however the
-    // render has already been executed meanwhile. There is no need to do it
-    // again.
-    return;
+    scheduleDelay = d->RequestTime.elapsed();
+    ctkVTKAbstractViewRenderScheduler::instance()->unschedule(this);
     }
-
-  // The timer can be stopped if it hasn't timed out yet.
-  d->RequestTimer->stop();
   d->RequestTime = QTime();
 
   //logger.trace(QString("forceRender - RenderEnabled: %1")
@@ -230,7 +405,9 @@ void ctkVTKAbstractView::forceRender()
     {
     return;
     }
+  d->PendingScheduleDelay = scheduleDelay;
   d->RenderWindow->Render();
+  d->PendingScheduleDelay = -1.;
 }
 
 //----------------------------------------------------------------------------
@@ -401,16 +578,15 @@ void ctkVTKAbstractView::setFPSVisible(bool show)
     return;
     }
   d->FPSVisible = show;
+  d->updateAnnotationTimer();
   vtkRenderer* renderer = d->firstRenderer();
   if (d->FPSVisible)
     {
-    d->FPSTimer->start();
     qvtkConnect(renderer,
                 vtkCommand::EndEvent, this, SLOT(onRender()));
     }
   else
     {
-    d->FPSTimer->stop();
     qvtkDisconnect(renderer,
                    vtkCommand::EndEvent, this, SLOT(onRender()));
     d->CornerAnnotation->SetText(1, "");
@@ -435,11 +611,174 @@ void ctkVTKAbstractView::onRender()
 void ctkVTKAbstractView::updateFPS()
 {
   Q_D(ctkVTKAbstractView);
-  vtkRenderer* renderer = d->firstRenderer();
-  double lastRenderTime = renderer ? renderer->GetLastRenderTimeInSeconds() : 0.;
-  QString fpsString = tr("FPS: %1(%2s)").arg(d->FPS).arg(lastRenderTime);
-  d->FPS = 0;
-  d->CornerAnnotation->SetText(1, fpsString.toLatin1());
+  if (d->FPSVisible)
+    {
+    vtkRenderer* renderer = d->firstRenderer();
+    double lastRenderTime = renderer ? renderer->GetLastRenderTimeInSeconds() : 0.;
+    QString fpsString = tr("FPS: %1(%2s)").arg(d->FPS).arg(lastRenderTime);
+    d->FPS = 0;
+    d->CornerAnnotation->SetText(1, fpsString.toLatin1());
+    }
+  if (d->ProfilingEnabled)
+    {
+    QVector<double> frameTimes;
+    foreach(const ctkVTKAbstractViewFrameTiming& timing, d->frameTimings())
+      {
+      frameTimes << timing.FrameTime;
+      }
+    ctkVTKAbstractViewTimingStatistics statistics = timingStatistics(frameTimes);
+    QString profilingString = tr("Frame: %1/%2/%3ms (min/avg/p99)\nSkipped: %4")
+      .arg(statistics.Minimum, 0, 'f', 1)
+      .arg(statistics.Average, 0, 'f', 1)
+      .arg(statistics.Percentile99, 0, 'f', 1)
+      .arg(d->SkippedRenderCount);
+    d->CornerAnnotation->SetText(3, profilingString.toLatin1());
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkVTKAbstractView::onRenderWindowStart()
+{
+  Q_D(ctkVTKAbstractView);
+  d->FrameClock.start();
+}
+
+//----------------------------------------------------------------------------
+void ctkVTKAbstractView::onRenderWindowEnd()
+{
+  Q_D(ctkVTKAbstractView);
+  if (!d->FrameClock.isValid())
+    {
+    return;
+    }
+  ctkVTKAbstractViewFrameTiming timing;
+  timing.FrameTime = d->FrameClock.nsecsElapsed() / 1000000.;
+  // Renders that are not scheduled, e.g. by QVTKWidget::paintEvent(), have
+  // no schedule delay.
+  timing.ScheduleDelay = qMax(d->PendingScheduleDelay, 0.);
+  timing.RenderTime = 0.;
+  foreach(vtkRenderer* renderer, d->renderers())
+    {
+    timing.RenderTime += renderer->GetLastRenderTimeInSeconds() * 1000.;
+    }
+  d->FrameClock.invalidate();
+
+  d->FrameTimings[d->NextFrameTiming] = timing;
+  d->NextFrameTiming = (d->NextFrameTiming + 1) % d->FrameTimings.size();
+  d->FrameTimingsCount = qMin(d->FrameTimingsCount + 1, d->FrameTimings.size());
+}
+
+//----------------------------------------------------------------------------
+void ctkVTKAbstractView::setProfilingEnabled(bool enable)
+{
+  Q_D(ctkVTKAbstractView);
+  if (d->ProfilingEnabled == enable)
+    {
+    return;
+    }
+  d->ProfilingEnabled = enable;
+  d->updateAnnotationTimer();
+  if (enable)
+    {
+    this->resetProfiling();
+    qvtkConnect(d->RenderWindow, vtkCommand::StartEvent,
+                this, SLOT(onRenderWindowStart()));
+    qvtkConnect(d->RenderWindow, vtkCommand::EndEvent,
+                this, SLOT(onRenderWindowEnd()));
+    }
+  else
+    {
+    qvtkDisconnect(d->RenderWindow, vtkCommand::StartEvent,
+                   this, SLOT(onRenderWindowStart()));
+    qvtkDisconnect(d->RenderWindow, vtkCommand::EndEvent,
+                   this, SLOT(onRenderWindowEnd()));
+    d->CornerAnnotation->SetText(3, "");
+    }
+}
+
+//----------------------------------------------------------------------------
+bool ctkVTKAbstractView::isProfilingEnabled()const
+{
+  Q_D(const ctkVTKAbstractView);
+  return d->ProfilingEnabled;
+}
+
+//----------------------------------------------------------------------------
+void ctkVTKAbstractView::setProfilingFrameCount(int count)
+{
+  Q_D(ctkVTKAbstractView);
+  count = qMax(1, count);
+  if (count == d->FrameTimings.size())
+    {
+    return;
+    }
+  // Keep the most recent timings
+  QList<ctkVTKAbstractViewFrameTiming> timings = d->frameTimings();
+  while (timings.count() > count)
+    {
+    timings.removeFirst();
+    }
+  d->FrameTimings.resize(count);
+  for (int i = 0; i < timings.count(); ++i)
+    {
+    d->FrameTimings[i] = timings[i];
+    }
+  d->FrameTimingsCount = timings.count();
+  d->NextFrameTiming = timings.count() % count;
+}
+
+//----------------------------------------------------------------------------
+int ctkVTKAbstractView::profilingFrameCount()const
+{
+  Q_D(const ctkVTKAbstractView);
+  return d->FrameTimings.size();
+}
+
+//----------------------------------------------------------------------------
+void ctkVTKAbstractView::resetProfiling()
+{
+  Q_D(ctkVTKAbstractView);
+  d->FrameTimingsCount = 0;
+  d->NextFrameTiming = 0;
+  d->SkippedRenderCount = 0;
+}
+
+//----------------------------------------------------------------------------
+int ctkVTKAbstractView::skippedRenderCount()const
+{
+  Q_D(const ctkVTKAbstractView);
+  return d->SkippedRenderCount;
+}
+
+//----------------------------------------------------------------------------
+QString ctkVTKAbstractView::profilingReport()const
+{
+  Q_D(const ctkVTKAbstractView);
+  QList<ctkVTKAbstractViewFrameTiming> timings = d->frameTimings();
+  QVector<double> scheduleDelays;
+  QVector<double> renderTimes;
+  QVector<double> frameTimes;
+  QStringList frames;
+  foreach(const ctkVTKAbstractViewFrameTiming& timing, timings)
+    {
+    scheduleDelays << timing.ScheduleDelay;
+    renderTimes << timing.RenderTime;
+    frameTimes << timing.FrameTime;
+    frames << QString("{\"scheduleDelay\": %1, \"renderTime\": %2, \"frameTime\": %3}")
+      .arg(timing.ScheduleDelay).arg(timing.RenderTime).arg(timing.FrameTime);
+    }
+  QString report("{\n");
+  report += QString("  \"frameCount\": %1,\n").arg(timings.count());
+  report += QString("  \"skippedRenderCount\": %1,\n").arg(d->SkippedRenderCount);
+  report += QString("  \"scheduleDelay\": %1,\n")
+    .arg(timingStatisticsToJSON(timingStatistics(scheduleDelays)));
+  report += QString("  \"renderTime\": %1,\n")
+    .arg(timingStatisticsToJSON(timingStatistics(renderTimes)));
+  report += QString("  \"frameTime\": %1,\n")
+    .arg(timingStatisticsToJSON(timingStatistics(frameTimes)));
+  report += QString("  \"frames\": [%1]\n").arg(frames.join(",\n    "));
+  report += "}\n";
+  return report;
 }
 
 //----------------------------------------------------------------------------
@@ -480,3 +819,15 @@ void ctkVTKAbstractView::setMultiSamples(int number)
 {
   ctkVTKAbstractViewPrivate::MultiSamples = number;
 }
+
+//----------------------------------------------------------------------------
+double ctkVTKAbstractView::maximumFrameRate()
+{
+  return ctkVTKAbstractViewPrivate::MaximumFrameRate;
+}
+
+//----------------------------------------------------------------------------
+void ctkVTKAbstractView::setMaximumFrameRate(double frameRate)
+{
+  ctkVTKAbstractViewPrivate::MaximumFrameRate = frameRate;
+}
@@ -55,6 +55,18 @@ class CTK_VISUALIZATION_VTK_WIDGETS_EXPORT ctkVTKAbstractView : public QWidget
   /// not.
   /// false by default.
   Q_PROPERTY(bool useDepthPeeling READ useDepthPeeling WRITE setUseDepthPeeling)
+  /// This property controls whether the timings of the last frames are
+  /// recorded, and shown with a corner annotation.
+  /// For each frame, the delay between scheduleRender() and the render, the
+  /// time spent by the renderers and the time of the whole frame (including
+  /// the buffer swap) are recorded, in milliseconds.
+  /// false by default.
+  /// \sa profilingFrameCount, profilingReport(), skippedRenderCount()
+  Q_PROPERTY(bool profilingEnabled READ isProfilingEnabled WRITE setProfilingEnabled)
+  /// This property holds the number of last frames whose timings are kept.
+  /// 256 by default.
+  /// \sa profilingEnabled
+  Q_PROPERTY(int profilingFrameCount READ profilingFrameCount WRITE setProfilingFrameCount)
 public:
 
   typedef QWidget Superclass;
@@ -66,6 +78,9 @@ public Q_SLOTS:
   /// scheduleRender() respects the desired framerate of the render window,
   /// it won't render the window more than what the current render window
   /// framerate is.
+  /// The views are rendered in frame ticks shared by all the views: the views
+  /// scheduled before a tick are all rendered in the same event loop pass.
+  /// \sa setMaximumFrameRate()
   virtual void scheduleRender();
 
   /// Force a render even if a render is already ocurring
@@ -97,6 +112,17 @@ public Q_SLOTS:
   /// \sa useDepthPeeling
   void setUseDepthPeeling(bool use);
 
+  /// Enable/Disable the recording of the frame timings.
+  /// \sa profilingEnabled
+  void setProfilingEnabled(bool enable);
+
+  /// Set the number of frames whose timings are kept.
+  /// \sa profilingFrameCount
+  void setProfilingFrameCount(int count);
+
+  /// Clear the recorded frame timings and the skipped render count.
+  void resetProfiling();
+
 public:
   /// Get underlying RenderWindow
   Q_INVOKABLE vtkRenderWindow* renderWindow()const;
@@ -141,6 +167,25 @@ public:
   /// \sa useDepthPeeling
   bool useDepthPeeling()const;
 
+  /// Return the profilingEnabled property value.
+  /// \sa profilingEnabled
+  bool isProfilingEnabled()const;
+
+  /// Return the profilingFrameCount property value.
+  /// \sa profilingFrameCount
+  int profilingFrameCount()const;
+
+  /// Return the number of scheduleRender() calls that didn't lead to a
+  /// render of their own because a render was already scheduled, since the
+  /// profiling was enabled or reset.
+  int skippedRenderCount()const;
+
+  /// Return the recorded frame timings as a JSON object: the number of
+  /// frames, the skipped render count, the minimum, average and 99th
+  /// percentile of each timing and the timings of each frame, oldest first.
+  /// \sa profilingEnabled
+  QString profilingReport()const;
+
   /// Set the default number of multisamples to use. Note that a negative
   /// value means "auto", which means the renderer will attempt to select
   /// the maximum number (but is not guaranteed to work).
@@ -156,6 +201,17 @@ public:
   /// \sa setMultiSamples()
   static int multiSamples();
 
+  /// Set the maximum number of frame ticks per second in which the views
+  /// scheduled by scheduleRender() are rendered, for all the views.
+  /// 0 or a negative value, the default, means the refresh rate of the
+  /// primary screen (60Hz if unknown).
+  /// \sa maximumFrameRate(), scheduleRender()
+  static void setMaximumFrameRate(double frameRate);
+
+  /// Return the maximum number of frame ticks per second.
+  /// \sa setMaximumFrameRate()
+  static double maximumFrameRate();
+
   virtual QSize minimumSizeHint()const;
   virtual QSize sizeHint()const;
   virtual bool hasHeightForWidth()const;
@@ -164,6 +220,8 @@ public:
 protected Q_SLOTS:
   void onRender();
   void updateFPS();
+  void onRenderWindowStart();
+  void onRenderWindowEnd();
 
 protected:
   QScopedPointer<ctkVTKAbstractViewPrivate> d_ptr;
@@ -22,8 +22,12 @@
 #define __ctkVTKAbstractView_p_h
 
 // Qt includes
+#include <QElapsedTimer>
+#include <QList>
 #include <QObject>
+#include <QPointer>
 #include <QTime>
+#include <QVector>
 class QTimer;
 
 // CTK includes
@@ -36,6 +40,20 @@ class QTimer;
 #include <vtkSmartPointer.h>
 #include <vtkWeakPointer.h>
 
+//-----------------------------------------------------------------------------
+/// \ingroup Visualization_VTK_Widgets
+/// Timings of a frame, in milliseconds.
+struct ctkVTKAbstractViewFrameTiming
+{
+  /// Delay between the first scheduleRender() and the render, 0 if the
+  /// render wasn't scheduled.
+  double ScheduleDelay;
+  /// Time spent by the renderers.
+  double RenderTime;
+  /// Time of the whole render window render, including the buffer swap.
+  double FrameTime;
+};
+
 //-----------------------------------------------------------------------------
 /// \ingroup Visualization_VTK_Widgets
 class ctkVTKAbstractViewPrivate : public QObject
@@ -57,17 +75,68 @@ public:
   QList<vtkRenderer*> renderers()const;
   vtkRenderer* firstRenderer()const;
 
+  /// Recorded frame timings, oldest first.
+  QList<ctkVTKAbstractViewFrameTiming> frameTimings()const;
+  /// Start or stop the timer of the FPS and profiling annotations.
+  void updateAnnotationTimer();
+
   QVTKWidget*                                   VTKWidget;
   vtkSmartPointer<vtkRenderWindow>              RenderWindow;
-  QTimer*                                       RequestTimer;
   QTime                                         RequestTime;
   bool                                          RenderEnabled;
   bool                                          FPSVisible;
   QTimer*                                       FPSTimer;
   int                                           FPS;
   static int                                    MultiSamples;
+  static double                                 MaximumFrameRate;
+
+  bool                                          ProfilingEnabled;
+  /// Ring buffer of the last frame timings
+  QVector<ctkVTKAbstractViewFrameTiming>        FrameTimings;
+  int                                           FrameTimingsCount;
+  int                                           NextFrameTiming;
+  int                                           SkippedRenderCount;
+  /// Delay of the scheduled render about to be done, -1 if none
+  double                                        PendingScheduleDelay;
+  QElapsedTimer                                 FrameClock;
 
   vtkSmartPointer<vtkCornerAnnotation>          CornerAnnotation;
 };
 
+//-----------------------------------------------------------------------------
+/// \ingroup Visualization_VTK_Widgets
+/// Renders the views scheduled by ctkVTKAbstractView::scheduleRender() in
+/// frame ticks shared by all the views: the views that need a render when a
+/// tick occurs are all rendered in the same event loop pass, and the ticks
+/// never occur more often than ctkVTKAbstractView::maximumFrameRate().
+class ctkVTKAbstractViewRenderScheduler : public QObject
+{
+  Q_OBJECT
+
+public:
+  static ctkVTKAbstractViewRenderScheduler* instance();
+
+  /// Render \a view in a tick at least \a msecsBeforeRender milliseconds
+  /// from now, sooner if other views are rendered before.
+  void schedule(ctkVTKAbstractView* view, double msecsBeforeRender);
+  /// Remove \a view from the views to render, e.g. when it is rendered now.
+  void unschedule(ctkVTKAbstractView* view);
+
+  /// Minimum number of milliseconds between two ticks.
+  double frameInterval()const;
+
+public Q_SLOTS:
+  /// Render all the scheduled views now.
+  void renderScheduledViews();
+
+protected:
+  ctkVTKAbstractViewRenderScheduler(QObject* parent);
+
+  QTimer*                                       TickTimer;
+  QElapsedTimer                                 Clock;
+  qint64                                        LastTick;
+  qint64                                        NextTick;
+  QList<QPointer<ctkVTKAbstractView> >          ScheduledViews;
+};
+
 #endif
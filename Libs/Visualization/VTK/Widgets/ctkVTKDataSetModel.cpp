@@ -20,6 +20,9 @@
 
 // Qt includes
 #include <QDebug>
+#include <QPair>
+#include <QSet>
+#include <QTimer>
 
 // CTK includes
 #include "ctkVTKDataSetModel.h"
@@ -46,6 +49,17 @@ public:
   static QList<vtkAbstractArray*> attributeArrayToInsert(const ctkVTKDataSetModel::AttributeTypes& attributeType,
                                                      vtkDataSetAttributes * dataSetAttributes);
 
+  typedef QPair<vtkAbstractArray*, int> ArrayLocation;
+  /// List the arrays to show, with their location, in the order of the rows
+  QList<ArrayLocation> arraysToShow()const;
+  /// Return the array and location of a row, (0, NullItemLocation) for the
+  /// null item.
+  ArrayLocation arrayLocationFromRow(int row)const;
+
+  /// Update the model now if updates are not deferred, otherwise schedule an
+  /// update for when the control returns to the event loop.
+  void requestUpdate();
+
   vtkSmartPointer<vtkDataSet> DataSet;
   vtkSmartPointer<vtkPointData> DataSetPointData;
   vtkSmartPointer<vtkCellData> DataSetCellData;
@@ -53,6 +67,8 @@ public:
   bool ListenAbstractArrayModifiedEvent;
   ctkVTKDataSetModel::AttributeTypes AttributeType;
   bool IncludeNullItem;
+  bool DeferUpdates;
+  bool UpdatePending;
 };
 
 
@@ -63,6 +79,8 @@ ctkVTKDataSetModelPrivate::ctkVTKDataSetModelPrivate(ctkVTKDataSetModel& object)
   this->ListenAbstractArrayModifiedEvent = false;
   this->AttributeType = ctkVTKDataSetModel::AllAttribute;
   this->IncludeNullItem = false;
+  this->DeferUpdates = false;
+  this->UpdatePending = false;
 }
 
 //------------------------------------------------------------------------------
@@ -136,6 +154,64 @@ QList<vtkAbstractArray*> ctkVTKDataSetModelPrivate::attributeArrayToInsert(
   return attributeArraysToInsert;
 }
 
+//------------------------------------------------------------------------------
+QList<ctkVTKDataSetModelPrivate::ArrayLocation> ctkVTKDataSetModelPrivate::arraysToShow()const
+{
+  QList<ArrayLocation> arrays;
+  if (this->DataSet.GetPointer() == 0)
+    {
+    return arrays;
+    }
+  foreach(vtkAbstractArray* attributeArray,
+    ctkVTKDataSetModelPrivate::attributeArrayToInsert(this->AttributeType, this->DataSet->GetPointData()))
+    {
+    // Arrays can be pre-allocated for a data set
+    if (attributeArray)
+      {
+      arrays << ArrayLocation(attributeArray, vtkAssignAttribute::POINT_DATA);
+      }
+    }
+  foreach(vtkAbstractArray* attributeArray,
+    ctkVTKDataSetModelPrivate::attributeArrayToInsert(this->AttributeType, this->DataSet->GetCellData()))
+    {
+    if (attributeArray)
+      {
+      arrays << ArrayLocation(attributeArray, vtkAssignAttribute::CELL_DATA);
+      }
+    }
+  return arrays;
+}
+
+//------------------------------------------------------------------------------
+ctkVTKDataSetModelPrivate::ArrayLocation ctkVTKDataSetModelPrivate::arrayLocationFromRow(int row)const
+{
+  Q_Q(const ctkVTKDataSetModel);
+  QStandardItem* item = q->item(row);
+  Q_ASSERT(item);
+  return ArrayLocation(
+    static_cast<vtkAbstractArray*>(reinterpret_cast<void *>(
+      item->data(ctkVTK::PointerRole).toLongLong())),
+    item->data(ctkVTK::LocationRole).toInt());
+}
+
+//------------------------------------------------------------------------------
+void ctkVTKDataSetModelPrivate::requestUpdate()
+{
+  Q_Q(ctkVTKDataSetModel);
+  if (!this->DeferUpdates)
+    {
+    q->updateDataSet();
+    return;
+    }
+  if (this->UpdatePending)
+    {
+    // Collapsed into the update already scheduled
+    return;
+    }
+  this->UpdatePending = true;
+  QTimer::singleShot(0, q, SLOT(onDeferredUpdate()));
+}
+
 //------------------------------------------------------------------------------
 // ctkVTKDataSetModel
 
@@ -175,6 +251,10 @@ void ctkVTKDataSetModel::setDataSet(vtkDataSet* dataSet)
                       this, SLOT(onDataSetModified(vtkObject*)) );
   d->DataSet = dataSet;
   this->onDataSetModified(dataSet);
+  if (d->UpdatePending)
+    {
+    this->updateDataSet();
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -230,6 +310,24 @@ void ctkVTKDataSetModel::setIncludeNullItem(bool includeNullItem)
   d->IncludeNullItem = includeNullItem;
 }
 
+// ----------------------------------------------------------------------------
+bool ctkVTKDataSetModel::deferUpdates()const
+{
+  Q_D(const ctkVTKDataSetModel);
+  return d->DeferUpdates;
+}
+
+// ----------------------------------------------------------------------------
+void ctkVTKDataSetModel::setDeferUpdates(bool defer)
+{
+  Q_D(ctkVTKDataSetModel);
+  d->DeferUpdates = defer;
+  if (!defer && d->UpdatePending)
+    {
+    this->updateDataSet();
+    }
+}
+
 //------------------------------------------------------------------------------
 vtkAbstractArray* ctkVTKDataSetModel::arrayFromItem(QStandardItem* arrayItem)const
 {
@@ -317,31 +415,95 @@ bool ctkVTKDataSetModel::listenNodeModifiedEvent()const
 void ctkVTKDataSetModel::updateDataSet()
 {
   Q_D(ctkVTKDataSetModel);
+  d->UpdatePending = false;
 
-  // Remove all items (except the first one, if there is a NULL item)
+  // Keep the first item, if there is a NULL item
+  int firstRow = 0;
   if (d->IncludeNullItem)
     {
-    if (this->rowCount()<1)
+    if (this->rowCount() < 1 ||
+        this->item(0)->data(ctkVTK::LocationRole).toInt() != this->NullItemLocation)
       {
       this->insertNullItem();
       }
-    else
+    firstRow = 1;
+    }
+
+  if (this->rowCount() == firstRow)
+    {
+    // Nothing to diff against
+    if (d->DataSet.GetPointer() != 0)
       {
-      this->setRowCount(1);
+      this->populateDataSet();
       }
+    return;
     }
-  else
+
+  const QList<ctkVTKDataSetModelPrivate::ArrayLocation> arrays = d->arraysToShow();
+  const QSet<ctkVTKDataSetModelPrivate::ArrayLocation> arrayLocations =
+    QSet<ctkVTKDataSetModelPrivate::ArrayLocation>::fromList(arrays);
+
+  // Remove the rows of the arrays that are no longer listed, contiguous rows
+  // at once.
+  for (int row = this->rowCount() - 1; row >= firstRow; --row)
     {
-    this->setRowCount(0);
+    int count = 0;
+    while (row - count >= firstRow)
+      {
+      ctkVTKDataSetModelPrivate::ArrayLocation arrayLocation =
+        d->arrayLocationFromRow(row - count);
+      if (arrayLocations.contains(arrayLocation))
+        {
+        break;
+        }
+      if (d->ListenAbstractArrayModifiedEvent)
+        {
+        qvtkDisconnect(arrayLocation.first, vtkCommand::ModifiedEvent,
+                       this, SLOT(onArrayModified(vtkObject*)));
+        }
+      ++count;
+      }
+    if (count)
+      {
+      this->removeRows(row - count + 1, count);
+      row -= count - 1;
+      }
     }
 
-  if (d->DataSet.GetPointer() == 0)
+  // Insert the rows of the new arrays, move the rows of the arrays that
+  // changed order.
+  for (int i = 0; i < arrays.count(); ++i)
     {
-    return;
+    const int row = firstRow + i;
+    vtkAbstractArray* array = arrays[i].first;
+    const int location = arrays[i].second;
+    if (row < this->rowCount())
+      {
+      if (d->arrayLocationFromRow(row) == arrays[i])
+        {
+        // The array may have been renamed
+        QStandardItem* arrayItem = this->item(row);
+        if (arrayItem->text() != QString(array->GetName()))
+          {
+          for (int column = 0; column < this->columnCount(); ++column)
+            {
+            this->updateItemFromArray(this->item(row, column), array, location, column);
+            }
+          }
+        continue;
+        }
+      for (int otherRow = row + 1; otherRow < this->rowCount(); ++otherRow)
+        {
+        if (d->arrayLocationFromRow(otherRow) == arrays[i])
+          {
+          this->removeRow(otherRow);
+          break;
+          }
+        }
+      }
+    this->insertArray(array, location, row);
     }
-
-  // Populate scene with nodes
-  this->populateDataSet();
+  Q_ASSERT(this->rowCount() == firstRow + arrays.count());
 }
 
 //------------------------------------------------------------------------------
@@ -477,20 +639,34 @@ void ctkVTKDataSetModel::onDataSetModified(vtkObject* dataSet)
                       this, SLOT(onDataSetCellDataModified(vtkObject*)) );
   d->DataSetCellData = dataSetCellData;
 
-  this->updateDataSet();
+  d->requestUpdate();
 }
 
 //------------------------------------------------------------------------------
 void ctkVTKDataSetModel::onDataSetPointDataModified(vtkObject* dataSetPointData)
 {
   Q_UNUSED(dataSetPointData);
-  this->updateDataSet();
+  Q_D(ctkVTKDataSetModel);
+  d->requestUpdate();
 }
 
 //------------------------------------------------------------------------------
 void ctkVTKDataSetModel::onDataSetCellDataModified(vtkObject* dataSetCellData)
 {
   Q_UNUSED(dataSetCellData);
+  Q_D(ctkVTKDataSetModel);
+  d->requestUpdate();
+}
+
+//------------------------------------------------------------------------------
+void ctkVTKDataSetModel::onDeferredUpdate()
+{
+  Q_D(ctkVTKDataSetModel);
+  if (!d->UpdatePending)
+    {
+    // Already updated
+    return;
+    }
   this->updateDataSet();
 }
 
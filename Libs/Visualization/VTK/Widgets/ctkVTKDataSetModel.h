@@ -65,6 +65,17 @@ class CTK_VISUALIZATION_VTK_WIDGETS_EXPORT ctkVTKDataSetModel
   /// By default no 'Null' item is included.
   Q_PROPERTY(bool includeNullItem READ includeNullItem WRITE setIncludeNullItem)
 
+  /// This property controls when the model is updated after the dataset, its
+  /// point data or its cell data is modified.
+  /// If false, the model is updated as soon as the modification happens.
+  /// If true, the update is deferred until the control returns to the event
+  /// loop, all the modifications done meanwhile are collapsed into one update.
+  /// In both cases, only the rows of the arrays that were added or removed are
+  /// inserted or removed, the other rows are kept.
+  /// setDataSet() and setAttributeTypes() always update the model immediately.
+  /// By default, updates are not deferred.
+  Q_PROPERTY(bool deferUpdates READ deferUpdates WRITE setDeferUpdates)
+
 public:
   typedef ctkVTKDataSetModel Self;
   typedef QStandardItemModel Superclass;
@@ -96,6 +107,9 @@ public:
   void setIncludeNullItem(bool includeNullItem);
   int nullItemLocation()const;
 
+  bool deferUpdates()const;
+  void setDeferUpdates(bool defer);
+
   /// Return the vtkAbstractArray associated to the index.
   /// 0 if the index doesn't contain a vtkAbstractArray
   inline vtkAbstractArray* arrayFromIndex(const QModelIndex& arrayIndex)const;
@@ -122,6 +136,7 @@ protected Q_SLOTS:
   void onDataSetCellDataModified(vtkObject* dataSetCellData);
   void onArrayModified(vtkObject* array);
   void onItemChanged(QStandardItem * item);
+  void onDeferredUpdate();
 
 protected:
 
@@ -131,7 +146,11 @@ protected:
   virtual void insertArray(vtkAbstractArray* array, int location, int row);
   virtual void updateItemFromArray(QStandardItem* item, vtkAbstractArray* array, int location, int column);
   virtual void updateArrayFromItem(vtkAbstractArray* array, QStandardItem* item);
+  /// Synchronize the rows with the arrays of the dataset: the rows of the
+  /// arrays that are no longer listed are removed, the rows of the new arrays
+  /// are inserted and the existing rows are kept.
   virtual void updateDataSet();
+  /// Insert a row for each array of the dataset.
   virtual void populateDataSet();
   virtual void insertNullItem();
   virtual void removeNullItem();
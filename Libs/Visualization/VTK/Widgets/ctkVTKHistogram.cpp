@@ -21,6 +21,10 @@
 /// Qt includes
 #include <QColor>
 #include <QDebug>
+#include <QFutureWatcher>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
 
 /// CTK includes
 #include "ctkVTKHistogram.h"
@@ -39,6 +43,161 @@
 static ctkLogger logger("org.commontk.libs.visualization.core.ctkVTKHistogram");
 //--------------------------------------------------------------------------
 
+namespace
+{
+
+// Arrays with less tuples per thread are binned in the calling thread
+const vtkIdType MinimumTuplesPerThread = 1 << 16;
+
+// Integer arrays with a larger data range have no base bins
+const int MaximumBaseBins = 1 << 20;
+
+//-----------------------------------------------------------------------------
+struct ctkVTKHistogramChunk
+{
+  vtkIdType Begin;
+  vtkIdType End;
+};
+
+//-----------------------------------------------------------------------------
+template <class T>
+void populateBins(int* bins, int binCount, const T* ptr, const T* endPtr,
+                  vtkIdType componentNumber, double minRange)
+{
+  const T offset = static_cast<T>(minRange);
+  for (; ptr < endPtr; ptr += componentNumber)
+    {
+    if (std::numeric_limits<T>::has_quiet_NaN &&
+        vtkMath::IsNan(*ptr))
+      {
+      continue;
+      }
+    const int index = static_cast<int>(*ptr - offset);
+    // values out of the range are not counted
+    if (static_cast<unsigned int>(index) < static_cast<unsigned int>(binCount))
+      {
+      ++bins[index];
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+template <class T>
+void populateIrregularBins(int* bins, int binCount, const T* ptr, const T* endPtr,
+                           vtkIdType componentNumber, double minRange, double binWidth)
+{
+  for (; ptr < endPtr; ptr += componentNumber)
+    {
+    if (std::numeric_limits<T>::has_quiet_NaN &&
+        vtkMath::IsNan(*ptr))
+      {
+      continue;
+      }
+    int index = vtkMath::Floor((static_cast<double>(*ptr) - minRange) * binWidth);
+    // the maximum of the range is counted in the last bin
+    index = (index == binCount) ? binCount - 1 : index;
+    if (static_cast<unsigned int>(index) < static_cast<unsigned int>(binCount))
+      {
+      ++bins[index];
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Computes the bins of a range of tuples, see QtConcurrent::mappedReduced()
+struct ctkVTKHistogramBinner
+{
+  typedef QVector<int> result_type;
+
+  vtkDataArray* Scalars;
+  int Component;
+  int BinCount;
+  double Range[2];
+  bool Regular;
+  /// One tuple of each block of SampleStride tuples is binned, 1 for all of them
+  vtkIdType SampleStride;
+
+  QVector<int> operator()(const ctkVTKHistogramChunk& chunk)const
+  {
+    QVector<int> bins(this->BinCount, 0);
+    switch(this->Scalars->GetDataType())
+      {
+      vtkTemplateMacro(this->populate<VTK_TT>(bins.data(), chunk));
+      }
+    if (this->SampleStride > 1)
+      {
+      // estimate of the counts of all the tuples
+      int* binsPtr = bins.data();
+      for (int i = 0; i < this->BinCount; ++i)
+        {
+        binsPtr[i] *= this->SampleStride;
+        }
+      }
+    return bins;
+  }
+
+  template <class T>
+  void populate(int* bins, const ctkVTKHistogramChunk& chunk)const
+  {
+    // Read-only access, WriteVoidPointer() can copy the array
+    const vtkIdType componentNumber = this->Scalars->GetNumberOfComponents();
+    const T* ptr = static_cast<const T*>(this->Scalars->GetVoidPointer(0)) + this->Component;
+    if (this->SampleStride <= 1)
+      {
+      this->populateRange<T>(bins, ptr + chunk.Begin * componentNumber,
+                             ptr + chunk.End * componentNumber, componentNumber);
+      return;
+      }
+
+    // A random tuple of each block does not alias with the periodic
+    // structures of images, like a fixed stride would.
+    quint32 seed = static_cast<quint32>(chunk.Begin) * 2654435761u + 1u;
+    for (vtkIdType block = chunk.Begin; block < chunk.End; block += this->SampleStride)
+      {
+      seed = seed * 1664525u + 1013904223u;
+      const vtkIdType tuple = block + (seed >> 8) % qMin(this->SampleStride, chunk.End - block);
+      const T* valuePtr = ptr + tuple * componentNumber;
+      this->populateRange<T>(bins, valuePtr, valuePtr + 1, componentNumber);
+      }
+  }
+
+  template <class T>
+  void populateRange(int* bins, const T* ptr, const T* endPtr, vtkIdType componentNumber)const
+  {
+    if (this->Regular)
+      {
+      populateBins<T>(bins, this->BinCount, ptr, endPtr, componentNumber, this->Range[0]);
+      return;
+      }
+    double binWidth = 1.;
+    if (this->Range[1] != this->Range[0])
+      {
+      binWidth = static_cast<double>(this->BinCount) / (this->Range[1] - this->Range[0]);
+      }
+    populateIrregularBins<T>(bins, this->BinCount, ptr, endPtr, componentNumber,
+                             this->Range[0], binWidth);
+  }
+};
+
+//-----------------------------------------------------------------------------
+void addBins(QVector<int>& bins, const QVector<int>& chunkBins)
+{
+  if (bins.isEmpty())
+    {
+    bins = chunkBins;
+    return;
+    }
+  int* binsPtr = bins.data();
+  const int* chunkBinsPtr = chunkBins.constData();
+  const int binCount = bins.size();
+  for (int i = 0; i < binCount; ++i)
+    {
+    binsPtr[i] += chunkBinsPtr[i];
+    }
+}
+
+} // end of anonymous namespace
+
 //-----------------------------------------------------------------------------
 class ctkVTKHistogramPrivate
 {
@@ -52,7 +211,33 @@ public:
   int                           MinBin;
   int                           MaxBin;
 
+  double                        SampleFraction;
+  bool                          Sampled;
+
+  /// One bin per value of the data range of an integer array, from which the
+  /// bins of any range and number of bins are derived
+  QVector<int>                  BaseBins;
+  int                           BaseMin;
+  unsigned long                 BaseMTime;
+
+  QFutureWatcher<QVector<int> > BuildWatcher;
+  /// Keeps the array binned by buildAsync() alive
+  vtkSmartPointer<vtkDataArray> BuildDataArray;
+  bool                          RebuildPending;
+  bool                          BuildingBase;
+  int                           BuildBaseMin;
+  unsigned long                 BuildMTime;
+
   int computeNumberOfBins()const;
+  QList<ctkVTKHistogramChunk> chunks()const;
+  ctkVTKHistogramBinner binner(int binCount, double minRange, double maxRange,
+                               vtkIdType sampleStride = 1)const;
+  QVector<int> computeBins(const ctkVTKHistogramBinner& binner)const;
+  bool baseRange(int& baseMin, int& baseCount)const;
+  bool hasBaseBins()const;
+  QVector<int> deriveBins(int binCount)const;
+  void setBins(const QVector<int>& bins);
+  void cancelBuild();
 };
 
 //-----------------------------------------------------------------------------
@@ -64,6 +249,14 @@ ctkVTKHistogramPrivate::ctkVTKHistogramPrivate()
   this->Range[0] = this->Range[1] = 0.;
   this->MinBin = 0;
   this->MaxBin = 0;
+  this->SampleFraction = 1.;
+  this->Sampled = false;
+  this->BaseMin = 0;
+  this->BaseMTime = 0;
+  this->RebuildPending = false;
+  this->BuildingBase = false;
+  this->BuildBaseMin = 0;
+  this->BuildMTime = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -82,11 +275,182 @@ int ctkVTKHistogramPrivate::computeNumberOfBins()const
   return static_cast<int>(this->Range[1] - this->Range[0]) + 1;
 }
 
+//-----------------------------------------------------------------------------
+QList<ctkVTKHistogramChunk> ctkVTKHistogramPrivate::chunks()const
+{
+  const vtkIdType tupleNumber = this->DataArray->GetNumberOfTuples();
+  const vtkIdType chunkCount = qMax<vtkIdType>(1,
+    qMin<vtkIdType>(QThread::idealThreadCount(), tupleNumber / MinimumTuplesPerThread));
+
+  QList<ctkVTKHistogramChunk> chunks;
+  for (vtkIdType i = 0; i < chunkCount; ++i)
+    {
+    ctkVTKHistogramChunk chunk;
+    chunk.Begin = tupleNumber * i / chunkCount;
+    chunk.End = tupleNumber * (i + 1) / chunkCount;
+    chunks << chunk;
+    }
+  return chunks;
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKHistogramBinner ctkVTKHistogramPrivate::binner(int binCount, double minRange, double maxRange,
+                                                     vtkIdType sampleStride)const
+{
+  ctkVTKHistogramBinner binner;
+  binner.Scalars = this->DataArray;
+  binner.Component = this->Component;
+  binner.BinCount = binCount;
+  binner.Range[0] = minRange;
+  binner.Range[1] = maxRange;
+  // What is the type of the array, discrete or reals
+  binner.Regular = (static_cast<double>(binCount) == (maxRange - minRange + 1));
+  binner.SampleStride = sampleStride;
+  return binner;
+}
+
+//-----------------------------------------------------------------------------
+QVector<int> ctkVTKHistogramPrivate::computeBins(const ctkVTKHistogramBinner& binner)const
+{
+  // Each thread counts a range of tuples in its own bins, which are summed up
+  QList<ctkVTKHistogramChunk> chunks = this->chunks();
+  if (chunks.size() == 1)
+    {
+    return binner(chunks[0]);
+    }
+  return QtConcurrent::blockingMappedReduced<QVector<int> >(
+    chunks, binner, addBins, QtConcurrent::UnorderedReduce);
+}
+
+//-----------------------------------------------------------------------------
+bool ctkVTKHistogramPrivate::baseRange(int& baseMin, int& baseCount)const
+{
+  switch (this->DataArray->GetDataType())
+    {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR:
+    case VTK_UNSIGNED_CHAR:
+    case VTK_SHORT:
+    case VTK_UNSIGNED_SHORT:
+    case VTK_INT:
+    case VTK_UNSIGNED_INT:
+    case VTK_LONG:
+    case VTK_UNSIGNED_LONG:
+    case VTK_ID_TYPE:
+    case VTK_LONG_LONG:
+    case VTK_UNSIGNED_LONG_LONG:
+      break;
+    default:
+      // the bins of real values cannot be derived exactly
+      return false;
+    }
+  double dataRange[2];
+  this->DataArray->GetRange(dataRange, this->Component);
+  if (dataRange[0] > dataRange[1] ||
+      dataRange[1] - dataRange[0] + 1 > MaximumBaseBins)
+    {
+    return false;
+    }
+  baseMin = static_cast<int>(dataRange[0]);
+  baseCount = static_cast<int>(dataRange[1] - dataRange[0]) + 1;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkVTKHistogramPrivate::hasBaseBins()const
+{
+  return !this->BaseBins.isEmpty() &&
+    this->BaseMTime == this->DataArray->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+QVector<int> ctkVTKHistogramPrivate::deriveBins(int binCount)const
+{
+  // The same bin indices as populateBins() and populateIrregularBins()
+  // give to the values
+  QVector<int> bins(binCount, 0);
+  int* binsPtr = bins.data();
+  const bool regular = (static_cast<double>(binCount) == (this->Range[1] - this->Range[0] + 1));
+  const vtkIdType offset = static_cast<vtkIdType>(this->Range[0]);
+  double binWidth = 1.;
+  if (this->Range[1] != this->Range[0])
+    {
+    binWidth = static_cast<double>(binCount) / (this->Range[1] - this->Range[0]);
+    }
+
+  const int* baseBinsPtr = this->BaseBins.constData();
+  const int baseCount = this->BaseBins.size();
+  for (int i = 0; i < baseCount; ++i)
+    {
+    if (baseBinsPtr[i] == 0)
+      {
+      continue;
+      }
+    const vtkIdType value = static_cast<vtkIdType>(this->BaseMin) + i;
+    int index = 0;
+    if (regular)
+      {
+      index = static_cast<int>(value - offset);
+      }
+    else
+      {
+      index = vtkMath::Floor((static_cast<double>(value) - this->Range[0]) * binWidth);
+      index = (index == binCount) ? binCount - 1 : index;
+      }
+    if (static_cast<unsigned int>(index) < static_cast<unsigned int>(binCount))
+      {
+      binsPtr[index] += baseBinsPtr[i];
+      }
+    }
+  return bins;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKHistogramPrivate::setBins(const QVector<int>& bins)
+{
+  const int binCount = bins.size();
+  this->Bins->SetNumberOfComponents(1);
+  this->Bins->SetNumberOfTuples(binCount);
+  if (binCount <= 0)
+    {
+    this->MinBin = 0;
+    this->MaxBin = 0;
+    return;
+    }
+  memcpy(this->Bins->GetPointer(0), bins.constData(), binCount * sizeof(int));
+
+  // update Min/Max values
+  const int* binPtr = bins.constData();
+  const int* endPtr = binPtr + binCount - 1;
+  this->MinBin = *endPtr;
+  this->MaxBin = *endPtr;
+  for (;binPtr < endPtr; ++binPtr)
+    {
+    this->MinBin = qMin(*binPtr, this->MinBin);
+    this->MaxBin = qMax(*binPtr, this->MaxBin);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKHistogramPrivate::cancelBuild()
+{
+  if (this->BuildWatcher.isRunning())
+    {
+    this->BuildWatcher.cancel();
+    this->BuildWatcher.waitForFinished();
+    }
+  this->BuildDataArray = 0;
+  this->RebuildPending = false;
+  this->BuildingBase = false;
+}
+
 //-----------------------------------------------------------------------------
 ctkVTKHistogram::ctkVTKHistogram(QObject* parentObject)
   :ctkHistogram(parentObject)
   , d_ptr(new ctkVTKHistogramPrivate)
 {
+  Q_D(ctkVTKHistogram);
+  connect(&d->BuildWatcher, SIGNAL(finished()), this, SLOT(onBuildFinished()));
 }
 
 //-----------------------------------------------------------------------------
@@ -95,12 +459,16 @@ ctkVTKHistogram::ctkVTKHistogram(vtkDataArray* dataArray,
   :ctkHistogram(parentObject)
   , d_ptr(new ctkVTKHistogramPrivate)
 {
+  Q_D(ctkVTKHistogram);
+  connect(&d->BuildWatcher, SIGNAL(finished()), this, SLOT(onBuildFinished()));
   this->setDataArray(dataArray);
 }
 
 //-----------------------------------------------------------------------------
 ctkVTKHistogram::~ctkVTKHistogram()
 {
+  Q_D(ctkVTKHistogram);
+  d->cancelBuild();
 }
 
 //-----------------------------------------------------------------------------
@@ -247,6 +615,9 @@ void ctkVTKHistogram::setDataArray(vtkDataArray* newDataArray)
     return;
     }
 
+  // the bins of the previous array are not needed anymore
+  d->cancelBuild();
+  d->BaseBins.clear();
   d->DataArray = newDataArray;
   this->resetRange();
   this->qvtkReconnect(d->DataArray,vtkCommand::ModifiedEvent,
@@ -265,6 +636,11 @@ vtkDataArray* ctkVTKHistogram::dataArray()const
 void ctkVTKHistogram::setComponent(int component)
 {
   Q_D(ctkVTKHistogram);
+  if (component != d->Component)
+    {
+    d->cancelBuild();
+    d->BaseBins.clear();
+    }
   d->Component = component;
   // need rebuild
 }
@@ -291,122 +667,163 @@ void ctkVTKHistogram::setNumberOfBins(int number)
 }
 
 //-----------------------------------------------------------------------------
-template <class T>
-void populateBins(vtkIntArray* bins, const ctkVTKHistogram* histogram)
+void ctkVTKHistogram::build()
 {
-  vtkDataArray* scalars = histogram->dataArray();
-  int* binsPtr = bins->WritePointer(0, bins->GetNumberOfTuples());
-
-  // reset bins to 0
-  memset(binsPtr, 0, bins->GetNumberOfComponents()*bins->GetNumberOfTuples()*sizeof(int));
-
-  const vtkIdType componentNumber = scalars->GetNumberOfComponents();
-  const vtkIdType tupleNumber = scalars->GetNumberOfTuples();
-  int component = histogram->component();
+  Q_D(ctkVTKHistogram);
 
-  double range[2];
-  histogram->range(range[0], range[1]);
-  T offset = static_cast<T>(range[0]);
+  d->cancelBuild();
 
-  T* ptr = static_cast<T*>(scalars->WriteVoidPointer(0, tupleNumber));
-  T* endPtr = ptr + tupleNumber * componentNumber;
-  ptr += component;
-  for (; ptr < endPtr; ptr += componentNumber)
+  if (d->DataArray.GetPointer() == 0)
     {
-    Q_ASSERT( (static_cast<long long>(*ptr) - offset) == 
-              (static_cast<int>(*ptr) - offset));
-    binsPtr[static_cast<int>(*ptr - offset)]++;
+    d->MinBin = 0;
+    d->MaxBin = 0;
+    d->Bins->SetNumberOfTuples(0);
+    return;
     }
-}
 
-//-----------------------------------------------------------------------------
-template <class T>
-void populateIrregularBins(vtkIntArray* bins, const ctkVTKHistogram* histogram)
-{
-  vtkDataArray* scalars = histogram->dataArray();
-
-  int* binsPtr = bins->WritePointer(0, bins->GetNumberOfComponents()*bins->GetNumberOfTuples());
-  // reset bins to 0
-  memset(binsPtr, 0, bins->GetNumberOfTuples() * sizeof(int));
+  const int binCount = d->computeNumberOfBins();
 
-  const vtkIdType componentNumber = scalars->GetNumberOfComponents();
-  const vtkIdType tupleNumber = scalars->GetNumberOfTuples();
-  int component = histogram->component();
+  if (binCount <= 0)
+    {
+    d->Bins->SetNumberOfComponents(1);
+    d->Bins->SetNumberOfTuples(binCount);
+    d->MinBin = 0;
+    d->MaxBin = 0;
+    return;
+    }
 
-  double range[2];
-  histogram->range(range[0], range[1]);
-  double offset = range[0];
+  if (d->hasBaseBins())
+    {
+    d->setBins(d->deriveBins(binCount));
+    d->Sampled = false;
+    emit changed();
+    return;
+    }
 
-  double binWidth = 1.;
-  if (range[1] != range[0])
+  if (d->SampleFraction < 1.)
     {
-    binWidth = static_cast<double>(bins->GetNumberOfTuples()) / (range[1] - range[0]);
+    // A preview from a sample of the tuples, refined in the background
+    vtkIdType sampleStride = qMax<vtkIdType>(1, qRound64(1. / d->SampleFraction));
+    d->setBins(d->computeBins(d->binner(binCount, d->Range[0], d->Range[1], sampleStride)));
+    d->Sampled = true;
+    emit changed();
+    this->buildAsync();
+    return;
     }
 
-  T* ptr = static_cast<T*>(scalars->WriteVoidPointer(0, tupleNumber));
-  T* endPtr = ptr + tupleNumber * componentNumber;
-  ptr += component;
-  for (; ptr < endPtr; ptr += componentNumber)
+  int baseMin = 0;
+  int baseCount = 0;
+  if (d->baseRange(baseMin, baseCount))
     {
-    if (std::numeric_limits<T>::has_quiet_NaN &&
-        vtkMath::IsNan(*ptr))
-      {
-      continue;
-      }
-    binsPtr[vtkMath::Floor((static_cast<double>(*ptr) - offset) * binWidth)]++;
+    d->BaseBins = d->computeBins(d->binner(baseCount, baseMin, baseMin + baseCount - 1));
+    d->BaseMin = baseMin;
+    d->BaseMTime = d->DataArray->GetMTime();
+    d->setBins(d->deriveBins(binCount));
+    }
+  else
+    {
+    d->setBins(d->computeBins(d->binner(binCount, d->Range[0], d->Range[1])));
     }
+  d->Sampled = false;
+  emit changed();
 }
 
 //-----------------------------------------------------------------------------
-void ctkVTKHistogram::build()
+void ctkVTKHistogram::buildAsync()
 {
   Q_D(ctkVTKHistogram);
 
-  if (d->DataArray.GetPointer() == 0)
+  if (d->BuildWatcher.isRunning())
     {
-    d->MinBin = 0;
-    d->MaxBin = 0;
-    d->Bins->SetNumberOfTuples(0);
+    // the bins are computed again once the running build finishes
+    d->RebuildPending = true;
     return;
     }
 
   const int binCount = d->computeNumberOfBins();
-
-  d->Bins->SetNumberOfComponents(1);
-  d->Bins->SetNumberOfTuples(binCount);
-
-  if (binCount <= 0)
+  if (d->DataArray.GetPointer() == 0 || binCount <= 0 || d->hasBaseBins())
     {
-    d->MinBin = 0;
-    d->MaxBin = 0;
+    this->build();
     return;
     }
 
-  // What is the type of the array, discrete or reals
-  if (static_cast<double>(binCount) != (d->Range[1] - d->Range[0] + 1))
+  int baseMin = 0;
+  int baseCount = 0;
+  ctkVTKHistogramBinner binner;
+  d->BuildingBase = d->baseRange(baseMin, baseCount);
+  if (d->BuildingBase)
     {
-    switch(d->DataArray->GetDataType())
-      {
-      vtkTemplateMacro(populateIrregularBins<VTK_TT>(d->Bins, this));
-      }
+    binner = d->binner(baseCount, baseMin, baseMin + baseCount - 1);
     }
   else
     {
-    switch(d->DataArray->GetDataType())
-      {
-      vtkTemplateMacro(populateBins<VTK_TT>(d->Bins, this));
-      }
+    binner = d->binner(binCount, d->Range[0], d->Range[1]);
     }
-  // update Min/Max values
-  int* binPtr = d->Bins->GetPointer(0);
-  int* endPtr = d->Bins->GetPointer(binCount-1);
-  d->MinBin = *endPtr;
-  d->MaxBin = *endPtr;
-  for (;binPtr < endPtr; ++binPtr)
+
+  d->RebuildPending = false;
+  d->BuildDataArray = d->DataArray;
+  d->BuildBaseMin = baseMin;
+  d->BuildMTime = d->DataArray->GetMTime();
+  d->BuildWatcher.setFuture(QtConcurrent::mappedReduced<QVector<int> >(
+    d->chunks(), binner, addBins, QtConcurrent::UnorderedReduce));
+}
+
+//-----------------------------------------------------------------------------
+bool ctkVTKHistogram::isBuilding()const
+{
+  Q_D(const ctkVTKHistogram);
+  return d->BuildWatcher.isRunning();
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKHistogram::setSampleFraction(double fraction)
+{
+  Q_D(ctkVTKHistogram);
+  if (fraction <= 0. || fraction > 1.)
     {
-    d->MinBin = qMin(*binPtr, d->MinBin);
-    d->MaxBin = qMax(*binPtr, d->MaxBin);
+    logger.warn("the sample fraction must be in ]0, 1]");
+    fraction = qBound(1.e-6, fraction, 1.);
+    }
+  d->SampleFraction = fraction;
+}
+
+//-----------------------------------------------------------------------------
+double ctkVTKHistogram::sampleFraction()const
+{
+  Q_D(const ctkVTKHistogram);
+  return d->SampleFraction;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkVTKHistogram::isSampled()const
+{
+  Q_D(const ctkVTKHistogram);
+  return d->Sampled;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKHistogram::onBuildFinished()
+{
+  Q_D(ctkVTKHistogram);
+  if (d->BuildWatcher.isCanceled())
+    {
+    return;
+    }
+  QVector<int> bins = d->BuildWatcher.result();
+  d->BuildDataArray = 0;
+  if (d->BuildingBase)
+    {
+    d->BaseBins = bins;
+    d->BaseMin = d->BuildBaseMin;
+    d->BaseMTime = d->BuildMTime;
+    }
+  if (d->RebuildPending)
+    {
+    this->buildAsync();
+    return;
     }
+  d->setBins(d->BuildingBase ? d->deriveBins(d->computeNumberOfBins()) : bins);
+  d->Sampled = false;
   emit changed();
 }
 
@@ -42,6 +42,7 @@ class CTK_VISUALIZATION_VTK_WIDGETS_EXPORT ctkVTKHistogram: public ctkHistogram
   Q_PROPERTY(QVariant maxValue READ maxValue)
   Q_PROPERTY(QVariant minValue READ minValue)
   Q_PROPERTY(int numberOfBins READ numberOfBins WRITE setNumberOfBins)
+  Q_PROPERTY(double sampleFraction READ sampleFraction WRITE setSampleFraction)
 public:
   ctkVTKHistogram(QObject* parent = 0);
   ctkVTKHistogram(vtkDataArray* dataArray, QObject* parent = 0);
@@ -77,7 +78,38 @@ public:
 
   Q_INVOKABLE virtual void removeControlPoint( qreal pos );
 
+  /// Compute the bins from the data array, on all the cores for large arrays.
+  /// A build started by buildAsync() is canceled.
+  /// The first build of an integer array also counts each value of its data
+  /// range. The bins of the next builds are derived from these counts, without
+  /// reading the array again, until the array or the component changes.
+  /// If sampleFraction() is less than 1 and no such counts exist, a preview is
+  /// computed from a sample of the tuples and refined by buildAsync().
+  /// \sa isSampled()
   Q_INVOKABLE virtual void build();
+
+  /// Compute the bins in the thread pool and emit changed() when they are
+  /// computed. The previous bins are kept until then. The data array must not
+  /// be modified while the bins are computed.
+  /// \sa isBuilding()
+  Q_INVOKABLE void buildAsync();
+
+  /// Return true while the bins of buildAsync() are computed.
+  bool isBuilding()const;
+
+  /// Set the fraction of the tuples, in ]0, 1], that build() bins for a quick
+  /// preview of large arrays. The counts of the preview are scaled to estimate
+  /// the counts of all the tuples. 1 by default: no preview.
+  void setSampleFraction(double fraction);
+  double sampleFraction()const;
+
+  /// Return true if the bins are the estimate of a preview.
+  /// \sa setSampleFraction()
+  bool isSampled()const;
+
+protected Q_SLOTS:
+  void onBuildFinished();
+
 protected:
   qreal indexToPos(int index)const;
   int posToIndex(qreal pos)const;
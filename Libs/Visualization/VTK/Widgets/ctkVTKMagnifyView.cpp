@@ -59,6 +59,7 @@ ctkVTKMagnifyViewPrivate::ctkVTKMagnifyViewPrivate(ctkVTKMagnifyView& object)
   this->EventHandler.UpdateInterval = 20;
   this->EventHandler.TimerId = 0;
 
+  this->PixelData = vtkSmartPointer<vtkUnsignedCharArray>::New();
 }
 
 // --------------------------------------------------------------------------
@@ -354,27 +355,37 @@ void ctkVTKMagnifyViewPrivate::updatePixmap()
     }
   q->setAlignment(alignment);
 
-  // Retrieve the pixel data into a QImage (flip vertically to move from render
-  // window coordinates to Qt coordinates)
+  // Read back only the region to magnify. The buffers are kept from one update
+  // to the next, they are reallocated only when the region size changes.
   QSize actualSize(indexRight-indexLeft+1, indexTop-indexBottom+1);
-  QImage image(actualSize.width(), actualSize.height(), QImage::Format_RGB32);
-  vtkUnsignedCharArray * pixelData = vtkUnsignedCharArray::New();
-  pixelData->SetArray(image.bits(), actualSize.width() * actualSize.height() * 4, 1);
   int front = renderWindow->GetDoubleBuffer();
   int success = renderWindow->GetRGBACharPixelData(
-      indexLeft, indexBottom, indexRight, indexTop, front, pixelData);
+      indexLeft, indexBottom, indexRight, indexTop, front, this->PixelData);
   if (!success)
     {
     return;
     }
-  pixelData->Delete();
-  image = image.rgbSwapped();
-  image = image.mirrored();
+  if (this->RegionImage.size() != actualSize)
+    {
+    this->RegionImage = QImage(actualSize, QImage::Format_RGB32);
+    }
+
+  // Convert the RGBA pixels into the QImage and flip vertically to move from
+  // render window coordinates to Qt coordinates, in a single pass.
+  const unsigned char* pixelPtr = this->PixelData->GetPointer(0);
+  for (int row = actualSize.height() - 1; row >= 0; --row)
+    {
+    QRgb* linePtr = reinterpret_cast<QRgb*>(this->RegionImage.scanLine(row));
+    for (int column = 0; column < actualSize.width(); ++column, pixelPtr += 4)
+      {
+      linePtr[column] = qRgb(pixelPtr[0], pixelPtr[1], pixelPtr[2]);
+      }
+    }
 
   // Scale the image to zoom, using FastTransformation to prevent smoothing
   QSize imageSize = actualSize * this->Magnification;
-  image = image.scaled(imageSize, Qt::KeepAspectRatioByExpanding,
-                       Qt::FastTransformation);
+  QImage image = this->RegionImage.scaled(imageSize, Qt::KeepAspectRatioByExpanding,
+                                          Qt::FastTransformation);
 
   // Crop the magnified image to solve the problem of magnified partial pixels
   double errorLeft
@@ -22,6 +22,7 @@
 #define __ctkVTKMagnifyView_p_h
 
 // Qt includes
+#include <QImage>
 #include <QPointer>
 class QPointF;
 class QTimerEvent;
@@ -31,7 +32,9 @@ class QTimerEvent;
 #include <ctkVTKObject.h>
 
 // VTK includes
+#include <vtkSmartPointer.h>
 class QVTKWidget;
+class vtkUnsignedCharArray;
 
 /// \ingroup Visualization_VTK_Widgets
 class ctkVTKMagnifyViewPrivate : public QObject
@@ -83,6 +86,10 @@ public:
   double Magnification;
   bool ObserveRenderWindowEvents;
   EventHandlerStruct EventHandler;
+
+  /// Buffers of updatePixmap(), reused from one update to the next
+  vtkSmartPointer<vtkUnsignedCharArray> PixelData;
+  QImage RegionImage;
 };
 
 #endif
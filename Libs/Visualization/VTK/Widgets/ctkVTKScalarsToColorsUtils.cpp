@@ -22,19 +22,169 @@
 #include <QApplication>
 #include <QBuffer>
 #include <QImage>
+#include <QList>
 #include <QStyle>
+#include <QVector>
 
 // CTK includes
 #include "ctkLogger.h"
 #include "ctkVTKScalarsToColorsUtils.h"
 
 // VTK includes
+#include <vtkColorTransferFunction.h>
+#include <vtkDiscretizableColorTransferFunction.h>
 #include <vtkScalarsToColors.h>
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 //----------------------------------------------------------------------------
 static ctkLogger logger("org.commontk.visualization.vtk.widgets.ctkVTKScalarsToColorsUtils");
 //----------------------------------------------------------------------------
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Image previously generated for a vtkScalarsToColors.
+/// The MTime of VTK objects is unique across all the objects, an entry can't
+/// be mistaken for the one of another object allocated at the same address.
+struct ScalarsToColorsImage
+{
+  vtkScalarsToColors* ScalarsToColors;
+  unsigned long MTime;
+  double Range[2];
+  /// Nodes (x, r, g, b, midpoint, sharpness) of a vtkColorTransferFunction
+  QVector<double> Nodes;
+  /// Interpolation settings of a vtkColorTransferFunction
+  QVector<int> Settings;
+  QImage Image;
+};
+
+/// Most recently used first
+QList<ScalarsToColorsImage> ScalarsToColorsImages;
+const int MaximumScalarsToColorsImages = 16;
+
+//----------------------------------------------------------------------------
+/// Only the nodes of a vtkColorTransferFunction tell which part of the image
+/// changed, other vtkScalarsToColors are always mapped entirely.
+vtkColorTransferFunction* nodeBasedFunction(vtkScalarsToColors* scalarsToColors)
+{
+  if (vtkDiscretizableColorTransferFunction::SafeDownCast(scalarsToColors))
+    {
+    // Discretization changes the colors of the whole range
+    return 0;
+    }
+  return vtkColorTransferFunction::SafeDownCast(scalarsToColors);
+}
+
+//----------------------------------------------------------------------------
+void functionState(vtkScalarsToColors* scalarsToColors,
+                   QVector<double>& nodes, QVector<int>& settings)
+{
+  nodes.clear();
+  settings.clear();
+  vtkColorTransferFunction* colorTransferFunction = nodeBasedFunction(scalarsToColors);
+  if (!colorTransferFunction)
+    {
+    return;
+    }
+  const int size = colorTransferFunction->GetSize();
+  nodes.resize(6 * size);
+  for (int i = 0; i < size; ++i)
+    {
+    colorTransferFunction->GetNodeValue(i, nodes.data() + 6 * i);
+    }
+  settings << colorTransferFunction->GetColorSpace()
+           << colorTransferFunction->GetHSVWrap()
+           << colorTransferFunction->GetScale()
+           << colorTransferFunction->GetClamping();
+}
+
+//----------------------------------------------------------------------------
+/// Map the values of the columns [firstColumn, lastColumn] of the image in
+/// one pass and copy them to all the lines.
+void mapColumns(vtkScalarsToColors* scalarsToColors, const double range[2],
+                QImage& image, int firstColumn, int lastColumn)
+{
+  const int width = image.width();
+  const int count = lastColumn - firstColumn + 1;
+  const double step = width > 1 ? (range[1] - range[0]) / (width - 1) : 0.;
+  QVector<double> values(count);
+  for (int i = 0; i < count; ++i)
+    {
+    values[i] = range[0] + (firstColumn + i) * step;
+    }
+  QVector<unsigned char> colors(VTK_RGBA * count);
+  scalarsToColors->MapScalarsThroughTable2(
+    values.data(), colors.data(), VTK_DOUBLE, count, 1, VTK_RGBA);
+
+  // VTK colors are RGBA bytes, QImage pixels are 0xAARRGGBB.
+  QRgb* firstLine = reinterpret_cast<QRgb*>(image.scanLine(0)) + firstColumn;
+  const unsigned char* colorsPtr = colors.constData();
+  for (int i = 0; i < count; ++i, colorsPtr += VTK_RGBA)
+    {
+    firstLine[i] = qRgb(colorsPtr[0], colorsPtr[1], colorsPtr[2]);
+    }
+  for (int i = 1; i < image.height(); ++i)
+    {
+    memcpy(reinterpret_cast<QRgb*>(image.scanLine(i)) + firstColumn,
+           firstLine, count * sizeof(QRgb));
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Return in [firstColumn, lastColumn] the columns of the image that depend
+/// on the nodes that changed, false if the whole image must be mapped.
+bool changedColumns(const ScalarsToColorsImage& cachedImage,
+                    const QVector<double>& nodes, const QVector<int>& settings,
+                    const double range[2], int& firstColumn, int& lastColumn)
+{
+  const int width = cachedImage.Image.width();
+  if (nodes.isEmpty() || width < 2 ||
+      nodes.size() != cachedImage.Nodes.size() ||
+      settings != cachedImage.Settings ||
+      range[0] != cachedImage.Range[0] || range[1] != cachedImage.Range[1] ||
+      range[1] <= range[0])
+    {
+    return false;
+    }
+  const int nodeCount = nodes.size() / 6;
+  int firstNode = -1;
+  int lastNode = -1;
+  for (int i = 0; i < nodeCount; ++i)
+    {
+    if (!std::equal(nodes.constData() + 6 * i, nodes.constData() + 6 * (i + 1),
+                    cachedImage.Nodes.constData() + 6 * i))
+      {
+      if (firstNode < 0)
+        {
+        firstNode = i;
+        }
+      lastNode = i;
+      }
+    }
+  if (firstNode < 0)
+    {
+    // Modified for another reason, e.g. a setting not compared here
+    return false;
+    }
+  // The segments on both sides of a changed node change, the neighbor nodes
+  // are the same in the old and new functions.
+  const double minValue = nodes[6 * qMax(firstNode - 1, 0)];
+  const double maxValue = nodes[6 * qMin(lastNode + 1, nodeCount - 1)];
+  const double columnsPerValue = (width - 1) / (range[1] - range[0]);
+  firstColumn = qBound(0, static_cast<int>(
+    std::floor((minValue - range[0]) * columnsPerValue)), width - 1);
+  lastColumn = qBound(0, static_cast<int>(
+    std::ceil((maxValue - range[0]) * columnsPerValue)), width - 1);
+  return true;
+}
+
+} // end namespace
+
 //----------------------------------------------------------------------------
 QImage ctk::scalarsToColorsImage(vtkScalarsToColors* scalarsToColors, const QSize& size)
 {
@@ -49,33 +199,52 @@ QImage ctk::scalarsToColorsImage(vtkScalarsToColors* scalarsToColors, const QSiz
     {
     width = height = qApp->style()->pixelMetric(QStyle::PM_LargeIconSize);
     }
-  
-  double* values = new double[width];
-  const double* range = scalarsToColors->GetRange();
-  for (int i = 0; i < width; ++i)
+
+  ScalarsToColorsImage cachedImage;
+  cachedImage.ScalarsToColors = 0;
+  for (int i = 0; i < ScalarsToColorsImages.count(); ++i)
     {
-    values[i] = range[0] + i * (range[1] - range[0]) / (width - 1);
+    const ScalarsToColorsImage& image = ScalarsToColorsImages[i];
+    if (image.ScalarsToColors == scalarsToColors &&
+        image.Image.size() == QSize(width, height))
+      {
+      cachedImage = ScalarsToColorsImages.takeAt(i);
+      break;
+      }
     }
-
-  QImage transferFunctionImage(width, height, QImage::Format_RGB32);
-  unsigned char* colors = transferFunctionImage.bits();
-  // Map the first line
-  scalarsToColors->MapScalarsThroughTable2(
-    values, colors, VTK_DOUBLE, width, 1, VTK_RGBA);
-  delete [] values;
-  // Pixels are not correctly ordered, reorder them correctly
-  unsigned char* colorsPtr = colors;
-  QRgb* rgbPtr = reinterpret_cast<QRgb*>(colors);
-  for (int i = 0; i < width; ++i)
+  if (cachedImage.ScalarsToColors &&
+      cachedImage.MTime == scalarsToColors->GetMTime())
     {
-    *(rgbPtr++) = QColor(colorsPtr[0], colorsPtr[1], colorsPtr[2]).rgb();
-    colorsPtr += 4;
+    ScalarsToColorsImages.prepend(cachedImage);
+    return cachedImage.Image;
     }
-  // Fill the other lines
-  for (int i = 1; i < height; ++i)
+
+  const double* range = scalarsToColors->GetRange();
+  QVector<double> nodes;
+  QVector<int> settings;
+  functionState(scalarsToColors, nodes, settings);
+
+  int firstColumn = 0;
+  int lastColumn = width - 1;
+  if (!cachedImage.ScalarsToColors ||
+      !changedColumns(cachedImage, nodes, settings, range, firstColumn, lastColumn))
     {
-    memcpy(colors + i*VTK_RGBA*width, colors, VTK_RGBA*width);
+    cachedImage.Image = QImage(width, height, QImage::Format_RGB32);
+    firstColumn = 0;
+    lastColumn = width - 1;
     }
+  mapColumns(scalarsToColors, range, cachedImage.Image, firstColumn, lastColumn);
 
-  return transferFunctionImage;
+  cachedImage.ScalarsToColors = scalarsToColors;
+  cachedImage.MTime = scalarsToColors->GetMTime();
+  cachedImage.Range[0] = range[0];
+  cachedImage.Range[1] = range[1];
+  cachedImage.Nodes = nodes;
+  cachedImage.Settings = settings;
+  ScalarsToColorsImages.prepend(cachedImage);
+  while (ScalarsToColorsImages.count() > MaximumScalarsToColorsImages)
+    {
+    ScalarsToColorsImages.removeLast();
+    }
+  return cachedImage.Image;
 }
@@ -28,15 +28,20 @@
 // VTK includes
 #include <vtkCamera.h>
 #include <vtkFollower.h>
+#include <vtkImageData.h>
 #include <vtkInteractorStyle.h>
 #include <vtkMath.h>
 #include <vtkOutlineSource.h>
+#include <vtkPointData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
+#include <vtkPropCollection.h>
 #include <vtkRenderWindow.h>
 #include <vtkRenderWindowInteractor.h>
 #include <vtkRenderer.h>
 #include <vtkSmartPointer.h>
+#include <vtkTexture.h>
+#include <vtkUnsignedCharArray.h>
 #include <vtkVersion.h>
 #include <vtkWeakPointer.h>
 
@@ -62,14 +67,41 @@ public:
   void updateCamera();
   void resetCamera();
 
+  /// Renderer containing the copy of the scene: the renderer of the view, or
+  /// OffscreenRenderer when rendering offscreen.
+  vtkRenderer* sceneRenderer()const;
+  vtkCamera* sceneCamera()const;
+
+  /// Move the props and the camera of a renderer to another one
+  void moveScene(vtkRenderer* from, vtkRenderer* to);
+
+  /// Render the scene offscreen if the camera, the props or the view size
+  /// changed since the last offscreen render.
+  void updateOffscreenImage();
+  unsigned long sceneMTime()const;
+
+  /// Render window shared by all the thumbnail views rendering offscreen
+  static vtkRenderWindow* SharedRenderWindow;
+  static int SharedRenderWindowUsers;
+
   vtkRenderer*                       Renderer;
   vtkWeakPointer<vtkRenderWindowInteractor> Interactor;
   
   vtkOutlineSource*                  FOVBox;
   vtkPolyDataMapper*                 FOVBoxMapper;
   vtkFollower*                       FOVBoxActor;
+
+  bool                               OffscreenRendering;
+  double                             OffscreenScale;
+  vtkSmartPointer<vtkRenderer>       OffscreenRenderer;
+  vtkSmartPointer<vtkImageData>      OffscreenImage;
+  vtkSmartPointer<vtkTexture>        OffscreenTexture;
+  unsigned long                      OffscreenImageMTime;
 };
 
+vtkRenderWindow* ctkVTKThumbnailViewPrivate::SharedRenderWindow = 0;
+int ctkVTKThumbnailViewPrivate::SharedRenderWindowUsers = 0;
+
 //--------------------------------------------------------------------------
 // ctkVTKThumbnailViewPrivate methods
 
@@ -83,11 +115,21 @@ ctkVTKThumbnailViewPrivate::ctkVTKThumbnailViewPrivate(ctkVTKThumbnailView& obje
   this->FOVBox = 0;
   this->FOVBoxMapper = 0;
   this->FOVBoxActor = 0;
+
+  this->OffscreenRendering = false;
+  this->OffscreenScale = 0.5;
+  this->OffscreenImageMTime = 0;
 }
 
 //---------------------------------------------------------------------------
 ctkVTKThumbnailViewPrivate::~ctkVTKThumbnailViewPrivate()
 {
+  if (this->OffscreenRendering &&
+      --ctkVTKThumbnailViewPrivate::SharedRenderWindowUsers == 0)
+    {
+    ctkVTKThumbnailViewPrivate::SharedRenderWindow->Delete();
+    ctkVTKThumbnailViewPrivate::SharedRenderWindow = 0;
+    }
   this->FOVBox->Delete();
   this->FOVBoxMapper->Delete();
   this->FOVBoxActor->Delete();
@@ -127,7 +169,6 @@ void ctkVTKThumbnailViewPrivate::init()
 //---------------------------------------------------------------------------
 void ctkVTKThumbnailViewPrivate::initCamera()
 {
-  Q_Q(ctkVTKThumbnailView);
   vtkRenderer* ren = this->Renderer;
   if (!ren)
     {
@@ -138,7 +179,7 @@ void ctkVTKThumbnailViewPrivate::initCamera()
     {
     return;
     }
-  vtkCamera *navcam = q->activeCamera();
+  vtkCamera *navcam = this->sceneCamera();
   if (!navcam)
     {
     return;
@@ -154,7 +195,6 @@ void ctkVTKThumbnailViewPrivate::initCamera()
 //---------------------------------------------------------------------------
 void ctkVTKThumbnailViewPrivate::updateBounds()
 {
-  Q_Q(ctkVTKThumbnailView);
   vtkRenderer* ren = this->Renderer;
   
   vtkActorCollection *mainActors;
@@ -164,11 +204,12 @@ void ctkVTKThumbnailViewPrivate::updateBounds()
 
   // iterate thru the actor collection,
   // remove item, delete actor, delete mapper.
-  vtkActorCollection *navActors = q->renderer()->GetActors();
+  vtkRenderer* navren = this->sceneRenderer();
+  vtkActorCollection *navActors = navren->GetActors();
     
   if (!navActors)
     {
-    q->renderer()->RemoveAllViewProps();
+    navren->RemoveAllViewProps();
     navActors->RemoveAllItems();
     }
   if (!ren)
@@ -197,7 +238,7 @@ void ctkVTKThumbnailViewPrivate::updateBounds()
     }
 
   // add the little FOV box to NavigationWidget's actors
-  q->renderer()->AddViewProp(this->FOVBoxActor);
+  navren->AddViewProp(this->FOVBoxActor);
 
   for(mainActors->InitTraversal(); (mainActor = mainActors->GetNextActor()); )
     {
@@ -231,7 +272,7 @@ void ctkVTKThumbnailViewPrivate::updateBounds()
       newActor->SetMapper ( newMapper );
       newMapper->Delete();
       
-      q->renderer()->AddActor( newActor );
+      navren->AddActor( newActor );
       newActor->Delete();
       }
     }
@@ -240,7 +281,6 @@ void ctkVTKThumbnailViewPrivate::updateBounds()
 //---------------------------------------------------------------------------
 void ctkVTKThumbnailViewPrivate::updateCamera()
 {
-  Q_Q(ctkVTKThumbnailView);
    // Scale the FOVBox actor to show the
   // MainViewer's window on the scene.
   vtkRenderer *ren = this->Renderer;
@@ -261,8 +301,8 @@ void ctkVTKThumbnailViewPrivate::updateCamera()
   double boxDist = camDist * 0.89;
 
   // configure navcam based on main renderer's camera
-  vtkRenderer *navren = q->renderer();
-  vtkCamera *navcam = q->activeCamera();
+  vtkRenderer *navren = this->sceneRenderer();
+  vtkCamera *navcam = this->sceneCamera();
 
   if ( navcam == 0 )
     {
@@ -341,10 +381,8 @@ void ctkVTKThumbnailViewPrivate::updateCamera()
 // ----------------------------------------------------------------------------
 void ctkVTKThumbnailViewPrivate::resetCamera()
 {
-  Q_Q(ctkVTKThumbnailView);
-  
-  vtkRenderer *ren = q->renderer();
-  vtkCamera *cam = q->activeCamera();
+  vtkRenderer *ren = this->sceneRenderer();
+  vtkCamera *cam = this->sceneCamera();
   
   if (!ren || !cam)
     {
@@ -419,6 +457,91 @@ void ctkVTKThumbnailViewPrivate::resetCamera()
   cam->SetParallelScale(radius);
 }
 
+// ----------------------------------------------------------------------------
+vtkRenderer* ctkVTKThumbnailViewPrivate::sceneRenderer()const
+{
+  Q_Q(const ctkVTKThumbnailView);
+  return this->OffscreenRendering ?
+    this->OffscreenRenderer.GetPointer() : q->renderer();
+}
+
+// ----------------------------------------------------------------------------
+vtkCamera* ctkVTKThumbnailViewPrivate::sceneCamera()const
+{
+  Q_Q(const ctkVTKThumbnailView);
+  return this->OffscreenRendering ?
+    this->OffscreenRenderer->GetActiveCamera() : q->activeCamera();
+}
+
+// ----------------------------------------------------------------------------
+void ctkVTKThumbnailViewPrivate::moveScene(vtkRenderer* from, vtkRenderer* to)
+{
+  vtkPropCollection* props = from->GetViewProps();
+  vtkProp* prop;
+  for (props->InitTraversal(); (prop = props->GetNextProp()); )
+    {
+    to->AddViewProp(prop);
+    }
+  from->RemoveAllViewProps();
+  to->GetActiveCamera()->DeepCopy(from->GetActiveCamera());
+  this->FOVBoxActor->SetCamera(to->GetActiveCamera());
+}
+
+// ----------------------------------------------------------------------------
+unsigned long ctkVTKThumbnailViewPrivate::sceneMTime()const
+{
+  unsigned long mtime = this->OffscreenRenderer->GetActiveCamera()->GetMTime();
+  vtkPropCollection* props = this->OffscreenRenderer->GetViewProps();
+  vtkProp* prop;
+  for (props->InitTraversal(); (prop = props->GetNextProp()); )
+    {
+    // Includes the modifications of the mappers and their inputs
+    mtime = qMax(mtime, prop->GetRedrawMTime());
+    }
+  return mtime;
+}
+
+// ----------------------------------------------------------------------------
+void ctkVTKThumbnailViewPrivate::updateOffscreenImage()
+{
+  Q_Q(ctkVTKThumbnailView);
+  const int* viewSize = q->renderWindow()->GetSize();
+  const int width = qMax(1, static_cast<int>(viewSize[0] * this->OffscreenScale));
+  const int height = qMax(1, static_cast<int>(viewSize[1] * this->OffscreenScale));
+  int imageSize[3] = {0, 0, 0};
+  if (this->OffscreenImage)
+    {
+    this->OffscreenImage->GetDimensions(imageSize);
+    }
+  const unsigned long sceneMTime = this->sceneMTime();
+  if (this->OffscreenImage &&
+      imageSize[0] == width && imageSize[1] == height &&
+      sceneMTime <= this->OffscreenImageMTime)
+    {
+    // Reuse the last image
+    return;
+    }
+
+  vtkRenderWindow* renderWindow = ctkVTKThumbnailViewPrivate::SharedRenderWindow;
+  this->OffscreenRenderer->SetBackground(q->renderer()->GetBackground());
+  renderWindow->SetSize(width, height);
+  renderWindow->AddRenderer(this->OffscreenRenderer);
+  renderWindow->Render();
+  vtkSmartPointer<vtkUnsignedCharArray> pixels =
+    vtkSmartPointer<vtkUnsignedCharArray>::New();
+  renderWindow->GetRGBACharPixelData(0, 0, width - 1, height - 1, 1, pixels);
+  renderWindow->RemoveRenderer(this->OffscreenRenderer);
+
+  if (!this->OffscreenImage)
+    {
+    this->OffscreenImage = vtkSmartPointer<vtkImageData>::New();
+    }
+  this->OffscreenImage->SetDimensions(width, height, 1);
+  this->OffscreenImage->GetPointData()->SetScalars(pixels);
+  this->OffscreenImage->Modified();
+  this->OffscreenImageMTime = this->sceneMTime();
+}
+
 // --------------------------------------------------------------------------
 // ctkVTKThumbnailView methods
 
@@ -477,3 +600,84 @@ void ctkVTKThumbnailView::updateBounds()
   d->updateBounds();
   this->scheduleRender();
 }
+
+//---------------------------------------------------------------------------
+void ctkVTKThumbnailView::setOffscreenRendering(bool offscreen)
+{
+  Q_D(ctkVTKThumbnailView);
+  if (d->OffscreenRendering == offscreen)
+    {
+    return;
+    }
+  if (offscreen)
+    {
+    if (ctkVTKThumbnailViewPrivate::SharedRenderWindowUsers++ == 0)
+      {
+      vtkRenderWindow* renderWindow = vtkRenderWindow::New();
+      renderWindow->SetOffScreenRendering(1);
+      ctkVTKThumbnailViewPrivate::SharedRenderWindow = renderWindow;
+      }
+    d->OffscreenRenderer = vtkSmartPointer<vtkRenderer>::New();
+    d->OffscreenImage = 0;
+    d->OffscreenTexture = vtkSmartPointer<vtkTexture>::New();
+    d->OffscreenTexture->InterpolateOn();
+    d->moveScene(this->renderer(), d->OffscreenRenderer);
+    d->updateOffscreenImage();
+#if VTK_MAJOR_VERSION <= 5
+    d->OffscreenTexture->SetInput(d->OffscreenImage);
+#else
+    d->OffscreenTexture->SetInputData(d->OffscreenImage);
+#endif
+    this->renderer()->SetBackgroundTexture(d->OffscreenTexture);
+    this->renderer()->TexturedBackgroundOn();
+    }
+  else
+    {
+    this->renderer()->TexturedBackgroundOff();
+    this->renderer()->SetBackgroundTexture(0);
+    d->moveScene(d->OffscreenRenderer, this->renderer());
+    d->OffscreenRenderer = 0;
+    d->OffscreenImage = 0;
+    d->OffscreenTexture = 0;
+    if (--ctkVTKThumbnailViewPrivate::SharedRenderWindowUsers == 0)
+      {
+      ctkVTKThumbnailViewPrivate::SharedRenderWindow->Delete();
+      ctkVTKThumbnailViewPrivate::SharedRenderWindow = 0;
+      }
+    }
+  d->OffscreenRendering = offscreen;
+  this->scheduleRender();
+}
+
+//---------------------------------------------------------------------------
+bool ctkVTKThumbnailView::offscreenRendering()const
+{
+  Q_D(const ctkVTKThumbnailView);
+  return d->OffscreenRendering;
+}
+
+//---------------------------------------------------------------------------
+void ctkVTKThumbnailView::setOffscreenScale(double scale)
+{
+  Q_D(ctkVTKThumbnailView);
+  d->OffscreenScale = qBound(0.01, scale, 1.);
+  this->scheduleRender();
+}
+
+//---------------------------------------------------------------------------
+double ctkVTKThumbnailView::offscreenScale()const
+{
+  Q_D(const ctkVTKThumbnailView);
+  return d->OffscreenScale;
+}
+
+//---------------------------------------------------------------------------
+void ctkVTKThumbnailView::forceRender()
+{
+  Q_D(ctkVTKThumbnailView);
+  if (d->OffscreenRendering && this->renderEnabled())
+    {
+    d->updateOffscreenImage();
+    }
+  this->Superclass::forceRender();
+}
@@ -29,10 +29,24 @@
 class ctkVTKThumbnailViewPrivate;
 
 /// \ingroup Visualization_VTK_Widgets
+/// Show a copy of the scene of a renderer, with a box representing the field
+/// of view of the renderer camera. The thumbnail is updated when the
+/// interaction in the renderer ends.
 class CTK_VISUALIZATION_VTK_WIDGETS_EXPORT ctkVTKThumbnailView : public ctkVTKRenderView
 {
   Q_OBJECT
   QVTK_OBJECT
+  /// If true, the copy of the scene is rendered in an offscreen render window
+  /// shared by all the thumbnail views, and the view only shows the resulting
+  /// image. The scene is rendered again only when the camera, the actors or
+  /// the view size changed, other renders of the view reuse the image.
+  /// false by default.
+  /// \sa offscreenScale
+  Q_PROPERTY(bool offscreenRendering READ offscreenRendering WRITE setOffscreenRendering)
+  /// Resolution of the offscreen image relative to the view size.
+  /// 0.5 by default.
+  /// \sa offscreenRendering
+  Q_PROPERTY(double offscreenScale READ offscreenScale WRITE setOffscreenScale)
 
 public:
   /// Superclass typedef
@@ -44,6 +58,16 @@ public:
 
   void setRendererToListen(vtkRenderer* renderer);
 
+  void setOffscreenRendering(bool offscreen);
+  bool offscreenRendering()const;
+
+  void setOffscreenScale(double scale);
+  double offscreenScale()const;
+
+public Q_SLOTS:
+  /// Reimplemented to update the offscreen image first, if needed.
+  virtual void forceRender();
+
 protected Q_SLOTS:
   void checkAbort();
   void updateBounds();
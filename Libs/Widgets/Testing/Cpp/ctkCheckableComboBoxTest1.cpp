@@ -102,6 +102,46 @@ int ctkCheckableComboBoxTest1(int argc, char * argv [] )
     return EXIT_FAILURE;
     }
 
+  // The checked indexes are kept in the order of the model
+  comboBox.setCheckState(firstIndex, Qt::Unchecked);
+  comboBox.setCheckState(comboBox.model()->index(2, 0), Qt::Unchecked);
+  comboBox.setCheckState(firstIndex, Qt::Checked);
+  QModelIndexList checkedIndexes = comboBox.checkedIndexes();
+  if (checkedIndexes.count() != 3 ||
+      checkedIndexes[0].row() != 0 ||
+      checkedIndexes[1].row() != 1 ||
+      checkedIndexes[2].row() != 3 ||
+      comboBox.allChecked() ||
+      comboBox.noneChecked())
+    {
+    std::cerr << "Line " << __LINE__ << " - ctkCheckableComboBox::"
+              << "checkedIndexes() failed\n"
+              << " count:" << checkedIndexes.count()
+              << " all:" << comboBox.allChecked()
+              << " none:" << comboBox.noneChecked() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Removing the only unchecked item checks all the items
+  comboBox.removeItem(2);
+  if (comboBox.checkedIndexes().count() != 3 ||
+      !comboBox.allChecked())
+    {
+    std::cerr << "Line " << __LINE__ << " - ctkCheckableComboBox::"
+              << "removeItem() failed\n"
+              << " count:" << comboBox.checkedIndexes().count()
+              << " all:" << comboBox.allChecked() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  comboBox.setUniformItemSizes(true);
+  if (!comboBox.uniformItemSizes())
+    {
+    std::cerr << "Line " << __LINE__ << " - ctkCheckableComboBox::"
+              << "setUniformItemSizes() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   comboBox.show();
   if (argc < 2 || QString(argv[1]) != "-I" )
     {
@@ -23,6 +23,7 @@
 #include <QDebug>
 #include <QFocusEvent>
 #include <QScopedPointer>
+#include <QSignalSpy>
 #include <QStandardItem>
 #include <QStandardItemModel>
 #include <QTimer>
@@ -345,5 +346,71 @@ int ctkCheckableModelHelperTest1(int argc, char * argv [] )
       return EXIT_FAILURE;
       }
   } // end of local scope
+
+  {
+    // Batch updates
+    QStandardItemModel treeModel;
+    treeModel.setHeaderData(0, Qt::Horizontal, Qt::Unchecked, Qt::CheckStateRole);
+    QList<QStandardItem*> leaves;
+    for (int i = 0; i < 3; ++i)
+      {
+      QStandardItem* item = new QStandardItem("item");
+      item->setCheckable(true);
+      for (int j = 0; j < 4; ++j)
+        {
+        QStandardItem* leaf = new QStandardItem("leaf");
+        leaf->setCheckable(true);
+        item->appendRow(leaf);
+        leaves << leaf;
+        }
+      treeModel.appendRow(item);
+      }
+
+    QScopedPointer<ctkCheckableModelHelper> modelHelper(new ctkCheckableModelHelper(Qt::Horizontal));
+    modelHelper->setBatchUpdates(true);
+    if (!modelHelper->batchUpdates())
+      {
+      std::cerr << "Line " << __LINE__
+                << " - ctkCheckableModelHelper::setBatchUpdates() failed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    modelHelper->setModel(&treeModel);
+
+    QSignalSpy spy(&treeModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+    modelHelper->setHeaderCheckState(0, Qt::Checked);
+    // One signal for the top-level items, one for the children of each item.
+    if (spy.count() != 4)
+      {
+      std::cerr << "Line " << __LINE__
+                << " - ctkCheckableModelHelper::setBatchUpdates() failed: "
+                << spy.count() << " dataChanged signals" << std::endl;
+      return EXIT_FAILURE;
+      }
+    foreach(QStandardItem* leaf, leaves)
+      {
+      if (leaf->checkState() != Qt::Checked)
+        {
+        std::cerr << "Line " << __LINE__
+                  << " - ctkCheckableModelHelper::setBatchUpdates() failed: "
+                  << static_cast<int>(leaf->checkState()) << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    // Unchecking an item updates its children and its parent.
+    spy.clear();
+    treeModel.item(1)->setCheckState(Qt::Unchecked);
+    if (spy.count() != 2 ||
+        modelHelper->headerCheckState(0) != Qt::PartiallyChecked ||
+        treeModel.item(1)->child(3)->checkState() != Qt::Unchecked ||
+        treeModel.item(0)->child(3)->checkState() != Qt::Checked)
+      {
+      std::cerr << "Line " << __LINE__
+                << " - ctkCheckableModelHelper::setBatchUpdates() failed: "
+                << spy.count() << " dataChanged signals, header "
+                << static_cast<int>(modelHelper->headerCheckState(0)) << std::endl;
+      return EXIT_FAILURE;
+      }
+  } // end of local scope
   return EXIT_SUCCESS;
 }
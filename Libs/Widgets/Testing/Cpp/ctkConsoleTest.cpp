@@ -21,6 +21,8 @@
 // Qt includes
 #include <QApplication>
 #include <QString>
+#include <QTextDocument>
+#include <QTextEdit>
 #include <QTimer>
 
 // CTK includes
@@ -35,6 +37,10 @@ class ctkConsoleTester: public QObject
 private slots:
   void testShow();
 
+  void testPrintMessage();
+  void testMaximumBlockCount();
+  void testMaximumOutputRate();
+
   void testRunFile();
   void testRunFile_data();
 };
@@ -51,6 +57,62 @@ void ctkConsoleTester::testShow()
 #endif
 }
 
+// ----------------------------------------------------------------------------
+void ctkConsoleTester::testPrintMessage()
+{
+  ctkConsole console;
+  QTextEdit* textEdit = console.findChild<QTextEdit*>();
+  QVERIFY(textEdit);
+  for (int i = 0; i < 1000; ++i)
+    {
+    console.printMessage(QString("line %1\n").arg(i), Qt::black);
+    }
+  console.flushOutput();
+  QVERIFY(textEdit->toPlainText().contains("line 0\n"));
+  QVERIFY(textEdit->toPlainText().contains("line 999\n"));
+
+  console.printMessage("pending message\n", Qt::black);
+  // Written at the latest after the flush interval
+  QTest::qWait(100);
+  QVERIFY(textEdit->toPlainText().contains("pending message"));
+}
+
+// ----------------------------------------------------------------------------
+void ctkConsoleTester::testMaximumBlockCount()
+{
+  ctkConsole console;
+  QCOMPARE(console.maximumBlockCount(), 0);
+  console.setMaximumBlockCount(100);
+  QCOMPARE(console.maximumBlockCount(), 100);
+  for (int i = 0; i < 1000; ++i)
+    {
+    console.printMessage(QString("line %1\n").arg(i), Qt::black);
+    }
+  console.flushOutput();
+  QTextEdit* textEdit = console.findChild<QTextEdit*>();
+  QVERIFY(textEdit->document()->blockCount() <= 100);
+  QVERIFY(!textEdit->toPlainText().contains("line 0\n"));
+  QVERIFY(textEdit->toPlainText().contains("line 999\n"));
+}
+
+// ----------------------------------------------------------------------------
+void ctkConsoleTester::testMaximumOutputRate()
+{
+  ctkConsole console;
+  QCOMPARE(console.maximumOutputRate(), 0);
+  console.setMaximumOutputRate(10);
+  QCOMPARE(console.maximumOutputRate(), 10);
+  for (int i = 0; i < 1000; ++i)
+    {
+    console.printMessage(QString("line %1\n").arg(i), Qt::black);
+    }
+  console.flushOutput();
+  QTextEdit* textEdit = console.findChild<QTextEdit*>();
+  QVERIFY(textEdit->toPlainText().contains("line 9\n"));
+  QVERIFY(!textEdit->toPlainText().contains("line 999\n"));
+  QVERIFY(textEdit->toPlainText().contains("lines of output suppressed"));
+}
+
 // ----------------------------------------------------------------------------
 void ctkConsoleTester::testRunFile()
 {
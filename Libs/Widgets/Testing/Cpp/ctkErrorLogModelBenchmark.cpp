@@ -0,0 +1,99 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QDateTime>
+#include <QStringList>
+
+// CTK includes
+#include "ctkErrorLogContext.h"
+#include "ctkErrorLogModel.h"
+#include "ctkTest.h"
+
+// ----------------------------------------------------------------------------
+class ctkErrorLogModelBenchmarker: public QObject
+{
+  Q_OBJECT
+private slots:
+
+  void benchmarkAddEntry_data();
+  void benchmarkAddEntry();
+};
+
+// ----------------------------------------------------------------------------
+void ctkErrorLogModelBenchmarker::benchmarkAddEntry_data()
+{
+  QTest::addColumn<bool>("grouping");
+  QTest::addColumn<bool>("asynchronous");
+  QTest::addColumn<int>("maximumEntryCount");
+
+  QTest::newRow("synchronous") << false << false << 0;
+  QTest::newRow("grouping") << true << false << 0;
+  QTest::newRow("asynchronous") << false << true << 0;
+  QTest::newRow("maximum entry count") << false << false << 100;
+}
+
+// ----------------------------------------------------------------------------
+void ctkErrorLogModelBenchmarker::benchmarkAddEntry()
+{
+  QFETCH(bool, grouping);
+  QFETCH(bool, asynchronous);
+  QFETCH(int, maximumEntryCount);
+
+  ctkErrorLogModel model;
+  model.setTerminalOutputs(ctkErrorLogTerminalOutput::None);
+  model.setFileLoggingEnabled(false);
+  model.setLogEntryGrouping(grouping);
+  model.setAsynchronousLogging(asynchronous);
+  model.setMaximumEntryCount(maximumEntryCount);
+
+  // the same messages and dates from one run to the next, groups of two
+  // consecutive messages are grouped
+  const int messageCount = 1000;
+  QDateTime dateTime(QDate(2015, 1, 1), QTime(12, 0));
+  QStringList messages;
+  for (int i = 0; i < messageCount; ++i)
+    {
+    messages << QString("This is message %1").arg(i / 2);
+    }
+
+  QBENCHMARK
+    {
+    model.clear();
+    for (int i = 0; i < messageCount; ++i)
+      {
+      ctkErrorLogLevel::LogLevel logLevel = (i % 4 < 2) ? ctkErrorLogLevel::Warning : ctkErrorLogLevel::Info;
+      model.addEntry(dateTime, "0x1", logLevel, "Benchmark",
+                     ctkErrorLogContext(messages[i]), messages[i]);
+      }
+    model.processPendingEntries();
+    }
+
+  int expectedCount = grouping ? messageCount / 2 : messageCount;
+  if (maximumEntryCount > 0)
+    {
+    expectedCount = qMin(expectedCount, maximumEntryCount);
+    }
+  QCOMPARE(model.logEntryCount(), expectedCount);
+}
+
+// ----------------------------------------------------------------------------
+CTK_TEST_MAIN(ctkErrorLogModelBenchmark)
+#include "moc_ctkErrorLogModelBenchmark.cpp"
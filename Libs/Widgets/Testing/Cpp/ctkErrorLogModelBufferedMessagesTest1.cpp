@@ -0,0 +1,196 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDebug>
+
+// CTK includes
+#include "ctkErrorLogAbstractMessageHandler.h"
+#include "ctkErrorLogContext.h"
+#include "ctkModelTester.h"
+#include "ctkUtils.h"
+
+// STL includes
+#include <cstdlib>
+#include <iostream>
+
+// Helper functions
+#include "Testing/Cpp/ctkErrorLogModelTestHelper.cpp"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Handler buffering the messages, like the VTK and ITK handlers
+class ctkBufferingMessageHandler : public ctkErrorLogAbstractMessageHandler
+{
+public:
+  static QString HandlerName;
+  virtual QString handlerName()const { return ctkBufferingMessageHandler::HandlerName; }
+  virtual void setEnabledInternal(bool) {}
+
+  void logMessage(ctkErrorLogLevel::LogLevel logLevel, const QString& text)
+  {
+    this->bufferMessage(ctk::qtHandleToString(QThread::currentThreadId()), logLevel,
+                        this->handlerPrettyName(), ctkErrorLogContext(text), text);
+  }
+};
+
+QString ctkBufferingMessageHandler::HandlerName = QLatin1String("Buffering");
+
+ctkBufferingMessageHandler* BufferingHandler = 0;
+
+//-----------------------------------------------------------------------------
+class LogBufferedMessageThread : public LogMessageThread
+{
+public:
+  LogBufferedMessageThread(int id, int maxIteration) : LogMessageThread(id, maxIteration){}
+
+  virtual void logMessage(const QDateTime& dateTime, int threadId, int counterIdx)
+  {
+    Q_UNUSED(dateTime);
+    Q_UNUSED(threadId);
+    Q_UNUSED(counterIdx);
+    BufferingHandler->logMessage(ctkErrorLogLevel::Warning, "Warning from a thread chunk");
+  }
+};
+
+//-----------------------------------------------------------------------------
+QString checkBufferedMessages(ctkErrorLogModel& model, int repeatedCount)
+{
+  // Nothing is added before the buffers are flushed
+  QString errorMsg = checkRowCount(__LINE__, model.logEntryCount(), /* expected = */ 0);
+  if (!errorMsg.isEmpty())
+    {
+    return errorMsg;
+    }
+  processEvents(500);
+  errorMsg = checkRowCount(__LINE__, model.logEntryCount(), /* expected = */ 2);
+  if (!errorMsg.isEmpty())
+    {
+    return errorMsg;
+    }
+  QStringList expectedMessages;
+  expectedMessages << QString("Repeated warning (repeated %1 times)").arg(repeatedCount)
+                   << "Single error";
+  return checkTextMessages(__LINE__, model, expectedMessages);
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int ctkErrorLogModelBufferedMessagesTest1(int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+  Q_UNUSED(app);
+  ctkErrorLogModel model;
+  ctkModelTester modelTester;
+  modelTester.setVerbose(false);
+  QString errorMsg;
+
+  try
+    {
+    modelTester.setModel(&model);
+
+    BufferingHandler = new ctkBufferingMessageHandler;
+    model.registerMsgHandler(BufferingHandler);
+    model.setMsgHandlerEnabled(ctkBufferingMessageHandler::HandlerName, true);
+
+    // --------------------------------------------------------------------------
+    // Identical messages are collapsed, asynchronous logging
+
+    int repeatedCount = 100;
+    for (int i = 0; i < repeatedCount; ++i)
+      {
+      BufferingHandler->logMessage(ctkErrorLogLevel::Warning, "Repeated warning");
+      }
+    BufferingHandler->logMessage(ctkErrorLogLevel::Error, "Single error");
+
+    errorMsg = checkBufferedMessages(model, repeatedCount);
+    if (!errorMsg.isEmpty())
+      {
+      model.disableAllMsgHandler();
+      printErrorMessage(errorMsg);
+      printTextMessages(model);
+      return EXIT_FAILURE;
+      }
+
+    // --------------------------------------------------------------------------
+    // Synchronous logging, the handler is flushed in the thread of the model
+
+    model.clear();
+    model.setAsynchronousLogging(false);
+    for (int i = 0; i < repeatedCount; ++i)
+      {
+      BufferingHandler->logMessage(ctkErrorLogLevel::Warning, "Repeated warning");
+      }
+    BufferingHandler->logMessage(ctkErrorLogLevel::Error, "Single error");
+
+    errorMsg = checkBufferedMessages(model, repeatedCount);
+    if (!errorMsg.isEmpty())
+      {
+      model.disableAllMsgHandler();
+      printErrorMessage(errorMsg);
+      printTextMessages(model);
+      return EXIT_FAILURE;
+      }
+    model.setAsynchronousLogging(true);
+
+    // --------------------------------------------------------------------------
+    // Each thread has its own buffer
+
+    model.clear();
+    int threadCount = 8;
+    int maxIteration = 50;
+    startLogMessageThreads<LogBufferedMessageThread>(threadCount, maxIteration);
+    foreach(const QSharedPointer<LogMessageThread>& thread, ThreadList)
+      {
+      thread->wait();
+      }
+    processEvents(500);
+
+    errorMsg = checkRowCount(__LINE__, model.logEntryCount(), /* expected = */ threadCount);
+    if (errorMsg.isEmpty())
+      {
+      QStringList expectedMessages;
+      for (int i = 0; i < threadCount; ++i)
+        {
+        expectedMessages << QString("Warning from a thread chunk (repeated %1 times)").arg(maxIteration);
+        }
+      errorMsg = checkTextMessages(__LINE__, model, expectedMessages);
+      }
+    if (!errorMsg.isEmpty())
+      {
+      model.disableAllMsgHandler();
+      printErrorMessage(errorMsg);
+      printTextMessages(model);
+      return EXIT_FAILURE;
+      }
+    }
+  catch (const char* error)
+    {
+    model.disableAllMsgHandler();
+    std::cerr << error << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
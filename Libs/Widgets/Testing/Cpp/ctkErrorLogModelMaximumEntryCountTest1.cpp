@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+// Qt includes
+#include <QCoreApplication>
+#include <QDateTime>
+
+// CTK includes
+#include "ctkErrorLogContext.h"
+#include "ctkModelTester.h"
+
+// STL includes
+#include <cstdlib>
+#include <iostream>
+
+// Helper functions
+#include "Testing/Cpp/ctkErrorLogModelTestHelper.cpp"
+
+//-----------------------------------------------------------------------------
+int ctkErrorLogModelMaximumEntryCountTest1(int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+  Q_UNUSED(app);
+  ctkErrorLogModel model;
+  ctkModelTester modelTester;
+  modelTester.setVerbose(false);
+  QString errorMsg;
+
+  try
+    {
+    modelTester.setModel(&model);
+
+    int maximumEntryCount = 4;
+    int messageCount = 10;
+    model.setMaximumEntryCount(maximumEntryCount);
+
+    QStringList expectedMessages;
+    for (int i = 0; i < messageCount; ++i)
+      {
+      ctkErrorLogLevel::LogLevel logLevel = (i % 2) ? ctkErrorLogLevel::Warning : ctkErrorLogLevel::Info;
+      QString message = QString("This is message %1").arg(i);
+      model.addEntry(QDateTime::currentDateTime(), "0x1", logLevel, "Test",
+                     ctkErrorLogContext(message), message);
+      if (i >= messageCount - maximumEntryCount)
+        {
+        expectedMessages << message;
+        }
+      }
+
+    // --------------------------------------------------------------------------
+    // Test that the oldest entries are removed
+
+    errorMsg = checkRowCount(__LINE__, model.logEntryCount(), /* expected = */ maximumEntryCount);
+    if (errorMsg.isEmpty())
+      {
+      errorMsg = checkTextMessages(__LINE__, model, expectedMessages);
+      }
+    if (!errorMsg.isEmpty())
+      {
+      printErrorMessage(errorMsg);
+      printTextMessages(model);
+      return EXIT_FAILURE;
+      }
+
+    // --------------------------------------------------------------------------
+    // Test level filtering
+
+    model.filterEntry(ctkErrorLogLevel::Warning);
+    errorMsg = checkRowCount(__LINE__, model.rowCount(), /* expected = */ maximumEntryCount / 2);
+    if (errorMsg.isEmpty())
+      {
+      model.filterEntry(ctkErrorLogLevel::Warning, /* disableFilter= */ true);
+      errorMsg = checkRowCount(__LINE__, model.rowCount(), /* expected = */ 0);
+      }
+    if (!errorMsg.isEmpty())
+      {
+      printErrorMessage(errorMsg);
+      printTextMessages(model);
+      return EXIT_FAILURE;
+      }
+
+    // --------------------------------------------------------------------------
+    // Test reducing the maximum entry count
+
+    model.filterEntry(ctkErrorLogLevel::Info | ctkErrorLogLevel::Warning);
+    model.setMaximumEntryCount(2);
+    expectedMessages = expectedMessages.mid(2);
+    errorMsg = checkRowCount(__LINE__, model.logEntryCount(), /* expected = */ 2);
+    if (errorMsg.isEmpty())
+      {
+      errorMsg = checkTextMessages(__LINE__, model, expectedMessages);
+      }
+    if (!errorMsg.isEmpty())
+      {
+      printErrorMessage(errorMsg);
+      printTextMessages(model);
+      return EXIT_FAILURE;
+      }
+    }
+  catch (const char* error)
+    {
+    std::cerr << error << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+// Qt includes
+#include <QCoreApplication>
+#include <QDebug>
+
+// CTK includes
+#include "ctkErrorLogQtMessageHandler.h"
+#include "ctkModelTester.h"
+
+// STL includes
+#include <cstdlib>
+#include <iostream>
+
+// Helper functions
+#include "Testing/Cpp/ctkErrorLogModelTestHelper.cpp"
+
+//-----------------------------------------------------------------------------
+int ctkErrorLogModelQueueTest1(int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+  Q_UNUSED(app);
+  ctkErrorLogModel model;
+  ctkModelTester modelTester;
+  modelTester.setVerbose(false);
+  QString errorMsg;
+
+  try
+    {
+    modelTester.setModel(&model);
+
+    // --------------------------------------------------------------------------
+    // Monitor Qt messages
+    model.registerMsgHandler(new ctkErrorLogQtMessageHandler);
+    model.setMsgHandlerEnabled(ctkErrorLogQtMessageHandler::HandlerName, true);
+
+    int maximumPendingEntries = 5;
+    int messageCount = 20;
+    model.setMaximumPendingEntries(maximumPendingEntries);
+
+    // --------------------------------------------------------------------------
+    // Test DropWhenFull
+
+    model.setQueueFullPolicy(ctkErrorLogModel::DropWhenFull);
+    for (int i = 0; i < messageCount; ++i)
+      {
+      qDebug().nospace() << "This is a dropped qDebug message - " << i;
+      }
+
+    errorMsg = checkInteger(__LINE__, "pendingEntryCount", model.pendingEntryCount(), maximumPendingEntries);
+    if (errorMsg.isEmpty())
+      {
+      errorMsg = checkInteger(__LINE__, "droppedEntryCount", model.droppedEntryCount(),
+                              messageCount - maximumPendingEntries);
+      }
+    if (errorMsg.isEmpty())
+      {
+      // Give enough time to the ErrorLogModel to consider the queued messages.
+      processEvents(1000);
+      errorMsg = checkRowCount(__LINE__, model.logEntryCount(), /* expected = */ maximumPendingEntries);
+      }
+    if (!errorMsg.isEmpty())
+      {
+      model.disableAllMsgHandler();
+      printErrorMessage(errorMsg);
+      printTextMessages(model);
+      return EXIT_FAILURE;
+      }
+
+    // --------------------------------------------------------------------------
+    // Test CoalesceWhenFull
+
+    model.clear();
+    model.resetQueueCounters();
+    model.setQueueFullPolicy(ctkErrorLogModel::CoalesceWhenFull);
+    for (int i = 0; i < messageCount; ++i)
+      {
+      qDebug().nospace() << "This is a coalesced qDebug message - " << i;
+      }
+
+    errorMsg = checkInteger(__LINE__, "coalescedEntryCount", model.coalescedEntryCount(),
+                            messageCount - maximumPendingEntries);
+    if (errorMsg.isEmpty())
+      {
+      errorMsg = checkInteger(__LINE__, "droppedEntryCount", model.droppedEntryCount(), 0);
+      }
+    if (errorMsg.isEmpty())
+      {
+      processEvents(1000);
+      errorMsg = checkRowCount(__LINE__, model.logEntryCount(), /* expected = */ maximumPendingEntries);
+      }
+    if (errorMsg.isEmpty())
+      {
+      QString lastDescription = model.logEntryDescription(maximumPendingEntries - 1);
+      errorMsg = checkInteger(__LINE__, "coalesced line count", lastDescription.split("\n").count(),
+                              messageCount - maximumPendingEntries + 1);
+      }
+    if (!errorMsg.isEmpty())
+      {
+      model.disableAllMsgHandler();
+      printErrorMessage(errorMsg);
+      printTextMessages(model);
+      return EXIT_FAILURE;
+      }
+
+    // --------------------------------------------------------------------------
+    // Test BlockWhenFull, the messages logged by the thread of the model are
+    // added before the queue overflows.
+
+    model.clear();
+    model.resetQueueCounters();
+    model.setQueueFullPolicy(ctkErrorLogModel::BlockWhenFull);
+    for (int i = 0; i < messageCount; ++i)
+      {
+      qDebug().nospace() << "This is a qDebug message - " << i;
+      }
+    processEvents(1000);
+
+    errorMsg = checkRowCount(__LINE__, model.logEntryCount(), /* expected = */ messageCount);
+    if (errorMsg.isEmpty())
+      {
+      errorMsg = checkInteger(__LINE__, "droppedEntryCount", model.droppedEntryCount(), 0);
+      }
+    if (!errorMsg.isEmpty())
+      {
+      model.disableAllMsgHandler();
+      printErrorMessage(errorMsg);
+      printTextMessages(model);
+      return EXIT_FAILURE;
+      }
+    }
+  catch (const char* error)
+    {
+    model.disableAllMsgHandler();
+    std::cerr << error << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -256,6 +256,17 @@ void ctkFlatProxyModelTester::testModel()
   QModelIndex subIndex1 = flattenModel.index(0,0, QModelIndex());
   QCOMPARE( flattenModel.rowCount(subIndex1), level1ExpectedRowCount);
 
+  // The mapping must follow the changes of the source model.
+  QStandardItem* newSubItem = new QStandardItem("newSubItem");
+  newSubItem->appendRow(new QStandardItem("newLeaf"));
+  model.item(0)->appendRow(newSubItem);
+  QCOMPARE( flattenModel.rowCount(QModelIndex()), level0ExpectedRowCount + 1);
+  QModelIndex newIndex = flattenModel.index(model.item(0)->rowCount() - 1, 0, QModelIndex());
+  QCOMPARE( flattenModel.data(newIndex).toString(), QString("newSubItem"));
+  QCOMPARE( flattenModel.rowCount(newIndex), 1);
+  model.item(0)->removeRow(model.item(0)->rowCount() - 1);
+  QCOMPARE( flattenModel.rowCount(QModelIndex()), level0ExpectedRowCount);
+
   ctkModelTester tester;
   tester.setTestDataEnabled(false);
   tester.setModel(&flattenModel);
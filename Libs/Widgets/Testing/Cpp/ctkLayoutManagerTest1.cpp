@@ -22,6 +22,7 @@
 #include <QApplication>
 #include <QDebug>
 #include <QPushButton>
+#include <QTabWidget>
 #include <QTimer>
 
 // CTK includes
@@ -255,6 +256,59 @@ int ctkLayoutManagerTest1(int argc, char * argv [] )
     }
 
 
+  // LazyTabs
+  QWidget lazyTab;
+  lazyTab.setWindowTitle("Lazy Tab Layout");
+  ctkTemplateLayoutViewFactory<ctkSliderWidget>* lazyTabInstanciator =
+    new ctkTemplateLayoutViewFactory<ctkSliderWidget>(&viewport);
+  ctkLayoutFactory lazyTabLayoutManager;
+  lazyTabLayoutManager.setLazyTabs(true);
+  lazyTabLayoutManager.registerViewFactory(lazyTabInstanciator);
+  lazyTabLayoutManager.setLayout(tabLayoutDoc);
+  lazyTabLayoutManager.setViewport(&lazyTab);
+  lazyTab.show();
+
+  if (lazyTabInstanciator->registeredViews().count() != 1)
+    {
+    std::cout << __LINE__ << " LazyTabs: "
+              << "ctkLayoutManager::setupLayout() created hidden tabs "
+              << lazyTabInstanciator->registeredViews().count() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QTabWidget* lazyTabWidget = lazyTab.findChild<QTabWidget*>();
+  if (!lazyTabWidget || lazyTabWidget->count() != 3)
+    {
+    std::cout << __LINE__ << " LazyTabs: "
+              << "ctkLayoutManager::setupLayout() failed to add the tabs"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  lazyTabWidget->setCurrentIndex(2);
+
+  QTimer::singleShot(200, &app, SLOT(quit()));
+  app.exec();
+
+  if (lazyTabInstanciator->registeredViews().count() != 2 ||
+      lazyTabInstanciator->registeredViews()[1]->isHidden())
+    {
+    std::cout << __LINE__ << " LazyTabs: "
+              << "ctkLayoutManager failed to create the shown tab "
+              << lazyTabInstanciator->registeredViews().count() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Switching layouts reuses the views created so far
+  lazyTabLayoutManager.setLayout(vboxLayoutDoc);
+  if (lazyTabInstanciator->registeredViews().count() != 2)
+    {
+    std::cout << __LINE__ << " LazyTabs: "
+              << "ctkLayoutManager failed to reuse the views "
+              << lazyTabInstanciator->registeredViews().count() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+
   if (argc < 2 || QString(argv[1]) != "-I" )
     {
     QTimer::singleShot(200, &app, SLOT(quit()));
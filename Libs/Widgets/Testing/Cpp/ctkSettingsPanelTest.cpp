@@ -47,6 +47,8 @@ private slots:
 
   void testResetRestoreReloadSettings();
   void testResetRestoreReloadSettings_data();
+
+  void testBatch();
 };
 
 //-----------------------------------------------------------------------------
@@ -415,6 +417,80 @@ void ctkSettingsPanelTester::testResetRestoreReloadSettings_data()
 
 }
 
+//-----------------------------------------------------------------------------
+void ctkSettingsPanelTester::testBatch()
+{
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope, "Common ToolKit", "CTK");
+  settings.clear();
+  settings.setValue("key 1", 1);
+
+  QSpinBox spinBox;
+  ctkSettingsPanel settingsPanel;
+  settingsPanel.setSettings(&settings);
+  settingsPanel.registerProperty("key 1", &spinBox, "value",
+                                 SIGNAL(valueChanged(int)));
+  QCOMPARE(spinBox.value(), 1);
+
+  qRegisterMetaType<QVariant>("QVariant");
+  QSignalSpy spy(&settingsPanel, SIGNAL(settingChanged(QString,QVariant)));
+
+  settingsPanel.beginBatch();
+  settingsPanel.beginBatch();
+  QVERIFY(settingsPanel.isBatching());
+  spinBox.setValue(2);
+  spinBox.setValue(3);
+  // Notified right away, written later
+  QCOMPARE(spy.count(), 2);
+  QCOMPARE(settingsPanel.changedSettings(), QStringList("key 1"));
+  QCOMPARE(settings.value("key 1").toInt(), 1);
+
+  settingsPanel.endBatch();
+  QCOMPARE(settings.value("key 1").toInt(), 1);
+  settingsPanel.endBatch();
+  QVERIFY(!settingsPanel.isBatching());
+  QCOMPARE(settings.value("key 1").toInt(), 3);
+
+  // Reset in a batch of its own
+  settingsPanel.beginBatch();
+  settingsPanel.resetSettings();
+  QCOMPARE(spinBox.value(), 1);
+  QCOMPARE(settings.value("key 1").toInt(), 3);
+  settingsPanel.endBatch();
+  QCOMPARE(settings.value("key 1").toInt(), 1);
+
+  // Pending values are written when the interval expires
+  settingsPanel.setFlushInterval(10);
+  settingsPanel.beginBatch();
+  spinBox.setValue(4);
+  QCOMPARE(settings.value("key 1").toInt(), 1);
+  QTest::qWait(100);
+  QCOMPARE(settings.value("key 1").toInt(), 4);
+  QVERIFY(settingsPanel.isBatching());
+  settingsPanel.endBatch();
+
+  // Pending values aren't lost when the settings are replaced
+  QSettings settings2(QSettings::IniFormat, QSettings::UserScope, "Common ToolKit", "CTK-batch");
+  settings2.clear();
+  settingsPanel.setFlushInterval(0);
+  settingsPanel.beginBatch();
+  spinBox.setValue(5);
+  settingsPanel.setSettings(&settings2);
+  QCOMPARE(settings.value("key 1").toInt(), 5);
+  settingsPanel.endBatch();
+  QCOMPARE(settings2.value("key 1").toInt(), 5);
+
+  // With an interval, changes are coalesced outside of a batch too
+  settingsPanel.setFlushInterval(10);
+  spinBox.setValue(6);
+  spinBox.setValue(7);
+  QCOMPARE(settings2.value("key 1").toInt(), 5);
+  QTest::qWait(100);
+  QCOMPARE(settings2.value("key 1").toInt(), 7);
+  spinBox.setValue(8);
+  settingsPanel.applySettings();
+  QCOMPARE(settings2.value("key 1").toInt(), 8);
+}
+
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(ctkSettingsPanelTest)
 #include "moc_ctkSettingsPanelTest.cpp"
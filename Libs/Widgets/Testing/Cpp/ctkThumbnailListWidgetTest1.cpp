@@ -20,12 +20,17 @@
 
 // Qt includes
 #include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
 #include <QList>
 #include <QPixmap>
 #include <QTimer>
 #include <QVariant>
 
 // ctkDICOMCore includes
+#include "ctkThumbnailLabel.h"
 #include "ctkThumbnailListWidget.h"
 
 // STD includes
@@ -69,6 +74,38 @@ int ctkThumbnailListWidgetTest1( int argc, char * argv [] )
 
   widget.show();
 
+  // Thumbnails loaded from files in the background
+  QString imageFile = QDir::temp().filePath("ctkThumbnailListWidgetTest1.png");
+  QImage image(512, 256, QImage::Format_RGB32);
+  image.fill(0xff0000ff);
+  if (!image.save(imageFile))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to write "
+              << qPrintable(imageFile) << std::endl;
+    return EXIT_FAILURE;
+    }
+  ctkThumbnailListWidget sourceWidget;
+  sourceWidget.setThumbnailSize(QSize(128, 128));
+  sourceWidget.addThumbnailSource(imageFile, "file");
+  sourceWidget.show();
+  ctkThumbnailLabel* sourceLabel = sourceWidget.findChild<ctkThumbnailLabel*>();
+  QElapsedTimer timer;
+  timer.start();
+  while (sourceLabel && (!sourceLabel->pixmap() || sourceLabel->pixmap()->isNull())
+         && timer.elapsed() < 5000)
+    {
+    QApplication::processEvents();
+    }
+  QFile::remove(imageFile);
+  if (!sourceLabel || !sourceLabel->pixmap() || sourceLabel->pixmap()->isNull() ||
+      sourceLabel->pixmap()->width() > 128 ||
+      sourceLabel->text() != "file")
+    {
+    std::cerr << "Line " << __LINE__ << " - ctkThumbnailListWidget::"
+              << "addThumbnailSource() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   if (argc <= 1 || QString(argv[1]) != "-I")
     {
     QTimer::singleShot(200, &app, SLOT(quit()));
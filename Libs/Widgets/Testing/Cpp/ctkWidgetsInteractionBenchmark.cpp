@@ -0,0 +1,141 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QDateTime>
+
+// CTK includes
+#include "ctkDoubleRangeSlider.h"
+#include "ctkErrorLogModel.h"
+#include "ctkErrorLogWidget.h"
+#include "ctkInteractionBenchmark.h"
+#include "ctkTest.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void benchmarkDoubleRangeSlider(ctkInteractionBenchmark& benchmark)
+{
+  ctkDoubleRangeSlider slider(Qt::Horizontal);
+  slider.resize(400, 30);
+  slider.setRange(0., 1000.);
+  slider.setSingleStep(0.5);
+  slider.setValues(0., 1000.);
+  slider.show();
+  QTest::qWaitForWindowShown(&slider);
+
+  // Programmatic stepping of both handles
+  for (int i = 0; i < 500; ++i)
+    {
+    benchmark.start();
+    slider.setValues(i, 1000. - i);
+    benchmark.stop("ctkDoubleRangeSlider", "setValues");
+    benchmark.recordFrame("ctkDoubleRangeSlider", &slider);
+    }
+
+  // Drags of the minimum handle, one mouse move per sample
+  QPoint pos(1, slider.height() / 2);
+  slider.setValues(0., 1000.);
+  QTest::mousePress(&slider, Qt::LeftButton, Qt::NoModifier, pos);
+  for (int x = 1; x < slider.width() / 2; x += 2)
+    {
+    pos.setX(x);
+    benchmark.start();
+    ctkTest::mouseMove(&slider, Qt::LeftButton, Qt::NoModifier, pos);
+    benchmark.stop("ctkDoubleRangeSlider", "drag");
+    }
+  QTest::mouseRelease(&slider, Qt::LeftButton, Qt::NoModifier, pos);
+}
+
+//-----------------------------------------------------------------------------
+void benchmarkErrorLogWidget(ctkInteractionBenchmark& benchmark, int entryCount)
+{
+  ctkErrorLogModel model;
+  ctkErrorLogWidget widget;
+  widget.setErrorLogModel(&model);
+  widget.resize(800, 600);
+  widget.show();
+  QTest::qWaitForWindowShown(&widget);
+
+  const ctkErrorLogLevel::LogLevel levels[] =
+    {ctkErrorLogLevel::Info, ctkErrorLogLevel::Warning, ctkErrorLogLevel::Error};
+  const ctkErrorLogContext context;
+  const QString threadId("0x1");
+  const int batchSize = 1000;
+  for (int i = 0; i < entryCount; i += batchSize)
+    {
+    benchmark.start();
+    for (int j = i; j < i + batchSize && j < entryCount; ++j)
+      {
+      model.addEntry(QDateTime::currentDateTime(), threadId, levels[j % 3],
+                     "Benchmark", context, QString("Entry %1").arg(j));
+      }
+    benchmark.stop("ctkErrorLogWidget", "addEntry_batch1000");
+    benchmark.recordFrame("ctkErrorLogWidget", &widget);
+    }
+  if (model.logEntryCount() != entryCount)
+    {
+    std::cerr << "Line " << __LINE__ << " - Expected " << entryCount
+              << " entries, got " << model.logEntryCount() << std::endl;
+    }
+
+  // Filtering the full log by level
+  for (int i = 0; i < 5; ++i)
+    {
+    benchmark.start();
+    widget.setErrorEntriesVisible(false);
+    benchmark.stop("ctkErrorLogWidget", "filter");
+    benchmark.recordFrame("ctkErrorLogWidget", &widget);
+    benchmark.start();
+    widget.setAllEntriesVisible(true);
+    benchmark.stop("ctkErrorLogWidget", "filter");
+    benchmark.recordFrame("ctkErrorLogWidget", &widget);
+    }
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int ctkWidgetsInteractionBenchmark(int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  // Optional argument: file the JSON summary is written into
+  QString output = argc > 1 ? QString(argv[1]) : QString();
+
+  ctkInteractionBenchmark benchmark("CTKWidgets");
+  benchmarkDoubleRangeSlider(benchmark);
+  benchmarkErrorLogWidget(benchmark, 100000);
+
+  if (benchmark.count("ctkDoubleRangeSlider", "frame") == 0 ||
+      benchmark.count("ctkErrorLogWidget", "addEntry_batch1000") != 100)
+    {
+    std::cerr << "Line " << __LINE__ << " - Missing samples" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return benchmark.writeJSON(output) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
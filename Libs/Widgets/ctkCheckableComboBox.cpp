@@ -25,6 +25,7 @@
 #include <QDesktopWidget>
 #include <QItemDelegate>
 #include <QLayout>
+#include <QListView>
 #include <QMouseEvent>
 #include <QMenu>
 #include <QPainter>
@@ -40,6 +41,9 @@
 #include "ctkCheckableComboBox.h"
 #include <ctkCheckableModelHelper.h>
 
+// STD includes
+#include <algorithm>
+
 // Similar to QComboBoxDelegate
 class ctkComboBoxDelegate : public QItemDelegate
 {
@@ -117,26 +121,53 @@ public:
   void init();
 
   QModelIndexList cachedCheckedIndexes()const;
+  /// Search the whole model for the checked and unchecked indexes
   void updateCheckedList();
+  /// Only look at the rows between topLeft and bottomRight
+  void updateCheckedList(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+  /// Forget the indexes of the removed rows
+  void removeInvalidIndexes();
+  void updateDisplayText()const;
 
   ctkCheckableModelHelper* CheckableModelHelper;
   bool MouseButtonPressed;
 
+  mutable bool    DisplayTextModified;
+  mutable QString DisplayText;
+  mutable QIcon   DisplayIcon;
+
 private:
   QModelIndexList persistentIndexesToModelIndexes(
     const QList<QPersistentModelIndex>& persistentModels)const;
   QList<QPersistentModelIndex> modelIndexesToPersistentIndexes(
     const QModelIndexList& modelIndexes)const;
+  /// Add or remove index from a list sorted by row.
+  /// Return true if the list is modified.
+  static bool setIndexListed(QList<QPersistentModelIndex>& list,
+                             const QModelIndex& index, bool listed);
 
   mutable QList<QPersistentModelIndex> CheckedList;
+  QList<QPersistentModelIndex> UncheckedList;
+  /// True if all the indexes of CheckedList and UncheckedList are top-level
+  /// items, sorted by row.
+  bool FlatLists;
 };
 
+//-----------------------------------------------------------------------------
+static bool ctkCheckableComboBoxRowLessThan(
+  const QPersistentModelIndex& index, int row)
+{
+  return index.row() < row;
+}
+
 //-----------------------------------------------------------------------------
 ctkCheckableComboBoxPrivate::ctkCheckableComboBoxPrivate(ctkCheckableComboBox& object)
   : q_ptr(&object)
 {
   this->CheckableModelHelper = 0;
   this->MouseButtonPressed = false;
+  this->DisplayTextModified = true;
+  this->FlatLists = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -158,8 +189,22 @@ void ctkCheckableComboBoxPrivate::init()
 void ctkCheckableComboBoxPrivate::updateCheckedList()
 {
   Q_Q(ctkCheckableComboBox);
+  this->DisplayTextModified = true;
+  this->UncheckedList =
+    this->modelIndexesToPersistentIndexes(this->uncheckedIndexes());
   QList<QPersistentModelIndex> newCheckedPersistentList =
     this->modelIndexesToPersistentIndexes(this->checkedIndexes());
+  this->FlatLists = true;
+  QModelIndex root = q->rootModelIndex();
+  foreach(const QPersistentModelIndex& index,
+          this->UncheckedList + newCheckedPersistentList)
+    {
+    if (index.parent() != root)
+      {
+      this->FlatLists = false;
+      break;
+      }
+    }
   if (newCheckedPersistentList == this->CheckedList)
     {
     return;
@@ -168,6 +213,121 @@ void ctkCheckableComboBoxPrivate::updateCheckedList()
   emit q->checkedIndexesChanged();
 }
 
+//-----------------------------------------------------------------------------
+void ctkCheckableComboBoxPrivate::updateCheckedList(
+  const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+  Q_Q(ctkCheckableComboBox);
+  QModelIndex root = q->rootModelIndex();
+  if (!this->FlatLists || topLeft.parent() != root)
+    {
+    this->updateCheckedList();
+    return;
+    }
+  this->DisplayTextModified = true;
+  // checkedIndexes() only searches the first column
+  if (topLeft.column() > 0)
+    {
+    return;
+    }
+  bool modified = false;
+  for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+    {
+    QModelIndex index = q->model()->index(row, 0, root);
+    if (q->model()->hasChildren(index))
+      {
+      this->updateCheckedList();
+      return;
+      }
+    QVariant checkState = q->model()->data(index, Qt::CheckStateRole);
+    modified |= this->setIndexListed(this->CheckedList, index,
+      checkState == static_cast<int>(Qt::Checked));
+    this->setIndexListed(this->UncheckedList, index,
+      checkState == static_cast<int>(Qt::Unchecked));
+    }
+  if (modified)
+    {
+    emit q->checkedIndexesChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool ctkCheckableComboBoxPrivate::setIndexListed(
+  QList<QPersistentModelIndex>& list, const QModelIndex& index, bool listed)
+{
+  QList<QPersistentModelIndex>::iterator it = std::lower_bound(
+    list.begin(), list.end(), index.row(), ctkCheckableComboBoxRowLessThan);
+  bool found = (it != list.end() && it->row() == index.row());
+  if (listed && !found)
+    {
+    list.insert(it, QPersistentModelIndex(index));
+    return true;
+    }
+  if (!listed && found)
+    {
+    list.erase(it);
+    return true;
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+void ctkCheckableComboBoxPrivate::removeInvalidIndexes()
+{
+  Q_Q(ctkCheckableComboBox);
+  this->DisplayTextModified = true;
+  this->UncheckedList =
+    this->modelIndexesToPersistentIndexes(
+      this->persistentIndexesToModelIndexes(this->UncheckedList));
+  QList<QPersistentModelIndex> newCheckedPersistentList =
+    this->modelIndexesToPersistentIndexes(this->cachedCheckedIndexes());
+  if (newCheckedPersistentList.count() == this->CheckedList.count())
+    {
+    return;
+    }
+  this->CheckedList = newCheckedPersistentList;
+  emit q->checkedIndexesChanged();
+}
+
+//-----------------------------------------------------------------------------
+void ctkCheckableComboBoxPrivate::updateDisplayText()const
+{
+  Q_Q(const ctkCheckableComboBox);
+  if (!this->DisplayTextModified)
+    {
+    return;
+    }
+  this->DisplayTextModified = false;
+  this->DisplayIcon = QIcon();
+  if (q->allChecked())
+    {
+    this->DisplayText = "All";
+    }
+  else if (q->noneChecked())
+    {
+    this->DisplayText = "None";
+    }
+  else
+    {
+    //search the checked items
+    QModelIndexList indexes = this->cachedCheckedIndexes();
+    if (indexes.count() == 1)
+      {
+      this->DisplayText = q->model()->data(indexes[0], Qt::DisplayRole).toString();
+      this->DisplayIcon = qvariant_cast<QIcon>(q->model()->data(indexes[0], Qt::DecorationRole));
+      }
+    else
+      {
+      QStringList indexesText;
+      foreach(QModelIndex checkedIndex, indexes)
+        {
+        indexesText << q->model()->data(checkedIndex, Qt::DisplayRole).toString();
+        }
+      this->DisplayText = indexesText.join(", ");
+      }
+    }
+}
+
 //-----------------------------------------------------------------------------
 QList<QPersistentModelIndex> ctkCheckableComboBoxPrivate
 ::modelIndexesToPersistentIndexes(const QModelIndexList& indexes)const
@@ -293,12 +453,28 @@ void ctkCheckableComboBox::setCheckableModel(QAbstractItemModel* newModel)
   Q_D(ctkCheckableComboBox);
   this->disconnect(this->model(), SIGNAL(dataChanged(QModelIndex,QModelIndex)),
                    this, SLOT(onDataChanged(QModelIndex,QModelIndex)));
+  this->disconnect(this->model(), SIGNAL(rowsInserted(QModelIndex,int,int)),
+                   this, SLOT(onRowsInserted(QModelIndex,int,int)));
+  this->disconnect(this->model(), SIGNAL(rowsRemoved(QModelIndex,int,int)),
+                   this, SLOT(onRowsRemoved()));
+  this->disconnect(this->model(), SIGNAL(modelReset()),
+                   this, SLOT(onModelReset()));
+  this->disconnect(this->model(), SIGNAL(layoutChanged()),
+                   this, SLOT(onModelReset()));
   if (newModel != this->model())
     {
     this->setModel(newModel);
     }
   this->connect(this->model(), SIGNAL(dataChanged(QModelIndex,QModelIndex)),
                 this, SLOT(onDataChanged(QModelIndex,QModelIndex)));
+  this->connect(this->model(), SIGNAL(rowsInserted(QModelIndex,int,int)),
+                this, SLOT(onRowsInserted(QModelIndex,int,int)));
+  this->connect(this->model(), SIGNAL(rowsRemoved(QModelIndex,int,int)),
+                this, SLOT(onRowsRemoved()));
+  this->connect(this->model(), SIGNAL(modelReset()),
+                this, SLOT(onModelReset()));
+  this->connect(this->model(), SIGNAL(layoutChanged()),
+                this, SLOT(onModelReset()));
   d->CheckableModelHelper->setModel(newModel);
   d->updateCheckedList();
 }
@@ -320,7 +496,7 @@ QModelIndexList ctkCheckableComboBox::checkedIndexes()const
 bool ctkCheckableComboBox::allChecked()const
 {
   Q_D(const ctkCheckableComboBox);
-  return d->uncheckedIndexes().count() == 0;
+  return d->UncheckedList.count() == 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -355,11 +531,48 @@ ctkCheckableModelHelper* ctkCheckableComboBox::checkableModelHelper()const
 void ctkCheckableComboBox::onDataChanged(const QModelIndex& start, const QModelIndex& end)
 {
   Q_D(ctkCheckableComboBox);
-  Q_UNUSED(start);
-  Q_UNUSED(end);
+  d->updateCheckedList(start, end);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCheckableComboBox::onRowsInserted(const QModelIndex& parent, int first, int last)
+{
+  Q_D(ctkCheckableComboBox);
+  d->updateCheckedList(this->model()->index(first, 0, parent),
+                       this->model()->index(last, 0, parent));
+}
+
+//-----------------------------------------------------------------------------
+void ctkCheckableComboBox::onRowsRemoved()
+{
+  Q_D(ctkCheckableComboBox);
+  d->removeInvalidIndexes();
+}
+
+//-----------------------------------------------------------------------------
+void ctkCheckableComboBox::onModelReset()
+{
+  Q_D(ctkCheckableComboBox);
   d->updateCheckedList();
 }
 
+//-----------------------------------------------------------------------------
+bool ctkCheckableComboBox::uniformItemSizes()const
+{
+  QListView* listView = qobject_cast<QListView*>(this->view());
+  return listView ? listView->uniformItemSizes() : false;
+}
+
+//-----------------------------------------------------------------------------
+void ctkCheckableComboBox::setUniformItemSizes(bool uniform)
+{
+  QListView* listView = qobject_cast<QListView*>(this->view());
+  if (listView)
+    {
+    listView->setUniformItemSizes(uniform);
+    }
+}
+
 //-----------------------------------------------------------------------------
 void ctkCheckableComboBox::paintEvent(QPaintEvent *)
 {
@@ -372,36 +585,9 @@ void ctkCheckableComboBox::paintEvent(QPaintEvent *)
   QStyleOptionComboBox opt;
   this->initStyleOption(&opt);
 
-  if (this->allChecked())
-    {
-    opt.currentText = "All";
-    opt.currentIcon = QIcon();
-    }
-  else if (this->noneChecked())
-    {
-    opt.currentText = "None";
-    opt.currentIcon = QIcon();
-    }
-  else
-    {
-    //search the checked items
-    QModelIndexList indexes = d->cachedCheckedIndexes();
-    if (indexes.count() == 1)
-      {
-      opt.currentText = this->model()->data(indexes[0], Qt::DisplayRole).toString();
-      opt.currentIcon = qvariant_cast<QIcon>(this->model()->data(indexes[0], Qt::DecorationRole));
-      }
-    else
-      {
-      QStringList indexesText;
-      foreach(QModelIndex checkedIndex, indexes)
-        {
-        indexesText << this->model()->data(checkedIndex, Qt::DisplayRole).toString();
-        }
-      opt.currentText = indexesText.join(", ");
-      opt.currentIcon = QIcon();
-      }
-    }
+  d->updateDisplayText();
+  opt.currentText = d->DisplayText;
+  opt.currentIcon = d->DisplayIcon;
   painter.drawComplexControl(QStyle::CC_ComboBox, opt);
 
   // draw the icon and text
@@ -36,6 +36,11 @@ class ctkCheckableComboBoxPrivate;
 class CTK_WIDGETS_EXPORT ctkCheckableComboBox : public QComboBox
 {
   Q_OBJECT
+  /// This property holds whether all the items of the popup list have the
+  /// same size. The list then doesn't measure every item, which is much
+  /// faster with many items. False by default.
+  /// \sa QListView::uniformItemSizes
+  Q_PROPERTY(bool uniformItemSizes READ uniformItemSizes WRITE setUniformItemSizes)
 
 public:
   ctkCheckableComboBox(QWidget *parent = 0);
@@ -60,6 +65,9 @@ public:
   /// Returns a pointer to the checkable model helper to give a direct access
   /// to the check manager.
   ctkCheckableModelHelper* checkableModelHelper()const;
+
+  bool uniformItemSizes()const;
+  void setUniformItemSizes(bool uniform);
   
   /// Reimplemented for internal reasons
   bool eventFilter(QObject *o, QEvent *e);
@@ -69,6 +77,9 @@ Q_SIGNALS:
 
 protected Q_SLOTS:
   void onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+  void onRowsInserted(const QModelIndex& parent, int first, int last);
+  void onRowsRemoved();
+  void onModelReset();
 
 protected:
   /// Reimplemented for internal reasons
@@ -22,6 +22,8 @@
 #include <QAbstractItemModel>
 #include <QDebug>
 #include <QStandardItemModel>
+#include <QPair>
+#include <QPersistentModelIndex>
 #include <QPointer>
 
 // CTK includes
@@ -49,6 +51,10 @@ public:
   void updateCheckState(const QModelIndex& modelIndex);
   /// Set the check state of the index to all its children and grand children
   void propagateCheckStateToChildren(const QModelIndex& modelIndex);
+  /// Same as propagateCheckStateToChildren() but with the signals of the
+  /// model blocked. One dataChanged() per parent is emitted at the end for
+  /// the range of its children that were modified.
+  void propagateCheckStateToChildrenInBatch(const QModelIndex& modelIndex);
 
   Qt::CheckState checkState(const QModelIndex& index, bool *checkable)const;
   void setCheckState(const QModelIndex& index, Qt::CheckState newCheckState);
@@ -68,6 +74,10 @@ public:
   /// ...
   int                 PropagateDepth;
   Qt::CheckState      DefaultCheckState;
+  bool                BatchUpdates;
+  /// Ranges of indexes modified while the signals of the model are blocked.
+  bool                InBatch;
+  QList<QPair<QPersistentModelIndex, QPersistentModelIndex> > BatchRanges;
 };
 
 //----------------------------------------------------------------------------
@@ -79,6 +89,8 @@ ctkCheckableModelHelperPrivate::ctkCheckableModelHelperPrivate(ctkCheckableModel
   this->ForceCheckability = false;
   this->PropagateDepth = -1;
   this->DefaultCheckState = Qt::Unchecked;
+  this->BatchUpdates = false;
+  this->InBatch = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -235,23 +247,98 @@ void ctkCheckableModelHelperPrivate
     return;
     }
 
+  if (this->BatchUpdates && !this->InBatch)
+    {
+    this->propagateCheckStateToChildrenInBatch(modelIndex);
+    return;
+    }
+
   while (this->ForceCheckability && q->model()->canFetchMore(modelIndex))
     {
+    // The views must be told about the fetched rows, even in a batch.
+    bool wasBlocked = q->model()->blockSignals(false);
     q->model()->fetchMore(modelIndex);
+    q->model()->blockSignals(wasBlocked);
     }
   
   const int rowCount = q->orientation() == Qt::Horizontal ?
     q->model()->rowCount(modelIndex) : 1;
   const int columnCount = q->orientation() == Qt::Vertical ?
     q->model()->columnCount(modelIndex) : 1;
+  QModelIndex firstModifiedChild;
+  QModelIndex lastModifiedChild;
   for (int r = 0; r < rowCount; ++r)
     {
     for (int c = 0; c < columnCount; ++c)
       {
       QModelIndex child = q->model()->index(r, c, modelIndex);
+      if (this->InBatch)
+        {
+        bool childCheckable = false;
+        Qt::CheckState childCheckState = this->checkState(child, &childCheckable);
+        if (!childCheckable && !this->ForceCheckability)
+          {
+          continue;
+          }
+        if (childCheckable && childCheckState == checkState)
+          {
+          // Nothing to do for the child, but its own children may still
+          // have a different state.
+          this->propagateCheckStateToChildren(child);
+          continue;
+          }
+        if (!firstModifiedChild.isValid())
+          {
+          firstModifiedChild = child;
+          }
+        lastModifiedChild = child;
+        }
       this->setIndexCheckState(child, checkState);
       }
     }
+  if (firstModifiedChild.isValid())
+    {
+    this->BatchRanges << qMakePair(QPersistentModelIndex(firstModifiedChild),
+                                   QPersistentModelIndex(lastModifiedChild));
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkCheckableModelHelperPrivate
+::propagateCheckStateToChildrenInBatch(const QModelIndex& modelIndex)
+{
+  Q_Q(ctkCheckableModelHelper);
+  QAbstractItemModel* model = q->model();
+  this->InBatch = true;
+  bool wasBlocked = model->blockSignals(true);
+  this->propagateCheckStateToChildren(modelIndex);
+  model->blockSignals(wasBlocked);
+  this->InBatch = false;
+
+  QList<QPair<QPersistentModelIndex, QPersistentModelIndex> > ranges =
+    this->BatchRanges;
+  this->BatchRanges.clear();
+  if (wasBlocked)
+    {
+    return;
+    }
+  // The states are already consistent, don't process our own signals.
+  bool oldItemsAreUpdating = this->ItemsAreUpdating;
+  this->ItemsAreUpdating = true;
+  QList<QPair<QPersistentModelIndex, QPersistentModelIndex> >::const_iterator it;
+  for (it = ranges.constBegin(); it != ranges.constEnd(); ++it)
+    {
+    if (!it->first.isValid() || !it->second.isValid())
+      {
+      continue;
+      }
+    // dataChanged() is protected in Qt4, it can only be emitted through
+    // the meta object system.
+    QMetaObject::invokeMethod(model, "dataChanged", Qt::DirectConnection,
+      Q_ARG(QModelIndex, QModelIndex(it->first)),
+      Q_ARG(QModelIndex, QModelIndex(it->second)));
+    }
+  this->ItemsAreUpdating = oldItemsAreUpdating;
 }
 
 //-----------------------------------------------------------------------------
@@ -451,6 +538,20 @@ Qt::CheckState ctkCheckableModelHelper::defaultCheckState()const
   return d->DefaultCheckState;
 }
 
+//-----------------------------------------------------------------------------
+void ctkCheckableModelHelper::setBatchUpdates(bool batch)
+{
+  Q_D(ctkCheckableModelHelper);
+  d->BatchUpdates = batch;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkCheckableModelHelper::batchUpdates()const
+{
+  Q_D(const ctkCheckableModelHelper);
+  return d->BatchUpdates;
+}
+
 //-----------------------------------------------------------------------------
 void ctkCheckableModelHelper::setHeaderCheckState(int section, Qt::CheckState checkState)
 {
@@ -539,23 +640,37 @@ void ctkCheckableModelHelper::updateHeadersFromItems()
 void ctkCheckableModelHelper::onDataChanged(const QModelIndex & topLeft,
                                            const QModelIndex & bottomRight)
 {
-  Q_UNUSED(bottomRight);
   Q_D(ctkCheckableModelHelper);
   if(d->ItemsAreUpdating || d->PropagateDepth == 0)
     {
     return;
     }
-  bool checkable = false;
-  d->checkState(topLeft, &checkable);
-  if (!checkable)
+  // Only the rows (resp. columns) of the range are items of the helper.
+  const int lastRow = this->orientation() == Qt::Horizontal &&
+    bottomRight.isValid() ? bottomRight.row() : topLeft.row();
+  const int lastColumn = this->orientation() == Qt::Vertical &&
+    bottomRight.isValid() ? bottomRight.column() : topLeft.column();
+  bool anyCheckable = false;
+  d->ItemsAreUpdating = true;
+  for (int r = topLeft.row(); r <= lastRow; ++r)
     {
-    return;
+    for (int c = topLeft.column(); c <= lastColumn; ++c)
+      {
+      QModelIndex index = topLeft.sibling(r, c);
+      bool checkable = false;
+      d->checkState(index, &checkable);
+      if (!checkable)
+        {
+        continue;
+        }
+      anyCheckable = true;
+      d->propagateCheckStateToChildren(index);
+      }
+    }
+  if (anyCheckable)
+    {
+    d->updateCheckState(topLeft.parent());
     }
-  d->ItemsAreUpdating = true;
-  // TODO: handle topLeft "TO bottomRight"
-  d->propagateCheckStateToChildren(topLeft);
-  d->updateCheckState(topLeft.parent());
-
   d->ItemsAreUpdating = false;
 }
 
@@ -71,6 +71,7 @@ class CTK_WIDGETS_EXPORT ctkCheckableModelHelper : public QObject
   Q_PROPERTY(bool forceCheckability READ forceCheckability WRITE setForceCheckability);
   Q_PROPERTY(int propagateDepth READ propagateDepth WRITE setPropagateDepth);
   Q_PROPERTY(Qt::CheckState defaultCheckState READ defaultCheckState WRITE setDefaultCheckState);
+  Q_PROPERTY(bool batchUpdates READ batchUpdates WRITE setBatchUpdates);
 
 public:
   ctkCheckableModelHelper(Qt::Orientation orientation, QObject *parent=0);
@@ -127,6 +128,15 @@ public:
   Qt::CheckState defaultCheckState()const;
   void setDefaultCheckState(Qt::CheckState);
 
+  /// When true, the check state propagated to the children of an index is
+  /// set with the signals of the model blocked and a single dataChanged() is
+  /// emitted per parent for the range of its modified children, instead of
+  /// one per item. Other observers of the model are notified only once the
+  /// whole tree is updated.
+  /// False by default.
+  void setBatchUpdates(bool batch);
+  bool batchUpdates()const;
+
 public Q_SLOTS:
   void setCheckState(const QModelIndex& modelIndex, Qt::CheckState checkState);
   ///
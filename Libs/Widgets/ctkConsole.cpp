@@ -60,7 +60,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <QMimeData>
 #include <QPointer>
 #include <QPushButton>
+#include <QTextDocument>
 #include <QTextCursor>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QScrollBar>
 #include <QDebug>
@@ -99,7 +101,12 @@ ctkConsolePrivate::ctkConsolePrivate(ctkConsole& object) :
   CompleterShortcuts(QList<QKeySequence>() << Qt::Key_Tab),
   RunFileOptions(ctkConsole::RunFileShortcut),
   RunFileButton(NULL),
-  RunFileAction(NULL)
+  RunFileAction(NULL),
+  FlushInterval(16),
+  FlushTimer(NULL),
+  MaximumOutputRate(0),
+  OutputRateLineCount(0),
+  SuppressedLineCount(0)
 {
 }
 
@@ -157,6 +164,10 @@ void ctkConsolePrivate::init()
           SLOT(onScrollBarValueChanged(int)));
   connect(this, SIGNAL(textChanged()), SLOT(onTextChanged()));
   connect(this->RunFileButton, SIGNAL(clicked()), q, SLOT(runFile()));
+
+  this->FlushTimer = new QTimer(this);
+  this->FlushTimer->setSingleShot(true);
+  connect(this->FlushTimer, SIGNAL(timeout()), SLOT(flushOutput()));
 }
 
 //-----------------------------------------------------------------------------
@@ -594,6 +605,8 @@ void ctkConsolePrivate::internalExecuteCommand()
 {
   Q_Q(ctkConsole);
 
+  this->flushOutput(true);
+
   QString command = this->commandBuffer();
   if (this->EditorHints & ctkConsole::RemoveTrailingSpaces)
     {
@@ -636,6 +649,8 @@ void ctkConsolePrivate::internalExecuteCommand()
 //-----------------------------------------------------------------------------
 void ctkConsolePrivate::processInput()
 {
+  this->flushOutput(true);
+
   QString command = this->commandBuffer();
 
   if (this->EditorHints & ctkConsole::RemoveTrailingSpaces)
@@ -656,9 +671,94 @@ void ctkConsolePrivate::processInput()
 //-----------------------------------------------------------------------------
 void ctkConsolePrivate::printString(const QString& text)
 {
-  this->textCursor().movePosition(QTextCursor::End);
-  this->textCursor().insertText(text);
+  if (text.isEmpty())
+    {
+    return;
+    }
+  if (this->MaximumOutputRate > 0)
+    {
+    if (!this->OutputRatePeriod.isValid() ||
+        this->OutputRatePeriod.elapsed() >= 1000)
+      {
+      this->flushOutput(true);
+      this->OutputRatePeriod.start();
+      this->OutputRateLineCount = 0;
+      }
+    const int lineCount = text.count('\n');
+    if (this->OutputRateLineCount >= this->MaximumOutputRate)
+      {
+      this->SuppressedLineCount += lineCount;
+      return;
+      }
+    this->OutputRateLineCount += lineCount;
+    }
+
+  // Consecutive messages with the same format are written at once.
+  QTextCharFormat format = this->currentCharFormat();
+  if (!this->PendingOutput.isEmpty() &&
+      this->PendingOutput.last().second == format)
+    {
+    this->PendingOutput.last().first.append(text);
+    }
+  else
+    {
+    this->PendingOutput << qMakePair(text, format);
+    }
+
+  if (!this->LastFlushTime.isValid() ||
+      this->LastFlushTime.elapsed() >= this->FlushInterval)
+    {
+    // Nothing was written recently, don't delay the message. While the
+    // messages keep coming, they are written at most every FlushInterval
+    // msecs, even if the event loop is not running.
+    this->flushOutput();
+    }
+  else if (!this->FlushTimer->isActive())
+    {
+    this->FlushTimer->start(this->FlushInterval);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkConsolePrivate::flushOutput(bool final)
+{
+  if (this->SuppressedLineCount > 0 &&
+      (final || this->OutputRatePeriod.elapsed() >= 1000))
+    {
+    QTextCharFormat format = this->currentCharFormat();
+    format.setForeground(Qt::gray);
+    this->PendingOutput << qMakePair(
+      QString("\n... %1 lines of output suppressed ...\n").arg(this->SuppressedLineCount),
+      format);
+    this->SuppressedLineCount = 0;
+    }
+  this->FlushTimer->stop();
+  if (this->PendingOutput.isEmpty())
+    {
+    return;
+    }
+  QTextCursor cursor(this->document());
+  cursor.movePosition(QTextCursor::End);
+  cursor.beginEditBlock();
+  QList<QPair<QString, QTextCharFormat> >::const_iterator it;
+  for (it = this->PendingOutput.constBegin();
+       it != this->PendingOutput.constEnd(); ++it)
+    {
+    cursor.insertText(it->first, it->second);
+    }
+  cursor.endEditBlock();
+  this->PendingOutput.clear();
   this->InteractivePosition = this->documentEnd();
+  this->LastFlushTime.start();
+}
+
+//-----------------------------------------------------------------------------
+void ctkConsolePrivate::discardPendingOutput()
+{
+  this->FlushTimer->stop();
+  this->PendingOutput.clear();
+  this->SuppressedLineCount = 0;
+  this->OutputRateLineCount = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -707,6 +807,8 @@ void ctkConsolePrivate::promptForInput(const QString& indent)
 //-----------------------------------------------------------------------------
 void ctkConsolePrivate::prompt(const QString& text)
 {
+  this->flushOutput(true);
+
   QTextCursor text_cursor = this->textCursor();
 
   // If the cursor is currently on a clean line, do nothing, otherwise we move
@@ -987,6 +1089,40 @@ void ctkConsole::addCompleterShortcut(const QKeySequence& key)
 //-----------------------------------------------------------------------------
 CTK_GET_CPP(ctkConsole, ctkConsole::RunFileOptions, runFileOptions, RunFileOptions);
 
+//-----------------------------------------------------------------------------
+int ctkConsole::maximumBlockCount()const
+{
+  Q_D(const ctkConsole);
+  return d->document()->maximumBlockCount();
+}
+
+//-----------------------------------------------------------------------------
+void ctkConsole::setMaximumBlockCount(int count)
+{
+  Q_D(ctkConsole);
+  d->document()->setMaximumBlockCount(count);
+  d->InteractivePosition = d->documentEnd() - d->commandBuffer().length();
+}
+
+//-----------------------------------------------------------------------------
+CTK_GET_CPP(ctkConsole, int, maximumOutputRate, MaximumOutputRate);
+
+//-----------------------------------------------------------------------------
+void ctkConsole::setMaximumOutputRate(int linesPerSecond)
+{
+  Q_D(ctkConsole);
+  d->flushOutput(true);
+  d->MaximumOutputRate = qMax(0, linesPerSecond);
+  d->OutputRatePeriod.invalidate();
+}
+
+//-----------------------------------------------------------------------------
+void ctkConsole::flushOutput()
+{
+  Q_D(ctkConsole);
+  d->flushOutput(true);
+}
+
 //-----------------------------------------------------------------------------
 void ctkConsole::setRunFileOptions(const RunFileOptions& newOptions)
 {
@@ -1061,6 +1197,7 @@ void ctkConsole::clear()
 {
   Q_D(ctkConsole);
 
+  d->discardPendingOutput();
   d->clear();
 
   // For some reason the QCompleter tries to set the focus policy to
@@ -1075,6 +1212,7 @@ void ctkConsole::reset()
 {
   Q_D(ctkConsole);
 
+  d->discardPendingOutput();
   d->clear();
 
   // For some reason the QCompleter tries to set the focus policy to
@@ -1120,6 +1258,7 @@ QString ctkConsole::readInputLine()
 {
   Q_D(ctkConsole);
 
+  d->flushOutput(true);
   d->moveCursor(QTextCursor::End);
 
   QScopedPointer<InputEventLoop> eventLoop(new InputEventLoop(qApp));
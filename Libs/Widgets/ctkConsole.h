@@ -83,6 +83,8 @@ class CTK_WIDGETS_EXPORT ctkConsole : public QWidget
   Q_PROPERTY(QList<QKeySequence> completerShortcuts READ completerShortcuts WRITE setCompleterShortcuts)
   Q_FLAGS(RunFileOption RunFileOptions)
   Q_PROPERTY(RunFileOptions runFileOptions READ runFileOptions WRITE setRunFileOptions)
+  Q_PROPERTY(int maximumBlockCount READ maximumBlockCount WRITE setMaximumBlockCount)
+  Q_PROPERTY(int maximumOutputRate READ maximumOutputRate WRITE setMaximumOutputRate)
   
 public:
 
@@ -170,6 +172,7 @@ public:
   void setScrollBarPolicy(const Qt::ScrollBarPolicy& newScrollBarPolicy);
 
   /// Prints text on the console
+  /// \sa flushOutput(), maximumOutputRate
   void printMessage(const QString& message, const QColor& color);
 
   /// Returns the string used as primary prompt
@@ -207,6 +210,20 @@ public:
   /// \sa runFileOptions()
   void setRunFileOptions(const RunFileOptions& newOptions);
 
+  /// Maximum number of lines (blocks) kept in the console. The oldest lines
+  /// are removed when the limit is reached.
+  /// Default is 0 for no limit.
+  /// \sa QTextDocument::maximumBlockCount
+  int maximumBlockCount()const;
+  void setMaximumBlockCount(int count);
+
+  /// Maximum number of lines per second printed by printMessage(). Above
+  /// that rate, the messages are dropped until the end of the second and
+  /// the number of suppressed lines is printed instead.
+  /// Default is 0 for no limit.
+  int maximumOutputRate()const;
+  void setMaximumOutputRate(int linesPerSecond);
+
 Q_SIGNALS:
 
   /// This signal emitted before and after a command is executed
@@ -237,6 +254,10 @@ public Q_SLOTS:
   /// Print the console help with shortcuts.
   virtual void printHelp();
 
+  /// The messages printed with printMessage() are written to the console in
+  /// batches, at most every 16 msecs. Write the pending messages now.
+  void flushOutput();
+
 protected:
 
   /// Prompt the user for input
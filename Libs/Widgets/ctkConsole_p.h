@@ -22,15 +22,20 @@
 #define __ctkConsole_p_h
 
 // Qt includes
-#include <QTextEdit>
-#include <QPointer>
+#include <QElapsedTimer>
 #include <QEventLoop>
+#include <QList>
+#include <QPair>
+#include <QPointer>
+#include <QTextCharFormat>
+#include <QTextEdit>
 
 // CTK includes
 #include "ctkConsole.h"
 #include "ctkWidgetsExport.h"
 
 class QPushButton;
+class QTimer;
 
 /// \ingroup Widgets
 class CTK_WIDGETS_EXPORT ctkConsolePrivate : public QTextEdit
@@ -86,9 +91,15 @@ public:
 
   void processInput();
 
-  /// Writes the supplied text to the console
+  /// Writes the supplied text to the console.
+  /// The text is queued and written with the other pending messages at most
+  /// every FlushInterval msecs.
+  /// \sa flushOutput()
   void printString(const QString& text);
 
+  /// Drop the pending messages not written yet.
+  void discardPendingOutput();
+
   /// Updates the current command.
   /// Unlike printMessage(), this will affect the current command being typed.
   void printCommand(const QString& cmd);
@@ -122,6 +133,12 @@ public Q_SLOTS:
   /// \sa ctkConsole::errorTextColor
   void printErrorMessage(const QString& text);
 
+  /// Write the pending messages to the document in a single edit block.
+  /// If \a final is true, the summary of the suppressed output is written
+  /// even if the rate period is not over.
+  /// \sa ctkConsole::maximumOutputRate
+  void flushOutput(bool final = false);
+
   /// Update the value of ScrollbarAtBottom given the current position of the scollbar
   void onScrollBarValueChanged(int value);
 
@@ -194,6 +211,19 @@ public:
 
   QPushButton* RunFileButton;
   QAction* RunFileAction;
+
+  /// Messages printed and not written to the document yet
+  QList<QPair<QString, QTextCharFormat> > PendingOutput;
+  /// Delay between two writes of the pending messages, 16 msecs by default
+  int FlushInterval;
+  QTimer* FlushTimer;
+  QElapsedTimer LastFlushTime;
+
+  /// Lines per second above which the output is suppressed, 0 for no limit
+  int MaximumOutputRate;
+  QElapsedTimer OutputRatePeriod;
+  int OutputRateLineCount;
+  int SuppressedLineCount;
 };
 
 
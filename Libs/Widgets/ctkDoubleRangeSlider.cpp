@@ -251,8 +251,7 @@ double ctkDoubleRangeSlider::minimum()const
   double max = d->Maximum;
   if (d->Proxy)
     {
-    min = d->Proxy.data()->valueFromProxyValue(min);
-    max = d->Proxy.data()->valueFromProxyValue(max);
+    d->Proxy.data()->valueRangeFromProxyRange(min, max, min, max);
     }
   return qMin(min, max);
 }
@@ -293,8 +292,7 @@ double ctkDoubleRangeSlider::maximum()const
   double max = d->Maximum;
   if (d->Proxy)
     {
-    min = d->Proxy.data()->valueFromProxyValue(min);
-    max = d->Proxy.data()->valueFromProxyValue(max);
+    d->Proxy.data()->valueRangeFromProxyRange(min, max, min, max);
     }
   return qMax(min, max);
 }
@@ -305,8 +303,7 @@ void ctkDoubleRangeSlider::setRange(double newMin, double newMax)
   Q_D(ctkDoubleRangeSlider);
   if (d->Proxy)
     {
-    newMin = d->Proxy.data()->proxyValueFromValue(newMin);
-    newMax = d->Proxy.data()->proxyValueFromValue(newMax);
+    d->Proxy.data()->proxyRangeFromValueRange(newMin, newMax, newMin, newMax);
     }
 
   if (newMin > newMax)
@@ -400,8 +397,7 @@ void ctkDoubleRangeSlider::setPositions(double newMinPos, double newMaxPos)
   Q_D(ctkDoubleRangeSlider);
   if (d->Proxy)
     {
-    newMinPos = d->Proxy.data()->proxyValueFromValue(newMinPos);
-    newMaxPos = d->Proxy.data()->proxyValueFromValue(newMaxPos);
+    d->Proxy.data()->proxyRangeFromValueRange(newMinPos, newMaxPos, newMinPos, newMaxPos);
     }
   int newIntMinPos = d->toInt(newMinPos);
   int newIntMaxPos = d->toInt(newMaxPos);
@@ -416,8 +412,7 @@ double ctkDoubleRangeSlider::minimumValue()const
   double maxValue = d->MaxValue;
   if (d->Proxy)
     {
-    minValue = d->Proxy.data()->valueFromProxyValue(minValue);
-    maxValue = d->Proxy.data()->valueFromProxyValue(maxValue);
+    d->Proxy.data()->valueRangeFromProxyRange(minValue, maxValue, minValue, maxValue);
     }
   return qMin(minValue, maxValue);
 }
@@ -465,8 +460,7 @@ double ctkDoubleRangeSlider::maximumValue()const
   double maxValue = d->MaxValue;
   if (d->Proxy)
     {
-    minValue = d->Proxy.data()->valueFromProxyValue(minValue);
-    maxValue = d->Proxy.data()->valueFromProxyValue(maxValue);
+    d->Proxy.data()->valueRangeFromProxyRange(minValue, maxValue, minValue, maxValue);
     }
   return qMax(minValue, maxValue);
 }
@@ -515,8 +509,7 @@ void ctkDoubleRangeSlider::setValues(double newMinVal, double newMaxVal)
   // new max value wouldn't be updated yet.
   if (d->Proxy)
     {
-    newMaxVal = d->Proxy.data()->proxyValueFromValue(newMaxVal);
-    newMinVal = d->Proxy.data()->proxyValueFromValue(newMinVal);
+    d->Proxy.data()->proxyRangeFromValueRange(newMaxVal, newMinVal, newMaxVal, newMinVal);
     }
   double newMinValue = qBound(d->Minimum, qMin(newMinVal, newMaxVal), d->Maximum);
   double newMaxValue = qBound(d->Minimum, qMax(newMinVal, newMaxVal), d->Maximum);
@@ -587,10 +580,8 @@ void ctkDoubleRangeSlider::setSingleStep(double newStep)
   double maxValue = d->MaxValue;
   if (d->Proxy)
     {
-    minimum = d->Proxy.data()->valueFromProxyValue(minimum);
-    maximum = d->Proxy.data()->valueFromProxyValue(maximum);
-    minValue = d->Proxy.data()->valueFromProxyValue(minValue);
-    maxValue = d->Proxy.data()->valueFromProxyValue(maxValue);
+    d->Proxy.data()->valueRangeFromProxyRange(minimum, maximum, minimum, maximum);
+    d->Proxy.data()->valueRangeFromProxyRange(minValue, maxValue, minValue, maxValue);
    }
   // calling setRange can change the MinimumValue and MaximumValue values,
   // this is why we re-set them after.
@@ -773,8 +764,7 @@ void ctkDoubleRangeSlider::onPositionsChanged(int newIntMinPos, int newIntMaxPos
   double newMaxPos = d->safeMaxFromInt(newIntMaxPos);
   if (d->Proxy)
     {
-    newMinPos = d->Proxy.data()->valueFromProxyValue(newMinPos);
-    newMaxPos = d->Proxy.data()->valueFromProxyValue(newMaxPos);
+    d->Proxy.data()->valueRangeFromProxyRange(newMinPos, newMaxPos, newMinPos, newMaxPos);
     }
   emit this->positionsChanged(newMinPos, newMaxPos);
 }
@@ -791,8 +781,7 @@ void ctkDoubleRangeSlider::onRangeChanged(int newIntMin, int newIntMax)
   double newMax = d->maxFromInt(newIntMax);
   if (d->Proxy)
     {
-    newMin = d->Proxy.data()->valueFromProxyValue(newMin);
-    newMax = d->Proxy.data()->valueFromProxyValue(newMax);
+    d->Proxy.data()->valueRangeFromProxyRange(newMin, newMax, newMin, newMax);
     }
   this->setRange(newMin, newMax);
 }
@@ -211,8 +211,7 @@ void ctkDoubleSlider::setRange(double newMin, double newMax)
   Q_D(ctkDoubleSlider);
   if (d->Proxy)
     {
-    newMin = d->Proxy.data()->proxyValueFromValue(newMin);
-    newMax = d->Proxy.data()->proxyValueFromValue(newMax);
+    d->Proxy.data()->proxyRangeFromValueRange(newMin, newMax, newMin, newMax);
     }
 
   if (newMin > newMax)
@@ -255,8 +254,7 @@ double ctkDoubleSlider::minimum()const
   double max = d->Maximum;
   if (d->Proxy)
     {
-    min = d->Proxy.data()->valueFromProxyValue(min);
-    max = d->Proxy.data()->valueFromProxyValue(max);
+    d->Proxy.data()->valueRangeFromProxyRange(min, max, min, max);
     }
   return qMin(min, max);
 }
@@ -269,8 +267,7 @@ double ctkDoubleSlider::maximum()const
   double max = d->Maximum;
   if (d->Proxy)
     {
-    min = d->Proxy.data()->valueFromProxyValue(min);
-    max = d->Proxy.data()->valueFromProxyValue(max);
+    d->Proxy.data()->valueRangeFromProxyRange(min, max, min, max);
     }
   return qMax(min, max);
 }
@@ -560,8 +557,7 @@ void ctkDoubleSlider::onRangeChanged(int newIntMin, int newIntMax)
   double newMax = d->fromInt(newIntMax);
   if (d->Proxy)
     {
-    newMin = d->Proxy.data()->valueFromProxyValue(newMin);
-    newMax = d->Proxy.data()->valueFromProxyValue(newMax);
+    d->Proxy.data()->valueRangeFromProxyRange(newMin, newMax, newMin, newMax);
     }
   this->setRange(newMin, newMax);
 }
@@ -526,8 +526,7 @@ void ctkDoubleSpinBoxPrivate::onValueChanged()
   double maximum = q->maximum();
   if (this->Proxy)
     {
-    minimum = this->Proxy.data()->proxyValueFromValue(minimum);
-    maximum = this->Proxy.data()->proxyValueFromValue(maximum);
+    this->Proxy.data()->proxyRangeFromValueRange(minimum, maximum, minimum, maximum);
     }
   // Special case to return max precision
   if (this->compare(minimum, newValue))
@@ -793,8 +792,7 @@ void ctkDoubleSpinBox::setRange(double newMin, double newMax)
   d->InputRange[1] = newMax;
   if (d->Proxy)
     {
-    newMin = d->Proxy.data()->proxyValueFromValue(newMin);
-    newMax = d->Proxy.data()->proxyValueFromValue(newMax);
+    d->Proxy.data()->proxyRangeFromValueRange(newMin, newMax, newMin, newMax);
     if (newMin > newMax)
       {
       qSwap(newMin, newMax);
@@ -21,14 +21,16 @@
 // Qt includes
 #include <QCoreApplication>
 #include <QDateTime>
+#include <QAbstractTableModel>
 #include <QDebug>
 #include <QFile>
 #include <QMetaEnum>
 #include <QMetaType>
 #include <QMutexLocker>
 #include <QPointer>
-#include <QStandardItem>
 #include <QThread>
+#include <QVector>
+#include <QWaitCondition>
 
 // CTK includes
 #include "ctkErrorLogContext.h"
@@ -36,6 +38,357 @@
 #include "ctkErrorLogAbstractMessageHandler.h"
 #include "ctkFileLogger.h"
 
+// --------------------------------------------------------------------------
+// ctkErrorLogEntryStorage
+
+// --------------------------------------------------------------------------
+/// Source model of ctkErrorLogModel. The entries are stored by column, the
+/// origins and thread ids are interned, and the oldest entries are overwritten
+/// once maximumCount() entries are stored.
+class ctkErrorLogEntryStorage : public QAbstractTableModel
+{
+public:
+  typedef QAbstractTableModel Superclass;
+
+  struct Entry
+    {
+    qint64 Time;
+    int ThreadId;
+    int Origin;
+    int LogLevel;
+    QString Description;
+    // Length of the first message of the description, the next ones are grouped
+    int FirstMessageLength;
+    };
+
+  ctkErrorLogEntryStorage();
+
+  virtual int rowCount(const QModelIndex& parent = QModelIndex())const;
+  virtual int columnCount(const QModelIndex& parent = QModelIndex())const;
+  virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole)const;
+  virtual Qt::ItemFlags flags(const QModelIndex& index)const;
+
+  int intern(const QString& value);
+
+  int logLevel(int row)const;
+  Entry entry(int row)const;
+
+  /// Append \a entries with a single insertion, the oldest entries are
+  /// removed first if needed.
+  void appendEntries(const QVector<Entry>& entries);
+
+  /// Group \a text with the description of the last entry.
+  void appendToLastEntry(const QString& text);
+
+  void clearEntries();
+
+  /// 0, the default, for no limit.
+  int maximumCount()const;
+  void setMaximumCount(int value);
+
+  static const char* TimeFormat;
+
+protected:
+  int physicalRow(int row)const;
+  void removeFirstEntries(int count);
+  void linearize();
+
+  QVector<qint64> Times;
+  QVector<int> ThreadIds;
+  QVector<int> Origins;
+  QVector<int> LogLevels;
+  QVector<QString> Descriptions;
+  QVector<int> FirstMessageLengths;
+
+  QStringList InternedStrings;
+  QHash<QString, int> InternedIndexes;
+
+  // Physical row of the oldest entry
+  int Start;
+  int Count;
+  int MaximumCount;
+};
+
+const char* ctkErrorLogEntryStorage::TimeFormat = "dd.MM.yyyy hh:mm:ss";
+
+// --------------------------------------------------------------------------
+ctkErrorLogEntryStorage::ctkErrorLogEntryStorage()
+  : Start(0), Count(0), MaximumCount(0)
+{
+}
+
+// --------------------------------------------------------------------------
+int ctkErrorLogEntryStorage::rowCount(const QModelIndex& parent)const
+{
+  return parent.isValid() ? 0 : this->Count;
+}
+
+// --------------------------------------------------------------------------
+int ctkErrorLogEntryStorage::columnCount(const QModelIndex& parent)const
+{
+  return parent.isValid() ? 0 : ctkErrorLogModel::MaxColumn + 1;
+}
+
+// --------------------------------------------------------------------------
+QVariant ctkErrorLogEntryStorage::data(const QModelIndex& index, int role)const
+{
+  if (!index.isValid() || index.row() >= this->Count)
+    {
+    return QVariant();
+    }
+  int row = this->physicalRow(index.row());
+  if (role == ctkErrorLogModel::DescriptionTextRole
+      && index.column() == ctkErrorLogModel::DescriptionColumn)
+    {
+    return this->Descriptions.at(row);
+    }
+  if (role != Qt::DisplayRole && role != Qt::EditRole)
+    {
+    return QVariant();
+    }
+  switch(index.column())
+    {
+    case ctkErrorLogModel::TimeColumn:
+      return QDateTime::fromMSecsSinceEpoch(this->Times.at(row)).toString(ctkErrorLogEntryStorage::TimeFormat);
+    case ctkErrorLogModel::ThreadIdColumn:
+      return this->InternedStrings.at(this->ThreadIds.at(row));
+    case ctkErrorLogModel::LogLevelColumn:
+      return ctkErrorLogLevel::logLevelAsString(
+            static_cast<ctkErrorLogLevel::LogLevel>(this->LogLevels.at(row)));
+    case ctkErrorLogModel::OriginColumn:
+      return this->InternedStrings.at(this->Origins.at(row));
+    case ctkErrorLogModel::DescriptionColumn:
+      {
+      const QString& description = this->Descriptions.at(row);
+      int firstMessageLength = this->FirstMessageLengths.at(row);
+      bool grouped = description.size() > firstMessageLength;
+      if (!grouped && firstMessageLength <= 160)
+        {
+        return description;
+        }
+      return description.left(qMin(firstMessageLength, 160)).append("...");
+      }
+    default:
+      return QVariant();
+    }
+}
+
+// --------------------------------------------------------------------------
+Qt::ItemFlags ctkErrorLogEntryStorage::flags(const QModelIndex& index)const
+{
+  if (!index.isValid())
+    {
+    return Qt::NoItemFlags;
+    }
+  return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+}
+
+// --------------------------------------------------------------------------
+int ctkErrorLogEntryStorage::intern(const QString& value)
+{
+  QHash<QString, int>::const_iterator it = this->InternedIndexes.find(value);
+  if (it != this->InternedIndexes.end())
+    {
+    return it.value();
+    }
+  int index = this->InternedStrings.count();
+  this->InternedStrings << value;
+  this->InternedIndexes.insert(value, index);
+  return index;
+}
+
+// --------------------------------------------------------------------------
+int ctkErrorLogEntryStorage::logLevel(int row)const
+{
+  return this->LogLevels.at(this->physicalRow(row));
+}
+
+// --------------------------------------------------------------------------
+ctkErrorLogEntryStorage::Entry ctkErrorLogEntryStorage::entry(int row)const
+{
+  int physicalRow = this->physicalRow(row);
+  Entry entry;
+  entry.Time = this->Times.at(physicalRow);
+  entry.ThreadId = this->ThreadIds.at(physicalRow);
+  entry.Origin = this->Origins.at(physicalRow);
+  entry.LogLevel = this->LogLevels.at(physicalRow);
+  entry.Description = this->Descriptions.at(physicalRow);
+  entry.FirstMessageLength = this->FirstMessageLengths.at(physicalRow);
+  return entry;
+}
+
+// --------------------------------------------------------------------------
+int ctkErrorLogEntryStorage::physicalRow(int row)const
+{
+  if (this->Start == 0)
+    {
+    return row;
+    }
+  return (this->Start + row) % this->Times.size();
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogEntryStorage::appendEntries(const QVector<Entry>& entries)
+{
+  if (entries.isEmpty())
+    {
+    return;
+    }
+
+  int first = 0;
+  int count = entries.count();
+  if (this->MaximumCount > 0)
+    {
+    if (count > this->MaximumCount)
+      {
+      first = count - this->MaximumCount;
+      count = this->MaximumCount;
+      }
+    if (this->Count + count > this->MaximumCount)
+      {
+      this->removeFirstEntries(this->Count + count - this->MaximumCount);
+      }
+    }
+
+  this->beginInsertRows(QModelIndex(), this->Count, this->Count + count - 1);
+  for (int i = first; i < entries.count(); ++i)
+    {
+    const Entry& entry = entries.at(i);
+    if (this->Count == this->Times.size())
+      {
+      this->Times.append(entry.Time);
+      this->ThreadIds.append(entry.ThreadId);
+      this->Origins.append(entry.Origin);
+      this->LogLevels.append(entry.LogLevel);
+      this->Descriptions.append(entry.Description);
+      this->FirstMessageLengths.append(entry.FirstMessageLength);
+      }
+    else
+      {
+      // Reuse the row of a removed entry
+      int row = this->physicalRow(this->Count);
+      this->Times[row] = entry.Time;
+      this->ThreadIds[row] = entry.ThreadId;
+      this->Origins[row] = entry.Origin;
+      this->LogLevels[row] = entry.LogLevel;
+      this->Descriptions[row] = entry.Description;
+      this->FirstMessageLengths[row] = entry.FirstMessageLength;
+      }
+    ++this->Count;
+    }
+  this->endInsertRows();
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogEntryStorage::appendToLastEntry(const QString& text)
+{
+  Q_ASSERT(this->Count > 0);
+  int row = this->physicalRow(this->Count - 1);
+  this->Descriptions[row].append("\n").append(text);
+  QModelIndex index = this->index(this->Count - 1, ctkErrorLogModel::DescriptionColumn);
+  emit this->dataChanged(index, index);
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogEntryStorage::removeFirstEntries(int count)
+{
+  count = qMin(count, this->Count);
+  if (count <= 0)
+    {
+    return;
+    }
+  this->beginRemoveRows(QModelIndex(), 0, count - 1);
+  for (int i = 0; i < count; ++i)
+    {
+    // Release the memory of the description
+    this->Descriptions[this->physicalRow(i)] = QString();
+    }
+  this->Start = (this->Start + count) % this->Times.size();
+  this->Count -= count;
+  if (this->Count == 0)
+    {
+    this->Start = 0;
+    }
+  this->endRemoveRows();
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogEntryStorage::linearize()
+{
+  if (this->Start == 0)
+    {
+    return;
+    }
+  QVector<qint64> times(this->Count);
+  QVector<int> threadIds(this->Count);
+  QVector<int> origins(this->Count);
+  QVector<int> logLevels(this->Count);
+  QVector<QString> descriptions(this->Count);
+  QVector<int> firstMessageLengths(this->Count);
+  for (int i = 0; i < this->Count; ++i)
+    {
+    int row = this->physicalRow(i);
+    times[i] = this->Times.at(row);
+    threadIds[i] = this->ThreadIds.at(row);
+    origins[i] = this->Origins.at(row);
+    logLevels[i] = this->LogLevels.at(row);
+    descriptions[i] = this->Descriptions.at(row);
+    firstMessageLengths[i] = this->FirstMessageLengths.at(row);
+    }
+  this->Times = times;
+  this->ThreadIds = threadIds;
+  this->Origins = origins;
+  this->LogLevels = logLevels;
+  this->Descriptions = descriptions;
+  this->FirstMessageLengths = firstMessageLengths;
+  this->Start = 0;
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogEntryStorage::clearEntries()
+{
+  this->beginResetModel();
+  this->Times.clear();
+  this->ThreadIds.clear();
+  this->Origins.clear();
+  this->LogLevels.clear();
+  this->Descriptions.clear();
+  this->FirstMessageLengths.clear();
+  this->InternedStrings.clear();
+  this->InternedIndexes.clear();
+  this->Start = 0;
+  this->Count = 0;
+  this->endResetModel();
+}
+
+// --------------------------------------------------------------------------
+int ctkErrorLogEntryStorage::maximumCount()const
+{
+  return this->MaximumCount;
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogEntryStorage::setMaximumCount(int value)
+{
+  value = qMax(0, value);
+  if (value == this->MaximumCount)
+    {
+    return;
+    }
+  if (value > 0 && this->Count > value)
+    {
+    this->removeFirstEntries(this->Count - value);
+    }
+  // The rows are reused in order from the first physical one
+  this->linearize();
+  this->Times.resize(this->Count);
+  this->ThreadIds.resize(this->Count);
+  this->Origins.resize(this->Count);
+  this->LogLevels.resize(this->Count);
+  this->Descriptions.resize(this->Count);
+  this->FirstMessageLengths.resize(this->Count);
+  this->MaximumCount = value;
+}
 
 // --------------------------------------------------------------------------
 // ctkErrorLogModelPrivate
@@ -54,11 +407,26 @@ public:
 
   void setMessageHandlerConnection(ctkErrorLogAbstractMessageHandler * msgHandler, bool asynchronous);
 
-  QStandardItemModel StandardItemModel;
+  struct PendingEntry
+    {
+    QDateTime CurrentDateTime;
+    QString ThreadId;
+    ctkErrorLogLevel::LogLevel LogLevel;
+    QString Origin;
+    ctkErrorLogContext Context;
+    QString Text;
+    };
+
+  /// Add \a entries to the model, the rows are inserted at once.
+  void addEntries(const QList<PendingEntry>& entries);
+
+  ctkErrorLogEntryStorage EntryStorage;
 
   QHash<QString, ctkErrorLogAbstractMessageHandler*> RegisteredHandlers;
 
-  ctkErrorLogLevel::LogLevels CurrentLogLevelFilter;
+  // Levels accepted by filterAcceptsRow(), all of them if the filter is disabled.
+  bool LogLevelFilterEnabled;
+  int LogLevelFilterMask;
 
   bool LogEntryGrouping;
   bool AsynchronousLogging;
@@ -71,6 +439,17 @@ public:
 
   ctkFileLogger FileLogger;
   QString FileLoggingPattern;
+
+  // Queue of the asynchronous logging, written by the logging threads and
+  // emptied by processPendingEntries() in the thread of the model.
+  mutable QMutex PendingEntriesMutex;
+  QWaitCondition PendingEntriesTaken;
+  QList<PendingEntry> PendingEntries;
+  bool ProcessingScheduled;
+  int MaximumPendingEntries;
+  ctkErrorLogModel::QueueFullPolicy QueueFullPolicy;
+  int DroppedEntryCount;
+  int CoalescedEntryCount;
 };
 
 // --------------------------------------------------------------------------
@@ -81,10 +460,16 @@ ctkErrorLogModelPrivate::ctkErrorLogModelPrivate(ctkErrorLogModel& object)
   : q_ptr(&object)
 {
   qRegisterMetaType<ctkErrorLogContext>("ctkErrorLogContext");
-  this->StandardItemModel.setColumnCount(ctkErrorLogModel::MaxColumn);
+  this->LogLevelFilterEnabled = false;
+  this->LogLevelFilterMask = 0;
   this->LogEntryGrouping = false;
   this->AsynchronousLogging = true;
   this->AddingEntry = false;
+  this->ProcessingScheduled = false;
+  this->MaximumPendingEntries = 10000;
+  this->QueueFullPolicy = ctkErrorLogModel::CoalesceWhenFull;
+  this->DroppedEntryCount = 0;
+  this->CoalescedEntryCount = 0;
   this->FileLogger.setEnabled(false);
   this->FileLoggingPattern = "[%{level}][%{origin}] %{timestamp} [%{category}] (%{file}:%{line}) - %{msg}";
 }
@@ -110,7 +495,7 @@ void ctkErrorLogModelPrivate::init()
   //
   // WARNING - Using a QSortFilterProxyModel slows down the insertion of rows by a factor 10
   //
-  q->setSourceModel(&this->StandardItemModel);
+  q->setSourceModel(&this->EntryStorage);
   q->setFilterKeyColumn(ctkErrorLogModel::LogLevelColumn);
 }
 
@@ -122,10 +507,102 @@ void ctkErrorLogModelPrivate::setMessageHandlerConnection(
 
   msgHandler->disconnect();
 
-  QObject::connect(msgHandler,
-        SIGNAL(messageHandled(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
-        q, SLOT(addEntry(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
-        asynchronous ? Qt::QueuedConnection : Qt::BlockingQueuedConnection);
+  if (asynchronous)
+    {
+    // queueEntry() is thread-safe, it is called by the thread of the handler
+    QObject::connect(msgHandler,
+          SIGNAL(messageHandled(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
+          q, SLOT(queueEntry(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
+          Qt::DirectConnection);
+    }
+  else
+    {
+    QObject::connect(msgHandler,
+          SIGNAL(messageHandled(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
+          q, SLOT(addEntryFromHandlerThread(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
+          Qt::DirectConnection);
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogModelPrivate::addEntries(const QList<PendingEntry>& entries)
+{
+  Q_Q(ctkErrorLogModel);
+
+  if (this->AddingEntry || entries.isEmpty())
+    {
+    return;
+    }
+
+  this->AddingEntry = true;
+
+  int groupingIntervalInMsecs = 1000;
+  QVector<ctkErrorLogEntryStorage::Entry> newEntries;
+  foreach(const PendingEntry& pendingEntry, entries)
+    {
+    ctkErrorLogEntryStorage::Entry entry;
+    entry.Time = pendingEntry.CurrentDateTime.toMSecsSinceEpoch();
+    entry.ThreadId = this->EntryStorage.intern(pendingEntry.ThreadId);
+    entry.Origin = this->EntryStorage.intern(pendingEntry.Origin);
+    entry.LogLevel = pendingEntry.LogLevel;
+
+    if (this->LogEntryGrouping)
+      {
+      // Compare with the last entry of the batch or of the model
+      bool lastEntryInBatch = !newEntries.isEmpty();
+      if (lastEntryInBatch || this->EntryStorage.rowCount() > 0)
+        {
+        ctkErrorLogEntryStorage::Entry lastEntry = lastEntryInBatch ?
+              newEntries.last() : this->EntryStorage.entry(this->EntryStorage.rowCount() - 1);
+        if (lastEntry.ThreadId == entry.ThreadId
+            && lastEntry.LogLevel == entry.LogLevel
+            && lastEntry.Origin == entry.Origin
+            && entry.Time - lastEntry.Time <= groupingIntervalInMsecs)
+          {
+          if (lastEntryInBatch)
+            {
+            newEntries.last().Description.append("\n").append(pendingEntry.Text);
+            }
+          else
+            {
+            this->EntryStorage.appendToLastEntry(pendingEntry.Text);
+            }
+          continue;
+          }
+        }
+      }
+
+    entry.Description = pendingEntry.Text;
+    entry.FirstMessageLength = pendingEntry.Text.size();
+    newEntries << entry;
+    }
+  this->EntryStorage.appendEntries(newEntries);
+
+  this->AddingEntry = false;
+
+  foreach(const PendingEntry& pendingEntry, entries)
+    {
+    const ctkErrorLogContext& context = pendingEntry.Context;
+    QString fileLogText = this->FileLoggingPattern;
+    fileLogText.replace("%{level}", this->ErrorLogLevel(pendingEntry.LogLevel).toUpper());
+    fileLogText.replace("%{timestamp}", pendingEntry.CurrentDateTime.toString(ctkErrorLogEntryStorage::TimeFormat));
+    fileLogText.replace("%{origin}", pendingEntry.Origin);
+    fileLogText.replace("%{pid}", QString("%1").arg(QCoreApplication::applicationPid()));
+    fileLogText.replace("%{threadid}", pendingEntry.ThreadId);
+    fileLogText.replace("%{function}", context.Function);
+    fileLogText.replace("%{line}", QString("%1").arg(context.Line));
+    fileLogText.replace("%{file}", context.File);
+    fileLogText.replace("%{category}", context.Category);
+    fileLogText.replace("%{msg}", context.Message);
+    this->FileLogger.logMessage(fileLogText.trimmed());
+    if (pendingEntry.LogLevel == ctkErrorLogLevel::Critical || pendingEntry.LogLevel == ctkErrorLogLevel::Fatal)
+      {
+      // do not lose the messages queued by an asynchronous file logger
+      this->FileLogger.flush();
+      }
+
+    emit q->entryAdded(pendingEntry.LogLevel);
+    }
 }
 
 // --------------------------------------------------------------------------
@@ -271,115 +748,125 @@ void ctkErrorLogModel::addEntry(const QDateTime& currentDateTime, const QString&
 {
   Q_D(ctkErrorLogModel);
 
-  if (d->AddingEntry)
+  ctkErrorLogModelPrivate::PendingEntry entry;
+  entry.CurrentDateTime = currentDateTime;
+  entry.ThreadId = threadId;
+  entry.LogLevel = logLevel;
+  entry.Origin = origin;
+  entry.Context = context;
+  entry.Text = text;
+  d->addEntries(QList<ctkErrorLogModelPrivate::PendingEntry>() << entry);
+}
+
+//------------------------------------------------------------------------------
+void ctkErrorLogModel::addEntryFromHandlerThread(const QDateTime& currentDateTime, const QString& threadId,
+                                                 ctkErrorLogLevel::LogLevel logLevel,
+                                                 const QString& origin, const ctkErrorLogContext &context,
+                                                 const QString &text)
+{
+  if (QThread::currentThread() == this->thread())
     {
+    this->addEntry(currentDateTime, threadId, logLevel, origin, context, text);
     return;
     }
+  QMetaObject::invokeMethod(this, "addEntry", Qt::BlockingQueuedConnection,
+                            Q_ARG(QDateTime, currentDateTime), Q_ARG(QString, threadId),
+                            Q_ARG(ctkErrorLogLevel::LogLevel, logLevel), Q_ARG(QString, origin),
+                            Q_ARG(ctkErrorLogContext, context), Q_ARG(QString, text));
+}
 
-  d->AddingEntry = true;
-
-  QString timeFormat("dd.MM.yyyy hh:mm:ss");
+//------------------------------------------------------------------------------
+void ctkErrorLogModel::queueEntry(const QDateTime& currentDateTime, const QString& threadId,
+                                  ctkErrorLogLevel::LogLevel logLevel,
+                                  const QString& origin, const ctkErrorLogContext &context, const QString &text)
+{
+  Q_D(ctkErrorLogModel);
 
-  bool groupEntry = false;
-  if (d->LogEntryGrouping)
+  bool modelThread = QThread::currentThread() == this->thread();
+  if (modelThread && d->AddingEntry)
     {
-    int lastRowIndex = d->StandardItemModel.rowCount() - 1;
-
-    QString lastRowThreadId = this->logEntryData(lastRowIndex, Self::ThreadIdColumn).toString();
-    bool threadIdMatched = threadId == lastRowThreadId;
-
-    QString lastRowLogLevel = this->logEntryData(lastRowIndex, Self::LogLevelColumn).toString();
-    bool logLevelMatched = d->ErrorLogLevel(logLevel) == lastRowLogLevel;
-
-    QString lastRowOrigin = this->logEntryData(lastRowIndex, Self::OriginColumn).toString();
-    bool originMatched = origin == lastRowOrigin;
-
-    QDateTime lastRowDateTime =
-        QDateTime::fromString(this->logEntryData(lastRowIndex, Self::TimeColumn).toString(), timeFormat);
-    int groupingIntervalInMsecs = 1000;
-    bool withinGroupingInterval = lastRowDateTime.time().msecsTo(currentDateTime.time()) <= groupingIntervalInMsecs;
-
-    groupEntry = threadIdMatched && logLevelMatched && originMatched && withinGroupingInterval;
+    // Message logged while adding an entry, see addEntry()
+    return;
     }
 
-  if (!groupEntry)
-    {
-    QList<QStandardItem*> itemList;
-
-    // Time item
-    QStandardItem * timeItem = new QStandardItem(currentDateTime.toString(timeFormat));
-    timeItem->setEditable(false);
-    itemList << timeItem;
-
-    // ThreadId item
-    QStandardItem * threadIdItem = new QStandardItem(threadId);
-    threadIdItem->setEditable(false);
-    itemList << threadIdItem;
-
-    // LogLevel item
-    QStandardItem * logLevelItem = new QStandardItem(d->ErrorLogLevel(logLevel));
-    logLevelItem->setEditable(false);
-    itemList << logLevelItem;
-
-    // Origin item
-    QStandardItem * originItem = new QStandardItem(origin);
-    originItem->setEditable(false);
-    itemList << originItem;
+  QMutexLocker locker(&d->PendingEntriesMutex);
 
-    // Description item
-    QStandardItem * descriptionItem = new QStandardItem();
-    QString descriptionText(text);
-    descriptionItem->setData(descriptionText.left(160).append((descriptionText.size() > 160) ? "..." : ""), Qt::DisplayRole);
-    descriptionItem->setData(descriptionText, ctkErrorLogModel::DescriptionTextRole);
-    descriptionItem->setEditable(false);
-    itemList << descriptionItem;
-
-    d->StandardItemModel.invisibleRootItem()->appendRow(itemList);
-    }
-  else
+  if (d->PendingEntries.count() >= d->MaximumPendingEntries
+      && d->QueueFullPolicy == Self::BlockWhenFull)
     {
-    // Retrieve description associated with last row
-    QModelIndex lastRowDescriptionIndex =
-        d->StandardItemModel.index(d->StandardItemModel.rowCount() - 1, ctkErrorLogModel::DescriptionColumn);
-
-    QStringList updatedDescription;
-    updatedDescription << lastRowDescriptionIndex.data(ctkErrorLogModel::DescriptionTextRole).toString();
-    updatedDescription << text;
-
-    d->StandardItemModel.setData(lastRowDescriptionIndex, updatedDescription.join("\n"),
-                                 ctkErrorLogModel::DescriptionTextRole);
+    if (modelThread)
+      {
+      locker.unlock();
+      this->processPendingEntries();
+      locker.relock();
+      }
+    else
+      {
+      // Do not wait forever, the model thread could be waiting for this one
+      QTime waitTime;
+      waitTime.start();
+      while (d->PendingEntries.count() >= d->MaximumPendingEntries && waitTime.elapsed() < 1000)
+        {
+        d->PendingEntriesTaken.wait(&d->PendingEntriesMutex, 100);
+        }
+      }
+    }
 
-    // Append '...' to displayText if needed
-    QString displayText = lastRowDescriptionIndex.data().toString();
-    if (!displayText.endsWith("..."))
+  if (d->PendingEntries.count() >= d->MaximumPendingEntries)
+    {
+    if (d->QueueFullPolicy == Self::CoalesceWhenFull && !d->PendingEntries.isEmpty())
       {
-      d->StandardItemModel.setData(lastRowDescriptionIndex, displayText.append("..."), Qt::DisplayRole);
+      ctkErrorLogModelPrivate::PendingEntry& lastEntry = d->PendingEntries.last();
+      if (lastEntry.ThreadId == threadId && lastEntry.LogLevel == logLevel && lastEntry.Origin == origin)
+        {
+        lastEntry.Text.append("\n").append(text);
+        lastEntry.Context.Message.append("\n").append(context.Message);
+        ++d->CoalescedEntryCount;
+        return;
+        }
       }
+    ++d->DroppedEntryCount;
+    return;
+    }
+
+  ctkErrorLogModelPrivate::PendingEntry entry;
+  entry.CurrentDateTime = currentDateTime;
+  entry.ThreadId = threadId;
+  entry.LogLevel = logLevel;
+  entry.Origin = origin;
+  entry.Context = context;
+  entry.Text = text;
+  d->PendingEntries.append(entry);
+
+  // A single event adds all the entries queued until it is processed
+  if (!d->ProcessingScheduled)
+    {
+    d->ProcessingScheduled = true;
+    QMetaObject::invokeMethod(this, "processPendingEntries", Qt::QueuedConnection);
     }
+}
 
-  d->AddingEntry = false;
+//------------------------------------------------------------------------------
+void ctkErrorLogModel::processPendingEntries()
+{
+  Q_D(ctkErrorLogModel);
 
-  QString fileLogText = d->FileLoggingPattern;
-  fileLogText.replace("%{level}", d->ErrorLogLevel(logLevel).toUpper());
-  fileLogText.replace("%{timestamp}", currentDateTime.toString(timeFormat));
-  fileLogText.replace("%{origin}", origin);
-  fileLogText.replace("%{pid}", QString("%1").arg(QCoreApplication::applicationPid()));
-  fileLogText.replace("%{threadid}", threadId);
-  fileLogText.replace("%{function}", context.Function);
-  fileLogText.replace("%{line}", QString("%1").arg(context.Line));
-  fileLogText.replace("%{file}", context.File);
-  fileLogText.replace("%{category}", context.Category);
-  fileLogText.replace("%{msg}", context.Message);
-  d->FileLogger.logMessage(fileLogText.trimmed());
+  QList<ctkErrorLogModelPrivate::PendingEntry> entries;
+  {
+    QMutexLocker locker(&d->PendingEntriesMutex);
+    entries.swap(d->PendingEntries);
+    d->ProcessingScheduled = false;
+    d->PendingEntriesTaken.wakeAll();
+  }
 
-  emit this->entryAdded(logLevel);
+  d->addEntries(entries);
 }
 
 //------------------------------------------------------------------------------
 void ctkErrorLogModel::clear()
 {
   Q_D(ctkErrorLogModel);
-  d->StandardItemModel.invisibleRootItem()->removeRows(0, d->StandardItemModel.rowCount());
+  d->EntryStorage.clearEntries();
 }
 
 //------------------------------------------------------------------------------
@@ -414,12 +901,10 @@ void ctkErrorLogModel::filterEntry(const ctkErrorLogLevel::LogLevels& logLevel,
       if (!disableFilter)
         {
         patterns << logLevelAsString;
-        d->CurrentLogLevelFilter |= static_cast<ctkErrorLogLevel::LogLevels>(aLogLevel);
         }
       else
         {
         patterns.removeAll(logLevelAsString);
-        d->CurrentLogLevelFilter ^= static_cast<ctkErrorLogLevel::LogLevels>(aLogLevel);
         }
       }
     }
@@ -442,6 +927,18 @@ void ctkErrorLogModel::filterEntry(const ctkErrorLogLevel::LogLevels& logLevel,
     filterChanged = currentPatterns.count() > 0;
     }
 
+  // The pattern is kept for logLevelFilter(), the rows are accepted by
+  // filterAcceptsRow() using the equivalent mask of levels.
+  d->LogLevelFilterEnabled = true;
+  d->LogLevelFilterMask = 0;
+  foreach(const QString& p, patterns)
+    {
+    int aLogLevel = logLevelEnum.keyToValue(p.toLatin1());
+    if (aLogLevel > 0)
+      {
+      d->LogLevelFilterMask |= aLogLevel;
+      }
+    }
   this->setFilterRegExp(patterns.join("|"));
 
   if (filterChanged)
@@ -450,6 +947,18 @@ void ctkErrorLogModel::filterEntry(const ctkErrorLogLevel::LogLevels& logLevel,
     }
 }
 
+//------------------------------------------------------------------------------
+bool ctkErrorLogModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent)const
+{
+  Q_D(const ctkErrorLogModel);
+  Q_UNUSED(sourceParent);
+  if (!d->LogLevelFilterEnabled)
+    {
+    return true;
+    }
+  return (d->EntryStorage.logLevel(sourceRow) & d->LogLevelFilterMask) != 0;
+}
+
 //------------------------------------------------------------------------------
 ctkErrorLogLevel::LogLevels ctkErrorLogModel::logLevelFilter()const
 {
@@ -502,6 +1011,91 @@ void ctkErrorLogModel::setAsynchronousLogging(bool value)
     }
 
   d->AsynchronousLogging = value;
+
+  if (!value)
+    {
+    // Keep the order of the messages queued before the change
+    this->processPendingEntries();
+    }
+}
+
+//------------------------------------------------------------------------------
+int ctkErrorLogModel::maximumEntryCount()const
+{
+  Q_D(const ctkErrorLogModel);
+  return d->EntryStorage.maximumCount();
+}
+
+//------------------------------------------------------------------------------
+void ctkErrorLogModel::setMaximumEntryCount(int value)
+{
+  Q_D(ctkErrorLogModel);
+  d->EntryStorage.setMaximumCount(value);
+}
+
+//------------------------------------------------------------------------------
+int ctkErrorLogModel::maximumPendingEntries()const
+{
+  Q_D(const ctkErrorLogModel);
+  QMutexLocker locker(&d->PendingEntriesMutex);
+  return d->MaximumPendingEntries;
+}
+
+//------------------------------------------------------------------------------
+void ctkErrorLogModel::setMaximumPendingEntries(int value)
+{
+  Q_D(ctkErrorLogModel);
+  QMutexLocker locker(&d->PendingEntriesMutex);
+  d->MaximumPendingEntries = qMax(1, value);
+}
+
+//------------------------------------------------------------------------------
+ctkErrorLogModel::QueueFullPolicy ctkErrorLogModel::queueFullPolicy()const
+{
+  Q_D(const ctkErrorLogModel);
+  QMutexLocker locker(&d->PendingEntriesMutex);
+  return d->QueueFullPolicy;
+}
+
+//------------------------------------------------------------------------------
+void ctkErrorLogModel::setQueueFullPolicy(QueueFullPolicy policy)
+{
+  Q_D(ctkErrorLogModel);
+  QMutexLocker locker(&d->PendingEntriesMutex);
+  d->QueueFullPolicy = policy;
+}
+
+//------------------------------------------------------------------------------
+int ctkErrorLogModel::pendingEntryCount()const
+{
+  Q_D(const ctkErrorLogModel);
+  QMutexLocker locker(&d->PendingEntriesMutex);
+  return d->PendingEntries.count();
+}
+
+//------------------------------------------------------------------------------
+int ctkErrorLogModel::droppedEntryCount()const
+{
+  Q_D(const ctkErrorLogModel);
+  QMutexLocker locker(&d->PendingEntriesMutex);
+  return d->DroppedEntryCount;
+}
+
+//------------------------------------------------------------------------------
+int ctkErrorLogModel::coalescedEntryCount()const
+{
+  Q_D(const ctkErrorLogModel);
+  QMutexLocker locker(&d->PendingEntriesMutex);
+  return d->CoalescedEntryCount;
+}
+
+//------------------------------------------------------------------------------
+void ctkErrorLogModel::resetQueueCounters()
+{
+  Q_D(ctkErrorLogModel);
+  QMutexLocker locker(&d->PendingEntriesMutex);
+  d->DroppedEntryCount = 0;
+  d->CoalescedEntryCount = 0;
 }
 
 // --------------------------------------------------------------------------
@@ -569,7 +1163,7 @@ QVariant ctkErrorLogModel::logEntryData(int row, int column, int role) const
     {
     return QVariant();
     }
-  QModelIndex rowDescriptionIndex = d->StandardItemModel.index(row, column);
+  QModelIndex rowDescriptionIndex = d->EntryStorage.index(row, column);
   return rowDescriptionIndex.data(role);
 }
 
@@ -583,5 +1177,5 @@ QString ctkErrorLogModel::logEntryDescription(int row) const
 int ctkErrorLogModel::logEntryCount()const
 {
   Q_D(const ctkErrorLogModel);
-  return d->StandardItemModel.rowCount();
+  return d->EntryStorage.rowCount();
 }
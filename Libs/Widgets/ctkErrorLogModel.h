@@ -39,9 +39,13 @@ struct ctkErrorLogContext;
 class CTK_WIDGETS_EXPORT ctkErrorLogModel : public QSortFilterProxyModel
 {
   Q_OBJECT
+  Q_ENUMS(QueueFullPolicy)
   Q_PROPERTY(bool logEntryGrouping READ logEntryGrouping WRITE setLogEntryGrouping)
   Q_PROPERTY(ctkErrorLogTerminalOutput::TerminalOutputs terminalOutputs READ terminalOutputs WRITE setTerminalOutputs)
   Q_PROPERTY(bool asynchronousLogging READ asynchronousLogging WRITE  setAsynchronousLogging)
+  Q_PROPERTY(int maximumEntryCount READ maximumEntryCount WRITE setMaximumEntryCount)
+  Q_PROPERTY(int maximumPendingEntries READ maximumPendingEntries WRITE setMaximumPendingEntries)
+  Q_PROPERTY(QueueFullPolicy queueFullPolicy READ queueFullPolicy WRITE setQueueFullPolicy)
   Q_PROPERTY(QString filePath READ filePath WRITE  setFilePath)
   Q_PROPERTY(int numberOfFilesToKeep READ numberOfFilesToKeep WRITE  setNumberOfFilesToKeep)
   Q_PROPERTY(bool fileLoggingEnabled READ fileLoggingEnabled WRITE  setFileLoggingEnabled)
@@ -66,6 +70,20 @@ public:
     DescriptionTextRole = Qt::UserRole + 1
     };
 
+  /// Behavior of asynchronous logging when maximumPendingEntries() entries
+  /// are waiting to be added to the model.
+  enum QueueFullPolicy
+    {
+    /// The logging thread waits up to one second for the model thread
+    /// to add the pending entries, the message is then dropped.
+    BlockWhenFull = 0,
+    /// The message is dropped.
+    DropWhenFull,
+    /// The message is appended to the last pending entry if it has the same
+    /// thread, level and origin, it is dropped otherwise.
+    CoalesceWhenFull
+    };
+
   /// Register a message handler.
   bool registerMsgHandler(ctkErrorLogAbstractMessageHandler * msgHandler);
 
@@ -103,9 +121,39 @@ public:
   bool logEntryGrouping()const;
   void setLogEntryGrouping(bool value);
 
+  /// If enabled, the messages are queued and added by batches in the thread of
+  /// the model. Otherwise the logging thread waits until its message is added.
+  /// Enabled by default.
   bool asynchronousLogging()const;
   void setAsynchronousLogging(bool value);
 
+  /// Maximum number of entries kept by the model, the oldest ones are removed
+  /// first. 0, the default, for no limit.
+  int maximumEntryCount()const;
+  void setMaximumEntryCount(int value);
+
+  /// Maximum number of queued messages in asynchronous mode, 10000 by default.
+  /// \sa queueFullPolicy(), asynchronousLogging()
+  int maximumPendingEntries()const;
+  void setMaximumPendingEntries(int value);
+
+  /// CoalesceWhenFull by default.
+  /// \sa droppedEntryCount(), coalescedEntryCount()
+  QueueFullPolicy queueFullPolicy()const;
+  void setQueueFullPolicy(QueueFullPolicy policy);
+
+  /// Return the number of messages waiting to be added to the model.
+  int pendingEntryCount()const;
+
+  /// Return the number of messages dropped because the queue was full.
+  int droppedEntryCount()const;
+
+  /// Return the number of messages appended to a pending entry because the queue was full.
+  int coalescedEntryCount()const;
+
+  /// Reset droppedEntryCount() and coalescedEntryCount().
+  void resetQueueCounters();
+
   QString filePath()const;
   void setFilePath(const QString& filePath);
 
@@ -142,12 +190,35 @@ public Q_SLOTS:
                 ctkErrorLogLevel::LogLevel logLevel, const QString& origin,
                 const ctkErrorLogContext &context, const QString& text);
 
+  /// Add the queued messages to the model.
+  /// \sa asynchronousLogging()
+  void processPendingEntries();
+
 Q_SIGNALS:
   void logLevelFilterChanged();
 
   /// \sa addEntry()
   void entryAdded(ctkErrorLogLevel::LogLevel logLevel);
 
+protected:
+  /// Accept the rows whose level is selected with filterEntry().
+  virtual bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent)const;
+
+protected Q_SLOTS:
+  /// Queue a message, called in the thread of the message handler.
+  void queueEntry(const QDateTime& currentDateTime, const QString& threadId,
+                  ctkErrorLogLevel::LogLevel logLevel, const QString& origin,
+                  const ctkErrorLogContext &context, const QString& text);
+
+  /// Add a message synchronously, called in the thread of the message
+  /// handler. Unlike a blocking queued connection, it doesn't deadlock when
+  /// the handler is in the thread of the model (e.g. a buffering handler
+  /// flushing its messages).
+  /// \sa asynchronousLogging(), ctkErrorLogAbstractMessageHandler::bufferMessage()
+  void addEntryFromHandlerThread(const QDateTime& currentDateTime, const QString& threadId,
+                                 ctkErrorLogLevel::LogLevel logLevel, const QString& origin,
+                                 const ctkErrorLogContext &context, const QString& text);
+
 protected:
   QScopedPointer<ctkErrorLogModelPrivate> d_ptr;
 
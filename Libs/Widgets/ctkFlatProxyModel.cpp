@@ -19,6 +19,12 @@
 =========================================================================*/
 // QT includes
 #include <QDebug>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+// STD includes
+#include <algorithm>
 
 // CTK includes
 #include "ctkFlatProxyModel.h"
@@ -38,10 +44,22 @@ public:
   int rowCount(const QModelIndex& sourceIndex, int depth = 0)const;
   QModelIndex sourceParent(const QModelIndex& index)const;
   QModelIndex grandChild(const QModelIndex& parent, int& row, int depth)const;
+  /// Cumulative row counts at \a depth of the children of \a parent:
+  /// offsets[i] is the number of rows of the children before the ith one and
+  /// the last element is rowCount(parent, depth). \a depth must be > 0.
+  const QVector<int>& childRowOffsets(const QModelIndex& parent, int depth)const;
+  void clearMappings();
 
   int StartFlattenLevel;
   int EndFlattenLevel;
   int HideLevel;
+
+  /// Mapping tables, built lazily and cleared by any structural change of the
+  /// source model.
+  typedef QPair<QModelIndex, int> OffsetsKey;
+  mutable QHash<OffsetsKey, QVector<int> > ChildRowOffsets;
+  mutable QHash<void*, QModelIndex> SourceParents;
+  mutable bool SourceParentsBuilt;
 };
 
 // ----------------------------------------------------------------------------
@@ -54,6 +72,7 @@ ctkFlatProxyModelPrivate::ctkFlatProxyModelPrivate(ctkFlatProxyModel &object)
   this->StartFlattenLevel = -1;
   this->EndFlattenLevel = -1;
   this->HideLevel = -1;
+  this->SourceParentsBuilt = false;
 }
 
 // ----------------------------------------------------------------------------
@@ -77,18 +96,14 @@ int ctkFlatProxyModelPrivate::indexLevel(const QModelIndex& index)const
 // ----------------------------------------------------------------------------
 int ctkFlatProxyModelPrivate::levelRowCount(const QModelIndex& sourceIndex)const
 {
-  Q_Q(const ctkFlatProxyModel);
   if (!sourceIndex.isValid()
       || this->StartFlattenLevel > this->indexLevel(sourceIndex)
       || this->EndFlattenLevel < this->indexLevel(sourceIndex))
     {
     return 0;
     }
-  int previousRows = 0;
-  for (int row = 0; row != sourceIndex.row() ; ++row)
-    {
-    previousRows += q->sourceModel()->rowCount(sourceIndex.sibling(row, sourceIndex.column()));
-    }
+  const int previousRows =
+    this->childRowOffsets(sourceIndex.parent(), 1).at(sourceIndex.row());
   return previousRows + this->levelRowCount(sourceIndex.parent());
 }
 
@@ -116,21 +131,47 @@ int ctkFlatProxyModelPrivate::nextLevelRowCount(const QModelIndex& sourceIndex)c
 int ctkFlatProxyModelPrivate::rowCount(const QModelIndex& sourceIndex, int depth)const
 {
   Q_Q(const ctkFlatProxyModel);
-  int rows = 0;
   if (depth < 0)
     {
-    rows = 1;
+    return 1;
     }
-  else
+  if (depth == 0)
     {
-    --depth;
-    for (int row = 0; row < q->sourceModel()->rowCount(sourceIndex); ++row)
-      {
-      QModelIndex child = q->sourceModel()->index(row, 0, sourceIndex);
-      rows += this->rowCount(child, depth);
-      }
+    return q->sourceModel()->rowCount(sourceIndex);
+    }
+  return this->childRowOffsets(sourceIndex, depth).last();
+}
+
+// ----------------------------------------------------------------------------
+const QVector<int>& ctkFlatProxyModelPrivate
+::childRowOffsets(const QModelIndex& parent, int depth)const
+{
+  Q_Q(const ctkFlatProxyModel);
+  Q_ASSERT(depth > 0);
+  const OffsetsKey key(parent, depth);
+  QHash<OffsetsKey, QVector<int> >::const_iterator it =
+    this->ChildRowOffsets.constFind(key);
+  if (it != this->ChildRowOffsets.constEnd())
+    {
+    return it.value();
+    }
+  const int childCount = q->sourceModel()->rowCount(parent);
+  QVector<int> offsets(childCount + 1);
+  offsets[0] = 0;
+  for (int row = 0; row < childCount; ++row)
+    {
+    QModelIndex child = q->sourceModel()->index(row, 0, parent);
+    offsets[row + 1] = offsets[row] + this->rowCount(child, depth - 1);
     }
-  return rows;
+  return this->ChildRowOffsets.insert(key, offsets).value();
+}
+
+// ----------------------------------------------------------------------------
+void ctkFlatProxyModelPrivate::clearMappings()
+{
+  this->ChildRowOffsets.clear();
+  this->SourceParents.clear();
+  this->SourceParentsBuilt = false;
 }
 
 // ----------------------------------------------------------------------------
@@ -138,28 +179,35 @@ QModelIndex ctkFlatProxyModelPrivate
 ::sourceParent(const QModelIndex& index)const
 {
   Q_Q(const ctkFlatProxyModel);
-  QModelIndexList sourceIndexes;
-  sourceIndexes << QModelIndex();
-  QMap<int, int> rowCountsPerLevel;
-  while (!sourceIndexes.isEmpty())
+  if (!this->SourceParentsBuilt)
     {
-    QModelIndex sourceIndex = sourceIndexes.takeFirst();
-    const int rowCount = q->sourceModel()->rowCount(sourceIndex);
-    for (int row = 0; row < rowCount; ++row)
+    // Breadth first, the first parent found for an internal pointer wins.
+    QModelIndexList sourceIndexes;
+    sourceIndexes << QModelIndex();
+    while (!sourceIndexes.isEmpty())
       {
-      QModelIndex child = q->sourceModel()->index(row, 0, sourceIndex);
-      if (child.internalPointer() == index.internalPointer())
-        {
-        return sourceIndex;
-        }
-      else
+      QModelIndex sourceIndex = sourceIndexes.takeFirst();
+      const int rowCount = q->sourceModel()->rowCount(sourceIndex);
+      for (int row = 0; row < rowCount; ++row)
         {
+        QModelIndex child = q->sourceModel()->index(row, 0, sourceIndex);
+        if (!this->SourceParents.contains(child.internalPointer()))
+          {
+          this->SourceParents.insert(child.internalPointer(), sourceIndex);
+          }
         sourceIndexes << child;
         }
       }
+    this->SourceParentsBuilt = true;
     }
-  Q_ASSERT(false);
-  return QModelIndex();
+  QHash<void*, QModelIndex>::const_iterator it =
+    this->SourceParents.constFind(index.internalPointer());
+  if (it == this->SourceParents.constEnd())
+    {
+    Q_ASSERT(false);
+    return QModelIndex();
+    }
+  return it.value();
 }
 
 // ----------------------------------------------------------------------------
@@ -167,33 +215,29 @@ QModelIndex ctkFlatProxyModelPrivate
 ::grandChild(const QModelIndex& parent, int& row, int depth)const
 {
   Q_Q(const ctkFlatProxyModel);
-  const int rowCount = q->sourceModel()->rowCount(parent);
-
   if (depth > 0)
     {
-    for (int i = 0; i < rowCount; ++i)
+    const QVector<int>& offsets = this->childRowOffsets(parent, depth);
+    if (row >= offsets.last())
       {
-      QModelIndex child = q->sourceModel()->index(i, 0, parent);
-      QModelIndex found = this->grandChild(child, row, depth - 1);
-      if (found.isValid())
-        {
-        return found;
-        }
+      row -= offsets.last();
+      return QModelIndex();
       }
+    // Last child whose first row is before or at row.
+    const int i = static_cast<int>(
+      std::upper_bound(offsets.begin(), offsets.end(), row) - offsets.begin()) - 1;
+    row -= offsets[i];
+    QModelIndex child = q->sourceModel()->index(i, 0, parent);
+    return this->grandChild(child, row, depth - 1);
     }
-  else
+  const int rowCount = q->sourceModel()->rowCount(parent);
+  if (row < rowCount)
     {
-    if (row < rowCount)
-      {
-      QModelIndex sourceIndex = q->sourceModel()->index(
-        row, 0, parent);
-      return sourceIndex;
-      }
-    else
-      {
-      row -= rowCount;
-      }
+    QModelIndex sourceIndex = q->sourceModel()->index(
+      row, 0, parent);
+    return sourceIndex;
     }
+  row -= rowCount;
   return QModelIndex();
 }
 
@@ -214,6 +258,43 @@ ctkFlatProxyModel::~ctkFlatProxyModel()
 {
 }
 
+// ----------------------------------------------------------------------------
+void ctkFlatProxyModel::setSourceModel(QAbstractItemModel* newSourceModel)
+{
+  Q_D(ctkFlatProxyModel);
+  QAbstractItemModel* oldSourceModel = this->sourceModel();
+  if (oldSourceModel)
+    {
+    disconnect(oldSourceModel, 0, this, SLOT(onSourceModelChanged()));
+    }
+  d->clearMappings();
+  this->Superclass::setSourceModel(newSourceModel);
+  if (newSourceModel)
+    {
+    const char* signalNames[] = {
+      SIGNAL(rowsInserted(QModelIndex,int,int)),
+      SIGNAL(rowsRemoved(QModelIndex,int,int)),
+      SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
+      SIGNAL(columnsInserted(QModelIndex,int,int)),
+      SIGNAL(columnsRemoved(QModelIndex,int,int)),
+      SIGNAL(columnsMoved(QModelIndex,int,int,QModelIndex,int)),
+      SIGNAL(layoutChanged()),
+      SIGNAL(modelReset())};
+    for (size_t i = 0; i < sizeof(signalNames) / sizeof(signalNames[0]); ++i)
+      {
+      connect(newSourceModel, signalNames[i],
+              this, SLOT(onSourceModelChanged()));
+      }
+    }
+}
+
+// ----------------------------------------------------------------------------
+void ctkFlatProxyModel::onSourceModelChanged()
+{
+  Q_D(ctkFlatProxyModel);
+  d->clearMappings();
+}
+
 // ----------------------------------------------------------------------------
 int ctkFlatProxyModel::startFlattenLevel() const
 {
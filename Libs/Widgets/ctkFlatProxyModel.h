@@ -63,6 +63,10 @@ public:
   void setHideLevel(int level);
   int hideLevel() const;
 
+  /// Reimplemented to keep the row mapping tables in sync with the structure
+  /// of the source model.
+  virtual void setSourceModel(QAbstractItemModel* sourceModel);
+
   virtual QModelIndex mapFromSource( const QModelIndex& sourceIndex ) const;
   virtual QModelIndex mapToSource( const QModelIndex& sourceIndex ) const;
 
@@ -71,6 +75,9 @@ public:
   virtual int rowCount(const QModelIndex &parent) const;
   virtual int columnCount(const QModelIndex &parent) const;
 
+protected Q_SLOTS:
+  void onSourceModelChanged();
+
 protected:
   QScopedPointer<ctkFlatProxyModelPrivate> d_ptr;
 
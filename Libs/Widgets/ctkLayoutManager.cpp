@@ -39,6 +39,7 @@ ctkLayoutManagerPrivate::ctkLayoutManagerPrivate(ctkLayoutManager& object)
 {
   this->Viewport = 0;
   this->Spacing = 0;
+  this->LazyTabs = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -95,6 +96,7 @@ void ctkLayoutManagerPrivate::clearWidget(QWidget* widget, QLayout* parentLayout
         }
       }
     this->LayoutWidgets.remove(widget);
+    this->PendingTabPages.remove(widget);
     if (parentLayout)
       {
       parentLayout->removeWidget(widget);
@@ -186,6 +188,25 @@ void ctkLayoutManager::setSpacing(int spacing)
   this->refresh();
 }
 
+//-----------------------------------------------------------------------------
+bool ctkLayoutManager::lazyTabs()const
+{
+  Q_D(const ctkLayoutManager);
+  return d->LazyTabs;
+}
+
+//-----------------------------------------------------------------------------
+void ctkLayoutManager::setLazyTabs(bool lazy)
+{
+  Q_D(ctkLayoutManager);
+  if (lazy == d->LazyTabs)
+    {
+    return;
+    }
+  d->LazyTabs = lazy;
+  this->refresh();
+}
+
 //-----------------------------------------------------------------------------
 void ctkLayoutManager::refresh()
 {
@@ -211,6 +232,8 @@ void ctkLayoutManager::clearLayout()
     return;
     }
   // TODO: post an event on the event queue
+  // Removing the tabs must not create the content of the next ones.
+  d->PendingTabPages.clear();
   d->clearLayout(d->Viewport->layout());
   Q_ASSERT(d->LayoutWidgets.size() == 0);
 }
@@ -382,9 +405,23 @@ QLayoutItem* ctkLayoutManager::layoutFromXML(QDomElement layoutElement)
 //-----------------------------------------------------------------------------
 void ctkLayoutManager::processItemElement(QDomElement itemElement, QLayoutItem* layoutItem)
 {
+  Q_D(ctkLayoutManager);
   Q_ASSERT(itemElement.tagName() == "item");
   Q_ASSERT(itemElement.childNodes().count() == 1);
   bool multiple = itemElement.attribute("multiple", "false") == "true";
+  QTabWidget* tabWidget = qobject_cast<QTabWidget*>(layoutItem->widget());
+  if (d->LazyTabs && tabWidget && tabWidget->count() > 0 && !multiple)
+    {
+    // The first tab is the current one, the others are filled when shown.
+    QWidget* page = new QWidget();
+    d->LayoutWidgets << page;
+    d->PendingTabPages[page] = itemElement;
+    tabWidget->addTab(page, itemElement.attribute("name"));
+    QObject::connect(tabWidget, SIGNAL(currentChanged(int)),
+                     this, SLOT(onCurrentTabChanged(int)),
+                     Qt::UniqueConnection);
+    return;
+    }
   QList<QLayoutItem*> childrenItem;
   if (multiple)
     {
@@ -447,6 +484,35 @@ void ctkLayoutManager::addChildItemToLayout(QDomElement itemElement, QLayoutItem
     }
 }
 
+//-----------------------------------------------------------------------------
+void ctkLayoutManager::onCurrentTabChanged(int index)
+{
+  Q_D(ctkLayoutManager);
+  QTabWidget* tabWidget = qobject_cast<QTabWidget*>(this->sender());
+  QWidget* page = tabWidget ? tabWidget->widget(index) : 0;
+  if (!page || !d->PendingTabPages.contains(page))
+    {
+    return;
+    }
+  QDomElement itemElement = d->PendingTabPages.take(page);
+  QLayoutItem* childItem =
+    this->processElement(itemElement.firstChild().toElement());
+  QLayout* pageLayout = childItem->layout();
+  if (!pageLayout)
+    {
+    QHBoxLayout* hboxLayout = new QHBoxLayout(0);
+    hboxLayout->setContentsMargins(0, 0, 0, 0);
+    hboxLayout->addItem(childItem);
+    pageLayout = hboxLayout;
+    }
+  // setLayout() reparents the views into the page
+  page->setLayout(pageLayout);
+  if (tabWidget->tabText(index).isEmpty() && childItem->widget())
+    {
+    tabWidget->setTabText(index, childItem->widget()->windowTitle());
+    }
+}
+
 //-----------------------------------------------------------------------------
 QWidgetItem* ctkLayoutManager::widgetItemFromXML(QDomElement viewElement)
 {
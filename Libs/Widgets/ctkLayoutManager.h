@@ -77,6 +77,11 @@ class CTK_WIDGETS_EXPORT ctkLayoutManager: public QObject
   /// Spacing between the widgets in all the layouts.
   /// \sa spacing(), setSpacing()
   Q_PROPERTY(int spacing READ spacing WRITE setSpacing)
+  /// Create the views of a "tab" layout only when their tab is shown for
+  /// the first time. The views of the first tab are created with the layout.
+  /// False by default.
+  /// \sa lazyTabs(), setLazyTabs()
+  Q_PROPERTY(bool lazyTabs READ lazyTabs WRITE setLazyTabs)
 public:
   /// Constructor
   ctkLayoutManager(QObject* parent = 0);
@@ -95,6 +100,13 @@ public:
   /// \sa spacing
   void setSpacing(int spacing);
 
+  /// Return the lazyTabs property value.
+  /// \sa lazyTabs
+  bool lazyTabs()const;
+  /// Set the lazyTabs property value.
+  /// \sa lazyTabs
+  void setLazyTabs(bool lazy);
+
   void refresh();
 
 public Q_SLOTS:
@@ -158,6 +170,11 @@ protected:
   /// \sa viewFromXML(), 
   virtual QList<QWidget*> viewsFromXML(QDomElement layoutElement);
 
+protected Q_SLOTS:
+  /// Create the content of a tab page not shown yet.
+  /// \sa lazyTabs
+  void onCurrentTabChanged(int index);
+
 private:
   Q_DECLARE_PRIVATE(ctkLayoutManager);
   Q_DISABLE_COPY(ctkLayoutManager);
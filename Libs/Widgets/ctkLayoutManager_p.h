@@ -23,6 +23,7 @@
 
 // Qt includes
 #include <QDomDocument>
+#include <QHash>
 #include <QObject>
 #include <QSet>
 
@@ -62,6 +63,10 @@ public:
   QSet<QWidget*> LayoutWidgets;
   /// Unique spacing used by all the inner layouts.
   int            Spacing;
+  /// Create the content of the tab pages when they are first shown.
+  bool           LazyTabs;
+  /// Empty tab pages by the "item" XML element of their content.
+  QHash<QWidget*, QDomElement> PendingTabPages;
 };
 
 #endif
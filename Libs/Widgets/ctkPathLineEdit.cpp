@@ -24,8 +24,8 @@
 #include <QComboBox>
 #include <QCompleter>
 #include <QDebug>
-#include <QDirModel>
 #include <QFileDialog>
+#include <QFileSystemModel>
 #include <QHBoxLayout>
 #include <QLineEdit>
 #include <QRegExp>
@@ -58,10 +58,13 @@ public:
 
   void createPathLineEditWidget(bool useComboBox);
   QString settingKey()const;
+  /// Directory of sCurrentDirectory, or sCurrentDirectory if it is a directory
+  static QString currentDirectory();
 
   QLineEdit*            LineEdit;
   QComboBox*            ComboBox;
   QToolButton*          BrowseButton;       //!< "..." button
+  QFileSystemModel*     CompleterModel;     //!< lists the directories in a separate thread
 
   int                   MinimumContentsLength;
   ctkPathLineEdit::SizeAdjustPolicy SizeAdjustPolicy;
@@ -78,7 +81,7 @@ public:
   bool                  HasValidInput;      //!< boolean that stores the old state of valid input
   QString               SettingKey;
 
-  static QString        sCurrentDirectory;   //!< Content the last value of the current directory
+  static QString        sCurrentDirectory;   //!< Content the last valid path, see currentDirectory()
   static int            sMaxHistory;     //!< Size of the history, if the history is full and a new value is added, the oldest value is dropped
 
   mutable QSize SizeHint;
@@ -94,6 +97,7 @@ ctkPathLineEditPrivate::ctkPathLineEditPrivate(ctkPathLineEdit& object)
   , LineEdit(0)
   , ComboBox(0)
   , BrowseButton(0)
+  , CompleterModel(0)
   , MinimumContentsLength(0)
   , SizeAdjustPolicy(ctkPathLineEdit::AdjustToContentsOnFirstShow)
   , Filters(QDir::AllEntries|QDir::NoDotAndDotDot|QDir::Readable)
@@ -245,15 +249,28 @@ void ctkPathLineEditPrivate::updateFilter()
 {
   Q_Q(ctkPathLineEdit);
   // help completion for the QComboBox::QLineEdit
-  QCompleter *newCompleter = new QCompleter(q);
-  newCompleter->setModel(new QDirModel(
-                           ctk::nameFiltersToExtensions(this->NameFilters),
-                           this->Filters | QDir::NoDotAndDotDot | QDir::AllDirs,
-                           QDir::Name|QDir::DirsLast, newCompleter));
-  this->LineEdit->setCompleter(newCompleter);
+  // QFileSystemModel lists the directories in a separate thread and keeps
+  // them, unlike QDirModel that blocks the GUI thread.
+  if (!this->CompleterModel)
+    {
+    this->CompleterModel = new QFileSystemModel(q);
+    this->CompleterModel->setNameFilterDisables(false);
+    this->CompleterModel->setRootPath(QString());
+    }
+  this->CompleterModel->setNameFilters(
+    ctk::nameFiltersToExtensions(this->NameFilters));
+  this->CompleterModel->setFilter(
+    this->Filters | QDir::NoDotAndDotDot | QDir::AllDirs);
+  if (!this->LineEdit->completer() ||
+      this->LineEdit->completer()->model() != this->CompleterModel)
+    {
+    QCompleter *newCompleter = new QCompleter(q);
+    newCompleter->setModel(this->CompleterModel);
+    this->LineEdit->setCompleter(newCompleter);
 
-  QObject::connect(this->LineEdit->completer()->completionModel(), SIGNAL(layoutChanged()),
-                   q, SLOT(_q_recomputeCompleterPopupSize()));
+    QObject::connect(this->LineEdit->completer()->completionModel(), SIGNAL(layoutChanged()),
+                     q, SLOT(_q_recomputeCompleterPopupSize()));
+    }
 
   // don't accept invalid path
   QRegExpValidator* validator = new QRegExpValidator(
@@ -312,6 +329,17 @@ QString ctkPathLineEditPrivate::settingKey()const
     (this->SettingKey.isEmpty() ? q->objectName() : this->SettingKey);
 }
 
+//-----------------------------------------------------------------------------
+QString ctkPathLineEditPrivate::currentDirectory()
+{
+  if (sCurrentDirectory.isEmpty())
+    {
+    return sCurrentDirectory;
+    }
+  QFileInfo fileInfo(sCurrentDirectory);
+  return fileInfo.isFile() ? fileInfo.absolutePath() : fileInfo.absoluteFilePath();
+}
+
 //-----------------------------------------------------------------------------
 ctkPathLineEdit::ctkPathLineEdit(QWidget *parentWidget)
   : QWidget(parentWidget)
@@ -423,7 +451,7 @@ void ctkPathLineEdit::browse()
       path = QFileDialog::getSaveFileName(
 	this,
         tr("Select a file to save "),
-        this->currentPath().isEmpty() ? ctkPathLineEditPrivate::sCurrentDirectory :
+        this->currentPath().isEmpty() ? ctkPathLineEditPrivate::currentDirectory() :
 	                                this->currentPath(),
 	d->NameFilters.join(";;"),
 	0,
@@ -438,7 +466,7 @@ void ctkPathLineEdit::browse()
       path = QFileDialog::getOpenFileName(
         this,
         QString("Open a file"),
-        this->currentPath().isEmpty()? ctkPathLineEditPrivate::sCurrentDirectory :
+        this->currentPath().isEmpty()? ctkPathLineEditPrivate::currentDirectory() :
 	                               this->currentPath(),
         d->NameFilters.join(";;"),
 	0,
@@ -454,7 +482,7 @@ void ctkPathLineEdit::browse()
     path = QFileDialog::getExistingDirectory(
       this,
       QString("Select a directory..."),
-      this->currentPath().isEmpty() ? ctkPathLineEditPrivate::sCurrentDirectory :
+      this->currentPath().isEmpty() ? ctkPathLineEditPrivate::currentDirectory() :
                                       this->currentPath(),
 #ifdef USE_QFILEDIALOG_OPTIONS
       d->DialogOptions);
@@ -595,9 +623,9 @@ void ctkPathLineEdit::updateHasValidInput()
   d->HasValidInput = d->LineEdit->hasAcceptableInput();
   if (d->HasValidInput)
     {
-    QFileInfo fileInfo(this->currentPath());
-    ctkPathLineEditPrivate::sCurrentDirectory =
-      fileInfo.isFile() ? fileInfo.absolutePath() : fileInfo.absoluteFilePath();
+    // Don't access the file system while typing, the path is resolved when
+    // browsing.
+    ctkPathLineEditPrivate::sCurrentDirectory = this->currentPath();
     emit currentPathChanged(this->currentPath());
     }
   if (d->HasValidInput != oldHasValidInput)
@@ -35,6 +35,13 @@
 #include <QColor>
 #include <QTextEdit>
 #include <QDialog>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
 
 #include <cmath>
 
@@ -91,18 +98,73 @@ public:
   bool   MouseMiddleDragging;
   bool   MouseRightDragging;
 
+  typedef QPair< int, int > LevelKey;
+
+  /// Level n of a frame is the image of the frame 2^n times smaller, by
+  /// LevelKey( frame, n ). Level 0, the image itself, is not cached.
+  /// The cost is the size of the level in kilobytes.
+  QCache< LevelKey, QImage > LevelCache;
+  QSet< LevelKey > PendingLevels;
+  /// Incremented when the computed levels are not wanted anymore
+  int LevelGeneration;
+  QMutex CacheMutex;
+  QThreadPool LevelPool;
+
   double clamp( double x, double xMin, double xMax );
 
   void fitImageRectangle( double x0, double y0, double x1, double y1 );
+
+  /// The coarsest level of image with at least one pixel of the level per
+  /// pixel drawn, when scale pixels of image are drawn per pixel.
+  int levelForScale( const QImage& image, double scale ) const;
+  /// Return the coarsest available level of frame down to level, and
+  /// compute the missing ones in the background.
+  QImage levelImage( int frame, int level, int& availableLevel );
+  /// Called from the level thread
+  void computeLevels( int frame, int generation, QImage image,
+    int fromLevel, int toLevel );
   
 };
 
+//--------------------------------------------------------------------------
+class ctkQImageViewLevelTask : public QRunnable
+{
+public:
+  ctkQImageViewLevelTask( ctkQImageViewPrivate* view, int frame,
+    int generation, const QImage& image, int fromLevel, int toLevel )
+    : View( view )
+    , Frame( frame )
+    , Generation( generation )
+    , Image( image )
+    , FromLevel( fromLevel )
+    , ToLevel( toLevel )
+  {
+  }
+
+  virtual void run()
+  {
+    this->View->computeLevels( this->Frame, this->Generation, this->Image,
+      this->FromLevel, this->ToLevel );
+  }
+
+private:
+  ctkQImageViewPrivate* View;
+  int Frame;
+  int Generation;
+  QImage Image;
+  int FromLevel;
+  int ToLevel;
+};
+
 //--------------------------------------------------------------------------
 ctkQImageViewPrivate::ctkQImageViewPrivate(
   ctkQImageView& object )
   : q_ptr( &object )
 {
   this->Window = new QLabel();
+  this->LevelCache.setMaxCost( 64 * 1024 );
+  this->LevelGeneration = 0;
+  this->LevelPool.setMaxThreadCount( 1 );
 }
 
 //--------------------------------------------------------------------------
@@ -187,6 +249,94 @@ void ctkQImageViewPrivate::fitImageRectangle( double x0,
     }
 }
 
+//--------------------------------------------------------------------------
+int ctkQImageViewPrivate::levelForScale( const QImage& image,
+  double scale ) const
+{
+  int level = 0;
+  while( scale >= 2
+    && ( image.width() >> ( level + 1 ) ) > 0
+    && ( image.height() >> ( level + 1 ) ) > 0 )
+    {
+    scale /= 2;
+    ++level;
+    }
+  return level;
+}
+
+//--------------------------------------------------------------------------
+QImage ctkQImageViewPrivate::levelImage( int frame, int level,
+  int& availableLevel )
+{
+  const QImage& image = this->ImageList[ frame ];
+  QMutexLocker locker( &this->CacheMutex );
+  QImage source = image;
+  availableLevel = 0;
+  for( int l = level; l > 0; --l )
+    {
+    QImage* cached = this->LevelCache.object( LevelKey( frame, l ) );
+    if( cached )
+      {
+      source = *cached;
+      availableLevel = l;
+      break;
+      }
+    }
+  if( availableLevel == level )
+    {
+    return source;
+    }
+  // Don't compute a level the cache can't keep
+  const int levelCost = static_cast<int>( ( qint64( image.width() >> level )
+    * ( image.height() >> level ) * 4 ) / 1024 );
+  LevelKey key( frame, level );
+  if( levelCost < this->LevelCache.maxCost()
+    && !this->PendingLevels.contains( key ) )
+    {
+    this->PendingLevels.insert( key );
+    this->LevelPool.start( new ctkQImageViewLevelTask( this, frame,
+      this->LevelGeneration, source, availableLevel, level ) );
+    }
+  return source;
+}
+
+//--------------------------------------------------------------------------
+void ctkQImageViewPrivate::computeLevels( int frame, int generation,
+  QImage image, int fromLevel, int toLevel )
+{
+  Q_Q( ctkQImageView );
+  for( int level = fromLevel + 1; level <= toLevel; ++level )
+    {
+    {
+    QMutexLocker locker( &this->CacheMutex );
+    if( generation != this->LevelGeneration )
+      {
+      return;
+      }
+    }
+    image = image.scaled( qMax( 1, image.width() / 2 ),
+      qMax( 1, image.height() / 2 ), Qt::IgnoreAspectRatio,
+      Qt::SmoothTransformation );
+    QMutexLocker locker( &this->CacheMutex );
+    if( generation != this->LevelGeneration )
+      {
+      return;
+      }
+    this->LevelCache.insert( LevelKey( frame, level ), new QImage( image ),
+      qMax( 1, image.byteCount() / 1024 ) );
+    }
+  {
+  QMutexLocker locker( &this->CacheMutex );
+  if( generation != this->LevelGeneration )
+    {
+    return;
+    }
+  this->PendingLevels.remove( LevelKey( frame, toLevel ) );
+  }
+  QMetaObject::invokeMethod( q, "onLevelComputed", Qt::QueuedConnection,
+    Q_ARG( int, frame ), Q_ARG( int, generation ) );
+}
+
 
 // -------------------------------------------------------------------------
 ctkQImageView::ctkQImageView( QWidget* _parent )
@@ -212,6 +362,12 @@ ctkQImageView::ctkQImageView(
 // -------------------------------------------------------------------------
 ctkQImageView::~ctkQImageView()
 {
+  Q_D( ctkQImageView );
+  {
+  QMutexLocker locker( &d->CacheMutex );
+  ++d->LevelGeneration;
+  }
+  d->LevelPool.waitForDone();
 }
 
 // -------------------------------------------------------------------------
@@ -238,10 +394,64 @@ void ctkQImageView::addImage( const QImage & image )
 void ctkQImageView::clearImages( void )
 {
   Q_D( ctkQImageView );
+  {
+  QMutexLocker locker( &d->CacheMutex );
+  ++d->LevelGeneration;
+  d->LevelCache.clear();
+  d->PendingLevels.clear();
+  }
   d->ImageList.clear();
   this->update( true, true );
 }
 
+// -------------------------------------------------------------------------
+void ctkQImageView::setLevelCacheSize( int kilobytes )
+{
+  Q_D( ctkQImageView );
+  QMutexLocker locker( &d->CacheMutex );
+  d->LevelCache.setMaxCost( qMax( 0, kilobytes ) );
+}
+
+// -------------------------------------------------------------------------
+int ctkQImageView::levelCacheSize( void ) const
+{
+  Q_D( const ctkQImageView );
+  QMutexLocker locker( const_cast< QMutex* >( &d->CacheMutex ) );
+  return d->LevelCache.maxCost();
+}
+
+// -------------------------------------------------------------------------
+int ctkQImageView::levelCacheUsage( void ) const
+{
+  Q_D( const ctkQImageView );
+  QMutexLocker locker( const_cast< QMutex* >( &d->CacheMutex ) );
+  return d->LevelCache.totalCost();
+}
+
+// -------------------------------------------------------------------------
+void ctkQImageView::waitForLevels( void )
+{
+  Q_D( ctkQImageView );
+  d->LevelPool.waitForDone();
+}
+
+// -------------------------------------------------------------------------
+void ctkQImageView::onLevelComputed( int frame, int generation )
+{
+  Q_D( ctkQImageView );
+  {
+  QMutexLocker locker( &d->CacheMutex );
+  if( generation != d->LevelGeneration )
+    {
+    return;
+    }
+  }
+  if( frame == d->SliceNumber )
+    {
+    this->update( false, false );
+    }
+}
+
 // -------------------------------------------------------------------------
 double ctkQImageView::xSpacing( void )
 {
@@ -998,12 +1208,24 @@ void ctkQImageView::update( bool zoomChanged,
     if( d->TmpImage.width() > 0 &&  d->TmpImage.height() > 0)
       {
       QRectF target( 0, 0, d->TmpImage.width(), d->TmpImage.height() );
-      double sourceX = d->TmpXMin;
-      double sourceY = d->TmpYMin;
       double sourceW = d->TmpXMax - d->TmpXMin;
       double sourceH = d->TmpYMax - d->TmpYMin;
+      // Draw the visible part of the level closest to the screen resolution
+      int level = d->levelForScale( *img, qMin( sourceW / target.width(),
+        sourceH / target.height() ) );
+      int availableLevel = 0;
+      QImage levelImg = d->levelImage( d->SliceNumber, level,
+        availableLevel );
+      double levelScaleX = static_cast<double>( levelImg.width() )
+        / img->width();
+      double levelScaleY = static_cast<double>( levelImg.height() )
+        / img->height();
+      QRectF levelSource( d->TmpXMin * levelScaleX, d->TmpYMin * levelScaleY,
+        sourceW * levelScaleX, sourceH * levelScaleY );
+      QRect visibleRect = levelSource.toAlignedRect() & levelImg.rect();
+      QImage tmpI = levelImg.copy( visibleRect );
+      QRectF source = levelSource.translated( -visibleRect.topLeft() );
       QPainter painter( &(d->TmpImage) );
-      QImage tmpI = *img;
       if( d->InvertImage )
         {
         tmpI.invertPixels();
@@ -1013,15 +1235,14 @@ void ctkQImageView::update( bool zoomChanged,
         tmpI = tmpI.mirrored( d->FlipXAxis, d->FlipYAxis );
         if( d->FlipXAxis )
           {
-          sourceX = tmpI.width() - (d->TmpXMax - d->TmpXMin) - d->TmpXMin;
+          source.moveLeft( tmpI.width() - source.right() );
           }
         if( d->FlipYAxis )
           {
-          sourceY = tmpI.height() - (d->TmpYMax - d->TmpYMin) - d->TmpYMin;
+          source.moveTop( tmpI.height() - source.bottom() );
           }
         }
-      QRectF source( sourceX, sourceY, sourceW, sourceH );
-      painter.drawPixmap( target, QPixmap::fromImage( tmpI ), source );
+      painter.drawImage( target, tmpI, source );
 
       //if( ! sizeChanged )
         {
@@ -34,10 +34,18 @@ class ctkQImageViewPrivate;
 /// \ingroup Widgets
 ///
 /// ctkQImageView is the base class of image viewer widgets.
+///
+/// The images are drawn from scaled down copies, halved in size level after
+/// level, that are computed in a background thread when a zoom needs them.
+/// Only the visible part of the chosen level is drawn. The levels are kept in
+/// a cache of levelCacheSize kilobytes, the least recently used are removed
+/// first.
 class CTK_WIDGETS_EXPORT ctkQImageView: public QWidget
 {
 
   Q_OBJECT
+  Q_PROPERTY(int levelCacheSize READ levelCacheSize WRITE setLevelCacheSize);
+  Q_PROPERTY(int levelCacheUsage READ levelCacheUsage);
 
 public:
 
@@ -77,6 +85,16 @@ public:
 
   double zoom( void );
 
+  /// Maximum memory used by the scaled down levels of the images, in
+  /// kilobytes. 64 MB by default, 0 draws the images at full resolution.
+  int levelCacheSize( void ) const;
+
+  /// Memory used by the scaled down levels of the images, in kilobytes.
+  int levelCacheUsage( void ) const;
+
+  /// Wait for the levels being computed in the background.
+  void waitForLevels( void );
+
 public Q_SLOTS:
 
   void addImage( const QImage & image );
@@ -103,6 +121,8 @@ public Q_SLOTS:
 
   void setZoom( double factor );
 
+  void setLevelCacheSize( int kilobytes );
+
   void reset();
 
   virtual void update( bool zoomChanged=false, bool sizeChanged=false );
@@ -139,6 +159,11 @@ protected:
 
   virtual void resizeEvent( QResizeEvent* event );
 
+protected Q_SLOTS:
+
+  /// Called when missing levels of \a frame are computed
+  void onLevelComputed( int frame, int generation );
+
   /// protected constructor to derive private implementations
   ctkQImageView( ctkQImageViewPrivate & pvt,
     QWidget* parent=0 );
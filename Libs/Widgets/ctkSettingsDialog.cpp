@@ -54,7 +54,12 @@ public:
   void updatePanelTitle(ctkSettingsPanel* panel);
   void updateRestartRequiredLabel();
 
+  /// Start or end the batch of all the panels
+  void setPanelsBatching(bool batching);
+
   QSettings* Settings;
+  bool BatchWrites;
+  bool PanelsBatching;
 
 protected:
   QMap<QTreeWidgetItem*, ctkSettingsPanel*> Panels;
@@ -65,6 +70,8 @@ ctkSettingsDialogPrivate::ctkSettingsDialogPrivate(ctkSettingsDialog& object)
   :q_ptr(&object)
 {
   this->Settings = 0;
+  this->BatchWrites = false;
+  this->PanelsBatching = false;
 }
 
 // --------------------------------------------------------------------------
@@ -178,6 +185,27 @@ void ctkSettingsDialogPrivate::updateRestartRequiredLabel()
   this->RestartRequiredLabel->setVisible(restartRequired);
 }
 
+// --------------------------------------------------------------------------
+void ctkSettingsDialogPrivate::setPanelsBatching(bool batching)
+{
+  if (this->PanelsBatching == batching)
+    {
+    return;
+    }
+  this->PanelsBatching = batching;
+  foreach(ctkSettingsPanel* panel, this->panels())
+    {
+    if (batching)
+      {
+      panel->beginBatch();
+      }
+    else
+      {
+      panel->endBatch();
+      }
+    }
+}
+
 // --------------------------------------------------------------------------
 ctkSettingsDialog::ctkSettingsDialog(QWidget* _parent)
   : Superclass(_parent)
@@ -232,6 +260,10 @@ void ctkSettingsDialog
   connect(panel, SIGNAL(settingChanged(QString,QVariant)),
           this, SLOT(onSettingChanged(QString,QVariant)));
   panel->setSettings(this->settings());
+  if (d->PanelsBatching)
+    {
+    panel->beginBatch();
+    }
 }
 
 // --------------------------------------------------------------------------
@@ -366,6 +398,11 @@ void ctkSettingsDialog::restoreDefaultSettings()
   // for the ones we don't default value, the best is to clear all of them...
   if (d->Settings)
     {
+    // ... once the values not yet written are in, so they get cleared too
+    foreach(ctkSettingsPanel* panel, d->Panels.values())
+      {
+      panel->flushSettings();
+      }
     d->Settings->clear();
     }
   // ... and restore settings for the ones we can
@@ -435,11 +472,20 @@ void ctkSettingsDialog::adjustTreeWidgetToContents()
 // -------------------------------------------------------------------------
 bool ctkSettingsDialog::event(QEvent* event)
 {
+  Q_D(ctkSettingsDialog);
   if (event->type() == QEvent::FontChange ||
       event->type() == QEvent::StyleChange)
     {
     this->adjustTreeWidgetToContents();
     }
+  else if (event->type() == QEvent::Show)
+    {
+    d->setPanelsBatching(d->BatchWrites);
+    }
+  else if (event->type() == QEvent::Hide)
+    {
+    d->setPanelsBatching(false);
+    }
   return this->Superclass::event(event);
 }
 
@@ -465,3 +511,18 @@ bool ctkSettingsDialog::isRestartRequired()const
   return d->RestartRequiredLabel->isVisibleTo(
     const_cast<ctkSettingsDialog*>(this));
 }
+
+// -------------------------------------------------------------------------
+bool ctkSettingsDialog::batchWrites()const
+{
+  Q_D(const ctkSettingsDialog);
+  return d->BatchWrites;
+}
+
+// -------------------------------------------------------------------------
+void ctkSettingsDialog::setBatchWrites(bool batch)
+{
+  Q_D(ctkSettingsDialog);
+  d->BatchWrites = batch;
+  d->setPanelsBatching(batch && this->isVisible());
+}
@@ -53,6 +53,14 @@ class CTK_WIDGETS_EXPORT ctkSettingsDialog : public QDialog
   /// application.
   Q_PROPERTY(bool restartRequired READ isRestartRequired);
 
+  /// This property controls whether the panels postpone writing into the
+  /// settings while the dialog is visible. The modified values are written
+  /// when the dialog is hidden (accepted or rejected) or when the
+  /// ctkSettingsPanel::flushInterval of their panel expires.
+  /// False by default: the settings are written as soon as a value changes.
+  /// \sa ctkSettingsPanel::beginBatch()
+  Q_PROPERTY(bool batchWrites READ batchWrites WRITE setBatchWrites);
+
 public:
   /// Superclass typedef
   typedef QDialog Superclass;
@@ -97,6 +105,9 @@ public:
   /// \sa restartRequired, restartRequested
   bool isRestartRequired()const;
 
+  bool batchWrites()const;
+  void setBatchWrites(bool batch);
+
 public Q_SLOTS:
   void setCurrentPanel(ctkSettingsPanel* panel);
   void setCurrentPanel(const QString& label);
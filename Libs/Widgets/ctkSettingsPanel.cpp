@@ -23,6 +23,7 @@
 #include <QMetaProperty>
 #include <QSettings>
 #include <QSignalMapper>
+#include <QTimer>
 
 // CTK includes
 #include "ctkSettingsPanel.h"
@@ -158,9 +159,27 @@ public:
   /// \sa ctkSettingsPanel::registerProperty
   QSettings* settings(const QString& settingKey)const;
 
+  /// Return true if the values are kept in memory instead of being written
+  /// right away: during a batch or when a flush interval is set.
+  bool deferWrites()const;
+
+  /// Return the value of \a settingKey in \a settings, or its value not yet
+  /// written if the writes are deferred.
+  QVariant storedValue(const QString& settingKey, QSettings* settings);
+  /// Write the value in \a settings, or postpone it until the next flush.
+  void storeValue(const QString& settingKey, QSettings* settings, const QVariant& value);
+  void writeValue(const QString& settingKey, QSettings* settings, const QVariant& value);
+
   QSettings*                  Settings;
   QMap<QString, PropertyType> Properties;
   bool                        SaveToSettingsWhenRegister;
+
+  int                         BatchDepth;
+  /// Values modified and not yet written
+  QMap<QString, QVariant>     PendingValues;
+  /// Values read from or written to the settings since the last flush
+  QHash<QString, QVariant>    StoredValues;
+  QTimer*                     FlushTimer;
 };
 
 // --------------------------------------------------------------------------
@@ -171,11 +190,19 @@ ctkSettingsPanelPrivate::ctkSettingsPanelPrivate(ctkSettingsPanel& object)
   qRegisterMetaType<ctkSettingsPanel::SettingOptions>("ctkSettingsPanel::SettingOptions");
   this->Settings = 0;
   this->SaveToSettingsWhenRegister = true;
+  this->BatchDepth = 0;
+  this->FlushTimer = 0;
 }
 
 // --------------------------------------------------------------------------
 void ctkSettingsPanelPrivate::init()
 {
+  Q_Q(ctkSettingsPanel);
+  this->FlushTimer = new QTimer(q);
+  this->FlushTimer->setSingleShot(true);
+  this->FlushTimer->setInterval(0);
+  QObject::connect(this->FlushTimer, SIGNAL(timeout()),
+                   q, SLOT(flushSettings()));
 }
 
 // --------------------------------------------------------------------------
@@ -193,6 +220,62 @@ QSettings* ctkSettingsPanelPrivate::settings(const QString& settingKey)const
   return this->Settings;
 }
 
+// --------------------------------------------------------------------------
+bool ctkSettingsPanelPrivate::deferWrites()const
+{
+  return this->BatchDepth > 0 || this->FlushTimer->interval() > 0;
+}
+
+// --------------------------------------------------------------------------
+QVariant ctkSettingsPanelPrivate::storedValue(const QString& settingKey,
+                                              QSettings* settings)
+{
+  if (!this->deferWrites())
+    {
+    return settings->value(settingKey);
+    }
+  QHash<QString, QVariant>::const_iterator it = this->StoredValues.constFind(settingKey);
+  if (it != this->StoredValues.constEnd())
+    {
+    return it.value();
+    }
+  QVariant value = settings->value(settingKey);
+  this->StoredValues.insert(settingKey, value);
+  return value;
+}
+
+// --------------------------------------------------------------------------
+void ctkSettingsPanelPrivate::storeValue(const QString& settingKey,
+                                         QSettings* settings,
+                                         const QVariant& value)
+{
+  if (!this->deferWrites())
+    {
+    this->writeValue(settingKey, settings, value);
+    return;
+    }
+  this->PendingValues[settingKey] = value;
+  this->StoredValues[settingKey] = value;
+  if (this->FlushTimer->interval() > 0 && !this->FlushTimer->isActive())
+    {
+    this->FlushTimer->start();
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkSettingsPanelPrivate::writeValue(const QString& settingKey,
+                                         QSettings* settings,
+                                         const QVariant& value)
+{
+  settings->setValue(settingKey, value);
+  if (settings->status() != QSettings::NoError)
+    {
+    logger.warn( QString("Error #%1 while writing setting \"%2\"")
+      .arg(static_cast<int>(settings->status()))
+      .arg(settingKey));
+    }
+}
+
 // --------------------------------------------------------------------------
 ctkSettingsPanel::ctkSettingsPanel(QWidget* _parent)
   : Superclass(_parent)
@@ -205,6 +288,7 @@ ctkSettingsPanel::ctkSettingsPanel(QWidget* _parent)
 // --------------------------------------------------------------------------
 ctkSettingsPanel::~ctkSettingsPanel()
 {
+  this->flushSettings();
   this->applySettings();
 }
 
@@ -223,14 +307,91 @@ void ctkSettingsPanel::setSettings(QSettings* settings)
     {
     return;
     }
+  // Pending values belong to the previous settings
+  this->flushSettings();
   d->Settings = settings;
   this->reloadSettings();
 }
 
+// --------------------------------------------------------------------------
+int ctkSettingsPanel::flushInterval()const
+{
+  Q_D(const ctkSettingsPanel);
+  return d->FlushTimer->interval();
+}
+
+// --------------------------------------------------------------------------
+void ctkSettingsPanel::setFlushInterval(int msecs)
+{
+  Q_D(ctkSettingsPanel);
+  d->FlushTimer->setInterval(qMax(0, msecs));
+  if (d->FlushTimer->interval() == 0)
+    {
+    d->FlushTimer->stop();
+    // Nothing would write the pending values anymore
+    if (d->BatchDepth == 0)
+      {
+      this->flushSettings();
+      }
+    }
+  else if (!d->PendingValues.isEmpty() && !d->FlushTimer->isActive())
+    {
+    d->FlushTimer->start();
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkSettingsPanel::beginBatch()
+{
+  Q_D(ctkSettingsPanel);
+  ++d->BatchDepth;
+}
+
+// --------------------------------------------------------------------------
+void ctkSettingsPanel::endBatch()
+{
+  Q_D(ctkSettingsPanel);
+  Q_ASSERT(d->BatchDepth > 0);
+  if (d->BatchDepth == 0 || --d->BatchDepth > 0)
+    {
+    return;
+    }
+  this->flushSettings();
+}
+
+// --------------------------------------------------------------------------
+bool ctkSettingsPanel::isBatching()const
+{
+  Q_D(const ctkSettingsPanel);
+  return d->BatchDepth > 0;
+}
+
+// --------------------------------------------------------------------------
+void ctkSettingsPanel::flushSettings()
+{
+  Q_D(ctkSettingsPanel);
+  d->FlushTimer->stop();
+  QMap<QString, QVariant> pendingValues = d->PendingValues;
+  d->PendingValues.clear();
+  d->StoredValues.clear();
+  QMap<QString, QVariant>::const_iterator it;
+  for (it = pendingValues.constBegin(); it != pendingValues.constEnd(); ++it)
+    {
+    QSettings* settings = d->settings(it.key());
+    if (settings)
+      {
+      d->writeValue(it.key(), settings, it.value());
+      }
+    }
+}
+
 // --------------------------------------------------------------------------
 void ctkSettingsPanel::reloadSettings()
 {
   Q_D(ctkSettingsPanel);
+  // Values not yet written would be read back as stale
+  this->flushSettings();
+  this->beginBatch();
   foreach(const QString& key, d->Properties.keys())
     {
     QSettings* settings = d->settings(key);
@@ -251,6 +412,7 @@ void ctkSettingsPanel::reloadSettings()
       this->updateSetting(key);
       }
     }
+  this->endBatch();
 }
 
 // --------------------------------------------------------------------------
@@ -273,17 +435,11 @@ void ctkSettingsPanel::setSetting(const QString& key, const QVariant& newVal)
     {
     return;
     }
-  QVariant oldVal = settings->value(key);
+  QVariant oldVal = d->storedValue(key, settings);
   oldVal = PropertyType::fixEmptyStringListVariant(
         oldVal, d->Properties[key].metaProperty().typeName());
-  settings->setValue(key, newVal);
+  d->storeValue(key, settings, newVal);
   d->Properties[key].setValue(newVal);
-  if (settings->status() != QSettings::NoError)
-    {
-    logger.warn( QString("Error #%1 while writing setting \"%2\"")
-      .arg(static_cast<int>(settings->status()))
-      .arg(key));
-    }
   if (oldVal != newVal)
     {
     emit settingChanged(key, newVal);
@@ -313,9 +469,11 @@ void ctkSettingsPanel::registerProperty(const QString& key,
     }
   
   QSettings* propSettings = settings ? settings : d->Settings;
-  if (propSettings && propSettings->contains(key))
+  // When registering in a batch, the value read here is cached for
+  // updateSetting() and the initial value is written with the others.
+  QVariant val = propSettings ? d->storedValue(key, propSettings) : QVariant();
+  if (val.isValid())
     {
-    QVariant val = propSettings->value(key);
     prop.setValue(val);
     prop.setPreviousValue(val);
     }
@@ -414,6 +572,7 @@ ctkSettingsPanel::SettingOptions ctkSettingsPanel
 void ctkSettingsPanel::applySettings()
 {
   Q_D(ctkSettingsPanel);
+  this->flushSettings();
   foreach(const QString& key, d->Properties.keys())
     {
     PropertyType& prop = d->Properties[key];
@@ -425,18 +584,22 @@ void ctkSettingsPanel::applySettings()
 void ctkSettingsPanel::resetSettings()
 {
   Q_D(ctkSettingsPanel);
+  this->beginBatch();
   foreach(const QString& key, d->Properties.keys())
     {
     this->setSetting(key, d->Properties[key].previousValue());
     }
+  this->endBatch();
 }
 
 // --------------------------------------------------------------------------
 void ctkSettingsPanel::restoreDefaultSettings()
 {
   Q_D(ctkSettingsPanel);
+  this->beginBatch();
   foreach(const QString& key, d->Properties.keys())
     {
     this->setSetting(key, d->Properties[key].DefaultValue);
     }
+  this->endBatch();
 }
@@ -40,6 +40,14 @@ class CTK_WIDGETS_EXPORT ctkSettingsPanel : public QWidget
 
   Q_PROPERTY(QSettings* settings READ settings WRITE setSettings);
 
+  /// Maximum time in milliseconds the modified setting values can stay
+  /// unwritten. When set, the changes are coalesced even outside of a batch,
+  /// e.g. while dragging a slider only the last value is written. They are
+  /// also written by applySettings() and when the panel is destroyed.
+  /// 0 (default) writes them right away, or when the batch ends.
+  /// \sa beginBatch(), flushSettings()
+  Q_PROPERTY(int flushInterval READ flushInterval WRITE setFlushInterval);
+
 public:
   /// Superclass typedef
   typedef QWidget Superclass;
@@ -53,6 +61,9 @@ public:
   QSettings* settings()const;
   void setSettings(QSettings* settings);
 
+  int flushInterval()const;
+  void setFlushInterval(int msecs);
+
   enum SettingOption{
     OptionNone = 0x0000,
     OptionRequireRestart = 0x0001,
@@ -108,11 +119,28 @@ public:
 
   /// Return the options associated to a setting
   SettingOptions settingOptions(const QString& settingKey)const;
+
+  /// Start coalescing the writes into the settings.
+  /// Until the matching endBatch() is called, modified values are kept in
+  /// memory and only the last value of each key is written, when the batch
+  /// ends or when flushInterval expires. The values read from the settings
+  /// during the batch are cached, they are not fetched again until the next
+  /// flush. Batches can be nested.
+  /// resetSettings(), restoreDefaultSettings() and reloadSettings() always
+  /// run in a batch. Registering many properties in a batch reads each key
+  /// once and writes the initial values in one go.
+  /// \sa endBatch(), isBatching(), flushSettings()
+  void beginBatch();
+  /// End the batch started by beginBatch(). The pending values are written
+  /// when the outermost batch ends.
+  void endBatch();
+  /// Return true between beginBatch() and the matching endBatch().
+  bool isBatching()const;
 public Q_SLOTS:
 
   /// Forget the old property values so next time resetSettings is called it
   /// will set the properties with the same values when applySettings() is
-  /// called.
+  /// called. The values not yet written are flushed into the settings.
   virtual void applySettings();
 
   /// Restore all the properties with their values when applySettings() was
@@ -130,6 +158,11 @@ public Q_SLOTS:
   /// \sa resetSettings(), restoreDefaultSettings()
   virtual void reloadSettings();
 
+  /// Write the values modified during the current batch into the settings
+  /// and forget the cached values.
+  /// \sa beginBatch()
+  void flushSettings();
+
 Q_SIGNALS:
   /// Fired anytime a property is modified.
   void settingChanged(const QString& key, const QVariant& value);
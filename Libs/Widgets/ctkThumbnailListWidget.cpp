@@ -25,9 +25,14 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QGridLayout>
+#include <QImage>
+#include <QImageReader>
+#include <QMutexLocker>
 #include <QPixmap>
+#include <QPixmapCache>
 #include <QPushButton>
 #include <QResizeEvent>
+#include <QRunnable>
 #include <QScrollBar>
 #include <QTimer>
 
@@ -47,6 +52,32 @@
 
 static ctkLogger logger("org.commontk.Widgets.ctkThumbnailListWidget");
 
+//----------------------------------------------------------------------------
+class ctkThumbnailListWidgetLoadTask : public QRunnable
+{
+public:
+  ctkThumbnailListWidgetLoadTask(ctkThumbnailListWidgetPrivate* widget,
+                                 const QString& source, const QSize& size,
+                                 int generation)
+    : Widget(widget)
+    , Source(source)
+    , Size(size)
+    , Generation(generation)
+  {
+  }
+
+  virtual void run()
+  {
+    this->Widget->loadThumbnail(this->Source, this->Size, this->Generation);
+  }
+
+private:
+  ctkThumbnailListWidgetPrivate* Widget;
+  QString Source;
+  QSize Size;
+  int Generation;
+};
+
 //----------------------------------------------------------------------------
 // ctkThumbnailListWidgetPrivate methods
 
@@ -57,6 +88,8 @@ ctkThumbnailListWidgetPrivate
   , CurrentThumbnail(-1)
   , ThumbnailSize(-1, -1)
   , RequestRelayout(false)
+  , LoadVisibleRequested(false)
+  , LoadGeneration(0)
 {
 }
 
@@ -72,6 +105,10 @@ void ctkThumbnailListWidgetPrivate::init()
   flowLayout->setHorizontalSpacing(4);
   this->ScrollAreaContentWidget->setLayout(flowLayout);
   this->ScrollArea->installEventFilter(q);
+  q->connect(this->ScrollArea->horizontalScrollBar(), SIGNAL(valueChanged(int)),
+    q, SLOT(loadVisibleThumbnails()));
+  q->connect(this->ScrollArea->verticalScrollBar(), SIGNAL(valueChanged(int)),
+    q, SLOT(loadVisibleThumbnails()));
 }
 
 //----------------------------------------------------------------------------
@@ -79,6 +116,14 @@ void ctkThumbnailListWidgetPrivate::clearAllThumbnails()
 {
   Q_Q(ctkThumbnailListWidget);
 
+  // Forget the images being loaded
+  {
+  QMutexLocker locker(&this->LoadMutex);
+  ++this->LoadGeneration;
+  }
+  this->PendingThumbnails.clear();
+  this->LoadingSources.clear();
+
   // Remove previous displayed thumbnails
   QLayoutItem* item;
   while((item = this->ScrollAreaContentWidget->layout()->takeAt(0)))
@@ -147,6 +192,37 @@ void ctkThumbnailListWidgetPrivate::updateScrollAreaContentWidgetSize(QSize size
   this->ScrollAreaContentWidget->resize(newViewportSize);
 }
 
+//----------------------------------------------------------------------------
+QString ctkThumbnailListWidgetPrivate::pixmapCacheKey(const QString& source)const
+{
+  return QString("ctkThumbnailListWidget/%1x%2/%3")
+    .arg(this->ThumbnailSize.width()).arg(this->ThumbnailSize.height())
+    .arg(source);
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailListWidgetPrivate::loadThumbnail(const QString& source,
+                                                  const QSize& size, int generation)
+{
+  Q_Q(ctkThumbnailListWidget);
+  {
+  QMutexLocker locker(&this->LoadMutex);
+  if (generation != this->LoadGeneration)
+    {
+    return;
+    }
+  }
+  QImage image = q->loadThumbnailImage(source, size);
+  if (!image.isNull() && size.isValid() &&
+      (image.width() > size.width() || image.height() > size.height()))
+    {
+    image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+  QMetaObject::invokeMethod(q, "onThumbnailImageLoaded", Qt::QueuedConnection,
+                            Q_ARG(QString, source), Q_ARG(QImage, image),
+                            Q_ARG(int, generation));
+}
+
 //----------------------------------------------------------------------------
 // ctkThumbnailListWidget methods
 
@@ -177,6 +253,7 @@ ctkThumbnailListWidget::~ctkThumbnailListWidget()
   Q_D(ctkThumbnailListWidget);
 
   d->clearAllThumbnails();
+  d->LoadPool.waitForDone();
 }
 
 //----------------------------------------------------------------------------
@@ -202,6 +279,132 @@ void ctkThumbnailListWidget::addThumbnail(const QPixmap& pixmap, const QString&
   d->addThumbnail(widget);
 }
 
+//----------------------------------------------------------------------------
+void ctkThumbnailListWidget::addThumbnailSources(const QStringList& sources)
+{
+  foreach(const QString& source, sources)
+    {
+    this->addThumbnailSource(source);
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailListWidget::addThumbnailSource(const QString& source, const QString& label)
+{
+  Q_D(ctkThumbnailListWidget);
+  ctkThumbnailLabel* widget = new ctkThumbnailLabel(d->ScrollAreaContentWidget);
+  widget->setText(label);
+  if(d->ThumbnailSize.isValid())
+    {
+    widget->setFixedSize(d->ThumbnailSize);
+    }
+  QPixmap pixmap;
+  if (QPixmapCache::find(d->pixmapCacheKey(source), &pixmap))
+    {
+    widget->setPixmap(pixmap);
+    }
+  else
+    {
+    d->PendingThumbnails[widget] = source;
+    if (!d->LoadVisibleRequested)
+      {
+      d->LoadVisibleRequested = true;
+      QTimer::singleShot(0, this, SLOT(loadVisibleThumbnails()));
+      }
+    }
+  d->addThumbnail(widget);
+}
+
+//----------------------------------------------------------------------------
+QImage ctkThumbnailListWidget::loadThumbnailImage(const QString& source,
+                                                  const QSize& size)const
+{
+  QImageReader reader(source);
+  QSize imageSize = reader.size();
+  if (size.isValid() && imageSize.isValid() &&
+      (imageSize.width() > size.width() || imageSize.height() > size.height()))
+    {
+    // some formats (e.g. JPEG) can be decoded directly at a smaller size
+    imageSize.scale(size, Qt::KeepAspectRatio);
+    reader.setScaledSize(imageSize);
+    }
+  return reader.read();
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailListWidget::loadVisibleThumbnails()
+{
+  Q_D(ctkThumbnailListWidget);
+  d->LoadVisibleRequested = false;
+  if (d->PendingThumbnails.isEmpty() || !this->isVisible())
+    {
+    return;
+    }
+  // Load the thumbnails in the viewport and one viewport around it
+  QSize viewportSize = d->ScrollArea->viewport()->size();
+  QRect visibleRect(-d->ScrollAreaContentWidget->pos(), viewportSize);
+  QRect nearRect = visibleRect.adjusted(
+    -viewportSize.width(), -viewportSize.height(),
+    viewportSize.width(), viewportSize.height());
+  int generation;
+  {
+  QMutexLocker locker(&d->LoadMutex);
+  generation = d->LoadGeneration;
+  }
+  QHash<ctkThumbnailLabel*, QString>::const_iterator it;
+  for (it = d->PendingThumbnails.constBegin();
+       it != d->PendingThumbnails.constEnd(); ++it)
+    {
+    if (d->LoadingSources.contains(it.value()) ||
+        !it.key()->geometry().intersects(nearRect))
+      {
+      continue;
+      }
+    d->LoadingSources.insert(it.value());
+    d->LoadPool.start(new ctkThumbnailListWidgetLoadTask(
+      d, it.value(), d->ThumbnailSize, generation));
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkThumbnailListWidget::onThumbnailImageLoaded(const QString& source,
+                                                    const QImage& image,
+                                                    int generation)
+{
+  Q_D(ctkThumbnailListWidget);
+  {
+  QMutexLocker locker(&d->LoadMutex);
+  if (generation != d->LoadGeneration)
+    {
+    return;
+    }
+  }
+  d->LoadingSources.remove(source);
+  QPixmap pixmap = QPixmap::fromImage(image);
+  if (pixmap.isNull())
+    {
+    logger.warn("Failed to load thumbnail " + source);
+    }
+  else
+    {
+    QPixmapCache::insert(d->pixmapCacheKey(source), pixmap);
+    }
+  QHash<ctkThumbnailLabel*, QString>::iterator it = d->PendingThumbnails.begin();
+  while (it != d->PendingThumbnails.end())
+    {
+    if (it.value() != source)
+      {
+      ++it;
+      continue;
+      }
+    if (!pixmap.isNull())
+      {
+      it.key()->setPixmap(pixmap);
+      }
+    it = d->PendingThumbnails.erase(it);
+    }
+}
+
 //----------------------------------------------------------------------------
 void ctkThumbnailListWidget::setCurrentThumbnail(int index)
 {
@@ -304,6 +507,7 @@ void ctkThumbnailListWidget::resizeEvent(QResizeEvent* event)
 {
   Q_D(ctkThumbnailListWidget);
   d->updateScrollAreaContentWidgetSize(event->size());
+  this->loadVisibleThumbnails();
 }
 
 //----------------------------------------------------------------------------
@@ -326,4 +530,5 @@ void ctkThumbnailListWidget::updateLayout()
 {
   Q_D(ctkThumbnailListWidget);
   d->updateScrollAreaContentWidgetSize(this->size());
+  this->loadVisibleThumbnails();
 }
@@ -23,6 +23,7 @@
 
 // Qt includes
 #include <QWidget>
+class QImage;
 class QResizeEvent;
 
 // CTK includes
@@ -48,6 +49,17 @@ public:
   /// Add multiple thumbnails to the widget
   void addThumbnails(const QList<QPixmap>& thumbnails);
 
+  /// Add a thumbnail whose image is loaded from \a source in a worker
+  /// thread by loadThumbnailImage(). The label is shown without image until
+  /// then. Only the thumbnails in or near the visible area are loaded.
+  /// The loaded images are kept in QPixmapCache.
+  /// \sa loadThumbnailImage()
+  void addThumbnailSource(const QString& source, const QString& label = QString());
+
+  /// Add multiple thumbnails loaded asynchronously.
+  /// \sa addThumbnailSource()
+  void addThumbnailSources(const QStringList& sources);
+
   /// Set current thumbnail
   void setCurrentThumbnail(int index);
 
@@ -79,11 +91,23 @@ Q_SIGNALS:
 protected Q_SLOTS:
   void onThumbnailSelected(const ctkThumbnailLabel& widget);
   void updateLayout();
+  /// Start loading the thumbnails in or near the visible area.
+  void loadVisibleThumbnails();
+  void onThumbnailImageLoaded(const QString& source, const QImage& image,
+                              int generation);
 
 protected:
   explicit ctkThumbnailListWidget(ctkThumbnailListWidgetPrivate* ptr, QWidget* parent=0);
   ctkThumbnailListWidgetPrivate* d_ptr;
 
+  /// Return the image of a thumbnail source, by default the image of the
+  /// file \a source decoded at about \a size. \a size is the thumbnailSize,
+  /// invalid if not set; larger images are scaled down afterwards.
+  /// Can be reimplemented to load images from other sources. It is called
+  /// from a worker thread, it must be thread-safe and must not use QPixmap.
+  /// \sa addThumbnailSource()
+  virtual QImage loadThumbnailImage(const QString& source, const QSize& size)const;
+
   virtual void resizeEvent(QResizeEvent* event);
 
 private:
@@ -21,6 +21,12 @@
 #ifndef __ctkThumbnailListWidget_p_h
 #define __ctkThumbnailListWidget_p_h
 
+// Qt includes
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
+
 #include "ctkWidgetsExport.h"
 #include "ui_ctkThumbnailListWidget.h"
 
@@ -43,6 +49,11 @@ public:
   void addThumbnail(ctkThumbnailLabel* thumbnail);
   void updateScrollAreaContentWidgetSize(QSize size);
 
+  /// Key of the image of source in QPixmapCache
+  QString pixmapCacheKey(const QString& source)const;
+  /// Called from the worker threads
+  void loadThumbnail(const QString& source, const QSize& size, int generation);
+
 protected:
   ctkThumbnailListWidget* const q_ptr;
 
@@ -50,6 +61,16 @@ protected:
   QSize ThumbnailSize;
   bool RequestRelayout;
 
+  /// Thumbnails waiting for their image, with the source of the image
+  QHash<ctkThumbnailLabel*, QString> PendingThumbnails;
+  /// Sources being loaded by LoadPool
+  QSet<QString> LoadingSources;
+  bool LoadVisibleRequested;
+  /// Incremented when the images being loaded are not wanted anymore
+  int LoadGeneration;
+  QMutex LoadMutex;
+  QThreadPool LoadPool;
+
 private:
   Q_DISABLE_COPY( ctkThumbnailListWidgetPrivate );
 };
@@ -46,6 +46,7 @@ protected:
 
 public:
   ctkTransferFunctionBarsItemPrivate(ctkTransferFunctionBarsItem& object);
+  void init();
 
   QPainterPath createBarsPath(ctkTransferFunction* tf, const QList<QPointF>& points, qreal barWidth, bool useLog, const QRectF& rect);
   QPainterPath createAreaPath(ctkTransferFunction* tf, const QList<QPointF>& points, qreal barWidth, bool useLog, const QRectF& rect);
@@ -55,6 +56,12 @@ public:
   qreal  BarWidthRatio;
   QColor BarColor;
   ctkTransferFunctionBarsItem::LogMode   LogMode;
+
+  /// The bars of histograms with thousands of bins are long to build, the
+  /// path is kept until the transfer function, the rect or the width change.
+  QPainterPath BarsPath;
+  QRectF       BarsPathRect;
+  bool         BarsPathModified;
 };
 
 //-----------------------------------------------------------------------------
@@ -66,6 +73,15 @@ ctkTransferFunctionBarsItemPrivate::ctkTransferFunctionBarsItemPrivate(ctkTransf
   this->BarColor = QApplication::palette().color(QPalette::Normal, QPalette::Highlight);
   this->BarColor.setAlphaF(0.2);
   this->LogMode = ctkTransferFunctionBarsItem::AutoLog;
+  this->BarsPathModified = true;
+}
+
+//-----------------------------------------------------------------------------
+void ctkTransferFunctionBarsItemPrivate::init()
+{
+  Q_Q(ctkTransferFunctionBarsItem);
+  // The bars rarely change, don't repaint them when other items move.
+  q->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 //-----------------------------------------------------------------------------
@@ -73,6 +89,8 @@ ctkTransferFunctionBarsItem::ctkTransferFunctionBarsItem(QGraphicsItem* parentGr
   :ctkTransferFunctionItem(parentGraphicsItem)
   , d_ptr(new ctkTransferFunctionBarsItemPrivate(*this))
 {
+  Q_D(ctkTransferFunctionBarsItem);
+  d->init();
 }
 
 //-----------------------------------------------------------------------------
@@ -81,6 +99,8 @@ ctkTransferFunctionBarsItem::ctkTransferFunctionBarsItem(
   :ctkTransferFunctionItem(transferFunc, parentItem)
   , d_ptr(new ctkTransferFunctionBarsItemPrivate(*this))
 {
+  Q_D(ctkTransferFunctionBarsItem);
+  d->init();
 }
 
 //-----------------------------------------------------------------------------
@@ -98,6 +118,7 @@ void ctkTransferFunctionBarsItem::setBarWidth(qreal newBarWidthRatio)
     return;
     }
   d->BarWidthRatio = newBarWidthRatio;
+  d->BarsPathModified = true;
   this->update();
 }
 
@@ -112,7 +133,12 @@ qreal ctkTransferFunctionBarsItem::barWidth()const
 void ctkTransferFunctionBarsItem::setBarColor(const QColor& color)
 {
   Q_D(ctkTransferFunctionBarsItem);
+  if (d->BarColor == color)
+    {
+    return;
+    }
   d->BarColor = color;
+  this->update();
 }
 
 //-----------------------------------------------------------------------------
@@ -152,25 +178,41 @@ void ctkTransferFunctionBarsItem::paint(
     }
 
   Q_ASSERT(tf->representation());
-  const QList<QPointF>& points = tf->representation()->points();
+  const bool area = qFuzzyCompare(d->BarWidthRatio, 1.);
+  if (d->BarsPathModified || d->BarsPathRect != this->rect())
+    {
+    const QList<QPointF>& points = tf->representation()->points();
 
-  qreal barWidth = d->barWidth(); 
-  bool useLog = d->useLog();
+    qreal barWidth = d->barWidth();
+    bool useLog = d->useLog();
 
-  QPainterPath bars;
-  if (qFuzzyCompare(d->BarWidthRatio, 1.))
-    {
-    bars = d->createAreaPath(tf, points, barWidth, useLog, this->rect());
-    pen.setWidth(2);
+    if (area)
+      {
+      d->BarsPath = d->createAreaPath(tf, points, barWidth, useLog, this->rect());
+      }
+    else
+      {
+      d->BarsPath = d->createBarsPath(tf, points, barWidth, useLog, this->rect());
+      }
+    d->BarsPathRect = this->rect();
+    d->BarsPathModified = false;
     }
-  else
+  if (area)
     {
-    bars = d->createBarsPath(tf, points, barWidth, useLog, this->rect());
+    pen.setWidth(2);
     }
-  
+
   painter->setPen(pen);
   painter->setBrush(QBrush(d->BarColor));
-  painter->drawPath(bars);
+  painter->drawPath(d->BarsPath);
+}
+
+//-----------------------------------------------------------------------------
+void ctkTransferFunctionBarsItem::onTransferFunctionChanged()
+{
+  Q_D(ctkTransferFunctionBarsItem);
+  d->BarsPathModified = true;
+  this->ctkTransferFunctionItem::onTransferFunctionChanged();
 }
 
 //-----------------------------------------------------------------------------
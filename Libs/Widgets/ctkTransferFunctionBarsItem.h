@@ -58,6 +58,10 @@ public:
     AutoLog =2
   };
   virtual void paint(QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget = 0);
+
+protected:
+  virtual void onTransferFunctionChanged();
+
 protected:
   QScopedPointer<ctkTransferFunctionBarsItemPrivate> d_ptr;
 
@@ -52,6 +52,8 @@ ctkTransferFunctionGradientItem::ctkTransferFunctionGradientItem(QGraphicsItem*
   :ctkTransferFunctionItem(parentGraphicsItem)
   , d_ptr(new ctkTransferFunctionGradientItemPrivate)
 {
+  // Only repainted when the transfer function or the view changes
+  this->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 //-----------------------------------------------------------------------------
@@ -60,6 +62,8 @@ ctkTransferFunctionGradientItem::ctkTransferFunctionGradientItem(
   :ctkTransferFunctionItem(transferFunction, parentItem)
   , d_ptr(new ctkTransferFunctionGradientItemPrivate)
 {
+  // Only repainted when the transfer function or the view changes
+  this->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 //-----------------------------------------------------------------------------
@@ -116,5 +120,10 @@ bool ctkTransferFunctionGradientItem::mask() const
 void ctkTransferFunctionGradientItem::setMask( bool mask )
 {
   Q_D( ctkTransferFunctionGradientItem );
+  if (d->Mask == mask)
+    {
+    return;
+    }
   d->Mask = mask;
+  this->update();
 }
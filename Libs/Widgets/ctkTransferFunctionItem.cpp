@@ -85,12 +85,28 @@ ctkTransferFunctionItem::~ctkTransferFunctionItem()
 void ctkTransferFunctionItem::setTransferFunction(ctkTransferFunction* transferFunction)
 {
   Q_D(ctkTransferFunctionItem);
+  if (d->TransferFunction == transferFunction)
+    {
+    return;
+    }
+  if (d->TransferFunction)
+    {
+    disconnect(d->TransferFunction, SIGNAL(changed()),
+               this, SLOT(onTransferFunctionChanged()));
+    }
   d->TransferFunction = transferFunction;
-  if (this->scene())
+  if (d->TransferFunction)
     {
-    connect(d->TransferFunction,SIGNAL(changed()),
-            this->scene(), SLOT(update()),Qt::UniqueConnection);
+    connect(d->TransferFunction, SIGNAL(changed()),
+            this, SLOT(onTransferFunctionChanged()), Qt::UniqueConnection);
     }
+  this->onTransferFunctionChanged();
+}
+
+//-----------------------------------------------------------------------------
+void ctkTransferFunctionItem::onTransferFunctionChanged()
+{
+  this->update();
 }
 
 //-----------------------------------------------------------------------------
@@ -322,11 +338,6 @@ QPointF ctkTransferFunctionItem::screen2TransferFunctionCoordinates( qreal x, qr
 //-----------------------------------------------------------------------------
 QVariant ctkTransferFunctionItem::itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant& value)
 {
-  QVariant res = this->QGraphicsObject::itemChange(change, value);
-  if (change == QGraphicsItem::ItemSceneHasChanged && this->scene())
-    {
-    connect(this->transferFunction(),SIGNAL(changed()),
-            this->scene(), SLOT(update()),Qt::UniqueConnection);
-    }
-  return res;
+  // The item is connected to the transfer function in setTransferFunction()
+  return this->QGraphicsObject::itemChange(change, value);
 }
@@ -73,6 +73,13 @@ protected:
   //QList<ctkPoint> bezierParams(ctkControlPoint* start, ctkControlPoint* end)const;
   //QList<ctkPoint> nonLinearPoints(ctkControlPoint* start, ctkControlPoint* end)const;
   virtual QVariant itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant& value);
+
+protected Q_SLOTS:
+  /// Called when the transfer function is modified. Only the item is
+  /// repainted, not the whole scene.
+  /// Reimplement to invalidate cached drawings.
+  virtual void onTransferFunctionChanged();
+
 protected:
   QScopedPointer<ctkTransferFunctionItemPrivate> d_ptr;
 
@@ -107,6 +107,18 @@ void ctkTreeComboBox::setVisibleModelColumn(int index)
   d->VisibleModelColumn = index;
 }
 
+// -------------------------------------------------------------------------
+bool ctkTreeComboBox::uniformRowHeights()const
+{
+  return this->treeView()->uniformRowHeights();
+}
+
+// -------------------------------------------------------------------------
+void ctkTreeComboBox::setUniformRowHeights(bool uniform)
+{
+  this->treeView()->setUniformRowHeights(uniform);
+}
+
 // -------------------------------------------------------------------------
 bool ctkTreeComboBox::eventFilter(QObject* object, QEvent* _event)
 {
@@ -251,6 +263,8 @@ void ctkTreeComboBox::resizePopup()
     {
     int listHeight = 0;
     int count = 0;
+    // with uniform heights, the first row gives the height of all of them
+    int rowHeight = -1;
     QStack<QModelIndex> toCheck;
     toCheck.push(this->view()->rootIndex());
 #ifndef QT_NO_TREEVIEW
@@ -268,7 +282,11 @@ void ctkTreeComboBox::resizePopup()
           {
           continue;
           }
-        listHeight += this->view()->visualRect(idx).height(); /* + container->spacing() */;
+        if (rowHeight < 0 || !this->uniformRowHeights())
+          {
+          rowHeight = this->view()->visualRect(idx).height();
+          }
+        listHeight += rowHeight; /* + container->spacing() */;
 #ifndef QT_NO_TREEVIEW
         if (this->model()->hasChildren(idx) && treeView && treeView->isExpanded(idx))
           {
@@ -276,7 +294,9 @@ void ctkTreeComboBox::resizePopup()
           }
 #endif
         ++count;
-        if (!usePopup && count > this->maxVisibleItems())
+        // the popup is never taller than the screen
+        if ((!usePopup && count > this->maxVisibleItems()) ||
+            (boundToScreen && listHeight > screen.height()))
           {
           toCheck.clear();
           break;
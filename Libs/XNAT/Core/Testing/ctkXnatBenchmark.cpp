@@ -0,0 +1,505 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkXnatBenchmark.h"
+
+#include "ctkXnatMockServer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QStringList>
+#include <QTest>
+#include <QUuid>
+
+#include <ctkXnatDataModel.h>
+#include <ctkXnatDefaultSchemaTypes.h>
+#include <ctkXnatDownloadManager.h>
+#include <ctkXnatException.h>
+#include <ctkXnatFile.h>
+#include <ctkXnatLoginProfile.h>
+#include <ctkXnatProject.h>
+#include <ctkXnatResource.h>
+#include <ctkXnatResourceFolder.h>
+#include <ctkXnatSession.h>
+#include <ctkXnatUploadManager.h>
+
+namespace {
+
+// The archive of the tree walk, download and concurrency benchmarks
+const int Projects = 2;
+const int Subjects = 4;
+const int Experiments = 2;
+const int Scans = 2;
+const int Files = 16;
+const int FileSize = 256 * 1024;
+
+const char* const ScanFilesUri =
+    "/data/archive/projects/P0/subjects/P0_S0/experiments/P0_S0_E0/scans/1/resources/DICOM/files";
+
+//----------------------------------------------------------------------------
+int walk(ctkXnatObject* object)
+{
+  int count = 0;
+  object->fetch();
+  foreach (ctkXnatObject* child, object->children())
+  {
+    count += 1 + walk(child);
+  }
+  return count;
+}
+
+//----------------------------------------------------------------------------
+void removeDirectory(const QString& path)
+{
+  QDir dir(path);
+  foreach (const QFileInfo& entry, dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot))
+  {
+    if (entry.isDir())
+    {
+      removeDirectory(entry.filePath());
+    }
+    else
+    {
+      dir.remove(entry.fileName());
+    }
+  }
+  QDir().rmdir(path);
+}
+
+}
+
+//----------------------------------------------------------------------------
+ctkXnatAsyncTreeWalker::ctkXnatAsyncTreeWalker(ctkXnatSession* session)
+  : Pending(0), Count(0)
+{
+  connect(session, SIGNAL(fetchFinished(ctkXnatObject*)), this, SLOT(fetchFinished(ctkXnatObject*)));
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatAsyncTreeWalker::walk(ctkXnatObject* root)
+{
+  this->Pending = 1;
+  this->Count = 0;
+  root->fetchAsync();
+  while (this->Pending > 0)
+  {
+    QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+  }
+  return this->Count;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatAsyncTreeWalker::fetchFinished(ctkXnatObject* object)
+{
+  // the requests of all children are sent before the first reply is handled
+  foreach (ctkXnatObject* child, object->children())
+  {
+    ++this->Count;
+    ++this->Pending;
+    child->fetchAsync();
+  }
+  --this->Pending;
+}
+
+//----------------------------------------------------------------------------
+class ctkXnatBenchmarkTestCasePrivate
+{
+public:
+  ctkXnatSession* openSession(const QUrl& url) const;
+
+  ctkXnatMockServer Server;
+
+  QString WorkPath;
+  QStringList UploadFiles;
+};
+
+//----------------------------------------------------------------------------
+ctkXnatSession* ctkXnatBenchmarkTestCasePrivate::openSession(const QUrl& url) const
+{
+  ctkXnatLoginProfile loginProfile;
+  loginProfile.setName("mock");
+  loginProfile.setServerUrl(url);
+  loginProfile.setUserName("ctk");
+  loginProfile.setPassword("ctk");
+
+  ctkXnatSession* session = new ctkXnatSession(loginProfile);
+  session->open();
+  return session;
+}
+
+// --------------------------------------------------------------------------
+ctkXnatBenchmarkTestCase::ctkXnatBenchmarkTestCase()
+: d_ptr(new ctkXnatBenchmarkTestCasePrivate())
+{
+}
+
+// --------------------------------------------------------------------------
+ctkXnatBenchmarkTestCase::~ctkXnatBenchmarkTestCase()
+{
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::initTestCase()
+{
+  Q_D(ctkXnatBenchmarkTestCase);
+
+  QVERIFY(d->Server.listen());
+  d->Server.populate(Projects, Subjects, Experiments, Scans, Files, FileSize);
+
+  d->WorkPath = QDir::tempPath() + "/ctkXnatBenchmark_" + QUuid::createUuid().toString().mid(1, 8);
+  QVERIFY(QDir().mkpath(d->WorkPath + "/upload"));
+
+  for (int i = 0; i < Files; ++i)
+  {
+    QString fileName = QString("%1/upload/%2.bin").arg(d->WorkPath).arg(i);
+    QFile file(fileName);
+    QVERIFY(file.open(QFile::WriteOnly));
+    QByteArray data(FileSize, '\0');
+    for (int j = 0; j < data.size(); ++j)
+    {
+      data[j] = static_cast<char>(qrand());
+    }
+    QCOMPARE(file.write(data), static_cast<qint64>(data.size()));
+    d->UploadFiles << fileName;
+  }
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::init()
+{
+  Q_D(ctkXnatBenchmarkTestCase);
+
+  d->Server.setLatency(0);
+  d->Server.setBandwidth(0);
+  d->Server.resetStatistics();
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::cleanupTestCase()
+{
+  Q_D(ctkXnatBenchmarkTestCase);
+
+  d->Server.close();
+  removeDirectory(d->WorkPath);
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkTreeWalk_data()
+{
+  QTest::addColumn<int>("latency");
+  QTest::addColumn<bool>("async");
+
+  QTest::newRow("fetch, 0 ms") << 0 << false;
+  QTest::newRow("fetchAsync, 0 ms") << 0 << true;
+  QTest::newRow("fetch, 5 ms") << 5 << false;
+  QTest::newRow("fetchAsync, 5 ms") << 5 << true;
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkTreeWalk()
+{
+  Q_D(ctkXnatBenchmarkTestCase);
+  QFETCH(int, latency);
+  QFETCH(bool, async);
+
+  d->Server.setLatency(latency);
+
+  // Includes opening and closing the session, two requests next to the ones of the walk
+  int count = 0;
+  QBENCHMARK
+  {
+    QScopedPointer<ctkXnatSession> session(d->openSession(d->Server.url()));
+    if (async)
+    {
+      ctkXnatAsyncTreeWalker walker(session.data());
+      count = walker.walk(session->dataModel());
+    }
+    else
+    {
+      count = walk(session->dataModel());
+    }
+  }
+
+  int scans = Projects * Subjects * Experiments * Scans;
+  QVERIFY(count >= Projects + Projects * Subjects + Projects * Subjects * Experiments +
+          scans + scans * Files);
+  qDebug() << count << "objects," << d->Server.requestCount() << "requests on"
+           << d->Server.connectionCount() << "connections";
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkListingParsing_data()
+{
+  QTest::addColumn<int>("subjects");
+
+  QTest::newRow("1000 subjects") << 1000;
+  QTest::newRow("10000 subjects") << 10000;
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkListingParsing()
+{
+  Q_D(ctkXnatBenchmarkTestCase);
+  QFETCH(int, subjects);
+
+  // A project of its own, the transfer over the loopback is part of the measurement
+  ctkXnatMockServer server;
+  QVERIFY(server.listen());
+  server.populate(1, subjects, 0, 0);
+  QScopedPointer<ctkXnatSession> session(d->openSession(server.url()));
+
+  ctkXnatSession::UrlParameters parameters;
+  parameters["columns"] = "ID,label,insert_date,insert_user,URI";
+
+  int count = 0;
+  QElapsedTimer timer;
+  timer.start();
+  QBENCHMARK
+  {
+    QUuid queryId = session->httpGet("/data/archive/projects/P0/subjects", parameters);
+    QList<ctkXnatObject*> results = session->httpResults(queryId, ctkXnatDefaultSchemaTypes::XSI_SUBJECT);
+    count = results.size();
+    qDeleteAll(results);
+  }
+  qint64 elapsed = timer.elapsed();
+
+  QCOMPARE(count, subjects);
+  if (elapsed > 0)
+  {
+    int iterations = qMax(1, server.requestCount() - 2);
+    qDebug() << (1000.0 * subjects * iterations / elapsed) << "subjects/s";
+  }
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkDownload_data()
+{
+  QTest::addColumn<int>("connections");
+  QTest::addColumn<qint64>("bandwidth");
+
+  QTest::newRow("1 connection, unlimited") << 1 << Q_INT64_C(0);
+  QTest::newRow("4 connections, unlimited") << 4 << Q_INT64_C(0);
+  QTest::newRow("1 connection, 8 MB/s") << 1 << Q_INT64_C(8 << 20);
+  QTest::newRow("4 connections, 8 MB/s") << 4 << Q_INT64_C(8 << 20);
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkDownload()
+{
+  Q_D(ctkXnatBenchmarkTestCase);
+  QFETCH(int, connections);
+  QFETCH(qint64, bandwidth);
+
+  d->Server.setLatency(5);
+  d->Server.setBandwidth(bandwidth);
+  QScopedPointer<ctkXnatSession> session(d->openSession(d->Server.url()));
+
+  // Every iteration downloads into a new directory, existing files are not downloaded again
+  int iteration = 0;
+  QStringList errors;
+  QElapsedTimer timer;
+  timer.start();
+  QBENCHMARK
+  {
+    ctkXnatDownloadManager manager(session.data());
+    manager.setMaximumConnections(connections);
+    manager.download(ScanFilesUri, QString("%1/download/%2").arg(d->WorkPath).arg(iteration++));
+    manager.waitForFinished();
+    errors << manager.errors();
+  }
+  qint64 elapsed = timer.elapsed();
+
+  QVERIFY2(errors.isEmpty(), qPrintable(errors.join("\n")));
+  QCOMPARE(QDir(QString("%1/download/0").arg(d->WorkPath)).entryList(QDir::Files).size(), Files);
+  removeDirectory(d->WorkPath + "/download");
+  if (elapsed > 0)
+  {
+    qDebug() << (1000.0 * iteration * Files * FileSize / elapsed / (1 << 20)) << "MB/s";
+  }
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkUpload_data()
+{
+  QTest::addColumn<int>("connections");
+  QTest::addColumn<qint64>("bandwidth");
+
+  QTest::newRow("1 connection, unlimited") << 1 << Q_INT64_C(0);
+  QTest::newRow("4 connections, unlimited") << 4 << Q_INT64_C(0);
+  QTest::newRow("1 connection, 8 MB/s") << 1 << Q_INT64_C(8 << 20);
+  QTest::newRow("4 connections, 8 MB/s") << 4 << Q_INT64_C(8 << 20);
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkUpload()
+{
+  Q_D(ctkXnatBenchmarkTestCase);
+  QFETCH(int, connections);
+  QFETCH(qint64, bandwidth);
+
+  d->Server.setLatency(5);
+  d->Server.setBandwidth(bandwidth);
+  QScopedPointer<ctkXnatSession> session(d->openSession(d->Server.url()));
+
+  ctkXnatProject* project = new ctkXnatProject(session->dataModel());
+  project->setId("P0");
+  ctkXnatResourceFolder* folder = new ctkXnatResourceFolder(project);
+  ctkXnatResource* resource = new ctkXnatResource(folder);
+  resource->setName("UPLOAD");
+
+  QList<ctkXnatFile*> xnatFiles;
+  foreach (const QString& fileName, d->UploadFiles)
+  {
+    ctkXnatFile* xnatFile = new ctkXnatFile(resource);
+    xnatFile->setLocalFilePath(fileName);
+    xnatFile->setName(QFileInfo(fileName).fileName());
+    xnatFiles << xnatFile;
+  }
+
+  // The uploads include the validation of the MD5 digests listed by the server
+  int iterations = 0;
+  QStringList errors;
+  QElapsedTimer timer;
+  timer.start();
+  QBENCHMARK
+  {
+    ctkXnatUploadManager manager(session.data());
+    manager.setMaximumConnections(connections);
+    foreach (ctkXnatFile* xnatFile, xnatFiles)
+    {
+      manager.upload(xnatFile);
+    }
+    manager.waitForFinished();
+    errors << manager.errors();
+    ++iterations;
+  }
+  qint64 elapsed = timer.elapsed();
+
+  QVERIFY2(errors.isEmpty(), qPrintable(errors.join("\n")));
+  foreach (ctkXnatFile* xnatFile, xnatFiles)
+  {
+    QCOMPARE(d->Server.file(xnatFile->resourceUri()).size(), FileSize);
+  }
+  if (elapsed > 0)
+  {
+    qDebug() << (1000.0 * iterations * Files * FileSize / elapsed / (1 << 20)) << "MB/s";
+  }
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkConcurrency_data()
+{
+  QTest::addColumn<int>("requests");
+
+  QTest::newRow("1 concurrent request") << 1;
+  QTest::newRow("2 concurrent requests") << 2;
+  QTest::newRow("4 concurrent requests") << 4;
+  QTest::newRow("6 concurrent requests") << 6;
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::benchmarkConcurrency()
+{
+  Q_D(ctkXnatBenchmarkTestCase);
+  QFETCH(int, requests);
+
+  d->Server.setLatency(20);
+  QScopedPointer<ctkXnatSession> session(d->openSession(d->Server.url()));
+  session->setMaximumConcurrentRequests(requests);
+
+  // The experiment and scan listings of all subjects, sent before waiting for the first reply
+  QStringList resources;
+  for (int p = 0; p < Projects; ++p)
+  {
+    for (int s = 0; s < Subjects; ++s)
+    {
+      QString subjectUri = QString("/data/archive/projects/P%1/subjects/P%1_S%2").arg(p).arg(s);
+      resources << subjectUri + "/experiments";
+      for (int e = 0; e < Experiments; ++e)
+      {
+        resources << QString("%1/experiments/P%2_S%3_E%4/scans").arg(subjectUri).arg(p).arg(s).arg(e);
+      }
+    }
+  }
+
+  int results = 0;
+  d->Server.resetStatistics();
+  QBENCHMARK
+  {
+    QList<QUuid> queryIds;
+    foreach (const QString& resource, resources)
+    {
+      queryIds << session->httpGet(resource);
+    }
+    results = 0;
+    foreach (const QUuid& queryId, queryIds)
+    {
+      results += session->httpSync(queryId).size();
+    }
+  }
+
+  QCOMPARE(results, Projects * Subjects * (Experiments + Experiments * Scans));
+  qDebug() << d->Server.peakConcurrentRequests() << "requests at the same time,"
+           << d->Server.connectionCount() << "connections";
+}
+
+// --------------------------------------------------------------------------
+void ctkXnatBenchmarkTestCase::testCancelFetch()
+{
+  Q_D(ctkXnatBenchmarkTestCase);
+
+  QScopedPointer<ctkXnatSession> session(d->openSession(d->Server.url()));
+  session->dataModel()->fetch();
+  QVERIFY(!session->dataModel()->children().isEmpty());
+  ctkXnatObject* project = session->dataModel()->children().first();
+
+  // A cancelled fetch does not finish, and its reply is discarded
+  d->Server.setLatency(50);
+  QSignalSpy fetchFinishedSpy(session.data(), SIGNAL(fetchFinished(ctkXnatObject*)));
+  project->fetchAsync();
+  project->cancelFetch();
+  QTest::qWait(200);
+  QCOMPARE(fetchFinishedSpy.count(), 0);
+  QVERIFY(!project->isFetched());
+
+  // The next fetch sends the requests again
+  project->fetchAsync();
+  for (int i = 0; i < 100 && fetchFinishedSpy.count() == 0; ++i)
+  {
+    QTest::qWait(20);
+  }
+  QCOMPARE(fetchFinishedSpy.count(), 1);
+  QVERIFY(project->isFetched());
+  QVERIFY(project->children().size() >= Subjects);
+}
+
+// --------------------------------------------------------------------------
+int ctkXnatBenchmark(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  ctkXnatBenchmarkTestCase test;
+  return QTest::qExec(&test, argc, argv);
+}
@@ -0,0 +1,103 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKXNATBENCHMARK_H
+#define CTKXNATBENCHMARK_H
+
+#include <QObject>
+#include <QScopedPointer>
+
+class ctkXnatBenchmarkTestCasePrivate;
+class ctkXnatObject;
+class ctkXnatSession;
+
+/**
+ * @brief Fetches the tree below an object with ctkXnatObject::fetchAsync(), one
+ * level of the tree at a time.
+ */
+class ctkXnatAsyncTreeWalker : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  explicit ctkXnatAsyncTreeWalker(ctkXnatSession* session);
+
+  /// @returns the number of objects below \a root
+  int walk(ctkXnatObject* root);
+
+  Q_SLOT void fetchFinished(ctkXnatObject* object);
+
+private:
+
+  int Pending;
+  int Count;
+};
+
+/**
+ * @brief Measures the client side of ctkXnatSession against a ctkXnatMockServer
+ * with scripted latency and bandwidth.
+ */
+class ctkXnatBenchmarkTestCase : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  explicit ctkXnatBenchmarkTestCase();
+  virtual ~ctkXnatBenchmarkTestCase();
+
+private slots:
+
+  void initTestCase();
+
+  void init();
+
+  void cleanupTestCase();
+
+  void benchmarkTreeWalk_data();
+  void benchmarkTreeWalk();
+
+  void benchmarkListingParsing_data();
+  void benchmarkListingParsing();
+
+  void benchmarkDownload_data();
+  void benchmarkDownload();
+
+  void benchmarkUpload_data();
+  void benchmarkUpload();
+
+  void benchmarkConcurrency_data();
+  void benchmarkConcurrency();
+
+  void testCancelFetch();
+
+private:
+  QScopedPointer<ctkXnatBenchmarkTestCasePrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(ctkXnatBenchmarkTestCase)
+  Q_DISABLE_COPY(ctkXnatBenchmarkTestCase)
+};
+
+// --------------------------------------------------------------------------
+int ctkXnatBenchmark(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,870 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkXnatMockServer.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QMap>
+#include <QRegExp>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+//----------------------------------------------------------------------------
+namespace {
+
+typedef QMap<QString, QString> ctkXnatMockEntry;
+
+const char* const SessionId = "MOCKSESSIONID";
+
+struct ctkXnatMockRequest
+{
+  QByteArray Method;
+  QString Path;
+  QMap<QString, QString> Query;
+  QMap<QByteArray, QByteArray> Headers;
+  QByteArray Body;
+};
+
+struct ctkXnatMockConnection
+{
+  QByteArray Input;
+  bool Replying;
+  bool Closing;
+
+  // the reply to the current request
+  QByteArray Output;
+  int OutputOffset;
+  qint64 DueTime;
+  qint64 SentTime;
+
+  ctkXnatMockConnection()
+    : Replying(false), Closing(false), OutputOffset(0), DueTime(0), SentTime(0)
+  {
+  }
+};
+
+//----------------------------------------------------------------------------
+QString decodeUrlPart(QByteArray part)
+{
+  part.replace('+', ' ');
+  return QUrl::fromPercentEncoding(part);
+}
+
+//----------------------------------------------------------------------------
+QByteArray jsonString(const QString& value)
+{
+  QByteArray result = "\"";
+  QByteArray utf8 = value.toUtf8();
+  for (int i = 0; i < utf8.size(); ++i)
+  {
+    char c = utf8[i];
+    if (c == '"' || c == '\\')
+    {
+      result += '\\';
+      result += c;
+    }
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      result += "\\u00" + QByteArray::number(static_cast<int>(c), 16).rightJustified(2, '0');
+    }
+    else
+    {
+      result += c;
+    }
+  }
+  result += '"';
+  return result;
+}
+
+//----------------------------------------------------------------------------
+QByteArray pseudoRandomData(int size)
+{
+  QByteArray data(size, '\0');
+  quint32 seed = 1;
+  for (int i = 0; i < size; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    data[i] = static_cast<char>(seed >> 16);
+  }
+  return data;
+}
+
+}
+
+//----------------------------------------------------------------------------
+class ctkXnatMockServerPrivate
+{
+public:
+
+  ctkXnatMockServerPrivate()
+    : Latency(0), Bandwidth(0), RequestCount(0), ActiveRequests(0),
+      PeakConcurrentRequests(0), ConnectionCount(0)
+  {
+  }
+
+  bool takeRequest(QByteArray& input, ctkXnatMockRequest& request, bool& valid) const;
+  QByteArray reply(const ctkXnatMockRequest& request);
+  QByteArray listingReply(const QString& path, const ctkXnatMockRequest& request) const;
+  QByteArray fileReply(const QString& path, const ctkXnatMockRequest& request) const;
+  void putFile(const QString& filesPath, const QString& name, const QByteArray& data);
+  void putResource(const QString& resourcesPath, const QString& name);
+  void remove(const QString& path);
+
+  void processRequests(QTcpSocket* socket);
+  void finishReply(QTcpSocket* socket, ctkXnatMockConnection& connection);
+
+  static bool isCollection(const QString& path);
+  static QByteArray statusLine(int status);
+
+  QTcpServer Server;
+  QTimer Timer;
+  QElapsedTimer Clock;
+  QHash<QTcpSocket*, ctkXnatMockConnection> Connections;
+
+  int Latency;
+  qint64 Bandwidth;
+
+  // the listings and file contents by their path
+  QHash<QString, QList<ctkXnatMockEntry> > Listings;
+  QHash<QString, QByteArray> Files;
+
+  int RequestCount;
+  int ActiveRequests;
+  int PeakConcurrentRequests;
+  int ConnectionCount;
+};
+
+//----------------------------------------------------------------------------
+bool ctkXnatMockServerPrivate::takeRequest(QByteArray& input, ctkXnatMockRequest& request,
+                                           bool& valid) const
+{
+  valid = true;
+  int headerEnd = input.indexOf("\r\n\r\n");
+  if (headerEnd < 0)
+  {
+    return false;
+  }
+
+  QList<QByteArray> lines = input.left(headerEnd).split('\n');
+  QList<QByteArray> requestLine = lines.takeFirst().trimmed().split(' ');
+  if (requestLine.size() != 3)
+  {
+    valid = false;
+    return false;
+  }
+
+  request.Headers.clear();
+  foreach (const QByteArray& line, lines)
+  {
+    int colon = line.indexOf(':');
+    if (colon > 0)
+    {
+      request.Headers[line.left(colon).trimmed().toLower()] = line.mid(colon + 1).trimmed();
+    }
+  }
+
+  bool ok = true;
+  int bodySize = request.Headers.value("content-length", "0").toInt(&ok);
+  if (!ok || bodySize < 0)
+  {
+    valid = false;
+    return false;
+  }
+  if (input.size() < headerEnd + 4 + bodySize)
+  {
+    return false;
+  }
+
+  request.Method = requestLine[0];
+  QByteArray target = requestLine[1];
+  int queryStart = target.indexOf('?');
+  request.Path = decodeUrlPart(target.left(queryStart));
+  while (request.Path.endsWith('/'))
+  {
+    request.Path.chop(1);
+  }
+  request.Query.clear();
+  if (queryStart >= 0)
+  {
+    foreach (const QByteArray& item, target.mid(queryStart + 1).split('&'))
+    {
+      int equals = item.indexOf('=');
+      if (equals < 0)
+      {
+        request.Query[decodeUrlPart(item)] = QString();
+      }
+      else
+      {
+        request.Query[decodeUrlPart(item.left(equals))] = decodeUrlPart(item.mid(equals + 1));
+      }
+    }
+  }
+  request.Body = input.mid(headerEnd + 4, bodySize);
+  input.remove(0, headerEnd + 4 + bodySize);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatMockServerPrivate::isCollection(const QString& path)
+{
+  static QRegExp collectionPattern(".*/(subjects|experiments|scans|reconstructions|assessors|resources|files)");
+  return collectionPattern.exactMatch(path);
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkXnatMockServerPrivate::statusLine(int status)
+{
+  switch (status)
+  {
+  case 200:
+    return "HTTP/1.1 200 OK\r\n";
+  case 206:
+    return "HTTP/1.1 206 Partial Content\r\n";
+  case 400:
+    return "HTTP/1.1 400 Bad Request\r\n";
+  case 404:
+    return "HTTP/1.1 404 Not Found\r\n";
+  case 405:
+    return "HTTP/1.1 405 Method Not Allowed\r\n";
+  case 416:
+    return "HTTP/1.1 416 Requested Range Not Satisfiable\r\n";
+  }
+  return "HTTP/1.1 500 Internal Server Error\r\n";
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkXnatMockServerPrivate::reply(const ctkXnatMockRequest& request)
+{
+  const QString& path = request.Path;
+  static QRegExp filePattern("(.*/resources/[^/]+/files)/([^/]+)");
+  static QRegExp resourcePattern("(.*/resources)/([^/]+)");
+
+  if (path == "/data/JSESSION" || path == "/data/auth")
+  {
+    // the expiration cookie of XNAT is the start time and the session time span in milliseconds
+    QByteArray body(SessionId);
+    return statusLine(200) +
+        "Content-Type: text/plain\r\n"
+        "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+        "Set-Cookie: JSESSIONID=" + body + "; Path=/\r\n"
+        "Set-Cookie: SESSION_EXPIRATION_TIME=\"" +
+        QByteArray::number(QDateTime::currentDateTime().toMSecsSinceEpoch()) + ",900000\"; Path=/\r\n"
+        "\r\n" + (request.Method == "HEAD" ? QByteArray() : body);
+  }
+
+  QByteArray body;
+  int status = 200;
+  if (path == "/data/version")
+  {
+    body = "1.6.5";
+  }
+  else if (request.Method == "GET" || request.Method == "HEAD")
+  {
+    if (this->Files.contains(path))
+    {
+      return this->fileReply(path, request);
+    }
+    else if (this->Listings.contains(path) || isCollection(path))
+    {
+      body = this->listingReply(path, request);
+    }
+    else
+    {
+      status = 404;
+    }
+  }
+  else if (request.Method == "PUT")
+  {
+    if (filePattern.exactMatch(path))
+    {
+      this->putFile(filePattern.cap(1), filePattern.cap(2), request.Body);
+    }
+    else if (resourcePattern.exactMatch(path))
+    {
+      this->putResource(resourcePattern.cap(1), resourcePattern.cap(2));
+    }
+  }
+  else if (request.Method == "DELETE")
+  {
+    this->remove(path);
+  }
+  else
+  {
+    status = 405;
+  }
+
+  QByteArray contentType = body.startsWith('{') ? "application/json" : "text/plain";
+  return statusLine(status) +
+      "Content-Type: " + contentType + "\r\n"
+      "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+      "\r\n" + (request.Method == "HEAD" ? QByteArray() : body);
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkXnatMockServerPrivate::listingReply(const QString& path,
+                                                  const ctkXnatMockRequest& request) const
+{
+  QStringList columns;
+  if (request.Query.contains("columns"))
+  {
+    columns = request.Query["columns"].split(',', QString::SkipEmptyParts);
+  }
+  QString xsiType = request.Query.value("xsiType");
+
+  // e.g. {"ResultSet":{"Result": [{"p1":"v1","p2":"v2",...}], "totalRecords":"13"}}
+  QByteArray result = "{\"ResultSet\":{\"Result\":[";
+  int count = 0;
+  foreach (ctkXnatMockEntry entry, this->Listings.value(path))
+  {
+    // image sessions are listed by the xsiType of their modality
+    QString entryType = entry.value("xsiType");
+    if (!xsiType.isEmpty() && entryType != xsiType &&
+        !(xsiType == "xnat:imageSessionData" && entryType.endsWith("SessionData")))
+    {
+      continue;
+    }
+    foreach (const QString& column, columns)
+    {
+      if (!entry.contains(column))
+      {
+        entry[column] = QString();
+      }
+    }
+
+    if (count++ > 0)
+    {
+      result += ',';
+    }
+    result += '{';
+    QMapIterator<QString, QString> itEntry(entry);
+    bool first = true;
+    while (itEntry.hasNext())
+    {
+      itEntry.next();
+      if (!first)
+      {
+        result += ',';
+      }
+      first = false;
+      result += jsonString(itEntry.key()) + ':' + jsonString(itEntry.value());
+    }
+    result += '}';
+  }
+  result += "],\"totalRecords\":\"" + QByteArray::number(count) + "\"}}";
+  return result;
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkXnatMockServerPrivate::fileReply(const QString& path,
+                                               const ctkXnatMockRequest& request) const
+{
+  const QByteArray data = this->Files.value(path);
+  qint64 offset = 0;
+  QByteArray range = request.Headers.value("range");
+  if (range.startsWith("bytes=") && range.endsWith('-'))
+  {
+    offset = range.mid(6, range.size() - 7).toLongLong();
+    if (offset >= data.size() && offset > 0)
+    {
+      return statusLine(416) + "Content-Length: 0\r\n\r\n";
+    }
+  }
+
+  QByteArray header = statusLine(offset > 0 ? 206 : 200) +
+      "Content-Type: application/octet-stream\r\n"
+      "Content-Length: " + QByteArray::number(data.size() - offset) + "\r\n";
+  if (offset > 0)
+  {
+    header += "Content-Range: bytes " + QByteArray::number(offset) + '-' +
+        QByteArray::number(data.size() - 1) + '/' + QByteArray::number(data.size()) + "\r\n";
+  }
+  header += "\r\n";
+  return request.Method == "HEAD" ? header : header + data.mid(offset);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServerPrivate::putFile(const QString& filesPath, const QString& name,
+                                       const QByteArray& data)
+{
+  QString resourcePath = filesPath.left(filesPath.size() - 6);
+  int slash = resourcePath.lastIndexOf('/');
+  this->putResource(resourcePath.left(slash), resourcePath.mid(slash + 1));
+
+  QString path = filesPath + "/" + name;
+  this->Files[path] = data;
+
+  ctkXnatMockEntry entry;
+  entry["Name"] = name;
+  entry["Size"] = QString::number(data.size());
+  entry["URI"] = path;
+  entry["digest"] = QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+  entry["collection"] = resourcePath.mid(slash + 1);
+
+  QList<ctkXnatMockEntry>& files = this->Listings[filesPath];
+  for (int i = 0; i < files.size(); ++i)
+  {
+    if (files[i]["Name"] == name)
+    {
+      files[i] = entry;
+      return;
+    }
+  }
+  files << entry;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServerPrivate::putResource(const QString& resourcesPath, const QString& name)
+{
+  QList<ctkXnatMockEntry>& resources = this->Listings[resourcesPath];
+  foreach (const ctkXnatMockEntry& resource, resources)
+  {
+    if (resource["label"] == name)
+    {
+      return;
+    }
+  }
+  ctkXnatMockEntry entry;
+  entry["label"] = name;
+  resources << entry;
+  this->Listings[resourcesPath + "/" + name + "/files"];
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServerPrivate::remove(const QString& path)
+{
+  QString prefix = path + "/";
+  foreach (const QString& filePath, this->Files.keys())
+  {
+    if (filePath == path || filePath.startsWith(prefix))
+    {
+      this->Files.remove(filePath);
+    }
+  }
+  foreach (const QString& listingPath, this->Listings.keys())
+  {
+    if (listingPath == path || listingPath.startsWith(prefix))
+    {
+      this->Listings.remove(listingPath);
+    }
+  }
+
+  int slash = path.lastIndexOf('/');
+  QString parentPath = path.left(slash);
+  QString name = path.mid(slash + 1);
+  if (this->Listings.contains(parentPath))
+  {
+    QList<ctkXnatMockEntry>& entries = this->Listings[parentPath];
+    for (int i = entries.size() - 1; i >= 0; --i)
+    {
+      if (entries[i].value("Name") == name || entries[i].value("label") == name ||
+          entries[i].value("ID") == name)
+      {
+        entries.removeAt(i);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServerPrivate::processRequests(QTcpSocket* socket)
+{
+  ctkXnatMockConnection& connection = this->Connections[socket];
+  if (connection.Replying)
+  {
+    // HTTP/1.1 replies are sent in the order of the requests
+    return;
+  }
+
+  ctkXnatMockRequest request;
+  bool valid = true;
+  if (!this->takeRequest(connection.Input, request, valid))
+  {
+    if (!valid)
+    {
+      socket->write(statusLine(400) + "Content-Length: 0\r\nConnection: close\r\n\r\n");
+      socket->disconnectFromHost();
+    }
+    return;
+  }
+
+  ++this->RequestCount;
+  ++this->ActiveRequests;
+  this->PeakConcurrentRequests = qMax(this->PeakConcurrentRequests, this->ActiveRequests);
+
+  connection.Replying = true;
+  connection.Closing = request.Headers.value("connection").toLower() == "close";
+  connection.Output = this->reply(request);
+  connection.OutputOffset = 0;
+
+  // an upload is answered after the time its body takes at the bandwidth
+  qint64 delay = this->Latency;
+  if (this->Bandwidth > 0)
+  {
+    delay += request.Body.size() * 1000 / this->Bandwidth;
+  }
+  connection.DueTime = this->Clock.elapsed() + delay;
+  connection.SentTime = connection.DueTime;
+
+  if (delay == 0 && this->Bandwidth == 0)
+  {
+    socket->write(connection.Output);
+    this->finishReply(socket, connection);
+  }
+  else if (!this->Timer.isActive())
+  {
+    this->Timer.start();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServerPrivate::finishReply(QTcpSocket* socket, ctkXnatMockConnection& connection)
+{
+  --this->ActiveRequests;
+  connection.Replying = false;
+  connection.Output.clear();
+  connection.OutputOffset = 0;
+  if (connection.Closing)
+  {
+    socket->disconnectFromHost();
+  }
+  else
+  {
+    this->processRequests(socket);
+  }
+}
+
+//----------------------------------------------------------------------------
+ctkXnatMockServer::ctkXnatMockServer(QObject* parent)
+  : QObject(parent)
+  , d_ptr(new ctkXnatMockServerPrivate())
+{
+  Q_D(ctkXnatMockServer);
+  d->Timer.setInterval(5);
+  d->Clock.start();
+  connect(&d->Server, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+  connect(&d->Timer, SIGNAL(timeout()), this, SLOT(sendReplies()));
+}
+
+//----------------------------------------------------------------------------
+ctkXnatMockServer::~ctkXnatMockServer()
+{
+  this->close();
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatMockServer::listen()
+{
+  Q_D(ctkXnatMockServer);
+  return d->Server.listen(QHostAddress::LocalHost);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServer::close()
+{
+  Q_D(ctkXnatMockServer);
+  d->Server.close();
+  d->Timer.stop();
+  foreach (QTcpSocket* socket, d->Connections.keys())
+  {
+    socket->disconnect(this);
+    socket->abort();
+    delete socket;
+  }
+  d->Connections.clear();
+  d->ActiveRequests = 0;
+}
+
+//----------------------------------------------------------------------------
+QUrl ctkXnatMockServer::url() const
+{
+  Q_D(const ctkXnatMockServer);
+  return QUrl(QString("http://127.0.0.1:%1").arg(d->Server.serverPort()));
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServer::setLatency(int msecs)
+{
+  Q_D(ctkXnatMockServer);
+  d->Latency = qMax(0, msecs);
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatMockServer::latency() const
+{
+  Q_D(const ctkXnatMockServer);
+  return d->Latency;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServer::setBandwidth(qint64 bytesPerSecond)
+{
+  Q_D(ctkXnatMockServer);
+  d->Bandwidth = qMax(Q_INT64_C(0), bytesPerSecond);
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkXnatMockServer::bandwidth() const
+{
+  Q_D(const ctkXnatMockServer);
+  return d->Bandwidth;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServer::populate(int projects, int subjects, int experiments, int scans,
+                                 int files, int fileSize)
+{
+  Q_D(ctkXnatMockServer);
+
+  d->Listings.clear();
+  d->Files.clear();
+
+  // the files share one block of data
+  QByteArray data = pseudoRandomData(fileSize);
+  QString digest = QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+  QString insertDate = "2015-01-01 12:00:00.0";
+
+  int subjectNumber = 0;
+  int experimentNumber = 0;
+  QList<ctkXnatMockEntry>& projectEntries = d->Listings["/data/archive/projects"];
+  for (int p = 0; p < projects; ++p)
+  {
+    QString projectId = QString("P%1").arg(p);
+    QString projectPath = "/data/archive/projects/" + projectId;
+
+    ctkXnatMockEntry project;
+    project["ID"] = projectId;
+    project["name"] = projectId;
+    project["secondary_ID"] = projectId;
+    project["description"] = "Mock project";
+    project["URI"] = "/data/projects/" + projectId;
+    projectEntries << project;
+
+    QList<ctkXnatMockEntry>& subjectEntries = d->Listings[projectPath + "/subjects"];
+    for (int s = 0; s < subjects; ++s)
+    {
+      QString subjectLabel = QString("%1_S%2").arg(projectId).arg(s);
+      QString subjectPath = projectPath + "/subjects/" + subjectLabel;
+      QString subjectId = QString("XNAT_S%1").arg(++subjectNumber, 5, 10, QChar('0'));
+
+      ctkXnatMockEntry subject;
+      subject["ID"] = subjectId;
+      subject["label"] = subjectLabel;
+      subject["project"] = projectId;
+      subject["insert_date"] = insertDate;
+      subject["insert_user"] = "ctk";
+      subject["URI"] = "/data/subjects/" + subjectId;
+      subjectEntries << subject;
+
+      QList<ctkXnatMockEntry>& experimentEntries = d->Listings[subjectPath + "/experiments"];
+      for (int e = 0; e < experiments; ++e)
+      {
+        QString experimentLabel = QString("%1_E%2").arg(subjectLabel).arg(e);
+        QString experimentPath = subjectPath + "/experiments/" + experimentLabel;
+        QString experimentId = QString("XNAT_E%1").arg(++experimentNumber, 5, 10, QChar('0'));
+
+        ctkXnatMockEntry experiment;
+        experiment["ID"] = experimentId;
+        experiment["label"] = experimentLabel;
+        experiment["xsiType"] = "xnat:mrSessionData";
+        experiment["insert_date"] = insertDate;
+        experiment["insert_user"] = "ctk";
+        experiment["URI"] = "/data/experiments/" + experimentId;
+        experiment["date"] = "2015-01-01";
+        experiment["time"] = "12:00:00";
+        experiment["scanner"] = "Mock";
+        experiment["modality"] = "MR";
+        experimentEntries << experiment;
+
+        QList<ctkXnatMockEntry>& scanEntries = d->Listings[experimentPath + "/scans"];
+        for (int c = 1; c <= scans; ++c)
+        {
+          QString scanPath = QString("%1/scans/%2").arg(experimentPath).arg(c);
+
+          ctkXnatMockEntry scan;
+          scan["ID"] = QString::number(c);
+          scan["type"] = "T1";
+          scan["series_description"] = QString("Series %1").arg(c);
+          scan["quality"] = "usable";
+          scan["xsiType"] = "xnat:mrScanData";
+          scan["URI"] = scanPath;
+          scanEntries << scan;
+
+          if (files > 0)
+          {
+            ctkXnatMockEntry resource;
+            resource["label"] = "DICOM";
+            resource["format"] = "DICOM";
+            resource["file_count"] = QString::number(files);
+            d->Listings[scanPath + "/resources"] << resource;
+
+            QString filesPath = scanPath + "/resources/DICOM/files";
+            QList<ctkXnatMockEntry>& fileEntries = d->Listings[filesPath];
+            for (int f = 1; f <= files; ++f)
+            {
+              QString fileName = QString("%1.dcm").arg(f);
+              ctkXnatMockEntry file;
+              file["Name"] = fileName;
+              file["Size"] = QString::number(data.size());
+              file["URI"] = filesPath + "/" + fileName;
+              file["digest"] = digest;
+              file["collection"] = "DICOM";
+              fileEntries << file;
+              d->Files[filesPath + "/" + fileName] = data;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkXnatMockServer::file(const QString& resourceUri) const
+{
+  Q_D(const ctkXnatMockServer);
+  return d->Files.value(resourceUri);
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatMockServer::requestCount() const
+{
+  Q_D(const ctkXnatMockServer);
+  return d->RequestCount;
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatMockServer::peakConcurrentRequests() const
+{
+  Q_D(const ctkXnatMockServer);
+  return d->PeakConcurrentRequests;
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatMockServer::connectionCount() const
+{
+  Q_D(const ctkXnatMockServer);
+  return d->ConnectionCount;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServer::resetStatistics()
+{
+  Q_D(ctkXnatMockServer);
+  d->RequestCount = 0;
+  d->PeakConcurrentRequests = d->ActiveRequests;
+  d->ConnectionCount = 0;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServer::acceptConnections()
+{
+  Q_D(ctkXnatMockServer);
+  while (d->Server.hasPendingConnections())
+  {
+    QTcpSocket* socket = d->Server.nextPendingConnection();
+    ++d->ConnectionCount;
+    d->Connections.insert(socket, ctkXnatMockConnection());
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readRequests()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(removeConnection()));
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServer::readRequests()
+{
+  Q_D(ctkXnatMockServer);
+  QTcpSocket* socket = qobject_cast<QTcpSocket*>(this->sender());
+  if (!socket || !d->Connections.contains(socket))
+  {
+    return;
+  }
+  d->Connections[socket].Input += socket->readAll();
+  d->processRequests(socket);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServer::sendReplies()
+{
+  Q_D(ctkXnatMockServer);
+
+  qint64 now = d->Clock.elapsed();
+  bool replying = false;
+  foreach (QTcpSocket* socket, d->Connections.keys())
+  {
+    ctkXnatMockConnection& connection = d->Connections[socket];
+    if (!connection.Replying)
+    {
+      continue;
+    }
+    replying = true;
+    if (now < connection.DueTime)
+    {
+      continue;
+    }
+
+    int remaining = connection.Output.size() - connection.OutputOffset;
+    qint64 chunkSize = remaining;
+    if (d->Bandwidth > 0)
+    {
+      chunkSize = qMin(chunkSize, d->Bandwidth * (now - connection.SentTime) / 1000);
+      if (chunkSize <= 0)
+      {
+        continue;
+      }
+    }
+    socket->write(connection.Output.constData() + connection.OutputOffset, chunkSize);
+    connection.OutputOffset += chunkSize;
+    connection.SentTime = now;
+    if (connection.OutputOffset == connection.Output.size())
+    {
+      d->finishReply(socket, connection);
+    }
+  }
+
+  if (!replying)
+  {
+    d->Timer.stop();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMockServer::removeConnection()
+{
+  Q_D(ctkXnatMockServer);
+  QTcpSocket* socket = qobject_cast<QTcpSocket*>(this->sender());
+  if (!socket || !d->Connections.contains(socket))
+  {
+    return;
+  }
+  if (d->Connections[socket].Replying)
+  {
+    --d->ActiveRequests;
+  }
+  d->Connections.remove(socket);
+  socket->deleteLater();
+}
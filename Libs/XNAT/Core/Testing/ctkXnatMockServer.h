@@ -0,0 +1,103 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKXNATMOCKSERVER_H
+#define CTKXNATMOCKSERVER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QScopedPointer>
+#include <QString>
+#include <QUrl>
+
+class ctkXnatMockServerPrivate;
+
+/**
+ * @brief Local HTTP server which answers the REST requests of ctkXnatSession
+ * from a generated archive, for tests and benchmarks without an XNAT server.
+ *
+ * The archive is held in memory. The server returns JSON listings of projects,
+ * subjects, experiments, scans, resources and files, and file contents with
+ * Range support. A PUT of a file stores it, and the file appears in the listing
+ * of its resource with its MD5 digest. The connections are kept alive like the
+ * ones of a real server.
+ *
+ * Each reply starts latency() milliseconds after its request is received. It is
+ * then sent at bandwidth() bytes per second and connection. An upload is answered
+ * after the time its body takes at the same bandwidth.
+ */
+class ctkXnatMockServer : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  explicit ctkXnatMockServer(QObject* parent = 0);
+  virtual ~ctkXnatMockServer();
+
+  /// Listens on a free port of the local host.
+  bool listen();
+  void close();
+
+  /// The URL to set as server URL of the login profile.
+  QUrl url() const;
+
+  /// Sets the delay of the replies in milliseconds, 0 by default.
+  void setLatency(int msecs);
+  int latency() const;
+
+  /// Sets the bytes per second of each connection, 0 for no limit, the default.
+  void setBandwidth(qint64 bytesPerSecond);
+  qint64 bandwidth() const;
+
+  /// Replaces the archive by \a projects projects "P<i>", each with \a subjects
+  /// subjects "P<i>_S<j>", each with \a experiments MR sessions "P<i>_S<j>_E<k>",
+  /// each with \a scans scans "1", "2", ... Each scan has a "DICOM" resource
+  /// holding \a files files "<n>.dcm" of \a fileSize pseudo-random bytes.
+  void populate(int projects, int subjects, int experiments, int scans,
+                int files = 0, int fileSize = 0);
+
+  /// The contents of the file with the given resource URI, e.g. one uploaded.
+  QByteArray file(const QString& resourceUri) const;
+
+  /// The number of requests received since the last resetStatistics().
+  int requestCount() const;
+  /// The largest number of requests received and not completely answered yet at
+  /// the same time, across all connections, since the last resetStatistics().
+  int peakConcurrentRequests() const;
+  /// The number of connections accepted since the last resetStatistics().
+  int connectionCount() const;
+  void resetStatistics();
+
+private:
+
+  const QScopedPointer<ctkXnatMockServerPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(ctkXnatMockServer);
+  Q_DISABLE_COPY(ctkXnatMockServer);
+
+  Q_SLOT void acceptConnections();
+  Q_SLOT void readRequests();
+  Q_SLOT void sendReplies();
+  Q_SLOT void removeConnection();
+};
+
+#endif
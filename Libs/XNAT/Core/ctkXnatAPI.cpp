@@ -30,6 +30,9 @@
 #include <QRegExp>
 #include <QUrl>
 #if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QUrlQuery>
 #endif
 
@@ -128,10 +131,42 @@ QList<QVariantMap> ctkXnatAPI::parseXmlResponse(qRestResult* /*restResult*/, con
 // --------------------------------------------------------------------------
 QList<QVariantMap> ctkXnatAPI::parseJsonResponse(qRestResult* restResult, const QByteArray& response)
 {
-  QScriptValue scriptValue = this->ScriptEngine.evaluate("(" + QString(response) + ")");
-
   QList<QVariantMap> result;
 
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+  // The native parser builds the maps directly, evaluating the response as a
+  // script takes seconds for result sets with thousands of entries.
+  QJsonParseError parseError;
+  QJsonDocument document = QJsonDocument::fromJson(response, &parseError);
+  if (parseError.error != QJsonParseError::NoError)
+    {
+    restResult->setError(QString("Bad data: ") + parseError.errorString(), qRestAPI::ResponseParseError);
+    return result;
+    }
+
+  // e.g. {"ResultSet":{"Result": [{"p1":"v1","p2":"v2",...}], "totalRecords":"13"}}
+  QJsonValue data = document.object().value("ResultSet").toObject().value("Result");
+  if (data.isArray())
+    {
+    QJsonArray array = data.toArray();
+    result.reserve(array.size());
+    for (QJsonArray::const_iterator iter = array.constBegin(); iter != array.constEnd(); ++iter)
+      {
+      result.push_back((*iter).toObject().toVariantMap());
+      }
+    }
+  else if (data.isObject())
+    {
+    result.push_back(data.toObject().toVariantMap());
+    }
+  else
+    {
+    restResult->setError(QString("Bad data: ") + response, qRestAPI::ResponseParseError);
+    result.push_back(QVariantMap());
+    }
+#else
+  QScriptValue scriptValue = this->ScriptEngine.evaluate("(" + QString(response) + ")");
+
   // e.g. {"ResultSet":{"Result": [{"p1":"v1","p2":"v2",...}], "totalRecords":"13"}}
   QScriptValue resultSet = scriptValue.property("ResultSet");
   QScriptValue data = resultSet.property("Result");
@@ -154,6 +189,7 @@ QList<QVariantMap> ctkXnatAPI::parseJsonResponse(qRestResult* restResult, const
     {
     qRestAPI::appendScriptValueToVariantMapList(result, data);
     }
+#endif
 
   return result;
 }
@@ -25,8 +25,10 @@
 #include "qRestAPI.h"
 
 #include <QList>
+#if (QT_VERSION < QT_VERSION_CHECK(5,0,0))
 #include <QScriptEngine>
 #include <QScriptValue>
+#endif
 
 /**
  * ctkXnatAPI is a simple interface class to communicate with an XNAT
@@ -56,7 +58,9 @@ private:
 
   QList<QVariantMap> parseJsonResponse(qRestResult* restResult, const QByteArray& response);
 
+#if (QT_VERSION < QT_VERSION_CHECK(5,0,0))
   QScriptEngine ScriptEngine;
+#endif
 
   Q_DISABLE_COPY(ctkXnatAPI)
 };
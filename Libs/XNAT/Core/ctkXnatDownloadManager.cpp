@@ -0,0 +1,431 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkXnatDownloadManager.h"
+
+#include "ctkXnatException.h"
+#include "ctkXnatSession.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUrl>
+
+//----------------------------------------------------------------------------
+namespace {
+
+struct ctkXnatDownloadFile
+{
+  QString Uri;
+  QString Path;
+  QString Md5;
+  qint64 Size;
+  int Attempts;
+};
+
+struct ctkXnatTransfer
+{
+  ctkXnatDownloadFile File;
+  QFile Output;
+  QCryptographicHash Hash;
+  qint64 Offset;
+  bool StatusChecked;
+
+  ctkXnatTransfer(const ctkXnatDownloadFile& file)
+    : File(file), Output(file.Path + ".part"), Hash(QCryptographicHash::Md5)
+    , Offset(0), StatusChecked(false)
+  {}
+};
+
+}
+
+//----------------------------------------------------------------------------
+class ctkXnatDownloadManagerPrivate
+{
+public:
+
+  ctkXnatDownloadManagerPrivate(ctkXnatSession* session)
+    : Session(session), MaximumConnections(4), MaximumAttempts(3)
+    , Running(false), Canceled(false), BytesReceived(0), BytesTotal(0)
+  {}
+
+  ~ctkXnatDownloadManagerPrivate()
+  {
+    qDeleteAll(Transfers);
+  }
+
+  QString relativePath(const QString& filesResourceUri, const QVariantMap& entry) const;
+
+  ctkXnatSession* Session;
+  QNetworkAccessManager NetworkManager;
+  int MaximumConnections;
+  int MaximumAttempts;
+
+  bool Running;
+  bool Canceled;
+  qint64 BytesReceived;
+  qint64 BytesTotal;
+  QStringList Errors;
+
+  QList<ctkXnatDownloadFile> Pending;
+  QHash<QNetworkReply*, ctkXnatTransfer*> Transfers;
+};
+
+//----------------------------------------------------------------------------
+QString ctkXnatDownloadManagerPrivate::relativePath(const QString& filesResourceUri,
+                                                    const QVariantMap& entry) const
+{
+  // e.g. the files of ".../scans/ALL/files" are ".../scans/1/resources/DICOM/files/1.dcm"
+  QString base = filesResourceUri;
+  if (base.endsWith("/ALL/files"))
+  {
+    base.chop(10);
+  }
+  else if (base.endsWith("/files"))
+  {
+    base.chop(6);
+  }
+
+  QString uri = entry["URI"].toString();
+  QString path = uri.startsWith(base + "/") ? uri.mid(base.size() + 1) : entry["Name"].toString();
+  path = QDir::cleanPath(path);
+  if (path.isEmpty() || path.startsWith("..") || QDir::isAbsolutePath(path))
+  {
+    // do not write outside of the target directory
+    return QString();
+  }
+  return path;
+}
+
+//----------------------------------------------------------------------------
+ctkXnatDownloadManager::ctkXnatDownloadManager(ctkXnatSession* session, QObject* parent)
+  : QObject(parent)
+  , d_ptr(new ctkXnatDownloadManagerPrivate(session))
+{
+}
+
+//----------------------------------------------------------------------------
+ctkXnatDownloadManager::~ctkXnatDownloadManager()
+{
+  this->cancel();
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatDownloadManager::setMaximumConnections(int connections)
+{
+  Q_D(ctkXnatDownloadManager);
+  d->MaximumConnections = qMax(1, connections);
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatDownloadManager::maximumConnections() const
+{
+  Q_D(const ctkXnatDownloadManager);
+  return d->MaximumConnections;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatDownloadManager::setMaximumAttempts(int attempts)
+{
+  Q_D(ctkXnatDownloadManager);
+  d->MaximumAttempts = qMax(1, attempts);
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatDownloadManager::maximumAttempts() const
+{
+  Q_D(const ctkXnatDownloadManager);
+  return d->MaximumAttempts;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatDownloadManager::download(const QString& filesResourceUri, const QString& directory)
+{
+  Q_D(ctkXnatDownloadManager);
+  if (d->Running)
+  {
+    throw ctkXnatException("A download is already running.");
+  }
+
+  QUuid queryId = d->Session->httpGet(filesResourceUri);
+  QList<QVariantMap> entries = d->Session->httpSync(queryId);
+
+  d->Pending.clear();
+  d->Errors.clear();
+  d->Canceled = false;
+  d->BytesReceived = 0;
+  d->BytesTotal = 0;
+
+  QDir targetDir(directory);
+  foreach (const QVariantMap& entry, entries)
+  {
+    QString path = d->relativePath(filesResourceUri, entry);
+    if (path.isEmpty())
+    {
+      d->Errors << QString("Invalid file URI %1").arg(entry["URI"].toString());
+      continue;
+    }
+
+    ctkXnatDownloadFile file;
+    file.Uri = entry["URI"].toString();
+    file.Path = targetDir.absoluteFilePath(path);
+    file.Md5 = entry["digest"].toString().toLower();
+    file.Size = entry["Size"].toLongLong();
+    file.Attempts = 0;
+
+    d->BytesTotal += file.Size;
+    if (QFileInfo(file.Path).exists() && (file.Size <= 0 || QFileInfo(file.Path).size() == file.Size))
+    {
+      // downloaded before
+      d->BytesReceived += file.Size;
+      continue;
+    }
+    d->Pending << file;
+  }
+
+  d->Running = true;
+  emit progress(d->BytesReceived, d->BytesTotal);
+
+  // Start the transfers from the event loop, so that the signals of a download
+  // without any pending file are not emitted before this method returns
+  QMetaObject::invokeMethod(this, "finishFile", Qt::QueuedConnection);
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatDownloadManager::isRunning() const
+{
+  Q_D(const ctkXnatDownloadManager);
+  return d->Running;
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatDownloadManager::waitForFinished()
+{
+  Q_D(ctkXnatDownloadManager);
+  if (d->Running)
+  {
+    QEventLoop loop;
+    connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+    loop.exec(QEventLoop::ExcludeUserInputEvents);
+  }
+  return d->Errors.isEmpty() && !d->Canceled;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatDownloadManager::cancel()
+{
+  Q_D(ctkXnatDownloadManager);
+  if (!d->Running) return;
+
+  d->Canceled = true;
+  d->Pending.clear();
+  // aborting a reply emits its finished() signal
+  foreach (QNetworkReply* reply, d->Transfers.keys())
+  {
+    reply->abort();
+  }
+}
+
+//----------------------------------------------------------------------------
+QStringList ctkXnatDownloadManager::errors() const
+{
+  Q_D(const ctkXnatDownloadManager);
+  return d->Errors;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatDownloadManager::readFileData()
+{
+  Q_D(ctkXnatDownloadManager);
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  ctkXnatTransfer* transfer = d->Transfers.value(reply);
+  if (!transfer) return;
+
+  if (!transfer->StatusChecked)
+  {
+    transfer->StatusChecked = true;
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (transfer->Offset > 0 && status == 200)
+    {
+      // the server ignored the range, the whole file is sent
+      transfer->Output.resize(0);
+      transfer->Output.seek(0);
+      transfer->Hash.reset();
+      d->BytesReceived -= transfer->Offset;
+      transfer->Offset = 0;
+    }
+  }
+
+  QByteArray data = reply->readAll();
+  if (data.isEmpty()) return;
+  if (transfer->Output.write(data) != data.size())
+  {
+    reply->abort();
+    return;
+  }
+  transfer->Hash.addData(data);
+  d->BytesReceived += data.size();
+  emit progress(d->BytesReceived, d->BytesTotal);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatDownloadManager::finishFile()
+{
+  Q_D(ctkXnatDownloadManager);
+
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  if (ctkXnatTransfer* transfer = d->Transfers.value(reply))
+  {
+    if (reply->error() == QNetworkReply::NoError)
+    {
+      this->readFileData();
+    }
+    d->Transfers.remove(reply);
+    reply->deleteLater();
+
+    transfer->Output.close();
+    ctkXnatDownloadFile file = transfer->File;
+    QString partPath = transfer->Output.fileName();
+
+    if (d->Canceled)
+    {
+      // keep the partial file for resuming
+    }
+    else if (reply->error() != QNetworkReply::NoError ||
+             transfer->Output.error() != QFile::NoError)
+    {
+      QString error = reply->error() != QNetworkReply::NoError ? reply->errorString()
+                                                                : transfer->Output.errorString();
+      if (file.Attempts < d->MaximumAttempts)
+      {
+        // resumed from the end of the partial file
+        d->Pending.prepend(file);
+      }
+      else
+      {
+        d->Errors << QString("%1: %2").arg(file.Uri, error);
+      }
+    }
+    else if (!file.Md5.isEmpty() && transfer->Hash.result().toHex() != file.Md5.toLatin1())
+    {
+      // the file is transferred again from the start
+      d->BytesReceived -= transfer->Output.size();
+      transfer->Output.remove();
+      if (file.Attempts < d->MaximumAttempts)
+      {
+        d->Pending.prepend(file);
+      }
+      else
+      {
+        d->Errors << QString("%1: MD5 checksum mismatch").arg(file.Uri);
+      }
+    }
+    else
+    {
+      QFile::remove(file.Path);
+      if (QFile::rename(partPath, file.Path))
+      {
+        emit fileDownloaded(file.Path);
+      }
+      else
+      {
+        d->Errors << QString("%1: cannot write %2").arg(file.Uri, file.Path);
+      }
+    }
+    delete transfer;
+  }
+
+  if (!d->Running) return;
+
+  while (!d->Pending.isEmpty() && d->Transfers.size() < d->MaximumConnections)
+  {
+    ctkXnatDownloadFile file = d->Pending.takeFirst();
+    ++file.Attempts;
+
+    ctkXnatTransfer* transfer = new ctkXnatTransfer(file);
+    QDir().mkpath(QFileInfo(file.Path).absolutePath());
+
+    // a partial file larger than the file is not resumed
+    if (file.Size > 0 && transfer->Output.size() > file.Size)
+    {
+      transfer->Output.remove();
+    }
+    if (!transfer->Output.open(QIODevice::ReadWrite))
+    {
+      d->Errors << QString("%1: cannot write %2").arg(file.Uri, transfer->Output.fileName());
+      delete transfer;
+      continue;
+    }
+
+    // the digest covers the partial file as well
+    while (!transfer->Output.atEnd())
+    {
+      transfer->Hash.addData(transfer->Output.read(1 << 20));
+    }
+    transfer->Offset = transfer->Output.size();
+    if (file.Attempts == 1)
+    {
+      // resumed from a previous download
+      d->BytesReceived += transfer->Offset;
+    }
+
+    QNetworkRequest request(QUrl(d->Session->url().toString() + file.Uri));
+    request.setRawHeader("User-Agent", "Qt");
+    request.setRawHeader("Cookie", QString("JSESSIONID=%1").arg(d->Session->sessionId()).toLatin1());
+    if (transfer->Offset > 0)
+    {
+      request.setRawHeader("Range", "bytes=" + QByteArray::number(transfer->Offset) + "-");
+    }
+
+    QNetworkReply* reply = d->NetworkManager.get(request);
+    // bounds the memory of a transfer which is faster than the disk
+    reply->setReadBufferSize(4 << 20);
+    d->Transfers.insert(reply, transfer);
+    connect(reply, SIGNAL(readyRead()), SLOT(readFileData()));
+    connect(reply, SIGNAL(finished()), SLOT(finishFile()));
+    connect(reply, SIGNAL(sslErrors(QList<QSslError>)), SLOT(ignoreSslErrors()));
+  }
+
+  if (d->Pending.isEmpty() && d->Transfers.isEmpty())
+  {
+    d->Running = false;
+    emit finished();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatDownloadManager::ignoreSslErrors()
+{
+  // Like ctkXnatSession, which suppresses the SSL errors of sites with
+  // self-signed certificates
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  if (reply)
+  {
+    reply->ignoreSslErrors();
+  }
+}
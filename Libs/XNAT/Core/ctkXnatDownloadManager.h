@@ -0,0 +1,118 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKXNATDOWNLOADMANAGER_H
+#define CTKXNATDOWNLOADMANAGER_H
+
+#include "ctkXNATCoreExport.h"
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+
+class ctkXnatDownloadManagerPrivate;
+class ctkXnatSession;
+
+/**
+ * @ingroup XNAT_Core
+ *
+ * @brief Downloads the files of an XNAT resource concurrently, as opposed to the
+ * single zip archive requested by ctkXnatSession::download().
+ *
+ * The files are listed by a GET request of a files resource, e.g. the resource URI
+ * of a ctkXnatScanFolder followed by "/ALL/files", and written below the target
+ * directory in the layout of the server. Up to maximumConnections() files are
+ * transferred at the same time; QNetworkAccessManager opens at most six connections
+ * to one server.
+ *
+ * A file is first written to a ".part" file. Interrupted transfers, also of
+ * previous downloads into the same directory, are resumed with a HTTP Range
+ * request, and the file is verified against the MD5 digest of the listing if
+ * the server reports it.
+ */
+class CTK_XNAT_CORE_EXPORT ctkXnatDownloadManager : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  ctkXnatDownloadManager(ctkXnatSession* session, QObject* parent = 0);
+  ~ctkXnatDownloadManager();
+
+  /**
+   * @brief Number of files transferred at the same time, 4 by default.
+   */
+  void setMaximumConnections(int connections);
+  int maximumConnections() const;
+
+  /**
+   * @brief Number of attempts to transfer a file, 3 by default.
+   */
+  void setMaximumAttempts(int attempts);
+  int maximumAttempts() const;
+
+  /**
+   * @brief Lists the files of \a filesResourceUri and starts to download them into
+   * \a directory, without waiting for the transfers.
+   *
+   * @throws ctkXnatException if a download is running or the files could not be listed.
+   */
+  void download(const QString& filesResourceUri, const QString& directory);
+
+  bool isRunning() const;
+
+  /**
+   * @brief Waits for the running download.
+   * @return \c true if all files were downloaded.
+   */
+  bool waitForFinished();
+
+  /**
+   * @brief Aborts the running download, the partial files are kept for resuming.
+   */
+  void cancel();
+
+  /**
+   * @brief The errors of the files which could not be downloaded.
+   */
+  QStringList errors() const;
+
+  Q_SIGNAL void progress(qint64 bytesReceived, qint64 bytesTotal);
+
+  Q_SIGNAL void fileDownloaded(const QString& filePath);
+
+  Q_SIGNAL void finished();
+
+protected:
+
+  const QScopedPointer<ctkXnatDownloadManagerPrivate> d_ptr;
+
+private:
+
+  Q_DECLARE_PRIVATE(ctkXnatDownloadManager)
+  Q_DISABLE_COPY(ctkXnatDownloadManager)
+
+  Q_SLOT void readFileData();
+  Q_SLOT void finishFile();
+  Q_SLOT void ignoreSslErrors();
+};
+
+#endif
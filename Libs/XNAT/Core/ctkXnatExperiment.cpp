@@ -54,7 +54,26 @@ public:
 //    uri.clear();
   }
 
+  QList<ctkXnatObject*> takeResults(ctkXnatSession* session, QUuid& queryId, const QString& schemaType)
+  {
+    QList<ctkXnatObject*> results;
+    try
+    {
+      results = session->httpResults(queryId, schemaType);
+    }
+    catch (const ctkException& e)
+    {
+      qWarning() << QString(e.what());
+    }
+    queryId = QUuid();
+    return results;
+  }
+
 //  QString uri;
+
+  QUuid scansQueryId;
+  QUuid reconstructionsQueryId;
+  QUuid assessorsQueryId;
 };
 
 
@@ -158,69 +177,63 @@ void ctkXnatExperiment::reset()
 }
 
 //----------------------------------------------------------------------------
-void ctkXnatExperiment::fetchImpl()
+QList<QUuid> ctkXnatExperiment::sendFetchRequests()
 {
-  QString scansUri = this->resourceUri() + "/scans";
-  ctkXnatSession* const session = this->session();
-  QUuid scansQueryId = session->httpGet(scansUri);
-
-  QList<ctkXnatObject*> scans;
-  
-  try
+  Q_D(ctkXnatExperiment);
+  if (d->scansQueryId.isNull())
   {
-    scans = session->httpResults(scansQueryId,
-				 ctkXnatDefaultSchemaTypes::XSI_SCAN);
-  }
-  catch (const ctkException& e)
-  {
-    qWarning() << QString(e.what());
+    ctkXnatSession* const session = this->session();
+    d->scansQueryId = session->httpGet(this->resourceUri() + "/scans");
+    d->reconstructionsQueryId = session->httpGet(this->resourceUri() + "/reconstructions");
+    d->assessorsQueryId = session->httpGet(this->resourceUri() + "/assessors");
   }
+  return QList<QUuid>() << d->scansQueryId << d->reconstructionsQueryId << d->assessorsQueryId;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatExperiment::cancelFetchRequests()
+{
+  Q_D(ctkXnatExperiment);
+  d->scansQueryId = QUuid();
+  d->reconstructionsQueryId = QUuid();
+  d->assessorsQueryId = QUuid();
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatExperiment::fetchImpl()
+{
+  Q_D(ctkXnatExperiment);
+
+  // The requests are sent at once, unless fetchAsync() already sent them
+  this->sendFetchRequests();
+  ctkXnatSession* const session = this->session();
 
+  // The fetched children are kept by the folders, which do not need to be fetched again
+  QList<ctkXnatObject*> scans = d->takeResults(session, d->scansQueryId,
+                                               ctkXnatDefaultSchemaTypes::XSI_SCAN);
   if (!scans.isEmpty())
   {
     ctkXnatScanFolder* scanFolder = new ctkXnatScanFolder();
     this->add(scanFolder);
+    scanFolder->addFetchedChildren(scans);
   }
 
-  QString reconstructionsUri = this->resourceUri() + "/reconstructions";
-  QUuid reconstructionsQueryId = session->httpGet(reconstructionsUri);
-
-  QList<ctkXnatObject*> reconstructions;
-  try
-  {
-    reconstructions = session->httpResults(reconstructionsQueryId,
-					   ctkXnatDefaultSchemaTypes::XSI_RECONSTRUCTION);
-  }
-  catch (const ctkException& e)
-  {
-    qWarning() << QString(e.what());
-  }
-  
+  QList<ctkXnatObject*> reconstructions = d->takeResults(session, d->reconstructionsQueryId,
+                                                         ctkXnatDefaultSchemaTypes::XSI_RECONSTRUCTION);
   if (!reconstructions.isEmpty())
   {
     ctkXnatReconstructionFolder* reconstructionFolder = new ctkXnatReconstructionFolder();
     this->add(reconstructionFolder);
+    reconstructionFolder->addFetchedChildren(reconstructions);
   }
 
-  QString assessorsUri = this->resourceUri() + "/assessors";
-  QUuid assessorsQueryId = session->httpGet(assessorsUri);
-  
-  QList<ctkXnatObject*> assessors;
-  
-  try
-  {
-    assessors = session->httpResults(assessorsQueryId,
-				     ctkXnatDefaultSchemaTypes::XSI_ASSESSOR);
-  }
-  catch (const ctkException& e)
-  {
-    qWarning() << QString(e.what());
-  }
-
+  QList<ctkXnatObject*> assessors = d->takeResults(session, d->assessorsQueryId,
+                                                   ctkXnatDefaultSchemaTypes::XSI_ASSESSOR);
   if (!assessors.isEmpty())
   {
     ctkXnatAssessorFolder* assessorFolder = new ctkXnatAssessorFolder(this);
     this->add(assessorFolder);
+    assessorFolder->addFetchedChildren(assessors);
   }
 
   this->fetchResources();
@@ -72,6 +72,9 @@ public:
 
 private:
 
+  virtual QList<QUuid> sendFetchRequests();
+  virtual void cancelFetchRequests();
+
   virtual void fetchImpl();
 
   virtual void downloadImpl(const QString&);
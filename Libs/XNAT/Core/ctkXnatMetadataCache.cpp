@@ -0,0 +1,197 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkXnatMetadataCache.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+
+//----------------------------------------------------------------------------
+namespace {
+
+static const quint32 CACHE_MAGIC = 0x584d4443; // "XMDC"
+static const quint32 CACHE_VERSION = 1;
+
+struct ctkXnatMetadataCacheEntry
+{
+  QList<QVariantMap> Results;
+  QDateTime LastModifiedTime;
+};
+
+QDataStream& operator<<(QDataStream& stream, const ctkXnatMetadataCacheEntry& entry)
+{
+  return stream << entry.Results << entry.LastModifiedTime;
+}
+
+QDataStream& operator>>(QDataStream& stream, ctkXnatMetadataCacheEntry& entry)
+{
+  return stream >> entry.Results >> entry.LastModifiedTime;
+}
+
+}
+
+//----------------------------------------------------------------------------
+class ctkXnatMetadataCachePrivate
+{
+public:
+
+  static QString key(const QString& serverUrl, const QString& resourceUri)
+  {
+    return serverUrl + resourceUri;
+  }
+
+  QString FileName;
+  QHash<QString, ctkXnatMetadataCacheEntry> Entries;
+};
+
+//----------------------------------------------------------------------------
+ctkXnatMetadataCache::ctkXnatMetadataCache(const QString& fileName)
+  : d_ptr(new ctkXnatMetadataCachePrivate())
+{
+  Q_D(ctkXnatMetadataCache);
+  d->FileName = fileName;
+}
+
+//----------------------------------------------------------------------------
+ctkXnatMetadataCache::~ctkXnatMetadataCache()
+{
+}
+
+//----------------------------------------------------------------------------
+QString ctkXnatMetadataCache::fileName() const
+{
+  Q_D(const ctkXnatMetadataCache);
+  return d->FileName;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMetadataCache::setFileName(const QString& fileName)
+{
+  Q_D(ctkXnatMetadataCache);
+  d->FileName = fileName;
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatMetadataCache::load()
+{
+  Q_D(ctkXnatMetadataCache);
+  d->Entries.clear();
+
+  QFile file(d->FileName);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+
+  QDataStream stream(&file);
+  quint32 magic = 0;
+  quint32 version = 0;
+  stream >> magic >> version;
+  if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+  {
+    qWarning() << "ctkXnatMetadataCache: unknown format of" << d->FileName;
+    return false;
+  }
+  stream.setVersion(QDataStream::Qt_4_6);
+
+  QHash<QString, ctkXnatMetadataCacheEntry> entries;
+  stream >> entries;
+  if (stream.status() != QDataStream::Ok)
+  {
+    qWarning() << "ctkXnatMetadataCache: could not read" << d->FileName;
+    return false;
+  }
+  d->Entries = entries;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatMetadataCache::save() const
+{
+  Q_D(const ctkXnatMetadataCache);
+
+  QFile file(d->FileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << "ctkXnatMetadataCache: could not write" << d->FileName << ":" << file.errorString();
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream << CACHE_MAGIC << CACHE_VERSION;
+  stream.setVersion(QDataStream::Qt_4_6);
+  stream << d->Entries;
+  return stream.status() == QDataStream::Ok;
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatMetadataCache::contains(const QString& serverUrl, const QString& resourceUri) const
+{
+  Q_D(const ctkXnatMetadataCache);
+  return d->Entries.contains(d->key(serverUrl, resourceUri));
+}
+
+//----------------------------------------------------------------------------
+QList<QVariantMap> ctkXnatMetadataCache::results(const QString& serverUrl, const QString& resourceUri) const
+{
+  Q_D(const ctkXnatMetadataCache);
+  return d->Entries.value(d->key(serverUrl, resourceUri)).Results;
+}
+
+//----------------------------------------------------------------------------
+QDateTime ctkXnatMetadataCache::lastModifiedTime(const QString& serverUrl, const QString& resourceUri) const
+{
+  Q_D(const ctkXnatMetadataCache);
+  return d->Entries.value(d->key(serverUrl, resourceUri)).LastModifiedTime;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMetadataCache::insert(const QString& serverUrl, const QString& resourceUri,
+                                  const QList<QVariantMap>& results, const QDateTime& lastModifiedTime)
+{
+  Q_D(ctkXnatMetadataCache);
+  ctkXnatMetadataCacheEntry& entry = d->Entries[d->key(serverUrl, resourceUri)];
+  entry.Results = results;
+  entry.LastModifiedTime = lastModifiedTime;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMetadataCache::remove(const QString& serverUrl, const QString& resourceUri)
+{
+  Q_D(ctkXnatMetadataCache);
+  d->Entries.remove(d->key(serverUrl, resourceUri));
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatMetadataCache::clear()
+{
+  Q_D(ctkXnatMetadataCache);
+  d->Entries.clear();
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatMetadataCache::count() const
+{
+  Q_D(const ctkXnatMetadataCache);
+  return d->Entries.size();
+}
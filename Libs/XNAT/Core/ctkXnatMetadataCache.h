@@ -0,0 +1,97 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef ctkXnatMetadataCache_h
+#define ctkXnatMetadataCache_h
+
+#include "ctkXNATCoreExport.h"
+
+#include <QDateTime>
+#include <QList>
+#include <QScopedPointer>
+#include <QVariantMap>
+
+class ctkXnatMetadataCachePrivate;
+
+/**
+ * @ingroup XNAT_Core
+ *
+ * @brief A local cache of the replies to the queries of ctkXnatObject::fetch().
+ *
+ * The entries hold the property maps of a query and the last modification time
+ * reported by the server, keyed by the server URL and the resource URI of the
+ * query, including its parameters. The cache is stored in a compact binary file,
+ * so that the object tree of a new session is fetched from it without waiting for
+ * the server.
+ *
+ * @sa ctkXnatSession::setMetadataCache()
+ */
+class CTK_XNAT_CORE_EXPORT ctkXnatMetadataCache
+{
+public:
+
+  /**
+   * @brief Creates an empty cache which is stored in \a fileName, see load() and save().
+   */
+  ctkXnatMetadataCache(const QString& fileName = QString());
+  ~ctkXnatMetadataCache();
+
+  QString fileName() const;
+  void setFileName(const QString& fileName);
+
+  /**
+   * @brief Reads the entries of the cache file.
+   * @return \c false if the file does not exist or has an unknown format, the cache is empty then.
+   */
+  bool load();
+
+  /**
+   * @brief Writes the entries to the cache file.
+   */
+  bool save() const;
+
+  bool contains(const QString& serverUrl, const QString& resourceUri) const;
+
+  QList<QVariantMap> results(const QString& serverUrl, const QString& resourceUri) const;
+
+  QDateTime lastModifiedTime(const QString& serverUrl, const QString& resourceUri) const;
+
+  void insert(const QString& serverUrl, const QString& resourceUri,
+              const QList<QVariantMap>& results, const QDateTime& lastModifiedTime = QDateTime());
+
+  void remove(const QString& serverUrl, const QString& resourceUri);
+
+  /**
+   * @brief Removes the entries of all servers.
+   */
+  void clear();
+
+  int count() const;
+
+private:
+
+  const QScopedPointer<ctkXnatMetadataCachePrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(ctkXnatMetadataCache)
+  Q_DISABLE_COPY(ctkXnatMetadataCache)
+};
+
+#endif
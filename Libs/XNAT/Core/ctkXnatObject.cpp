@@ -293,11 +293,97 @@ void ctkXnatObject::fetch(bool forceFetch)
   Q_D(ctkXnatObject);
   if (!d->fetched || forceFetch)
   {
-    this->fetchImpl();
+    d->fetchPending = false;
+    ctkXnatSession* session = this->session();
+    session->beginCachedFetch();
+    try
+    {
+      this->fetchImpl();
+    }
+    catch (...)
+    {
+      session->endCachedFetch();
+      throw;
+    }
+    session->endCachedFetch();
     d->fetched = true;
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkXnatObject::fetchAsync(bool forceFetch)
+{
+  Q_D(ctkXnatObject);
+  if (d->fetchPending)
+  {
+    // fetchFinished() will be emitted for the pending fetch
+    return;
+  }
+
+  QList<QUuid> queryIds;
+  if (!d->fetched || forceFetch)
+  {
+    d->fetchPending = true;
+    this->session()->beginCachedFetch();
+    try
+    {
+      queryIds = this->sendFetchRequests();
+    }
+    catch (...)
+    {
+      this->session()->endCachedFetch();
+      throw;
+    }
+    this->session()->endCachedFetch();
+  }
+  this->session()->startFetch(this, queryIds);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatObject::cancelFetch()
+{
+  Q_D(ctkXnatObject);
+  d->fetchPending = false;
+  ctkXnatSession* session = this->session();
+  if (session)
+  {
+    session->cancelFetch(this);
+  }
+  this->cancelFetchRequests();
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatObject::addFetchedChildren(const QList<ctkXnatObject*>& children)
+{
+  Q_D(ctkXnatObject);
+  foreach (ctkXnatObject* child, children)
+  {
+    this->add(child);
+  }
+  d->fetched = true;
+}
+
+//----------------------------------------------------------------------------
+QList<QUuid> ctkXnatObject::sendFetchRequests()
+{
+  return QList<QUuid>();
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatObject::cancelFetchRequests()
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatObject::finishFetch()
+{
+  Q_D(ctkXnatObject);
+  if (d->fetchPending)
+  {
+    this->fetch(true);
+  }
+}
+
 //----------------------------------------------------------------------------
 ctkXnatSession* ctkXnatObject::session() const
 {
@@ -435,6 +521,53 @@ void ctkXnatObject::fetchResources(const QString& path)
   this->add(resFolder);
 }
 
+//----------------------------------------------------------------------------
+QList<ctkXnatObject*> ctkXnatObject::mergeChildren(const QList<ctkXnatObject*>& listedObjects)
+{
+  Q_D(ctkXnatObject);
+  QList<ctkXnatObject*> children;
+  foreach (ctkXnatObject* listedObject, listedObjects)
+  {
+    ctkXnatObject* child = 0;
+    foreach (ctkXnatObject* existingChild, d->children)
+    {
+      if ((existingChild->id().length() != 0 && existingChild->id() == listedObject->id()) ||
+          (existingChild->id().length() == 0 && existingChild->name() == listedObject->name()))
+      {
+        child = existingChild;
+        break;
+      }
+    }
+
+    if (child)
+    {
+      QMapIterator<QString, QString> itProperties(listedObject->properties());
+      while (itProperties.hasNext())
+      {
+        itProperties.next();
+        child->setProperty(itProperties.key(), itProperties.value());
+      }
+      child->setDescription(listedObject->description());
+      child->setLastModifiedTime(listedObject->d_func()->lastModifiedTime);
+      delete listedObject;
+    }
+    else
+    {
+      child = listedObject;
+      this->add(child);
+    }
+    children.push_back(child);
+  }
+  return children;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatObject::setFetched(bool fetched)
+{
+  Q_D(ctkXnatObject);
+  d->fetched = fetched;
+}
+
 //----------------------------------------------------------------------------
 void ctkXnatObject::erase()
 {
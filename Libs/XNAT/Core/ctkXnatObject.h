@@ -30,6 +30,7 @@
 #include <QObject>
 #include <QString>
 #include <QMetaType>
+#include <QUuid>
 
 class ctkXnatResource;
 class ctkXnatSession;
@@ -119,6 +120,23 @@ public:
   /// Fetches the children and the properties of the object.
   void fetch(bool forceFetch = false);
 
+  /// Fetches the children and the properties of the object without waiting for
+  /// the replies of the server. ctkXnatSession::fetchFinished() is emitted for the
+  /// object once they are available, also if the object was already fetched.
+  /// Objects which do not support asynchronous fetching are fetched from the event
+  /// loop, blocking it until the replies are received.
+  void fetchAsync(bool forceFetch = false);
+
+  /// Cancels the pending fetch of fetchAsync(), if any. ctkXnatSession::fetchFinished()
+  /// is not emitted for it, the requests which are not sent yet are dropped and the
+  /// replies of the sent ones are discarded. The object is not fetched afterwards.
+  void cancelFetch();
+
+  /// Adds children which were fetched together with another object, e.g. the
+  /// parent of this object. The object counts as fetched afterwards, so that the
+  /// children are not requested again.
+  virtual void addFetchedChildren(const QList<ctkXnatObject*>& children);
+
   /// Checks if the object exists on the XNAT server.
   bool exists() const;
 
@@ -180,11 +198,22 @@ protected:
   /// Fetches the resources of the object
   virtual void fetchResources(const QString &path = "/resources");
 
+  /// Adds listed objects to the children of the object. The children which have
+  /// the ID of a listed object are kept and get its properties, and the listed
+  /// object is deleted, so that the objects already in use stay valid.
+  /// @returns the children corresponding to the listed objects
+  QList<ctkXnatObject*> mergeChildren(const QList<ctkXnatObject*>& listedObjects);
+
+  /// Marks the children and the properties of the object as fetched, e.g. after
+  /// they were listed by another request than the one of fetchImpl().
+  void setFetched(bool fetched);
+
   /// The private implementation part of the object.
   const QScopedPointer<ctkXnatObjectPrivate> d_ptr;
 
 private:
 
+  friend class ctkXnatSession;
   friend class ctkXnatSessionPrivate;
 
   void setSchemaType(const QString& schemaType);
@@ -192,6 +221,19 @@ private:
   /// The implementation of the fetch mechanism, called by the fetch() function.
   virtual void fetchImpl() = 0;
 
+  /// Sends the requests needed by fetchImpl() without waiting for the replies and
+  /// returns their query IDs, called by the fetchAsync() function. fetchImpl() then
+  /// takes the replies of these requests instead of sending new ones.
+  /// The default implementation sends no requests.
+  virtual QList<QUuid> sendFetchRequests();
+
+  /// Forgets the query IDs returned by sendFetchRequests(), called by cancelFetch()
+  /// once the session discarded their replies. The default implementation does nothing.
+  virtual void cancelFetchRequests();
+
+  /// Calls fetchImpl() once the replies to the requests of fetchAsync() are received.
+  void finishFetch();
+
   /// The implementation of the download mechanism, called by the download(const QString&) function.
   virtual void downloadImpl(const QString&) = 0;
 
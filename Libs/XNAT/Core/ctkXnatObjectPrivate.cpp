@@ -27,6 +27,7 @@
 //----------------------------------------------------------------------------
 ctkXnatObjectPrivate::ctkXnatObjectPrivate()
 : fetched(false)
+, fetchPending(false)
 , parent(0)
 {
 }
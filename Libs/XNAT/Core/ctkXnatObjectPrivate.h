@@ -56,6 +56,9 @@ private:
 
   bool fetched;
 
+  // fetchAsync() was called and fetchImpl() has not been called since
+  bool fetchPending;
+
   ctkXnatObject* parent;
 };
 
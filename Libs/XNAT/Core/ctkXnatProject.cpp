@@ -50,6 +50,8 @@ public:
   }
 
 //  QString uri;
+
+  QUuid subjectsQueryId;
 };
 
 
@@ -145,25 +147,98 @@ void ctkXnatProject::reset()
 }
 
 //----------------------------------------------------------------------------
-void ctkXnatProject::fetchImpl()
+QList<QUuid> ctkXnatProject::sendFetchRequests()
+{
+  Q_D(ctkXnatProject);
+  if (d->subjectsQueryId.isNull())
+  {
+    d->subjectsQueryId = this->sendSubjectsRequest(QStringList());
+  }
+  return QList<QUuid>() << d->subjectsQueryId;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatProject::cancelFetchRequests()
+{
+  Q_D(ctkXnatProject);
+  d->subjectsQueryId = QUuid();
+}
+
+//----------------------------------------------------------------------------
+QUuid ctkXnatProject::sendSubjectsRequest(const QStringList& columns)
 {
   QString subjectsUri = this->resourceUri() + "/subjects";
-  ctkXnatSession* const session = this->session();
   QMap<QString, QString> paramMap;
-  QString arglist = QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11")
-    .arg(ctkXnatObject::ID)
-    .arg(ctkXnatObject::LABEL)
-    .arg(ctkXnatObject::URI)
-    .arg(ctkXnatSubject::INSERT_DATE)
-    .arg(ctkXnatSubject::INSERT_USER)
-    .arg(ctkXnatSubject::DATE_OF_BIRTH)
-    .arg(ctkXnatSubject::PROJECT_ID)
-    .arg(ctkXnatSubject::GENDER)
-    .arg(ctkXnatSubject::HANDEDNESS)
-    .arg(ctkXnatSubject::WEIGHT)
-    .arg(ctkXnatSubject::HEIGHT);
-  paramMap.insert("columns", arglist);
-  QUuid queryId = session->httpGet(subjectsUri, paramMap);
+  QStringList arglist;
+  arglist << ctkXnatObject::ID
+          << ctkXnatObject::LABEL
+          << ctkXnatObject::URI
+          << ctkXnatSubject::INSERT_DATE
+          << ctkXnatSubject::INSERT_USER
+          << ctkXnatSubject::DATE_OF_BIRTH
+          << ctkXnatSubject::PROJECT_ID
+          << ctkXnatSubject::GENDER
+          << ctkXnatSubject::HANDEDNESS
+          << ctkXnatSubject::WEIGHT
+          << ctkXnatSubject::HEIGHT;
+  foreach (const QString& column, columns)
+  {
+    if (!arglist.contains(column))
+    {
+      arglist << column;
+    }
+  }
+  paramMap.insert("columns", arglist.join(","));
+  return this->session()->httpGet(subjectsUri, paramMap);
+}
+
+//----------------------------------------------------------------------------
+QList<ctkXnatSubject*> ctkXnatProject::fetchSubjects(const QStringList& columns)
+{
+  bool fetched = this->isFetched();
+
+  ctkXnatSession* const session = this->session();
+  QUuid queryId = this->sendSubjectsRequest(columns);
+  QList<ctkXnatObject*> listedSubjects = session->httpResults(queryId,
+                                                              ctkXnatDefaultSchemaTypes::XSI_SUBJECT);
+  foreach (ctkXnatObject* subject, listedSubjects)
+  {
+    QString label = subject->name();
+    if (!label.isEmpty())
+    {
+      subject->setId(label);
+    }
+  }
+
+  QList<ctkXnatSubject*> subjects;
+  foreach (ctkXnatObject* child, this->mergeChildren(listedSubjects))
+  {
+    if (ctkXnatSubject* subject = dynamic_cast<ctkXnatSubject*>(child))
+    {
+      subjects.push_back(subject);
+    }
+  }
+
+  // The listing holds all the subjects, like the one of fetchImpl()
+  if (!fetched)
+  {
+    this->fetchResources();
+    this->setFetched(true);
+  }
+  return subjects;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatProject::fetchImpl()
+{
+  Q_D(ctkXnatProject);
+
+  // The request is sent now, unless fetchAsync() already sent it
+  this->sendFetchRequests();
+  QUuid queryId = d->subjectsQueryId;
+  d->subjectsQueryId = QUuid();
+
+  ctkXnatSession* const session = this->session();
   QList<ctkXnatObject*> subjects = session->httpResults(queryId,
                                                         ctkXnatDefaultSchemaTypes::XSI_SUBJECT);
 
@@ -27,8 +27,11 @@
 #include "ctkXnatObject.h"
 #include "ctkXnatDefaultSchemaTypes.h"
 
+#include <QStringList>
+
 class ctkXnatDataModel;
 class ctkXnatProjectPrivate;
+class ctkXnatSubject;
 
 /**
  * @ingroup XNAT_Core
@@ -58,6 +61,14 @@ public:
   QString projectDescription() const;
   void setProjectDescription(const QString &description);
 
+  /// Lists the subjects of the project with their properties in one request.
+  /// The \a columns of the server, e.g. "xnat:subjectData/demographics/education",
+  /// are requested in addition to the ones of fetch(). The subjects which are
+  /// already children of the project get the listed properties. The project counts
+  /// as fetched afterwards; the experiments of the subjects are not fetched.
+  /// @returns the subjects of the project
+  QList<ctkXnatSubject*> fetchSubjects(const QStringList& columns = QStringList());
+
   void reset();
 
   static const QString SECONDARY_ID;
@@ -67,6 +78,11 @@ public:
 
 private:
 
+  virtual QList<QUuid> sendFetchRequests();
+  virtual void cancelFetchRequests();
+
+  QUuid sendSubjectsRequest(const QStringList& columns);
+
   virtual void fetchImpl();
 
   virtual void downloadImpl(const QString&);
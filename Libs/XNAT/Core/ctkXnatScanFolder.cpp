@@ -93,15 +93,20 @@ void ctkXnatScanFolder::fetchImpl()
   QList<ctkXnatObject*> scans = session->httpResults(queryId,
                                                      ctkXnatDefaultSchemaTypes::XSI_SCAN);
 
+  this->addFetchedChildren(scans);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatScanFolder::addFetchedChildren(const QList<ctkXnatObject*>& scans)
+{
   foreach (ctkXnatObject* scan, scans)
   {
     QString series_description = scan->property (ctkXnatScan::SERIES_DESCRIPTION);
     QString label = scan->property (LABEL);
     label = label.isEmpty() ? series_description : label;
     scan->setProperty (LABEL, label);
-    
-    this->add(scan);
   }
+  ctkXnatObject::addFetchedChildren(scans);
 }
 
 //----------------------------------------------------------------------------
@@ -49,6 +49,9 @@ public:
 
   void reset();
 
+  /// Adds the scans, labelled by their series description if they have no label
+  virtual void addFetchedChildren(const QList<ctkXnatObject*>& scans);
+
 private:
 
   friend class qRestResult;
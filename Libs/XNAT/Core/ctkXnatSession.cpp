@@ -28,21 +28,26 @@
 #include "ctkXnatExperiment.h"
 #include "ctkXnatFile.h"
 #include "ctkXnatLoginProfile.h"
+#include "ctkXnatMetadataCache.h"
 #include "ctkXnatObject.h"
 #include "ctkXnatProject.h"
 #include "ctkXnatReconstruction.h"
 #include "ctkXnatResource.h"
 #include "ctkXnatScan.h"
 #include "ctkXnatSubject.h"
+#include "ctkXnatUploadManager.h"
 
-#include <QCryptographicHash>
 #include <QDateTime>
 #include <QTimer>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QScopedPointer>
 #include <QStringBuilder>
 #include <QNetworkCookie>
+#include <QPair>
+#include <QSet>
 
 #include <ctkXnatAPI_p.h>
 #include <qRestResult.h>
@@ -55,6 +60,37 @@ static const char* HEADER_COOKIE = "Cookie";
 static QString SERVER_VERSION = "version";
 static QString SESSION_EXPIRATION_DATE = "expires";
 
+//----------------------------------------------------------------------------
+struct ctkXnatGetRequest
+{
+  QString resource;
+  ctkXnatSession::UrlParameters parameters;
+  ctkXnatSession::HttpRawHeaders rawHeaders;
+  // the equal requests share the reply, empty for requests with raw headers
+  QString key;
+
+  // the query ID of qRestAPI, null while the request is queued
+  QUuid queryId;
+  // the IDs returned by httpGet() whose results are not taken yet
+  QList<QUuid> ids;
+
+  QElapsedTimer timer;
+  qint64 queueTime;
+
+  // the reply is being taken in a local event loop
+  bool taking;
+  bool taken;
+  bool failed;
+  // the session was closed while the reply was being taken
+  bool orphaned;
+  QList<QVariantMap> results;
+  QDateTime lastModifiedTime;
+
+  ctkXnatGetRequest()
+    : queueTime(-1), taking(false), taken(false), failed(false), orphaned(false)
+  {}
+};
+
 //----------------------------------------------------------------------------
 class ctkXnatSessionPrivate
 {
@@ -68,6 +104,33 @@ public:
 
   QMap<QString, QString> sessionProperties;
 
+  // objects of ctkXnatObject::fetchAsync() with the queries they wait for
+  QList<QPair<ctkXnatObject*, QSet<QUuid> > > pendingFetches;
+  // all the queries of the pending fetches, discarded if a fetch is cancelled
+  QHash<ctkXnatObject*, QList<QUuid> > fetchQueries;
+  // queries of cancelled fetches whose replies are discarded when received
+  QSet<QUuid> cancelledQueries;
+
+  // cache of the queries of ctkXnatObject::fetch(), not owned
+  ctkXnatMetadataCache* metadataCache;
+  // the GET requests are cached while fetching
+  int cachedFetchDepth;
+  // cache keys of the queries answered from the cache
+  QHash<QUuid, QString> cachedQueries;
+  // cache keys of the queries whose results are stored in the cache
+  QHash<QUuid, QString> cacheableQueries;
+  // cache keys of the queries revalidating an entry answered from the cache
+  QHash<QUuid, QString> revalidationQueries;
+
+  // the GET requests by the IDs returned by httpGet()
+  QHash<QUuid, ctkXnatGetRequest*> getRequests;
+  // the sent GET requests by their query ID
+  QHash<QUuid, ctkXnatGetRequest*> runningGets;
+  QList<ctkXnatGetRequest*> queuedGets;
+  // the requests which equal requests share until the reply is taken
+  QHash<QString, ctkXnatGetRequest*> sharedGets;
+  int maximumConcurrentRequests;
+
   ctkXnatSession* q;
 
   QTimer* timer;
@@ -95,7 +158,20 @@ public:
 
   void close();
 
-  static QList<ctkXnatObject*> results(qRestResult* restResult, QString schemaType);
+  static QString cacheKey(const QString& resource, const ctkXnatSession::UrlParameters& parameters);
+  void cacheResults(const QString& cacheKey, const QList<QVariantMap>& results,
+                    const QDateTime& lastModifiedTime);
+
+  QUuid scheduleGet(const QString& resource, const ctkXnatSession::UrlParameters& parameters,
+                    const ctkXnatSession::HttpRawHeaders& rawHeaders);
+  void startGet(ctkXnatGetRequest* request);
+  void startQueuedGets();
+  void releaseGet(ctkXnatGetRequest* request, const QUuid& id);
+  bool isFinishedGet(const QUuid& id) const;
+  void clearGets();
+
+  static QList<ctkXnatObject*> results(const QList<QVariantMap>& propertyMaps,
+                                       const QDateTime& lastModifiedTime, QString schemaType);
 };
 
 //----------------------------------------------------------------------------
@@ -104,6 +180,9 @@ ctkXnatSessionPrivate::ctkXnatSessionPrivate(const ctkXnatLoginProfile& loginPro
   : loginProfile(loginProfile)
   , xnat(new ctkXnatAPI())
   , defaultDownloadDir(".")
+  , metadataCache(0)
+  , cachedFetchDepth(0)
+  , maximumConcurrentRequests(6)
   , q(q)
   , timer(new QTimer(q))
   , timeOutWarningPeriod (840000)
@@ -119,6 +198,7 @@ ctkXnatSessionPrivate::ctkXnatSessionPrivate(const ctkXnatLoginProfile& loginPro
 //----------------------------------------------------------------------------
 ctkXnatSessionPrivate::~ctkXnatSessionPrivate()
 {
+  this->clearGets();
 }
 
 //----------------------------------------------------------------------------
@@ -247,14 +327,151 @@ void ctkXnatSessionPrivate::close()
   sessionId.clear();
   this->setDefaultHttpHeaders();
 
+  // the objects are deleted with the data model
+  pendingFetches.clear();
+  fetchQueries.clear();
+  cancelledQueries.clear();
+
+  cachedQueries.clear();
+  cacheableQueries.clear();
+  revalidationQueries.clear();
+  this->clearGets();
+  if (metadataCache && !metadataCache->fileName().isEmpty())
+  {
+    metadataCache->save();
+  }
+
   dataModel.reset();
 }
 
 //----------------------------------------------------------------------------
-QList<ctkXnatObject*> ctkXnatSessionPrivate::results(qRestResult* restResult, QString schemaType)
+QString ctkXnatSessionPrivate::cacheKey(const QString& resource,
+                                        const ctkXnatSession::UrlParameters& parameters)
+{
+  QString key = resource;
+  QMapIterator<QString, QString> it(parameters);
+  QChar separator('?');
+  while (it.hasNext())
+  {
+    it.next();
+    key.append(separator).append(it.key()).append('=').append(it.value());
+    separator = '&';
+  }
+  return key;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSessionPrivate::cacheResults(const QString& cacheKey, const QList<QVariantMap>& results,
+                                         const QDateTime& lastModifiedTime)
+{
+  if (metadataCache)
+  {
+    metadataCache->insert(loginProfile.serverUrl().toString(), cacheKey, results, lastModifiedTime);
+  }
+}
+
+//----------------------------------------------------------------------------
+QUuid ctkXnatSessionPrivate::scheduleGet(const QString& resource,
+                                         const ctkXnatSession::UrlParameters& parameters,
+                                         const ctkXnatSession::HttpRawHeaders& rawHeaders)
+{
+  QString key = rawHeaders.isEmpty() ? cacheKey(resource, parameters) : QString();
+  ctkXnatGetRequest* request = key.isEmpty() ? 0 : sharedGets.value(key);
+  if (!request)
+  {
+    request = new ctkXnatGetRequest();
+    request->resource = resource;
+    request->parameters = parameters;
+    request->rawHeaders = rawHeaders;
+    request->key = key;
+    request->timer.start();
+    if (!key.isEmpty())
+    {
+      sharedGets.insert(key, request);
+    }
+    queuedGets.append(request);
+    this->startQueuedGets();
+  }
+
+  QUuid id = QUuid::createUuid();
+  request->ids.append(id);
+  getRequests.insert(id, request);
+  return id;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSessionPrivate::startGet(ctkXnatGetRequest* request)
+{
+  queuedGets.removeOne(request);
+  request->queueTime = request->timer.restart();
+  request->queryId = xnat->get(request->resource, request->parameters, request->rawHeaders);
+  runningGets.insert(request->queryId, request);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSessionPrivate::startQueuedGets()
+{
+  while (runningGets.size() < maximumConcurrentRequests && !queuedGets.isEmpty())
+  {
+    this->startGet(queuedGets.first());
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSessionPrivate::releaseGet(ctkXnatGetRequest* request, const QUuid& id)
+{
+  getRequests.remove(id);
+  request->ids.removeOne(id);
+  if (request->ids.isEmpty())
+  {
+    if (sharedGets.value(request->key) == request)
+    {
+      sharedGets.remove(request->key);
+    }
+    queuedGets.removeOne(request);
+    if (runningGets.value(request->queryId) == request)
+    {
+      runningGets.remove(request->queryId);
+    }
+    delete request;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatSessionPrivate::isFinishedGet(const QUuid& id) const
+{
+  ctkXnatGetRequest* request = getRequests.value(id);
+  return request && !request->queryId.isNull() && !runningGets.contains(request->queryId);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSessionPrivate::clearGets()
+{
+  foreach (ctkXnatGetRequest* request, getRequests.values().toSet())
+  {
+    if (request->taking)
+    {
+      // deleted by ctkXnatSession::takeResults()
+      request->orphaned = true;
+      request->ids.clear();
+    }
+    else
+    {
+      delete request;
+    }
+  }
+  getRequests.clear();
+  runningGets.clear();
+  queuedGets.clear();
+  sharedGets.clear();
+}
+
+//----------------------------------------------------------------------------
+QList<ctkXnatObject*> ctkXnatSessionPrivate::results(const QList<QVariantMap>& propertyMaps,
+                                                     const QDateTime& lastModifiedTime, QString schemaType)
 {
   QList<ctkXnatObject*> results;
-  foreach (const QVariantMap& propertyMap, restResult->results())
+  foreach (const QVariantMap& propertyMap, propertyMaps)
   {
     QString customSchemaType;
     if (propertyMap.contains("xsiType"))
@@ -312,12 +529,6 @@ QList<ctkXnatObject*> ctkXnatSessionPrivate::results(qRestResult* restResult, QS
       description.append (str + QString ("\t::\t") + var.toString() + "\n");
     }
 
-    QVariant lastModifiedHeader = restResult->rawHeader("Last-Modified");
-    QDateTime lastModifiedTime;
-    if (lastModifiedHeader.isValid())
-    {
-      lastModifiedTime = lastModifiedHeader.toDateTime();
-    }
     if (lastModifiedTime.isValid())
     {
       object->setLastModifiedTime(lastModifiedTime);
@@ -354,6 +565,8 @@ ctkXnatSession::ctkXnatSession(const ctkXnatLoginProfile& loginProfile)
 //  QObject::connect(d->xnat.data(), SIGNAL(uploadFinished()), this, SIGNAL(uploadFinished()));
   QObject::connect(d->xnat.data(), SIGNAL(progress(QUuid,double)),
           this, SIGNAL(progress(QUuid,double)));
+  QObject::connect(d->xnat.data(), SIGNAL(finished(QUuid)),
+          this, SLOT(queryFinished(QUuid)));
 //  QObject::connect(d->xnat.data(), SIGNAL(progress(QUuid,double)),
 //          this, SLOT(onProgress(QUuid,double)));
 
@@ -535,7 +748,30 @@ QUuid ctkXnatSession::httpGet(const QString& resource, const ctkXnatSession::Url
   Q_D(ctkXnatSession);
   d->checkSession();
   d->timer->start(d->timeOutWarningPeriod);
-  return d->xnat->get(resource, parameters, rawHeaders);
+
+  if (!d->metadataCache || d->cachedFetchDepth == 0)
+  {
+    return d->scheduleGet(resource, parameters, rawHeaders);
+  }
+
+  QString cacheKey = d->cacheKey(resource, parameters);
+  QUuid queryId = d->scheduleGet(resource, parameters, rawHeaders);
+  if (d->metadataCache->contains(this->url().toString(), cacheKey))
+  {
+    // The cached results are returned at once and the query revalidates them
+    // in the background
+    d->revalidationQueries.insert(queryId, cacheKey);
+    if (d->isFinishedGet(queryId))
+    {
+      // shares the reply of an equal request
+      this->revalidate(queryId);
+    }
+    QUuid cachedQueryId = QUuid::createUuid();
+    d->cachedQueries.insert(cachedQueryId, cacheKey);
+    return cachedQueryId;
+  }
+  d->cacheableQueries.insert(queryId, cacheKey);
+  return queryId;
 }
 
 //----------------------------------------------------------------------------
@@ -544,13 +780,26 @@ QList<ctkXnatObject*> ctkXnatSession::httpResults(const QUuid& uuid, const QStri
   Q_D(ctkXnatSession);
   d->checkSession();
 
-  QScopedPointer<qRestResult> restResult(d->xnat->takeResult(uuid));
-  if (restResult == NULL)
+  if (d->cachedQueries.contains(uuid))
   {
+    QString cacheKey = d->cachedQueries.take(uuid);
+    return d->results(d->metadataCache->results(this->url().toString(), cacheKey),
+                      d->metadataCache->lastModifiedTime(this->url().toString(), cacheKey), schemaType);
+  }
+
+  QList<QVariantMap> results;
+  QDateTime lastModifiedTime;
+  if (!this->takeResults(uuid, results, lastModifiedTime))
+  {
+    d->cacheableQueries.remove(uuid);
     d->throwXnatException("Http request failed.");
   }
   d->timer->start(d->timeOutWarningPeriod);
-  return d->results(restResult.data(), schemaType);
+  if (d->cacheableQueries.contains(uuid))
+  {
+    d->cacheResults(d->cacheableQueries.take(uuid), results, lastModifiedTime);
+  }
+  return d->results(results, lastModifiedTime, schemaType);
 }
 
 QUuid ctkXnatSession::httpPut(const QString& resource, const ctkXnatSession::UrlParameters& parameters,
@@ -568,16 +817,21 @@ QList<QVariantMap> ctkXnatSession::httpSync(const QUuid& uuid)
   Q_D(ctkXnatSession);
   d->checkSession();
 
+  if (d->cachedQueries.contains(uuid))
+  {
+    return d->metadataCache->results(this->url().toString(), d->cachedQueries.take(uuid));
+  }
+
   QList<QVariantMap> result;
-  qRestResult* restResult = d->xnat->takeResult(uuid);
-  if (restResult == NULL)
+  QDateTime lastModifiedTime;
+  if (!this->takeResults(uuid, result, lastModifiedTime))
   {
+    d->cacheableQueries.remove(uuid);
     d->throwXnatException("Syncing with http request failed.");
   }
-  else
+  else if (d->cacheableQueries.contains(uuid))
   {
-    d->updateExpirationDate(restResult); // restarts session timer as well
-    result = restResult->results();
+    d->cacheResults(d->cacheableQueries.take(uuid), result, lastModifiedTime);
   }
   return result;
 }
@@ -651,76 +905,311 @@ void ctkXnatSession::upload(ctkXnatFile *xnatFile,
 {
   Q_D(ctkXnatSession);
 
-  QFile file(xnatFile->localFilePath());
+  // The MD5 digest of the local file is computed while it is sent, and the
+  // file is removed from the server if the digests differ.
+  ctkXnatUploadManager uploadManager(this);
+  uploadManager.upload(xnatFile, parameters);
+  bool uploaded = uploadManager.waitForFinished();
+
+  d->timer->start(d->timeOutWarningPeriod);
 
-  if (!file.exists())
+  if (!uploaded)
   {
-    QString msg = "Error uploading file! ";
-    msg.append(QString("File \"%1\" does not exist!").arg(xnatFile->localFilePath()));
+    QString msg = "Upload failed! An error occurred during file upload. ";
+    msg.append(uploadManager.errors().join("\n"));
     throw ctkXnatException(msg);
   }
+}
 
-  QUuid queryId = d->xnat->upload(xnatFile->localFilePath(), xnatFile->resourceUri(), parameters);
-  d->xnat->sync(queryId);
+//----------------------------------------------------------------------------
+void ctkXnatSession::processResult(QUuid queryId, QList<QVariantMap> parameters)
+{
+  Q_UNUSED(queryId)
+  Q_UNUSED(parameters)
+}
 
-  // Validating the file upload by requesting the catalog XML
-  // of the parent resource. Unfortunately for XNAT versions <= 1.6.4
-  // this is the only way to get the file's MD5 hash form the server.
-  QString md5Query = xnatFile->parent()->resourceUri();
-  QUuid md5QueryID = this->httpGet(md5Query);
-  QList<QVariantMap> result = this->httpSync(md5QueryID);
+//----------------------------------------------------------------------------
+void ctkXnatSession::startFetch(ctkXnatObject* object, const QList<QUuid>& queryIds)
+{
+  Q_D(ctkXnatSession);
+  QSet<QUuid> pendingQueryIds;
+  foreach (const QUuid& queryId, queryIds)
+  {
+    // the queries answered from the metadata cache or sharing a received
+    // reply do not finish
+    if (!d->cachedQueries.contains(queryId) && !d->isFinishedGet(queryId))
+    {
+      pendingQueryIds.insert(queryId);
+    }
+  }
+  d->pendingFetches.append(qMakePair(object, pendingQueryIds));
+  if (!queryIds.isEmpty())
+  {
+    d->fetchQueries.insert(object, queryIds);
+  }
+  if (pendingQueryIds.isEmpty())
+  {
+    // fetchFinished() is not emitted before fetchAsync() returns
+    QTimer::singleShot(0, this, SLOT(finishFetches()));
+  }
+}
 
-  d->timer->start(d->timeOutWarningPeriod);
+//----------------------------------------------------------------------------
+void ctkXnatSession::cancelFetch(ctkXnatObject* object)
+{
+  Q_D(ctkXnatSession);
+  QMutableListIterator<QPair<ctkXnatObject*, QSet<QUuid> > > iter(d->pendingFetches);
+  while (iter.hasNext())
+  {
+    if (iter.next().first == object)
+    {
+      iter.remove();
+    }
+  }
+
+  foreach (const QUuid& queryId, d->fetchQueries.take(object))
+  {
+    if (d->cachedQueries.remove(queryId))
+    {
+      continue;
+    }
+    d->cacheableQueries.remove(queryId);
+    ctkXnatGetRequest* request = d->getRequests.value(queryId);
+    if (!request)
+    {
+      // not a GET request, or already taken
+      continue;
+    }
+    if (request->queryId.isNull())
+    {
+      // not sent yet, equal requests of other fetches are still sent
+      d->releaseGet(request, queryId);
+    }
+    else if (d->runningGets.value(request->queryId) == request || request->taking)
+    {
+      d->cancelledQueries.insert(queryId);
+    }
+    else
+    {
+      this->discardResults(queryId);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSession::discardResults(const QUuid& queryId)
+{
+  QList<QVariantMap> results;
+  QDateTime lastModifiedTime;
+  this->takeResults(queryId, results, lastModifiedTime);
+}
 
-  QString md5ChecksumRemote ("0");
-  // Newly added files are usually at the end of the catalog
-  // and hence at the end of the result list.
-  // So iterating backward is for performance reasons.
-  QList<QVariantMap>::const_iterator it = result.constEnd()-1;
-  while (it != result.constBegin()-1)
+//----------------------------------------------------------------------------
+bool ctkXnatSession::takeResults(const QUuid& uuid, QList<QVariantMap>& results,
+                                 QDateTime& lastModifiedTime)
+{
+  Q_D(ctkXnatSession);
+
+  ctkXnatGetRequest* request = d->getRequests.value(uuid);
+  if (!request)
   {
-    QVariantMap::const_iterator it2 = (*it).find(xnatFile->name());
-    if (it2 != (*it).constEnd())
+    // not a GET request
+    QScopedPointer<qRestResult> restResult(d->xnat->takeResult(uuid));
+    if (restResult == NULL)
     {
-      md5ChecksumRemote = it2.value().toString();
-      break;
+      return false;
     }
-    --it;
+    d->updateExpirationDate(restResult.data()); // restarts session timer as well
+    results = restResult->results();
+    lastModifiedTime = restResult->rawHeader("Last-Modified").toDateTime();
+    return true;
   }
 
-  QFile localFile(xnatFile->localFilePath());
-  if (localFile.open(QFile::ReadOnly) && md5ChecksumRemote != "0")
+  if (request->taking)
   {
-    QCryptographicHash hash(QCryptographicHash::Md5);
+    // The reply is taken by a call waiting in the event loop of this one, so
+    // the request is sent again
+    ctkXnatGetRequest* copy = new ctkXnatGetRequest();
+    copy->resource = request->resource;
+    copy->parameters = request->parameters;
+    copy->rawHeaders = request->rawHeaders;
+    copy->timer.start();
+    d->releaseGet(request, uuid);
+    request = copy;
+    request->ids.append(uuid);
+    d->getRequests.insert(uuid, request);
+    d->startGet(request);
+  }
 
-#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
-    hash.addData(&localFile);
-#else
-    hash.addData(localFile.readAll());
-#endif
+  if (!request->taken)
+  {
+    if (request->queryId.isNull())
+    {
+      // waited for, so it is not queued any longer
+      d->startGet(request);
+    }
+    // the equal requests sent from now on are sent to the server again
+    if (d->sharedGets.value(request->key) == request)
+    {
+      d->sharedGets.remove(request->key);
+    }
+
+    QUuid queryId = request->queryId;
+    request->taking = true;
+    QScopedPointer<qRestResult> restResult(d->xnat->takeResult(queryId));
+    request->taking = false;
+    request->taken = true;
+    if (request->orphaned)
+    {
+      delete request;
+      return false;
+    }
+
+    if (restResult == NULL)
+    {
+      request->failed = true;
+    }
+    else
+    {
+      d->updateExpirationDate(restResult.data());
+      request->results = restResult->results();
+      request->lastModifiedTime = restResult->rawHeader("Last-Modified").toDateTime();
+    }
 
-    QString md5ChecksumLocal(hash.result().toHex());
-    // Retrieving the md5 checksum on the server and comparing
-    // it with the local file md5 sum
-    if (md5ChecksumLocal != md5ChecksumRemote)
+    if (d->runningGets.contains(queryId))
+    {
+      // the finished signal was not received yet
+      this->queryFinished(queryId);
+    }
+    else
     {
-      // Remove corrupted file from server
-      xnatFile->erase();
-      d->timer->start(d->timeOutWarningPeriod);
-      throw ctkXnatException("Upload failed! An error occurred during file upload.");
+      // the revalidations and discards skipped by queryFinished() while the
+      // reply was taken
+      foreach (const QUuid& id, request->ids)
+      {
+        if (id != uuid && d->revalidationQueries.contains(id))
+        {
+          this->revalidate(id);
+        }
+        else if (id != uuid && d->cancelledQueries.remove(id))
+        {
+          this->discardResults(id);
+        }
+      }
     }
   }
+
+  bool taken = !request->failed;
+  results = request->results;
+  lastModifiedTime = request->lastModifiedTime;
+  d->releaseGet(request, uuid);
+  return taken;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSession::revalidate(const QUuid& queryId)
+{
+  Q_D(ctkXnatSession);
+
+  QString cacheKey = d->revalidationQueries.take(queryId);
+  QList<QVariantMap> results;
+  QDateTime lastModifiedTime;
+  if (this->takeResults(queryId, results, lastModifiedTime) && d->metadataCache &&
+      results != d->metadataCache->results(this->url().toString(), cacheKey))
+  {
+    d->cacheResults(cacheKey, results, lastModifiedTime);
+    emit metadataChanged(cacheKey.section('?', 0, 0));
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSession::queryFinished(const QUuid& queryId)
+{
+  Q_D(ctkXnatSession);
+
+  QList<QUuid> queryIds;
+  bool taking = false;
+  ctkXnatGetRequest* request = d->runningGets.take(queryId);
+  if (request)
+  {
+    emit httpRequestFinished(request->resource, request->queueTime, request->timer.elapsed());
+    queryIds = request->ids;
+    taking = request->taking;
+    d->startQueuedGets();
+  }
   else
   {
-    qWarning()<<"Could not validate file upload! Remote MD5: "<<md5ChecksumRemote;
+    queryIds << queryId;
+  }
+
+  bool fetchReady = false;
+  foreach (const QUuid& id, queryIds)
+  {
+    if (d->revalidationQueries.contains(id))
+    {
+      // revalidated by takeResults() once the reply is taken
+      if (!taking)
+      {
+        this->revalidate(id);
+      }
+      continue;
+    }
+    if (d->cancelledQueries.contains(id))
+    {
+      // discarded by takeResults() once the reply is taken
+      if (!taking)
+      {
+        d->cancelledQueries.remove(id);
+        this->discardResults(id);
+      }
+      continue;
+    }
+
+    for (int i = 0; i < d->pendingFetches.size(); ++i)
+    {
+      QSet<QUuid>& fetchQueryIds = d->pendingFetches[i].second;
+      if (fetchQueryIds.remove(id) && fetchQueryIds.isEmpty())
+      {
+        fetchReady = true;
+      }
+    }
+  }
+  if (fetchReady)
+  {
+    this->finishFetches();
   }
 }
 
 //----------------------------------------------------------------------------
-void ctkXnatSession::processResult(QUuid queryId, QList<QVariantMap> parameters)
+void ctkXnatSession::finishFetches()
 {
-  Q_UNUSED(queryId)
-  Q_UNUSED(parameters)
+  Q_D(ctkXnatSession);
+
+  QList<ctkXnatObject*> objects;
+  QMutableListIterator<QPair<ctkXnatObject*, QSet<QUuid> > > iter(d->pendingFetches);
+  while (iter.hasNext())
+  {
+    if (iter.next().second.isEmpty())
+    {
+      objects.append(iter.value().first);
+      d->fetchQueries.remove(iter.value().first);
+      iter.remove();
+    }
+  }
+
+  // The replies are received, so fetchImpl() takes them without waiting
+  foreach (ctkXnatObject* object, objects)
+  {
+    try
+    {
+      object->finishFetch();
+    }
+    catch (const ctkException& e)
+    {
+      qWarning() << "ctkXnatSession: fetching" << object->resourceUri() << "failed:" << e.what();
+    }
+    emit fetchFinished(object);
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -747,3 +1236,49 @@ void ctkXnatSession::setHttpNetworkProxy(const QNetworkProxy& proxy)
 
   d->xnat->setHttpNetworkProxy(proxy);
 }
+
+//----------------------------------------------------------------------------
+void ctkXnatSession::setMetadataCache(ctkXnatMetadataCache* cache)
+{
+  Q_D(ctkXnatSession);
+  d->metadataCache = cache;
+  d->cachedQueries.clear();
+  d->cacheableQueries.clear();
+  d->revalidationQueries.clear();
+}
+
+//----------------------------------------------------------------------------
+ctkXnatMetadataCache* ctkXnatSession::metadataCache() const
+{
+  Q_D(const ctkXnatSession);
+  return d->metadataCache;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSession::beginCachedFetch()
+{
+  Q_D(ctkXnatSession);
+  ++d->cachedFetchDepth;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSession::endCachedFetch()
+{
+  Q_D(ctkXnatSession);
+  --d->cachedFetchDepth;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSession::setMaximumConcurrentRequests(int requests)
+{
+  Q_D(ctkXnatSession);
+  d->maximumConcurrentRequests = qMax(1, requests);
+  d->startQueuedGets();
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatSession::maximumConcurrentRequests() const
+{
+  Q_D(const ctkXnatSession);
+  return d->maximumConcurrentRequests;
+}
@@ -39,6 +39,7 @@ class ctkXnatSessionPrivate;
 class ctkXnatFile;
 class ctkXnatLoginProfile;
 class ctkXnatDataModel;
+class ctkXnatMetadataCache;
 class ctkXnatObject;
 class ctkXnatResource;
 
@@ -177,6 +178,32 @@ public:
 
   ctkXnatDataModel* dataModel() const;
 
+  /**
+   * @brief Sets a cache for the replies to the GET requests of ctkXnatObject::fetch().
+   *
+   * The queries found in the cache are answered from it at once, and revalidated
+   * by a request in the background. metadataChanged() is emitted for the resources
+   * whose reply differs from the cached one, e.g. to fetch the object again.
+   * The cache is saved to its file when the session is closed.
+   *
+   * @param cache the cache, not owned by the session, or 0 to disable caching.
+   */
+  void setMetadataCache(ctkXnatMetadataCache* cache);
+  ctkXnatMetadataCache* metadataCache() const;
+
+  /**
+   * @brief Sets the number of GET requests sent at the same time, 6 by default.
+   *
+   * The GET requests of httpGet() are queued while this number of them is running,
+   * and an equal request, without raw headers, which is sent before the reply of the
+   * previous one is taken shares its reply instead of being sent again. The requests
+   * go through one QNetworkAccessManager, which keeps the connections to the server
+   * alive between them. A request whose results are waited for by httpSync() or
+   * httpResults() is sent at once.
+   */
+  void setMaximumConcurrentRequests(int requests);
+  int maximumConcurrentRequests() const;
+
   /**
    * @brief TODO
    * @param resource
@@ -251,6 +278,8 @@ public:
   /// \a rawHeaders can be used to set the raw headers of the request to send.
   /// These headers will be set additionally to those defined by the
   /// \a defaultRawHeaders property.
+  /// The upload is validated by the MD5 digest of the file, see ctkXnatUploadManager
+  /// for uploading several files concurrently.
   void upload(ctkXnatFile *xnatFile,
     const UrlParameters& parameters = UrlParameters(),
     const HttpRawHeaders& rawHeaders = HttpRawHeaders());
@@ -292,6 +321,26 @@ public:
    */
   Q_SIGNAL void aboutToTimeOut();
 
+  /**
+   * @brief Signals that the children and properties of an object were fetched by
+   * ctkXnatObject::fetchAsync().
+   */
+  Q_SIGNAL void fetchFinished(ctkXnatObject* object);
+
+  /**
+   * @brief Signals that the reply of the server to a query of \a resourceUri differs
+   * from the one of the metadata cache.
+   */
+  Q_SIGNAL void metadataChanged(const QString& resourceUri);
+
+  /**
+   * @brief Signals that a GET request of httpGet() finished, for diagnostics.
+   * @param resourceUri the resource of the request
+   * @param queueTime the time in milliseconds the request was queued
+   * @param transferTime the time in milliseconds from sending the request to receiving the reply
+   */
+  Q_SIGNAL void httpRequestFinished(const QString& resourceUri, qint64 queueTime, qint64 transferTime);
+
 public slots:
   void processResult(QUuid queryId, QList<QVariantMap> parameters);
   void onProgress(QUuid queryId, double onProgress);
@@ -300,9 +349,50 @@ protected:
   QScopedPointer<ctkXnatSessionPrivate> d_ptr;
 
 private:
+  friend class ctkXnatObject;
+
   Q_DECLARE_PRIVATE(ctkXnatSession)
   Q_DISABLE_COPY(ctkXnatSession)
   Q_SLOT void emitTimeOut();
+
+  /**
+   * @brief Finishes the fetch of \a object once the replies to the given queries are
+   * received, called by ctkXnatObject::fetchAsync().
+   */
+  void startFetch(ctkXnatObject* object, const QList<QUuid>& queryIds);
+
+  /**
+   * @brief Forgets the pending fetch of \a object, called by ctkXnatObject::cancelFetch().
+   * The queued requests of the fetch are not sent, unless an equal request shares
+   * them, and the replies of the sent ones are discarded.
+   */
+  void cancelFetch(ctkXnatObject* object);
+
+  /**
+   * @brief Takes the results of a query without using them.
+   */
+  void discardResults(const QUuid& queryId);
+
+  /**
+   * @brief The GET requests between these calls are answered from the metadata
+   * cache, called by ctkXnatObject while fetching.
+   */
+  void beginCachedFetch();
+  void endCachedFetch();
+
+  /**
+   * @brief Takes the results of a query, also when they are shared by equal GET requests.
+   * @return \c false if the request failed
+   */
+  bool takeResults(const QUuid& uuid, QList<QVariantMap>& results, QDateTime& lastModifiedTime);
+
+  /**
+   * @brief Updates the metadata cache entry revalidated by the given query.
+   */
+  void revalidate(const QUuid& queryId);
+
+  Q_SLOT void queryFinished(const QUuid& queryId);
+  Q_SLOT void finishFetches();
 };
 
 #endif
@@ -61,6 +61,9 @@ public:
 //  QString uri;
 
   QList<ctkXnatProject*> projects;
+
+  QUuid imageSessionDataQueryId;
+  QUuid subjectVariablesDataQueryId;
 };
 
 
@@ -216,12 +219,42 @@ void ctkXnatSubject::reset()
   d->reset();
 }
 
+//----------------------------------------------------------------------------
+QList<QUuid> ctkXnatSubject::sendFetchRequests()
+{
+  Q_D(ctkXnatSubject);
+  if (d->imageSessionDataQueryId.isNull())
+  {
+    d->imageSessionDataQueryId = this->sendImageSessionDataRequest(QStringList());
+    d->subjectVariablesDataQueryId = this->sendSubjectVariablesDataRequest(QStringList());
+  }
+  return QList<QUuid>() << d->imageSessionDataQueryId << d->subjectVariablesDataQueryId;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatSubject::cancelFetchRequests()
+{
+  Q_D(ctkXnatSubject);
+  d->imageSessionDataQueryId = QUuid();
+  d->subjectVariablesDataQueryId = QUuid();
+}
+
 //----------------------------------------------------------------------------
 void ctkXnatSubject::fetchImpl()
 {
+  Q_D(ctkXnatSubject);
+
+  // The requests are sent at once, unless fetchAsync() already sent them
+  this->sendFetchRequests();
+  QUuid imageSessionDataQueryId = d->imageSessionDataQueryId;
+  QUuid subjectVariablesDataQueryId = d->subjectVariablesDataQueryId;
+  d->imageSessionDataQueryId = QUuid();
+  d->subjectVariablesDataQueryId = QUuid();
+
+  ctkXnatSession* const session = this->session();
   QList<ctkXnatObject*> experiments;
-  experiments.append(this->fetchImageSessionData());
-  experiments.append(this->fetchSubjectVariablesData());
+  experiments.append(session->httpResults(imageSessionDataQueryId, ctkXnatDefaultSchemaTypes::XSI_EXPERIMENT));
+  experiments.append(session->httpResults(subjectVariablesDataQueryId, ctkXnatDefaultSchemaTypes::XSI_EXPERIMENT));
 
   foreach (ctkXnatObject* experiment, experiments)
   {
@@ -237,45 +270,96 @@ void ctkXnatSubject::fetchImpl()
 }
 
 //----------------------------------------------------------------------------
-QList<ctkXnatObject*> ctkXnatSubject::fetchImageSessionData()
+QUuid ctkXnatSubject::sendImageSessionDataRequest(const QStringList& columns)
 {
   QString experimentsUri = this->resourceUri() + "/experiments";
   ctkXnatSession* const session = this->session();
   QMap<QString, QString> paramMap;
-  QString arglist = QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10")
-    .arg(ctkXnatObject::ID)
-    .arg(ctkXnatObject::LABEL)
-    .arg(ctkXnatObject::XSI_SCHEMA_TYPE)
-    .arg(INSERT_DATE)
-    .arg(INSERT_USER)
-    .arg(ctkXnatObject::URI)
-    .arg(ctkXnatExperiment::DATE_OF_ACQUISITION)
-    .arg(ctkXnatExperiment::TIME_OF_ACQUISITION)
-    .arg(ctkXnatExperiment::SCANNER_TYPE)
-    .arg(ctkXnatExperiment::IMAGE_MODALITY);
-  paramMap.insert("columns", arglist);
+  QStringList arglist;
+  arglist << ctkXnatObject::ID
+          << ctkXnatObject::LABEL
+          << ctkXnatObject::XSI_SCHEMA_TYPE
+          << INSERT_DATE
+          << INSERT_USER
+          << ctkXnatObject::URI
+          << ctkXnatExperiment::DATE_OF_ACQUISITION
+          << ctkXnatExperiment::TIME_OF_ACQUISITION
+          << ctkXnatExperiment::SCANNER_TYPE
+          << ctkXnatExperiment::IMAGE_MODALITY;
+  foreach (const QString& column, columns)
+  {
+    if (!arglist.contains(column))
+    {
+      arglist << column;
+    }
+  }
+  paramMap.insert("columns", arglist.join(","));
   paramMap.insert(ctkXnatObject::XSI_SCHEMA_TYPE, ctkXnatDefaultSchemaTypes::XSI_IMAGE_SESSION_DATA);
-  QUuid queryId = session->httpGet(experimentsUri, paramMap);
-  return session->httpResults(queryId, ctkXnatDefaultSchemaTypes::XSI_EXPERIMENT);
+  return session->httpGet(experimentsUri, paramMap);
 }
 
 //----------------------------------------------------------------------------
-QList<ctkXnatObject*> ctkXnatSubject::fetchSubjectVariablesData()
+QUuid ctkXnatSubject::sendSubjectVariablesDataRequest(const QStringList& columns)
 {
   QString experimentsUri = this->resourceUri() + "/experiments";
   ctkXnatSession* const session = this->session();
   QMap<QString, QString> paramMap;
-  QString arglist = QString("%1,%2,%3,%4,%5,%6")
-    .arg(ctkXnatObject::ID)
-    .arg(ctkXnatObject::LABEL)
-    .arg(ctkXnatObject::XSI_SCHEMA_TYPE)
-    .arg(INSERT_DATE)
-    .arg(INSERT_USER)
-    .arg(ctkXnatObject::URI);
-  paramMap.insert("columns", arglist);
+  QStringList arglist;
+  arglist << ctkXnatObject::ID
+          << ctkXnatObject::LABEL
+          << ctkXnatObject::XSI_SCHEMA_TYPE
+          << INSERT_DATE
+          << INSERT_USER
+          << ctkXnatObject::URI;
+  foreach (const QString& column, columns)
+  {
+    if (!arglist.contains(column))
+    {
+      arglist << column;
+    }
+  }
+  paramMap.insert("columns", arglist.join(","));
   paramMap.insert(ctkXnatObject::XSI_SCHEMA_TYPE, ctkXnatDefaultSchemaTypes::XSI_SUBJECT_VARIABLE_DATA);
-  QUuid queryId = session->httpGet(experimentsUri, paramMap);
-  return session->httpResults(queryId, ctkXnatDefaultSchemaTypes::XSI_EXPERIMENT);
+  return session->httpGet(experimentsUri, paramMap);
+}
+
+//----------------------------------------------------------------------------
+QList<ctkXnatExperiment*> ctkXnatSubject::fetchExperiments(const QStringList& columns)
+{
+  bool fetched = this->isFetched();
+
+  // Both requests are sent before waiting for the first reply
+  ctkXnatSession* const session = this->session();
+  QUuid imageSessionDataQueryId = this->sendImageSessionDataRequest(columns);
+  QUuid subjectVariablesDataQueryId = this->sendSubjectVariablesDataRequest(columns);
+  QList<ctkXnatObject*> listedExperiments;
+  listedExperiments.append(session->httpResults(imageSessionDataQueryId, ctkXnatDefaultSchemaTypes::XSI_EXPERIMENT));
+  listedExperiments.append(session->httpResults(subjectVariablesDataQueryId, ctkXnatDefaultSchemaTypes::XSI_EXPERIMENT));
+  foreach (ctkXnatObject* experiment, listedExperiments)
+  {
+    QString label = experiment->name();
+    if (!label.isEmpty())
+    {
+      experiment->setId(label);
+    }
+  }
+
+  QList<ctkXnatExperiment*> experiments;
+  foreach (ctkXnatObject* child, this->mergeChildren(listedExperiments))
+  {
+    if (ctkXnatExperiment* experiment = dynamic_cast<ctkXnatExperiment*>(child))
+    {
+      experiments.push_back(experiment);
+    }
+  }
+
+  // The listings hold all the experiments, like the ones of fetchImpl()
+  if (!fetched)
+  {
+    this->fetchResources();
+    this->setFetched(true);
+  }
+  return experiments;
 }
 
 //----------------------------------------------------------------------------
@@ -27,6 +27,9 @@
 #include "ctkXnatObject.h"
 #include "ctkXnatDefaultSchemaTypes.h"
 
+#include <QStringList>
+
+class ctkXnatExperiment;
 class ctkXnatProject;
 class ctkXnatSubjectPrivate;
 
@@ -83,6 +86,15 @@ public:
 
   virtual QString resourceUri() const;
 
+  /// Lists the experiments of the subject with their properties, by one request for
+  /// the image sessions and one for the subject variables. The \a columns of the
+  /// server, e.g. "xnat:mrSessionData/fieldStrength", are requested in addition to
+  /// the ones of fetch(). The experiments which are already children of the subject
+  /// get the listed properties. The subject counts as fetched afterwards; the scans
+  /// of the experiments are not fetched.
+  /// @returns the experiments of the subject
+  QList<ctkXnatExperiment*> fetchExperiments(const QStringList& columns = QStringList());
+
   void reset();
 
   static const QString PROJECT_ID;
@@ -98,10 +110,13 @@ private:
 
   friend class qRestResult;
 
+  virtual QList<QUuid> sendFetchRequests();
+  virtual void cancelFetchRequests();
+
   virtual void fetchImpl();
 
-  QList<ctkXnatObject*> fetchImageSessionData();
-  QList<ctkXnatObject*> fetchSubjectVariablesData();
+  QUuid sendImageSessionDataRequest(const QStringList& columns);
+  QUuid sendSubjectVariablesDataRequest(const QStringList& columns);
 
   virtual void downloadImpl(const QString&);
 
@@ -69,6 +69,14 @@ ctkXnatTreeItem* ctkXnatTreeItem::child(int row)
   return m_ChildItems.value(row);
 }
 
+//----------------------------------------------------------------------------
+ctkXnatTreeItem* ctkXnatTreeItem::takeChild(int row)
+{
+  ctkXnatTreeItem* item = m_ChildItems.takeAt(row);
+  item->m_ParentItem = 0;
+  return item;
+}
+
 //----------------------------------------------------------------------------
 int ctkXnatTreeItem::childCount() const
 {
@@ -42,6 +42,7 @@ public:
   void removeChildren();
 
   ctkXnatTreeItem* child(int row);
+  ctkXnatTreeItem* takeChild(int row);
   int childCount() const;
   int columnCount() const;
   QVariant data(int column) const;
@@ -22,10 +22,16 @@
 #include "ctkXnatTreeModel.h"
 
 #include "ctkXnatDataModel.h"
+#include "ctkXnatException.h"
 #include "ctkXnatObject.h"
+#include "ctkXnatSession.h"
 #include "ctkXnatTreeItem_p.h"
 
+#include <QDebug>
+#include <QHash>
 #include <QList>
+#include <QSet>
+#include <QTimer>
 
 class ctkXnatTreeModelPrivate
 {
@@ -33,6 +39,9 @@ public:
 
   ctkXnatTreeModelPrivate()
     : m_RootItem(new ctkXnatTreeItem())
+    , m_PageSize(100)
+    , m_MaximumPrefetches(2)
+    , m_PageInsertionScheduled(false)
   {
   }
 
@@ -41,8 +50,47 @@ public:
     return static_cast<ctkXnatTreeItem*>(index.internalPointer());
   }
 
+  // false if the item or one of its ancestors was removed from the tree
+  bool isAttached(ctkXnatTreeItem* item) const
+  {
+    while (item != m_RootItem.data())
+    {
+      if (!item->parent() || item->row() < 0)
+      {
+        return false;
+      }
+      item = item->parent();
+    }
+    return true;
+  }
+
+  // the row shown while the children of the item are requested the first time
+  bool hasPlaceholder(ctkXnatTreeItem* item) const
+  {
+    int count = item->childCount();
+    return count > 0 && !item->child(count - 1)->xnatObject();
+  }
+
+  bool isFetching(ctkXnatTreeItem* item) const
+  {
+    return m_FetchingItems.contains(item->xnatObject()) || m_InsertingItems.contains(item);
+  }
+
   QScopedPointer<ctkXnatTreeItem> m_RootItem;
 
+  int m_PageSize;
+  int m_MaximumPrefetches;
+
+  // expanded items waiting for the children of their object
+  QHash<ctkXnatObject*, ctkXnatTreeItem*> m_FetchingItems;
+
+  // items whose children are inserted page by page
+  QList<ctkXnatTreeItem*> m_InsertingItems;
+  bool m_PageInsertionScheduled;
+
+  QList<ctkXnatObject*> m_PrefetchQueue;
+  QSet<ctkXnatObject*> m_Prefetching;
+
 };
 
 //----------------------------------------------------------------------------
@@ -70,10 +118,16 @@ QVariant ctkXnatTreeModel::data(const QModelIndex& index, int role) const
   {
     return QVariant(int(Qt::AlignTop | Qt::AlignLeft));
   }
-  else if (role == Qt::DisplayRole)
+
+  ctkXnatObject* xnatObject = this->xnatObject(index);
+  if (!xnatObject)
   {
-    ctkXnatObject* xnatObject = this->xnatObject(index);
+    // placeholder row
+    return role == Qt::DisplayRole ? QVariant(tr("Loading...")) : QVariant();
+  }
 
+  if (role == Qt::DisplayRole)
+  {
     QString displayData = xnatObject->name();
     if (displayData.isEmpty())
     {
@@ -83,11 +137,11 @@ QVariant ctkXnatTreeModel::data(const QModelIndex& index, int role) const
   }
   else if (role == Qt::ToolTipRole)
   {
-    return this->xnatObject(index)->description();
+    return xnatObject->description();
   }
   else if (role == Qt::UserRole)
   {
-    return QVariant::fromValue<ctkXnatObject*>(this->xnatObject(index));
+    return QVariant::fromValue<ctkXnatObject*>(xnatObject);
   }
 
   return QVariant();
@@ -182,9 +236,25 @@ bool ctkXnatTreeModel::hasChildren(const QModelIndex& index) const
   }
 
   ctkXnatTreeItem* item = d->itemAt(index);
+  if (!item->xnatObject())
+  {
+    // placeholder row
+    return false;
+  }
   return item->xnatObject() || !item->xnatObject()->isFetched() || !item->xnatObject()->children().isEmpty();
 }
 
+//----------------------------------------------------------------------------
+Qt::ItemFlags ctkXnatTreeModel::flags(const QModelIndex& index) const
+{
+  if (index.isValid() && !this->xnatObject(index))
+  {
+    // placeholder row
+    return Qt::NoItemFlags;
+  }
+  return QAbstractItemModel::flags(index);
+}
+
 //----------------------------------------------------------------------------
 bool ctkXnatTreeModel::canFetchMore(const QModelIndex& index) const
 {
@@ -195,7 +265,16 @@ bool ctkXnatTreeModel::canFetchMore(const QModelIndex& index) const
 
   Q_D(const ctkXnatTreeModel);
   ctkXnatTreeItem* item = d->itemAt(index);
-  return !(item->childCount() > 0);
+  if (!item->xnatObject() || d->isFetching(item))
+  {
+    return false;
+  }
+  ctkXnatObject* xnatObject = item->xnatObject();
+  if (!xnatObject->isFetched())
+  {
+    return !(item->childCount() > 0);
+  }
+  return item->childCount() < xnatObject->children().size();
 }
 
 //----------------------------------------------------------------------------
@@ -206,21 +285,32 @@ void ctkXnatTreeModel::fetchMore(const QModelIndex& index)
     return;
   }
 
-  Q_D(const ctkXnatTreeModel);
+  Q_D(ctkXnatTreeModel);
   ctkXnatTreeItem* item = d->itemAt(index);
+  if (!item->xnatObject() || d->isFetching(item))
+  {
+    return;
+  }
 
+  // The children are inserted by fetchFinished(), without blocking the event loop
+  // for the requests
   ctkXnatObject* xnatObject = item->xnatObject();
+  d->m_FetchingItems.insert(xnatObject, item);
+  try
+  {
+    xnatObject->fetchAsync();
+  }
+  catch (const ctkException& e)
+  {
+    d->m_FetchingItems.remove(xnatObject);
+    qWarning() << "ctkXnatTreeModel: fetching" << xnatObject->resourceUri() << "failed:" << e.what();
+    return;
+  }
 
-  xnatObject->fetch();
-
-  QList<ctkXnatObject*> children = xnatObject->children();
-  if (!children.isEmpty())
+  if (!xnatObject->isFetched() && item->childCount() == 0)
   {
-    beginInsertRows(index, 0, children.size() - 1);
-    foreach (ctkXnatObject* child, children)
-    {
-      item->appendChild(new ctkXnatTreeItem(child, item));
-    }
+    beginInsertRows(index, 0, 0);
+    item->appendChild(new ctkXnatTreeItem(0, item));
     endInsertRows();
   }
 }
@@ -319,6 +409,11 @@ void ctkXnatTreeModel::addDataModel(ctkXnatDataModel* dataModel)
 {
   Q_D(ctkXnatTreeModel);
   d->m_RootItem->appendChild(new ctkXnatTreeItem(dataModel, d->m_RootItem.data()));
+
+  ctkXnatSession* session = dataModel->session();
+  connect(session, SIGNAL(fetchFinished(ctkXnatObject*)),
+          this, SLOT(fetchFinished(ctkXnatObject*)), Qt::UniqueConnection);
+  connect(session, SIGNAL(sessionAboutToBeClosed()), this, SLOT(clearFetches()), Qt::UniqueConnection);
 }
 
 //----------------------------------------------------------------------------
@@ -338,6 +433,10 @@ bool ctkXnatTreeModel::removeAllRows(const QModelIndex& parent)
   }
 
   ctkXnatObject* xnatObject = this->xnatObject(parent);
+  if (!xnatObject)
+  {
+    return false;
+  }
 
   // nt: not sure why the parent.row() is used here instead of the first item in list
   // that is xnatObject->children()[0];
@@ -389,3 +488,222 @@ void ctkXnatTreeModel::addChildNode(const QModelIndex &index, ctkXnatObject* chi
   item->appendChild(new ctkXnatTreeItem(child, item));
   endInsertRows();
 }
+
+//----------------------------------------------------------------------------
+void ctkXnatTreeModel::setPageSize(int pageSize)
+{
+  Q_D(ctkXnatTreeModel);
+  d->m_PageSize = qMax(1, pageSize);
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatTreeModel::pageSize() const
+{
+  Q_D(const ctkXnatTreeModel);
+  return d->m_PageSize;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatTreeModel::setMaximumPrefetches(int prefetches)
+{
+  Q_D(ctkXnatTreeModel);
+  d->m_MaximumPrefetches = qMax(0, prefetches);
+  if (d->m_MaximumPrefetches == 0)
+  {
+    d->m_PrefetchQueue.clear();
+  }
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatTreeModel::maximumPrefetches() const
+{
+  Q_D(const ctkXnatTreeModel);
+  return d->m_MaximumPrefetches;
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatTreeModel::isFetching(const QModelIndex& index) const
+{
+  if (!index.isValid())
+  {
+    return false;
+  }
+
+  Q_D(const ctkXnatTreeModel);
+  return d->isFetching(d->itemAt(index));
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatTreeModel::fetchFinished(ctkXnatObject* xnatObject)
+{
+  Q_D(ctkXnatTreeModel);
+
+  if (d->m_Prefetching.remove(xnatObject))
+  {
+    this->startPrefetches();
+  }
+
+  ctkXnatTreeItem* item = d->m_FetchingItems.take(xnatObject);
+  if (!item || !d->isAttached(item))
+  {
+    this->startPrefetches();
+    return;
+  }
+
+  this->removePlaceholder(item);
+  d->m_InsertingItems.append(item);
+  this->insertPages();
+
+  if (d->m_MaximumPrefetches > 0)
+  {
+    // The children of the first page are the visible ones, the ones of the last
+    // expanded item are prefetched instead of the previous ones
+    d->m_PrefetchQueue.clear();
+    foreach (ctkXnatObject* child, xnatObject->children().mid(0, d->m_PageSize))
+    {
+      if (!child->isFetched())
+      {
+        d->m_PrefetchQueue.append(child);
+      }
+    }
+    this->startPrefetches();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatTreeModel::insertPages()
+{
+  Q_D(ctkXnatTreeModel);
+  d->m_PageInsertionScheduled = false;
+
+  // One page of each item per event loop iteration
+  QMutableListIterator<ctkXnatTreeItem*> iter(d->m_InsertingItems);
+  while (iter.hasNext())
+  {
+    ctkXnatTreeItem* item = iter.next();
+    if (!d->isAttached(item))
+    {
+      iter.remove();
+      continue;
+    }
+
+    QList<ctkXnatObject*> children = item->xnatObject()->children();
+    int first = item->childCount();
+    int last = qMin(children.size(), first + d->m_PageSize) - 1;
+    if (last >= first)
+    {
+      beginInsertRows(this->createIndex(item->row(), 0, item), first, last);
+      for (int i = first; i <= last; ++i)
+      {
+        item->appendChild(new ctkXnatTreeItem(children[i], item));
+      }
+      endInsertRows();
+    }
+
+    if (item->childCount() >= children.size())
+    {
+      iter.remove();
+    }
+  }
+
+  if (!d->m_InsertingItems.isEmpty() && !d->m_PageInsertionScheduled)
+  {
+    d->m_PageInsertionScheduled = true;
+    QTimer::singleShot(0, this, SLOT(insertPages()));
+  }
+  else if (d->m_InsertingItems.isEmpty())
+  {
+    this->startPrefetches();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatTreeModel::startPrefetches()
+{
+  Q_D(ctkXnatTreeModel);
+  if (!d->m_FetchingItems.isEmpty() || !d->m_InsertingItems.isEmpty())
+  {
+    // the requests of the expanded items go first
+    return;
+  }
+  while (d->m_Prefetching.size() < d->m_MaximumPrefetches && !d->m_PrefetchQueue.isEmpty())
+  {
+    ctkXnatObject* xnatObject = d->m_PrefetchQueue.takeFirst();
+    if (xnatObject->isFetched() || d->m_Prefetching.contains(xnatObject))
+    {
+      continue;
+    }
+
+    d->m_Prefetching.insert(xnatObject);
+    try
+    {
+      xnatObject->fetchAsync();
+    }
+    catch (const ctkException& e)
+    {
+      d->m_Prefetching.remove(xnatObject);
+      qWarning() << "ctkXnatTreeModel: prefetching" << xnatObject->resourceUri() << "failed:" << e.what();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatTreeModel::cancelFetch(const QModelIndex& index)
+{
+  if (!index.isValid())
+  {
+    return;
+  }
+
+  Q_D(ctkXnatTreeModel);
+  ctkXnatTreeItem* item = d->itemAt(index);
+  ctkXnatObject* xnatObject = item->xnatObject();
+  if (!xnatObject)
+  {
+    return;
+  }
+
+  if (d->m_FetchingItems.value(xnatObject) == item)
+  {
+    d->m_FetchingItems.remove(xnatObject);
+    d->m_Prefetching.remove(xnatObject);
+    xnatObject->cancelFetch();
+    this->removePlaceholder(item);
+  }
+  d->m_InsertingItems.removeAll(item);
+
+  // The children of a collapsed item are not prefetched, unless they are expanded
+  foreach (ctkXnatObject* child, xnatObject->children())
+  {
+    d->m_PrefetchQueue.removeAll(child);
+    if (!d->m_FetchingItems.contains(child) && d->m_Prefetching.remove(child))
+    {
+      child->cancelFetch();
+    }
+  }
+  this->startPrefetches();
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatTreeModel::removePlaceholder(ctkXnatTreeItem* item)
+{
+  Q_D(ctkXnatTreeModel);
+  if (d->hasPlaceholder(item))
+  {
+    int row = item->childCount() - 1;
+    beginRemoveRows(this->createIndex(item->row(), 0, item), row, row);
+    delete item->takeChild(row);
+    endRemoveRows();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatTreeModel::clearFetches()
+{
+  Q_D(ctkXnatTreeModel);
+  // the objects are deleted with the data model of the session
+  d->m_FetchingItems.clear();
+  d->m_InsertingItems.clear();
+  d->m_PrefetchQueue.clear();
+  d->m_Prefetching.clear();
+}
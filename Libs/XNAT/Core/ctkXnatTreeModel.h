@@ -28,10 +28,21 @@
 
 class ctkXnatObject;
 class ctkXnatDataModel;
+class ctkXnatTreeItem;
 class ctkXnatTreeModelPrivate;
 
 /**
  * @ingroup XNAT_Core
+ *
+ * The children of an item are fetched with ctkXnatObject::fetchAsync() when the
+ * item is expanded, and inserted in pages of pageSize() rows from the event loop.
+ * A placeholder row, which has no XNAT object, is shown while the children are
+ * requested the first time. cancelFetch() drops the requests of an item, e.g.
+ * when it is collapsed.
+ * The children of the expanded items are then fetched speculatively, by at most
+ * maximumPrefetches() requests at the same time, so that expanding them does not
+ * wait for the server. These requests are only sent while no expanded item is
+ * being fetched or inserted.
  */
 class CTK_XNAT_CORE_EXPORT ctkXnatTreeModel : public QAbstractItemModel
 {
@@ -47,6 +58,7 @@ public:
   virtual int rowCount(const QModelIndex& parent) const;
   virtual int columnCount(const QModelIndex& parent) const;
   virtual bool hasChildren(const QModelIndex& parent) const;
+  virtual Qt::ItemFlags flags(const QModelIndex& index) const;
   virtual bool canFetchMore(const QModelIndex& parent) const;
   virtual void fetchMore(const QModelIndex& parent);
 
@@ -67,8 +79,39 @@ public:
 
   void addChildNode(const QModelIndex& index, ctkXnatObject *child);
 
+  /**
+   * @brief Number of rows inserted at once, 100 by default.
+   */
+  void setPageSize(int pageSize);
+  int pageSize() const;
+
+  /**
+   * @brief Number of objects prefetched at the same time, 2 by default, 0 to disable prefetching.
+   */
+  void setMaximumPrefetches(int prefetches);
+  int maximumPrefetches() const;
+
+  /**
+   * @brief Tells if the children of the item are being fetched or inserted.
+   */
+  bool isFetching(const QModelIndex& index) const;
+
+  /**
+   * @brief Cancels the fetch and the insertion of the children of the item, and
+   * the prefetches of their children. Rows inserted so far are kept, the others are
+   * fetched again by the next fetchMore().
+   */
+  Q_SLOT void cancelFetch(const QModelIndex& index);
+
 private:
 
+  Q_SLOT void fetchFinished(ctkXnatObject* xnatObject);
+  Q_SLOT void insertPages();
+  Q_SLOT void clearFetches();
+
+  void startPrefetches();
+  void removePlaceholder(ctkXnatTreeItem* item);
+
   const QScopedPointer<ctkXnatTreeModelPrivate> d_ptr;
 
   Q_DECLARE_PRIVATE(ctkXnatTreeModel)
@@ -0,0 +1,427 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkXnatUploadManager.h"
+
+#include "ctkXnatException.h"
+#include "ctkXnatFile.h"
+#include "ctkXnatSession.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QEventLoop>
+#include <QFile>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUrl>
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+#include <QUrlQuery>
+#endif
+
+//----------------------------------------------------------------------------
+namespace {
+
+/// Reads a file for the transfer and computes its MD5 digest from the data read.
+class ctkXnatHashingFile : public QIODevice
+{
+public:
+
+  ctkXnatHashingFile(const QString& fileName)
+    : File(fileName), Hash(QCryptographicHash::Md5), HashedBytes(0)
+  {}
+
+  virtual bool open(OpenMode mode)
+  {
+    Q_UNUSED(mode)
+    if (!File.open(QIODevice::ReadOnly))
+    {
+      this->setErrorString(File.errorString());
+      return false;
+    }
+    // unbuffered, so that the position of the file is the position of the device
+    return QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+  }
+
+  virtual void close()
+  {
+    File.close();
+    QIODevice::close();
+  }
+
+  virtual qint64 size() const
+  {
+    return File.size();
+  }
+
+  virtual bool seek(qint64 pos)
+  {
+    return File.seek(pos) && QIODevice::seek(pos);
+  }
+
+  /// The digest of the file, empty unless the whole file was read.
+  QByteArray md5() const
+  {
+    return HashedBytes == File.size() ? Hash.result().toHex() : QByteArray();
+  }
+
+protected:
+
+  virtual qint64 readData(char* data, qint64 maxSize)
+  {
+    qint64 pos = File.pos();
+    qint64 bytesRead = File.read(data, maxSize);
+    // data which is sent again, e.g. after a redirection, is not hashed twice
+    if (bytesRead > 0 && pos == HashedBytes)
+    {
+      Hash.addData(data, static_cast<int>(bytesRead));
+      HashedBytes += bytesRead;
+    }
+    return bytesRead;
+  }
+
+  virtual qint64 writeData(const char* /*data*/, qint64 /*maxSize*/)
+  {
+    return -1;
+  }
+
+private:
+
+  QFile File;
+  mutable QCryptographicHash Hash;
+  qint64 HashedBytes;
+};
+
+struct ctkXnatUpload
+{
+  ctkXnatFile* XnatFile;
+  QUrl Url;
+  ctkXnatHashingFile Device;
+  qint64 BytesSent;
+
+  ctkXnatUpload(ctkXnatFile* xnatFile)
+    : XnatFile(xnatFile), Device(xnatFile->localFilePath()), BytesSent(0)
+  {}
+};
+
+}
+
+//----------------------------------------------------------------------------
+class ctkXnatUploadManagerPrivate
+{
+public:
+
+  ctkXnatUploadManagerPrivate(ctkXnatSession* session)
+    : Session(session), MaximumConnections(4), Running(false)
+    , BytesSent(0), BytesTotal(0)
+  {}
+
+  ~ctkXnatUploadManagerPrivate()
+  {
+    qDeleteAll(Pending);
+    qDeleteAll(Transfers);
+    qDeleteAll(Uploaded);
+  }
+
+  ctkXnatSession* Session;
+  QNetworkAccessManager NetworkManager;
+  int MaximumConnections;
+
+  bool Running;
+  qint64 BytesSent;
+  qint64 BytesTotal;
+  QStringList Errors;
+
+  QList<ctkXnatUpload*> Pending;
+  QHash<QNetworkReply*, ctkXnatUpload*> Transfers;
+  /// Transferred, to be validated
+  QList<ctkXnatUpload*> Uploaded;
+};
+
+//----------------------------------------------------------------------------
+ctkXnatUploadManager::ctkXnatUploadManager(ctkXnatSession* session, QObject* parent)
+  : QObject(parent)
+  , d_ptr(new ctkXnatUploadManagerPrivate(session))
+{
+}
+
+//----------------------------------------------------------------------------
+ctkXnatUploadManager::~ctkXnatUploadManager()
+{
+  Q_D(ctkXnatUploadManager);
+  foreach (QNetworkReply* reply, d->Transfers.keys())
+  {
+    reply->disconnect(this);
+    reply->abort();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatUploadManager::setMaximumConnections(int connections)
+{
+  Q_D(ctkXnatUploadManager);
+  d->MaximumConnections = qMax(1, connections);
+}
+
+//----------------------------------------------------------------------------
+int ctkXnatUploadManager::maximumConnections() const
+{
+  Q_D(const ctkXnatUploadManager);
+  return d->MaximumConnections;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatUploadManager::upload(ctkXnatFile* xnatFile, const UrlParameters& parameters)
+{
+  Q_D(ctkXnatUploadManager);
+
+  if (!QFile::exists(xnatFile->localFilePath()))
+  {
+    QString msg = "Error uploading file! ";
+    msg.append(QString("File \"%1\" does not exist!").arg(xnatFile->localFilePath()));
+    throw ctkXnatException(msg);
+  }
+
+  if (!d->Running)
+  {
+    d->Errors.clear();
+    d->BytesSent = 0;
+    d->BytesTotal = 0;
+    d->Running = true;
+  }
+
+  ctkXnatUpload* upload = new ctkXnatUpload(xnatFile);
+  upload->Url = QUrl(d->Session->url().toString() + xnatFile->resourceUri());
+#if (QT_VERSION < QT_VERSION_CHECK(5,0,0))
+  foreach (const QString& key, parameters.keys())
+  {
+    upload->Url.addQueryItem(key, parameters[key]);
+  }
+#else
+  QUrlQuery urlQuery(upload->Url);
+  foreach (const QString& key, parameters.keys())
+  {
+    urlQuery.addQueryItem(key, parameters[key]);
+  }
+  upload->Url.setQuery(urlQuery);
+#endif
+
+  d->BytesTotal += upload->Device.size();
+  d->Pending << upload;
+  this->startUploads();
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatUploadManager::isRunning() const
+{
+  Q_D(const ctkXnatUploadManager);
+  return d->Running;
+}
+
+//----------------------------------------------------------------------------
+bool ctkXnatUploadManager::waitForFinished()
+{
+  Q_D(ctkXnatUploadManager);
+  if (d->Running)
+  {
+    QEventLoop loop;
+    connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+    loop.exec(QEventLoop::ExcludeUserInputEvents);
+  }
+  return d->Errors.isEmpty();
+}
+
+//----------------------------------------------------------------------------
+QStringList ctkXnatUploadManager::errors() const
+{
+  Q_D(const ctkXnatUploadManager);
+  return d->Errors;
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatUploadManager::startUploads()
+{
+  Q_D(ctkXnatUploadManager);
+
+  while (!d->Pending.isEmpty() && d->Transfers.size() < d->MaximumConnections)
+  {
+    ctkXnatUpload* upload = d->Pending.takeFirst();
+    if (!upload->Device.open(QIODevice::ReadOnly))
+    {
+      d->Errors << QString("%1: %2").arg(upload->XnatFile->localFilePath(), upload->Device.errorString());
+      delete upload;
+      continue;
+    }
+
+    QNetworkRequest request(upload->Url);
+    request.setRawHeader("User-Agent", "Qt");
+    request.setRawHeader("Cookie", QString("JSESSIONID=%1").arg(d->Session->sessionId()).toLatin1());
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    request.setHeader(QNetworkRequest::ContentLengthHeader, upload->Device.size());
+
+    QNetworkReply* reply = d->NetworkManager.put(request, &upload->Device);
+    d->Transfers.insert(reply, upload);
+    connect(reply, SIGNAL(uploadProgress(qint64,qint64)), SLOT(updateProgress(qint64,qint64)));
+    connect(reply, SIGNAL(finished()), SLOT(finishFile()));
+    connect(reply, SIGNAL(sslErrors(QList<QSslError>)), SLOT(ignoreSslErrors()));
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatUploadManager::updateProgress(qint64 bytesSent, qint64 /*bytesTotal*/)
+{
+  Q_D(ctkXnatUploadManager);
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  ctkXnatUpload* upload = d->Transfers.value(reply);
+  if (!upload || bytesSent <= upload->BytesSent) return;
+
+  d->BytesSent += bytesSent - upload->BytesSent;
+  upload->BytesSent = bytesSent;
+  emit progress(d->BytesSent, d->BytesTotal);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatUploadManager::finishFile()
+{
+  Q_D(ctkXnatUploadManager);
+
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  ctkXnatUpload* upload = d->Transfers.take(reply);
+  if (!upload) return;
+
+  reply->deleteLater();
+  upload->Device.close();
+
+  if (reply->error() != QNetworkReply::NoError)
+  {
+    d->Errors << QString("%1: %2").arg(upload->XnatFile->localFilePath(), reply->errorString());
+    delete upload;
+  }
+  else
+  {
+    d->Uploaded << upload;
+  }
+
+  this->startUploads();
+
+  if (d->Pending.isEmpty() && d->Transfers.isEmpty())
+  {
+    this->validateUploads();
+    d->Running = false;
+    emit finished();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatUploadManager::validateUploads()
+{
+  Q_D(ctkXnatUploadManager);
+
+  QMap<QString, QList<ctkXnatUpload*> > resourceUploads;
+  foreach (ctkXnatUpload* upload, d->Uploaded)
+  {
+    resourceUploads[upload->XnatFile->parent()->resourceUri()] << upload;
+  }
+  QList<ctkXnatUpload*> uploaded = d->Uploaded;
+  d->Uploaded.clear();
+
+  // The file lists of all resources are requested at once
+  QMap<QString, QUuid> listQueryIds;
+  foreach (const QString& resourceUri, resourceUploads.keys())
+  {
+    listQueryIds[resourceUri] = d->Session->httpGet(resourceUri + "/files");
+  }
+
+  foreach (const QString& resourceUri, resourceUploads.keys())
+  {
+    QMap<QString, QString> remoteMd5s;
+    try
+    {
+      foreach (const QVariantMap& entry, d->Session->httpSync(listQueryIds[resourceUri]))
+      {
+        if (entry.contains("digest"))
+        {
+          remoteMd5s[entry["Name"].toString()] = entry["digest"].toString().toLower();
+        }
+      }
+
+      if (remoteMd5s.isEmpty())
+      {
+        // For XNAT versions <= 1.6.4 the digests are only in the catalog XML
+        // of the resource, which maps the file names to their digest
+        QUuid catalogQueryId = d->Session->httpGet(resourceUri);
+        foreach (const QVariantMap& entry, d->Session->httpSync(catalogQueryId))
+        {
+          QMapIterator<QString, QVariant> itEntry(entry);
+          while (itEntry.hasNext())
+          {
+            itEntry.next();
+            remoteMd5s[itEntry.key()] = itEntry.value().toString().toLower();
+          }
+        }
+      }
+    }
+    catch (const ctkXnatException& e)
+    {
+      qWarning() << "Could not request the MD5 digests of" << resourceUri << ":" << e.what();
+    }
+
+    foreach (ctkXnatUpload* upload, resourceUploads[resourceUri])
+    {
+      QString md5ChecksumRemote = remoteMd5s.value(upload->XnatFile->name());
+      QString md5ChecksumLocal = upload->Device.md5();
+      if (md5ChecksumRemote.isEmpty() || md5ChecksumLocal.isEmpty())
+      {
+        qWarning() << "Could not validate file upload! Remote MD5:" << md5ChecksumRemote
+                   << "Local MD5:" << md5ChecksumLocal;
+      }
+      else if (md5ChecksumLocal != md5ChecksumRemote)
+      {
+        d->Errors << QString("%1: MD5 checksum mismatch").arg(upload->XnatFile->localFilePath());
+        try
+        {
+          // Remove corrupted file from server
+          upload->XnatFile->erase();
+        }
+        catch (const ctkXnatException& e)
+        {
+          qWarning() << "Could not remove" << upload->XnatFile->resourceUri() << ":" << e.what();
+        }
+        continue;
+      }
+      emit fileUploaded(upload->XnatFile);
+    }
+  }
+  qDeleteAll(uploaded);
+}
+
+//----------------------------------------------------------------------------
+void ctkXnatUploadManager::ignoreSslErrors()
+{
+  // Like ctkXnatSession, which suppresses the SSL errors of sites with
+  // self-signed certificates
+  QNetworkReply* reply = qobject_cast<QNetworkReply*>(this->sender());
+  if (reply)
+  {
+    reply->ignoreSslErrors();
+  }
+}
@@ -0,0 +1,111 @@
+/*=============================================================================
+
+  Library: XNAT/Core
+
+  Copyright (c) University College London,
+    Centre for Medical Image Computing
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKXNATUPLOADMANAGER_H
+#define CTKXNATUPLOADMANAGER_H
+
+#include "ctkXNATCoreExport.h"
+
+#include <QMap>
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+
+class ctkXnatFile;
+class ctkXnatSession;
+class ctkXnatUploadManagerPrivate;
+
+/**
+ * @ingroup XNAT_Core
+ *
+ * @brief Uploads files to XNAT concurrently and validates them by their MD5 digest.
+ *
+ * The local file is streamed to the server and its MD5 digest is computed from the
+ * data read for the transfer, so the file is read only once. When the transfers of
+ * a resource are finished, the digests of the server are looked up with one request
+ * of its file list, or of its catalog for servers which do not report the digests in
+ * the list. Files with a different digest on the server are removed from the server
+ * and reported in errors().
+ */
+class CTK_XNAT_CORE_EXPORT ctkXnatUploadManager : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  typedef QMap<QString, QString> UrlParameters;
+
+  ctkXnatUploadManager(ctkXnatSession* session, QObject* parent = 0);
+  ~ctkXnatUploadManager();
+
+  /**
+   * @brief Number of files transferred at the same time, 4 by default.
+   */
+  void setMaximumConnections(int connections);
+  int maximumConnections() const;
+
+  /**
+   * @brief Starts to upload the local file of \a xnatFile, without waiting for the transfer.
+   *
+   * The \a parameters are appended to the URL of the file, like for ctkXnatSession::upload().
+   * The file object has to exist until the upload is finished.
+   *
+   * @throws ctkXnatException if the local file does not exist.
+   */
+  void upload(ctkXnatFile* xnatFile, const UrlParameters& parameters = UrlParameters());
+
+  bool isRunning() const;
+
+  /**
+   * @brief Waits for the running uploads and their validation.
+   * @return \c true if all files were uploaded.
+   */
+  bool waitForFinished();
+
+  /**
+   * @brief The errors of the files which could not be uploaded.
+   */
+  QStringList errors() const;
+
+  Q_SIGNAL void progress(qint64 bytesSent, qint64 bytesTotal);
+
+  Q_SIGNAL void fileUploaded(ctkXnatFile* xnatFile);
+
+  Q_SIGNAL void finished();
+
+protected:
+
+  const QScopedPointer<ctkXnatUploadManagerPrivate> d_ptr;
+
+private:
+
+  Q_DECLARE_PRIVATE(ctkXnatUploadManager)
+  Q_DISABLE_COPY(ctkXnatUploadManager)
+
+  void startUploads();
+  void validateUploads();
+
+  Q_SLOT void updateProgress(qint64 bytesSent, qint64 bytesTotal);
+  Q_SLOT void finishFile();
+  Q_SLOT void ignoreSslErrors();
+};
+
+#endif
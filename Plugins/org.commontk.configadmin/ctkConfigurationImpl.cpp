@@ -105,6 +105,7 @@ void ctkConfigurationImpl::setPluginLocation(const QString& pluginLocation)
   configurationAdminFactory->checkConfigurationPermission();
   this->pluginLocation = pluginLocation;
   boundPlugin.clear(); // always reset the boundPlugin when setPluginLocation is called
+  configurationStore->updateLocationIndex(pid, pluginLocation);
 }
 
 void ctkConfigurationImpl::update()
@@ -173,6 +174,10 @@ bool ctkConfigurationImpl::bind(QSharedPointer<ctkPlugin> plugin)
   if (boundPlugin.isNull() && (pluginLocation.isEmpty() || pluginLocation == plugin->getLocation()))
   {
     boundPlugin = plugin;
+    if (!deleted)
+    {
+      configurationStore->updateLocationIndex(pid, getPluginLocation(false));
+    }
   }
   return (boundPlugin == plugin);
 }
@@ -183,6 +188,10 @@ void ctkConfigurationImpl::unbind(QSharedPointer<ctkPlugin> plugin)
   if (boundPlugin == plugin)
   {
     boundPlugin.clear();
+    if (!deleted)
+    {
+      configurationStore->updateLocationIndex(pid, pluginLocation);
+    }
   }
 }
 
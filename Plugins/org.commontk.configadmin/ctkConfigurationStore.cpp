@@ -23,21 +23,153 @@
 #include "ctkConfigurationStore_p.h"
 #include "ctkConfigurationAdminFactory_p.h"
 
+#include <ctkPluginConstants.h>
 #include <ctkPluginContext.h>
+#include <service/cm/ctkConfigurationAdmin.h>
 #include <service/log/ctkLogService.h>
 
 #include <QDataStream>
 #include <QDateTime>
+#include <QRunnable>
+#if QT_VERSION >= QT_VERSION_CHECK(5,1,0)
+#include <QSaveFile>
+#endif
+
+#if QT_VERSION < QT_VERSION_CHECK(5,1,0)
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <cstdio>
+#include <unistd.h>
+#endif
+#endif
+
+class _FlushStoreRunnable : public QRunnable
+{
+public:
+
+  _FlushStoreRunnable(ctkConfigurationStore* store, int delay)
+    : store(store), delay(delay)
+  {
+
+  }
+
+  void run()
+  {
+    store->flush(delay);
+  }
+
+private:
+
+  ctkConfigurationStore* store;
+  int delay;
+};
 
 const QString ctkConfigurationStore::STORE_DIR = "store";
 const QString ctkConfigurationStore::PID_EXT = ".pid";
+const QString ctkConfigurationStore::TMP_EXT = ".tmp";
+const QString ctkConfigurationStore::COMPACT_FILE = "configurations.dat";
+const QString ctkConfigurationStore::PROP_COMPACT = "org.commontk.configadmin.store.compact";
+const QString ctkConfigurationStore::PROP_WRITE_DELAY = "org.commontk.configadmin.store.writeDelay";
+
+namespace {
+
+/**
+ * Split the normalized filter string (ctkLDAPSearchFilter::toString()) of an equality
+ * without wildcards into its attribute name and unescaped value.
+ */
+bool simpleEquality(const QString& term, QString& name, QString& value)
+{
+  if (term.size() < 3 || term.at(0) != '(' || term.at(term.size() - 1) != ')')
+  {
+    return false;
+  }
+  int pos = 1;
+  while (pos < term.size() - 1 && QString("=<>~()&|!").indexOf(term.at(pos)) < 0)
+  {
+    ++pos;
+  }
+  if (pos == 1 || term.at(pos) != '=')
+  {
+    return false;
+  }
+  name = term.mid(1, pos - 1);
+  value.clear();
+  for (++pos; pos < term.size() - 1; ++pos)
+  {
+    QChar c = term.at(pos);
+    if (c == '\\')
+    {
+      value.append(term.at(++pos));
+    }
+    else if (c == '*' || c == '(' || c == ')')
+    {
+      return false;
+    }
+    else
+    {
+      value.append(c);
+    }
+  }
+  return pos == term.size() - 1;
+}
+
+/**
+ * Split the normalized filter string of a conjunction into its terms.
+ */
+QStringList conjunctionTerms(const QString& filter)
+{
+  QStringList terms;
+  if (!filter.startsWith("(&") || !filter.endsWith(')'))
+  {
+    return terms;
+  }
+  int depth = 0;
+  int start = 2;
+  for (int pos = 2; pos < filter.size() - 1; ++pos)
+  {
+    QChar c = filter.at(pos);
+    if (c == '\\')
+    {
+      ++pos;
+    }
+    else if (c == '(')
+    {
+      if (depth++ == 0) start = pos;
+    }
+    else if (c == ')' && --depth == 0)
+    {
+      terms.push_back(filter.mid(start, pos - start + 1));
+    }
+  }
+  return terms;
+}
+
+}
+
+static const quint32 COMPACT_MAGIC = 0x63746b43; // "ctkC"
+static const qint32 COMPACT_VERSION = 1;
 
 ctkConfigurationStore::ctkConfigurationStore(
   ctkConfigurationAdminFactory* configurationAdminFactory,
   ctkPluginContext* context)
   : configurationAdminFactory(configurationAdminFactory),
-    createdPidCount(0)
+    createdPidCount(0), flushScheduled(false), stopping(false),
+    writeDelay(50), compact(false),
+    persistenceQueue("ctkConfigurationStore Persistence Queue")
 {
+  QVariant writeDelayProp = context->getProperty(PROP_WRITE_DELAY);
+  if (writeDelayProp.isValid())
+  {
+    bool ok = false;
+    int delay = writeDelayProp.toInt(&ok);
+    if (ok && delay >= 0)
+    {
+      writeDelay = delay;
+    }
+  }
+  compact = context->getProperty(PROP_COMPACT).toBool();
+
   store = context->getDataFile(STORE_DIR).absoluteDir();
 
   if (!store.mkpath(store.absolutePath()))
@@ -45,6 +177,174 @@ ctkConfigurationStore::ctkConfigurationStore(
     return; // no persistent store
   }
 
+  // remove the files of writes interrupted before they were renamed
+  QStringList tmpFilters;
+  tmpFilters << QString('*') + TMP_EXT;
+  foreach (QString tmpFileName, store.entryList(tmpFilters, QDir::Files | QDir::CaseSensitive))
+  {
+    store.remove(tmpFileName);
+  }
+
+  if (compact)
+  {
+    loadCompactFile();
+    loadConfigurationFiles();
+  }
+  else
+  {
+    // configurations of the compact file without a pid file are migrated to pid files
+    loadConfigurationFiles();
+    loadCompactFile();
+  }
+
+  if (!legacyFiles.isEmpty())
+  {
+    QMutexLocker lock(&persistenceMutex);
+    scheduleFlush();
+  }
+}
+
+ctkConfigurationStore::~ctkConfigurationStore()
+{
+  {
+    QMutexLocker lock(&persistenceMutex);
+    stopping = true;
+    flushCondition.wakeAll();
+  }
+  flush();
+}
+
+void ctkConfigurationStore::loadConfiguration(const ctkDictionary& dictionary)
+{
+  ctkConfigurationImplPtr config(new ctkConfigurationImpl(configurationAdminFactory, this, dictionary));
+  insertConfiguration(config->getPid(),
+                      dictionary.value(ctkConfigurationAdmin::SERVICE_FACTORYPID).toString(),
+                      dictionary.value(ctkConfigurationAdmin::SERVICE_PLUGINLOCATION).toString(),
+                      config);
+}
+
+void ctkConfigurationStore::insertConfiguration(const QString& pid, const QString& factoryPid,
+                                                const QString& location, ctkConfigurationImplPtr config)
+{
+  configurations.insert(pid, config);
+  if (!factoryPid.isEmpty())
+  {
+    factoryPidIndex[factoryPid].insert(pid);
+  }
+  updateLocationIndex(pid, location);
+}
+
+void ctkConfigurationStore::eraseConfiguration(const QString& pid)
+{
+  ctkConfigurationImplPtr config = configurations.take(pid);
+  if (config)
+  {
+    QString factoryPid = config->getFactoryPid(false);
+    QHash<QString, QSet<QString> >::iterator it = factoryPidIndex.find(factoryPid);
+    if (it != factoryPidIndex.end())
+    {
+      it.value().remove(pid);
+      if (it.value().isEmpty())
+      {
+        factoryPidIndex.erase(it);
+      }
+    }
+  }
+  updateLocationIndex(pid, QString());
+}
+
+void ctkConfigurationStore::updateLocationIndex(const QString& pid, const QString& location)
+{
+  QMutexLocker lock(&locationMutex);
+  QHash<QString, QString>::iterator indexed = indexedLocations.find(pid);
+  if (indexed != indexedLocations.end())
+  {
+    if (indexed.value() == location)
+    {
+      return;
+    }
+    QHash<QString, QSet<QString> >::iterator it = locationIndex.find(indexed.value());
+    if (it != locationIndex.end())
+    {
+      it.value().remove(pid);
+      if (it.value().isEmpty())
+      {
+        locationIndex.erase(it);
+      }
+    }
+    indexedLocations.erase(indexed);
+  }
+  if (!location.isEmpty())
+  {
+    indexedLocations.insert(pid, location);
+    locationIndex[location].insert(pid);
+  }
+}
+
+bool ctkConfigurationStore::indexedConfigurations(const QString& filter,
+                                                  QList<ctkConfigurationImplPtr>& candidates)
+{
+  QStringList terms = conjunctionTerms(filter);
+  if (terms.isEmpty())
+  {
+    terms.push_back(filter);
+  }
+
+  // the candidates of the most selective indexed term, they are still matched against the filter
+  bool indexed = false;
+  QSet<QString> pids;
+  foreach (QString term, terms)
+  {
+    QString name;
+    QString value;
+    if (!simpleEquality(term, name, value))
+    {
+      continue;
+    }
+
+    QSet<QString> termPids;
+    if (name.compare(ctkPluginConstants::SERVICE_PID, Qt::CaseInsensitive) == 0)
+    {
+      if (configurations.contains(value)) termPids.insert(value);
+    }
+    else if (name.compare(ctkConfigurationAdmin::SERVICE_FACTORYPID, Qt::CaseInsensitive) == 0)
+    {
+      termPids = factoryPidIndex.value(value);
+    }
+    else if (name.compare(ctkConfigurationAdmin::SERVICE_PLUGINLOCATION, Qt::CaseInsensitive) == 0)
+    {
+      QMutexLocker lock(&locationMutex);
+      termPids = locationIndex.value(value);
+    }
+    else
+    {
+      continue;
+    }
+
+    if (!indexed || termPids.size() < pids.size())
+    {
+      pids = termPids;
+      indexed = true;
+    }
+  }
+
+  if (!indexed)
+  {
+    return false;
+  }
+  foreach (QString pid, pids)
+  {
+    ctkConfigurationImplPtr config = configurations.value(pid);
+    if (config)
+    {
+      candidates.push_back(config);
+    }
+  }
+  return true;
+}
+
+void ctkConfigurationStore::loadConfigurationFiles()
+{
   QStringList nameFilters;
   nameFilters << QString('*') + PID_EXT;
   QFileInfoList configurationFiles = store.entryInfoList(nameFilters, QDir::Files | QDir::CaseSensitive);
@@ -63,8 +363,19 @@ ctkConfigurationStore::ctkConfigurationStore(
     dataStream >> dictionary;
     if (dataStream.status() == QDataStream::Ok)
     {
-      ctkConfigurationImplPtr config(new ctkConfigurationImpl(configurationAdminFactory, this, dictionary));
-      configurations.insert(config->getPid(), config);
+      if (compact)
+      {
+        // pid files left by a previous layout, removed once written to the compact file
+        legacyFiles.push_back(configurationFilePath);
+        if (configurations.contains(pid))
+        {
+          iodevice->close();
+          delete iodevice;
+          continue;
+        }
+        compactConfigurations.insert(pid, dictionary);
+      }
+      loadConfiguration(dictionary);
     }
     else
     {
@@ -84,44 +395,174 @@ ctkConfigurationStore::ctkConfigurationStore(
   }
 }
 
+bool ctkConfigurationStore::loadCompactFile()
+{
+  QFile compactFile(store.filePath(COMPACT_FILE));
+  if (!compactFile.exists())
+  {
+    return false;
+  }
+
+  QHash<QString, ctkDictionary> dictionaries;
+  bool restored = false;
+  if (compactFile.open(QIODevice::ReadOnly))
+  {
+    QDataStream dataStream(&compactFile);
+    quint32 magic = 0;
+    qint32 version = 0;
+    dataStream >> magic >> version;
+    if (magic == COMPACT_MAGIC && version <= COMPACT_VERSION)
+    {
+      dataStream >> dictionaries;
+      restored = dataStream.status() == QDataStream::Ok;
+    }
+    compactFile.close();
+  }
+
+  if (!restored)
+  {
+    QString errorMessage = QString("{Configuration Admin} %1 could not be restored. %2")
+        .arg(compactFile.fileName()).arg(compactFile.errorString());
+    CTK_ERROR(configurationAdminFactory->getLogService()) << errorMessage;
+    compactFile.remove();
+    return false;
+  }
+
+  if (compact)
+  {
+    compactConfigurations = dictionaries;
+    QHashIterator<QString, ctkDictionary> it(dictionaries);
+    while (it.hasNext())
+    {
+      it.next();
+      loadConfiguration(it.value());
+    }
+  }
+  else
+  {
+    QHashIterator<QString, ctkDictionary> it(dictionaries);
+    while (it.hasNext())
+    {
+      it.next();
+      if (!configurations.contains(it.key()))
+      {
+        loadConfiguration(it.value());
+        pendingWrites.insert(it.key(), it.value());
+      }
+    }
+    legacyFiles.push_back(compactFile.fileName());
+  }
+  return true;
+}
+
 void ctkConfigurationStore::saveConfiguration(const QString& pid, ctkConfigurationImpl* config)
 {
   if (!store.exists())
     return; // no persistent store
 
   config->checkLocked();
-  QFile configFile(store.filePath(pid + PID_EXT));
   ctkDictionary configProperties = config->getAllProperties();
-  //TODO security
-//  try
-//  {
-//    AccessController.doPrivileged(new PrivilegedExceptionAction() {
-//      public Object run() throws Exception {
-        writeConfigurationFile(configFile, configProperties);
-//        return null;
-//      }
-//    });
-//  }
-//  catch (PrivilegedActionException e)
-//  {
-//    throw (IOException) e.getException();
-//  }
+
+  // written later by flush(), consecutive updates of a configuration are written once
+  QMutexLocker lock(&persistenceMutex);
+  pendingWrites.insert(pid, configProperties);
+  pendingRemovals.remove(pid);
+  scheduleFlush();
 }
 
 void ctkConfigurationStore::removeConfiguration(const QString& pid)
 {
   QMutexLocker lock(&mutex);
-  configurations.remove(pid);
+  eraseConfiguration(pid);
   if (!store.exists())
     return; // no persistent store
 
-  QFile configFile(store.filePath(pid + PID_EXT));
-  //TODO security//  AccessController.doPrivileged(new PrivilegedAction() {
-//    public Object run() {
-  deleteConfigurationFile(configFile);
+  QMutexLocker persistenceLock(&persistenceMutex);
+  pendingWrites.remove(pid);
+  pendingRemovals.insert(pid);
+  scheduleFlush();
+}
+
+void ctkConfigurationStore::scheduleFlush()
+{
+  if (flushScheduled || stopping)
+  {
+    return;
+  }
+  flushScheduled = true;
+  persistenceQueue.put(new _FlushStoreRunnable(this, writeDelay));
+}
+
+void ctkConfigurationStore::flush(int delay)
+{
+  QMutexLocker flushLock(&flushMutex);
+
+  QHash<QString, ctkDictionary> writes;
+  QSet<QString> removals;
+  {
+    QMutexLocker lock(&persistenceMutex);
+    if (delay > 0 && !stopping)
+    {
+      // let the updates following each other be written at once
+      flushCondition.wait(&persistenceMutex, delay);
+    }
+    writes = pendingWrites;
+    removals = pendingRemovals;
+    pendingWrites.clear();
+    pendingRemovals.clear();
+    flushScheduled = false;
+  }
+
+  if (writes.isEmpty() && removals.isEmpty() && legacyFiles.isEmpty())
+  {
+    return;
+  }
+
+  //TODO security
+//  AccessController.doPrivileged(new PrivilegedExceptionAction() {
+//    public Object run() throws Exception {
+  bool written = true;
+  if (compact)
+  {
+    foreach (QString pid, removals)
+    {
+      compactConfigurations.remove(pid);
+    }
+    QHashIterator<QString, ctkDictionary> it(writes);
+    while (it.hasNext())
+    {
+      it.next();
+      compactConfigurations.insert(it.key(), it.value());
+    }
+    written = writeCompactFile();
+  }
+  else
+  {
+    foreach (QString pid, removals)
+    {
+      QFile configFile(store.filePath(pid + PID_EXT));
+      deleteConfigurationFile(configFile);
+    }
+    QHashIterator<QString, ctkDictionary> it(writes);
+    while (it.hasNext())
+    {
+      it.next();
+      QFile configFile(store.filePath(it.key() + PID_EXT));
+      written = writeConfigurationFile(configFile, it.value()) && written;
+    }
+  }
 //      return null;
 //    }
 //  });
+
+  if (written)
+  {
+    foreach (QString legacyFile, legacyFiles)
+    {
+      QFile::remove(legacyFile);
+    }
+    legacyFiles.clear();
+  }
 }
 
 ctkConfigurationImplPtr ctkConfigurationStore::getConfiguration(
@@ -133,7 +574,7 @@ ctkConfigurationImplPtr ctkConfigurationStore::getConfiguration(
   {
     config = ctkConfigurationImplPtr(new ctkConfigurationImpl(configurationAdminFactory, this,
                                                               QString(), pid, location));
-    configurations.insert(pid, config);
+    insertConfiguration(pid, QString(), location, config);
   }
   return config;
 }
@@ -145,7 +586,7 @@ ctkConfigurationImplPtr ctkConfigurationStore::createFactoryConfiguration(
   //TODO Qt4.7 use QDateTime::currentMSecsSinceEpoch()
   QString pid = factoryPid + "-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmsszzz") + "-" + QString::number(createdPidCount++);
   ctkConfigurationImplPtr config(new ctkConfigurationImpl(configurationAdminFactory, this, factoryPid, pid, location));
-  configurations.insert(pid, config);
+  insertConfiguration(pid, factoryPid, location, config);
   return config;
 }
 
@@ -159,13 +600,9 @@ QList<ctkConfigurationImplPtr> ctkConfigurationStore::getFactoryConfigurations(c
 {
   QMutexLocker lock(&mutex);
   QList<ctkConfigurationImplPtr> resultList;
-  foreach (ctkConfigurationImplPtr config, configurations)
+  foreach (QString pid, factoryPidIndex.value(factoryPid))
   {
-    QString otherFactoryPid = config->getFactoryPid();
-    if (otherFactoryPid == factoryPid)
-    {
-      resultList.push_back(config);
-    }
+    resultList.push_back(configurations.value(pid));
   }
   return resultList;
 }
@@ -173,8 +610,14 @@ QList<ctkConfigurationImplPtr> ctkConfigurationStore::getFactoryConfigurations(c
 QList<ctkConfigurationImplPtr> ctkConfigurationStore::listConfigurations(const ctkLDAPSearchFilter& filter)
 {
   QMutexLocker lock(&mutex);
+  QList<ctkConfigurationImplPtr> candidates;
+  if (!indexedConfigurations(filter.toString(), candidates))
+  {
+    candidates = configurations.values();
+  }
+
   QList<ctkConfigurationImplPtr> resultList;
-  foreach (ctkConfigurationImplPtr config, configurations)
+  foreach (ctkConfigurationImplPtr config, candidates)
   {
     ctkDictionary properties = config->getAllProperties();
     if (filter.match(properties))
@@ -194,19 +637,76 @@ void ctkConfigurationStore::unbindConfigurations(QSharedPointer<ctkPlugin> plugi
   }
 }
 
-void ctkConfigurationStore::writeConfigurationFile(QFile& configFile,
+bool ctkConfigurationStore::writeConfigurationFile(QFile& configFile,
                             const ctkDictionary& configProperties)
 {
-  QIODevice* iodevice = &configFile;
-  iodevice->open(QIODevice::WriteOnly);
-  QDataStream datastream(iodevice);
-
+  QByteArray data;
+  QDataStream datastream(&data, QIODevice::WriteOnly);
   datastream << configProperties;
-  // ignore errors
-  iodevice->close();
+
+  return writeFileAtomically(configFile.fileName(), data);
 }
 
 void ctkConfigurationStore::deleteConfigurationFile(QFile& configFile)
 {
   configFile.remove();
 }
+
+bool ctkConfigurationStore::writeCompactFile()
+{
+  QByteArray data;
+  QDataStream datastream(&data, QIODevice::WriteOnly);
+  datastream << COMPACT_MAGIC << COMPACT_VERSION << compactConfigurations;
+
+  return writeFileAtomically(store.filePath(COMPACT_FILE), data);
+}
+
+bool ctkConfigurationStore::writeFileAtomically(const QString& fileName, const QByteArray& data)
+{
+  // the data is written to a temporary file which replaces the file once complete,
+  // an interrupted write leaves the previous content in place
+#if QT_VERSION >= QT_VERSION_CHECK(5,1,0)
+  QSaveFile file(fileName);
+  if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit())
+  {
+    return true;
+  }
+  CTK_ERROR(configurationAdminFactory->getLogService())
+      << QString("{Configuration Admin} %1 could not be written. %2").arg(fileName).arg(file.errorString());
+  file.cancelWriting();
+  return false;
+#else
+  QString tmpFileName = fileName + TMP_EXT;
+  QFile file(tmpFileName);
+  bool written = file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.flush();
+#ifndef Q_OS_WIN
+  written = written && ::fsync(file.handle()) == 0;
+#endif
+  QString errorString = file.errorString();
+  file.close();
+
+  if (written)
+  {
+#ifdef Q_OS_WIN
+    written = ::MoveFileExW(reinterpret_cast<const wchar_t*>(tmpFileName.utf16()),
+                            reinterpret_cast<const wchar_t*>(fileName.utf16()),
+                            MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    written = ::rename(QFile::encodeName(tmpFileName).constData(),
+                       QFile::encodeName(fileName).constData()) == 0;
+#endif
+    if (!written)
+    {
+      errorString = "The temporary file could not be renamed";
+    }
+  }
+
+  if (!written)
+  {
+    CTK_ERROR(configurationAdminFactory->getLogService())
+        << QString("{Configuration Admin} %1 could not be written. %2").arg(fileName).arg(errorString);
+    QFile::remove(tmpFileName);
+  }
+  return written;
+#endif
+}
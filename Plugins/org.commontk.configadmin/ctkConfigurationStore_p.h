@@ -26,11 +26,14 @@
 #include <ctkLDAPSearchFilter.h>
 
 #include "ctkConfigurationImpl_p.h"
+#include "ctkCMSerializedTaskQueue_p.h"
 
 #include <QSharedPointer>
 #include <QHash>
+#include <QSet>
 #include <QDir>
 #include <QMutex>
+#include <QWaitCondition>
 
 class ctkConfigurationImpl;
 class ctkConfigurationAdminFactory;
@@ -42,6 +45,20 @@ class ctkPlugin;
  * implementation uses a filestore and serialization of the configuration dictionaries to files
  * identified by their pid. Persistence details are in the constructor, saveConfiguration, and
  * deleteConfiguration and can be factored out separately if required.
+ *
+ * The changes are not written by saveConfiguration and removeConfiguration themselves: they are
+ * recorded and written in the background after a short delay, so that the updates of a configuration
+ * following each other are written once. The files are replaced atomically and the pending changes
+ * are written when the store is destroyed.
+ *
+ * With the framework property org.commontk.configadmin.store.compact set to true, all the
+ * configurations are kept in a single file which loads faster than the directory of pid files.
+ * The delay of the background writes in milliseconds is given by the framework property
+ * org.commontk.configadmin.store.writeDelay.
+ *
+ * The configurations are indexed by factory pid and plugin location. listConfigurations uses the
+ * indexes when the filter is an equality on service.pid, service.factoryPid or
+ * service.pluginLocation, or a conjunction containing one, instead of matching every configuration.
  */
 class ctkConfigurationStore
 {
@@ -50,6 +67,7 @@ public:
 
   ctkConfigurationStore(ctkConfigurationAdminFactory* configurationAdminFactory,
                         ctkPluginContext* context);
+  ~ctkConfigurationStore();
 
   void saveConfiguration(const QString& pid, ctkConfigurationImpl* config);
   void removeConfiguration(const QString& pid);
@@ -66,20 +84,75 @@ public:
 
   void unbindConfigurations(QSharedPointer<ctkPlugin> plugin);
 
+  /**
+   * Called by the configuration when its plugin location changes, the configuration
+   * lock may be held.
+   */
+  void updateLocationIndex(const QString& pid, const QString& location);
+
+  /**
+   * Write the pending changes. With a delay, waits up to delay ms for more changes
+   * before writing, unless the store is being destroyed.
+   */
+  void flush(int delay = 0);
+
 private:
 
   QMutex mutex;
   ctkConfigurationAdminFactory* configurationAdminFactory;
   static const QString STORE_DIR; // = "store"
   static const QString PID_EXT; // = ".pid"
+  static const QString TMP_EXT; // = ".tmp"
+  static const QString COMPACT_FILE; // = "configurations.dat"
+  static const QString PROP_COMPACT; // = "org.commontk.configadmin.store.compact"
+  static const QString PROP_WRITE_DELAY; // = "org.commontk.configadmin.store.writeDelay"
   QHash<QString, ctkConfigurationImplPtr> configurations;
+  QHash<QString, QSet<QString> > factoryPidIndex; // guarded by mutex
   int createdPidCount;
+
+  // the location index has its own mutex, it is updated with the configuration lock held
+  // while mutex is held when the configurations are locked
+  QMutex locationMutex;
+  QHash<QString, QSet<QString> > locationIndex;
+  QHash<QString, QString> indexedLocations;
   QDir store;
 
 
-  void writeConfigurationFile(QFile& configFile,
+  // persistence, the pending changes are guarded by persistenceMutex and
+  // the writes are serialized by flushMutex
+  QMutex persistenceMutex;
+  QWaitCondition flushCondition;
+  QHash<QString, ctkDictionary> pendingWrites;
+  QSet<QString> pendingRemovals;
+  bool flushScheduled;
+  bool stopping;
+  int writeDelay;
+  bool compact;
+  QMutex flushMutex;
+  QHash<QString, ctkDictionary> compactConfigurations; // content of the compact file
+  QStringList legacyFiles; // files of the other layout, removed once migrated
+
+  void loadConfiguration(const ctkDictionary& dictionary);
+
+  // called with mutex locked
+  void insertConfiguration(const QString& pid, const QString& factoryPid,
+                           const QString& location, ctkConfigurationImplPtr config);
+  void eraseConfiguration(const QString& pid);
+  bool indexedConfigurations(const QString& filter, QList<ctkConfigurationImplPtr>& candidates);
+  void loadConfigurationFiles();
+  bool loadCompactFile();
+
+  // called with persistenceMutex locked
+  void scheduleFlush();
+
+  bool writeConfigurationFile(QFile& configFile,
                               const ctkDictionary& configProperties);
   void deleteConfigurationFile(QFile& configFile);
+  bool writeCompactFile();
+  bool writeFileAtomically(const QString& fileName, const QByteArray& data);
+
+  // last member, its thread may run a flush until it is destroyed
+  ctkCMSerializedTaskQueue persistenceQueue;
 
 };
 
@@ -0,0 +1,113 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+// CTK includes
+#include <ctkDicomAvailableDataHelper.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+//----------------------------------------------------------------------------
+int ctkDicomAvailableDataHelperTest1(int argc, char* argv[])
+{
+  Q_UNUSED(argc);
+  Q_UNUSED(argv);
+
+  ctkDicomAppHosting::AvailableData availableData;
+  ctkDicomAvailableDataHelper::ctkDicomAvailableDataAccessor accessor(availableData);
+
+  ctkDicomAppHosting::Patient patient;
+  patient.id = "patient1";
+  ctkDicomAppHosting::ObjectDescriptor objectDescriptor;
+
+  //----------------------------------------------------------------------------
+  if (accessor.getPatient(patient) || accessor.getStudy("study1") || accessor.getSeries("series1"))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with lookups of empty available data" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  for (int i = 0; i < 3; ++i)
+    {
+    objectDescriptor.descriptorUUID = QString::number(i);
+    accessor.addObjectDescriptor(patient, "study1", i < 2 ? "series1" : "series2", objectDescriptor);
+    }
+
+  if (availableData.patients.size() != 1 ||
+      availableData.patients[0].studies.size() != 1 ||
+      availableData.patients[0].studies[0].series.size() != 2 ||
+      availableData.patients[0].studies[0].series[0].objectDescriptors.size() != 2)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with addObjectDescriptor() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDicomAppHosting::Patient* patientFound;
+  ctkDicomAppHosting::Study* studyFound;
+  ctkDicomAppHosting::Series* seriesFound;
+  accessor.find(patient, "study1", "series2", patientFound, studyFound, seriesFound);
+  if (patientFound != &availableData.patients[0] ||
+      studyFound != &availableData.patients[0].studies[0] ||
+      seriesFound != &availableData.patients[0].studies[0].series[1] ||
+      accessor.getSeries("series2") != seriesFound)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with find() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  ctkDicomAppHosting::AvailableData src;
+  ctkDicomAvailableDataHelper::ctkDicomAvailableDataAccessor srcAccessor(src);
+  objectDescriptor.descriptorUUID = "3";
+  srcAccessor.addObjectDescriptor(patient, "study1", "series2", objectDescriptor);
+  ctkDicomAppHosting::Patient patient2;
+  patient2.id = "patient2";
+  objectDescriptor.descriptorUUID = "4";
+  srcAccessor.addObjectDescriptor(patient2, "study2", "series3", objectDescriptor);
+
+  ctkDicomAvailableDataHelper::appendToAvailableData(accessor, src);
+  if (availableData.patients.size() != 2 ||
+      availableData.patients[0].studies[0].series[1].objectDescriptors.size() != 2 ||
+      ctkDicomAvailableDataHelper::getAllUuids(availableData).size() != 5)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with appendToAvailableData() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (accessor.getStudy("study2") != &availableData.patients[1].studies[0])
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with getStudy() method after merge" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  // modifications without the accessor are detected on lookup
+  availableData.patients.removeFirst();
+  if (accessor.getPatient(patient) != NULL || accessor.getSeries("series3") != &availableData.patients[0].studies[0].series[0])
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with lookups after modification" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
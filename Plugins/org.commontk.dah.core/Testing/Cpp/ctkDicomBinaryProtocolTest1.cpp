@@ -0,0 +1,224 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QUuid>
+
+// CTK includes
+#include <ctkDicomAppInterface.h>
+#include <ctkDicomBinaryClient.h>
+#include <ctkDicomBinaryProtocol.h>
+#include <ctkDicomBinaryServer.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+class ctkDicomTestAppInterface : public ctkDicomAppInterface
+{
+public:
+  ctkDicomTestAppInterface() : State(ctkDicomAppHosting::IDLE) {}
+
+  virtual ctkDicomAppHosting::State getState()
+  {
+    return this->State;
+  }
+
+  virtual bool setState(ctkDicomAppHosting::State newState)
+  {
+    this->State = newState;
+    return true;
+  }
+
+  virtual bool bringToFront(const QRect&)
+  {
+    return false;
+  }
+
+  virtual bool notifyDataAvailable(const ctkDicomAppHosting::AvailableData& data, bool)
+  {
+    this->Data = data;
+    return true;
+  }
+
+  virtual QList<ctkDicomAppHosting::ObjectLocator> getData(const QList<QUuid>& objectUUIDs,
+                                                           const QList<QString>&, bool)
+  {
+    QList<ctkDicomAppHosting::ObjectLocator> objectLocators;
+    foreach(const QUuid& uuid, objectUUIDs)
+      {
+      ctkDicomAppHosting::ObjectLocator objectLocator;
+      objectLocator.locator = uuid.toString();
+      objectLocator.length = 16;
+      objectLocators.append(objectLocator);
+      }
+    return objectLocators;
+  }
+
+  virtual void releaseData(const QList<QUuid>&)
+  {
+  }
+
+  ctkDicomAppHosting::State State;
+  ctkDicomAppHosting::AvailableData Data;
+};
+
+}
+
+//----------------------------------------------------------------------------
+int ctkDicomBinaryProtocolTest1(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  //----------------------------------------------------------------------------
+  ctkDicomAppHosting::ObjectDescriptor descriptor;
+  descriptor.descriptorUUID = QUuid::createUuid().toString();
+  descriptor.classUID = "1.2.840.10008.5.1.4.1.1.2";
+  descriptor.modality = "CT";
+  ctkDicomAppHosting::Series series;
+  series.seriesUID = "1.2.3.4";
+  series.objectDescriptors.append(descriptor);
+  ctkDicomAppHosting::Study study;
+  study.studyUID = "1.2.3";
+  study.series.append(series);
+  ctkDicomAppHosting::Patient patient;
+  patient.name = "Patient";
+  patient.studies.append(study);
+  ctkDicomAppHosting::AvailableData data;
+  data.patients.append(patient);
+
+  ctkDicomAppHosting::AvailableData dataRead;
+  bool lastData = false;
+  if (!ctkDicomBinaryProtocol::unpack(ctkDicomBinaryProtocol::pack(data, true), dataRead, lastData) ||
+      dataRead != data || !lastData)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the serialization of AvailableData" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDicomAppHosting::State state;
+  if (ctkDicomBinaryProtocol::unpack(ctkDicomBinaryProtocol::pack(qint32(42)), state))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the serialization of an invalid State" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  QByteArray frames;
+  ctkDicomBinaryProtocol::appendFrame(frames, 7, ctkDicomBinaryProtocol::GetState, QByteArray());
+  ctkDicomBinaryProtocol::appendFrame(frames, 8, ctkDicomBinaryProtocol::ReleaseData, "abc");
+  int offset = 0;
+  quint32 requestId = 0;
+  quint8 code = 0;
+  QByteArray body;
+  if (ctkDicomBinaryProtocol::takeFrame(frames, offset, requestId, code, body) != ctkDicomBinaryProtocol::FrameTaken ||
+      requestId != 7 || code != ctkDicomBinaryProtocol::GetState || !body.isEmpty())
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with takeFrame() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QByteArray truncated = frames.left(frames.size() - 1);
+  int truncatedOffset = offset;
+  if (ctkDicomBinaryProtocol::takeFrame(truncated, truncatedOffset, requestId, code, body) != ctkDicomBinaryProtocol::FrameIncomplete ||
+      ctkDicomBinaryProtocol::takeFrame(frames, offset, requestId, code, body) != ctkDicomBinaryProtocol::FrameTaken ||
+      requestId != 8 || body != "abc" || offset != frames.size())
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with takeFrame() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  const int port = 48731;
+  ctkDicomBinaryClient client(port);
+  client.setRetryInterval(0);
+  if (client.call(ctkDicomBinaryProtocol::GetState, QByteArray()))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with call() method without server" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDicomBinaryServer server;
+  if (!server.listen(port))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with listen() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QByteArray result;
+  if (client.call(ctkDicomBinaryProtocol::GetState, QByteArray(), &result))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with call() method without interface" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ctkDicomTestAppInterface appInterface;
+  server.setExchangeInterface(&appInterface);
+
+  bool accepted = false;
+  if (!client.call(ctkDicomBinaryProtocol::SetState,
+                   ctkDicomBinaryProtocol::pack(ctkDicomAppHosting::INPROGRESS), &result) ||
+      !ctkDicomBinaryProtocol::unpack(result, accepted) || !accepted ||
+      appInterface.State != ctkDicomAppHosting::INPROGRESS)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the SetState call" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!client.call(ctkDicomBinaryProtocol::GetState, QByteArray(), &result) ||
+      !ctkDicomBinaryProtocol::unpack(result, state) || state != ctkDicomAppHosting::INPROGRESS)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the GetState call" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QList<QUuid> objectUUIDs;
+  objectUUIDs << QUuid::createUuid() << QUuid::createUuid();
+  QList<ctkDicomAppHosting::ObjectLocator> objectLocators;
+  if (!client.call(ctkDicomBinaryProtocol::GetData,
+                   ctkDicomBinaryProtocol::pack(objectUUIDs, QList<QString>(), false), &result) ||
+      !ctkDicomBinaryProtocol::unpack(result, objectLocators) || objectLocators.size() != 2 ||
+      objectLocators[1].locator != objectUUIDs[1].toString() || objectLocators[1].length != 16)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the GetData call" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (client.call(ctkDicomBinaryProtocol::GenerateUID, QByteArray(), &result))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with a host method called on an application" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  server.close();
+  if (client.call(ctkDicomBinaryProtocol::GetState, QByteArray(), &result) || client.isConnected())
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with call() method after the server is closed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
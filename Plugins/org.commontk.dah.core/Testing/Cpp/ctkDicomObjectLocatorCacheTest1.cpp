@@ -20,6 +20,7 @@
 =============================================================================*/
 
 // Qt includes
+#include <QElapsedTimer>
 #include <QUuid>
 
 // CTK includes
@@ -212,5 +213,44 @@ int ctkDicomObjectLocatorCacheTest1(int argc, char* argv[])
     return EXIT_FAILURE;
     }
 
+  //----------------------------------------------------------------------------
+  // Eviction of the least recently used entries above the maximum cost
+  ctkDicomObjectLocatorCache boundedCache;
+  ctkDicomAppHosting::ObjectLocator largeObjectLocator;
+  largeObjectLocator.length = 1000;
+  QString oldestUuid = QUuid::createUuid().toString();
+  QString newestUuid = QUuid::createUuid().toString();
+  boundedCache.insert(oldestUuid, largeObjectLocator);
+  boundedCache.insert(newestUuid, largeObjectLocator);
+  if (boundedCache.count() != 2 || boundedCache.totalCost() <= 2000)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with totalCost() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  boundedCache.setMaximumCost(boundedCache.totalCost() - 1);
+  if (boundedCache.evict() != 1 || boundedCache.count() != 1 ||
+      !boundedCache.find(newestUuid, objectLocatorFound) || boundedCache.find(oldestUuid, objectLocatorFound))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with evict() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  // Eviction of the entries not accessed for the maximum age
+  ctkDicomObjectLocatorCache expiringCache;
+  expiringCache.setMaximumAge(1);
+  expiringCache.insert(objectUuid, objectLocator);
+  QElapsedTimer timer;
+  timer.start();
+  while (timer.elapsed() < 10)
+    {
+    }
+  if (expiringCache.evict() != 1 || expiringCache.count() != 0 || expiringCache.totalCost() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with setMaximumAge() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
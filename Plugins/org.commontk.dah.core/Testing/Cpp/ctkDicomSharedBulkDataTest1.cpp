@@ -0,0 +1,108 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+// Qt includes
+#include <QUuid>
+
+// CTK includes
+#include <ctkDicomSharedBulkData.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+//----------------------------------------------------------------------------
+int ctkDicomSharedBulkDataTest1(int argc, char* argv[])
+{
+  Q_UNUSED(argc);
+  Q_UNUSED(argv);
+
+  ctkDicomSharedBulkData bulkData;
+  QString objectUuid = QUuid::createUuid().toString();
+  QByteArray content("pixel data");
+
+  //----------------------------------------------------------------------------
+  ctkDicomAppHosting::ObjectLocator objectLocator = bulkData.publish(objectUuid, content);
+  if (!ctkDicomSharedBulkData::isShared(objectLocator) ||
+      objectLocator.length != content.size() || objectLocator.locator != objectUuid)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with publish() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  {
+    ctkDicomSharedBulkDataView view(objectLocator);
+    if (!view.isValid() || view.toByteArray() != content)
+      {
+      std::cerr << "Line " << __LINE__ << " - Problem with ctkDicomSharedBulkDataView: "
+                << qPrintable(view.errorString()) << std::endl;
+      return EXIT_FAILURE;
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  ctkDicomAppHosting::ObjectLocator partLocator = objectLocator;
+  partLocator.offset = 6;
+  partLocator.length = 4;
+  {
+    ctkDicomSharedBulkDataView view(partLocator);
+    if (!view.isValid() || view.toByteArray() != "data")
+      {
+      std::cerr << "Line " << __LINE__ << " - Problem with the offset of ctkDicomSharedBulkDataView" << std::endl;
+      return EXIT_FAILURE;
+      }
+  }
+
+  partLocator.length = 5;
+  if (ctkDicomSharedBulkDataView(partLocator).isValid())
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the bounds of ctkDicomSharedBulkDataView" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  QString resultUuid = QUuid::createUuid().toString();
+  ctkDicomAppHosting::ObjectLocator resultLocator;
+  char* buffer = bulkData.create(resultUuid, 3, resultLocator);
+  if (buffer == 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with create() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::memcpy(buffer, "abc", 3);
+  if (ctkDicomSharedBulkDataView(resultLocator).toByteArray() != "abc")
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the data written in place" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  //----------------------------------------------------------------------------
+  if (!bulkData.release(objectUuid) || bulkData.release(objectUuid) ||
+      ctkDicomSharedBulkDataView(objectLocator).isValid())
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with release() method" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -19,11 +19,42 @@
 
 =============================================================================*/
 
+// Qt includes
+#include <QUuid>
+
 // CTK includes
 #include "ctkDicomAbstractExchangeCache.h"
 #include "ctkDicomAppHostingTypesHelper.h"
 #include "ctkDicomAvailableDataHelper.h"
 #include <ctkDicomObjectLocatorCache.h>
+#include "ctkDicomSharedBulkData.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Releases the shared memory of the evicted locators
+class ctkDicomExchangeObjectLocatorCache : public ctkDicomObjectLocatorCache
+{
+public:
+  ctkDicomExchangeObjectLocatorCache(ctkDicomSharedBulkData* sharedBulkData)
+    : SharedBulkData(sharedBulkData)
+  {}
+
+protected:
+  virtual void evicted(const QString& objectUuid, const ctkDicomAppHosting::ObjectLocator& objectLocator)
+  {
+    if (ctkDicomSharedBulkData::isShared(objectLocator))
+      {
+      this->SharedBulkData->release(objectUuid);
+      }
+  }
+
+private:
+  ctkDicomSharedBulkData* SharedBulkData;
+};
+
+}
 
 class ctkDicomAbstractExchangeCachePrivate
 {
@@ -32,9 +63,12 @@ public:
   ctkDicomAbstractExchangeCachePrivate();
   ~ctkDicomAbstractExchangeCachePrivate();
 
-  ctkDicomObjectLocatorCache ObjectLocatorCache;
+  ctkDicomSharedBulkData SharedBulkData;
+  ctkDicomExchangeObjectLocatorCache ObjectLocatorCache;
 
   ctkDicomAppHosting::AvailableData IncomingAvailableData;
+  // keeps the indexes of the incoming data between the notifications
+  QScopedPointer<ctkDicomAvailableDataHelper::ctkDicomAvailableDataAccessor> IncomingAccessor;
   bool lastIncomingData ;
 };
 
@@ -42,7 +76,10 @@ public:
 // ctkDicomAbstractExchangeCachePrivate methods
 
 //----------------------------------------------------------------------------
-ctkDicomAbstractExchangeCachePrivate::ctkDicomAbstractExchangeCachePrivate() : lastIncomingData(false)
+ctkDicomAbstractExchangeCachePrivate::ctkDicomAbstractExchangeCachePrivate() :
+  ObjectLocatorCache(&SharedBulkData),
+  IncomingAccessor(new ctkDicomAvailableDataHelper::ctkDicomAvailableDataAccessor(IncomingAvailableData)),
+  lastIncomingData(false)
 {
 
 }
@@ -86,6 +123,13 @@ ctkDicomObjectLocatorCache* ctkDicomAbstractExchangeCache::objectLocatorCache()
   return const_cast<ctkDicomObjectLocatorCache*>(&d->ObjectLocatorCache);
 }
 
+//----------------------------------------------------------------------------
+ctkDicomSharedBulkData* ctkDicomAbstractExchangeCache::sharedBulkData() const
+{
+  Q_D(const ctkDicomAbstractExchangeCache);
+  return const_cast<ctkDicomSharedBulkData*>(&d->SharedBulkData);
+}
+
 //----------------------------------------------------------------------------
 bool ctkDicomAbstractExchangeCache::publishData(const ctkDicomAppHosting::AvailableData& availableData, bool lastData)
 {
@@ -104,7 +148,18 @@ bool ctkDicomAbstractExchangeCache::publishData(const ctkDicomAppHosting::Availa
 //----------------------------------------------------------------------------
 void ctkDicomAbstractExchangeCache::releaseData(const QList<QUuid>& objectUUIDs)
 {
-  Q_UNUSED(objectUUIDs)
+  Q_D(ctkDicomAbstractExchangeCache);
+  foreach(const QUuid& objectUUID, objectUUIDs)
+    {
+    QString objectUuid = objectUUID.toString();
+    ctkDicomAppHosting::ObjectLocator objectLocator;
+    if (d->ObjectLocatorCache.find(objectUuid, objectLocator) &&
+        ctkDicomSharedBulkData::isShared(objectLocator))
+      {
+      d->ObjectLocatorCache.remove(objectUuid);
+      d->SharedBulkData.release(objectUuid);
+      }
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -125,7 +180,7 @@ bool ctkDicomAbstractExchangeCache::lastIncomingData() const
 bool ctkDicomAbstractExchangeCache::notifyDataAvailable(const ctkDicomAppHosting::AvailableData& data, bool lastData)
 {
   Q_D(ctkDicomAbstractExchangeCache);
-  ctkDicomAvailableDataHelper::appendToAvailableData(d->IncomingAvailableData, data);
+  ctkDicomAvailableDataHelper::appendToAvailableData(*d->IncomingAccessor, data);
   d->lastIncomingData = lastData;
   emit internalDataAvailable();
   return true;
@@ -136,5 +191,6 @@ void ctkDicomAbstractExchangeCache::cleanIncomingData()
 {
   Q_D(ctkDicomAbstractExchangeCache);
   d->IncomingAvailableData = ctkDicomAppHosting::AvailableData();
+  d->IncomingAccessor.reset(new ctkDicomAvailableDataHelper::ctkDicomAvailableDataAccessor(d->IncomingAvailableData));
   d->lastIncomingData = false;
 }
\ No newline at end of file
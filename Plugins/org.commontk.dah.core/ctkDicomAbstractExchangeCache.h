@@ -29,6 +29,7 @@
 
 class ctkDicomAbstractExchangeCachePrivate;
 class ctkDicomObjectLocatorCache;
+class ctkDicomSharedBulkData;
 
 /**
  * @brief Provides a basic convenience methods for the data exchange.
@@ -80,6 +81,13 @@ public:
     const QList<QString>& acceptableTransferSyntaxUIDs,
     bool includeBulkData);
 
+  /**
+   * @brief Release the data the other side does not need anymore.
+   *
+   * The shared memory of the data published with sharedBulkData() is released.
+   *
+   * @param objectUUIDs
+  */
   void releaseData(const QList<QUuid>& objectUUIDs);
 
   /**
@@ -89,6 +97,16 @@ public:
   */
   ctkDicomObjectLocatorCache* objectLocatorCache() const;
 
+  /**
+   * @brief Return the shared memory of the outgoing bulk data.
+   *
+   * The locators of the data published there have to be inserted in the
+   * objectLocatorCache() like the locators of files.
+   *
+   * @return ctkDicomSharedBulkData *
+  */
+  ctkDicomSharedBulkData* sharedBulkData() const;
+
   /**
    * @brief Publish data to other side
    *
@@ -38,11 +38,217 @@ protected:
   
 public:
   ctkDicomAvailableDataAccessorPrivate(ctkDicomAppHosting::AvailableData& availableData) : 
-      m_AvailableData(availableData) { };
+      m_AvailableData(availableData), m_Indexed(false) { };
+
+  // position of a study or series in the available data
+  struct Location
+  {
+    Location(int p = -1, int s = -1, int se = -1) : patient(p), study(s), series(se) {}
+    int patient;
+    int study;
+    int series;
+  };
+
+  void buildIndex() const;
+  void indexPatient(int p) const;
+  void indexStudy(int p, int s) const;
+  void indexSeries(int p, int s, int se) const;
+
+  int patientIndex(const QString& patientID) const;
+  Location studyLocation(const QString& studyUID) const;
+  Location seriesLocation(const QString& seriesUID) const;
+
+  // the index of a patient, study or series inside its parent, -1 if not present
+  int studyIndex(int p, const QString& studyUID) const;
+  int seriesIndex(int p, int s, const QString& seriesUID) const;
 
   ctkDicomAppHosting::AvailableData& m_AvailableData;
+
+  // the indexes keep the first entry of an ID, like a linear scan does
+  mutable bool m_Indexed;
+  mutable QHash<QString, int> m_PatientIndex;
+  mutable QHash<QString, Location> m_StudyIndex;
+  mutable QHash<QString, Location> m_SeriesIndex;
 };
 
+//------------------------------------------------------------------------------
+void ctkDicomAvailableDataAccessorPrivate::buildIndex() const
+{
+  m_PatientIndex.clear();
+  m_StudyIndex.clear();
+  m_SeriesIndex.clear();
+  for (int p = 0; p < m_AvailableData.patients.size(); ++p)
+    {
+    indexPatient(p);
+    }
+  m_Indexed = true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDicomAvailableDataAccessorPrivate::indexPatient(int p) const
+{
+  const ctkDicomAppHosting::Patient& patient = m_AvailableData.patients.at(p);
+  if (!m_PatientIndex.contains(patient.id))
+    {
+    m_PatientIndex.insert(patient.id, p);
+    }
+  for (int s = 0; s < patient.studies.size(); ++s)
+    {
+    indexStudy(p, s);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDicomAvailableDataAccessorPrivate::indexStudy(int p, int s) const
+{
+  const ctkDicomAppHosting::Study& study = m_AvailableData.patients.at(p).studies.at(s);
+  if (!m_StudyIndex.contains(study.studyUID))
+    {
+    m_StudyIndex.insert(study.studyUID, Location(p, s));
+    }
+  for (int se = 0; se < study.series.size(); ++se)
+    {
+    indexSeries(p, s, se);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDicomAvailableDataAccessorPrivate::indexSeries(int p, int s, int se) const
+{
+  const QString& seriesUID = m_AvailableData.patients.at(p).studies.at(s).series.at(se).seriesUID;
+  if (!m_SeriesIndex.contains(seriesUID))
+    {
+    m_SeriesIndex.insert(seriesUID, Location(p, s, se));
+    }
+}
+
+//------------------------------------------------------------------------------
+int ctkDicomAvailableDataAccessorPrivate::patientIndex(const QString& patientID) const
+{
+  const QList<ctkDicomAppHosting::Patient>& patients = m_AvailableData.patients;
+  for (int attempt = 0; attempt < 2; ++attempt)
+    {
+    if (!m_Indexed)
+      {
+      buildIndex();
+      }
+    QHash<QString, int>::const_iterator it = m_PatientIndex.find(patientID);
+    if (it == m_PatientIndex.end())
+      {
+      return -1;
+      }
+    if (it.value() < patients.size() && patients.at(it.value()).id == patientID)
+      {
+      return it.value();
+      }
+    // the available data was modified without the accessor
+    m_Indexed = false;
+    }
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+ctkDicomAvailableDataAccessorPrivate::Location ctkDicomAvailableDataAccessorPrivate::studyLocation(
+  const QString& studyUID) const
+{
+  const QList<ctkDicomAppHosting::Patient>& patients = m_AvailableData.patients;
+  for (int attempt = 0; attempt < 2; ++attempt)
+    {
+    if (!m_Indexed)
+      {
+      buildIndex();
+      }
+    QHash<QString, Location>::const_iterator it = m_StudyIndex.find(studyUID);
+    if (it == m_StudyIndex.end())
+      {
+      return Location();
+      }
+    const Location& l = it.value();
+    if (l.patient < patients.size() && l.study < patients.at(l.patient).studies.size() &&
+        patients.at(l.patient).studies.at(l.study).studyUID == studyUID)
+      {
+      return l;
+      }
+    m_Indexed = false;
+    }
+  return Location();
+}
+
+//------------------------------------------------------------------------------
+ctkDicomAvailableDataAccessorPrivate::Location ctkDicomAvailableDataAccessorPrivate::seriesLocation(
+  const QString& seriesUID) const
+{
+  const QList<ctkDicomAppHosting::Patient>& patients = m_AvailableData.patients;
+  for (int attempt = 0; attempt < 2; ++attempt)
+    {
+    if (!m_Indexed)
+      {
+      buildIndex();
+      }
+    QHash<QString, Location>::const_iterator it = m_SeriesIndex.find(seriesUID);
+    if (it == m_SeriesIndex.end())
+      {
+      return Location();
+      }
+    const Location& l = it.value();
+    if (l.patient < patients.size() && l.study < patients.at(l.patient).studies.size() &&
+        l.series < patients.at(l.patient).studies.at(l.study).series.size() &&
+        patients.at(l.patient).studies.at(l.study).series.at(l.series).seriesUID == seriesUID)
+      {
+      return l;
+      }
+    m_Indexed = false;
+    }
+  return Location();
+}
+
+//------------------------------------------------------------------------------
+int ctkDicomAvailableDataAccessorPrivate::studyIndex(int p, const QString& studyUID) const
+{
+  Location l = studyLocation(studyUID);
+  if (l.patient == p)
+    {
+    return l.study;
+    }
+  if (l.patient < 0)
+    {
+    return -1;
+    }
+  // the same study UID in another patient
+  const QList<ctkDicomAppHosting::Study>& studies = m_AvailableData.patients.at(p).studies;
+  for (int s = 0; s < studies.size(); ++s)
+    {
+    if (studies.at(s).studyUID == studyUID)
+      {
+      return s;
+      }
+    }
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+int ctkDicomAvailableDataAccessorPrivate::seriesIndex(int p, int s, const QString& seriesUID) const
+{
+  Location l = seriesLocation(seriesUID);
+  if (l.patient == p && l.study == s)
+    {
+    return l.series;
+    }
+  if (l.patient < 0)
+    {
+    return -1;
+    }
+  const QList<ctkDicomAppHosting::Series>& series = m_AvailableData.patients.at(p).studies.at(s).series;
+  for (int se = 0; se < series.size(); ++se)
+    {
+    if (series.at(se).seriesUID == seriesUID)
+      {
+      return se;
+      }
+    }
+  return -1;
+}
+
 //----------------------------------------------------------------------------
 ctkDicomAvailableDataAccessor::ctkDicomAvailableDataAccessor(ctkDicomAppHosting::AvailableData& ad)
   : d_ptr(new ctkDicomAvailableDataAccessorPrivate(ad))
@@ -51,58 +257,41 @@ ctkDicomAvailableDataAccessor::ctkDicomAvailableDataAccessor(ctkDicomAppHosting:
 
 ctkDicomAvailableDataAccessor::~ctkDicomAvailableDataAccessor() {};
 
+//----------------------------------------------------------------------------
+ctkDicomAppHosting::AvailableData& ctkDicomAvailableDataAccessor::availableData() const
+{
+  const Q_D(ctkDicomAvailableDataAccessor);
+  return d->m_AvailableData;
+}
+
 //----------------------------------------------------------------------------
 ctkDicomAppHosting::Patient* ctkDicomAvailableDataAccessor::getPatient(const ctkDicomAppHosting::Patient& patient) const
 {
   const Q_D(ctkDicomAvailableDataAccessor);
-  ctkDicomAppHosting::AvailableData & ad(d->m_AvailableData);
-  for (QList<ctkDicomAppHosting::Patient>::Iterator pit = ad.patients.begin();
-    pit < ad.patients.end(); pit++)
-    {
-      if(pit->id==patient.id)
-        return &(*pit);
-    }
-  return NULL;
+  int p = d->patientIndex(patient.id);
+  if (p < 0)
+    return NULL;
+  return &d->m_AvailableData.patients[p];
 }
 
 //----------------------------------------------------------------------------
 ctkDicomAppHosting::Study* ctkDicomAvailableDataAccessor::getStudy(const QString& studyUID) const
 {
   const Q_D(ctkDicomAvailableDataAccessor);
-  ctkDicomAppHosting::AvailableData & ad(d->m_AvailableData);
-  for (QList<ctkDicomAppHosting::Patient>::Iterator pit = ad.patients.begin();
-    pit < ad.patients.end(); pit++)
-    {
-    for (QList<ctkDicomAppHosting::Study>::Iterator sit = pit->studies.begin();
-      sit < pit->studies.end(); sit++)
-      {
-          if(sit->studyUID==studyUID)
-            return &(*sit);
-      }
-    }
-  return NULL;
+  ctkDicomAvailableDataAccessorPrivate::Location l = d->studyLocation(studyUID);
+  if (l.patient < 0)
+    return NULL;
+  return &d->m_AvailableData.patients[l.patient].studies[l.study];
 }
 
 //----------------------------------------------------------------------------
 ctkDicomAppHosting::Series* ctkDicomAvailableDataAccessor::getSeries(const QString& seriesUID) const
 {
   const Q_D(ctkDicomAvailableDataAccessor);
-  ctkDicomAppHosting::AvailableData & ad(d->m_AvailableData);
-  for (QList<ctkDicomAppHosting::Patient>::Iterator pit = ad.patients.begin();
-    pit < ad.patients.end(); pit++)
-    {
-    for (QList<ctkDicomAppHosting::Study>::Iterator sit = pit->studies.begin();
-      sit < pit->studies.end(); sit++)
-      {
-      for (QList<ctkDicomAppHosting::Series>::Iterator seit = sit->series.begin();
-        seit < sit->series.end(); seit++)
-        {
-          if(seit->seriesUID==seriesUID)
-            return &(*seit);
-        }
-      }
-    }
-  return NULL;
+  ctkDicomAvailableDataAccessorPrivate::Location l = d->seriesLocation(seriesUID);
+  if (l.patient < 0)
+    return NULL;
+  return &d->m_AvailableData.patients[l.patient].studies[l.study].series[l.series];
 }
 
 //----------------------------------------------------------------------------
@@ -118,31 +307,104 @@ void ctkDicomAvailableDataAccessor::find(const ctkDicomAppHosting::Patient& pati
   patientResult=NULL;
   studyResult=NULL;
   seriesResult=NULL;
-  for (QList<ctkDicomAppHosting::Patient>::Iterator pit = ad.patients.begin();
-    pit < ad.patients.end(); pit++)
+  int p = d->patientIndex(patient.id);
+  if (p < 0)
+    return;
+  patientResult = &ad.patients[p];
+  int s = d->studyIndex(p, studyUID);
+  if (s < 0)
+    return;
+  studyResult = &patientResult->studies[s];
+  int se = d->seriesIndex(p, s, seriesUID);
+  if (se < 0)
+    return;
+  seriesResult = &studyResult->series[se];
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomAvailableDataAccessor::addObjectDescriptor(const ctkDicomAppHosting::Patient& patient,
+                                                        const QString& studyUID,
+                                                        const QString& seriesUID,
+                                                        const ctkDicomAppHosting::ObjectDescriptor& objectDescriptor)
+{
+  Q_D(ctkDicomAvailableDataAccessor);
+  ctkDicomAppHosting::AvailableData & ad(d->m_AvailableData);
+
+  int p = d->patientIndex(patient.id);
+  if (p < 0)
+    {
+    ctkDicomAppHosting::Patient newPatient(patient);
+    newPatient.objectDescriptors.clear();
+    newPatient.studies.clear();
+    ad.patients.append(newPatient);
+    p = ad.patients.size() - 1;
+    d->indexPatient(p);
+    }
+  QList<ctkDicomAppHosting::Study>& studies = ad.patients[p].studies;
+  int s = d->studyIndex(p, studyUID);
+  if (s < 0)
+    {
+    ctkDicomAppHosting::Study study;
+    study.studyUID = studyUID;
+    studies.append(study);
+    s = studies.size() - 1;
+    d->indexStudy(p, s);
+    }
+  QList<ctkDicomAppHosting::Series>& series = studies[s].series;
+  int se = d->seriesIndex(p, s, seriesUID);
+  if (se < 0)
     {
-    if(pit->id==patient.id)
+    ctkDicomAppHosting::Series newSeries;
+    newSeries.seriesUID = seriesUID;
+    series.append(newSeries);
+    se = series.size() - 1;
+    d->indexSeries(p, s, se);
+    }
+  series[se].objectDescriptors.append(objectDescriptor);
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomAvailableDataAccessor::merge(const ctkDicomAppHosting::AvailableData& src)
+{
+  Q_D(ctkDicomAvailableDataAccessor);
+  ctkDicomAppHosting::AvailableData & ad(d->m_AvailableData);
+  ad.objectDescriptors.append(src.objectDescriptors);
+
+  foreach(const ctkDicomAppHosting::Patient& srcPatient, src.patients)
+    {
+    int p = d->patientIndex(srcPatient.id);
+    if (p < 0)
       {
-      patientResult = &(*pit);
-      for (QList<ctkDicomAppHosting::Study>::Iterator sit = pit->studies.begin();
-        sit < pit->studies.end(); sit++)
+      ad.patients.append(srcPatient);
+      d->indexPatient(ad.patients.size() - 1);
+      continue;
+      }
+    ad.patients[p].objectDescriptors.append(srcPatient.objectDescriptors);
+
+    foreach(const ctkDicomAppHosting::Study& srcStudy, srcPatient.studies)
+      {
+      QList<ctkDicomAppHosting::Study>& studies = ad.patients[p].studies;
+      int s = d->studyIndex(p, srcStudy.studyUID);
+      if (s < 0)
+        {
+        studies.append(srcStudy);
+        d->indexStudy(p, studies.size() - 1);
+        continue;
+        }
+      studies[s].objectDescriptors.append(srcStudy.objectDescriptors);
+
+      foreach(const ctkDicomAppHosting::Series& srcSeries, srcStudy.series)
         {
-        if(sit->studyUID==studyUID)
+        QList<ctkDicomAppHosting::Series>& series = studies[s].series;
+        int se = d->seriesIndex(p, s, srcSeries.seriesUID);
+        if (se < 0)
           {
-          studyResult = &(*sit);
-          for (QList<ctkDicomAppHosting::Series>::Iterator seit = sit->series.begin();
-            seit < sit->series.end(); seit++)
-            {
-            if(seit->seriesUID==seriesUID)
-              {
-              seriesResult=&(*seit);
-              return;
-              }
-            }
-            return;
+          series.append(srcSeries);
+          d->indexSeries(p, s, series.size() - 1);
+          continue;
           }
+        series[se].objectDescriptors.append(srcSeries.objectDescriptors);
         }
-      return;
       }
     }
 }
@@ -204,11 +466,11 @@ bool addNonDICOMToAvailableData(ctkDicomAppHosting::AvailableData& data,
 }
 
 
-bool addToAvailableData(ctkDicomAppHosting::AvailableData& data, 
-                        ctkDicomObjectLocatorCache* objectLocatorCache, 
-                        const ctkDICOMItem& dataset, 
-                        long length, 
-                        long offset, 
+bool addToAvailableData(ctkDicomAvailableDataAccessor& accessor,
+                        ctkDicomObjectLocatorCache* objectLocatorCache,
+                        const ctkDICOMItem& dataset,
+                        long length,
+                        long offset,
                         const QString& uri)
 {
   if(objectLocatorCache == NULL)
@@ -238,38 +500,7 @@ bool addToAvailableData(ctkDicomAppHosting::AvailableData& data,
   
 
 
-  ctkDicomAppHosting::Patient* ppatient;
-  ctkDicomAppHosting::Study* pstudy;
-  ctkDicomAppHosting::Series* pseries;
-  
-  ctkDicomAvailableDataAccessor(data).find(patient, study.studyUID, series.seriesUID,
-    ppatient, pstudy, pseries);
-
-  if(pseries==NULL)
-  {
-    series.objectDescriptors.append(objectDescriptor);
-    if(pstudy==NULL)
-    {
-      study.series.append(series);
-      if(ppatient==NULL)
-      {
-        patient.studies.append(study);
-        data.patients.append(patient);
-      }
-      else
-      {
-        ppatient->studies.append(study);
-      }
-    }
-    else
-    {
-      pstudy->series.append(series);
-    }
-  }
-  else
-  {
-    pseries->objectDescriptors.append(objectDescriptor);
-  }
+  accessor.addObjectDescriptor(patient, study.studyUID, series.seriesUID, objectDescriptor);
 
   ctkDicomAppHosting::ObjectLocator locator;
   locator.locator = objectDescriptor.descriptorUUID;
@@ -283,10 +514,31 @@ bool addToAvailableData(ctkDicomAppHosting::AvailableData& data,
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool addToAvailableData(ctkDicomAppHosting::AvailableData& data, 
+                        ctkDicomObjectLocatorCache* objectLocatorCache, 
+                        const ctkDICOMItem& dataset, 
+                        long length, 
+                        long offset, 
+                        const QString& uri)
+{
+  ctkDicomAvailableDataAccessor accessor(data);
+  return addToAvailableData(accessor, objectLocatorCache, dataset, length, offset, uri);
+}
+
 //----------------------------------------------------------------------------
 bool addToAvailableData(ctkDicomAppHosting::AvailableData& data,
                         ctkDicomObjectLocatorCache* objectLocatorCache, 
                         const QString& filename)
+{
+  ctkDicomAvailableDataAccessor accessor(data);
+  return addToAvailableData(accessor, objectLocatorCache, filename);
+}
+
+//----------------------------------------------------------------------------
+bool addToAvailableData(ctkDicomAvailableDataAccessor& accessor,
+                        ctkDicomObjectLocatorCache* objectLocatorCache,
+                        const QString& filename)
 {
   QFileInfo fileinfo(filename);
   qDebug() << filename << " " << fileinfo.exists();
@@ -302,13 +554,13 @@ bool addToAvailableData(ctkDicomAppHosting::AvailableData& data,
        (ext.compare("nrrd") ==0) )
   {
   	  qDebug() << "adding Non DICOM File";
-      return addNonDICOMToAvailableData(data, objectLocatorCache, fileinfo.size(), 0, uri);
+      return addNonDICOMToAvailableData(accessor.availableData(), objectLocatorCache, fileinfo.size(), 0, uri);
   }
   //this could be a DICOM file then
   ctkDICOMItem ctkdataset;
   ctkdataset.InitializeFromFile(filename, EXS_Unknown, EGL_noChange, 400);
 
-  return addToAvailableData(data, objectLocatorCache, ctkdataset, fileinfo.size(), 0, uri);
+  return addToAvailableData(accessor, objectLocatorCache, ctkdataset, fileinfo.size(), 0, uri);
 
 }
 
@@ -316,8 +568,15 @@ bool addToAvailableData(ctkDicomAppHosting::AvailableData& data,
 bool appendToAvailableData(ctkDicomAppHosting::AvailableData& dest,
                         const ctkDicomAppHosting::AvailableData& src)
 {
-  dest.objectDescriptors.append(src.objectDescriptors);
-  dest.patients.append(src.patients);
+  ctkDicomAvailableDataAccessor accessor(dest);
+  return appendToAvailableData(accessor, src);
+}
+
+//----------------------------------------------------------------------------
+bool appendToAvailableData(ctkDicomAvailableDataAccessor& dest,
+                        const ctkDicomAppHosting::AvailableData& src)
+{
+  dest.merge(src);
   return true;
 }
 
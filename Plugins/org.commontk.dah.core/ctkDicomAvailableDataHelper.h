@@ -39,11 +39,25 @@ namespace ctkDicomAvailableDataHelper {
 
 //----------------------------------------------------------------------------
 class ctkDicomAvailableDataAccessorPrivate;
+/**
+ * \brief Accessor of the patients, studies and series of available data.
+ *
+ * The accessor indexes the patients by ID, the studies and the series by UID
+ * on the first lookup, the lookups afterwards do not scan the available data.
+ * The indexes are kept up to date by addObjectDescriptor() and merge(), the
+ * available data should be modified through the accessor while it is used,
+ * other modifications are detected when their entries are looked up.
+ */
 class org_commontk_dah_core_EXPORT ctkDicomAvailableDataAccessor : public QObject
 {
 public:
   ctkDicomAvailableDataAccessor(ctkDicomAppHosting::AvailableData& ad);
   virtual ~ctkDicomAvailableDataAccessor();
+
+  /**
+   * \return the available data of the accessor.
+   */
+  ctkDicomAppHosting::AvailableData& availableData() const;
   
   /**
    * Method used to retrieve information about a specific patient, giving a patient struct with the ID field already 
@@ -71,6 +85,21 @@ public:
                                          ctkDicomAppHosting::Study*& studyResult, 
                                          ctkDicomAppHosting::Series*& seriesResult) const;
 
+  /**
+   * Add an object descriptor to the given series, the patient, study and series are
+   * created when they are not present yet.
+   */
+  void addObjectDescriptor(const ctkDicomAppHosting::Patient& patient,
+                           const QString& studyUID,
+                           const QString& seriesUID,
+                           const ctkDicomAppHosting::ObjectDescriptor& objectDescriptor);
+
+  /**
+   * Merge the source available data: the patients, studies and series present in both
+   * are merged and their object descriptors appended.
+   */
+  void merge(const ctkDicomAppHosting::AvailableData& src);
+
 protected:
   QScopedPointer<ctkDicomAvailableDataAccessorPrivate> d_ptr;
 
@@ -91,6 +120,23 @@ bool org_commontk_dah_core_EXPORT addToAvailableData(ctkDicomAppHosting::Availab
                         ctkDicomObjectLocatorCache* objectLocatorCache, 
                         const QString& filename);
 
+//----------------------------------------------------------------------------
+/**
+ * \brief Add to the available data of the accessor, which keeps its indexes
+ * between the calls when many objects are added.
+ */
+bool org_commontk_dah_core_EXPORT addToAvailableData(ctkDicomAvailableDataAccessor& accessor,
+                        ctkDicomObjectLocatorCache* objectLocatorCache,
+                        const ctkDICOMItem& dataset,
+                        long length,
+                        long offset,
+                        const QString& uri);
+
+//----------------------------------------------------------------------------
+bool org_commontk_dah_core_EXPORT addToAvailableData(ctkDicomAvailableDataAccessor& accessor,
+                        ctkDicomObjectLocatorCache* objectLocatorCache,
+                        const QString& filename);
+
 //----------------------------------------------------------------------------
 bool org_commontk_dah_core_EXPORT addNonDICOMToAvailableData(ctkDicomAppHosting::AvailableData& data, 
                         ctkDicomObjectLocatorCache* objectLocatorCache, 
@@ -100,9 +146,16 @@ bool org_commontk_dah_core_EXPORT addNonDICOMToAvailableData(ctkDicomAppHosting:
                         const QString& uri);
 
 //----------------------------------------------------------------------------
+/**
+ * \brief Merge src into dest, see ctkDicomAvailableDataAccessor::merge().
+ */
 bool org_commontk_dah_core_EXPORT appendToAvailableData(ctkDicomAppHosting::AvailableData& dest,
                         const ctkDicomAppHosting::AvailableData& src);
 
+//----------------------------------------------------------------------------
+bool org_commontk_dah_core_EXPORT appendToAvailableData(ctkDicomAvailableDataAccessor& dest,
+                        const ctkDicomAppHosting::AvailableData& src);
+
 
 //----------------------------------------------------------------------------
 /**
@@ -0,0 +1,249 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+// Qt includes
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QLocalSocket>
+#include <QPair>
+#include <QTimer>
+
+// CTK includes
+#include "ctkDicomBinaryClient.h"
+
+//----------------------------------------------------------------------------
+class ctkDicomBinaryClientPrivate
+{
+public:
+
+  ctkDicomBinaryClientPrivate()
+    : Port(0), RetryInterval(1000), Attempted(false), Greeted(false), LastRequestId(0)
+  {}
+
+  QLocalSocket Socket;
+  int Port;
+  int RetryInterval;
+
+  bool Attempted;
+  QElapsedTimer LastAttempt;
+
+  bool Greeted;
+  QByteArray Buffer;
+  quint32 LastRequestId;
+  QHash<quint32, QPair<quint8, QByteArray> > Replies;
+};
+
+//----------------------------------------------------------------------------
+ctkDicomBinaryClient::ctkDicomBinaryClient(int port, QObject* parent)
+  : QObject(parent), d_ptr(new ctkDicomBinaryClientPrivate())
+{
+  Q_D(ctkDicomBinaryClient);
+  d->Port = port;
+
+  connect(&d->Socket, SIGNAL(readyRead()), this, SLOT(readReplies()));
+  connect(&d->Socket, SIGNAL(disconnected()), this, SLOT(connectionClosed()));
+}
+
+//----------------------------------------------------------------------------
+ctkDicomBinaryClient::~ctkDicomBinaryClient()
+{
+  Q_D(ctkDicomBinaryClient);
+  d->Socket.disconnect(this);
+  d->Socket.abort();
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryClient::setRetryInterval(int msecs)
+{
+  Q_D(ctkDicomBinaryClient);
+  d->RetryInterval = msecs;
+}
+
+//----------------------------------------------------------------------------
+int ctkDicomBinaryClient::retryInterval() const
+{
+  Q_D(const ctkDicomBinaryClient);
+  return d->RetryInterval;
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomBinaryClient::isConnected() const
+{
+  Q_D(const ctkDicomBinaryClient);
+  return d->Greeted && d->Socket.state() == QLocalSocket::ConnectedState;
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomBinaryClient::connectToServer(int timeout)
+{
+  Q_D(ctkDicomBinaryClient);
+
+  this->disconnectFromServer();
+  d->Attempted = true;
+  d->LastAttempt.start();
+
+  d->Socket.connectToServer(ctkDicomBinaryProtocol::serverName(d->Port));
+  if (!d->Socket.waitForConnected(timeout))
+    {
+    // no binary server, the peer only speaks SOAP
+    d->Socket.abort();
+    return false;
+    }
+  d->Socket.write(ctkDicomBinaryProtocol::greeting());
+
+  QEventLoop loop;
+  QTimer timer;
+  timer.setSingleShot(true);
+  connect(this, SIGNAL(replyReceived()), &loop, SLOT(quit()));
+  connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+  timer.start(timeout);
+  while (!d->Greeted && d->Socket.state() == QLocalSocket::ConnectedState && timer.isActive())
+    {
+    loop.exec(QEventLoop::ExcludeUserInputEvents | QEventLoop::WaitForMoreEvents);
+    }
+
+  if (!this->isConnected())
+    {
+    d->Socket.abort();
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryClient::disconnectFromServer()
+{
+  Q_D(ctkDicomBinaryClient);
+  d->Socket.abort();
+  d->Greeted = false;
+  d->Buffer.clear();
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomBinaryClient::call(ctkDicomBinaryProtocol::Method method,
+                                const QByteArray& arguments, QByteArray* result)
+{
+  Q_D(ctkDicomBinaryClient);
+
+  if (!this->isConnected())
+    {
+    if (d->Attempted && d->LastAttempt.elapsed() < d->RetryInterval)
+      {
+      return false;
+      }
+    if (!this->connectToServer())
+      {
+      return false;
+      }
+    }
+
+  quint32 requestId = ++d->LastRequestId;
+  QByteArray frame;
+  ctkDicomBinaryProtocol::appendFrame(frame, requestId, static_cast<quint8>(method), arguments);
+  d->Socket.write(frame);
+  d->Socket.flush();
+
+  // The reply can be received by the event loop of a nested call, which then
+  // quits this loop as well.
+  QEventLoop loop;
+  connect(this, SIGNAL(replyReceived()), &loop, SLOT(quit()));
+  while (!d->Replies.contains(requestId) && this->isConnected())
+    {
+    loop.exec(QEventLoop::ExcludeUserInputEvents | QEventLoop::WaitForMoreEvents);
+    }
+
+  if (!d->Replies.contains(requestId))
+    {
+    qWarning() << "ctkDicomBinaryClient: connection to" << ctkDicomBinaryProtocol::serverName(d->Port)
+               << "lost during request" << method;
+    return false;
+    }
+
+  QPair<quint8, QByteArray> reply = d->Replies.take(requestId);
+  if (reply.first != ctkDicomBinaryProtocol::Ok)
+    {
+    return false;
+    }
+  if (result)
+    {
+    *result = reply.second;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryClient::readReplies()
+{
+  Q_D(ctkDicomBinaryClient);
+
+  d->Buffer.append(d->Socket.readAll());
+
+  int offset = 0;
+  if (!d->Greeted)
+    {
+    if (d->Buffer.size() < ctkDicomBinaryProtocol::GreetingSize)
+      {
+      return;
+      }
+    if (!ctkDicomBinaryProtocol::isValidGreeting(d->Buffer))
+      {
+      // the peer speaks another version of the protocol
+      this->disconnectFromServer();
+      emit replyReceived();
+      return;
+      }
+    d->Greeted = true;
+    offset = ctkDicomBinaryProtocol::GreetingSize;
+    }
+
+  quint32 requestId = 0;
+  quint8 status = 0;
+  QByteArray body;
+  ctkDicomBinaryProtocol::FrameStatus frameStatus;
+  while ((frameStatus = ctkDicomBinaryProtocol::takeFrame(d->Buffer, offset, requestId, status, body))
+         == ctkDicomBinaryProtocol::FrameTaken)
+    {
+    d->Replies.insert(requestId, qMakePair(status, body));
+    }
+
+  if (frameStatus == ctkDicomBinaryProtocol::FrameError)
+    {
+    qWarning() << "ctkDicomBinaryClient: invalid reply received from"
+               << ctkDicomBinaryProtocol::serverName(d->Port);
+    this->disconnectFromServer();
+    }
+  else
+    {
+    d->Buffer.remove(0, offset);
+    }
+  emit replyReceived();
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryClient::connectionClosed()
+{
+  Q_D(ctkDicomBinaryClient);
+  d->Greeted = false;
+  d->Buffer.clear();
+  emit replyReceived();
+}
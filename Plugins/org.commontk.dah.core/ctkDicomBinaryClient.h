@@ -0,0 +1,96 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKDICOMBINARYCLIENT_H
+#define CTKDICOMBINARYCLIENT_H
+
+// Qt includes
+#include <QObject>
+#include <QScopedPointer>
+
+// CTK includes
+#include "ctkDicomBinaryProtocol.h"
+#include <org_commontk_dah_core_Export.h>
+
+class ctkDicomBinaryClientPrivate;
+
+/**
+ * @brief Client of the binary protocol served by ctkDicomBinaryServer.
+ *
+ * The connection is negotiated on the first call. If the peer does not answer the
+ * greeting, call() returns false and the caller submits the request with SOAP; a new
+ * negotiation is attempted after retryInterval() milliseconds.
+ *
+ * Like ctkSimpleSoapClient, call() waits for the reply in a local event loop, so that
+ * the calls made back by the peer while it handles the request are served.
+ */
+class org_commontk_dah_core_EXPORT ctkDicomBinaryClient : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  ctkDicomBinaryClient(int port, QObject* parent = 0);
+  virtual ~ctkDicomBinaryClient();
+
+  /**
+   * @brief Time between two negotiations with a peer which did not answer, 1000 ms by default.
+   */
+  void setRetryInterval(int msecs);
+  int retryInterval() const;
+
+  bool isConnected() const;
+
+  /**
+   * @brief Connect to the server and negotiate the protocol version.
+   *
+   * @return false if the peer has no binary server or does not support the protocol
+   */
+  bool connectToServer(int timeout = 1000);
+
+  void disconnectFromServer();
+
+  /**
+   * @brief Submit a request and wait for its reply.
+   *
+   * @return false if the request has to be submitted with SOAP
+   */
+  bool call(ctkDicomBinaryProtocol::Method method, const QByteArray& arguments, QByteArray* result = 0);
+
+Q_SIGNALS:
+
+  void replyReceived();
+
+private Q_SLOTS:
+
+  void readReplies();
+  void connectionClosed();
+
+private:
+
+  const QScopedPointer<ctkDicomBinaryClientPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(ctkDicomBinaryClient);
+  Q_DISABLE_COPY(ctkDicomBinaryClient);
+};
+
+#endif // CTKDICOMBINARYCLIENT_H
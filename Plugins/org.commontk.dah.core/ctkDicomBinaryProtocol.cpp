@@ -0,0 +1,208 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+// Qt includes
+#include <QtEndian>
+
+// CTK includes
+#include "ctkDicomBinaryProtocol.h"
+
+//----------------------------------------------------------------------------
+QString ctkDicomBinaryProtocol::serverName(int port)
+{
+  return QString("ctkDicomAppHosting_%1").arg(port);
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkDicomBinaryProtocol::greeting()
+{
+  QByteArray data(GreetingSize, '\0');
+  uchar* header = reinterpret_cast<uchar*>(data.data());
+  qToBigEndian<quint32>(Magic, header);
+  qToBigEndian<quint16>(Version, header + 4);
+  return data;
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomBinaryProtocol::isValidGreeting(const QByteArray& data)
+{
+  if (data.size() < GreetingSize)
+    {
+    return false;
+    }
+  const uchar* header = reinterpret_cast<const uchar*>(data.constData());
+  return qFromBigEndian<quint32>(header) == Magic &&
+         qFromBigEndian<quint16>(header + 4) == Version;
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryProtocol::appendFrame(QByteArray& data, quint32 id, quint8 code,
+                                         const QByteArray& body)
+{
+  uchar header[FrameHeaderSize + RequestHeaderSize];
+  qToBigEndian<quint32>(RequestHeaderSize + body.size(), header);
+  qToBigEndian<quint32>(id, header + FrameHeaderSize);
+  header[FrameHeaderSize + 4] = code;
+  data.append(reinterpret_cast<const char*>(header), sizeof(header));
+  data.append(body);
+}
+
+//----------------------------------------------------------------------------
+ctkDicomBinaryProtocol::FrameStatus ctkDicomBinaryProtocol::takeFrame(
+  const QByteArray& data, int& offset, quint32& id, quint8& code, QByteArray& body)
+{
+  if (data.size() - offset < FrameHeaderSize)
+    {
+    return FrameIncomplete;
+    }
+  const uchar* header = reinterpret_cast<const uchar*>(data.constData() + offset);
+  quint32 size = qFromBigEndian<quint32>(header);
+  if (size < static_cast<quint32>(RequestHeaderSize) || size > MaximumFrameSize)
+    {
+    return FrameError;
+    }
+  if (static_cast<quint32>(data.size() - offset - FrameHeaderSize) < size)
+    {
+    return FrameIncomplete;
+    }
+  id = qFromBigEndian<quint32>(header + FrameHeaderSize);
+  code = header[FrameHeaderSize + 4];
+  body = data.mid(offset + FrameHeaderSize + RequestHeaderSize, size - RequestHeaderSize);
+  offset += FrameHeaderSize + size;
+  return FrameTaken;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator<<(QDataStream& stream, State state)
+{
+  return stream << static_cast<qint32>(state);
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator>>(QDataStream& stream, State& state)
+{
+  qint32 value = 0;
+  stream >> value;
+  if (value < IDLE || value > EXIT)
+    {
+    stream.setStatus(QDataStream::ReadCorruptData);
+    }
+  state = static_cast<State>(value);
+  return stream;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator<<(QDataStream& stream, const Status& status)
+{
+  return stream << static_cast<qint32>(status.statusType) << status.codingSchemeDesignator
+                << status.codeValue << status.codeMeaning;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator>>(QDataStream& stream, Status& status)
+{
+  qint32 statusType = 0;
+  stream >> statusType >> status.codingSchemeDesignator >> status.codeValue >> status.codeMeaning;
+  if (statusType < INFORMATION || statusType > FATALERROR)
+    {
+    stream.setStatus(QDataStream::ReadCorruptData);
+    }
+  status.statusType = static_cast<StatusType>(statusType);
+  return stream;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator<<(QDataStream& stream, const ObjectLocator& locator)
+{
+  return stream << locator.locator << locator.source << locator.transferSyntax
+                << locator.length << locator.offset << locator.URI;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator>>(QDataStream& stream, ObjectLocator& locator)
+{
+  return stream >> locator.locator >> locator.source >> locator.transferSyntax
+                >> locator.length >> locator.offset >> locator.URI;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator<<(QDataStream& stream, const ObjectDescriptor& descriptor)
+{
+  return stream << descriptor.descriptorUUID << descriptor.mimeType << descriptor.classUID
+                << descriptor.transferSyntaxUID << descriptor.modality;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator>>(QDataStream& stream, ObjectDescriptor& descriptor)
+{
+  return stream >> descriptor.descriptorUUID >> descriptor.mimeType >> descriptor.classUID
+                >> descriptor.transferSyntaxUID >> descriptor.modality;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator<<(QDataStream& stream, const Series& series)
+{
+  return stream << series.seriesUID << series.objectDescriptors;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator>>(QDataStream& stream, Series& series)
+{
+  return stream >> series.seriesUID >> series.objectDescriptors;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator<<(QDataStream& stream, const Study& study)
+{
+  return stream << study.studyUID << study.objectDescriptors << study.series;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator>>(QDataStream& stream, Study& study)
+{
+  return stream >> study.studyUID >> study.objectDescriptors >> study.series;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator<<(QDataStream& stream, const Patient& patient)
+{
+  return stream << patient.name << patient.id << patient.assigningAuthority << patient.sex
+                << patient.birthDate << patient.objectDescriptors << patient.studies;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator>>(QDataStream& stream, Patient& patient)
+{
+  return stream >> patient.name >> patient.id >> patient.assigningAuthority >> patient.sex
+                >> patient.birthDate >> patient.objectDescriptors >> patient.studies;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator<<(QDataStream& stream, const AvailableData& data)
+{
+  return stream << data.objectDescriptors << data.patients;
+}
+
+//----------------------------------------------------------------------------
+QDataStream& ctkDicomAppHosting::operator>>(QDataStream& stream, AvailableData& data)
+{
+  return stream >> data.objectDescriptors >> data.patients;
+}
@@ -0,0 +1,216 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKDICOMBINARYPROTOCOL_H
+#define CTKDICOMBINARYPROTOCOL_H
+
+// Qt includes
+#include <QByteArray>
+#include <QDataStream>
+#include <QRect>
+#include <QStringList>
+#include <QUuid>
+
+// CTK includes
+#include "ctkDicomAppHostingTypes.h"
+#include <org_commontk_dah_core_Export.h>
+
+/**
+ * @brief Binary protocol of the DICOM App Hosting calls between processes on the same host.
+ *
+ * The hosting system and the hosted application listen on a local socket named after
+ * the port of their SOAP server (see serverName()). A client opens the connection with
+ * a greeting of 8 bytes: the magic number and its protocol version as big endian quint32 and
+ * quint16, followed by two reserved bytes. The server answers with the same greeting, the
+ * client falls back to SOAP if there is no server or if the versions differ.
+ *
+ * After the greeting a request is a frame made of the size of the rest of the frame
+ * (quint32), the id of the request (quint32), the method (quint8) and its arguments
+ * serialized with QDataStream. The reply frame carries the id of the request, a
+ * ReplyStatus (quint8) and the return value.
+ */
+namespace ctkDicomBinaryProtocol {
+
+  //----------------------------------------------------------------------------
+  enum Method {
+    GetState = 1,
+    SetState,
+    BringToFront,
+    GenerateUID,
+    GetAvailableScreen,
+    GetOutputLocation,
+    NotifyStateChanged,
+    NotifyStatus,
+    NotifyDataAvailable,
+    GetData,
+    ReleaseData
+  };
+
+  //----------------------------------------------------------------------------
+  enum ReplyStatus {
+    Ok = 0,
+    /// The method is not known or not served by the peer, the call has to be made with SOAP.
+    Unsupported,
+    /// The arguments could not be read.
+    InvalidArguments
+  };
+
+  const quint32 Magic = 0x63746b48; // "ctkH"
+  const quint16 Version = 1;
+  const int GreetingSize = 8;
+  const int FrameHeaderSize = 4;
+  const int RequestHeaderSize = 5;
+  /// Frames bigger than that are considered as a protocol error.
+  const quint32 MaximumFrameSize = 256 * 1024 * 1024;
+  const int StreamVersion = QDataStream::Qt_4_6;
+
+  /**
+   * @brief Name of the local socket of the DAH server listening on the given port.
+   */
+  org_commontk_dah_core_EXPORT QString serverName(int port);
+
+  /**
+   * @brief Greeting sent by the client and answered by the server.
+   */
+  org_commontk_dah_core_EXPORT QByteArray greeting();
+
+  /**
+   * @brief Check the greeting received from the peer.
+   */
+  org_commontk_dah_core_EXPORT bool isValidGreeting(const QByteArray& data);
+
+  /**
+   * @brief Append a frame with the given header and body to data.
+   */
+  org_commontk_dah_core_EXPORT void appendFrame(QByteArray& data, quint32 id, quint8 code,
+                                                const QByteArray& body);
+
+  //----------------------------------------------------------------------------
+  enum FrameStatus {
+    FrameTaken,
+    FrameIncomplete,
+    FrameError
+  };
+
+  /**
+   * @brief Take the frame at offset from data and move offset after it.
+   */
+  org_commontk_dah_core_EXPORT FrameStatus takeFrame(const QByteArray& data, int& offset,
+                                                     quint32& id, quint8& code, QByteArray& body);
+
+  //----------------------------------------------------------------------------
+  template<typename T1>
+  QByteArray pack(const T1& value1)
+  {
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(StreamVersion);
+    stream << value1;
+    return data;
+  }
+
+  //----------------------------------------------------------------------------
+  template<typename T1, typename T2>
+  QByteArray pack(const T1& value1, const T2& value2)
+  {
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(StreamVersion);
+    stream << value1 << value2;
+    return data;
+  }
+
+  //----------------------------------------------------------------------------
+  template<typename T1, typename T2, typename T3>
+  QByteArray pack(const T1& value1, const T2& value2, const T3& value3)
+  {
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(StreamVersion);
+    stream << value1 << value2 << value3;
+    return data;
+  }
+
+  //----------------------------------------------------------------------------
+  template<typename T1>
+  bool unpack(const QByteArray& data, T1& value1)
+  {
+    QDataStream stream(data);
+    stream.setVersion(StreamVersion);
+    stream >> value1;
+    return stream.status() == QDataStream::Ok;
+  }
+
+  //----------------------------------------------------------------------------
+  template<typename T1, typename T2>
+  bool unpack(const QByteArray& data, T1& value1, T2& value2)
+  {
+    QDataStream stream(data);
+    stream.setVersion(StreamVersion);
+    stream >> value1 >> value2;
+    return stream.status() == QDataStream::Ok;
+  }
+
+  //----------------------------------------------------------------------------
+  template<typename T1, typename T2, typename T3>
+  bool unpack(const QByteArray& data, T1& value1, T2& value2, T3& value3)
+  {
+    QDataStream stream(data);
+    stream.setVersion(StreamVersion);
+    stream >> value1 >> value2 >> value3;
+    return stream.status() == QDataStream::Ok;
+  }
+
+}
+
+namespace ctkDicomAppHosting {
+
+//----------------------------------------------------------------------------
+// Serialization operators of the binary protocol
+
+org_commontk_dah_core_EXPORT QDataStream& operator<<(QDataStream& stream, State state);
+org_commontk_dah_core_EXPORT QDataStream& operator>>(QDataStream& stream, State& state);
+
+org_commontk_dah_core_EXPORT QDataStream& operator<<(QDataStream& stream, const Status& status);
+org_commontk_dah_core_EXPORT QDataStream& operator>>(QDataStream& stream, Status& status);
+
+org_commontk_dah_core_EXPORT QDataStream& operator<<(QDataStream& stream, const ObjectLocator& locator);
+org_commontk_dah_core_EXPORT QDataStream& operator>>(QDataStream& stream, ObjectLocator& locator);
+
+org_commontk_dah_core_EXPORT QDataStream& operator<<(QDataStream& stream, const ObjectDescriptor& descriptor);
+org_commontk_dah_core_EXPORT QDataStream& operator>>(QDataStream& stream, ObjectDescriptor& descriptor);
+
+org_commontk_dah_core_EXPORT QDataStream& operator<<(QDataStream& stream, const Series& series);
+org_commontk_dah_core_EXPORT QDataStream& operator>>(QDataStream& stream, Series& series);
+
+org_commontk_dah_core_EXPORT QDataStream& operator<<(QDataStream& stream, const Study& study);
+org_commontk_dah_core_EXPORT QDataStream& operator>>(QDataStream& stream, Study& study);
+
+org_commontk_dah_core_EXPORT QDataStream& operator<<(QDataStream& stream, const Patient& patient);
+org_commontk_dah_core_EXPORT QDataStream& operator>>(QDataStream& stream, Patient& patient);
+
+org_commontk_dah_core_EXPORT QDataStream& operator<<(QDataStream& stream, const AvailableData& data);
+org_commontk_dah_core_EXPORT QDataStream& operator>>(QDataStream& stream, AvailableData& data);
+
+}
+
+#endif // CTKDICOMBINARYPROTOCOL_H
@@ -0,0 +1,380 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+// Qt includes
+#include <QDebug>
+#include <QHash>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMutex>
+#include <QPointer>
+#include <QtEndian>
+
+// CTK includes
+#include "ctkDicomBinaryServer.h"
+#include "ctkDicomBinaryProtocol.h"
+#include "ctkDicomAppInterface.h"
+#include "ctkDicomHostInterface.h"
+
+//----------------------------------------------------------------------------
+class ctkDicomBinaryServerPrivate
+{
+public:
+
+  struct Connection
+  {
+    Connection() : Greeted(false) {}
+    bool Greeted;
+    QByteArray Buffer;
+  };
+
+  ctkDicomBinaryServerPrivate()
+    : ExchangeInterface(0)
+  {}
+
+  /// Call the method of the interface, return a ctkDicomBinaryProtocol::ReplyStatus.
+  quint8 dispatch(quint8 method, const QByteArray& arguments, QByteArray& result);
+
+  /// Close the connection after a protocol error.
+  void dropConnection(QLocalSocket* socket);
+
+  QLocalServer Server;
+  QHash<QLocalSocket*, Connection> Connections;
+
+  QMutex Mutex;
+  ctkDicomExchangeInterface* ExchangeInterface;
+};
+
+//----------------------------------------------------------------------------
+quint8 ctkDicomBinaryServerPrivate::dispatch(quint8 method, const QByteArray& arguments,
+                                             QByteArray& result)
+{
+  ctkDicomExchangeInterface* exchangeInterface = 0;
+  {
+    QMutexLocker lock(&this->Mutex);
+    exchangeInterface = this->ExchangeInterface;
+  }
+  if (exchangeInterface == 0)
+    {
+    return ctkDicomBinaryProtocol::Unsupported;
+    }
+  ctkDicomHostInterface* hostInterface = dynamic_cast<ctkDicomHostInterface*>(exchangeInterface);
+  ctkDicomAppInterface* appInterface = dynamic_cast<ctkDicomAppInterface*>(exchangeInterface);
+
+  switch (method)
+    {
+    case ctkDicomBinaryProtocol::GetState:
+      {
+      if (appInterface == 0)
+        {
+        return ctkDicomBinaryProtocol::Unsupported;
+        }
+      result = ctkDicomBinaryProtocol::pack(appInterface->getState());
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::SetState:
+      {
+      ctkDicomAppHosting::State state;
+      if (appInterface == 0)
+        {
+        return ctkDicomBinaryProtocol::Unsupported;
+        }
+      if (!ctkDicomBinaryProtocol::unpack(arguments, state))
+        {
+        return ctkDicomBinaryProtocol::InvalidArguments;
+        }
+      result = ctkDicomBinaryProtocol::pack(appInterface->setState(state));
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::BringToFront:
+      {
+      QRect requestedScreenArea;
+      if (appInterface == 0)
+        {
+        return ctkDicomBinaryProtocol::Unsupported;
+        }
+      if (!ctkDicomBinaryProtocol::unpack(arguments, requestedScreenArea))
+        {
+        return ctkDicomBinaryProtocol::InvalidArguments;
+        }
+      result = ctkDicomBinaryProtocol::pack(appInterface->bringToFront(requestedScreenArea));
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::GenerateUID:
+      {
+      if (hostInterface == 0)
+        {
+        return ctkDicomBinaryProtocol::Unsupported;
+        }
+      result = ctkDicomBinaryProtocol::pack(hostInterface->generateUID());
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::GetAvailableScreen:
+      {
+      QRect preferredScreen;
+      if (hostInterface == 0)
+        {
+        return ctkDicomBinaryProtocol::Unsupported;
+        }
+      if (!ctkDicomBinaryProtocol::unpack(arguments, preferredScreen))
+        {
+        return ctkDicomBinaryProtocol::InvalidArguments;
+        }
+      result = ctkDicomBinaryProtocol::pack(hostInterface->getAvailableScreen(preferredScreen));
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::GetOutputLocation:
+      {
+      QStringList preferredProtocols;
+      if (hostInterface == 0)
+        {
+        return ctkDicomBinaryProtocol::Unsupported;
+        }
+      if (!ctkDicomBinaryProtocol::unpack(arguments, preferredProtocols))
+        {
+        return ctkDicomBinaryProtocol::InvalidArguments;
+        }
+      result = ctkDicomBinaryProtocol::pack(hostInterface->getOutputLocation(preferredProtocols));
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::NotifyStateChanged:
+      {
+      ctkDicomAppHosting::State state;
+      if (hostInterface == 0)
+        {
+        return ctkDicomBinaryProtocol::Unsupported;
+        }
+      if (!ctkDicomBinaryProtocol::unpack(arguments, state))
+        {
+        return ctkDicomBinaryProtocol::InvalidArguments;
+        }
+      hostInterface->notifyStateChanged(state);
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::NotifyStatus:
+      {
+      ctkDicomAppHosting::Status status;
+      if (hostInterface == 0)
+        {
+        return ctkDicomBinaryProtocol::Unsupported;
+        }
+      if (!ctkDicomBinaryProtocol::unpack(arguments, status))
+        {
+        return ctkDicomBinaryProtocol::InvalidArguments;
+        }
+      hostInterface->notifyStatus(status);
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::NotifyDataAvailable:
+      {
+      ctkDicomAppHosting::AvailableData data;
+      bool lastData = false;
+      if (!ctkDicomBinaryProtocol::unpack(arguments, data, lastData))
+        {
+        return ctkDicomBinaryProtocol::InvalidArguments;
+        }
+      result = ctkDicomBinaryProtocol::pack(exchangeInterface->notifyDataAvailable(data, lastData));
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::GetData:
+      {
+      QList<QUuid> objectUUIDs;
+      QList<QString> acceptableTransferSyntaxUIDs;
+      bool includeBulkData = false;
+      if (!ctkDicomBinaryProtocol::unpack(arguments, objectUUIDs, acceptableTransferSyntaxUIDs, includeBulkData))
+        {
+        return ctkDicomBinaryProtocol::InvalidArguments;
+        }
+      result = ctkDicomBinaryProtocol::pack(
+        exchangeInterface->getData(objectUUIDs, acceptableTransferSyntaxUIDs, includeBulkData));
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    case ctkDicomBinaryProtocol::ReleaseData:
+      {
+      QList<QUuid> objectUUIDs;
+      if (!ctkDicomBinaryProtocol::unpack(arguments, objectUUIDs))
+        {
+        return ctkDicomBinaryProtocol::InvalidArguments;
+        }
+      exchangeInterface->releaseData(objectUUIDs);
+      return ctkDicomBinaryProtocol::Ok;
+      }
+    default:
+      return ctkDicomBinaryProtocol::Unsupported;
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryServerPrivate::dropConnection(QLocalSocket* socket)
+{
+  this->Connections.remove(socket);
+  socket->disconnect();
+  socket->abort();
+  socket->deleteLater();
+}
+
+//----------------------------------------------------------------------------
+ctkDicomBinaryServer::ctkDicomBinaryServer(QObject* parent)
+  : QObject(parent), d_ptr(new ctkDicomBinaryServerPrivate())
+{
+  Q_D(ctkDicomBinaryServer);
+  connect(&d->Server, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+}
+
+//----------------------------------------------------------------------------
+ctkDicomBinaryServer::~ctkDicomBinaryServer()
+{
+  this->close();
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomBinaryServer::listen(int port)
+{
+  Q_D(ctkDicomBinaryServer);
+  QString name = ctkDicomBinaryProtocol::serverName(port);
+
+  // remove the socket file left by a server which did not shut down
+  QLocalServer::removeServer(name);
+  if (!d->Server.listen(name))
+    {
+    qWarning() << "ctkDicomBinaryServer: listening to" << name << "failed:" << d->Server.errorString();
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryServer::close()
+{
+  Q_D(ctkDicomBinaryServer);
+  foreach(QLocalSocket* socket, d->Connections.keys())
+    {
+    d->dropConnection(socket);
+    }
+  d->Server.close();
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomBinaryServer::isListening() const
+{
+  Q_D(const ctkDicomBinaryServer);
+  return d->Server.isListening();
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryServer::setExchangeInterface(ctkDicomExchangeInterface* exchangeInterface)
+{
+  Q_D(ctkDicomBinaryServer);
+  QMutexLocker lock(&d->Mutex);
+  d->ExchangeInterface = exchangeInterface;
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryServer::acceptConnections()
+{
+  Q_D(ctkDicomBinaryServer);
+  while (d->Server.hasPendingConnections())
+    {
+    QLocalSocket* socket = d->Server.nextPendingConnection();
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readRequests()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(removeConnection()));
+    d->Connections.insert(socket, ctkDicomBinaryServerPrivate::Connection());
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryServer::readRequests()
+{
+  Q_D(ctkDicomBinaryServer);
+  QPointer<QLocalSocket> socket = qobject_cast<QLocalSocket*>(this->sender());
+  if (socket.isNull() || !d->Connections.contains(socket))
+    {
+    return;
+    }
+  d->Connections[socket].Buffer.append(socket->readAll());
+
+  // The connection is looked up again after each request: the interface may run
+  // an event loop which reads the next requests or closes the connection.
+  while (!socket.isNull() && d->Connections.contains(socket))
+    {
+    ctkDicomBinaryServerPrivate::Connection& connection = d->Connections[socket];
+    if (!connection.Greeted)
+      {
+      if (connection.Buffer.size() < ctkDicomBinaryProtocol::GreetingSize)
+        {
+        return;
+        }
+      if (qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(connection.Buffer.constData()))
+          != ctkDicomBinaryProtocol::Magic)
+        {
+        qWarning() << "ctkDicomBinaryServer: invalid greeting, closing the connection";
+        d->dropConnection(socket);
+        return;
+        }
+      // a client of another version closes the connection when it gets our greeting
+      connection.Greeted = true;
+      connection.Buffer.remove(0, ctkDicomBinaryProtocol::GreetingSize);
+      socket->write(ctkDicomBinaryProtocol::greeting());
+      socket->flush();
+      continue;
+      }
+
+    int offset = 0;
+    quint32 requestId = 0;
+    quint8 method = 0;
+    QByteArray arguments;
+    ctkDicomBinaryProtocol::FrameStatus status =
+      ctkDicomBinaryProtocol::takeFrame(connection.Buffer, offset, requestId, method, arguments);
+    if (status == ctkDicomBinaryProtocol::FrameIncomplete)
+      {
+      return;
+      }
+    if (status == ctkDicomBinaryProtocol::FrameError)
+      {
+      qWarning() << "ctkDicomBinaryServer: invalid request, closing the connection";
+      d->dropConnection(socket);
+      return;
+      }
+    connection.Buffer.remove(0, offset);
+
+    QByteArray result;
+    quint8 replyStatus = d->dispatch(method, arguments, result);
+    if (socket.isNull() || !d->Connections.contains(socket))
+      {
+      return;
+      }
+    QByteArray reply;
+    ctkDicomBinaryProtocol::appendFrame(reply, requestId, replyStatus, result);
+    socket->write(reply);
+    socket->flush();
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomBinaryServer::removeConnection()
+{
+  Q_D(ctkDicomBinaryServer);
+  QLocalSocket* socket = qobject_cast<QLocalSocket*>(this->sender());
+  if (socket && d->Connections.remove(socket))
+    {
+    socket->deleteLater();
+    }
+}
@@ -0,0 +1,79 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKDICOMBINARYSERVER_H
+#define CTKDICOMBINARYSERVER_H
+
+// Qt includes
+#include <QObject>
+#include <QScopedPointer>
+
+// CTK includes
+#include <org_commontk_dah_core_Export.h>
+
+struct ctkDicomExchangeInterface;
+class ctkDicomBinaryServerPrivate;
+
+/**
+ * @brief Local socket server of the binary protocol, next to the SOAP server of a DAH peer.
+ *
+ * The requests are dispatched in the thread of the server to the interface set with
+ * setExchangeInterface(). The host and application methods are served if the interface
+ * is a ctkDicomHostInterface or a ctkDicomAppInterface respectively, the other ones are
+ * replied with ctkDicomBinaryProtocol::Unsupported so that the client uses SOAP.
+ */
+class org_commontk_dah_core_EXPORT ctkDicomBinaryServer : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  ctkDicomBinaryServer(QObject* parent = 0);
+  virtual ~ctkDicomBinaryServer();
+
+  /**
+   * @brief Listen on the local socket of the given SOAP port, see ctkDicomBinaryProtocol::serverName().
+   */
+  bool listen(int port);
+  void close();
+  bool isListening() const;
+
+  /**
+   * @brief Set the interface the requests are dispatched to, 0 to reply to all of them with Unsupported.
+   */
+  void setExchangeInterface(ctkDicomExchangeInterface* exchangeInterface);
+
+private Q_SLOTS:
+
+  void acceptConnections();
+  void readRequests();
+  void removeConnection();
+
+private:
+
+  const QScopedPointer<ctkDicomBinaryServerPrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(ctkDicomBinaryServer);
+  Q_DISABLE_COPY(ctkDicomBinaryServer);
+};
+
+#endif // CTKDICOMBINARYSERVER_H
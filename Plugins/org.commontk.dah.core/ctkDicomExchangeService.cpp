@@ -19,29 +19,90 @@
 
 =============================================================================*/
 
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QTimer>
+
 #include "ctkDicomExchangeService.h"
 
 #include "ctkSimpleSoapClient.h"
 
 #include "ctkDicomAppHostingTypesHelper.h"
+#include "ctkDicomAvailableDataHelper.h"
+#include "ctkDicomBinaryClient.h"
 
 //----------------------------------------------------------------------------
-ctkDicomExchangeService::ctkDicomExchangeService(ushort port, QString path)
-  : ctkSimpleSoapClient(port, path)
+class ctkDicomExchangeServicePrivate
 {
+public:
+
+  ctkDicomExchangeServicePrivate()
+    : BinaryClient(0), PendingLastData(false), FlushScheduled(false)
+  {}
+
+  typedef QList<QFutureInterface<bool> > BatchInterfaces;
+  typedef QFutureInterface<QList<ctkDicomAppHosting::ObjectLocator> > GetDataInterface;
 
+  ctkDicomBinaryClient* BinaryClient;
+
+  /// Data queued by notifyDataAvailableAsync() for the next batch.
+  ctkDicomAppHosting::AvailableData PendingData;
+  bool PendingLastData;
+  BatchInterfaces PendingInterfaces;
+  bool FlushScheduled;
+
+  /// Requests sent with SOAP, waiting for their response.
+  QHash<QObject*, BatchInterfaces> SentBatches;
+  QHash<QObject*, GetDataInterface> SentGetData;
+};
+
+//----------------------------------------------------------------------------
+ctkDicomExchangeService::ctkDicomExchangeService(ushort port, QString path)
+  : ctkSimpleSoapClient(port, path), d_ptr(new ctkDicomExchangeServicePrivate())
+{
+  Q_D(ctkDicomExchangeService);
+  d->BinaryClient = new ctkDicomBinaryClient(port, this);
 }
 
 //----------------------------------------------------------------------------
 ctkDicomExchangeService::~ctkDicomExchangeService()
 {
+  Q_D(ctkDicomExchangeService);
 
+  QList<ctkDicomExchangeServicePrivate::BatchInterfaces> batches = d->SentBatches.values();
+  batches << d->PendingInterfaces;
+  foreach(ctkDicomExchangeServicePrivate::BatchInterfaces batch, batches)
+    {
+    for (int i = 0; i < batch.size(); ++i)
+      {
+      batch[i].reportCanceled();
+      batch[i].reportFinished();
+      }
+    }
+  foreach(ctkDicomExchangeServicePrivate::GetDataInterface futureInterface, d->SentGetData.values())
+    {
+    futureInterface.reportCanceled();
+    futureInterface.reportFinished();
+    }
 }
 
 //----------------------------------------------------------------------------
 bool ctkDicomExchangeService::notifyDataAvailable(
     const ctkDicomAppHosting::AvailableData& data, bool lastData)
 {
+  // keep the order of the notifications
+  this->flushDataAvailable();
+
+  QByteArray binaryResult;
+  bool received = false;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::NotifyDataAvailable,
+                                ctkDicomBinaryProtocol::pack(data, lastData), &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, received))
+    {
+    return received;
+    }
+
   QList<QtSoapType*> list;
   list << new ctkDicomSoapAvailableData("data", data);
   list << new ctkDicomSoapBool("lastData", lastData);
@@ -54,6 +115,17 @@ QList<ctkDicomAppHosting::ObjectLocator> ctkDicomExchangeService::getData(
     const QList<QUuid>& objectUUIDs,
     const QList<QString>& acceptableTransferSyntaxUIDs, bool includeBulkData)
 {
+  QByteArray binaryResult;
+  QList<ctkDicomAppHosting::ObjectLocator> objectLocators;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::GetData,
+                                ctkDicomBinaryProtocol::pack(objectUUIDs, acceptableTransferSyntaxUIDs,
+                                                             includeBulkData),
+                                &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, objectLocators))
+    {
+    return objectLocators;
+    }
+
   //Q_D(ctkDicomService);
   QList<QtSoapType*> list;
 
@@ -76,9 +148,173 @@ DumpAll(result); //xxx
 //----------------------------------------------------------------------------
 void ctkDicomExchangeService::releaseData(const QList<QUuid>& objectUUIDs)
 {
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::ReleaseData,
+                                ctkDicomBinaryProtocol::pack(objectUUIDs)))
+    {
+    return;
+    }
+
   QList<QtSoapType*> list;
 
   list << new ctkDicomSoapArrayOfUUIDS("objects",objectUUIDs);
    submitSoapRequest("ReleaseData",list);
   return;
 }
+
+//----------------------------------------------------------------------------
+bool ctkDicomExchangeService::submitBinaryRequest(ctkDicomBinaryProtocol::Method method,
+                                                  const QByteArray& arguments, QByteArray* result)
+{
+  Q_D(ctkDicomExchangeService);
+  return d->BinaryClient->call(method, arguments, result);
+}
+
+//----------------------------------------------------------------------------
+QFuture<bool> ctkDicomExchangeService::notifyDataAvailableAsync(
+    const ctkDicomAppHosting::AvailableData& data, bool lastData)
+{
+  Q_D(ctkDicomExchangeService);
+
+  ctkDicomAvailableDataHelper::appendToAvailableData(d->PendingData, data);
+  d->PendingLastData = lastData;
+
+  QFutureInterface<bool> futureInterface;
+  futureInterface.reportStarted();
+  d->PendingInterfaces.append(futureInterface);
+
+  if (!d->FlushScheduled)
+    {
+    d->FlushScheduled = true;
+    QTimer::singleShot(0, this, SLOT(flushDataAvailable()));
+    }
+  return futureInterface.future();
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomExchangeService::flushDataAvailable()
+{
+  Q_D(ctkDicomExchangeService);
+
+  d->FlushScheduled = false;
+  if (d->PendingInterfaces.isEmpty())
+    {
+    return;
+    }
+
+  ctkDicomAppHosting::AvailableData data = d->PendingData;
+  bool lastData = d->PendingLastData;
+  ctkDicomExchangeServicePrivate::BatchInterfaces batch = d->PendingInterfaces;
+  d->PendingData = ctkDicomAppHosting::AvailableData();
+  d->PendingLastData = false;
+  d->PendingInterfaces.clear();
+
+  QByteArray binaryResult;
+  bool received = false;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::NotifyDataAvailable,
+                                ctkDicomBinaryProtocol::pack(data, lastData), &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, received))
+    {
+    for (int i = 0; i < batch.size(); ++i)
+      {
+      batch[i].reportResult(received);
+      batch[i].reportFinished();
+      }
+    return;
+    }
+
+  QList<QtSoapType*> list;
+  list << new ctkDicomSoapAvailableData("data", data);
+  list << new ctkDicomSoapBool("lastData", lastData);
+
+  QFutureWatcher<QtSoapMessage>* watcher = new QFutureWatcher<QtSoapMessage>(this);
+  connect(watcher, SIGNAL(finished()), this, SLOT(dataAvailableBatchFinished()));
+  d->SentBatches.insert(watcher, batch);
+  watcher->setFuture(this->submitSoapRequestAsync("NotifyDataAvailable", list));
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomExchangeService::dataAvailableBatchFinished()
+{
+  Q_D(ctkDicomExchangeService);
+
+  QFutureWatcher<QtSoapMessage>* watcher = static_cast<QFutureWatcher<QtSoapMessage>*>(this->sender());
+  watcher->deleteLater();
+  if (!d->SentBatches.contains(watcher))
+    {
+    return;
+    }
+  ctkDicomExchangeServicePrivate::BatchInterfaces batch = d->SentBatches.take(watcher);
+
+  bool received = false;
+  if (!watcher->isCanceled())
+    {
+    QtSoapMessage response = watcher->result();
+    received = !response.isFault() && ctkDicomSoapBool::getBool(response.returnValue());
+    }
+  for (int i = 0; i < batch.size(); ++i)
+    {
+    batch[i].reportResult(received);
+    batch[i].reportFinished();
+    }
+}
+
+//----------------------------------------------------------------------------
+QFuture<QList<ctkDicomAppHosting::ObjectLocator> > ctkDicomExchangeService::getDataAsync(
+    const QList<QUuid>& objectUUIDs,
+    const QList<QString>& acceptableTransferSyntaxUIDs, bool includeBulkData)
+{
+  Q_D(ctkDicomExchangeService);
+
+  ctkDicomExchangeServicePrivate::GetDataInterface futureInterface;
+  futureInterface.reportStarted();
+
+  QByteArray binaryResult;
+  QList<ctkDicomAppHosting::ObjectLocator> objectLocators;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::GetData,
+                                ctkDicomBinaryProtocol::pack(objectUUIDs, acceptableTransferSyntaxUIDs,
+                                                             includeBulkData),
+                                &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, objectLocators))
+    {
+    futureInterface.reportResult(objectLocators);
+    futureInterface.reportFinished();
+    return futureInterface.future();
+    }
+
+  QList<QtSoapType*> list;
+  list << new ctkDicomSoapArrayOfUUIDS("objects",objectUUIDs);
+  list << new ctkDicomSoapArrayOfUIDS("acceptableTransferSyntaxes", acceptableTransferSyntaxUIDs);
+  list << new ctkDicomSoapBool("includeBulkData", includeBulkData);
+
+  QFutureWatcher<QtSoapMessage>* watcher = new QFutureWatcher<QtSoapMessage>(this);
+  connect(watcher, SIGNAL(finished()), this, SLOT(getDataFinished()));
+  d->SentGetData.insert(watcher, futureInterface);
+  watcher->setFuture(this->submitSoapRequestAsync("GetData", list));
+  return futureInterface.future();
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomExchangeService::getDataFinished()
+{
+  Q_D(ctkDicomExchangeService);
+
+  QFutureWatcher<QtSoapMessage>* watcher = static_cast<QFutureWatcher<QtSoapMessage>*>(this->sender());
+  watcher->deleteLater();
+  if (!d->SentGetData.contains(watcher))
+    {
+    return;
+    }
+  ctkDicomExchangeServicePrivate::GetDataInterface futureInterface = d->SentGetData.take(watcher);
+
+  QList<ctkDicomAppHosting::ObjectLocator> objectLocators;
+  if (!watcher->isCanceled())
+    {
+    QtSoapMessage response = watcher->result();
+    if (!response.isFault())
+      {
+      objectLocators = ctkDicomSoapArrayOfObjectLocators::getArray(response.returnValue());
+      }
+    }
+  futureInterface.reportResult(objectLocators);
+  futureInterface.reportFinished();
+}
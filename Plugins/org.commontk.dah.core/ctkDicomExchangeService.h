@@ -23,14 +23,28 @@
 #ifndef CTKDICOMEXCHANGESERVICE_H
 #define CTKDICOMEXCHANGESERVICE_H
 
+#include <QFuture>
+
 #include "ctkSimpleSoapClient.h"
+#include "ctkDicomBinaryProtocol.h"
 #include "ctkDicomExchangeInterface.h"
 
 #include <org_commontk_dah_core_Export.h>
 
+class ctkDicomExchangeServicePrivate;
+
+/**
+ * Client of the exchange methods of a DAH peer. The calls are submitted with the
+ * binary protocol of ctkDicomBinaryClient when the peer supports it, with SOAP otherwise.
+ *
+ * The asynchronous methods return futures finished by the event loop of the thread
+ * of the service. The notifyDataAvailableAsync() calls made until the control returns
+ * to the event loop are merged and sent as a single request.
+ */
 class org_commontk_dah_core_EXPORT ctkDicomExchangeService :
     public ctkSimpleSoapClient, public virtual ctkDicomExchangeInterface
 {
+  Q_OBJECT
 
 public:
 
@@ -46,6 +60,45 @@ public:
 
   void releaseData(const QList<QUuid>& objectUUIDs);
 
+  /**
+   * Queue the data for the next batch of notifyDataAvailable. The batch is
+   * flagged as last data if the last call queued in it is.
+   * \return the result of the batch the data is sent in
+   */
+  QFuture<bool> notifyDataAvailableAsync(const ctkDicomAppHosting::AvailableData& data, bool lastData);
+
+  QFuture<QList<ctkDicomAppHosting::ObjectLocator> > getDataAsync(
+    const QList<QUuid>& objectUUIDs,
+    const QList<QString>& acceptableTransferSyntaxUIDs,
+    bool includeBulkData);
+
+public Q_SLOTS:
+
+  /**
+   * Send the data queued by notifyDataAvailableAsync() now.
+   */
+  void flushDataAvailable();
+
+protected:
+
+  /**
+   * Submit the call with the binary protocol.
+   * \return false if the peer does not support it, the call has then to be submitted with SOAP.
+   */
+  bool submitBinaryRequest(ctkDicomBinaryProtocol::Method method, const QByteArray& arguments,
+                           QByteArray* result = 0);
+
+private Q_SLOTS:
+
+  void dataAvailableBatchFinished();
+  void getDataFinished();
+
+private:
+
+  const QScopedPointer<ctkDicomExchangeServicePrivate> d_ptr;
+
+  Q_DECLARE_PRIVATE(ctkDicomExchangeService);
+  Q_DISABLE_COPY(ctkDicomExchangeService);
 };
 
 #endif // CTKDICOMEXCHANGESERVICE_H
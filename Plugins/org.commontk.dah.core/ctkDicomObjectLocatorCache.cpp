@@ -21,8 +21,11 @@
 // Qt includes
 #include <QHash>
 #include <QUuid>
-#include <QSet>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QPair>
+#include <QtAlgorithms>
 
 // CTK includes
 #include "ctkDicomAppHostingTypes.h"
@@ -32,10 +35,36 @@ namespace
 {
 struct ObjectLocatorCacheItem
 {
-  ObjectLocatorCacheItem():RefCount(1){}
+  ObjectLocatorCacheItem():RefCount(1), Temporary(false), LastAccess(0), Cost(0){}
   ctkDicomAppHosting::ObjectLocator ObjectLocator;
   int RefCount;
+  bool Temporary;
+  qint64 LastAccess;
+  qint64 Cost;
 };
+
+struct ObjectLocatorCacheStripe
+{
+  QMutex Mutex;
+  QHash<QString, ObjectLocatorCacheItem> ObjectLocatorMap;
+};
+
+const int StripeCount = 16;
+
+// The expired entries are looked for at most once per interval, or per maximum age if shorter
+const qint64 ExpirationInterval = 1000;
+
+// Evict down to this fraction of the maximum cost, not to evict again at the next insert
+const qint64 CostHysteresisPercent = 90;
+
+//----------------------------------------------------------------------------
+qint64 objectLocatorCost(const QString& objectUuid, const ctkDicomAppHosting::ObjectLocator& objectLocator)
+{
+  qint64 footprint = sizeof(ObjectLocatorCacheItem) + sizeof(QString) +
+    sizeof(QChar) * (objectUuid.size() + objectLocator.locator.size() + objectLocator.source.size() +
+                     objectLocator.transferSyntax.size() + objectLocator.URI.size());
+  return footprint + qMax<qint64>(objectLocator.length, 0);
+}
 }
 
 class ctkDicomObjectLocatorCachePrivate
@@ -43,10 +72,25 @@ class ctkDicomObjectLocatorCachePrivate
 public:
   ctkDicomObjectLocatorCachePrivate();
 
-  bool find(const QString& objectUuid, ObjectLocatorCacheItem& objectLocatorCacheItem)const;
+  ObjectLocatorCacheStripe& stripe(const QString& objectUuid)const;
 
-  QHash<QString, ObjectLocatorCacheItem> ObjectLocatorMap;
-  QSet<QString> TemporaryObjectLocatorSet;
+  bool contains(const QString& objectUuid)const;
+
+  /// Entries evicted by evict(), the evicted() hook is called once the locks are released.
+  typedef QList<QPair<QString, ctkDicomAppHosting::ObjectLocator> > EvictedList;
+  void evictExpired(qint64 now, EvictedList& evicted);
+  void evictLeastRecentlyUsed(EvictedList& evicted);
+  void removeItem(ObjectLocatorCacheStripe& stripe, const QString& objectUuid);
+
+  mutable ObjectLocatorCacheStripe Stripes[StripeCount];
+  QElapsedTimer Clock;
+
+  mutable QMutex SettingsMutex;
+  qint64 MaximumAge;
+  qint64 MaximumCost;
+  qint64 TotalCost;
+  int Count;
+  qint64 LastExpiration;
 };
 
 //----------------------------------------------------------------------------
@@ -54,19 +98,121 @@ public:
 
 //----------------------------------------------------------------------------
 ctkDicomObjectLocatorCachePrivate::ctkDicomObjectLocatorCachePrivate()
+  : MaximumAge(0), MaximumCost(0), TotalCost(0), Count(0), LastExpiration(0)
 {
+  this->Clock.start();
 }
 
 //----------------------------------------------------------------------------
-bool ctkDicomObjectLocatorCachePrivate::find(const QString& objectUuid,
-                                             ObjectLocatorCacheItem& objectLocatorCacheItem)const
+ObjectLocatorCacheStripe& ctkDicomObjectLocatorCachePrivate::stripe(const QString& objectUuid)const
 {
-  if (!this->ObjectLocatorMap.contains(objectUuid))
+  return this->Stripes[qHash(objectUuid) % StripeCount];
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomObjectLocatorCachePrivate::contains(const QString& objectUuid)const
+{
+  ObjectLocatorCacheStripe& stripe = this->stripe(objectUuid);
+  QMutexLocker lock(&stripe.Mutex);
+  return stripe.ObjectLocatorMap.contains(objectUuid);
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomObjectLocatorCachePrivate::removeItem(ObjectLocatorCacheStripe& stripe, const QString& objectUuid)
+{
+  // Called with the lock of the stripe held
+  ObjectLocatorCacheItem item = stripe.ObjectLocatorMap.take(objectUuid);
+  if (item.Temporary)
     {
-    return false;
+    // Not implemented - Delete the object
+    qDebug() << "ctkDicomObjectLocatorCache::remove - RefCount [1] - Temporary [True] - Not implemented";
+    }
+  QMutexLocker lock(&this->SettingsMutex);
+  this->TotalCost -= item.Cost;
+  --this->Count;
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomObjectLocatorCachePrivate::evictExpired(qint64 now, EvictedList& evicted)
+{
+  qint64 maximumAge = 0;
+  {
+    QMutexLocker lock(&this->SettingsMutex);
+    maximumAge = this->MaximumAge;
+    this->LastExpiration = now;
+  }
+  if (maximumAge <= 0)
+    {
+    return;
+    }
+  for (int i = 0; i < StripeCount; ++i)
+    {
+    ObjectLocatorCacheStripe& stripe = this->Stripes[i];
+    QMutexLocker lock(&stripe.Mutex);
+    QHash<QString, ObjectLocatorCacheItem>::iterator it = stripe.ObjectLocatorMap.begin();
+    while (it != stripe.ObjectLocatorMap.end())
+      {
+      if (now - it.value().LastAccess < maximumAge)
+        {
+        ++it;
+        continue;
+        }
+      evicted << qMakePair(it.key(), it.value().ObjectLocator);
+      QString objectUuid = it.key();
+      ++it;
+      this->removeItem(stripe, objectUuid);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomObjectLocatorCachePrivate::evictLeastRecentlyUsed(EvictedList& evicted)
+{
+  qint64 target = 0;
+  {
+    QMutexLocker lock(&this->SettingsMutex);
+    if (this->MaximumCost <= 0 || this->TotalCost <= this->MaximumCost)
+      {
+      return;
+      }
+    target = this->MaximumCost * CostHysteresisPercent / 100;
+  }
+
+  // (last access, stripe) of the entries, the stripes are locked one after the other
+  QList<QPair<qint64, QPair<int, QString> > > entries;
+  for (int i = 0; i < StripeCount; ++i)
+    {
+    ObjectLocatorCacheStripe& stripe = this->Stripes[i];
+    QMutexLocker lock(&stripe.Mutex);
+    QHash<QString, ObjectLocatorCacheItem>::const_iterator it;
+    for (it = stripe.ObjectLocatorMap.constBegin(); it != stripe.ObjectLocatorMap.constEnd(); ++it)
+      {
+      entries << qMakePair(it.value().LastAccess, qMakePair(i, it.key()));
+      }
+    }
+  qSort(entries);
+
+  for (int i = 0; i < entries.size(); ++i)
+    {
+    {
+      QMutexLocker lock(&this->SettingsMutex);
+      if (this->TotalCost <= target)
+        {
+        return;
+        }
+    }
+    ObjectLocatorCacheStripe& stripe = this->Stripes[entries[i].second.first];
+    const QString& objectUuid = entries[i].second.second;
+    QMutexLocker lock(&stripe.Mutex);
+    QHash<QString, ObjectLocatorCacheItem>::const_iterator it = stripe.ObjectLocatorMap.constFind(objectUuid);
+    // skip the entries accessed since they have been listed
+    if (it == stripe.ObjectLocatorMap.constEnd() || it.value().LastAccess != entries[i].first)
+      {
+      continue;
+      }
+    evicted << qMakePair(objectUuid, it.value().ObjectLocator);
+    this->removeItem(stripe, objectUuid);
     }
-  objectLocatorCacheItem = this->ObjectLocatorMap[objectUuid];
-  return true;
 }
 
 //----------------------------------------------------------------------------
@@ -82,17 +228,86 @@ ctkDicomObjectLocatorCache::~ctkDicomObjectLocatorCache()
 {
 }
 
+//----------------------------------------------------------------------------
+void ctkDicomObjectLocatorCache::setMaximumAge(qint64 msecs)
+{
+  Q_D(ctkDicomObjectLocatorCache);
+  QMutexLocker lock(&d->SettingsMutex);
+  d->MaximumAge = msecs;
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkDicomObjectLocatorCache::maximumAge()const
+{
+  Q_D(const ctkDicomObjectLocatorCache);
+  QMutexLocker lock(&d->SettingsMutex);
+  return d->MaximumAge;
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomObjectLocatorCache::setMaximumCost(qint64 cost)
+{
+  Q_D(ctkDicomObjectLocatorCache);
+  QMutexLocker lock(&d->SettingsMutex);
+  d->MaximumCost = cost;
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkDicomObjectLocatorCache::maximumCost()const
+{
+  Q_D(const ctkDicomObjectLocatorCache);
+  QMutexLocker lock(&d->SettingsMutex);
+  return d->MaximumCost;
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkDicomObjectLocatorCache::totalCost()const
+{
+  Q_D(const ctkDicomObjectLocatorCache);
+  QMutexLocker lock(&d->SettingsMutex);
+  return d->TotalCost;
+}
+
+//----------------------------------------------------------------------------
+int ctkDicomObjectLocatorCache::count()const
+{
+  Q_D(const ctkDicomObjectLocatorCache);
+  QMutexLocker lock(&d->SettingsMutex);
+  return d->Count;
+}
+
+//----------------------------------------------------------------------------
+int ctkDicomObjectLocatorCache::evict()
+{
+  Q_D(ctkDicomObjectLocatorCache);
+  ctkDicomObjectLocatorCachePrivate::EvictedList evictedList;
+  d->evictExpired(d->Clock.elapsed(), evictedList);
+  d->evictLeastRecentlyUsed(evictedList);
+  for (int i = 0; i < evictedList.size(); ++i)
+    {
+    this->evicted(evictedList[i].first, evictedList[i].second);
+    }
+  return evictedList.size();
+}
+
+//----------------------------------------------------------------------------
+void ctkDicomObjectLocatorCache::evicted(const QString& objectUuid,
+                                         const ctkDicomAppHosting::ObjectLocator& objectLocator)
+{
+  Q_UNUSED(objectUuid);
+  Q_UNUSED(objectLocator);
+}
+
 //----------------------------------------------------------------------------
 bool ctkDicomObjectLocatorCache::isCached(const ctkDicomAppHosting::AvailableData& availableData)const
 {
   Q_D(const ctkDicomObjectLocatorCache);
   bool hasCachedData = false;
-  QList<QString> uuids = d->ObjectLocatorMap.keys();
   // Loop over top level object descriptors
   foreach(const ctkDicomAppHosting::ObjectDescriptor& objectDescriptor, availableData.objectDescriptors)
     {
     hasCachedData = true;
-    if (!uuids.contains(objectDescriptor.descriptorUUID))
+    if (!d->contains(objectDescriptor.descriptorUUID))
       {
       return false;
       }
@@ -104,7 +319,7 @@ bool ctkDicomObjectLocatorCache::isCached(const ctkDicomAppHosting::AvailableDat
     foreach(const ctkDicomAppHosting::ObjectDescriptor& objectDescriptor, patient.objectDescriptors)
       {
       hasCachedData = true;
-      if (!uuids.contains(objectDescriptor.descriptorUUID))
+      if (!d->contains(objectDescriptor.descriptorUUID))
         {
         return false;
         }
@@ -116,7 +331,7 @@ bool ctkDicomObjectLocatorCache::isCached(const ctkDicomAppHosting::AvailableDat
       foreach(const ctkDicomAppHosting::ObjectDescriptor& objectDescriptor, study.objectDescriptors)
         {
         hasCachedData = true;
-        if (!uuids.contains(objectDescriptor.descriptorUUID))
+        if (!d->contains(objectDescriptor.descriptorUUID))
           {
           return false;
           }
@@ -128,7 +343,7 @@ bool ctkDicomObjectLocatorCache::isCached(const ctkDicomAppHosting::AvailableDat
         foreach(const ctkDicomAppHosting::ObjectDescriptor& objectDescriptor, series.objectDescriptors)
           {
           hasCachedData = true;
-          if (!uuids.contains(objectDescriptor.descriptorUUID))
+          if (!d->contains(objectDescriptor.descriptorUUID))
             {
             return false;
             }
@@ -145,13 +360,15 @@ bool ctkDicomObjectLocatorCache::find(const QString& objectUuid,
 {
   Q_D(const ctkDicomObjectLocatorCache);
 
-  ObjectLocatorCacheItem item;
-  bool found = d->find(objectUuid, item);
-  if (!found)
+  ObjectLocatorCacheStripe& stripe = d->stripe(objectUuid);
+  QMutexLocker lock(&stripe.Mutex);
+  QHash<QString, ObjectLocatorCacheItem>::iterator it = stripe.ObjectLocatorMap.find(objectUuid);
+  if (it == stripe.ObjectLocatorMap.end())
     {
     return false;
     }
-  objectLocator = item.ObjectLocator;
+  it.value().LastAccess = d->Clock.elapsed();
+  objectLocator = it.value().ObjectLocator;
   return true;
 }
 
@@ -161,21 +378,36 @@ void ctkDicomObjectLocatorCache::insert(const QString& objectUuid,
                                         bool temporary)
 {
   Q_D(ctkDicomObjectLocatorCache);
-  ObjectLocatorCacheItem item;
-  d->find(objectUuid, item);
-  if(d->ObjectLocatorMap.contains(objectUuid))
-    {
-    Q_ASSERT(objectLocator == item.ObjectLocator); // ObjectLocator are expected to match
-    item.RefCount++;
-    d->ObjectLocatorMap.insert(objectUuid, item);
-    return;
-    }
-  item.ObjectLocator = objectLocator;
-  d->ObjectLocatorMap.insert(objectUuid, item);
+  bool evictionNeeded = false;
+  {
+    ObjectLocatorCacheStripe& stripe = d->stripe(objectUuid);
+    QMutexLocker lock(&stripe.Mutex);
+    QHash<QString, ObjectLocatorCacheItem>::iterator it = stripe.ObjectLocatorMap.find(objectUuid);
+    if (it != stripe.ObjectLocatorMap.end())
+      {
+      Q_ASSERT(objectLocator == it.value().ObjectLocator); // ObjectLocator are expected to match
+      it.value().RefCount++;
+      it.value().LastAccess = d->Clock.elapsed();
+      return;
+      }
+    ObjectLocatorCacheItem item;
+    item.ObjectLocator = objectLocator;
+    item.Temporary = temporary;
+    item.LastAccess = d->Clock.elapsed();
+    item.Cost = objectLocatorCost(objectUuid, objectLocator);
+    stripe.ObjectLocatorMap.insert(objectUuid, item);
+
+    QMutexLocker settingsLock(&d->SettingsMutex);
+    d->TotalCost += item.Cost;
+    ++d->Count;
+    evictionNeeded = (d->MaximumCost > 0 && d->TotalCost > d->MaximumCost) ||
+      (d->MaximumAge > 0 &&
+       item.LastAccess - d->LastExpiration >= qMin(d->MaximumAge, ExpirationInterval));
+  }
 
-  if (temporary)
+  if (evictionNeeded)
     {
-    d->TemporaryObjectLocatorSet.insert(objectUuid);
+    this->evict();
     }
 }
 
@@ -183,27 +415,17 @@ void ctkDicomObjectLocatorCache::insert(const QString& objectUuid,
 bool ctkDicomObjectLocatorCache::remove(const QString& objectUuid)
 {
   Q_D(ctkDicomObjectLocatorCache);
-  ObjectLocatorCacheItem item;
-  bool found = d->find(objectUuid, item);
-  if (!found)
+  ObjectLocatorCacheStripe& stripe = d->stripe(objectUuid);
+  QMutexLocker lock(&stripe.Mutex);
+  QHash<QString, ObjectLocatorCacheItem>::iterator it = stripe.ObjectLocatorMap.find(objectUuid);
+  if (it == stripe.ObjectLocatorMap.end())
     {
     return false;
     }
-  Q_ASSERT(item.RefCount > 0);
-  item.RefCount--;
-  d->ObjectLocatorMap.insert(objectUuid, item);
-  if (item.RefCount == 0)
+  Q_ASSERT(it.value().RefCount > 0);
+  if (--it.value().RefCount == 0)
     {
-    if (d->TemporaryObjectLocatorSet.contains(objectUuid))
-      {
-      // Not implemented - Delete the object
-      qDebug() << "ctkDicomObjectLocatorCache::remove - RefCount [1] - Temporary [True] - Not implemented";
-
-      bool removed = d->TemporaryObjectLocatorSet.remove(objectUuid);
-      Q_ASSERT(removed);
-      }
-    int removed = d->ObjectLocatorMap.remove(objectUuid);
-    Q_ASSERT(removed == 1);
+    d->removeItem(stripe, objectUuid);
     }
   return true;
 }
@@ -32,7 +32,14 @@ class ctkDicomObjectLocatorCachePrivate;
 struct QUuid;
 
 /**
+  * Reference counted ObjectLocators published by one side of the data exchange.
   *
+  * The cache can be used from several threads: the entries are spread over
+  * stripes with a lock of their own. The entries not released by the other side
+  * can be evicted, either when they have not been accessed for maximumAge()
+  * milliseconds or, the least recently used first, when the total cost of the
+  * entries exceeds maximumCost(). The cost of an entry is its memory footprint
+  * plus the length of the data it locates.
   */
 class org_commontk_dah_core_EXPORT ctkDicomObjectLocatorCache
 {
@@ -42,6 +49,28 @@ public:
   ctkDicomObjectLocatorCache();
   virtual ~ctkDicomObjectLocatorCache();
 
+  /**
+   * Time without access after which an entry is evicted, 0 (the default) to keep them.
+   */
+  void setMaximumAge(qint64 msecs);
+  qint64 maximumAge()const;
+
+  /**
+   * Total cost above which the least recently used entries are evicted, 0 (the default) for no limit.
+   */
+  void setMaximumCost(qint64 cost);
+  qint64 maximumCost()const;
+
+  qint64 totalCost()const;
+  int count()const;
+
+  /**
+   * Evict the expired entries and the least recently used ones above the maximum cost.
+   * This is also done by insert().
+   * \return the number of evicted entries
+   */
+  int evict();
+
   bool isCached(const ctkDicomAppHosting::AvailableData& availableData)const;
 
   bool find(const QString& objectUuid, ctkDicomAppHosting::ObjectLocator& objectLocator)const;
@@ -53,6 +82,14 @@ public:
 
   QList<ctkDicomAppHosting::ObjectLocator> getData(const QList<QUuid>& objectUUIDs);
 
+protected:
+
+  /**
+   * Called without lock held for each entry evicted by evict(), so that the
+   * resources of the entry can be released.
+   */
+  virtual void evicted(const QString& objectUuid, const ctkDicomAppHosting::ObjectLocator& objectLocator);
+
 private:
   Q_DECLARE_PRIVATE(ctkDicomObjectLocatorCache)
   const QScopedPointer<ctkDicomObjectLocatorCachePrivate> d_ptr;
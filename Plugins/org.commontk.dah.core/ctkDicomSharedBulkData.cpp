@@ -0,0 +1,208 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+// Qt includes
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QSharedMemory>
+#include <QSharedPointer>
+
+// CTK includes
+#include "ctkDicomSharedBulkData.h"
+
+// STD includes
+#include <climits>
+#include <cstring>
+
+const QString ctkDicomSharedBulkData::URI_SCHEME = "ctkshm";
+
+//----------------------------------------------------------------------------
+class ctkDicomSharedBulkDataPrivate
+{
+public:
+
+  // the segments are released by the eviction of the object locator cache as well
+  QMutex Mutex;
+  QHash<QString, QSharedPointer<QSharedMemory> > Segments;
+};
+
+//----------------------------------------------------------------------------
+class ctkDicomSharedBulkDataViewPrivate
+{
+public:
+
+  ctkDicomSharedBulkDataViewPrivate() : Data(0), Size(0) {}
+
+  QSharedMemory Memory;
+  const char* Data;
+  qint64 Size;
+  QString ErrorString;
+};
+
+//----------------------------------------------------------------------------
+// ctkDicomSharedBulkData methods
+
+//----------------------------------------------------------------------------
+ctkDicomSharedBulkData::ctkDicomSharedBulkData() : d_ptr(new ctkDicomSharedBulkDataPrivate())
+{
+}
+
+//----------------------------------------------------------------------------
+ctkDicomSharedBulkData::~ctkDicomSharedBulkData()
+{
+}
+
+//----------------------------------------------------------------------------
+ctkDicomAppHosting::ObjectLocator ctkDicomSharedBulkData::publish(
+  const QString& objectUuid, const QByteArray& data, const QString& transferSyntax)
+{
+  ctkDicomAppHosting::ObjectLocator objectLocator;
+  char* buffer = this->create(objectUuid, data.size(), objectLocator, transferSyntax);
+  if (buffer)
+    {
+    std::memcpy(buffer, data.constData(), data.size());
+    }
+  return objectLocator;
+}
+
+//----------------------------------------------------------------------------
+char* ctkDicomSharedBulkData::create(const QString& objectUuid, qint64 size,
+                                     ctkDicomAppHosting::ObjectLocator& objectLocator,
+                                     const QString& transferSyntax)
+{
+  Q_D(ctkDicomSharedBulkData);
+  this->release(objectUuid);
+
+  objectLocator.locator = objectUuid;
+  objectLocator.source = objectUuid;
+  objectLocator.transferSyntax = transferSyntax;
+  objectLocator.offset = 0;
+  objectLocator.length = size;
+  objectLocator.URI.clear();
+
+  // a segment can not be empty
+  QSharedPointer<QSharedMemory> segment(new QSharedMemory("ctkDicomBulkData_" + objectUuid));
+  if (size < 0 || size > INT_MAX || !segment->create(static_cast<int>(qMax<qint64>(size, 1))))
+    {
+    qCritical() << "Shared memory for" << objectUuid << "could not be created:" << segment->errorString();
+    return 0;
+    }
+
+  QMutexLocker lock(&d->Mutex);
+  d->Segments.insert(objectUuid, segment);
+  objectLocator.URI = URI_SCHEME + ":" + segment->key();
+  return static_cast<char*>(segment->data());
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomSharedBulkData::release(const QString& objectUuid)
+{
+  Q_D(ctkDicomSharedBulkData);
+  QSharedPointer<QSharedMemory> segment;
+  {
+    QMutexLocker lock(&d->Mutex);
+    segment = d->Segments.take(objectUuid);
+  }
+  // detached outside of the lock
+  return !segment.isNull();
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomSharedBulkData::isShared(const ctkDicomAppHosting::ObjectLocator& objectLocator)
+{
+  return objectLocator.URI.startsWith(URI_SCHEME + ":");
+}
+
+//----------------------------------------------------------------------------
+// ctkDicomSharedBulkDataView methods
+
+//----------------------------------------------------------------------------
+ctkDicomSharedBulkDataView::ctkDicomSharedBulkDataView(const ctkDicomAppHosting::ObjectLocator& objectLocator)
+  : d_ptr(new ctkDicomSharedBulkDataViewPrivate())
+{
+  Q_D(ctkDicomSharedBulkDataView);
+  if (!ctkDicomSharedBulkData::isShared(objectLocator))
+    {
+    d->ErrorString = "The object locator does not reference shared memory";
+    return;
+    }
+
+  d->Memory.setKey(objectLocator.URI.mid(ctkDicomSharedBulkData::URI_SCHEME.size() + 1));
+  if (!d->Memory.attach(QSharedMemory::ReadOnly))
+    {
+    d->ErrorString = d->Memory.errorString();
+    return;
+    }
+  if (objectLocator.offset < 0 || objectLocator.length < 0 ||
+      objectLocator.offset + objectLocator.length > d->Memory.size())
+    {
+    d->ErrorString = "The object locator is outside of the shared memory";
+    d->Memory.detach();
+    return;
+    }
+  d->Data = static_cast<const char*>(d->Memory.constData()) + objectLocator.offset;
+  d->Size = objectLocator.length;
+}
+
+//----------------------------------------------------------------------------
+ctkDicomSharedBulkDataView::~ctkDicomSharedBulkDataView()
+{
+}
+
+//----------------------------------------------------------------------------
+bool ctkDicomSharedBulkDataView::isValid() const
+{
+  Q_D(const ctkDicomSharedBulkDataView);
+  return d->Data != 0;
+}
+
+//----------------------------------------------------------------------------
+QString ctkDicomSharedBulkDataView::errorString() const
+{
+  Q_D(const ctkDicomSharedBulkDataView);
+  return d->ErrorString;
+}
+
+//----------------------------------------------------------------------------
+const char* ctkDicomSharedBulkDataView::data() const
+{
+  Q_D(const ctkDicomSharedBulkDataView);
+  return d->Data;
+}
+
+//----------------------------------------------------------------------------
+qint64 ctkDicomSharedBulkDataView::size() const
+{
+  Q_D(const ctkDicomSharedBulkDataView);
+  return d->Size;
+}
+
+//----------------------------------------------------------------------------
+QByteArray ctkDicomSharedBulkDataView::toByteArray() const
+{
+  Q_D(const ctkDicomSharedBulkDataView);
+  if (d->Data == 0)
+    {
+    return QByteArray();
+    }
+  return QByteArray::fromRawData(d->Data, static_cast<int>(d->Size));
+}
@@ -0,0 +1,123 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKDICOMSHAREDBULKDATA_H
+#define CTKDICOMSHAREDBULKDATA_H
+
+// Qt includes
+#include <QScopedPointer>
+#include <QString>
+
+// CTK includes
+#include "ctkDicomAppHostingTypes.h"
+#include <org_commontk_dah_core_Export.h>
+
+class ctkDicomSharedBulkDataPrivate;
+class ctkDicomSharedBulkDataViewPrivate;
+
+/**
+ * @brief Bulk data published in shared memory for the other side of the data exchange.
+ *
+ * Instead of writing the data to a file, the publishing side copies it into (or
+ * writes it directly to) a QSharedMemory segment. The returned ObjectLocator
+ * references the segment with a URI of the form "ctkshm:<key>", its offset and
+ * length give the position of the data in the segment. The other side maps the
+ * segment read-only with ctkDicomSharedBulkDataView.
+ *
+ * The segments live until they are released or this object is destroyed. The
+ * methods can be called from several threads.
+ */
+class org_commontk_dah_core_EXPORT ctkDicomSharedBulkData
+{
+
+public:
+
+  static const QString URI_SCHEME; // = "ctkshm"
+
+  ctkDicomSharedBulkData();
+  virtual ~ctkDicomSharedBulkData();
+
+  /**
+   * @brief Copy the data to a new shared memory segment.
+   *
+   * @return the locator of the data, with an empty URI if the segment could not be created
+   */
+  ctkDicomAppHosting::ObjectLocator publish(const QString& objectUuid, const QByteArray& data,
+                                            const QString& transferSyntax = QString());
+
+  /**
+   * @brief Create a shared memory segment of the given size to be written in place.
+   *
+   * The returned buffer stays valid until the segment is released.
+   *
+   * @return the buffer of the segment, 0 if it could not be created
+   */
+  char* create(const QString& objectUuid, qint64 size, ctkDicomAppHosting::ObjectLocator& objectLocator,
+               const QString& transferSyntax = QString());
+
+  /**
+   * @brief Release the segment of the object.
+   *
+   * @return false if no segment was published for the object
+   */
+  bool release(const QString& objectUuid);
+
+  /**
+   * @brief Check whether the locator references shared memory.
+   */
+  static bool isShared(const ctkDicomAppHosting::ObjectLocator& objectLocator);
+
+private:
+  Q_DECLARE_PRIVATE(ctkDicomSharedBulkData)
+  const QScopedPointer<ctkDicomSharedBulkDataPrivate> d_ptr;
+};
+
+/**
+ * @brief Read-only mapping of bulk data published with ctkDicomSharedBulkData.
+ *
+ * The data is accessed in place, it stays valid as long as the view exists.
+ */
+class org_commontk_dah_core_EXPORT ctkDicomSharedBulkDataView
+{
+
+public:
+
+  ctkDicomSharedBulkDataView(const ctkDicomAppHosting::ObjectLocator& objectLocator);
+  virtual ~ctkDicomSharedBulkDataView();
+
+  bool isValid() const;
+  QString errorString() const;
+
+  const char* data() const;
+  qint64 size() const;
+
+  /**
+   * @brief The data without copy, only valid as long as the view exists.
+   */
+  QByteArray toByteArray() const;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDicomSharedBulkDataView)
+  const QScopedPointer<ctkDicomSharedBulkDataViewPrivate> d_ptr;
+};
+
+#endif // CTKDICOMSHAREDBULKDATA_H
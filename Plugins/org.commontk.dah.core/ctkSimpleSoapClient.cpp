@@ -25,16 +25,25 @@
 
 #include <QApplication>
 #include <QCursor>
+#include <QEventLoop>
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QNetworkAccessManager>
 #include <QNetworkReply>
-#include <QtSoapHttpTransport>
+#include <QNetworkRequest>
+#include <QUrl>
 
 //----------------------------------------------------------------------------
 class ctkSimpleSoapClientPrivate
 {
 public:
 
-  QEventLoop BlockingLoop;
-  QtSoapHttpTransport Http;
+  QNetworkAccessManager Network;
+  QHash<QNetworkReply*, QFutureInterface<QtSoapMessage> > PendingReplies;
+
+  /// Response of the last blocking request, referenced by the value returned to the caller.
+  QtSoapMessage Response;
 
   int Port;
   QString Path;
@@ -49,22 +58,58 @@ ctkSimpleSoapClient::ctkSimpleSoapClient(int port, QString path)
   d->Port = port;
   d->Path = path;
 
-  connect(&d->Http, SIGNAL(responseReady()), this, SLOT(responseReady()));
-
-  d->Http.setHost("127.0.0.1", false, port);
+  connect(&d->Network, SIGNAL(finished(QNetworkReply*)), this, SLOT(replyFinished(QNetworkReply*)));
 }
 
 //----------------------------------------------------------------------------
 ctkSimpleSoapClient::~ctkSimpleSoapClient()
 {
+  Q_D(ctkSimpleSoapClient);
+  d->Network.disconnect(this);
 
+  QHashIterator<QNetworkReply*, QFutureInterface<QtSoapMessage> > it(d->PendingReplies);
+  while (it.hasNext())
+    {
+    it.next();
+    it.key()->abort();
+    QFutureInterface<QtSoapMessage> futureInterface = it.value();
+    futureInterface.reportCanceled();
+    futureInterface.reportFinished();
+    }
+}
+
+//----------------------------------------------------------------------------
+int ctkSimpleSoapClient::pendingRequests() const
+{
+  Q_D(const ctkSimpleSoapClient);
+  return d->PendingReplies.size();
 }
 
 //----------------------------------------------------------------------------
-void ctkSimpleSoapClient::responseReady()
+void ctkSimpleSoapClient::replyFinished(QNetworkReply* reply)
 {
   Q_D(ctkSimpleSoapClient);
-  d->BlockingLoop.exit();
+
+  reply->deleteLater();
+  if (!d->PendingReplies.contains(reply))
+    {
+    return;
+    }
+  QFutureInterface<QtSoapMessage> futureInterface = d->PendingReplies.take(reply);
+
+  // a fault is replied with the status 500 and a SOAP message
+  QtSoapMessage response;
+  QByteArray content = reply->readAll();
+  if (content.isEmpty() || !response.setContent(content))
+    {
+    response.clear();
+    response.setFaultCode(QtSoapMessage::Server);
+    response.setFaultString(reply->error() != QNetworkReply::NoError
+                            ? reply->errorString() : QString("Invalid SOAP response"));
+    }
+
+  futureInterface.reportResult(response);
+  futureInterface.reportFinished();
 }
 
 //----------------------------------------------------------------------------
@@ -80,52 +125,76 @@ const QtSoapType & ctkSimpleSoapClient::submitSoapRequest(const QString& methodN
 }
 
 //----------------------------------------------------------------------------
-const QtSoapType & ctkSimpleSoapClient::submitSoapRequest(const QString& methodName,
-                                                   const QList<QtSoapType*>& soapTypes )
+QFuture<QtSoapMessage> ctkSimpleSoapClient::submitSoapRequestAsync(const QString& methodName,
+                                                                   const QList<QtSoapType*>& soapTypes)
 {
   Q_D(ctkSimpleSoapClient);
 
-  /*QString action="\"";
-  //action.append(methodName);
-  action.append("\"");
-  d->Http.setAction(action);*/
   QString action = "http://dicom.nema.org/PS3.19/IHostService/" + methodName;
 
-  d->Http.setAction(action);
-
   CTK_SOAP_LOG( << "Submitting action " << action
                 << " method " << methodName
                 << " to path " << d->Path );
 
   QtSoapMessage request;
-  //request.setMethod(QtSoapQName(methodName,"http://wg23.dicom.nema.org/"));
   request.setMethod(QtSoapQName(methodName,"http://dicom.nema.org/PS3.19" + d->Path ));
-  if(!soapTypes.isEmpty())
+  for (QList<QtSoapType*>::ConstIterator it = soapTypes.begin();
+       it < soapTypes.constEnd(); it++)
     {
-    for (QList<QtSoapType*>::ConstIterator it = soapTypes.begin();
-         it < soapTypes.constEnd(); it++)
-      {
-      request.addMethodArgument(*it);
-      CTK_SOAP_LOG( << "  Argument type added " << (*it)->typeName() << ". "
-                    << " Argument name is " << (*it)->name().name() );
-      }
+    request.addMethodArgument(*it);
+    CTK_SOAP_LOG( << "  Argument type added " << (*it)->typeName() << ". "
+                  << " Argument name is " << (*it)->name().name() );
     }
   CTK_SOAP_LOG_LOWLEVEL( << "Submitting request " << methodName);
   CTK_SOAP_LOG_LOWLEVEL( << request.toXmlString());
 
-  d->Http.submitRequest(request, d->Path);;
+  QUrl url;
+  url.setScheme("http");
+  url.setHost("127.0.0.1");
+  url.setPort(d->Port);
+  url.setPath(d->Path);
+
+  QNetworkRequest networkRequest(url);
+  networkRequest.setHeader(QNetworkRequest::ContentTypeHeader, "text/xml;charset=utf-8");
+  networkRequest.setRawHeader("SOAPAction", action.toLatin1());
+  // the server reads the requests of a keep-alive connection one after the other
+  networkRequest.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+
+  QFutureInterface<QtSoapMessage> futureInterface;
+  futureInterface.reportStarted();
+  QNetworkReply* reply = d->Network.post(networkRequest, request.toXmlString().toUtf8());
+  d->PendingReplies.insert(reply, futureInterface);
 
   CTK_SOAP_LOG_LOWLEVEL( << "Submitted request " << methodName);
 
+  return futureInterface.future();
+}
+
+//----------------------------------------------------------------------------
+const QtSoapType & ctkSimpleSoapClient::submitSoapRequest(const QString& methodName,
+                                                   const QList<QtSoapType*>& soapTypes )
+{
+  Q_D(ctkSimpleSoapClient);
+
+  QFuture<QtSoapMessage> future = this->submitSoapRequestAsync(methodName, soapTypes);
+
+  // a loop per request, the nested requests submitted while waiting have their own
+  QFutureWatcher<QtSoapMessage> watcher;
+  QEventLoop blockingLoop;
+  connect(&watcher, SIGNAL(finished()), &blockingLoop, SLOT(quit()));
+  watcher.setFuture(future);
+
   QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
-  d->BlockingLoop.exec(QEventLoop::ExcludeUserInputEvents | QEventLoop::WaitForMoreEvents);
+  while (!future.isFinished())
+    {
+    blockingLoop.exec(QEventLoop::ExcludeUserInputEvents | QEventLoop::WaitForMoreEvents);
+    }
 
   QApplication::restoreOverrideCursor();
 
-  //qDebug() << "Reply error: " << reply->errorString();
-  //qDebug() << reply->readAll();
-  const QtSoapMessage& response = d->Http.getResponse();
+  d->Response = future.isCanceled() ? QtSoapMessage() : future.result();
+  const QtSoapMessage& response = d->Response;
 
   CTK_SOAP_LOG( << "Got Response." );
 
@@ -22,15 +22,26 @@
 #ifndef CTKSIMPLESOAPCLIENT_H
 #define CTKSIMPLESOAPCLIENT_H
 
+#include <QFuture>
 #include <QObject>
 #include <QScopedPointer>
 
+#include <QtSoapMessage>
 #include <QtSoapType>
 
 #include <org_commontk_dah_core_Export.h>
 
+class QNetworkReply;
 class ctkSimpleSoapClientPrivate;
 
+/**
+ * SOAP client of a DAH peer listening on 127.0.0.1.
+ *
+ * The requests are posted with a QNetworkAccessManager, which keeps several
+ * persistent connections to the server: the asynchronous requests are in flight
+ * at the same time. Their futures are finished by the event loop of the thread
+ * of the client, watch them with a QFutureWatcher rather than blocking on them.
+ */
 class org_commontk_dah_core_EXPORT ctkSimpleSoapClient : public QObject
 {
   Q_OBJECT
@@ -39,12 +50,29 @@ public:
   ctkSimpleSoapClient(int port, QString path);
   virtual ~ctkSimpleSoapClient();
 
+  /**
+   * Submit the request and wait for the response in a local event loop.
+   * The returned value is valid until the next request returns.
+   */
   const QtSoapType & submitSoapRequest(const QString& methodName, const QList<QtSoapType*>& soapTypes);
   const QtSoapType & submitSoapRequest(const QString& methodName, QtSoapType* soapType);
 
+  /**
+   * Submit the request without waiting for the response. The client takes
+   * the ownership of the soap types. A transport error is reported as a
+   * fault message.
+   */
+  QFuture<QtSoapMessage> submitSoapRequestAsync(const QString& methodName,
+                                                const QList<QtSoapType*>& soapTypes);
+
+  /**
+   * Number of asynchronous and blocking requests waiting for their response.
+   */
+  int pendingRequests() const;
+
 private Q_SLOTS:
 
-  void responseReady();
+  void replyFinished(QNetworkReply* reply);
 
 private:
 
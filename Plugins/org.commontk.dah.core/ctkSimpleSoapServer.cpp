@@ -26,11 +26,23 @@
 
 //----------------------------------------------------------------------------
 ctkSimpleSoapServer::ctkSimpleSoapServer(QObject *parent) :
-    QTcpServer(parent)
+    QTcpServer(parent), ConnectionThreadDispatch(false)
 {
   qRegisterMetaType<QtSoapMessage>("QtSoapMessage");
 }
 
+//----------------------------------------------------------------------------
+void ctkSimpleSoapServer::setDispatchInConnectionThread(bool connectionThread)
+{
+  this->ConnectionThreadDispatch = connectionThread;
+}
+
+//----------------------------------------------------------------------------
+bool ctkSimpleSoapServer::dispatchInConnectionThread() const
+{
+  return this->ConnectionThreadDispatch;
+}
+
 //----------------------------------------------------------------------------
 #if (QT_VERSION < 0x50000)
 void ctkSimpleSoapServer::incomingConnection(int socketDescriptor)
@@ -41,13 +53,15 @@ void ctkSimpleSoapServer::incomingConnection(qintptr socketDescriptor)
   qDebug() << "New incoming connection";
   ctkSoapConnectionRunnable* runnable = new ctkSoapConnectionRunnable(socketDescriptor);
 
+  Qt::ConnectionType type = this->ConnectionThreadDispatch ? Qt::DirectConnection
+                                                           : Qt::BlockingQueuedConnection;
   connect(runnable, SIGNAL(incomingSoapMessage(QtSoapMessage,QtSoapMessage*)),
           this, SIGNAL(incomingSoapMessage(QtSoapMessage,QtSoapMessage*)),
-          Qt::BlockingQueuedConnection);
+          type);
 
   connect(runnable, SIGNAL(incomingWSDLMessage(QString,QString*)),
           this, SIGNAL(incomingWSDLMessage(QString,QString*)),
-          Qt::BlockingQueuedConnection);
+          type);
 
   QThreadPool::globalInstance()->start(runnable);
 }
@@ -33,6 +33,16 @@
 #include <org_commontk_dah_core_Export.h>
 #include <ctkDicomAppHostingTypes.h>
 
+/**
+ * HTTP server receiving the SOAP messages of DICOM App Hosting. Each connection
+ * is served by a thread of the global QThreadPool and is kept alive between the
+ * requests.
+ *
+ * By default the incoming message signals are emitted in the thread of the server,
+ * the connection thread blocks until the reply is set. With setDispatchInConnectionThread(true)
+ * they are emitted in the connection thread: the receivers have to be thread safe and
+ * connected with Qt::DirectConnection.
+ */
 class org_commontk_dah_core_EXPORT ctkSimpleSoapServer : public QTcpServer
 {
   Q_OBJECT
@@ -41,6 +51,12 @@ public:
 
   ctkSimpleSoapServer(QObject *parent = 0);
 
+  /**
+   * Set where the messages received by the connections created afterwards are handled.
+   */
+  void setDispatchInConnectionThread(bool connectionThread);
+  bool dispatchInConnectionThread() const;
+
 Q_SIGNALS:
 
   void incomingSoapMessage(const QtSoapMessage& message, QtSoapMessage* reply);
@@ -56,6 +72,10 @@ protected:
   virtual void incomingConnection(qintptr socketDescriptor);
 #endif
 
+private:
+
+  bool ConnectionThreadDispatch;
+
 };
 
 #endif // CTKSIMPLESOAPSERVER_H
@@ -20,12 +20,58 @@
 =============================================================================*/
 
 // Qt includes
+#include <QCoreApplication>
 #include <QTcpSocket>
 
 // CTK includes
 #include "ctkSoapConnectionRunnable_p.h"
 #include "ctkSoapLog.h"
 
+// STD includes
+#include <cstring>
+
+namespace {
+
+// limits protecting the server from broken clients
+const int MaxHeaderSize = 64 * 1024;
+const int Timeout = 1 * 1000;
+
+//----------------------------------------------------------------------------
+bool headerNameIs(const char* begin, const char* end, const char* name)
+{
+  int size = static_cast<int>(std::strlen(name));
+  return end - begin == size && qstrnicmp(begin, name, size) == 0;
+}
+
+//----------------------------------------------------------------------------
+QByteArray trimmed(const char* begin, const char* end)
+{
+  while (begin < end && (*begin == ' ' || *begin == '\t'))
+    {
+    ++begin;
+    }
+  while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+    {
+    --end;
+    }
+  return QByteArray(begin, static_cast<int>(end - begin));
+}
+
+//----------------------------------------------------------------------------
+// Size of the header including the empty line, or -1 if it is not complete.
+int headerSize(const QByteArray& buffer)
+{
+  int crlf = buffer.indexOf("\r\n\r\n");
+  int lf = buffer.indexOf("\n\n");
+  if (crlf >= 0 && (lf < 0 || crlf < lf))
+    {
+    return crlf + 4;
+    }
+  return lf >= 0 ? lf + 2 : -1;
+}
+
+}
+
 //----------------------------------------------------------------------------
 ctkSoapConnectionRunnable::ctkSoapConnectionRunnable(int socketDescriptor)
   : socketDescriptor(socketDescriptor), isAboutToQuit(0)
@@ -49,110 +95,199 @@ void ctkSoapConnectionRunnable::run()
     return;
     }
 
-  const int timeout = 1 * 1000;
+  // the requests of a keep-alive connection follow each other in the buffer
+  QByteArray buffer;
   while (tcpSocket.state() == QTcpSocket::ConnectedState &&
          isAboutToQuit.fetchAndAddOrdered(0) == 0)
     {
+    if (!readClient(tcpSocket, buffer))
+      {
+      break;
+      }
+    }
 
-    tcpSocket.waitForReadyRead(timeout);
-
-    readClient(tcpSocket);
+  if (tcpSocket.state() == QTcpSocket::ConnectedState)
+    {
+    tcpSocket.disconnectFromHost();
+    if (tcpSocket.state() != QTcpSocket::UnconnectedState)
+      {
+      tcpSocket.waitForDisconnected(Timeout);
+      }
     }
+}
 
+//----------------------------------------------------------------------------
+bool ctkSoapConnectionRunnable::waitForData(QTcpSocket& socket, QByteArray& buffer)
+{
+  if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(Timeout))
+    {
+    return false;
+    }
+  buffer.append(socket.readAll());
+  return true;
 }
 
 //----------------------------------------------------------------------------
-void ctkSoapConnectionRunnable::readClient(QTcpSocket& socket)
+bool ctkSoapConnectionRunnable::parseHeader(const QByteArray& buffer, int headerSize, Request& request)
 {
-  QString requestType;
-  int contentLength = -1;
-  //qDebug() << socket->readAll();
-  while (socket.canReadLine()) {
-    QString line = socket.readLine();
-    CTK_SOAP_LOG_LOWLEVEL( << line );
-    if(line.contains("?wsdl HTTP"))
-      {
-      requestType = "?wsdl";
-      }
-    if(line.contains("?xsd=1"))
+  const char* data = buffer.constData();
+  const char* end = data + headerSize;
+
+  // request line: method SP target SP version
+  const char* lineEnd = static_cast<const char*>(std::memchr(data, '\n', headerSize));
+  if (lineEnd == 0)
+    {
+    return false;
+    }
+  QList<QByteArray> requestLine = trimmed(data, lineEnd).split(' ');
+  if (requestLine.size() != 3)
+    {
+    return false;
+    }
+  request.method = requestLine[0];
+  request.target = requestLine[1];
+  request.version = requestLine[2];
+  request.contentLength = 0;
+  request.keepAlive = request.version == "HTTP/1.1";
+
+  for (const char* line = lineEnd + 1; line < end; line = lineEnd + 1)
+    {
+    lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+    if (lineEnd == 0)
       {
-      requestType = "?xsd=1";
+      lineEnd = end;
       }
-    if(line.contains("SoapAction"))
+    const char* colon = static_cast<const char*>(std::memchr(line, ':', lineEnd - line));
+    if (colon == 0)
       {
-      requestType = line;
+      continue; // the empty line
       }
-    if(line.contains("Content-Length: "))
+    if (headerNameIs(line, colon, "Content-Length"))
       {
-      contentLength = line.section(':',1).trimmed().toInt();
+      bool ok = false;
+      request.contentLength = trimmed(colon + 1, lineEnd).toInt(&ok);
+      if (!ok || request.contentLength < 0)
+        {
+        return false;
+        }
       }
-    if (line.trimmed().isEmpty())
+    else if (headerNameIs(line, colon, "Connection"))
       {
-      QString content;
-      if(requestType.startsWith("?"))
+      QByteArray value = trimmed(colon + 1, lineEnd).toLower();
+      if (value.contains("close"))
         {
-        QByteArray body = socket.readAll();
-        emit incomingWSDLMessage(requestType, &content);
+        request.keepAlive = false;
         }
-      else
+      else if (value.contains("keep-alive"))
         {
-        // Read the http body, which contains the soap message
-        int bytesRead = 0;
-        QByteArray body;
-        while(body.size() < contentLength)
-          {
-          QByteArray bodyPart = socket.read(contentLength);
-          CTK_SOAP_LOG_LOWLEVEL( << bodyPart );
-          bytesRead += bodyPart.size();
-          body.append(bodyPart);
-          CTK_SOAP_LOG_LOWLEVEL( << " Expected content-length: " << contentLength << ". Bytes read so far: " << body.size() );
-          if (body.size()<contentLength)
-            {
-            qCritical() << " Message body too small. Trying to read more.";
-            socket.waitForReadyRead(-1);
-            }
-          }
-        if(body.trimmed().isEmpty()==false)
-          {
-          QtSoapMessage msg;
-          if (!msg.setContent(body))
-            {
-            qCritical() << "QtSoap import failed:" << msg.errorString();
-            return;
-            }
-
-          QtSoapMessage reply;
-          CTK_SOAP_LOG(<< "###################" << msg.toXmlString());
-          emit incomingSoapMessage(msg, &reply);
-
-          if (reply.isFault())
-            {
-            qCritical() << "QtSoap reply faulty";
-            return;
-            }
-
-          CTK_SOAP_LOG_LOWLEVEL( << "SOAP reply:" );
-
-          content = reply.toXmlString();
-          }
+        request.keepAlive = true;
         }
+      }
+    else if (headerNameIs(line, colon, "Transfer-Encoding"))
+      {
+      // chunked requests are not supported, the SOAP clients send the content length
+      return false;
+      }
+    }
+  return true;
+}
 
-      QByteArray block;
-      block.append("HTTP/1.1 200 OK\n");
-      block.append("Content-Type: text/xml;charset=utf-8\n");
-      block.append("Content-Length: ").append(QString::number(content.size())).append("\n");
-      block.append("\n");
+//----------------------------------------------------------------------------
+bool ctkSoapConnectionRunnable::readClient(QTcpSocket& socket, QByteArray& buffer)
+{
+  int size = headerSize(buffer);
+  while (size < 0)
+    {
+    if (buffer.size() > MaxHeaderSize)
+      {
+      writeResponse(socket, "400 Bad Request", QByteArray(), false);
+      return false;
+      }
+    if (!waitForData(socket, buffer))
+      {
+      // idle connection, keep it open
+      return socket.state() == QTcpSocket::ConnectedState;
+      }
+    size = headerSize(buffer);
+    }
 
-      block.append(content);
+  Request request;
+  if (!parseHeader(buffer, size, request))
+    {
+    qCritical() << "Invalid HTTP request received";
+    writeResponse(socket, "400 Bad Request", QByteArray(), false);
+    return false;
+    }
+  CTK_SOAP_LOG_LOWLEVEL( << request.method << request.target << request.version );
 
-      CTK_SOAP_LOG_LOWLEVEL( << block );
+  // read the http body, which contains the soap message
+  while (buffer.size() < size + request.contentLength)
+    {
+    if (!waitForData(socket, buffer) &&
+        (socket.state() != QTcpSocket::ConnectedState || isAboutToQuit.fetchAndAddOrdered(0) != 0))
+      {
+      qCritical() << "Connection closed before the message body was received";
+      return false;
+      }
+    }
+  CTK_SOAP_LOG_LOWLEVEL( << " Content-length: " << request.contentLength );
 
-      socket.write(block);
+  QByteArray content;
+  const char* status = "200 OK";
+  if (request.target.endsWith("?wsdl") || request.target.endsWith("?xsd=1"))
+    {
+    QString reply;
+    emit incomingWSDLMessage(request.target.endsWith("?wsdl") ? "?wsdl" : "?xsd=1", &reply);
+    content = reply.toUtf8();
+    }
+  else if (request.contentLength > 0)
+    {
+    // the body is parsed in place, it is only removed from the buffer afterwards
+    QByteArray body = QByteArray::fromRawData(buffer.constData() + size, request.contentLength);
+    QtSoapMessage msg;
+    if (!msg.setContent(body))
+      {
+      qCritical() << "QtSoap import failed:" << msg.errorString();
+      status = "400 Bad Request";
+      }
+    else
+      {
+      QtSoapMessage reply;
+      emit incomingSoapMessage(msg, &reply);
 
-      requestType = "";
-      contentLength = -1;
+      if (reply.isFault())
+        {
+        qCritical() << "QtSoap reply faulty";
+        status = "500 Internal Server Error";
+        }
+      content = reply.toXmlString().toUtf8();
       }
     }
+  buffer.remove(0, size + request.contentLength);
+
+  writeResponse(socket, status, content, request.keepAlive);
+  return request.keepAlive;
+}
+
+//----------------------------------------------------------------------------
+void ctkSoapConnectionRunnable::writeResponse(QTcpSocket& socket, const char* status,
+                                              const QByteArray& content, bool keepAlive)
+{
+  QByteArray block;
+  block.reserve(content.size() + 128);
+  block.append("HTTP/1.1 ").append(status).append("\r\n");
+  block.append("Content-Type: text/xml;charset=utf-8\r\n");
+  block.append("Content-Length: ").append(QByteArray::number(content.size())).append("\r\n");
+  block.append(keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+  block.append("\r\n");
+  block.append(content);
+
+  socket.write(block);
+  socket.flush();
+  if (!keepAlive)
+    {
+    socket.waitForBytesWritten(Timeout);
+    }
 }
 
 void ctkSoapConnectionRunnable::aboutToQuit()
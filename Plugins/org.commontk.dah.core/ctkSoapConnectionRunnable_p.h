@@ -29,6 +29,12 @@
 
 #include <qtsoap.h>
 
+/**
+ * Serves the HTTP/1.1 requests of one connection. The connection is kept open
+ * between the requests unless the client asks to close it. The headers are
+ * parsed on the received bytes and the SOAP body is handed to QtSoap without
+ * being converted to a QString first.
+ */
 class ctkSoapConnectionRunnable : public QObject, public QRunnable
 {
   Q_OBJECT
@@ -51,7 +57,29 @@ protected Q_SLOTS:
 
 private:
 
-  void readClient(QTcpSocket& socket);
+  struct Request
+  {
+    QByteArray method;
+    QByteArray target;
+    QByteArray version;
+    int contentLength;
+    bool keepAlive;
+  };
+
+  /**
+   * Parse the request line and headers in [0, headerSize) of the buffer.
+   */
+  static bool parseHeader(const QByteArray& buffer, int headerSize, Request& request);
+
+  /**
+   * Handle the next request in the buffer, reading from the socket until it is complete.
+   * Returns false when the connection has to be closed.
+   */
+  bool readClient(QTcpSocket& socket, QByteArray& buffer);
+
+  void writeResponse(QTcpSocket& socket, const char* status, const QByteArray& content, bool keepAlive);
+
+  bool waitForData(QTcpSocket& socket, QByteArray& buffer);
 
   int socketDescriptor;
 
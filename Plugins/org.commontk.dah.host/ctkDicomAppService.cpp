@@ -24,6 +24,7 @@
 #include "ctkSimpleSoapClient.h"
 
 #include "ctkDicomAppHostingTypesHelper.h"
+#include "ctkDicomBinaryProtocol.h"
 
 //----------------------------------------------------------------------------
 ctkDicomAppService::ctkDicomAppService(ushort port, QString path)
@@ -39,6 +40,14 @@ ctkDicomAppService::~ctkDicomAppService()
 //----------------------------------------------------------------------------
 ctkDicomAppHosting::State ctkDicomAppService::getState()
 {
+  QByteArray binaryResult;
+  ctkDicomAppHosting::State state;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::GetState, QByteArray(), &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, state))
+    {
+    return state;
+    }
+
   const QtSoapType & result = submitSoapRequest("GetState", NULL);
   return ctkDicomSoapState::getState(result);
 }
@@ -46,6 +55,15 @@ ctkDicomAppHosting::State ctkDicomAppService::getState()
 //----------------------------------------------------------------------------
 bool ctkDicomAppService::setState(ctkDicomAppHosting::State newState)
 {
+  QByteArray binaryResult;
+  bool accepted = false;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::SetState,
+                                ctkDicomBinaryProtocol::pack(newState), &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, accepted))
+    {
+    return accepted;
+    }
+
   QtSoapType* input = new ctkDicomSoapState("state", newState);
   const QtSoapType & result = submitSoapRequest("SetState", input);
   return ctkDicomSoapBool::getBool(result);
@@ -55,6 +73,15 @@ bool ctkDicomAppService::setState(ctkDicomAppHosting::State newState)
 //----------------------------------------------------------------------------
 bool ctkDicomAppService::bringToFront(const QRect& requestedScreenArea)
 {
+  QByteArray binaryResult;
+  bool accepted = false;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::BringToFront,
+                                ctkDicomBinaryProtocol::pack(requestedScreenArea), &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, accepted))
+    {
+    return accepted;
+    }
+
   QtSoapType* input = new ctkDicomSoapRectangle("RequestedScreenArea", requestedScreenArea);
   const QtSoapType & result = submitSoapRequest("BringToFront", input);
   return ctkDicomSoapBool::getBool(result);	
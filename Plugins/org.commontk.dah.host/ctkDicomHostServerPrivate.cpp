@@ -47,6 +47,10 @@ ctkDicomHostServerPrivate::ctkDicomHostServerPrivate(ctkDicomHostInterface* host
     qCritical() << "Listening to 127.0.0.1:" << this->Port << " failed.";
   }
 
+  // the hosted applications use the binary protocol when they support it
+  this->BinaryServer.setExchangeInterface(hostInterface);
+  this->BinaryServer.listen(this->Port);
+
   ctkHostSoapMessageProcessor* hostProcessor = new ctkHostSoapMessageProcessor( hostInterface );
   this->Processors.push_back(hostProcessor);
   ctkExchangeSoapMessageProcessor* exchangeProcessor = new ctkExchangeSoapMessageProcessor( hostInterface );
@@ -25,6 +25,7 @@
 #include <QObject>
 #include <QtSoapMessage>
 
+#include <ctkDicomBinaryServer.h>
 #include <ctkSimpleSoapServer.h>
 #include <ctkSoapMessageProcessorList.h>
 
@@ -38,6 +39,7 @@ public:
   ctkDicomHostServerPrivate(ctkDicomHostInterface* hostInterface, int port, QString path);
 
   ctkSimpleSoapServer Server;
+  ctkDicomBinaryServer BinaryServer;
   int Port;
   QString Path;
 
@@ -52,12 +52,14 @@ ctkDicomAppServer::ctkDicomAppServer(int port, QString path)
     {
     qCritical() << "Listening to 127.0.0.1:" << port << " failed.";
     }
+  this->BinaryServer.listen(this->Port);
 }
 
 //----------------------------------------------------------------------------
 ctkDicomAppServer::~ctkDicomAppServer()
 {
   this->Server.close ();
+  this->BinaryServer.close();
 }
 
 //----------------------------------------------------------------------------
@@ -117,6 +119,7 @@ ctkDicomAppInterface* ctkDicomAppServer::addingService(const ctkServiceReference
   ctkDicomAppInterface* appInterface = ctkDicomAppPlugin::getPluginContext()->getService<ctkDicomAppInterface>(reference);
   this->Processors.push_back(new ctkAppSoapMessageProcessor(appInterface));
   this->Processors.push_back(new ctkExchangeSoapMessageProcessor(appInterface));
+  this->BinaryServer.setExchangeInterface(appInterface);
   return appInterface;
 }
 
@@ -137,4 +140,5 @@ void ctkDicomAppServer::removedService(const ctkServiceReference& reference, ctk
   QMutexLocker lock(&this->Mutex);
   this->AppInterfaceRegistered = false;
   this->Processors.clear();
+  this->BinaryServer.setExchangeInterface(0);
 }
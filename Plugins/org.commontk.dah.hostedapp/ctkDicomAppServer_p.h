@@ -31,6 +31,7 @@
 #include <ctkServiceTracker.h>
 
 #include <ctkDicomAppInterface.h>
+#include <ctkDicomBinaryServer.h>
 #include <ctkSimpleSoapServer.h>
 #include <ctkSoapMessageProcessorList.h>
 
@@ -66,6 +67,7 @@ private:
 
   ctkSoapMessageProcessorList Processors;
   ctkSimpleSoapServer Server;
+  ctkDicomBinaryServer BinaryServer;
   int Port;
   QString Path;
 
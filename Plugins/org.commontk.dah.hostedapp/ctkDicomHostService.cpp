@@ -22,6 +22,7 @@
 #include "ctkDicomHostService_p.h"
 
 #include <ctkDicomAppHostingTypesHelper.h>
+#include <ctkDicomBinaryProtocol.h>
 
 //----------------------------------------------------------------------------
 ctkDicomHostService::ctkDicomHostService(ushort port, QString path)
@@ -37,6 +38,14 @@ ctkDicomHostService::~ctkDicomHostService()
 //----------------------------------------------------------------------------
 QString ctkDicomHostService::generateUID()
 {
+  QByteArray binaryResult;
+  QString uid;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::GenerateUID, QByteArray(), &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, uid))
+    {
+    return uid;
+    }
+
   const QtSoapType& result = submitSoapRequest("GenerateUID", NULL);
   QString resultUID = ctkDicomSoapUID::getUID(result);
   return resultUID;
@@ -45,6 +54,15 @@ QString ctkDicomHostService::generateUID()
 //----------------------------------------------------------------------------
 QString ctkDicomHostService::getOutputLocation(const QStringList& preferredProtocols)
 {
+  QByteArray binaryResult;
+  QString location;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::GetOutputLocation,
+                                ctkDicomBinaryProtocol::pack(preferredProtocols), &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, location))
+    {
+    return location;
+    }
+
   QtSoapStruct* input = dynamic_cast<QtSoapStruct*>(
    new ctkDicomSoapArrayOfStringType("string","preferredProtocols", preferredProtocols));
   const QtSoapType& result = submitSoapRequest("GetOutputLocation", input);
@@ -55,6 +73,15 @@ QString ctkDicomHostService::getOutputLocation(const QStringList& preferredProto
 //----------------------------------------------------------------------------
 QRect ctkDicomHostService::getAvailableScreen(const QRect& preferredScreen)
 {
+  QByteArray binaryResult;
+  QRect availableScreen;
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::GetAvailableScreen,
+                                ctkDicomBinaryProtocol::pack(preferredScreen), &binaryResult) &&
+      ctkDicomBinaryProtocol::unpack(binaryResult, availableScreen))
+    {
+    return availableScreen;
+    }
+
   QtSoapStruct* input = new ctkDicomSoapRectangle("preferredScreen", preferredScreen);
   const QtSoapType& result = submitSoapRequest("GetAvailableScreen", input);
   QRect resultRect = ctkDicomSoapRectangle::getQRect(result);
@@ -65,6 +92,11 @@ QRect ctkDicomHostService::getAvailableScreen(const QRect& preferredScreen)
 //----------------------------------------------------------------------------
 void ctkDicomHostService::notifyStateChanged(ctkDicomAppHosting::State state)
 {
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::NotifyStateChanged,
+                                ctkDicomBinaryProtocol::pack(state)))
+    {
+    return;
+    }
   QtSoapType* input = new ctkDicomSoapState("state", state); // spec would be "state", java has "newState" FIX JAVA/STANDARD
   submitSoapRequest("NotifyStateChanged", input);
 }
@@ -72,6 +104,11 @@ void ctkDicomHostService::notifyStateChanged(ctkDicomAppHosting::State state)
 //----------------------------------------------------------------------------
 void ctkDicomHostService::notifyStatus(const ctkDicomAppHosting::Status& status)
 {
+  if (this->submitBinaryRequest(ctkDicomBinaryProtocol::NotifyStatus,
+                                ctkDicomBinaryProtocol::pack(status)))
+    {
+    return;
+    }
   //Q_D(ctkDicomService);
   QtSoapStruct* input = new ctkDicomSoapStatus("status", status);
   submitSoapRequest("NotifyStatus", input);
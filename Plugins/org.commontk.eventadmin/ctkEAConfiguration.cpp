@@ -24,6 +24,7 @@
 
 #include "ctkEventAdminService_p.h"
 #include "ctkEAMetaTypeProvider_p.h"
+#include "util/ctkEAMetrics_p.h"
 #include "adapter/ctkEAFrameworkEventAdapter_p.h"
 #include "adapter/ctkEALogEventAdapter_p.h"
 #include "adapter/ctkEAPluginEventAdapter_p.h"
@@ -42,10 +43,14 @@ const QString ctkEAConfiguration::PROP_TIMEOUT = "org.commontk.eventadmin.Timeou
 const QString ctkEAConfiguration::PROP_REQUIRE_TOPIC = "org.commontk.eventadmin.RequireTopic";
 const QString ctkEAConfiguration::PROP_IGNORE_TIMEOUT = "org.commontk.eventadmin.IgnoreTimeout";
 const QString ctkEAConfiguration::PROP_LOG_LEVEL = "org.commontk.eventadmin.LogLevel";
+const QString ctkEAConfiguration::PROP_ASYNC_DELIVERY_SHARDS = "org.commontk.eventadmin.AsyncDeliveryShards";
+const QString ctkEAConfiguration::PROP_ASYNC_DELIVERY_BATCH_SIZE = "org.commontk.eventadmin.AsyncDeliveryBatchSize";
+const QString ctkEAConfiguration::PROP_METRICS = "org.commontk.eventadmin.Metrics";
+const QString ctkEAConfiguration::PROP_METRICS_LOG_INTERVAL = "org.commontk.eventadmin.MetricsLogInterval";
 
 
 ctkEAConfiguration::ctkEAConfiguration(ctkPluginContext* pluginContext )
-  : pluginContext(pluginContext), sync_pool(0), async_pool(0), admin(0)
+  : pluginContext(pluginContext), metrics(0), sync_pool(0), async_pool(0), admin(0)
 {
   // default configuration
   configure(ctkDictionary());
@@ -137,6 +142,21 @@ void ctkEAConfiguration::configure(const ctkDictionary& config )
                               pluginContext->getProperty(PROP_LOG_LEVEL),
                               ctkLogService::LOG_WARNING, // default log level is WARNING
                               ctkLogService::LOG_ERROR);
+
+    // The number of threads delivering the asynchronous events per handler.
+    // 0 delivers them on the async thread pool instead.
+    asyncDeliveryShards = getIntProperty(PROP_ASYNC_DELIVERY_SHARDS,
+                                         pluginContext->getProperty(PROP_ASYNC_DELIVERY_SHARDS), 0, 0);
+
+    // The number of asynchronous events these threads dispatch at once.
+    asyncDeliveryBatchSize = getIntProperty(PROP_ASYNC_DELIVERY_BATCH_SIZE,
+                                            pluginContext->getProperty(PROP_ASYNC_DELIVERY_BATCH_SIZE), 16, 1);
+
+    // Record the delivery metrics and log a summary every
+    // metricsLogInterval seconds.
+    collectMetrics = getBoolProperty(pluginContext->getProperty(PROP_METRICS), false);
+    metricsLogInterval = getIntProperty(PROP_METRICS_LOG_INTERVAL,
+                                        pluginContext->getProperty(PROP_METRICS_LOG_INTERVAL), 60, 0);
   }
   else
   {
@@ -159,6 +179,13 @@ void ctkEAConfiguration::configure(const ctkDictionary& config )
                               config.value(PROP_LOG_LEVEL),
                               ctkLogService::LOG_WARNING, // default log level is WARNING
                               ctkLogService::LOG_ERROR);
+    asyncDeliveryShards = getIntProperty(PROP_ASYNC_DELIVERY_SHARDS,
+                                         config.value(PROP_ASYNC_DELIVERY_SHARDS), 0, 0);
+    asyncDeliveryBatchSize = getIntProperty(PROP_ASYNC_DELIVERY_BATCH_SIZE,
+                                            config.value(PROP_ASYNC_DELIVERY_BATCH_SIZE), 16, 1);
+    collectMetrics = getBoolProperty(config.value(PROP_METRICS), false);
+    metricsLogInterval = getIntProperty(PROP_METRICS_LOG_INTERVAL,
+                                        config.value(PROP_METRICS_LOG_INTERVAL), 60, 0);
   }
   // a timeout less or equals to 100 means : disable timeout
   if (timeout <= 100)
@@ -190,12 +217,19 @@ void ctkEAConfiguration::destroy()
     registration.unregister();
     registration = 0;
   }
+  if (metricsReg)
+  {
+    metricsReg.unregister();
+    metricsReg = 0;
+  }
   if (admin)
   {
     admin->stop();
     delete admin;
     admin = 0;
   }
+  delete metrics;
+  metrics = 0;
   if (async_pool)
   {
     async_pool->close();
@@ -222,6 +256,22 @@ void ctkEAConfiguration::startOrUpdate()
       << PROP_TIMEOUT << "=" << timeout;
   CTK_DEBUG(ctkEventAdminActivator::getLogService())
       << PROP_REQUIRE_TOPIC << "=" << requireTopic;
+  CTK_DEBUG(ctkEventAdminActivator::getLogService())
+      << PROP_ASYNC_DELIVERY_SHARDS << "=" << asyncDeliveryShards;
+  CTK_DEBUG(ctkEventAdminActivator::getLogService())
+      << PROP_ASYNC_DELIVERY_BATCH_SIZE << "=" << asyncDeliveryBatchSize;
+  CTK_DEBUG(ctkEventAdminActivator::getLogService())
+      << PROP_METRICS << "=" << collectMetrics;
+  CTK_DEBUG(ctkEventAdminActivator::getLogService())
+      << PROP_METRICS_LOG_INTERVAL << "=" << metricsLogInterval;
+
+  // The metrics are created with the event admin, they are shared by the
+  // handler tasks created on each update
+  if (admin == 0 && collectMetrics)
+  {
+    metrics = new ctkEAMetrics();
+    metrics->setLogInterval(metricsLogInterval);
+  }
 
   ctkEventAdminService::TopicHandlerFiltersInterface* topicHandlerFilters =
       new ctkEventAdminService::TopicHandlerFilters(
@@ -260,12 +310,15 @@ void ctkEAConfiguration::startOrUpdate()
   // below (and not in this HandlerTasks object!)
   ctkEventAdminService::HandlerTasksInterface* handlerTasks =
       new ctkEventAdminService::BlacklistingHandlerTasks(
-        pluginContext, new ctkEventAdminService::BlackList(), topicHandlerFilters, filters);
+        pluginContext, new ctkEventAdminService::BlackList(), topicHandlerFilters, filters,
+        metrics);
 
   if (admin == 0)
   {
     admin = new ctkEventAdminService(pluginContext, handlerTasks, sync_pool, async_pool,
-                                     timeout, ignoreTimeout);
+                                     timeout, ignoreTimeout,
+                                     asyncDeliveryShards, asyncDeliveryBatchSize, metrics);
+    admin->setRequireTopic(requireTopic);
 
     // Finally, adapt the outside events to our kind of events as per spec
     adaptEvents(admin);
@@ -277,10 +330,16 @@ void ctkEAConfiguration::startOrUpdate()
     //registration = pluginContext->registerService<ctkEventAdmin>(
     //      new ctkEASecureEventAdminFactory(admin));
     registration = pluginContext->registerService<ctkEventAdmin>(admin);
+
+    if (metrics)
+    {
+      metricsReg = pluginContext->registerService<ctkEventAdminMetrics>(metrics);
+    }
   }
   else
   {
-    admin->update(handlerTasks, timeout, ignoreTimeout);
+    admin->update(handlerTasks, timeout, ignoreTimeout, asyncDeliveryBatchSize);
+    admin->setRequireTopic(requireTopic);
   }
 
 }
@@ -32,6 +32,7 @@
 
 class ctkPluginContext;
 class ctkEAAbstractAdapter;
+class ctkEAMetrics;
 
 /**
  * The <code>ctkEAConfiguration</code> class encapsules the
@@ -89,6 +90,47 @@ class ctkEAAbstractAdapter;
  * pure optimization!
  * The value is a list of strings (separated by comma) which is assumed to define
  * exact class names.
+ * </p>
+ * <p>
+ * <p>
+ *      <tt>org.commontk.eventadmin.AsyncDeliveryShards</tt> - The number of
+ *          threads delivering the asynchronous events.
+ * </p>
+ * The default value is 0, the asynchronous events are then delivered on a thread
+ * pool, in order per posting thread. Any other value starts this number of threads
+ * and assigns each <tt>ctkEventHandler</tt> to one of them, which delivers the
+ * events to the handler in the order they were posted. Use it for high rates of
+ * posted events. This property is only read when the event admin starts.
+ * </p>
+ * <p>
+ * <p>
+ *      <tt>org.commontk.eventadmin.AsyncDeliveryBatchSize</tt> - The maximum
+ *          number of asynchronous events a delivery thread dispatches at once.
+ * </p>
+ * The default value is 16. It only applies if
+ * <tt>org.commontk.eventadmin.AsyncDeliveryShards</tt> is set. Larger values
+ * reduce the dispatch overhead of bursts of events, smaller values lower their
+ * latency. A value less then 1 triggers the default value.
+ * </p>
+ * <p>
+ * <p>
+ *      <tt>org.commontk.eventadmin.Metrics</tt> - Collect delivery metrics?
+ * </p>
+ * The default is <tt>false</tt>. If <tt>true</tt>, the publish rate of the
+ * topics, the delivery latency of each <tt>ctkEventHandler</tt>, the depth of
+ * the asynchronous queue and the timeouts are recorded and available through
+ * the <tt>ctkEventAdminMetrics</tt> service. This property is only read when
+ * the event admin starts.
+ * </p>
+ * <p>
+ * <p>
+ *      <tt>org.commontk.eventadmin.MetricsLogInterval</tt> - The interval of
+ *          the metrics summary in seconds.
+ * </p>
+ * The default value is 60. If metrics are collected, a summary with the
+ * slowest <tt>ctkEventHandler</tt>s is logged at info level at this interval.
+ * A value of 0 disables the summary. This property is only read when the event
+ * admin starts.
  *
  * These properties are read at startup and serve as a default configuration.
  * If a configuration admin is configured, the event admin can be configured
@@ -110,6 +152,10 @@ public:
   static const QString PROP_REQUIRE_TOPIC; // = "org.commontk.eventadmin.RequireTopic"
   static const QString PROP_IGNORE_TIMEOUT; // = "org.commontk.eventadmin.IgnoreTimeout"
   static const QString PROP_LOG_LEVEL; // = "org.commontk.eventadmin.LogLevel"
+  static const QString PROP_ASYNC_DELIVERY_SHARDS; // = "org.commontk.eventadmin.AsyncDeliveryShards"
+  static const QString PROP_ASYNC_DELIVERY_BATCH_SIZE; // = "org.commontk.eventadmin.AsyncDeliveryBatchSize"
+  static const QString PROP_METRICS; // = "org.commontk.eventadmin.Metrics"
+  static const QString PROP_METRICS_LOG_INTERVAL; // = "org.commontk.eventadmin.MetricsLogInterval"
 
 private:
 
@@ -130,6 +176,19 @@ private:
 
   int logLevel;
 
+  int asyncDeliveryShards;
+
+  int asyncDeliveryBatchSize;
+
+  bool collectMetrics;
+
+  int metricsLogInterval;
+
+  // The delivery metrics, null if they are not collected
+  ctkEAMetrics* metrics;
+
+  ctkServiceRegistration metricsReg;
+
   // The thread pool used - this is a member because we need to close it on stop
   ctkEADefaultThreadPool* sync_pool;
   ctkEADefaultThreadPool* async_pool;
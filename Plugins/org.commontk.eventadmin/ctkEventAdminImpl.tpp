@@ -27,7 +27,8 @@ template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
 ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::ctkEventAdminImpl(
   HandlerTasksInterface* managers, ctkEADefaultThreadPool* syncPool,
   ctkEADefaultThreadPool* asyncPool, int timeout,
-  const QStringList& ignoreTimeout)
+  const QStringList& ignoreTimeout, int asyncShards, int asyncBatchSize,
+  ctkEAMetrics* metrics)
   : managers(managers)
 {
   checkNull(managers, "Managers");
@@ -38,7 +39,8 @@ ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::ctkEventAdmi
                                      (timeout > 100 ? timeout : 0),
                                      ignoreTimeout);
 
-  postManager = new AsyncDeliverTasks(asyncPool, sendManager);
+  postManager = new AsyncDeliverTasks(asyncPool, sendManager, asyncShards, asyncBatchSize,
+                                      metrics);
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
@@ -51,31 +53,48 @@ ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::~ctkEventAdm
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
 void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::postEvent(const ctkEvent& event)
 {
-  handleEvent(managers.fetchAndAddOrdered(0)->createHandlerTasks(event), postManager);
+  handleEvent(createHandlerTasks(event), postManager);
+}
+
+template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
+void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::postEvents(const QList<ctkEvent>& events)
+{
+  handleEvent(createHandlerTasks(events), postManager);
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
 void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::sendEvent(const ctkEvent& event)
 {
-  handleEvent(managers.fetchAndAddOrdered(0)->createHandlerTasks(event), sendManager);
+  handleEvent(createHandlerTasks(event), sendManager);
+}
+
+template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
+qlonglong ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::
+subscribeSlot(const QObject* subscriber, const char* member,
+              const ctkDictionary& properties, Qt::ConnectionType type)
+{
+  return slotSubscriptions.subscribe(subscriber, member, properties, type);
+}
+
+template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
+void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::
+unsubscribeSlot(qlonglong subscriptionId)
+{
+  slotSubscriptions.unsubscribe(subscriptionId);
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
-QString ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::
-subscribeSlot(const QObject *subscriber, const char *member, const ctkProperties &properties)
+bool ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::
+updateProperties(qlonglong subscriptionId, const ctkDictionary& properties)
 {
-  Q_UNUSED(subscriber)
-  Q_UNUSED(member)
-  Q_UNUSED(properties)
-  return QString();
+  return slotSubscriptions.updateProperties(subscriptionId, properties);
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
 void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::
-updateProperties(const QString &subsriptionId, const ctkProperties &properties)
+setRequireTopic(bool requireTopic)
 {
-  Q_UNUSED(subsriptionId)
-  Q_UNUSED(properties)
+  slotSubscriptions.setRequireTopic(requireTopic);
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
@@ -86,16 +105,99 @@ void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::stop()
   HandlerTasksInterface* oldManagers =
       this->managers.fetchAndStoreOrdered(&stoppedHandlerTasks);
   delete oldManagers;
+  // The queued asynchronous events are delivered through the sync master
+  // thread, deliver them before it stops.
+  postManager->stop();
   syncMasterThread.stop();
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
 void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::update(HandlerTasksInterface* managers, int timeout,
-                               const QStringList& ignoreTimeout)
+                               const QStringList& ignoreTimeout, int asyncBatchSize)
 {
   HandlerTasksInterface* oldManagers = this->managers.fetchAndStoreOrdered(managers);
   delete oldManagers;
   this->sendManager->update(timeout, ignoreTimeout);
+  this->postManager->update(asyncBatchSize);
+}
+
+template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
+HandlerTasks* ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::getHandlerTasks()
+{
+  HandlerTasksInterface* currManagers = managers.fetchAndAddOrdered(0);
+  if (currManagers == &stoppedHandlerTasks)
+  {
+    throw ctkIllegalStateException("The EventAdmin is stopped");
+  }
+  return static_cast<HandlerTasks*>(currManagers);
+}
+
+template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
+QList<typename ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::HandlerTask>
+ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::createHandlerTasks(const ctkEvent& event)
+{
+  HandlerTasks* handlerTasks = getHandlerTasks();
+  QList<HandlerTask> tasks = handlerTasks->createHandlerTasks(event);
+
+  // The subscribed slots are not services, they are matched here
+  const QList<ctkEASlotSubscriptions::Subscription> slots =
+      slotSubscriptions.getSubscriptions(event.getTopic());
+  for (int i = 0; i < slots.size(); ++i)
+  {
+    const ctkEASlotSubscriptions::Subscription& slot = slots.at(i);
+    if (slot->isDeliverable() && slot->matches(event))
+    {
+      tasks.push_back(HandlerTask(slot, event, handlerTasks));
+    }
+  }
+  return tasks;
+}
+
+template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
+QList<typename ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::HandlerTask>
+ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::createHandlerTasks(const QList<ctkEvent>& events)
+{
+  HandlerTasks* handlerTasks = getHandlerTasks();
+  QList<HandlerTask> tasks = handlerTasks->createHandlerTasks(events);
+  if (events.isEmpty())
+  {
+    return tasks;
+  }
+
+  const QList<ctkEASlotSubscriptions::Subscription> slots =
+      slotSubscriptions.getSubscriptions(events.front().getTopic());
+  for (int i = 0; i < slots.size(); ++i)
+  {
+    const ctkEASlotSubscriptions::Subscription& slot = slots.at(i);
+    if (!slot->isDeliverable())
+    {
+      continue;
+    }
+
+    if (slot->isCoalesced())
+    {
+      // latest value wins
+      for (int j = events.size() - 1; j >= 0; --j)
+      {
+        if (slot->matches(events.at(j)))
+        {
+          tasks.push_back(HandlerTask(slot, events.at(j), handlerTasks));
+          break;
+        }
+      }
+    }
+    else
+    {
+      for (int j = 0; j < events.size(); ++j)
+      {
+        if (slot->matches(events.at(j)))
+        {
+          tasks.push_back(HandlerTask(slot, events.at(j), handlerTasks));
+        }
+      }
+    }
+  }
+  return tasks;
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
@@ -26,8 +26,10 @@
 #include "handler/ctkEAHandlerTasks_p.h"
 #include "tasks/ctkEADeliverTask_p.h"
 #include "dispatch/ctkEASyncMasterThread_p.h"
+#include "handler/ctkEASlotSubscriptions_p.h"
 
 class ctkEADefaultThreadPool;
+class ctkEAMetrics;
 
 /**
  * This is the actual implementation of the OSGi R4 Event Admin Service (see the
@@ -39,6 +41,10 @@ class ctkEADefaultThreadPool;
  * its <tt>send()</tt> method is called. Note that the actual work is done in the
  * implementations of the <tt>ctkEADeliverTask</tt>s. Additionally, a stop method is
  * provided that prevents subsequent events to be delivered.
+ *
+ * Slots subscribed through <tt>subscribeSlot()</tt> are kept in a topic indexed
+ * table and get delivery tasks of their own, they are not registered as
+ * <tt>ctkEventHandler</tt> services.
  */
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
 class ctkEventAdminImpl
@@ -58,7 +64,7 @@ private:
   QAtomicPointer<HandlerTasksInterface> managers;
 
   // The asynchronous event dispatcher
-  AsyncDeliverTaskInterface* postManager;
+  AsyncDeliverTasks* postManager;
 
   // The (interruptible) thread where sync events are handled
   ctkEASyncMasterThread syncMasterThread;
@@ -83,10 +89,18 @@ private:
     {
       throw ctkIllegalStateException("The EventAdmin is stopped");
     }
+
+    QList<ctkEAHandlerTask<HandlerTasks> > createHandlerTasks(const QList<ctkEvent>&)
+    {
+      throw ctkIllegalStateException("The EventAdmin is stopped");
+    }
   };
 
   StoppedHandlerTasks stoppedHandlerTasks;
 
+  // The subscribed slots
+  ctkEASlotSubscriptions slotSubscriptions;
+
 public:
 
   /**
@@ -98,12 +112,20 @@ public:
    * @param managers The factory used to determine applicable <tt>ctkEventHandler</tt>
    * @param syncPool The synchronous thread pool
    * @param asyncPool The asynchronous thread pool
+   * @param asyncShards The number of threads delivering the asynchronous
+   *        events per handler, 0 to deliver them on the asynchronous pool
+   * @param asyncBatchSize The maximum number of asynchronous events
+   *        delivered at once by these threads
+   * @param metrics The delivery metrics to record, or null
    */
   ctkEventAdminImpl(HandlerTasksInterface* managers,
                     ctkEADefaultThreadPool* syncPool,
                     ctkEADefaultThreadPool* asyncPool,
                     int timeout,
-                    const QStringList& ignoreTimeout);
+                    const QStringList& ignoreTimeout,
+                    int asyncShards = 0,
+                    int asyncBatchSize = 1,
+                    ctkEAMetrics* metrics = 0);
 
   ~ctkEventAdminImpl();
 
@@ -118,6 +140,17 @@ public:
    */
   void postEvent(const ctkEvent& event);
 
+  /**
+   * Post a batch of asynchronous events of the same topic.
+   *
+   * @param events The events to be posted by this service
+   *
+   * @throws ctkIllegalStateException - In case we are stopped
+   *
+   * @see ctkEventAdmin#postEvents(const QString&, const QList<ctkDictionary>&)
+   */
+  void postEvents(const QList<ctkEvent>& events);
+
   /**
    * Send a synchronous event.
    *
@@ -129,9 +162,30 @@ public:
    */
   void sendEvent(const ctkEvent& event);
 
-  QString subscribeSlot(const QObject *subscriber, const char *member, const ctkProperties &properties);
+  /**
+   * Subscribe a slot for events. The slot is called for the matching events
+   * with the given connection type.
+   *
+   * @return The id of the subscription
+   *
+   * @throws ctkInvalidArgumentException If <code>member</code> is not a method
+   *         of <code>subscriber</code> taking no or a <code>ctkEvent</code>
+   *         argument
+   *
+   * @see ctkEventAdmin#subscribeSlot(const QObject*, const char*, const ctkDictionary&, Qt::ConnectionType)
+   */
+  qlonglong subscribeSlot(const QObject* subscriber, const char* member,
+                          const ctkDictionary& properties, Qt::ConnectionType type);
+
+  /**
+   * @see ctkEventAdmin#unsubscribeSlot(qlonglong)
+   */
+  void unsubscribeSlot(qlonglong subscriptionId);
 
-  void updateProperties(const QString &subsriptionId, const ctkProperties &properties);
+  /**
+   * @see ctkEventAdmin#updateProperties(qlonglong, const ctkDictionary&)
+   */
+  bool updateProperties(qlonglong subscriptionId, const ctkDictionary& properties);
 
   /**
    * This method can be used to stop the delivery of events. The managers variable is
@@ -144,10 +198,35 @@ public:
    * Update the event admin with new configuration.
    */
   void update(HandlerTasksInterface* managers, int timeout,
-              const QStringList& ignoreTimeout);
+              const QStringList& ignoreTimeout, int asyncBatchSize = 1);
+
+  /**
+   * Deliver all events to the slots subscribed without topic if
+   * <code>requireTopic</code> is <code>false</code>.
+   */
+  void setRequireTopic(bool requireTopic);
 
 private:
 
+  /**
+   * Get the current HandlerTasks factory.
+   *
+   * @throws ctkIllegalStateException - In case we are stopped
+   */
+  HandlerTasks* getHandlerTasks();
+
+  /**
+   * Create the delivery tasks of the handler services and the subscribed
+   * slots matching the event.
+   */
+  QList<HandlerTask> createHandlerTasks(const ctkEvent& event);
+
+  /**
+   * Create the delivery tasks of the handler services and the subscribed
+   * slots matching a batch of events of the same topic.
+   */
+  QList<HandlerTask> createHandlerTasks(const QList<ctkEvent>& events);
+
   /**
    * This is a utility method that uses the given ctkEADeliverTasks to create a
    * dispatch task that subsequently is used to dispatch the given ctkEAHandlerTasks.
@@ -22,17 +22,17 @@
 
 #include "ctkEventAdminService_p.h"
 
-#include "handler/ctkEASlotHandler_p.h"
-
-#include <ctkPluginConstants.h>
-
 ctkEventAdminService::ctkEventAdminService(ctkPluginContext* context,
                                            HandlerTasksInterface* managers,
                                            ctkEADefaultThreadPool* syncPool,
                                            ctkEADefaultThreadPool* asyncPool,
                                            int timeout,
-                                           const QStringList& ignoreTimeout)
-  : impl(managers, syncPool, asyncPool, timeout, ignoreTimeout),
+                                           const QStringList& ignoreTimeout,
+                                           int asyncShards,
+                                           int asyncBatchSize,
+                                           ctkEAMetrics* metrics)
+  : impl(managers, syncPool, asyncPool, timeout, ignoreTimeout,
+         asyncShards, asyncBatchSize, metrics),
     context(context)
 {
 
@@ -40,7 +40,6 @@ ctkEventAdminService::ctkEventAdminService(ctkPluginContext* context,
 
 ctkEventAdminService::~ctkEventAdminService()
 {
-  qDeleteAll(slotHandler);
   foreach(QList<ctkEASignalPublisher*> l, signalPublisher.values())
   {
     qDeleteAll(l);
@@ -52,6 +51,20 @@ void ctkEventAdminService::postEvent(const ctkEvent& event)
   impl.postEvent(event);
 }
 
+void ctkEventAdminService::postEvents(const QString& topic, const QList<ctkDictionary>& properties)
+{
+  QList<ctkEvent> events;
+  events.reserve(properties.size());
+  for (int i = 0; i < properties.size(); ++i)
+  {
+    events.push_back(ctkEvent(topic, properties.at(i)));
+  }
+  if (!events.isEmpty())
+  {
+    impl.postEvents(events);
+  }
+}
+
 void ctkEventAdminService::sendEvent(const ctkEvent& event)
 {
   impl.sendEvent(event);
@@ -161,34 +174,17 @@ qlonglong ctkEventAdminService::subscribeSlot(const QObject* subscriber, const c
     throw ctkInvalidArgumentException("connection type invalid");
   }
 
-  ctkEASlotHandler* handler = new ctkEASlotHandler();
-  connect(handler, SIGNAL(eventOccured(ctkEvent)), subscriber, member, type);
-  ctkServiceRegistration reg = context->registerService<ctkEventHandler>(handler, properties);
-  handler->reg = reg;
-  qlonglong id = reg.getReference().getProperty(ctkPluginConstants::SERVICE_ID).toLongLong();
-  slotHandler.insert(id, handler);
-  return id;
+  return impl.subscribeSlot(subscriber, member, properties, type);
 }
 
 void ctkEventAdminService::unsubscribeSlot(qlonglong subscriptionId)
 {
-  ctkEASlotHandler* handler = slotHandler.take(subscriptionId);
-  if (handler)
-  {
-    handler->reg.unregister();
-    delete handler;
-  }
+  impl.unsubscribeSlot(subscriptionId);
 }
 
 bool ctkEventAdminService::updateProperties(qlonglong subscriptionId, const ctkDictionary& properties)
 {
-  ctkEASlotHandler* handler = slotHandler.value(subscriptionId);
-  if (handler)
-  {
-    handler->updateProperties(properties);
-    return true;
-  }
-  return false;
+  return impl.updateProperties(subscriptionId, properties);
 }
 
 void ctkEventAdminService::stop()
@@ -197,8 +193,13 @@ void ctkEventAdminService::stop()
 }
 
 void ctkEventAdminService::update(HandlerTasksInterface* managers, int timeout,
-                                  const QStringList& ignoreTimeout)
+                                  const QStringList& ignoreTimeout, int asyncBatchSize)
+{
+  impl.update(managers, timeout, ignoreTimeout, asyncBatchSize);
+}
+
+void ctkEventAdminService::setRequireTopic(bool requireTopic)
 {
-  impl.update(managers, timeout, ignoreTimeout);
+  impl.setRequireTopic(requireTopic);
 }
 
@@ -37,8 +37,6 @@
 #include "tasks/ctkEAAsyncDeliverTasks_p.h"
 #include "dispatch/ctkEASignalPublisher_p.h"
 
-class ctkEASlotHandler;
-
 class ctkEventAdminService : public QObject, public ctkEventAdmin
 {
   Q_OBJECT
@@ -72,7 +70,6 @@ private:
 
   ctkPluginContext* context;
   QHash<const QObject*, QList<ctkEASignalPublisher*> > signalPublisher;
-  QHash<qlonglong, ctkEASlotHandler*> slotHandler;
 
 public:
   ctkEventAdminService(ctkPluginContext* context,
@@ -80,12 +77,17 @@ public:
                        ctkEADefaultThreadPool* syncPool,
                        ctkEADefaultThreadPool* asyncPool,
                        int timeout,
-                       const QStringList& ignoreTimeout);
+                       const QStringList& ignoreTimeout,
+                       int asyncShards,
+                       int asyncBatchSize,
+                       ctkEAMetrics* metrics);
 
   ~ctkEventAdminService();
 
   void postEvent(const ctkEvent& event);
 
+  void postEvents(const QString& topic, const QList<ctkDictionary>& properties);
+
   void sendEvent(const ctkEvent& event);
 
   void publishSignal(const QObject* publisher, const char* signal,
@@ -113,7 +115,13 @@ public:
    * Update the event admin with new configuration.
    */
   void update(HandlerTasksInterface* managers, int timeout,
-              const QStringList& ignoreTimeout);
+              const QStringList& ignoreTimeout, int asyncBatchSize);
+
+  /**
+   * Deliver all events to the slots subscribed without topic if
+   * <code>requireTopic</code> is <code>false</code>.
+   */
+  void setRequireTopic(bool requireTopic);
 
 };
 
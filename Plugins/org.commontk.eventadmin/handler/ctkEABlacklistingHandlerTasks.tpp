@@ -20,25 +20,32 @@
 =============================================================================*/
 
 
+#include <util/ctkEAMetrics_p.h>
+
 template<class BlackList, class TopicHandlerFilters, class Filters>
 ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
 ctkEABlacklistingHandlerTasks(ctkPluginContext* context,
                               ctkEABlackList<BlackList>* blackList,
                               ctkEATopicHandlerFilters<TopicHandlerFilters>* topicHandlerFilters,
-                              ctkEAFilters<Filters>* filters)
+                              ctkEAFilters<Filters>* filters,
+                              ctkEAMetrics* metrics)
   : blackList(blackList), context(context),
-    topicHandlerFilters(topicHandlerFilters), filters(filters)
+    topicHandlerFilters(topicHandlerFilters), filters(filters), handlerRefsCache(0),
+    metrics(metrics)
 {
   checkNull(context, "Context");
   checkNull(blackList, "BlackList");
   checkNull(topicHandlerFilters, "TopicHandlerFilters");
   checkNull(filters, "Filters");
+
+  handlerRefsCache = new ctkEAHandlerReferenceCache(context);
 }
 
 template<class BlackList, class TopicHandlerFilters, class Filters>
 ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
 ~ctkEABlacklistingHandlerTasks()
 {
+  delete handlerRefsCache;
   delete filters;
   delete topicHandlerFilters;
   delete blackList;
@@ -50,43 +57,87 @@ ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
 createHandlerTasks(const ctkEvent& event)
 {
   QList<ctkEAHandlerTask<Self> > result;
-  QList<ctkServiceReference> handlerRefs;
+  if (metrics)
+  {
+    metrics->eventsPublished(event.getTopic(), 1);
+  }
+  const QList<ctkEAHandlerReferenceCache::Handler> handlers = getHandlers(event.getTopic());
 
-  try
+  for (int i = 0; i < handlers.size(); ++i)
   {
-    handlerRefs = context->getServiceReferences<ctkEventHandler>(
-          topicHandlerFilters->createFilterForTopic(event.getTopic()));
+    const ctkEAHandlerReferenceCache::Handler& handler = handlers.at(i);
+    // The filter of the handler was parsed when it was registered
+    if (isDeliverable(handler) && (!handler.filter || event.matches(handler.filter)))
+    {
+      result.push_back(ctkEAHandlerTask<Self>(handler.ref, event, this));
+    }
   }
-  catch (const ctkInvalidArgumentException& e)
+
+  return result;
+}
+
+template<class BlackList, class TopicHandlerFilters, class Filters>
+QList<ctkEAHandlerTask<ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters> > >
+ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
+createHandlerTasks(const QList<ctkEvent>& events)
+{
+  QList<ctkEAHandlerTask<Self> > result;
+  if (events.isEmpty())
   {
-    CTK_WARN_EXC(ctkEventAdminActivator::getLogService(), &e)
-        << "Invalid EVENT_TOPIC [" << event.getTopic() << "]";
+    return result;
   }
 
-  for (int i = 0; i < handlerRefs.size(); ++i)
+  if (metrics)
   {
-    const ctkServiceReference& ref = handlerRefs.at(i);
-    if (!blackList->contains(ref)
-        //TODO security
-        //&& ref.getPlugin()->hasPermission(
-        //  PermissionsUtil.createSubscribePermission(event.getTopic()))
-        )
+    metrics->eventsPublished(events.front().getTopic(), events.size());
+  }
+
+  // All the events of a batch have the same topic
+  const QList<ctkEAHandlerReferenceCache::Handler> handlers = getHandlers(events.front().getTopic());
+
+  for (int i = 0; i < handlers.size(); ++i)
+  {
+    const ctkEAHandlerReferenceCache::Handler& handler = handlers.at(i);
+    if (!isDeliverable(handler))
     {
-      try
+      continue;
+    }
+
+    QList<ctkEvent> matching;
+    if (!handler.filter)
+    {
+      matching = events;
+    }
+    else
+    {
+      for (int j = 0; j < events.size(); ++j)
       {
-        if (event.matches(filters->createFilter(
-                            ref.getProperty(ctkEventConstants::EVENT_FILTER).toString())))
+        if (events.at(j).matches(handler.filter))
         {
-          result.push_back(ctkEAHandlerTask<Self>(ref, event, this));
+          matching.push_back(events.at(j));
         }
       }
-      catch (const ctkInvalidArgumentException& e)
-      {
-        CTK_WARN_SR_EXC(ctkEventAdminActivator::getLogService(), ref, &e)
-            << "Invalid EVENT_FILTER - Blacklisting ServiceReference ["
-            << ref << " | Plugin(" << ref.getPlugin() << ")]";
+    }
 
-        blackList->add(ref);
+    if (matching.isEmpty())
+    {
+      continue;
+    }
+
+    if (handler.coalesce)
+    {
+      // latest value wins
+      result.push_back(ctkEAHandlerTask<Self>(handler.ref, matching.back(), this));
+    }
+    else if (handler.batch)
+    {
+      result.push_back(ctkEAHandlerTask<Self>(handler.ref, matching, this));
+    }
+    else
+    {
+      for (int j = 0; j < matching.size(); ++j)
+      {
+        result.push_back(ctkEAHandlerTask<Self>(handler.ref, matching.at(j), this));
       }
     }
   }
@@ -94,12 +145,75 @@ createHandlerTasks(const ctkEvent& event)
   return result;
 }
 
+template<class BlackList, class TopicHandlerFilters, class Filters>
+QList<ctkEAHandlerReferenceCache::Handler>
+ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
+getHandlers(const QString& topic)
+{
+  QList<ctkEAHandlerReferenceCache::Handler> handlers;
+
+  if (!handlerRefsCache->find(topic, handlers))
+  {
+    const int generation = handlerRefsCache->getGeneration();
+    try
+    {
+      QList<ctkServiceReference> handlerRefs = context->getServiceReferences<ctkEventHandler>(
+            topicHandlerFilters->createFilterForTopic(topic));
+      handlers = handlerRefsCache->insert(topic, handlerRefs, generation);
+    }
+    catch (const ctkInvalidArgumentException& e)
+    {
+      CTK_WARN_EXC(ctkEventAdminActivator::getLogService(), &e)
+          << "Invalid EVENT_TOPIC [" << topic << "]";
+    }
+  }
+
+  return handlers;
+}
+
+template<class BlackList, class TopicHandlerFilters, class Filters>
+bool
+ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
+isDeliverable(const ctkEAHandlerReferenceCache::Handler& handler)
+{
+  const ctkServiceReference& ref = handler.ref;
+  if (blackList->contains(ref)
+      //TODO security
+      //|| !ref.getPlugin()->hasPermission(
+      //  PermissionsUtil.createSubscribePermission(event.getTopic()))
+      )
+  {
+    return false;
+  }
+
+  if (!handler.filterError.isEmpty())
+  {
+    ctkInvalidArgumentException e(handler.filterError);
+    CTK_WARN_SR_EXC(ctkEventAdminActivator::getLogService(), ref, &e)
+        << "Invalid EVENT_FILTER - Blacklisting ServiceReference ["
+        << ref << " | Plugin(" << ref.getPlugin() << ")]";
+
+    blackList->add(ref);
+    if (metrics)
+    {
+      metrics->handlerBlacklisted(ref);
+    }
+    return false;
+  }
+
+  return true;
+}
+
 template<class BlackList, class TopicHandlerFilters, class Filters>
 void
 ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
 blackListRef(const ctkServiceReference& handlerRef)
 {
   blackList->add(handlerRef);
+  if (metrics)
+  {
+    metrics->handlerTimedOut(handlerRef);
+  }
 
   CTK_WARN(ctkEventAdminActivator::getLogService())
       << "Blacklisting ServiceReference [" << handlerRef << " | Plugin("
@@ -134,6 +248,14 @@ ungetEventHandler(ctkEventHandler* handler,
   }
 }
 
+template<class BlackList, class TopicHandlerFilters, class Filters>
+ctkEAMetrics*
+ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
+getMetrics() const
+{
+  return metrics;
+}
+
 template<class BlackList, class TopicHandlerFilters, class Filters>
 void
 ctkEABlacklistingHandlerTasks<BlackList, TopicHandlerFilters, Filters>::
@@ -33,6 +33,9 @@
 #include "ctkEATopicHandlerFilters_p.h"
 #include "ctkEAFilters_p.h"
 #include "ctkEABlackList_p.h"
+#include "ctkEAHandlerReferenceCache_p.h"
+
+class ctkEAMetrics;
 
 /**
  * This class is an implementation of the ctkEAHandlerTasks interface that does provide
@@ -41,7 +44,9 @@
  * book-keeping of <tt>ctkEventHandler</tt> services while they come and go but a
  * query for each sent event. In order to do this, an ldap-filter is created that
  * will match applicable <tt>ctkEventHandler</tt> references. In order to ease some of
- * the overhead pains of this approach some light caching is going on.
+ * the overhead pains of this approach some light caching is going on. In particular,
+ * the references matching a topic are cached until a <tt>ctkEventHandler</tt>
+ * service is registered, modified or unregistered.
  */
 template<class BlackList, class TopicHandlerFilters, class Filters>
 class ctkEABlacklistingHandlerTasks :
@@ -64,9 +69,16 @@ private:
   ctkEATopicHandlerFilters<TopicHandlerFilters>* topicHandlerFilters;
 
   // Used to create the filters that are used to determine whether an applicable
-  // event handler is interested in a particular event
+  // event handler is interested in a particular event. The filters of the
+  // handlers are parsed by handlerRefsCache, this is for ad-hoc filters.
   ctkEAFilters<Filters>* filters;
 
+  // The handler references of the topics already queried
+  ctkEAHandlerReferenceCache* handlerRefsCache;
+
+  // The delivery metrics, null if they are not collected
+  ctkEAMetrics* const metrics;
+
 public:
 
   /**
@@ -76,11 +88,13 @@ public:
    * @param blackList The set to use for keeping track of blacklisted references
    * @param topicHandlerFilters The factory for topic handler filters
    * @param filters The factory for <tt>ctkLDAPSearchFilter</tt> objects
+   * @param metrics The delivery metrics to record, or null
    */
   ctkEABlacklistingHandlerTasks(ctkPluginContext* context,
                                 ctkEABlackList<BlackList>* blackList,
                                 ctkEATopicHandlerFilters<TopicHandlerFilters>* topicHandlerFilters,
-                                ctkEAFilters<Filters>* filters);
+                                ctkEAFilters<Filters>* filters,
+                                ctkEAMetrics* metrics = 0);
 
   ~ctkEABlacklistingHandlerTasks();
 
@@ -96,6 +110,21 @@ public:
    */
   QList<ctkEAHandlerTask<Self> > createHandlerTasks(const ctkEvent& event);
 
+  /**
+   * Create the handler tasks for a batch of events of the same topic. Handlers
+   * registered with the <tt>DELIVERY_BATCH</tt> delivery quality get one task
+   * for all their matching events, handlers registered with
+   * <tt>DELIVERY_COALESCE</tt> a task for their last matching event only and
+   * the other handlers a task per matching event.
+   *
+   * @param events The events for which' handlers delivery tasks must be created
+   *
+   * @return The delivery tasks for the handlers that match the given events
+   *
+   * @see ctkHandlerTasks#createHandlerTasks(const QList<ctkEvent>&)
+   */
+  QList<ctkEAHandlerTask<Self> > createHandlerTasks(const QList<ctkEvent>& events);
+
   /**
    * Blacklist the given service reference. This is a private method and only
    * public due to its usage in a friend class.
@@ -127,6 +156,13 @@ public:
   void ungetEventHandler(ctkEventHandler* handler,
                          const ctkServiceReference& handlerRef);
 
+  /**
+   * Get the delivery metrics to record, null if they are not collected.
+   * This is a private method and only public due to its usage in a friend
+   * class.
+   */
+  ctkEAMetrics* getMetrics() const;
+
 private:
 
   /*
@@ -152,6 +188,18 @@ private:
 
   NullEventHandler nullEventHandler;
 
+  /*
+   * Get the handlers of topic, from the cache or the service registry.
+   */
+  QList<ctkEAHandlerReferenceCache::Handler> getHandlers(const QString& topic);
+
+  /*
+   * Check whether events may be delivered to handler: it must not be
+   * blacklisted and its EVENT_FILTER must be valid. A handler with an
+   * invalid filter is blacklisted.
+   */
+  bool isDeliverable(const ctkEAHandlerReferenceCache::Handler& handler);
+
   /*
    * This is a utility method that will throw a <tt>ctkInvalidArgumentException</tt>
    * in case that the given object is null. The message will be of the form name +
@@ -0,0 +1,148 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkEAHandlerReferenceCache_p.h"
+
+#include <ctkException.h>
+#include <ctkPluginConstants.h>
+#include <ctkPluginContext.h>
+#include <ctkServiceEvent.h>
+#include <service/event/ctkEventConstants.h>
+#include <service/event/ctkEventHandler.h>
+
+const int ctkEAHandlerReferenceCache::MAX_SIZE = 1024;
+
+ctkEAHandlerReferenceCache::ctkEAHandlerReferenceCache(ctkPluginContext* context)
+  : context(context), generation(0), cacheGeneration(0)
+{
+  context->connectServiceListener(this, "serviceChanged",
+                                  QString("(") + ctkPluginConstants::OBJECTCLASS + "=" +
+                                  qobject_interface_iid<ctkEventHandler*>() + ")");
+}
+
+ctkEAHandlerReferenceCache::~ctkEAHandlerReferenceCache()
+{
+  try
+  {
+    context->disconnectServiceListener(this, "serviceChanged");
+  }
+  catch (const ctkIllegalStateException&)
+  {
+    // the plugin context is already invalid
+  }
+}
+
+int ctkEAHandlerReferenceCache::getGeneration()
+{
+  return generation.fetchAndAddOrdered(0);
+}
+
+const ctkEAHandlerReferenceCache::Handler& ctkEAHandlerReferenceCache::handler(const ctkServiceReference& ref)
+{
+  QHash<ctkServiceReference, Handler>::iterator it = handlers.find(ref);
+  if (it != handlers.end())
+  {
+    return it.value();
+  }
+
+  Handler entry;
+  entry.ref = ref;
+  const QString filter = ref.getProperty(ctkEventConstants::EVENT_FILTER).toString();
+  if (!filter.isEmpty())
+  {
+    try
+    {
+      entry.filter = ctkLDAPSearchFilter(filter);
+    }
+    catch (const ctkInvalidArgumentException& e)
+    {
+      entry.filterError = e.message();
+    }
+  }
+  const QStringList delivery = ref.getProperty(ctkEventConstants::EVENT_DELIVERY).toStringList();
+  entry.batch = delivery.contains(ctkEventConstants::DELIVERY_BATCH);
+  entry.coalesce = delivery.contains(ctkEventConstants::DELIVERY_COALESCE);
+  return handlers.insert(ref, entry).value();
+}
+
+bool ctkEAHandlerReferenceCache::find(const QString& topic, QList<Handler>& handlerList)
+{
+  QReadLocker l(&lock);
+  if (cacheGeneration != getGeneration())
+  {
+    return false;
+  }
+
+  QHash<QString, QList<Handler> >::const_iterator it = cache.find(topic);
+  if (it == cache.end())
+  {
+    return false;
+  }
+  handlerList = it.value();
+  return true;
+}
+
+QList<ctkEAHandlerReferenceCache::Handler>
+ctkEAHandlerReferenceCache::insert(const QString& topic,
+                                   const QList<ctkServiceReference>& handlerRefs,
+                                   int generation)
+{
+  QWriteLocker l(&lock);
+
+  QList<Handler> handlerList;
+  foreach(const ctkServiceReference& ref, handlerRefs)
+  {
+    handlerList.push_back(handler(ref));
+  }
+
+  if (generation != getGeneration())
+  {
+    // the handlers changed while the registry was queried
+    return handlerList;
+  }
+
+  if (cacheGeneration != generation || cache.size() >= MAX_SIZE)
+  {
+    cache.clear();
+    cacheGeneration = generation;
+  }
+  cache.insert(topic, handlerList);
+  return handlerList;
+}
+
+void ctkEAHandlerReferenceCache::serviceChanged(const ctkServiceEvent& event)
+{
+  {
+    QWriteLocker l(&lock);
+    const ctkServiceReference ref = event.getServiceReference();
+    handlers.remove(ref);
+    if (event.getType() != ctkServiceEvent::UNREGISTERING)
+    {
+      // Parse the filter of the new or modified handler now rather than
+      // on its first event
+      handler(ref);
+    }
+  }
+
+  // The cached entries are dropped lazily, see insert()
+  generation.fetchAndAddOrdered(1);
+}
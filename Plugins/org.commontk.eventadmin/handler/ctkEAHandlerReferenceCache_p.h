@@ -0,0 +1,132 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEAHANDLERREFERENCECACHE_P_H
+#define CTKEAHANDLERREFERENCECACHE_P_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QHash>
+#include <QReadWriteLock>
+
+#include <ctkLDAPSearchFilter.h>
+#include <ctkServiceReference.h>
+
+class ctkPluginContext;
+class ctkServiceEvent;
+
+/**
+ * Caches the <tt>ctkEventHandler</tt> references matching a topic, as
+ * returned by the service registry for the topic handler filter of the topic.
+ * The registry does the wildcard matching, hence the cache holds one entry
+ * per topic of the events and not per topic of the handlers.
+ *
+ * The cache listens to the service events of the <tt>ctkEventHandler</tt>
+ * services. Any registration, modification or unregistration invalidates
+ * all the cached topics. While the handlers don't change, looking up the
+ * handlers of an event doesn't query the service registry.
+ *
+ * The <tt>EVENT_FILTER</tt> and <tt>EVENT_DELIVERY</tt> properties of each
+ * handler are parsed once, when the handler is registered or modified, and
+ * returned along with its reference.
+ */
+class ctkEAHandlerReferenceCache : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  struct Handler
+  {
+    ctkServiceReference ref;
+    /// The parsed EVENT_FILTER, null if the handler has no filter
+    ctkLDAPSearchFilter filter;
+    /// The parse error if the EVENT_FILTER is invalid, empty otherwise
+    QString filterError;
+    /// Whether EVENT_DELIVERY contains DELIVERY_BATCH
+    bool batch;
+    /// Whether EVENT_DELIVERY contains DELIVERY_COALESCE
+    bool coalesce;
+
+    Handler() : batch(false), coalesce(false) {}
+  };
+
+private:
+
+  // The maximum number of cached topics, the cache is cleared once
+  // it is reached
+  static const int MAX_SIZE; // = 1024
+
+  ctkPluginContext* const context;
+
+  // Incremented on each service event of a ctkEventHandler
+  QAtomicInt generation;
+
+  QReadWriteLock lock;
+
+  // The generation the cached entries are valid for
+  int cacheGeneration;
+  QHash<QString, QList<Handler> > cache;
+
+  // The handlers with a parsed EVENT_FILTER, by reference
+  QHash<ctkServiceReference, Handler> handlers;
+
+  /**
+   * Get the handler of ref, parsing its EVENT_FILTER if needed. Must be
+   * called with the lock held for writing.
+   */
+  const Handler& handler(const ctkServiceReference& ref);
+
+public:
+
+  ctkEAHandlerReferenceCache(ctkPluginContext* context);
+  ~ctkEAHandlerReferenceCache();
+
+  /**
+   * The current generation of the handlers. Read it before querying the
+   * registry and pass it to <tt>insert()</tt>.
+   */
+  int getGeneration();
+
+  /**
+   * Get the cached handlers of topic.
+   *
+   * @return <code>false</code> if topic is not cached or the handlers changed
+   *         since it was cached
+   */
+  bool find(const QString& topic, QList<Handler>& handlers);
+
+  /**
+   * Cache the handler references of topic, queried from the registry at
+   * the given generation. Nothing is cached if the handlers changed since.
+   *
+   * @return The handlers of the references
+   */
+  QList<Handler> insert(const QString& topic, const QList<ctkServiceReference>& handlerRefs,
+                        int generation);
+
+protected Q_SLOTS:
+
+  void serviceChanged(const ctkServiceEvent& event);
+};
+
+#endif // CTKEAHANDLERREFERENCECACHE_P_H
@@ -49,6 +49,20 @@ struct ctkEAHandlerTasks
     return static_cast<Impl*>(this)->createHandlerTasks(event);
   }
 
+  /**
+   * Create the handler tasks for a batch of events of the same topic. Event
+   * handlers asking for batched delivery get one task for all their matching
+   * events, the others one task per matching event.
+   *
+   * @param events The events for which' handlers delivery tasks must be created
+   *
+   * @return The delivery tasks for the handlers that match the given events
+   */
+  QList<ctkEAHandlerTask<Impl> > createHandlerTasks(const QList<ctkEvent>& events)
+  {
+    return static_cast<Impl*>(this)->createHandlerTasks(events);
+  }
+
   virtual ~ctkEAHandlerTasks() {}
 
 };
@@ -1,37 +0,0 @@
-/*=============================================================================
-
-  Library: CTK
-
-  Copyright (c) German Cancer Research Center,
-    Division of Medical and Biological Informatics
-
-  Licensed under the Apache License, Version 2.0 (the "License");
-  you may not use this file except in compliance with the License.
-  You may obtain a copy of the License at
-
-    http://www.apache.org/licenses/LICENSE-2.0
-
-  Unless required by applicable law or agreed to in writing, software
-  distributed under the License is distributed on an "AS IS" BASIS,
-  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-  See the License for the specific language governing permissions and
-  limitations under the License.
-
-=============================================================================*/
-
-
-#include "ctkEASlotHandler_p.h"
-
-
-void ctkEASlotHandler::updateProperties(const ctkDictionary& properties)
-{
-  if (reg)
-  {
-    reg.setProperties(properties);
-  }
-}
-
-void ctkEASlotHandler::handleEvent(const ctkEvent& event)
-{
-  emit eventOccured(event);
-}
@@ -0,0 +1,321 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkEASlotSubscriptions_p.h"
+
+#include <ctkException.h>
+#include <ctkEventAdminActivator_p.h>
+#include <service/event/ctkEventConstants.h>
+
+#include <QMap>
+
+ctkEASlotSubscription::ctkEASlotSubscription(qlonglong id, const QObject* subscriber,
+                                             int methodIndex,
+                                             const ctkDictionary& properties,
+                                             Qt::ConnectionType type,
+                                             const QSharedPointer<QAtomicInt>& blacklisted)
+  : id(id), subscriber(const_cast<QObject*>(subscriber)),
+    className(subscriber->metaObject()->className()), methodIndex(methodIndex),
+    method(subscriber->metaObject()->method(methodIndex)), hasEventArgument(false), type(type),
+    properties(properties), validFilter(true), coalesce(false), blacklisted(blacklisted)
+{
+  const QList<QByteArray> parameterTypes = method.parameterTypes();
+  if (parameterTypes.size() > 1 ||
+      (parameterTypes.size() == 1 && parameterTypes.front() != "ctkEvent"))
+  {
+    throw ctkInvalidArgumentException(QString("the slot %1 must take no or a ctkEvent argument")
+                                      .arg(getName()));
+  }
+  hasEventArgument = !parameterTypes.isEmpty();
+
+  topics = properties.value(ctkEventConstants::EVENT_TOPIC).toStringList();
+
+  const QString filterString = properties.value(ctkEventConstants::EVENT_FILTER).toString();
+  if (!filterString.isEmpty())
+  {
+    try
+    {
+      filter = ctkLDAPSearchFilter(filterString);
+    }
+    catch (const ctkInvalidArgumentException& e)
+    {
+      CTK_WARN_EXC(ctkEventAdminActivator::getLogService(), &e)
+          << "Invalid EVENT_FILTER - Ignoring slot [" << getName() << "]";
+      validFilter = false;
+    }
+  }
+
+  coalesce = properties.value(ctkEventConstants::EVENT_DELIVERY).toStringList()
+      .contains(ctkEventConstants::DELIVERY_COALESCE);
+}
+
+qlonglong ctkEASlotSubscription::getId() const
+{
+  return id;
+}
+
+QString ctkEASlotSubscription::getSubscriberClassName() const
+{
+  return className;
+}
+
+QString ctkEASlotSubscription::getName() const
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+  return className + "::" + method.methodSignature();
+#else
+  return className + "::" + method.signature();
+#endif
+}
+
+const QObject* ctkEASlotSubscription::getSubscriber() const
+{
+  return subscriber.data();
+}
+
+int ctkEASlotSubscription::getMethodIndex() const
+{
+  return methodIndex;
+}
+
+Qt::ConnectionType ctkEASlotSubscription::getConnectionType() const
+{
+  return type;
+}
+
+QStringList ctkEASlotSubscription::getTopics() const
+{
+  return topics;
+}
+
+bool ctkEASlotSubscription::isCoalesced() const
+{
+  return coalesce;
+}
+
+bool ctkEASlotSubscription::isDeliverable() const
+{
+  return validFilter && !blacklisted->fetchAndAddOrdered(0) && !subscriber.isNull();
+}
+
+bool ctkEASlotSubscription::matches(const ctkEvent& event) const
+{
+  return !filter || event.matches(filter);
+}
+
+void ctkEASlotSubscription::blacklist()
+{
+  blacklisted->fetchAndStoreOrdered(1);
+}
+
+void ctkEASlotSubscription::invoke(const ctkEvent& event)
+{
+  QObject* receiver = subscriber.data();
+  if (receiver == 0)
+  {
+    // the subscriber was deleted
+    return;
+  }
+
+  if (hasEventArgument)
+  {
+    method.invoke(receiver, type, Q_ARG(ctkEvent, event));
+  }
+  else
+  {
+    method.invoke(receiver, type);
+  }
+}
+
+ctkDictionary ctkEASlotSubscription::getProperties() const
+{
+  return properties;
+}
+
+QSharedPointer<QAtomicInt> ctkEASlotSubscription::getBlacklisted() const
+{
+  return blacklisted;
+}
+
+ctkEASlotSubscriptions::ctkEASlotSubscriptions()
+  : lastId(0), requireTopic(true)
+{
+
+}
+
+void ctkEASlotSubscriptions::setRequireTopic(bool requireTopic)
+{
+  QWriteLocker l(&lock);
+  this->requireTopic = requireTopic;
+}
+
+qlonglong ctkEASlotSubscriptions::subscribe(const QObject* subscriber, const char* member,
+                                            const ctkDictionary& properties, Qt::ConnectionType type)
+{
+  // Strip the code of the SLOT() and SIGNAL() macros
+  QByteArray signature(member);
+  if (!signature.isEmpty() && signature.at(0) >= '0' && signature.at(0) <= '2')
+  {
+    signature.remove(0, 1);
+  }
+  signature = QMetaObject::normalizedSignature(signature.constData());
+
+  const QMetaObject* metaObject = subscriber->metaObject();
+  const int index = metaObject->indexOfMethod(signature.constData());
+  if (index < 0)
+  {
+    throw ctkInvalidArgumentException(QString("%1 has no method %2")
+                                      .arg(metaObject->className()).arg(signature.constData()));
+  }
+
+  QWriteLocker l(&lock);
+  const qlonglong id = ++lastId;
+  subscriptions.insert(id, Subscription(new ctkEASlotSubscription(
+                                          id, subscriber, index, properties, type,
+                                          QSharedPointer<QAtomicInt>(new QAtomicInt(0)))));
+  reindex();
+  return id;
+}
+
+void ctkEASlotSubscriptions::unsubscribe(qlonglong id)
+{
+  QWriteLocker l(&lock);
+  if (subscriptions.remove(id))
+  {
+    reindex();
+  }
+}
+
+bool ctkEASlotSubscriptions::updateProperties(qlonglong id, const ctkDictionary& properties)
+{
+  QWriteLocker l(&lock);
+  Subscription subscription = subscriptions.value(id);
+  if (!subscription || subscription->getSubscriber() == 0)
+  {
+    return false;
+  }
+
+  // A property is removed by providing an invalid QVariant
+  ctkDictionary newProperties = subscription->getProperties();
+  for (ctkDictionary::const_iterator it = properties.begin(); it != properties.end(); ++it)
+  {
+    if (it.value().isValid())
+    {
+      newProperties.insert(it.key(), it.value());
+    }
+    else
+    {
+      newProperties.remove(it.key());
+    }
+  }
+
+  subscriptions.insert(id, Subscription(new ctkEASlotSubscription(
+                                          id, subscription->getSubscriber(),
+                                          subscription->getMethodIndex(), newProperties,
+                                          subscription->getConnectionType(),
+                                          subscription->getBlacklisted())));
+  reindex();
+  return true;
+}
+
+void ctkEASlotSubscriptions::reindex()
+{
+  topicIndex.clear();
+  wildcardIndex.clear();
+  noTopic.clear();
+
+  // QHash is unordered, index the subscriptions by id
+  QMap<qlonglong, Subscription> ordered;
+  for (QHash<qlonglong, Subscription>::const_iterator it = subscriptions.begin();
+       it != subscriptions.end(); ++it)
+  {
+    ordered.insert(it.key(), it.value());
+  }
+
+  foreach (const Subscription& subscription, ordered)
+  {
+    const QStringList topics = subscription->getTopics();
+    if (topics.isEmpty())
+    {
+      noTopic.push_back(subscription);
+    }
+    foreach (const QString& topic, topics)
+    {
+      if (topic == "*")
+      {
+        wildcardIndex[QString("")].push_back(subscription);
+      }
+      else if (topic.endsWith("/*"))
+      {
+        wildcardIndex[topic.left(topic.size() - 1)].push_back(subscription);
+      }
+      else
+      {
+        topicIndex[topic].push_back(subscription);
+      }
+    }
+  }
+}
+
+QList<ctkEASlotSubscriptions::Subscription> ctkEASlotSubscriptions::getSubscriptions(const QString& topic) const
+{
+  QReadLocker l(&lock);
+  if (subscriptions.isEmpty())
+  {
+    return QList<Subscription>();
+  }
+
+  QMap<qlonglong, Subscription> result;
+  foreach (const Subscription& subscription, topicIndex.value(topic))
+  {
+    result.insert(subscription->getId(), subscription);
+  }
+  if (!wildcardIndex.isEmpty())
+  {
+    foreach (const Subscription& subscription, wildcardIndex.value(QString("")))
+    {
+      result.insert(subscription->getId(), subscription);
+    }
+    for (int i = 0; i < topic.size(); ++i)
+    {
+      if (topic.at(i) == QChar('/'))
+      {
+        QHash<QString, QList<Subscription> >::const_iterator it = wildcardIndex.find(topic.left(i + 1));
+        if (it != wildcardIndex.end())
+        {
+          foreach (const Subscription& subscription, it.value())
+          {
+            result.insert(subscription->getId(), subscription);
+          }
+        }
+      }
+    }
+  }
+  if (!requireTopic)
+  {
+    foreach (const Subscription& subscription, noTopic)
+    {
+      result.insert(subscription->getId(), subscription);
+    }
+  }
+  return result.values();
+}
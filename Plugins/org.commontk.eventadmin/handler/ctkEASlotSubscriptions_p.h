@@ -0,0 +1,203 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEASLOTSUBSCRIPTIONS_P_H
+#define CTKEASLOTSUBSCRIPTIONS_P_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMetaMethod>
+#include <QPointer>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+
+#include <ctkLDAPSearchFilter.h>
+#include <service/event/ctkEvent.h>
+
+/**
+ * A slot subscribed through <tt>ctkEventAdmin::subscribeSlot()</tt>. The
+ * subscription is immutable, updating its properties replaces it, except for
+ * its blacklisting.
+ */
+class ctkEASlotSubscription
+{
+
+private:
+
+  const qlonglong id;
+
+  // The subscriber is not owned, it may be deleted before it is unsubscribed
+  QPointer<QObject> subscriber;
+  const QString className;
+
+  const int methodIndex;
+  QMetaMethod method;
+  bool hasEventArgument;
+  const Qt::ConnectionType type;
+
+  const ctkDictionary properties;
+  QStringList topics;
+  ctkLDAPSearchFilter filter;
+  bool validFilter;
+  bool coalesce;
+
+  // Shared by the subscriptions replacing each other
+  QSharedPointer<QAtomicInt> blacklisted;
+
+public:
+
+  /**
+   * An invalid EVENT_FILTER is logged and the subscription ignored.
+   *
+   * @throws ctkInvalidArgumentException If <code>method</code> takes other
+   *         arguments than a <code>ctkEvent</code>.
+   */
+  ctkEASlotSubscription(qlonglong id, const QObject* subscriber, int methodIndex,
+                        const ctkDictionary& properties, Qt::ConnectionType type,
+                        const QSharedPointer<QAtomicInt>& blacklisted);
+
+  qlonglong getId() const;
+
+  /**
+   * The class name of the subscriber, for the <tt>IgnoreTimeout</tt>
+   * configuration.
+   */
+  QString getSubscriberClassName() const;
+
+  /**
+   * The subscriber class name followed by the slot signature.
+   */
+  QString getName() const;
+
+  const QObject* getSubscriber() const;
+
+  /**
+   * The index of the slot in the meta-object of the subscriber.
+   */
+  int getMethodIndex() const;
+
+  Qt::ConnectionType getConnectionType() const;
+
+  /**
+   * The EVENT_TOPIC property of the subscription, empty if none.
+   */
+  QStringList getTopics() const;
+
+  /**
+   * Whether EVENT_DELIVERY contains DELIVERY_COALESCE.
+   */
+  bool isCoalesced() const;
+
+  /**
+   * Whether the subscription has no invalid EVENT_FILTER, was not blacklisted
+   * and the subscriber still exists.
+   */
+  bool isDeliverable() const;
+
+  /**
+   * Whether the event matches the EVENT_FILTER of the subscription.
+   */
+  bool matches(const ctkEvent& event) const;
+
+  /**
+   * Blacklist the subscription, its slot won't be called any more.
+   */
+  void blacklist();
+
+  /**
+   * Call the slot with the event, using the connection type of the
+   * subscription.
+   */
+  void invoke(const ctkEvent& event);
+
+  ctkDictionary getProperties() const;
+
+  QSharedPointer<QAtomicInt> getBlacklisted() const;
+
+};
+
+/**
+ * The slots subscribed to the event admin, indexed by their topics. The
+ * subscribed slots are called directly, without registering them as
+ * <tt>ctkEventHandler</tt> services, hence without looking them up in
+ * the service registry for each event.
+ *
+ * The index holds the exact topics and the prefixes of the wildcard topics
+ * (<code>a/b/</code> for <code>a/b/&#42;</code>). Looking up the slots of an
+ * event costs one hash lookup per topic token.
+ */
+class ctkEASlotSubscriptions
+{
+
+public:
+
+  typedef QSharedPointer<ctkEASlotSubscription> Subscription;
+
+private:
+
+  mutable QReadWriteLock lock;
+
+  qlonglong lastId;
+  bool requireTopic;
+
+  QHash<qlonglong, Subscription> subscriptions;
+
+  // The index built from subscriptions
+  QHash<QString, QList<Subscription> > topicIndex;
+  QHash<QString, QList<Subscription> > wildcardIndex;
+  QList<Subscription> noTopic;
+
+  /**
+   * Rebuild the index, must be called with the lock held for writing.
+   */
+  void reindex();
+
+public:
+
+  ctkEASlotSubscriptions();
+
+  /**
+   * Deliver all events to slots subscribed without topic if
+   * <code>requireTopic</code> is <code>false</code>.
+   */
+  void setRequireTopic(bool requireTopic);
+
+  /**
+   * @throws ctkInvalidArgumentException If <code>member</code> is not a method
+   *         of <code>subscriber</code> taking no or a <code>ctkEvent</code>
+   *         argument.
+   */
+  qlonglong subscribe(const QObject* subscriber, const char* member,
+                      const ctkDictionary& properties, Qt::ConnectionType type);
+
+  void unsubscribe(qlonglong id);
+
+  bool updateProperties(qlonglong id, const ctkDictionary& properties);
+
+  /**
+   * Get the subscriptions to topic, in subscription order.
+   */
+  QList<Subscription> getSubscriptions(const QString& topic) const;
+
+};
+
+#endif // CTKEASLOTSUBSCRIPTIONS_P_H
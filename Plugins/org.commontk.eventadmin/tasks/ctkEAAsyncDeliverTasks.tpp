@@ -19,6 +19,8 @@
 
 =============================================================================*/
 
+#include <util/ctkEAMetrics_p.h>
+
 template<class SyncDeliverTasks, class HandlerTask>
 class ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::TaskExecuter
     : public ctkEARunnable
@@ -53,6 +55,10 @@ public:
         currTasks.push_back(tasks.takeFirst());
       }
       tc->deliver_task->execute(currTasks);
+      if (tc->metrics)
+      {
+        tc->metrics->tasksDelivered(currTasks.size());
+      }
       {
         QMutexLocker l(&tc->running_threads_mutex);
         running = tasks.size() > 0;
@@ -73,14 +79,55 @@ public:
 };
 
 template<class SyncDeliverTasks, class HandlerTask>
-ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask)
- : pool(pool), deliver_task(deliverTask)
+ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask,
+                                                                              int shardCount, int batchSize,
+                                                                              ctkEAMetrics* metrics)
+ : pool(pool), deliver_task(deliverTask), sharded_tasks(0), metrics(metrics)
+{
+  if (shardCount > 0)
+  {
+    sharded_tasks = new ShardedDeliverTasks(deliverTask, shardCount, batchSize, metrics);
+  }
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::~ctkEAAsyncDeliverTasks()
 {
+  delete sharded_tasks;
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::update(int batchSize)
+{
+  if (sharded_tasks)
+  {
+    sharded_tasks->setBatchSize(batchSize);
+  }
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::stop()
+{
+  if (sharded_tasks)
+  {
+    sharded_tasks->stop();
+  }
 }
 
 template<class SyncDeliverTasks, class HandlerTask>
 void ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::execute(const QList<HandlerTask>& tasks)
 {
+  if (metrics)
+  {
+    metrics->tasksQueued(tasks.size());
+  }
+
+  if (sharded_tasks)
+  {
+    sharded_tasks->execute(tasks);
+    return;
+  }
+
   QThread* currentThread = QThread::currentThread();
   TaskExecuter* executer = 0;
   {
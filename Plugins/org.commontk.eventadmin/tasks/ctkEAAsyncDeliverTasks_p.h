@@ -24,9 +24,11 @@
 #define CTKEAASYNCDELIVERTASKS_P_H
 
 #include "ctkEADeliverTask_p.h"
+#include "ctkEAShardedDeliverTasks_p.h"
 #include <dispatch/ctkEADefaultThreadPool_p.h>
 
 class ctkEARunnable;
+class ctkEAMetrics;
 
 /**
  * This class does the actual work of the asynchronous event dispatch.
@@ -52,6 +54,16 @@ private:
   QHash<QThread*, ctkEARunnable*> running_threads;
   QMutex running_threads_mutex;
 
+  /**
+   * The workers delivering the events per handler, if configured. The
+   * pool is not used in this case.
+   */
+  typedef ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask> ShardedDeliverTasks;
+  ShardedDeliverTasks* sharded_tasks;
+
+  // The delivery metrics, null if they are not collected
+  ctkEAMetrics* metrics;
+
 public:
 
   /**
@@ -61,8 +73,18 @@ public:
    *        dispatching threads in case of timeout or that the asynchronous event
    *        dispatching thread is used to send a synchronous event
    * @param deliverTask The deliver tasks for dispatching the event.
+   * @param shardCount If greater than 0, the events are delivered by this
+   *        number of worker threads instead of the pool, see
+   *        <tt>ctkEAShardedDeliverTasks</tt>
+   * @param batchSize The maximum number of tasks delivered at once by a
+   *        worker thread
+   * @param metrics The delivery metrics to record, or null
    */
-  ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask);
+  ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask,
+                         int shardCount = 0, int batchSize = 1,
+                         ctkEAMetrics* metrics = 0);
+
+  ~ctkEAAsyncDeliverTasks();
 
   /**
    * This does not block an unrelated thread used to send a synchronous event.
@@ -73,6 +95,16 @@ public:
    */
   void execute(const QList<HandlerTask>& tasks);
 
+  /**
+   * Update the batch size of the worker threads, if any.
+   */
+  void update(int batchSize);
+
+  /**
+   * Deliver the events queued to the worker threads, if any, and stop them.
+   */
+  void stop();
+
 private:
 
   class TaskExecuter;
@@ -24,6 +24,7 @@
 #include <ctkEventAdminActivator_p.h>
 
 #include <handler/ctkEABlacklistingHandlerTasks_p.h>
+#include <util/ctkEAMetrics_p.h>
 
 template<class BlacklistingHandlerTasks>
 class ctkEAHandlerTask<BlacklistingHandlerTasks>::_GetAndUngetEventHandler
@@ -61,14 +62,30 @@ private:
 template<class BlacklistingHandlerTasks>
 ctkEAHandlerTask<BlacklistingHandlerTasks>::ctkEAHandlerTask(const ctkServiceReference& eventHandlerRef,
                                                              const ctkEvent& event, BlacklistingHandlerTasks* handlerTasks)
-  : eventHandlerRef(eventHandlerRef), event(event), handlerTasks(handlerTasks)
+  : eventHandlerRef(eventHandlerRef), handlerTasks(handlerTasks)
+{
+  events.push_back(event);
+}
+
+template<class BlacklistingHandlerTasks>
+ctkEAHandlerTask<BlacklistingHandlerTasks>::ctkEAHandlerTask(const ctkServiceReference& eventHandlerRef,
+                                                             const QList<ctkEvent>& events, BlacklistingHandlerTasks* handlerTasks)
+  : eventHandlerRef(eventHandlerRef), events(events), handlerTasks(handlerTasks)
 {
 
 }
 
+template<class BlacklistingHandlerTasks>
+ctkEAHandlerTask<BlacklistingHandlerTasks>::ctkEAHandlerTask(const ctkEASlotSubscriptions::Subscription& slot,
+                                                             const ctkEvent& event, BlacklistingHandlerTasks* handlerTasks)
+  : slot(slot), handlerTasks(handlerTasks)
+{
+  events.push_back(event);
+}
+
 template<class BlacklistingHandlerTasks>
 ctkEAHandlerTask<BlacklistingHandlerTasks>::ctkEAHandlerTask(const Self& task)
-  : eventHandlerRef(task.eventHandlerRef), event(task.event),
+  : eventHandlerRef(task.eventHandlerRef), slot(task.slot), events(task.events),
     handlerTasks(task.handlerTasks)
 {
 
@@ -79,7 +96,8 @@ ctkEAHandlerTask<BlacklistingHandlerTasks>&
 ctkEAHandlerTask<BlacklistingHandlerTasks>::operator=(const Self& task)
 {
   eventHandlerRef = task.eventHandlerRef;
-  event = task.event;
+  slot = task.slot;
+  events = task.events;
   handlerTasks = task.handlerTasks;
   return *this;
 }
@@ -87,31 +105,118 @@ ctkEAHandlerTask<BlacklistingHandlerTasks>::operator=(const Self& task)
 template<class BlacklistingHandlerTasks>
 QString ctkEAHandlerTask<BlacklistingHandlerTasks>::getHandlerClassName() const
 {
+  if (slot)
+  {
+    return slot->getSubscriberClassName();
+  }
   QObject* handler = _GetAndUngetEventHandler(handlerTasks, eventHandlerRef).getObject();
   return handler->metaObject()->className();
 }
 
+template<class BlacklistingHandlerTasks>
+ctkServiceReference ctkEAHandlerTask<BlacklistingHandlerTasks>::getEventHandlerReference() const
+{
+  return eventHandlerRef;
+}
+
+template<class BlacklistingHandlerTasks>
+uint ctkEAHandlerTask<BlacklistingHandlerTasks>::getHandlerHash() const
+{
+  return slot ? qHash(slot->getId()) : qHash(eventHandlerRef);
+}
+
 template<class BlacklistingHandlerTasks>
 void ctkEAHandlerTask<BlacklistingHandlerTasks>::execute()
 {
+  if (slot)
+  {
+    executeSlot();
+    return;
+  }
+
   // Get the service object
-  ctkEventHandler* const handler = _GetAndUngetEventHandler(handlerTasks, eventHandlerRef).getHandler();
+  const _GetAndUngetEventHandler getAndUnget(handlerTasks, eventHandlerRef);
+  ctkEventHandler* const handler = getAndUnget.getHandler();
+
+  ctkEAMetrics* const metrics = handlerTasks->getMetrics();
+  ctkEAMetrics::Timer timer;
+  if (metrics)
+  {
+    timer.start();
+  }
 
   try
   {
-    handler->handleEvent(event);
+    if (events.size() == 1)
+    {
+      handler->handleEvent(events.front());
+    }
+    else
+    {
+      handler->handleEvents(events);
+    }
   }
   catch (const std::exception& e)
   {
     // The spec says that we must catch exceptions and log them:
     CTK_WARN_SR_EXC(ctkEventAdminActivator::getLogService(), eventHandlerRef, &e)
-        << "Exception during event dispatch [" << event.getTopic() << "| Plugin("
+        << "Exception during event dispatch [" << events.front().getTopic() << "| Plugin("
         << eventHandlerRef.getPlugin()->getSymbolicName() << ")]";
   }
+
+  // The null handler of blacklisted and stale references is no QObject
+  const QObject* handlerObject = getAndUnget.getObject();
+  if (metrics && handlerObject)
+  {
+    metrics->eventDelivered(eventHandlerRef, handlerObject, timer.elapsedMicroseconds());
+  }
+}
+
+template<class BlacklistingHandlerTasks>
+void ctkEAHandlerTask<BlacklistingHandlerTasks>::executeSlot()
+{
+  if (!slot->isDeliverable())
+  {
+    return;
+  }
+
+  ctkEAMetrics* const metrics = handlerTasks->getMetrics();
+  ctkEAMetrics::Timer timer;
+  if (metrics)
+  {
+    timer.start();
+  }
+
+  try
+  {
+    slot->invoke(events.front());
+  }
+  catch (const std::exception& e)
+  {
+    CTK_WARN_EXC(ctkEventAdminActivator::getLogService(), &e)
+        << "Exception during event dispatch [" << events.front().getTopic() << "| Slot("
+        << slot->getName() << ")]";
+  }
+
+  if (metrics)
+  {
+    metrics->slotEventDelivered(slot->getId(), slot->getName(), timer.elapsedMicroseconds());
+  }
 }
 
 template<class BlacklistingHandlerTasks>
 void ctkEAHandlerTask<BlacklistingHandlerTasks>::blackListHandler()
 {
+  if (slot)
+  {
+    slot->blacklist();
+    if (ctkEAMetrics* const metrics = handlerTasks->getMetrics())
+    {
+      metrics->slotTimedOut(slot->getId());
+    }
+    CTK_WARN(ctkEventAdminActivator::getLogService())
+        << "Blacklisting slot [" << slot->getName() << "] due to timeout!";
+    return;
+  }
   handlerTasks->blackListRef(eventHandlerRef);
 }
@@ -24,13 +24,18 @@
 #define CTKEAHANDLERTASK_P_H
 
 #include <QAtomicInt>
+#include <QList>
 
 #include <ctkServiceReference.h>
 #include <service/event/ctkEvent.h>
 
+#include <handler/ctkEASlotSubscriptions_p.h>
+
 /**
- * A task that will deliver its event to its <tt>ctkEventHandler</tt> when executed
- * or blacklist the handler, respectively.
+ * A task that will deliver its events to its <tt>ctkEventHandler</tt> when executed
+ * or blacklist the handler, respectively. A task usually holds one event, the
+ * tasks of the handlers asking for batched delivery hold a batch of events.
+ * The tasks of the subscribed slots call the slot instead of a service.
  */
 template<class BlacklistingHandlerTasks>
 class ctkEAHandlerTask
@@ -43,14 +48,20 @@ private:
   // The service reference of the handler
   ctkServiceReference eventHandlerRef;
 
-  // The event to deliver to the handler
-  ctkEvent event;
+  // The subscribed slot, null if the handler is a service
+  ctkEASlotSubscriptions::Subscription slot;
+
+  // The events to deliver to the handler
+  QList<ctkEvent> events;
 
   // Used to blacklist the service or get the service object for the reference
   BlacklistingHandlerTasks* handlerTasks;
 
   class _GetAndUngetEventHandler;
 
+  // Call the subscribed slot with the event
+  void executeSlot();
+
 public:
 
   /**
@@ -64,6 +75,28 @@ public:
   ctkEAHandlerTask(const ctkServiceReference& eventHandlerRef,
                    const ctkEvent& event, BlacklistingHandlerTasks* handlerTasks);
 
+  /**
+   * Construct a delivery task for the given service and batch of events. The
+   * events are delivered in one call of <tt>ctkEventHandler::handleEvents()</tt>.
+   *
+   * @param eventHandlerRef The servicereference of the handler
+   * @param events The events to deliver
+   * @param handlerTasks Used to blacklist the service or get the service object
+   *      for the reference
+   */
+  ctkEAHandlerTask(const ctkServiceReference& eventHandlerRef,
+                   const QList<ctkEvent>& events, BlacklistingHandlerTasks* handlerTasks);
+
+  /**
+   * Construct a delivery task for the given subscribed slot and event.
+   *
+   * @param slot The subscribed slot
+   * @param event The event to deliver
+   * @param handlerTasks Used to get the delivery metrics
+   */
+  ctkEAHandlerTask(const ctkEASlotSubscriptions::Subscription& slot,
+                   const ctkEvent& event, BlacklistingHandlerTasks* handlerTasks);
+
   ctkEAHandlerTask(const Self& task);
 
   ctkEAHandlerTask& operator=(const Self& task);
@@ -74,7 +107,18 @@ public:
   QString getHandlerClassName() const;
 
   /**
-   * Deliver the event to the handler.
+   * Return the service reference of the handler, an invalid reference for
+   * a subscribed slot
+   */
+  ctkServiceReference getEventHandlerReference() const;
+
+  /**
+   * Return a hash of the handler, the same for all the tasks of a handler
+   */
+  uint getHandlerHash() const;
+
+  /**
+   * Deliver the events to the handler.
    */
   void execute();
 
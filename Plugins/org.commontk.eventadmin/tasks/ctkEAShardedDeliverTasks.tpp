@@ -0,0 +1,201 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include <ctkEventAdminActivator_p.h>
+
+#include <util/ctkEAMetrics_p.h>
+#include <util/ctkEAMPSCQueue_p.h>
+
+#include <ctkException.h>
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+template<class SyncDeliverTasks, class HandlerTask>
+class ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask>::Shard
+{
+public:
+
+  ctkEAMPSCQueue<HandlerTask> queue;
+
+  // The number of tasks pushed to the queue and not delivered yet. The
+  // producer making it non-zero wakes up the worker.
+  QAtomicInt pending;
+
+  QMutex mutex;
+  QWaitCondition waitCond;
+  bool stopping;
+
+  Worker* worker;
+
+  Shard() : pending(0), stopping(false), worker(0) {}
+};
+
+template<class SyncDeliverTasks, class HandlerTask>
+class ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask>::Worker
+    : public QThread
+{
+
+private:
+
+  typedef ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask> TopClass;
+
+  TopClass* tc;
+  Shard* shard;
+
+public:
+
+  Worker(TopClass* tc, Shard* shard)
+    : tc(tc), shard(shard)
+  {
+  }
+
+  void run()
+  {
+    tc->drain(shard);
+  }
+};
+
+template<class SyncDeliverTasks, class HandlerTask>
+ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask>::ctkEAShardedDeliverTasks(
+  DeliverTask* deliverTask, int shardCount, int batchSize, ctkEAMetrics* metrics)
+  : deliver_task(deliverTask), batchSize(qMax(1, batchSize)), stopped(0), metrics(metrics)
+{
+  for (int i = 0; i < qMax(1, shardCount); ++i)
+  {
+    Shard* shard = new Shard();
+    shard->worker = new Worker(this, shard);
+    shard->worker->setObjectName(QString("ctkEAShardedDeliverTasks-%1").arg(i));
+    shards.push_back(shard);
+    shard->worker->start();
+  }
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask>::~ctkEAShardedDeliverTasks()
+{
+  stop();
+  qDeleteAll(shards);
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask>::execute(const QList<HandlerTask>& tasks)
+{
+  if (stopped.fetchAndAddOrdered(0))
+  {
+    throw ctkIllegalStateException("The EventAdmin is stopped");
+  }
+
+  foreach(const HandlerTask& task, tasks)
+  {
+    Shard* shard = shards[task.getHandlerHash() % shards.size()];
+    shard->queue.push(task);
+    if (shard->pending.fetchAndAddOrdered(1) == 0)
+    {
+      QMutexLocker l(&shard->mutex);
+      shard->waitCond.wakeOne();
+    }
+  }
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+int ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask>::getBatchSize() const
+{
+  return const_cast<QAtomicInt&>(batchSize).fetchAndAddOrdered(0);
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask>::setBatchSize(int batchSize)
+{
+  this->batchSize.fetchAndStoreOrdered(qMax(1, batchSize));
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask>::stop()
+{
+  if (stopped.fetchAndStoreOrdered(1))
+  {
+    return;
+  }
+
+  foreach(Shard* shard, shards)
+  {
+    QMutexLocker l(&shard->mutex);
+    shard->stopping = true;
+    shard->waitCond.wakeOne();
+  }
+  // The shards are deleted with this object, a concurrent execute() may
+  // still push to their queues.
+  foreach(Shard* shard, shards)
+  {
+    shard->worker->wait();
+    delete shard->worker;
+    shard->worker = 0;
+  }
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEAShardedDeliverTasks<SyncDeliverTasks, HandlerTask>::drain(Shard* shard)
+{
+  QList<HandlerTask> batch;
+  while (true)
+  {
+    const int maxBatchSize = getBatchSize();
+    batch.clear();
+    while (batch.size() < maxBatchSize)
+    {
+      HandlerTask* task = shard->queue.take();
+      if (task == 0) break;
+      batch.push_back(*task);
+      delete task;
+    }
+
+    if (!batch.isEmpty())
+    {
+      try
+      {
+        deliver_task->execute(batch);
+      }
+      catch (const ctkException& e)
+      {
+        CTK_WARN_EXC(ctkEventAdminActivator::getLogService(), &e)
+            << "Exception during asynchronous event delivery";
+      }
+      shard->pending.fetchAndAddOrdered(-batch.size());
+      if (metrics)
+      {
+        metrics->tasksDelivered(batch.size());
+      }
+      continue;
+    }
+
+    QMutexLocker l(&shard->mutex);
+    if (shard->pending.fetchAndAddOrdered(0) == 0)
+    {
+      // Only stop once the queue is empty, the tasks posted before stop()
+      // are still delivered.
+      if (shard->stopping) return;
+      shard->waitCond.wait(&shard->mutex);
+    }
+  }
+}
@@ -0,0 +1,114 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEASHARDEDDELIVERTASKS_P_H
+#define CTKEASHARDEDDELIVERTASKS_P_H
+
+#include "ctkEADeliverTask_p.h"
+
+#include <QAtomicInt>
+#include <QList>
+
+class ctkEAMetrics;
+
+/**
+ * Asynchronous event delivery on a fixed set of worker threads. Each
+ * <tt>ctkEventHandler</tt> is assigned to one worker (a shard) and its
+ * tasks are appended to the lock-free queue of that worker. Hence, the
+ * events a handler receives from one posting thread are delivered in the
+ * order they were posted, while different handlers are served in parallel.
+ *
+ * A worker hands the queued tasks to the deliver task in batches of at
+ * most <tt>getBatchSize()</tt> tasks, so that a burst of posted events
+ * costs one hand-off per batch instead of one per event.
+ */
+template<class SyncDeliverTasks, class HandlerTask>
+class ctkEAShardedDeliverTasks : public ctkEADeliverTask<ctkEAShardedDeliverTasks<SyncDeliverTasks,HandlerTask>, HandlerTask>
+{
+
+private:
+
+  /**
+   * The deliver task for actually delivering the events. This
+   * is the sync deliver tasks as this has all the code for timeout
+   * handling etc.
+   */
+  typedef ctkEADeliverTask<SyncDeliverTasks, HandlerTask> DeliverTask;
+  DeliverTask* deliver_task;
+
+  class Shard;
+  class Worker;
+
+  QList<Shard*> shards;
+
+  QAtomicInt batchSize;
+  QAtomicInt stopped;
+
+  // The delivery metrics, null if they are not collected
+  ctkEAMetrics* metrics;
+
+public:
+
+  /**
+   * @param deliverTask The deliver tasks for dispatching the event.
+   * @param shardCount The number of worker threads
+   * @param batchSize The maximum number of tasks delivered at once by a worker
+   * @param metrics The delivery metrics to record, or null
+   */
+  ctkEAShardedDeliverTasks(DeliverTask* deliverTask, int shardCount, int batchSize,
+                           ctkEAMetrics* metrics = 0);
+
+  /**
+   * Stops the workers, see <tt>stop()</tt>. Tasks queued after
+   * <tt>stop()</tt> are dropped.
+   */
+  ~ctkEAShardedDeliverTasks();
+
+  /**
+   * Queue the tasks to the workers of their handlers. This does not block.
+   *
+   * @param tasks The event handler dispatch tasks to execute
+   *
+   * @throws ctkIllegalStateException - In case we are stopped
+   *
+   * @see ctkEADeliverTask#execute(const QList<HandlerTask>&)
+   */
+  void execute(const QList<HandlerTask>& tasks);
+
+  int getBatchSize() const;
+
+  void setBatchSize(int batchSize);
+
+  /**
+   * Deliver the queued tasks and stop the workers. This blocks until the
+   * workers are done.
+   */
+  void stop();
+
+private:
+
+  void drain(Shard* shard);
+};
+
+#include "ctkEAShardedDeliverTasks.tpp"
+
+#endif // CTKEASHARDEDDELIVERTASKS_P_H
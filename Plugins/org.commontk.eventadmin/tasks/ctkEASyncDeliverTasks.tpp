@@ -27,7 +27,14 @@
 #include <util/ctkEARendezvous_p.h>
 #include <util/ctkEATimeoutException_p.h>
 
-#include <QDateTime>
+#if QT_VERSION >= 0x040700
+#include <QElapsedTimer>
+// A monotonic clock for the timeouts of the cascaded events
+typedef QElapsedTimer ctkEAElapsedTimer;
+#else
+#include <QTime>
+typedef QTime ctkEAElapsedTimer;
+#endif
 
 template<class HandlerTask>
 class _TimeoutRunnable : public ctkEARunnable
@@ -133,6 +140,35 @@ void ctkEASyncDeliverTasks<HandlerTask>::update(long timeout, const QList<QStrin
 
 template<class HandlerTask>
 void ctkEASyncDeliverTasks<HandlerTask>::execute(const QList<HandlerTask>& tasks)
+{
+  // The handlers delivered without timeout are called inline on the
+  // sending thread, only the runs of tasks needing timeout handling are
+  // handed to the sync master thread. The order of the tasks is kept.
+  QList<HandlerTask> timeoutTasks;
+  foreach(HandlerTask task, tasks)
+  {
+    if (useTimeout(task))
+    {
+      timeoutTasks.push_back(task);
+      continue;
+    }
+
+    if (!timeoutTasks.isEmpty())
+    {
+      executeWithTimeout(timeoutTasks);
+      timeoutTasks.clear();
+    }
+    task.execute();
+  }
+
+  if (!timeoutTasks.isEmpty())
+  {
+    executeWithTimeout(timeoutTasks);
+  }
+}
+
+template<class HandlerTask>
+void ctkEASyncDeliverTasks<HandlerTask>::executeWithTimeout(const QList<HandlerTask>& tasks)
 {
   _RunInSyncMaster<HandlerTask> runnable(this, tasks);
   runnable.setAutoDelete(false);
@@ -156,11 +192,10 @@ void ctkEASyncDeliverTasks<HandlerTask>::executeInSyncMaster(const QList<Handler
     {
       // if this is a cascaded event, we directly use this thread
       // otherwise we could end up in a starvation
-      //TODO use Qt4.7 API
-      //long startTime = System.currentTimeMillis();
-      QDateTime startTime = QDateTime::currentDateTime();
+      ctkEAElapsedTimer startTime;
+      startTime.start();
       task.execute();
-      if (startTime.time().msecsTo(QDateTime::currentDateTime().time()) > timeout)
+      if (startTime.elapsed() > timeout)
       {
         task.blackListHandler();
       }
@@ -199,18 +234,15 @@ bool ctkEASyncDeliverTasks<HandlerTask>::useTimeout(const HandlerTask& task)
 {
   // we only check the classname if a timeout is configured
   long t = 0;
+  QList<Matcher*> currMatcherList;
   {
     QMutexLocker l(&mutex);
     t = timeout;
+    currMatcherList = ignoreTimeoutMatcher;
   }
 
   if (t > 0)
   {
-    QList<Matcher*> currMatcherList;
-    {
-      QMutexLocker l(&mutex);
-      currMatcherList = ignoreTimeoutMatcher;
-    }
     if (!currMatcherList.isEmpty())
     {
       QString className = task.getHandlerClassName();
@@ -117,7 +117,10 @@ public:
 
   /**
    * This blocks an unrelated thread used to send a synchronous event until the
-   * event is send (or a timeout occurs).
+   * event is send (or a timeout occurs). The handlers without timeout handling,
+   * i.e. all of them if no timeout is configured or the ones matching
+   * <tt>org.commontk.eventadmin.IgnoreTimeout</tt>, are called on the calling
+   * thread.
    *
    * @param tasks The event handler dispatch tasks to execute
    *
@@ -136,6 +139,11 @@ private:
    */
   bool useTimeout(const HandlerTask& task);
 
+  /**
+   * Execute the tasks in the sync master thread, with timeout handling.
+   */
+  void executeWithTimeout(const QList<HandlerTask>& tasks);
+
 };
 
 #include "ctkEASyncDeliverTasks.tpp"
@@ -0,0 +1,71 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+template<typename T>
+ctkEAMPSCQueue<T>::ctkEAMPSCQueue()
+  : head(0), tail(0)
+{
+  // Start with an empty node, tail always points to the node before the
+  // first element.
+  tail = new Node(0);
+  head.fetchAndStoreOrdered(tail);
+}
+
+template<typename T>
+ctkEAMPSCQueue<T>::~ctkEAMPSCQueue()
+{
+  while (tail)
+  {
+    Node* next = tail->next.fetchAndAddOrdered(0);
+    delete tail->value;
+    delete tail;
+    tail = next;
+  }
+}
+
+template<typename T>
+void ctkEAMPSCQueue<T>::push(const T& value)
+{
+  Node* node = new Node(new T(value));
+  Node* prev = head.fetchAndStoreOrdered(node);
+  // Between the two statements the node is already the head but not
+  // reachable from tail yet, see take()
+  prev->next.fetchAndStoreRelease(node);
+}
+
+template<typename T>
+T* ctkEAMPSCQueue<T>::take()
+{
+  Node* next = tail->next.fetchAndAddAcquire(0);
+  if (next == 0)
+  {
+    return 0;
+  }
+
+  T* value = next->value;
+  next->value = 0;
+
+  // next becomes the empty node in front of the queue
+  delete tail;
+  tail = next;
+  return value;
+}
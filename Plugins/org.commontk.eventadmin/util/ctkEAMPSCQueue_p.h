@@ -0,0 +1,84 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEAMPSCQUEUE_P_H
+#define CTKEAMPSCQUEUE_P_H
+
+#include <QAtomicPointer>
+
+/**
+ * An unbounded, lock-free queue for many producers and a single consumer.
+ * <tt>push()</tt> may be called from any thread, <tt>take()</tt> only from
+ * the consumer thread. Elements are popped in the order their
+ * <tt>push()</tt> calls took effect, hence the elements pushed by one thread
+ * keep their order.
+ *
+ * A <tt>take()</tt> concurrent to a <tt>push()</tt> may not see the element
+ * being pushed yet, even if the queue had elements pushed after it. The
+ * element is returned by a later <tt>take()</tt>, once its <tt>push()</tt>
+ * has returned.
+ */
+template<typename T>
+class ctkEAMPSCQueue
+{
+
+private:
+
+  struct Node
+  {
+    QAtomicPointer<Node> next;
+    T* value;
+
+    Node(T* value) : next(0), value(value) {}
+  };
+
+  // The most recently pushed node, swapped by the producers
+  QAtomicPointer<Node> head;
+
+  // The node before the next element to pop, only used by the consumer
+  Node* tail;
+
+  Q_DISABLE_COPY(ctkEAMPSCQueue)
+
+public:
+
+  ctkEAMPSCQueue();
+
+  ~ctkEAMPSCQueue();
+
+  /**
+   * Append a copy of value to the queue.
+   */
+  void push(const T& value);
+
+  /**
+   * Remove the first element of the queue.
+   *
+   * @return The element, to be deleted by the caller, or 0 if the queue
+   *         is empty
+   */
+  T* take();
+};
+
+#include "ctkEAMPSCQueue.tpp"
+
+#endif // CTKEAMPSCQUEUE_P_H
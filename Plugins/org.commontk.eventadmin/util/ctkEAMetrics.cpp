@@ -0,0 +1,323 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkEAMetrics_p.h"
+
+#include <ctkPlugin.h>
+#include <ctkEventAdminActivator_p.h>
+
+#include <QStringList>
+#include <QtAlgorithms>
+
+static QString formatLatency(qint64 latency)
+{
+  return QString::number(latency / 1000.0, 'f', 1) + " ms";
+}
+
+void ctkEAMetrics::Timer::start()
+{
+  timer.start();
+}
+
+qint64 ctkEAMetrics::Timer::elapsedMicroseconds() const
+{
+#if QT_VERSION >= 0x040800
+  return timer.nsecsElapsed() / 1000;
+#else
+  return static_cast<qint64>(timer.elapsed()) * 1000;
+#endif
+}
+
+ctkEAMetrics::HandlerMetrics::HandlerMetrics()
+  : deliveries(0), totalLatency(0), maxLatency(0), timeouts(0)
+{
+  for (int i = 0; i < BUCKETS; ++i)
+  {
+    histogram[i] = 0;
+  }
+}
+
+ctkEAMetrics::ctkEAMetrics()
+  : timeouts(0), blacklisted(0), queueDepth(0), queueMaxDepth(0), lastSummary(0)
+{
+  uptime.start();
+  connect(&summaryTimer, SIGNAL(timeout()), SLOT(logSummary()));
+}
+
+void ctkEAMetrics::setLogInterval(int interval)
+{
+  if (interval > 0)
+  {
+    summaryTimer.start(interval * 1000);
+  }
+  else
+  {
+    summaryTimer.stop();
+  }
+}
+
+void ctkEAMetrics::eventsPublished(const QString& topic, int count)
+{
+  QMutexLocker l(&mutex);
+  published[topic] += count;
+}
+
+void ctkEAMetrics::record(HandlerMetrics& metrics, qint64 latency)
+{
+  int bucket = 0;
+  for (qint64 bound = 100; bucket < BUCKETS - 1 && latency >= bound; bound *= 10)
+  {
+    ++bucket;
+  }
+
+  ++metrics.deliveries;
+  metrics.totalLatency += latency;
+  metrics.maxLatency = qMax(metrics.maxLatency, latency);
+  ++metrics.histogram[bucket];
+}
+
+QList<const ctkEAMetrics::HandlerMetrics*> ctkEAMetrics::allHandlers() const
+{
+  QList<const HandlerMetrics*> result;
+  QHash<ctkServiceReference, HandlerMetrics>::const_iterator handlerEnd = handlers.end();
+  for (QHash<ctkServiceReference, HandlerMetrics>::const_iterator it = handlers.begin();
+       it != handlerEnd; ++it)
+  {
+    result.push_back(&it.value());
+  }
+  QHash<qlonglong, HandlerMetrics>::const_iterator slotEnd = slotHandlers.end();
+  for (QHash<qlonglong, HandlerMetrics>::const_iterator it = slotHandlers.begin();
+       it != slotEnd; ++it)
+  {
+    result.push_back(&it.value());
+  }
+  return result;
+}
+
+void ctkEAMetrics::eventDelivered(const ctkServiceReference& ref, const QObject* handler, qint64 latency)
+{
+  QMutexLocker l(&mutex);
+  HandlerMetrics& metrics = handlers[ref];
+  if (metrics.deliveries == 0 && metrics.name.isEmpty())
+  {
+    metrics.name = handler ? handler->metaObject()->className() : "";
+    QSharedPointer<ctkPlugin> plugin = ref.getPlugin();
+    metrics.plugin = plugin ? plugin->getSymbolicName() : QString();
+  }
+  record(metrics, latency);
+}
+
+void ctkEAMetrics::slotEventDelivered(qlonglong id, const QString& name, qint64 latency)
+{
+  QMutexLocker l(&mutex);
+  HandlerMetrics& metrics = slotHandlers[id];
+  if (metrics.name.isEmpty())
+  {
+    metrics.name = name;
+    metrics.plugin = "slot";
+  }
+  record(metrics, latency);
+}
+
+void ctkEAMetrics::tasksQueued(int count)
+{
+  const int depth = queueDepth.fetchAndAddOrdered(count) + count;
+  while (true)
+  {
+    const int maxDepth = queueMaxDepth.fetchAndAddOrdered(0);
+    if (depth <= maxDepth || queueMaxDepth.testAndSetOrdered(maxDepth, depth))
+    {
+      break;
+    }
+  }
+}
+
+void ctkEAMetrics::tasksDelivered(int count)
+{
+  queueDepth.fetchAndAddOrdered(-count);
+}
+
+void ctkEAMetrics::handlerTimedOut(const ctkServiceReference& ref)
+{
+  QMutexLocker l(&mutex);
+  ++handlers[ref].timeouts;
+  ++timeouts;
+  ++blacklisted;
+}
+
+void ctkEAMetrics::slotTimedOut(qlonglong id)
+{
+  QMutexLocker l(&mutex);
+  ++slotHandlers[id].timeouts;
+  ++timeouts;
+  ++blacklisted;
+}
+
+void ctkEAMetrics::handlerBlacklisted(const ctkServiceReference& ref)
+{
+  Q_UNUSED(ref)
+  QMutexLocker l(&mutex);
+  ++blacklisted;
+}
+
+ctkDictionary ctkEAMetrics::getMetrics() const
+{
+  QMutexLocker l(&mutex);
+  ctkDictionary result;
+
+  const double seconds = uptime.elapsedMicroseconds() / 1000000.0;
+  result.insert("uptime", seconds);
+
+  QVariantMap topics;
+  QHash<QString, qint64>::const_iterator topicEnd = published.end();
+  for (QHash<QString, qint64>::const_iterator it = published.begin(); it != topicEnd; ++it)
+  {
+    QVariantMap topic;
+    topic.insert("count", it.value());
+    topic.insert("rate", seconds > 0 ? it.value() / seconds : 0.0);
+    topics.insert(it.key(), topic);
+  }
+  result.insert("topics", topics);
+
+  QVariantList handlerList;
+  foreach (const HandlerMetrics* handlerMetrics, allHandlers())
+  {
+    const HandlerMetrics& metrics = *handlerMetrics;
+    QVariantMap handler;
+    handler.insert("name", metrics.name);
+    handler.insert("plugin", metrics.plugin);
+    handler.insert("deliveries", metrics.deliveries);
+    handler.insert("meanLatency", metrics.deliveries ? metrics.totalLatency / metrics.deliveries : 0);
+    handler.insert("maxLatency", metrics.maxLatency);
+    handler.insert("timeouts", metrics.timeouts);
+    QVariantList histogram;
+    for (int i = 0; i < BUCKETS; ++i)
+    {
+      histogram.push_back(metrics.histogram[i]);
+    }
+    handler.insert("histogram", histogram);
+    handlerList.push_back(handler);
+  }
+  result.insert("handlers", handlerList);
+
+  result.insert("asyncQueueDepth", const_cast<QAtomicInt&>(queueDepth).fetchAndAddOrdered(0));
+  result.insert("asyncQueueMaxDepth", const_cast<QAtomicInt&>(queueMaxDepth).fetchAndAddOrdered(0));
+  result.insert("timeouts", timeouts);
+  result.insert("blacklisted", blacklisted);
+  return result;
+}
+
+bool ctkEAMetrics::slowerThan(const HandlerMetrics* h1, const HandlerMetrics* h2)
+{
+  return h1->maxLatency > h2->maxLatency;
+}
+
+QString ctkEAMetrics::getSlowHandlerReport(int maxHandlers) const
+{
+  QMutexLocker l(&mutex);
+
+  QList<const HandlerMetrics*> slowest;
+  foreach (const HandlerMetrics* metrics, allHandlers())
+  {
+    if (metrics->deliveries > 0)
+    {
+      slowest.push_back(metrics);
+    }
+  }
+  qSort(slowest.begin(), slowest.end(), slowerThan);
+
+  QStringList lines;
+  for (int i = 0; i < slowest.size() && i < maxHandlers; ++i)
+  {
+    const HandlerMetrics* metrics = slowest.at(i);
+    lines << QString("%1 [%2]: max %3, mean %4, %5 deliveries, %6 timeouts")
+             .arg(metrics->name).arg(metrics->plugin)
+             .arg(formatLatency(metrics->maxLatency))
+             .arg(formatLatency(metrics->totalLatency / metrics->deliveries))
+             .arg(metrics->deliveries).arg(metrics->timeouts);
+  }
+  return lines.join("\n");
+}
+
+void ctkEAMetrics::reset()
+{
+  QMutexLocker l(&mutex);
+  published.clear();
+  handlers.clear();
+  slotHandlers.clear();
+  timeouts = 0;
+  blacklisted = 0;
+  lastPublished.clear();
+  lastSummary = 0;
+  queueMaxDepth.fetchAndStoreOrdered(queueDepth.fetchAndAddOrdered(0));
+  uptime.start();
+}
+
+void ctkEAMetrics::logSummary()
+{
+  qint64 count = 0;
+  double seconds = 0;
+  QString busiestTopic;
+  qint64 busiestCount = 0;
+  int timeoutCount = 0;
+  int blacklistedCount = 0;
+  {
+    QMutexLocker l(&mutex);
+    const qint64 now = uptime.elapsedMicroseconds();
+    seconds = (now - lastSummary) / 1000000.0;
+    lastSummary = now;
+
+    QHash<QString, qint64>::const_iterator topicEnd = published.end();
+    for (QHash<QString, qint64>::const_iterator it = published.begin(); it != topicEnd; ++it)
+    {
+      const qint64 topicCount = it.value() - lastPublished.value(it.key());
+      count += topicCount;
+      if (topicCount > busiestCount)
+      {
+        busiestTopic = it.key();
+        busiestCount = topicCount;
+      }
+    }
+    lastPublished = published;
+    timeoutCount = timeouts;
+    blacklistedCount = blacklisted;
+  }
+
+  const double rate = seconds > 0 ? count / seconds : 0.0;
+  QString summary = QString("EventAdmin metrics: %1 events published (%2/s), async queue depth %3 (max %4), "
+                            "%5 timeouts, %6 blacklisted handlers")
+      .arg(count).arg(rate, 0, 'f', 1)
+      .arg(queueDepth.fetchAndAddOrdered(0)).arg(queueMaxDepth.fetchAndAddOrdered(0))
+      .arg(timeoutCount).arg(blacklistedCount);
+  if (busiestCount > 0)
+  {
+    summary += QString("\nBusiest topic: %1 (%2/s)").arg(busiestTopic)
+        .arg(busiestCount / seconds, 0, 'f', 1);
+  }
+  const QString report = getSlowHandlerReport(3);
+  if (!report.isEmpty())
+  {
+    summary += "\nSlowest handlers:\n" + report;
+  }
+
+  CTK_INFO(ctkEventAdminActivator::getLogService()) << summary;
+}
@@ -0,0 +1,190 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEAMETRICS_P_H
+#define CTKEAMETRICS_P_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+
+#if QT_VERSION >= 0x040700
+#include <QElapsedTimer>
+#else
+#include <QTime>
+#endif
+
+#include <ctkServiceReference.h>
+#include <service/event/ctkEventAdminMetrics.h>
+
+/**
+ * Collects the delivery metrics of the event admin and registers them as
+ * the <tt>ctkEventAdminMetrics</tt> service. The metrics are only collected
+ * if <tt>org.commontk.eventadmin.Metrics</tt> is set, the event admin
+ * classes get a null pointer otherwise.
+ *
+ * A summary of the metrics and the slowest handlers is logged at
+ * <tt>LOG_INFO</tt> level every <tt>setLogInterval()</tt> seconds.
+ */
+class ctkEAMetrics : public QObject, public ctkEventAdminMetrics
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkEventAdminMetrics)
+
+public:
+
+  /**
+   * Measures the delivery latencies in microseconds.
+   */
+  class Timer
+  {
+  public:
+    void start();
+    qint64 elapsedMicroseconds() const;
+  private:
+#if QT_VERSION >= 0x040700
+    QElapsedTimer timer;
+#else
+    QTime timer;
+#endif
+  };
+
+private:
+
+  // The histogram buckets, deliveries of less than 100us, 1ms, 10ms,
+  // 100ms, 1s and more
+  static const int BUCKETS = 6;
+
+  struct HandlerMetrics
+  {
+    QString name;
+    QString plugin;
+    qint64 deliveries;
+    qint64 totalLatency;
+    qint64 maxLatency;
+    qint64 histogram[BUCKETS];
+    int timeouts;
+
+    HandlerMetrics();
+  };
+
+  mutable QMutex mutex;
+
+  Timer uptime;
+
+  QHash<QString, qint64> published;
+  QHash<ctkServiceReference, HandlerMetrics> handlers;
+  // The subscribed slots, by subscription id
+  QHash<qlonglong, HandlerMetrics> slotHandlers;
+  int timeouts;
+  int blacklisted;
+
+  QAtomicInt queueDepth;
+  QAtomicInt queueMaxDepth;
+
+  // The number of events published per topic at the last summary
+  QHash<QString, qint64> lastPublished;
+  qint64 lastSummary;
+
+  QTimer summaryTimer;
+
+  static bool slowerThan(const HandlerMetrics* h1, const HandlerMetrics* h2);
+
+  static void record(HandlerMetrics& metrics, qint64 latency);
+
+  /**
+   * The metrics of the handlers and slots, must be called with the mutex held.
+   */
+  QList<const HandlerMetrics*> allHandlers() const;
+
+public:
+
+  ctkEAMetrics();
+
+  /**
+   * Log a summary every interval seconds, 0 disables the summary. Must be
+   * called from the thread of this object.
+   */
+  void setLogInterval(int interval);
+
+  /**
+   * Record count events published under topic.
+   */
+  void eventsPublished(const QString& topic, int count);
+
+  /**
+   * Record the delivery of an event to the handler of ref.
+   *
+   * @param ref The reference of the handler
+   * @param handler The handler, used to name it
+   * @param latency The time spent in the handler in microseconds
+   */
+  void eventDelivered(const ctkServiceReference& ref, const QObject* handler, qint64 latency);
+
+  /**
+   * Record the delivery of an event to a subscribed slot.
+   *
+   * @param id The subscription id of the slot
+   * @param name The name of the slot
+   * @param latency The time spent in the slot in microseconds
+   */
+  void slotEventDelivered(qlonglong id, const QString& name, qint64 latency);
+
+  /**
+   * Record count handler tasks queued for asynchronous delivery.
+   */
+  void tasksQueued(int count);
+
+  /**
+   * Record count asynchronous handler tasks delivered.
+   */
+  void tasksDelivered(int count);
+
+  /**
+   * Record a handler blacklisted due to a timeout.
+   */
+  void handlerTimedOut(const ctkServiceReference& ref);
+
+  /**
+   * Record a subscribed slot blacklisted due to a timeout.
+   */
+  void slotTimedOut(qlonglong id);
+
+  /**
+   * Record a handler blacklisted due to an invalid filter.
+   */
+  void handlerBlacklisted(const ctkServiceReference& ref);
+
+  ctkDictionary getMetrics() const;
+
+  QString getSlowHandlerReport(int maxHandlers = 10) const;
+
+  void reset();
+
+protected Q_SLOTS:
+
+  void logSummary();
+};
+
+#endif // CTKEAMETRICS_P_H
@@ -0,0 +1,429 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkEventBusBenchmark_p.h"
+
+#include <ctkCommandLineParser.h>
+
+#include <ctkBusEvent.h>
+#include <ctkEventBusImpl_p.h>
+#include <ctkEventBusManager.h>
+#include <ctkNetworkConnectorQXMLRPC.h>
+#include <ctkNetworkConnectorSharedMemory.h>
+#include <ctkNetworkConnectorTcp.h>
+#include <ctkNetworkConnectorZeroMQ.h>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace ctkEventBus;
+
+namespace {
+
+const char *LOCAL_TOPIC = "ctk/local/benchmark/event";
+const char *POSTED_TOPIC = "ctk/local/benchmark/posted";
+
+/// Result of a case of the benchmark for a payload size.
+struct ctkEventBusBenchmarkResult {
+    QString name;
+    int payload;
+    int events;
+    int received;
+    double seconds;
+    QVector<qint64> latencies; ///< sorted, in nanoseconds
+    QString error;
+};
+
+/**
+ Class name: ctkEventBusBenchmarkCase
+ Path of the events measured by the benchmark.
+ */
+class ctkEventBusBenchmarkCase {
+public:
+    ctkEventBusBenchmarkCase(const QString &name) : m_Name(name) {}
+    virtual ~ctkEventBusBenchmarkCase() {}
+
+    QString name() const {return m_Name;}
+
+    /// Prepare the path, return an error message if it is not available.
+    virtual QString setUp() {return QString();}
+
+    /// Send the event with the given sequence number.
+    virtual void send(int sequence, const QByteArray &payload) = 0;
+
+private:
+    QString m_Name;
+};
+
+/// events notified synchronously to the local dispatcher.
+class ctkEventBusLocalCase : public ctkEventBusBenchmarkCase {
+public:
+    ctkEventBusLocalCase() : ctkEventBusBenchmarkCase("local") {}
+
+    void send(int sequence, const QByteArray &payload) {
+        QVariantList data;
+        data << sequence << payload;
+        ctkEventArgumentsList args;
+        args.append(ctkEventArgument(QVariantList, data));
+        ctkEventBusManager::instance()->notifyEvent(LOCAL_TOPIC, ctkEventTypeLocal, &args);
+    }
+};
+
+/// events posted to the bus and delivered by its dispatch thread.
+class ctkEventBusPostCase : public ctkEventBusBenchmarkCase {
+public:
+    ctkEventBusPostCase() : ctkEventBusBenchmarkCase("post"), m_Bus(1, true) {}
+
+    void send(int sequence, const QByteArray &payload) {
+        QVariantList data;
+        data << sequence << payload;
+        ctkDictionary properties;
+        properties.insert(TYPE, ctkEventTypeLocal);
+        properties.insert("localEvent", QVariantList());
+        properties.insert("localData", data);
+        m_Bus.postEvent(ctkEvent(POSTED_TOPIC, properties));
+    }
+
+private:
+    ctkEventBusImpl m_Bus;
+};
+
+/// events sent by the client of a connector to its own server.
+class ctkEventBusConnectorCase : public ctkEventBusBenchmarkCase {
+public:
+    ctkEventBusConnectorCase(ctkNetworkConnector *connector, unsigned int port, const QString &method)
+        : ctkEventBusBenchmarkCase(connector->protocol()), m_Connector(connector), m_Port(port), m_Method(method) {}
+
+    ~ctkEventBusConnectorCase() {
+        delete m_Connector;
+    }
+
+    QString setUp() {
+        m_Connector->createServer(m_Port);
+        m_Connector->startListen();
+        m_Connector->createClient("localhost", m_Port);
+        return QString();
+    }
+
+    void send(int sequence, const QByteArray &payload) {
+        QVariantList eventParameters;
+        eventParameters << LOCAL_TOPIC << ctkEventTypeLocal << ctkSignatureTypeCallback << "receive(QVariantList)";
+        QVariantList data;
+        data << sequence << payload;
+
+        ctkEventArgumentsList listToSend;
+        listToSend.append(ctkEventArgument(QVariantList, eventParameters));
+        listToSend.append(ctkEventArgument(QVariantList, data));
+        m_Connector->send(m_Method, &listToSend);
+    }
+
+private:
+    ctkNetworkConnector *m_Connector;
+    unsigned int m_Port;
+    QString m_Method;
+};
+
+/// process the events until count events have been received, return false after timeout ms.
+bool waitForEvents(ctkEventBusBenchmarkReceiver *receiver, int count, int timeout) {
+    QElapsedTimer clock;
+    clock.start();
+    while(receiver->received() < count) {
+        if(clock.elapsed() > timeout) {
+            return false;
+        }
+        QCoreApplication::processEvents();
+    }
+    return true;
+}
+
+/// register a signal or a callback of the receiver.
+bool registerEvent(const QString &topic, ctkSignatureType type, QObject *object, const QString &signature) {
+    ctkBusEvent *properties = new ctkBusEvent(topic, ctkEventTypeLocal, type, object, signature);
+    if(!ctkEventBusManager::instance()->addEventProperty(*properties)) {
+        delete properties;
+        return false;
+    }
+    return true;
+}
+
+/// send count events of the given size, keeping at most window events in flight.
+ctkEventBusBenchmarkResult runCase(ctkEventBusBenchmarkCase *benchmarkCase, ctkEventBusBenchmarkReceiver *receiver,
+                                   int payloadSize, int count, int window, int timeout) {
+    ctkEventBusBenchmarkResult result;
+    result.name = benchmarkCase->name();
+    result.payload = payloadSize;
+    result.events = count;
+    result.received = 0;
+    result.seconds = 0;
+
+    QByteArray payload(payloadSize, 'x');
+    int total = count + 1;
+    receiver->reset(total);
+
+    // warm up, the first event also checks that the path works and is not measured
+    receiver->sent(0);
+    benchmarkCase->send(0, payload);
+    if(!waitForEvents(receiver, 1, timeout)) {
+        result.error = "no event received";
+        return result;
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    QElapsedTimer idle;
+    idle.start();
+    int sent = 1;
+    int received = receiver->received();
+    while(receiver->received() < total) {
+        if(sent < total && sent - receiver->received() < window) {
+            receiver->sent(sent);
+            benchmarkCase->send(sent, payload);
+            ++sent;
+            continue;
+        }
+        QCoreApplication::processEvents();
+        if(receiver->received() != received) {
+            received = receiver->received();
+            idle.restart();
+        } else if(idle.elapsed() > timeout) {
+            result.error = "timeout";
+            break;
+        }
+    }
+    result.seconds = clock.nsecsElapsed() / 1e9;
+
+    result.latencies = receiver->latencies();
+    result.latencies.remove(0);
+    result.received = result.latencies.size();
+    std::sort(result.latencies.begin(), result.latencies.end());
+    return result;
+}
+
+/// nearest rank percentile of the sorted latencies, in microseconds.
+double percentile(const QVector<qint64> &latencies, double p) {
+    if(latencies.isEmpty()) {
+        return 0;
+    }
+    int rank = qBound(0, int(p * latencies.size() + 0.999999) - 1, latencies.size() - 1);
+    return latencies.at(rank) / 1000.0;
+}
+
+QString jsonEscape(const QString &str) {
+    QString res(str);
+    res.replace('\\', "\\\\");
+    res.replace('"', "\\\"");
+    return res;
+}
+
+void writeJson(QTextStream &out, const QList<ctkEventBusBenchmarkResult> &results, int window) {
+    out << "{\"benchmark\":\"ctkEventBus\",\"window\":" << window << ",\"results\":[\n";
+    for(int i = 0; i < results.size(); ++i) {
+        const ctkEventBusBenchmarkResult &r = results.at(i);
+        double rate = r.seconds > 0 ? r.received / r.seconds : 0;
+        out << "{\"case\":\"" << jsonEscape(r.name) << "\",\"payload\":" << r.payload
+            << ",\"events\":" << r.events << ",\"received\":" << r.received
+            << ",\"seconds\":" << r.seconds << ",\"eventsPerSecond\":" << rate
+            << ",\"latencyUs\":{\"p50\":" << percentile(r.latencies, 0.5)
+            << ",\"p99\":" << percentile(r.latencies, 0.99)
+            << ",\"max\":" << percentile(r.latencies, 1.0) << "}"
+            << ",\"error\":\"" << jsonEscape(r.error) << "\"}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+}
+
+}
+
+//----------------------------------------------------------------------------
+ctkEventBusBenchmarkReceiver::ctkEventBusBenchmarkReceiver() {
+    m_Timer.start();
+}
+
+void ctkEventBusBenchmarkReceiver::reset(int count) {
+    m_SendTimes.fill(-1, count);
+    m_Latencies.clear();
+    m_Latencies.reserve(count);
+}
+
+void ctkEventBusBenchmarkReceiver::sent(int sequence) {
+    m_SendTimes[sequence] = m_Timer.nsecsElapsed();
+}
+
+int ctkEventBusBenchmarkReceiver::received() const {
+    return m_Latencies.size();
+}
+
+QVector<qint64> ctkEventBusBenchmarkReceiver::latencies() const {
+    return m_Latencies;
+}
+
+void ctkEventBusBenchmarkReceiver::receive(QVariantList data) {
+    int sequence = data.value(0, -1).toInt();
+    if(sequence < 0 || sequence >= m_SendTimes.size() || m_SendTimes.at(sequence) < 0) {
+        return;
+    }
+    m_Latencies.append(m_Timer.nsecsElapsed() - m_SendTimes.at(sequence));
+    // an event received twice is only measured once
+    m_SendTimes[sequence] = -1;
+}
+
+void ctkEventBusBenchmarkReceiver::receivePosted(QVariantList event, QVariantList data) {
+    Q_UNUSED(event);
+    receive(data);
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    app.setOrganizationName("CTK");
+    app.setOrganizationDomain("commontk.org");
+    app.setApplicationName("ctkEventBusBenchmark");
+
+    ctkCommandLineParser parser;
+    parser.setArgumentPrefix("--", "-");
+    parser.addArgument("cases", "c", QVariant::String,
+                       "Comma separated list of the paths to measure: local, post and the protocols of the connectors",
+                       "local,post,XMLRPC,SOAP,ZEROMQ,TCP,SHAREDMEMORY");
+    parser.addArgument("sizes", "s", QVariant::String,
+                       "Comma separated list of the payload sizes, in bytes", "16,1024,65536,1048576");
+    parser.addArgument("events", "e", QVariant::Int, "Number of events of each case and size", 1000);
+    parser.addArgument("max-volume", "m", QVariant::Int,
+                       "Maximum volume sent by each case and size in MB, the number of events is reduced for the large payloads", 64);
+    parser.addArgument("window", "w", QVariant::Int,
+                       "Number of events in flight, 1 measures the latency of each event alone", 1);
+    parser.addArgument("timeout", "t", QVariant::Int, "Time to wait for the next event, in ms", 5000);
+    parser.addArgument("output", "o", QVariant::String, "Write the JSON report to this file instead of the standard output");
+    parser.addArgument("help", "h", QVariant::Bool, "Show this help text");
+
+    bool ok = false;
+    QHash<QString, QVariant> parsedArgs = parser.parseArguments(QCoreApplication::arguments(), &ok);
+    if(!ok) {
+        QTextStream(stderr, QIODevice::WriteOnly) << "Error parsing arguments: " << parser.errorString() << "\n";
+        return EXIT_FAILURE;
+    }
+    if(parsedArgs.contains("help")) {
+        QTextStream(stdout, QIODevice::WriteOnly) << parser.helpText();
+        return EXIT_SUCCESS;
+    }
+
+    const QStringList cases = parsedArgs.value("cases").toString().split(',', QString::SkipEmptyParts);
+    QList<int> sizes;
+    foreach(QString size, parsedArgs.value("sizes").toString().split(',', QString::SkipEmptyParts)) {
+        sizes.append(qMax(0, size.trimmed().toInt()));
+    }
+    const int nEvents = qMax(1, parsedArgs.value("events").toInt());
+    const qint64 maxVolume = qint64(qMax(1, parsedArgs.value("max-volume").toInt())) * 1024 * 1024;
+    const int window = qMax(1, parsedArgs.value("window").toInt());
+    const int timeout = qMax(1, parsedArgs.value("timeout").toInt());
+
+    ctkEventBusManager *eventBus = ctkEventBusManager::instance();
+    ctkEventBusBenchmarkReceiver receiver;
+    if(!registerEvent(LOCAL_TOPIC, ctkSignatureTypeSignal, &receiver, "localEvent(QVariantList)") ||
+       !registerEvent(LOCAL_TOPIC, ctkSignatureTypeCallback, &receiver, "receive(QVariantList)") ||
+       !registerEvent(POSTED_TOPIC, ctkSignatureTypeSignal, &receiver, "postedEvent(QVariantList,QVariantList)") ||
+       !registerEvent(POSTED_TOPIC, ctkSignatureTypeCallback, &receiver, "receivePosted(QVariantList,QVariantList)")) {
+        qCritical() << "Registering the events of the benchmark failed";
+        return EXIT_FAILURE;
+    }
+
+    QList<ctkEventBusBenchmarkResult> results;
+    bool failed = false;
+    foreach(QString caseName, cases) {
+        caseName = caseName.trimmed();
+        ctkEventBusBenchmarkCase *benchmarkCase = NULL;
+        QString error;
+        if(caseName == "local") {
+            benchmarkCase = new ctkEventBusLocalCase();
+        } else if(caseName == "post") {
+            benchmarkCase = new ctkEventBusPostCase();
+        } else if(caseName == "XMLRPC") {
+            benchmarkCase = new ctkEventBusConnectorCase(new ctkNetworkConnectorQXMLRPC(), 8100, "ctk/remote/eventBus/comunication/send/xmlrpc");
+        } else if(caseName == "ZEROMQ") {
+            benchmarkCase = new ctkEventBusConnectorCase(new ctkNetworkConnectorZeroMQ(), 8102, "ctk/remote/eventBus/comunication/send/zeromq");
+        } else if(caseName == "TCP") {
+            benchmarkCase = new ctkEventBusConnectorCase(new ctkNetworkConnectorTcp(), 8103, "ctk/remote/eventBus/comunication/send/tcp");
+        } else if(caseName == "SHAREDMEMORY") {
+            benchmarkCase = new ctkEventBusConnectorCase(new ctkNetworkConnectorSharedMemory(), 8104, "ctk/remote/eventBus/comunication/send/sharedmemory");
+        } else if(caseName == "SOAP") {
+            // the connector is a client of external web services only
+            error = "QtSoap has no server side";
+        } else {
+            error = "unknown case";
+        }
+
+        if(benchmarkCase) {
+            error = benchmarkCase->setUp();
+        }
+        foreach(int size, sizes) {
+            if(!error.isEmpty()) {
+                ctkEventBusBenchmarkResult result;
+                result.name = caseName;
+                result.payload = size;
+                result.events = 0;
+                result.received = 0;
+                result.seconds = 0;
+                result.error = error;
+                results.append(result);
+                continue;
+            }
+            int count = int(qMin(qint64(nEvents), qMax(qint64(10), maxVolume / qMax(1, size))));
+            ctkEventBusBenchmarkResult result = runCase(benchmarkCase, &receiver, size, count, window, timeout);
+            failed = failed || !result.error.isEmpty();
+            results.append(result);
+        }
+        delete benchmarkCase;
+    }
+
+    QString output = parsedArgs.value("output").toString();
+    if(output.isEmpty()) {
+        QTextStream out(stdout, QIODevice::WriteOnly);
+        writeJson(out, results, window);
+    } else {
+        QFile file(output);
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            qCritical() << "Writing the report to" << output << "failed";
+            return EXIT_FAILURE;
+        }
+        QTextStream out(&file);
+        writeJson(out, results, window);
+
+        QTextStream summary(stdout, QIODevice::WriteOnly);
+        foreach(const ctkEventBusBenchmarkResult &r, results) {
+            summary << r.name << " " << r.payload << " bytes: ";
+            if(!r.error.isEmpty()) {
+                summary << r.error << "\n";
+                continue;
+            }
+            summary << (r.seconds > 0 ? r.received / r.seconds : 0) << " events/s, p50 "
+                    << percentile(r.latencies, 0.5) << " us, p99 " << percentile(r.latencies, 0.99) << " us\n";
+        }
+    }
+
+    eventBus->shutdown();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKEVENTBUSBENCHMARK_P_H
+#define CTKEVENTBUSBENCHMARK_P_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVariantList>
+#include <QVector>
+
+/**
+ Class name: ctkEventBusBenchmarkReceiver
+ Emits and receives the events of the benchmark. The events carry their sequence number
+ as first data parameter, the latency of an event is measured from the time it was sent
+ to the time its callback has been called.
+ */
+class ctkEventBusBenchmarkReceiver : public QObject {
+    Q_OBJECT
+
+public:
+    /// object constructor.
+    ctkEventBusBenchmarkReceiver();
+
+    /// Prepare the reception of count events.
+    void reset(int count);
+
+    /// Remember the time the event with the given sequence number is sent.
+    void sent(int sequence);
+
+    /// Number of events received since the last reset().
+    int received() const;
+
+    /// Latencies of the received events, in nanoseconds.
+    QVector<qint64> latencies() const;
+
+Q_SIGNALS:
+    /// Signal registered for the local and remote events.
+    void localEvent(QVariantList data);
+
+    /// Signal registered for the events posted to ctkEventBusImpl.
+    void postedEvent(QVariantList event, QVariantList data);
+
+public Q_SLOTS:
+    /// Callback of the local and remote events.
+    void receive(QVariantList data);
+
+    /// Callback of the events posted to ctkEventBusImpl.
+    void receivePosted(QVariantList event, QVariantList data);
+
+private:
+    QElapsedTimer m_Timer; ///< Clock of the send and receive times.
+    QVector<qint64> m_SendTimes; ///< Send time of each event.
+    QVector<qint64> m_Latencies; ///< Latency of each event received.
+};
+
+#endif // CTKEVENTBUSBENCHMARK_P_H
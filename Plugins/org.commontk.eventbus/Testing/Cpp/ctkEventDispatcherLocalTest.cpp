@@ -58,6 +58,9 @@ public Q_SLOTS:
     int setObjectValue9WithReturnValue(int v1, int v2, int v3, int v4, int v5, int v6, int v7, int v8, int v9){return v1 + v2 + v3 + v4 +v5 + v6 + v7 + v8 + v9;};
     int setObjectValue10WithReturnValue(int v1, int v2, int v3, int v4, int v5, int v6, int v7, int v8, int v9, int v10){return v1 + v2 + v3 + v4 +v5 + v6 + v7 + v8 + v9 + v10;};
 
+    /// Test slot counting the delivered events.
+    void incrementVar(){m_Var++;};
+
 Q_SIGNALS:
     void signalSetObjectValue0();
     void signalSetObjectValue1(int v1);
@@ -83,6 +86,8 @@ Q_SIGNALS:
     int signalSetObjectValue9WithReturnValue(int v1, int v2, int v3, int v4, int v5, int v6, int v7, int v8, int v9);
     int signalSetObjectValue10WithReturnValue(int v1, int v2, int v3, int v4, int v5, int v6, int v7, int v8, int v9, int v10);
 
+    void signalIncrementVar();
+
 private:
     int m_Var; ///< Test var.
 };
@@ -132,6 +137,9 @@ private Q_SLOTS:
     /// notify event test which cover all the possibilities in terms of arguments with returned value
     void notifyEventWitReturnValueTest();
 
+    /// notify event test of a topic whose events are coalesced.
+    void notifyEventCoalescedTest();
+
 private:
     testObjectCustomForDispatcherLocal *m_ObjTest; ///< Test Object var
     ctkEventDispatcherLocal *m_EventDispatcherLocal; ///< Test var.
@@ -419,5 +427,41 @@ void ctkEventDispatcherLocalTest::notifyEventWitReturnValueTest() {
     delete propCallback10;
 }
 
+void ctkEventDispatcherLocalTest::notifyEventCoalescedTest() {
+    QString topic = "ctk/local/incrementVar";
+    ctkTopicQoS qos;
+    qos.coalesce = true;
+    m_EventDispatcherLocal->setTopicQoS(topic, qos);
+    QVERIFY(m_EventDispatcherLocal->topicQoS(topic).isQueued());
+
+    ctkBusEvent *propSignal = new ctkBusEvent(topic, ctkEventTypeLocal, ctkSignatureTypeSignal, m_ObjTest, "signalIncrementVar()");
+    m_EventDispatcherLocal->registerSignal(*propSignal);
+    ctkBusEvent *propCallback = new ctkBusEvent(topic, ctkEventTypeLocal, ctkSignatureTypeCallback, m_ObjTest, "incrementVar()");
+    m_EventDispatcherLocal->addObserver(*propCallback);
+
+    int var = m_ObjTest->var();
+    ctkBusEvent *notEvent = new ctkBusEvent(topic, ctkDictionary());
+    m_EventDispatcherLocal->notifyEvent(*notEvent);
+    m_EventDispatcherLocal->notifyEvent(*notEvent);
+    m_EventDispatcherLocal->notifyEvent(*notEvent);
+    // the events are queued until the delivery
+    QCOMPARE(m_ObjTest->var(), var);
+
+    m_EventDispatcherLocal->flushQueuedEvents();
+    QCOMPARE(m_ObjTest->var(), var + 1);
+
+    // nothing is left to deliver
+    m_EventDispatcherLocal->flushQueuedEvents();
+    QCOMPARE(m_ObjTest->var(), var + 1);
+
+    m_EventDispatcherLocal->setTopicQoS(topic, ctkTopicQoS());
+    m_EventDispatcherLocal->notifyEvent(*notEvent);
+    QCOMPARE(m_ObjTest->var(), var + 2);
+
+    delete notEvent;
+    delete propSignal;
+    delete propCallback;
+}
+
 CTK_REGISTER_TEST(ctkEventDispatcherLocalTest);
 #include "ctkEventDispatcherLocalTest.moc"
@@ -0,0 +1,129 @@
+/*
+ *  ctkNetworkConnectorSharedMemoryTest.cpp
+ *  ctkNetworkConnectorSharedMemoryTest
+ *
+ *  See Licence at: http://tiny.cc/QXJ4D
+ *
+ */
+
+#include "ctkTestSuite.h"
+#include <ctkNetworkConnectorSharedMemory.h>
+#include <ctkEventBusManager.h>
+
+#include <QApplication>
+
+using namespace ctkEventBus;
+
+//-------------------------------------------------------------------------
+/**
+ Class name: testObjectCustomForNetworkConnectorTcp
+ Custom object needed for testing.
+ */
+class testObjectCustomForNetworkConnectorTcp : public QObject {
+    Q_OBJECT
+
+public:
+    /// constructor.
+    testObjectCustomForNetworkConnectorTcp() : m_Var(0) {}
+
+    /// Return tha var's value.
+    int var() {return m_Var;}
+
+public Q_SLOTS:
+    /// Test slot that will increment the value of m_Var when an event is raised.
+    void updateObject() {m_Var++;}
+
+private:
+    int m_Var; ///< Test var.
+};
+
+
+/**
+ Class name: ctkNetworkConnectorSharedMemoryTest
+ This class implements the test suite for ctkNetworkConnectorSharedMemory.
+ */
+
+//! <title>
+//ctkNetworkConnectorSharedMemory
+//! </title>
+//! <description>
+//ctkNetworkConnectorSharedMemory exchanges binary messages with the peers of the same host through shared memory.
+//! </description>
+
+class ctkNetworkConnectorSharedMemoryTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    /// Initialize test variables
+    void initTestCase() {
+        m_EventBus = ctkEventBusManager::instance();
+        m_NetWorkConnectorSharedMemory = new ctkEventBus::ctkNetworkConnectorSharedMemory();
+        m_ObjectTest = new testObjectCustomForNetworkConnectorTcp();
+    }
+
+    /// Cleanup tes variables memory allocation.
+    void cleanupTestCase() {
+        if(m_ObjectTest) {
+            delete m_ObjectTest;
+            m_ObjectTest = NULL;
+        }
+        delete m_NetWorkConnectorSharedMemory;
+        m_EventBus->shutdown();
+    }
+
+    /// Check the default values of the connector.
+    void ctkNetworkConnectorSharedMemoryConstructorTest();
+
+    /// Check that the events written into the ring buffer are notified on the server.
+    void ctkNetworkConnectorSharedMemoryCommunictionTest();
+
+private:
+    ctkEventBusManager *m_EventBus; ///< event bus instance
+    ctkNetworkConnectorSharedMemory *m_NetWorkConnectorSharedMemory; ///< EventBus test variable instance.
+    testObjectCustomForNetworkConnectorTcp *m_ObjectTest;
+};
+
+void ctkNetworkConnectorSharedMemoryTest::ctkNetworkConnectorSharedMemoryConstructorTest() {
+    QVERIFY(m_NetWorkConnectorSharedMemory != NULL);
+    QCOMPARE(m_NetWorkConnectorSharedMemory->protocol(), QString("SHAREDMEMORY"));
+    QCOMPARE(m_NetWorkConnectorSharedMemory->bufferSize(), 4 * 1024 * 1024);
+
+    // rounded up to a power of two
+    m_NetWorkConnectorSharedMemory->setBufferSize(3000);
+    QCOMPARE(m_NetWorkConnectorSharedMemory->bufferSize(), 4096);
+}
+
+void ctkNetworkConnectorSharedMemoryTest::ctkNetworkConnectorSharedMemoryCommunictionTest() {
+    m_NetWorkConnectorSharedMemory->createServer(8030);
+    m_NetWorkConnectorSharedMemory->startListen();
+
+    // Register callback (done by the remote object).
+    ctkRegisterLocalCallback("ctk/local/eventBus/globalUpdate", m_ObjectTest, "updateObject()");
+
+    m_NetWorkConnectorSharedMemory->createClient("localhost", 8030);
+
+    QVariantList eventParameters;
+    eventParameters.append("ctk/local/eventBus/globalUpdate");
+    eventParameters.append(ctkEventTypeLocal);
+    eventParameters.append(ctkSignatureTypeCallback);
+    eventParameters.append("updateObject()");
+
+    QVariantList dataParameters;
+
+    ctkEventArgumentsList listToSend;
+    listToSend.append(ctkEventArgument(QVariantList, eventParameters));
+    listToSend.append(ctkEventArgument(QVariantList, dataParameters));
+
+    for(int i = 0; i < 5; ++i) {
+        m_NetWorkConnectorSharedMemory->send("ctk/remote/eventBus/comunication/send/sharedmemory", &listToSend);
+    }
+
+    QTime dieTime = QTime::currentTime().addSecs(3);
+    while(QTime::currentTime() < dieTime && m_ObjectTest->var() < 5) {
+       QCoreApplication::processEvents(QEventLoop::AllEvents, 3);
+    }
+    QCOMPARE(m_ObjectTest->var(), 5);
+}
+
+CTK_REGISTER_TEST(ctkNetworkConnectorSharedMemoryTest);
+#include "ctkNetworkConnectorSharedMemoryTest.moc"
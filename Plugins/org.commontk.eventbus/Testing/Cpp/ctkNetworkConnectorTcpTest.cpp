@@ -0,0 +1,135 @@
+/*
+ *  ctkNetworkConnectorTcpTest.cpp
+ *  ctkNetworkConnectorTcpTest
+ *
+ *  See Licence at: http://tiny.cc/QXJ4D
+ *
+ */
+
+#include "ctkTestSuite.h"
+#include <ctkNetworkConnectorTcp.h>
+#include <ctkEventBusManager.h>
+
+#include <QApplication>
+
+using namespace ctkEventBus;
+
+//-------------------------------------------------------------------------
+/**
+ Class name: testObjectCustomForNetworkConnectorTcp
+ Custom object needed for testing.
+ */
+class testObjectCustomForNetworkConnectorTcp : public QObject {
+    Q_OBJECT
+
+public:
+    /// constructor.
+    testObjectCustomForNetworkConnectorTcp() : m_Var(0) {}
+
+    /// Return tha var's value.
+    int var() {return m_Var;}
+
+public Q_SLOTS:
+    /// Test slot that will increment the value of m_Var when an event is raised.
+    void updateObject() {m_Var++;}
+
+private:
+    int m_Var; ///< Test var.
+};
+
+
+/**
+ Class name: ctkNetworkConnectorTcpTest
+ This class implements the test suite for ctkNetworkConnectorTcp.
+ */
+
+//! <title>
+//ctkNetworkConnectorTcp
+//! </title>
+//! <description>
+//ctkNetworkConnectorTcp sends pipelined binary messages over TCP.
+//! </description>
+
+class ctkNetworkConnectorTcpTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    /// Initialize test variables
+    void initTestCase() {
+        m_EventBus = ctkEventBusManager::instance();
+        m_NetWorkConnectorTcp = new ctkEventBus::ctkNetworkConnectorTcp();
+        m_ObjectTest = new testObjectCustomForNetworkConnectorTcp();
+    }
+
+    /// Cleanup tes variables memory allocation.
+    void cleanupTestCase() {
+        if(m_ObjectTest) {
+            delete m_ObjectTest;
+            m_ObjectTest = NULL;
+        }
+        delete m_NetWorkConnectorTcp;
+        m_EventBus->shutdown();
+    }
+
+    /// Check the default values of the connector.
+    void ctkNetworkConnectorTcpConstructorTest();
+
+    /// Check that several requests are sent without waiting for the replies.
+    void ctkNetworkConnectorTcpCommunictionTest();
+
+private:
+    ctkEventBusManager *m_EventBus; ///< event bus instance
+    ctkNetworkConnectorTcp *m_NetWorkConnectorTcp; ///< EventBus test variable instance.
+    testObjectCustomForNetworkConnectorTcp *m_ObjectTest;
+};
+
+void ctkNetworkConnectorTcpTest::ctkNetworkConnectorTcpConstructorTest() {
+    QVERIFY(m_NetWorkConnectorTcp != NULL);
+    QCOMPARE(m_NetWorkConnectorTcp->protocol(), QString("TCP"));
+    QVERIFY(m_NetWorkConnectorTcp->coalescing());
+    QCOMPARE(m_NetWorkConnectorTcp->maximumPendingRequests(), 32);
+    QCOMPARE(m_NetWorkConnectorTcp->pendingRequests(), 0);
+}
+
+void ctkNetworkConnectorTcpTest::ctkNetworkConnectorTcpCommunictionTest() {
+    m_NetWorkConnectorTcp->createServer(8020);
+    m_NetWorkConnectorTcp->startListen();
+
+    // Register callback (done by the remote object).
+    ctkRegisterLocalCallback("ctk/local/eventBus/globalUpdate", m_ObjectTest, "updateObject()");
+
+    // two requests in flight at most
+    m_NetWorkConnectorTcp->setMaximumPendingRequests(2);
+    m_NetWorkConnectorTcp->createClient("localhost", 8020);
+
+    QVariantList eventParameters;
+    eventParameters.append("ctk/local/eventBus/globalUpdate");
+    eventParameters.append(ctkEventTypeLocal);
+    eventParameters.append(ctkSignatureTypeCallback);
+    eventParameters.append("updateObject()");
+
+    QVariantList dataParameters;
+
+    ctkEventArgumentsList listToSend;
+    listToSend.append(ctkEventArgument(QVariantList, eventParameters));
+    listToSend.append(ctkEventArgument(QVariantList, dataParameters));
+
+    for(int i = 0; i < 5; ++i) {
+        m_NetWorkConnectorTcp->send("ctk/remote/eventBus/comunication/send/tcp", &listToSend);
+    }
+
+    QTime dieTime = QTime::currentTime().addSecs(3);
+    while(QTime::currentTime() < dieTime && m_ObjectTest->var() < 5) {
+       QCoreApplication::processEvents(QEventLoop::AllEvents, 3);
+    }
+    QCOMPARE(m_ObjectTest->var(), 5);
+
+    dieTime = QTime::currentTime().addSecs(3);
+    while(QTime::currentTime() < dieTime && m_NetWorkConnectorTcp->pendingRequests() != 0) {
+       QCoreApplication::processEvents(QEventLoop::AllEvents, 3);
+    }
+    QCOMPARE(m_NetWorkConnectorTcp->pendingRequests(), 0);
+}
+
+CTK_REGISTER_TEST(ctkNetworkConnectorTcpTest);
+#include "ctkNetworkConnectorTcpTest.moc"
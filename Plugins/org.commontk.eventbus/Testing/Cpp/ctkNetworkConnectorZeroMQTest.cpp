@@ -94,9 +94,12 @@ private Q_SLOTS:
     /// Check the existence of the ctkNetworkConnectorZeroMQe singletone creation.
     void ctkNetworkConnectorZeroMQConstructorTest();
 
-    /// Check the existence of the ctkNetworkConnectorZeroMQe singletone creation.
+    /// Check the request/reply communication between a client and a server.
     void ctkNetworkConnectorZeroMQCommunictionTest();
 
+    /// Check the publish/subscribe communication and the topic filtering of the server.
+    void ctkNetworkConnectorZeroMQPublishSubscribeTest();
+
 private:
     ctkEventBusManager *m_EventBus; ///< event bus instance
     ctkNetworkConnectorZeroMQ *m_NetWorkConnectorZeroMQ; ///< EventBus test variable instance.
@@ -108,13 +111,71 @@ void ctkNetworkConnectorZeroMQTest::ctkNetworkConnectorZeroMQConstructorTest() {
 }
 
 
-void ctkNetworkConnectorZeroMQTest::ctkNetworkConnectorZeroMQCommunictionTest() {
+/// send an event to the given topic and process the events until the object has been updated.
+static void sendAndWait(ctkNetworkConnectorZeroMQ *client, const QString &topic, testObjectCustomForNetworkConnectorZeroMQ *object) {
+    QVariantList eventParameters;
+    eventParameters.append(topic);
+    eventParameters.append(ctkEventTypeLocal);
+    eventParameters.append(ctkSignatureTypeCallback);
+    eventParameters.append("updateObject()");
+
+    QVariantList dataParameters;
+
+    ctkEventArgumentsList listToSend;
+    listToSend.append(ctkEventArgument(QVariantList, eventParameters));
+    listToSend.append(ctkEventArgument(QVariantList, dataParameters));
+
+    int var = object->var();
     QTime dieTime = QTime::currentTime().addSecs(3);
-    while(QTime::currentTime() < dieTime) {
-       QCoreApplication::processEvents(QEventLoop::AllEvents, 3);
+    while(QTime::currentTime() < dieTime && object->var() == var) {
+        // 0MQ drops the messages published before the connection is established
+        client->send("ctk/remote/eventBus/comunication/send/zeromq", &listToSend);
+        QTime retryTime = QTime::currentTime().addMSecs(100);
+        while(QTime::currentTime() < retryTime && object->var() == var) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 3);
+        }
     }
 }
 
+void ctkNetworkConnectorZeroMQTest::ctkNetworkConnectorZeroMQCommunictionTest() {
+    QCOMPARE(m_NetWorkConnectorZeroMQ->protocol(), QString("ZEROMQ"));
+    QCOMPARE(m_NetWorkConnectorZeroMQ->pattern(), ctkNetworkConnectorZeroMQ::RequestReply);
+
+    m_NetWorkConnectorZeroMQ->createServer(8010);
+    m_NetWorkConnectorZeroMQ->startListen();
+
+    // Register callback (done by the remote object).
+    ctkRegisterLocalCallback("ctk/local/eventBus/globalUpdate", m_ObjectTest, "updateObject()");
+
+    m_NetWorkConnectorZeroMQ->createClient("localhost", 8010);
+
+    sendAndWait(m_NetWorkConnectorZeroMQ, "ctk/local/eventBus/globalUpdate", m_ObjectTest);
+    QVERIFY(m_ObjectTest->var() > 0);
+}
+
+void ctkNetworkConnectorZeroMQTest::ctkNetworkConnectorZeroMQPublishSubscribeTest() {
+    ctkNetworkConnectorZeroMQ server(ctkNetworkConnectorZeroMQ::PublishSubscribe);
+    server.subscribeTopic("ctk/local/eventBus/zeromq/");
+    server.createServer(8011);
+    server.startListen();
+
+    ctkNetworkConnectorZeroMQ *client = static_cast<ctkNetworkConnectorZeroMQ *>(server.clone());
+    QCOMPARE(client->pattern(), ctkNetworkConnectorZeroMQ::PublishSubscribe);
+    client->createClient("localhost", 8011);
+
+    testObjectCustomForNetworkConnectorZeroMQ subscribed;
+    testObjectCustomForNetworkConnectorZeroMQ filtered;
+    ctkRegisterLocalCallback("ctk/local/eventBus/zeromq/update", &subscribed, "updateObject()");
+    ctkRegisterLocalCallback("ctk/local/eventBus/filteredUpdate", &filtered, "updateObject()");
+
+    sendAndWait(client, "ctk/local/eventBus/filteredUpdate", &filtered);
+    sendAndWait(client, "ctk/local/eventBus/zeromq/update", &subscribed);
+
+    QVERIFY(subscribed.var() > 0);
+    QCOMPARE(filtered.var(), 0);
+    delete client;
+}
+
 CTK_REGISTER_TEST(ctkNetworkConnectorZeroMQTest);
 #include "ctkNetworkConnectorZeroMQTest.moc"
 
@@ -0,0 +1,117 @@
+/*
+ *  ctkNetworkMessageTest.cpp
+ *  ctkEventBusTest
+ *
+ *  See Licence at: http://tiny.cc/QXJ4D
+ *
+ */
+
+#include "ctkTestSuite.h"
+#include <ctkEventDefinitions.h>
+#include <ctkNetworkMessage.h>
+
+using namespace ctkEventBus;
+
+/**
+ Class name: ctkNetworkMessageTest
+ This class implements the test suite for ctkNetworkMessage.
+ */
+
+//! <title>
+//ctkNetworkMessage
+//! </title>
+//! <description>
+//ctkNetworkMessage is the binary message exchanged by the network connectors.
+//! </description>
+
+class ctkNetworkMessageTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    /// check the encoding and the decoding of the requests and the replies.
+    void ctkNetworkMessageEncodingTest();
+
+    /// check the conversion of the arguments sent by the event bus.
+    void ctkNetworkMessageArgumentsTest();
+
+    /// check the framing of several messages in a stream.
+    void ctkNetworkMessageFrameTest();
+};
+
+void ctkNetworkMessageTest::ctkNetworkMessageEncodingTest() {
+    QVERIFY(!ctkNetworkMessage().isValid());
+    QVERIFY(!ctkNetworkMessage::decode(QByteArray("not a message")).isValid());
+
+    QVariantList eventParameters;
+    eventParameters.append("ctk/local/eventBus/globalUpdate");
+    eventParameters.append(ctkEventTypeLocal);
+    QVariantList dataParameters;
+    dataParameters.append(3.5);
+    dataParameters.append(QString("data"));
+    QList<QVariantList> parameters;
+    parameters.append(eventParameters);
+    parameters.append(dataParameters);
+
+    ctkNetworkMessage request = ctkNetworkMessage::decode(ctkNetworkMessage::request(7, "method", parameters).encode());
+    QVERIFY(request.isValid());
+    QCOMPARE(request.type(), ctkNetworkMessage::Request);
+    QCOMPARE(request.requestId(), 7);
+    QCOMPARE(request.methodName(), QString("method"));
+    QCOMPARE(request.topic(), QString("ctk/local/eventBus/globalUpdate"));
+    QCOMPARE(request.parameters(), parameters);
+
+    ctkNetworkMessage reply = ctkNetworkMessage::decode(ctkNetworkMessage::reply(7, "OK").encode());
+    QVERIFY(reply.isValid());
+    QCOMPARE(reply.type(), ctkNetworkMessage::Reply);
+    QCOMPARE(reply.requestId(), 7);
+    QCOMPARE(reply.status(), QString("OK"));
+    QVERIFY(reply.topic().isEmpty());
+}
+
+void ctkNetworkMessageTest::ctkNetworkMessageArgumentsTest() {
+    QVariantList eventParameters;
+    eventParameters.append("ctk/local/eventBus/globalUpdate");
+
+    ctkEventArgumentsList argList;
+    QVERIFY(!ctkNetworkMessage::request(1, "method", &argList).isValid());
+    QVERIFY(!ctkNetworkMessage::request(1, "method", NULL).isValid());
+
+    argList.append(ctkEventArgument(QVariantList, eventParameters));
+    ctkNetworkMessage request = ctkNetworkMessage::request(1, "method", &argList);
+    QVERIFY(request.isValid());
+    QCOMPARE(request.topic(), QString("ctk/local/eventBus/globalUpdate"));
+
+    int value = 1;
+    argList.append(ctkEventArgument(int, value));
+    QVERIFY(!ctkNetworkMessage::request(1, "method", &argList).isValid());
+}
+
+void ctkNetworkMessageTest::ctkNetworkMessageFrameTest() {
+    QByteArray stream;
+    ctkNetworkMessage::appendFrame(stream, ctkNetworkMessage::reply(1, "OK"));
+    ctkNetworkMessage::appendFrame(stream, ctkNetworkMessage::reply(2, "FAIL"));
+
+    // the second frame is received in two parts
+    QByteArray received = stream.left(stream.size() - 3);
+    int offset = 0;
+    ctkNetworkMessage message;
+    QCOMPARE(ctkNetworkMessage::takeFrame(received, offset, message), ctkNetworkMessage::FrameTaken);
+    QCOMPARE(message.requestId(), 1);
+    int endOfFirst = offset;
+    QCOMPARE(ctkNetworkMessage::takeFrame(received, offset, message), ctkNetworkMessage::FrameIncomplete);
+    QCOMPARE(offset, endOfFirst);
+
+    received += stream.right(3);
+    QCOMPARE(ctkNetworkMessage::takeFrame(received, offset, message), ctkNetworkMessage::FrameTaken);
+    QCOMPARE(message.requestId(), 2);
+    QCOMPARE(message.status(), QString("FAIL"));
+    QCOMPARE(offset, stream.size());
+
+    // a length larger than the maximum size is an error
+    QByteArray invalid(4, '\xff');
+    offset = 0;
+    QCOMPARE(ctkNetworkMessage::takeFrame(invalid, offset, message), ctkNetworkMessage::FrameError);
+}
+
+CTK_REGISTER_TEST(ctkNetworkMessageTest);
+#include "ctkNetworkMessageTest.moc"
@@ -110,6 +110,12 @@ void ctkTopicRegistryTest::ctkTopicRegistryOwnerTest() {
 
     // print 2 topic
     m_TopicRegistry->dump();
+
+    // wildcard lookup of the remaining topics
+    QStringList topics = m_TopicRegistry->topics("ctk/local/*");
+    QCOMPARE(topics.count(), 2);
+    QVERIFY(topics.contains("ctk/local/eventBus/testTopic1"));
+    QVERIFY(m_TopicRegistry->topics("ctk/local/eventBus/testTopic").isEmpty());
 }
 
 
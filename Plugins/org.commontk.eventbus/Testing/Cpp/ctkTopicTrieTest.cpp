@@ -0,0 +1,116 @@
+/*
+ *  ctkTopicTrieTest.cpp
+ *  ctkEventBusTest
+ *
+ *  See Licence at: http://tiny.cc/QXJ4D
+ *
+ */
+
+#include "ctkTestSuite.h"
+#include <ctkTopicTrie.h>
+
+using namespace ctkEventBus;
+
+/**
+ Class name: ctkTopicTrieTest
+ This class implements the test suite for ctkTopicTrie.
+ */
+
+//! <title>
+//ctkTopicTrie
+//! </title>
+//! <description>
+//ctkTopicTrie stores the topics by segment for the wildcard lookups.
+//! </description>
+
+class ctkTopicTrieTest : public QObject {
+    Q_OBJECT
+
+private Q_SLOTS:
+    /// insert, contains and remove test case.
+    void ctkTopicTrieInsertRemoveTest();
+
+    /// lookup of the patterns matching a topic.
+    void ctkTopicTrieMatchTest();
+
+    /// lookup of the topics matched by a pattern.
+    void ctkTopicTrieFindTest();
+};
+
+void ctkTopicTrieTest::ctkTopicTrieInsertRemoveTest() {
+    ctkTopicTrie trie;
+    QCOMPARE(trie.count(), 0);
+
+    trie.insert("ctk/local/eventBus/testTopic");
+    trie.insert("ctk/local/eventBus/testTopic");
+    trie.insert("ctk/local");
+    QCOMPARE(trie.count(), 2);
+    QVERIFY(trie.contains("ctk/local/eventBus/testTopic"));
+    QVERIFY(trie.contains("ctk/local"));
+    QVERIFY(!trie.contains("ctk/local/eventBus"));
+    QVERIFY(!trie.contains("ctk"));
+
+    trie.remove("ctk/local/eventBus");
+    QCOMPARE(trie.count(), 2);
+
+    trie.remove("ctk/local/eventBus/testTopic");
+    QCOMPARE(trie.count(), 1);
+    QVERIFY(!trie.contains("ctk/local/eventBus/testTopic"));
+    QVERIFY(trie.contains("ctk/local"));
+
+    trie.clear();
+    QCOMPARE(trie.count(), 0);
+    QVERIFY(!trie.contains("ctk/local"));
+
+    QVERIFY(ctkTopicTrie::isPattern("ctk/remote/*"));
+    QVERIFY(ctkTopicTrie::isPattern("ctk/*/eventBus"));
+    QVERIFY(!ctkTopicTrie::isPattern("ctk/remote/event*"));
+}
+
+void ctkTopicTrieTest::ctkTopicTrieMatchTest() {
+    ctkTopicTrie trie;
+    trie.insert("ctk/remote/*");
+    trie.insert("ctk/*/eventBus");
+    trie.insert("ctk/remote/eventBus");
+    trie.insert("ctk/local/eventBus/update");
+
+    QStringList patterns = trie.match("ctk/remote/eventBus");
+    QCOMPARE(patterns.count(), 3);
+    QVERIFY(patterns.contains("ctk/remote/*"));
+    QVERIFY(patterns.contains("ctk/*/eventBus"));
+    QVERIFY(patterns.contains("ctk/remote/eventBus"));
+
+    // a trailing wildcard matches several segments, the other ones exactly one
+    patterns = trie.match("ctk/remote/eventBus/comunication");
+    QCOMPARE(patterns, QStringList("ctk/remote/*"));
+
+    patterns = trie.match("ctk/local/eventBus");
+    QCOMPARE(patterns, QStringList("ctk/*/eventBus"));
+
+    QVERIFY(trie.match("ctk/remote").isEmpty());
+    QVERIFY(trie.match("ctk/local/eventBus/other").isEmpty());
+}
+
+void ctkTopicTrieTest::ctkTopicTrieFindTest() {
+    ctkTopicTrie trie;
+    trie.insert("ctk/remote/eventBus");
+    trie.insert("ctk/remote/eventBus/comunication");
+    trie.insert("ctk/local/eventBus");
+    trie.insert("ctk/local/other");
+
+    QStringList topics = trie.find("ctk/remote/*");
+    QCOMPARE(topics.count(), 2);
+    QVERIFY(topics.contains("ctk/remote/eventBus"));
+    QVERIFY(topics.contains("ctk/remote/eventBus/comunication"));
+
+    topics = trie.find("ctk/*/eventBus");
+    QCOMPARE(topics.count(), 2);
+    QVERIFY(topics.contains("ctk/local/eventBus"));
+
+    QCOMPARE(trie.find("ctk/local/other"), QStringList("ctk/local/other"));
+    QVERIFY(trie.find("ctk/local").isEmpty());
+    QCOMPARE(trie.find("*").count(), 4);
+}
+
+CTK_REGISTER_TEST(ctkTopicTrieTest);
+#include "ctkTopicTrieTest.moc"
@@ -0,0 +1,144 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkEventBusDispatchThread_p.h"
+
+#include "ctkEventBusImpl_p.h"
+
+namespace {
+
+// acquire load, available with the same name in Qt 4 and Qt 5
+template<class T>
+T* loadAcquire(QAtomicPointer<T>& pointer)
+{
+  return pointer.fetchAndAddAcquire(0);
+}
+
+}
+
+//----------------------------------------------------------------------------
+ctkEventBusQueue::ctkEventBusQueue()
+  : head(new Node()), tail(0)
+{
+  tail = loadAcquire(head);
+}
+
+//----------------------------------------------------------------------------
+ctkEventBusQueue::~ctkEventBusQueue()
+{
+  ctkEvent event;
+  while (dequeue(event)) {}
+  delete tail;
+}
+
+//----------------------------------------------------------------------------
+void ctkEventBusQueue::enqueue(const ctkEvent& event)
+{
+  Node* node = new Node();
+  node->event = event;
+  // the node is visible to the consumer once linked to the previous head
+  Node* previous = head.fetchAndStoreAcquire(node);
+  previous->next.fetchAndStoreRelease(node);
+}
+
+//----------------------------------------------------------------------------
+bool ctkEventBusQueue::dequeue(ctkEvent& event)
+{
+  Node* next = loadAcquire(tail->next);
+  if (next == 0)
+  {
+    return false;
+  }
+  event = next->event;
+  next->event = ctkEvent();
+  delete tail;
+  tail = next;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool ctkEventBusQueue::isEmpty() const
+{
+  // also false while an event is enqueued but not linked yet
+  return loadAcquire(const_cast<ctkEventBusQueue*>(this)->head) == tail;
+}
+
+//----------------------------------------------------------------------------
+ctkEventBusDispatchThread::ctkEventBusDispatchThread(ctkEventBusImpl* bus)
+  : bus(bus), waiting(0), stopped(0)
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkEventBusDispatchThread::post(const ctkEvent& event)
+{
+  queue.enqueue(event);
+  wakeUp();
+}
+
+//----------------------------------------------------------------------------
+void ctkEventBusDispatchThread::stop()
+{
+  stopped.fetchAndStoreOrdered(1);
+  wakeUp();
+  wait();
+}
+
+//----------------------------------------------------------------------------
+void ctkEventBusDispatchThread::wakeUp()
+{
+  if (waiting.testAndSetOrdered(1, 0))
+  {
+    semaphore.release();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkEventBusDispatchThread::run()
+{
+  ctkEvent event;
+  forever
+  {
+    while (queue.dequeue(event))
+    {
+      bus->dispatchEvent(event, true);
+    }
+    if (stopped.fetchAndAddOrdered(0))
+    {
+      // an event enqueued but not linked yet when stopping is delivered
+      if (queue.isEmpty()) return;
+      yieldCurrentThread();
+      continue;
+    }
+
+    waiting.fetchAndStoreOrdered(1);
+    // check again, an event may have been posted before the flag was set
+    if (!queue.isEmpty() || stopped.fetchAndAddOrdered(0))
+    {
+      if (waiting.testAndSetOrdered(1, 0))
+      {
+        continue;
+      }
+      // a publisher cleared the flag, take its release
+    }
+    semaphore.acquire();
+  }
+}
@@ -0,0 +1,115 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKEVENTBUSDISPATCHTHREAD_P_H
+#define CTKEVENTBUSDISPATCHTHREAD_P_H
+
+#include <service/event/ctkEvent.h>
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QSemaphore>
+#include <QThread>
+
+class ctkEventBusImpl;
+
+/**
+ * Unbounded multiple producers, single consumer queue of events.
+ *
+ * enqueue() is wait free and can be called from any thread, it only allocates the node
+ * of the event. dequeue() must only be called by the consumer thread.
+ */
+class ctkEventBusQueue
+{
+public:
+
+  ctkEventBusQueue();
+  ~ctkEventBusQueue();
+
+  void enqueue(const ctkEvent& event);
+
+  /**
+   * Take the oldest event, return false if the queue is empty or the
+   * event being enqueued is not linked yet.
+   */
+  bool dequeue(ctkEvent& event);
+
+  /**
+   * Check if all the enqueued events have been taken, from the consumer thread.
+   */
+  bool isEmpty() const;
+
+private:
+
+  struct Node
+  {
+    Node() : next(0) {}
+    QAtomicPointer<Node> next;
+    ctkEvent event;
+  };
+
+  Q_DISABLE_COPY(ctkEventBusQueue)
+
+  QAtomicPointer<Node> head; // last node enqueued, shared by the producers
+  Node* tail; // node before the oldest event, only used by the consumer
+};
+
+/**
+ * Thread delivering the events posted to the event bus in the order
+ * of its queue.
+ *
+ * The publishers only touch the semaphore when the thread is waiting
+ * for events, so that posting from an acquisition thread does not lock
+ * while the bus is busy.
+ */
+class ctkEventBusDispatchThread : public QThread
+{
+
+public:
+
+  ctkEventBusDispatchThread(ctkEventBusImpl* bus);
+
+  /**
+   * Queue the event and wake up the thread if it is waiting.
+   */
+  void post(const ctkEvent& event);
+
+  /**
+   * Deliver the queued events and stop the thread.
+   */
+  void stop();
+
+protected:
+
+  void run();
+
+private:
+
+  void wakeUp();
+
+  ctkEventBusImpl* bus;
+  ctkEventBusQueue queue;
+  QSemaphore semaphore;
+  QAtomicInt waiting; // 1 when the thread waits on the semaphore
+  QAtomicInt stopped;
+};
+
+#endif // CTKEVENTBUSDISPATCHTHREAD_P_H
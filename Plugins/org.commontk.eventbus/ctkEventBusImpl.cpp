@@ -23,6 +23,7 @@
 
 #include <QSetIterator>
 
+#include "ctkEventBusDispatchThread_p.h"
 #include "ctkEventHandlerWrapper_p.h"
 #include "ctkBusEvent.h"
 #include "ctkEventDefinitions.h"
@@ -30,14 +31,53 @@
 
 #define ctkEventArgument(type,data) QArgument<type >(#type, data)
 
-ctkEventBusImpl::ctkEventBusImpl()
+ctkEventBusImpl::ctkEventBusImpl(int asyncThreads, bool topicOrdering)
+  : m_TopicOrdering(topicOrdering), m_NextDispatchThread(0)
 {
     m_EventBusManager = ctkEventBus::ctkEventBusManager::instance();
+    for (int i = 0; i < asyncThreads; ++i)
+    {
+      ctkEventBusDispatchThread* thread = new ctkEventBusDispatchThread(this);
+      thread->start();
+      m_DispatchThreads.append(thread);
+    }
+}
+
+ctkEventBusImpl::~ctkEventBusImpl()
+{
+  // the events already posted are delivered
+  foreach (ctkEventBusDispatchThread* thread, m_DispatchThreads)
+  {
+    thread->stop();
+    delete thread;
+  }
+}
+
+ctkEventBusDispatchThread* ctkEventBusImpl::dispatchThread(const QString& topic)
+{
+  uint index = m_TopicOrdering ? qHash(topic)
+                               : uint(m_NextDispatchThread.fetchAndAddRelaxed(1));
+  return m_DispatchThreads.at(index % uint(m_DispatchThreads.size()));
 }
 
 void ctkEventBusImpl::postEvent(const ::ctkEvent& event)
 {
-  dispatchEvent(event, true);
+  if (m_DispatchThreads.isEmpty())
+  {
+    dispatchEvent(event, true);
+    return;
+  }
+  // does not wait for the subscribers, nor lock
+  dispatchThread(event.getTopic())->post(event);
+}
+
+void ctkEventBusImpl::postEvents(const QString& topic, const QList<ctkDictionary>& properties)
+{
+  // no batched dispatch, post the events one by one
+  for (int i = 0; i < properties.size(); ++i)
+  {
+    postEvent(::ctkEvent(topic, properties.at(i)));
+  }
 }
 
 void ctkEventBusImpl::sendEvent(const ::ctkEvent& event)
@@ -97,14 +137,14 @@ bool ctkEventBusImpl::updateProperties(qlonglong subscriptionId, const ctkDictio
 void ctkEventBusImpl::dispatchEvent(const ctkEvent& event, bool isAsync)
 {
   Q_UNUSED(isAsync)
-  ctkBusEvent *mebEvent = new ctkBusEvent("",ctkEventBus::ctkEventTypeRemote,ctkEventBus::ctkSignatureTypeSignal, this, "no");
+  ctkBusEvent mebEvent("",ctkEventBus::ctkEventTypeRemote,ctkEventBus::ctkSignatureTypeSignal, this, "no");
   //cycle for all other elements
   QStringList keyList = event.getPropertyNames();
   QStringList::const_iterator constIterator;
   for (constIterator = keyList.constBegin(); constIterator != keyList.constEnd(); ++constIterator) {
       QVariant value = event.getProperty((*constIterator));
       //qDebug() << (*constIterator) << " " << value.toString();
-      (*mebEvent)[(*constIterator)] = event.getProperty((*constIterator));
+      mebEvent[(*constIterator)] = event.getProperty((*constIterator));
   }
 
   typedef QList<QGenericArgument> ctkEventArgumentList;
@@ -113,7 +153,7 @@ void ctkEventBusImpl::dispatchEvent(const ctkEvent& event, bool isAsync)
   list.append(Q_ARG(QVariantList,event.getProperty("localEvent").toList()));
   list.append(Q_ARG(QVariantList,event.getProperty("localData").toList()));
 
-  m_EventBusManager->notifyEvent(*mebEvent, &list);
+  m_EventBusManager->notifyEvent(mebEvent, &list);
 }
 
 bool ctkEventBusImpl::createServer(const QString &communication_protocol, unsigned int listen_port) {
@@ -32,6 +32,7 @@
 
 //class forward
 class ctkEventHandlerWrapper;
+class ctkEventBusDispatchThread;
 
 
 class ctkEventBusImpl : public QObject,
@@ -42,9 +43,17 @@ class ctkEventBusImpl : public QObject,
 
 public:
 
-  ctkEventBusImpl();
+  /**
+   * The posted events are delivered by <code>asyncThreads</code> dedicated threads,
+   * or synchronously when it is 0. With <code>topicOrdering</code>, the events of a
+   * topic are always delivered by the same thread in the order they were posted,
+   * otherwise the events are spread over the threads.
+   */
+  ctkEventBusImpl(int asyncThreads = 1, bool topicOrdering = true);
+  ~ctkEventBusImpl();
 
   void postEvent(const ctkEvent& event);
+  void postEvents(const QString& topic, const QList<ctkDictionary>& properties);
   void sendEvent(const ctkEvent& event);
 
   void publishSignal(const QObject* publisher, const char* signal, const QString& topic, Qt::ConnectionType type = Qt::QueuedConnection);
@@ -72,8 +81,15 @@ protected:
 
 private:
 
+  friend class ctkEventBusDispatchThread;
+
+  /// Return the thread delivering the posted events of the topic.
+  ctkEventBusDispatchThread* dispatchThread(const QString& topic);
 
   ctkEventBus::ctkEventBusManager *m_EventBusManager;
+  QList<ctkEventBusDispatchThread*> m_DispatchThreads;
+  bool m_TopicOrdering;
+  QAtomicInt m_NextDispatchThread; ///< Round robin over the threads without topic ordering.
 };
 
 #endif // CTKEVENTBUSIMPL_H
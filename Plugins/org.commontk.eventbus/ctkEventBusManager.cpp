@@ -12,6 +12,9 @@
 #include "ctkTopicRegistry.h"
 #include "ctkNetworkConnectorQtSoap.h"
 #include "ctkNetworkConnectorQXMLRPC.h"
+#include "ctkNetworkConnectorTcp.h"
+#include "ctkNetworkConnectorSharedMemory.h"
+#include "ctkNetworkConnectorZeroMQ.h"
 
 using namespace ctkEventBus;
 
@@ -67,6 +70,9 @@ void ctkEventBusManager::shutdown() {
 void ctkEventBusManager::initializeNetworkConnectors() {
     plugNetworkConnector("SOAP", new ctkNetworkConnectorQtSoap());
     plugNetworkConnector("XMLRPC", new ctkNetworkConnectorQXMLRPC());
+    plugNetworkConnector("ZEROMQ", new ctkNetworkConnectorZeroMQ());
+    plugNetworkConnector("TCP", new ctkNetworkConnectorTcp());
+    plugNetworkConnector("SHAREDMEMORY", new ctkNetworkConnectorSharedMemory());
 }
 
 bool ctkEventBusManager::addEventProperty(ctkBusEvent &props) const {
@@ -179,6 +185,20 @@ void ctkEventBusManager::notifyEvent(ctkBusEvent &event_dictionary, ctkEventArgu
     }
 }
 
+void ctkEventBusManager::setTopicQoS(const QString &topic, const ctkTopicQoS &qos) {
+    m_LocalDispatcher->setTopicQoS(topic, qos);
+    m_RemoteDispatcher->setTopicQoS(topic, qos);
+}
+
+ctkTopicQoS ctkEventBusManager::topicQoS(const QString &topic) const {
+    return m_LocalDispatcher->topicQoS(topic);
+}
+
+void ctkEventBusManager::flushQueuedEvents() {
+    m_LocalDispatcher->flushQueuedEvents();
+    m_RemoteDispatcher->flushQueuedEvents();
+}
+
 void ctkEventBusManager::enableEventLogging(bool enable) {
     m_EnableEventLogging = enable;
 }
@@ -60,6 +60,18 @@ public:
     /// Notify event associated to the given id locally to the application.
     void notifyEvent(const QString topic, ctkEventType ev_type = ctkEventTypeLocal, ctkEventArgumentsList *argList = NULL, ctkGenericReturnArgument *returnArg = NULL) const;
 
+    /// Set the delivery settings of the given topic, for the local and the remote events.
+    /** The events of a topic which coalesces or has a backlog are queued and delivered later from the thread of the
+    event bus, high priority lanes first. Use it for high rate topics (progress, cursor position...) so that they
+    don't swamp the control topics.*/
+    void setTopicQoS(const QString &topic, const ctkTopicQoS &qos);
+
+    /// Return the delivery settings of the given topic.
+    ctkTopicQoS topicQoS(const QString &topic) const;
+
+    /// Deliver the queued local and remote events now.
+    void flushQueuedEvents();
+
     /// Enable/Disable event logging to allow dumping events notification into the selected logging output stream.
     void enableEventLogging(bool enable = true);
 
@@ -36,12 +36,20 @@
 
 ctkEventBusPlugin* ctkEventBusPlugin::instance = 0;
 
+// number of threads delivering the posted events, 0 to deliver them synchronously
+static const QString PROP_ASYNC_THREADS = "org.commontk.eventbus.AsyncThreads";
+// deliver the posted events of a topic in order, true by default
+static const QString PROP_TOPIC_ORDERING = "org.commontk.eventbus.TopicOrdering";
+
 void ctkEventBusPlugin::start(ctkPluginContext* context)
 {
   instance = this;
   this->context = context;
   qDebug() << "ctkEventBus Plugin starting";
-  m_Bus = new ctkEventBusImpl;
+  QVariant asyncThreads = context->getProperty(PROP_ASYNC_THREADS);
+  QVariant topicOrdering = context->getProperty(PROP_TOPIC_ORDERING);
+  m_Bus = new ctkEventBusImpl(asyncThreads.isValid() ? qMax(0, asyncThreads.toInt()) : 1,
+                              topicOrdering.isValid() ? topicOrdering.toBool() : true);
   qDebug() << "ctkEventBus created";
   context->registerService(QStringList("ctkEventAdminBus"),m_Bus);
   qDebug() << "ctkEventBus Plugin started";
@@ -15,6 +15,7 @@
 // Qt includes
 #include <QByteArray>
 #include <QList>
+#include <QMetaMethod>
 #include <QMap>
 #include <QVariant>
 #include <QString>
@@ -100,6 +101,26 @@ typedef enum {
     ctkSignatureTypeCallback = 1
 } ctkSignatureType;
 
+///< Enum that identify the lane of the queued events: the events of the higher lanes are delivered first.
+typedef enum {
+    ctkEventPriorityLow = 0,
+    ctkEventPriorityNormal = 1,
+    ctkEventPriorityHigh = 2
+} ctkEventPriority;
+
+/// delivery settings of a topic. With the default settings the events are delivered as soon as they are notified.
+/** The events of a topic which coalesces or has a backlog are queued by the dispatcher and delivered from its thread,
+without return value. Queued events of higher priority are delivered first. */
+struct ctkTopicQoS {
+    ctkTopicQoS() : priority(ctkEventPriorityNormal), coalesce(false), minimumInterval(0), maximumBacklog(0) {}
+    bool isQueued() const { return coalesce || maximumBacklog > 0; }
+
+    int priority; ///< lane of the queued events, one of ctkEventPriority.
+    bool coalesce; ///< only deliver the latest event notified since the previous delivery.
+    int minimumInterval; ///< with coalesce, minimum time in milliseconds between two deliveries.
+    int maximumBacklog; ///< number of queued events kept, the oldest are dropped. 0 for no limit when coalescing.
+};
+
 /// List of the arguments to be sent through the event bus.
 typedef QList<QGenericArgument> ctkEventArgumentsList;
 typedef ctkEventArgumentsList * ctkEventArgumentsListPointer;
@@ -114,6 +135,15 @@ typedef QHash<QString, ctkBusEvent *> ctkEventsHashType;
 /// type definition for observers' properties list to be stored into the event's hash.
 typedef QList<ctkBusEvent *> ctkEventItemListType;
 
+/// signal registered for a topic, with its method resolved at registration to avoid a lookup by name when the event is notified.
+struct ctkEventSignalItem {
+    QObject *object; ///< object which emits the signal
+    QMetaMethod method; ///< signal to emit
+};
+
+/// type definition for the signals' list of a topic, shared between the dispatcher and the notifications.
+typedef QList<ctkEventSignalItem> ctkEventSignalItemListType;
+
 /// map which represent list of function to be registered in the server, with parameters
 typedef QMap<QString, QList<QVariant::Type> >  mafRegisterMethodsMap;
 
@@ -13,21 +13,248 @@
 #include "ctkEventDispatcher.h"
 #include "ctkBusEvent.h"
 
+#include <QMetaType>
+#include <QTimer>
+
 #define CALLBACK_SIGNATURE "1"
 #define SIGNAL_SIGNATURE   "2"
 
 using namespace ctkEventBus;
 
-ctkEventDispatcher::ctkEventDispatcher() {
+namespace {
+
+/// return the signature of the method without its return type.
+QByteArray methodSignature(const QMetaMethod &method) {
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+    return method.methodSignature();
+#else
+    return QByteArray(method.signature());
+#endif
+}
+
+/// find the method of obj with the given signature, or with the same name as QMetaObject::invokeMethod() does.
+QMetaMethod resolveMethod(const QObject *obj, const QString &signature) {
+    const QMetaObject *metaObject = obj->metaObject();
+    QByteArray normalized = QMetaObject::normalizedSignature(signature.toLatin1().constData());
+    int index = metaObject->indexOfMethod(normalized.constData());
+    if(index >= 0) {
+        return metaObject->method(index);
+    }
+
+    QByteArray name = normalized.left(normalized.indexOf('(')) + '(';
+    for(int i = metaObject->methodCount() - 1; i >= 0; --i) {
+        if(methodSignature(metaObject->method(i)).startsWith(name)) {
+            return metaObject->method(i);
+        }
+    }
+    return QMetaMethod();
+}
+
+/// copy the value of the argument, return NULL if its type is not known by QMetaType.
+void *copyArgument(const QGenericArgument &arg, int *type) {
+    *type = QMetaType::type(arg.name());
+    if(*type == 0) {
+        return NULL;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
+    return QMetaType::create(*type, arg.data());
+#else
+    return QMetaType::construct(*type, arg.data());
+#endif
+}
+
+}
 
+ctkEventDispatcher::ctkEventDispatcher() : m_QueueScheduled(false), m_QueuedTopicCount(0), m_DeliveringEvent(NULL) {
+    m_QueueTimer = new QTimer(this);
+    m_QueueTimer->setSingleShot(true);
+    connect(m_QueueTimer, SIGNAL(timeout()), this, SLOT(deliverQueuedEvents()));
 }
 
 ctkEventDispatcher::~ctkEventDispatcher() {
+    QHash<QString, ctkTopicQueue>::iterator i;
+    for (i = m_TopicQueues.begin(); i != m_TopicQueues.end(); ++i) {
+        foreach(ctkQueuedEvent *queued, i.value().events) {
+            deleteQueuedEvent(queued);
+        }
+    }
+}
+
+void ctkEventDispatcher::setTopicQoS(const QString &topic, const ctkTopicQoS &qos) {
+    QList<ctkQueuedEvent *> dropped;
+    {
+        QMutexLocker locker(&m_QueueMutex);
+        ctkTopicQueue &queue = m_TopicQueues[topic];
+        if(queue.qos.isQueued() != qos.isQueued()) {
+            m_QueuedTopicCount.fetchAndAddOrdered(qos.isQueued() ? 1 : -1);
+        }
+        queue.qos = qos;
+        // the events already queued are delivered with the new settings, the extra ones are dropped.
+        int maximum = qos.coalesce ? 1 : qos.maximumBacklog;
+        while(maximum > 0 && queue.events.count() > maximum) {
+            dropped << queue.events.takeFirst();
+        }
+    }
+    foreach(ctkQueuedEvent *queued, dropped) {
+        deleteQueuedEvent(queued);
+    }
+}
+
+ctkTopicQoS ctkEventDispatcher::topicQoS(const QString &topic) const {
+    QMutexLocker locker(&m_QueueMutex);
+    return m_TopicQueues.value(topic).qos;
+}
+
+bool ctkEventDispatcher::queueEvent(ctkBusEvent &event_dictionary, ctkEventArgumentsList *argList) const {
+    if(m_QueuedTopicCount.fetchAndAddRelaxed(0) == 0) {
+        return false;
+    }
+    // the queued events are delivered through notifyEvent() too.
+    if(&event_dictionary == m_DeliveringEvent && QThread::currentThread() == thread()) {
+        return false;
+    }
+
+    QString topic = event_dictionary[TOPIC].toString();
+    {
+        QMutexLocker locker(&m_QueueMutex);
+        QHash<QString, ctkTopicQueue>::const_iterator it = m_TopicQueues.constFind(topic);
+        if(it == m_TopicQueues.constEnd() || !it.value().qos.isQueued()) {
+            return false;
+        }
+    }
+
+    // copy the arguments outside of the lock, they only live until notifyEvent() returns.
+    ctkQueuedEvent *queued = new ctkQueuedEvent;
+    queued->event = event_dictionary;
+    if(argList != NULL) {
+        foreach(const QGenericArgument &arg, *argList) {
+            int type = 0;
+            void *copy = copyArgument(arg, &type);
+            if(copy == NULL) {
+                qWarning("%s", tr("Argument of type %1 can not be queued, the event of %2 is delivered now")
+                         .arg(arg.name()).arg(topic).toLatin1().data());
+                deleteQueuedEvent(queued);
+                return false;
+            }
+            queued->typeNames << QByteArray(arg.name());
+            queued->arguments << copy;
+        }
+    }
+
+    ctkQueuedEvent *dropped = NULL;
+    bool schedule = false;
+    {
+        QMutexLocker locker(&m_QueueMutex);
+        ctkTopicQueue &queue = m_TopicQueues[topic];
+        queue.events.append(queued);
+        int maximum = queue.qos.coalesce ? 1 : queue.qos.maximumBacklog;
+        if(maximum > 0 && queue.events.count() > maximum) {
+            // the oldest event is stale, only the latest ones are worth delivering.
+            dropped = queue.events.takeFirst();
+        }
+        schedule = !m_QueueScheduled;
+        m_QueueScheduled = true;
+    }
+    if(dropped != NULL) {
+        deleteQueuedEvent(dropped);
+    }
+    if(schedule) {
+        if(QThread::currentThread() == thread()) {
+            const_cast<ctkEventDispatcher *>(this)->scheduleQueuedEvents();
+        } else {
+            QMetaObject::invokeMethod(const_cast<ctkEventDispatcher *>(this), "scheduleQueuedEvents", Qt::QueuedConnection);
+        }
+    }
+    return true;
+}
+
+void ctkEventDispatcher::scheduleQueuedEvents() {
+    if(!m_QueueTimer->isActive() || m_QueueTimer->interval() > 0) {
+        m_QueueTimer->start(0);
+    }
+}
+
+void ctkEventDispatcher::deliverQueuedEvents() {
+    QMap<int, QList<ctkQueuedEvent *> > lanes;
+    int nextDelivery = -1;
+    {
+        QMutexLocker locker(&m_QueueMutex);
+        m_QueueScheduled = false;
+        QHash<QString, ctkTopicQueue>::iterator i;
+        for (i = m_TopicQueues.begin(); i != m_TopicQueues.end(); ++i) {
+            ctkTopicQueue &queue = i.value();
+            if(queue.events.isEmpty()) {
+                continue;
+            }
+            if(queue.qos.coalesce && queue.qos.minimumInterval > 0 && queue.delivered) {
+                qint64 remaining = queue.qos.minimumInterval - queue.lastDelivery.elapsed();
+                if(remaining > 0) {
+                    nextDelivery = nextDelivery < 0 ? int(remaining) : qMin(nextDelivery, int(remaining));
+                    continue;
+                }
+            }
+            lanes[queue.qos.priority] << queue.events;
+            queue.events.clear();
+            queue.lastDelivery.start();
+            queue.delivered = true;
+        }
+    }
+    deliverEvents(lanes);
+    if(nextDelivery >= 0) {
+        QMutexLocker locker(&m_QueueMutex);
+        // an event queued meanwhile already scheduled the earliest delivery.
+        if(!m_QueueScheduled) {
+            m_QueueTimer->start(nextDelivery);
+        }
+    }
+}
+
+void ctkEventDispatcher::flushQueuedEvents() {
+    QMap<int, QList<ctkQueuedEvent *> > lanes;
+    {
+        QMutexLocker locker(&m_QueueMutex);
+        QHash<QString, ctkTopicQueue>::iterator i;
+        for (i = m_TopicQueues.begin(); i != m_TopicQueues.end(); ++i) {
+            ctkTopicQueue &queue = i.value();
+            if(queue.events.isEmpty()) {
+                continue;
+            }
+            lanes[queue.qos.priority] << queue.events;
+            queue.events.clear();
+            queue.lastDelivery.start();
+            queue.delivered = true;
+        }
+    }
+    deliverEvents(lanes);
+}
 
+void ctkEventDispatcher::deliverEvents(const QMap<int, QList<ctkQueuedEvent *> > &lanes) {
+    QMapIterator<int, QList<ctkQueuedEvent *> > lane(lanes);
+    lane.toBack();
+    while(lane.hasPrevious()) {
+        lane.previous();
+        foreach(ctkQueuedEvent *queued, lane.value()) {
+            ctkEventArgumentsList argList;
+            for(int i = 0; i < queued->arguments.count(); ++i) {
+                argList << QGenericArgument(queued->typeNames.at(i).constData(), queued->arguments.at(i));
+            }
+            m_DeliveringEvent = &queued->event;
+            notifyEvent(queued->event, argList.isEmpty() ? NULL : &argList);
+            m_DeliveringEvent = NULL;
+            deleteQueuedEvent(queued);
+        }
+    }
+}
+
+void ctkEventDispatcher::deleteQueuedEvent(ctkQueuedEvent *queued) {
+    for(int i = 0; i < queued->arguments.count(); ++i) {
+        QMetaType::destroy(QMetaType::type(queued->typeNames.at(i).constData()), queued->arguments.at(i));
+    }
+    delete queued;
 }
 
 bool ctkEventDispatcher::isLocalSignalPresent(const QString topic) const {
-    return m_SignalsHash.values(topic).size() != 0;
+    return m_SignalsHash.contains(topic);
 }
 
 void ctkEventDispatcher::resetHashes() {
@@ -42,6 +269,56 @@ void ctkEventDispatcher::resetHashes() {
         delete i.value();
     }
     m_SignalsHash.clear();
+    m_SignalItemsHash.clear();
+    m_CallbacksTrie.clear();
+    m_SignalsTrie.clear();
+}
+
+ctkEventItemListType ctkEventDispatcher::callbackItems(const QString &topic) const {
+    ctkEventItemListType items;
+    foreach(QString pattern, m_CallbacksTrie.match(topic)) {
+        items.append(m_CallbacksHash.values(pattern));
+    }
+    return items;
+}
+
+void ctkEventDispatcher::updateTopicTries(const QString &topic) {
+    if(m_CallbacksHash.contains(topic)) {
+        m_CallbacksTrie.insert(topic);
+    } else {
+        m_CallbacksTrie.remove(topic);
+    }
+    if(m_SignalsHash.contains(topic)) {
+        m_SignalsTrie.insert(topic);
+    } else {
+        m_SignalsTrie.remove(topic);
+    }
+}
+
+void ctkEventDispatcher::updateSignalItems(const QString &topic) {
+    ctkEventSignalItemListType items;
+    ctkBusEvent *itemEventProp;
+    foreach(itemEventProp, m_SignalsHash.values(topic)) {
+        QString sig = (*itemEventProp)[SIGNATURE].toString();
+        QObject *obj = (*itemEventProp)[OBJECT].value<QObject *>();
+        if(sig.length() == 0 || obj == NULL) {
+            continue;
+        }
+        ctkEventSignalItem item;
+        item.object = obj;
+        item.method = resolveMethod(obj, sig);
+        if(item.method.methodIndex() < 0) {
+            qWarning("%s", tr("No method %1 in %2 for Topic '%3'").arg(sig, obj->metaObject()->className(), topic).toLatin1().data());
+            continue;
+        }
+        items.append(item);
+    }
+
+    if(items.isEmpty()) {
+        m_SignalItemsHash.remove(topic);
+    } else {
+        m_SignalItemsHash.insert(topic, items);
+    }
 }
 
 void ctkEventDispatcher::initializeGlobalEvents() {
@@ -97,18 +374,21 @@ bool ctkEventDispatcher::disconnectSignal(ctkBusEvent &props) {
 }
 
 bool ctkEventDispatcher::disconnectCallback(ctkBusEvent &props) {
-    //need to disconnect observer from the signal
+    //need to disconnect observer from the signals of all the topics it matches
     QString observer_sig = CALLBACK_SIGNATURE;
     observer_sig.append(props[SIGNATURE].toString());
-
-    ctkBusEvent *itemSignal = m_SignalsHash.value(props[TOPIC].toString());
-    QString event_sig = SIGNAL_SIGNATURE;
-    event_sig.append((*itemSignal)[SIGNATURE].toString());
-
-    QObject *objSignal = (*itemSignal)[OBJECT].value<QObject *>();
     QObject *objSlot = props[OBJECT].value<QObject *>();
 
-    return disconnect(objSignal, event_sig.toLatin1(), objSlot, observer_sig.toLatin1());
+    bool result = true;
+    foreach(QString topic, m_SignalsTrie.find(props[TOPIC].toString())) {
+        ctkBusEvent *itemSignal = m_SignalsHash.value(topic);
+        QString event_sig = SIGNAL_SIGNATURE;
+        event_sig.append((*itemSignal)[SIGNATURE].toString());
+
+        QObject *objSignal = (*itemSignal)[OBJECT].value<QObject *>();
+        result = disconnect(objSignal, event_sig.toLatin1(), objSlot, observer_sig.toLatin1()) && result;
+    }
+    return result;
 }
 
 bool ctkEventDispatcher::removeEventItem(ctkBusEvent &props) {
@@ -130,6 +410,7 @@ bool ctkEventDispatcher::removeEventItem(ctkBusEvent &props) {
                     ++i;
                 }
             }
+            updateTopicTries(props[TOPIC].toString());
         } else {
             //itemEventPropList = m_SignalsHash.values();
             isDisconnected = disconnectSignal(props);
@@ -145,6 +426,8 @@ bool ctkEventDispatcher::removeEventItem(ctkBusEvent &props) {
             }
             m_SignalsHash.remove(props[TOPIC].toString()); //in signal hash the id is unique
             m_CallbacksHash.remove(props[TOPIC].toString()); //remove also all the id associated in callback
+            m_SignalItemsHash.remove(props[TOPIC].toString());
+            updateTopicTries(props[TOPIC].toString());
         }
 
         //itemEventPropList.removeAt(idx);
@@ -166,30 +449,31 @@ bool ctkEventDispatcher::addObserver(ctkBusEvent &props) {
 
     if(sig.length() > 0 && objSlot != NULL) {
 
-        ctkBusEvent *itemEventProp;
-        //bool testRes = this->isLocalSignalPresent(topic);
-        itemEventProp = m_SignalsHash.value(topic);
-        if(itemEventProp == NULL) {
-            qDebug() << tr("Signal not present for topic %1, create only the entry in CallbacksHash").arg(topic);
-
-            ctkBusEvent *dict = const_cast<ctkBusEvent *>(&props);
-            this->m_CallbacksHash.insertMulti(topic, dict);
+        // Add the new observer to the Hash.
+        ctkBusEvent *dict = const_cast<ctkBusEvent *>(&props);
+        this->m_CallbacksHash.insertMulti(topic, dict);
+        m_CallbacksTrie.insert(topic);
 
+        // a wildcard topic is connected to the signals of all the matching topics
+        QStringList signalTopics = m_SignalsTrie.find(topic);
+        if(signalTopics.isEmpty()) {
+            qDebug() << tr("Signal not present for topic %1, create only the entry in CallbacksHash").arg(topic);
             return true;
         }
 
         QString observer_sig = CALLBACK_SIGNATURE;
         observer_sig.append(props[SIGNATURE].toString());
-        
-        QString event_sig = SIGNAL_SIGNATURE;
-        event_sig.append((*itemEventProp)[SIGNATURE].toString());
-        
-        // Add the new observer to the Hash.
-        ctkBusEvent *dict = const_cast<ctkBusEvent *>(&props);
-        this->m_CallbacksHash.insertMulti(topic, dict);
-        QObject *objSignal = (*itemEventProp)[OBJECT].value<QObject *>();
 
-        return connect(objSignal, event_sig.toLatin1(), objSlot, observer_sig.toLatin1());
+        bool cumulativeConnect = true;
+        foreach(QString signalTopic, signalTopics) {
+            ctkBusEvent *itemEventProp = m_SignalsHash.value(signalTopic);
+            QString event_sig = SIGNAL_SIGNATURE;
+            event_sig.append((*itemEventProp)[SIGNATURE].toString());
+
+            QObject *objSignal = (*itemEventProp)[OBJECT].value<QObject *>();
+            cumulativeConnect = connect(objSignal, event_sig.toLatin1(), objSlot, observer_sig.toLatin1()) && cumulativeConnect;
+        }
+        return cumulativeConnect;
     }
     
     qDebug() << tr("Signal not valid for topic: %1").arg(topic);
@@ -246,15 +530,21 @@ bool ctkEventDispatcher::removeFromHash(ctkEventsHashType *hash, const QObject *
                 ++i;
             }
         }
+        if(hash == &m_SignalsHash) {
+            updateSignalItems(topic);
+        }
+        updateTopicTries(topic);
         return disconnectItem;
     }
 
     if(topic.isEmpty()) {
+        QStringList topics;
         ctkEventsHashType::iterator i = hash->begin();
         while(i != hash->end()) {
             QObject *item = (*(i.value()))[OBJECT].value<QObject *>();
             if(item == obj) {
                 ctkBusEvent *prop = i.value();
+                topics.append(i.key());
                 bool currentDisconnetFlag = false;
                 if(qt_disconnect) {
                     if(*hash == m_CallbacksHash) {
@@ -277,6 +567,12 @@ bool ctkEventDispatcher::removeFromHash(ctkEventsHashType *hash, const QObject *
                 ++i;
             }
         }
+        foreach(QString t, topics) {
+            if(hash == &m_SignalsHash) {
+                updateSignalItems(t);
+            }
+            updateTopicTries(t);
+        }
         return disconnectItem;
     }
 
@@ -298,6 +594,10 @@ bool ctkEventDispatcher::registerSignal(ctkBusEvent &props) {
     }
 
     QString topic = props[TOPIC].toString();
+    if(ctkTopicTrie::isPattern(topic)) {
+        qWarning("%s", tr("Topic '%1' of a signal cannot contain wildcards").arg(topic).toLatin1().data());
+        return false;
+    }
     // Check if a signal (corresponding to a mafID) already is present.
     if(m_SignalsHash.contains(topic)) {// && (this->isSignaturePresent(signal_props) == true)) {
         // Only one signal for a given id can be registered!!
@@ -312,13 +612,15 @@ bool ctkEventDispatcher::registerSignal(ctkBusEvent &props) {
 
 
     ctkEventItemListType itemEventPropList;
-    itemEventPropList = m_CallbacksHash.values(topic);
+    itemEventPropList = callbackItems(topic);
     if(itemEventPropList.count() == 0) {
         qDebug() << tr("Callbacks not present for topic %1, create only the entry in SignalsHash").arg(topic);
 
         // Add the new signal to the Hash.
         ctkBusEvent *dict = const_cast<ctkBusEvent *>(&props);
         this->m_SignalsHash.insert(topic, dict);
+        m_SignalsTrie.insert(topic);
+        updateSignalItems(topic);
         return true;
     }
 
@@ -342,6 +644,8 @@ bool ctkEventDispatcher::registerSignal(ctkBusEvent &props) {
          }
          ctkBusEvent *dict = const_cast<ctkBusEvent *>(&props);
          this->m_SignalsHash.insert(topic, dict);
+         m_SignalsTrie.insert(topic);
+         updateSignalItems(topic);
     }
 
     return cumulativeConnect;
@@ -13,12 +13,24 @@
 #define CTKEVENTDISPATCHER_H
 
 #include "ctkEventDefinitions.h"
+#include "ctkTopicTrie.h"
+#include "ctkBusEvent.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+
+class QTimer;
 
 namespace ctkEventBus {
 
 /**
  Class name: ctkEventDispatcher
  This allows dispatching events coming from local application to attached observers.
+ The topic of an observer can contain "*" wildcard segments ("ctk/local/*"): it is connected to the
+ signals of all the matching topics, registered before or after it. The topics of the signals and of
+ the observers are kept in ctkTopicTrie, so the matching ones are found without scanning the hashes.
+ The events of the topics given a queued ctkTopicQoS are kept per priority lane and delivered later
+ from the thread of the dispatcher, so that high rate topics don't swamp the others.
  */
 class org_commontk_eventbus_EXPORT ctkEventDispatcher : public QObject {
     Q_OBJECT
@@ -59,6 +71,15 @@ public:
     /// Emit event corresponding to the given id (present into the event_dictionary) locally to the application.
     virtual void notifyEvent(ctkBusEvent &event_dictionary, ctkEventArgumentsList *argList = NULL, ctkGenericReturnArgument *returnArg = NULL) const;
 
+    /// Set the delivery settings of the events of the given topic (without wildcard).
+    void setTopicQoS(const QString &topic, const ctkTopicQoS &qos);
+
+    /// Return the delivery settings of the given topic.
+    ctkTopicQoS topicQoS(const QString &topic) const;
+
+    /// Deliver all the queued events now, regardless of their minimum interval.
+    void flushQueuedEvents();
+
     /// clean the signal and callback hashes.
     /** This method is used when the destructor is called. The destructor of the dispatcher is called by the ctkEventBusManager destructor.*/
     void resetHashes();
@@ -82,7 +103,44 @@ protected:
     /// Return the signal item property associated to the given ID.
     ctkEventItemListType signalItemProperty(const QString topic) const;
 
+    /// Queue the event if the QoS of its topic requires it, return true if it was queued.
+    /** Subclasses call it first in notifyEvent(), the arguments are copied. */
+    bool queueEvent(ctkBusEvent &event_dictionary, ctkEventArgumentsList *argList) const;
+
+    /// Return the signals associated to the given ID with their resolved methods.
+    /** The list is a snapshot updated when the signals change, so it can be copied without allocation when an event is notified. */
+    ctkEventSignalItemListType signalItems(const QString &topic) const;
+
+private Q_SLOTS:
+    /// Deliver the queued events which are due and restart the timer for the others.
+    void deliverQueuedEvents();
+
+    /// Start the timer of the queued events from the thread of the dispatcher.
+    void scheduleQueuedEvents();
+
 private:
+    /// event waiting in the queue of its topic, with a copy of its arguments.
+    struct ctkQueuedEvent {
+        ctkBusEvent event;
+        QList<QByteArray> typeNames;
+        QList<void *> arguments;
+    };
+
+    /// settings and queued events of a topic.
+    struct ctkTopicQueue {
+        ctkTopicQueue() : delivered(false) {}
+        ctkTopicQoS qos;
+        QList<ctkQueuedEvent *> events;
+        QElapsedTimer lastDelivery;
+        bool delivered;
+    };
+
+    /// Deliver the events, by lane of decreasing priority.
+    void deliverEvents(const QMap<int, QList<ctkQueuedEvent *> > &lanes);
+
+    /// Free the event and its copied arguments.
+    static void deleteQueuedEvent(ctkQueuedEvent *queued);
+
     /// method used to check if the given object has been already registered for the given id and signature.
     bool isSignaturePresent(ctkBusEvent &props) const;
 
@@ -96,8 +154,27 @@ private:
     /// Remove the given object from the has passed as argument
     bool removeFromHash(ctkEventsHashType *hash, const QObject *obj, const QString topic, bool qt_disconnect = true);
 
+    /// Resolve again the methods of the signals registered for the given topic.
+    void updateSignalItems(const QString &topic);
+
+    /// Return the observers of the given topic, including the ones subscribed with a wildcard.
+    ctkEventItemListType callbackItems(const QString &topic) const;
+
+    /// Add or remove the topic from the tries according to the hashes.
+    void updateTopicTries(const QString &topic);
+
     ctkEventsHashType m_CallbacksHash; ///< Callbacks' hash for receiving events like updates or refreshes.
     ctkEventsHashType m_SignalsHash; ///< Signals' hash for sending events.
+    QHash<QString, ctkEventSignalItemListType> m_SignalItemsHash; ///< Signals of m_SignalsHash with their resolved methods.
+    ctkTopicTrie m_CallbacksTrie; ///< Topics and patterns of m_CallbacksHash.
+    ctkTopicTrie m_SignalsTrie; ///< Topics of m_SignalsHash.
+
+    mutable QMutex m_QueueMutex; ///< Guards the queues, events can be notified from any thread.
+    mutable QHash<QString, ctkTopicQueue> m_TopicQueues; ///< Topics with a QoS and their queued events.
+    mutable bool m_QueueScheduled; ///< true when a delivery of the queues is pending.
+    QAtomicInt m_QueuedTopicCount; ///< Number of topics whose events are queued, to skip the lookup when 0.
+    QTimer *m_QueueTimer; ///< Timer delivering the queued events.
+    const ctkBusEvent *m_DeliveringEvent; ///< Queued event being delivered, which must not be queued again.
 };
 
 /////////////////////////////////////////////////////////////
@@ -108,6 +185,10 @@ inline ctkEventItemListType ctkEventDispatcher::signalItemProperty(const QString
     return m_SignalsHash.values(topic);
 }
 
+inline ctkEventSignalItemListType ctkEventDispatcher::signalItems(const QString &topic) const {
+    return m_SignalItemsHash.value(topic);
+}
+
 } // namespace ctkEventBus
 
 #endif // CTKEVENTDISPATCHER_H
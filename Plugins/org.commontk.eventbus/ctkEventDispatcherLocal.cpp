@@ -34,128 +34,38 @@ void ctkEventDispatcherLocal::initializeGlobalEvents() {
 }
 
 void ctkEventDispatcherLocal::notifyEvent(ctkBusEvent &event_dictionary, ctkEventArgumentsList *argList, ctkGenericReturnArgument *returnArg) const {
+    // events of topics with a queued QoS are delivered later by the dispatcher.
+    if(queueEvent(event_dictionary, argList)) {
+        return;
+    }
+
     QString topic = event_dictionary[TOPIC].toString();
-    ctkEventItemListType items = signalItemProperty(topic);
-    ctkBusEvent *itemEventProp;
-    foreach(itemEventProp, items) {
-        if((*itemEventProp)[SIGNATURE].toString().length() != 0) {
-            QString signal_to_emit = (*itemEventProp)[SIGNATURE].toString().split("(")[0];
-            QObject *obj = (*itemEventProp)[OBJECT].value<QObject *>();
-            if(argList != NULL) {
-                if (returnArg == NULL || returnArg->data() == NULL) { //don't use return value
-                    switch (argList->count()) {
-                        case 0:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1());
-                            break;
-                        case 1:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                            argList->at(0));
-                            break;
-                        case 2:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1));
-                            break;
-                        case 3:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2));
-                            break;
-                        case 4:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3));
-                            break;
-                        case 5:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4));
-                            break;
-                        case 6:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), argList->at(5));
-                            break;
-                        case 7:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6));
-                            break;
-                        case 8:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7));
-                            break;
-                        case 9:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7), argList->at(8));
-                            break;
-                        case 10:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7), argList->at(8), argList->at(9));
-                            break;
-                        default:
-                            qWarning("%s", tr("Number of arguments not supported. Max 10 arguments").toLatin1().data());
-                    } //switch
-                 } else { //use return value
-                    switch (argList->count()) {
-                        case 0:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg);
-                            break;
-                        case 1:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg,\
-                            argList->at(0));
-                            break;
-                        case 2:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1));
-                            break;
-                        case 3:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2));
-                            break;
-                        case 4:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3));
-                            break;
-                        case 5:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4));
-                            break;
-                        case 6:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), argList->at(5));
-                            break;
-                        case 7:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6));
-                            break;
-                        case 8:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7));
-                            break;
-                        case 9:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7), argList->at(8));
-                            break;
-                        case 10:
-                            this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg, \
-                             argList->at(0), argList->at(1), argList->at(2), argList->at(3), argList->at(4), \
-                             argList->at(5), argList->at(6), argList->at(7), argList->at(8), argList->at(9));
-                            break;
-                        default:
-                            qWarning("%s", tr("Number of arguments not supported. Max 10 arguments").toLatin1().data());
-                    } //switch
-                 }
-            } else {
-                if (returnArg == NULL || returnArg->data() == NULL) { //don't use return value
-                    this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1());
-                } else {
-                    this->metaObject()->invokeMethod(obj, signal_to_emit.toLatin1(), *returnArg);
-                }
+    // the signals' list is shared with the dispatcher, no allocation here.
+    const ctkEventSignalItemListType items = signalItems(topic);
+    if(items.isEmpty()) {
+        return;
+    }
 
-            }
+    QGenericArgument args[10];
+    if(argList != NULL) {
+        if(argList->count() > 10) {
+            qWarning("%s", tr("Number of arguments not supported. Max 10 arguments").toLatin1().data());
+            return;
+        }
+        for(int i = 0; i < argList->count(); ++i) {
+            args[i] = argList->at(i);
         }
     }
-}
 
+    QGenericReturnArgument ret;
+    if(returnArg != NULL && returnArg->data() != NULL) { //use return value
+        ret = *returnArg;
+    }
+
+    ctkEventSignalItemListType::const_iterator item = items.constBegin();
+    for(; item != items.constEnd(); ++item) {
+        (*item).method.invoke((*item).object, Qt::AutoConnection, ret, \
+                              args[0], args[1], args[2], args[3], args[4], \
+                              args[5], args[6], args[7], args[8], args[9]);
+    }
+}
@@ -74,6 +74,11 @@ void ctkEventDispatcherRemote::notifyEvent(ctkBusEvent &event_dictionary, ctkEve
     //Q_UNUSED(argList);
     Q_UNUSED(returnArg);
 
+    // events of topics with a queued QoS are sent later by the dispatcher.
+    if(queueEvent(event_dictionary, argList)) {
+        return;
+    }
+
     // Call the notifyEventRemote converting the arguments...
     m_NetworkConnectorClient->send(event_dictionary[TOPIC].toString(), argList);
 }
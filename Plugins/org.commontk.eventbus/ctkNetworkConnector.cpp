@@ -10,6 +10,10 @@
  */
 
 #include "ctkNetworkConnector.h"
+#include "ctkNetworkMessage.h"
+#include "ctkEventBusManager.h"
+
+#include <service/event/ctkEvent.h>
 
 using namespace ctkEventBus;
 
@@ -20,3 +24,40 @@ ctkNetworkConnector::ctkNetworkConnector() {
 QString ctkNetworkConnector::protocol() {
     return m_Protocol;
 }
+
+QString ctkNetworkConnector::notifyRequest(const ctkNetworkMessage &request) {
+    //first argument regards local signal to be called.
+    QString id_name = request.topic();
+    if(id_name.isEmpty()) {
+        return "No Command to Execute, command list is empty";
+    }
+
+    QList<QVariantList> parameters = request.parameters();
+    QVariantList p;
+    if(parameters.count() > 1) {
+        p = parameters.at(1);
+    }
+    ctkEventArgumentsList *argList = NULL;
+    if(p.count() != 0) {
+        argList = new ctkEventArgumentsList();
+        argList->push_back(Q_ARG(QVariantList, p));
+    }
+
+    QString status("FAIL");
+    if ( ctkEventBusManager::instance()->isLocalSignalPresent(id_name) ) {
+        ctkBusEvent dictionary(id_name,ctkEventTypeLocal,0,NULL,"");
+        ctkEventBusManager::instance()->notifyEvent(dictionary, argList);
+        status = "OK";
+    }
+    delete argList;
+    return status;
+}
+
+void ctkNetworkConnector::notifyReturnValue(const QString &status) {
+    if(status == "OK") {
+        ctkEventBusManager::instance()->notifyEvent("ctk/local/eventBus/remoteCommunicationDone", ctkEventTypeLocal);
+    } else {
+        qDebug("%s", status.toLatin1().data());
+        ctkEventBusManager::instance()->notifyEvent("ctk/local/eventBus/remoteCommunicationFailed", ctkEventTypeLocal);
+    }
+}
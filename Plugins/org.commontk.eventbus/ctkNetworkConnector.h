@@ -17,6 +17,8 @@
 
 namespace ctkEventBus {
 
+class ctkNetworkMessage;
+
 /**
  Class name: ctkNetworkConnector
  This class is the interface class for client/server objects that works over network.
@@ -56,6 +58,12 @@ Q_SIGNALS:
     void remoteCommunication(const QString event_id, ctkEventArgumentsList *argList);
 
 protected:
+    /// notify locally the event of a request received by the server, and return the status to reply.
+    QString notifyRequest(const ctkNetworkMessage &request);
+
+    /// notify ctk/local/eventBus/remoteCommunicationDone if status is "OK", ctk/local/eventBus/remoteCommunicationFailed otherwise.
+    void notifyReturnValue(const QString &status);
+
     QString m_Protocol; ///< define the protocol of the connector (xmlrpc, soap, etc...)
 };
 
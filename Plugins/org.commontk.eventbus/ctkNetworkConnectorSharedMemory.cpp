@@ -0,0 +1,353 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkNetworkConnectorSharedMemory.h"
+#include "ctkNetworkMessage.h"
+#include "ctkEventBusManager.h"
+
+#include <service/event/ctkEvent.h>
+
+#include <QHostInfo>
+#include <QSharedMemory>
+#include <QSystemSemaphore>
+#include <QThread>
+
+#include <cstring>
+
+namespace {
+
+/// identifies an initialized ring buffer, reset when the server stops.
+const quint32 RING_MAGIC = 0x63746b52; // "ctkR"
+
+/// header at the beginning of the shared memory, followed by the data of the ring buffer.
+/** head and tail are byte counters, the position in the buffer is the counter modulo the capacity
+    which is a power of two. Both are only accessed with the shared memory locked. */
+struct ctkSharedMemoryHeader {
+    quint32 magic;
+    quint32 capacity;
+    quint32 head; ///< written by the clients
+    quint32 tail; ///< written by the server
+};
+
+char *ringData(QSharedMemory *memory) {
+    return static_cast<char *>(memory->data()) + sizeof(ctkSharedMemoryHeader);
+}
+
+ctkSharedMemoryHeader *ringHeader(QSharedMemory *memory) {
+    return static_cast<ctkSharedMemoryHeader *>(memory->data());
+}
+
+}
+
+namespace ctkEventBus {
+
+/**
+ Class name: ctkSharedMemoryReader
+ Thread waiting on the semaphore of the server, the frames are read in the thread of the connector.
+ */
+class ctkSharedMemoryReader : public QThread {
+public:
+    ctkSharedMemoryReader(ctkNetworkConnectorSharedMemory *connector) : m_Scheduled(0), m_Connector(connector), m_Stop(0) {
+    }
+
+    /// wake up and stop the thread.
+    void stop() {
+        m_Stop.fetchAndStoreOrdered(1);
+        m_Connector->m_ServerSemaphore->release();
+        wait();
+    }
+
+    QAtomicInt m_Scheduled; ///< a readServerData() is queued
+
+protected:
+    void run() {
+        while(true) {
+            if(!m_Connector->m_ServerSemaphore->acquire() || m_Stop.fetchAndAddOrdered(0)) {
+                break;
+            }
+            // several releases are handled by one read
+            if(m_Scheduled.testAndSetOrdered(0, 1)) {
+                QMetaObject::invokeMethod(m_Connector, "readServerData", Qt::QueuedConnection);
+            }
+        }
+    }
+
+private:
+    ctkNetworkConnectorSharedMemory *m_Connector;
+    QAtomicInt m_Stop;
+};
+
+}
+
+using namespace ctkEventBus;
+
+ctkNetworkConnectorSharedMemory::ctkNetworkConnectorSharedMemory() : ctkNetworkConnector(), m_ServerMemory(NULL), m_ServerSemaphore(NULL), m_Reader(NULL), m_Port(0), m_ClientMemory(NULL), m_ClientSemaphore(NULL), m_ClientPort(0), m_BufferSize(4 * 1024 * 1024), m_RequestId(0) {
+
+    m_Protocol = "SHAREDMEMORY";
+}
+
+void ctkNetworkConnectorSharedMemory::initializeForEventBus() {
+    ctkRegisterRemoteSignal("ctk/remote/eventBus/comunication/send/sharedmemory", this, "remoteCommunication(const QString, ctkEventArgumentsList *)");
+    ctkRegisterRemoteCallback("ctk/remote/eventBus/comunication/send/sharedmemory", this, "send(const QString, ctkEventArgumentsList *)");
+}
+
+ctkNetworkConnectorSharedMemory::~ctkNetworkConnectorSharedMemory() {
+    stopClient();
+    stopServer();
+}
+
+//retrieve an instance of the object
+ctkNetworkConnector *ctkNetworkConnectorSharedMemory::clone() {
+    ctkNetworkConnectorSharedMemory *copy = new ctkNetworkConnectorSharedMemory();
+    copy->m_BufferSize = m_BufferSize;
+    return copy;
+}
+
+void ctkNetworkConnectorSharedMemory::setBufferSize(int size) {
+    // a power of two, so that the counters can wrap around
+    int capacity = 1024;
+    while(capacity < size && capacity < (1 << 30)) {
+        capacity <<= 1;
+    }
+    m_BufferSize = capacity;
+}
+
+int ctkNetworkConnectorSharedMemory::bufferSize() const {
+    return m_BufferSize;
+}
+
+QString ctkNetworkConnectorSharedMemory::memoryKey(unsigned int port) {
+    return QString("ctkEventBus_SharedMemory_%1").arg(port);
+}
+
+void ctkNetworkConnectorSharedMemory::createClient(const QString hostName, const unsigned int port) {
+    stopClient();
+
+    if(!hostName.isEmpty() && hostName != "localhost" && hostName != "127.0.0.1" &&
+       hostName != "::1" && hostName.compare(QHostInfo::localHostName(), Qt::CaseInsensitive) != 0) {
+        qWarning("%s", tr("Shared memory connector can only reach the local host, not %1").arg(hostName).toLatin1().data());
+        return;
+    }
+
+    m_ClientPort = port;
+    m_ClientMemory = new QSharedMemory(memoryKey(port), this);
+    // the server may not be started yet, attached again when sending
+    attachClient();
+}
+
+void ctkNetworkConnectorSharedMemory::stopClient() {
+    delete m_ClientSemaphore;
+    m_ClientSemaphore = NULL;
+    delete m_ClientMemory;
+    m_ClientMemory = NULL;
+    m_ClientPort = 0;
+}
+
+bool ctkNetworkConnectorSharedMemory::attachClient() {
+    if(m_ClientMemory == NULL) {
+        return false;
+    }
+    if(m_ClientMemory->isAttached()) {
+        return true;
+    }
+    if(!m_ClientMemory->attach()) {
+        return false;
+    }
+    if(m_ClientMemory->size() < int(sizeof(ctkSharedMemoryHeader))) {
+        m_ClientMemory->detach();
+        return false;
+    }
+    if(m_ClientSemaphore == NULL) {
+        m_ClientSemaphore = new QSystemSemaphore(memoryKey(m_ClientPort) + "_semaphore", 0, QSystemSemaphore::Open);
+    }
+    return true;
+}
+
+void ctkNetworkConnectorSharedMemory::createServer(const unsigned int port) {
+    if(m_ServerMemory != NULL) {
+        if(m_Port == port) {
+            return;
+        }
+        stopServer();
+    }
+
+    QString key = memoryKey(port);
+    int size = sizeof(ctkSharedMemoryHeader) + m_BufferSize;
+    m_ServerMemory = new QSharedMemory(key, this);
+    bool created = m_ServerMemory->create(size);
+    if(!created && m_ServerMemory->error() == QSharedMemory::AlreadyExists) {
+        // segment left by a crashed server, destroyed by the last detach on Unix
+        if(m_ServerMemory->attach()) {
+            m_ServerMemory->detach();
+        }
+        created = m_ServerMemory->create(size);
+    }
+    if(!created) {
+        qWarning("%s", tr("Unable to create the shared memory %1: %2").arg(key, m_ServerMemory->errorString()).toLatin1().data());
+        delete m_ServerMemory;
+        m_ServerMemory = NULL;
+        return;
+    }
+
+    m_ServerMemory->lock();
+    ctkSharedMemoryHeader *header = ringHeader(m_ServerMemory);
+    header->magic = RING_MAGIC;
+    header->capacity = m_BufferSize;
+    header->head = 0;
+    header->tail = 0;
+    m_ServerMemory->unlock();
+
+    m_ServerSemaphore = new QSystemSemaphore(key + "_semaphore", 0, QSystemSemaphore::Create);
+    m_Port = port;
+}
+
+void ctkNetworkConnectorSharedMemory::stopServer() {
+    if(m_Reader) {
+        m_Reader->stop();
+        delete m_Reader;
+        m_Reader = NULL;
+    }
+    if(m_ServerMemory) {
+        // the attached clients attach again to the next server
+        m_ServerMemory->lock();
+        ringHeader(m_ServerMemory)->magic = 0;
+        m_ServerMemory->unlock();
+        delete m_ServerMemory;
+        m_ServerMemory = NULL;
+    }
+    delete m_ServerSemaphore;
+    m_ServerSemaphore = NULL;
+    m_ServerBuffer.clear();
+    m_Port = 0;
+}
+
+void ctkNetworkConnectorSharedMemory::startListen() {
+    if(m_ServerMemory == NULL) {
+        qWarning("%s", tr("Server can not start. Create it first, then call startListen again!!").toLatin1().data());
+        return;
+    }
+    if(m_Reader) {
+        qDebug("%s", tr("Server is already listening on port %1").arg(m_Port).toLatin1().data());
+        return;
+    }
+
+    m_Reader = new ctkSharedMemoryReader(this);
+    m_Reader->start();
+    qDebug() << "Listening for shared memory requests on port" << m_Port;
+
+    // frames may have been written before the reader was started
+    readServerData();
+}
+
+bool ctkNetworkConnectorSharedMemory::writeFrame(const QByteArray &frame) {
+    // a second attempt when the server has been restarted
+    for(int attempt = 0; attempt < 2; ++attempt) {
+        if(!attachClient()) {
+            qWarning("%s", tr("No shared memory server on port %1").arg(m_ClientPort).toLatin1().data());
+            return false;
+        }
+
+        m_ClientMemory->lock();
+        ctkSharedMemoryHeader *header = ringHeader(m_ClientMemory);
+        if(header->magic != RING_MAGIC) {
+            m_ClientMemory->unlock();
+            m_ClientMemory->detach();
+            continue;
+        }
+
+        quint32 capacity = header->capacity;
+        quint32 size = frame.size();
+        if(size > capacity - (header->head - header->tail)) {
+            m_ClientMemory->unlock();
+            qWarning("%s", tr("Shared memory buffer of port %1 is full").arg(m_ClientPort).toLatin1().data());
+            return false;
+        }
+
+        char *data = ringData(m_ClientMemory);
+        quint32 position = header->head & (capacity - 1);
+        quint32 first = qMin(size, capacity - position);
+        memcpy(data + position, frame.constData(), first);
+        memcpy(data, frame.constData() + first, size - first);
+        header->head += size;
+        m_ClientMemory->unlock();
+
+        m_ClientSemaphore->release();
+        return true;
+    }
+    qWarning("%s", tr("No shared memory server on port %1").arg(m_ClientPort).toLatin1().data());
+    return false;
+}
+
+void ctkNetworkConnectorSharedMemory::send(const QString event_id, ctkEventArgumentsList *argList) {
+    if(m_ClientMemory == NULL) {
+        qWarning("%s", tr("Client not created, call createClient before sending").toLatin1().data());
+        return;
+    }
+
+    ctkNetworkMessage request = ctkNetworkMessage::request(++m_RequestId, event_id, argList);
+    if(!request.isValid()) {
+        qWarning("%s", tr("Remote Dispatcher need to have at least one argument and arguments that are QVariantList").toLatin1().data());
+        return;
+    }
+
+    QByteArray frame;
+    ctkNetworkMessage::appendFrame(frame, request);
+    notifyReturnValue(writeFrame(frame) ? "OK" : "FAIL");
+}
+
+void ctkNetworkConnectorSharedMemory::readServerData() {
+    if(m_ServerMemory == NULL) {
+        return;
+    }
+    if(m_Reader) {
+        m_Reader->m_Scheduled.fetchAndStoreOrdered(0);
+    }
+
+    // the content of the ring buffer is copied at once, the clients are not blocked while it is notified
+    m_ServerMemory->lock();
+    ctkSharedMemoryHeader *header = ringHeader(m_ServerMemory);
+    const char *data = ringData(m_ServerMemory);
+    quint32 capacity = header->capacity;
+    quint32 available = header->head - header->tail;
+    if(available > 0) {
+        quint32 position = header->tail & (capacity - 1);
+        quint32 first = qMin(available, capacity - position);
+        m_ServerBuffer.append(data + position, first);
+        m_ServerBuffer.append(data, available - first);
+        header->tail += available;
+    }
+    m_ServerMemory->unlock();
+
+    int offset = 0;
+    ctkNetworkMessage request;
+    ctkNetworkMessage::FrameStatus status;
+    while((status = ctkNetworkMessage::takeFrame(m_ServerBuffer, offset, request)) == ctkNetworkMessage::FrameTaken) {
+        if(request.type() == ctkNetworkMessage::Request) {
+            notifyRequest(request);
+        }
+    }
+    if(status == ctkNetworkMessage::FrameError) {
+        qWarning("%s", tr("Invalid data in the shared memory of port %1").arg(m_Port).toLatin1().data());
+        m_ServerBuffer.clear();
+        return;
+    }
+    m_ServerBuffer.remove(0, offset);
+}
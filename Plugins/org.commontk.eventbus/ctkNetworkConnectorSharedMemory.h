@@ -0,0 +1,117 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+#ifndef CTKNETWORKCONNECTORSHAREDMEMORY_H
+#define CTKNETWORKCONNECTORSHAREDMEMORY_H
+
+// include list
+#include "ctkNetworkConnector.h"
+
+class QSharedMemory;
+class QSystemSemaphore;
+
+namespace ctkEventBus {
+
+class ctkSharedMemoryReader;
+
+/**
+ Class name: ctkNetworkConnectorSharedMemory
+ This class is the implementation class for client/server objects that run on the same host and
+ exchange the events through a ring buffer in shared memory. The port identifies the shared memory
+ segment, the host name of the client must be the local host.
+ The clients write length prefixed ctkNetworkMessage frames into the ring buffer of the server
+ and release a system semaphore; a thread of the server waits on the semaphore and the frames are
+ notified in the thread of the connector. There is no reply: the client notifies
+ ctk/local/eventBus/remoteCommunicationDone when the event is written into the buffer, and
+ ctk/local/eventBus/remoteCommunicationFailed when the server is not running or the buffer is full.
+ */
+class org_commontk_eventbus_EXPORT ctkNetworkConnectorSharedMemory : public ctkNetworkConnector {
+    Q_OBJECT
+
+public:
+    /// object constructor.
+    ctkNetworkConnectorSharedMemory();
+
+    /// object destructor.
+    /*virtual*/ ~ctkNetworkConnectorSharedMemory();
+
+    /// create the unique instance of the client.
+    /*virtual*/ void createClient(const QString hostName, const unsigned int port);
+
+    /// create the unique instance of the server.
+    /*virtual*/ void createServer(const unsigned int port);
+
+    /// Start the server.
+    /*virtual*/ void startListen();
+
+    //retrieve an instance of the object
+    /*virtual*/ ctkNetworkConnector *clone();
+
+    /// register all the signals and slots
+    /*virtual*/ void initializeForEventBus();
+
+    /// Size of the ring buffer created by the server, rounded up to a power of two, 4 MB by default.
+    /** It has to be set before createServer(). */
+    void setBufferSize(int size);
+    int bufferSize() const;
+
+public Q_SLOTS:
+    /// Allow to send a network request.
+    /** The arguments must be QVariantList, the first item of the first one is the topic notified on the server. */
+    /*virtual*/ void send(const QString event_id, ctkEventArgumentsList *argList);
+
+private Q_SLOTS:
+    /// read the frames written by the clients into the ring buffer.
+    void readServerData();
+
+private:
+    /// return the key of the shared memory for the given port.
+    static QString memoryKey(unsigned int port);
+
+    /// attach the client to the shared memory of the server, if not done yet.
+    bool attachClient();
+
+    /// write a frame into the ring buffer of the server and wake up its reader.
+    bool writeFrame(const QByteArray &frame);
+
+    /// stop and destroy the server instance.
+    void stopServer();
+
+    /// destroy the client instance.
+    void stopClient();
+
+    QSharedMemory *m_ServerMemory; ///< ring buffer of the server
+    QSystemSemaphore *m_ServerSemaphore; ///< released by the clients for each frame written
+    ctkSharedMemoryReader *m_Reader; ///< thread waiting on the semaphore
+    unsigned int m_Port; ///< port identifying the shared memory of the server
+    QByteArray m_ServerBuffer; ///< frames read from the ring buffer
+
+    QSharedMemory *m_ClientMemory; ///< ring buffer of the server the client writes to
+    QSystemSemaphore *m_ClientSemaphore; ///< semaphore of the server
+    unsigned int m_ClientPort; ///< port of the server
+    int m_BufferSize; ///< size of the ring buffer created by the server
+    int m_RequestId; ///< id of the last request sent by the client
+
+    friend class ctkSharedMemoryReader;
+};
+
+} //namespace ctkEventBus
+
+#endif // CTKNETWORKCONNECTORSHAREDMEMORY_H
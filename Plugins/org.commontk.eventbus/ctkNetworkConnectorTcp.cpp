@@ -0,0 +1,285 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkNetworkConnectorTcp.h"
+#include "ctkEventBusManager.h"
+
+#include <service/event/ctkEvent.h>
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+using namespace ctkEventBus;
+
+ctkNetworkConnectorTcp::ctkNetworkConnectorTcp() : ctkNetworkConnector(), m_Server(NULL), m_Port(0), m_Client(NULL), m_MaximumPendingRequests(32), m_Coalescing(true), m_FlushScheduled(false), m_RequestId(0) {
+
+    m_Protocol = "TCP";
+}
+
+void ctkNetworkConnectorTcp::initializeForEventBus() {
+    ctkRegisterRemoteSignal("ctk/remote/eventBus/comunication/send/tcp", this, "remoteCommunication(const QString, ctkEventArgumentsList *)");
+    ctkRegisterRemoteCallback("ctk/remote/eventBus/comunication/send/tcp", this, "send(const QString, ctkEventArgumentsList *)");
+}
+
+ctkNetworkConnectorTcp::~ctkNetworkConnectorTcp() {
+    stopClient();
+    stopServer();
+}
+
+//retrieve an instance of the object
+ctkNetworkConnector *ctkNetworkConnectorTcp::clone() {
+    ctkNetworkConnectorTcp *copy = new ctkNetworkConnectorTcp();
+    copy->m_MaximumPendingRequests = m_MaximumPendingRequests;
+    copy->m_Coalescing = m_Coalescing;
+    return copy;
+}
+
+void ctkNetworkConnectorTcp::setCoalescing(bool coalescing) {
+    m_Coalescing = coalescing;
+    if(!m_Coalescing) {
+        flush();
+    }
+}
+
+bool ctkNetworkConnectorTcp::coalescing() const {
+    return m_Coalescing;
+}
+
+void ctkNetworkConnectorTcp::setMaximumPendingRequests(int maximum) {
+    m_MaximumPendingRequests = qMax(0, maximum);
+    flush();
+}
+
+int ctkNetworkConnectorTcp::maximumPendingRequests() const {
+    return m_MaximumPendingRequests;
+}
+
+int ctkNetworkConnectorTcp::pendingRequests() const {
+    return m_PendingRequests.size();
+}
+
+void ctkNetworkConnectorTcp::createClient(const QString hostName, const unsigned int port) {
+    stopClient();
+
+    m_Client = new QTcpSocket(this);
+    connect(m_Client, SIGNAL(connected()), this, SLOT(flush()));
+    connect(m_Client, SIGNAL(readyRead()), this, SLOT(readClientData()));
+    connect(m_Client, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(processClientError(QAbstractSocket::SocketError)));
+    m_Client->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_Client->connectToHost(hostName, port);
+}
+
+void ctkNetworkConnectorTcp::stopClient() {
+    if(m_Client) {
+        m_Client->disconnect(this);
+        m_Client->abort();
+        delete m_Client;
+        m_Client = NULL;
+    }
+    m_ClientBuffer.clear();
+    m_Queue.clear();
+    m_PendingRequests.clear();
+}
+
+void ctkNetworkConnectorTcp::createServer(const unsigned int port) {
+    if(m_Server != NULL) {
+        if(m_Port == port) {
+            return;
+        }
+        stopServer();
+    }
+    m_Server = new QTcpServer(this);
+    m_Port = port;
+    connect(m_Server, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+}
+
+void ctkNetworkConnectorTcp::stopServer() {
+    foreach(QTcpSocket *connection, m_ServerBuffers.keys()) {
+        connection->disconnect(this);
+        connection->abort();
+        delete connection;
+    }
+    m_ServerBuffers.clear();
+    if(m_Server) {
+        delete m_Server;
+        m_Server = NULL;
+    }
+    m_Port = 0;
+}
+
+void ctkNetworkConnectorTcp::startListen() {
+    if(m_Server == NULL) {
+        qWarning("%s", tr("Server can not start. Create it first, then call startListen again!!").toLatin1().data());
+        return;
+    }
+    if(m_Server->isListening()) {
+        qDebug("%s", tr("Server is already listening on port %1").arg(m_Port).toLatin1().data());
+        return;
+    }
+
+    if(m_Server->listen(QHostAddress::Any, m_Port)) {
+        qDebug() << "Listening for TCP requests on port" << m_Port;
+    } else {
+        qDebug() << "Error listening port" << m_Port << m_Server->errorString();
+    }
+}
+
+void ctkNetworkConnectorTcp::send(const QString event_id, ctkEventArgumentsList *argList) {
+    if(m_Client == NULL) {
+        qWarning("%s", tr("Client not created, call createClient before sending").toLatin1().data());
+        return;
+    }
+
+    ctkNetworkMessage request = ctkNetworkMessage::request(++m_RequestId, event_id, argList);
+    if(!request.isValid()) {
+        qWarning("%s", tr("Remote Dispatcher need to have at least one argument and arguments that are QVariantList").toLatin1().data());
+        return;
+    }
+    m_Queue.append(request);
+
+    if(!m_Coalescing) {
+        flush();
+    } else if(!m_FlushScheduled) {
+        // the events sent until the control returns to the event loop are written at once
+        m_FlushScheduled = true;
+        QTimer::singleShot(0, this, SLOT(flush()));
+    }
+}
+
+void ctkNetworkConnectorTcp::flush() {
+    m_FlushScheduled = false;
+    if(m_Client == NULL || m_Client->state() != QAbstractSocket::ConnectedState) {
+        // flushed again when connected
+        return;
+    }
+
+    QByteArray data;
+    while(!m_Queue.isEmpty() &&
+          (m_MaximumPendingRequests == 0 || m_PendingRequests.size() < m_MaximumPendingRequests)) {
+        ctkNetworkMessage request = m_Queue.takeFirst();
+        m_PendingRequests.insert(request.requestId());
+        ctkNetworkMessage::appendFrame(data, request);
+    }
+    if(!data.isEmpty()) {
+        m_Client->write(data);
+    }
+}
+
+void ctkNetworkConnectorTcp::readClientData() {
+    m_ClientBuffer.append(m_Client->readAll());
+
+    int offset = 0;
+    ctkNetworkMessage reply;
+    ctkNetworkMessage::FrameStatus status;
+    while((status = ctkNetworkMessage::takeFrame(m_ClientBuffer, offset, reply)) == ctkNetworkMessage::FrameTaken) {
+        if(reply.type() == ctkNetworkMessage::Reply && m_PendingRequests.remove(reply.requestId())) {
+            processReturnValue(reply.requestId(), reply.status());
+        }
+    }
+
+    if(status == ctkNetworkMessage::FrameError) {
+        qWarning("%s", tr("Invalid reply received from %1").arg(m_Client->peerName()).toLatin1().data());
+        m_Client->abort();
+        m_ClientBuffer.clear();
+        failRequests();
+        return;
+    }
+    m_ClientBuffer.remove(0, offset);
+
+    // replies make room for the requests waiting in the queue
+    if(!m_Queue.isEmpty()) {
+        flush();
+    }
+}
+
+void ctkNetworkConnectorTcp::processClientError(QAbstractSocket::SocketError error) {
+    Q_UNUSED(error);
+    // Log the error.
+    qDebug("%s", tr("Connection error %1").arg(m_Client->errorString()).toLatin1().data());
+    failRequests();
+}
+
+void ctkNetworkConnectorTcp::failRequests() {
+    int count = m_PendingRequests.size() + m_Queue.size();
+    m_PendingRequests.clear();
+    m_Queue.clear();
+    for(int i = 0; i < count; ++i) {
+        ctkEventBusManager::instance()->notifyEvent("ctk/local/eventBus/remoteCommunicationFailed", ctkEventTypeLocal);
+    }
+}
+
+void ctkNetworkConnectorTcp::acceptConnection() {
+    while(m_Server->hasPendingConnections()) {
+        QTcpSocket *connection = m_Server->nextPendingConnection();
+        connection->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(connection, SIGNAL(readyRead()), this, SLOT(readServerData()));
+        connect(connection, SIGNAL(disconnected()), this, SLOT(removeServerConnection()));
+        m_ServerBuffers.insert(connection, QByteArray());
+    }
+}
+
+void ctkNetworkConnectorTcp::readServerData() {
+    QTcpSocket *connection = qobject_cast<QTcpSocket *>(sender());
+    if(connection == NULL || !m_ServerBuffers.contains(connection)) {
+        return;
+    }
+    // the buffer is copied, the hash may change while the events are notified
+    QByteArray buffer = m_ServerBuffers.value(connection) + connection->readAll();
+
+    int offset = 0;
+    QByteArray replies;
+    ctkNetworkMessage request;
+    ctkNetworkMessage::FrameStatus status;
+    while((status = ctkNetworkMessage::takeFrame(buffer, offset, request)) == ctkNetworkMessage::FrameTaken) {
+        if(request.type() == ctkNetworkMessage::Request) {
+            ctkNetworkMessage::appendFrame(replies, ctkNetworkMessage::reply(request.requestId(), notifyRequest(request)));
+        }
+    }
+
+    if(!m_ServerBuffers.contains(connection)) {
+        return;
+    }
+    if(!replies.isEmpty()) {
+        connection->write(replies);
+    }
+    if(status == ctkNetworkMessage::FrameError) {
+        qWarning("%s", tr("Invalid request received from %1, closing the connection").arg(connection->peerAddress().toString()).toLatin1().data());
+        m_ServerBuffers.remove(connection);
+        connection->disconnect(this);
+        connection->abort();
+        connection->deleteLater();
+        return;
+    }
+    m_ServerBuffers[connection] = buffer.mid(offset);
+}
+
+void ctkNetworkConnectorTcp::removeServerConnection() {
+    QTcpSocket *connection = qobject_cast<QTcpSocket *>(sender());
+    if(connection && m_ServerBuffers.remove(connection)) {
+        connection->deleteLater();
+    }
+}
+
+void ctkNetworkConnectorTcp::processReturnValue( int requestId, QVariant value ) {
+    Q_UNUSED(requestId);
+    notifyReturnValue(value.toString());
+}
@@ -0,0 +1,134 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+#ifndef CTKNETWORKCONNECTORTCP_H
+#define CTKNETWORKCONNECTORTCP_H
+
+// include list
+#include "ctkNetworkConnector.h"
+#include "ctkNetworkMessage.h"
+
+#include <QAbstractSocket>
+#include <QSet>
+
+class QTcpServer;
+class QTcpSocket;
+
+namespace ctkEventBus {
+
+/**
+ Class name: ctkNetworkConnectorTcp
+ This class is the implementation class for client/server objects that works over a TCP connection
+ with length prefixed ctkNetworkMessage frames. The client does not wait for the reply of a request
+ before sending the next one: up to maximumPendingRequests() requests are in flight, matched with
+ their replies by id. When coalescing is enabled (the default), the events sent while the event loop
+ is busy are written to the socket at once, and the server writes at once the replies of the requests
+ it read together.
+ */
+class org_commontk_eventbus_EXPORT ctkNetworkConnectorTcp : public ctkNetworkConnector {
+    Q_OBJECT
+
+public:
+    /// object constructor.
+    ctkNetworkConnectorTcp();
+
+    /// object destructor.
+    /*virtual*/ ~ctkNetworkConnectorTcp();
+
+    /// create the unique instance of the client.
+    /*virtual*/ void createClient(const QString hostName, const unsigned int port);
+
+    /// create the unique instance of the server.
+    /*virtual*/ void createServer(const unsigned int port);
+
+    /// Start the server.
+    /*virtual*/ void startListen();
+
+    //retrieve an instance of the object
+    /*virtual*/ ctkNetworkConnector *clone();
+
+    /// register all the signals and slots
+    /*virtual*/ void initializeForEventBus();
+
+    /// Write the events sent in the same event loop iteration at once, true by default.
+    void setCoalescing(bool coalescing);
+    bool coalescing() const;
+
+    /// Maximum number of requests waiting for their reply, 32 by default, 0 for no limit.
+    void setMaximumPendingRequests(int maximum);
+    int maximumPendingRequests() const;
+
+    /// Number of requests sent and waiting for their reply.
+    int pendingRequests() const;
+
+public Q_SLOTS:
+    /// Allow to send a network request.
+    /** The arguments must be QVariantList, the first item of the first one is the topic notified on the server. */
+    /*virtual*/ void send(const QString event_id, ctkEventArgumentsList *argList);
+
+private Q_SLOTS:
+    /// callback for the client which retrieve the variable from the server
+    virtual void processReturnValue( int requestId, QVariant value );
+
+    /// write the queued requests.
+    void flush();
+
+    /// read the replies received by the client.
+    void readClientData();
+
+    /// callback which manage a fault in the connection of the client
+    void processClientError(QAbstractSocket::SocketError error);
+
+    /// accept the connections of the clients.
+    void acceptConnection();
+
+    /// read the requests received by the server.
+    void readServerData();
+
+    /// forget a connection closed by a client.
+    void removeServerConnection();
+
+private:
+    /// stop and destroy the server instance.
+    void stopServer();
+
+    /// destroy the client instance.
+    void stopClient();
+
+    /// notify the failure of the pending and queued requests.
+    void failRequests();
+
+    QTcpServer *m_Server; ///< server accepting the connections of the clients
+    unsigned int m_Port; ///< port the server listens on
+    QHash<QTcpSocket *, QByteArray> m_ServerBuffers; ///< data received and not decoded yet for each connection of the server
+
+    QTcpSocket *m_Client; ///< connection of the client
+    QByteArray m_ClientBuffer; ///< data received by the client and not decoded yet
+    QList<ctkNetworkMessage> m_Queue; ///< requests not written yet
+    QSet<qint32> m_PendingRequests; ///< ids of the requests waiting for their reply
+    int m_MaximumPendingRequests; ///< maximum number of requests in flight
+    bool m_Coalescing; ///< write the queued requests at once
+    bool m_FlushScheduled; ///< a flush() is scheduled
+    int m_RequestId; ///< id of the last request sent by the client
+};
+
+} //namespace ctkEventBus
+
+#endif // CTKNETWORKCONNECTORTCP_H
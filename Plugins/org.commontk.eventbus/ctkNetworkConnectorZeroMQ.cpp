@@ -10,60 +10,389 @@
  */
 
 #include "ctkNetworkConnectorZeroMQ.h"
+#include "ctkNetworkMessage.h"
 #include "ctkEventBusManager.h"
 
 #include <service/event/ctkEvent.h>
 
+#include <QSocketNotifier>
+
+#include <zmq.h>
+
+#include <cstring>
+
+// 0MQ 2.x names of the DEALER and ROUTER sockets.
+#ifndef ZMQ_DEALER
+#define ZMQ_DEALER ZMQ_XREQ
+#endif
+#ifndef ZMQ_ROUTER
+#define ZMQ_ROUTER ZMQ_XREP
+#endif
+
 using namespace ctkEventBus;
 
-ctkNetworkConnectorZeroMQ::ctkNetworkConnectorZeroMQ() : ctkNetworkConnector() {
+namespace {
+
+#if defined(_WIN32)
+typedef SOCKET ctkZmqFd;
+#else
+typedef int ctkZmqFd;
+#endif
+
+#if ZMQ_VERSION_MAJOR >= 3
+typedef int ctkZmqMore;
+typedef int ctkZmqEvents;
+const int zmqNonBlocking = ZMQ_DONTWAIT;
+#else
+typedef qint64 ctkZmqMore;
+typedef quint32 ctkZmqEvents;
+const int zmqNonBlocking = ZMQ_NOBLOCK;
+#endif
+
+int zmqSend(void *socket, zmq_msg_t *msg, int flags) {
+#if ZMQ_VERSION_MAJOR >= 3
+    return zmq_sendmsg(socket, msg, flags);
+#else
+    return zmq_send(socket, msg, flags);
+#endif
+}
+
+int zmqReceive(void *socket, zmq_msg_t *msg, int flags) {
+#if ZMQ_VERSION_MAJOR >= 3
+    return zmq_recvmsg(socket, msg, flags);
+#else
+    return zmq_recv(socket, msg, flags);
+#endif
+}
+
+/// send a multipart message.
+bool sendFrames(void *socket, const QList<QByteArray> &frames) {
+    for(int i = 0; i < frames.size(); ++i) {
+        const QByteArray &frame = frames.at(i);
+        zmq_msg_t msg;
+        if(zmq_msg_init_size(&msg, frame.size()) != 0) {
+            return false;
+        }
+        memcpy(zmq_msg_data(&msg), frame.constData(), frame.size());
+        int rc = zmqSend(socket, &msg, i < frames.size() - 1 ? ZMQ_SNDMORE : 0);
+        zmq_msg_close(&msg);
+        if(rc < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// receive a multipart message without waiting, return false if there is none.
+bool receiveFrames(void *socket, QList<QByteArray> &frames) {
+    frames.clear();
+    while(true) {
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        if(zmqReceive(socket, &msg, zmqNonBlocking) < 0) {
+            zmq_msg_close(&msg);
+            return !frames.isEmpty();
+        }
+        frames.append(QByteArray(static_cast<const char *>(zmq_msg_data(&msg)), static_cast<int>(zmq_msg_size(&msg))));
+        zmq_msg_close(&msg);
+
+        ctkZmqMore more = 0;
+        size_t size = sizeof(more);
+        if(zmq_getsockopt(socket, ZMQ_RCVMORE, &more, &size) != 0 || !more) {
+            return true;
+        }
+    }
+}
+
+/// return true if a message can be read from the socket.
+/** The file descriptor of a 0MQ socket is edge triggered, the events have to be checked until there is no more input. */
+bool hasInput(void *socket) {
+    ctkZmqEvents events = 0;
+    size_t size = sizeof(events);
+    return zmq_getsockopt(socket, ZMQ_EVENTS, &events, &size) == 0 && (events & ZMQ_POLLIN);
+}
+
+/// create a socket notifier on the file descriptor of the 0MQ socket.
+QSocketNotifier *createNotifier(void *socket, QObject *receiver, const char *member) {
+    ctkZmqFd fd;
+    size_t size = sizeof(fd);
+    if(zmq_getsockopt(socket, ZMQ_FD, &fd, &size) != 0) {
+        return NULL;
+    }
+    QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Read, receiver);
+    QObject::connect(notifier, SIGNAL(activated(int)), receiver, member);
+    return notifier;
+}
+
+/// close a socket without waiting for the pending messages.
+void closeSocket(void *socket) {
+    int linger = 0;
+    zmq_setsockopt(socket, ZMQ_LINGER, &linger, sizeof(linger));
+    zmq_close(socket);
+}
+
+QString lastError() {
+    return QString::fromLocal8Bit(zmq_strerror(zmq_errno()));
+}
+
+}
+
+ctkNetworkConnectorZeroMQ::ctkNetworkConnectorZeroMQ(Pattern pattern) : ctkNetworkConnector(), m_Pattern(pattern), m_Context(NULL), m_Server(NULL), m_Client(NULL), m_ServerNotifier(NULL), m_ClientNotifier(NULL), m_Port(0), m_RequestId(0) {
 
-    m_Protocol = "SOCKET";
+    m_Protocol = "ZEROMQ";
 }
 
 void ctkNetworkConnectorZeroMQ::initializeForEventBus() {
-    //ctkRegisterRemoteSignal("ctk/remote/eventBus/comunication/??????????", this, "remoteCommunication(const QString, ctkEventArgumentsList *)");
-    //ctkRegisterRemoteCallback("ctk/remote/eventBus/comunication/????????????", this, "send(const QString, ctkEventArgumentsList *)");
+    ctkRegisterRemoteSignal("ctk/remote/eventBus/comunication/send/zeromq", this, "remoteCommunication(const QString, ctkEventArgumentsList *)");
+    ctkRegisterRemoteCallback("ctk/remote/eventBus/comunication/send/zeromq", this, "send(const QString, ctkEventArgumentsList *)");
 }
 
 ctkNetworkConnectorZeroMQ::~ctkNetworkConnectorZeroMQ() {
+    stopClient();
+    stopServer();
+    if(m_Context) {
+        zmq_term(m_Context);
+        m_Context = NULL;
     }
+}
 
 //retrieve an instance of the object
 ctkNetworkConnector *ctkNetworkConnectorZeroMQ::clone() {
-    ctkNetworkConnectorZeroMQ *copy = new ctkNetworkConnectorZeroMQ();
+    ctkNetworkConnectorZeroMQ *copy = new ctkNetworkConnectorZeroMQ(m_Pattern);
+    copy->m_Subscriptions = m_Subscriptions;
     return copy;
 }
 
+ctkNetworkConnectorZeroMQ::Pattern ctkNetworkConnectorZeroMQ::pattern() const {
+    return m_Pattern;
+}
+
+void ctkNetworkConnectorZeroMQ::subscribeTopic(const QString &prefix) {
+    if(m_Subscriptions.contains(prefix)) {
+        return;
+    }
+    m_Subscriptions.append(prefix);
+    if(m_Server && m_Pattern == PublishSubscribe) {
+        QByteArray filter = prefix.toUtf8();
+        if(m_Subscriptions.size() == 1) {
+            // the server was receiving every topic
+            zmq_setsockopt(m_Server, ZMQ_UNSUBSCRIBE, "", 0);
+        }
+        zmq_setsockopt(m_Server, ZMQ_SUBSCRIBE, filter.constData(), filter.size());
+    }
+}
+
+void ctkNetworkConnectorZeroMQ::unsubscribeTopic(const QString &prefix) {
+    if(!m_Subscriptions.removeOne(prefix)) {
+        return;
+    }
+    if(m_Server && m_Pattern == PublishSubscribe) {
+        QByteArray filter = prefix.toUtf8();
+        zmq_setsockopt(m_Server, ZMQ_UNSUBSCRIBE, filter.constData(), filter.size());
+        if(m_Subscriptions.isEmpty()) {
+            zmq_setsockopt(m_Server, ZMQ_SUBSCRIBE, "", 0);
+        }
+    }
+}
+
+void *ctkNetworkConnectorZeroMQ::context() {
+    if(m_Context == NULL) {
+        m_Context = zmq_init(1);
+        if(m_Context == NULL) {
+            qWarning("%s", tr("Unable to create the 0MQ context: %1").arg(lastError()).toLatin1().data());
+        }
+    }
+    return m_Context;
+}
+
 void ctkNetworkConnectorZeroMQ::createClient(const QString hostName, const unsigned int port) {
-    Q_UNUSED(hostName);
-    Q_UNUSED(port);
-    //@@ TODO
+    stopClient();
+    if(context() == NULL) {
+        return;
+    }
+
+    m_Client = zmq_socket(m_Context, m_Pattern == RequestReply ? ZMQ_DEALER : ZMQ_PUB);
+    if(m_Client == NULL) {
+        qWarning("%s", tr("Unable to create the 0MQ client: %1").arg(lastError()).toLatin1().data());
+        return;
+    }
+
+    QByteArray endpoint = QString("tcp://%1:%2").arg(hostName).arg(port).toLatin1();
+    if(zmq_connect(m_Client, endpoint.constData()) != 0) {
+        qWarning("%s", tr("Unable to connect to %1: %2").arg(endpoint.constData(), lastError()).toLatin1().data());
+        stopClient();
+        return;
+    }
+
+    if(m_Pattern == RequestReply) {
+        m_ClientNotifier = createNotifier(m_Client, this, SLOT(readClientMessages()));
+    }
+}
+
+void ctkNetworkConnectorZeroMQ::stopClient() {
+    delete m_ClientNotifier;
+    m_ClientNotifier = NULL;
+    if(m_Client) {
+        closeSocket(m_Client);
+        m_Client = NULL;
+    }
 }
 
 void ctkNetworkConnectorZeroMQ::createServer(const unsigned int port) {
-   Q_UNUSED(port);
-   //@@ TODO
+    if(m_Server != NULL) {
+        if(m_Port == port) {
+            return;
+        }
+        stopServer();
+    }
+    if(context() == NULL) {
+        return;
+    }
+
+    m_Server = zmq_socket(m_Context, m_Pattern == RequestReply ? ZMQ_ROUTER : ZMQ_SUB);
+    if(m_Server == NULL) {
+        qWarning("%s", tr("Unable to create the 0MQ server: %1").arg(lastError()).toLatin1().data());
+        return;
+    }
+    m_Port = port;
+
+    if(m_Pattern == PublishSubscribe) {
+        // the topic is the first frame, so the socket drops the messages of the other topics
+        if(m_Subscriptions.isEmpty()) {
+            zmq_setsockopt(m_Server, ZMQ_SUBSCRIBE, "", 0);
+        }
+        foreach(QString prefix, m_Subscriptions) {
+            QByteArray filter = prefix.toUtf8();
+            zmq_setsockopt(m_Server, ZMQ_SUBSCRIBE, filter.constData(), filter.size());
+        }
+    }
 }
 
 void ctkNetworkConnectorZeroMQ::stopServer() {
-    //@@ TODO
+    delete m_ServerNotifier;
+    m_ServerNotifier = NULL;
+    if(m_Server) {
+        closeSocket(m_Server);
+        m_Server = NULL;
+    }
+    m_Port = 0;
 }
 
 
 void ctkNetworkConnectorZeroMQ::startListen() {
-    //@@ TODO
+    if(m_Server == NULL) {
+        qWarning("%s", tr("Server can not start. Create it first, then call startListen again!!").toLatin1().data());
+        return;
+    }
+    if(m_ServerNotifier) {
+        qDebug("%s", tr("Server is already listening on port %1").arg(m_Port).toLatin1().data());
+        return;
+    }
+
+    QByteArray endpoint = QString("tcp://*:%1").arg(m_Port).toLatin1();
+    if(zmq_bind(m_Server, endpoint.constData()) != 0) {
+        qDebug() << "Error listening port" << m_Port << lastError();
+        return;
+    }
+    m_ServerNotifier = createNotifier(m_Server, this, SLOT(readServerMessages()));
+    qDebug() << "Listening for 0MQ messages on port" << m_Port;
+
+    // messages may have been queued before the notifier was created
+    readServerMessages();
 }
 
 void ctkNetworkConnectorZeroMQ::send(const QString event_id, ctkEventArgumentsList *argList) {
-	Q_UNUSED(event_id);
-	Q_UNUSED(argList);
-    //@@ TODO
+    if(m_Client == NULL) {
+        qWarning("%s", tr("Client not created, call createClient before sending").toLatin1().data());
+        return;
+    }
+
+    ctkNetworkMessage request = ctkNetworkMessage::request(++m_RequestId, event_id, argList);
+    if(!request.isValid()) {
+        qWarning("%s", tr("Remote Dispatcher need to have at least one argument and arguments that are QVariantList").toLatin1().data());
+        return;
+    }
+
+    // the topic is the first frame for the filtering of the SUB socket
+    QList<QByteArray> frames;
+    frames.append(request.topic().toUtf8());
+    frames.append(request.encode());
+    if(!sendFrames(m_Client, frames)) {
+        qWarning("%s", tr("Unable to send %1: %2").arg(event_id, lastError()).toLatin1().data());
+        ctkEventBusManager::instance()->notifyEvent("ctk/local/eventBus/remoteCommunicationFailed", ctkEventTypeLocal);
+        return;
+    }
+
+    // sending may consume the read notification of the edge triggered descriptor
+    if(m_ClientNotifier) {
+        readClientMessages();
+    }
+}
+
+void ctkNetworkConnectorZeroMQ::readServerMessages() {
+    if(m_Server == NULL) {
+        return;
+    }
+    if(m_ServerNotifier) {
+        m_ServerNotifier->setEnabled(false);
+    }
+
+    QList<QByteArray> frames;
+    while(m_Server && hasInput(m_Server) && receiveFrames(m_Server, frames)) {
+        if(m_Pattern == RequestReply) {
+            // identity of the client, topic, payload
+            if(frames.size() == 3) {
+                processRequest(frames.at(0), frames.at(2));
+            }
+        } else if(frames.size() == 2) {
+            processRequest(QByteArray(), frames.at(1));
+        }
+    }
+
+    if(m_ServerNotifier) {
+        m_ServerNotifier->setEnabled(true);
+    }
 }
 
+void ctkNetworkConnectorZeroMQ::processRequest(const QByteArray &identity, const QByteArray &payload) {
+    ctkNetworkMessage request = ctkNetworkMessage::decode(payload);
+    QString status("FAIL");
+    if(!request.isValid() || request.type() != ctkNetworkMessage::Request) {
+        qWarning("%s", tr("Invalid 0MQ message received").toLatin1().data());
+    } else {
+        status = notifyRequest(request);
+    }
+
+    if(!identity.isEmpty() && m_Server) {
+        QList<QByteArray> frames;
+        frames.append(identity);
+        frames.append(ctkNetworkMessage::reply(request.requestId(), status).encode());
+        sendFrames(m_Server, frames);
+    }
+}
+
+void ctkNetworkConnectorZeroMQ::readClientMessages() {
+    if(m_Client == NULL) {
+        return;
+    }
+    if(m_ClientNotifier) {
+        m_ClientNotifier->setEnabled(false);
+    }
+
+    QList<QByteArray> frames;
+    while(m_Client && hasInput(m_Client) && receiveFrames(m_Client, frames)) {
+        ctkNetworkMessage reply = ctkNetworkMessage::decode(frames.back());
+        if(reply.isValid() && reply.type() == ctkNetworkMessage::Reply) {
+            processReturnValue(reply.requestId(), reply.status());
+        }
+    }
+
+    if(m_ClientNotifier) {
+        m_ClientNotifier->setEnabled(true);
+    }
+}
 
 void ctkNetworkConnectorZeroMQ::processReturnValue( int requestId, QVariant value ) {
-	Q_UNUSED(requestId);
-	Q_UNUSED(value);
-    //@@ TODO
+    Q_UNUSED(requestId);
+    notifyReturnValue(value.toString());
 }
@@ -15,22 +15,38 @@
 // include list
 #include "ctkNetworkConnector.h"
 
+#include <QStringList>
+
+class QSocketNotifier;
+
 namespace ctkEventBus {
 
 /**
  Class name: ctkNetworkConnectorZeroMQ
  This class is the implementation class for client/server objects that works over network
- with xml-rpc protocol. The server side part also create a new ID named REGISTER_SERVER_METHODS_XXX
- (where the XXX is the port on which run the server) that allows you to register your own remote
- callbacks. The library used is qxmlrpc.
+ with the 0MQ library. Each message is made of two frames: the topic of the local event to notify
+ on the server and the arguments list encoded with QDataStream.
+ Two patterns are available:
+ - RequestReply (default): the client is a DEALER socket and the server a ROUTER socket. The server
+   answers each request, and the client notifies ctk/local/eventBus/remoteCommunicationDone or
+   ctk/local/eventBus/remoteCommunicationFailed as the xml-rpc connector does.
+ - PublishSubscribe: the clients are PUB sockets and the server a SUB socket. There is no answer,
+   and the server only receives the topics starting with one of the prefixes given to subscribeTopic()
+   (all the topics if none is given), the filtering is done by the 0MQ socket.
  */
 class org_commontk_eventbus_EXPORT ctkNetworkConnectorZeroMQ : public ctkNetworkConnector {
     Q_OBJECT
 
 
 public:
+    /// messaging pattern used between the client and the server.
+    enum Pattern {
+        RequestReply,
+        PublishSubscribe
+    };
+
     /// object constructor.
-    ctkNetworkConnectorZeroMQ();
+    ctkNetworkConnectorZeroMQ(Pattern pattern = RequestReply);
 
     /// object destructor.
     /*virtual*/ ~ctkNetworkConnectorZeroMQ();
@@ -50,27 +66,52 @@ public:
     /// register all the signals and slots
     /*virtual*/ void initializeForEventBus();
 
+    /// Return the messaging pattern.
+    Pattern pattern() const;
+
+    /// Receive on the server the topics starting with prefix (PublishSubscribe pattern only).
+    void subscribeTopic(const QString &prefix);
+
+    /// Stop receiving the topics starting with prefix (PublishSubscribe pattern only).
+    void unsubscribeTopic(const QString &prefix);
+
+public Q_SLOTS:
     /// Allow to send a network request.
-    /** Contains the conversion between maf datatypes and qxmlrpc datatype based both on QVariant. */
+    /** The arguments must be QVariantList, the first item of the first one is the topic notified on the server. */
     /*virtual*/ void send(const QString event_id, ctkEventArgumentsList *argList);
 
 private Q_SLOTS:
     /// callback for the client which retrieve the variable from the server
     virtual void processReturnValue( int requestId, QVariant value );
 
-    //// here goes slots which handle the connection
+    /// read the messages received by the server socket.
+    void readServerMessages();
+
+    /// read the answers received by the client socket.
+    void readClientMessages();
 
-    
-protected:
-    //here goes zeromq vars
-    
 private:
-    //here ges function for zeromq connection
-    
+    /// create the 0MQ context if needed.
+    void *context();
+
     /// stop and destroy the server instance.
     void stopServer();
 
-    
+    /// destroy the client instance.
+    void stopClient();
+
+    /// process a request received by the server; identity is empty for the PublishSubscribe pattern.
+    void processRequest(const QByteArray &identity, const QByteArray &payload);
+
+    Pattern m_Pattern; ///< messaging pattern
+    void *m_Context; ///< 0MQ context shared by the client and the server sockets
+    void *m_Server; ///< ROUTER or SUB socket
+    void *m_Client; ///< DEALER or PUB socket
+    QSocketNotifier *m_ServerNotifier; ///< notifies the messages received by the server
+    QSocketNotifier *m_ClientNotifier; ///< notifies the answers received by the client
+    unsigned int m_Port; ///< port the server listens on
+    QStringList m_Subscriptions; ///< topic prefixes received by the SUB socket
+    int m_RequestId; ///< id of the last request sent by the client
 };
 
 } //namespace ctkEventBus
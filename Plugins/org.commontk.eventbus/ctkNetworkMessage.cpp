@@ -0,0 +1,169 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkNetworkMessage.h"
+
+#include <QDataStream>
+#include <QtEndian>
+
+using namespace ctkEventBus;
+
+namespace {
+
+/// version of the encoding of the messages.
+const quint8 MESSAGE_FORMAT = 1;
+
+/// size of the length prefix of a frame.
+const int FRAME_HEADER_SIZE = 4;
+
+}
+
+ctkNetworkMessage::ctkNetworkMessage() : m_Valid(false), m_Type(Request), m_RequestId(0) {
+}
+
+ctkNetworkMessage ctkNetworkMessage::request(qint32 requestId, const QString &methodName, const QList<QVariantList> &parameters) {
+    ctkNetworkMessage message;
+    message.m_Valid = true;
+    message.m_Type = Request;
+    message.m_RequestId = requestId;
+    message.m_Name = methodName;
+    message.m_Parameters = parameters;
+    return message;
+}
+
+ctkNetworkMessage ctkNetworkMessage::request(qint32 requestId, const QString &methodName, const ctkEventArgumentsList *argList) {
+    if(argList == NULL || argList->isEmpty()) {
+        return ctkNetworkMessage();
+    }
+
+    QList<QVariantList> parameters;
+    int i=0, size = argList->count();
+    for(;i<size;i++) {
+        if(QByteArray(argList->at(i).name()) != "QVariantList") {
+            return ctkNetworkMessage();
+        }
+        parameters.append(*static_cast<const QVariantList *>(argList->at(i).data()));
+    }
+    return request(requestId, methodName, parameters);
+}
+
+ctkNetworkMessage ctkNetworkMessage::reply(qint32 requestId, const QString &status) {
+    ctkNetworkMessage message;
+    message.m_Valid = true;
+    message.m_Type = Reply;
+    message.m_RequestId = requestId;
+    message.m_Name = status;
+    return message;
+}
+
+bool ctkNetworkMessage::isValid() const {
+    return m_Valid;
+}
+
+ctkNetworkMessage::Type ctkNetworkMessage::type() const {
+    return m_Type;
+}
+
+qint32 ctkNetworkMessage::requestId() const {
+    return m_RequestId;
+}
+
+QString ctkNetworkMessage::methodName() const {
+    return m_Type == Request ? m_Name : QString();
+}
+
+QList<QVariantList> ctkNetworkMessage::parameters() const {
+    return m_Parameters;
+}
+
+QString ctkNetworkMessage::topic() const {
+    if(m_Parameters.isEmpty() || m_Parameters.at(0).isEmpty()) {
+        return QString();
+    }
+    return m_Parameters.at(0).at(0).toString();
+}
+
+QString ctkNetworkMessage::status() const {
+    return m_Type == Reply ? m_Name : QString();
+}
+
+QByteArray ctkNetworkMessage::encode() const {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    // readable by the Qt 4.6 and later nodes
+    out.setVersion(QDataStream::Qt_4_6);
+    out << MESSAGE_FORMAT << quint8(m_Type) << m_RequestId << m_Name << quint32(m_Parameters.count());
+    foreach(QVariantList l, m_Parameters) {
+        out << l;
+    }
+    return data;
+}
+
+ctkNetworkMessage ctkNetworkMessage::decode(const QByteArray &data) {
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint8 format = 0;
+    quint8 type = 0;
+    ctkNetworkMessage message;
+    quint32 size = 0;
+    in >> format >> type >> message.m_RequestId >> message.m_Name >> size;
+    if(in.status() != QDataStream::Ok || format != MESSAGE_FORMAT || type > Reply) {
+        return ctkNetworkMessage();
+    }
+
+    for(quint32 i = 0; i < size; ++i) {
+        QVariantList l;
+        in >> l;
+        if(in.status() != QDataStream::Ok) {
+            return ctkNetworkMessage();
+        }
+        message.m_Parameters.append(l);
+    }
+    message.m_Type = static_cast<Type>(type);
+    message.m_Valid = true;
+    return message;
+}
+
+void ctkNetworkMessage::appendFrame(QByteArray &buffer, const ctkNetworkMessage &message) {
+    QByteArray data = message.encode();
+    uchar header[FRAME_HEADER_SIZE];
+    qToBigEndian<quint32>(data.size(), header);
+    buffer.append(reinterpret_cast<const char *>(header), FRAME_HEADER_SIZE);
+    buffer.append(data);
+}
+
+ctkNetworkMessage::FrameStatus ctkNetworkMessage::takeFrame(const QByteArray &buffer, int &offset, ctkNetworkMessage &message) {
+    if(buffer.size() - offset < FRAME_HEADER_SIZE) {
+        return FrameIncomplete;
+    }
+    quint32 length = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(buffer.constData() + offset));
+    if(length > MaximumFrameSize) {
+        return FrameError;
+    }
+    if(quint32(buffer.size() - offset - FRAME_HEADER_SIZE) < length) {
+        return FrameIncomplete;
+    }
+
+    message = decode(QByteArray::fromRawData(buffer.constData() + offset + FRAME_HEADER_SIZE, length));
+    offset += FRAME_HEADER_SIZE + length;
+    return message.isValid() ? FrameTaken : FrameError;
+}
@@ -0,0 +1,110 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+#ifndef CTKNETWORKMESSAGE_H
+#define CTKNETWORKMESSAGE_H
+
+#include "ctkEventDefinitions.h"
+
+namespace ctkEventBus {
+
+/**
+ Class name: ctkNetworkMessage
+ Binary message exchanged by the network connectors, independent of the transport.
+ A request carries the method name and the QVariantList arguments of the remote event, the first
+ item of the first list being the topic to notify on the server. A reply carries the id of the request
+ and its status. The messages are encoded with QDataStream; on stream transports each one is
+ prefixed with its length, so that several requests can be in flight and written at once.
+ */
+class org_commontk_eventbus_EXPORT ctkNetworkMessage {
+
+public:
+    /// kind of message.
+    enum Type {
+        Request = 0,
+        Reply = 1
+    };
+
+    /// result of takeFrame().
+    enum FrameStatus {
+        FrameIncomplete, ///< more data is needed
+        FrameTaken, ///< a message has been decoded
+        FrameError ///< the data is not a valid frame, the connection should be closed
+    };
+
+    /// Frames larger than this size are rejected by takeFrame().
+    static const quint32 MaximumFrameSize = 64 * 1024 * 1024;
+
+    /// object constructor, the message is invalid.
+    ctkNetworkMessage();
+
+    /// create a request.
+    static ctkNetworkMessage request(qint32 requestId, const QString &methodName, const QList<QVariantList> &parameters);
+
+    /// create a request from the arguments sent by the event bus, which must be QVariantList.
+    /** Return an invalid message if an argument is not a QVariantList or if there is no argument. */
+    static ctkNetworkMessage request(qint32 requestId, const QString &methodName, const ctkEventArgumentsList *argList);
+
+    /// create the reply to a request.
+    static ctkNetworkMessage reply(qint32 requestId, const QString &status);
+
+    /// Return false for the default constructed messages and the ones which could not be decoded.
+    bool isValid() const;
+
+    Type type() const;
+
+    qint32 requestId() const;
+
+    /// method name of a request.
+    QString methodName() const;
+
+    /// arguments of a request.
+    QList<QVariantList> parameters() const;
+
+    /// topic of the local event to notify, first item of the first argument of a request.
+    QString topic() const;
+
+    /// status of a reply.
+    QString status() const;
+
+    /// encode the message.
+    QByteArray encode() const;
+
+    /// decode a message, the result is invalid if data is not an encoded message.
+    static ctkNetworkMessage decode(const QByteArray &data);
+
+    /// append the message to buffer, prefixed with its length.
+    static void appendFrame(QByteArray &buffer, const ctkNetworkMessage &message);
+
+    /// decode the frame of buffer starting at offset, and move offset after it.
+    /** Offset is not changed if the frame is incomplete. */
+    static FrameStatus takeFrame(const QByteArray &buffer, int &offset, ctkNetworkMessage &message);
+
+private:
+    bool m_Valid; ///< false if the message is invalid
+    Type m_Type; ///< request or reply
+    qint32 m_RequestId; ///< id of the request, also sent in the reply
+    QString m_Name; ///< method name of a request or status of a reply
+    QList<QVariantList> m_Parameters; ///< arguments of a request
+};
+
+} // namespace ctkEventBus
+
+#endif // CTKNETWORKMESSAGE_H
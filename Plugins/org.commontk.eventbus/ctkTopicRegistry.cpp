@@ -23,6 +23,7 @@ ctkTopicRegistry::ctkTopicRegistry() {
 
 void ctkTopicRegistry::shutdown() {
     m_TopicHash.clear();
+    m_TopicTrie.clear();
 }
 
 bool ctkTopicRegistry::registerTopic(const QString topic, const QObject *owner) {
@@ -37,6 +38,7 @@ bool ctkTopicRegistry::registerTopic(const QString topic, const QObject *owner)
         return false;
     }
     m_TopicHash.insert(topic,owner);
+    m_TopicTrie.insert(topic);
     return true;
 }
 
@@ -44,6 +46,7 @@ bool ctkTopicRegistry::unregisterTopic(const QString topic) {
     bool result = false;
     if(m_TopicHash.contains(topic)){
         if (m_TopicHash.remove(topic) > 0) {
+            m_TopicTrie.remove(topic);
             result = true;
         }
     }
@@ -58,6 +61,10 @@ bool ctkTopicRegistry::isTopicRegistered(const QString topic) const {
     return m_TopicHash.contains(topic);
 }
 
+QStringList ctkTopicRegistry::topics(const QString pattern) const {
+    return m_TopicTrie.find(pattern);
+}
+
 void ctkTopicRegistry::dump() {
     QHash<QString, const QObject*>::const_iterator i = m_TopicHash.constBegin();
     while (i != m_TopicHash.constEnd()) {
@@ -14,6 +14,7 @@
 
 // Includes list
 #include "ctkEventDefinitions.h"
+#include "ctkTopicTrie.h"
 
 namespace ctkEventBus {
 
@@ -41,6 +42,10 @@ public:
     /// Check if a topic is present in the topic hash.
     bool isTopicRegistered(const QString topic) const;
 
+    /// Return the registered topics matched by the given pattern.
+    /** The pattern can contain "*" wildcard segments, e.g. "ctk/remote/*" returns all the topics starting with "ctk/remote/". */
+    QStringList topics(const QString pattern) const;
+
     /// Dump of the topic hash.
     void dump();
 
@@ -49,6 +54,7 @@ private:
     ctkTopicRegistry();
 
     QHash<QString, const QObject*> m_TopicHash; ///< Hash containing pairs (topic,owner).
+    ctkTopicTrie m_TopicTrie; ///< Topics of m_TopicHash, for the wildcard lookups.
 };
 
 } //nameSpace ctkEventBus
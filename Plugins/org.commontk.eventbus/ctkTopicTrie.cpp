@@ -0,0 +1,189 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkTopicTrie.h"
+
+using namespace ctkEventBus;
+
+namespace {
+
+const QString WILDCARD("*");
+
+}
+
+struct ctkTopicTrie::Node {
+    Node() : terminal(false) {}
+    ~Node() { qDeleteAll(children); }
+
+    QHash<QString, Node *> children; ///< Nodes of the next segment.
+    QString topic; ///< Topic ending at this node, if terminal.
+    bool terminal; ///< A topic ends at this node.
+};
+
+ctkTopicTrie::ctkTopicTrie() : m_Root(new Node()), m_Count(0) {
+}
+
+ctkTopicTrie::~ctkTopicTrie() {
+    delete m_Root;
+}
+
+void ctkTopicTrie::insert(const QString &topic) {
+    Node *node = m_Root;
+    foreach(const QString &segment, topic.split('/')) {
+        Node *child = node->children.value(segment);
+        if(child == NULL) {
+            child = new Node();
+            node->children.insert(segment, child);
+        }
+        node = child;
+    }
+    if(!node->terminal) {
+        node->terminal = true;
+        node->topic = topic;
+        ++m_Count;
+    }
+}
+
+void ctkTopicTrie::remove(const QString &topic) {
+    QStringList segments = topic.split('/');
+    QList<Node *> path;
+    Node *node = m_Root;
+    foreach(const QString &segment, segments) {
+        path.append(node);
+        node = node->children.value(segment);
+        if(node == NULL) {
+            return;
+        }
+    }
+    if(!node->terminal) {
+        return;
+    }
+    node->terminal = false;
+    node->topic.clear();
+    --m_Count;
+
+    // prune the nodes left without topic
+    for(int i = segments.size() - 1; i >= 0 && !node->terminal && node->children.isEmpty(); --i) {
+        Node *parent = path.at(i);
+        parent->children.remove(segments.at(i));
+        delete node;
+        node = parent;
+    }
+}
+
+bool ctkTopicTrie::contains(const QString &topic) const {
+    const Node *node = m_Root;
+    foreach(const QString &segment, topic.split('/')) {
+        node = node->children.value(segment);
+        if(node == NULL) {
+            return false;
+        }
+    }
+    return node->terminal;
+}
+
+void ctkTopicTrie::clear() {
+    delete m_Root;
+    m_Root = new Node();
+    m_Count = 0;
+}
+
+int ctkTopicTrie::count() const {
+    return m_Count;
+}
+
+QStringList ctkTopicTrie::match(const QString &topic) const {
+    QStringList result;
+    matchNode(m_Root, topic.split('/'), 0, result);
+    return result;
+}
+
+QStringList ctkTopicTrie::find(const QString &pattern) const {
+    QStringList result;
+    findNode(m_Root, pattern.split('/'), 0, result);
+    return result;
+}
+
+bool ctkTopicTrie::isPattern(const QString &topic) {
+    return topic.split('/').contains(WILDCARD);
+}
+
+void ctkTopicTrie::collect(const Node *node, QStringList &result) {
+    if(node->terminal) {
+        result.append(node->topic);
+    }
+    foreach(const Node *child, node->children) {
+        collect(child, result);
+    }
+}
+
+void ctkTopicTrie::matchNode(const Node *node, const QStringList &segments, int index, QStringList &result) {
+    if(index == segments.size()) {
+        if(node->terminal) {
+            result.append(node->topic);
+        }
+        return;
+    }
+
+    const QString &segment = segments.at(index);
+    const Node *child = node->children.value(segment);
+    if(child) {
+        matchNode(child, segments, index + 1, result);
+    }
+    if(segment == WILDCARD) {
+        return;
+    }
+    const Node *wildcard = node->children.value(WILDCARD);
+    if(wildcard) {
+        // a trailing wildcard matches the remaining segments, the last one is handled by the recursion
+        if(wildcard->terminal && index + 1 < segments.size()) {
+            result.append(wildcard->topic);
+        }
+        matchNode(wildcard, segments, index + 1, result);
+    }
+}
+
+void ctkTopicTrie::findNode(const Node *node, const QStringList &segments, int index, QStringList &result) {
+    if(index == segments.size()) {
+        if(node->terminal) {
+            result.append(node->topic);
+        }
+        return;
+    }
+
+    const QString &segment = segments.at(index);
+    if(segment != WILDCARD) {
+        const Node *child = node->children.value(segment);
+        if(child) {
+            findNode(child, segments, index + 1, result);
+        }
+        return;
+    }
+
+    bool last = index + 1 == segments.size();
+    foreach(const Node *child, node->children) {
+        if(last) {
+            collect(child, result);
+        } else {
+            findNode(child, segments, index + 1, result);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKTOPICTRIE_H
+#define CTKTOPICTRIE_H
+
+// Includes list
+#include "ctkEventDefinitions.h"
+
+#include <QStringList>
+
+namespace ctkEventBus {
+
+/**
+  Class name: ctkTopicTrie
+  Set of topics stored by segment ("ctk/local/eventBus" has three segments), so that the
+  wildcard lookups do not scan all the topics. A "*" segment matches exactly one segment,
+  except as the last segment where it matches all the remaining ones: "ctk/remote/*"
+  matches "ctk/remote/eventBus" and "ctk/remote/eventBus/comunication".
+  The lookups cost O(depth) for the topics without wildcards.
+*/
+class org_commontk_eventbus_EXPORT ctkTopicTrie {
+public:
+    /// Object constructor.
+    ctkTopicTrie();
+
+    /// Object destructor.
+    ~ctkTopicTrie();
+
+    /// Add a topic or a pattern, nothing is done if it is already present.
+    void insert(const QString &topic);
+
+    /// Remove a topic or a pattern.
+    void remove(const QString &topic);
+
+    /// Check if the topic or the pattern has been inserted.
+    bool contains(const QString &topic) const;
+
+    /// Remove all the topics.
+    void clear();
+
+    /// Number of topics and patterns inserted.
+    int count() const;
+
+    /// Return the inserted topics and patterns matching the given topic.
+    /** Used to find the wildcard subscriptions which have to receive an event. */
+    QStringList match(const QString &topic) const;
+
+    /// Return the inserted topics matched by the given pattern.
+    /** Used to find the topics a wildcard subscription has to receive. */
+    QStringList find(const QString &pattern) const;
+
+    /// Check if the topic contains a wildcard segment.
+    static bool isPattern(const QString &topic);
+
+private:
+    struct Node;
+
+    /// add all the topics of the sub tree of node.
+    static void collect(const Node *node, QStringList &result);
+
+    /// add the inserted patterns which match the segments of a topic from index.
+    static void matchNode(const Node *node, const QStringList &segments, int index, QStringList &result);
+
+    /// add the inserted topics matched by the segments of a pattern from index.
+    static void findNode(const Node *node, const QStringList &segments, int index, QStringList &result);
+
+    /// Not copyable.
+    ctkTopicTrie(const ctkTopicTrie &);
+    ctkTopicTrie &operator=(const ctkTopicTrie &);
+
+    Node *m_Root; ///< Node of the empty path.
+    int m_Count; ///< Number of topics inserted.
+};
+
+} //nameSpace ctkEventBus
+
+#endif // CTKTOPICTRIE_H
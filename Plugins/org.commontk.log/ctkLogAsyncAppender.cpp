@@ -0,0 +1,157 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+
+#include "ctkLogAsyncAppender_p.h"
+
+#include "ctkLogQDebug_p.h"
+
+#include <QMutexLocker>
+
+//----------------------------------------------------------------------------
+ctkLogAsyncAppender::ctkLogAsyncAppender(int flushInterval, int batchSize, int flushLevel)
+  : head(0), flushInterval(qMax(1, flushInterval)), batchSize(qMax(1, batchSize)),
+    flushLevel(flushLevel)
+{
+  this->setObjectName("ctkLogAsyncAppender");
+}
+
+//----------------------------------------------------------------------------
+ctkLogAsyncAppender::~ctkLogAsyncAppender()
+{
+  stopping.fetchAndStoreOrdered(1);
+  this->wake(true);
+  this->wait();
+
+  // Records appended after the thread stopped
+  ctkLogRecord* record = this->takeAll();
+  while (record)
+  {
+    ctkLogRecord* next = record->next;
+    ctkLogQDebug::write(*record);
+    delete record;
+    record = next;
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkLogAsyncAppender::append(ctkLogRecord* record)
+{
+  ctkLogRecord* oldHead = 0;
+  do
+  {
+#if QT_VERSION >= 0x050000
+    oldHead = head.loadAcquire();
+#else
+    oldHead = head;
+#endif
+    record->next = oldHead;
+  } while (!head.testAndSetRelease(oldHead, record));
+
+  const bool flushNow = record->level <= flushLevel;
+  if (pending.fetchAndAddOrdered(1) + 1 == batchSize || flushNow)
+  {
+    this->wake(flushNow);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkLogAsyncAppender::flush()
+{
+  if (!this->isRunning() || QThread::currentThread() == this)
+  {
+    return;
+  }
+  this->wake(true);
+  QMutexLocker lock(&mutex);
+  while (pending.fetchAndAddOrdered(0) > 0 && this->isRunning())
+  {
+    // Bounded wait, the thread may be writing when we start waiting
+    written.wait(&mutex, flushInterval);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkLogAsyncAppender::run()
+{
+  forever
+  {
+    {
+      QMutexLocker lock(&mutex);
+      if (!stopping.fetchAndAddOrdered(0) && !urgent.fetchAndAddOrdered(0) &&
+          pending.fetchAndAddOrdered(0) < batchSize)
+      {
+        wakeUp.wait(&mutex, flushInterval);
+      }
+      urgent.fetchAndStoreOrdered(0);
+    }
+
+    int count = 0;
+    ctkLogRecord* record = this->takeAll();
+    while (record)
+    {
+      ctkLogRecord* next = record->next;
+      ctkLogQDebug::write(*record);
+      delete record;
+      record = next;
+      ++count;
+    }
+
+    if (count > 0)
+    {
+      pending.fetchAndAddOrdered(-count);
+      QMutexLocker lock(&mutex);
+      written.wakeAll();
+    }
+    else if (stopping.fetchAndAddOrdered(0))
+    {
+      return;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+ctkLogRecord* ctkLogAsyncAppender::takeAll()
+{
+  // The stack is in reverse order of append()
+  ctkLogRecord* record = head.fetchAndStoreAcquire(0);
+  ctkLogRecord* records = 0;
+  while (record)
+  {
+    ctkLogRecord* next = record->next;
+    record->next = records;
+    records = record;
+    record = next;
+  }
+  return records;
+}
+
+//----------------------------------------------------------------------------
+void ctkLogAsyncAppender::wake(bool urgentFlush)
+{
+  QMutexLocker lock(&mutex);
+  if (urgentFlush)
+  {
+    urgent.fetchAndStoreOrdered(1);
+  }
+  wakeUp.wakeOne();
+}
@@ -0,0 +1,109 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+
+#ifndef CTKLOGASYNCAPPENDER_P_H
+#define CTKLOGASYNCAPPENDER_P_H
+
+#include <ctkServiceReference.h>
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QDateTime>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+/**
+ * A log entry accepted by ctkLogQDebug, waiting to be written.
+ */
+struct ctkLogRecord
+{
+  ctkLogRecord() : level(0), file(0), line(-1), next(0) {}
+
+  QDateTime time;
+  int level;
+  QString message;
+  QString exception;
+  ctkServiceReference sr;
+  const char* file;
+  int line;
+
+  ctkLogRecord* next;
+};
+
+/**
+ * Writes the records of ctkLogQDebug from a background thread.
+ *
+ * append() pushes a record onto a lock-free stack and returns, the
+ * records are written in the order they were appended. The thread wakes
+ * up every <code>flushInterval</code> milliseconds, as soon as
+ * <code>batchSize</code> records are pending, or as soon as a record at
+ * least as severe as <code>flushLevel</code> is appended.
+ */
+class ctkLogAsyncAppender : public QThread
+{
+
+public:
+
+  ctkLogAsyncAppender(int flushInterval, int batchSize, int flushLevel);
+
+  /**
+   * Writes the pending records and stops the thread.
+   */
+  ~ctkLogAsyncAppender();
+
+  /**
+   * Queues a record, which is deleted once written. Thread safe and lock free,
+   * unless the record must be flushed right away.
+   */
+  void append(ctkLogRecord* record);
+
+  /**
+   * Blocks until the records appended before the call are written.
+   */
+  void flush();
+
+protected:
+
+  void run();
+
+private:
+
+  ctkLogRecord* takeAll();
+  void wake(bool urgent);
+
+  QAtomicPointer<ctkLogRecord> head;
+  QAtomicInt pending;
+  QAtomicInt urgent;
+  QAtomicInt stopping;
+
+  const int flushInterval;
+  const int batchSize;
+  const int flushLevel;
+
+  QMutex mutex;
+  QWaitCondition wakeUp;
+  QWaitCondition written;
+};
+
+#endif // CTKLOGASYNCAPPENDER_P_H
@@ -22,11 +22,30 @@
 
 #include "ctkLogPlugin_p.h"
 
+#include "ctkLogAsyncAppender_p.h"
 #include "ctkLogQDebug_p.h"
 
 #include <QtPlugin>
 #include <QStringList>
 
+const QString ctkLogPlugin::PROP_LOG_LEVEL = "org.commontk.log.level";
+const QString ctkLogPlugin::PROP_ASYNC = "org.commontk.log.async";
+const QString ctkLogPlugin::PROP_FLUSH_INTERVAL = "org.commontk.log.flushInterval";
+const QString ctkLogPlugin::PROP_BATCH_SIZE = "org.commontk.log.batchSize";
+const QString ctkLogPlugin::PROP_FLUSH_LEVEL = "org.commontk.log.flushLevel";
+
+namespace
+{
+
+int intProperty(ctkPluginContext* context, const QString& key, int defaultValue)
+{
+  bool ok = false;
+  int value = context->getProperty(key).toInt(&ok);
+  return ok ? value : defaultValue;
+}
+
+}
+
 ctkLogPlugin::ctkLogPlugin()
   : logService(0)
 {
@@ -35,7 +54,17 @@ ctkLogPlugin::ctkLogPlugin()
 
 void ctkLogPlugin::start(ctkPluginContext* context)
 {
-  logService = new ctkLogQDebug();
+  ctkLogAsyncAppender* appender = 0;
+  QVariant async = context->getProperty(PROP_ASYNC);
+  if (!async.isValid() || async.toBool())
+  {
+    appender = new ctkLogAsyncAppender(intProperty(context, PROP_FLUSH_INTERVAL, 100),
+                                       intProperty(context, PROP_BATCH_SIZE, 64),
+                                       intProperty(context, PROP_FLUSH_LEVEL, ctkLogService::LOG_WARNING));
+    appender->start();
+  }
+  logService = new ctkLogQDebug(intProperty(context, PROP_LOG_LEVEL, ctkLogService::LOG_DEBUG),
+                                appender);
   context->registerService(QStringList("ctkLogService"), logService);
 }
 
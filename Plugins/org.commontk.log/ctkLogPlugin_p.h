@@ -38,6 +38,36 @@ class ctkLogPlugin :
 
 public:
 
+  /**
+   * Framework property, the least severe level accepted into the log.
+   * Defaults to ctkLogService::LOG_DEBUG.
+   */
+  static const QString PROP_LOG_LEVEL; // = "org.commontk.log.level"
+
+  /**
+   * Framework property, whether the log entries are written from a
+   * background thread. Defaults to <code>true</code>.
+   */
+  static const QString PROP_ASYNC; // = "org.commontk.log.async"
+
+  /**
+   * Framework property, the maximum time in milliseconds a log entry waits
+   * in the queue of the background thread. Defaults to 100.
+   */
+  static const QString PROP_FLUSH_INTERVAL; // = "org.commontk.log.flushInterval"
+
+  /**
+   * Framework property, the number of queued log entries which wakes up
+   * the background thread before the flush interval. Defaults to 64.
+   */
+  static const QString PROP_BATCH_SIZE; // = "org.commontk.log.batchSize"
+
+  /**
+   * Framework property, log entries at least this severe are written
+   * right away. Defaults to ctkLogService::LOG_WARNING.
+   */
+  static const QString PROP_FLUSH_LEVEL; // = "org.commontk.log.flushLevel"
+
   ctkLogPlugin();
 
   void start(ctkPluginContext* context);
@@ -20,17 +20,25 @@
 =============================================================================*/
 
 
+
 #include "ctkLogQDebug_p.h"
 
+#include "ctkLogAsyncAppender_p.h"
+
 #include <QDateTime>
 #include <QDebug>
 #include <QStringList>
 
 #include <ctkPluginConstants.h>
 
-ctkLogQDebug::ctkLogQDebug()
-  : logLevel(ctkLogService::LOG_DEBUG)
+ctkLogQDebug::ctkLogQDebug(int logLevel, ctkLogAsyncAppender* appender)
+  : logLevel(logLevel), appender(appender)
+{
+}
+
+ctkLogQDebug::~ctkLogQDebug()
 {
+  delete appender;
 }
 
 void ctkLogQDebug::log(int level, const QString& message, const std::exception* exception,
@@ -38,31 +46,19 @@ void ctkLogQDebug::log(int level, const QString& message, const std::exception*
 {
   Q_UNUSED(function)
 
-  QString s = QDateTime::currentDateTime().toString(Qt::ISODate)
-      .append(" - ").append(message);
+  if (!this->isLogged(level)) return;
 
+  ctkLogRecord* record = new ctkLogRecord;
+  record->time = QDateTime::currentDateTime();
+  record->level = level;
+  record->message = message;
   if (exception != 0)
   {
-    s.append(" (").append(exception->what()).append(")");
-  }
-
-  if (file)
-  {
-    s.append(" [at ").append(file).append(":").append(QString::number(line)).append("]");
-  }
-
-  if (level == ctkLogService::LOG_WARNING)
-  {
-    qWarning() << s;
-  }
-  else if (level == ctkLogService::LOG_ERROR)
-  {
-    qCritical() << s;
-  }
-  else
-  {
-    qDebug() << s;
+    record->exception = exception->what();
   }
+  record->file = file;
+  record->line = line;
+  this->append(record);
 }
 
 void ctkLogQDebug::log(const ctkServiceReference& sr, int level, const QString& message,
@@ -71,36 +67,63 @@ void ctkLogQDebug::log(const ctkServiceReference& sr, int level, const QString&
 {
   Q_UNUSED(function)
 
-  QString s = QDateTime::currentDateTime().toString(Qt::ISODate)
-      .append(" - [");
+  if (!this->isLogged(level)) return;
 
-  s.append(sr.getProperty(ctkPluginConstants::SERVICE_ID).toString());
-  s.append(";");
-  QStringList clazzes = sr.getProperty(ctkPluginConstants::OBJECTCLASS).toStringList();
-  int i = 0;
-  foreach (QString clazz, clazzes)
+  ctkLogRecord* record = new ctkLogRecord;
+  record->time = QDateTime::currentDateTime();
+  record->level = level;
+  record->message = message;
+  if (exception != 0)
   {
-    if (i > 0) s.append(",");
-    s.append(clazz);
+    record->exception = exception->what();
   }
+  record->sr = sr;
+  record->file = file;
+  record->line = line;
+  this->append(record);
+}
+
+int ctkLogQDebug::getLogLevel() const
+{
+  return logLevel;
+}
 
-  s.append(message);
+void ctkLogQDebug::write(const ctkLogRecord& record)
+{
+  QString s = record.time.toString(Qt::ISODate).append(" - ");
 
-  if(exception != 0)
+  if (record.sr)
   {
-    s.append(" (").append(exception->what()).append(")");
+    s.append("[");
+    s.append(record.sr.getProperty(ctkPluginConstants::SERVICE_ID).toString());
+    s.append(";");
+    QStringList clazzes = record.sr.getProperty(ctkPluginConstants::OBJECTCLASS).toStringList();
+    int i = 0;
+    foreach (QString clazz, clazzes)
+    {
+      if (i++ > 0) s.append(",");
+      s.append(clazz);
+    }
+    s.append("] ");
   }
 
-  if (file)
+  s.append(record.message);
+
+  if (!record.exception.isNull())
   {
-    s.append(" [at ").append(file).append(":").append(QString::number(line)).append("]");
+    s.append(" (").append(record.exception).append(")");
   }
 
-  if (level == ctkLogService::LOG_WARNING)
+  if (record.file)
+  {
+    s.append(" [at ").append(record.file).append(":").append(QString::number(record.line)).append("]");
+  }
+
+  if (record.level == ctkLogService::LOG_WARNING)
   {
     qWarning() << s;
   }
-  else if (level == ctkLogService::LOG_ERROR)
+  else if (record.level == ctkLogService::LOG_ERROR)
   {
     qCritical() << s;
   }
@@ -110,7 +133,15 @@ void ctkLogQDebug::log(const ctkServiceReference& sr, int level, const QString&
   }
 }
 
-int ctkLogQDebug::getLogLevel() const
+void ctkLogQDebug::append(ctkLogRecord* record)
 {
-  return logLevel;
+  if (appender)
+  {
+    appender->append(record);
+  }
+  else
+  {
+    write(*record);
+    delete record;
+  }
 }
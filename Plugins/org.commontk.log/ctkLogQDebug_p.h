@@ -20,6 +20,7 @@
 =============================================================================*/
 
 
+
 #ifndef CTKLOGQDEBUG_P_H
 #define CTKLOGQDEBUG_P_H
 
@@ -27,6 +28,9 @@
 
 #include <QObject>
 
+class ctkLogAsyncAppender;
+struct ctkLogRecord;
+
 class ctkLogQDebug : public QObject, public ctkLogService
 {
 
@@ -35,7 +39,14 @@ class ctkLogQDebug : public QObject, public ctkLogService
 
 public:
 
-  ctkLogQDebug();
+  /**
+   * \param logLevel The least severe level accepted into the log.
+   * \param appender Writes the entries from a background thread, the log
+   *        service takes ownership. If 0, the entries are written from
+   *        the thread calling log().
+   */
+  ctkLogQDebug(int logLevel = ctkLogService::LOG_DEBUG, ctkLogAsyncAppender* appender = 0);
+  ~ctkLogQDebug();
 
   void log(int level, const QString& message, const std::exception* exception = 0,
            const char* file = 0, const char* function = 0, int line = -1);
@@ -44,9 +55,17 @@ public:
            const char* file = 0, const char* function = 0, int line = -1);
   int getLogLevel() const;
 
+  /**
+   * Formats a log entry and writes it with qDebug(), qWarning() or qCritical().
+   */
+  static void write(const ctkLogRecord& record);
+
 private:
 
+  void append(ctkLogRecord* record);
+
   int logLevel;
+  ctkLogAsyncAppender* appender;
 };
 
 #endif // CTKLOGQDEBUG_P_H
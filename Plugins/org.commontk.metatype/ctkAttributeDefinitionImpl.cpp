@@ -26,6 +26,7 @@
 
 #include <service/log/ctkLogService.h>
 #include <QCoreApplication>
+#include <QDataStream>
 
 const QChar ctkAttributeDefinitionImpl::SEPARATE = ',';
 const QChar ctkAttributeDefinitionImpl::CONTROL = '\\';
@@ -190,6 +191,34 @@ void ctkAttributeDefinitionImpl::setPluginLocalization(const ctkPluginLocalizati
   _locElem.setPluginLocalization(pluginLoc);
 }
 
+void ctkAttributeDefinitionImpl::write(QDataStream& out) const
+{
+  out << _id << _name << _description << static_cast<qint32>(_dataType)
+      << static_cast<qint32>(_cardinality) << _minValue << _maxValue << _isRequired
+      << _locElem.getLocalizationBase() << _locElem.getContext()
+      << _defaults << _values << _labels;
+}
+
+ctkAttributeDefinitionImplPtr ctkAttributeDefinitionImpl::read(QDataStream& in, ctkLogService* logger)
+{
+  QString id, name, description, localization, context;
+  qint32 type = 0;
+  qint32 cardinality = 0;
+  QVariant min, max;
+  bool isRequired = false;
+  QStringList defaults, values, labels;
+  in >> id >> name >> description >> type >> cardinality >> min >> max >> isRequired
+     >> localization >> context >> defaults >> values >> labels;
+
+  ctkAttributeDefinitionImplPtr ad(new ctkAttributeDefinitionImpl(
+                                     id, name, description, type, cardinality, min, max,
+                                     isRequired, localization, context, logger));
+  // the options and defaults were validated when the metatype document was parsed
+  ad->setOption(labels, values, false);
+  ad->setDefaultValue(defaults, false);
+  return ad;
+}
+
 QString ctkAttributeDefinitionImpl::validate(const QString& value) const
 {
   if (value.isNull())
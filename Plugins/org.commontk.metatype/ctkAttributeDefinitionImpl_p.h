@@ -30,6 +30,7 @@
 #include <QStringList>
 #include <QVariant>
 
+class QDataStream;
 struct ctkLogService;
 
 /**
@@ -183,6 +184,16 @@ public:
    */
   QString validate(const QString& value) const;
 
+  /**
+   * Write this AD to the metatype cache.
+   */
+  void write(QDataStream& out) const;
+
+  /**
+   * Read an AD written by write().
+   */
+  static QSharedPointer<ctkAttributeDefinitionImpl> read(QDataStream& in, ctkLogService* logger);
+
 private:
 
   /**
@@ -49,6 +49,8 @@ public:
   QString getLocalized(const QString& key) const;
 
   QString getLocalizationBase() const;
+
+  QString getContext() const;
 };
 
 #endif // CTKMTLOCALIZATIONELEMENT_P_H
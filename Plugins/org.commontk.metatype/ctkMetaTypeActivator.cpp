@@ -86,7 +86,9 @@ void ctkMetaTypeActivator::start(ctkPluginContext* context)
   properties.insert(ctkPluginConstants::SERVICE_VENDOR, "CommonTK");
   properties.insert(ctkPluginConstants::SERVICE_DESCRIPTION, ctkMTMsg::SERVICE_DESCRIPTION);
   properties.insert(ctkPluginConstants::SERVICE_PID, SERVICE_PID);
-  metaTypeService = new ctkMetaTypeServiceImpl(lsTracker, mtpTracker);
+  // the parsed metatype documents are cached in the plugin's data directory
+  metaTypeService = new ctkMetaTypeServiceImpl(lsTracker, mtpTracker,
+                                               context->getDataFile("cache").absoluteFilePath());
   context->connectPluginListener(metaTypeService, SLOT(pluginChanged(ctkPluginEvent)), Qt::DirectConnection);
   metaTypeServiceRegistration = context->registerService<ctkMetaTypeService>(metaTypeService, properties);
 }
@@ -27,14 +27,16 @@
 
 #include <ctkPlugin.h>
 
-ctkMetaTypeInformationImpl::ctkMetaTypeInformationImpl(const QSharedPointer<ctkPlugin>& plugin, ctkLogService* logger)
-  : ctkMetaTypeProviderImpl(plugin, logger)
+ctkMetaTypeInformationImpl::ctkMetaTypeInformationImpl(const QSharedPointer<ctkPlugin>& plugin, ctkLogService* logger,
+                                                       const QString& cacheDir)
+  : ctkMetaTypeProviderImpl(plugin, logger, cacheDir)
 {
 
 }
 
 QStringList ctkMetaTypeInformationImpl::getPids() const
 {
+  loadMetaData();
   if (_allPidOCDs.isEmpty())
   {
     return QStringList();
@@ -45,6 +47,7 @@ QStringList ctkMetaTypeInformationImpl::getPids() const
 
 QStringList ctkMetaTypeInformationImpl::getFactoryPids() const
 {
+  loadMetaData();
   if (_allFPidOCDs.isEmpty())
   {
     return QStringList();
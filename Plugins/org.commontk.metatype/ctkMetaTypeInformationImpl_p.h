@@ -47,7 +47,8 @@ public:
   /**
    * Constructor of class ctkMetaTypeInformationImpl.
    */
-  ctkMetaTypeInformationImpl(const QSharedPointer<ctkPlugin>& plugin, ctkLogService* logger);
+  ctkMetaTypeInformationImpl(const QSharedPointer<ctkPlugin>& plugin, ctkLogService* logger,
+                             const QString& cacheDir = QString());
 
   /*
    * @see ctkMetaTypeInformation#getPids()
@@ -27,6 +27,7 @@
 #include "ctkMTMsg_p.h"
 #include "ctkMTDataParser_p.h"
 
+#include <ctkPlugin.h>
 #include <ctkPluginConstants.h>
 #include <ctkException.h>
 #include <service/log/ctkLogService.h>
@@ -35,6 +36,14 @@
 #include <QCoreApplication>
 #include <QStringList>
 #include <QBuffer>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QUrl>
+
+static const quint32 CACHE_MAGIC = 0x63746b4d; // "ctkM"
+static const qint32 CACHE_VERSION = 1;
 
 const QString ctkMetaTypeProviderImpl::METADATA_NOT_FOUND = "METADATA_NOT_FOUND";
 const QString ctkMetaTypeProviderImpl::OCD_ID_NOT_FOUND = "OCD_ID_NOT_FOUND";
@@ -44,47 +53,86 @@ const QString ctkMetaTypeProviderImpl::META_FILE_EXT = ".XML";
 const QString ctkMetaTypeProviderImpl::RESOURCE_FILE_CONN = "_";
 const QString ctkMetaTypeProviderImpl::RESOURCE_FILE_EXT = ".qm";
 const QChar ctkMetaTypeProviderImpl::DIRECTORY_SEP = '/';
+const QString ctkMetaTypeProviderImpl::CACHE_FILE_EXT = ".ocd";
 
 
 ctkMetaTypeProviderImpl::ctkMetaTypeProviderImpl(
-  const QSharedPointer<ctkPlugin>& plugin, ctkLogService* logger)
-  : _plugin(plugin), logger(logger), _isThereMeta(false)
+  const QSharedPointer<ctkPlugin>& plugin, ctkLogService* logger, const QString& cacheDir)
+  : _plugin(plugin), logger(logger), _isThereMeta(false), _cacheDir(cacheDir), _loaded(false)
 {
-  // read all plugin's metadata files and build internal data structures
-  _isThereMeta = readMetaFiles(plugin);
+  // the metadata files are read on first use, only check that the plugin has some
+  _isThereMeta = !plugin->getResourceList(ctkMetaTypeService::METATYPE_DOCUMENTS_LOCATION).isEmpty();
 
   if (!_isThereMeta)
   {
+    _loaded = true;
     CTK_DEBUG(logger) << QCoreApplication::translate(ctkMTMsg::CONTEXT, ctkMTMsg::METADATA_NOT_FOUND)
                          .arg(plugin->getPluginId()).arg(plugin->getSymbolicName());
   }
 }
 
+void ctkMetaTypeProviderImpl::loadMetaData() const
+{
+  QMutexLocker lock(&_loadMutex);
+  if (_loaded)
+  {
+    return;
+  }
+
+  ctkMetaTypeProviderImpl* self = const_cast<ctkMetaTypeProviderImpl*>(this);
+  if (!self->readCache())
+  {
+    // read all plugin's metadata files and build internal data structures
+    if (self->readMetaFiles(_plugin))
+    {
+      writeCache();
+    }
+    else
+    {
+      CTK_DEBUG(logger) << QCoreApplication::translate(ctkMTMsg::CONTEXT, ctkMTMsg::METADATA_NOT_FOUND)
+                           .arg(_plugin->getPluginId()).arg(_plugin->getSymbolicName());
+    }
+  }
+  _loaded = true;
+}
+
 ctkObjectClassDefinitionPtr ctkMetaTypeProviderImpl::getObjectClassDefinition(
   const QString& pid, const QLocale& locale)
 {
-  ctkObjectClassDefinitionImplPtr ocd;
-  if (_allPidOCDs.contains(pid))
+  loadMetaData();
+
+  QMutexLocker lock(&_localizedMutex);
+
+  // localized copies are created once per locale, later requests are a lookup
+  const QString localeName = locale.name();
+  QHash<QString, ctkObjectClassDefinitionImplPtr>& localizedOCDs = _localizedOCDs[localeName];
+  ctkObjectClassDefinitionImplPtr ocd = localizedOCDs.value(pid);
+  if (ocd)
   {
-    ocd = ctkObjectClassDefinitionImplPtr(new ctkObjectClassDefinitionImpl(*_allPidOCDs.value(pid).data()));
-    ocd->setPluginLocalization(locale, _plugin);
     return ocd;
   }
-  else if (_allFPidOCDs.contains(pid))
+
+  ctkObjectClassDefinitionImplPtr unlocalizedOCD = _allPidOCDs.value(pid);
+  if (!unlocalizedOCD)
   {
-    ocd = ctkObjectClassDefinitionImplPtr(new ctkObjectClassDefinitionImpl(*_allFPidOCDs.value(pid).data()));
-    ocd->setPluginLocalization(locale, _plugin);
-    return ocd;
+    unlocalizedOCD = _allFPidOCDs.value(pid);
   }
-  else
+  if (!unlocalizedOCD)
   {
     QString msg = QCoreApplication::translate(ctkMTMsg::CONTEXT, ctkMTMsg::OCD_ID_NOT_FOUND).arg(pid);
     throw ctkInvalidArgumentException(msg);
   }
+
+  ocd = ctkObjectClassDefinitionImplPtr(new ctkObjectClassDefinitionImpl(*unlocalizedOCD.data()));
+  ocd->setPluginLocalization(locale, _plugin);
+  localizedOCDs.insert(pid, ocd);
+  return ocd;
 }
 
 QList<QLocale> ctkMetaTypeProviderImpl::getLocales() const
 {
+  loadMetaData();
+
   if (!_locales.isEmpty())
     return checkForDefault(_locales);
 
@@ -204,6 +252,135 @@ bool ctkMetaTypeProviderImpl::readMetaFiles(const QSharedPointer<ctkPlugin>& plu
   return isThereMetaHere;
 }
 
+QString ctkMetaTypeProviderImpl::cacheFile() const
+{
+  if (_cacheDir.isEmpty())
+  {
+    return QString();
+  }
+  return QDir(_cacheDir).filePath(_plugin->getSymbolicName() + RESOURCE_FILE_CONN +
+                                  _plugin->getVersion().toString() + CACHE_FILE_EXT);
+}
+
+QString ctkMetaTypeProviderImpl::cacheKey() const
+{
+  // the plugin content is identified by the time stamp and size of its file
+  QString location = _plugin->getLocation();
+  QUrl url(location);
+  QString path = url.scheme() == "file" ? url.toLocalFile() : location;
+  QFileInfo pluginFile(path);
+  if (!pluginFile.isFile())
+  {
+    return QString();
+  }
+  return QString("%1|%2|%3").arg(location)
+      .arg(pluginFile.lastModified().toString(Qt::ISODate)).arg(pluginFile.size());
+}
+
+bool ctkMetaTypeProviderImpl::readCache()
+{
+  QString fileName = cacheFile();
+  QString key = cacheKey();
+  if (fileName.isEmpty() || key.isEmpty())
+  {
+    return false;
+  }
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+  QDataStream in(&file);
+  quint32 magic = 0;
+  qint32 version = 0;
+  QString cachedKey;
+  in >> magic >> version;
+  if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+  {
+    return false;
+  }
+  in >> cachedKey;
+  if (cachedKey != key)
+  {
+    return false;
+  }
+
+  QHash<QString, ctkObjectClassDefinitionImplPtr> pidToOCD;
+  qint32 count = 0;
+  in >> count;
+  for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+  {
+    QString pid;
+    in >> pid;
+    ctkObjectClassDefinitionImplPtr ocd = ctkObjectClassDefinitionImpl::read(in, _plugin, logger);
+    pidToOCD.insert(pid, ocd);
+  }
+  if (in.status() != QDataStream::Ok)
+  {
+    CTK_WARN(logger) << "Invalid metatype cache file" << fileName;
+    file.close();
+    file.remove();
+    return false;
+  }
+
+  QHash<QString, ctkObjectClassDefinitionImplPtr>::ConstIterator end(pidToOCD.end());
+  for (QHash<QString, ctkObjectClassDefinitionImplPtr>::ConstIterator it(pidToOCD.begin()); it != end; ++it)
+  {
+    if (it.value()->getType() == ctkObjectClassDefinitionImpl::PID)
+    {
+      _allPidOCDs.insert(it.key(), it.value());
+    }
+    else
+    {
+      _allFPidOCDs.insert(it.key(), it.value());
+    }
+  }
+  return true;
+}
+
+void ctkMetaTypeProviderImpl::writeCache() const
+{
+  QString fileName = cacheFile();
+  QString key = cacheKey();
+  if (fileName.isEmpty() || key.isEmpty() || !QDir().mkpath(_cacheDir))
+  {
+    return;
+  }
+
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  out << CACHE_MAGIC << CACHE_VERSION << key;
+  out << static_cast<qint32>(_allPidOCDs.size() + _allFPidOCDs.size());
+  QHash<QString, ctkObjectClassDefinitionImplPtr>::ConstIterator end(_allPidOCDs.end());
+  for (QHash<QString, ctkObjectClassDefinitionImplPtr>::ConstIterator it(_allPidOCDs.begin()); it != end; ++it)
+  {
+    out << it.key();
+    it.value()->write(out);
+  }
+  end = _allFPidOCDs.end();
+  for (QHash<QString, ctkObjectClassDefinitionImplPtr>::ConstIterator it(_allFPidOCDs.begin()); it != end; ++it)
+  {
+    out << it.key();
+    it.value()->write(out);
+  }
+
+  // written under a temporary name, a concurrent reader never sees a partial file
+  QString tmpFileName = fileName + RESOURCE_FILE_CONN + QString::number(QCoreApplication::applicationPid());
+  QFile file(tmpFileName);
+  if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size())
+  {
+    file.remove();
+    return;
+  }
+  file.close();
+  QFile::remove(fileName);
+  if (!QFile::rename(tmpFileName, fileName))
+  {
+    QFile::remove(tmpFileName);
+  }
+}
+
 QList<QLocale> ctkMetaTypeProviderImpl::checkForDefault(const QList<QLocale>& locales) const
 {
   if (locales.isEmpty() || (locales.size() == 1 && QLocale() == locales[0]))
@@ -25,6 +25,8 @@
 
 #include <service/metatype/ctkMetaTypeProvider.h>
 
+#include <QMutex>
+
 class ctkPlugin;
 struct ctkLogService;
 class ctkObjectClassDefinitionImpl;
@@ -45,6 +47,7 @@ public:
   static const QString RESOURCE_FILE_CONN; // = "_"
   static const QString RESOURCE_FILE_EXT; // = ".qm"
   static const QChar DIRECTORY_SEP; // = '/'
+  static const QString CACHE_FILE_EXT; // = ".ocd"
 
 protected:
 
@@ -55,11 +58,27 @@ protected:
 
   ctkLogService* logger;
 
+  /**
+   * Read the metadata of the plugin on first use, from the cache file when it is
+   * up to date, or from the plugin's metatype documents.
+   */
+  void loadMetaData() const;
+
 private:
 
   mutable QList<QLocale> _locales;
   bool _isThereMeta;
 
+  QString _cacheDir;
+  mutable QMutex _loadMutex;
+  mutable bool _loaded;
+
+  /**
+   * The object class definitions already localized, by locale name and pid.
+   */
+  QMutex _localizedMutex;
+  QHash<QString, QHash<QString, QSharedPointer<ctkObjectClassDefinitionImpl> > > _localizedOCDs;
+
   friend class ctkMetaTypeServiceImpl;
 
 public:
@@ -67,7 +86,8 @@ public:
   /**
    * Constructor of class MetaTypeProviderImpl.
    */
-  ctkMetaTypeProviderImpl(const QSharedPointer<ctkPlugin>& plugin, ctkLogService* logger);
+  ctkMetaTypeProviderImpl(const QSharedPointer<ctkPlugin>& plugin, ctkLogService* logger,
+                          const QString& cacheDir = QString());
 
   /*
    * @see ctkMetaTypeProvider#getObjectClassDefinition(const QString&, const QLocale&)
@@ -93,6 +113,16 @@ private:
    */
   bool readMetaFiles(const QSharedPointer<ctkPlugin>& plugin);
 
+  /**
+   * The cache file of the plugin and the key of the plugin's content it was written
+   * for, the key is empty when the plugin location is not a local file.
+   */
+  QString cacheFile() const;
+  QString cacheKey() const;
+
+  bool readCache();
+  void writeCache() const;
+
   /**
    * Internal Method - checkForDefault
    */
@@ -29,8 +29,9 @@
 
 #include <service/log/ctkLogService.h>
 
-ctkMetaTypeServiceImpl::ctkMetaTypeServiceImpl(ctkLogService* logger, ctkServiceTracker<>* metaTypeProviderTracker)
-  : logger(logger), metaTypeProviderTracker(metaTypeProviderTracker)
+ctkMetaTypeServiceImpl::ctkMetaTypeServiceImpl(ctkLogService* logger, ctkServiceTracker<>* metaTypeProviderTracker,
+                                               const QString& cacheDir)
+  : logger(logger), metaTypeProviderTracker(metaTypeProviderTracker), cacheDir(cacheDir)
 {
 }
 
@@ -59,7 +60,7 @@ ctkMetaTypeInformationPtr ctkMetaTypeServiceImpl::getMetaTypeProvider(const QSha
       return _mtps.value(pID);
     }
 
-    ctkMetaTypeInformationImpl* impl = new ctkMetaTypeInformationImpl(p, logger);
+    ctkMetaTypeInformationImpl* impl = new ctkMetaTypeInformationImpl(p, logger, cacheDir);
     ctkMetaTypeInformation* mti = impl;
     if (!impl->_isThereMeta)
     {
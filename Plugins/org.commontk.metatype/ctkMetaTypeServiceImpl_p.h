@@ -43,13 +43,15 @@ private:
 
   ctkLogService* const logger;
   ctkServiceTracker<>* metaTypeProviderTracker;
+  const QString cacheDir;
 
 public:
 
   /**
    * Constructor of class ctkMetaTypeServiceImpl.
    */
-  ctkMetaTypeServiceImpl(ctkLogService* logger, ctkServiceTracker<>* metaTypeProviderTracker);
+  ctkMetaTypeServiceImpl(ctkLogService* logger, ctkServiceTracker<>* metaTypeProviderTracker,
+                         const QString& cacheDir = QString());
 
   /*
    * @see ctkMetaTypeService#getMetaTypeInformation()
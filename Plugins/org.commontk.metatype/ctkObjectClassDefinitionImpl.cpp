@@ -27,6 +27,8 @@
 #include <ctkPlugin.h>
 #include <ctkPluginConstants.h>
 
+#include <QDataStream>
+
 const int ctkObjectClassDefinitionImpl::PID = 0;
 const int ctkObjectClassDefinitionImpl::FPID = 1;
 const QChar ctkObjectClassDefinitionImpl::LOCALE_SEP = '_';
@@ -42,14 +44,14 @@ ctkObjectClassDefinitionImpl::ctkObjectClassDefinitionImpl(const ctkObjectClassD
   : _name(other._name), _id(other._id), _description(other._description),
     _locElem(other._locElem), _type(other._type), _icon(other._icon)
 {
-  for (int i = 0; i < _required.size(); i++)
+  for (int i = 0; i < other._required.size(); i++)
   {
-    ctkAttributeDefinitionImplPtr ad(new ctkAttributeDefinitionImpl(*_required.value(i).data()));
+    ctkAttributeDefinitionImplPtr ad(new ctkAttributeDefinitionImpl(*other._required.value(i).data()));
     this->addAttributeDefinition(ad, true);
   }
-  for (int i = 0; i < _optional.size(); i++)
+  for (int i = 0; i < other._optional.size(); i++)
   {
-    ctkAttributeDefinitionImplPtr ad(new ctkAttributeDefinitionImpl(*_optional.value(i).data()));
+    ctkAttributeDefinitionImplPtr ad(new ctkAttributeDefinitionImpl(*other._optional.value(i).data()));
     this->addAttributeDefinition(ad, false);
   }
 }
@@ -174,3 +176,49 @@ QString ctkObjectClassDefinitionImpl::getLocalization() const
   return _locElem.getLocalizationBase();
 }
 
+void ctkObjectClassDefinitionImpl::write(QDataStream& out) const
+{
+  out << _name << _description << _id << _locElem.getLocalizationBase() << _locElem.getContext()
+      << static_cast<qint32>(_type) << static_cast<bool>(_icon) << _icon.getIconName()
+      << static_cast<qint32>(_icon.getIconSize());
+
+  out << static_cast<qint32>(_required.size());
+  foreach(ctkAttributeDefinitionImplPtr impl, _required)
+  {
+    impl->write(out);
+  }
+  out << static_cast<qint32>(_optional.size());
+  foreach(ctkAttributeDefinitionImplPtr impl, _optional)
+  {
+    impl->write(out);
+  }
+}
+
+ctkObjectClassDefinitionImplPtr ctkObjectClassDefinitionImpl::read(
+  QDataStream& in, const QSharedPointer<ctkPlugin>& plugin, ctkLogService* logger)
+{
+  QString name, description, id, localization, context, iconName;
+  qint32 type = 0;
+  bool hasIcon = false;
+  qint32 iconSize = -1;
+  in >> name >> description >> id >> localization >> context >> type >> hasIcon >> iconName >> iconSize;
+
+  ctkObjectClassDefinitionImplPtr ocd(new ctkObjectClassDefinitionImpl(
+                                        name, description, id, localization, context, type));
+  if (hasIcon)
+  {
+    ocd->setIcon(ctkMTIcon(iconName, iconSize, plugin));
+  }
+
+  for (int required = 1; required >= 0; --required)
+  {
+    qint32 count = 0;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+      ocd->addAttributeDefinition(ctkAttributeDefinitionImpl::read(in, logger), required != 0);
+    }
+  }
+  return ocd;
+}
+
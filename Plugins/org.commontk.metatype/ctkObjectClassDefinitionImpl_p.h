@@ -30,6 +30,8 @@
 #include "ctkMTLocalizationElement_p.h"
 
 class ctkAttributeDefinitionImpl;
+class QDataStream;
+struct ctkLogService;
 
 /**
  * Implementation of ObjectClassDefinition
@@ -129,6 +131,17 @@ public:
 
   QString getLocalization() const;
 
+  /**
+   * Write this OCD and its ADs to the metatype cache.
+   */
+  void write(QDataStream& out) const;
+
+  /**
+   * Read an OCD written by write(), its icon is loaded from the given plugin.
+   */
+  static QSharedPointer<ctkObjectClassDefinitionImpl> read(QDataStream& in, const QSharedPointer<ctkPlugin>& plugin,
+                                                           ctkLogService* logger);
+
 };
 
 typedef QSharedPointer<ctkObjectClassDefinitionImpl> ctkObjectClassDefinitionImplPtr;